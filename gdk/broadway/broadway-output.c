@@ -4,6 +4,7 @@
 #include <assert.h>
 #include <errno.h>
 #include <cairo.h>
+#include <zlib.h>
 
 #include "broadway-output.h"
 
@@ -14,27 +15,189 @@
  *                Basic I/O primitives                                  *
  ************************************************************************/
 
+/* Frames are written to the client by a separate thread, so a slow
+ * client does not hold up the main loop. Once more than this many
+ * bytes are queued up, senders wait for the writer to catch up.
+ */
+#define MAX_QUEUED_BYTES (32 * 1024 * 1024)
+
+/* When the output is freed with more than this queued up, the client
+ * is considered gone and the remaining frames are dropped
+ */
+#define MAX_CLOSING_BYTES (1024 * 1024)
+
 struct BroadwayOutput {
+  gatomicrefcount ref_count;
   GOutputStream *out;
   GString *buf;
-  int error;
+  int error; /* atomic */
   guint32 serial;
+  z_stream *deflate;
+  GByteArray *deflate_buf;
+
+  GThread *write_thread;
+  GCancellable *cancellable;
+  GMutex lock;
+  GCond cond;
+  GQueue frames; /* GBytes, protected by lock */
+  gsize queued_bytes; /* protected by lock */
+  gboolean closing; /* protected by lock */
 };
 
+static void
+broadway_output_unref (BroadwayOutput *output)
+{
+  if (!g_atomic_ref_count_dec (&output->ref_count))
+    return;
+
+  g_queue_clear_full (&output->frames, (GDestroyNotify) g_bytes_unref);
+  g_mutex_clear (&output->lock);
+  g_cond_clear (&output->cond);
+  g_object_unref (output->cancellable);
+  g_object_unref (output->out);
+  g_free (output);
+}
+
+static gpointer
+broadway_output_write_thread (gpointer data)
+{
+  BroadwayOutput *output = data;
+  GBytes *frame;
+
+  g_mutex_lock (&output->lock);
+  for (;;)
+    {
+      gsize size;
+
+      while (g_queue_is_empty (&output->frames) && !output->closing)
+        g_cond_wait (&output->cond, &output->lock);
+
+      frame = g_queue_pop_head (&output->frames);
+      if (frame == NULL)
+        break;
+
+      g_mutex_unlock (&output->lock);
+
+      size = g_bytes_get_size (frame);
+      if (!g_atomic_int_get (&output->error) &&
+          !g_output_stream_write_all (output->out,
+                                      g_bytes_get_data (frame, NULL), size,
+                                      NULL, output->cancellable, NULL))
+        g_atomic_int_set (&output->error, TRUE);
+      g_bytes_unref (frame);
+
+      g_mutex_lock (&output->lock);
+      output->queued_bytes -= size;
+      g_cond_broadcast (&output->cond);
+    }
+  g_mutex_unlock (&output->lock);
+
+  broadway_output_unref (output);
+
+  return NULL;
+}
+
+static void
+broadway_output_queue_frame (BroadwayOutput *output,
+                             GBytes         *frame)
+{
+  g_mutex_lock (&output->lock);
+
+  while (output->queued_bytes > MAX_QUEUED_BYTES &&
+         !g_atomic_int_get (&output->error))
+    g_cond_wait (&output->cond, &output->lock);
+
+  if (g_atomic_int_get (&output->error))
+    {
+      g_bytes_unref (frame);
+    }
+  else
+    {
+      output->queued_bytes += g_bytes_get_size (frame);
+      g_queue_push_tail (&output->frames, frame);
+      g_cond_broadcast (&output->cond);
+    }
+
+  g_mutex_unlock (&output->lock);
+}
+
+/* Messages smaller than this are not worth compressing */
+#define DEFLATE_MIN_SIZE 64
+
+/* Compresses a message as described in RFC 7692. The compression
+ * context is kept across messages, so repeated node trees and
+ * commands get cheaper after the first time they are sent.
+ */
+static gboolean
+broadway_output_deflate (BroadwayOutput *output,
+                         const void     *buf,
+                         gsize           count)
+{
+  z_stream *zs = output->deflate;
+  guchar chunk[16384];
+  int res;
+
+  g_byte_array_set_size (output->deflate_buf, 0);
+
+  zs->next_in = (Bytef *) buf;
+  zs->avail_in = count;
+  do
+    {
+      zs->next_out = chunk;
+      zs->avail_out = sizeof (chunk);
+      res = deflate (zs, Z_SYNC_FLUSH);
+      if (res != Z_OK && res != Z_BUF_ERROR)
+        return FALSE;
+      g_byte_array_append (output->deflate_buf, chunk, sizeof (chunk) - zs->avail_out);
+    }
+  while (zs->avail_out == 0);
+
+  /* Strip the 0x00 0x00 0xff 0xff trailer of the sync flush,
+   * the receiver adds it back
+   */
+  if (output->deflate_buf->len < 4)
+    return FALSE;
+  g_byte_array_set_size (output->deflate_buf, output->deflate_buf->len - 4);
+
+  return TRUE;
+}
+
 static void
 broadway_output_send_cmd (BroadwayOutput *output,
                           gboolean fin, BroadwayWSOpCode code,
                           const void *buf, gsize count)
 {
   gboolean mask = FALSE;
+  gboolean compressed = FALSE;
+  GByteArray *frame;
   guchar header[16];
   size_t p;
+  gboolean mid_header;
+  gboolean long_header;
+
+  /* Control frames must not be compressed */
+  if (output->deflate && code == BROADWAY_WS_BINARY && fin &&
+      count >= DEFLATE_MIN_SIZE)
+    {
+      if (broadway_output_deflate (output, buf, count))
+        {
+          compressed = TRUE;
+          buf = output->deflate_buf->data;
+          count = output->deflate_buf->len;
+        }
+      else
+        {
+          /* The context is unusable now, send everything uncompressed */
+          deflateEnd (output->deflate);
+          g_clear_pointer (&output->deflate, g_free);
+        }
+    }
 
-  gboolean mid_header = count > 125 && count <= 65535;
-  gboolean long_header = count > 65535;
+  mid_header = count > 125 && count <= 65535;
+  long_header = count > 65535;
 
   /* NB. big-endian spec => bit 0 == MSB */
-  header[0] = ( (fin ? 0x80 : 0) | (code & 0x0f) );
+  header[0] = ( (fin ? 0x80 : 0) | (compressed ? 0x40 : 0) | (code & 0x0f) );
   header[1] = ( (mask ? 0x80 : 0) |
                 (mid_header ? 126 : long_header ? 127 : count) );
   p = 2;
@@ -49,9 +212,10 @@ broadway_output_send_cmd (BroadwayOutput *output,
       p += 8;
     }
   // FIXME: if we are paranoid we should 'mask' the data
-  // FIXME: we should really emit these as a single write
-  g_output_stream_write_all (output->out, header, p, NULL, NULL, NULL);
-  g_output_stream_write_all (output->out, buf, count, NULL, NULL, NULL);
+  frame = g_byte_array_sized_new (p + count);
+  g_byte_array_append (frame, header, p);
+  g_byte_array_append (frame, buf, count);
+  broadway_output_queue_frame (output, g_byte_array_free_to_bytes (frame));
 }
 
 void broadway_output_pong (BroadwayOutput *output)
@@ -70,7 +234,7 @@ broadway_output_flush (BroadwayOutput *output)
 
   g_string_set_size (output->buf, 0);
 
-  return !output->error;
+  return !g_atomic_int_get (&output->error);
 
 }
 
@@ -81,18 +245,76 @@ broadway_output_new (GOutputStream *out, guint32 serial)
 
   output = g_new0 (BroadwayOutput, 1);
 
+  g_atomic_ref_count_init (&output->ref_count);
   output->out = g_object_ref (out);
   output->buf = g_string_new ("");
   output->serial = serial;
 
+  output->cancellable = g_cancellable_new ();
+  g_mutex_init (&output->lock);
+  g_cond_init (&output->cond);
+  g_queue_init (&output->frames);
+
+  /* The thread holds its own reference, see broadway_output_free() */
+  g_atomic_ref_count_inc (&output->ref_count);
+  output->write_thread = g_thread_new ("broadway-output",
+                                       broadway_output_write_thread,
+                                       output);
+
   return output;
 }
 
+/* Compress outgoing messages with the permessage-deflate extension.
+ * Must only be called if the client negotiated it in the handshake.
+ */
+gboolean
+broadway_output_enable_deflate (BroadwayOutput *output)
+{
+  z_stream *zs;
+
+  if (output->deflate)
+    return TRUE;
+
+  zs = g_new0 (z_stream, 1);
+  /* Negative window bits give a raw deflate stream, without zlib header */
+  if (deflateInit2 (zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                    -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+      g_free (zs);
+      return FALSE;
+    }
+
+  output->deflate = zs;
+  if (output->deflate_buf == NULL)
+    output->deflate_buf = g_byte_array_new ();
+
+  return TRUE;
+}
+
+/* This does not wait for the queued frames to be written, the write
+ * thread finishes them in the background and frees the rest of the
+ * output. If the client is far behind, the frames are dropped.
+ */
 void
 broadway_output_free (BroadwayOutput *output)
 {
-  g_object_unref (output->out);
-  free (output);
+  if (output->deflate)
+    {
+      deflateEnd (output->deflate);
+      g_free (output->deflate);
+    }
+  g_clear_pointer (&output->deflate_buf, g_byte_array_unref);
+  g_string_free (output->buf, TRUE);
+
+  g_mutex_lock (&output->lock);
+  output->closing = TRUE;
+  if (output->queued_bytes > MAX_CLOSING_BYTES)
+    g_cancellable_cancel (output->cancellable);
+  g_cond_broadcast (&output->cond);
+  g_mutex_unlock (&output->lock);
+
+  g_thread_unref (output->write_thread);
+  broadway_output_unref (output);
 }
 
 guint32
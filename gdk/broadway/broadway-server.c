@@ -11,6 +11,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <zlib.h>
 
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
@@ -112,6 +113,8 @@ struct BroadwayInput {
   gboolean seen_time;
   gint64 time_base;
   gboolean active;
+  z_stream *inflate;
+  GByteArray *inflate_buf;
 };
 
 struct BroadwaySurface {
@@ -336,6 +339,12 @@ broadway_input_free (BroadwayInput *input)
 {
   g_object_unref (input->connection);
   g_byte_array_free (input->buffer, FALSE);
+  if (input->inflate)
+    {
+      inflateEnd (input->inflate);
+      g_free (input->inflate);
+      g_byte_array_unref (input->inflate_buf);
+    }
   g_source_destroy (input->source);
   g_free (input);
 }
@@ -772,6 +781,41 @@ hex_dump (guchar *data, gsize len)
 #endif
 }
 
+/* Decompresses a message sent with the permessage-deflate extension
+ * into input->inflate_buf. See RFC 7692.
+ */
+static gboolean
+inflate_message (BroadwayInput *input,
+                 guchar        *data,
+                 gsize          len)
+{
+  static const guchar trailer[] = { 0x00, 0x00, 0xff, 0xff };
+  z_stream *zs = input->inflate;
+  guchar chunk[4096];
+  int i, res;
+
+  g_byte_array_set_size (input->inflate_buf, 0);
+
+  /* The sender strips the trailer of the final sync flush, add it back */
+  for (i = 0; i < 2; i++)
+    {
+      zs->next_in = i == 0 ? data : (Bytef *) trailer;
+      zs->avail_in = i == 0 ? len : sizeof (trailer);
+      do
+        {
+          zs->next_out = chunk;
+          zs->avail_out = sizeof (chunk);
+          res = inflate (zs, Z_SYNC_FLUSH);
+          if (res != Z_OK && res != Z_BUF_ERROR)
+            return FALSE;
+          g_byte_array_append (input->inflate_buf, chunk, sizeof (chunk) - zs->avail_out);
+        }
+      while (zs->avail_out == 0);
+    }
+
+  return TRUE;
+}
+
 static void
 parse_input (BroadwayInput *input)
 {
@@ -784,7 +828,7 @@ parse_input (BroadwayInput *input)
     {
       gsize len, payload_len;
       BroadwayWSOpCode code;
-      gboolean is_mask, fin;
+      gboolean is_mask, fin, compressed;
       guchar *buf, *data, *mask;
 
       buf = input->buffer->data;
@@ -795,6 +839,7 @@ parse_input (BroadwayInput *input)
 #endif
 
       fin = buf[0] & 0x80;
+      compressed = buf[0] & 0x40;
       code = buf[0] & 0x0f;
       payload_len = buf[1] & 0x7f;
       is_mask = buf[1] & 0x80;
@@ -844,6 +889,14 @@ parse_input (BroadwayInput *input)
             g_warning ("can't yet accept fragmented input");
 #endif
           }
+        else if (compressed)
+          {
+            if (input->inflate == NULL ||
+                !inflate_message (input, data, payload_len))
+              g_warning ("invalid compressed input message");
+            else if (input->inflate_buf->len >= 12)
+              parse_input_message (input, input->inflate_buf->data);
+          }
         else
           {
             parse_input_message (input, data);
@@ -1098,7 +1151,8 @@ start_input (HttpRequest *request)
   const char *p;
   int i;
   char *res;
-  const char *origin, *host;
+  const char *origin, *host, *extensions;
+  gboolean use_deflate;
   BroadwayInput *input;
   const void *data_buffer;
   gsize data_buffer_size;
@@ -1115,6 +1169,7 @@ start_input (HttpRequest *request)
   key = NULL;
   origin = NULL;
   host = NULL;
+  extensions = NULL;
   for (i = 0; lines[i] != NULL; i++)
     {
       if ((p = parse_line (lines[i], "Sec-WebSocket-Key")))
@@ -1125,8 +1180,19 @@ start_input (HttpRequest *request)
         host = p;
       else if ((p = parse_line (lines[i], "Sec-WebSocket-Origin")))
         origin = p;
+      else if ((p = parse_line (lines[i], "Sec-WebSocket-Extensions")))
+        extensions = p;
     }
 
+  /* Only accept permessage-deflate offers that let us keep the
+   * compression context and use the full window. The client
+   * parameters need no reply, we handle whatever the client sends.
+   */
+  use_deflate = extensions != NULL &&
+                strstr (extensions, "permessage-deflate") != NULL &&
+                strstr (extensions, "server_max_window_bits") == NULL &&
+                strstr (extensions, "server_no_context_takeover") == NULL;
+
   if (host == NULL)
     {
       g_strfreev (lines);
@@ -1144,9 +1210,11 @@ start_input (HttpRequest *request)
                              "%s%s%s"
                              "Sec-WebSocket-Location: ws://%s/socket\r\n"
                              "Sec-WebSocket-Protocol: broadway\r\n"
+                             "%s"
                              "\r\n", accept,
                              origin?"Sec-WebSocket-Origin: ":"", origin?origin:"", origin?"\r\n":"",
-                             host);
+                             host,
+                             use_deflate?"Sec-WebSocket-Extensions: permessage-deflate\r\n":"");
       g_free (accept);
 
 #ifdef DEBUG_WEBSOCKETS
@@ -1179,6 +1247,15 @@ start_input (HttpRequest *request)
   input->output =
     broadway_output_new (g_io_stream_get_output_stream (request->connection), 0);
 
+  if (use_deflate)
+    {
+      input->inflate = g_new0 (z_stream, 1);
+      input->inflate_buf = g_byte_array_new ();
+      if (inflateInit2 (input->inflate, -MAX_WBITS) != Z_OK ||
+          !broadway_output_enable_deflate (input->output))
+        g_error ("Failed to set up compression");
+    }
+
   /* This will free and close the data input stream, but we got all the buffered content already */
   http_request_free (request);
 
@@ -15,6 +15,7 @@
 #include "gdkprivate-broadway.h"
 #include "gdkprivate.h"
 
+#include <gdk/gdkshmprivate.h>
 #include <gdk/gdktextureprivate.h>
 
 #include <glib.h>
@@ -573,54 +574,6 @@ _gdk_broadway_server_surface_set_modal_hint (GdkBroadwayServer *server,
 				    BROADWAY_REQUEST_SET_MODAL_HINT);
 }
 
-static int
-open_shared_memory (void)
-{
-  static gboolean force_shm_open = FALSE;
-  int ret = -1;
-
-#if !defined (__NR_memfd_create)
-  force_shm_open = TRUE;
-#endif
-
-  do
-    {
-#if defined (__NR_memfd_create)
-      if (!force_shm_open)
-        {
-          ret = syscall (__NR_memfd_create, "gdk-broadway", MFD_CLOEXEC);
-
-          /* fall back to shm_open until debian stops shipping 3.16 kernel
-           * See bug 766341
-           */
-          if (ret < 0 && errno == ENOSYS)
-            force_shm_open = TRUE;
-        }
-#endif
-
-      if (force_shm_open)
-        {
-          char name[NAME_MAX - 1] = "";
-
-          sprintf (name, "/gdk-broadway-%x", g_random_int ());
-
-          ret = shm_open (name, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
-
-          if (ret >= 0)
-            shm_unlink (name);
-          else if (errno == EEXIST)
-            continue;
-        }
-    }
-  while (ret < 0 && errno == EINTR);
-
-  if (ret < 0)
-    g_critical (G_STRLOC ": creating shared memory file (using %s) failed: %m",
-                force_shm_open? "shm_open" : "memfd_create");
-
-  return ret;
-}
-
 guint32
 gdk_broadway_server_upload_texture (GdkBroadwayServer *server,
                                     GdkTexture        *texture)
@@ -633,7 +586,7 @@ gdk_broadway_server_upload_texture (GdkBroadwayServer *server,
   int fd;
 
   bytes = gdk_texture_save_to_png_bytes (texture);
-  fd = open_shared_memory ();
+  fd = gdk_shm_open ("gdk-broadway");
   data = g_bytes_get_data (bytes, &size);
 
   id = server->next_texture_id++;
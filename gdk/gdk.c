@@ -137,6 +137,8 @@ static const GdkDebugKey gdk_debug_keys[] = {
   { "high-depth",      GDK_DEBUG_HIGH_DEPTH, "Use high bit depth rendering if possible" },
   { "no-vsync",        GDK_DEBUG_NO_VSYNC, "Repaint instantly (uses 100% CPU with animations)" },
   { "dmabuf-disable",  GDK_DEBUG_DMABUF_DISABLE, "Disable dmabuf support" },
+  { "frame-deadline",  GDK_DEBUG_FRAME_DEADLINE, "Start frames as late as possible before the next vblank" },
+  { "wayland-read-thread", GDK_DEBUG_WAYLAND_READ_THREAD, "Read Wayland events in a separate thread" },
 };
 
 
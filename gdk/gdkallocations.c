@@ -0,0 +1,133 @@
+/* GDK - The GIMP Drawing Kit
+ * Copyright © 2024 The GTK Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gdkallocationsprivate.h"
+
+#include "gdkprofilerprivate.h"
+
+gboolean gdk_allocation_tracking = FALSE;
+
+static guint tracking_users;
+
+static GdkAllocationCounts allocation_counts[GDK_N_ALLOCATION_KINDS];
+
+static const char *kind_names[GDK_N_ALLOCATION_KINDS] = {
+  [GDK_ALLOCATION_RENDER_NODE] = "Render nodes",
+  [GDK_ALLOCATION_CSS_VALUE] = "CSS values",
+  [GDK_ALLOCATION_PANGO_LAYOUT] = "Pango layouts",
+  [GDK_ALLOCATION_TEXTURE] = "Textures",
+  [GDK_ALLOCATION_GPU_CACHE] = "GPU cache entries",
+};
+
+/*< private >
+ * gdk_allocation_tracking_enable:
+ *
+ * Starts counting allocations.
+ *
+ * Calls must be balanced with gdk_allocation_tracking_disable().
+ * The counts are kept when tracking is disabled, so deltas between
+ * two samples stay meaningful.
+ */
+void
+gdk_allocation_tracking_enable (void)
+{
+  tracking_users++;
+  gdk_allocation_tracking = TRUE;
+}
+
+void
+gdk_allocation_tracking_disable (void)
+{
+  g_return_if_fail (tracking_users > 0);
+
+  tracking_users--;
+  gdk_allocation_tracking = tracking_users > 0;
+}
+
+/* Objects get allocated from threads too, eg textures by loaders */
+void
+gdk_allocation_record (GdkAllocationKind kind,
+                       gsize             n_allocated,
+                       gsize             n_freed,
+                       gsize             bytes_allocated)
+{
+  GdkAllocationCounts *c = &allocation_counts[kind];
+
+  if (n_allocated)
+    g_atomic_pointer_add (&c->n_allocated, n_allocated);
+  if (n_freed)
+    g_atomic_pointer_add (&c->n_freed, n_freed);
+  if (bytes_allocated)
+    g_atomic_pointer_add (&c->bytes_allocated, bytes_allocated);
+}
+
+const char *
+gdk_allocation_kind_get_name (GdkAllocationKind kind)
+{
+  return kind_names[kind];
+}
+
+/*< private >
+ * gdk_allocation_get_counts:
+ * @kind: the kind of object
+ * @counts: (out): return location for the counts
+ *
+ * Gets the number of allocations, frees and the number of bytes
+ * allocated for @kind since tracking was first enabled.
+ *
+ * Sample the counts periodically and compare them to find churn
+ * and leaks.
+ */
+void
+gdk_allocation_get_counts (GdkAllocationKind    kind,
+                           GdkAllocationCounts *counts)
+{
+  GdkAllocationCounts *c = &allocation_counts[kind];
+
+  counts->n_allocated = (gsize) g_atomic_pointer_get (&c->n_allocated);
+  counts->n_freed = (gsize) g_atomic_pointer_get (&c->n_freed);
+  counts->bytes_allocated = (gsize) g_atomic_pointer_get (&c->bytes_allocated);
+}
+
+/*< private >
+ * gdk_allocation_add_to_profiler:
+ *
+ * Reports the number of live objects of every kind as counters
+ * to sysprof, if tracking is enabled.
+ */
+void
+gdk_allocation_add_to_profiler (void)
+{
+  static guint counter_ids[GDK_N_ALLOCATION_KINDS];
+  GdkAllocationKind kind;
+
+  if (!GDK_ALLOCATION_TRACKING)
+    return;
+
+  for (kind = 0; kind < GDK_N_ALLOCATION_KINDS; kind++)
+    {
+      GdkAllocationCounts c;
+
+      if (counter_ids[kind] == 0)
+        counter_ids[kind] = gdk_profiler_define_int_counter (kind_names[kind], "Live objects");
+
+      gdk_allocation_get_counts (kind, &c);
+      gdk_profiler_set_int_counter (counter_ids[kind], (gint64) c.n_allocated - (gint64) c.n_freed);
+    }
+}
@@ -0,0 +1,74 @@
+/* GDK - The GIMP Drawing Kit
+ * Copyright © 2024 The GTK Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Counts allocations of frequently created objects across GDK, GSK
+ * and GTK, for finding leaks and churn. Counting is off by default
+ * and costs a single branch per allocation then.
+ *
+ * Counts start when tracking is enabled, so objects allocated before
+ * that may show up as frees without matching allocations.
+ */
+typedef enum {
+  GDK_ALLOCATION_RENDER_NODE,
+  GDK_ALLOCATION_CSS_VALUE,
+  GDK_ALLOCATION_PANGO_LAYOUT,
+  GDK_ALLOCATION_TEXTURE,
+  GDK_ALLOCATION_GPU_CACHE,
+  GDK_N_ALLOCATION_KINDS
+} GdkAllocationKind;
+
+typedef struct {
+  gsize n_allocated;
+  gsize n_freed;
+  gsize bytes_allocated;
+} GdkAllocationCounts;
+
+extern gboolean gdk_allocation_tracking;
+
+#define GDK_ALLOCATION_TRACKING (G_UNLIKELY (gdk_allocation_tracking))
+
+#define gdk_allocation_add(kind, size) G_STMT_START { \
+  if (GDK_ALLOCATION_TRACKING) \
+    gdk_allocation_record ((kind), 1, 0, (size)); \
+} G_STMT_END
+
+#define gdk_allocation_remove(kind) G_STMT_START { \
+  if (GDK_ALLOCATION_TRACKING) \
+    gdk_allocation_record ((kind), 0, 1, 0); \
+} G_STMT_END
+
+void            gdk_allocation_tracking_enable          (void);
+void            gdk_allocation_tracking_disable         (void);
+
+void            gdk_allocation_record                   (GdkAllocationKind    kind,
+                                                         gsize                n_allocated,
+                                                         gsize                n_freed,
+                                                         gsize                bytes_allocated);
+
+const char *    gdk_allocation_kind_get_name            (GdkAllocationKind    kind);
+void            gdk_allocation_get_counts               (GdkAllocationKind    kind,
+                                                         GdkAllocationCounts *counts);
+
+void            gdk_allocation_add_to_profiler          (void);
+
+G_END_DECLS
@@ -0,0 +1,288 @@
+/* GDK - The GIMP Drawing Kit
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gdkanimationdecoderprivate.h"
+
+#include "gdkmemoryformatprivate.h"
+#include "gdkmemorytexture.h"
+#include "gdktexture.h"
+
+#include <glib/gi18n-lib.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+/* Decoders for animated images.
+ *
+ * A decoder produces the frames of an animation one after the other,
+ * composited to the full size of the image, together with how long each
+ * frame is shown. Decoders are not threadsafe, but they can be used from
+ * any thread, one at a time, so that callers can decode ahead in a thread.
+ *
+ * Formats are added with gdk_animation_decoder_register(). Registered
+ * decoders are tried in order, before the builtin one that handles
+ * whatever animations gdk-pixbuf can load.
+ */
+
+G_LOCK_DEFINE_STATIC (decoders);
+static GSList *decoders;
+
+/* {{{ gdk-pixbuf */
+
+typedef struct
+{
+  GdkAnimationDecoder decoder;
+
+  GdkPixbufAnimation *animation;
+  GdkPixbufAnimationIter *iter;
+  GTimeVal time;
+  gboolean done;
+} GdkPixbufAnimationDecoder;
+
+static gboolean
+gdk_pixbuf_animation_decoder_is_format (GBytes *bytes)
+{
+  return TRUE;
+}
+
+static gboolean
+gdk_pixbuf_animation_decoder_init (GdkAnimationDecoder  *decoder,
+                                   GBytes               *bytes,
+                                   GError              **error)
+{
+  GdkPixbufAnimationDecoder *self = (GdkPixbufAnimationDecoder *) decoder;
+  GInputStream *stream;
+
+  stream = g_memory_input_stream_new_from_bytes (bytes);
+  self->animation = gdk_pixbuf_animation_new_from_stream (stream, NULL, error);
+  g_object_unref (stream);
+
+  if (self->animation == NULL)
+    return FALSE;
+
+  decoder->width = gdk_pixbuf_animation_get_width (self->animation);
+  decoder->height = gdk_pixbuf_animation_get_height (self->animation);
+
+  /* The iter is driven by virtual time, so frames come out in order
+   * no matter how long decoding them takes
+   */
+G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+  self->iter = gdk_pixbuf_animation_get_iter (self->animation, &self->time);
+G_GNUC_END_IGNORE_DEPRECATIONS
+
+  return TRUE;
+}
+
+static void
+gdk_pixbuf_animation_decoder_finish (GdkAnimationDecoder *decoder)
+{
+  GdkPixbufAnimationDecoder *self = (GdkPixbufAnimationDecoder *) decoder;
+
+  g_clear_object (&self->iter);
+  g_clear_object (&self->animation);
+}
+
+static gboolean
+gdk_pixbuf_animation_decoder_next_frame (GdkAnimationDecoder  *decoder,
+                                         GdkTexture          **texture,
+                                         gint64               *duration,
+                                         GError              **error)
+{
+  GdkPixbufAnimationDecoder *self = (GdkPixbufAnimationDecoder *) decoder;
+  GdkPixbuf *pixbuf;
+  GBytes *bytes;
+  guchar *data;
+  gsize stride;
+  int delay;
+
+  if (self->done)
+    return FALSE;
+
+  pixbuf = gdk_pixbuf_animation_iter_get_pixbuf (self->iter);
+  delay = gdk_pixbuf_animation_iter_get_delay_time (self->iter);
+
+  /* The iter reuses its pixbuf for the following frames, so the pixels
+   * need to be copied anyway. Convert them to the format the renderers
+   * upload as is while doing that, which keeps this work off the main
+   * thread.
+   */
+  stride = gdk_pixbuf_get_width (pixbuf) * gdk_memory_format_bytes_per_pixel (GDK_MEMORY_DEFAULT);
+  data = g_try_malloc_n (gdk_pixbuf_get_height (pixbuf), stride);
+  if (data == NULL)
+    {
+      g_set_error (error,
+                   GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_TOO_LARGE,
+                   _("Not enough memory for image size %ux%u"),
+                   gdk_pixbuf_get_width (pixbuf), gdk_pixbuf_get_height (pixbuf));
+      return FALSE;
+    }
+
+  gdk_memory_convert (data,
+                      stride,
+                      GDK_MEMORY_DEFAULT,
+                      gdk_pixbuf_get_pixels (pixbuf),
+                      gdk_pixbuf_get_rowstride (pixbuf),
+                      gdk_pixbuf_get_has_alpha (pixbuf) ? GDK_MEMORY_GDK_PIXBUF_ALPHA
+                                                        : GDK_MEMORY_GDK_PIXBUF_OPAQUE,
+                      gdk_pixbuf_get_width (pixbuf),
+                      gdk_pixbuf_get_height (pixbuf));
+
+  bytes = g_bytes_new_take (data, gdk_pixbuf_get_height (pixbuf) * stride);
+  *texture = gdk_memory_texture_new (gdk_pixbuf_get_width (pixbuf),
+                                     gdk_pixbuf_get_height (pixbuf),
+                                     GDK_MEMORY_DEFAULT,
+                                     bytes,
+                                     stride);
+  g_bytes_unref (bytes);
+
+  if (delay < 0)
+    {
+      /* Static images, and animations that are done looping */
+      self->done = TRUE;
+      *duration = -1;
+      return TRUE;
+    }
+
+  *duration = delay * (gint64) 1000;
+
+G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+  g_time_val_add (&self->time, delay * 1000);
+  gdk_pixbuf_animation_iter_advance (self->iter, &self->time);
+G_GNUC_END_IGNORE_DEPRECATIONS
+
+  return TRUE;
+}
+
+static const GdkAnimationDecoderClass GDK_PIXBUF_ANIMATION_DECODER_CLASS = {
+  "gdk-pixbuf",
+  sizeof (GdkPixbufAnimationDecoder),
+  gdk_pixbuf_animation_decoder_is_format,
+  gdk_pixbuf_animation_decoder_init,
+  gdk_pixbuf_animation_decoder_finish,
+  gdk_pixbuf_animation_decoder_next_frame,
+};
+
+/* }}} */
+/* {{{ API */
+
+/*
+ * gdk_animation_decoder_register:
+ * @klass: (transfer none): the decoder class, which must stay alive
+ *
+ * Adds a decoder for an animation format. Decoders that are
+ * registered later take precedence.
+ */
+void
+gdk_animation_decoder_register (const GdkAnimationDecoderClass *klass)
+{
+  g_return_if_fail (klass->instance_size >= sizeof (GdkAnimationDecoder));
+  g_return_if_fail (klass->is_format != NULL);
+  g_return_if_fail (klass->init != NULL);
+  g_return_if_fail (klass->next_frame != NULL);
+
+  G_LOCK (decoders);
+  decoders = g_slist_prepend (decoders, (gpointer) klass);
+  G_UNLOCK (decoders);
+}
+
+static const GdkAnimationDecoderClass *
+gdk_animation_decoder_find_class (GBytes *bytes)
+{
+  const GdkAnimationDecoderClass *klass = &GDK_PIXBUF_ANIMATION_DECODER_CLASS;
+  GSList *l;
+
+  G_LOCK (decoders);
+
+  for (l = decoders; l; l = l->next)
+    {
+      const GdkAnimationDecoderClass *candidate = l->data;
+
+      if (candidate->is_format (bytes))
+        {
+          klass = candidate;
+          break;
+        }
+    }
+
+  G_UNLOCK (decoders);
+
+  return klass;
+}
+
+/*
+ * gdk_animation_decoder_new:
+ * @bytes: the image data
+ * @error: return location for an error
+ *
+ * Creates a decoder for the animation in @bytes. This can be
+ * called from any thread.
+ *
+ * Returns: (nullable): a new decoder
+ */
+GdkAnimationDecoder *
+gdk_animation_decoder_new (GBytes  *bytes,
+                           GError **error)
+{
+  const GdkAnimationDecoderClass *klass;
+  GdkAnimationDecoder *self;
+
+  klass = gdk_animation_decoder_find_class (bytes);
+
+  self = g_malloc0 (klass->instance_size);
+  self->klass = klass;
+
+  if (!klass->init (self, bytes, error))
+    {
+      gdk_animation_decoder_free (self);
+      return NULL;
+    }
+
+  return self;
+}
+
+void
+gdk_animation_decoder_free (GdkAnimationDecoder *self)
+{
+  if (self->klass->finish)
+    self->klass->finish (self);
+
+  g_free (self);
+}
+
+/*
+ * gdk_animation_decoder_next_frame:
+ * @self: a decoder
+ * @texture: (out) (transfer full): return location for the frame
+ * @duration: (out): return location for how long the frame is shown,
+ *   in microseconds, or -1 if it is the last frame
+ * @error: return location for an error
+ *
+ * Decodes the next frame of the animation.
+ *
+ * Returns: %FALSE if there are no more frames or an error happened
+ */
+gboolean
+gdk_animation_decoder_next_frame (GdkAnimationDecoder  *self,
+                                  GdkTexture          **texture,
+                                  gint64               *duration,
+                                  GError              **error)
+{
+  return self->klass->next_frame (self, texture, duration, error);
+}
+
+/* }}} */
+
+/* vim:set foldmethod=marker expandtab: */
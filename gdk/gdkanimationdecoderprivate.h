@@ -0,0 +1,48 @@
+#pragma once
+
+#include "gdktexture.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GdkAnimationDecoder GdkAnimationDecoder;
+typedef struct _GdkAnimationDecoderClass GdkAnimationDecoderClass;
+
+struct _GdkAnimationDecoder
+{
+  const GdkAnimationDecoderClass *klass;
+
+  int width;
+  int height;
+};
+
+struct _GdkAnimationDecoderClass
+{
+  const char *name;
+  gsize instance_size;
+
+  /* Returns TRUE if @bytes look like data this decoder handles */
+  gboolean              (* is_format)                   (GBytes                 *bytes);
+  /* Parses the headers and sets width and height */
+  gboolean              (* init)                        (GdkAnimationDecoder    *self,
+                                                         GBytes                 *bytes,
+                                                         GError                **error);
+  void                  (* finish)                      (GdkAnimationDecoder    *self);
+  /* Decodes the next frame, see gdk_animation_decoder_next_frame() */
+  gboolean              (* next_frame)                  (GdkAnimationDecoder    *self,
+                                                         GdkTexture            **texture,
+                                                         gint64                 *duration,
+                                                         GError                **error);
+};
+
+void                    gdk_animation_decoder_register          (const GdkAnimationDecoderClass *klass);
+
+GdkAnimationDecoder *   gdk_animation_decoder_new               (GBytes                 *bytes,
+                                                                 GError                **error);
+void                    gdk_animation_decoder_free              (GdkAnimationDecoder    *self);
+
+gboolean                gdk_animation_decoder_next_frame        (GdkAnimationDecoder    *self,
+                                                                 GdkTexture            **texture,
+                                                                 gint64                 *duration,
+                                                                 GError                **error);
+
+G_END_DECLS
@@ -0,0 +1,375 @@
+/* GDK - The GIMP Drawing Kit
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gdkcompressedtextureprivate.h"
+
+#include "gdkmemoryformatprivate.h"
+
+#include <string.h>
+
+/* A texture holding image data in one of the block compressed formats
+ * that GPUs can sample from directly.
+ *
+ * Renderers that support the format upload the blocks as they are,
+ * which keeps the image compressed in video memory. Everything else
+ * downloads the texture, which decodes it on the CPU.
+ */
+
+struct _GdkCompressedTexture
+{
+  GdkTexture parent_instance;
+
+  GdkCompressedFormat compressed_format;
+  GBytes *bytes;
+};
+
+struct _GdkCompressedTextureClass
+{
+  GdkTextureClass parent_class;
+};
+
+G_DEFINE_TYPE (GdkCompressedTexture, gdk_compressed_texture, GDK_TYPE_TEXTURE)
+
+/* {{{ Decoding */
+
+static void
+color_from_565 (guint16  color,
+                guchar  *rgba)
+{
+  guint r = (color >> 11) & 0x1f;
+  guint g = (color >> 5) & 0x3f;
+  guint b = color & 0x1f;
+
+  rgba[0] = (r << 3) | (r >> 2);
+  rgba[1] = (g << 2) | (g >> 4);
+  rgba[2] = (b << 3) | (b >> 2);
+  rgba[3] = 255;
+}
+
+/* Decodes the color part of a block, which is the whole block for BC1 and
+ * the second half for BC2 and BC3. Only BC1 has the 3 color mode with a
+ * transparent color.
+ */
+static void
+decode_color_block (const guchar *block,
+                    gboolean      allow_transparent,
+                    guchar        pixels[16][4])
+{
+  guchar palette[4][4];
+  guint16 c0, c1;
+  guint32 indices;
+  int i, j;
+
+  c0 = block[0] | (block[1] << 8);
+  c1 = block[2] | (block[3] << 8);
+  indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((guint32) block[7] << 24);
+
+  color_from_565 (c0, palette[0]);
+  color_from_565 (c1, palette[1]);
+
+  if (c0 > c1 || !allow_transparent)
+    {
+      for (j = 0; j < 3; j++)
+        {
+          palette[2][j] = (2 * palette[0][j] + palette[1][j]) / 3;
+          palette[3][j] = (palette[0][j] + 2 * palette[1][j]) / 3;
+        }
+      palette[2][3] = 255;
+      palette[3][3] = 255;
+    }
+  else
+    {
+      for (j = 0; j < 3; j++)
+        palette[2][j] = (palette[0][j] + palette[1][j]) / 2;
+      palette[2][3] = 255;
+      memset (palette[3], 0, 4);
+    }
+
+  for (i = 0; i < 16; i++)
+    memcpy (pixels[i], palette[(indices >> (2 * i)) & 3], 4);
+}
+
+static void
+decode_bc2_alpha (const guchar *block,
+                  guchar        pixels[16][4])
+{
+  int i;
+
+  for (i = 0; i < 16; i++)
+    {
+      guint a = (block[i / 2] >> (4 * (i % 2))) & 0xf;
+
+      pixels[i][3] = a * 17;
+    }
+}
+
+static void
+decode_bc3_alpha (const guchar *block,
+                  guchar        pixels[16][4])
+{
+  guchar alphas[8];
+  guint64 indices;
+  int i;
+
+  alphas[0] = block[0];
+  alphas[1] = block[1];
+
+  if (alphas[0] > alphas[1])
+    {
+      for (i = 1; i < 7; i++)
+        alphas[i + 1] = ((7 - i) * alphas[0] + i * alphas[1]) / 7;
+    }
+  else
+    {
+      for (i = 1; i < 5; i++)
+        alphas[i + 1] = ((5 - i) * alphas[0] + i * alphas[1]) / 5;
+      alphas[6] = 0;
+      alphas[7] = 255;
+    }
+
+  indices = 0;
+  for (i = 0; i < 6; i++)
+    indices |= (guint64) block[2 + i] << (8 * i);
+
+  for (i = 0; i < 16; i++)
+    pixels[i][3] = alphas[(indices >> (3 * i)) & 7];
+}
+
+static void
+decode_block (GdkCompressedFormat  format,
+              const guchar        *block,
+              guchar               pixels[16][4])
+{
+  switch (format)
+    {
+    case GDK_COMPRESSED_BC1:
+      decode_color_block (block, TRUE, pixels);
+      break;
+
+    case GDK_COMPRESSED_BC2:
+      decode_color_block (block + 8, FALSE, pixels);
+      decode_bc2_alpha (block, pixels);
+      break;
+
+    case GDK_COMPRESSED_BC3:
+      decode_color_block (block + 8, FALSE, pixels);
+      decode_bc3_alpha (block, pixels);
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+/* }}} */
+/* {{{ GdkTexture implementation */
+
+static void
+gdk_compressed_texture_dispose (GObject *object)
+{
+  GdkCompressedTexture *self = GDK_COMPRESSED_TEXTURE (object);
+
+  g_clear_pointer (&self->bytes, g_bytes_unref);
+
+  G_OBJECT_CLASS (gdk_compressed_texture_parent_class)->dispose (object);
+}
+
+static void
+gdk_compressed_texture_download (GdkTexture         *texture,
+                                 const GdkRectangle *area,
+                                 GdkMemoryFormat     format,
+                                 guchar             *data,
+                                 gsize               stride)
+{
+  GdkCompressedTexture *self = GDK_COMPRESSED_TEXTURE (texture);
+  gsize block_size, blocks_per_row, rgba_stride;
+  const guchar *blocks;
+  guchar *rgba;
+  int bx, by, x, y;
+
+  block_size = gdk_compressed_format_get_block_size (self->compressed_format);
+  blocks_per_row = (texture->width + 3) / 4;
+  blocks = g_bytes_get_data (self->bytes, NULL);
+
+  rgba_stride = area->width * 4;
+  rgba = g_malloc_n (area->height, rgba_stride);
+
+  for (by = area->y / 4; by * 4 < area->y + area->height; by++)
+    {
+      for (bx = area->x / 4; bx * 4 < area->x + area->width; bx++)
+        {
+          guchar pixels[16][4];
+
+          decode_block (self->compressed_format,
+                        blocks + (by * blocks_per_row + bx) * block_size,
+                        pixels);
+
+          for (y = MAX (by * 4, area->y); y < MIN (by * 4 + 4, area->y + area->height); y++)
+            for (x = MAX (bx * 4, area->x); x < MIN (bx * 4 + 4, area->x + area->width); x++)
+              memcpy (rgba + (y - area->y) * rgba_stride + (x - area->x) * 4,
+                      pixels[(y % 4) * 4 + x % 4],
+                      4);
+        }
+    }
+
+  gdk_memory_convert (data, stride,
+                      format,
+                      rgba, rgba_stride,
+                      texture->format,
+                      area->width,
+                      area->height);
+
+  g_free (rgba);
+}
+
+static void
+gdk_compressed_texture_class_init (GdkCompressedTextureClass *klass)
+{
+  GdkTextureClass *texture_class = GDK_TEXTURE_CLASS (klass);
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  texture_class->download = gdk_compressed_texture_download;
+
+  gobject_class->dispose = gdk_compressed_texture_dispose;
+}
+
+static void
+gdk_compressed_texture_init (GdkCompressedTexture *self)
+{
+}
+
+/* }}} */
+/* {{{ API */
+
+/*
+ * gdk_compressed_format_get_block_size:
+ * @format: a compressed format
+ *
+ * Returns: the size in bytes of one 4x4 block
+ */
+gsize
+gdk_compressed_format_get_block_size (GdkCompressedFormat format)
+{
+  switch (format)
+    {
+    case GDK_COMPRESSED_BC1:
+      return 8;
+
+    case GDK_COMPRESSED_BC2:
+    case GDK_COMPRESSED_BC3:
+      return 16;
+
+    default:
+      g_assert_not_reached ();
+      return 16;
+    }
+}
+
+/*
+ * gdk_compressed_format_get_data_size:
+ * @format: a compressed format
+ * @width: width of the image
+ * @height: height of the image
+ *
+ * Returns: the size in bytes of an image of the given size,
+ *   or 0 if it does not fit into memory
+ */
+gsize
+gdk_compressed_format_get_data_size (GdkCompressedFormat format,
+                                     gsize               width,
+                                     gsize               height)
+{
+  gsize blocks_x = (width + 3) / 4;
+  gsize blocks_y = (height + 3) / 4;
+  gsize size;
+
+  if (!g_size_checked_mul (&size, blocks_x, blocks_y) ||
+      !g_size_checked_mul (&size, size, gdk_compressed_format_get_block_size (format)))
+    return 0;
+
+  return size;
+}
+
+/*
+ * gdk_compressed_texture_new:
+ * @format: the compressed format of @bytes
+ * @premultiplied: whether the colors in @bytes are premultiplied
+ * @width: the width of the texture
+ * @height: the height of the texture
+ * @bytes: the blocks, row by row
+ *
+ * Creates a texture for block compressed image data. Partial blocks
+ * at the right and bottom edges are stored as full blocks.
+ *
+ * BC1 data is always treated as premultiplied, as its transparent
+ * pixels are black.
+ *
+ * Returns: (transfer full): a new texture
+ */
+GdkTexture *
+gdk_compressed_texture_new (GdkCompressedFormat  format,
+                            gboolean             premultiplied,
+                            int                  width,
+                            int                  height,
+                            GBytes              *bytes)
+{
+  GdkCompressedTexture *self;
+  gsize size;
+
+  g_return_val_if_fail (width > 0 && height > 0, NULL);
+  size = gdk_compressed_format_get_data_size (format, width, height);
+  g_return_val_if_fail (size > 0 && g_bytes_get_size (bytes) >= size, NULL);
+
+  self = g_object_new (GDK_TYPE_COMPRESSED_TEXTURE,
+                       "width", width,
+                       "height", height,
+                       NULL);
+
+  if (format == GDK_COMPRESSED_BC1 || premultiplied)
+    GDK_TEXTURE (self)->format = GDK_MEMORY_R8G8B8A8_PREMULTIPLIED;
+  else
+    GDK_TEXTURE (self)->format = GDK_MEMORY_R8G8B8A8;
+
+  self->compressed_format = format;
+  self->bytes = g_bytes_new_from_bytes (bytes, 0, size);
+
+  return GDK_TEXTURE (self);
+}
+
+GdkCompressedFormat
+gdk_compressed_texture_get_compressed_format (GdkCompressedTexture *self)
+{
+  return self->compressed_format;
+}
+
+/*
+ * gdk_compressed_texture_get_bytes:
+ * @self: a compressed texture
+ *
+ * Returns: (transfer none): the compressed blocks, exactly
+ *   gdk_compressed_format_get_data_size() bytes
+ */
+GBytes *
+gdk_compressed_texture_get_bytes (GdkCompressedTexture *self)
+{
+  return self->bytes;
+}
+
+/* }}} */
+
+/* vim:set foldmethod=marker expandtab: */
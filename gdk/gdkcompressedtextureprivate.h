@@ -0,0 +1,38 @@
+#pragma once
+
+#include "gdktextureprivate.h"
+
+G_BEGIN_DECLS
+
+/* The block compressed formats, in blocks of 4x4 pixels */
+typedef enum {
+  GDK_COMPRESSED_BC1,
+  GDK_COMPRESSED_BC2,
+  GDK_COMPRESSED_BC3,
+} GdkCompressedFormat;
+
+#define GDK_TYPE_COMPRESSED_TEXTURE (gdk_compressed_texture_get_type ())
+
+#define GDK_COMPRESSED_TEXTURE(obj)         (G_TYPE_CHECK_INSTANCE_CAST ((obj), GDK_TYPE_COMPRESSED_TEXTURE, GdkCompressedTexture))
+#define GDK_IS_COMPRESSED_TEXTURE(obj)      (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GDK_TYPE_COMPRESSED_TEXTURE))
+
+typedef struct _GdkCompressedTexture      GdkCompressedTexture;
+typedef struct _GdkCompressedTextureClass GdkCompressedTextureClass;
+
+GType                   gdk_compressed_texture_get_type                 (void) G_GNUC_CONST;
+
+gsize                   gdk_compressed_format_get_block_size            (GdkCompressedFormat     format);
+gsize                   gdk_compressed_format_get_data_size             (GdkCompressedFormat     format,
+                                                                         gsize                   width,
+                                                                         gsize                   height);
+
+GdkTexture *            gdk_compressed_texture_new                      (GdkCompressedFormat     format,
+                                                                         gboolean                premultiplied,
+                                                                         int                     width,
+                                                                         int                     height,
+                                                                         GBytes                 *bytes);
+
+GdkCompressedFormat     gdk_compressed_texture_get_compressed_format    (GdkCompressedTexture   *self);
+GBytes *                gdk_compressed_texture_get_bytes                (GdkCompressedTexture   *self);
+
+G_END_DECLS
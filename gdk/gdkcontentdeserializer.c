@@ -658,6 +658,44 @@ pixbuf_deserializer (GdkContentDeserializer *deserializer)
                                     deserializer);
 }
 
+static void
+texture_decode_finish (GObject      *source,
+                       GAsyncResult *res,
+                       gpointer      user_data)
+{
+  GdkContentDeserializer *deserializer = GDK_CONTENT_DESERIALIZER (source);
+  GdkTexture *texture;
+  GError *error = NULL;
+
+  texture = g_task_propagate_pointer (G_TASK (res), &error);
+  if (texture == NULL)
+    {
+      gdk_content_deserializer_return_error (deserializer, error);
+      return;
+    }
+
+  g_value_take_object (gdk_content_deserializer_get_value (deserializer), texture);
+  gdk_content_deserializer_return_success (deserializer);
+}
+
+static void
+decode_texture_in_thread (GTask        *task,
+                          gpointer      source_object,
+                          gpointer      task_data,
+                          GCancellable *cancellable)
+{
+  GBytes *bytes = task_data;
+  GdkTexture *texture;
+  GError *error = NULL;
+
+  texture = gdk_texture_new_from_bytes (bytes, &error);
+
+  if (texture)
+    g_task_return_pointer (task, texture, g_object_unref);
+  else
+    g_task_return_error (task, error);
+}
+
 static void
 texture_deserializer_finish (GObject      *source,
                              GAsyncResult *result,
@@ -666,7 +704,7 @@ texture_deserializer_finish (GObject      *source,
   GOutputStream *stream = G_OUTPUT_STREAM (source);
   GBytes *bytes;
   GError *error = NULL;
-  GdkTexture *texture = NULL;
+  GTask *task;
   gssize written;
 
   written = g_output_stream_splice_finish (stream, result, &error);
@@ -678,16 +716,15 @@ texture_deserializer_finish (GObject      *source,
 
   bytes = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (stream));
 
-  texture = gdk_texture_new_from_bytes (bytes, &error);
-  g_bytes_unref (bytes);
-  if (texture == NULL)
-    {
-      gdk_content_deserializer_return_error (deserializer, error);
-      return;
-    }
-
-  g_value_take_object (gdk_content_deserializer_get_value (deserializer), texture);
-  gdk_content_deserializer_return_success (deserializer);
+  /* Decoding large images takes a while, don't block the main loop */
+  task = g_task_new (deserializer,
+                     gdk_content_deserializer_get_cancellable (deserializer),
+                     texture_decode_finish,
+                     NULL);
+  g_task_set_priority (task, gdk_content_deserializer_get_priority (deserializer));
+  g_task_set_task_data (task, bytes, (GDestroyNotify) g_bytes_unref);
+  g_task_run_in_thread (task, decode_texture_in_thread);
+  g_object_unref (task);
 }
 
 static void
@@ -40,10 +40,12 @@ typedef enum {
   GDK_DEBUG_OFFLOAD         = 1 << 12,
 
   /* flags below are influencing behavior */
+  GDK_DEBUG_WAYLAND_READ_THREAD = 1 << 13,
   GDK_DEBUG_PORTALS         = 1 << 14,
   GDK_DEBUG_NO_PORTALS      = 1 << 15,
   GDK_DEBUG_GL_DISABLE      = 1 << 16,
   GDK_DEBUG_GL_NO_FRACTIONAL= 1 << 17,
+  GDK_DEBUG_FRAME_DEADLINE  = 1 << 18,
 
   GDK_DEBUG_GL_DISABLE_GL   = 1 << 19,
   GDK_DEBUG_GL_DISABLE_GLES = 1 << 20,
@@ -0,0 +1,155 @@
+#include "config.h"
+
+#include "gdkdecodeschedulerprivate.h"
+
+/* A shared scheduler for decoding images in threads.
+ *
+ * Unlike g_task_run_in_thread(), it uses a bounded number of threads,
+ * so that image loads can't starve other users of the GTask pool. Jobs
+ * are picked by their task's priority when a thread becomes free, not
+ * when they are queued, so a caller can boost jobs that become visible
+ * while waiting. Jobs whose cancellable was triggered are dropped
+ * without running.
+ */
+
+#define MAX_DECODE_THREADS 4
+
+typedef struct _DecodeJob DecodeJob;
+
+struct _DecodeJob
+{
+  GTask *task;
+  GTaskThreadFunc task_func;
+  guint64 serial;
+};
+
+static GMutex scheduler_lock;
+static GQueue pending_jobs = G_QUEUE_INIT;
+static guint64 next_serial;
+
+static inline gboolean
+decode_job_is_before (DecodeJob *a,
+                      DecodeJob *b)
+{
+  int pa = g_task_get_priority (a->task);
+  int pb = g_task_get_priority (b->task);
+
+  if (pa != pb)
+    return pa < pb;
+
+  return a->serial < b->serial;
+}
+
+static void
+gdk_decode_scheduler_thread_func (gpointer data,
+                                  gpointer unused)
+{
+  DecodeJob *job = NULL;
+  GList *dropped = NULL;
+  GList *l, *next;
+
+  g_mutex_lock (&scheduler_lock);
+
+  for (l = pending_jobs.head; l; l = next)
+    {
+      DecodeJob *pending = l->data;
+
+      next = l->next;
+
+      if (g_cancellable_is_cancelled (g_task_get_cancellable (pending->task)))
+        {
+          g_queue_unlink (&pending_jobs, l);
+          dropped = g_list_concat (l, dropped);
+        }
+      else if (job == NULL || decode_job_is_before (pending, job))
+        {
+          job = pending;
+        }
+    }
+
+  if (job)
+    g_queue_remove (&pending_jobs, job);
+
+  g_mutex_unlock (&scheduler_lock);
+
+  for (l = dropped; l; l = l->next)
+    {
+      DecodeJob *pending = l->data;
+
+      g_task_return_error_if_cancelled (pending->task);
+      g_object_unref (pending->task);
+      g_free (pending);
+    }
+  g_list_free (dropped);
+
+  if (job == NULL)
+    return;
+
+  job->task_func (job->task,
+                  g_task_get_source_object (job->task),
+                  g_task_get_task_data (job->task),
+                  g_task_get_cancellable (job->task));
+
+  g_object_unref (job->task);
+  g_free (job);
+}
+
+/*
+ * gdk_decode_scheduler_run:
+ * @task: the task to run
+ * @task_func: the function to run in a thread
+ *
+ * Runs @task_func in one of the decoding threads, like
+ * g_task_run_in_thread() would.
+ *
+ * Pending tasks are run in order of their priority, see
+ * g_task_set_priority(). Tasks that are cancelled before they start
+ * return %G_IO_ERROR_CANCELLED without running @task_func.
+ */
+void
+gdk_decode_scheduler_run (GTask           *task,
+                          GTaskThreadFunc  task_func)
+{
+  static GThreadPool *pool;
+  DecodeJob *job;
+
+  if (g_once_init_enter (&pool))
+    {
+      GThreadPool *the_pool = g_thread_pool_new (gdk_decode_scheduler_thread_func,
+                                                 NULL,
+                                                 CLAMP (g_get_num_processors () - 1, 1, MAX_DECODE_THREADS),
+                                                 FALSE,
+                                                 NULL);
+      g_once_init_leave (&pool, the_pool);
+    }
+
+  job = g_new (DecodeJob, 1);
+  job->task = g_object_ref (task);
+  job->task_func = task_func;
+
+  g_mutex_lock (&scheduler_lock);
+  job->serial = next_serial++;
+  g_queue_push_tail (&pending_jobs, job);
+  g_mutex_unlock (&scheduler_lock);
+
+  /* Every push lets a thread pick one job, the best at that time */
+  g_thread_pool_push (pool, GUINT_TO_POINTER (1), NULL);
+}
+
+/*
+ * gdk_decode_scheduler_set_priority:
+ * @task: a task passed to gdk_decode_scheduler_run()
+ * @priority: the new priority
+ *
+ * Changes the priority of @task. If @task has not started yet, this
+ * affects when it runs, so it can be used to boost loads for items
+ * that became visible.
+ */
+void
+gdk_decode_scheduler_set_priority (GTask *task,
+                                   int    priority)
+{
+  g_mutex_lock (&scheduler_lock);
+  g_task_set_priority (task, priority);
+  g_mutex_unlock (&scheduler_lock);
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+void                    gdk_decode_scheduler_run                (GTask                  *task,
+                                                                 GTaskThreadFunc         task_func);
+void                    gdk_decode_scheduler_set_priority       (GTask                  *task,
+                                                                 int                     priority);
+
+G_END_DECLS
@@ -351,6 +351,7 @@ gdk_device_finalize (GObject *object)
   g_clear_pointer (&device->name, g_free);
   g_clear_pointer (&device->vendor_id, g_free);
   g_clear_pointer (&device->product_id, g_free);
+  g_clear_pointer (&device->history, g_free);
 
   G_OBJECT_CLASS (gdk_device_parent_class)->finalize (object);
 }
@@ -1356,6 +1357,90 @@ gdk_device_set_timestamp (GdkDevice *device,
   device->timestamp = timestamp;
 }
 
+/*<private>
+ * gdk_device_push_history:
+ * @device: a `GdkDevice`
+ * @surface: the surface that @coord is relative to
+ * @coord: the sample
+ *
+ * Records a sample in the motion history of @device.
+ *
+ * The history is a ring buffer that is allocated once, so recording
+ * does not allocate, no matter how many samples the device sends.
+ *
+ * Returns: the serial of the sample, for gdk_device_get_history()
+ */
+guint32
+gdk_device_push_history (GdkDevice          *device,
+                         GdkSurface         *surface,
+                         const GdkTimeCoord *coord)
+{
+  GdkDeviceHistoryEntry *entry;
+
+  if (G_UNLIKELY (device->history == NULL))
+    device->history = g_new0 (GdkDeviceHistoryEntry, GDK_DEVICE_HISTORY_SIZE);
+
+  /* 0 means "no serial" */
+  device->history_serial++;
+  if (G_UNLIKELY (device->history_serial == 0))
+    device->history_serial++;
+
+  entry = &device->history[device->history_serial % GDK_DEVICE_HISTORY_SIZE];
+  entry->serial = device->history_serial;
+  entry->surface = surface;
+  entry->coord = *coord;
+
+  return device->history_serial;
+}
+
+/*<private>
+ * gdk_device_get_history:
+ * @device: a `GdkDevice`
+ * @surface: the surface to get samples for
+ * @first_serial: the serial of the first sample
+ * @last_serial: the serial of the last sample
+ * @coords: (element-type GdkTimeCoord): array to append the samples to
+ *
+ * Appends the samples between @first_serial and @last_serial, inclusive,
+ * that were recorded for @surface.
+ *
+ * If some of the samples have already been overwritten, @coords
+ * is left unchanged.
+ *
+ * Returns: %TRUE if all samples were still in the history
+ */
+gboolean
+gdk_device_get_history (GdkDevice  *device,
+                        GdkSurface *surface,
+                        guint32     first_serial,
+                        guint32     last_serial,
+                        GArray     *coords)
+{
+  guint32 i;
+
+  if (device->history == NULL ||
+      last_serial < first_serial ||
+      last_serial - first_serial >= GDK_DEVICE_HISTORY_SIZE)
+    return FALSE;
+
+  /* Samples are overwritten in order, so if the first one is still
+   * there, so are all the others
+   */
+  if (device->history[first_serial % GDK_DEVICE_HISTORY_SIZE].serial != first_serial ||
+      device->history[last_serial % GDK_DEVICE_HISTORY_SIZE].serial != last_serial)
+    return FALSE;
+
+  for (i = 0; i <= last_serial - first_serial; i++)
+    {
+      const GdkDeviceHistoryEntry *entry = &device->history[(first_serial + i) % GDK_DEVICE_HISTORY_SIZE];
+
+      if (entry->surface == surface)
+        g_array_append_val (coords, entry->coord);
+    }
+
+  return TRUE;
+}
+
 /**
  * gdk_device_get_timestamp:
  * @device: a `GdkDevice`
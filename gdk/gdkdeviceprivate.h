@@ -24,6 +24,18 @@
 
 G_BEGIN_DECLS
 
+/* About half a second of samples from a 2kHz tablet */
+#define GDK_DEVICE_HISTORY_SIZE 1024
+
+typedef struct _GdkDeviceHistoryEntry GdkDeviceHistoryEntry;
+
+struct _GdkDeviceHistoryEntry
+{
+  guint32 serial;
+  GdkSurface *surface; /* only compared, not referenced */
+  GdkTimeCoord coord;
+};
+
 typedef enum
 {
   GDK_GRAB_SUCCESS         = 0,
@@ -90,6 +102,10 @@ struct _GdkDevice
   GdkDeviceTool *last_tool;
 
   guint32 timestamp;
+
+  /* Ring buffer of the last GDK_DEVICE_HISTORY_SIZE tool motions */
+  GdkDeviceHistoryEntry *history;
+  guint32 history_serial;
 };
 
 struct _GdkDeviceClass
@@ -193,6 +209,15 @@ GdkAxisUse gdk_device_get_axis_use  (GdkDevice         *device,
 void gdk_device_set_timestamp (GdkDevice *device,
                                guint32    timestamp);
 
+guint32  gdk_device_push_history (GdkDevice          *device,
+                                  GdkSurface         *surface,
+                                  const GdkTimeCoord *coord);
+gboolean gdk_device_get_history  (GdkDevice          *device,
+                                  GdkSurface         *surface,
+                                  guint32             first_serial,
+                                  guint32             last_serial,
+                                  GArray             *coords);
+
 gboolean gdk_device_grab_info (GdkDisplay  *display,
                                GdkDevice   *device,
                                GdkSurface  **grab_surface,
@@ -405,6 +405,10 @@ gdk_display_init (GdkDisplay *display)
 
   g_queue_init (&display->queued_events);
 
+  g_mutex_init (&display->egl_image_cache_lock);
+  g_queue_init (&display->egl_image_cache);
+  g_mutex_init (&display->dmabuf_download_stats_lock);
+
   priv->debug_flags = _gdk_debug_flags;
 
   priv->composited = TRUE;
@@ -435,6 +439,10 @@ gdk_display_dispose (GObject *object)
 
   g_clear_pointer (&display->egl_dmabuf_formats, gdk_dmabuf_formats_unref);
   g_clear_pointer (&display->egl_external_formats, gdk_dmabuf_formats_unref);
+#if defined (HAVE_DMABUF) && defined (HAVE_EGL)
+  gdk_dmabuf_egl_clear_image_cache (display);
+#endif
+  gdk_dmabuf_texture_print_download_stats (display);
 #ifdef GDK_RENDERING_VULKAN
   if (display->vk_dmabuf_formats)
     {
@@ -471,6 +479,10 @@ gdk_display_finalize (GObject *object)
 
   g_clear_pointer (&display->dmabuf_formats, gdk_dmabuf_formats_unref);
 
+  g_mutex_clear (&display->egl_image_cache_lock);
+  g_clear_pointer (&display->dmabuf_download_stats, g_hash_table_unref);
+  g_mutex_clear (&display->dmabuf_download_stats_lock);
+
   G_OBJECT_CLASS (gdk_display_parent_class)->finalize (object);
 }
 
@@ -50,6 +50,7 @@ typedef enum {
   GDK_VULKAN_FEATURE_SEMAPHORE_EXPORT           = 1 << 5,
   GDK_VULKAN_FEATURE_SEMAPHORE_IMPORT           = 1 << 6,
   GDK_VULKAN_FEATURE_INCREMENTAL_PRESENT        = 1 << 7,
+  GDK_VULKAN_FEATURE_MEMORY_BUDGET              = 1 << 8,
 } GdkVulkanFeatures;
 
 /* Tracks information about the device grab on this display */
@@ -137,6 +138,14 @@ struct _GdkDisplay
    /* Cached data the EGL dmabuf downloader */
   GdkDmabufFormats *egl_dmabuf_formats;
   GdkDmabufFormats *egl_external_formats;
+
+  /* EGLImages of recently imported dmabufs, most recent first */
+  GMutex egl_image_cache_lock;
+  GQueue egl_image_cache;
+
+  /* How often dmabufs of each format were downloaded to the CPU */
+  GMutex dmabuf_download_stats_lock;
+  GHashTable *dmabuf_download_stats;
 };
 
 struct _GdkDisplayClass
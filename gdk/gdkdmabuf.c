@@ -1981,10 +1981,15 @@ gdk_dmabuf_get_mmap_formats (void)
 }
 
 static void
-gdk_dmabuf_do_download_mmap (GdkTexture *texture,
-                             guchar     *data,
-                             gsize       stride)
+gdk_dmabuf_do_download_mmap (GdkTexture         *texture,
+                             const GdkRectangle *area,
+                             GdkMemoryFormat     format,
+                             guchar             *data,
+                             gsize               stride)
 {
+  GdkMemoryFormat src_format = gdk_texture_get_format (texture);
+  unsigned int width = gdk_texture_get_width (texture);
+  unsigned int height = gdk_texture_get_height (texture);
   const GdkDrmFormatInfo *info;
   const GdkDmabuf *dmabuf;
   const guchar *src_data[GDK_DMABUF_MAX_PLANES];
@@ -1998,8 +2003,8 @@ gdk_dmabuf_do_download_mmap (GdkTexture *texture,
   g_return_if_fail (info && info->download);
 
   GDK_DISPLAY_DEBUG (gdk_dmabuf_texture_get_display (GDK_DMABUF_TEXTURE (texture)), DMABUF,
-                     "Using mmap for downloading %dx%d dmabuf (format %.4s:%#" G_GINT64_MODIFIER "x)",
-                     gdk_texture_get_width (texture), gdk_texture_get_height (texture),
+                     "Using mmap for downloading %dx%d of %dx%d dmabuf (format %.4s:%#" G_GINT64_MODIFIER "x)",
+                     area->width, area->height, width, height,
                      (char *)&dmabuf->fourcc, dmabuf->modifier);
 
   for (i = 0; i < dmabuf->n_planes; i++)
@@ -2037,14 +2042,61 @@ gdk_dmabuf_do_download_mmap (GdkTexture *texture,
       needs_unmap[i] = TRUE;
     }
 
-    info->download (data,
-                    stride,
-                    gdk_texture_get_format (texture),
-                    gdk_texture_get_width (texture),
-                    gdk_texture_get_height (texture),
-                    dmabuf,
-                    src_data,
-                    sizes);
+  if (format == src_format &&
+      area->x == 0 && area->y == 0 &&
+      area->width == width && area->height == height)
+    {
+      info->download (data,
+                      stride,
+                      src_format,
+                      width,
+                      height,
+                      dmabuf,
+                      src_data,
+                      sizes);
+    }
+  else if (info->download == download_memcpy)
+    {
+      /* Single plane formats can be converted straight from the
+       * mapping, so only the pages of the area get touched
+       */
+      gsize src_stride = dmabuf->planes[0].stride;
+      gsize bpp = gdk_memory_format_bytes_per_pixel (src_format);
+
+      if (sizes[0] < dmabuf->planes[0].offset + (area->y + area->height - 1) * src_stride +
+                     (area->x + area->width) * bpp)
+        {
+          g_warning ("dmabuf is too small for its size");
+          goto out;
+        }
+
+      gdk_memory_convert (data, stride, format,
+                          src_data[0] + dmabuf->planes[0].offset + area->y * src_stride + area->x * bpp,
+                          src_stride, src_format,
+                          area->width, area->height);
+    }
+  else
+    {
+      gsize bpp = gdk_memory_format_bytes_per_pixel (src_format);
+      gsize tmp_stride = width * bpp;
+      guchar *tmp_data = g_malloc_n (tmp_stride, height);
+
+      info->download (tmp_data,
+                      tmp_stride,
+                      src_format,
+                      width,
+                      height,
+                      dmabuf,
+                      src_data,
+                      sizes);
+
+      gdk_memory_convert (data, stride, format,
+                          tmp_data + area->y * tmp_stride + area->x * bpp,
+                          tmp_stride, src_format,
+                          area->width, area->height);
+
+      g_free (tmp_data);
+    }
 
 out:
   for (i = 0; i < dmabuf->n_planes; i++)
@@ -2060,35 +2112,13 @@ out:
 }
 
 void
-gdk_dmabuf_download_mmap (GdkTexture      *texture,
-                          GdkMemoryFormat  format,
-                          guchar          *data,
-                          gsize            stride)
+gdk_dmabuf_download_mmap (GdkTexture         *texture,
+                          const GdkRectangle *area,
+                          GdkMemoryFormat     format,
+                          guchar             *data,
+                          gsize               stride)
 {
-  GdkMemoryFormat src_format = gdk_texture_get_format (texture);
-
-  if (format == src_format)
-    gdk_dmabuf_do_download_mmap (texture, data, stride);
-  else
-    {
-      unsigned int width, height;
-      guchar *src_data;
-      gsize src_stride;
-
-      width = gdk_texture_get_width (texture);
-      height = gdk_texture_get_height (texture);
-
-      src_stride = width * gdk_memory_format_bytes_per_pixel (src_format);
-      src_data = g_new (guchar, src_stride * height);
-
-      gdk_dmabuf_do_download_mmap (texture, src_data, src_stride);
-
-      gdk_memory_convert (data, stride, format,
-                          src_data, src_stride, src_format,
-                          width, height);
-
-      g_free (src_data);
-    }
+  gdk_dmabuf_do_download_mmap (texture, area, format, data, stride);
 }
 
 int
@@ -31,6 +31,8 @@
 #include "gdktexturedownloader.h"
 
 #include <graphene.h>
+#include <string.h>
+#include <sys/stat.h>
 
 /* A dmabuf downloader implementation that downloads buffers via
  * gsk_renderer_render_texture + GL texture download.
@@ -283,4 +285,158 @@ gdk_dmabuf_egl_create_image (GdkDisplay      *display,
   return image;
 }
 
+/* {{{ Image cache */
+
+/* Video players recycle a small pool of buffers, wrapping them in new
+ * textures every frame. Importing is expensive, so we keep the images
+ * of the last few buffers around and find them again by the identity
+ * of their planes' files and their layout.
+ *
+ * As a cached image keeps its dmabuf alive, the inode of a cached
+ * buffer can't be reused for a different buffer.
+ */
+#define EGL_IMAGE_CACHE_SIZE 16
+
+typedef struct
+{
+  dev_t dev;
+  ino_t ino;
+  unsigned int offset;
+  unsigned int stride;
+} EglImageCachePlane;
+
+typedef struct
+{
+  int width;
+  int height;
+  guint32 fourcc;
+  guint64 modifier;
+  unsigned int n_planes;
+  EglImageCachePlane planes[GDK_DMABUF_MAX_PLANES];
+
+  EGLImage image;
+} EglImageCacheEntry;
+
+static gboolean
+egl_image_cache_key_init (EglImageCacheEntry *key,
+                          int                 width,
+                          int                 height,
+                          const GdkDmabuf    *dmabuf)
+{
+  unsigned int i;
+
+  memset (key, 0, sizeof (EglImageCacheEntry));
+  key->width = width;
+  key->height = height;
+  key->fourcc = dmabuf->fourcc;
+  key->modifier = dmabuf->modifier;
+  key->n_planes = dmabuf->n_planes;
+
+  for (i = 0; i < dmabuf->n_planes; i++)
+    {
+      struct stat st;
+
+      if (fstat (dmabuf->planes[i].fd, &st) != 0)
+        return FALSE;
+
+      key->planes[i].dev = st.st_dev;
+      key->planes[i].ino = st.st_ino;
+      key->planes[i].offset = dmabuf->planes[i].offset;
+      key->planes[i].stride = dmabuf->planes[i].stride;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+egl_image_cache_key_equal (const EglImageCacheEntry *a,
+                           const EglImageCacheEntry *b)
+{
+  return memcmp (a, b, G_STRUCT_OFFSET (EglImageCacheEntry, image)) == 0;
+}
+
+/*
+ * gdk_dmabuf_egl_get_cached_image:
+ *
+ * Like gdk_dmabuf_egl_create_image(), but reuses the image of a
+ * previous import of the same buffer.
+ *
+ * The image is owned by the cache and must not be destroyed.
+ */
+EGLImage
+gdk_dmabuf_egl_get_cached_image (GdkDisplay      *display,
+                                 int              width,
+                                 int              height,
+                                 const GdkDmabuf *dmabuf,
+                                 int              target)
+{
+  EglImageCacheEntry key, *entry;
+  EGLImage image;
+  GList *l;
+
+  if (!egl_image_cache_key_init (&key, width, height, dmabuf))
+    return gdk_dmabuf_egl_create_image (display, width, height, dmabuf, target);
+
+  g_mutex_lock (&display->egl_image_cache_lock);
+
+  for (l = display->egl_image_cache.head; l; l = l->next)
+    {
+      entry = l->data;
+
+      if (egl_image_cache_key_equal (entry, &key))
+        {
+          g_queue_unlink (&display->egl_image_cache, l);
+          g_queue_push_head_link (&display->egl_image_cache, l);
+          image = entry->image;
+          g_mutex_unlock (&display->egl_image_cache_lock);
+
+          GDK_DISPLAY_DEBUG (display, DMABUF,
+                             "Reusing EGLImage for dmabuf (format: %.4s:%#" G_GINT64_MODIFIER "x)",
+                             (char *) &dmabuf->fourcc, dmabuf->modifier);
+          return image;
+        }
+    }
+
+  image = gdk_dmabuf_egl_create_image (display, width, height, dmabuf, target);
+  if (image == EGL_NO_IMAGE)
+    {
+      g_mutex_unlock (&display->egl_image_cache_lock);
+      return EGL_NO_IMAGE;
+    }
+
+  entry = g_memdup2 (&key, sizeof (EglImageCacheEntry));
+  entry->image = image;
+  g_queue_push_head (&display->egl_image_cache, entry);
+
+  while (g_queue_get_length (&display->egl_image_cache) > EGL_IMAGE_CACHE_SIZE)
+    {
+      entry = g_queue_pop_tail (&display->egl_image_cache);
+      eglDestroyImageKHR (gdk_display_get_egl_display (display), entry->image);
+      g_free (entry);
+    }
+
+  g_mutex_unlock (&display->egl_image_cache_lock);
+
+  return image;
+}
+
+void
+gdk_dmabuf_egl_clear_image_cache (GdkDisplay *display)
+{
+  EGLDisplay egl_display = gdk_display_get_egl_display (display);
+  EglImageCacheEntry *entry;
+
+  g_mutex_lock (&display->egl_image_cache_lock);
+
+  while ((entry = g_queue_pop_head (&display->egl_image_cache)))
+    {
+      eglDestroyImageKHR (egl_display, entry->image);
+      g_free (entry);
+    }
+
+  g_mutex_unlock (&display->egl_image_cache_lock);
+}
+
+/* }}} */
+
 #endif  /* HAVE_DMABUF && HAVE_EGL */
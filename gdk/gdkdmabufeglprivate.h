@@ -14,5 +14,11 @@ EGLImage                    gdk_dmabuf_egl_create_image         (GdkDisplay
                                                                  int                             height,
                                                                  const GdkDmabuf                *dmabuf,
                                                                  int                             target);
+EGLImage                    gdk_dmabuf_egl_get_cached_image     (GdkDisplay                     *display,
+                                                                 int                             width,
+                                                                 int                             height,
+                                                                 const GdkDmabuf                *dmabuf,
+                                                                 int                             target);
+void                        gdk_dmabuf_egl_clear_image_cache    (GdkDisplay                     *display);
 
 #endif  /* HAVE_DMABUF && HAVE_EGL */
@@ -26,6 +26,7 @@ struct _GdkDmabuf
 
 GdkDmabufFormats *          gdk_dmabuf_get_mmap_formats         (void) G_GNUC_CONST;
 void                        gdk_dmabuf_download_mmap            (GdkTexture                     *texture,
+                                                                 const GdkRectangle             *area,
                                                                  GdkMemoryFormat                 format,
                                                                  guchar                         *data,
                                                                  gsize                           stride);
@@ -25,6 +25,7 @@
 #include "gdkdmabufformatsbuilderprivate.h"
 #include "gdkdmabuffourccprivate.h"
 #include "gdkdmabufprivate.h"
+#include "gdkprofilerprivate.h"
 #include "gdktextureprivate.h"
 #include <gdk/gdkglcontext.h>
 #include <gdk/gdkgltexturebuilder.h>
@@ -106,11 +107,80 @@ gdk_dmabuf_texture_invoke_callback (gpointer data)
   return FALSE;
 }
 
+/* Downloads happen when renderers can't import a dmabuf, so we keep
+ * track of the formats they happen for.
+ */
+static void
+gdk_dmabuf_texture_record_download (GdkDmabufTexture *self,
+                                    const char       *method)
+{
+  static guint downloads_counter;
+  static int n_downloads;
+  GdkDisplay *display = self->display;
+  char *key;
+  guint count;
+
+  if (downloads_counter == 0)
+    downloads_counter = gdk_profiler_define_int_counter ("dmabuf-downloads", "Number of dmabuf textures downloaded to memory");
+
+  gdk_profiler_set_int_counter (downloads_counter, g_atomic_int_add (&n_downloads, 1) + 1);
+
+  GDK_DISPLAY_DEBUG (display, DMABUF,
+                     "Downloading %dx%d %.4s:%#" G_GINT64_MODIFIER "x dmabuf via %s",
+                     gdk_texture_get_width (GDK_TEXTURE (self)),
+                     gdk_texture_get_height (GDK_TEXTURE (self)),
+                     (char *) &self->dmabuf.fourcc, self->dmabuf.modifier,
+                     method);
+
+  key = g_strdup_printf ("%.4s:%#" G_GINT64_MODIFIER "x via %s",
+                         (char *) &self->dmabuf.fourcc, self->dmabuf.modifier,
+                         method);
+
+  g_mutex_lock (&display->dmabuf_download_stats_lock);
+
+  if (display->dmabuf_download_stats == NULL)
+    display->dmabuf_download_stats = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  count = GPOINTER_TO_UINT (g_hash_table_lookup (display->dmabuf_download_stats, key));
+  g_hash_table_replace (display->dmabuf_download_stats, key, GUINT_TO_POINTER (count + 1));
+
+  g_mutex_unlock (&display->dmabuf_download_stats_lock);
+}
+
+/*
+ * gdk_dmabuf_texture_print_download_stats:
+ * @display: a `GdkDisplay`
+ *
+ * Prints how often dmabuf textures of each format and modifier were
+ * downloaded to memory, if dmabuf debugging is enabled.
+ */
+void
+gdk_dmabuf_texture_print_download_stats (GdkDisplay *display)
+{
+  GHashTableIter iter;
+  gpointer key, value;
+
+  if (!GDK_DISPLAY_DEBUG_CHECK (display, DMABUF))
+    return;
+
+  g_mutex_lock (&display->dmabuf_download_stats_lock);
+
+  if (display->dmabuf_download_stats)
+    {
+      g_hash_table_iter_init (&iter, display->dmabuf_download_stats);
+      while (g_hash_table_iter_next (&iter, &key, &value))
+        gdk_debug_message ("dmabuf downloads: %s: %u", (char *) key, GPOINTER_TO_UINT (value));
+    }
+
+  g_mutex_unlock (&display->dmabuf_download_stats_lock);
+}
+
 static void
-gdk_dmabuf_texture_download (GdkTexture      *texture,
-                             GdkMemoryFormat  format,
-                             guchar          *data,
-                             gsize            stride)
+gdk_dmabuf_texture_download (GdkTexture         *texture,
+                             const GdkRectangle *area,
+                             GdkMemoryFormat     format,
+                             guchar             *data,
+                             gsize               stride)
 {
   GdkDmabufTexture *self = GDK_DMABUF_TEXTURE (texture);
   Download download = { self, format, data, stride, 0 };
@@ -118,11 +188,22 @@ gdk_dmabuf_texture_download (GdkTexture      *texture,
   if (self->downloader == NULL)
     {
 #ifdef HAVE_DMABUF
-      gdk_dmabuf_download_mmap (texture, format, data, stride);
+      gdk_dmabuf_texture_record_download (self, "mmap");
+      gdk_dmabuf_download_mmap (texture, area, format, data, stride);
 #endif
       return;
     }
 
+  /* The downloaders render the whole dmabuf */
+  if (area->x != 0 || area->y != 0 ||
+      area->width != texture->width || area->height != texture->height)
+    {
+      gdk_texture_download_area_fallback (texture, area, format, data, stride);
+      return;
+    }
+
+  gdk_dmabuf_texture_record_download (self, G_OBJECT_TYPE_NAME (self->downloader));
+
   g_main_context_invoke (NULL, gdk_dmabuf_texture_invoke_callback, &download);
 
   while (g_atomic_int_get (&download.spinlock) == 0);
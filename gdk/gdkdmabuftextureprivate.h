@@ -17,5 +17,8 @@ GdkTexture *            gdk_dmabuf_texture_new_from_builder (GdkDmabufTextureBui
 GdkDisplay *            gdk_dmabuf_texture_get_display      (GdkDmabufTexture        *self);
 const GdkDmabuf *       gdk_dmabuf_texture_get_dmabuf       (GdkDmabufTexture        *self);
 
+void                    gdk_dmabuf_texture_print_download_stats
+                                                            (GdkDisplay              *display);
+
 G_END_DECLS
 
@@ -24,6 +24,7 @@
 
 #include "config.h"
 
+#include "gdkdeviceprivate.h"
 #include "gdkdisplayprivate.h"
 #include "gdkdragprivate.h"
 #include "gdkdropprivate.h"
@@ -546,10 +547,29 @@ _gdk_event_queue_find_first (GdkDisplay *display)
  *
  * Returns: the newly appended list node.
  */
+static void gdk_motion_event_get_time_coord (GdkEvent     *event,
+                                             GdkTimeCoord *hist);
+
 GList *
 _gdk_event_queue_append (GdkDisplay *display,
 			 GdkEvent   *event)
 {
+  /* Record every tool motion in the device history before motion
+   * compression gets to drop any of them
+   */
+  if (event->event_type == GDK_MOTION_NOTIFY &&
+      event->device != NULL &&
+      ((GdkMotionEvent *) event)->tool != NULL &&
+      ((GdkMotionEvent *) event)->history_serial == 0)
+    {
+      GdkTimeCoord hist;
+
+      gdk_motion_event_get_time_coord (event, &hist);
+      ((GdkMotionEvent *) event)->history_serial = gdk_device_push_history (event->device,
+                                                                            event->surface,
+                                                                            &hist);
+    }
+
   g_queue_push_tail (&display->queued_events, event);
 
   return g_queue_peek_tail_link (&display->queued_events);
@@ -730,48 +750,55 @@ gdk_event_queue_handle_scroll_compression (GdkDisplay *display)
 }
 
 static void
-gdk_motion_event_push_history (GdkEvent *event,
-                               GdkEvent *history_event)
+gdk_motion_event_get_time_coord (GdkEvent     *event,
+                                 GdkTimeCoord *hist)
 {
-  GdkMotionEvent *self = (GdkMotionEvent *) event;
   GdkDeviceTool *tool;
-  GdkTimeCoord hist;
   int i;
 
-  g_assert (GDK_IS_EVENT_TYPE (event, GDK_MOTION_NOTIFY));
-  g_assert (GDK_IS_EVENT_TYPE (history_event, GDK_MOTION_NOTIFY));
+  tool = gdk_event_get_device_tool (event);
 
-  if (G_UNLIKELY (!self->history))
-    self->history = g_array_new (FALSE, TRUE, sizeof (GdkTimeCoord));
-
-  if (((GdkMotionEvent *)history_event)->history)
-    {
-      GArray *history = ((GdkMotionEvent *)history_event)->history;
-      g_array_append_vals (self->history, history->data, history->len);
-    }
-
-  tool = gdk_event_get_device_tool (history_event);
-
-  memset (&hist, 0, sizeof (GdkTimeCoord));
-  hist.time = gdk_event_get_time (history_event);
+  memset (hist, 0, sizeof (GdkTimeCoord));
+  hist->time = gdk_event_get_time (event);
 
   if (tool)
     {
-      hist.flags = gdk_device_tool_get_axes (tool);
+      hist->flags = gdk_device_tool_get_axes (tool);
       for (i = GDK_AXIS_X; i < GDK_AXIS_LAST; i++)
-        gdk_event_get_axis (history_event, i, &hist.axes[i]);
+        gdk_event_get_axis (event, i, &hist->axes[i]);
     }
 
   /* GdkTimeCoord has no dedicated fields to record event position. For plain
    * pointer events, and for tools which don't report GDK_AXIS_X/GDK_AXIS_Y
    * on their own, we surface the position using the X and Y input axes.
    */
-  if (!(hist.flags & GDK_AXIS_FLAG_X) || !(hist.flags & GDK_AXIS_FLAG_Y))
+  if (!(hist->flags & GDK_AXIS_FLAG_X) || !(hist->flags & GDK_AXIS_FLAG_Y))
+    {
+      hist->flags |= GDK_AXIS_FLAG_X | GDK_AXIS_FLAG_Y;
+      gdk_event_get_position (event, &hist->axes[GDK_AXIS_X], &hist->axes[GDK_AXIS_Y]);
+    }
+}
+
+static void
+gdk_motion_event_push_history (GdkEvent *event,
+                               GdkEvent *history_event)
+{
+  GdkMotionEvent *self = (GdkMotionEvent *) event;
+  GdkTimeCoord hist;
+
+  g_assert (GDK_IS_EVENT_TYPE (event, GDK_MOTION_NOTIFY));
+  g_assert (GDK_IS_EVENT_TYPE (history_event, GDK_MOTION_NOTIFY));
+
+  if (G_UNLIKELY (!self->history))
+    self->history = g_array_new (FALSE, TRUE, sizeof (GdkTimeCoord));
+
+  if (((GdkMotionEvent *)history_event)->history)
     {
-      hist.flags |= GDK_AXIS_FLAG_X | GDK_AXIS_FLAG_Y;
-      gdk_event_get_position (history_event, &hist.axes[GDK_AXIS_X], &hist.axes[GDK_AXIS_Y]);
+      GArray *history = ((GdkMotionEvent *)history_event)->history;
+      g_array_append_vals (self->history, history->data, history->len);
     }
 
+  gdk_motion_event_get_time_coord (history_event, &hist);
   g_array_append_val (self->history, hist);
 }
 
@@ -3185,6 +3212,23 @@ gdk_event_get_history (GdkEvent *event,
   return NULL;
 }
 
+/*<private>
+ * gdk_motion_event_get_history_serial:
+ * @event: a motion `GdkEvent`
+ *
+ * Gets the serial of @event in the history of its device,
+ * see gdk_device_get_history().
+ *
+ * Returns: the serial, or 0 if @event was not recorded
+ */
+guint32
+gdk_motion_event_get_history_serial (GdkEvent *event)
+{
+  g_return_val_if_fail (GDK_IS_EVENT_TYPE (event, GDK_MOTION_NOTIFY), 0);
+
+  return ((GdkMotionEvent *) event)->history_serial;
+}
+
 /* }}} */
 /* {{{ GdkProximityEvent */
 
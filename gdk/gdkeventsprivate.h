@@ -125,6 +125,7 @@ struct _GdkMotionEvent
   double *axes;
   GdkDeviceTool *tool;
   GArray *history; /* <GdkTimeCoord> */
+  guint32 history_serial; /* in the history of the device, or 0 */
 };
 
 /*
@@ -632,5 +633,7 @@ void     _gdk_event_queue_flush                     (GdkDisplay       *display);
 
 double * gdk_event_dup_axes (GdkEvent *event);
 
+guint32  gdk_motion_event_get_history_serial (GdkEvent *event);
+
 G_END_DECLS
 
@@ -26,6 +26,8 @@
 
 #include "gdkframeclockprivate.h"
 
+#include "gdkallocationsprivate.h"
+
 /**
  * GdkFrameClock:
  *
@@ -267,7 +269,12 @@ gdk_frame_clock_init (GdkFrameClock *clock)
   timings_init (&priv->timings);
 
   if (fps_counter == 0)
-    fps_counter = gdk_profiler_define_counter ("fps", "Frames per Second");
+    {
+      fps_counter = gdk_profiler_define_counter ("fps", "Frames per Second");
+
+      if (GDK_PROFILER_IS_RUNNING)
+        gdk_allocation_tracking_enable ();
+    }
 }
 
 /**
@@ -596,6 +603,13 @@ _gdk_frame_clock_debug_print_timings (GdkFrameClock   *clock,
     g_string_append_printf (str, " paint_start=%-4.1f", (timings->paint_start_time - timings->frame_time) / 1000.);
   if (timings->frame_end_time != 0)
     g_string_append_printf (str, " frame_end=%-4.1f", (timings->frame_end_time - timings->frame_time) / 1000.);
+  g_string_append_printf (str, " phases=%.1f/%.1f/%.1f/%.1f/%.1f render=%.1f",
+                          timings->events_duration / 1000.,
+                          timings->update_duration / 1000.,
+                          timings->layout_duration / 1000.,
+                          timings->paint_duration / 1000.,
+                          timings->after_paint_duration / 1000.,
+                          timings->render_duration / 1000.);
   if (timings->drawn_time != 0)
     g_string_append_printf (str, " drawn=%-4.1f", (timings->drawn_time - timings->frame_time) / 1000.);
   if (timings->presentation_time != 0)
@@ -847,4 +861,5 @@ _gdk_frame_clock_add_timings_to_profiler (GdkFrameClock   *clock,
     }
 
   gdk_profiler_set_counter (fps_counter, gdk_frame_clock_get_fps (clock));
+  gdk_allocation_add_to_profiler ();
 }
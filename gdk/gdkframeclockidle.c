@@ -37,6 +37,14 @@
 
 #define FRAME_INTERVAL 16667 /* microseconds */
 
+/* Safety margin for frame-deadline scheduling, on top of the
+ * expected cycle duration. The compositor needs our buffer
+ * somewhat before the vblank it will be shown at.
+ */
+#define DEADLINE_MIN_MARGIN 2000 /* microseconds */
+
+static guint throttled_frames_counter;
+
 typedef enum {
   SMOOTH_PHASE_STATE_VALID = 0,    /* explicit, since we count on zero-init */
   SMOOTH_PHASE_STATE_AWAIT_FIRST,
@@ -51,14 +59,20 @@ struct _GdkFrameClockIdlePrivate
   gint64 smoothed_frame_time_reported; /* Ensures we are always monotonic */
   gint64 smoothed_frame_time_phase;    /* The offset of the first reported frame time, in the current animation sequence, from the preceding vsync */
   gint64 min_next_frame_time;          /* We're not synced to vblank, so wait at least until this before next cycle to avoid busy looping */
+  gint64 unthrottled_frame_time;       /* The value of min_next_frame_time before the animation frame rate limit was applied */
   SmoothDeltaState smooth_phase_state; /* The state of smoothed_frame_time_phase - is it valid, awaiting vsync etc. Thanks to zero-init, the initial value
                                           of smoothed_frame_time_phase is `0`. This is valid, since we didn't get a "frame drawn" event yet. Accordingly,
                                           the initial value of smooth_phase_state is SMOOTH_PHASE_STATE_VALID. See the comment in gdk_frame_clock_paint_idle()
                                           for details. */
 
+  gint64 cycle_duration;               /* Estimated duration of a clock cycle, quick to grow and slow to shrink */
+  gint64 events_duration;              /* Time spent flushing events for the upcoming frame */
+
   gint64 sleep_serial;
   gint64 freeze_time; /* in microseconds */
 
+  guint64 throttled_frames;            /* Frames skipped because of the animation frame rate limit */
+
   guint flush_idle_id;
   guint paint_idle_id;
   guint freeze_count;
@@ -69,6 +83,7 @@ struct _GdkFrameClockIdlePrivate
 
   guint in_paint_idle : 1;
   guint paint_is_thaw : 1;
+  guint throttled : 1;
 #ifdef G_OS_WIN32
   guint begin_period : 1;
 #endif
@@ -174,6 +189,40 @@ gdk_frame_clock_idle_dispose (GObject *object)
 
 /* Note: This is never called on first frame, so
  * smoothed_frame_time_base != 0 and we have a valid frame_interval. */
+/* Returns the minimum interval between frames that only happen
+ * because of tick callbacks, or 0 if there is no limit.
+ * See GDK_MAX_ANIMATION_FRAME_RATE.
+ */
+static gint64
+get_animation_frame_interval (void)
+{
+  static gint64 interval = -1;
+
+  if (interval < 0)
+    {
+      const char *str = g_getenv ("GDK_MAX_ANIMATION_FRAME_RATE");
+      guint64 value;
+      GError *error = NULL;
+
+      interval = 0;
+
+      if (str != NULL)
+        {
+          if (!g_ascii_string_to_unsigned (str, 10, 0, 1000, &value, &error))
+            {
+              g_warning ("Failed to parse GDK_MAX_ANIMATION_FRAME_RATE: %s", error->message);
+              g_error_free (error);
+            }
+          else if (value > 0)
+            {
+              interval = G_USEC_PER_SEC / value;
+            }
+        }
+    }
+
+  return interval;
+}
+
 static gint64
 compute_smooth_frame_time (GdkFrameClock *clock,
                            gint64 new_frame_time,
@@ -386,6 +435,7 @@ gdk_frame_clock_flush_idle (void *data)
   GdkFrameClock *clock = GDK_FRAME_CLOCK (data);
   GdkFrameClockIdle *clock_idle = GDK_FRAME_CLOCK_IDLE (clock);
   GdkFrameClockIdlePrivate *priv = clock_idle->priv;
+  gint64 start_time;
 
   priv->flush_idle_id = 0;
 
@@ -395,13 +445,20 @@ gdk_frame_clock_flush_idle (void *data)
   priv->phase = GDK_FRAME_CLOCK_PHASE_FLUSH_EVENTS;
   priv->requested &= ~GDK_FRAME_CLOCK_PHASE_FLUSH_EVENTS;
 
+  start_time = g_get_monotonic_time ();
   _gdk_frame_clock_emit_flush_events (clock);
 
   if ((priv->requested & ~GDK_FRAME_CLOCK_PHASE_FLUSH_EVENTS) != 0 ||
       priv->updating_count > 0)
-    priv->phase = GDK_FRAME_CLOCK_PHASE_BEFORE_PAINT;
+    {
+      priv->phase = GDK_FRAME_CLOCK_PHASE_BEFORE_PAINT;
+      priv->events_duration = g_get_monotonic_time () - start_time;
+    }
   else
-    priv->phase = GDK_FRAME_CLOCK_PHASE_NONE;
+    {
+      priv->phase = GDK_FRAME_CLOCK_PHASE_NONE;
+      priv->events_duration = 0;
+    }
 
   g_clear_handle_id (&priv->paint_idle_id, g_source_remove);
   gdk_frame_clock_paint_idle (data);
@@ -428,6 +485,100 @@ positive_modulo (int i, int n)
   return (i % n + n) % n;
 }
 
+static void
+update_cycle_duration (GdkFrameClockIdle *self,
+                       gint64             duration)
+{
+  GdkFrameClockIdlePrivate *priv = self->priv;
+
+  /* Missing a frame is worse than starting one too early,
+   * so follow increases immediately and decreases slowly.
+   */
+  if (duration >= priv->cycle_duration)
+    priv->cycle_duration = duration;
+  else
+    priv->cycle_duration = (priv->cycle_duration * 7 + duration) / 8;
+}
+
+/* Returns the latest time at which the next clock cycle can start
+ * and still be done before the next vblank, or 0 to start right away.
+ */
+static gint64
+compute_deadline_start_time (GdkFrameClockIdle *self)
+{
+  GdkFrameClock *clock = GDK_FRAME_CLOCK (self);
+  GdkFrameClockIdlePrivate *priv = self->priv;
+  GdkFrameTimings *timings = NULL;
+  gint64 frame_counter, history_start;
+  gint64 now, refresh_interval, next_vblank, start_time;
+  int i;
+
+  if (priv->cycle_duration == 0)
+    return 0;
+
+  /* Find the most recent frame with presentation feedback */
+  frame_counter = gdk_frame_clock_get_frame_counter (clock);
+  history_start = gdk_frame_clock_get_history_start (clock);
+  for (i = 0; i < 4 && frame_counter >= history_start; i++, frame_counter--)
+    {
+      GdkFrameTimings *t = gdk_frame_clock_get_timings (clock, frame_counter);
+
+      if (t && t->complete && t->presentation_time != 0 && t->refresh_interval != 0)
+        {
+          timings = t;
+          break;
+        }
+    }
+
+  if (timings == NULL)
+    return 0;
+
+  now = g_get_monotonic_time ();
+  refresh_interval = timings->refresh_interval;
+
+  next_vblank = timings->presentation_time + refresh_interval;
+  if (next_vblank <= now)
+    next_vblank += ((now - next_vblank) / refresh_interval + 1) * refresh_interval;
+
+  start_time = next_vblank - priv->cycle_duration - MAX (DEADLINE_MIN_MARGIN, refresh_interval / 4);
+  if (start_time <= now)
+    return 0;
+
+  return start_time;
+}
+
+/* Holds back frames that nobody but tick callbacks asked for, if
+ * there is a limit for the animation frame rate.
+ *
+ * The frame times are aligned to a grid that all clocks share, so
+ * that throttled animations in different windows wake up together.
+ */
+static void
+maybe_throttle_animation (GdkFrameClockIdle *self)
+{
+  GdkFrameClockIdlePrivate *priv = self->priv;
+  gint64 interval, next_frame_time;
+
+  interval = get_animation_frame_interval ();
+  if (interval <= priv->smoothed_frame_time_period)
+    return;
+
+  if ((priv->requested & ~GDK_FRAME_CLOCK_PHASE_FLUSH_EVENTS) != 0 ||
+      priv->updating_count == 0)
+    return;
+
+  next_frame_time = (priv->frame_time / interval + 1) * interval;
+  if (next_frame_time <= priv->min_next_frame_time)
+    return;
+
+  priv->unthrottled_frame_time = priv->min_next_frame_time;
+  priv->min_next_frame_time = next_frame_time;
+  priv->throttled = TRUE;
+
+  priv->throttled_frames += (next_frame_time - priv->unthrottled_frame_time) / priv->smoothed_frame_time_period;
+  gdk_profiler_set_int_counter (throttled_frames_counter, priv->throttled_frames);
+}
+
 static gboolean
 gdk_frame_clock_paint_idle (void *data)
 {
@@ -435,7 +586,9 @@ gdk_frame_clock_paint_idle (void *data)
   GdkFrameClockIdle *clock_idle = GDK_FRAME_CLOCK_IDLE (clock);
   GdkFrameClockIdlePrivate *priv = clock_idle->priv;
   gboolean skip_to_resume_events;
+  gboolean began_frame = FALSE;
   GdkFrameTimings *timings = NULL;
+  gint64 phase_start;
   gint64 before G_GNUC_UNUSED;
 
   before = GDK_PROFILER_CURRENT_TIME;
@@ -443,6 +596,7 @@ gdk_frame_clock_paint_idle (void *data)
   priv->paint_idle_id = 0;
   priv->in_paint_idle = TRUE;
   priv->min_next_frame_time = 0;
+  priv->throttled = FALSE;
 
   skip_to_resume_events =
     (priv->requested & ~(GDK_FRAME_CLOCK_PHASE_FLUSH_EVENTS | GDK_FRAME_CLOCK_PHASE_RESUME_EVENTS)) == 0 &&
@@ -562,6 +716,9 @@ gdk_frame_clock_paint_idle (void *data)
               timings->frame_time = priv->frame_time;
               timings->smoothed_frame_time = priv->smoothed_frame_time_base;
               timings->slept_before = priv->sleep_serial != get_sleep_serial ();
+              timings->events_duration = priv->events_duration;
+              priv->events_duration = 0;
+              began_frame = TRUE;
 
               priv->phase = GDK_FRAME_CLOCK_PHASE_BEFORE_PAINT;
 
@@ -583,7 +740,10 @@ gdk_frame_clock_paint_idle (void *data)
                   priv->updating_count > 0)
                 {
                   priv->requested &= ~GDK_FRAME_CLOCK_PHASE_UPDATE;
+                  phase_start = g_get_monotonic_time ();
                   _gdk_frame_clock_emit_update (clock);
+                  if (timings)
+                    timings->update_duration += g_get_monotonic_time () - phase_start;
                 }
             }
           G_GNUC_FALLTHROUGH;
@@ -609,6 +769,7 @@ gdk_frame_clock_paint_idle (void *data)
 	       * resizes and natural size changes.
 	       */
 	      iter = 0;
+              phase_start = g_get_monotonic_time ();
               while ((priv->requested & GDK_FRAME_CLOCK_PHASE_LAYOUT) &&
                      !gdk_frame_clock_idle_is_frozen (clock_idle) &&
 		     iter++ < 4)
@@ -616,6 +777,8 @@ gdk_frame_clock_paint_idle (void *data)
                   priv->requested &= ~GDK_FRAME_CLOCK_PHASE_LAYOUT;
                   _gdk_frame_clock_emit_layout (clock);
                 }
+              if (timings && iter > 0)
+                timings->layout_duration += g_get_monotonic_time () - phase_start;
 	      if (iter == 5)
 		g_warning ("gdk-frame-clock: layout continuously requested, giving up after 4 tries");
             }
@@ -638,7 +801,10 @@ gdk_frame_clock_paint_idle (void *data)
               if (priv->requested & GDK_FRAME_CLOCK_PHASE_PAINT)
                 {
                   priv->requested &= ~GDK_FRAME_CLOCK_PHASE_PAINT;
+                  phase_start = g_get_monotonic_time ();
                   _gdk_frame_clock_emit_paint (clock);
+                  if (timings)
+                    timings->paint_duration += g_get_monotonic_time () - phase_start;
                 }
             }
           G_GNUC_FALLTHROUGH;
@@ -647,16 +813,16 @@ gdk_frame_clock_paint_idle (void *data)
           if (!gdk_frame_clock_idle_is_frozen (clock_idle))
             {
               priv->requested &= ~GDK_FRAME_CLOCK_PHASE_AFTER_PAINT;
+              phase_start = g_get_monotonic_time ();
               _gdk_frame_clock_emit_after_paint (clock);
+              if (timings)
+                timings->after_paint_duration += g_get_monotonic_time () - phase_start;
               /* the ::after-paint phase doesn't get repeated on freeze/thaw,
                */
               priv->phase = GDK_FRAME_CLOCK_PHASE_NONE;
             }
-          if (GDK_DEBUG_CHECK (FRAMES))
-            {
-              if (timings)
-                timings->frame_end_time = g_get_monotonic_time ();
-            }
+          if (timings)
+            timings->frame_end_time = g_get_monotonic_time ();
           G_GNUC_FALLTHROUGH;
 
         case GDK_FRAME_CLOCK_PHASE_RESUME_EVENTS:
@@ -665,6 +831,9 @@ gdk_frame_clock_paint_idle (void *data)
         }
     }
 
+  if (began_frame && priv->phase == GDK_FRAME_CLOCK_PHASE_NONE)
+    update_cycle_duration (clock_idle, g_get_monotonic_time () - priv->frame_time);
+
   if (priv->requested & GDK_FRAME_CLOCK_PHASE_RESUME_EVENTS)
     {
       priv->requested &= ~GDK_FRAME_CLOCK_PHASE_RESUME_EVENTS;
@@ -695,6 +864,8 @@ gdk_frame_clock_paint_idle (void *data)
       gint64 smooth_cycle_start = priv->smoothed_frame_time_base - priv->smoothed_frame_time_phase;
       priv->min_next_frame_time = smooth_cycle_start + priv->smoothed_frame_time_period;
 
+      maybe_throttle_animation (clock_idle);
+
       maybe_start_idle (clock_idle, FALSE);
     }
 
@@ -713,6 +884,16 @@ gdk_frame_clock_idle_request_phase (GdkFrameClock      *clock,
   GdkFrameClockIdle *clock_idle = GDK_FRAME_CLOCK_IDLE (clock);
   GdkFrameClockIdlePrivate *priv = clock_idle->priv;
 
+  /* Someone other than the tick callbacks wants a frame,
+   * for example to handle input, so don't hold it back.
+   */
+  if (priv->throttled)
+    {
+      priv->throttled = FALSE;
+      priv->min_next_frame_time = priv->unthrottled_frame_time;
+      g_clear_handle_id (&priv->paint_idle_id, g_source_remove);
+    }
+
   priv->requested |= phase;
   maybe_start_idle (clock_idle, FALSE);
 }
@@ -793,6 +974,16 @@ gdk_frame_clock_idle_thaw (GdkFrameClock *clock)
   priv->freeze_count--;
   if (!gdk_frame_clock_idle_is_frozen (clock_idle))
     {
+      /* Thawing usually means the compositor is ready for a new frame.
+       * Instead of starting it right away, we can start it as late as
+       * possible, so it reflects the most recent input.
+       */
+      if (GDK_DEBUG_CHECK (FRAME_DEADLINE) &&
+          !GDK_DEBUG_CHECK (NO_VSYNC) &&
+          !priv->throttled &&
+          priv->paint_idle_id == 0)
+        priv->min_next_frame_time = compute_deadline_start_time (clock_idle);
+
       maybe_start_idle (clock_idle, TRUE);
       /* If nothing is requested so we didn't start an idle, we need
        * to skip to the end of the state chain, since the idle won't
@@ -828,6 +1019,8 @@ gdk_frame_clock_idle_class_init (GdkFrameClockIdleClass *klass)
   frame_clock_class->end_updating = gdk_frame_clock_idle_end_updating;
   frame_clock_class->freeze = gdk_frame_clock_idle_freeze;
   frame_clock_class->thaw = gdk_frame_clock_idle_thaw;
+
+  throttled_frames_counter = gdk_profiler_define_int_counter ("throttled-frames", "Animation frames skipped because of GDK_MAX_ANIMATION_FRAME_RATE");
 }
 
 GdkFrameClock *
@@ -99,6 +99,15 @@ struct _GdkFrameTimings
   gint64 paint_start_time;
   gint64 frame_end_time;
 
+  /* Time spent in each phase, in microseconds */
+  gint64 events_duration;
+  gint64 update_duration;
+  gint64 layout_duration;
+  gint64 paint_duration;
+  gint64 after_paint_duration;
+  /* The part of the paint phase spent in GSK renderers */
+  gint64 render_duration;
+
   guint complete : 1;
   guint slept_before : 1;
 };
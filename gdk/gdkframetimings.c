@@ -236,3 +236,147 @@ gdk_frame_timings_get_refresh_interval (GdkFrameTimings *timings)
 
   return timings->refresh_interval;
 }
+
+/**
+ * gdk_frame_timings_get_events_duration:
+ * @timings: a `GdkFrameTimings`
+ *
+ * Gets the time spent in the [signal@Gdk.FrameClock::flush-events] phase
+ * for this frame.
+ *
+ * Returns: the duration in microseconds, or 0 if the phase did not run
+ *
+ * Since: 4.16
+ */
+gint64
+gdk_frame_timings_get_events_duration (GdkFrameTimings *timings)
+{
+  g_return_val_if_fail (timings != NULL, 0);
+
+  return timings->events_duration;
+}
+
+/**
+ * gdk_frame_timings_get_update_duration:
+ * @timings: a `GdkFrameTimings`
+ *
+ * Gets the time spent in the [signal@Gdk.FrameClock::update] phase, typically driving animations
+ * for this frame.
+ *
+ * Returns: the duration in microseconds, or 0 if the phase did not run
+ *
+ * Since: 4.16
+ */
+gint64
+gdk_frame_timings_get_update_duration (GdkFrameTimings *timings)
+{
+  g_return_val_if_fail (timings != NULL, 0);
+
+  return timings->update_duration;
+}
+
+/**
+ * gdk_frame_timings_get_layout_duration:
+ * @timings: a `GdkFrameTimings`
+ *
+ * Gets the time spent in the [signal@Gdk.FrameClock::layout] phase
+ * for this frame.
+ *
+ * Returns: the duration in microseconds, or 0 if the phase did not run
+ *
+ * Since: 4.16
+ */
+gint64
+gdk_frame_timings_get_layout_duration (GdkFrameTimings *timings)
+{
+  g_return_val_if_fail (timings != NULL, 0);
+
+  return timings->layout_duration;
+}
+
+/**
+ * gdk_frame_timings_get_paint_duration:
+ * @timings: a `GdkFrameTimings`
+ *
+ * Gets the time spent in the [signal@Gdk.FrameClock::paint] phase
+ * for this frame.
+ *
+ * Returns: the duration in microseconds, or 0 if the phase did not run
+ *
+ * Since: 4.16
+ */
+gint64
+gdk_frame_timings_get_paint_duration (GdkFrameTimings *timings)
+{
+  g_return_val_if_fail (timings != NULL, 0);
+
+  return timings->paint_duration;
+}
+
+/**
+ * gdk_frame_timings_get_after_paint_duration:
+ * @timings: a `GdkFrameTimings`
+ *
+ * Gets the time spent in the [signal@Gdk.FrameClock::after-paint] phase
+ * for this frame.
+ *
+ * Returns: the duration in microseconds, or 0 if the phase did not run
+ *
+ * Since: 4.16
+ */
+gint64
+gdk_frame_timings_get_after_paint_duration (GdkFrameTimings *timings)
+{
+  g_return_val_if_fail (timings != NULL, 0);
+
+  return timings->after_paint_duration;
+}
+
+/**
+ * gdk_frame_timings_get_render_duration:
+ * @timings: a `GdkFrameTimings`
+ *
+ * Gets the time the CPU spent in renderers for this frame,
+ * recording and submitting the rendering commands.
+ *
+ * This is part of the duration of the paint phase, see
+ * [method@Gdk.FrameTimings.get_paint_duration]. It does not
+ * include the time the GPU spends executing the commands.
+ *
+ * Returns: the duration in microseconds, or 0 if nothing was rendered
+ *
+ * Since: 4.16
+ */
+gint64
+gdk_frame_timings_get_render_duration (GdkFrameTimings *timings)
+{
+  g_return_val_if_fail (timings != NULL, 0);
+
+  return timings->render_duration;
+}
+
+/**
+ * gdk_frame_timings_get_presentation_latency:
+ * @timings: a `GdkFrameTimings`
+ *
+ * Gets the time between the end of the frame clock cycle that
+ * produced this frame and the frame being presented.
+ *
+ * This covers GPU execution, queuing in the window system and
+ * waiting for the vertical blank.
+ *
+ * Returns: the latency in microseconds, or 0 if it is not available.
+ *   See [method@Gdk.FrameTimings.get_complete].
+ *
+ * Since: 4.16
+ */
+gint64
+gdk_frame_timings_get_presentation_latency (GdkFrameTimings *timings)
+{
+  g_return_val_if_fail (timings != NULL, 0);
+
+  if (timings->presentation_time == 0 || timings->frame_end_time == 0)
+    return 0;
+
+  return MAX (timings->presentation_time - timings->frame_end_time, 0);
+}
@@ -49,6 +49,21 @@ gint64           gdk_frame_timings_get_refresh_interval  (GdkFrameTimings *timin
 GDK_AVAILABLE_IN_ALL
 gint64           gdk_frame_timings_get_predicted_presentation_time (GdkFrameTimings *timings);
 
+GDK_AVAILABLE_IN_4_16
+gint64           gdk_frame_timings_get_events_duration      (GdkFrameTimings *timings);
+GDK_AVAILABLE_IN_4_16
+gint64           gdk_frame_timings_get_update_duration      (GdkFrameTimings *timings);
+GDK_AVAILABLE_IN_4_16
+gint64           gdk_frame_timings_get_layout_duration      (GdkFrameTimings *timings);
+GDK_AVAILABLE_IN_4_16
+gint64           gdk_frame_timings_get_paint_duration       (GdkFrameTimings *timings);
+GDK_AVAILABLE_IN_4_16
+gint64           gdk_frame_timings_get_after_paint_duration (GdkFrameTimings *timings);
+GDK_AVAILABLE_IN_4_16
+gint64           gdk_frame_timings_get_render_duration      (GdkFrameTimings *timings);
+GDK_AVAILABLE_IN_4_16
+gint64           gdk_frame_timings_get_presentation_latency (GdkFrameTimings *timings);
+
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GdkFrameTimings, gdk_frame_timings_unref)
 
 G_END_DECLS
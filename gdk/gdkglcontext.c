@@ -110,6 +110,7 @@ static const GdkDebugKey gdk_gl_feature_keys[] = {
   { "sync", GDK_GL_FEATURE_SYNC, "GL_ARB_sync" },
   { "base-instance", GDK_GL_FEATURE_BASE_INSTANCE, "GL_ARB_base_instance" },
   { "buffer-storage", GDK_GL_FEATURE_BUFFER_STORAGE, "GL_EXT_buffer_storage" },
+  { "texture-compression-s3tc", GDK_GL_FEATURE_TEXTURE_COMPRESSION_S3TC, "GL_EXT_texture_compression_s3tc" },
 };
 
 typedef struct _GdkGLContextPrivate GdkGLContextPrivate;
@@ -1709,6 +1710,9 @@ gdk_gl_context_check_features (GdkGLContext *context)
       epoxy_has_gl_extension ("GL_ARB_buffer_storage"))
     features |= GDK_GL_FEATURE_BUFFER_STORAGE;
 
+  if (epoxy_has_gl_extension ("GL_EXT_texture_compression_s3tc"))
+    features |= GDK_GL_FEATURE_TEXTURE_COMPRESSION_S3TC;
+
   return features;
 }
 
@@ -2164,11 +2168,11 @@ gdk_gl_context_import_dmabuf_for_target (GdkGLContext    *self,
   EGLImage image;
   guint texture_id;
 
-  image = gdk_dmabuf_egl_create_image (display,
-                                       width,
-                                       height,
-                                       dmabuf,
-                                       target);
+  image = gdk_dmabuf_egl_get_cached_image (display,
+                                           width,
+                                           height,
+                                           dmabuf,
+                                           target);
   if (image == EGL_NO_IMAGE)
     return 0;
 
@@ -2178,8 +2182,6 @@ gdk_gl_context_import_dmabuf_for_target (GdkGLContext    *self,
   glTexParameteri (target, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
   glTexParameteri (target, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
-  eglDestroyImageKHR (gdk_display_get_egl_display (display), image);
-
   return texture_id;
 #else
   return 0;
@@ -135,6 +135,7 @@ typedef struct _Download Download;
 
 struct _Download
 {
+  GdkRectangle area;
   GdkMemoryFormat format;
   guchar *data;
   gsize stride;
@@ -187,49 +188,91 @@ gdk_gl_texture_do_download (GdkGLTexture *self,
   GdkMemoryFormat format;
   gsize expected_stride;
   Download *download = download_;
+  const GdkRectangle *area = &download->area;
+  gboolean full;
   GLint gl_internal_format;
   GLenum gl_format, gl_type;
   GLint gl_swizzle[4];
 
   format = gdk_texture_get_format (texture),
-  expected_stride = texture->width * gdk_memory_format_bytes_per_pixel (download->format);
+  expected_stride = area->width * gdk_memory_format_bytes_per_pixel (download->format);
+  full = area->x == 0 && area->y == 0 &&
+         area->width == texture->width && area->height == texture->height;
 
   if (!gdk_gl_context_get_use_es (context) &&
       ((gdk_gl_context_get_format_flags (context, format) & GDK_GL_FORMAT_USABLE) == GDK_GL_FORMAT_USABLE))
     {
+      gboolean sub_image;
+
       gdk_memory_format_gl_format (format,
                                    gdk_gl_context_get_use_es (context),
                                    &gl_internal_format,
                                    &gl_format, &gl_type, gl_swizzle);
+
+      sub_image = !full && gdk_gl_context_check_version (context, "4.5", NULL);
+
       if (download->stride == expected_stride &&
-          download->format == format)
+          download->format == format &&
+          (full || sub_image))
         {
-          glGetTexImage (GL_TEXTURE_2D,
-                         0,
-                         gl_format,
-                         gl_type,
-                         download->data);
+          if (full)
+            glGetTexImage (GL_TEXTURE_2D,
+                           0,
+                           gl_format,
+                           gl_type,
+                           download->data);
+          else
+            {
+              glPixelStorei (GL_PACK_ALIGNMENT, 1);
+              glGetTextureSubImage (self->id, 0,
+                                    area->x, area->y, 0,
+                                    area->width, area->height, 1,
+                                    gl_format, gl_type,
+                                    download->stride * area->height,
+                                    download->data);
+            }
         }
       else
         {
-          gsize stride = texture->width * gdk_memory_format_bytes_per_pixel (format);
-          guchar *pixels = g_malloc_n (stride, texture->height);
+          gsize bpp = gdk_memory_format_bytes_per_pixel (format);
+          GdkRectangle read;
+          gsize stride;
+          guchar *pixels;
+
+          /* Without glGetTextureSubImage(), the whole texture has to be
+           * read back, but only the area gets converted
+           */
+          if (full || sub_image)
+            read = *area;
+          else
+            read = (GdkRectangle) { 0, 0, texture->width, texture->height };
+
+          stride = read.width * bpp;
+          pixels = g_malloc_n (stride, read.height);
 
           glPixelStorei (GL_PACK_ALIGNMENT, 1);
-          glGetTexImage (GL_TEXTURE_2D,
-                         0,
-                         gl_format,
-                         gl_type,
-                         pixels);
+          if (sub_image)
+            glGetTextureSubImage (self->id, 0,
+                                  read.x, read.y, 0,
+                                  read.width, read.height, 1,
+                                  gl_format, gl_type,
+                                  stride * read.height,
+                                  pixels);
+          else
+            glGetTexImage (GL_TEXTURE_2D,
+                           0,
+                           gl_format,
+                           gl_type,
+                           pixels);
 
           gdk_memory_convert (download->data,
                               download->stride,
                               download->format,
-                              pixels,
+                              pixels + (area->y - read.y) * stride + (area->x - read.x) * bpp,
                               stride,
                               format,
-                              texture->width,
-                              texture->height);
+                              area->width,
+                              area->height);
 
           g_free (pixels);
 
@@ -281,8 +324,8 @@ gdk_gl_texture_do_download (GdkGLTexture *self,
       if (download->format == actual_format &&
           (download->stride == expected_stride))
         {
-          glReadPixels (0, 0,
-                        texture->width, texture->height,
+          glReadPixels (area->x, area->y,
+                        area->width, area->height,
                         gl_read_format,
                         gl_read_type,
                         download->data);
@@ -290,12 +333,12 @@ gdk_gl_texture_do_download (GdkGLTexture *self,
       else
         {
           gsize actual_bpp = gdk_memory_format_bytes_per_pixel (actual_format);
-          gsize stride = actual_bpp * texture->width;
-          guchar *pixels = g_malloc_n (stride, texture->height);
+          gsize stride = actual_bpp * area->width;
+          guchar *pixels = g_malloc_n (stride, area->height);
 
           glPixelStorei (GL_PACK_ALIGNMENT, 1);
-          glReadPixels (0, 0,
-                        texture->width, texture->height,
+          glReadPixels (area->x, area->y,
+                        area->width, area->height,
                         gl_read_format,
                         gl_read_type,
                         pixels);
@@ -309,9 +352,9 @@ gdk_gl_texture_do_download (GdkGLTexture *self,
                format == GDK_MEMORY_G8 ||
                format == GDK_MEMORY_A8))
             {
-              for (unsigned int y = 0; y < texture->height; y++)
+              for (unsigned int y = 0; y < area->height; y++)
                 {
-                  for (unsigned int x = 0; x < texture->width; x++)
+                  for (unsigned int x = 0; x < area->width; x++)
                     {
                       guchar *data = &pixels[y * stride + x * actual_bpp];
                       if (format == GDK_MEMORY_G8A8 ||
@@ -345,9 +388,9 @@ gdk_gl_texture_do_download (GdkGLTexture *self,
                format == GDK_MEMORY_G16 ||
                format == GDK_MEMORY_A16))
             {
-              for (unsigned int y = 0; y < texture->height; y++)
+              for (unsigned int y = 0; y < area->height; y++)
                 {
-                  for (unsigned int x = 0; x < texture->width; x++)
+                  for (unsigned int x = 0; x < area->width; x++)
                     {
                       guint16 *data = (guint16 *) &pixels[y * stride + x * actual_bpp];
                       if (format == GDK_MEMORY_G16A16 ||
@@ -380,8 +423,8 @@ gdk_gl_texture_do_download (GdkGLTexture *self,
                               pixels,
                               stride,
                               actual_format,
-                              texture->width,
-                              texture->height);
+                              area->width,
+                              area->height);
 
           g_free (pixels);
         }
@@ -391,20 +434,22 @@ gdk_gl_texture_do_download (GdkGLTexture *self,
 }
 
 static void
-gdk_gl_texture_download (GdkTexture      *texture,
-                         GdkMemoryFormat  format,
-                         guchar          *data,
-                         gsize            stride)
+gdk_gl_texture_download (GdkTexture         *texture,
+                         const GdkRectangle *area,
+                         GdkMemoryFormat     format,
+                         guchar             *data,
+                         gsize               stride)
 {
   GdkGLTexture *self = GDK_GL_TEXTURE (texture);
   Download download;
 
   if (self->saved)
     {
-      gdk_texture_do_download (self->saved, format, data, stride);
+      gdk_texture_do_download_area (self->saved, area, format, data, stride);
       return;
     }
 
+  download.area = *area;
   download.format = format;
   download.data = data;
   download.stride = stride;
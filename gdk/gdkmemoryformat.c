@@ -23,11 +23,20 @@
 
 #include "gdkdmabuffourccprivate.h"
 #include "gdkglcontextprivate.h"
+#include "gdkparalleltaskprivate.h"
 
 #include "gsk/gl/fp16private.h"
 
 #include <epoxy/gl.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HAVE_SSE2_CONVERT 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define HAVE_NEON_CONVERT 1
+#endif
+
 typedef struct _GdkMemoryFormatDescription GdkMemoryFormatDescription;
 
 #define TYPED_FUNCS(name, T, R, G, B, A, bpp, scale) \
@@ -277,32 +286,6 @@ a32_float_from_float (guchar      *dest_data,
     }
 }
 
-#define PREMULTIPLY_FUNC(name, R1, G1, B1, A1, R2, G2, B2, A2) \
-static void \
-name (guchar *dest, \
-      const guchar *src, \
-      gsize n) \
-{ \
-  for (; n > 0; n--) \
-    { \
-      guchar a = src[A1]; \
-      guint16 r = (guint16)src[R1] * a + 127; \
-      guint16 g = (guint16)src[G1] * a + 127; \
-      guint16 b = (guint16)src[B1] * a + 127; \
-      dest[R2] = (r + (r >> 8) + 1) >> 8; \
-      dest[G2] = (g + (g >> 8) + 1) >> 8; \
-      dest[B2] = (b + (b >> 8) + 1) >> 8; \
-      dest[A2] = a; \
-      dest += 4; \
-      src += 4; \
-    } \
-}
-
-PREMULTIPLY_FUNC(r8g8b8a8_to_r8g8b8a8_premultiplied, 0, 1, 2, 3, 0, 1, 2, 3)
-PREMULTIPLY_FUNC(r8g8b8a8_to_b8g8r8a8_premultiplied, 0, 1, 2, 3, 2, 1, 0, 3)
-PREMULTIPLY_FUNC(r8g8b8a8_to_a8r8g8b8_premultiplied, 0, 1, 2, 3, 1, 2, 3, 0)
-PREMULTIPLY_FUNC(r8g8b8a8_to_a8b8g8r8_premultiplied, 0, 1, 2, 3, 3, 2, 1, 0)
-
 #define ADD_ALPHA_FUNC(name, R1, G1, B1, R2, G2, B2, A2) \
 static void \
 name (guchar *dest, \
@@ -1690,15 +1673,420 @@ unpremultiply (float *rgba,
     }
 }
 
-void
-gdk_memory_convert (guchar              *dest_data,
-                    gsize                dest_stride,
-                    GdkMemoryFormat      dest_format,
-                    const guchar        *src_data,
-                    gsize                src_stride,
-                    GdkMemoryFormat      src_format,
-                    gsize                width,
-                    gsize                height)
+/* {{{ Fast conversions */
+
+/* Conversions between the 8-bit RGBA formats are done with integer
+ * kernels instead of a float round-trip. The results are identical
+ * to the float path.
+ *
+ * SSE2 and NEON are part of the x86-64 and aarch64 baselines, so they
+ * are selected at compile time.
+ */
+
+typedef struct
+{
+  /* byte offset of R, G, B and A */
+  guint8 offset[4];
+  GdkMemoryAlpha alpha;
+} Rgba8Layout;
+
+static gboolean
+get_rgba8_layout (GdkMemoryFormat  format,
+                  Rgba8Layout     *layout)
+{
+  static const guint8 rgba[4] = { 0, 1, 2, 3 };
+  static const guint8 bgra[4] = { 2, 1, 0, 3 };
+  static const guint8 argb[4] = { 1, 2, 3, 0 };
+  static const guint8 abgr[4] = { 3, 2, 1, 0 };
+  const guint8 *offset;
+
+  switch ((int) format)
+    {
+    case GDK_MEMORY_R8G8B8A8_PREMULTIPLIED:
+    case GDK_MEMORY_R8G8B8A8:
+      offset = rgba;
+      break;
+    case GDK_MEMORY_B8G8R8A8_PREMULTIPLIED:
+    case GDK_MEMORY_B8G8R8A8:
+      offset = bgra;
+      break;
+    case GDK_MEMORY_A8R8G8B8_PREMULTIPLIED:
+    case GDK_MEMORY_A8R8G8B8:
+      offset = argb;
+      break;
+    case GDK_MEMORY_A8B8G8R8_PREMULTIPLIED:
+    case GDK_MEMORY_A8B8G8R8:
+      offset = abgr;
+      break;
+    default:
+      return FALSE;
+    }
+
+  memcpy (layout->offset, offset, sizeof (layout->offset));
+  layout->alpha = memory_formats[format].alpha;
+
+  return TRUE;
+}
+
+static inline gboolean
+layout_is (const Rgba8Layout *layout,
+           guint8             r,
+           guint8             g,
+           guint8             b,
+           guint8             a)
+{
+  return layout->offset[0] == r && layout->offset[1] == g &&
+         layout->offset[2] == b && layout->offset[3] == a;
+}
+
+static inline guchar
+premultiply_u8 (guchar c,
+                guchar a)
+{
+  guint16 t = (guint16) c * a + 127;
+
+  return (t + (t >> 8) + 1) >> 8;
+}
+
+static void
+swizzle_rgba8 (guchar            *dest,
+               const Rgba8Layout *dest_layout,
+               const guchar      *src,
+               const Rgba8Layout *src_layout,
+               gsize              n)
+{
+  const guint8 *d = dest_layout->offset;
+  const guint8 *s = src_layout->offset;
+  gsize i = 0;
+
+#if defined(HAVE_SSE2_CONVERT)
+  /* Swapping the R and B bytes is the common case: RGBA <=> BGRA */
+  if ((layout_is (src_layout, 0, 1, 2, 3) && layout_is (dest_layout, 2, 1, 0, 3)) ||
+      (layout_is (src_layout, 2, 1, 0, 3) && layout_is (dest_layout, 0, 1, 2, 3)))
+    {
+      const __m128i ga_mask = _mm_set1_epi32 (0xff00ff00);
+      const __m128i rb_mask = _mm_set1_epi32 (0x00ff00ff);
+
+      for (; i + 4 <= n; i += 4)
+        {
+          __m128i v = _mm_loadu_si128 ((const __m128i *) (src + 4 * i));
+          __m128i rb = _mm_and_si128 (v, rb_mask);
+
+          rb = _mm_or_si128 (_mm_slli_epi32 (rb, 16), _mm_srli_epi32 (rb, 16));
+          v = _mm_or_si128 (_mm_and_si128 (v, ga_mask), _mm_and_si128 (rb, rb_mask));
+          _mm_storeu_si128 ((__m128i *) (dest + 4 * i), v);
+        }
+    }
+#elif defined(HAVE_NEON_CONVERT)
+  for (; i + 16 <= n; i += 16)
+    {
+      uint8x16x4_t in = vld4q_u8 (src + 4 * i);
+      uint8x16x4_t out;
+
+      out.val[d[0]] = in.val[s[0]];
+      out.val[d[1]] = in.val[s[1]];
+      out.val[d[2]] = in.val[s[2]];
+      out.val[d[3]] = in.val[s[3]];
+      vst4q_u8 (dest + 4 * i, out);
+    }
+#endif
+
+  for (; i < n; i++)
+    {
+      const guchar *sp = src + 4 * i;
+      guchar *dp = dest + 4 * i;
+      guchar r = sp[s[0]], g = sp[s[1]], b = sp[s[2]], a = sp[s[3]];
+
+      dp[d[0]] = r;
+      dp[d[1]] = g;
+      dp[d[2]] = b;
+      dp[d[3]] = a;
+    }
+}
+
+#if defined(HAVE_NEON_CONVERT)
+static inline uint8x16_t
+premultiply_neon (uint8x16_t c,
+                  uint8x16_t a)
+{
+  uint16x8_t lo = vmlal_u8 (vdupq_n_u16 (127), vget_low_u8 (c), vget_low_u8 (a));
+  uint16x8_t hi = vmlal_u8 (vdupq_n_u16 (127), vget_high_u8 (c), vget_high_u8 (a));
+
+  lo = vaddq_u16 (vaddq_u16 (lo, vshrq_n_u16 (lo, 8)), vdupq_n_u16 (1));
+  hi = vaddq_u16 (vaddq_u16 (hi, vshrq_n_u16 (hi, 8)), vdupq_n_u16 (1));
+
+  return vcombine_u8 (vshrn_n_u16 (lo, 8), vshrn_n_u16 (hi, 8));
+}
+#endif
+
+static void
+premultiply_rgba8 (guchar            *dest,
+                   const Rgba8Layout *dest_layout,
+                   const guchar      *src,
+                   const Rgba8Layout *src_layout,
+                   gsize              n)
+{
+  const guint8 *d = dest_layout->offset;
+  const guint8 *s = src_layout->offset;
+  gsize i = 0;
+
+#if defined(HAVE_SSE2_CONVERT)
+  if (s[3] == 3 && d[3] == 3 && s[1] == 1 && d[1] == 1)
+    {
+      const __m128i zero = _mm_setzero_si128 ();
+      const __m128i bias = _mm_set1_epi16 (127);
+      const __m128i one = _mm_set1_epi16 (1);
+      const __m128i alpha_mask = _mm_set1_epi32 (0xff000000);
+      const __m128i ga_mask = _mm_set1_epi32 (0xff00ff00);
+      const __m128i rb_mask = _mm_set1_epi32 (0x00ff00ff);
+      gboolean swap = s[0] != d[0];
+
+      for (; i + 4 <= n; i += 4)
+        {
+          __m128i v = _mm_loadu_si128 ((const __m128i *) (src + 4 * i));
+          __m128i lo = _mm_unpacklo_epi8 (v, zero);
+          __m128i hi = _mm_unpackhi_epi8 (v, zero);
+          __m128i alo = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (lo, _MM_SHUFFLE (3, 3, 3, 3)), _MM_SHUFFLE (3, 3, 3, 3));
+          __m128i ahi = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (hi, _MM_SHUFFLE (3, 3, 3, 3)), _MM_SHUFFLE (3, 3, 3, 3));
+          __m128i r;
+
+          lo = _mm_add_epi16 (_mm_mullo_epi16 (lo, alo), bias);
+          hi = _mm_add_epi16 (_mm_mullo_epi16 (hi, ahi), bias);
+          lo = _mm_srli_epi16 (_mm_add_epi16 (_mm_add_epi16 (lo, _mm_srli_epi16 (lo, 8)), one), 8);
+          hi = _mm_srli_epi16 (_mm_add_epi16 (_mm_add_epi16 (hi, _mm_srli_epi16 (hi, 8)), one), 8);
+
+          r = _mm_packus_epi16 (lo, hi);
+          r = _mm_or_si128 (_mm_andnot_si128 (alpha_mask, r), _mm_and_si128 (alpha_mask, v));
+          if (swap)
+            {
+              __m128i rb = _mm_and_si128 (r, rb_mask);
+              rb = _mm_or_si128 (_mm_slli_epi32 (rb, 16), _mm_srli_epi32 (rb, 16));
+              r = _mm_or_si128 (_mm_and_si128 (r, ga_mask), _mm_and_si128 (rb, rb_mask));
+            }
+          _mm_storeu_si128 ((__m128i *) (dest + 4 * i), r);
+        }
+    }
+#elif defined(HAVE_NEON_CONVERT)
+  for (; i + 16 <= n; i += 16)
+    {
+      uint8x16x4_t in = vld4q_u8 (src + 4 * i);
+      uint8x16x4_t out;
+      uint8x16_t a = in.val[s[3]];
+
+      out.val[d[0]] = premultiply_neon (in.val[s[0]], a);
+      out.val[d[1]] = premultiply_neon (in.val[s[1]], a);
+      out.val[d[2]] = premultiply_neon (in.val[s[2]], a);
+      out.val[d[3]] = a;
+      vst4q_u8 (dest + 4 * i, out);
+    }
+#endif
+
+  for (; i < n; i++)
+    {
+      const guchar *sp = src + 4 * i;
+      guchar *dp = dest + 4 * i;
+      guchar a = sp[s[3]];
+      guchar r = premultiply_u8 (sp[s[0]], a);
+      guchar g = premultiply_u8 (sp[s[1]], a);
+      guchar b = premultiply_u8 (sp[s[2]], a);
+
+      dp[d[0]] = r;
+      dp[d[1]] = g;
+      dp[d[2]] = b;
+      dp[d[3]] = a;
+    }
+}
+
+static void
+unpremultiply_rgba8 (guchar            *dest,
+                     const Rgba8Layout *dest_layout,
+                     const guchar      *src,
+                     const Rgba8Layout *src_layout,
+                     gsize              n,
+                     const guint32      inverse[256])
+{
+  const guint8 *d = dest_layout->offset;
+  const guint8 *s = src_layout->offset;
+
+  for (gsize i = 0; i < n; i++)
+    {
+      const guchar *sp = src + 4 * i;
+      guchar *dp = dest + 4 * i;
+      guchar a = sp[s[3]];
+      guchar r = sp[s[0]], g = sp[s[1]], b = sp[s[2]];
+
+      /* like unpremultiply(), leave almost transparent pixels alone */
+      if (a > 1)
+        {
+          guint32 half = a / 2;
+
+          r = MIN (((r * 255 + half) * (guint64) inverse[a]) >> 24, 255);
+          g = MIN (((g * 255 + half) * (guint64) inverse[a]) >> 24, 255);
+          b = MIN (((b * 255 + half) * (guint64) inverse[a]) >> 24, 255);
+        }
+
+      dp[d[0]] = r;
+      dp[d[1]] = g;
+      dp[d[2]] = b;
+      dp[d[3]] = a;
+    }
+}
+
+static void
+rgba8_to_rgba16 (guchar            *dest_data,
+                 const guchar      *src,
+                 const Rgba8Layout *src_layout,
+                 gsize              n)
+{
+  const guint8 *s = src_layout->offset;
+  guint16 *dest = (guint16 *) dest_data;
+
+  for (gsize i = 0; i < n; i++)
+    {
+      dest[0] = src[s[0]] * 257;
+      dest[1] = src[s[1]] * 257;
+      dest[2] = src[s[2]] * 257;
+      dest[3] = src[s[3]] * 257;
+      dest += 4;
+      src += 4;
+    }
+}
+
+static void
+rgba16_to_rgba8 (guchar            *dest,
+                 const Rgba8Layout *dest_layout,
+                 const guchar      *src_data,
+                 gsize              n)
+{
+  const guint8 *d = dest_layout->offset;
+  const guint16 *src = (const guint16 *) src_data;
+
+  for (gsize i = 0; i < n; i++)
+    {
+      dest[d[0]] = (src[0] * 255u + 32767) / 65535;
+      dest[d[1]] = (src[1] * 255u + 32767) / 65535;
+      dest[d[2]] = (src[2] * 255u + 32767) / 65535;
+      dest[d[3]] = (src[3] * 255u + 32767) / 65535;
+      dest += 4;
+      src += 4;
+    }
+}
+
+static void
+rgba8_to_rgba32f (guchar            *dest_data,
+                  const guchar      *src,
+                  const Rgba8Layout *src_layout,
+                  gsize              n)
+{
+  const guint8 *s = src_layout->offset;
+  float *dest = (float *) dest_data;
+
+  for (gsize i = 0; i < n; i++)
+    {
+      dest[0] = (float) src[s[0]] / 255;
+      dest[1] = (float) src[s[1]] / 255;
+      dest[2] = (float) src[s[2]] / 255;
+      dest[3] = (float) src[s[3]] / 255;
+      dest += 4;
+      src += 4;
+    }
+}
+
+static gboolean
+gdk_memory_convert_fast (guchar          *dest_data,
+                         gsize            dest_stride,
+                         GdkMemoryFormat  dest_format,
+                         const guchar    *src_data,
+                         gsize            src_stride,
+                         GdkMemoryFormat  src_format,
+                         gsize            width,
+                         gsize            height)
+{
+  Rgba8Layout src_layout, dest_layout;
+  gboolean src_is_rgba8, dest_is_rgba8;
+  gsize y;
+
+  src_is_rgba8 = get_rgba8_layout (src_format, &src_layout);
+  dest_is_rgba8 = get_rgba8_layout (dest_format, &dest_layout);
+
+  if (src_is_rgba8 && dest_is_rgba8)
+    {
+      if (src_layout.alpha == dest_layout.alpha)
+        {
+          for (y = 0; y < height; y++)
+            swizzle_rgba8 (dest_data + y * dest_stride, &dest_layout,
+                           src_data + y * src_stride, &src_layout, width);
+        }
+      else if (src_layout.alpha == GDK_MEMORY_ALPHA_STRAIGHT)
+        {
+          for (y = 0; y < height; y++)
+            premultiply_rgba8 (dest_data + y * dest_stride, &dest_layout,
+                               src_data + y * src_stride, &src_layout, width);
+        }
+      else
+        {
+          guint32 inverse[256];
+          guint a;
+
+          /* (x * inverse[a]) >> 24 == x / a for all x we use */
+          inverse[0] = 0;
+          for (a = 1; a < 256; a++)
+            inverse[a] = ((1u << 24) + a - 1) / a;
+
+          for (y = 0; y < height; y++)
+            unpremultiply_rgba8 (dest_data + y * dest_stride, &dest_layout,
+                                 src_data + y * src_stride, &src_layout, width,
+                                 inverse);
+        }
+      return TRUE;
+    }
+
+  if (src_is_rgba8 &&
+      memory_formats[dest_format].alpha == src_layout.alpha)
+    {
+      if (dest_format == GDK_MEMORY_R16G16B16A16 ||
+          dest_format == GDK_MEMORY_R16G16B16A16_PREMULTIPLIED)
+        {
+          for (y = 0; y < height; y++)
+            rgba8_to_rgba16 (dest_data + y * dest_stride,
+                             src_data + y * src_stride, &src_layout, width);
+          return TRUE;
+        }
+      else if (dest_format == GDK_MEMORY_R32G32B32A32_FLOAT ||
+               dest_format == GDK_MEMORY_R32G32B32A32_FLOAT_PREMULTIPLIED)
+        {
+          for (y = 0; y < height; y++)
+            rgba8_to_rgba32f (dest_data + y * dest_stride,
+                              src_data + y * src_stride, &src_layout, width);
+          return TRUE;
+        }
+    }
+
+  if (dest_is_rgba8 &&
+      memory_formats[src_format].alpha == dest_layout.alpha &&
+      (src_format == GDK_MEMORY_R16G16B16A16 ||
+       src_format == GDK_MEMORY_R16G16B16A16_PREMULTIPLIED))
+    {
+      for (y = 0; y < height; y++)
+        rgba16_to_rgba8 (dest_data + y * dest_stride, &dest_layout,
+                         src_data + y * src_stride, width);
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+/* }}} */
+
+static void
+gdk_memory_convert_rows (guchar          *dest_data,
+                         gsize            dest_stride,
+                         GdkMemoryFormat  dest_format,
+                         const guchar    *src_data,
+                         gsize            src_stride,
+                         GdkMemoryFormat  src_format,
+                         gsize            width,
+                         gsize            height)
 {
   const GdkMemoryFormatDescription *dest_desc = &memory_formats[dest_format];
   const GdkMemoryFormatDescription *src_desc = &memory_formats[src_format];
@@ -1729,19 +2117,12 @@ gdk_memory_convert (guchar              *dest_data,
       return;
     }
 
-  if (src_format == GDK_MEMORY_R8G8B8A8 && dest_format == GDK_MEMORY_R8G8B8A8_PREMULTIPLIED)
-    func = r8g8b8a8_to_r8g8b8a8_premultiplied;
-  else if (src_format == GDK_MEMORY_B8G8R8A8 && dest_format == GDK_MEMORY_R8G8B8A8_PREMULTIPLIED)
-    func = r8g8b8a8_to_b8g8r8a8_premultiplied;
-  else if (src_format == GDK_MEMORY_R8G8B8A8 && dest_format == GDK_MEMORY_B8G8R8A8_PREMULTIPLIED)
-    func = r8g8b8a8_to_b8g8r8a8_premultiplied;
-  else if (src_format == GDK_MEMORY_B8G8R8A8 && dest_format == GDK_MEMORY_B8G8R8A8_PREMULTIPLIED)
-    func = r8g8b8a8_to_r8g8b8a8_premultiplied;
-  else if (src_format == GDK_MEMORY_R8G8B8A8 && dest_format == GDK_MEMORY_A8R8G8B8_PREMULTIPLIED)
-    func = r8g8b8a8_to_a8r8g8b8_premultiplied;
-  else if (src_format == GDK_MEMORY_B8G8R8A8 && dest_format == GDK_MEMORY_A8R8G8B8_PREMULTIPLIED)
-    func = r8g8b8a8_to_a8b8g8r8_premultiplied;
-  else if (src_format == GDK_MEMORY_R8G8B8 && dest_format == GDK_MEMORY_R8G8B8A8_PREMULTIPLIED)
+  if (gdk_memory_convert_fast (dest_data, dest_stride, dest_format,
+                                src_data, src_stride, src_format,
+                                width, height))
+    return;
+
+  if (src_format == GDK_MEMORY_R8G8B8 && dest_format == GDK_MEMORY_R8G8B8A8_PREMULTIPLIED)
     func = r8g8b8_to_r8g8b8a8;
   else if (src_format == GDK_MEMORY_B8G8R8 && dest_format == GDK_MEMORY_R8G8B8A8_PREMULTIPLIED)
     func = r8g8b8_to_b8g8r8a8;
@@ -1793,3 +2174,173 @@ gdk_memory_convert (guchar              *dest_data,
 
   g_free (tmp);
 }
+
+/* Images with more pixels than this are converted in parallel */
+#define PARALLEL_CONVERT_PIXELS (512 * 512)
+/* Number of pixels each chunk of a parallel conversion handles */
+#define PARALLEL_CONVERT_CHUNK_PIXELS (64 * 1024)
+
+typedef struct _MemoryConvert MemoryConvert;
+
+struct _MemoryConvert
+{
+  guchar          *dest_data;
+  gsize            dest_stride;
+  GdkMemoryFormat  dest_format;
+  const guchar    *src_data;
+  gsize            src_stride;
+  GdkMemoryFormat  src_format;
+  gsize            width;
+  gsize            height;
+
+  gsize            rows_per_chunk;
+  gsize            n_chunks;
+  gint             next_chunk; /* (atomic) */
+};
+
+static void
+gdk_memory_convert_task (gpointer data)
+{
+  MemoryConvert *mc = data;
+  gsize chunk, y, n_rows;
+
+  for (chunk = g_atomic_int_add (&mc->next_chunk, 1);
+       chunk < mc->n_chunks;
+       chunk = g_atomic_int_add (&mc->next_chunk, 1))
+    {
+      y = chunk * mc->rows_per_chunk;
+      n_rows = MIN (mc->rows_per_chunk, mc->height - y);
+
+      gdk_memory_convert_rows (mc->dest_data + y * mc->dest_stride,
+                               mc->dest_stride,
+                               mc->dest_format,
+                               mc->src_data + y * mc->src_stride,
+                               mc->src_stride,
+                               mc->src_format,
+                               mc->width,
+                               n_rows);
+    }
+}
+
+/*
+ * gdk_memory_convert:
+ *
+ * Converts @height rows of @width pixels from @src_format to @dest_format.
+ *
+ * Large images are split into chunks of rows that are converted in
+ * parallel using the shared GDK worker pool.
+ */
+void
+gdk_memory_convert (guchar              *dest_data,
+                    gsize                dest_stride,
+                    GdkMemoryFormat      dest_format,
+                    const guchar        *src_data,
+                    gsize                src_stride,
+                    GdkMemoryFormat      src_format,
+                    gsize                width,
+                    gsize                height)
+{
+  MemoryConvert mc;
+  guint n_processors;
+
+  n_processors = g_get_num_processors ();
+
+  if (n_processors < 2 ||
+      width * height < PARALLEL_CONVERT_PIXELS ||
+      height < 2)
+    {
+      gdk_memory_convert_rows (dest_data, dest_stride, dest_format,
+                               src_data, src_stride, src_format,
+                               width, height);
+      return;
+    }
+
+  mc = (MemoryConvert) {
+    .dest_data = dest_data,
+    .dest_stride = dest_stride,
+    .dest_format = dest_format,
+    .src_data = src_data,
+    .src_stride = src_stride,
+    .src_format = src_format,
+    .width = width,
+    .height = height,
+    .rows_per_chunk = MAX (1, PARALLEL_CONVERT_CHUNK_PIXELS / width),
+    .next_chunk = 0,
+  };
+  mc.n_chunks = (height + mc.rows_per_chunk - 1) / mc.rows_per_chunk;
+
+  gdk_parallel_task_run (gdk_memory_convert_task,
+                         &mc,
+                         MIN (mc.n_chunks, n_processors));
+}
+
+/*
+ * gdk_memory_downscale_rows:
+ * @dest: the row to write to
+ * @src: the first row to read from
+ * @src_stride: stride of @src
+ * @format: format of @src and @dest
+ * @src_width: width of @src
+ * @n_rows: number of rows in @src
+ * @factor: the scale factor
+ *
+ * Box-filters @n_rows rows of @src into a single row of
+ * ceil (@src_width / @factor) pixels. @n_rows is usually @factor, but
+ * may be less for the last row of an image.
+ *
+ * This allows loaders to scale down images while decoding row by row,
+ * so that the full size image never needs to be in memory.
+ */
+void
+gdk_memory_downscale_rows (guchar          *dest,
+                           const guchar    *src,
+                           gsize            src_stride,
+                           GdkMemoryFormat  format,
+                           gsize            src_width,
+                           gsize            n_rows,
+                           guint            factor)
+{
+  const GdkMemoryFormatDescription *desc = &memory_formats[format];
+  gsize dest_width, x, y, i;
+  float *tmp, *sum;
+
+  g_assert (factor > 0);
+  g_assert (n_rows > 0 && n_rows <= factor);
+
+  dest_width = (src_width + factor - 1) / factor;
+  tmp = g_new (float, src_width * 4);
+  sum = g_new0 (float, dest_width * 4);
+
+  for (y = 0; y < n_rows; y++)
+    {
+      desc->to_float (tmp, src + y * src_stride, src_width);
+      /* average premultiplied values, so transparent pixels don't bleed */
+      if (desc->alpha == GDK_MEMORY_ALPHA_STRAIGHT)
+        premultiply (tmp, src_width);
+
+      for (x = 0; x < src_width; x++)
+        {
+          float *s = &sum[(x / factor) * 4];
+
+          for (i = 0; i < 4; i++)
+            s[i] += tmp[4 * x + i];
+        }
+    }
+
+  for (x = 0; x < dest_width; x++)
+    {
+      gsize n_columns = MIN (factor, src_width - x * factor);
+      float scale = 1.0f / (n_columns * n_rows);
+
+      for (i = 0; i < 4; i++)
+        sum[4 * x + i] *= scale;
+    }
+
+  if (desc->alpha == GDK_MEMORY_ALPHA_STRAIGHT)
+    unpremultiply (sum, dest_width);
+
+  desc->from_float (dest, sum, dest_width);
+
+  g_free (sum);
+  g_free (tmp);
+}
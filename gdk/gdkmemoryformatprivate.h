@@ -85,7 +85,13 @@ void                    gdk_memory_convert                  (guchar
                                                              GdkMemoryFormat             src_format,
                                                              gsize                       width,
                                                              gsize                       height);
-
+void                    gdk_memory_downscale_rows           (guchar                     *dest,
+                                                             const guchar               *src,
+                                                             gsize                       src_stride,
+                                                             GdkMemoryFormat             format,
+                                                             gsize                       src_width,
+                                                             gsize                       n_rows,
+                                                             guint                       factor);
 
 G_END_DECLS
 
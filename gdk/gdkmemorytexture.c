@@ -36,6 +36,11 @@ struct _GdkMemoryTexture
 
   GBytes *bytes;
   gsize stride;
+
+  /* For entries of a texture atlas: the atlas page and the position on it */
+  GdkTexture *atlas;
+  int atlas_x;
+  int atlas_y;
 };
 
 struct _GdkMemoryTextureClass
@@ -51,25 +56,32 @@ gdk_memory_texture_dispose (GObject *object)
   GdkMemoryTexture *self = GDK_MEMORY_TEXTURE (object);
 
   g_clear_pointer (&self->bytes, g_bytes_unref);
+  g_clear_object (&self->atlas);
 
   G_OBJECT_CLASS (gdk_memory_texture_parent_class)->dispose (object);
 }
 
 static void
-gdk_memory_texture_download (GdkTexture      *texture,
-                             GdkMemoryFormat  format,
-                             guchar          *data,
-                             gsize            stride)
+gdk_memory_texture_download (GdkTexture         *texture,
+                             const GdkRectangle *area,
+                             GdkMemoryFormat     format,
+                             guchar             *data,
+                             gsize               stride)
 {
   GdkMemoryTexture *self = GDK_MEMORY_TEXTURE (texture);
+  const guchar *src;
+
+  src = (const guchar *) g_bytes_get_data (self->bytes, NULL) +
+        area->y * self->stride +
+        area->x * gdk_memory_format_bytes_per_pixel (texture->format);
 
   gdk_memory_convert (data, stride,
                       format,
-                      (guchar *) g_bytes_get_data (self->bytes, NULL),
+                      src,
                       self->stride,
                       texture->format,
-                      gdk_texture_get_width (texture),
-                      gdk_texture_get_height (texture));
+                      area->width,
+                      area->height);
 }
 
 static void
@@ -201,6 +213,62 @@ gdk_memory_texture_new_subtexture (GdkMemoryTexture  *source,
   return result;
 }
 
+/*<private>
+ * gdk_memory_texture_new_atlas_entry:
+ * @atlas: the atlas page
+ * @x: the x position of the entry on @atlas
+ * @y: the y position of the entry on @atlas
+ * @width: the width of the entry
+ * @height: the height of the entry
+ *
+ * Creates a subtexture of @atlas that remembers where it came from,
+ * so that renderers can draw it from the image they keep for @atlas
+ * instead of uploading it on its own.
+ *
+ * Returns: (transfer full): the new texture
+ */
+GdkTexture *
+gdk_memory_texture_new_atlas_entry (GdkMemoryTexture *atlas,
+                                    int               x,
+                                    int               y,
+                                    int               width,
+                                    int               height)
+{
+  GdkMemoryTexture *self;
+
+  self = GDK_MEMORY_TEXTURE (gdk_memory_texture_new_subtexture (atlas, x, y, width, height));
+  if (self == NULL)
+    return NULL;
+
+  self->atlas = g_object_ref (GDK_TEXTURE (atlas));
+  self->atlas_x = x;
+  self->atlas_y = y;
+
+  return GDK_TEXTURE (self);
+}
+
+/*<private>
+ * gdk_memory_texture_get_atlas:
+ * @self: a `GdkMemoryTexture`
+ * @out_x: (out): return location for the x position on the atlas page
+ * @out_y: (out): return location for the y position on the atlas page
+ *
+ * Gets the atlas page that @self was created from with
+ * gdk_memory_texture_new_atlas_entry().
+ *
+ * Returns: (transfer none) (nullable): the atlas page
+ */
+GdkTexture *
+gdk_memory_texture_get_atlas (GdkMemoryTexture *self,
+                              int              *out_x,
+                              int              *out_y)
+{
+  *out_x = self->atlas_x;
+  *out_y = self->atlas_y;
+
+  return self->atlas;
+}
+
 GdkMemoryTexture *
 gdk_memory_texture_from_texture (GdkTexture      *texture,
                                  GdkMemoryFormat  format)
@@ -35,6 +35,14 @@ GdkTexture *            gdk_memory_texture_new_subtexture   (GdkMemoryTexture  *
                                                              int                y,
                                                              int                width,
                                                              int                height);
+GdkTexture *            gdk_memory_texture_new_atlas_entry  (GdkMemoryTexture  *atlas,
+                                                             int                x,
+                                                             int                y,
+                                                             int                width,
+                                                             int                height);
+GdkTexture *            gdk_memory_texture_get_atlas        (GdkMemoryTexture  *self,
+                                                             int               *out_x,
+                                                             int               *out_y);
 
 GBytes *                gdk_memory_texture_get_bytes        (GdkMemoryTexture  *self,
                                                              gsize             *out_stride);
@@ -0,0 +1,102 @@
+#include "config.h"
+
+#include "gdkparalleltaskprivate.h"
+
+typedef struct _TaskData TaskData;
+
+struct _TaskData
+{
+  GdkTaskFunc task_func;
+  gpointer task_data;
+
+  GMutex mutex;
+  GCond cond;
+  guint n_running_tasks;
+};
+
+static GPrivate in_parallel_task;
+
+static void
+gdk_parallel_task_thread_func (gpointer data,
+                               gpointer unused)
+{
+  TaskData *task = data;
+  gpointer was_in_task;
+
+  was_in_task = g_private_get (&in_parallel_task);
+  g_private_set (&in_parallel_task, GINT_TO_POINTER (TRUE));
+  task->task_func (task->task_data);
+  g_private_set (&in_parallel_task, was_in_task);
+
+  g_mutex_lock (&task->mutex);
+  task->n_running_tasks--;
+  if (task->n_running_tasks == 0)
+    g_cond_signal (&task->cond);
+  g_mutex_unlock (&task->mutex);
+}
+
+/*
+ * gdk_parallel_task_run:
+ * @task_func: the function to run
+ * @task_data: data to pass to @task_func
+ * @n_tasks: how often to run @task_func
+ *
+ * Runs @task_func @n_tasks times in parallel, using a shared pool of
+ * worker threads and the calling thread, and waits for all of them to
+ * finish.
+ *
+ * The function is called with the same data every time, so it is up to
+ * it to split the work, usually via an atomic counter.
+ *
+ * Because the calling thread takes part in the work, it is fine if the
+ * thread pool is busy or cannot create more threads. At worst, all tasks
+ * end up running in the calling thread.
+ *
+ * Calls from inside a running task do not use the pool, as waiting on it
+ * from a worker thread could deadlock. @task_func is run once instead, so
+ * it must be able to do all the work on its own.
+ */
+void
+gdk_parallel_task_run (GdkTaskFunc task_func,
+                       gpointer    task_data,
+                       guint       n_tasks)
+{
+  static GThreadPool *pool;
+  TaskData task;
+  guint i;
+
+  if (n_tasks <= 1 || g_private_get (&in_parallel_task))
+    {
+      task_func (task_data);
+      return;
+    }
+
+  if (g_once_init_enter (&pool))
+    {
+      GThreadPool *the_pool = g_thread_pool_new (gdk_parallel_task_thread_func,
+                                                 NULL,
+                                                 MAX (2, g_get_num_processors ()) - 1,
+                                                 FALSE,
+                                                 NULL);
+      g_once_init_leave (&pool, the_pool);
+    }
+
+  task.task_func = task_func;
+  task.task_data = task_data;
+  g_mutex_init (&task.mutex);
+  g_cond_init (&task.cond);
+  task.n_running_tasks = n_tasks;
+
+  for (i = 1; i < n_tasks; i++)
+    g_thread_pool_push (pool, &task, NULL);
+
+  gdk_parallel_task_thread_func (&task, NULL);
+
+  g_mutex_lock (&task.mutex);
+  while (task.n_running_tasks > 0)
+    g_cond_wait (&task.cond, &task.mutex);
+  g_mutex_unlock (&task.mutex);
+
+  g_mutex_clear (&task.mutex);
+  g_cond_clear (&task.cond);
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef void (* GdkTaskFunc) (gpointer task_data);
+
+void                    gdk_parallel_task_run                   (GdkTaskFunc             task_func,
+                                                                 gpointer                task_data,
+                                                                 guint                   n_tasks);
+
+G_END_DECLS
@@ -0,0 +1,212 @@
+#include "config.h"
+
+#include "gdkresourceatlasprivate.h"
+
+#include "gdkmemorytextureprivate.h"
+
+#include <string.h>
+
+/* Images in resources can be packed into atlas pages at build time with
+ * gtk4-pack-atlas. Textures for them are then created as subtextures of
+ * the page, so the page is loaded once, and renderers can draw all of
+ * them from a single image.
+ *
+ * The index of every resource directory is loaded the first time an
+ * image from that directory is needed. Pages are only kept alive by the
+ * textures that were created from them.
+ */
+
+typedef struct _AtlasEntry AtlasEntry;
+typedef struct _Atlas Atlas;
+
+struct _AtlasEntry
+{
+  guint page;
+  guint16 x;
+  guint16 y;
+  guint16 width;
+  guint16 height;
+};
+
+struct _Atlas
+{
+  char *dir;
+  GHashTable *entries;
+  guint n_pages;
+  GWeakRef *pages;
+};
+
+G_LOCK_DEFINE_STATIC (atlases);
+static GHashTable *atlases;
+
+static void
+atlas_free (gpointer data)
+{
+  Atlas *atlas = data;
+  guint i;
+
+  if (atlas == NULL)
+    return;
+
+  for (i = 0; i < atlas->n_pages; i++)
+    g_weak_ref_clear (&atlas->pages[i]);
+  g_free (atlas->pages);
+  g_hash_table_unref (atlas->entries);
+  g_free (atlas->dir);
+  g_free (atlas);
+}
+
+static Atlas *
+atlas_load (const char *dir)
+{
+  Atlas *atlas;
+  GVariant *index;
+  GVariantIter *iter;
+  GBytes *bytes;
+  char *path;
+  const char *name;
+  AtlasEntry entry;
+  guint version, i;
+
+  path = g_strconcat (dir, GDK_RESOURCE_ATLAS_INDEX, NULL);
+  bytes = g_resources_lookup_data (path, 0, NULL);
+  g_free (path);
+  if (bytes == NULL)
+    return NULL;
+
+  index = g_variant_new_from_bytes (G_VARIANT_TYPE (GDK_RESOURCE_ATLAS_FORMAT), bytes, FALSE);
+  g_bytes_unref (bytes);
+
+  g_variant_get (index, "(ua{s(uqqqq)})", &version, &iter);
+  if (version != GDK_RESOURCE_ATLAS_VERSION)
+    {
+      g_variant_iter_free (iter);
+      g_variant_unref (index);
+      return NULL;
+    }
+
+  atlas = g_new0 (Atlas, 1);
+  atlas->dir = g_strdup (dir);
+  atlas->entries = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+  while (g_variant_iter_next (iter, "{&s(uqqqq)}",
+                              &name, &entry.page, &entry.x, &entry.y, &entry.width, &entry.height))
+    {
+      if (entry.width == 0 || entry.height == 0)
+        continue;
+
+      g_hash_table_insert (atlas->entries, g_strdup (name), g_memdup2 (&entry, sizeof (AtlasEntry)));
+      atlas->n_pages = MAX (atlas->n_pages, entry.page + 1);
+    }
+
+  g_variant_iter_free (iter);
+  g_variant_unref (index);
+
+  atlas->pages = g_new (GWeakRef, atlas->n_pages);
+  for (i = 0; i < atlas->n_pages; i++)
+    g_weak_ref_init (&atlas->pages[i], NULL);
+
+  return atlas;
+}
+
+static GdkTexture *
+atlas_get_page (Atlas *atlas,
+                guint  page)
+{
+  GdkTexture *texture;
+  GBytes *bytes;
+  char *name, *path;
+
+  texture = g_weak_ref_get (&atlas->pages[page]);
+  if (texture)
+    return texture;
+
+  name = g_strdup_printf (GDK_RESOURCE_ATLAS_PAGE, page);
+  path = g_strconcat (atlas->dir, name, NULL);
+  bytes = g_resources_lookup_data (path, 0, NULL);
+  g_free (path);
+  g_free (name);
+  if (bytes == NULL)
+    return NULL;
+
+  texture = gdk_texture_new_from_bytes (bytes, NULL);
+  g_bytes_unref (bytes);
+  if (texture == NULL)
+    return NULL;
+
+  if (!GDK_IS_MEMORY_TEXTURE (texture))
+    {
+      GdkTexture *memtex;
+
+      memtex = GDK_TEXTURE (gdk_memory_texture_from_texture (texture, gdk_texture_get_format (texture)));
+      g_object_unref (texture);
+      texture = memtex;
+    }
+
+  g_weak_ref_set (&atlas->pages[page], texture);
+
+  return texture;
+}
+
+/*<private>
+ * gdk_resource_atlas_lookup:
+ * @resource_path: the path of an image resource
+ *
+ * Looks for @resource_path in the atlas of its resource directory.
+ *
+ * Returns: (transfer full) (nullable): a texture for @resource_path,
+ *   or %NULL if it was not packed into an atlas
+ */
+GdkTexture *
+gdk_resource_atlas_lookup (const char *resource_path)
+{
+  const char *slash;
+  char *dir;
+  Atlas *atlas;
+  const AtlasEntry *entry;
+  GdkTexture *page, *texture;
+
+  slash = strrchr (resource_path, '/');
+  if (slash == NULL)
+    return NULL;
+
+  dir = g_strndup (resource_path, slash - resource_path + 1);
+
+  G_LOCK (atlases);
+
+  if (atlases == NULL)
+    atlases = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, atlas_free);
+
+  if (!g_hash_table_lookup_extended (atlases, dir, NULL, (gpointer *) &atlas))
+    {
+      /* Directories without an atlas are remembered, too */
+      atlas = atlas_load (dir);
+      g_hash_table_insert (atlases, g_strdup (dir), atlas);
+    }
+
+  texture = NULL;
+
+  if (atlas)
+    {
+      entry = g_hash_table_lookup (atlas->entries, slash + 1);
+      if (entry)
+        {
+          page = atlas_get_page (atlas, entry->page);
+          if (page)
+            {
+              if (entry->x + entry->width <= gdk_texture_get_width (page) &&
+                  entry->y + entry->height <= gdk_texture_get_height (page))
+                texture = gdk_memory_texture_new_atlas_entry (GDK_MEMORY_TEXTURE (page),
+                                                              entry->x, entry->y,
+                                                              entry->width, entry->height);
+              g_object_unref (page);
+            }
+        }
+    }
+
+  G_UNLOCK (atlases);
+
+  g_free (dir);
+
+  return texture;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "gdktexture.h"
+
+G_BEGIN_DECLS
+
+/* The files written by gtk4-pack-atlas. They are looked up in the
+ * resource directory of the images that were packed.
+ */
+#define GDK_RESOURCE_ATLAS_INDEX        "gtk-atlas.index"
+#define GDK_RESOURCE_ATLAS_PAGE         "gtk-atlas-%u.png"
+
+/* Version, then basename => (page, x, y, width, height) */
+#define GDK_RESOURCE_ATLAS_VERSION      1
+#define GDK_RESOURCE_ATLAS_FORMAT       "(ua{s(uqqqq)})"
+
+GdkTexture *            gdk_resource_atlas_lookup               (const char             *resource_path);
+
+G_END_DECLS
@@ -0,0 +1,307 @@
+#include "config.h"
+
+#include "gdkshmprivate.h"
+
+#include "gdkmemoryformatprivate.h"
+#include "gdktexturedownloaderprivate.h"
+
+#ifdef HAVE_LINUX_MEMFD_H
+#include <linux/memfd.h>
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/* Shared memory that can be passed to other processes, like the
+ * compositor for wl_shm buffers.
+ *
+ * GBytes created here are backed by an anonymous file, and we keep a
+ * registry of them, so that the file can be found again from any
+ * GBytes pointing into the mapping, including subtextures.
+ */
+
+typedef struct _ShmBuffer ShmBuffer;
+
+struct _ShmBuffer
+{
+  guchar *data;
+  gsize size;
+  int fd;
+};
+
+static GMutex shm_lock;
+static GPtrArray *shm_buffers;
+
+/*
+ * gdk_shm_open:
+ * @name: name for the file, used for debugging
+ *
+ * Creates an anonymous file for shared memory, using memfd_create()
+ * where available and shm_open() otherwise.
+ *
+ * Returns: the file descriptor or -1 on error
+ */
+int
+gdk_shm_open (const char *name)
+{
+  static gboolean force_shm_open = FALSE;
+  int ret = -1;
+
+#if !defined (__NR_memfd_create)
+  force_shm_open = TRUE;
+#endif
+
+  do
+    {
+#if defined (__NR_memfd_create)
+      if (!force_shm_open)
+        {
+          int options = MFD_CLOEXEC;
+#if defined (MFD_ALLOW_SEALING)
+          options |= MFD_ALLOW_SEALING;
+#endif
+          ret = syscall (__NR_memfd_create, name, options);
+
+          /* fall back to shm_open until debian stops shipping 3.16 kernel
+           * See bug 766341
+           */
+          if (ret < 0 && errno == ENOSYS)
+            force_shm_open = TRUE;
+#if defined (F_ADD_SEALS) && defined (F_SEAL_SHRINK)
+          if (ret >= 0)
+            fcntl (ret, F_ADD_SEALS, F_SEAL_SHRINK);
+#endif
+        }
+#endif
+
+      if (force_shm_open)
+        {
+#if defined (__FreeBSD__)
+          ret = shm_open (SHM_ANON, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+#else
+          char shm_name[NAME_MAX - 1] = "";
+
+          g_snprintf (shm_name, sizeof (shm_name), "/%s-%x", name, g_random_int ());
+
+          ret = shm_open (shm_name, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+
+          if (ret >= 0)
+            shm_unlink (shm_name);
+          else if (errno == EEXIST)
+            continue;
+#endif
+        }
+    }
+  while (ret < 0 && errno == EINTR);
+
+  if (ret < 0)
+    g_critical (G_STRLOC ": creating shared memory file (using %s) failed: %m",
+                force_shm_open? "shm_open" : "memfd_create");
+
+  return ret;
+}
+
+static void
+shm_buffer_free (gpointer data)
+{
+  ShmBuffer *buffer = data;
+
+  g_mutex_lock (&shm_lock);
+  g_ptr_array_remove_fast (shm_buffers, buffer);
+  g_mutex_unlock (&shm_lock);
+
+  munmap (buffer->data, buffer->size);
+  close (buffer->fd);
+  g_free (buffer);
+}
+
+/*
+ * gdk_shm_bytes_new:
+ * @size: size of the memory
+ * @out_data: (out): the writable memory
+ *
+ * Allocates @size bytes of shared memory. The memory can be written to
+ * via @out_data until the bytes are shared.
+ *
+ * Returns: (nullable): the bytes or %NULL if shared memory is not
+ *   available
+ */
+GBytes *
+gdk_shm_bytes_new (gsize    size,
+                   guchar **out_data)
+{
+  ShmBuffer *buffer;
+  void *data;
+  int fd;
+
+  fd = gdk_shm_open ("gdk-shm");
+  if (fd < 0)
+    return NULL;
+
+  if (ftruncate (fd, size) < 0)
+    {
+      g_critical (G_STRLOC ": Truncating shared memory file failed: %m");
+      close (fd);
+      return NULL;
+    }
+
+  data = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED)
+    {
+      g_critical (G_STRLOC ": mmap'ping shared memory file failed: %m");
+      close (fd);
+      return NULL;
+    }
+
+  buffer = g_new (ShmBuffer, 1);
+  buffer->data = data;
+  buffer->size = size;
+  buffer->fd = fd;
+
+  g_mutex_lock (&shm_lock);
+  if (shm_buffers == NULL)
+    shm_buffers = g_ptr_array_new ();
+  g_ptr_array_add (shm_buffers, buffer);
+  g_mutex_unlock (&shm_lock);
+
+  *out_data = data;
+
+  return g_bytes_new_with_free_func (data, size, shm_buffer_free, buffer);
+}
+
+/*
+ * gdk_shm_bytes_get_fd:
+ * @bytes: a `GBytes`
+ * @out_offset: (out): offset of @bytes in the file
+ *
+ * Finds the shared memory file that holds @bytes, if @bytes points
+ * into memory created with gdk_shm_bytes_new().
+ *
+ * The file descriptor is owned by the memory, dup() it to keep it.
+ *
+ * Returns: the file descriptor or -1
+ */
+int
+gdk_shm_bytes_get_fd (GBytes *bytes,
+                      gsize  *out_offset)
+{
+  const guchar *data;
+  gsize size;
+  int fd = -1;
+  guint i;
+
+  data = g_bytes_get_data (bytes, &size);
+
+  g_mutex_lock (&shm_lock);
+
+  for (i = 0; shm_buffers && i < shm_buffers->len; i++)
+    {
+      ShmBuffer *buffer = g_ptr_array_index (shm_buffers, i);
+
+      if (data >= buffer->data &&
+          data + size <= buffer->data + buffer->size)
+        {
+          fd = buffer->fd;
+          *out_offset = data - buffer->data;
+          break;
+        }
+    }
+
+  g_mutex_unlock (&shm_lock);
+
+  return fd;
+}
+
+/*
+ * gdk_memory_texture_new_shm:
+ * @width: width of the texture
+ * @height: height of the texture
+ * @format: format of the texture
+ * @source: (nullable): texture to initialize the contents from
+ *
+ * Creates a memory texture backed by shared memory, whose file can be
+ * handed to other processes with gdk_memory_texture_get_shm_fd().
+ *
+ * If @source is already such a texture with the given size and format,
+ * it is returned without copying.
+ *
+ * Returns: (nullable): the new texture, or %NULL if shared memory is
+ *   not available
+ */
+GdkTexture *
+gdk_memory_texture_new_shm (int              width,
+                            int              height,
+                            GdkMemoryFormat  format,
+                            GdkTexture      *source)
+{
+  GdkTexture *texture;
+  GBytes *bytes;
+  guchar *data;
+  gsize stride, offset, size;
+
+  if (GDK_IS_MEMORY_TEXTURE (source) &&
+      gdk_texture_get_width (source) == width &&
+      gdk_texture_get_height (source) == height &&
+      gdk_texture_get_format (source) == format &&
+      gdk_memory_texture_get_shm_fd (GDK_MEMORY_TEXTURE (source), &offset, &stride) >= 0)
+    return g_object_ref (source);
+
+  stride = width * gdk_memory_format_bytes_per_pixel (format);
+  /* wl_shm and cairo want 4-byte aligned rows */
+  stride = (stride + 3) & ~3;
+  if (!g_size_checked_mul (&size, stride, height))
+    return NULL;
+
+  bytes = gdk_shm_bytes_new (size, &data);
+  if (bytes == NULL)
+    return NULL;
+
+  if (source)
+    {
+      GdkTextureDownloader downloader;
+
+      gdk_texture_downloader_init (&downloader, source);
+      gdk_texture_downloader_set_format (&downloader, format);
+      gdk_texture_downloader_download_into (&downloader, data, stride);
+      gdk_texture_downloader_finish (&downloader);
+    }
+  else
+    {
+      memset (data, 0, size);
+    }
+
+  texture = gdk_memory_texture_new (width, height, format, bytes, stride);
+  g_bytes_unref (bytes);
+
+  return texture;
+}
+
+/*
+ * gdk_memory_texture_get_shm_fd:
+ * @self: a `GdkMemoryTexture`
+ * @out_offset: (out): offset of the first row in the file
+ * @out_stride: (out): the stride of the texture
+ *
+ * If @self is backed by shared memory, returns the file holding it.
+ *
+ * The file descriptor is owned by the texture, dup() it to keep it.
+ *
+ * Returns: the file descriptor or -1
+ */
+int
+gdk_memory_texture_get_shm_fd (GdkMemoryTexture *self,
+                               gsize            *out_offset,
+                               gsize            *out_stride)
+{
+  GBytes *bytes;
+
+  bytes = gdk_memory_texture_get_bytes (self, out_stride);
+
+  return gdk_shm_bytes_get_fd (bytes, out_offset);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "gdkmemorytextureprivate.h"
+
+G_BEGIN_DECLS
+
+int                     gdk_shm_open                            (const char             *name);
+
+GBytes *                gdk_shm_bytes_new                       (gsize                   size,
+                                                                 guchar                **out_data);
+int                     gdk_shm_bytes_get_fd                    (GBytes                 *bytes,
+                                                                 gsize                  *out_offset);
+
+GdkTexture *            gdk_memory_texture_new_shm              (int                     width,
+                                                                 int                     height,
+                                                                 GdkMemoryFormat         format,
+                                                                 GdkTexture             *source);
+int                     gdk_memory_texture_get_shm_fd           (GdkMemoryTexture       *self,
+                                                                 gsize                  *out_offset,
+                                                                 gsize                  *out_stride);
+
+G_END_DECLS
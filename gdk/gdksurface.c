@@ -33,6 +33,7 @@
 #include "gdkcontentprovider.h"
 #include "gdkdeviceprivate.h"
 #include "gdkdisplayprivate.h"
+#include "gdkdmabufformats.h"
 #include "gdkdragsurfaceprivate.h"
 #include "gdkeventsprivate.h"
 #include "gdkframeclockidleprivate.h"
@@ -765,6 +766,7 @@ gdk_surface_finalize (GObject *object)
   g_clear_object (&surface->display);
 
   g_clear_pointer (&surface->opaque_region, cairo_region_destroy);
+  g_clear_pointer (&surface->scanout_formats, gdk_dmabuf_formats_unref);
 
   if (surface->parent)
     surface->parent->children = g_list_remove (surface->parent->children, surface);
@@ -2642,6 +2644,7 @@ gdk_surface_set_state (GdkSurface      *surface,
                        GdkToplevelState new_state)
 {
   gboolean was_sticky, sticky;
+  gboolean was_suspended, suspended;
   g_return_if_fail (GDK_IS_SURFACE (surface));
 
   if (new_state == surface->state)
@@ -2653,10 +2656,23 @@ gdk_surface_set_state (GdkSurface      *surface,
    */
 
   was_sticky = GDK_SURFACE_IS_STICKY (surface);
+  was_suspended = (surface->state & GDK_TOPLEVEL_STATE_SUSPENDED) != 0;
 
   surface->state = new_state;
 
   sticky = GDK_SURFACE_IS_STICKY (surface);
+  suspended = (surface->state & GDK_TOPLEVEL_STATE_SUSPENDED) != 0;
+
+  /* Nobody can see a suspended surface, so don't run tick
+   * callbacks or paint it until it becomes visible again.
+   */
+  if (was_suspended != suspended && !GDK_SURFACE_DESTROYED (surface))
+    {
+      if (suspended)
+        gdk_surface_freeze_updates (surface);
+      else
+        gdk_surface_thaw_updates (surface);
+    }
 
   if (GDK_IS_TOPLEVEL (surface))
     g_object_notify (G_OBJECT (surface), "state");
@@ -3076,3 +3092,44 @@ gdk_surface_get_subsurface (GdkSurface *surface,
 {
   return g_ptr_array_index (surface->subsurfaces, idx);
 }
+
+/*
+ * gdk_surface_set_scanout_formats:
+ * @surface: a `GdkSurface`
+ * @formats: (nullable): the formats that can be scanned out
+ *
+ * Sets the dmabuf formats that the display server can put on screen
+ * directly when they are used for content of @surface.
+ *
+ * Backends call this whenever the display server changes its
+ * preferences, so renderers pick them up on their next allocation.
+ */
+void
+gdk_surface_set_scanout_formats (GdkSurface       *surface,
+                                 GdkDmabufFormats *formats)
+{
+  if (gdk_dmabuf_formats_equal (surface->scanout_formats, formats))
+    return;
+
+  g_clear_pointer (&surface->scanout_formats, gdk_dmabuf_formats_unref);
+  if (formats)
+    surface->scanout_formats = gdk_dmabuf_formats_ref (formats);
+
+  GDK_DISPLAY_DEBUG (surface->display, DMABUF,
+                     "surface %p: %zu scanout formats",
+                     surface,
+                     formats ? gdk_dmabuf_formats_get_n_formats (formats) : 0);
+}
+
+/*
+ * gdk_surface_get_scanout_formats:
+ * @surface: a `GdkSurface`
+ *
+ * Returns: (transfer none) (nullable): the formats that can be
+ *   scanned out for @surface, or %NULL if that is not known
+ */
+GdkDmabufFormats *
+gdk_surface_get_scanout_formats (GdkSurface *surface)
+{
+  return surface->scanout_formats;
+}
@@ -105,6 +105,9 @@ struct _GdkSurface
    */
   GdkSubsurface *subsurfaces_above;
   GdkSubsurface *subsurfaces_below;
+
+  /* The formats the compositor can scan out when used for this surface */
+  GdkDmabufFormats *scanout_formats;
 };
 
 struct _GdkSurfaceClass
@@ -355,4 +358,8 @@ gsize           gdk_surface_get_n_subsurfaces  (GdkSurface          *surface);
 GdkSubsurface * gdk_surface_get_subsurface     (GdkSurface          *surface,
                                                 gsize                idx);
 
+void               gdk_surface_set_scanout_formats (GdkSurface       *surface,
+                                                    GdkDmabufFormats *formats);
+GdkDmabufFormats * gdk_surface_get_scanout_formats (GdkSurface       *surface);
+
 G_END_DECLS
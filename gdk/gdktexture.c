@@ -41,14 +41,19 @@
 #include "gdktextureprivate.h"
 
 #include <glib/gi18n-lib.h>
+#include "gdkallocationsprivate.h"
+#include "gdkdecodeschedulerprivate.h"
+#include "gdkmemoryformatprivate.h"
 #include "gdkmemorytextureprivate.h"
 #include "gdkpaintable.h"
+#include "gdkresourceatlasprivate.h"
 #include "gdksnapshot.h"
 
 #include <graphene.h>
 #include "loaders/gdkpngprivate.h"
 #include "loaders/gdktiffprivate.h"
 #include "loaders/gdkjpegprivate.h"
+#include "loaders/gdkddsprivate.h"
 
 G_DEFINE_QUARK (gdk-texture-error-quark, gdk_texture_error)
 
@@ -206,7 +211,7 @@ gdk_texture_loadable_icon_load_async (GLoadableIcon       *icon,
   GTask *task;
 
   task = g_task_new (icon, cancellable, callback, user_data);
-  g_task_run_in_thread (task, gdk_texture_loadable_icon_load_in_thread);
+  gdk_decode_scheduler_run (task, gdk_texture_loadable_icon_load_in_thread);
   g_object_unref (task);
 }
 
@@ -249,10 +254,11 @@ G_DEFINE_ABSTRACT_TYPE_WITH_CODE (GdkTexture, gdk_texture, G_TYPE_OBJECT,
   g_critical ("Texture of type '%s' does not implement GdkTexture::" # method, G_OBJECT_TYPE_NAME (obj))
 
 static void
-gdk_texture_default_download (GdkTexture      *texture,
-                              GdkMemoryFormat  format,
-                              guchar          *data,
-                              gsize            stride)
+gdk_texture_default_download (GdkTexture         *texture,
+                              const GdkRectangle *area,
+                              GdkMemoryFormat     format,
+                              guchar             *data,
+                              gsize               stride)
 {
   GDK_TEXTURE_WARN_NOT_IMPLEMENTED_METHOD (texture, download);
 }
@@ -305,6 +311,27 @@ gdk_texture_get_property (GObject    *gobject,
     }
 }
 
+static void
+gdk_texture_constructed (GObject *object)
+{
+  GdkTexture *self = GDK_TEXTURE (object);
+
+  G_OBJECT_CLASS (gdk_texture_parent_class)->constructed (object);
+
+  /* Subclasses only set the format after construction,
+   * so assume 4 bytes per pixel
+   */
+  gdk_allocation_add (GDK_ALLOCATION_TEXTURE, (gsize) self->width * self->height * 4);
+}
+
+static void
+gdk_texture_finalize (GObject *object)
+{
+  gdk_allocation_remove (GDK_ALLOCATION_TEXTURE);
+
+  G_OBJECT_CLASS (gdk_texture_parent_class)->finalize (object);
+}
+
 static void
 gdk_texture_dispose (GObject *object)
 {
@@ -349,7 +376,9 @@ gdk_texture_class_init (GdkTextureClass *klass)
 
   gobject_class->set_property = gdk_texture_set_property;
   gobject_class->get_property = gdk_texture_get_property;
+  gobject_class->constructed = gdk_texture_constructed;
   gobject_class->dispose = gdk_texture_dispose;
+  gobject_class->finalize = gdk_texture_finalize;
 
   /**
    * GdkTexture:width: (attributes org.gtk.Property.get=gdk_texture_get_width)
@@ -480,6 +509,10 @@ gdk_texture_new_for_pixbuf (GdkPixbuf *pixbuf)
  * If you are unsure about the validity of a resource, use
  * [ctor@Gdk.Texture.new_from_file] to load it.
  *
+ * If the image was packed into an atlas with `gtk4-pack-atlas`, and
+ * the atlas was added to the same resource directory, the texture
+ * shares its pixels with the atlas page.
+ *
  * This function is threadsafe, so that you can e.g. use GTask
  * and [method@Gio.Task.run_in_thread] to avoid blocking the main thread
  * while loading a big image.
@@ -495,6 +528,10 @@ gdk_texture_new_from_resource (const char *resource_path)
 
   g_return_val_if_fail (resource_path != NULL, NULL);
 
+  texture = gdk_resource_atlas_lookup (resource_path);
+  if (texture)
+    return texture;
+
   bytes = g_resources_lookup_data (resource_path, 0, &error);
   if (bytes != NULL)
     {
@@ -518,7 +555,7 @@ gdk_texture_new_from_resource (const char *resource_path)
  * Creates a new texture by loading an image from a file.
  *
  * The file format is detected automatically. The supported formats
- * are PNG, JPEG and TIFF, though more formats might be available.
+ * are PNG, JPEG, TIFF and DDS, though more formats might be available.
  *
  * If %NULL is returned, then @error will be set.
  *
@@ -532,19 +569,70 @@ GdkTexture *
 gdk_texture_new_from_file (GFile   *file,
                            GError **error)
 {
-  GBytes *bytes;
+  GInputStream *stream;
   GdkTexture *texture;
 
   g_return_val_if_fail (G_IS_FILE (file), NULL);
   g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-  bytes = g_file_load_bytes (file, NULL, NULL, error);
-  if (bytes == NULL)
+  stream = G_INPUT_STREAM (g_file_read (file, NULL, error));
+  if (stream == NULL)
     return NULL;
 
-  texture = gdk_texture_new_from_bytes (bytes, error);
+  texture = gdk_texture_new_from_stream (stream, 0, 0, NULL, NULL, NULL, error);
 
-  g_bytes_unref (bytes);
+  g_object_unref (stream);
+
+  return texture;
+}
+
+/**
+ * gdk_texture_new_from_file_at_size:
+ * @file: `GFile` to load
+ * @width: the width the texture is needed at
+ * @height: the height the texture is needed at
+ * @error: Return location for an error
+ *
+ * Creates a new texture by loading an image from a file, scaling it
+ * down while decoding if it is much larger than @width x @height.
+ *
+ * The size is a hint. The image keeps its aspect ratio and is only
+ * ever scaled down by integer factors, so that the resulting texture
+ * is at least as large as the given size in both dimensions, unless
+ * the image is smaller than that. Some images are always loaded at
+ * their full size.
+ *
+ * This is much faster and needs much less memory than loading the
+ * full image in order to display it at a small size, such as for
+ * thumbnails.
+ *
+ * See [ctor@Gdk.Texture.new_from_file] for details.
+ *
+ * Return value: A newly-created `GdkTexture`
+ *
+ * Since: 4.16
+ */
+GdkTexture *
+gdk_texture_new_from_file_at_size (GFile   *file,
+                                   int      width,
+                                   int      height,
+                                   GError **error)
+{
+  GInputStream *stream;
+  GdkTexture *texture;
+
+  g_return_val_if_fail (G_IS_FILE (file), NULL);
+  g_return_val_if_fail (width > 0, NULL);
+  g_return_val_if_fail (height > 0, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  stream = G_INPUT_STREAM (g_file_read (file, NULL, error));
+  if (stream == NULL)
+    return NULL;
+
+  texture = gdk_texture_new_from_stream (stream, width, height, NULL, NULL, NULL, error);
+
+  g_object_unref (stream);
 
   return texture;
 }
@@ -554,7 +642,8 @@ gdk_texture_can_load (GBytes *bytes)
 {
   return gdk_is_png (bytes) ||
          gdk_is_jpeg (bytes) ||
-         gdk_is_tiff (bytes);
+         gdk_is_tiff (bytes) ||
+         gdk_is_dds (bytes);
 }
 
 static GdkTexture *
@@ -573,6 +662,10 @@ gdk_texture_new_from_bytes_internal (GBytes  *bytes,
     {
       return gdk_load_tiff (bytes, error);
     }
+  else if (gdk_is_dds (bytes))
+    {
+      return gdk_load_dds (bytes, error);
+    }
   else
     {
       g_set_error_literal (error,
@@ -611,7 +704,7 @@ gdk_texture_new_from_bytes_pixbuf (GBytes  *bytes,
  * Creates a new texture by loading an image from memory,
  *
  * The file format is detected automatically. The supported formats
- * are PNG, JPEG and TIFF, though more formats might be available.
+ * are PNG, JPEG, TIFF and DDS, though more formats might be available.
  *
  * If %NULL is returned, then @error will be set.
  *
@@ -649,6 +742,129 @@ gdk_texture_new_from_bytes (GBytes  *bytes,
   return gdk_texture_new_from_bytes_pixbuf (bytes, error);
 }
 
+static GdkTexture *
+gdk_texture_new_from_stream_bytes (GInputStream  *stream,
+                                   int            width,
+                                   int            height,
+                                   GCancellable  *cancellable,
+                                   GError       **error)
+{
+  GOutputStream *output;
+  GdkTexture *texture;
+  GBytes *bytes;
+
+  output = g_memory_output_stream_new_resizable ();
+  if (g_output_stream_splice (output, stream,
+                              G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+                              cancellable, error) < 0)
+    {
+      g_object_unref (output);
+      return NULL;
+    }
+
+  bytes = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (output));
+  g_object_unref (output);
+
+  if (width > 0 && height > 0 && gdk_is_tiff (bytes))
+    texture = gdk_load_tiff_at_size (bytes, width, height, error);
+  else
+    texture = gdk_texture_new_from_bytes (bytes, error);
+  g_bytes_unref (bytes);
+
+  return texture;
+}
+
+/*
+ * gdk_texture_new_from_stream:
+ * @stream: the stream to load from
+ * @width: the width to decode at, or 0 for the full size
+ * @height: the height to decode at, or 0 for the full size
+ * @progress: (nullable): function to call with partial results
+ * @progress_data: data to pass to @progress
+ * @cancellable: (nullable): a `GCancellable`
+ * @error: return location for an error
+ *
+ * Loads a texture from @stream.
+ *
+ * PNG and JPEG images are decoded while they are read, so the
+ * compressed data is never held in memory as a whole. Interlaced PNG
+ * passes and progressive JPEG scans are passed to @progress as partial
+ * textures while loading, which allows showing large images early.
+ *
+ * Other formats are read into memory and loaded like
+ * [ctor@Gdk.Texture.new_from_bytes].
+ *
+ * If a size is given, loaders that support it scale the image down
+ * while decoding, see [ctor@Gdk.Texture.new_from_file_at_size].
+ *
+ * Returns: (transfer full) (nullable): the loaded texture
+ */
+GdkTexture *
+gdk_texture_new_from_stream (GInputStream            *stream,
+                             int                      width,
+                             int                      height,
+                             GdkTextureProgressFunc   progress,
+                             gpointer                 progress_data,
+                             GCancellable            *cancellable,
+                             GError                 **error)
+{
+  GInputStream *buffered;
+  GdkTexture *texture;
+  GError *internal_error = NULL;
+  GBytes *header;
+  const guchar *data;
+  gsize size;
+
+  g_return_val_if_fail (G_IS_INPUT_STREAM (stream), NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  buffered = g_buffered_input_stream_new (stream);
+  g_filter_input_stream_set_close_base_stream (G_FILTER_INPUT_STREAM (buffered), FALSE);
+
+  if (g_buffered_input_stream_fill (G_BUFFERED_INPUT_STREAM (buffered), 16, cancellable, error) < 0)
+    {
+      g_object_unref (buffered);
+      return NULL;
+    }
+
+  data = g_buffered_input_stream_peek_buffer (G_BUFFERED_INPUT_STREAM (buffered), &size);
+  header = g_bytes_new_static (data, size);
+
+  if (gdk_is_png (header))
+    texture = gdk_load_png_from_stream (buffered, width, height, progress, progress_data, cancellable, &internal_error);
+  else if (gdk_is_jpeg (header))
+    texture = gdk_load_jpeg_from_stream (buffered, width, height, progress, progress_data, cancellable, &internal_error);
+  else
+    {
+      g_bytes_unref (header);
+      texture = gdk_texture_new_from_stream_bytes (buffered, width, height, cancellable, error);
+      g_object_unref (buffered);
+      return texture;
+    }
+
+  g_bytes_unref (header);
+
+  /* Content the loaders can't handle may still work with gdk-pixbuf,
+   * but that needs the data from the start */
+  if (texture == NULL &&
+      g_error_matches (internal_error, GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_UNSUPPORTED_CONTENT) &&
+      G_IS_SEEKABLE (stream) &&
+      g_seekable_can_seek (G_SEEKABLE (stream)) &&
+      g_seekable_seek (G_SEEKABLE (stream), 0, G_SEEK_SET, cancellable, NULL))
+    {
+      g_clear_error (&internal_error);
+      g_object_unref (buffered);
+      return gdk_texture_new_from_stream_bytes (stream, width, height, cancellable, error);
+    }
+
+  if (internal_error)
+    g_propagate_error (error, internal_error);
+
+  g_object_unref (buffered);
+
+  return texture;
+}
+
 /**
  * gdk_texture_new_from_filename:
  * @path: (type filename): the filename to load
@@ -657,7 +873,7 @@ gdk_texture_new_from_bytes (GBytes  *bytes,
  * Creates a new texture by loading an image from a file.
  *
  * The file format is detected automatically. The supported formats
- * are PNG, JPEG and TIFF, though more formats might be available.
+ * are PNG, JPEG, TIFF and DDS, though more formats might be available.
  *
  * If %NULL is returned, then @error will be set.
  *
@@ -726,7 +942,73 @@ gdk_texture_do_download (GdkTexture      *texture,
                          guchar          *data,
                          gsize            stride)
 {
-  GDK_TEXTURE_GET_CLASS (texture)->download (texture, format, data, stride);
+  GDK_TEXTURE_GET_CLASS (texture)->download (texture,
+                                             &(GdkRectangle) { 0, 0, texture->width, texture->height },
+                                             format,
+                                             data,
+                                             stride);
+}
+
+/*< private >
+ * gdk_texture_do_download_area:
+ * @texture: a `GdkTexture`
+ * @area: the area to download, which must be inside @texture
+ * @format: the format to download in
+ * @data: memory for @area in @format
+ * @stride: rowstride of @data
+ *
+ * Downloads part of a texture. The first row of @data is the
+ * top row of @area.
+ */
+void
+gdk_texture_do_download_area (GdkTexture         *texture,
+                              const GdkRectangle *area,
+                              GdkMemoryFormat     format,
+                              guchar             *data,
+                              gsize               stride)
+{
+  g_assert (area->x >= 0 && area->y >= 0 && area->width > 0 && area->height > 0);
+  g_assert (area->x + area->width <= texture->width);
+  g_assert (area->y + area->height <= texture->height);
+
+  GDK_TEXTURE_GET_CLASS (texture)->download (texture, area, format, data, stride);
+}
+
+/*< private >
+ * gdk_texture_download_area_fallback:
+ * @texture: a `GdkTexture`
+ * @area: the area to download
+ * @format: the format to download in
+ * @data: memory for @area in @format
+ * @stride: rowstride of @data
+ *
+ * Downloads the whole texture in its own format and converts @area from
+ * that. For implementations that have no cheaper way to download an area.
+ */
+void
+gdk_texture_download_area_fallback (GdkTexture         *texture,
+                                    const GdkRectangle *area,
+                                    GdkMemoryFormat     format,
+                                    guchar             *data,
+                                    gsize               stride)
+{
+  GdkMemoryFormat src_format;
+  gsize src_bpp, src_stride;
+  guchar *src_data;
+
+  src_format = gdk_texture_get_format (texture);
+  src_bpp = gdk_memory_format_bytes_per_pixel (src_format);
+  src_stride = texture->width * src_bpp;
+  src_data = g_malloc_n (src_stride, texture->height);
+
+  gdk_texture_do_download (texture, src_format, src_data, src_stride);
+
+  gdk_memory_convert (data, stride, format,
+                      src_data + area->y * src_stride + area->x * src_bpp,
+                      src_stride, src_format,
+                      area->width, area->height);
+
+  g_free (src_data);
 }
 
 static gboolean
@@ -69,6 +69,11 @@ GdkTexture *            gdk_texture_new_from_resource          (const char
 GDK_AVAILABLE_IN_ALL
 GdkTexture *            gdk_texture_new_from_file              (GFile           *file,
                                                                 GError         **error);
+GDK_AVAILABLE_IN_4_16
+GdkTexture *            gdk_texture_new_from_file_at_size      (GFile           *file,
+                                                                int              width,
+                                                                int              height,
+                                                                GError         **error);
 GDK_AVAILABLE_IN_4_6
 GdkTexture *            gdk_texture_new_from_filename          (const char      *path,
                                                                 GError         **error);
@@ -222,6 +222,40 @@ gdk_texture_downloader_download_into (const GdkTextureDownloader *self,
   gdk_texture_do_download (self->texture, self->format, data, stride);
 }
 
+/**
+ * gdk_texture_downloader_download_area_into:
+ * @self: a texture downloader
+ * @area: the area of the texture to download
+ * @data: (array): pointer to enough memory to be filled with the
+ *   downloaded data of the area
+ * @stride: rowstride in bytes
+ *
+ * Downloads the given @area of the texture into local memory.
+ *
+ * The top left pixel of @area ends up at the start of @data.
+ * For textures that live on the GPU, this avoids transferring
+ * the parts of the texture outside of @area where possible.
+ *
+ * Since: 4.16
+ **/
+void
+gdk_texture_downloader_download_area_into (const GdkTextureDownloader *self,
+                                           const GdkRectangle         *area,
+                                           guchar                     *data,
+                                           gsize                       stride)
+{
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (area != NULL);
+  g_return_if_fail (area->x >= 0 && area->y >= 0);
+  g_return_if_fail (area->width > 0 && area->height > 0);
+  g_return_if_fail (area->x + area->width <= gdk_texture_get_width (self->texture));
+  g_return_if_fail (area->y + area->height <= gdk_texture_get_height (self->texture));
+  g_return_if_fail (data != NULL);
+  g_return_if_fail (stride >= area->width * gdk_memory_format_bytes_per_pixel (self->format));
+
+  gdk_texture_do_download_area (self->texture, area, self->format, data, stride);
+}
+
 /**
  * gdk_texture_downloader_download_bytes:
  * @self: the downloader
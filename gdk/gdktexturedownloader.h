@@ -54,6 +54,12 @@ GDK_AVAILABLE_IN_4_10
 void                    gdk_texture_downloader_download_into    (const GdkTextureDownloader     *self,
                                                                  guchar                         *data,
                                                                  gsize                           stride);
+GDK_AVAILABLE_IN_4_16
+void                    gdk_texture_downloader_download_area_into
+                                                                (const GdkTextureDownloader     *self,
+                                                                 const GdkRectangle             *area,
+                                                                 guchar                         *data,
+                                                                 gsize                           stride);
 GDK_AVAILABLE_IN_4_10
 GBytes *                gdk_texture_downloader_download_bytes   (const GdkTextureDownloader     *self,
                                                                  gsize                          *out_stride);
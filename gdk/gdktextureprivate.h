@@ -43,14 +43,44 @@ struct _GdkTexture
 struct _GdkTextureClass {
   GObjectClass parent_class;
 
-  /* mandatory: Download in the given format into data */
+  /* mandatory: Download the given area in the given format into data */
   void                  (* download)                    (GdkTexture             *texture,
+                                                         const GdkRectangle     *area,
                                                          GdkMemoryFormat         format,
                                                          guchar                 *data,
                                                          gsize                   stride);
 };
 
+typedef void (* GdkTextureProgressFunc) (GdkTexture *partial,
+                                         gpointer    user_data);
+
+/*
+ * gdk_texture_get_downscale_factor:
+ *
+ * Computes the largest integer factor an image of the given size can be
+ * scaled down by while staying at least as large as the target size in
+ * both dimensions. A target size of 0 means no scaling.
+ */
+static inline guint
+gdk_texture_get_downscale_factor (guint width,
+                                  guint height,
+                                  int   target_width,
+                                  int   target_height)
+{
+  if (target_width <= 0 || target_height <= 0)
+    return 1;
+
+  return MAX (1, MIN (width / target_width, height / target_height));
+}
+
 gboolean                gdk_texture_can_load            (GBytes                 *bytes);
+GdkTexture *            gdk_texture_new_from_stream     (GInputStream           *stream,
+                                                         int                     width,
+                                                         int                     height,
+                                                         GdkTextureProgressFunc  progress,
+                                                         gpointer                progress_data,
+                                                         GCancellable           *cancellable,
+                                                         GError                **error);
 
 GdkTexture *            gdk_texture_new_for_surface     (cairo_surface_t        *surface);
 cairo_surface_t *       gdk_texture_download_surface    (GdkTexture             *texture);
@@ -59,6 +89,16 @@ void                    gdk_texture_do_download         (GdkTexture
                                                          GdkMemoryFormat         format,
                                                          guchar                 *data,
                                                          gsize                   stride);
+void                    gdk_texture_do_download_area    (GdkTexture             *texture,
+                                                         const GdkRectangle     *area,
+                                                         GdkMemoryFormat         format,
+                                                         guchar                 *data,
+                                                         gsize                   stride);
+void                    gdk_texture_download_area_fallback (GdkTexture         *texture,
+                                                         const GdkRectangle     *area,
+                                                         GdkMemoryFormat         format,
+                                                         guchar                 *data,
+                                                         gsize                   stride);
 void                    gdk_texture_diff                (GdkTexture             *self,
                                                          GdkTexture             *other,
                                                          cairo_region_t         *region);
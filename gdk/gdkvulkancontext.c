@@ -42,6 +42,7 @@ static const GdkDebugKey gsk_vulkan_feature_keys[] = {
   { "semaphore-export", GDK_VULKAN_FEATURE_SEMAPHORE_EXPORT, "Disable sync of exported dmabufs" },
   { "semaphore-import", GDK_VULKAN_FEATURE_SEMAPHORE_IMPORT, "Disable sync of imported dmabufs" },
   { "incremental-present", GDK_VULKAN_FEATURE_INCREMENTAL_PRESENT, "Do not send damage regions" },
+  { "memory-budget", GDK_VULKAN_FEATURE_MEMORY_BUDGET, "Do not query memory budgets" },
 };
 #endif
 
@@ -618,6 +619,9 @@ physical_device_check_features (VkPhysicalDevice device)
   if (physical_device_supports_extension (device, VK_KHR_INCREMENTAL_PRESENT_EXTENSION_NAME))
     features |= GDK_VULKAN_FEATURE_INCREMENTAL_PRESENT;
 
+  if (physical_device_supports_extension (device, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME))
+    features |= GDK_VULKAN_FEATURE_MEMORY_BUDGET;
+
   return features;
 }
 
@@ -1494,6 +1498,8 @@ gdk_display_create_vulkan_device (GdkDisplay  *display,
                 }
               if (features & GDK_VULKAN_FEATURE_INCREMENTAL_PRESENT)
                 g_ptr_array_add (device_extensions, (gpointer) VK_KHR_INCREMENTAL_PRESENT_EXTENSION_NAME);
+              if (features & GDK_VULKAN_FEATURE_MEMORY_BUDGET)
+                g_ptr_array_add (device_extensions, (gpointer) VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
 
 #define ENABLE_IF(flag) ((features & (flag)) ? VK_TRUE : VK_FALSE)
               GDK_DISPLAY_DEBUG (display, VULKAN, "Using Vulkan device %u, queue %u", i, j);
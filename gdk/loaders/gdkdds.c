@@ -0,0 +1,222 @@
+/* GDK - The GIMP Drawing Kit
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gdkddsprivate.h"
+
+#include <glib/gi18n-lib.h>
+#include "gdkcompressedtextureprivate.h"
+
+/* DDS files are the common container for block compressed images.
+ *
+ * We only load the first mipmap level of 2D images in the BC1, BC2
+ * and BC3 formats (also known as DXT1 to DXT5), which is what GPUs can
+ * sample from directly. Those are kept compressed, see
+ * GdkCompressedTexture.
+ */
+
+#define DDS_HEADER_SIZE 124
+#define DDS_PIXELFORMAT_SIZE 32
+#define DDS_DX10_HEADER_SIZE 20
+
+#define DDS_HEADER_OFFSET 4
+#define DDS_DX10_HEADER_OFFSET (DDS_HEADER_OFFSET + DDS_HEADER_SIZE)
+
+/* DDS_PIXELFORMAT.dwFlags */
+#define DDPF_FOURCC 0x4
+
+/* DDS_HEADER_DXT10.miscFlags2 */
+#define DDS_ALPHA_MODE_MASK 0x7
+#define DDS_ALPHA_MODE_PREMULTIPLIED 2
+
+/* DXGI_FORMAT values */
+#define DXGI_FORMAT_BC1_UNORM      71
+#define DXGI_FORMAT_BC1_UNORM_SRGB 72
+#define DXGI_FORMAT_BC2_UNORM      74
+#define DXGI_FORMAT_BC2_UNORM_SRGB 75
+#define DXGI_FORMAT_BC3_UNORM      77
+#define DXGI_FORMAT_BC3_UNORM_SRGB 78
+
+#define FOURCC(a, b, c, d) ((guint32) (a) | ((guint32) (b) << 8) | ((guint32) (c) << 16) | ((guint32) (d) << 24))
+
+static inline guint32
+read_uint32 (const guchar *data,
+             gsize         offset)
+{
+  return (guint32) data[offset] |
+         ((guint32) data[offset + 1] << 8) |
+         ((guint32) data[offset + 2] << 16) |
+         ((guint32) data[offset + 3] << 24);
+}
+
+static gboolean
+dds_format_from_dxgi (guint32              dxgi_format,
+                      GdkCompressedFormat *format)
+{
+  switch (dxgi_format)
+    {
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+      *format = GDK_COMPRESSED_BC1;
+      return TRUE;
+
+    case DXGI_FORMAT_BC2_UNORM:
+    case DXGI_FORMAT_BC2_UNORM_SRGB:
+      *format = GDK_COMPRESSED_BC2;
+      return TRUE;
+
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+      *format = GDK_COMPRESSED_BC3;
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
+static gboolean
+dds_format_from_fourcc (guint32              fourcc,
+                        GdkCompressedFormat *format,
+                        gboolean            *premultiplied)
+{
+  switch (fourcc)
+    {
+    case FOURCC ('D', 'X', 'T', '1'):
+      *format = GDK_COMPRESSED_BC1;
+      *premultiplied = FALSE;
+      return TRUE;
+
+    case FOURCC ('D', 'X', 'T', '2'):
+    case FOURCC ('D', 'X', 'T', '3'):
+      *format = GDK_COMPRESSED_BC2;
+      *premultiplied = fourcc == FOURCC ('D', 'X', 'T', '2');
+      return TRUE;
+
+    case FOURCC ('D', 'X', 'T', '4'):
+    case FOURCC ('D', 'X', 'T', '5'):
+      *format = GDK_COMPRESSED_BC3;
+      *premultiplied = fourcc == FOURCC ('D', 'X', 'T', '4');
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
+GdkTexture *
+gdk_load_dds (GBytes  *bytes,
+              GError **error)
+{
+  GdkCompressedFormat format;
+  gboolean premultiplied;
+  const guchar *data;
+  gsize size, offset, data_size;
+  guint32 width, height, pf_flags, fourcc;
+  GdkTexture *texture;
+  GBytes *blocks;
+
+  data = g_bytes_get_data (bytes, &size);
+
+  if (size < DDS_DX10_HEADER_OFFSET ||
+      read_uint32 (data, DDS_HEADER_OFFSET) != DDS_HEADER_SIZE ||
+      read_uint32 (data, DDS_HEADER_OFFSET + 72) != DDS_PIXELFORMAT_SIZE)
+    {
+      g_set_error_literal (error,
+                           GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_CORRUPT_IMAGE,
+                           _("Error reading DDS image header"));
+      return NULL;
+    }
+
+  height = read_uint32 (data, DDS_HEADER_OFFSET + 8);
+  width = read_uint32 (data, DDS_HEADER_OFFSET + 12);
+  pf_flags = read_uint32 (data, DDS_HEADER_OFFSET + 76);
+  fourcc = read_uint32 (data, DDS_HEADER_OFFSET + 80);
+
+  if (width == 0 || height == 0 || width > G_MAXINT || height > G_MAXINT)
+    {
+      g_set_error_literal (error,
+                           GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_CORRUPT_IMAGE,
+                           _("Error reading DDS image header"));
+      return NULL;
+    }
+
+  if ((pf_flags & DDPF_FOURCC) == 0)
+    {
+      g_set_error_literal (error,
+                           GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_UNSUPPORTED_CONTENT,
+                           _("Uncompressed DDS images are not supported"));
+      return NULL;
+    }
+
+  if (fourcc == FOURCC ('D', 'X', '1', '0'))
+    {
+      if (size < DDS_DX10_HEADER_OFFSET + DDS_DX10_HEADER_SIZE)
+        {
+          g_set_error_literal (error,
+                               GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_CORRUPT_IMAGE,
+                               _("Error reading DDS image header"));
+          return NULL;
+        }
+
+      if (!dds_format_from_dxgi (read_uint32 (data, DDS_DX10_HEADER_OFFSET), &format))
+        {
+          g_set_error (error,
+                       GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_UNSUPPORTED_CONTENT,
+                       _("Unsupported DDS format (%u)"), read_uint32 (data, DDS_DX10_HEADER_OFFSET));
+          return NULL;
+        }
+
+      premultiplied = (read_uint32 (data, DDS_DX10_HEADER_OFFSET + 16) & DDS_ALPHA_MODE_MASK) == DDS_ALPHA_MODE_PREMULTIPLIED;
+      offset = DDS_DX10_HEADER_OFFSET + DDS_DX10_HEADER_SIZE;
+    }
+  else
+    {
+      if (!dds_format_from_fourcc (fourcc, &format, &premultiplied))
+        {
+          g_set_error (error,
+                       GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_UNSUPPORTED_CONTENT,
+                       _("Unsupported DDS format (%.4s)"), (const char *) data + DDS_HEADER_OFFSET + 80);
+          return NULL;
+        }
+
+      offset = DDS_DX10_HEADER_OFFSET;
+    }
+
+  data_size = gdk_compressed_format_get_data_size (format, width, height);
+  if (data_size == 0)
+    {
+      g_set_error (error,
+                   GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_TOO_LARGE,
+                   _("Not enough memory for image size %ux%u"), width, height);
+      return NULL;
+    }
+
+  if (size - offset < data_size)
+    {
+      g_set_error_literal (error,
+                           GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_CORRUPT_IMAGE,
+                           _("DDS image data is truncated"));
+      return NULL;
+    }
+
+  blocks = g_bytes_new_from_bytes (bytes, offset, data_size);
+  texture = gdk_compressed_texture_new (format, premultiplied, width, height, blocks);
+  g_bytes_unref (blocks);
+
+  return texture;
+}
@@ -0,0 +1,37 @@
+/* GDK - The GIMP Drawing Kit
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "gdktextureprivate.h"
+#include <gio/gio.h>
+
+#define DDS_SIGNATURE "DDS "
+
+GdkTexture *gdk_load_dds        (GBytes         *bytes,
+                                 GError        **error);
+
+static inline gboolean
+gdk_is_dds (GBytes *bytes)
+{
+  const char *data;
+  gsize size;
+
+  data = g_bytes_get_data (bytes, &size);
+
+  return size > strlen (DDS_SIGNATURE) &&
+         memcmp (data, DDS_SIGNATURE, strlen (DDS_SIGNATURE)) == 0;
+}
@@ -132,6 +132,158 @@ convert_cmyk_to_rgba (guchar *data,
 }
 
  /* }}} */
+/* {{{ Stream source */
+
+#define STREAM_BUFFER_SIZE (64 * 1024)
+
+typedef struct
+{
+  struct jpeg_source_mgr pub;
+  GInputStream *stream;
+  GCancellable *cancellable;
+  GError **error;
+  JOCTET buffer[STREAM_BUFFER_SIZE];
+} stream_source_mgr;
+
+static void
+stream_init_source (j_decompress_ptr cinfo)
+{
+}
+
+static boolean
+stream_fill_input_buffer (j_decompress_ptr cinfo)
+{
+  static const JOCTET fake_eoi[2] = { 0xFF, JPEG_EOI };
+  stream_source_mgr *src = (stream_source_mgr *) cinfo->src;
+  gssize n_read;
+
+  n_read = g_input_stream_read (src->stream,
+                                src->buffer, sizeof (src->buffer),
+                                src->cancellable,
+                                src->error);
+  if (n_read < 0)
+    {
+      /* The error is already set, so the error handler keeps it */
+      ERREXIT (cinfo, JERR_FILE_READ);
+    }
+  else if (n_read == 0)
+    {
+      /* Like the stdio source, treat a truncated file as ending there */
+      WARNMS (cinfo, JWRN_JPEG_EOF);
+      src->pub.next_input_byte = fake_eoi;
+      src->pub.bytes_in_buffer = 2;
+      return TRUE;
+    }
+
+  src->pub.next_input_byte = src->buffer;
+  src->pub.bytes_in_buffer = n_read;
+
+  return TRUE;
+}
+
+static void
+stream_skip_input_data (j_decompress_ptr cinfo,
+                        long             num_bytes)
+{
+  stream_source_mgr *src = (stream_source_mgr *) cinfo->src;
+
+  if (num_bytes <= 0)
+    return;
+
+  while (num_bytes > (long) src->pub.bytes_in_buffer)
+    {
+      num_bytes -= (long) src->pub.bytes_in_buffer;
+      stream_fill_input_buffer (cinfo);
+    }
+
+  src->pub.next_input_byte += num_bytes;
+  src->pub.bytes_in_buffer -= num_bytes;
+}
+
+static void
+stream_term_source (j_decompress_ptr cinfo)
+{
+}
+
+static void
+jpeg_stream_src (j_decompress_ptr   cinfo,
+                 stream_source_mgr *src,
+                 GInputStream      *stream,
+                 GCancellable      *cancellable,
+                 GError           **error)
+{
+  src->pub.init_source = stream_init_source;
+  src->pub.fill_input_buffer = stream_fill_input_buffer;
+  src->pub.skip_input_data = stream_skip_input_data;
+  src->pub.resync_to_restart = jpeg_resync_to_restart;
+  src->pub.term_source = stream_term_source;
+  src->pub.next_input_byte = NULL;
+  src->pub.bytes_in_buffer = 0;
+  src->stream = stream;
+  src->cancellable = cancellable;
+  src->error = error;
+
+  cinfo->src = &src->pub;
+}
+
+/* }}} */
+/* {{{ Decoding */
+
+/* Converts @data in place and creates a texture taking ownership of it */
+static GdkTexture *
+jpeg_texture_new (guchar       *data,
+                  guint         width,
+                  guint         height,
+                  guint         stride,
+                  J_COLOR_SPACE color_space)
+{
+  GdkMemoryFormat format;
+  GdkTexture *texture;
+  GBytes *bytes;
+
+  switch ((int) color_space)
+    {
+    case JCS_GRAYSCALE:
+      convert_grayscale_to_rgb (data, width, height, stride);
+      format = GDK_MEMORY_R8G8B8;
+      break;
+    case JCS_RGB:
+      format = GDK_MEMORY_R8G8B8;
+      break;
+    case JCS_CMYK:
+      convert_cmyk_to_rgba (data, width, height, stride);
+      format = GDK_MEMORY_R8G8B8A8_PREMULTIPLIED;
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+
+  bytes = g_bytes_new_take (data, (gsize) stride * height);
+
+  texture = gdk_memory_texture_new (width, height,
+                                    format,
+                                    bytes, stride);
+
+  g_bytes_unref (bytes);
+
+  return texture;
+}
+
+static void
+jpeg_read_image (j_decompress_ptr  info,
+                 guchar           *data,
+                 guint             stride)
+{
+  unsigned char *row[1];
+
+  while (info->output_scanline < info->output_height)
+    {
+       row[0] = (unsigned char *)(&data[stride * info->output_scanline]);
+       jpeg_read_scanlines (info, row, 1);
+    }
+}
+
+/* }}} */
 /* {{{ Public API */
 
 GdkTexture *
@@ -142,10 +294,7 @@ gdk_load_jpeg (GBytes  *input_bytes,
   struct error_handler_data jerr;
   guint width, height, stride;
   unsigned char *data = NULL;
-  unsigned char *row[1];
-  GBytes *bytes;
   GdkTexture *texture;
-  GdkMemoryFormat format;
   G_GNUC_UNUSED guint64 before = GDK_PROFILER_CURRENT_TIME;
 
   info.err = jpeg_std_error (&jerr.pub);
@@ -181,12 +330,10 @@ gdk_load_jpeg (GBytes  *input_bytes,
     case JCS_RGB:
       stride = 3 * width;
       data = g_try_malloc_n (stride, height);
-      format = GDK_MEMORY_R8G8B8;
       break;
     case JCS_CMYK:
       stride = 4 * width;
       data = g_try_malloc_n (stride, height);
-      format = GDK_MEMORY_R8G8B8A8_PREMULTIPLIED;
       break;
     default:
       g_set_error (error,
@@ -205,40 +352,165 @@ gdk_load_jpeg (GBytes  *input_bytes,
       return NULL;
     }
 
-  while (info.output_scanline < info.output_height)
+  jpeg_read_image (&info, data, stride);
+
+  jpeg_finish_decompress (&info);
+
+  texture = jpeg_texture_new (data, width, height, stride, info.out_color_space);
+
+  jpeg_destroy_decompress (&info);
+
+  gdk_profiler_end_mark (before, "Load jpeg", NULL);
+ 
+  return texture;
+}
+
+/*
+ * gdk_load_jpeg_from_stream:
+ * @stream: the stream to read from
+ * @width: the width to decode at, or 0 for the full size
+ * @height: the height to decode at, or 0 for the full size
+ * @progress: (nullable): function to call with partial results
+ * @progress_data: data to pass to @progress
+ * @cancellable: (nullable): a `GCancellable`
+ * @error: return location for an error
+ *
+ * Loads a jpeg image incrementally from @stream, without keeping the
+ * compressed data in memory.
+ *
+ * For progressive images, @progress is called with a texture of the
+ * image at the quality decoded so far after every scan but the last.
+ *
+ * If a target size is given, the image is decoded at the smallest DCT
+ * scale of 1/2, 1/4 or 1/8 that keeps it at least that large.
+ */
+GdkTexture *
+gdk_load_jpeg_from_stream (GInputStream            *stream,
+                           int                      target_width,
+                           int                      target_height,
+                           GdkTextureProgressFunc   progress,
+                           gpointer                 progress_data,
+                           GCancellable            *cancellable,
+                           GError                 **error)
+{
+  struct jpeg_decompress_struct info;
+  struct error_handler_data jerr;
+  stream_source_mgr *src;
+  guint width, height, stride;
+  guint factor;
+  unsigned char *data = NULL;
+  GdkTexture *texture;
+  G_GNUC_UNUSED guint64 before = GDK_PROFILER_CURRENT_TIME;
+
+  src = g_new (stream_source_mgr, 1);
+
+  info.err = jpeg_std_error (&jerr.pub);
+  jerr.pub.error_exit = fatal_error_handler;
+  jerr.pub.output_message = output_message_handler;
+  jerr.error = error;
+
+  if (sigsetjmp (jerr.setjmp_buffer, 1))
     {
-       row[0] = (unsigned char *)(&data[stride * info.output_scanline]);
-       jpeg_read_scanlines (&info, row, 1);
+      g_free (data);
+      g_free (src);
+      jpeg_destroy_decompress (&info);
+      return NULL;
     }
 
+  jpeg_create_decompress (&info);
+
+  /* Limit to 1GB to avoid OOM with large images */
+  info.mem->max_memory_to_use = 1024 * 1024 * 1024;
+
+  jpeg_stream_src (&info, src, stream, cancellable, error);
+
+  jpeg_read_header (&info, TRUE);
+
+  info.buffered_image = progress != NULL && jpeg_has_multiple_scans (&info);
+
+  /* Let the IDCT scale down, the denominators every libjpeg supports
+   * are 1, 2, 4 and 8 */
+  factor = gdk_texture_get_downscale_factor (info.image_width, info.image_height,
+                                             target_width, target_height);
+  info.scale_num = 1;
+  if (factor >= 8)
+    info.scale_denom = 8;
+  else if (factor >= 4)
+    info.scale_denom = 4;
+  else if (factor >= 2)
+    info.scale_denom = 2;
+  else
+    info.scale_denom = 1;
+
+  jpeg_start_decompress (&info);
+
+  width = info.output_width;
+  height = info.output_height;
+
   switch ((int)info.out_color_space)
     {
     case JCS_GRAYSCALE:
-      convert_grayscale_to_rgb (data, width, height, stride);
-      format = GDK_MEMORY_R8G8B8;
-      break;
     case JCS_RGB:
+      stride = 3 * width;
       break;
     case JCS_CMYK:
-      convert_cmyk_to_rgba (data, width, height, stride);
+      stride = 4 * width;
       break;
     default:
-      g_assert_not_reached ();
+      g_set_error (error,
+                   GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_UNSUPPORTED_CONTENT,
+                   _("Unsupported JPEG colorspace (%d)"), info.out_color_space);
+      jpeg_destroy_decompress (&info);
+      g_free (src);
+      return NULL;
     }
 
-  jpeg_finish_decompress (&info);
-  jpeg_destroy_decompress (&info);
+  data = g_try_malloc_n (stride, height);
+  if (!data)
+    {
+      g_set_error (error,
+                   GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_TOO_LARGE,
+                   _("Not enough memory for image size %ux%u"), width, height);
+      jpeg_destroy_decompress (&info);
+      g_free (src);
+      return NULL;
+    }
+
+  if (info.buffered_image)
+    {
+      /* Output the image after every scan, using the coefficients
+       * that have arrived so far */
+      while (TRUE)
+        {
+          jpeg_start_output (&info, info.input_scan_number);
+          jpeg_read_image (&info, data, stride);
+          jpeg_finish_output (&info);
+
+          if (jpeg_input_complete (&info) &&
+              info.output_scan_number == info.input_scan_number)
+            break;
+
+          texture = jpeg_texture_new (g_memdup2 (data, (gsize) stride * height),
+                                      width, height, stride,
+                                      info.out_color_space);
+          progress (texture, progress_data);
+          g_object_unref (texture);
+        }
+    }
+  else
+    {
+      jpeg_read_image (&info, data, stride);
+    }
 
-  bytes = g_bytes_new_take (data, stride * height);
+  jpeg_finish_decompress (&info);
 
-  texture = gdk_memory_texture_new (width, height,
-                                    format,
-                                    bytes, stride);
+  texture = jpeg_texture_new (data, width, height, stride, info.out_color_space);
 
-  g_bytes_unref (bytes);
+  jpeg_destroy_decompress (&info);
+  g_free (src);
 
   gdk_profiler_end_mark (before, "Load jpeg", NULL);
- 
+
   return texture;
 }
 
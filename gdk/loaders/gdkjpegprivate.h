@@ -18,12 +18,21 @@
 #pragma once
 
 #include "gdkmemorytexture.h"
+#include "gdktextureprivate.h"
 #include <gio/gio.h>
 
 #define JPEG_SIGNATURE "\xff\xd8"
 
 GdkTexture *gdk_load_jpeg         (GBytes           *bytes,
                                    GError          **error);
+GdkTexture *gdk_load_jpeg_from_stream
+                                  (GInputStream     *stream,
+                                   int               width,
+                                   int               height,
+                                   GdkTextureProgressFunc progress,
+                                   gpointer          progress_data,
+                                   GCancellable     *cancellable,
+                                   GError          **error);
 
 GBytes     *gdk_save_jpeg         (GdkTexture     *texture);
 
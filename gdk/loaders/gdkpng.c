@@ -48,6 +48,7 @@ typedef struct
   guchar *data;
   gsize size;
   gsize position;
+  gsize allocated;
 } png_io;
 
 
@@ -76,15 +77,16 @@ png_write_func (png_structp png,
 
   io = png_get_io_ptr (png);
 
-  if (io->position > io->size ||
-      io->size - io->position  < size)
+  /* Grow geometrically, libpng hands us the data in small pieces */
+  if (io->position + size > io->allocated)
     {
-      io->size = io->position + size;
-      io->data = g_realloc (io->data, io->size);
+      io->allocated = MAX (MAX (io->allocated * 2, io->position + size), 4096);
+      io->data = g_realloc (io->data, io->allocated);
     }
 
   memcpy (io->data + io->position, data, size);
   io->position += size;
+  io->size = MAX (io->size, io->position);
 }
 
 static void
@@ -127,55 +129,28 @@ png_simple_warning_callback (png_structp     png,
 }
 
 /* }}} */
-/* {{{ Public API */ 
+/* {{{ Format setup */
 
-GdkTexture *
-gdk_load_png (GBytes  *bytes,
-              GError **error)
+/* Sets up the transformations for reading the image described by @info
+ * and determines the resulting format. Returns the number of passes, or
+ * 0 if the image can't be loaded.
+ */
+static int
+png_setup_format (png_struct       *png,
+                  png_info         *info,
+                  guint            *out_width,
+                  guint            *out_height,
+                  GdkMemoryFormat  *out_format,
+                  gsize            *out_stride,
+                  GError          **error)
 {
-  png_io io;
-  png_struct *png = NULL;
-  png_info *info;
   guint width, height;
-  gsize i, stride;
+  gsize stride;
   int depth, color_type;
   int interlace;
+  int n_passes = 1;
   GdkMemoryFormat format;
-  guchar *buffer = NULL;
-  guchar **row_pointers = NULL;
-  GBytes *out_bytes;
-  GdkTexture *texture;
   int bpp;
-  G_GNUC_UNUSED gint64 before = GDK_PROFILER_CURRENT_TIME;
-
-  io.data = (guchar *)g_bytes_get_data (bytes, &io.size);
-  io.position = 0;
-
-  png = png_create_read_struct_2 (PNG_LIBPNG_VER_STRING,
-                                  error,
-                                  png_simple_error_callback,
-                                  png_simple_warning_callback,
-                                  NULL,
-                                  png_malloc_callback,
-                                  png_free_callback);
-  if (png == NULL)
-    g_error ("Out of memory");
-
-  info = png_create_info_struct (png);
-  if (info == NULL)
-    g_error ("Out of memory");
-
-  png_set_read_fn (png, &io, png_read_func);
-
-  if (sigsetjmp (png_jmpbuf (png), 1))
-    {
-      g_free (buffer);
-      g_free (row_pointers);
-      png_destroy_read_struct (&png, &info, NULL);
-      return NULL;
-    }
-
-  png_read_info (png, info);
 
   png_get_IHDR (png, info,
                 &width, &height, &depth,
@@ -194,7 +169,7 @@ gdk_load_png (GBytes  *bytes,
     png_set_packing (png);
 
   if (interlace != PNG_INTERLACE_NONE)
-    png_set_interlace_handling (png);
+    n_passes = png_set_interlace_handling (png);
 
 #if G_BYTE_ORDER == G_LITTLE_ENDIAN
   png_set_swap (png);
@@ -206,11 +181,10 @@ gdk_load_png (GBytes  *bytes,
                 &color_type, &interlace, NULL, NULL);
   if (depth != 8 && depth != 16)
     {
-      png_destroy_read_struct (&png, &info, NULL);
       g_set_error (error,
                    GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_UNSUPPORTED_CONTENT,
                    _("Unsupported depth %u in png image"), depth);
-      return NULL;
+      return 0;
     }
 
   switch (color_type)
@@ -230,7 +204,7 @@ gdk_load_png (GBytes  *bytes,
         {
           format = GDK_MEMORY_R8G8B8;
         }
-      else if (depth == 16)
+      else
         {
           format = GDK_MEMORY_R16G16B16;
         }
@@ -240,7 +214,7 @@ gdk_load_png (GBytes  *bytes,
         {
           format = GDK_MEMORY_G8;
         }
-      else if (depth == 16)
+      else
         {
           format = GDK_MEMORY_G16;
         }
@@ -250,17 +224,16 @@ gdk_load_png (GBytes  *bytes,
         {
           format = GDK_MEMORY_G8A8;
         }
-      else if (depth == 16)
+      else
         {
           format = GDK_MEMORY_G16A16;
         }
       break;
     default:
-      png_destroy_read_struct (&png, &info, NULL);
       g_set_error (error,
                    GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_UNSUPPORTED_CONTENT,
                    _("Unsupported color type %u in png image"), color_type);
-      return NULL;
+      return 0;
     }
 
   bpp = gdk_memory_format_bytes_per_pixel (format);
@@ -270,6 +243,217 @@ gdk_load_png (GBytes  *bytes,
       g_set_error (error,
                    GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_TOO_LARGE,
                    _("Image stride too large for image size %ux%u"), width, height);
+      return 0;
+    }
+
+  *out_width = width;
+  *out_height = height;
+  *out_format = format;
+  *out_stride = stride;
+
+  return n_passes;
+}
+
+/* }}} */
+/* {{{ Progressive loading */
+
+typedef struct
+{
+  png_struct *png;
+  png_info *info;
+  GError **error;
+
+  GdkTextureProgressFunc progress;
+  gpointer progress_data;
+
+  int target_width, target_height;
+
+  guint width, height;
+  gsize stride;
+  GdkMemoryFormat format;
+  int n_passes;
+  int pass;
+  guchar *buffer;
+  gboolean done;
+
+  /* for scaling down while decoding */
+  guint factor;
+  guint src_width, src_height;
+  gsize src_stride;
+  guchar *band;
+} png_progressive;
+
+static void
+png_progressive_emit_partial (png_progressive *self)
+{
+  GBytes *bytes;
+  GdkTexture *texture;
+
+  bytes = g_bytes_new (self->buffer, (gsize) self->height * self->stride);
+  texture = gdk_memory_texture_new (self->width, self->height, self->format, bytes, self->stride);
+  g_bytes_unref (bytes);
+
+  self->progress (texture, self->progress_data);
+
+  g_object_unref (texture);
+}
+
+static void
+png_progressive_info_callback (png_structp png,
+                               png_infop   info)
+{
+  png_progressive *self = png_get_progressive_ptr (png);
+  gsize bpp;
+
+  self->n_passes = png_setup_format (png, info,
+                                     &self->src_width, &self->src_height,
+                                     &self->format, &self->src_stride,
+                                     self->error);
+  if (self->n_passes == 0)
+    png_error (png, "Unsupported image");
+
+  /* Interlaced images deliver rows out of order, so they are
+   * always decoded at full size */
+  if (self->n_passes == 1)
+    self->factor = gdk_texture_get_downscale_factor (self->src_width, self->src_height,
+                                                     self->target_width, self->target_height);
+  else
+    self->factor = 1;
+
+  if (self->factor > 1)
+    {
+      self->width = (self->src_width + self->factor - 1) / self->factor;
+      self->height = (self->src_height + self->factor - 1) / self->factor;
+      bpp = gdk_memory_format_bytes_per_pixel (self->format);
+      self->stride = self->width * bpp;
+      self->stride += (8 - self->stride % 8) % 8;
+
+      self->band = g_try_malloc_n (self->factor, self->src_stride);
+      if (self->band == NULL)
+        {
+          g_set_error (self->error,
+                       GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_TOO_LARGE,
+                       _("Not enough memory for image size %ux%u"), self->src_width, self->src_height);
+          png_error (png, "Out of memory");
+        }
+    }
+  else
+    {
+      self->width = self->src_width;
+      self->height = self->src_height;
+      self->stride = self->src_stride;
+    }
+
+  /* Interlaced passes only fill some of the pixels, so the rest must
+   * be well-defined in partial textures */
+  self->buffer = g_try_malloc0_n (self->height, self->stride);
+  if (self->buffer == NULL)
+    {
+      g_set_error (self->error,
+                   GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_TOO_LARGE,
+                   _("Not enough memory for image size %ux%u"), self->width, self->height);
+      png_error (png, "Out of memory");
+    }
+}
+
+static void
+png_progressive_row_callback (png_structp png,
+                              png_bytep   new_row,
+                              png_uint_32 row_num,
+                              int         pass)
+{
+  png_progressive *self = png_get_progressive_ptr (png);
+
+  if (pass != self->pass)
+    {
+      if (self->progress)
+        png_progressive_emit_partial (self);
+      self->pass = pass;
+    }
+
+  if (new_row == NULL || row_num >= self->src_height)
+    return;
+
+  if (self->factor > 1)
+    {
+      guint band_row = row_num % self->factor;
+
+      png_progressive_combine_row (png, self->band + band_row * self->src_stride, new_row);
+
+      if (band_row == self->factor - 1 || row_num == self->src_height - 1)
+        gdk_memory_downscale_rows (self->buffer + (row_num / self->factor) * self->stride,
+                                   self->band,
+                                   self->src_stride,
+                                   self->format,
+                                   self->src_width,
+                                   band_row + 1,
+                                   self->factor);
+      return;
+    }
+
+  png_progressive_combine_row (png, self->buffer + row_num * self->stride, new_row);
+}
+
+static void
+png_progressive_end_callback (png_structp png,
+                              png_infop   info)
+{
+  png_progressive *self = png_get_progressive_ptr (png);
+
+  self->done = TRUE;
+}
+
+/* }}} */
+/* {{{ Public API */ 
+
+GdkTexture *
+gdk_load_png (GBytes  *bytes,
+              GError **error)
+{
+  png_io io;
+  png_struct *png = NULL;
+  png_info *info;
+  guint width, height;
+  gsize i, stride;
+  GdkMemoryFormat format;
+  guchar *buffer = NULL;
+  guchar **row_pointers = NULL;
+  GBytes *out_bytes;
+  GdkTexture *texture;
+  G_GNUC_UNUSED gint64 before = GDK_PROFILER_CURRENT_TIME;
+
+  io.data = (guchar *)g_bytes_get_data (bytes, &io.size);
+  io.position = 0;
+
+  png = png_create_read_struct_2 (PNG_LIBPNG_VER_STRING,
+                                  error,
+                                  png_simple_error_callback,
+                                  png_simple_warning_callback,
+                                  NULL,
+                                  png_malloc_callback,
+                                  png_free_callback);
+  if (png == NULL)
+    g_error ("Out of memory");
+
+  info = png_create_info_struct (png);
+  if (info == NULL)
+    g_error ("Out of memory");
+
+  png_set_read_fn (png, &io, png_read_func);
+
+  if (sigsetjmp (png_jmpbuf (png), 1))
+    {
+      g_free (buffer);
+      g_free (row_pointers);
+      png_destroy_read_struct (&png, &info, NULL);
+      return NULL;
+    }
+
+  png_read_info (png, info);
+
+  if (!png_setup_format (png, info, &width, &height, &format, &stride, error))
+    {
+      png_destroy_read_struct (&png, &info, NULL);
       return NULL;
     }
 
@@ -310,12 +494,127 @@ gdk_load_png (GBytes  *bytes,
   return texture;
 }
 
+/*
+ * gdk_load_png_from_stream:
+ * @stream: the stream to read from
+ * @width: the width to decode at, or 0 for the full size
+ * @height: the height to decode at, or 0 for the full size
+ * @progress: (nullable): function to call with partial results
+ * @progress_data: data to pass to @progress
+ * @cancellable: (nullable): a `GCancellable`
+ * @error: return location for an error
+ *
+ * Loads a png image incrementally from @stream, without keeping the
+ * compressed data in memory.
+ *
+ * For interlaced images, @progress is called with a texture containing
+ * the pixels decoded so far after every pass but the last.
+ *
+ * If a target size is given, non-interlaced images are box-filtered by
+ * the largest integer factor that keeps them at least that large, one
+ * band of rows at a time.
+ */
+GdkTexture *
+gdk_load_png_from_stream (GInputStream            *stream,
+                          int                      width,
+                          int                      height,
+                          GdkTextureProgressFunc   progress,
+                          gpointer                 progress_data,
+                          GCancellable            *cancellable,
+                          GError                 **error)
+{
+  png_progressive self = { 0, };
+  guchar data[16 * 1024];
+  GBytes *out_bytes;
+  GdkTexture *texture;
+  gssize n_read;
+  G_GNUC_UNUSED gint64 before = GDK_PROFILER_CURRENT_TIME;
+
+  self.error = error;
+  self.target_width = width;
+  self.target_height = height;
+  self.progress = progress;
+  self.progress_data = progress_data;
+
+  self.png = png_create_read_struct_2 (PNG_LIBPNG_VER_STRING,
+                                       error,
+                                       png_simple_error_callback,
+                                       png_simple_warning_callback,
+                                       NULL,
+                                       png_malloc_callback,
+                                       png_free_callback);
+  if (self.png == NULL)
+    g_error ("Out of memory");
+
+  self.info = png_create_info_struct (self.png);
+  if (self.info == NULL)
+    g_error ("Out of memory");
+
+  png_set_progressive_read_fn (self.png, &self,
+                               png_progressive_info_callback,
+                               png_progressive_row_callback,
+                               png_progressive_end_callback);
+
+  if (sigsetjmp (png_jmpbuf (self.png), 1))
+    {
+      g_free (self.band);
+      g_free (self.buffer);
+      png_destroy_read_struct (&self.png, &self.info, NULL);
+      return NULL;
+    }
+
+  while (!self.done)
+    {
+      n_read = g_input_stream_read (stream, data, sizeof (data), cancellable, error);
+      if (n_read < 0)
+        {
+          g_free (self.band);
+          g_free (self.buffer);
+          png_destroy_read_struct (&self.png, &self.info, NULL);
+          return NULL;
+        }
+      else if (n_read == 0)
+        {
+          png_error (self.png, "Read past EOF");
+        }
+
+      png_process_data (self.png, self.info, data, n_read);
+    }
+
+  g_free (self.band);
+
+  out_bytes = g_bytes_new_take (self.buffer, (gsize) self.height * self.stride);
+  texture = gdk_memory_texture_new (self.width, self.height, self.format, out_bytes, self.stride);
+  g_bytes_unref (out_bytes);
+
+  png_destroy_read_struct (&self.png, &self.info, NULL);
+
+  if (GDK_PROFILER_IS_RUNNING)
+    {
+      gint64 end = GDK_PROFILER_CURRENT_TIME;
+      if (end - before > 500000)
+        gdk_profiler_add_mark (before, end - before, "Load png", NULL);
+    }
+
+  return texture;
+}
+
 GBytes *
 gdk_save_png (GdkTexture *texture)
+{
+  return gdk_save_png_with_compression (texture, -1);
+}
+
+/* compression_level is a zlib compression level from 0 to 9,
+ * or -1 for the libpng default
+ */
+GBytes *
+gdk_save_png_with_compression (GdkTexture *texture,
+                               int         compression_level)
 {
   png_struct *png = NULL;
   png_info *info;
-  png_io io = { NULL, 0, 0 };
+  png_io io = { NULL, 0, 0, 0 };
   int width, height;
   int y;
   GdkMemoryFormat format;
@@ -445,6 +744,9 @@ gdk_save_png (GdkTexture *texture)
 
   png_set_write_fn (png, &io, png_write_func, png_flush_func);
 
+  if (compression_level >= 0)
+    png_set_compression_level (png, compression_level);
+
   png_set_IHDR (png, info, width, height, depth,
                 png_format,
                 PNG_INTERLACE_NONE,
@@ -466,7 +768,7 @@ gdk_save_png (GdkTexture *texture)
 
   g_bytes_unref (bytes);
 
-  return g_bytes_new_take (io.data, io.size);
+  return g_bytes_new_take (g_realloc (io.data, io.size), io.size);
 }
 
 /* }}} */
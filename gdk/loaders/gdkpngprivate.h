@@ -17,15 +17,26 @@
 
 #pragma once
 
-#include "gdktexture.h"
+#include "gdktextureprivate.h"
 #include <gio/gio.h>
 
 #define PNG_SIGNATURE "\x89PNG"
 
 GdkTexture *gdk_load_png        (GBytes         *bytes,
                                  GError        **error);
+GdkTexture *gdk_load_png_from_stream
+                                (GInputStream   *stream,
+                                 int             width,
+                                 int             height,
+                                 GdkTextureProgressFunc progress,
+                                 gpointer        progress_data,
+                                 GCancellable   *cancellable,
+                                 GError        **error);
 
 GBytes     *gdk_save_png        (GdkTexture     *texture);
+GBytes     *gdk_save_png_with_compression
+                                (GdkTexture     *texture,
+                                 int             compression_level);
 
 static inline gboolean
 gdk_is_png (GBytes *bytes)
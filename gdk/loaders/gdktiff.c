@@ -375,6 +375,27 @@ load_fallback (TIFF    *tif,
 GdkTexture *
 gdk_load_tiff (GBytes  *input_bytes,
                GError **error)
+{
+  return gdk_load_tiff_at_size (input_bytes, 0, 0, error);
+}
+
+/*
+ * gdk_load_tiff_at_size:
+ * @input_bytes: the data to load
+ * @target_width: the width to decode at, or 0 for the full size
+ * @target_height: the height to decode at, or 0 for the full size
+ * @error: return location for an error
+ *
+ * Loads a tiff image. If a target size is given, the image is
+ * box-filtered while reading scanlines, by the largest integer factor
+ * that keeps it at least that large. Images that need the RGBA
+ * fallback are always loaded at full size.
+ */
+GdkTexture *
+gdk_load_tiff_at_size (GBytes  *input_bytes,
+                       int      target_width,
+                       int      target_height,
+                       GError **error)
 {
   TIFF *tif;
   guint16 samples_per_pixel;
@@ -387,7 +408,10 @@ gdk_load_tiff (GBytes  *input_bytes,
   guint16 alpha_samples;
   GdkMemoryFormat format;
   guchar *data, *line;
-  gsize stride;
+  guchar *band = NULL;
+  guint32 src_width, src_height;
+  gsize stride, src_stride;
+  guint factor;
   int bpp;
   GBytes *bytes;
   GdkTexture *texture;
@@ -460,37 +484,62 @@ gdk_load_tiff (GBytes  *input_bytes,
       return texture;
     }
 
-  stride = width * gdk_memory_format_bytes_per_pixel (format);
+  bpp = gdk_memory_format_bytes_per_pixel (format);
+  src_width = width;
+  src_height = height;
+  src_stride = src_width * bpp;
 
-  g_assert (TIFFScanlineSize (tif) == stride);
+  g_assert (TIFFScanlineSize (tif) == src_stride);
+
+  factor = gdk_texture_get_downscale_factor (src_width, src_height, target_width, target_height);
+  width = (src_width + factor - 1) / factor;
+  height = (src_height + factor - 1) / factor;
+  stride = width * bpp;
 
   data = g_try_malloc_n (height, stride);
-  if (!data)
+  if (factor > 1)
+    band = g_try_malloc_n (factor, src_stride);
+  if (!data || (factor > 1 && !band))
     {
       g_set_error (error,
                    GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_TOO_LARGE,
-                   _("Not enough memory for image size %ux%u"), width, height);
+                   _("Not enough memory for image size %ux%u"), src_width, src_height);
       TIFFClose (tif);
+      g_free (data);
+      g_free (band);
       return NULL;
     }
 
   line = data;
-  for (int y = 0; y < height; y++)
+  for (int y = 0; y < src_height; y++)
     {
-      if (TIFFReadScanline (tif, line, y, 0) == -1)
+      guchar *row = factor > 1 ? band + (y % factor) * src_stride : line;
+
+      if (TIFFReadScanline (tif, row, y, 0) == -1)
         {
           g_set_error (error,
                        GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_CORRUPT_IMAGE,
                        _("Reading data failed at row %d"), y);
           TIFFClose (tif);
           g_free (data);
+          g_free (band);
           return NULL;
         }
 
-      line += stride;
+      if (factor == 1)
+        {
+          line += stride;
+        }
+      else if (y % factor == factor - 1 || y == src_height - 1)
+        {
+          gdk_memory_downscale_rows (line, band, src_stride, format,
+                                     src_width, y % factor + 1, factor);
+          line += stride;
+        }
     }
 
-  bpp = gdk_memory_format_bytes_per_pixel (format);
+  g_free (band);
+
   bytes = g_bytes_new_take (data, width * height * bpp);
 
   texture = gdk_memory_texture_new (width, height,
@@ -33,6 +33,12 @@
 
 static gint64 host_to_frame_clock_time (gint64 val);
 
+/* Initialized once from the main thread in gdk_display_link_source_new(),
+ * so the display link thread can read it without calling into the kernel
+ * on every frame.
+ */
+static mach_timebase_info_data_t timebase_info;
+
 static gboolean
 gdk_display_link_source_prepare (GSource *source,
                                  int     *timeout_)
@@ -182,6 +188,9 @@ gdk_display_link_source_new (CGDirectDisplayID display_id,
   impl->display_id = display_id;
   impl->paused = TRUE;
 
+  if (timebase_info.denom == 0)
+    mach_timebase_info (&timebase_info);
+
   /* Create DisplayLink for timing information for the display in
    * question so that we can produce graphics for that display at whatever
    * rate it can provide.
@@ -242,11 +251,7 @@ host_to_frame_clock_time (gint64 val)
 {
   /* NOTE: Code adapted from GLib's g_get_monotonic_time(). */
 
-  mach_timebase_info_data_t timebase_info;
-
   /* we get nanoseconds from mach_absolute_time() using timebase_info */
-  mach_timebase_info (&timebase_info);
-
   if (timebase_info.numer != timebase_info.denom)
     {
 #ifdef HAVE_UINT128_T
@@ -153,6 +153,7 @@ copy_surface_data (GdkMacosBuffer       *from,
   guint from_stride;
   guint to_stride;
   guint n_rects;
+  gboolean same_layout;
 
   g_assert (GDK_IS_MACOS_BUFFER (from));
   g_assert (GDK_IS_MACOS_BUFFER (to));
@@ -165,6 +166,12 @@ copy_surface_data (GdkMacosBuffer       *from,
   to_base = _gdk_macos_buffer_get_data (to);
   to_stride = _gdk_macos_buffer_get_stride (to);
 
+  /* Rows spanning the whole buffer are contiguous when both buffers
+   * share the same layout, so they can be copied in one go.
+   */
+  same_layout = from_stride == to_stride &&
+                _gdk_macos_buffer_get_width (from) == _gdk_macos_buffer_get_width (to);
+
   n_rects = cairo_region_num_rectangles (region);
 
   for (guint i = 0; i < n_rects; i++)
@@ -179,6 +186,16 @@ copy_surface_data (GdkMacosBuffer       *from,
       rect.x *= scale;
       rect.width *= scale;
 
+      if (same_layout &&
+          rect.x == 0 &&
+          rect.width == (int) _gdk_macos_buffer_get_width (to))
+        {
+          memcpy (&to_base[rect.y * to_stride],
+                  &from_base[rect.y * from_stride],
+                  (gsize) (rect.height - 1) * to_stride + rect.width * 4);
+          continue;
+        }
+
       y2 = rect.y + rect.height;
 
       for (int y = rect.y; y < y2; y++)
@@ -37,10 +37,25 @@ struct _GdkWaylandClipboard
 
   struct wl_data_offer *offer;
   GdkContentFormats *offer_formats;
+  guint offer_serial;
+  GHashTable *offer_cache; /* interned mime type => GBytes */
+  gsize offer_cache_size;
 
   struct wl_data_source *source;
 };
 
+/* Contents of the current offer are kept around up to this size,
+ * so that pasting the same thing again does not have to ask the
+ * source client for it again
+ */
+#define MAX_OFFER_CACHE_SIZE (16 * 1024 * 1024)
+
+typedef struct
+{
+  const char *mime_type;
+  guint offer_serial;
+} ReadData;
+
 struct _GdkWaylandClipboardClass
 {
   GdkClipboardClass parent_class;
@@ -53,6 +68,8 @@ gdk_wayland_clipboard_discard_offer (GdkWaylandClipboard *cb)
 {
   g_clear_pointer (&cb->offer_formats, gdk_content_formats_unref);
   g_clear_pointer (&cb->offer, wl_data_offer_destroy);
+  g_hash_table_remove_all (cb->offer_cache);
+  cb->offer_cache_size = 0;
 }
 
 static void
@@ -68,7 +85,8 @@ gdk_wayland_clipboard_finalize (GObject *object)
 
   gdk_wayland_clipboard_discard_offer (cb);
   gdk_wayland_clipboard_discard_source (cb);
-  
+  g_hash_table_unref (cb->offer_cache);
+
   G_OBJECT_CLASS (gdk_wayland_clipboard_parent_class)->finalize (object);
 }
 
@@ -206,6 +224,40 @@ gdk_wayland_clipboard_claim (GdkClipboard       *clipboard,
   return GDK_CLIPBOARD_CLASS (gdk_wayland_clipboard_parent_class)->claim (clipboard, formats, local, content);
 }
 
+static void
+gdk_wayland_clipboard_read_done (GObject      *source,
+                                 GAsyncResult *result,
+                                 gpointer      data)
+{
+  GTask *task = data;
+  GdkWaylandClipboard *cb = g_task_get_source_object (task);
+  ReadData *read_data = g_task_get_task_data (task);
+  GError *error = NULL;
+  GBytes *bytes;
+
+  if (g_output_stream_splice_finish (G_OUTPUT_STREAM (source), result, &error) < 0)
+    {
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      return;
+    }
+
+  bytes = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (source));
+
+  if (read_data->offer_serial == cb->offer_serial &&
+      cb->offer != NULL &&
+      cb->offer_cache_size + g_bytes_get_size (bytes) <= MAX_OFFER_CACHE_SIZE &&
+      !g_hash_table_contains (cb->offer_cache, read_data->mime_type))
+    {
+      g_hash_table_insert (cb->offer_cache, (gpointer) read_data->mime_type, g_bytes_ref (bytes));
+      cb->offer_cache_size += g_bytes_get_size (bytes);
+    }
+
+  g_task_return_pointer (task, g_memory_input_stream_new_from_bytes (bytes), g_object_unref);
+  g_bytes_unref (bytes);
+  g_object_unref (task);
+}
+
 static void
 gdk_wayland_clipboard_read_async (GdkClipboard        *clipboard,
                                   GdkContentFormats   *formats,
@@ -216,7 +268,10 @@ gdk_wayland_clipboard_read_async (GdkClipboard        *clipboard,
 {
   GdkWaylandClipboard *cb = GDK_WAYLAND_CLIPBOARD (clipboard);
   GInputStream *stream;
+  GOutputStream *output;
   const char *mime_type;
+  ReadData *read_data;
+  GBytes *cached;
   int pipe_fd[2];
   GError *error = NULL;
   GTask *task;
@@ -236,23 +291,50 @@ gdk_wayland_clipboard_read_async (GdkClipboard        *clipboard,
     {
       g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
                                _("No compatible transfer format found"));
+      g_object_unref (task);
       return;
     }
   /* offer formats should be empty if we have no offer */
   g_assert (cb->offer);
 
-  g_task_set_task_data (task, (gpointer) mime_type, NULL);
+  read_data = g_new (ReadData, 1);
+  read_data->mime_type = mime_type;
+  read_data->offer_serial = cb->offer_serial;
+  g_task_set_task_data (task, read_data, g_free);
+
+  cached = g_hash_table_lookup (cb->offer_cache, mime_type);
+  if (cached)
+    {
+      GDK_DISPLAY_DEBUG (gdk_clipboard_get_display (GDK_CLIPBOARD (cb)), CLIPBOARD,
+                         "%p: using cached contents for %s", cb, mime_type);
+      g_task_return_pointer (task, g_memory_input_stream_new_from_bytes (cached), g_object_unref);
+      g_object_unref (task);
+      return;
+    }
 
   if (!g_unix_open_pipe (pipe_fd, O_CLOEXEC, &error))
     {
       g_task_return_error (task, error);
+      g_object_unref (task);
       return;
     }
 
   wl_data_offer_receive (cb->offer, mime_type, pipe_fd[1]);
   stream = g_unix_input_stream_new (pipe_fd[0], TRUE);
   close (pipe_fd[1]);
-  g_task_return_pointer (task, stream, g_object_unref);
+
+  /* Read everything, so we can keep it for the next read */
+  output = g_memory_output_stream_new_resizable ();
+  g_output_stream_splice_async (output,
+                                stream,
+                                G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE
+                                | G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+                                io_priority,
+                                cancellable,
+                                gdk_wayland_clipboard_read_done,
+                                task);
+  g_object_unref (output);
+  g_object_unref (stream);
 }
 
 static GInputStream *
@@ -268,7 +350,11 @@ gdk_wayland_clipboard_read_finish (GdkClipboard  *clipboard,
   g_return_val_if_fail (g_task_get_source_tag (task) == gdk_wayland_clipboard_read_async, NULL);
 
   if (out_mime_type)
-    *out_mime_type = g_task_get_task_data (task);
+    {
+      ReadData *read_data = g_task_get_task_data (task);
+
+      *out_mime_type = read_data ? read_data->mime_type : NULL;
+    }
 
   return g_task_propagate_pointer (task, error);
 }
@@ -289,6 +375,7 @@ gdk_wayland_clipboard_class_init (GdkWaylandClipboardClass *class)
 static void
 gdk_wayland_clipboard_init (GdkWaylandClipboard *cb)
 {
+  cb->offer_cache = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) g_bytes_unref);
 }
 
 GdkClipboard *
@@ -328,6 +415,7 @@ gdk_wayland_clipboard_claim_remote (GdkWaylandClipboard  *cb,
     }
   cb->offer_formats = formats;
   cb->offer = offer;
+  cb->offer_serial++;
 
   gdk_clipboard_claim_remote (GDK_CLIPBOARD (cb),
                               cb->offer_formats);
@@ -152,6 +152,30 @@ static const struct wl_buffer_listener buffer_listener = {
   buffer_release_callback
 };
 
+static cairo_surface_t *
+gdk_wayland_cursor_create_surface (GdkWaylandDisplay *display,
+                                   GdkTexture        *texture)
+{
+  cairo_surface_t *surface;
+
+  /* Hands shared memory textures to the compositor without a copy */
+  surface = gdk_wayland_display_create_shm_surface_for_texture (display, texture);
+  if (surface)
+    return surface;
+
+  surface = gdk_wayland_display_create_shm_surface (display,
+                                                    gdk_texture_get_width (texture),
+                                                    gdk_texture_get_height (texture),
+                                                    &GDK_FRACTIONAL_SCALE_INIT_INT (1));
+
+  gdk_texture_download (texture,
+                        cairo_image_surface_get_data (surface),
+                        cairo_image_surface_get_stride (surface));
+  cairo_surface_mark_dirty (surface);
+
+  return surface;
+}
+
 struct wl_buffer *
 _gdk_wayland_cursor_get_buffer (GdkWaylandDisplay *display,
                                 GdkCursor         *cursor,
@@ -226,15 +250,7 @@ from_texture:
       surface = g_hash_table_lookup (display->cursor_surface_cache, cursor);
       if (surface == NULL)
         {
-          surface = gdk_wayland_display_create_shm_surface (display,
-                                                            gdk_texture_get_width (texture),
-                                                            gdk_texture_get_height (texture),
-                                                            &GDK_FRACTIONAL_SCALE_INIT_INT (1));
-
-          gdk_texture_download (texture,
-                                cairo_image_surface_get_data (surface),
-                                cairo_image_surface_get_stride (surface));
-          cairo_surface_mark_dirty (surface);
+          surface = gdk_wayland_cursor_create_surface (display, texture);
 
           g_object_weak_ref (G_OBJECT (cursor), gdk_wayland_cursor_remove_from_cache, display);
           g_hash_table_insert (display->cursor_surface_cache, cursor, surface);
@@ -274,15 +290,7 @@ from_texture:
           cairo_surface_t *surface;
           struct wl_buffer *buffer;
 
-          surface = gdk_wayland_display_create_shm_surface (display,
-                                                            gdk_texture_get_width (texture),
-                                                            gdk_texture_get_height (texture),
-                                                            &GDK_FRACTIONAL_SCALE_INIT_INT (1));
-
-          gdk_texture_download (texture,
-                                cairo_image_surface_get_data (surface),
-                                cairo_image_surface_get_stride (surface));
-          cairo_surface_mark_dirty (surface);
+          surface = gdk_wayland_cursor_create_surface (display, texture);
 
           buffer = _gdk_wayland_shm_surface_get_wl_buffer (surface);
           wl_buffer_add_listener (buffer, &buffer_listener, surface);
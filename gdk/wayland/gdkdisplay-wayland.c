@@ -50,6 +50,7 @@
 #include "gdkvulkancontext-wayland.h"
 #include "gdkwaylandmonitor.h"
 #include "gdkprofilerprivate.h"
+#include "gdkshmprivate.h"
 #include "gdktoplevel-wayland-private.h"
 #include <wayland/pointer-gestures-unstable-v1-client-protocol.h>
 #include "tablet-unstable-v2-client-protocol.h"
@@ -1316,68 +1317,10 @@ typedef struct _GdkWaylandCairoSurfaceData {
   struct wl_buffer *buffer;
   GdkWaylandDisplay *display;
   GdkFractionalScale scale;
+  /* set if the memory belongs to a texture */
+  GdkTexture *texture;
 } GdkWaylandCairoSurfaceData;
 
-static int
-open_shared_memory (void)
-{
-  static gboolean force_shm_open = FALSE;
-  int ret = -1;
-
-#if !defined (__NR_memfd_create)
-  force_shm_open = TRUE;
-#endif
-
-  do
-    {
-#if defined (__NR_memfd_create)
-      if (!force_shm_open)
-        {
-          int options = MFD_CLOEXEC;
-#if defined (MFD_ALLOW_SEALING)
-          options |= MFD_ALLOW_SEALING;
-#endif
-          ret = syscall (__NR_memfd_create, "gdk-wayland", options);
-
-          /* fall back to shm_open until debian stops shipping 3.16 kernel
-           * See bug 766341
-           */
-          if (ret < 0 && errno == ENOSYS)
-            force_shm_open = TRUE;
-#if defined (F_ADD_SEALS) && defined (F_SEAL_SHRINK)
-          if (ret >= 0)
-            fcntl (ret, F_ADD_SEALS, F_SEAL_SHRINK);
-#endif
-        }
-#endif
-
-      if (force_shm_open)
-        {
-#if defined (__FreeBSD__)
-          ret = shm_open (SHM_ANON, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
-#else
-          char name[NAME_MAX - 1] = "";
-
-          sprintf (name, "/gdk-wayland-%x", g_random_int ());
-
-          ret = shm_open (name, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
-
-          if (ret >= 0)
-            shm_unlink (name);
-          else if (errno == EEXIST)
-            continue;
-#endif
-        }
-    }
-  while (ret < 0 && errno == EINTR);
-
-  if (ret < 0)
-    g_critical (G_STRLOC ": creating shared memory file (using %s) failed: %m",
-                force_shm_open? "shm_open" : "memfd_create");
-
-  return ret;
-}
-
 static struct wl_shm_pool *
 create_shm_pool (struct wl_shm  *shm,
                  int             size,
@@ -1388,7 +1331,7 @@ create_shm_pool (struct wl_shm  *shm,
   int fd;
   void *data;
 
-  fd = open_shared_memory ();
+  fd = gdk_shm_open ("gdk-wayland");
 
   if (fd < 0)
     goto fail;
@@ -1435,7 +1378,10 @@ gdk_wayland_cairo_surface_destroy (void *p)
   if (data->pool)
     wl_shm_pool_destroy (data->pool);
 
-  munmap (data->buf, data->buf_length);
+  if (data->texture)
+    g_object_unref (data->texture);
+  else
+    munmap (data->buf, data->buf_length);
   g_free (data);
 }
 
@@ -1455,6 +1401,7 @@ gdk_wayland_display_create_shm_surface (GdkWaylandDisplay        *display,
   data->display = display;
   data->buffer = NULL;
   data->scale = *scale;
+  data->texture = NULL;
 
   scaled_width = gdk_fractional_scale_scale (scale, width);
   scaled_height = gdk_fractional_scale_scale (scale, height);
@@ -1494,6 +1441,66 @@ gdk_wayland_display_create_shm_surface (GdkWaylandDisplay        *display,
   return surface;
 }
 
+/*
+ * gdk_wayland_display_create_shm_surface_for_texture:
+ * @display: the display
+ * @texture: the texture to show
+ *
+ * Like gdk_wayland_display_create_shm_surface(), but for the contents
+ * of @texture. If @texture is backed by shared memory in the right
+ * format already, its memory is handed to the compositor directly,
+ * otherwise it is copied once.
+ *
+ * The surface must not be drawn to.
+ */
+cairo_surface_t *
+gdk_wayland_display_create_shm_surface_for_texture (GdkWaylandDisplay *display,
+                                                    GdkTexture        *texture)
+{
+  GdkWaylandCairoSurfaceData *data;
+  GdkTexture *shm_texture;
+  cairo_surface_t *surface;
+  GBytes *bytes;
+  gsize offset, stride;
+  int width, height;
+  int fd;
+
+  width = gdk_texture_get_width (texture);
+  height = gdk_texture_get_height (texture);
+
+  /* This is WL_SHM_FORMAT_ARGB8888, like CAIRO_FORMAT_ARGB32 */
+  shm_texture = gdk_memory_texture_new_shm (width, height, GDK_MEMORY_DEFAULT, texture);
+  if (shm_texture == NULL)
+    return NULL;
+
+  fd = gdk_memory_texture_get_shm_fd (GDK_MEMORY_TEXTURE (shm_texture), &offset, &stride);
+  g_assert (fd >= 0);
+
+  data = g_new (GdkWaylandCairoSurfaceData, 1);
+  data->display = display;
+  data->scale = GDK_FRACTIONAL_SCALE_INIT_INT (1);
+  data->texture = shm_texture;
+  bytes = gdk_memory_texture_get_bytes (GDK_MEMORY_TEXTURE (shm_texture), &stride);
+  data->buf = (gpointer) g_bytes_get_data (bytes, NULL);
+  data->buf_length = offset + stride * height;
+
+  /* The pool maps the file from the start, the buffer starts at the
+   * texture's offset */
+  data->pool = wl_shm_create_pool (display->shm, fd, data->buf_length);
+  data->buffer = wl_shm_pool_create_buffer (data->pool, offset,
+                                            width, height,
+                                            stride, WL_SHM_FORMAT_ARGB8888);
+
+  surface = cairo_image_surface_create_for_data (data->buf,
+                                                 CAIRO_FORMAT_ARGB32,
+                                                 width, height,
+                                                 stride);
+  cairo_surface_set_user_data (surface, &gdk_wayland_shm_surface_cairo_key,
+                               data, gdk_wayland_cairo_surface_destroy);
+
+  return surface;
+}
+
 struct wl_buffer *
 _gdk_wayland_shm_surface_get_wl_buffer (cairo_surface_t *surface)
 {
@@ -21,6 +21,9 @@
 
 #include "gdkeventsprivate.h"
 
+#include <glib-unix.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <unistd.h>
 #include <errno.h>
 
@@ -30,8 +33,108 @@ typedef struct _GdkWaylandEventSource {
   uint32_t mask;
   GdkDisplay *display;
   gboolean reading;
+
+  /* With GDK_DEBUG=wayland-read-thread, a thread reads from the socket
+   * into the event queues, and the main thread only dispatches them
+   */
+  GThread *read_thread;
+  GMainContext *context;
+  struct wl_event_queue *read_queue;
+  int stop_fds[2];
+  int read_error; /* atomic */
 } GdkWaylandEventSource;
 
+/* Reading with a queue of our own that never gets any events means
+ * wl_display_prepare_read_queue() always succeeds, even while the main
+ * thread has not dispatched what we read last time.
+ */
+static gpointer
+gdk_event_source_read_thread (gpointer data)
+{
+  GdkWaylandEventSource *source = data;
+  GdkWaylandDisplay *display = (GdkWaylandDisplay *) source->display;
+  struct pollfd fds[2];
+
+  fds[0].fd = wl_display_get_fd (display->wl_display);
+  fds[0].events = POLLIN;
+  fds[1].fd = source->stop_fds[0];
+  fds[1].events = POLLIN;
+
+  while (TRUE)
+    {
+      if (wl_display_prepare_read_queue (display->wl_display, source->read_queue) != 0)
+        {
+          g_atomic_int_set (&source->read_error, EINVAL);
+          break;
+        }
+
+      if (poll (fds, G_N_ELEMENTS (fds), -1) < 0)
+        {
+          wl_display_cancel_read (display->wl_display);
+          if (errno == EINTR)
+            continue;
+
+          g_atomic_int_set (&source->read_error, errno);
+          break;
+        }
+
+      if (fds[1].revents)
+        {
+          wl_display_cancel_read (display->wl_display);
+          return NULL;
+        }
+
+      if (fds[0].revents & POLLIN)
+        {
+          if (wl_display_read_events (display->wl_display) < 0)
+            {
+              g_atomic_int_set (&source->read_error, errno);
+              break;
+            }
+        }
+      else
+        {
+          wl_display_cancel_read (display->wl_display);
+          if (fds[0].revents & (POLLERR | POLLHUP))
+            {
+              g_atomic_int_set (&source->read_error, EPIPE);
+              break;
+            }
+        }
+
+      g_main_context_wakeup (source->context);
+    }
+
+  g_main_context_wakeup (source->context);
+
+  return NULL;
+}
+
+static gboolean
+gdk_event_source_has_pending (GdkWaylandEventSource *source)
+{
+  GdkWaylandDisplay *display = (GdkWaylandDisplay *) source->display;
+  GList *l;
+
+  if (g_atomic_int_get (&source->read_error) != 0)
+    return TRUE;
+
+  if (wl_display_prepare_read (display->wl_display) != 0)
+    return TRUE;
+  wl_display_cancel_read (display->wl_display);
+
+  for (l = display->event_queues; l; l = l->next)
+    {
+      struct wl_event_queue *queue = l->data;
+
+      if (wl_display_prepare_read_queue (display->wl_display, queue) != 0)
+        return TRUE;
+      wl_display_cancel_read (display->wl_display);
+    }
+
+  return FALSE;
+}
+
 static gboolean
 gdk_event_source_prepare (GSource *base,
                           int     *timeout)
@@ -53,6 +156,20 @@ gdk_event_source_prepare (GSource *base,
   if (_gdk_event_queue_find_first (source->display) != NULL)
     return TRUE;
 
+  if (source->read_thread)
+    {
+      if (gdk_event_source_has_pending (source))
+        return TRUE;
+
+      if (wl_display_flush (display->wl_display) < 0)
+        {
+          g_message ("Error flushing display: %s", g_strerror (errno));
+          _exit (1);
+        }
+
+      return FALSE;
+    }
+
   /* wl_display_prepare_read() needs to be balanced with either
    * wl_display_read_events() or wl_display_cancel_read()
    * (in gdk_event_source_check() */
@@ -106,6 +223,10 @@ gdk_event_source_check (GSource *base)
       return _gdk_event_queue_find_first (source->display) != NULL;
     }
 
+  if (source->read_thread)
+    return _gdk_event_queue_find_first (source->display) != NULL ||
+           gdk_event_source_has_pending (source);
+
   /* read the events from the wayland fd into their respective queues if we have data */
   if (source->reading)
     {
@@ -156,6 +277,20 @@ gdk_event_source_finalize (GSource *base)
   if (source->reading)
     wl_display_cancel_read (display->wl_display);
   source->reading = FALSE;
+
+  if (source->read_thread)
+    {
+      char c = 0;
+
+      if (write (source->stop_fds[1], &c, 1) < 0)
+        g_warning ("Failed to stop the Wayland read thread: %s", g_strerror (errno));
+      g_thread_join (source->read_thread);
+      source->read_thread = NULL;
+
+      close (source->stop_fds[0]);
+      close (source->stop_fds[1]);
+      wl_event_queue_destroy (source->read_queue);
+    }
 }
 
 static GSourceFuncs wl_glib_source_funcs = {
@@ -194,14 +329,37 @@ _gdk_wayland_display_event_source_new (GdkDisplay *display)
 
   display_wayland = GDK_WAYLAND_DISPLAY (display);
   wl_source->display = display;
-  wl_source->pfd.fd = wl_display_get_fd (display_wayland->wl_display);
-  wl_source->pfd.events = G_IO_IN | G_IO_ERR | G_IO_HUP;
-  g_source_add_poll (source, &wl_source->pfd);
 
   g_source_set_priority (source, GDK_PRIORITY_EVENTS);
   g_source_set_can_recurse (source, TRUE);
   g_source_attach (source, NULL);
 
+  if (GDK_DISPLAY_DEBUG_CHECK (display, WAYLAND_READ_THREAD))
+    {
+      GError *error = NULL;
+
+      if (g_unix_open_pipe (wl_source->stop_fds, O_CLOEXEC, &error))
+        {
+          wl_source->context = g_source_get_context (source);
+          wl_source->read_queue = wl_display_create_queue (display_wayland->wl_display);
+          wl_source->read_thread = g_thread_new ("wayland-read",
+                                                 gdk_event_source_read_thread,
+                                                 wl_source);
+        }
+      else
+        {
+          g_warning ("Failed to create the Wayland read thread: %s", error->message);
+          g_error_free (error);
+        }
+    }
+
+  if (wl_source->read_thread == NULL)
+    {
+      wl_source->pfd.fd = wl_display_get_fd (display_wayland->wl_display);
+      wl_source->pfd.events = G_IO_IN | G_IO_ERR | G_IO_HUP;
+      g_source_add_poll (source, &wl_source->pfd);
+    }
+
   return source;
 }
 
@@ -234,7 +392,8 @@ _gdk_wayland_display_queue_events (GdkDisplay *display)
         }
     }
 
-  if (source->pfd.revents & (G_IO_ERR | G_IO_HUP))
+  if (source->pfd.revents & (G_IO_ERR | G_IO_HUP) ||
+      g_atomic_int_get (&source->read_error) != 0)
     {
       g_message ("Lost connection to Wayland compositor.");
       _exit (1);
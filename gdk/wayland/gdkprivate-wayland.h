@@ -207,6 +207,9 @@ cairo_surface_t * gdk_wayland_display_create_shm_surface  (GdkWaylandDisplay
                                                            int                       width,
                                                            int                       height,
                                                            const GdkFractionalScale *scale);
+cairo_surface_t * gdk_wayland_display_create_shm_surface_for_texture
+                                                          (GdkWaylandDisplay        *display,
+                                                           GdkTexture               *texture);
 struct wl_buffer *_gdk_wayland_shm_surface_get_wl_buffer (cairo_surface_t *surface);
 gboolean _gdk_wayland_is_shm_surface (cairo_surface_t *surface);
 
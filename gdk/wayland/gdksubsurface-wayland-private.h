@@ -27,6 +27,8 @@ struct _GdkWaylandSubsurface
   struct wl_region *opaque_region;
 
   struct wl_callback *frame_callback;
+
+  GQueue buffers; /* CachedBuffer, most recently used first */
 };
 
 struct _GdkWaylandSubsurfaceClass
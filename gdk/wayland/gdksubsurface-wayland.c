@@ -28,6 +28,89 @@
 
 #include "linux-dmabuf-unstable-v1-client-protocol.h"
 
+#include <sys/stat.h>
+
+/* Video players cycle through a small pool of dmabufs, so we keep the
+ * wl_buffers for the most recently used ones around and attach them
+ * again, instead of creating a new one with a roundtrip every frame.
+ */
+#define MAX_CACHED_BUFFERS 8
+
+typedef struct {
+  /* NULL if the buffer is not cached, it is destroyed on release */
+  GdkWaylandSubsurface *self;
+  struct wl_buffer *buffer;
+  /* The texture using the buffer until the compositor releases it */
+  GdkTexture *texture;
+
+  /* dmabuf fds have a unique inode per buffer, which identifies
+   * the buffer no matter which fd or texture it comes from
+   */
+  ino_t inode;
+  int width;
+  int height;
+  GdkDmabuf dmabuf;
+} CachedBuffer;
+
+static void
+cached_buffer_free (CachedBuffer *cb)
+{
+  g_clear_object (&cb->texture);
+  wl_buffer_destroy (cb->buffer);
+  g_free (cb);
+}
+
+/* Drops the buffer from the cache. Buffers that are still in use
+ * are destroyed when the compositor releases them.
+ */
+static void
+cached_buffer_evict (CachedBuffer *cb)
+{
+  if (cb->texture)
+    cb->self = NULL;
+  else
+    cached_buffer_free (cb);
+}
+
+static gboolean
+cached_buffer_matches (CachedBuffer    *cb,
+                       ino_t            inode,
+                       GdkTexture      *texture,
+                       const GdkDmabuf *dmabuf)
+{
+  if (cb->inode != inode ||
+      cb->width != gdk_texture_get_width (texture) ||
+      cb->height != gdk_texture_get_height (texture) ||
+      cb->dmabuf.fourcc != dmabuf->fourcc ||
+      cb->dmabuf.modifier != dmabuf->modifier ||
+      cb->dmabuf.n_planes != dmabuf->n_planes)
+    return FALSE;
+
+  for (gsize i = 0; i < dmabuf->n_planes; i++)
+    {
+      if (cb->dmabuf.planes[i].offset != dmabuf->planes[i].offset ||
+          cb->dmabuf.planes[i].stride != dmabuf->planes[i].stride)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+gdk_wayland_subsurface_clear_buffers (GdkWaylandSubsurface *self)
+{
+  GList *l, *next;
+
+  for (l = self->buffers.head; l; l = next)
+    {
+      CachedBuffer *cb = l->data;
+
+      next = l->next;
+      cached_buffer_evict (cb);
+      g_queue_delete_link (&self->buffers, l);
+    }
+}
+
 G_DEFINE_TYPE (GdkWaylandSubsurface, gdk_wayland_subsurface, GDK_TYPE_SUBSURFACE)
 
 static void
@@ -40,6 +123,7 @@ gdk_wayland_subsurface_finalize (GObject *object)
 {
   GdkWaylandSubsurface *self = GDK_WAYLAND_SUBSURFACE (object);
 
+  gdk_wayland_subsurface_clear_buffers (self);
   g_clear_object (&self->texture);
   g_clear_pointer (&self->frame_callback, wl_callback_destroy);
   g_clear_pointer (&self->opaque_region, wl_region_destroy);
@@ -55,10 +139,12 @@ static void
 dmabuf_buffer_release (void             *data,
                        struct wl_buffer *buffer)
 {
-  GdkTexture *texture = data;
+  CachedBuffer *cb = data;
 
-  g_object_unref (texture);
-  wl_buffer_destroy (buffer);
+  if (cb->self == NULL)
+    cached_buffer_free (cb);
+  else
+    g_clear_object (&cb->texture);
 }
 
 static const struct wl_buffer_listener dmabuf_buffer_listener = {
@@ -106,9 +192,31 @@ get_wl_buffer (GdkWaylandSubsurface *self,
   struct wl_buffer *buffer;
   CreateBufferData cd = { NULL, FALSE };
   struct wl_event_queue *event_queue;
+  struct stat st;
+  gboolean cacheable;
+  CachedBuffer *cb;
+  GList *l;
 
   dmabuf = gdk_dmabuf_texture_get_dmabuf (GDK_DMABUF_TEXTURE (texture));
 
+  cacheable = fstat (dmabuf->planes[0].fd, &st) == 0;
+  if (cacheable)
+    {
+      for (l = self->buffers.head; l; l = l->next)
+        {
+          cb = l->data;
+
+          if (cb->texture == NULL &&
+              cached_buffer_matches (cb, st.st_ino, texture, dmabuf))
+            {
+              g_queue_unlink (&self->buffers, l);
+              g_queue_push_head_link (&self->buffers, l);
+              cb->texture = g_object_ref (texture);
+              return cb->buffer;
+            }
+        }
+    }
+
   params = zwp_linux_dmabuf_v1_create_params (display->linux_dmabuf);
 
   for (gsize i = 0; i < dmabuf->n_planes; i++)
@@ -142,8 +250,25 @@ get_wl_buffer (GdkWaylandSubsurface *self,
 
   if (buffer)
     {
+      cb = g_new0 (CachedBuffer, 1);
+      cb->buffer = buffer;
+      cb->texture = g_object_ref (texture);
+
       wl_proxy_set_queue ((struct wl_proxy *) buffer, NULL);
-      wl_buffer_add_listener (buffer, &dmabuf_buffer_listener, g_object_ref (texture));
+      wl_buffer_add_listener (buffer, &dmabuf_buffer_listener, cb);
+
+      if (cacheable)
+        {
+          cb->self = self;
+          cb->inode = st.st_ino;
+          cb->width = gdk_texture_get_width (texture);
+          cb->height = gdk_texture_get_height (texture);
+          cb->dmabuf = *dmabuf;
+          g_queue_push_head (&self->buffers, cb);
+
+          if (self->buffers.length > MAX_CACHED_BUFFERS)
+            cached_buffer_evict (g_queue_pop_tail (&self->buffers));
+        }
     }
 
   return buffer;
@@ -366,6 +491,7 @@ gdk_wayland_subsurface_detach (GdkSubsurface *sub)
     }
 
   g_set_object (&self->texture, NULL);
+  gdk_wayland_subsurface_clear_buffers (self);
   wl_surface_attach (self->surface, NULL, 0, 0);
   wl_surface_set_opaque_region (self->surface, self->opaque_region);
   wl_surface_commit (self->surface);
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "gdkprivate-wayland.h"
+#include "gdkdmabufformatsbuilderprivate.h"
 
 typedef enum _PopupState
 {
@@ -44,6 +45,18 @@ struct _GdkWaylandSurface
   struct wl_event_queue *event_queue;
   struct wl_callback *frame_callback;
 
+  /* Per-surface dmabuf feedback, collected into the surface's
+   * scanout formats when the compositor sends the done event.
+   */
+  struct {
+    struct zwp_linux_dmabuf_feedback_v1 *feedback;
+    LinuxDmabufFormat *format_table;
+    gsize format_table_size;
+    struct wl_array tranche_formats;
+    gboolean tranche_is_scanout;
+    GdkDmabufFormatsBuilder *scanout_formats;
+  } dmabuf;
+
   GdkWaylandPresentationTime *presentation_time;
 
   unsigned int initial_configure_received : 1;
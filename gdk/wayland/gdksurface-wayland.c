@@ -46,6 +46,7 @@
 #include <errno.h>
 
 #include <netinet/in.h>
+#include <sys/mman.h>
 #include <unistd.h>
 
 #include "gdksurface-wayland-private.h"
@@ -255,6 +256,17 @@ gdk_wayland_surface_update_size (GdkSurface               *surface,
       int w, h;
       get_egl_window_size (surface, &w, &h);
       wl_egl_window_resize (impl->display_server.egl_window, w, h, 0, 0);
+
+      if (GDK_DISPLAY_DEBUG_CHECK (gdk_surface_get_display (surface), OPENGL))
+        {
+          double rendered = (double) w * h;
+          double displayed = (double) gdk_fractional_scale_scale (&impl->scale, width) *
+                             gdk_fractional_scale_scale (&impl->scale, height);
+
+          gdk_debug_message ("Rendering %.0f pixels for %.0f displayed pixels (%.0f%%)",
+                             rendered, displayed,
+                             displayed > 0 ? 100 * rendered / displayed : 100);
+        }
     }
 
   gdk_surface_invalidate_rect (surface, NULL);
@@ -314,19 +326,30 @@ gdk_wayland_surface_frame_callback (GdkSurface *surface,
   if (timings == NULL)
     return;
 
-  timings->refresh_interval = 16667; /* default to 1/60th of a second */
-  if (impl->display_server.outputs)
+  /* Presentation feedback knows the refresh of the output the frame
+   * was actually shown on, so only guess if it didn't tell us.
+   */
+  if (timings->refresh_interval == 0)
     {
-      /* We pick a random output out of the outputs that the surface touches
+      GSList *l;
+      int refresh_rate = 0;
+
+      timings->refresh_interval = 16667; /* default to 1/60th of a second */
+
+      /* Use the fastest output that the surface touches. Frame callbacks
+       * pace us to the output we are synced to anyway, and on outputs
+       * with variable refresh rate, this is the rate we can reach.
        * The rate here is in milli-hertz */
-      int refresh_rate =
-        gdk_wayland_display_get_output_refresh_rate (display_wayland,
-                                                     impl->display_server.outputs->data);
+      for (l = impl->display_server.outputs; l != NULL; l = l->next)
+        refresh_rate = MAX (refresh_rate,
+                            gdk_wayland_display_get_output_refresh_rate (display_wayland, l->data));
+
       if (refresh_rate != 0)
         timings->refresh_interval = G_GINT64_CONSTANT(1000000000) / refresh_rate;
     }
 
-  fill_presentation_time_from_frame_time (timings, time);
+  if (timings->presentation_time == 0)
+    fill_presentation_time_from_frame_time (timings, time);
 
   timings->complete = TRUE;
 
@@ -853,6 +876,120 @@ static const struct wl_surface_listener surface_listener = {
   surface_leave
 };
 
+static void
+surface_dmabuf_done (void                               *data,
+                     struct zwp_linux_dmabuf_feedback_v1 *feedback)
+{
+  GdkWaylandSurface *self = data;
+  GdkDmabufFormats *formats;
+
+  if (self->dmabuf.scanout_formats == NULL)
+    {
+      gdk_surface_set_scanout_formats (GDK_SURFACE (self), NULL);
+      return;
+    }
+
+  formats = gdk_dmabuf_formats_builder_free_to_formats (self->dmabuf.scanout_formats);
+  self->dmabuf.scanout_formats = NULL;
+
+  gdk_surface_set_scanout_formats (GDK_SURFACE (self), formats);
+  gdk_dmabuf_formats_unref (formats);
+}
+
+static void
+surface_dmabuf_format_table (void                               *data,
+                             struct zwp_linux_dmabuf_feedback_v1 *feedback,
+                             int32_t                              fd,
+                             uint32_t                             size)
+{
+  GdkWaylandSurface *self = data;
+
+  if (self->dmabuf.format_table)
+    munmap (self->dmabuf.format_table, self->dmabuf.format_table_size);
+
+  self->dmabuf.format_table = mmap (NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (self->dmabuf.format_table == MAP_FAILED)
+    {
+      self->dmabuf.format_table = NULL;
+      size = 0;
+    }
+  self->dmabuf.format_table_size = size;
+
+  close (fd);
+}
+
+static void
+surface_dmabuf_main_device (void                               *data,
+                            struct zwp_linux_dmabuf_feedback_v1 *feedback,
+                            struct wl_array                     *device)
+{
+}
+
+static void
+surface_dmabuf_tranche_done (void                               *data,
+                             struct zwp_linux_dmabuf_feedback_v1 *feedback)
+{
+  GdkWaylandSurface *self = data;
+  gsize n_formats = self->dmabuf.format_table_size / sizeof (LinuxDmabufFormat);
+  guint16 *pos;
+
+  if (self->dmabuf.tranche_is_scanout)
+    {
+      if (self->dmabuf.scanout_formats == NULL)
+        self->dmabuf.scanout_formats = gdk_dmabuf_formats_builder_new ();
+
+      wl_array_for_each (pos, &self->dmabuf.tranche_formats)
+        {
+          if (*pos >= n_formats)
+            continue;
+
+          gdk_dmabuf_formats_builder_add_format (self->dmabuf.scanout_formats,
+                                                 self->dmabuf.format_table[*pos].fourcc,
+                                                 self->dmabuf.format_table[*pos].modifier);
+        }
+    }
+
+  self->dmabuf.tranche_formats.size = 0;
+  self->dmabuf.tranche_is_scanout = FALSE;
+}
+
+static void
+surface_dmabuf_tranche_target_device (void                               *data,
+                                      struct zwp_linux_dmabuf_feedback_v1 *feedback,
+                                      struct wl_array                     *device)
+{
+}
+
+static void
+surface_dmabuf_tranche_formats (void                               *data,
+                                struct zwp_linux_dmabuf_feedback_v1 *feedback,
+                                struct wl_array                     *indices)
+{
+  GdkWaylandSurface *self = data;
+
+  wl_array_copy (&self->dmabuf.tranche_formats, indices);
+}
+
+static void
+surface_dmabuf_tranche_flags (void                               *data,
+                              struct zwp_linux_dmabuf_feedback_v1 *feedback,
+                              uint32_t                             flags)
+{
+  GdkWaylandSurface *self = data;
+
+  self->dmabuf.tranche_is_scanout = (flags & ZWP_LINUX_DMABUF_FEEDBACK_V1_TRANCHE_FLAGS_SCANOUT) != 0;
+}
+
+static const struct zwp_linux_dmabuf_feedback_v1_listener surface_dmabuf_feedback_listener = {
+  surface_dmabuf_done,
+  surface_dmabuf_format_table,
+  surface_dmabuf_main_device,
+  surface_dmabuf_tranche_done,
+  surface_dmabuf_tranche_target_device,
+  surface_dmabuf_tranche_formats,
+  surface_dmabuf_tranche_flags,
+};
+
 static void
 gdk_wayland_surface_create_wl_surface (GdkSurface *surface)
 {
@@ -876,6 +1013,15 @@ gdk_wayland_surface_create_wl_surface (GdkSurface *surface)
       self->display_server.viewport =
           wp_viewporter_get_viewport (display_wayland->viewporter, wl_surface);
     }
+  if (display_wayland->linux_dmabuf)
+    {
+      wl_array_init (&self->dmabuf.tranche_formats);
+      self->dmabuf.feedback =
+          zwp_linux_dmabuf_v1_get_surface_feedback (display_wayland->linux_dmabuf, wl_surface);
+      wl_proxy_set_queue ((struct wl_proxy *) self->dmabuf.feedback, self->event_queue);
+      zwp_linux_dmabuf_feedback_v1_add_listener (self->dmabuf.feedback,
+                                                 &surface_dmabuf_feedback_listener, self);
+    }
 
   self->display_server.wl_surface = wl_surface;
 }
@@ -931,6 +1077,20 @@ gdk_wayland_surface_destroy_wl_surface (GdkWaylandSurface *self)
   g_clear_pointer (&self->display_server.viewport, wp_viewport_destroy);
   g_clear_pointer (&self->display_server.fractional_scale, wp_fractional_scale_v1_destroy);
 
+  if (self->dmabuf.feedback)
+    {
+      g_clear_pointer (&self->dmabuf.feedback, zwp_linux_dmabuf_feedback_v1_destroy);
+      if (self->dmabuf.format_table)
+        munmap (self->dmabuf.format_table, self->dmabuf.format_table_size);
+      self->dmabuf.format_table = NULL;
+      self->dmabuf.format_table_size = 0;
+      wl_array_release (&self->dmabuf.tranche_formats);
+      if (self->dmabuf.scanout_formats)
+        gdk_dmabuf_formats_unref (gdk_dmabuf_formats_builder_free_to_formats (self->dmabuf.scanout_formats));
+      self->dmabuf.scanout_formats = NULL;
+      gdk_surface_set_scanout_formats (GDK_SURFACE (self), NULL);
+    }
+
   g_clear_pointer (&self->display_server.wl_surface, wl_surface_destroy);
 
   g_clear_pointer (&self->display_server.outputs, g_slist_free);
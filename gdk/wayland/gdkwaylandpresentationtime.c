@@ -93,6 +93,9 @@ gdk_wayland_presentation_feedback_presented (void                            *da
   if ((timings = gdk_frame_clock_get_timings (frame->frame_clock, frame->frame_number)))
     {
       timings->presentation_time = time_from_wayland (tv_sec_hi, tv_sec_lo, tv_nsec);
+      /* The refresh is 0 for outputs with variable refresh rate */
+      if (refresh != 0)
+        timings->refresh_interval = refresh / 1000;
       timings->complete = TRUE;
     }
 
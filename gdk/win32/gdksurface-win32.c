@@ -131,6 +131,8 @@ typedef struct _AeroSnapEdgeRegion AeroSnapEdgeRegion;
  */
 #define AEROSNAP_INDICATOR_ANIMATION_TICK (16)
 
+static void     gdk_win32_impl_frame_clock_before_paint (GdkFrameClock *clock,
+                                                         GdkSurface    *surface);
 static void     gdk_win32_impl_frame_clock_after_paint (GdkFrameClock *clock,
                                                         GdkSurface    *surface);
 
@@ -218,13 +220,71 @@ _gdk_win32_get_window_client_area_rect (GdkSurface *window,
   rect->bottom = rect->top + height * scale;
 }
 
+/* Queries the refresh interval and the times of the last vblank and
+ * the last composition from DWM, in g_get_monotonic_time() units
+ */
+static gboolean
+gdk_win32_get_composition_timing (gint64 *refresh_interval,
+                                  gint64 *vblank_time,
+                                  gint64 *compose_time)
+{
+  DWM_TIMING_INFO timing_info;
+  LARGE_INTEGER tick_frequency;
+  double usec_per_tick;
+
+  if (!QueryPerformanceFrequency (&tick_frequency))
+    return FALSE;
+
+  timing_info.cbSize = sizeof (timing_info);
+  if (FAILED (DwmGetCompositionTimingInfo (NULL, &timing_info)))
+    return FALSE;
+
+  if (timing_info.qpcRefreshPeriod == 0)
+    return FALSE;
+
+  usec_per_tick = (double) G_USEC_PER_SEC / tick_frequency.QuadPart;
+  *refresh_interval = timing_info.qpcRefreshPeriod * usec_per_tick;
+  *vblank_time = timing_info.qpcVBlank * usec_per_tick;
+  *compose_time = timing_info.qpcCompose * usec_per_tick;
+
+  return *refresh_interval > 0;
+}
+
+static void
+gdk_win32_impl_frame_clock_before_paint (GdkFrameClock *clock,
+                                         GdkSurface    *surface)
+{
+  GdkFrameTimings *timings;
+  gint64 refresh_interval, vblank_time, compose_time;
+  gint64 now;
+
+  timings = gdk_frame_clock_get_current_timings (clock);
+  if (timings == NULL)
+    return;
+
+  if (!gdk_win32_get_composition_timing (&refresh_interval, &vblank_time, &compose_time))
+    {
+      timings->predicted_presentation_time = timings->frame_time + 16667;
+      return;
+    }
+
+  /* DWM composes once per vblank, so the frame we are about to draw
+   * shows up at the first vblank after we are done painting. Assume
+   * painting fits into the remainder of the current interval.
+   */
+  now = g_get_monotonic_time ();
+  if (vblank_time <= now)
+    vblank_time += ((now - vblank_time) / refresh_interval + 1) * refresh_interval;
+
+  timings->predicted_presentation_time = vblank_time;
+}
+
 static void
 gdk_win32_impl_frame_clock_after_paint (GdkFrameClock *clock,
                                         GdkSurface    *surface)
 {
-  DWM_TIMING_INFO timing_info;
-  LARGE_INTEGER tick_frequency;
   GdkFrameTimings *timings;
+  gint64 refresh_interval, vblank_time, compose_time;
 
   timings = gdk_frame_clock_get_timings (clock, gdk_frame_clock_get_frame_counter (clock));
 
@@ -233,18 +293,10 @@ gdk_win32_impl_frame_clock_after_paint (GdkFrameClock *clock,
       timings->refresh_interval = 16667; /* default to 1/60th of a second */
       timings->presentation_time = 0;
 
-      if (QueryPerformanceFrequency (&tick_frequency))
+      if (gdk_win32_get_composition_timing (&refresh_interval, &vblank_time, &compose_time))
         {
-          HRESULT hr;
-
-          timing_info.cbSize = sizeof (timing_info);
-          hr = DwmGetCompositionTimingInfo (NULL, &timing_info);
-
-          if (SUCCEEDED (hr))
-            {
-              timings->refresh_interval = timing_info.qpcRefreshPeriod * (double)G_USEC_PER_SEC / tick_frequency.QuadPart;
-              timings->presentation_time = timing_info.qpcCompose * (double)G_USEC_PER_SEC / tick_frequency.QuadPart;
-            }
+          timings->refresh_interval = refresh_interval;
+          timings->presentation_time = compose_time;
         }
 
       timings->complete = TRUE;
@@ -526,6 +578,10 @@ gdk_win32_surface_constructed (GObject *object)
   _gdk_win32_surface_register_dnd (surface);
   _gdk_win32_surface_update_style_bits (surface);
 
+  g_signal_connect (frame_clock,
+                    "before-paint",
+                    G_CALLBACK (gdk_win32_impl_frame_clock_before_paint),
+                    impl);
   g_signal_connect (frame_clock,
                     "after-paint",
                     G_CALLBACK (gdk_win32_impl_frame_clock_after_paint),
@@ -555,6 +611,9 @@ gdk_win32_surface_destroy (GdkSurface *window,
   /* Remove ourself from the modal stack */
   _gdk_remove_modal_window (window);
 
+  g_signal_handlers_disconnect_by_func (gdk_surface_get_frame_clock (window),
+                                        gdk_win32_impl_frame_clock_before_paint,
+                                        window);
   g_signal_handlers_disconnect_by_func (gdk_surface_get_frame_clock (window),
                                         gdk_win32_impl_frame_clock_after_paint,
                                         window);
@@ -29,8 +29,215 @@
 
 #include <X11/Xlib.h>
 
+#ifdef HAVE_XSHM
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <X11/extensions/XShm.h>
+#endif
+
 G_DEFINE_TYPE (GdkX11CairoContext, gdk_x11_cairo_context, GDK_TYPE_CAIRO_CONTEXT)
 
+#ifdef HAVE_XSHM
+
+/* A window-sized image in shared memory. We paint into it with cairo's
+ * image backend and hand the damaged parts to the X server with
+ * XShmPutImage(), which avoids copying the pixels through the socket.
+ */
+typedef struct
+{
+  XShmSegmentInfo info;
+  XImage *image;
+  GC gc;
+  cairo_surface_t *surface;
+  gboolean pending;
+} GdkX11ShmImage;
+
+static void
+gdk_x11_shm_image_free (GdkDisplay     *display,
+                        GdkX11ShmImage *shm)
+{
+  Display *xdisplay = gdk_x11_display_get_xdisplay (display);
+
+  cairo_surface_destroy (shm->surface);
+  XFreeGC (xdisplay, shm->gc);
+  XShmDetach (xdisplay, &shm->info);
+  shmdt (shm->info.shmaddr);
+  /* XDestroyImage() would free() the shared memory otherwise */
+  shm->image->data = NULL;
+  XDestroyImage (shm->image);
+  g_free (shm);
+}
+
+static GdkX11ShmImage *
+gdk_x11_shm_image_new (GdkSurface *surface,
+                       int         width,
+                       int         height)
+{
+  GdkDisplay *display = gdk_surface_get_display (surface);
+  Display *xdisplay = gdk_x11_display_get_xdisplay (display);
+  Visual *visual;
+  GdkX11ShmImage *shm;
+  int depth;
+
+  if (!XShmQueryExtension (xdisplay))
+    return NULL;
+
+  /* Only use formats that cairo can render to directly */
+  visual = gdk_x11_display_get_window_visual (GDK_X11_DISPLAY (display));
+  depth = gdk_x11_display_get_window_depth (GDK_X11_DISPLAY (display));
+  if (visual->class != TrueColor ||
+      (depth != 24 && depth != 32) ||
+      visual->red_mask != 0xff0000 ||
+      visual->green_mask != 0xff00 ||
+      visual->blue_mask != 0xff ||
+      ImageByteOrder (xdisplay) != (G_BYTE_ORDER == G_LITTLE_ENDIAN ? LSBFirst : MSBFirst))
+    return NULL;
+
+  shm = g_new0 (GdkX11ShmImage, 1);
+
+  shm->image = XShmCreateImage (xdisplay, visual, depth, ZPixmap, NULL,
+                                &shm->info, width, height);
+  if (shm->image == NULL)
+    {
+      g_free (shm);
+      return NULL;
+    }
+
+  if (shm->image->bits_per_pixel != 32)
+    goto fail_image;
+
+  shm->info.shmid = shmget (IPC_PRIVATE, shm->image->bytes_per_line * shm->image->height,
+                            IPC_CREAT | 0600);
+  if (shm->info.shmid < 0)
+    goto fail_image;
+
+  shm->info.shmaddr = shm->image->data = shmat (shm->info.shmid, NULL, 0);
+  if (shm->info.shmaddr == (char *) -1)
+    goto fail_segment;
+
+  shm->info.readOnly = False;
+
+  /* This fails for remote displays */
+  gdk_x11_display_error_trap_push (display);
+  XShmAttach (xdisplay, &shm->info);
+  XSync (xdisplay, False);
+  if (gdk_x11_display_error_trap_pop (display))
+    {
+      shmdt (shm->info.shmaddr);
+      goto fail_segment;
+    }
+
+  /* The segment goes away once both sides have detached */
+  shmctl (shm->info.shmid, IPC_RMID, NULL);
+
+  shm->gc = XCreateGC (xdisplay, GDK_SURFACE_XID (surface), 0, NULL);
+  shm->surface = cairo_image_surface_create_for_data ((guchar *) shm->image->data,
+                                                      depth == 32 ? CAIRO_FORMAT_ARGB32
+                                                                  : CAIRO_FORMAT_RGB24,
+                                                      width, height,
+                                                      shm->image->bytes_per_line);
+
+  return shm;
+
+fail_segment:
+  shmctl (shm->info.shmid, IPC_RMID, NULL);
+fail_image:
+  shm->image->data = NULL;
+  XDestroyImage (shm->image);
+  g_free (shm);
+  return NULL;
+}
+
+static gboolean
+gdk_x11_cairo_context_begin_shm_frame (GdkX11CairoContext *self,
+                                       GdkSurface         *surface,
+                                       cairo_region_t     *region)
+{
+  GdkDisplay *display = gdk_surface_get_display (surface);
+  GdkX11ShmImage *shm = self->shm_image;
+  int scale, width, height;
+  cairo_t *cr;
+
+  scale = gdk_surface_get_scale_factor (surface);
+  width = MAX (gdk_surface_get_width (surface) * scale, 1);
+  height = MAX (gdk_surface_get_height (surface) * scale, 1);
+
+  if (shm != NULL &&
+      (cairo_image_surface_get_width (shm->surface) != width ||
+       cairo_image_surface_get_height (shm->surface) != height))
+    {
+      gdk_x11_shm_image_free (display, shm);
+      self->shm_image = shm = NULL;
+    }
+
+  if (shm == NULL)
+    {
+      if (self->shm_failed)
+        return FALSE;
+
+      shm = gdk_x11_shm_image_new (surface, width, height);
+      if (shm == NULL)
+        {
+          self->shm_failed = TRUE;
+          return FALSE;
+        }
+      self->shm_image = shm;
+    }
+
+  /* Don't touch the pixels while the server may still be reading them */
+  if (shm->pending)
+    {
+      XSync (gdk_x11_display_get_xdisplay (display), False);
+      shm->pending = FALSE;
+    }
+
+  self->paint_surface = cairo_surface_reference (shm->surface);
+  cairo_surface_set_device_scale (self->paint_surface, scale, scale);
+
+  /* The image keeps the previous frame, but the region must start out clear */
+  cr = cairo_create (self->paint_surface);
+  gdk_cairo_region (cr, region);
+  cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+  cairo_fill (cr);
+  cairo_destroy (cr);
+
+  return TRUE;
+}
+
+static void
+gdk_x11_cairo_context_end_shm_frame (GdkX11CairoContext *self,
+                                     GdkSurface         *surface,
+                                     cairo_region_t     *painted)
+{
+  Display *xdisplay = gdk_x11_display_get_xdisplay (gdk_surface_get_display (surface));
+  GdkX11ShmImage *shm = self->shm_image;
+  int i, n, scale;
+
+  cairo_surface_flush (shm->surface);
+
+  scale = gdk_surface_get_scale_factor (surface);
+  n = cairo_region_num_rectangles (painted);
+  for (i = 0; i < n; i++)
+    {
+      cairo_rectangle_int_t rect;
+      int x0, y0, x1, y1;
+
+      cairo_region_get_rectangle (painted, i, &rect);
+      x0 = MAX (rect.x * scale, 0);
+      y0 = MAX (rect.y * scale, 0);
+      x1 = MIN ((rect.x + rect.width) * scale, shm->image->width);
+      y1 = MIN ((rect.y + rect.height) * scale, shm->image->height);
+      if (x1 <= x0 || y1 <= y0)
+        continue;
+
+      XShmPutImage (xdisplay, GDK_SURFACE_XID (surface), shm->gc, shm->image,
+                    x0, y0, x0, y0, x1 - x0, y1 - y0, False);
+      shm->pending = TRUE;
+    }
+}
+
+#endif /* HAVE_XSHM */
+
 static cairo_surface_t *
 create_cairo_surface_for_surface (GdkSurface *surface)
 {
@@ -64,6 +271,12 @@ gdk_x11_cairo_context_begin_frame (GdkDrawContext *draw_context,
   double sx, sy;
 
   surface = gdk_draw_context_get_surface (draw_context);
+
+#ifdef HAVE_XSHM
+  if (gdk_x11_cairo_context_begin_shm_frame (self, surface, region))
+    return;
+#endif
+
   cairo_region_get_extents (region, &clip_box);
 
   self->window_surface = create_cairo_surface_for_surface (surface);
@@ -87,6 +300,17 @@ gdk_x11_cairo_context_end_frame (GdkDrawContext *draw_context,
   GdkX11CairoContext *self = GDK_X11_CAIRO_CONTEXT (draw_context);
   cairo_t *cr;
 
+#ifdef HAVE_XSHM
+  if (self->window_surface == NULL)
+    {
+      gdk_x11_cairo_context_end_shm_frame (self,
+                                           gdk_draw_context_get_surface (draw_context),
+                                           painted);
+      g_clear_pointer (&self->paint_surface, cairo_surface_destroy);
+      return;
+    }
+#endif
+
   cr = cairo_create (self->window_surface);
 
   cairo_set_source_surface (cr, self->paint_surface, 0, 0);
@@ -112,12 +336,32 @@ gdk_x11_cairo_context_cairo_create (GdkCairoContext *context)
   return cairo_create (self->paint_surface);
 }
 
+static void
+gdk_x11_cairo_context_dispose (GObject *object)
+{
+#ifdef HAVE_XSHM
+  GdkX11CairoContext *self = GDK_X11_CAIRO_CONTEXT (object);
+
+  if (self->shm_image)
+    {
+      gdk_x11_shm_image_free (gdk_draw_context_get_display (GDK_DRAW_CONTEXT (self)),
+                              self->shm_image);
+      self->shm_image = NULL;
+    }
+#endif
+
+  G_OBJECT_CLASS (gdk_x11_cairo_context_parent_class)->dispose (object);
+}
+
 static void
 gdk_x11_cairo_context_class_init (GdkX11CairoContextClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
   GdkDrawContextClass *draw_context_class = GDK_DRAW_CONTEXT_CLASS (klass);
   GdkCairoContextClass *cairo_context_class = GDK_CAIRO_CONTEXT_CLASS (klass);
 
+  object_class->dispose = gdk_x11_cairo_context_dispose;
+
   draw_context_class->begin_frame = gdk_x11_cairo_context_begin_frame;
   draw_context_class->end_frame = gdk_x11_cairo_context_end_frame;
 
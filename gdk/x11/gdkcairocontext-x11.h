@@ -42,6 +42,9 @@ struct _GdkX11CairoContext
 
   cairo_surface_t *window_surface;
   cairo_surface_t *paint_surface;
+
+  gpointer shm_image;
+  gboolean shm_failed;
 };
 
 struct _GdkX11CairoContextClass
@@ -47,23 +47,168 @@ gsk_gl_buffer_init (GskGLBuffer *self,
   self->element_size = element_size;
 }
 
+/**
+ * gsk_gl_buffer_set_persistent:
+ * @persistent: whether to use a persistently mapped buffer
+ *
+ * Requests that data is streamed through a persistently mapped buffer
+ * (GL_ARB_buffer_storage) instead of orphaning the buffer on every
+ * submit. This avoids the driver-side copy and allocation that
+ * glBufferData() implies.
+ *
+ * This requires both buffer storage and sync objects and must be called
+ * before the first submit.
+ */
+void
+gsk_gl_buffer_set_persistent (GskGLBuffer *self,
+                              gboolean     persistent)
+{
+  g_assert (self->id == 0);
+
+  self->persistent = !!persistent;
+}
+
+static void
+gsk_gl_buffer_clear_fences (GskGLBuffer *buffer)
+{
+  for (guint i = 0; i < G_N_ELEMENTS (buffer->fences); i++)
+    {
+      if (buffer->fences[i] != NULL)
+        {
+          glDeleteSync (buffer->fences[i]);
+          buffer->fences[i] = NULL;
+        }
+    }
+}
+
+static void
+gsk_gl_buffer_clear_storage (GskGLBuffer *buffer)
+{
+  gsk_gl_buffer_clear_fences (buffer);
+
+  if (buffer->id != 0)
+    {
+      if (buffer->mapped != NULL)
+        {
+          glBindBuffer (buffer->target, buffer->id);
+          glUnmapBuffer (buffer->target);
+          buffer->mapped = NULL;
+        }
+
+      glDeleteBuffers (1, &buffer->id);
+      buffer->id = 0;
+    }
+}
+
+static gboolean
+gsk_gl_buffer_create_storage (GskGLBuffer *buffer,
+                              gsize        slice_len)
+{
+  const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+  gsk_gl_buffer_clear_storage (buffer);
+
+  glGenBuffers (1, &buffer->id);
+  glBindBuffer (buffer->target, buffer->id);
+  glBufferStorage (buffer->target, slice_len * GSK_GL_BUFFER_N_SLICES, NULL, flags);
+  buffer->mapped = glMapBufferRange (buffer->target, 0, slice_len * GSK_GL_BUFFER_N_SLICES, flags);
+  if (buffer->mapped == NULL)
+    {
+      glDeleteBuffers (1, &buffer->id);
+      buffer->id = 0;
+      return FALSE;
+    }
+
+  buffer->slice_len = slice_len;
+  buffer->slice = 0;
+
+  return TRUE;
+}
+
+/**
+ * gsk_gl_buffer_submit:
+ * @offset: (out): return location for the byte offset of the data
+ *
+ * Uploads the data collected since the last submit and binds the
+ * buffer that contains it. The data starts at @offset within the
+ * buffer.
+ *
+ * The buffer remains owned by @buffer. Call gsk_gl_buffer_fence()
+ * after the last command using the data has been issued.
+ *
+ * Returns: the id of the GL buffer containing the data
+ */
 GLuint
-gsk_gl_buffer_submit (GskGLBuffer *buffer)
+gsk_gl_buffer_submit (GskGLBuffer *buffer,
+                      gsize       *offset)
 {
-  GLuint id;
+  if (buffer->persistent)
+    {
+      if (buffer->id == 0 || buffer->buffer_pos > buffer->slice_len)
+        {
+          if (!gsk_gl_buffer_create_storage (buffer, MAX (buffer->buffer_len, buffer->buffer_pos)))
+            buffer->persistent = FALSE;
+        }
+      else
+        {
+          buffer->slice = (buffer->slice + 1) % GSK_GL_BUFFER_N_SLICES;
+          glBindBuffer (buffer->target, buffer->id);
+        }
+    }
+
+  if (buffer->persistent)
+    {
+      /* Wait until the GPU is done with the frame that last used this slice */
+      if (buffer->fences[buffer->slice] != NULL)
+        {
+          glClientWaitSync (buffer->fences[buffer->slice], GL_SYNC_FLUSH_COMMANDS_BIT, G_MAXINT64);
+          glDeleteSync (buffer->fences[buffer->slice]);
+          buffer->fences[buffer->slice] = NULL;
+        }
+
+      *offset = buffer->slice * buffer->slice_len;
+      memcpy (buffer->mapped + *offset, buffer->buffer, buffer->buffer_pos);
+    }
+  else
+    {
+      if (buffer->id == 0)
+        glGenBuffers (1, &buffer->id);
 
-  glGenBuffers (1, &id);
-  glBindBuffer (buffer->target, id);
-  glBufferData (buffer->target, buffer->buffer_pos, buffer->buffer, GL_STATIC_DRAW);
+      /* Orphan the previous storage so we don't stall on pending draws */
+      glBindBuffer (buffer->target, buffer->id);
+      glBufferData (buffer->target, buffer->buffer_pos, NULL, GL_STREAM_DRAW);
+      glBufferSubData (buffer->target, 0, buffer->buffer_pos, buffer->buffer);
+
+      *offset = 0;
+    }
 
   buffer->buffer_pos = 0;
   buffer->count = 0;
 
-  return id;
+  return buffer->id;
+}
+
+/**
+ * gsk_gl_buffer_fence:
+ *
+ * Marks the end of the commands using the data of the last submit,
+ * so that its slice of a persistently mapped buffer is not
+ * overwritten before the GPU is done with it.
+ */
+void
+gsk_gl_buffer_fence (GskGLBuffer *buffer)
+{
+  if (!buffer->persistent)
+    return;
+
+  g_assert (buffer->fences[buffer->slice] == NULL);
+
+  buffer->fences[buffer->slice] = glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 }
 
 void
 gsk_gl_buffer_destroy (GskGLBuffer *buffer)
 {
+  gsk_gl_buffer_clear_storage (buffer);
   g_clear_pointer (&buffer->buffer, g_free);
 }
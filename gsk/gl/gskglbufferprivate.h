@@ -24,6 +24,8 @@
 
 G_BEGIN_DECLS
 
+#define GSK_GL_BUFFER_N_SLICES 3
+
 typedef struct _GskGLBuffer
 {
   guint8 *buffer;
@@ -32,13 +34,28 @@ typedef struct _GskGLBuffer
   guint   count;
   GLenum  target;
   gsize   element_size;
+
+  /* The GL buffer we stream into. With persistent mapping, it is split
+   * into GSK_GL_BUFFER_N_SLICES slices that are reused in turn, each
+   * guarded by a fence. Otherwise it is orphaned on every submit.
+   */
+  GLuint  id;
+  guint8 *mapped;
+  gsize   slice_len;
+  guint   slice;
+  GLsync  fences[GSK_GL_BUFFER_N_SLICES];
+  guint   persistent : 1;
 } GskGLBuffer;
 
-void   gsk_gl_buffer_init    (GskGLBuffer *self,
-                              GLenum       target,
-                              guint        element_size);
-void   gsk_gl_buffer_destroy (GskGLBuffer *buffer);
-GLuint gsk_gl_buffer_submit  (GskGLBuffer *buffer);
+void   gsk_gl_buffer_init                 (GskGLBuffer  *self,
+                                           GLenum        target,
+                                           guint         element_size);
+void   gsk_gl_buffer_set_persistent       (GskGLBuffer  *self,
+                                           gboolean      persistent);
+void   gsk_gl_buffer_destroy              (GskGLBuffer  *buffer);
+GLuint gsk_gl_buffer_submit               (GskGLBuffer  *buffer,
+                                           gsize        *offset);
+void   gsk_gl_buffer_fence                (GskGLBuffer  *buffer);
 
 static inline gpointer
 gsk_gl_buffer_advance (GskGLBuffer *buffer,
@@ -31,6 +31,7 @@
 #include <gdk/gdktexturedownloaderprivate.h>
 #include <gsk/gskdebugprivate.h>
 #include <gsk/gskroundedrectprivate.h>
+#include <gsk/gsktransformprivate.h>
 
 #include "gskglattachmentstateprivate.h"
 #include "gskglbufferprivate.h"
@@ -433,6 +434,7 @@ gsk_gl_command_queue_dispose (GObject *object)
   gsk_gl_command_binds_clear (&self->batch_binds);
   gsk_gl_command_uniforms_clear (&self->batch_uniforms);
   gsk_gl_syncs_clear (&self->syncs);
+  gsk_gl_command_bounds_clear (&self->batch_bounds);
 
   gsk_gl_buffer_destroy (&self->vertices);
 
@@ -456,6 +458,7 @@ gsk_gl_command_queue_init (GskGLCommandQueue *self)
   gsk_gl_command_binds_init (&self->batch_binds, 1024);
   gsk_gl_command_uniforms_init (&self->batch_uniforms, 2048);
   gsk_gl_syncs_init (&self->syncs, 10);
+  gsk_gl_command_bounds_init (&self->batch_bounds, 128);
 
   gsk_gl_buffer_init (&self->vertices, GL_ARRAY_BUFFER, sizeof (GskGLDrawVertex));
 }
@@ -503,6 +506,10 @@ gsk_gl_command_queue_new (GdkGLContext      *context,
   self->has_samplers = gdk_gl_context_check_version (context, "3.3", "3.0");
   self->can_swizzle = gdk_gl_context_check_version (context, "3.0", "3.0");
 
+  gsk_gl_buffer_set_persistent (&self->vertices,
+                                gdk_gl_context_has_feature (context, GDK_GL_FEATURE_BUFFER_STORAGE) &&
+                                gdk_gl_context_has_feature (context, GDK_GL_FEATURE_SYNC));
+
   /* create the samplers */
   if (self->has_samplers)
     {
@@ -543,6 +550,10 @@ begin_next_batch (GskGLCommandQueue *self)
   batch->any.next_batch_index = -1;
   batch->any.prev_batch_index = self->tail_batch_index;
 
+  /* Unknown bounds, which never allow reordering */
+  *gsk_gl_command_bounds_append (&self->batch_bounds) = GRAPHENE_RECT_INIT (-G_MAXFLOAT / 4, -G_MAXFLOAT / 4,
+                                                                            G_MAXFLOAT / 2, G_MAXFLOAT / 2);
+
   return batch;
 }
 
@@ -583,6 +594,7 @@ discard_batch (GskGLCommandQueue *self)
   g_assert (self->batches.len > 0);
 
   self->batches.len--;
+  self->batch_bounds.len--;
 }
 
 gboolean
@@ -624,10 +636,59 @@ gsk_gl_command_queue_begin_draw (GskGLCommandQueue   *self,
   self->fbo_max = MAX (self->fbo_max, batch->draw.framebuffer);
 
   self->in_draw = TRUE;
+  self->has_draw_modelview = FALSE;
 
   return TRUE;
 }
 
+/**
+ * gsk_gl_command_queue_set_draw_modelview:
+ * @self: a `GskGLCommandQueue`
+ * @modelview: the modelview that the vertices of the draw are in
+ *
+ * Sets the modelview of the current draw, so the bounds of the draw
+ * in its framebuffer can be computed. Only draws with known bounds
+ * are considered for reordering.
+ */
+void
+gsk_gl_command_queue_set_draw_modelview (GskGLCommandQueue       *self,
+                                         const graphene_matrix_t *modelview)
+{
+  g_assert (GSK_IS_GL_COMMAND_QUEUE (self));
+  g_assert (self->in_draw == TRUE);
+
+  self->draw_modelview = *modelview;
+  self->has_draw_modelview = TRUE;
+}
+
+static void
+compute_draw_bounds (GskGLCommandQueue *self,
+                     GskGLCommandBatch *batch,
+                     graphene_rect_t   *bounds)
+{
+  const GskGLDrawVertex *vertices;
+  float min_x, min_y, max_x, max_y;
+
+  if (!self->has_draw_modelview)
+    return;
+
+  vertices = (const GskGLDrawVertex *) self->vertices.buffer + batch->draw.vbo_offset;
+  min_x = max_x = vertices[0].position[0];
+  min_y = max_y = vertices[0].position[1];
+
+  for (guint i = 1; i < batch->draw.vbo_count; i++)
+    {
+      min_x = MIN (min_x, vertices[i].position[0]);
+      min_y = MIN (min_y, vertices[i].position[1]);
+      max_x = MAX (max_x, vertices[i].position[0]);
+      max_y = MAX (max_y, vertices[i].position[1]);
+    }
+
+  gsk_matrix_transform_bounds (&self->draw_modelview,
+                               &GRAPHENE_RECT_INIT (min_x, min_y, max_x - min_x, max_y - min_y),
+                               bounds);
+}
+
 void
 gsk_gl_command_queue_end_draw (GskGLCommandQueue *self)
 {
@@ -655,6 +716,8 @@ gsk_gl_command_queue_end_draw (GskGLCommandQueue *self)
       return;
     }
 
+  compute_draw_bounds (self, batch, gsk_gl_command_bounds_tail (&self->batch_bounds));
+
   /* Track the destination framebuffer in case it changed */
   batch->draw.framebuffer = self->attachments->fbo.id;
   self->attachments->fbo.changed = FALSE;
@@ -695,6 +758,9 @@ gsk_gl_command_queue_end_draw (GskGLCommandQueue *self)
       last_batch->draw.vbo_count + batch->draw.vbo_count <= 0xffff &&
       snapshots_equal (self, last_batch, batch))
     {
+      graphene_rect_union (&self->batch_bounds.items[self->batch_bounds.len - 2],
+                           gsk_gl_command_bounds_tail (&self->batch_bounds),
+                           &self->batch_bounds.items[self->batch_bounds.len - 2]);
       last_batch->draw.vbo_count += batch->draw.vbo_count;
       discard_batch (self);
     }
@@ -726,6 +792,7 @@ gsk_gl_command_queue_split_draw (GskGLCommandQueue *self)
 {
   GskGLCommandBatch *batch;
   GskGLUniformProgram *program;
+  gboolean has_draw_modelview;
   guint width;
   guint height;
 
@@ -746,8 +813,11 @@ gsk_gl_command_queue_split_draw (GskGLCommandQueue *self)
   width = batch->any.viewport.width;
   height = batch->any.viewport.height;
 
+  has_draw_modelview = self->has_draw_modelview;
+
   gsk_gl_command_queue_end_draw (self);
-  gsk_gl_command_queue_begin_draw (self, program, width, height);
+  if (gsk_gl_command_queue_begin_draw (self, program, width, height))
+    self->has_draw_modelview = has_draw_modelview;
 }
 
 void
@@ -1007,6 +1077,129 @@ gsk_gl_command_queue_sort_batches (GskGLCommandQueue *self)
   g_free (seen_free);
 }
 
+static inline gboolean
+batches_share_state (GskGLCommandQueue       *self,
+                     const GskGLCommandBatch *first,
+                     const GskGLCommandBatch *second)
+{
+  if (first->any.program != second->any.program ||
+      first->any.viewport.width != second->any.viewport.width ||
+      first->any.viewport.height != second->any.viewport.height ||
+      first->draw.blend != second->draw.blend ||
+      first->draw.framebuffer != second->draw.framebuffer ||
+      first->draw.bind_count != second->draw.bind_count)
+    return FALSE;
+
+  for (guint i = 0; i < first->draw.bind_count; i++)
+    {
+      const GskGLCommandBind *fb = &self->batch_binds.items[first->draw.bind_offset+i];
+      const GskGLCommandBind *sb = &self->batch_binds.items[second->draw.bind_offset+i];
+
+      if (fb->id != sb->id || fb->texture != sb->texture || fb->sampler != sb->sampler)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static inline gboolean
+bounds_overlap (const graphene_rect_t *a,
+                const graphene_rect_t *b)
+{
+  /* Touching draws count as overlapping, to be safe with antialiasing */
+  return a->origin.x <= b->origin.x + b->size.width &&
+         b->origin.x <= a->origin.x + a->size.width &&
+         a->origin.y <= b->origin.y + b->size.height &&
+         b->origin.y <= a->origin.y + a->size.height;
+}
+
+/* How many batches we look ahead for draws that can be moved */
+#define MAX_REORDER_DISTANCE 32
+
+/*
+ * After sorting by framebuffer, interleaved draws (think text, icons and
+ * backgrounds of list rows) still switch programs and textures for every
+ * batch. Look ahead a bounded number of batches and move draws sharing
+ * the program and textures of the current one next to it, as long as the
+ * draws they jump over don't overlap them.
+ *
+ * Returns: the number of batches that were moved
+ */
+static guint
+gsk_gl_command_queue_reorder_batches (GskGLCommandQueue *self)
+{
+  guint n_reordered = 0;
+  int index;
+
+  index = self->head_batch_index;
+
+  while (index >= 0)
+    {
+      const GskGLCommandBatch *batch = &self->batches.items[index];
+      graphene_rect_t skipped;
+      gboolean have_skipped = FALSE;
+      int group_tail = index;
+      int cur_index;
+      guint distance;
+
+      if (batch->any.kind != GSK_GL_COMMAND_KIND_DRAW)
+        {
+          index = batch->any.next_batch_index;
+          continue;
+        }
+
+      cur_index = batch->any.next_batch_index;
+
+      for (distance = 0; cur_index >= 0 && distance < MAX_REORDER_DISTANCE; distance++)
+        {
+          GskGLCommandBatch *cur = &self->batches.items[cur_index];
+          const graphene_rect_t *bounds = &self->batch_bounds.items[cur_index];
+          int next_index = cur->any.next_batch_index;
+
+          /* We don't move draws across clears or framebuffer changes */
+          if (cur->any.kind != GSK_GL_COMMAND_KIND_DRAW ||
+              cur->draw.framebuffer != batch->draw.framebuffer)
+            break;
+
+          if (batches_share_state (self, batch, cur))
+            {
+              if (cur->any.prev_batch_index == group_tail)
+                {
+                  group_tail = cur_index;
+                  cur_index = next_index;
+                  continue;
+                }
+
+              if (!have_skipped || !bounds_overlap (&skipped, bounds))
+                {
+                  GskGLCommandBatch *sibling;
+
+                  gsk_gl_command_queue_unlink (self, cur);
+                  sibling = &self->batches.items[self->batches.items[group_tail].any.next_batch_index];
+                  gsk_gl_command_queue_insert_before (self, cur, sibling);
+
+                  group_tail = cur_index;
+                  cur_index = next_index;
+                  n_reordered++;
+                  continue;
+                }
+            }
+
+          if (have_skipped)
+            graphene_rect_union (&skipped, bounds, &skipped);
+          else
+            skipped = *bounds;
+          have_skipped = TRUE;
+
+          cur_index = next_index;
+        }
+
+      index = self->batches.items[group_tail].any.next_batch_index;
+    }
+
+  return n_reordered;
+}
+
 /**
  * gsk_gl_command_queue_execute:
  * @self: a `GskGLCommandQueue`
@@ -1042,8 +1235,9 @@ gsk_gl_command_queue_execute (GskGLCommandQueue    *self,
   G_GNUC_UNUSED unsigned int n_fbos = 0;
   G_GNUC_UNUSED unsigned int n_uniforms = 0;
   G_GNUC_UNUSED unsigned int n_programs = 0;
+  G_GNUC_UNUSED unsigned int n_reordered;
   guint vao_id;
-  guint vbo_id;
+  gsize vbo_offset;
   int textures[GSK_GL_MAX_TEXTURES_PER_PROGRAM];
   int samplers[GSK_GL_MAX_TEXTURES_PER_PROGRAM];
   int framebuffer = -1;
@@ -1062,6 +1256,7 @@ gsk_gl_command_queue_execute (GskGLCommandQueue    *self,
     samplers[i] = -1;
 
   gsk_gl_command_queue_sort_batches (self);
+  n_reordered = gsk_gl_command_queue_reorder_batches (self);
 
   gsk_gl_command_queue_make_current (self);
 
@@ -1081,31 +1276,31 @@ gsk_gl_command_queue_execute (GskGLCommandQueue    *self,
       glBindVertexArray (vao_id);
     }
 
-  vbo_id = gsk_gl_buffer_submit (&self->vertices);
+  gsk_gl_buffer_submit (&self->vertices, &vbo_offset);
 
   /* 0 = position location */
   glEnableVertexAttribArray (0);
   glVertexAttribPointer (0, 2, GL_FLOAT, GL_FALSE,
                          sizeof (GskGLDrawVertex),
-                         (void *) G_STRUCT_OFFSET (GskGLDrawVertex, position));
+                         (void *) (vbo_offset + G_STRUCT_OFFSET (GskGLDrawVertex, position)));
 
   /* 1 = texture coord location */
   glEnableVertexAttribArray (1);
   glVertexAttribPointer (1, 2, GL_FLOAT, GL_FALSE,
                          sizeof (GskGLDrawVertex),
-                         (void *) G_STRUCT_OFFSET (GskGLDrawVertex, uv));
+                         (void *) (vbo_offset + G_STRUCT_OFFSET (GskGLDrawVertex, uv)));
 
   /* 2 = color location */
   glEnableVertexAttribArray (2);
   glVertexAttribPointer (2, 4, GL_HALF_FLOAT, GL_FALSE,
                          sizeof (GskGLDrawVertex),
-                         (void *) G_STRUCT_OFFSET (GskGLDrawVertex, color));
+                         (void *) (vbo_offset + G_STRUCT_OFFSET (GskGLDrawVertex, color)));
 
   /* 3 = color2 location */
   glEnableVertexAttribArray (3);
   glVertexAttribPointer (3, 4, GL_HALF_FLOAT, GL_FALSE,
                          sizeof (GskGLDrawVertex),
-                         (void *) G_STRUCT_OFFSET (GskGLDrawVertex, color2));
+                         (void *) (vbo_offset + G_STRUCT_OFFSET (GskGLDrawVertex, color2)));
 
   /* Setup initial scissor clip */
   if (scissor != NULL && cairo_region_num_rectangles (scissor) > 0)
@@ -1285,7 +1480,7 @@ gsk_gl_command_queue_execute (GskGLCommandQueue    *self,
       next_batch_index = batch->any.next_batch_index;
     }
 
-  glDeleteBuffers (1, &vbo_id);
+  gsk_gl_buffer_fence (&self->vertices);
   if (gdk_gl_context_has_vertex_arrays (self->context))
     glDeleteVertexArrays (1, &vao_id);
 
@@ -1293,6 +1488,7 @@ gsk_gl_command_queue_execute (GskGLCommandQueue    *self,
   gdk_profiler_set_int_counter (self->metrics.n_uniforms, n_uniforms);
   gdk_profiler_set_int_counter (self->metrics.n_fbos, n_fbos);
   gdk_profiler_set_int_counter (self->metrics.n_programs, n_programs);
+  gdk_profiler_set_int_counter (self->metrics.n_reordered, n_reordered);
   gdk_profiler_set_int_counter (self->metrics.n_uploads, self->n_uploads);
   gdk_profiler_set_int_counter (self->metrics.queue_depth, self->batches.len);
 
@@ -1360,6 +1556,7 @@ gsk_gl_command_queue_end_frame (GskGLCommandQueue *self)
     }
 
   self->batches.len = 0;
+  self->batch_bounds.len = 0;
   self->batch_binds.len = 0;
   self->batch_uniforms.len = 0;
   self->syncs.len = 0;
@@ -1771,6 +1968,7 @@ gsk_gl_command_queue_set_profiler (GskGLCommandQueue *self,
       self->metrics.n_uniforms = gdk_profiler_define_int_counter ("uniforms", "Number of uniforms changed");
       self->metrics.n_uploads = gdk_profiler_define_int_counter ("uploads", "Number of texture uploads");
       self->metrics.n_programs = gdk_profiler_define_int_counter ("programs", "Number of program changes");
+      self->metrics.n_reordered = gdk_profiler_define_int_counter ("reordered-batches", "Number of batches moved next to similar batches");
       self->metrics.queue_depth = gdk_profiler_define_int_counter ("gl-queue-depth", "Depth of GL command batches");
     }
 }
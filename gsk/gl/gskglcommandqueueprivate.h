@@ -180,6 +180,7 @@ DEFINE_INLINE_ARRAY (GskGLCommandBatches, gsk_gl_command_batches, GskGLCommandBa
 DEFINE_INLINE_ARRAY (GskGLCommandBinds, gsk_gl_command_binds, GskGLCommandBind)
 DEFINE_INLINE_ARRAY (GskGLCommandUniforms, gsk_gl_command_uniforms, GskGLCommandUniform)
 DEFINE_INLINE_ARRAY (GskGLSyncs, gsk_gl_syncs, GskGLSync)
+DEFINE_INLINE_ARRAY (GskGLCommandBounds, gsk_gl_command_bounds, graphene_rect_t)
 
 struct _GskGLCommandQueue
 {
@@ -196,8 +197,9 @@ struct _GskGLCommandQueue
   GskGLCommandBatches batches;
 
   /* Contains array of vertices and some wrapper code to help upload them
-   * to the GL driver. We can also tweak this to use double buffered arrays
-   * if we find that to be faster on some hardware and/or drivers.
+   * to the GL driver. When buffer storage is available they are streamed
+   * through a triple buffered, persistently mapped buffer, otherwise the
+   * buffer is orphaned on every frame.
    */
   GskGLBuffer vertices;
 
@@ -247,6 +249,14 @@ struct _GskGLCommandQueue
    */
   GLuint samplers[GSK_GL_N_FILTERS * GSK_GL_N_FILTERS];
 
+  /* Array of framebuffer space bounds of every batch, indexed like
+   * @batches. We use these to reorder draws that don't overlap.
+   */
+  GskGLCommandBounds batch_bounds;
+
+  /* The modelview of the current draw, used to compute its bounds. */
+  graphene_matrix_t draw_modelview;
+
   /* Array of sync objects to wait on.
    */
   GskGLSyncs syncs;
@@ -277,6 +287,7 @@ struct _GskGLCommandQueue
     guint n_uniforms;
     guint n_uploads;
     guint n_programs;
+    guint n_reordered;
     guint queue_depth;
   } metrics;
 
@@ -297,6 +308,9 @@ struct _GskGLCommandQueue
 
   /* If we've warned about truncating batches */
   guint have_truncated : 1;
+
+  /* If @draw_modelview is set for the current draw */
+  guint has_draw_modelview : 1;
 };
 
 GskGLCommandQueue *gsk_gl_command_queue_new                   (GdkGLContext         *context,
@@ -350,6 +364,8 @@ gboolean            gsk_gl_command_queue_begin_draw           (GskGLCommandQueue
                                                                GskGLUniformProgram  *program_info,
                                                                guint                 width,
                                                                guint                 height);
+void                gsk_gl_command_queue_set_draw_modelview   (GskGLCommandQueue    *self,
+                                                               const graphene_matrix_t *modelview);
 void                gsk_gl_command_queue_end_draw             (GskGLCommandQueue    *self);
 void                gsk_gl_command_queue_split_draw           (GskGLCommandQueue    *self);
 
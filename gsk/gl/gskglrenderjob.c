@@ -1112,6 +1112,9 @@ gsk_gl_render_job_begin_draw (GskGLRenderJob *job,
                                         job->viewport.size.height))
     return FALSE;
 
+  gsk_gl_command_queue_set_draw_modelview (job->command_queue,
+                                           &job->current_modelview->matrix);
+
   gsk_gl_uniform_state_set4fv (program->uniforms,
                                program->program_info,
                                UNIFORM_SHARED_VIEWPORT,
@@ -6,20 +6,26 @@
 #include "gskgpushaderopprivate.h"
 #include "gskglbufferprivate.h"
 #include "gskglimageprivate.h"
+#include "gskglshaderprivate.h"
 
 #include "gdk/gdkdisplayprivate.h"
 #include "gdk/gdkglcontextprivate.h"
 #include "gdk/gdkprofilerprivate.h"
 
 #include <glib/gi18n-lib.h>
+#include <glib/gstdio.h>
+#include <errno.h>
+#include <string.h>
 
 struct _GskGLDevice
 {
   GskGpuDevice parent_instance;
 
   GHashTable *gl_programs;
+  GHashTable *gl_shaders; /* GskGLShaders with programs in gl_programs */
   const char *version_string;
   GdkGLAPI api;
+  char *program_cache_dir;
 
   guint sampler_ids[GSK_GPU_SAMPLER_N_SAMPLERS];
 };
@@ -34,6 +40,7 @@ typedef struct _GLProgramKey GLProgramKey;
 struct _GLProgramKey
 {
   const GskGpuShaderOpClass *op_class;
+  GskGLShader *gl_shader;
   guint32 variation;
   GskGpuShaderClip clip;
   guint n_external_textures;
@@ -47,6 +54,7 @@ gl_program_key_hash (gconstpointer data)
   const GLProgramKey *key = data;
 
   return GPOINTER_TO_UINT (key->op_class) ^
+         GPOINTER_TO_UINT (key->gl_shader) ^
          key->clip ^
          (key->variation << 2) ^
          (key->n_external_textures << 24);
@@ -60,6 +68,7 @@ gl_program_key_equal (gconstpointer a,
   const GLProgramKey *keyb = b;
 
   return keya->op_class == keyb->op_class &&
+         keya->gl_shader == keyb->gl_shader &&
          keya->variation == keyb->variation && 
          keya->clip == keyb->clip && 
          keya->n_external_textures == keyb->n_external_textures;
@@ -98,10 +107,11 @@ gsk_gl_device_create_upload_image (GskGpuDevice    *device,
 }
 
 static GskGpuImage *
-gsk_gl_device_create_download_image (GskGpuDevice   *device,
-                                     GdkMemoryDepth  depth,
-                                     gsize           width,
-                                     gsize           height)
+gsk_gl_device_create_download_image (GskGpuDevice     *device,
+                                     GdkMemoryDepth    depth,
+                                     GdkDmabufFormats *scanout_formats,
+                                     gsize             width,
+                                     gsize             height)
 {
   GskGLDevice *self = GSK_GL_DEVICE (device);
 
@@ -132,18 +142,29 @@ gsk_gl_device_make_current (GskGpuDevice *device)
   gdk_gl_context_make_current (gdk_display_get_gl_context (gsk_gpu_device_get_display (device)));
 }
 
+static void   gsk_gl_device_gl_shader_finalized       (gpointer  data,
+                                                       GObject  *where_the_object_was);
+
 static void
 gsk_gl_device_finalize (GObject *object)
 {
   GskGLDevice *self = GSK_GL_DEVICE (object);
   GskGpuDevice *device = GSK_GPU_DEVICE (self);
+  GHashTableIter iter;
+  gpointer shader;
 
   g_object_steal_data (G_OBJECT (gsk_gpu_device_get_display (device)), "-gsk-gl-device");
 
   gdk_gl_context_make_current (gdk_display_get_gl_context (gsk_gpu_device_get_display (device)));
 
+  g_hash_table_iter_init (&iter, self->gl_shaders);
+  while (g_hash_table_iter_next (&iter, &shader, NULL))
+    g_object_weak_unref (shader, gsk_gl_device_gl_shader_finalized, self);
+  g_hash_table_unref (self->gl_shaders);
+
   g_hash_table_unref (self->gl_programs);
   glDeleteSamplers (G_N_ELEMENTS (self->sampler_ids), self->sampler_ids);
+  g_free (self->program_cache_dir);
 
   G_OBJECT_CLASS (gsk_gl_device_parent_class)->finalize (object);
 }
@@ -173,6 +194,7 @@ static void
 gsk_gl_device_init (GskGLDevice *self)
 {
   self->gl_programs = g_hash_table_new_full (gl_program_key_hash, gl_program_key_equal, g_free, free_gl_program);
+  self->gl_shaders = g_hash_table_new (NULL, NULL);
 }
 
 static void
@@ -222,6 +244,42 @@ gsk_gl_device_setup_samplers (GskGLDevice *self)
     }
 }
 
+/* Linked programs are stored on disk with glProgramBinary(), so
+ * they don't need to be compiled again on the next start. Binaries
+ * are only valid for the driver that created them, so the driver
+ * is part of the directory name.
+ */
+static void
+gsk_gl_device_setup_program_cache (GskGLDevice  *self,
+                                   GdkGLContext *context)
+{
+  GChecksum *checksum;
+  GLint n_formats = 0;
+
+  if (!gdk_gl_context_check_version (context, "4.1", "3.0") &&
+      !epoxy_has_gl_extension ("GL_ARB_get_program_binary"))
+    return;
+
+  /* Some drivers support the API, but no formats */
+  glGetIntegerv (GL_NUM_PROGRAM_BINARY_FORMATS, &n_formats);
+  if (n_formats <= 0)
+    return;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  g_checksum_update (checksum, (const guchar *) glGetString (GL_VENDOR), -1);
+  g_checksum_update (checksum, (const guchar *) glGetString (GL_RENDERER), -1);
+  g_checksum_update (checksum, (const guchar *) glGetString (GL_VERSION), -1);
+  g_checksum_update (checksum, (const guchar *) GTK_VERSION, -1);
+
+  self->program_cache_dir = g_build_filename (g_get_user_cache_dir (),
+                                              "gtk-4.0",
+                                              "gl-program-cache",
+                                              g_checksum_get_string (checksum),
+                                              NULL);
+
+  g_checksum_free (checksum);
+}
+
 GskGpuDevice *
 gsk_gl_device_get_for_display (GdkDisplay  *display,
                                GError     **error)
@@ -257,6 +315,7 @@ gsk_gl_device_get_for_display (GdkDisplay  *display,
   self->version_string = gdk_gl_context_get_glsl_version_string (context);
   self->api = gdk_gl_context_get_api (context);
   gsk_gl_device_setup_samplers (self);
+  gsk_gl_device_setup_program_cache (self, context);
 
   g_object_set_data (G_OBJECT (display), "-gsk-gl-device", self);
 
@@ -372,6 +431,7 @@ gsk_gl_device_load_shader (GskGLDevice      *self,
                            guint32           variation,
                            GskGpuShaderClip  clip,
                            guint             n_external_textures,
+                           GBytes           *suffix,
                            GError          **error)
 {
   GString *preamble;
@@ -442,13 +502,19 @@ gsk_gl_device_load_shader (GskGLDevice      *self,
 
   shader_id = glCreateShader (shader_type);
 
+  /* The suffix is not nul-terminated, so pass its length */
   glShaderSource (shader_id,
-                  2,
+                  suffix ? 3 : 2,
                   (const char *[]) {
                     preamble->str,
                     g_bytes_get_data (bytes, NULL),
+                    suffix ? g_bytes_get_data (suffix, NULL) : NULL,
                   },
-                  NULL);
+                  (const GLint[]) {
+                    -1,
+                    -1,
+                    suffix ? g_bytes_get_size (suffix) : 0,
+                  });
 
   g_bytes_unref (bytes);
   g_string_free (preamble, TRUE);
@@ -466,25 +532,157 @@ gsk_gl_device_load_shader (GskGLDevice      *self,
   return shader_id;
 }
 
+static char *
+gsk_gl_device_get_program_cache_file (GskGLDevice               *self,
+                                      const GskGpuShaderOpClass *op_class,
+                                      guint32                    variation,
+                                      GskGpuShaderClip           clip,
+                                      guint                      n_external_textures,
+                                      GBytes                    *suffix)
+{
+  GChecksum *checksum;
+  char *resource_name, *key, *result;
+  GBytes *bytes;
+
+  if (self->program_cache_dir == NULL)
+    return NULL;
+
+  resource_name = g_strconcat ("/org/gtk/libgsk/shaders/gl/", op_class->shader_name, ".glsl", NULL);
+  bytes = g_resources_lookup_data (resource_name, 0, NULL);
+  g_free (resource_name);
+  if (bytes == NULL)
+    return NULL;
+
+  /* The shader source is part of the key, so changed shaders
+   * never pick up stale binaries */
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  g_checksum_update (checksum, g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes));
+  if (suffix)
+    g_checksum_update (checksum, g_bytes_get_data (suffix, NULL), g_bytes_get_size (suffix));
+  key = g_strdup_printf ("%s:%u:%u:%u:%u", op_class->shader_name, variation, clip, n_external_textures, self->api);
+  g_checksum_update (checksum, (const guchar *) key, -1);
+
+  result = g_build_filename (self->program_cache_dir, g_checksum_get_string (checksum), NULL);
+
+  g_checksum_free (checksum);
+  g_free (key);
+  g_bytes_unref (bytes);
+
+  return result;
+}
+
+static GLuint
+gsk_gl_device_load_cached_program (GskGLDevice *self,
+                                   const char  *filename)
+{
+  G_GNUC_UNUSED gint64 begin_time = GDK_PROFILER_CURRENT_TIME;
+  GLuint program_id;
+  GLint link_status;
+  guint32 format;
+  char *data;
+  gsize size;
+
+  if (!g_file_get_contents (filename, &data, &size, NULL))
+    return 0;
+
+  if (size <= sizeof (guint32))
+    {
+      g_free (data);
+      return 0;
+    }
+
+  /* The file is the binary format followed by the binary */
+  memcpy (&format, data, sizeof (guint32));
+
+  program_id = glCreateProgram ();
+  glProgramBinary (program_id, format, data + sizeof (guint32), size - sizeof (guint32));
+  g_free (data);
+
+  glGetProgramiv (program_id, GL_LINK_STATUS, &link_status);
+  if (link_status == GL_FALSE)
+    {
+      /* The driver changed its mind, compile it again */
+      GSK_DEBUG (SHADERS, "Discarding cached program %s", filename);
+      glDeleteProgram (program_id);
+      g_unlink (filename);
+      return 0;
+    }
+
+  gdk_profiler_end_markf (begin_time,
+                          "Load Program Binary",
+                          "id=%u", program_id);
+
+  return program_id;
+}
+
+static void
+gsk_gl_device_save_cached_program (GskGLDevice *self,
+                                   const char  *filename,
+                                   GLuint       program_id)
+{
+  GError *error = NULL;
+  GLint length = 0;
+  GLenum format;
+  guchar *data;
+
+  glGetProgramiv (program_id, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+    return;
+
+  data = g_malloc (sizeof (guint32) + length);
+  glGetProgramBinary (program_id, length, &length, &format, data + sizeof (guint32));
+  memcpy (data, &(guint32) { format }, sizeof (guint32));
+
+  if (g_mkdir_with_parents (self->program_cache_dir, 0755) != 0 ||
+      !g_file_set_contents (filename, (const char *) data, sizeof (guint32) + length, &error))
+    {
+      GSK_DEBUG (SHADERS, "Failed to save program to %s: %s",
+                 filename, error ? error->message : g_strerror (errno));
+      g_clear_error (&error);
+    }
+
+  g_free (data);
+}
+
 static GLuint
 gsk_gl_device_load_program (GskGLDevice               *self,
                             const GskGpuShaderOpClass *op_class,
                             guint32                    variation,
                             GskGpuShaderClip           clip,
                             guint                      n_external_textures,
+                            GBytes                    *suffix,
                             GError                   **error)
 {
   G_GNUC_UNUSED gint64 begin_time = GDK_PROFILER_CURRENT_TIME;
   GLuint vertex_shader_id, fragment_shader_id, program_id;
   GLint link_status;
+  char *cache_file;
+
+  cache_file = gsk_gl_device_get_program_cache_file (self, op_class, variation, clip, n_external_textures, suffix);
+  if (cache_file)
+    {
+      program_id = gsk_gl_device_load_cached_program (self, cache_file);
+      if (program_id)
+        {
+          g_free (cache_file);
+          return program_id;
+        }
+    }
 
-  vertex_shader_id = gsk_gl_device_load_shader (self, op_class->shader_name, GL_VERTEX_SHADER, variation, clip, n_external_textures, error);
+  vertex_shader_id = gsk_gl_device_load_shader (self, op_class->shader_name, GL_VERTEX_SHADER, variation, clip, n_external_textures, NULL, error);
   if (vertex_shader_id == 0)
-    return 0;
+    {
+      g_free (cache_file);
+      return 0;
+    }
 
-  fragment_shader_id = gsk_gl_device_load_shader (self, op_class->shader_name, GL_FRAGMENT_SHADER, variation, clip, n_external_textures, error);
+  fragment_shader_id = gsk_gl_device_load_shader (self, op_class->shader_name, GL_FRAGMENT_SHADER, variation, clip, n_external_textures, suffix, error);
   if (fragment_shader_id == 0)
-    return 0;
+    {
+      glDeleteShader (vertex_shader_id);
+      g_free (cache_file);
+      return 0;
+    }
 
   program_id = glCreateProgram ();
 
@@ -493,6 +691,9 @@ gsk_gl_device_load_program (GskGLDevice               *self,
 
   op_class->setup_attrib_locations (program_id);
 
+  if (cache_file)
+    glProgramParameteri (program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
   glLinkProgram (program_id);
 
   glGetProgramiv (program_id, GL_LINK_STATUS, &link_status);
@@ -525,10 +726,17 @@ gsk_gl_device_load_program (GskGLDevice               *self,
       g_free (buffer);
 
       glDeleteProgram (program_id);
+      g_free (cache_file);
 
       return 0;
     }
 
+  if (cache_file)
+    {
+      gsk_gl_device_save_cached_program (self, cache_file, program_id);
+      g_free (cache_file);
+    }
+
   gdk_profiler_end_markf (begin_time,
                           "Compile Program",
                           "name=%s id=%u frag=%u vert=%u",
@@ -537,6 +745,53 @@ gsk_gl_device_load_program (GskGLDevice               *self,
   return program_id;
 }
 
+static gboolean
+gsk_gl_device_lookup_program (GskGLDevice         *self,
+                              const GLProgramKey  *key,
+                              GBytes              *suffix,
+                              GLuint              *out_program_id,
+                              GError             **error)
+{
+  gpointer value;
+  GLuint program_id;
+  guint i, n_textures;
+
+  if (g_hash_table_lookup_extended (self->gl_programs, key, NULL, &value))
+    {
+      /* failed programs are stored as 0 */
+      *out_program_id = GPOINTER_TO_UINT (value);
+      return TRUE;
+    }
+
+  program_id = gsk_gl_device_load_program (self, key->op_class, key->variation, key->clip, key->n_external_textures, suffix, error);
+
+  g_hash_table_insert (self->gl_programs, g_memdup (key, sizeof (GLProgramKey)), GUINT_TO_POINTER (program_id));
+  *out_program_id = program_id;
+
+  if (program_id == 0)
+    return FALSE;
+
+  glUseProgram (program_id);
+
+  n_textures = 16 - 3 * key->n_external_textures;
+
+  for (i = 0; i < key->n_external_textures; i++)
+    {
+      char *name = g_strdup_printf ("external_textures[%u]", i);
+      glUniform1i (glGetUniformLocation (program_id, name), n_textures + 3 * i);
+      g_free (name);
+    }
+
+  for (i = 0; i < n_textures; i++)
+    {
+      char *name = g_strdup_printf ("textures[%u]", i);
+      glUniform1i (glGetUniformLocation (program_id, name), i);
+      g_free (name);
+    }
+
+  return TRUE;
+}
+
 void
 gsk_gl_device_use_program (GskGLDevice               *self,
                            const GskGpuShaderOpClass *op_class,
@@ -548,46 +803,92 @@ gsk_gl_device_use_program (GskGLDevice               *self,
   GLuint program_id;
   GLProgramKey key = {
     .op_class = op_class,
+    .gl_shader = NULL,
     .variation = variation,
     .clip = clip,
     .n_external_textures = n_external_textures
   };
-  guint i, n_textures;
 
-  program_id = GPOINTER_TO_UINT (g_hash_table_lookup (self->gl_programs, &key));
-  if (program_id)
-    {
-      glUseProgram (program_id);
-      return;
-    }
-
-  program_id = gsk_gl_device_load_program (self, op_class, variation, clip, n_external_textures, &error);
-  if (program_id == 0)
+  if (!gsk_gl_device_lookup_program (self, &key, NULL, &program_id, &error))
     {
       g_critical ("Failed to load shader program: %s", error->message);
       g_clear_error (&error);
       return;
     }
-  
-  g_hash_table_insert (self->gl_programs, g_memdup (&key, sizeof (GLProgramKey)), GUINT_TO_POINTER (program_id));
 
   glUseProgram (program_id);
+}
 
-  n_textures = 16 - 3 * n_external_textures;
+static gboolean
+remove_gl_shader_program (gpointer key,
+                          gpointer value,
+                          gpointer shader)
+{
+  return ((GLProgramKey *) key)->gl_shader == shader;
+}
 
-  for (i = 0; i < n_external_textures; i++)
+static void
+gsk_gl_device_gl_shader_finalized (gpointer  data,
+                                   GObject  *where_the_object_was)
+{
+  GskGLDevice *self = data;
+
+  gsk_gpu_device_make_current (GSK_GPU_DEVICE (self));
+
+  g_hash_table_foreach_remove (self->gl_programs, remove_gl_shader_program, where_the_object_was);
+  g_hash_table_remove (self->gl_shaders, where_the_object_was);
+}
+
+/*
+ * gsk_gl_device_use_gl_shader_program:
+ * @self: a `GskGLDevice`
+ * @op_class: the class of the op drawing @shader
+ * @shader: the `GskGLShader` to use
+ * @clip: the clip to compile for
+ * @n_external_textures: number of external textures in use
+ *
+ * Like gsk_gl_device_use_program(), but appends the source of @shader
+ * to the fragment shader of @op_class.
+ *
+ * Programs are cached until @shader is finalized. If @shader fails to
+ * compile, a warning is printed on first use and 0 is returned.
+ *
+ * Returns: the program id or 0 if @shader could not be compiled
+ */
+GLuint
+gsk_gl_device_use_gl_shader_program (GskGLDevice               *self,
+                                     const GskGpuShaderOpClass *op_class,
+                                     GskGLShader               *shader,
+                                     GskGpuShaderClip           clip,
+                                     guint                      n_external_textures)
+{
+  GError *error = NULL;
+  GLuint program_id;
+  GLProgramKey key = {
+    .op_class = op_class,
+    .gl_shader = shader,
+    .variation = 0,
+    .clip = clip,
+    .n_external_textures = n_external_textures
+  };
+
+  if (!g_hash_table_contains (self->gl_shaders, shader))
     {
-      char *name = g_strdup_printf ("external_textures[%u]", i);
-      glUniform1i (glGetUniformLocation (program_id, name), n_textures + 3 * i);
-      g_free (name);
+      g_object_weak_ref (G_OBJECT (shader), gsk_gl_device_gl_shader_finalized, self);
+      g_hash_table_add (self->gl_shaders, shader);
     }
 
-  for (i = 0; i < n_textures; i++)
+  if (!gsk_gl_device_lookup_program (self, &key, gsk_gl_shader_get_source (shader), &program_id, &error))
     {
-      char *name = g_strdup_printf ("textures[%u]", i);
-      glUniform1i (glGetUniformLocation (program_id, name), i);
-      g_free (name);
+      g_warning ("Failed to compile gl shader: %s", error->message);
+      g_clear_error (&error);
+      return 0;
     }
+
+  if (program_id)
+    glUseProgram (program_id);
+
+  return program_id;
 }
 
 GLuint
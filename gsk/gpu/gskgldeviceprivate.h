@@ -2,6 +2,8 @@
 
 #include "gskgpudeviceprivate.h"
 
+#include "gskglshader.h"
+
 G_BEGIN_DECLS
 
 #define GSK_TYPE_GL_DEVICE (gsk_gl_device_get_type ())
@@ -17,6 +19,12 @@ void                    gsk_gl_device_use_program                       (GskGLDe
                                                                          GskGpuShaderClip        clip,
                                                                          guint                   n_external_textures);
 
+GLuint                  gsk_gl_device_use_gl_shader_program             (GskGLDevice            *self,
+                                                                         const GskGpuShaderOpClass *op_class,
+                                                                         GskGLShader            *shader,
+                                                                         GskGpuShaderClip        clip,
+                                                                         guint                   n_external_textures);
+
 GLuint                  gsk_gl_device_get_sampler_id                    (GskGLDevice            *self,
                                                                          GskGpuSampler           sampler);
 
@@ -10,10 +10,13 @@
 #include "gskgldeviceprivate.h"
 #include "gskglimageprivate.h"
 
+#include "gdkcompressedtextureprivate.h"
 #include "gdkdmabuftextureprivate.h"
 #include "gdkglcontextprivate.h"
 #include "gdkgltextureprivate.h"
 
+#include <epoxy/gl.h>
+
 struct _GskGLFrame
 {
   GskGpuFrame parent_instance;
@@ -23,6 +26,10 @@ struct _GskGLFrame
   GLsync sync;
 
   GHashTable *vaos;
+
+  GLuint *timestamp_queries;
+  gsize n_timestamp_queries;
+  gsize n_used_timestamp_queries;
 };
 
 struct _GskGLFrameClass
@@ -73,6 +80,21 @@ gsk_gl_frame_cleanup (GskGpuFrame *frame)
       g_clear_pointer (&self->sync, glDeleteSync);
     }
 
+  if (self->n_used_timestamp_queries > 0)
+    {
+      guint64 *timestamps;
+      gsize i;
+
+      timestamps = g_new (guint64, self->n_used_timestamp_queries);
+      for (i = 0; i < self->n_used_timestamp_queries; i++)
+        glGetQueryObjectui64v (self->timestamp_queries[i], GL_QUERY_RESULT, &timestamps[i]);
+
+      gsk_gpu_frame_report_timings (frame, timestamps);
+
+      g_free (timestamps);
+      self->n_used_timestamp_queries = 0;
+    }
+
   self->next_texture_slot = 0;
 
   GSK_GPU_FRAME_CLASS (gsk_gl_frame_parent_class)->cleanup (frame);
@@ -126,6 +148,19 @@ gsk_gl_frame_upload_texture (GskGpuFrame  *frame,
                                                (external ? GSK_GPU_IMAGE_EXTERNAL | GSK_GPU_IMAGE_NO_BLIT : 0));
         }
     }
+  else if (GDK_IS_COMPRESSED_TEXTURE (texture))
+    {
+      if (gdk_gl_context_has_feature (GDK_GL_CONTEXT (gsk_gpu_frame_get_context (frame)),
+                                      GDK_GL_FEATURE_TEXTURE_COMPRESSION_S3TC))
+        {
+          GskGpuImage *image;
+
+          image = gsk_gl_image_new_for_compressed_texture (GSK_GL_DEVICE (gsk_gpu_frame_get_device (frame)),
+                                                           texture);
+          if (image)
+            return image;
+        }
+    }
 
   return GSK_GPU_FRAME_CLASS (gsk_gl_frame_parent_class)->upload_texture (frame, with_mipmap, texture);
 }
@@ -165,6 +200,29 @@ gsk_gl_frame_create_storage_buffer (GskGpuFrame *frame,
     return gsk_gl_copied_buffer_new (GL_UNIFORM_BUFFER, size);
 }
 
+static gboolean
+gsk_gl_frame_has_timer_query (GskGLFrame *self)
+{
+  return epoxy_is_desktop_gl () &&
+         (epoxy_gl_version () >= 33 || epoxy_has_gl_extension ("GL_ARB_timer_query"));
+}
+
+static void
+gsk_gl_frame_query_timestamp (GskGLFrame *self)
+{
+  if (self->n_used_timestamp_queries == self->n_timestamp_queries)
+    {
+      gsize new_size = MAX (64, 2 * self->n_timestamp_queries);
+
+      self->timestamp_queries = g_renew (GLuint, self->timestamp_queries, new_size);
+      glGenQueries (new_size - self->n_timestamp_queries, self->timestamp_queries + self->n_timestamp_queries);
+      self->n_timestamp_queries = new_size;
+    }
+
+  glQueryCounter (self->timestamp_queries[self->n_used_timestamp_queries], GL_TIMESTAMP);
+  self->n_used_timestamp_queries++;
+}
+
 static void
 gsk_gl_frame_submit (GskGpuFrame  *frame,
                      GskGpuBuffer *vertex_buffer,
@@ -172,6 +230,9 @@ gsk_gl_frame_submit (GskGpuFrame  *frame,
 {
   GskGLFrame *self = GSK_GL_FRAME (frame);
   GskGLCommandState state = { 0, };
+  gboolean timed;
+
+  timed = gsk_gpu_frame_should_time_ops (frame) && gsk_gl_frame_has_timer_query (self);
 
   glEnable (GL_SCISSOR_TEST);
 
@@ -189,9 +250,18 @@ gsk_gl_frame_submit (GskGpuFrame  *frame,
 
   while (op)
     {
+      if (timed)
+        {
+          gsk_gpu_frame_add_timed_op (frame, op);
+          gsk_gl_frame_query_timestamp (self);
+        }
+
       op = gsk_gpu_op_gl_command (op, frame, &state);
     }
 
+  if (timed)
+    gsk_gl_frame_query_timestamp (self);
+
   if (gdk_gl_context_has_feature (GDK_GL_CONTEXT (gsk_gpu_frame_get_context (frame)),
                                   GDK_GL_FEATURE_SYNC))
     self->sync = glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
@@ -204,6 +274,9 @@ gsk_gl_frame_finalize (GObject *object)
 
   g_hash_table_unref (self->vaos);
   glDeleteBuffers (1, &self->globals_buffer_id);
+  if (self->n_timestamp_queries > 0)
+    glDeleteQueries (self->n_timestamp_queries, self->timestamp_queries);
+  g_free (self->timestamp_queries);
 
   G_OBJECT_CLASS (gsk_gl_frame_parent_class)->finalize (object);
 }
@@ -239,21 +312,12 @@ gsk_gl_frame_init (GskGLFrame *self)
   self->vaos = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, free_vao);
 }
 
-void
-gsk_gl_frame_use_program (GskGLFrame                *self,
-                          const GskGpuShaderOpClass *op_class,
-                          guint32                    variation,
-                          GskGpuShaderClip           clip,
-                          guint                      n_external_textures)
+static void
+gsk_gl_frame_bind_vao (GskGLFrame                *self,
+                       const GskGpuShaderOpClass *op_class)
 {
   GLuint vao;
 
-  gsk_gl_device_use_program (GSK_GL_DEVICE (gsk_gpu_frame_get_device (GSK_GPU_FRAME (self))),
-                             op_class,
-                             variation,
-                             clip,
-                             n_external_textures);
-
   vao = GPOINTER_TO_UINT (g_hash_table_lookup (self->vaos, op_class));
   if (vao)
     {
@@ -267,6 +331,44 @@ gsk_gl_frame_use_program (GskGLFrame                *self,
   g_hash_table_insert (self->vaos, (gpointer) op_class, GUINT_TO_POINTER (vao));
 }
 
+void
+gsk_gl_frame_use_program (GskGLFrame                *self,
+                          const GskGpuShaderOpClass *op_class,
+                          guint32                    variation,
+                          GskGpuShaderClip           clip,
+                          guint                      n_external_textures)
+{
+  gsk_gl_device_use_program (GSK_GL_DEVICE (gsk_gpu_frame_get_device (GSK_GPU_FRAME (self))),
+                             op_class,
+                             variation,
+                             clip,
+                             n_external_textures);
+
+  gsk_gl_frame_bind_vao (self, op_class);
+}
+
+GLuint
+gsk_gl_frame_use_gl_shader_program (GskGLFrame                *self,
+                                    const GskGpuShaderOpClass *op_class,
+                                    GskGLShader               *shader,
+                                    GskGpuShaderClip           clip,
+                                    guint                      n_external_textures)
+{
+  GLuint program_id;
+
+  program_id = gsk_gl_device_use_gl_shader_program (GSK_GL_DEVICE (gsk_gpu_frame_get_device (GSK_GPU_FRAME (self))),
+                                                    op_class,
+                                                    shader,
+                                                    clip,
+                                                    n_external_textures);
+  if (program_id == 0)
+    return 0;
+
+  gsk_gl_frame_bind_vao (self, op_class);
+
+  return program_id;
+}
+
 void
 gsk_gl_frame_bind_globals (GskGLFrame *self)
 {
@@ -2,6 +2,8 @@
 
 #include "gskgpuframeprivate.h"
 
+#include "gskglshader.h"
+
 G_BEGIN_DECLS
 
 #define GSK_TYPE_GL_FRAME (gsk_gl_frame_get_type ())
@@ -14,6 +16,12 @@ void                    gsk_gl_frame_use_program                        (GskGLFr
                                                                          GskGpuShaderClip        clip,
                                                                          guint                   n_external_textures);
 
+GLuint                  gsk_gl_frame_use_gl_shader_program              (GskGLFrame             *self,
+                                                                         const GskGpuShaderOpClass *op_class,
+                                                                         GskGLShader            *shader,
+                                                                         GskGpuShaderClip        clip,
+                                                                         guint                   n_external_textures);
+
 void                    gsk_gl_frame_bind_globals                       (GskGLFrame             *self);
 
 G_END_DECLS
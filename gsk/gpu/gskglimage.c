@@ -2,6 +2,7 @@
 
 #include "gskglimageprivate.h"
 
+#include "gdk/gdkcompressedtextureprivate.h"
 #include "gdk/gdkdisplayprivate.h"
 #include "gdk/gdkglcontextprivate.h"
 
@@ -211,6 +212,88 @@ gsk_gl_image_new_for_texture (GskGLDevice      *device,
   return GSK_GPU_IMAGE (self);
 }
 
+/*
+ * gsk_gl_image_new_for_compressed_texture:
+ * @device: the device
+ * @owner: a `GdkCompressedTexture`
+ *
+ * Uploads the blocks of @owner as they are, so the image stays
+ * compressed in video memory. The context must support the
+ * compression format.
+ *
+ * Compressed images can neither be rendered to nor blitted from.
+ *
+ * Returns: (nullable): the new image
+ */
+GskGpuImage *
+gsk_gl_image_new_for_compressed_texture (GskGLDevice *device,
+                                         GdkTexture  *owner)
+{
+  GdkCompressedTexture *compressed = GDK_COMPRESSED_TEXTURE (owner);
+  GskGpuImageFlags flags;
+  GskGLImage *self;
+  GBytes *bytes;
+  gsize width, height, max_size;
+
+  width = gdk_texture_get_width (owner);
+  height = gdk_texture_get_height (owner);
+  max_size = gsk_gpu_device_get_max_image_size (GSK_GPU_DEVICE (device));
+  if (width > max_size || height > max_size)
+    return NULL;
+
+  self = g_object_new (GSK_TYPE_GL_IMAGE, NULL);
+
+  switch (gdk_compressed_texture_get_compressed_format (compressed))
+    {
+    case GDK_COMPRESSED_BC1:
+      self->gl_internal_format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+      break;
+    case GDK_COMPRESSED_BC2:
+      self->gl_internal_format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+      break;
+    case GDK_COMPRESSED_BC3:
+      self->gl_internal_format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+  /* Never used, as nothing is ever uploaded into or read from
+   * the image, but keep them meaningful
+   */
+  self->gl_format = GL_RGBA;
+  self->gl_type = GL_UNSIGNED_BYTE;
+
+  flags = GSK_GPU_IMAGE_NO_BLIT | GSK_GPU_IMAGE_FILTERABLE;
+  if (gdk_memory_format_alpha (gdk_texture_get_format (owner)) == GDK_MEMORY_ALPHA_STRAIGHT)
+    flags |= GSK_GPU_IMAGE_STRAIGHT_ALPHA;
+
+  gsk_gpu_image_setup (GSK_GPU_IMAGE (self),
+                       flags,
+                       gdk_texture_get_format (owner),
+                       width, height);
+
+  glGenTextures (1, &self->texture_id);
+  self->owns_texture = TRUE;
+
+  glActiveTexture (GL_TEXTURE0);
+  glBindTexture (GL_TEXTURE_2D, self->texture_id);
+
+  glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+  bytes = gdk_compressed_texture_get_bytes (compressed);
+  glCompressedTexImage2D (GL_TEXTURE_2D, 0,
+                          self->gl_internal_format,
+                          width, height,
+                          0,
+                          g_bytes_get_size (bytes),
+                          g_bytes_get_data (bytes, NULL));
+
+  return GSK_GPU_IMAGE (self);
+}
+
 void
 gsk_gl_image_bind_texture (GskGLImage *self)
 {
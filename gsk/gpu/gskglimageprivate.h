@@ -25,6 +25,8 @@ GskGpuImage *           gsk_gl_image_new_for_texture                    (GskGLDe
                                                                          GLuint                  tex_id,
                                                                          gboolean                take_ownership,
                                                                          GskGpuImageFlags        extra_flags);
+GskGpuImage *           gsk_gl_image_new_for_compressed_texture         (GskGLDevice            *device,
+                                                                         GdkTexture             *owner);
                                                                          
 
 void                    gsk_gl_image_bind_texture                       (GskGLImage             *self);
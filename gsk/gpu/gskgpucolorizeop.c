@@ -8,6 +8,8 @@
 
 #include "gpu/shaders/gskgpucolorizeinstance.h"
 
+#define VARIATION_SDF 1
+
 typedef struct _GskGpuColorizeOp GskGpuColorizeOp;
 
 struct _GskGpuColorizeOp
@@ -22,6 +24,8 @@ gsk_gpu_colorize_op_print_instance (GskGpuShaderOp *shader,
 {
   GskGpuColorizeInstance *instance = (GskGpuColorizeInstance *) instance_;
 
+  if (shader->variation & VARIATION_SDF)
+    gsk_gpu_print_string (string, "sdf");
   gsk_gpu_print_rect (string, instance->rect);
   gsk_gpu_print_image_descriptor (string, shader->desc, instance->tex_id);
   gsk_gpu_print_rgba (string, instance->color);
@@ -48,21 +52,22 @@ static const GskGpuShaderOpClass GSK_GPU_COLORIZE_OP_CLASS = {
   gsk_gpu_colorize_setup_vao
 };
 
-void
-gsk_gpu_colorize_op (GskGpuFrame            *frame,
-                     GskGpuShaderClip        clip,
-                     GskGpuDescriptors      *descriptors,
-                     guint32                 descriptor,
-                     const graphene_rect_t  *rect,
-                     const graphene_point_t *offset,
-                     const graphene_rect_t  *tex_rect,
-                     const GdkRGBA          *color)
+static void
+gsk_gpu_colorize_op_full (GskGpuFrame            *frame,
+                          guint32                 variation,
+                          GskGpuShaderClip        clip,
+                          GskGpuDescriptors      *descriptors,
+                          guint32                 descriptor,
+                          const graphene_rect_t  *rect,
+                          const graphene_point_t *offset,
+                          const graphene_rect_t  *tex_rect,
+                          const GdkRGBA          *color)
 {
   GskGpuColorizeInstance *instance;
 
   gsk_gpu_shader_op_alloc (frame,
                            &GSK_GPU_COLORIZE_OP_CLASS,
-                           0,
+                           variation,
                            clip,
                            descriptors,
                            &instance);
@@ -72,3 +77,45 @@ gsk_gpu_colorize_op (GskGpuFrame            *frame,
   instance->tex_id = descriptor;
   gsk_gpu_rgba_to_float (color, instance->color);
 }
+
+void
+gsk_gpu_colorize_op (GskGpuFrame            *frame,
+                     GskGpuShaderClip        clip,
+                     GskGpuDescriptors      *descriptors,
+                     guint32                 descriptor,
+                     const graphene_rect_t  *rect,
+                     const graphene_point_t *offset,
+                     const graphene_rect_t  *tex_rect,
+                     const GdkRGBA          *color)
+{
+  gsk_gpu_colorize_op_full (frame,
+                            0,
+                            clip,
+                            descriptors,
+                            descriptor,
+                            rect,
+                            offset,
+                            tex_rect,
+                            color);
+}
+
+void
+gsk_gpu_colorize_sdf_op (GskGpuFrame            *frame,
+                         GskGpuShaderClip        clip,
+                         GskGpuDescriptors      *descriptors,
+                         guint32                 descriptor,
+                         const graphene_rect_t  *rect,
+                         const graphene_point_t *offset,
+                         const graphene_rect_t  *tex_rect,
+                         const GdkRGBA          *color)
+{
+  gsk_gpu_colorize_op_full (frame,
+                            VARIATION_SDF,
+                            clip,
+                            descriptors,
+                            descriptor,
+                            rect,
+                            offset,
+                            tex_rect,
+                            color);
+}
@@ -6,12 +6,17 @@
 #include "gskgpuimageprivate.h"
 #include "gskgpuuploadopprivate.h"
 
+#include "gdk/gdkallocationsprivate.h"
 #include "gdk/gdkdisplayprivate.h"
+#include "gdk/gdkmemoryformatprivate.h"
 #include "gdk/gdktextureprivate.h"
 #include "gdk/gdkprofilerprivate.h"
 
 #include "gsk/gskdebugprivate.h"
+#include "gsk/gskpath.h"
 #include "gsk/gskprivate.h"
+#include "gsk/gskrendernodeprivate.h"
+#include "gsk/gskstrokeprivate.h"
 
 #define MAX_SLICES_PER_ATLAS 64
 
@@ -23,6 +28,8 @@
 
 #define CACHE_TIMEOUT 15  /* seconds */
 
+#define OFFSCREEN_CACHE_SIZE 64 /* megabytes */
+
 G_STATIC_ASSERT (MAX_ATLAS_ITEM_SIZE < ATLAS_SIZE);
 G_STATIC_ASSERT (MAX_DEAD_PIXELS < ATLAS_SIZE * ATLAS_SIZE);
 
@@ -30,6 +37,8 @@ typedef struct _GskGpuCached GskGpuCached;
 typedef struct _GskGpuCachedClass GskGpuCachedClass;
 typedef struct _GskGpuCachedAtlas GskGpuCachedAtlas;
 typedef struct _GskGpuCachedGlyph GskGpuCachedGlyph;
+typedef struct _GskGpuCachedOffscreen GskGpuCachedOffscreen;
+typedef struct _GskGpuCachedPath GskGpuCachedPath;
 typedef struct _GskGpuCachedTexture GskGpuCachedTexture;
 typedef struct _GskGpuDevicePrivate GskGpuDevicePrivate;
 
@@ -45,14 +54,34 @@ struct _GskGpuDevicePrivate
 
   GHashTable *texture_cache;
   GHashTable *glyph_cache;
+  GHashTable *path_cache;
+  GHashTable *offscreen_cache;
+
+  GQueue offscreen_lru;     /* least recently used first */
+  gsize offscreen_size;     /* in bytes */
+  gsize max_offscreen_size; /* in bytes, 0 disables the offscreen cache */
 
   GskGpuCachedAtlas *current_atlas;
 
+  /* glyph cache lookups since the last frame */
+  guint glyph_hits;
+  guint glyph_misses;
+
   /* atomic */ gsize dead_texture_pixels;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (GskGpuDevice, gsk_gpu_device, G_TYPE_OBJECT)
 
+/* Distance of the outline in pixels that SDF glyphs encode */
+#define SDF_GLYPH_SPREAD 4
+
+static guint glyph_hits_counter;
+static guint glyph_misses_counter;
+static guint glyph_hit_rate_counter;
+static guint texture_bytes_counter;
+static guint atlas_bytes_counter;
+static guint offscreen_bytes_counter;
+
 /* {{{ Cached base class */
 
 struct _GskGpuCachedClass
@@ -76,7 +105,7 @@ struct _GskGpuCached
 
   gint64 timestamp;
   gboolean stale;
-  guint pixels;   /* For glyphs and textures, pixels. For atlases, dead pixels */
+  guint pixels;   /* For glyphs, paths, offscreens and textures, pixels. For atlases, dead pixels */
 };
 
 static inline void
@@ -114,6 +143,8 @@ gsk_gpu_cached_free (GskGpuDevice *device,
 
   mark_as_stale (cached, TRUE);
 
+  gdk_allocation_remove (GDK_ALLOCATION_GPU_CACHE);
+
   cached->class->free (device, cached);
 }
 
@@ -135,6 +166,8 @@ gsk_gpu_cached_new (GskGpuDevice            *device,
 
   cached = g_malloc0 (class->size);
 
+  gdk_allocation_add (GDK_ALLOCATION_GPU_CACHE, class->size);
+
   cached->class = class;
   cached->atlas = atlas;
 
@@ -155,6 +188,9 @@ gsk_gpu_cached_use (GskGpuDevice *device,
 {
   cached->timestamp = timestamp;
   mark_as_stale (cached, FALSE);
+
+  if (cached->atlas)
+    ((GskGpuCached *) cached->atlas)->timestamp = timestamp;
 }
 
 static inline gboolean
@@ -215,7 +251,17 @@ gsk_gpu_cached_atlas_should_collect (GskGpuDevice *device,
                                      GskGpuCached *cached,
                                      gint64        timestamp)
 {
-  return cached->pixels > MAX_DEAD_PIXELS;
+  GskGpuDevicePrivate *priv = gsk_gpu_device_get_instance_private (device);
+
+  if (cached->pixels > MAX_DEAD_PIXELS)
+    return TRUE;
+
+  /* Compact idle atlases: Once nothing on an atlas we don't add to
+   * anymore has been used in a while, drop it, and let its items be
+   * rerendered into the current atlas when they are needed again.
+   */
+  return (GskGpuCachedAtlas *) cached != priv->current_atlas &&
+         gsk_gpu_cached_is_old (device, cached, timestamp);
 }
 
 static const GskGpuCachedClass GSK_GPU_CACHED_ATLAS_CLASS =
@@ -435,36 +481,309 @@ static const GskGpuCachedClass GSK_GPU_CACHED_GLYPH_CLASS =
 };
 
 /* }}} */
-/* {{{ GskGpuDevice */
+/* {{{ CachedPath */
+
+struct _GskGpuCachedPath
+{
+  GskGpuCached parent;
+
+  GskPath *path;
+  gboolean is_stroke;
+  GskFillRule fill_rule;
+  GskStroke stroke;
+  float scale_x;
+  float scale_y;
+  graphene_point_t subpixel;
+
+  GskGpuImage *image;
+  graphene_rect_t bounds;
+  graphene_point_t origin;
+};
 
 static void
-print_cache_stats (GskGpuDevice *self)
+gsk_gpu_cached_path_free (GskGpuDevice *device,
+                          GskGpuCached *cached)
+{
+  GskGpuDevicePrivate *priv = gsk_gpu_device_get_instance_private (device);
+  GskGpuCachedPath *self = (GskGpuCachedPath *) cached;
+
+  g_hash_table_remove (priv->path_cache, self);
+
+  gsk_path_unref (self->path);
+  gsk_stroke_clear (&self->stroke);
+  g_object_unref (self->image);
+
+  g_free (self);
+}
+
+static gboolean
+gsk_gpu_cached_path_should_collect (GskGpuDevice *device,
+                                    GskGpuCached *cached,
+                                    gint64        timestamp)
+{
+  /* Paths are only ever put into atlases, so they work like glyphs */
+  if (gsk_gpu_cached_is_old (device, cached, timestamp))
+    mark_as_stale (cached, TRUE);
+
+  return FALSE;
+}
+
+static guint
+gsk_gpu_cached_path_hash (gconstpointer data)
+{
+  const GskGpuCachedPath *path = data;
+
+  return GPOINTER_TO_UINT (path->path) ^
+         (path->is_stroke ? (guint) (path->stroke.line_width * 16) : path->fill_rule) ^
+         ((guint) (path->scale_x * 16) << 8) ^
+         ((guint) (path->scale_y * 16) << 16) ^
+         ((guint) (path->subpixel.x * 16) << 24) ^
+         ((guint) (path->subpixel.y * 16) << 28);
+}
+
+static gboolean
+gsk_gpu_cached_path_equal (gconstpointer v1,
+                           gconstpointer v2)
+{
+  const GskGpuCachedPath *path1 = v1;
+  const GskGpuCachedPath *path2 = v2;
+
+  if (path1->path != path2->path ||
+      path1->is_stroke != path2->is_stroke ||
+      path1->scale_x != path2->scale_x ||
+      path1->scale_y != path2->scale_y ||
+      !graphene_point_equal (&path1->subpixel, &path2->subpixel))
+    return FALSE;
+
+  if (path1->is_stroke)
+    return gsk_stroke_equal (&path1->stroke, &path2->stroke);
+  else
+    return path1->fill_rule == path2->fill_rule;
+}
+
+static const GskGpuCachedClass GSK_GPU_CACHED_PATH_CLASS =
+{
+  sizeof (GskGpuCachedPath),
+  gsk_gpu_cached_path_free,
+  gsk_gpu_cached_path_should_collect
+};
+
+typedef struct _PathData PathData;
+struct _PathData
+{
+  GskPath *path;
+  gboolean is_stroke;
+  GskFillRule fill_rule;
+  GskStroke stroke;
+};
+
+static void
+gsk_gpu_path_data_free (gpointer data)
+{
+  PathData *path_data = data;
+
+  gsk_path_unref (path_data->path);
+  gsk_stroke_clear (&path_data->stroke);
+  g_free (path_data);
+}
+
+static void
+gsk_gpu_path_data_draw (gpointer  data,
+                        cairo_t  *cr)
+{
+  PathData *path_data = data;
+
+  gsk_path_to_cairo (path_data->path, cr);
+  cairo_set_source_rgba (cr, 1, 1, 1, 1);
+
+  if (path_data->is_stroke)
+    {
+      gsk_stroke_to_cairo (&path_data->stroke, cr);
+      cairo_stroke (cr);
+    }
+  else
+    {
+      switch (path_data->fill_rule)
+      {
+        case GSK_FILL_RULE_WINDING:
+          cairo_set_fill_rule (cr, CAIRO_FILL_RULE_WINDING);
+          break;
+        case GSK_FILL_RULE_EVEN_ODD:
+          cairo_set_fill_rule (cr, CAIRO_FILL_RULE_EVEN_ODD);
+          break;
+        default:
+          g_assert_not_reached ();
+          break;
+      }
+      cairo_fill (cr);
+    }
+}
+
+/* }}} */
+/* {{{ CachedOffscreen */
+
+struct _GskGpuCachedOffscreen
+{
+  GskGpuCached parent;
+
+  GskRenderNode *node;
+  float scale_x;
+  float scale_y;
+  graphene_rect_t viewport;
+
+  GskGpuImage *image;
+  gsize size;
+  GList lru_link;
+};
+
+static void
+gsk_gpu_cached_offscreen_free (GskGpuDevice *device,
+                               GskGpuCached *cached)
+{
+  GskGpuDevicePrivate *priv = gsk_gpu_device_get_instance_private (device);
+  GskGpuCachedOffscreen *self = (GskGpuCachedOffscreen *) cached;
+
+  g_hash_table_remove (priv->offscreen_cache, self);
+  g_queue_unlink (&priv->offscreen_lru, &self->lru_link);
+  priv->offscreen_size -= self->size;
+
+  gsk_render_node_unref (self->node);
+  g_object_unref (self->image);
+
+  g_free (self);
+}
+
+static gboolean
+gsk_gpu_cached_offscreen_should_collect (GskGpuDevice *device,
+                                         GskGpuCached *cached,
+                                         gint64        timestamp)
+{
+  return gsk_gpu_cached_is_old (device, cached, timestamp);
+}
+
+static guint
+gsk_gpu_cached_offscreen_hash (gconstpointer data)
+{
+  const GskGpuCachedOffscreen *offscreen = data;
+
+  return GPOINTER_TO_UINT (offscreen->node) ^
+         ((guint) (offscreen->scale_x * 16) << 8) ^
+         ((guint) (offscreen->scale_y * 16) << 16) ^
+         ((guint) offscreen->viewport.size.width << 20) ^
+         ((guint) offscreen->viewport.size.height << 24);
+}
+
+static gboolean
+gsk_gpu_cached_offscreen_equal (gconstpointer v1,
+                                gconstpointer v2)
+{
+  const GskGpuCachedOffscreen *offscreen1 = v1;
+  const GskGpuCachedOffscreen *offscreen2 = v2;
+
+  return offscreen1->node == offscreen2->node
+      && offscreen1->scale_x == offscreen2->scale_x
+      && offscreen1->scale_y == offscreen2->scale_y
+      && graphene_rect_equal (&offscreen1->viewport, &offscreen2->viewport);
+}
+
+static const GskGpuCachedClass GSK_GPU_CACHED_OFFSCREEN_CLASS =
+{
+  sizeof (GskGpuCachedOffscreen),
+  gsk_gpu_cached_offscreen_free,
+  gsk_gpu_cached_offscreen_should_collect
+};
+
+/* }}} */
+/* {{{ GskGpuDevice */
+
+static gsize
+image_bytes (GskGpuImage *image)
+{
+  return gsk_gpu_image_get_width (image) *
+         gsk_gpu_image_get_height (image) *
+         gdk_memory_format_bytes_per_pixel (gsk_gpu_image_get_format (image));
+}
+
+/* Items that live in an atlas only count the pixels they occupy,
+ * the atlas itself is accounted for separately */
+static gsize
+item_bytes (GskGpuCached *cached,
+            GskGpuImage  *image)
+{
+  if (cached->atlas)
+    return (gsize) cached->pixels * gdk_memory_format_bytes_per_pixel (gsk_gpu_image_get_format (image));
+  else
+    return image_bytes (image);
+}
+
+/*
+ * gsk_gpu_device_get_cache_stats:
+ * @self: a device
+ * @stats: (out caller-allocates): the stats
+ *
+ * Counts the items and the memory in the device's caches.
+ *
+ * The caches are shared by all renderers of the display,
+ * so these are the numbers for all of its windows.
+ */
+void
+gsk_gpu_device_get_cache_stats (GskGpuDevice     *self,
+                                GskGpuCacheStats *stats)
 {
   GskGpuDevicePrivate *priv = gsk_gpu_device_get_instance_private (self);
   GskGpuCached *cached;
-  guint glyphs = 0;
-  guint stale_glyphs = 0;
-  guint textures = 0;
-  guint atlases = 0;
-  GString *ratios = g_string_new ("");
+
+  *stats = (GskGpuCacheStats) { 0, };
 
   for (cached = priv->first_cached; cached != NULL; cached = cached->next)
     {
       if (cached->class == &GSK_GPU_CACHED_GLYPH_CLASS)
         {
-          glyphs++;
+          stats->n_glyphs++;
           if (cached->stale)
-            stale_glyphs++;
+            stats->n_stale_glyphs++;
+          stats->glyph_bytes += item_bytes (cached, ((GskGpuCachedGlyph *) cached)->image);
+        }
+      else if (cached->class == &GSK_GPU_CACHED_PATH_CLASS)
+        {
+          stats->n_paths++;
+          if (cached->stale)
+            stats->n_stale_paths++;
+          stats->path_bytes += item_bytes (cached, ((GskGpuCachedPath *) cached)->image);
+        }
+      else if (cached->class == &GSK_GPU_CACHED_OFFSCREEN_CLASS)
+        {
+          stats->n_offscreens++;
+          stats->offscreen_bytes += ((GskGpuCachedOffscreen *) cached)->size;
         }
       else if (cached->class == &GSK_GPU_CACHED_TEXTURE_CLASS)
         {
-          textures++;
+          stats->n_textures++;
+          stats->texture_bytes += item_bytes (cached, ((GskGpuCachedTexture *) cached)->image);
         }
       else if (cached->class == &GSK_GPU_CACHED_ATLAS_CLASS)
         {
-          double ratio;
+          stats->n_atlases++;
+          stats->atlas_bytes += image_bytes (((GskGpuCachedAtlas *) cached)->image);
+        }
+    }
+}
 
-          atlases++;
+static void
+print_cache_stats (GskGpuDevice *self)
+{
+  GskGpuDevicePrivate *priv = gsk_gpu_device_get_instance_private (self);
+  GskGpuCacheStats stats;
+  GskGpuCached *cached;
+  GString *ratios = g_string_new ("");
+
+  gsk_gpu_device_get_cache_stats (self, &stats);
+
+  for (cached = priv->first_cached; cached != NULL; cached = cached->next)
+    {
+      if (cached->class == &GSK_GPU_CACHED_ATLAS_CLASS)
+        {
+          double ratio;
 
           ratio = (double) cached->pixels / (double) (ATLAS_SIZE * ATLAS_SIZE);
 
@@ -480,16 +799,32 @@ print_cache_stats (GskGpuDevice *self)
     g_string_append (ratios, ")");
 
   gdk_debug_message ("Cached items\n"
-                     "  glyphs:   %5u (%u stale)\n"
-                     "  textures: %5u (%u in hash)\n"
-                     "  atlases:  %5u%s",
-                     glyphs, stale_glyphs,
-                     textures, g_hash_table_size (priv->texture_cache),
-                     atlases, ratios->str);
+                     "  glyphs:   %5u (%u stale, %lu kB)\n"
+                     "  paths:    %5u (%u stale, %lu kB)\n"
+                     "  offscreens: %3u (%lu kB of %lu kB)\n"
+                     "  textures: %5u (%u in hash, %lu kB)\n"
+                     "  atlases:  %5u (%lu kB)%s",
+                     stats.n_glyphs, stats.n_stale_glyphs, stats.glyph_bytes / 1024,
+                     stats.n_paths, stats.n_stale_paths, stats.path_bytes / 1024,
+                     stats.n_offscreens, stats.offscreen_bytes / 1024, priv->max_offscreen_size / 1024,
+                     stats.n_textures, g_hash_table_size (priv->texture_cache), stats.texture_bytes / 1024,
+                     stats.n_atlases, stats.atlas_bytes / 1024, ratios->str);
 
   g_string_free (ratios, TRUE);
 }
 
+static void
+report_cache_stats (GskGpuDevice *self)
+{
+  GskGpuCacheStats stats;
+
+  gsk_gpu_device_get_cache_stats (self, &stats);
+
+  gdk_profiler_set_int_counter (texture_bytes_counter, stats.texture_bytes);
+  gdk_profiler_set_int_counter (atlas_bytes_counter, stats.atlas_bytes);
+  gdk_profiler_set_int_counter (offscreen_bytes_counter, stats.offscreen_bytes);
+}
+
 static void
 gsk_gpu_device_gc (GskGpuDevice *self,
                    gint64        timestamp)
@@ -512,9 +847,22 @@ gsk_gpu_device_gc (GskGpuDevice *self,
 
   g_atomic_pointer_set (&priv->dead_texture_pixels, 0);
 
+  if (GSK_GPU_DEVICE_GET_CLASS (self)->trim &&
+      GSK_GPU_DEVICE_GET_CLASS (self)->trim (self))
+    {
+      /* Running out of memory, so drop the offscreens we keep around
+       * just in case, they are the easiest to recreate.
+       */
+      while (!g_queue_is_empty (&priv->offscreen_lru))
+        gsk_gpu_cached_free (self, g_queue_peek_head (&priv->offscreen_lru));
+    }
+
   if (GSK_DEBUG_CHECK (GLYPH_CACHE))
     print_cache_stats (self);
 
+  if (GDK_PROFILER_IS_RUNNING)
+    report_cache_stats (self);
+
   gdk_profiler_end_mark (before, "Glyph cache GC", NULL);
 }
 
@@ -533,12 +881,32 @@ cache_gc_cb (gpointer data)
   return G_SOURCE_REMOVE;
 }
 
+static void
+gsk_gpu_device_report_glyph_stats (GskGpuDevice *self)
+{
+  GskGpuDevicePrivate *priv = gsk_gpu_device_get_instance_private (self);
+  guint lookups;
+
+  lookups = priv->glyph_hits + priv->glyph_misses;
+  if (lookups == 0)
+    return;
+
+  gdk_profiler_set_int_counter (glyph_hits_counter, priv->glyph_hits);
+  gdk_profiler_set_int_counter (glyph_misses_counter, priv->glyph_misses);
+  gdk_profiler_set_int_counter (glyph_hit_rate_counter, priv->glyph_hits * 100 / lookups);
+
+  priv->glyph_hits = 0;
+  priv->glyph_misses = 0;
+}
+
 void
 gsk_gpu_device_maybe_gc (GskGpuDevice *self)
 {
   GskGpuDevicePrivate *priv = gsk_gpu_device_get_instance_private (self);
   gsize dead_texture_pixels;
 
+  gsk_gpu_device_report_glyph_stats (self);
+
   if (priv->cache_timeout < 0)
     return;
 
@@ -592,6 +960,8 @@ gsk_gpu_device_dispose (GObject *object)
 
   gsk_gpu_device_clear_cache (self);
   g_hash_table_unref (priv->glyph_cache);
+  g_hash_table_unref (priv->path_cache);
+  g_hash_table_unref (priv->offscreen_cache);
   g_hash_table_unref (priv->texture_cache);
   g_clear_handle_id (&priv->cache_gc_source, g_source_remove);
 
@@ -616,6 +986,13 @@ gsk_gpu_device_class_init (GskGpuDeviceClass *klass)
 
   object_class->dispose = gsk_gpu_device_dispose;
   object_class->finalize = gsk_gpu_device_finalize;
+
+  glyph_hits_counter = gdk_profiler_define_int_counter ("glyph-cache-hits", "Glyph cache hits per frame");
+  glyph_misses_counter = gdk_profiler_define_int_counter ("glyph-cache-misses", "Glyph cache misses per frame");
+  glyph_hit_rate_counter = gdk_profiler_define_int_counter ("glyph-cache-hit-rate", "Glyph cache hit rate in percent");
+  texture_bytes_counter = gdk_profiler_define_int_counter ("texture-cache-bytes", "Memory used by cached textures");
+  atlas_bytes_counter = gdk_profiler_define_int_counter ("atlas-cache-bytes", "Memory used by glyph and icon atlases");
+  offscreen_bytes_counter = gdk_profiler_define_int_counter ("offscreen-cache-bytes", "Memory used by cached offscreens");
 }
 
 static void
@@ -625,10 +1002,24 @@ gsk_gpu_device_init (GskGpuDevice *self)
 
   priv->glyph_cache = g_hash_table_new (gsk_gpu_cached_glyph_hash,
                                         gsk_gpu_cached_glyph_equal);
+  priv->path_cache = g_hash_table_new (gsk_gpu_cached_path_hash,
+                                       gsk_gpu_cached_path_equal);
+  priv->offscreen_cache = g_hash_table_new (gsk_gpu_cached_offscreen_hash,
+                                            gsk_gpu_cached_offscreen_equal);
+  g_queue_init (&priv->offscreen_lru);
   priv->texture_cache = g_hash_table_new (g_direct_hash,
                                           g_direct_equal);
 }
 
+static void
+gsk_gpu_device_display_closed (GdkDisplay   *display,
+                               gboolean      is_error,
+                               GskGpuDevice *self)
+{
+  g_signal_handlers_disconnect_by_func (display, gsk_gpu_device_display_closed, self);
+  g_object_unref (self);
+}
+
 void
 gsk_gpu_device_setup (GskGpuDevice *self,
                       GdkDisplay   *display,
@@ -639,6 +1030,14 @@ gsk_gpu_device_setup (GskGpuDevice *self,
 
   priv->display = g_object_ref (display);
   priv->max_image_size = max_image_size;
+
+  /* The device is shared by all renderers on the display. Keep it, and
+   * with it the caches, around until the display is closed, so that
+   * windows that are opened later don't start with empty caches. Unused
+   * items still get collected by the GC.
+   */
+  g_object_ref (self);
+  g_signal_connect (display, "closed", G_CALLBACK (gsk_gpu_device_display_closed), self);
   priv->cache_timeout = CACHE_TIMEOUT;
 
   str = g_getenv ("GSK_CACHE_TIMEOUT");
@@ -658,8 +1057,32 @@ gsk_gpu_device_setup (GskGpuDevice *self,
         }
     }
 
+  priv->max_offscreen_size = OFFSCREEN_CACHE_SIZE * 1024 * 1024;
+
+  str = g_getenv ("GSK_OFFSCREEN_CACHE_SIZE");
+  if (str != NULL)
+    {
+      guint64 value;
+      GError *error = NULL;
+
+      if (!g_ascii_string_to_unsigned (str, 10, 0, G_MAXSIZE / (1024 * 1024), &value, &error))
+        {
+          g_warning ("Failed to parse GSK_OFFSCREEN_CACHE_SIZE: %s", error->message);
+          g_error_free (error);
+        }
+      else
+        {
+          priv->max_offscreen_size = (gsize) value * 1024 * 1024;
+        }
+    }
+
   if (GSK_DEBUG_CHECK (GLYPH_CACHE))
     {
+      if (priv->max_offscreen_size == 0)
+        gdk_debug_message ("Offscreen cache disabled");
+      else
+        gdk_debug_message ("Offscreen cache size: %lu MB", priv->max_offscreen_size / (1024 * 1024));
+
       if (priv->cache_timeout < 0)
         gdk_debug_message ("Cache GC disabled");
       else if (priv->cache_timeout == 0)
@@ -712,12 +1135,13 @@ gsk_gpu_device_make_current (GskGpuDevice *self)
 }
 
 GskGpuImage *
-gsk_gpu_device_create_download_image (GskGpuDevice   *self,
-                                      GdkMemoryDepth  depth,
-                                      gsize           width,
-                                      gsize           height)
+gsk_gpu_device_create_download_image (GskGpuDevice     *self,
+                                      GdkMemoryDepth    depth,
+                                      GdkDmabufFormats *scanout_formats,
+                                      gsize             width,
+                                      gsize             height)
 {
-  return GSK_GPU_DEVICE_GET_CLASS (self)->create_download_image (self, depth, width, height);
+  return GSK_GPU_DEVICE_GET_CLASS (self)->create_download_image (self, depth, scanout_formats, width, height);
 }
 
 /* This rounds up to the next number that has <= 2 bits set:
@@ -911,6 +1335,7 @@ gsk_gpu_device_lookup_glyph_image (GskGpuDevice           *self,
   cache = g_hash_table_lookup (priv->glyph_cache, &lookup);
   if (cache)
     {
+      priv->glyph_hits++;
       gsk_gpu_cached_use (self, (GskGpuCached *) cache, gsk_gpu_frame_get_timestamp (frame));
 
       *out_bounds = cache->bounds;
@@ -918,6 +1343,8 @@ gsk_gpu_device_lookup_glyph_image (GskGpuDevice           *self,
       return cache->image;
     }
 
+  priv->glyph_misses++;
+
   scaled_font = gsk_reload_font (font, scale, CAIRO_HINT_METRICS_DEFAULT, CAIRO_HINT_STYLE_DEFAULT, CAIRO_ANTIALIAS_DEFAULT);
 
   subpixel_x = (flags & 3) / 4.f;
@@ -929,6 +1356,16 @@ gsk_gpu_device_lookup_glyph_image (GskGpuDevice           *self,
   rect.size.height = ceil ((ink_rect.y + ink_rect.height) * 1.0 / PANGO_SCALE + subpixel_y) - origin.y;
   padding = 1;
 
+  /* The distance field extends past the outline, so it needs to be
+   * part of the drawn area */
+  if (flags & GSK_GPU_GLYPH_SDF)
+    {
+      origin.x -= SDF_GLYPH_SPREAD;
+      origin.y -= SDF_GLYPH_SPREAD;
+      rect.size.width += 2 * SDF_GLYPH_SPREAD;
+      rect.size.height += 2 * SDF_GLYPH_SPREAD;
+    }
+
   image = gsk_gpu_device_add_atlas_image (self,
                                           rect.size.width + 2 * padding, rect.size.height + 2 * padding,
                                           &atlas_x, &atlas_y);
@@ -969,7 +1406,8 @@ gsk_gpu_device_lookup_glyph_image (GskGpuDevice           *self,
                                .height = rect.size.height + 2 * padding,
                            },
                            &GRAPHENE_POINT_INIT (cache->origin.x + padding,
-                                                 cache->origin.y + padding));
+                                                 cache->origin.y + padding),
+                           flags & GSK_GPU_GLYPH_SDF ? SDF_GLYPH_SPREAD : 0);
 
   g_hash_table_insert (priv->glyph_cache, cache, cache);
   gsk_gpu_cached_use (self, (GskGpuCached *) cache, gsk_gpu_frame_get_timestamp (frame));
@@ -982,5 +1420,224 @@ gsk_gpu_device_lookup_glyph_image (GskGpuDevice           *self,
   return cache->image;
 }
 
+/*
+ * gsk_gpu_device_lookup_path_image:
+ * @self: the device
+ * @frame: the frame to upload with if the path isn't cached yet
+ * @path: the path
+ * @fill_rule: the fill rule when filling
+ * @stroke: (nullable): the stroke when stroking, or %NULL to fill
+ * @scale: the scale to render at
+ * @subpixel: the fractional part of the device position of the path's origin.
+ *   Both values must be in the range [0, 1).
+ * @out_bounds: (out): the area of the returned image that contains the mask
+ * @out_origin: (out): the position of the path's origin in @out_bounds,
+ *   in device pixels
+ *
+ * Looks up an alpha mask of the given path in the atlas, rendering it
+ * if it isn't there yet. Unlike the cairo fallback in the node processor,
+ * this way the mask survives across frames.
+ *
+ * Returns: (nullable) (transfer none): the image containing the mask or %NULL
+ *   if the path is too large to be put into an atlas
+ */
+GskGpuImage *
+gsk_gpu_device_lookup_path_image (GskGpuDevice           *self,
+                                  GskGpuFrame            *frame,
+                                  GskPath                *path,
+                                  GskFillRule             fill_rule,
+                                  const GskStroke        *stroke,
+                                  const graphene_vec2_t  *scale,
+                                  const graphene_point_t *subpixel,
+                                  graphene_rect_t        *out_bounds,
+                                  graphene_point_t       *out_origin)
+{
+  GskGpuDevicePrivate *priv = gsk_gpu_device_get_instance_private (self);
+  GskGpuCachedPath lookup = {
+    .path = path,
+    .is_stroke = stroke != NULL,
+    .fill_rule = stroke ? GSK_FILL_RULE_WINDING : fill_rule,
+    .stroke = stroke ? *stroke : (GskStroke) { 0, },
+    .scale_x = graphene_vec2_get_x (scale),
+    .scale_y = graphene_vec2_get_y (scale),
+    .subpixel = *subpixel,
+  };
+  GskGpuCachedPath *cache;
+  graphene_rect_t path_bounds, rect;
+  graphene_point_t origin;
+  GskGpuImage *image;
+  gsize atlas_x, atlas_y, padding;
+
+  cache = g_hash_table_lookup (priv->path_cache, &lookup);
+  if (cache)
+    {
+      gsk_gpu_cached_use (self, (GskGpuCached *) cache, gsk_gpu_frame_get_timestamp (frame));
+
+      *out_bounds = cache->bounds;
+      *out_origin = cache->origin;
+      return cache->image;
+    }
+
+  if (stroke)
+    {
+      if (!gsk_path_get_stroke_bounds (path, stroke, &path_bounds))
+        return NULL;
+    }
+  else
+    {
+      if (!gsk_path_get_bounds (path, &path_bounds))
+        return NULL;
+    }
+
+  origin.x = floor (path_bounds.origin.x * lookup.scale_x + subpixel->x);
+  origin.y = floor (path_bounds.origin.y * lookup.scale_y + subpixel->y);
+  rect.size.width = ceil ((path_bounds.origin.x + path_bounds.size.width) * lookup.scale_x + subpixel->x) - origin.x;
+  rect.size.height = ceil ((path_bounds.origin.y + path_bounds.size.height) * lookup.scale_y + subpixel->y) - origin.y;
+  padding = 1;
+
+  image = gsk_gpu_device_add_atlas_image (self,
+                                          rect.size.width + 2 * padding, rect.size.height + 2 * padding,
+                                          &atlas_x, &atlas_y);
+  if (image == NULL)
+    return NULL;
+
+  rect.origin.x = atlas_x + padding;
+  rect.origin.y = atlas_y + padding;
+
+  cache = gsk_gpu_cached_new (self, &GSK_GPU_CACHED_PATH_CLASS, priv->current_atlas);
+  cache->path = gsk_path_ref (path);
+  cache->is_stroke = lookup.is_stroke;
+  cache->fill_rule = lookup.fill_rule;
+  if (stroke)
+    cache->stroke = GSK_STROKE_INIT_COPY (stroke);
+  cache->scale_x = lookup.scale_x;
+  cache->scale_y = lookup.scale_y;
+  cache->subpixel = *subpixel;
+  cache->image = g_object_ref (image);
+  cache->bounds = rect;
+  cache->origin = GRAPHENE_POINT_INIT (- origin.x + subpixel->x,
+                                       - origin.y + subpixel->y);
+  ((GskGpuCached *) cache)->pixels = (rect.size.width + 2 * padding) * (rect.size.height + 2 * padding);
+
+  gsk_gpu_upload_cairo_into_op (frame,
+                                image,
+                                &(cairo_rectangle_int_t) {
+                                    .x = atlas_x,
+                                    .y = atlas_y,
+                                    .width = rect.size.width + 2 * padding,
+                                    .height = rect.size.height + 2 * padding,
+                                },
+                                &GRAPHENE_RECT_INIT ((origin.x - padding - subpixel->x) / lookup.scale_x,
+                                                     (origin.y - padding - subpixel->y) / lookup.scale_y,
+                                                     (rect.size.width + 2 * padding) / lookup.scale_x,
+                                                     (rect.size.height + 2 * padding) / lookup.scale_y),
+                                TRUE,
+                                gsk_gpu_path_data_draw,
+                                g_memdup (&(PathData) {
+                                    .path = gsk_path_ref (path),
+                                    .is_stroke = cache->is_stroke,
+                                    .fill_rule = cache->fill_rule,
+                                    .stroke = stroke ? GSK_STROKE_INIT_COPY (stroke) : (GskStroke) { 0, },
+                                }, sizeof (PathData)),
+                                gsk_gpu_path_data_free);
+
+  g_hash_table_insert (priv->path_cache, cache, cache);
+  gsk_gpu_cached_use (self, (GskGpuCached *) cache, gsk_gpu_frame_get_timestamp (frame));
+
+  *out_bounds = cache->bounds;
+  *out_origin = cache->origin;
+
+  return cache->image;
+}
+
+/*
+ * gsk_gpu_device_lookup_offscreen_image:
+ * @self: the device
+ * @node: the node that was rendered
+ * @scale: the scale the node was rendered at
+ * @viewport: the part of the node that was rendered
+ * @timestamp: the timestamp of the current frame
+ *
+ * Looks up an offscreen that was previously rendered for the given node
+ * with gsk_gpu_device_cache_offscreen_image().
+ *
+ * Render nodes are immutable, so if a node is reused across frames, its
+ * offscreen can be reused, too.
+ *
+ * Returns: (nullable) (transfer full): the cached offscreen
+ */
+GskGpuImage *
+gsk_gpu_device_lookup_offscreen_image (GskGpuDevice          *self,
+                                       GskRenderNode         *node,
+                                       const graphene_vec2_t *scale,
+                                       const graphene_rect_t *viewport,
+                                       gint64                 timestamp)
+{
+  GskGpuDevicePrivate *priv = gsk_gpu_device_get_instance_private (self);
+  GskGpuCachedOffscreen lookup = {
+    .node = node,
+    .scale_x = graphene_vec2_get_x (scale),
+    .scale_y = graphene_vec2_get_y (scale),
+    .viewport = *viewport,
+  };
+  GskGpuCachedOffscreen *cache;
+
+  cache = g_hash_table_lookup (priv->offscreen_cache, &lookup);
+  if (cache == NULL)
+    return NULL;
+
+  gsk_gpu_cached_use (self, (GskGpuCached *) cache, timestamp);
+
+  g_queue_unlink (&priv->offscreen_lru, &cache->lru_link);
+  g_queue_push_tail_link (&priv->offscreen_lru, &cache->lru_link);
+
+  return g_object_ref (cache->image);
+}
+
+void
+gsk_gpu_device_cache_offscreen_image (GskGpuDevice          *self,
+                                      GskRenderNode         *node,
+                                      const graphene_vec2_t *scale,
+                                      const graphene_rect_t *viewport,
+                                      gint64                 timestamp,
+                                      GskGpuImage           *image)
+{
+  GskGpuDevicePrivate *priv = gsk_gpu_device_get_instance_private (self);
+  GskGpuCachedOffscreen *cache;
+  gsize width, height, size;
+
+  width = gsk_gpu_image_get_width (image);
+  height = gsk_gpu_image_get_height (image);
+  size = width * height * gdk_memory_format_bytes_per_pixel (gsk_gpu_image_get_format (image));
+
+  /* Don't let a single offscreen evict everything else */
+  if (size > priv->max_offscreen_size / 4)
+    return;
+
+  /* Evict the least recently used offscreens until the new one fits */
+  while (priv->offscreen_size + size > priv->max_offscreen_size)
+    {
+      GList *link = g_queue_peek_head_link (&priv->offscreen_lru);
+
+      gsk_gpu_cached_free (self, link->data);
+    }
+
+  cache = gsk_gpu_cached_new (self, &GSK_GPU_CACHED_OFFSCREEN_CLASS, NULL);
+  cache->node = gsk_render_node_ref (node);
+  cache->scale_x = graphene_vec2_get_x (scale);
+  cache->scale_y = graphene_vec2_get_y (scale);
+  cache->viewport = *viewport;
+  cache->image = g_object_ref (image);
+  cache->size = size;
+  cache->lru_link.data = cache;
+  ((GskGpuCached *) cache)->pixels = width * height;
+
+  g_queue_push_tail_link (&priv->offscreen_lru, &cache->lru_link);
+  priv->offscreen_size += size;
+
+  g_hash_table_insert (priv->offscreen_cache, cache, cache);
+  gsk_gpu_cached_use (self, (GskGpuCached *) cache, timestamp);
+}
+
 /* }}} */
 /* vim:set foldmethod=marker expandtab: */
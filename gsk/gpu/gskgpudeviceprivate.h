@@ -2,6 +2,8 @@
 
 #include "gskgputypesprivate.h"
 
+#include "gsktypes.h"
+
 #include <graphene.h>
 
 G_BEGIN_DECLS
@@ -14,6 +16,7 @@ G_BEGIN_DECLS
 #define GSK_GPU_DEVICE_GET_CLASS(o) (G_TYPE_INSTANCE_GET_CLASS ((o), GSK_TYPE_GPU_DEVICE, GskGpuDeviceClass))
 
 typedef struct _GskGpuDeviceClass GskGpuDeviceClass;
+typedef struct _GskGpuCacheStats GskGpuCacheStats;
 
 struct _GskGpuDevice
 {
@@ -39,10 +42,32 @@ struct _GskGpuDeviceClass
                                                                          gsize                   height);
   GskGpuImage *         (* create_download_image)                       (GskGpuDevice           *self,
                                                                          GdkMemoryDepth          depth,
+                                                                         GdkDmabufFormats       *scanout_formats,
                                                                          gsize                   width,
                                                                          gsize                   height);
   void                  (* make_current)                                (GskGpuDevice           *self);
+  /* optional: release unused memory after GC, returns TRUE if memory is tight */
+  gboolean              (* trim)                                        (GskGpuDevice           *self);
+
+};
 
+/* Sizes are in bytes. Glyphs, paths and textures that live in an atlas
+ * count the pixels they occupy, and are included in atlas_bytes too */
+struct _GskGpuCacheStats
+{
+  guint n_textures;
+  guint n_glyphs;
+  guint n_stale_glyphs;
+  guint n_paths;
+  guint n_stale_paths;
+  guint n_offscreens;
+  guint n_atlases;
+
+  gsize texture_bytes;
+  gsize glyph_bytes;
+  gsize path_bytes;
+  gsize offscreen_bytes;
+  gsize atlas_bytes;
 };
 
 GType                   gsk_gpu_device_get_type                         (void) G_GNUC_CONST;
@@ -55,6 +80,8 @@ void                    gsk_gpu_device_queue_gc                         (GskGpuD
 GdkDisplay *            gsk_gpu_device_get_display                      (GskGpuDevice           *self);
 gsize                   gsk_gpu_device_get_max_image_size               (GskGpuDevice           *self);
 GskGpuImage *           gsk_gpu_device_get_atlas_image                  (GskGpuDevice           *self);
+void                    gsk_gpu_device_get_cache_stats                  (GskGpuDevice           *self,
+                                                                         GskGpuCacheStats       *stats);
 
 GskGpuImage *           gsk_gpu_device_create_offscreen_image           (GskGpuDevice           *self,
                                                                          gboolean                with_mipmap,
@@ -68,6 +95,7 @@ GskGpuImage *           gsk_gpu_device_create_upload_image              (GskGpuD
                                                                          gsize                   height);
 GskGpuImage *           gsk_gpu_device_create_download_image            (GskGpuDevice           *self,
                                                                          GdkMemoryDepth          depth,
+                                                                         GdkDmabufFormats       *scanout_formats,
                                                                          gsize                   width,
                                                                          gsize                   height);
 void                    gsk_gpu_device_make_current                     (GskGpuDevice           *self);
@@ -86,9 +114,14 @@ typedef enum
   GSK_GPU_GLYPH_X_OFFSET_3 = 0x3,
   GSK_GPU_GLYPH_Y_OFFSET_1 = 0x4,
   GSK_GPU_GLYPH_Y_OFFSET_2 = 0x8,
-  GSK_GPU_GLYPH_Y_OFFSET_3 = 0xC
+  GSK_GPU_GLYPH_Y_OFFSET_3 = 0xC,
+  GSK_GPU_GLYPH_SDF        = 0x10
 } GskGpuGlyphLookupFlags;
 
+/* Glyphs that are at least this many pixels in size are stored as
+ * distance fields rendered at that size, see GSK_GPU_GLYPH_SDF */
+#define GSK_GPU_SDF_GLYPH_SIZE 48
+
 GskGpuImage *           gsk_gpu_device_lookup_glyph_image               (GskGpuDevice           *self,
                                                                          GskGpuFrame            *frame,
                                                                          PangoFont              *font,
@@ -98,6 +131,26 @@ GskGpuImage *           gsk_gpu_device_lookup_glyph_image               (GskGpuD
                                                                          graphene_rect_t        *out_bounds,
                                                                          graphene_point_t       *out_origin);
 
+GskGpuImage *           gsk_gpu_device_lookup_path_image                (GskGpuDevice           *self,
+                                                                         GskGpuFrame            *frame,
+                                                                         GskPath                *path,
+                                                                         GskFillRule             fill_rule,
+                                                                         const GskStroke        *stroke,
+                                                                         const graphene_vec2_t  *scale,
+                                                                         const graphene_point_t *subpixel,
+                                                                         graphene_rect_t        *out_bounds,
+                                                                         graphene_point_t       *out_origin);
+GskGpuImage *           gsk_gpu_device_lookup_offscreen_image           (GskGpuDevice           *self,
+                                                                         GskRenderNode          *node,
+                                                                         const graphene_vec2_t  *scale,
+                                                                         const graphene_rect_t  *viewport,
+                                                                         gint64                  timestamp);
+void                    gsk_gpu_device_cache_offscreen_image            (GskGpuDevice           *self,
+                                                                         GskRenderNode          *node,
+                                                                         const graphene_vec2_t  *scale,
+                                                                         const graphene_rect_t  *viewport,
+                                                                         gint64                  timestamp,
+                                                                         GskGpuImage            *image);
 
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GskGpuDevice, g_object_unref)
 
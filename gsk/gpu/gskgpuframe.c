@@ -10,12 +10,14 @@
 #include "gskgpuopprivate.h"
 #include "gskgpurendererprivate.h"
 #include "gskgpurenderpassopprivate.h"
+#include "gskgpushaderopprivate.h"
 #include "gskgpuuploadopprivate.h"
 
 #include "gskdebugprivate.h"
 #include "gskrendererprivate.h"
 
 #include "gdk/gdkdmabufdownloaderprivate.h"
+#include "gdk/gdkprofilerprivate.h"
 #include "gdk/gdktexturedownloaderprivate.h"
 
 #define DEFAULT_VERTEX_BUFFER_SIZE 128 * 1024
@@ -23,6 +25,12 @@
 /* GL_MAX_UNIFORM_BLOCK_SIZE is at 16384 */
 #define DEFAULT_STORAGE_BUFFER_SIZE 16 * 1024 * 64
 
+/* Estimated cost of an extra render pass, in pixels. Damage rectangles
+ * get merged when drawing the extra pixels is cheaper than that. */
+#define RENDER_PASS_COST (256 * 256)
+/* Above this many rectangles, just render the extents */
+#define MAX_RENDER_PASSES 64
+
 #define GDK_ARRAY_NAME gsk_gpu_ops
 #define GDK_ARRAY_TYPE_NAME GskGpuOps
 #define GDK_ARRAY_ELEMENT_TYPE guchar
@@ -48,6 +56,11 @@ struct _GskGpuFramePrivate
   GskGpuBuffer *storage_buffer;
   guchar *storage_buffer_data;
   gsize storage_buffer_used;
+
+  gsize n_draw_calls;
+
+  GArray *timed_ops; /* names of the ops measured via GPU timestamps */
+  gint64 submit_time;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (GskGpuFrame, gsk_gpu_frame, G_TYPE_OBJECT)
@@ -112,6 +125,7 @@ gsk_gpu_frame_finalize (GObject *object)
   GskGpuFramePrivate *priv = gsk_gpu_frame_get_instance_private (self);
 
   gsk_gpu_ops_clear (&priv->ops);
+  g_array_unref (priv->timed_ops);
 
   g_clear_object (&priv->vertex_buffer);
   g_clear_object (&priv->storage_buffer);
@@ -140,6 +154,7 @@ gsk_gpu_frame_init (GskGpuFrame *self)
   GskGpuFramePrivate *priv = gsk_gpu_frame_get_instance_private (self);
 
   gsk_gpu_ops_init (&priv->ops);
+  priv->timed_ops = g_array_new (FALSE, FALSE, sizeof (const char *));
 }
 
 void
@@ -218,6 +233,26 @@ gsk_gpu_frame_verbose_print (GskGpuFrame *self,
     }
 }
 
+static void
+gsk_gpu_frame_print_merge_stats (GskGpuFrame *self)
+{
+  GskGpuFramePrivate *priv = gsk_gpu_frame_get_instance_private (self);
+  gsize n_instances = 0, n_ops = 0;
+  GskGpuOp *op;
+
+  for (op = priv->first_op; op; op = op->next)
+    {
+      if (op->op_class->stage != GSK_GPU_STAGE_SHADER)
+        continue;
+
+      n_instances += ((GskGpuShaderOp *) op)->n_ops;
+      n_ops++;
+    }
+
+  gdk_debug_message ("Merged %zu shader instances into %zu ops and %zu draw calls",
+                     n_instances, n_ops, priv->n_draw_calls);
+}
+
 static void
 gsk_gpu_frame_seal_ops (GskGpuFrame *self)
 {
@@ -373,6 +408,23 @@ gsk_gpu_frame_sort_ops (GskGpuFrame *self)
   priv->last_op = NULL;
 }
 
+/*
+ * gsk_gpu_frame_add_draw_calls:
+ * @self: the frame
+ * @n_draw_calls: number of draw calls that were recorded
+ *
+ * Shader ops call this so the debug output can show how well
+ * consecutive ops were merged.
+ */
+void
+gsk_gpu_frame_add_draw_calls (GskGpuFrame *self,
+                              gsize        n_draw_calls)
+{
+  GskGpuFramePrivate *priv = gsk_gpu_frame_get_instance_private (self);
+
+  priv->n_draw_calls += n_draw_calls;
+}
+
 gpointer
 gsk_gpu_frame_alloc_op (GskGpuFrame *self,
                         gsize        size)
@@ -537,6 +589,159 @@ gsk_gpu_frame_write_storage_buffer (GskGpuFrame  *self,
   return priv->storage_buffer;
 }
 
+/*
+ * gsk_gpu_frame_should_time_ops:
+ * @self: the frame
+ *
+ * Checks if the backend should measure how much GPU time the ops
+ * take. If so, it should call gsk_gpu_frame_add_timed_op() for every
+ * op it records with a timestamp query before it, write one more
+ * timestamp after the last op and hand the results to
+ * gsk_gpu_frame_report_timings() once the frame is done.
+ *
+ * Returns: %TRUE if GPU timings should be collected
+ */
+gboolean
+gsk_gpu_frame_should_time_ops (GskGpuFrame *self)
+{
+  return GSK_DEBUG_CHECK (GPU_TIMINGS) || GDK_PROFILER_IS_RUNNING;
+}
+
+void
+gsk_gpu_frame_add_timed_op (GskGpuFrame *self,
+                            GskGpuOp    *op)
+{
+  GskGpuFramePrivate *priv = gsk_gpu_frame_get_instance_private (self);
+  GString *string;
+  const char *name;
+  gsize len;
+
+  /* The ops don't have names, but they print them first */
+  string = g_string_new (NULL);
+  gsk_gpu_op_print (op, self, string, 0);
+  len = strcspn (string->str, " \n");
+  g_string_truncate (string, len);
+  name = g_intern_string (string->str);
+  g_string_free (string, TRUE);
+
+  g_array_append_val (priv->timed_ops, name);
+}
+
+gsize
+gsk_gpu_frame_get_n_timed_ops (GskGpuFrame *self)
+{
+  GskGpuFramePrivate *priv = gsk_gpu_frame_get_instance_private (self);
+
+  return priv->timed_ops->len;
+}
+
+typedef struct _GskGpuTiming GskGpuTiming;
+
+struct _GskGpuTiming
+{
+  const char *name;
+  guint64 time;
+  guint count;
+};
+
+static int
+compare_timings (gconstpointer a,
+                 gconstpointer b)
+{
+  const GskGpuTiming *ta = a;
+  const GskGpuTiming *tb = b;
+
+  if (ta->time > tb->time)
+    return -1;
+  else if (ta->time < tb->time)
+    return 1;
+  else
+    return 0;
+}
+
+/*
+ * gsk_gpu_frame_report_timings:
+ * @self: the frame
+ * @timestamps: GPU timestamps in nanoseconds, one before each timed op
+ *   and one after the last op, or %NULL if they could not be read back
+ *
+ * Aggregates the GPU time per op type and reports it via debug output
+ * and profiler marks. Afterwards, the timed ops are cleared.
+ */
+void
+gsk_gpu_frame_report_timings (GskGpuFrame   *self,
+                              const guint64 *timestamps)
+{
+  GskGpuFramePrivate *priv = gsk_gpu_frame_get_instance_private (self);
+  GArray *timings;
+  GString *string;
+  guint64 total;
+  guint i, j;
+
+  if (priv->timed_ops->len == 0)
+    return;
+
+  if (timestamps == NULL)
+    {
+      g_array_set_size (priv->timed_ops, 0);
+      return;
+    }
+
+  timings = g_array_new (FALSE, FALSE, sizeof (GskGpuTiming));
+  total = 0;
+
+  for (i = 0; i < priv->timed_ops->len; i++)
+    {
+      const char *name = g_array_index (priv->timed_ops, const char *, i);
+      guint64 time;
+
+      /* timestamps are not required to be monotonic across render passes
+       * on all drivers, so don't let a bogus value wrap around */
+      if (timestamps[i + 1] > timestamps[i])
+        time = timestamps[i + 1] - timestamps[i];
+      else
+        time = 0;
+      total += time;
+
+      for (j = 0; j < timings->len; j++)
+        {
+          GskGpuTiming *timing = &g_array_index (timings, GskGpuTiming, j);
+
+          if (timing->name == name)
+            {
+              timing->time += time;
+              timing->count++;
+              break;
+            }
+        }
+
+      if (j == timings->len)
+        g_array_append_val (timings, ((GskGpuTiming) { name, time, 1 }));
+    }
+
+  g_array_sort (timings, compare_timings);
+
+  string = g_string_new (NULL);
+
+  for (i = 0; i < timings->len; i++)
+    {
+      GskGpuTiming *timing = &g_array_index (timings, GskGpuTiming, i);
+
+      g_string_append_printf (string, "\n  %-24s %8.3f ms (%u)",
+                              timing->name, timing->time / 1000000.0, timing->count);
+
+      gdk_profiler_add_markf (priv->submit_time, timing->time,
+                              "GPU op", "%s (%u)", timing->name, timing->count);
+    }
+
+  GSK_DEBUG (GPU_TIMINGS, "GPU time: %.3f ms%s", total / 1000000.0, string->str);
+  gdk_profiler_add_mark (priv->submit_time, total, "GPU frame", NULL);
+
+  g_string_free (string, TRUE);
+  g_array_unref (timings);
+  g_array_set_size (priv->timed_ops, 0);
+}
+
 gboolean
 gsk_gpu_frame_is_busy (GskGpuFrame *self)
 {
@@ -581,6 +786,82 @@ gsk_gpu_frame_record_rect (GskGpuFrame                 *self,
                               GSK_RENDER_PASS_PRESENT);
 }
 
+static gsize
+rect_get_area (const cairo_rectangle_int_t *rect)
+{
+  return (gsize) rect->width * rect->height;
+}
+
+/*
+ * Turns the clip region into a list of render passes.
+ *
+ * cairo regions are split into bands, so damage like a blinking cursor
+ * next to a spinner ends up as many small rectangles. Each one would
+ * need its own render pass that processes the whole node tree, so
+ * merge them whenever the pixels that are drawn needlessly cost less
+ * than the render pass that is saved.
+ *
+ * The resulting rectangles never overlap.
+ */
+static GArray *
+gsk_gpu_frame_simplify_clip (const cairo_region_t *clip)
+{
+  GArray *rects;
+  gboolean merged;
+  int n, i, j;
+
+  n = cairo_region_num_rectangles (clip);
+  rects = g_array_sized_new (FALSE, FALSE, sizeof (cairo_rectangle_int_t), n);
+
+  if (n > MAX_RENDER_PASSES)
+    {
+      cairo_rectangle_int_t extents;
+
+      cairo_region_get_extents (clip, &extents);
+      g_array_append_val (rects, extents);
+      return rects;
+    }
+
+  for (i = 0; i < n; i++)
+    {
+      cairo_rectangle_int_t rect;
+
+      cairo_region_get_rectangle (clip, i, &rect);
+      g_array_append_val (rects, rect);
+    }
+
+  do
+    {
+      merged = FALSE;
+
+      for (i = 0; i < rects->len; i++)
+        {
+          cairo_rectangle_int_t *a = &g_array_index (rects, cairo_rectangle_int_t, i);
+
+          for (j = i + 1; j < rects->len; j++)
+            {
+              cairo_rectangle_int_t *b = &g_array_index (rects, cairo_rectangle_int_t, j);
+              cairo_rectangle_int_t u;
+
+              gdk_rectangle_union (a, b, &u);
+
+              /* Merged rectangles may overlap others, merge those, too */
+              if (rect_get_area (&u) > rect_get_area (a) + rect_get_area (b) + RENDER_PASS_COST &&
+                  !gdk_rectangle_intersect (a, b, NULL))
+                continue;
+
+              *a = u;
+              g_array_remove_index_fast (rects, j);
+              merged = TRUE;
+              j = i;
+            }
+        }
+    }
+  while (merged);
+
+  return rects;
+}
+
 static void
 gsk_gpu_frame_record (GskGpuFrame            *self,
                       gint64                  timestamp,
@@ -596,15 +877,24 @@ gsk_gpu_frame_record (GskGpuFrame            *self,
 
   if (clip)
     {
-      int i;
+      GArray *rects;
+      guint i;
 
-      for (i = 0; i < cairo_region_num_rectangles (clip); i++)
-        {
-          cairo_rectangle_int_t rect;
+      rects = gsk_gpu_frame_simplify_clip (clip);
+
+      GSK_DEBUG (RENDERER, "Rendering %u rectangles as %u render passes",
+                 cairo_region_num_rectangles (clip), rects->len);
 
-          cairo_region_get_rectangle (clip, i, &rect);
-          gsk_gpu_frame_record_rect (self, target, &rect, node, viewport);
+      for (i = 0; i < rects->len; i++)
+        {
+          gsk_gpu_frame_record_rect (self,
+                                     target,
+                                     &g_array_index (rects, cairo_rectangle_int_t, i),
+                                     node,
+                                     viewport);
         }
+
+      g_array_unref (rects);
     }
   else
     {
@@ -628,11 +918,16 @@ gsk_gpu_frame_submit (GskGpuFrame *self)
 {
   GskGpuFramePrivate *priv = gsk_gpu_frame_get_instance_private (self);
 
+  priv->submit_time = GDK_PROFILER_CURRENT_TIME;
+
   gsk_gpu_frame_seal_ops (self);
   gsk_gpu_frame_verbose_print (self, "start of frame");
   gsk_gpu_frame_sort_ops (self);
   gsk_gpu_frame_verbose_print (self, "after sort");
 
+  if (gsk_gpu_frame_should_optimize (self, GSK_GPU_OPTIMIZE_THREADS))
+    gsk_gpu_upload_cairo_ops_render_parallel (priv->first_op);
+
   if (priv->vertex_buffer)
     {
       gsk_gpu_buffer_unmap (priv->vertex_buffer, priv->vertex_buffer_used);
@@ -647,9 +942,14 @@ gsk_gpu_frame_submit (GskGpuFrame *self)
       priv->storage_buffer_used = 0;
     }
 
+  priv->n_draw_calls = 0;
+
   GSK_GPU_FRAME_GET_CLASS (self)->submit (self,
                                           priv->vertex_buffer,
                                           priv->first_op);
+
+  if (GSK_RENDERER_DEBUG_CHECK (GSK_RENDERER (priv->renderer), VERBOSE))
+    gsk_gpu_frame_print_merge_stats (self);
 }
 
 void
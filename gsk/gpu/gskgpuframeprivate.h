@@ -54,6 +54,9 @@ gint64                  gsk_gpu_frame_get_timestamp                     (GskGpuF
 gboolean                gsk_gpu_frame_should_optimize                   (GskGpuFrame            *self,
                                                                          GskGpuOptimizations     optimization) G_GNUC_PURE;
 
+void                    gsk_gpu_frame_add_draw_calls                    (GskGpuFrame            *self,
+                                                                         gsize                   n_draw_calls);
+
 gpointer                gsk_gpu_frame_alloc_op                          (GskGpuFrame            *self,
                                                                          gsize                   size);
 GskGpuImage *           gsk_gpu_frame_upload_texture                    (GskGpuFrame            *self,
@@ -69,6 +72,13 @@ GskGpuBuffer *          gsk_gpu_frame_write_storage_buffer              (GskGpuF
                                                                          gsize                   size,
                                                                          gsize                  *out_offset);
 
+gboolean                gsk_gpu_frame_should_time_ops                   (GskGpuFrame            *self);
+void                    gsk_gpu_frame_add_timed_op                      (GskGpuFrame            *self,
+                                                                         GskGpuOp               *op);
+gsize                   gsk_gpu_frame_get_n_timed_ops                   (GskGpuFrame            *self);
+void                    gsk_gpu_frame_report_timings                    (GskGpuFrame            *self,
+                                                                         const guint64          *timestamps);
+
 gboolean                gsk_gpu_frame_is_busy                           (GskGpuFrame            *self);
 void                    gsk_gpu_frame_wait                              (GskGpuFrame            *self);
 
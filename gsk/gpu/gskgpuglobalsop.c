@@ -39,6 +39,8 @@ gsk_gpu_globals_op_print (GskGpuOp    *op,
   g_string_append_printf (string, "scale %g %g ", instance->scale[0], instance->scale[1]);
   g_string_append (string, "clip ");
   gsk_gpu_print_rounded_rect (string, instance->clip);
+  if (instance->color_state == GSK_GPU_COLOR_STATE_SRGB_LINEAR)
+    g_string_append (string, "linear ");
   gsk_gpu_print_newline (string);
 }
 
@@ -95,7 +97,8 @@ void
 gsk_gpu_globals_op (GskGpuFrame             *frame,
                     const graphene_vec2_t   *scale,
                     const graphene_matrix_t *mvp,
-                    const GskRoundedRect    *clip)
+                    const GskRoundedRect    *clip,
+                    GskGpuColorState         color_state)
 {
   GskGpuGlobalsOp *self;
 
@@ -104,4 +107,5 @@ gsk_gpu_globals_op (GskGpuFrame             *frame,
   graphene_matrix_to_float (mvp, self->instance.mvp);
   gsk_rounded_rect_to_float (clip, graphene_point_zero (), self->instance.clip);
   graphene_vec2_to_float (scale, self->instance.scale);
+  self->instance.color_state = color_state;
 }
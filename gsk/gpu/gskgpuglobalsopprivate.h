@@ -14,12 +14,14 @@ struct _GskGpuGlobalsInstance
   float mvp[16];
   float clip[12];
   float scale[2];
+  guint32 color_state;
 };
 
 void                    gsk_gpu_globals_op                              (GskGpuFrame                    *frame,
                                                                          const graphene_vec2_t          *scale,
                                                                          const graphene_matrix_t        *mvp,
-                                                                         const GskRoundedRect           *clip);
+                                                                         const GskRoundedRect           *clip,
+                                                                         GskGpuColorState                color_state);
 
 
 G_END_DECLS
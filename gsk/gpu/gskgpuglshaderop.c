@@ -0,0 +1,250 @@
+#include "config.h"
+
+#include "gskgpuglshaderopprivate.h"
+
+#include "gskgpuframeprivate.h"
+#include "gskgpuprintprivate.h"
+#include "gskgldescriptorsprivate.h"
+#include "gskglframeprivate.h"
+#include "gskglshaderprivate.h"
+#include "gskrectprivate.h"
+
+#include "gdkglcontextprivate.h"
+
+#include <string.h>
+
+#include "gpu/shaders/gskgpuglshaderinstance.h"
+
+#define MAX_TEXTURES 4
+
+typedef struct _GskGpuGLShaderOp GskGpuGLShaderOp;
+
+struct _GskGpuGLShaderOp
+{
+  GskGpuShaderOp op;
+
+  GskGLShader *shader;
+  GBytes *args;
+  guint32 tex_ids[MAX_TEXTURES];
+  gsize n_textures;
+};
+
+static void
+gsk_gpu_gl_shader_op_finish (GskGpuOp *op)
+{
+  GskGpuGLShaderOp *self = (GskGpuGLShaderOp *) op;
+
+  g_object_unref (self->shader);
+  g_bytes_unref (self->args);
+
+  gsk_gpu_shader_op_finish (op);
+}
+
+static void
+gsk_gpu_gl_shader_op_print_instance (GskGpuShaderOp *shader,
+                                     gpointer        instance_,
+                                     GString        *string)
+{
+  GskGpuGLShaderOp *self = (GskGpuGLShaderOp *) shader;
+  GskGpuGlshaderInstance *instance = (GskGpuGlshaderInstance *) instance_;
+  gsize i;
+
+  gsk_gpu_print_rect (string, instance->rect);
+  for (i = 0; i < self->n_textures; i++)
+    gsk_gpu_print_image_descriptor (string, shader->desc, self->tex_ids[i]);
+}
+
+static void
+gsk_gpu_gl_shader_op_set_uniforms (GskGpuGLShaderOp *self,
+                                   GLuint            program_id)
+{
+  const GskGLUniform *uniforms;
+  const guchar *args;
+  int i, n_uniforms;
+
+  uniforms = gsk_gl_shader_get_uniforms (self->shader, &n_uniforms);
+  args = g_bytes_get_data (self->args, NULL);
+
+  for (i = 0; i < n_uniforms; i++)
+    {
+      GLint location = glGetUniformLocation (program_id, uniforms[i].name);
+      const guchar *data = args + uniforms[i].offset;
+
+      switch (uniforms[i].type)
+        {
+        default:
+        case GSK_GL_UNIFORM_TYPE_NONE:
+          break;
+        case GSK_GL_UNIFORM_TYPE_FLOAT:
+          glUniform1fv (location, 1, (const float *) data);
+          break;
+        case GSK_GL_UNIFORM_TYPE_INT:
+          glUniform1iv (location, 1, (const gint32 *) data);
+          break;
+        case GSK_GL_UNIFORM_TYPE_UINT:
+        case GSK_GL_UNIFORM_TYPE_BOOL:
+          glUniform1uiv (location, 1, (const guint32 *) data);
+          break;
+        case GSK_GL_UNIFORM_TYPE_VEC2:
+          glUniform2fv (location, 1, (const float *) data);
+          break;
+        case GSK_GL_UNIFORM_TYPE_VEC3:
+          glUniform3fv (location, 1, (const float *) data);
+          break;
+        case GSK_GL_UNIFORM_TYPE_VEC4:
+          glUniform4fv (location, 1, (const float *) data);
+          break;
+        }
+    }
+
+  for (i = 0; i < self->n_textures; i++)
+    {
+      char name[16];
+
+      /* The child images are never external, so their unit is the index */
+      g_snprintf (name, sizeof (name), "u_texture%d", i + 1);
+      glUniform1i (glGetUniformLocation (program_id, name), self->tex_ids[i] >> 1);
+    }
+}
+
+static GskGpuOp *
+gsk_gpu_gl_shader_op_gl_command (GskGpuOp          *op,
+                                 GskGpuFrame       *frame,
+                                 GskGLCommandState *state)
+{
+  GskGpuGLShaderOp *self = (GskGpuGLShaderOp *) op;
+  GskGpuShaderOp *shader = (GskGpuShaderOp *) op;
+  const GskGpuShaderOpClass *shader_op_class = (const GskGpuShaderOpClass *) op->op_class;
+  GskGLDescriptors *desc;
+  GLuint program_id;
+  gsize n_external;
+
+  desc = GSK_GL_DESCRIPTORS (shader->desc);
+  if (desc)
+    n_external = gsk_gl_descriptors_get_n_external (desc);
+  else
+    n_external = 0;
+
+  /* The program belongs to our shader, make the next op pick its own */
+  state->current_program.op_class = NULL;
+
+  program_id = gsk_gl_frame_use_gl_shader_program (GSK_GL_FRAME (frame),
+                                                   shader_op_class,
+                                                   self->shader,
+                                                   shader->clip,
+                                                   n_external);
+  if (program_id == 0)
+    return op->next;
+
+  if (desc != state->desc && desc)
+    {
+      gsk_gl_descriptors_use (desc);
+      state->desc = desc;
+    }
+
+  gsk_gpu_gl_shader_op_set_uniforms (self, program_id);
+
+  if (gdk_gl_context_has_feature (GDK_GL_CONTEXT (gsk_gpu_frame_get_context (frame)),
+                                  GDK_GL_FEATURE_BASE_INSTANCE))
+    {
+      glDrawArraysInstancedBaseInstance (GL_TRIANGLES,
+                                         0,
+                                         6,
+                                         1,
+                                         shader->vertex_offset / shader_op_class->vertex_size);
+    }
+  else
+    {
+      shader_op_class->setup_vao (shader->vertex_offset);
+
+      glDrawArraysInstanced (GL_TRIANGLES,
+                             0,
+                             6,
+                             1);
+    }
+
+  gsk_gpu_frame_add_draw_calls (frame, 1);
+
+  return op->next;
+}
+
+static const GskGpuShaderOpClass GSK_GPU_GL_SHADER_OP_CLASS = {
+  {
+    GSK_GPU_OP_SIZE (GskGpuGLShaderOp),
+    GSK_GPU_STAGE_SHADER,
+    gsk_gpu_gl_shader_op_finish,
+    gsk_gpu_shader_op_print,
+#ifdef GDK_RENDERING_VULKAN
+    gsk_gpu_shader_op_vk_command,
+#endif
+    gsk_gpu_gl_shader_op_gl_command
+  },
+  "gskgpuglshader",
+  sizeof (GskGpuGlshaderInstance),
+#ifdef GDK_RENDERING_VULKAN
+  &gsk_gpu_glshader_info,
+#endif
+  gsk_gpu_gl_shader_op_print_instance,
+  gsk_gpu_glshader_setup_attrib_locations,
+  gsk_gpu_glshader_setup_vao
+};
+
+/*
+ * gsk_gpu_gl_shader_op_is_supported:
+ * @frame: the frame to render in
+ *
+ * Checks if @frame can run the GLSL of a `GskGLShader`.
+ *
+ * Only GL can compile shaders at runtime, other backends
+ * have to use a fallback.
+ *
+ * Returns: `TRUE` if gsk_gpu_gl_shader_op() can be used
+ */
+gboolean
+gsk_gpu_gl_shader_op_is_supported (GskGpuFrame *frame)
+{
+  return GSK_IS_GL_FRAME (frame);
+}
+
+void
+gsk_gpu_gl_shader_op (GskGpuFrame            *frame,
+                      GskGpuShaderClip        clip,
+                      GskGpuDescriptors      *desc,
+                      GskGLShader            *shader,
+                      GBytes                 *args,
+                      const graphene_rect_t  *rect,
+                      const graphene_point_t *offset,
+                      const guint32          *tex_ids,
+                      gsize                   n_textures)
+{
+  GskGpuGLShaderOp *self;
+  GskGpuGlshaderInstance *instance;
+  gsize vertex_offset;
+
+  g_assert (n_textures <= MAX_TEXTURES);
+
+  /* Every op has its own program and uniforms, so unlike
+   * gsk_gpu_shader_op_alloc() this never merges ops.
+   */
+  vertex_offset = gsk_gpu_frame_reserve_vertex_data (frame, sizeof (GskGpuGlshaderInstance));
+
+  self = (GskGpuGLShaderOp *) gsk_gpu_op_alloc (frame, &GSK_GPU_GL_SHADER_OP_CLASS.parent_class);
+
+  self->op.variation = 0;
+  self->op.clip = clip;
+  self->op.vertex_offset = vertex_offset;
+  if (desc)
+    self->op.desc = g_object_ref (desc);
+  else
+    self->op.desc = NULL;
+  self->op.n_ops = 1;
+
+  self->shader = g_object_ref (shader);
+  self->args = g_bytes_ref (args);
+  if (n_textures > 0)
+    memcpy (self->tex_ids, tex_ids, n_textures * sizeof (guint32));
+  self->n_textures = n_textures;
+
+  instance = (GskGpuGlshaderInstance *) gsk_gpu_frame_get_vertex_data (frame, vertex_offset);
+  gsk_gpu_rect_to_float (rect, offset, instance->rect);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "gskgpushaderopprivate.h"
+
+#include "gskglshader.h"
+
+#include <graphene.h>
+
+G_BEGIN_DECLS
+
+gboolean                gsk_gpu_gl_shader_op_is_supported               (GskGpuFrame                    *frame);
+
+void                    gsk_gpu_gl_shader_op                            (GskGpuFrame                    *frame,
+                                                                         GskGpuShaderClip                clip,
+                                                                         GskGpuDescriptors              *desc,
+                                                                         GskGLShader                    *shader,
+                                                                         GBytes                         *args,
+                                                                         const graphene_rect_t          *rect,
+                                                                         const graphene_point_t         *offset,
+                                                                         const guint32                  *tex_ids,
+                                                                         gsize                           n_textures);
+
+
+G_END_DECLS
+
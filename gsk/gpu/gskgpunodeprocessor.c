@@ -14,11 +14,13 @@
 #include "gskgpucolormatrixopprivate.h"
 #include "gskgpucoloropprivate.h"
 #include "gskgpuconicgradientopprivate.h"
+#include "gskgpuconvertopprivate.h"
 #include "gskgpucrossfadeopprivate.h"
 #include "gskgpudescriptorsprivate.h"
 #include "gskgpudeviceprivate.h"
 #include "gskgpuframeprivate.h"
 #include "gskgpuglobalsopprivate.h"
+#include "gskgpuglshaderopprivate.h"
 #include "gskgpuimageprivate.h"
 #include "gskgpulineargradientopprivate.h"
 #include "gskgpumaskopprivate.h"
@@ -34,7 +36,7 @@
 
 #include "gskcairoblurprivate.h"
 #include "gskdebugprivate.h"
-#include "gskpath.h"
+#include "gskpathprivate.h"
 #include "gskrectprivate.h"
 #include "gskrendernodeprivate.h"
 #include "gskroundedrectprivate.h"
@@ -42,6 +44,7 @@
 #include "gsktransformprivate.h"
 #include "gskprivate.h"
 
+#include "gdk/gdkmemorytextureprivate.h"
 #include "gdk/gdkrgbaprivate.h"
 #include "gdk/gdksubsurfaceprivate.h"
 
@@ -118,6 +121,7 @@ struct _GskGpuNodeProcessor
   GskTransform                  *modelview;
   GskGpuClip                     clip;
   float                          opacity;
+  GskGpuColorState               color_state;
 
   GskGpuGlobals                  pending_globals;
 };
@@ -139,6 +143,8 @@ struct _GskGpuPatternWriter
   graphene_point_t               offset;
   graphene_vec2_t                scale;
   guint                          stack;
+  guint                          n_types;
+  guint32                        program;
 
   PatternBuffer                  buffer;
 };
@@ -201,6 +207,7 @@ gsk_gpu_node_processor_init (GskGpuNodeProcessor         *self,
   self->offset = GRAPHENE_POINT_INIT (-viewport->origin.x,
                                       -viewport->origin.y);
   self->opacity = 1.0;
+  self->color_state = GSK_GPU_COLOR_STATE_SRGB;
   self->pending_globals = GSK_GPU_GLOBAL_MATRIX | GSK_GPU_GLOBAL_SCALE | GSK_GPU_GLOBAL_CLIP | GSK_GPU_GLOBAL_SCISSOR | GSK_GPU_GLOBAL_BLEND;
 }
 
@@ -220,7 +227,8 @@ gsk_gpu_node_processor_emit_globals_op (GskGpuNodeProcessor *self)
   gsk_gpu_globals_op (self->frame,
                       &self->scale,
                       &mvp,
-                      &self->clip.rect);
+                      &self->clip.rect,
+                      self->color_state);
 
   self->pending_globals &= ~(GSK_GPU_GLOBAL_MATRIX | GSK_GPU_GLOBAL_SCALE | GSK_GPU_GLOBAL_CLIP);
 }
@@ -381,6 +389,62 @@ gsk_gpu_node_processor_finish_draw (GskGpuNodeProcessor *self,
   gsk_gpu_node_processor_finish (self);
 }
 
+/*
+ * Draws the node into a linear FP16 offscreen and converts the
+ * result to sRGB when drawing it into the target.
+ *
+ * The shaders keep working with sRGB colors, the globals make them
+ * convert their output for the offscreen. So everything that is
+ * blended into it - antialiased edges, opacity, overlapping nodes -
+ * is blended in linear light, and high depth content does not lose
+ * precision in dark colors.
+ */
+static gboolean
+gsk_gpu_node_processor_add_node_linear (GskGpuNodeProcessor *self,
+                                        GskRenderNode       *node)
+{
+  GskGpuNodeProcessor other;
+  GskGpuImage *image;
+  graphene_rect_t bounds;
+  guint32 descriptor;
+
+  graphene_rect_offset_r (&self->clip.rect.bounds,
+                          - self->offset.x,
+                          - self->offset.y,
+                          &bounds);
+  rect_round_to_pixels (&bounds, &self->scale, &self->offset, &bounds);
+
+  image = gsk_gpu_node_processor_init_draw (&other,
+                                            self->frame,
+                                            GDK_MEMORY_FLOAT16,
+                                            &self->scale,
+                                            &bounds);
+  if (image == NULL)
+    return FALSE;
+
+  other.color_state = GSK_GPU_COLOR_STATE_SRGB_LINEAR;
+
+  gsk_gpu_node_processor_add_node (&other, node);
+
+  gsk_gpu_node_processor_finish_draw (&other, image);
+
+  gsk_gpu_node_processor_sync_globals (self, 0);
+
+  descriptor = gsk_gpu_node_processor_add_image (self, image, GSK_GPU_SAMPLER_DEFAULT);
+
+  gsk_gpu_convert_op (self->frame,
+                      gsk_gpu_clip_get_shader_clip (&self->clip, &self->offset, &bounds),
+                      self->desc,
+                      descriptor,
+                      &bounds,
+                      &self->offset,
+                      &bounds);
+
+  g_object_unref (image);
+
+  return TRUE;
+}
+
 void
 gsk_gpu_node_processor_process (GskGpuFrame                 *frame,
                                 GskGpuImage                 *target,
@@ -389,6 +453,7 @@ gsk_gpu_node_processor_process (GskGpuFrame                 *frame,
                                 const graphene_rect_t       *viewport)
 {
   GskGpuNodeProcessor self;
+  GdkMemoryDepth depth;
 
   gsk_gpu_node_processor_init (&self,
                                frame,
@@ -397,7 +462,13 @@ gsk_gpu_node_processor_process (GskGpuFrame                 *frame,
                                clip,
                                viewport);
 
-  gsk_gpu_node_processor_add_node (&self, node);
+  /* Only content that wants float precision is composited in linear
+   * light, everything else keeps blending like it always did. */
+  depth = gsk_render_node_get_preferred_depth (node);
+  if (!gsk_gpu_frame_should_optimize (frame, GSK_GPU_OPTIMIZE_LINEAR) ||
+      (depth != GDK_MEMORY_FLOAT16 && depth != GDK_MEMORY_FLOAT32) ||
+      !gsk_gpu_node_processor_add_node_linear (&self, node))
+    gsk_gpu_node_processor_add_node (&self, node);
 
   gsk_gpu_node_processor_finish (&self);
 }
@@ -418,6 +489,8 @@ gsk_gpu_pattern_writer_init (GskGpuPatternWriter    *self,
   self->offset = *offset;
   self->scale = *scale;
   self->stack = 0;
+  self->n_types = 0;
+  self->program = 0;
 
   pattern_buffer_init (&self->buffer);
 }
@@ -458,6 +531,21 @@ gsk_gpu_pattern_writer_append_uint (GskGpuPatternWriter *self,
   gsk_gpu_pattern_writer_append (self, G_ALIGNOF (guint32), (guchar *) &u, sizeof (guint32));
 }
 
+/* Appends the type of the next pattern step and records it in
+ * the program, so the uber op can pick a specialized shader. */
+static void
+gsk_gpu_pattern_writer_append_type (GskGpuPatternWriter *self,
+                                    guint32              type)
+{
+  if (self->n_types < GSK_GPU_PATTERN_MAX_SPECIALIZED_TYPES)
+    self->program |= type << (GSK_GPU_PATTERN_SPECIALIZED_TYPE_BITS * self->n_types);
+  else
+    self->program = 0;
+  self->n_types++;
+
+  gsk_gpu_pattern_writer_append_uint (self, type);
+}
+
 static void
 gsk_gpu_pattern_writer_append_matrix (GskGpuPatternWriter     *self,
                                       const graphene_matrix_t *matrix)
@@ -792,15 +880,17 @@ gsk_gpu_get_node_as_image (GskGpuFrame            *frame,
                            GskRenderNode          *node,
                            graphene_rect_t        *out_bounds)
 {
+  GskGpuDevice *device;
   GskGpuImage *result;
+  gint64 timestamp;
 
   switch ((guint) gsk_render_node_get_node_type (node))
     {
     case GSK_TEXTURE_NODE:
       {
         GdkTexture *texture = gsk_texture_node_get_texture (node);
-        GskGpuDevice *device = gsk_gpu_frame_get_device (frame);
-        gint64 timestamp = gsk_gpu_frame_get_timestamp (frame);
+        device = gsk_gpu_frame_get_device (frame);
+        timestamp = gsk_gpu_frame_get_timestamp (frame);
         result = gsk_gpu_device_lookup_texture_image (device, texture, timestamp);
         if (result == NULL)
           result = gsk_gpu_frame_upload_texture (frame, FALSE, texture);
@@ -814,14 +904,21 @@ gsk_gpu_get_node_as_image (GskGpuFrame            *frame,
       }
 
     case GSK_CAIRO_NODE:
-      result = gsk_gpu_upload_cairo_op (frame,
-                                        scale,
-                                        clip_bounds,
-                                        (GskGpuCairoFunc) gsk_render_node_draw_fallback,
-                                        gsk_render_node_ref (node),
-                                        (GDestroyNotify) gsk_render_node_unref);
-
-      g_object_ref (result);
+      device = gsk_gpu_frame_get_device (frame);
+      timestamp = gsk_gpu_frame_get_timestamp (frame);
+      result = gsk_gpu_device_lookup_offscreen_image (device, node, scale, clip_bounds, timestamp);
+      if (result == NULL)
+        {
+          result = gsk_gpu_upload_cairo_op (frame,
+                                            scale,
+                                            clip_bounds,
+                                            TRUE,
+                                            (GskGpuCairoFunc) gsk_render_node_draw_fallback,
+                                            gsk_render_node_ref (node),
+                                            (GDestroyNotify) gsk_render_node_unref);
+          gsk_gpu_device_cache_offscreen_image (device, node, scale, clip_bounds, timestamp, result);
+          g_object_ref (result);
+        }
 
       *out_bounds = *clip_bounds;
       return result;
@@ -830,11 +927,24 @@ gsk_gpu_get_node_as_image (GskGpuFrame            *frame,
       break;
     }
 
+  /* Nodes are immutable, so if the same node is offscreened again,
+   * we can reuse the result from last time */
+  device = gsk_gpu_frame_get_device (frame);
+  timestamp = gsk_gpu_frame_get_timestamp (frame);
+  result = gsk_gpu_device_lookup_offscreen_image (device, node, scale, clip_bounds, timestamp);
+  if (result)
+    {
+      *out_bounds = *clip_bounds;
+      return result;
+    }
+
   GSK_DEBUG (FALLBACK, "Offscreening node '%s'", g_type_name_from_instance ((GTypeInstance *) node));
   result = gsk_gpu_node_processor_create_offscreen (frame,
                                                     scale,
                                                     clip_bounds,
                                                     node);
+  if (result)
+    gsk_gpu_device_cache_offscreen_image (device, node, scale, clip_bounds, timestamp, result);
 
   *out_bounds = *clip_bounds;
   return result;
@@ -925,6 +1035,46 @@ gsk_gpu_node_processor_ensure_image (GskGpuFrame      *frame,
   return copy;
 }
 
+/*
+ * gsk_gpu_node_processor_ensure_texture_image:
+ * @frame: the frame
+ * @texture: the texture that @image was created for
+ * @image: (transfer full): the image, usually from the texture cache
+ * @required_flags: flags that the resulting image must have
+ * @disallowed_flags: flags that the resulting image must NOT have
+ *
+ * Like gsk_gpu_node_processor_ensure_image(), but if a new image had to
+ * be created, it replaces the cached image for the texture.
+ *
+ * That way expensive fixups like creating mipmaps for a downscaled
+ * texture only happen once, not every frame. The new image is a
+ * superset of the old one, so all other users can use it, too.
+ *
+ * Returns: (transfer full): the image
+ */
+static GskGpuImage *
+gsk_gpu_node_processor_ensure_texture_image (GskGpuFrame      *frame,
+                                             GdkTexture       *texture,
+                                             GskGpuImage      *image,
+                                             GskGpuImageFlags  required_flags,
+                                             GskGpuImageFlags  disallowed_flags)
+{
+  GskGpuImage *ensure;
+
+  ensure = gsk_gpu_node_processor_ensure_image (frame,
+                                                image,
+                                                required_flags,
+                                                disallowed_flags);
+
+  if (ensure != image)
+    gsk_gpu_device_cache_texture_image (gsk_gpu_frame_get_device (frame),
+                                        texture,
+                                        gsk_gpu_frame_get_timestamp (frame),
+                                        ensure);
+
+  return ensure;
+}
+
 /*
  * gsk_gpu_node_processor_get_node_as_image:
  * @self: a node processor
@@ -991,6 +1141,192 @@ gsk_gpu_node_processor_get_node_as_image (GskGpuNodeProcessor   *self,
   return ensure;
 }
 
+/* Blurs with a larger radius in pixels are done at reduced resolution */
+#define BLUR_DOWNSAMPLE_RADIUS 16.f
+#define MAX_BLUR_DOWNSAMPLE 8
+
+/*
+ * Like gsk_gpu_node_processor_blur_op(), but downsamples the source by
+ * halving it repeatedly, does both blur passes at the reduced resolution
+ * and then draws the result upscaled.
+ *
+ * That reduces both the number of pixels and the number of texture taps
+ * per pixel by @downsample, which matters for large radii where the
+ * Gaussian at full resolution gets very expensive. As the result is
+ * very smooth anyway, the upscaling is not visible.
+ */
+static void
+gsk_gpu_node_processor_blur_op_downsampled (GskGpuNodeProcessor       *self,
+                                            guint                      downsample,
+                                            const graphene_rect_t     *rect,
+                                            const graphene_point_t    *shadow_offset,
+                                            float                      blur_radius,
+                                            const GdkRGBA             *shadow_color,
+                                            GskGpuDescriptors         *source_desc,
+                                            guint32                    source_descriptor,
+                                            GdkMemoryDepth             source_depth,
+                                            const graphene_rect_t     *source_rect)
+{
+  GskGpuNodeProcessor other;
+  GskGpuImage *image, *intermediate;
+  GskGpuDescriptors *desc;
+  guint32 descriptor;
+  graphene_vec2_t direction, scale;
+  graphene_rect_t clip_rect, image_rect, intermediate_rect, result_rect;
+  graphene_point_t real_offset;
+  float clip_radius;
+  guint i;
+
+  clip_radius = gsk_cairo_blur_compute_pixels (blur_radius / 2.0);
+
+  gsk_gpu_node_processor_get_clip_bounds (self, &clip_rect);
+  clip_rect.origin.x -= shadow_offset->x;
+  clip_rect.origin.y -= shadow_offset->y;
+  if (!gsk_rect_intersection (rect, &clip_rect, &result_rect))
+    return;
+  graphene_rect_inset (&clip_rect, 0.f, -clip_radius);
+  if (!gsk_rect_intersection (rect, &clip_rect, &intermediate_rect))
+    return;
+
+  /* downsample the source */
+  image = NULL;
+  desc = source_desc;
+  descriptor = source_descriptor;
+  image_rect = *source_rect;
+  scale = self->scale;
+  for (i = 1; i < downsample; i *= 2)
+    {
+      graphene_rect_t downsampled_rect;
+
+      graphene_vec2_scale (&scale, 0.5f, &scale);
+      rect_round_to_pixels (&image_rect, &scale, &self->offset, &downsampled_rect);
+
+      intermediate = gsk_gpu_node_processor_init_draw (&other,
+                                                       self->frame,
+                                                       source_depth,
+                                                       &scale,
+                                                       &downsampled_rect);
+      if (intermediate == NULL)
+        {
+          g_clear_object (&image);
+          return;
+        }
+
+      gsk_gpu_node_processor_sync_globals (&other, 0);
+
+      if (image)
+        {
+          descriptor = gsk_gpu_node_processor_add_image (&other, image, GSK_GPU_SAMPLER_TRANSPARENT);
+          desc = other.desc;
+        }
+
+      gsk_gpu_texture_op (other.frame,
+                          gsk_gpu_clip_get_shader_clip (&other.clip, &other.offset, &downsampled_rect),
+                          desc,
+                          descriptor,
+                          &downsampled_rect,
+                          &other.offset,
+                          &image_rect);
+
+      gsk_gpu_node_processor_finish_draw (&other, intermediate);
+
+      g_clear_object (&image);
+      image = intermediate;
+      image_rect = downsampled_rect;
+    }
+
+  /* horizontal pass */
+  rect_round_to_pixels (&intermediate_rect, &scale, &self->offset, &intermediate_rect);
+  intermediate = gsk_gpu_node_processor_init_draw (&other,
+                                                   self->frame,
+                                                   source_depth,
+                                                   &scale,
+                                                   &intermediate_rect);
+  if (intermediate == NULL)
+    {
+      g_object_unref (image);
+      return;
+    }
+
+  gsk_gpu_node_processor_sync_globals (&other, 0);
+
+  descriptor = gsk_gpu_node_processor_add_image (&other, image, GSK_GPU_SAMPLER_TRANSPARENT);
+  graphene_vec2_init (&direction, blur_radius, 0.0f);
+  gsk_gpu_blur_op (other.frame,
+                   gsk_gpu_clip_get_shader_clip (&other.clip, &other.offset, &intermediate_rect),
+                   other.desc,
+                   descriptor,
+                   &intermediate_rect,
+                   &other.offset,
+                   &image_rect,
+                   &direction);
+
+  gsk_gpu_node_processor_finish_draw (&other, intermediate);
+
+  g_object_unref (image);
+  image = intermediate;
+  image_rect = intermediate_rect;
+
+  /* vertical pass */
+  rect_round_to_pixels (&result_rect, &scale, &self->offset, &result_rect);
+  intermediate = gsk_gpu_node_processor_init_draw (&other,
+                                                   self->frame,
+                                                   source_depth,
+                                                   &scale,
+                                                   &result_rect);
+  if (intermediate == NULL)
+    {
+      g_object_unref (image);
+      return;
+    }
+
+  gsk_gpu_node_processor_sync_globals (&other, 0);
+
+  descriptor = gsk_gpu_node_processor_add_image (&other, image, GSK_GPU_SAMPLER_TRANSPARENT);
+  graphene_vec2_init (&direction, 0.0f, blur_radius);
+  if (shadow_color)
+    {
+      gsk_gpu_blur_shadow_op (other.frame,
+                              gsk_gpu_clip_get_shader_clip (&other.clip, &other.offset, &result_rect),
+                              other.desc,
+                              descriptor,
+                              &result_rect,
+                              &other.offset,
+                              &image_rect,
+                              &direction,
+                              shadow_color);
+    }
+  else
+    {
+      gsk_gpu_blur_op (other.frame,
+                       gsk_gpu_clip_get_shader_clip (&other.clip, &other.offset, &result_rect),
+                       other.desc,
+                       descriptor,
+                       &result_rect,
+                       &other.offset,
+                       &image_rect,
+                       &direction);
+    }
+
+  gsk_gpu_node_processor_finish_draw (&other, intermediate);
+
+  g_object_unref (image);
+
+  /* upscale the result */
+  real_offset = GRAPHENE_POINT_INIT (self->offset.x + shadow_offset->x,
+                                     self->offset.y + shadow_offset->y);
+  descriptor = gsk_gpu_node_processor_add_image (self, intermediate, GSK_GPU_SAMPLER_TRANSPARENT);
+  gsk_gpu_texture_op (self->frame,
+                      gsk_gpu_clip_get_shader_clip (&self->clip, &real_offset, &result_rect),
+                      self->desc,
+                      descriptor,
+                      &result_rect,
+                      &real_offset,
+                      &result_rect);
+
+  g_object_unref (intermediate);
+}
+
 static void
 gsk_gpu_node_processor_blur_op (GskGpuNodeProcessor       *self,
                                 const graphene_rect_t     *rect,
@@ -1010,6 +1346,32 @@ gsk_gpu_node_processor_blur_op (GskGpuNodeProcessor       *self,
   graphene_point_t real_offset;
   float clip_radius;
 
+  if (gsk_gpu_frame_should_optimize (self->frame, GSK_GPU_OPTIMIZE_BLUR))
+    {
+      float pixel_radius;
+      guint downsample;
+
+      pixel_radius = blur_radius * MAX (graphene_vec2_get_x (&self->scale), graphene_vec2_get_y (&self->scale));
+      downsample = 1;
+      while (pixel_radius > BLUR_DOWNSAMPLE_RADIUS * downsample && downsample < MAX_BLUR_DOWNSAMPLE)
+        downsample *= 2;
+
+      if (downsample > 1)
+        {
+          gsk_gpu_node_processor_blur_op_downsampled (self,
+                                                      downsample,
+                                                      rect,
+                                                      shadow_offset,
+                                                      blur_radius,
+                                                      shadow_color,
+                                                      source_desc,
+                                                      source_descriptor,
+                                                      source_depth,
+                                                      source_rect);
+          return;
+        }
+    }
+
   clip_radius = gsk_cairo_blur_compute_pixels (blur_radius / 2.0);
 
   /* FIXME: Handle clip radius growing the clip too much */
@@ -1077,8 +1439,10 @@ static void
 gsk_gpu_node_processor_add_fallback_node (GskGpuNodeProcessor *self,
                                           GskRenderNode       *node)
 {
+  GskGpuDevice *device;
   GskGpuImage *image;
   graphene_rect_t clipped_bounds;
+  gint64 timestamp;
 
   if (!gsk_gpu_node_processor_clip_node_bounds (self, node, &clipped_bounds))
     return;
@@ -1087,17 +1451,30 @@ gsk_gpu_node_processor_add_fallback_node (GskGpuNodeProcessor *self,
 
   gsk_gpu_node_processor_sync_globals (self, 0);
 
-  image = gsk_gpu_upload_cairo_op (self->frame,
-                                   &self->scale,
-                                   &clipped_bounds,
-                                   (GskGpuCairoFunc) gsk_render_node_draw_fallback,
-                                   gsk_render_node_ref (node),
-                                   (GDestroyNotify) gsk_render_node_unref);
+  /* Fallbacks are slow, so keep the result around in case the
+   * node gets drawn again in the next frames */
+  device = gsk_gpu_frame_get_device (self->frame);
+  timestamp = gsk_gpu_frame_get_timestamp (self->frame);
+  image = gsk_gpu_device_lookup_offscreen_image (device, node, &self->scale, &clipped_bounds, timestamp);
+  if (image == NULL)
+    {
+      image = gsk_gpu_upload_cairo_op (self->frame,
+                                       &self->scale,
+                                       &clipped_bounds,
+                                       FALSE,
+                                       (GskGpuCairoFunc) gsk_render_node_draw_fallback,
+                                       gsk_render_node_ref (node),
+                                       (GDestroyNotify) gsk_render_node_unref);
+      gsk_gpu_device_cache_offscreen_image (device, node, &self->scale, &clipped_bounds, timestamp, image);
+      g_object_ref (image);
+    }
 
   gsk_gpu_node_processor_image_op (self,
                                    image,
                                    &node->bounds,
                                    &clipped_bounds);
+
+  g_object_unref (image);
 }
 
 static gboolean
@@ -1187,9 +1564,19 @@ gsk_gpu_node_processor_ubershader_instead_of_offscreen (GskGpuNodeProcessor *sel
     }
 }
 
+/*
+ * gsk_gpu_node_processor_try_node_as_pattern_in_rect:
+ * @self: the node processor
+ * @node: the node to draw
+ * @rect: the area to draw. This may be larger than the node's
+ *   bounds for nodes that do their own antialiasing at the edges.
+ *
+ * Returns: %FALSE if @node could not be turned into a pattern
+ */
 static gboolean
-gsk_gpu_node_processor_try_node_as_pattern (GskGpuNodeProcessor *self,
-                                            GskRenderNode       *node)
+gsk_gpu_node_processor_try_node_as_pattern_in_rect (GskGpuNodeProcessor   *self,
+                                                    GskRenderNode         *node,
+                                                    const graphene_rect_t *rect)
 {
   GskGpuPatternWriter writer;
   graphene_rect_t clipped;
@@ -1216,7 +1603,7 @@ gsk_gpu_node_processor_try_node_as_pattern (GskGpuNodeProcessor *self,
 
   if (self->opacity < 1.0)
     {
-      gsk_gpu_pattern_writer_append_uint (&writer, GSK_GPU_PATTERN_OPACITY);
+      gsk_gpu_pattern_writer_append_type (&writer, GSK_GPU_PATTERN_OPACITY);
       gsk_gpu_pattern_writer_append_float (&writer, self->opacity);
     }
 
@@ -1242,16 +1629,24 @@ gsk_gpu_node_processor_try_node_as_pattern (GskGpuNodeProcessor *self,
   pattern_id = (pattern_id << 22) | (offset / sizeof (float));
 
   gsk_gpu_uber_op (self->frame,
-                   gsk_gpu_clip_get_shader_clip (&self->clip, &self->offset, &node->bounds),
-                   &node->bounds,
+                   gsk_gpu_clip_get_shader_clip (&self->clip, &self->offset, rect),
+                   rect,
                    &self->offset,
                    writer.desc ? writer.desc : self->desc,
+                   gsk_gpu_frame_should_optimize (self->frame, GSK_GPU_OPTIMIZE_SPECIALIZE) ? writer.program : 0,
                    pattern_id);
 
   gsk_gpu_pattern_writer_finish (&writer);
 
   return TRUE;
 }
+
+static gboolean
+gsk_gpu_node_processor_try_node_as_pattern (GskGpuNodeProcessor *self,
+                                            GskRenderNode       *node)
+{
+  return gsk_gpu_node_processor_try_node_as_pattern_in_rect (self, node, &node->bounds);
+}
  
 static void
 gsk_gpu_node_processor_add_without_opacity (GskGpuNodeProcessor *self,
@@ -1420,7 +1815,7 @@ gsk_gpu_node_processor_create_clip_pattern (GskGpuPatternWriter *self,
   if (!gsk_gpu_node_processor_create_node_pattern (self, gsk_opacity_node_get_child (node)))
     return FALSE;
 
-  gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_CLIP);
+  gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_CLIP);
   gsk_gpu_pattern_writer_append_rect (self,
                                      gsk_clip_node_get_clip (node),
                                      &self->offset);
@@ -1498,6 +1893,12 @@ gsk_gpu_node_processor_add_rounded_clip_node (GskGpuNodeProcessor *self,
   child = gsk_rounded_clip_node_get_child (node);
   original_clip = gsk_rounded_clip_node_get_clip (node);
 
+  if (gsk_rounded_clip_node_get_shape (node) & GSK_ROUNDED_RECT_SHAPE_RECTILINEAR)
+    {
+      gsk_gpu_node_processor_add_node_clipped (self, child, &original_clip->bounds);
+      return;
+    }
+
   /* Common case for entries etc: rounded solid color background.
    * And we have a shader for that */
   if (gsk_render_node_get_node_type (child) == GSK_COLOR_NODE &&
@@ -1727,7 +2128,7 @@ gsk_gpu_node_processor_create_transform_pattern (GskGpuPatternWriter *self,
         gsk_transform_to_affine (transform, &sx, &sy, &dx, &dy);
         inv_sx = 1.f / sx;
         inv_sy = 1.f / sy;
-        gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_AFFINE);
+        gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_AFFINE);
         graphene_vec4_init (&vec4, self->offset.x + dx, self->offset.y + dy, inv_sx, inv_sy);
         gsk_gpu_pattern_writer_append_vec4 (self, &vec4);
         self->bounds.origin.x = (self->bounds.origin.x - self->offset.x - dx) * inv_sx;
@@ -1755,7 +2156,7 @@ gsk_gpu_node_processor_create_transform_pattern (GskGpuPatternWriter *self,
   result = gsk_gpu_node_processor_create_node_pattern (self, child);
 
   if (result)
-    gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_POSITION_POP);
+    gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_POSITION_POP);
 
   gsk_gpu_pattern_writer_pop_stack (self);
   self->scale = old_scale; 
@@ -1793,6 +2194,7 @@ gsk_gpu_node_processor_add_color_node (GskGpuNodeProcessor *self,
   gsk_rect_intersection (&self->clip.rect.bounds, &rect, &clipped);
 
   if (gsk_gpu_frame_should_optimize (self->frame, GSK_GPU_OPTIMIZE_CLEAR) &&
+      self->color_state == GSK_GPU_COLOR_STATE_SRGB &&
       gdk_rgba_is_opaque (color) &&
       self->opacity >= 1.0 &&
       node->bounds.size.width * node->bounds.size.height > 100 * 100 && /* not worth the effort for small images */
@@ -1893,7 +2295,7 @@ static gboolean
 gsk_gpu_node_processor_create_color_pattern (GskGpuPatternWriter *self,
                                              GskRenderNode       *node)
 {
-  gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_COLOR);
+  gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_COLOR);
   gsk_gpu_pattern_writer_append_rgba (self, gsk_color_node_get_color (node));
 
   return TRUE;
@@ -1919,6 +2321,51 @@ gsk_gpu_node_processor_add_border_node (GskGpuNodeProcessor *self,
                      colors);
 }
 
+/* Textures from a resource atlas are drawn from the image of their
+ * atlas page, so they all share a single upload.
+ */
+static gboolean
+gsk_gpu_node_processor_add_atlas_texture_node (GskGpuNodeProcessor *self,
+                                               GskRenderNode       *node,
+                                               GdkTexture          *texture)
+{
+  GskGpuImage *image;
+  GdkTexture *atlas;
+  graphene_rect_t tex_rect;
+  float scale_x, scale_y;
+  int x, y;
+
+  if (!GDK_IS_MEMORY_TEXTURE (texture))
+    return FALSE;
+
+  atlas = gdk_memory_texture_get_atlas (GDK_MEMORY_TEXTURE (texture), &x, &y);
+  if (atlas == NULL)
+    return FALSE;
+
+  image = gsk_gpu_device_lookup_texture_image (gsk_gpu_frame_get_device (self->frame),
+                                               atlas,
+                                               gsk_gpu_frame_get_timestamp (self->frame));
+  if (image == NULL)
+    {
+      image = gsk_gpu_frame_upload_texture (self->frame, FALSE, atlas);
+      if (image == NULL)
+        return FALSE;
+    }
+
+  scale_x = node->bounds.size.width / gdk_texture_get_width (texture);
+  scale_y = node->bounds.size.height / gdk_texture_get_height (texture);
+  tex_rect = GRAPHENE_RECT_INIT (node->bounds.origin.x - x * scale_x,
+                                 node->bounds.origin.y - y * scale_y,
+                                 gdk_texture_get_width (atlas) * scale_x,
+                                 gdk_texture_get_height (atlas) * scale_y);
+
+  gsk_gpu_node_processor_image_op (self, image, &node->bounds, &tex_rect);
+
+  g_object_unref (image);
+
+  return TRUE;
+}
+
 static void
 gsk_gpu_node_processor_add_texture_node (GskGpuNodeProcessor *self,
                                          GskRenderNode       *node)
@@ -1927,11 +2374,20 @@ gsk_gpu_node_processor_add_texture_node (GskGpuNodeProcessor *self,
   GskGpuImage *image;
   GdkTexture *texture;
   gint64 timestamp;
+  gboolean mipmap;
 
   device = gsk_gpu_frame_get_device (self->frame);
   texture = gsk_texture_node_get_texture (node);
   timestamp = gsk_gpu_frame_get_timestamp (self->frame);
 
+  mipmap = gsk_gpu_frame_should_optimize (self->frame, GSK_GPU_OPTIMIZE_MIPMAP) &&
+           (gdk_texture_get_width (texture) > 2 * node->bounds.size.width * graphene_vec2_get_x (&self->scale) ||
+            gdk_texture_get_height (texture) > 2 * node->bounds.size.height * graphene_vec2_get_y (&self->scale));
+
+  /* Mipmaps of the page would bleed between the entries */
+  if (!mipmap && gsk_gpu_node_processor_add_atlas_texture_node (self, node, texture))
+    return;
+
   image = gsk_gpu_device_lookup_texture_image (device, texture, timestamp);
   if (image == NULL)
     {
@@ -1947,16 +2403,15 @@ gsk_gpu_node_processor_add_texture_node (GskGpuNodeProcessor *self,
         }
     }
 
-  if (gsk_gpu_frame_should_optimize (self->frame, GSK_GPU_OPTIMIZE_MIPMAP) &&
-      (gdk_texture_get_width (texture) > 2 * node->bounds.size.width * graphene_vec2_get_x (&self->scale) ||
-       gdk_texture_get_height (texture) > 2 * node->bounds.size.height * graphene_vec2_get_y (&self->scale)))
+  if (mipmap)
     {
       guint32 descriptor;
 
-      image = gsk_gpu_node_processor_ensure_image (self->frame,
-                                                   image,
-                                                   GSK_GPU_IMAGE_MIPMAP,
-                                                   GSK_GPU_IMAGE_STRAIGHT_ALPHA);
+      image = gsk_gpu_node_processor_ensure_texture_image (self->frame,
+                                                           texture,
+                                                           image,
+                                                           GSK_GPU_IMAGE_MIPMAP,
+                                                           GSK_GPU_IMAGE_STRAIGHT_ALPHA);
       descriptor = gsk_gpu_node_processor_add_image (self, image, GSK_GPU_SAMPLER_MIPMAP_DEFAULT);
       if (self->opacity < 1.0)
         {
@@ -2018,10 +2473,11 @@ gsk_gpu_node_processor_create_texture_pattern (GskGpuPatternWriter *self,
       (gdk_texture_get_width (texture) > 2 * node->bounds.size.width * graphene_vec2_get_x (&self->scale) ||
        gdk_texture_get_height (texture) > 2 * node->bounds.size.height * graphene_vec2_get_y (&self->scale)))
     {
-      image = gsk_gpu_node_processor_ensure_image (self->frame,
-                                                   image,
-                                                   GSK_GPU_IMAGE_MIPMAP,
-                                                   GSK_GPU_IMAGE_STRAIGHT_ALPHA);
+      image = gsk_gpu_node_processor_ensure_texture_image (self->frame,
+                                                           texture,
+                                                           image,
+                                                           GSK_GPU_IMAGE_MIPMAP,
+                                                           GSK_GPU_IMAGE_STRAIGHT_ALPHA);
       sampler = GSK_GPU_SAMPLER_MIPMAP_DEFAULT;
     }
   else
@@ -2036,9 +2492,9 @@ gsk_gpu_node_processor_create_texture_pattern (GskGpuPatternWriter *self,
     }
 
   if (gsk_gpu_image_get_flags (image) & GSK_GPU_IMAGE_STRAIGHT_ALPHA)
-    gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_STRAIGHT_ALPHA);
+    gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_STRAIGHT_ALPHA);
   else
-    gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_TEXTURE);
+    gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_TEXTURE);
   gsk_gpu_pattern_writer_append_uint (self, descriptor);
   gsk_gpu_pattern_writer_append_rect (self, &node->bounds, &self->offset);
 
@@ -2114,10 +2570,11 @@ gsk_gpu_node_processor_add_texture_scale_node (GskGpuNodeProcessor *self,
         }
     }
 
-  image = gsk_gpu_node_processor_ensure_image (self->frame,
-                                               image,
-                                               need_mipmap ? (GSK_GPU_IMAGE_CAN_MIPMAP | GSK_GPU_IMAGE_MIPMAP) : 0,
-                                               GSK_GPU_IMAGE_STRAIGHT_ALPHA);
+  image = gsk_gpu_node_processor_ensure_texture_image (self->frame,
+                                                       texture,
+                                                       image,
+                                                       need_mipmap ? (GSK_GPU_IMAGE_CAN_MIPMAP | GSK_GPU_IMAGE_MIPMAP) : 0,
+                                                       GSK_GPU_IMAGE_STRAIGHT_ALPHA);
 
   switch (scaling_filter)
     {
@@ -2371,9 +2828,9 @@ gsk_gpu_node_processor_create_linear_gradient_pattern (GskGpuPatternWriter *self
                                                        GskRenderNode       *node)
 {
   if (gsk_render_node_get_node_type (node) == GSK_REPEATING_LINEAR_GRADIENT_NODE)
-    gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_REPEATING_LINEAR_GRADIENT);
+    gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_REPEATING_LINEAR_GRADIENT);
   else
-    gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_LINEAR_GRADIENT);
+    gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_LINEAR_GRADIENT);
 
   gsk_gpu_pattern_writer_append_point (self,
                                       gsk_linear_gradient_node_get_start (node),
@@ -2426,9 +2883,9 @@ gsk_gpu_node_processor_create_radial_gradient_pattern (GskGpuPatternWriter *self
                                                        GskRenderNode       *node)
 {
   if (gsk_render_node_get_node_type (node) == GSK_REPEATING_RADIAL_GRADIENT_NODE)
-    gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_REPEATING_RADIAL_GRADIENT);
+    gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_REPEATING_RADIAL_GRADIENT);
   else
-    gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_RADIAL_GRADIENT);
+    gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_RADIAL_GRADIENT);
 
   gsk_gpu_pattern_writer_append_point (self,
                                       gsk_radial_gradient_node_get_center (node),
@@ -2475,7 +2932,7 @@ static gboolean
 gsk_gpu_node_processor_create_conic_gradient_pattern (GskGpuPatternWriter *self,
                                                       GskRenderNode       *node)
 {
-  gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_CONIC_GRADIENT);
+  gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_CONIC_GRADIENT);
   gsk_gpu_pattern_writer_append_point (self,
                                       gsk_conic_gradient_node_get_center (node),
                                       &self->offset);
@@ -2688,11 +3145,11 @@ gsk_gpu_node_processor_create_blend_pattern (GskGpuPatternWriter *self,
     return FALSE;
   if (!gsk_rect_contains_rect (&bottom_child->bounds, &node->bounds))
     {
-      gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_CLIP);
+      gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_CLIP);
       gsk_gpu_pattern_writer_append_rect (self, &bottom_child->bounds, &self->offset);
     }
 
-  gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_PUSH_COLOR);
+  gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_PUSH_COLOR);
 
   if (!gsk_gpu_pattern_writer_push_stack (self))
     return FALSE;
@@ -2704,11 +3161,11 @@ gsk_gpu_node_processor_create_blend_pattern (GskGpuPatternWriter *self,
     }
   if (!gsk_rect_contains_rect (&top_child->bounds, &node->bounds))
     {
-      gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_CLIP);
+      gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_CLIP);
       gsk_gpu_pattern_writer_append_rect (self, &top_child->bounds, &self->offset);
     }
 
-  gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_BLEND_DEFAULT + gsk_blend_node_get_blend_mode (node));
+  gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_BLEND_DEFAULT + gsk_blend_node_get_blend_mode (node));
 
   gsk_gpu_pattern_writer_pop_stack (self);
 
@@ -2810,11 +3267,11 @@ gsk_gpu_node_processor_create_cross_fade_pattern (GskGpuPatternWriter *self,
     return FALSE;
   if (!gsk_rect_contains_rect (&start_child->bounds, &node->bounds))
     {
-      gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_CLIP);
+      gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_CLIP);
       gsk_gpu_pattern_writer_append_rect (self, &start_child->bounds, &self->offset);
     }
 
-  gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_PUSH_COLOR);
+  gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_PUSH_COLOR);
 
   if (!gsk_gpu_pattern_writer_push_stack (self))
     return FALSE;
@@ -2826,11 +3283,11 @@ gsk_gpu_node_processor_create_cross_fade_pattern (GskGpuPatternWriter *self,
     }
   if (!gsk_rect_contains_rect (&end_child->bounds, &node->bounds))
     {
-      gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_CLIP);
+      gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_CLIP);
       gsk_gpu_pattern_writer_append_rect (self, &end_child->bounds, &self->offset);
     }
 
-  gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_POP_CROSS_FADE);
+  gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_POP_CROSS_FADE);
   gsk_gpu_pattern_writer_append_float (self, gsk_cross_fade_node_get_progress (node));
 
   gsk_gpu_pattern_writer_pop_stack (self);
@@ -2941,11 +3398,11 @@ gsk_gpu_node_processor_create_mask_pattern (GskGpuPatternWriter *self,
     return FALSE;
   if (!gsk_rect_contains_rect (&source_child->bounds, &node->bounds))
     {
-      gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_CLIP);
+      gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_CLIP);
       gsk_gpu_pattern_writer_append_rect (self, &source_child->bounds, &self->offset);
     }
 
-  gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_PUSH_COLOR);
+  gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_PUSH_COLOR);
 
   if (!gsk_gpu_pattern_writer_push_stack (self))
     return FALSE;
@@ -2957,26 +3414,26 @@ gsk_gpu_node_processor_create_mask_pattern (GskGpuPatternWriter *self,
     }
   if (!gsk_rect_contains_rect (&mask_child->bounds, &node->bounds))
     {
-      gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_CLIP);
+      gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_CLIP);
       gsk_gpu_pattern_writer_append_rect (self, &mask_child->bounds, &self->offset);
     }
 
   switch (gsk_mask_node_get_mask_mode (node))
   {
     case GSK_MASK_MODE_ALPHA:
-      gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_POP_MASK_ALPHA);
+      gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_POP_MASK_ALPHA);
       break;
 
     case GSK_MASK_MODE_INVERTED_ALPHA:
-      gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_POP_MASK_INVERTED_ALPHA);
+      gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_POP_MASK_INVERTED_ALPHA);
       break;
 
     case GSK_MASK_MODE_LUMINANCE:
-      gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_POP_MASK_LUMINANCE);
+      gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_POP_MASK_LUMINANCE);
       break;
 
     case GSK_MASK_MODE_INVERTED_LUMINANCE:
-      gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_POP_MASK_INVERTED_LUMINANCE);
+      gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_POP_MASK_INVERTED_LUMINANCE);
       break;
 
     default:
@@ -2999,6 +3456,7 @@ gsk_gpu_node_processor_add_glyph_node (GskGpuNodeProcessor *self,
   graphene_point_t offset;
   guint i, num_glyphs;
   float scale, inv_scale;
+  float sdf_scale, inv_sdf_scale;
   GdkRGBA color;
   float align_scale_x, align_scale_y;
   float inv_align_scale_x, inv_align_scale_y;
@@ -3043,6 +3501,26 @@ gsk_gpu_node_processor_add_glyph_node (GskGpuNodeProcessor *self,
   inv_align_scale_x = 1 / align_scale_x;
   inv_align_scale_y = 1 / align_scale_y;
 
+  /* Large glyphs are rendered once at a fixed size as distance fields,
+   * so zooming or animated scales don't rasterize them again */
+  sdf_scale = 0;
+  inv_sdf_scale = 0;
+  if (gsk_gpu_frame_should_optimize (self->frame, GSK_GPU_OPTIMIZE_SDF))
+    {
+      PangoFontDescription *desc;
+      float font_size;
+
+      desc = pango_font_describe_with_absolute_size (font);
+      font_size = (float) pango_font_description_get_size (desc) / PANGO_SCALE;
+      pango_font_description_free (desc);
+
+      if (font_size > 0 && font_size * scale >= GSK_GPU_SDF_GLYPH_SIZE)
+        {
+          sdf_scale = GSK_GPU_SDF_GLYPH_SIZE / font_size;
+          inv_sdf_scale = 1.f / sdf_scale;
+        }
+    }
+
   last_image = NULL;
   descriptor = 0;
   for (i = 0; i < num_glyphs; i++)
@@ -3051,35 +3529,50 @@ gsk_gpu_node_processor_add_glyph_node (GskGpuNodeProcessor *self,
       graphene_rect_t glyph_bounds, glyph_tex_rect;
       graphene_point_t glyph_offset, glyph_origin;
       GskGpuGlyphLookupFlags flags;
+      float glyph_scale, inv_glyph_scale;
+      gboolean sdf;
 
       glyph_origin = GRAPHENE_POINT_INIT (offset.x + glyphs[i].geometry.x_offset * inv_pango_scale,
                                           offset.y + glyphs[i].geometry.y_offset * inv_pango_scale);
 
-      glyph_origin.x = floorf (glyph_origin.x * align_scale_x + 0.5f);
-      glyph_origin.y = floorf (glyph_origin.y * align_scale_y + 0.5f);
-      flags = (((int) glyph_origin.x & 3) | (((int) glyph_origin.y & 3) << 2)) & flags_mask;
-      glyph_origin.x *= inv_align_scale_x;
-      glyph_origin.y *= inv_align_scale_y;
+      sdf = sdf_scale > 0 && !glyphs[i].attr.is_color;
+      if (sdf)
+        {
+          /* distance fields scale, so no need for subpixel positions */
+          flags = GSK_GPU_GLYPH_SDF;
+          glyph_scale = sdf_scale;
+          inv_glyph_scale = inv_sdf_scale;
+        }
+      else
+        {
+          glyph_origin.x = floorf (glyph_origin.x * align_scale_x + 0.5f);
+          glyph_origin.y = floorf (glyph_origin.y * align_scale_y + 0.5f);
+          flags = (((int) glyph_origin.x & 3) | (((int) glyph_origin.y & 3) << 2)) & flags_mask;
+          glyph_origin.x *= inv_align_scale_x;
+          glyph_origin.y *= inv_align_scale_y;
+          glyph_scale = scale;
+          inv_glyph_scale = inv_scale;
+        }
 
       image = gsk_gpu_device_lookup_glyph_image (device,
                                                  self->frame,
                                                  font,
                                                  glyphs[i].glyph,
                                                  flags,
-                                                 scale,
+                                                 glyph_scale,
                                                  &glyph_bounds,
                                                  &glyph_offset);
 
-      glyph_tex_rect = GRAPHENE_RECT_INIT (-glyph_bounds.origin.x * inv_scale,
-                                           -glyph_bounds.origin.y * inv_scale,
-                                           gsk_gpu_image_get_width (image) * inv_scale,
-                                           gsk_gpu_image_get_height (image) * inv_scale);
+      glyph_tex_rect = GRAPHENE_RECT_INIT (-glyph_bounds.origin.x * inv_glyph_scale,
+                                           -glyph_bounds.origin.y * inv_glyph_scale,
+                                           gsk_gpu_image_get_width (image) * inv_glyph_scale,
+                                           gsk_gpu_image_get_height (image) * inv_glyph_scale);
       glyph_bounds = GRAPHENE_RECT_INIT (0,
                                          0,
-                                         glyph_bounds.size.width * inv_scale,
-                                         glyph_bounds.size.height * inv_scale);
-      glyph_origin = GRAPHENE_POINT_INIT (glyph_origin.x - glyph_offset.x * inv_scale,
-                                          glyph_origin.y - glyph_offset.y * inv_scale);
+                                         glyph_bounds.size.width * inv_glyph_scale,
+                                         glyph_bounds.size.height * inv_glyph_scale);
+      glyph_origin = GRAPHENE_POINT_INIT (glyph_origin.x - glyph_offset.x * inv_glyph_scale,
+                                          glyph_origin.y - glyph_offset.y * inv_glyph_scale);
 
       if (image != last_image)
         {
@@ -3095,6 +3588,15 @@ gsk_gpu_node_processor_add_glyph_node (GskGpuNodeProcessor *self,
                             &glyph_bounds,
                             &glyph_origin,
                             &glyph_tex_rect);
+      else if (sdf)
+        gsk_gpu_colorize_sdf_op (self->frame,
+                                 gsk_gpu_clip_get_shader_clip (&self->clip, &glyph_offset, &glyph_bounds),
+                                 self->desc,
+                                 descriptor,
+                                 &glyph_bounds,
+                                 &glyph_origin,
+                                 &glyph_tex_rect,
+                                 &color);
       else
         gsk_gpu_colorize_op (self->frame,
                              gsk_gpu_clip_get_shader_clip (&self->clip, &glyph_offset, &glyph_bounds),
@@ -3141,7 +3643,7 @@ gsk_gpu_node_processor_create_glyph_pattern (GskGpuPatternWriter *self,
   scale = MAX (graphene_vec2_get_x (&self->scale), graphene_vec2_get_y (&self->scale));
   inv_scale = 1.f / scale;
 
-  gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_GLYPHS);
+  gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_GLYPHS);
   gsk_gpu_pattern_writer_append_rgba (self, gsk_text_node_get_color (node));
   gsk_gpu_pattern_writer_append_uint (self, num_glyphs);
 
@@ -3228,7 +3730,7 @@ gsk_gpu_node_processor_create_opacity_pattern (GskGpuPatternWriter *self,
   if (!gsk_gpu_node_processor_create_node_pattern (self, gsk_opacity_node_get_child (node)))
     return FALSE;
 
-  gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_OPACITY);
+  gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_OPACITY);
   gsk_gpu_pattern_writer_append_float (self, gsk_opacity_node_get_opacity (node));
 
   return TRUE;
@@ -3296,7 +3798,7 @@ gsk_gpu_node_processor_create_color_matrix_pattern (GskGpuPatternWriter *self,
   if (!gsk_gpu_node_processor_create_node_pattern (self, gsk_color_matrix_node_get_child (node)))
     return FALSE;
 
-  gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_COLOR_MATRIX);
+  gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_COLOR_MATRIX);
   gsk_gpu_pattern_writer_append_matrix (self, gsk_color_matrix_node_get_color_matrix (node));
   gsk_gpu_pattern_writer_append_vec4 (self, gsk_color_matrix_node_get_color_offset (node));
 
@@ -3489,7 +3991,7 @@ gsk_gpu_node_processor_create_repeat_pattern (GskGpuPatternWriter *self,
 
   if (gsk_rect_is_empty (child_bounds))
     {
-      gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_COLOR);
+      gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_COLOR);
       gsk_gpu_pattern_writer_append_rgba (self, &GDK_RGBA_TRANSPARENT);
       return TRUE;
     }
@@ -3500,7 +4002,7 @@ gsk_gpu_node_processor_create_repeat_pattern (GskGpuPatternWriter *self,
   if (!gsk_gpu_pattern_writer_push_stack (self))
     return FALSE;
 
-  gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_REPEAT_PUSH);
+  gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_REPEAT_PUSH);
   gsk_gpu_pattern_writer_append_rect (self, child_bounds, &self->offset);
 
   old_bounds = self->bounds;
@@ -3518,16 +4020,907 @@ gsk_gpu_node_processor_create_repeat_pattern (GskGpuPatternWriter *self,
 
   if (!gsk_rect_contains_rect (&child->bounds, child_bounds))
     {
-      gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_CLIP);
+      gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_CLIP);
       gsk_gpu_pattern_writer_append_rect (self, &child->bounds, &self->offset);
     }
 
-  gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_POSITION_POP);
+  gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_POSITION_POP);
   gsk_gpu_pattern_writer_pop_stack (self);
 
   return TRUE;
 }
 
+/* Paths with more lines than this get rasterized with cairo, because
+ * the shaders look at every line for every pixel.
+ */
+#define GSK_GPU_PATH_MAX_LINES 128
+
+typedef struct _GskGpuPathLines GskGpuPathLines;
+struct _GskGpuPathLines
+{
+  gboolean close_contours;
+  graphene_point_t start;
+  graphene_point_t current;
+  gsize n_lines;
+  graphene_point_t points[2 * GSK_GPU_PATH_MAX_LINES];
+};
+
+static gboolean
+gsk_gpu_path_lines_add_line (GskGpuPathLines        *self,
+                             const graphene_point_t *to)
+{
+  if (self->n_lines >= GSK_GPU_PATH_MAX_LINES)
+    return FALSE;
+
+  self->points[2 * self->n_lines] = self->current;
+  self->points[2 * self->n_lines + 1] = *to;
+  self->n_lines++;
+  self->current = *to;
+
+  return TRUE;
+}
+
+static gboolean
+gsk_gpu_path_lines_close_contour (GskGpuPathLines *self)
+{
+  if (graphene_point_equal (&self->current, &self->start))
+    return TRUE;
+
+  return gsk_gpu_path_lines_add_line (self, &self->start);
+}
+
+static gboolean
+gsk_gpu_path_lines_foreach (GskPathOperation        op,
+                            const graphene_point_t *pts,
+                            gsize                   n_pts,
+                            float                   weight,
+                            gpointer                user_data)
+{
+  GskGpuPathLines *self = user_data;
+
+  switch (op)
+    {
+    case GSK_PATH_MOVE:
+      if (self->close_contours &&
+          !gsk_gpu_path_lines_close_contour (self))
+        return FALSE;
+      self->start = pts[0];
+      self->current = pts[0];
+      return TRUE;
+
+    case GSK_PATH_CLOSE:
+      /* Not using close_contour() here, we want the zero-length
+       * line for round caps on degenerate strokes */
+      return gsk_gpu_path_lines_add_line (self, &self->start);
+
+    case GSK_PATH_LINE:
+      return gsk_gpu_path_lines_add_line (self, &pts[1]);
+
+    case GSK_PATH_QUAD:
+    case GSK_PATH_CUBIC:
+    case GSK_PATH_CONIC:
+    default:
+      g_assert_not_reached ();
+      return FALSE;
+    }
+}
+
+/*
+ * gsk_gpu_path_lines_init:
+ * @self: the lines to initialize
+ * @path: the path to flatten
+ * @close_contours: %TRUE to add a line to the start of every
+ *   contour that isn't closed, as is needed for filling
+ * @scale: the scale the path will be drawn at
+ *
+ * Flattens the path into lines so it can be drawn by the
+ * shaders directly instead of uploading a cairo rendering.
+ *
+ * Returns: %FALSE if the path needs too many lines
+ */
+static gboolean
+gsk_gpu_path_lines_init (GskGpuPathLines       *self,
+                         GskPath               *path,
+                         gboolean               close_contours,
+                         const graphene_vec2_t *scale)
+{
+  float max_scale;
+
+  self->close_contours = close_contours;
+  self->start = GRAPHENE_POINT_INIT (0, 0);
+  self->current = GRAPHENE_POINT_INIT (0, 0);
+  self->n_lines = 0;
+
+  max_scale = MAX (graphene_vec2_get_x (scale), graphene_vec2_get_y (scale));
+  if (max_scale <= 0)
+    return FALSE;
+
+  if (!gsk_path_foreach_with_tolerance (path,
+                                        0,
+                                        GSK_PATH_TOLERANCE_DEFAULT / max_scale,
+                                        gsk_gpu_path_lines_foreach,
+                                        self))
+    return FALSE;
+
+  if (close_contours)
+    return gsk_gpu_path_lines_close_contour (self);
+
+  return TRUE;
+}
+
+static void
+gsk_gpu_pattern_writer_append_lines (GskGpuPatternWriter   *self,
+                                     const GskGpuPathLines *lines)
+{
+  gsize i;
+
+  gsk_gpu_pattern_writer_append_uint (self, lines->n_lines);
+  for (i = 0; i < 2 * lines->n_lines; i++)
+    gsk_gpu_pattern_writer_append_point (self, &lines->points[i], &self->offset);
+}
+
+static gboolean
+gsk_gpu_node_processor_stroke_can_ubershader (const GskStroke *stroke)
+{
+  /* The shader computes the distance to the lines, which only
+   * matches round joins and caps */
+  return stroke->line_width > 0 &&
+         stroke->line_join == GSK_LINE_JOIN_ROUND &&
+         stroke->line_cap == GSK_LINE_CAP_ROUND &&
+         stroke->n_dash == 0;
+}
+
+/* Strokes that aren't round get tessellated into convex polygons and
+ * circles of the stroke's width. The shader draws their union, so the
+ * pieces must overlap where they meet, or the antialiasing would show
+ * the seams.
+ */
+#define GSK_GPU_STROKE_MAX_PIECES (2 * GSK_GPU_PATH_MAX_LINES)
+#define GSK_GPU_STROKE_MAX_POINTS (4 * GSK_GPU_PATH_MAX_LINES)
+#define GSK_GPU_STROKE_MAX_DASH_POINTS (GSK_GPU_PATH_MAX_LINES + 4)
+
+typedef struct _GskGpuStrokePieces GskGpuStrokePieces;
+struct _GskGpuStrokePieces
+{
+  const GskStroke *stroke;
+  float half_width;
+  /* how far segments reach into miter and bevel joins */
+  float overlap;
+
+  graphene_point_t contour[GSK_GPU_PATH_MAX_LINES + 1];
+  gsize n_contour;
+  gboolean has_lines;
+
+  gsize dash_index;
+  gboolean dash_on;
+  float dash_remaining;
+  /* on closed contours, the first dash gets joined to the last one */
+  gboolean defer_first_dash;
+  graphene_point_t dash[GSK_GPU_STROKE_MAX_DASH_POINTS];
+  gsize n_dash;
+  graphene_point_t first_dash[GSK_GPU_STROKE_MAX_DASH_POINTS];
+  gsize n_first_dash;
+
+  gsize n_pieces;
+  gsize n_points;
+  guint piece_points[GSK_GPU_STROKE_MAX_PIECES];
+  graphene_point_t points[GSK_GPU_STROKE_MAX_POINTS];
+};
+
+static gboolean
+gsk_gpu_stroke_pieces_add_circle (GskGpuStrokePieces     *self,
+                                  const graphene_point_t *center)
+{
+  if (self->n_pieces >= GSK_GPU_STROKE_MAX_PIECES ||
+      self->n_points >= GSK_GPU_STROKE_MAX_POINTS)
+    return FALSE;
+
+  self->piece_points[self->n_pieces++] = 1;
+  self->points[self->n_points++] = *center;
+
+  return TRUE;
+}
+
+static gboolean
+gsk_gpu_stroke_pieces_add_polygon (GskGpuStrokePieces     *self,
+                                   const graphene_point_t *pts,
+                                   gsize                   n_pts)
+{
+  graphene_point_t polygon[4];
+  gsize i, n;
+  float area;
+
+  g_assert (n_pts <= G_N_ELEMENTS (polygon));
+
+  /* The shader can't compute the normal of an empty edge */
+  n = 0;
+  for (i = 0; i < n_pts; i++)
+    {
+      if (n > 0 && graphene_point_equal (&pts[i], &polygon[n - 1]))
+        continue;
+      polygon[n++] = pts[i];
+    }
+  if (n > 1 && graphene_point_equal (&polygon[0], &polygon[n - 1]))
+    n--;
+
+  /* Relative to the first point, to not lose precision */
+  area = 0;
+  for (i = 1; i + 1 < n; i++)
+    area += (polygon[i].x - polygon[0].x) * (polygon[i + 1].y - polygon[0].y) -
+            (polygon[i + 1].x - polygon[0].x) * (polygon[i].y - polygon[0].y);
+
+  /* Degenerate polygons don't cover anything */
+  if (n < 3 || fabsf (area) < 1e-6f)
+    return TRUE;
+
+  if (self->n_pieces >= GSK_GPU_STROKE_MAX_PIECES ||
+      self->n_points + n > GSK_GPU_STROKE_MAX_POINTS)
+    return FALSE;
+
+  self->piece_points[self->n_pieces++] = n;
+  for (i = 0; i < n; i++)
+    self->points[self->n_points++] = polygon[area > 0 ? i : n - 1 - i];
+
+  return TRUE;
+}
+
+static void
+get_direction (const graphene_point_t *a,
+               const graphene_point_t *b,
+               graphene_vec2_t        *direction)
+{
+  graphene_vec2_init (direction, b->x - a->x, b->y - a->y);
+  graphene_vec2_normalize (direction, direction);
+}
+
+/* Draws the caps of a dash or contour that has no length */
+static gboolean
+gsk_gpu_stroke_pieces_add_dot (GskGpuStrokePieces     *self,
+                               const graphene_point_t *point,
+                               const graphene_vec2_t  *direction)
+{
+  float dx, dy, hw;
+
+  switch (self->stroke->line_cap)
+    {
+    case GSK_LINE_CAP_ROUND:
+      return gsk_gpu_stroke_pieces_add_circle (self, point);
+
+    case GSK_LINE_CAP_SQUARE:
+      hw = self->half_width;
+      dx = graphene_vec2_get_x (direction) * hw;
+      dy = graphene_vec2_get_y (direction) * hw;
+      return gsk_gpu_stroke_pieces_add_polygon (self,
+                                                (graphene_point_t[4]) {
+                                                  GRAPHENE_POINT_INIT (point->x - dx - dy, point->y - dy + dx),
+                                                  GRAPHENE_POINT_INIT (point->x + dx - dy, point->y + dy + dx),
+                                                  GRAPHENE_POINT_INIT (point->x + dx + dy, point->y + dy - dx),
+                                                  GRAPHENE_POINT_INIT (point->x - dx + dy, point->y - dy - dx),
+                                                },
+                                                4);
+
+    case GSK_LINE_CAP_BUTT:
+    default:
+      return TRUE;
+    }
+}
+
+/* Adds the rectangle covering the line from @a to @b, extended by
+ * @extend_a and @extend_b at its ends */
+static gboolean
+gsk_gpu_stroke_pieces_add_segment (GskGpuStrokePieces     *self,
+                                   const graphene_point_t *a,
+                                   const graphene_point_t *b,
+                                   float                   extend_a,
+                                   float                   extend_b)
+{
+  graphene_vec2_t direction;
+  float dx, dy, nx, ny;
+
+  get_direction (a, b, &direction);
+  dx = graphene_vec2_get_x (&direction);
+  dy = graphene_vec2_get_y (&direction);
+  nx = - dy * self->half_width;
+  ny = dx * self->half_width;
+
+  return gsk_gpu_stroke_pieces_add_polygon (self,
+                                            (graphene_point_t[4]) {
+                                              GRAPHENE_POINT_INIT (a->x - dx * extend_a + nx, a->y - dy * extend_a + ny),
+                                              GRAPHENE_POINT_INIT (b->x + dx * extend_b + nx, b->y + dy * extend_b + ny),
+                                              GRAPHENE_POINT_INIT (b->x + dx * extend_b - nx, b->y + dy * extend_b - ny),
+                                              GRAPHENE_POINT_INIT (a->x - dx * extend_a - nx, a->y - dy * extend_a - ny),
+                                            },
+                                            4);
+}
+
+/* Adds the join at @point between the line coming from @prev and the
+ * line going to @next */
+static gboolean
+gsk_gpu_stroke_pieces_add_join (GskGpuStrokePieces     *self,
+                                const graphene_point_t *prev,
+                                const graphene_point_t *point,
+                                const graphene_point_t *next)
+{
+  graphene_vec2_t d1, d2;
+  graphene_point_t p1, p2;
+  float cross, dot, k;
+
+  if (self->stroke->line_join == GSK_LINE_JOIN_ROUND)
+    return gsk_gpu_stroke_pieces_add_circle (self, point);
+
+  get_direction (prev, point, &d1);
+  get_direction (point, next, &d2);
+  cross = graphene_vec2_get_x (&d1) * graphene_vec2_get_y (&d2) -
+          graphene_vec2_get_y (&d1) * graphene_vec2_get_x (&d2);
+  dot = graphene_vec2_dot (&d1, &d2);
+
+  /* Almost straight on, the overlapping segments cover the gap */
+  if (dot > 0 && fabsf (cross) * self->half_width < self->overlap)
+    return TRUE;
+
+  /* Offset to the outside of the turn */
+  k = cross > 0 ? - self->half_width : self->half_width;
+  p1 = GRAPHENE_POINT_INIT (point->x - graphene_vec2_get_y (&d1) * k,
+                            point->y + graphene_vec2_get_x (&d1) * k);
+  p2 = GRAPHENE_POINT_INIT (point->x - graphene_vec2_get_y (&d2) * k,
+                            point->y + graphene_vec2_get_x (&d2) * k);
+
+  /* The miter length is 1 / sin (angle / 2) times the line width,
+   * and sin (angle / 2)² == (1 + dot) / 2 */
+  if (self->stroke->line_join == GSK_LINE_JOIN_MITER &&
+      (1 + dot) * self->stroke->miter_limit * self->stroke->miter_limit >= 2)
+    {
+      graphene_point_t tip;
+
+      tip = GRAPHENE_POINT_INIT (point->x + (p1.x + p2.x - 2 * point->x) / (1 + dot),
+                                 point->y + (p1.y + p2.y - 2 * point->y) / (1 + dot));
+
+      return gsk_gpu_stroke_pieces_add_polygon (self,
+                                                (graphene_point_t[4]) { *point, p1, tip, p2 },
+                                                4);
+    }
+
+  return gsk_gpu_stroke_pieces_add_polygon (self,
+                                            (graphene_point_t[3]) { *point, p1, p2 },
+                                            3);
+}
+
+/* Strokes a line through @pts that doesn't contain duplicate
+ * consecutive points. @direction is used to orient the caps if
+ * there is only one point.
+ */
+static gboolean
+gsk_gpu_stroke_pieces_add_polyline (GskGpuStrokePieces     *self,
+                                    const graphene_point_t *pts,
+                                    gsize                   n_pts,
+                                    gboolean                closed,
+                                    const graphene_vec2_t  *direction)
+{
+  float cap_extend, join_extend;
+  gsize i, n_segments;
+
+  if (n_pts == 0)
+    return TRUE;
+
+  if (n_pts == 1)
+    return gsk_gpu_stroke_pieces_add_dot (self, &pts[0], direction);
+
+  cap_extend = self->stroke->line_cap == GSK_LINE_CAP_SQUARE ? self->half_width : 0;
+  join_extend = self->stroke->line_join == GSK_LINE_JOIN_ROUND ? 0 : self->overlap;
+  n_segments = closed ? n_pts : n_pts - 1;
+
+  for (i = 0; i < n_segments; i++)
+    {
+      if (!gsk_gpu_stroke_pieces_add_segment (self,
+                                              &pts[i],
+                                              &pts[(i + 1) % n_pts],
+                                              !closed && i == 0 ? cap_extend : join_extend,
+                                              !closed && i + 1 == n_segments ? cap_extend : join_extend))
+        return FALSE;
+    }
+
+  for (i = closed ? 0 : 1; i < (closed ? n_pts : n_pts - 1); i++)
+    {
+      if (!gsk_gpu_stroke_pieces_add_join (self,
+                                           &pts[(i + n_pts - 1) % n_pts],
+                                           &pts[i],
+                                           &pts[(i + 1) % n_pts]))
+        return FALSE;
+    }
+
+  if (!closed && self->stroke->line_cap == GSK_LINE_CAP_ROUND)
+    {
+      if (!gsk_gpu_stroke_pieces_add_circle (self, &pts[0]) ||
+          !gsk_gpu_stroke_pieces_add_circle (self, &pts[n_pts - 1]))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+gsk_gpu_stroke_pieces_add_dash_point (GskGpuStrokePieces     *self,
+                                      const graphene_point_t *point)
+{
+  if (self->n_dash > 0 && graphene_point_equal (&self->dash[self->n_dash - 1], point))
+    return;
+
+  g_assert (self->n_dash < GSK_GPU_STROKE_MAX_DASH_POINTS);
+  self->dash[self->n_dash++] = *point;
+}
+
+static gboolean
+gsk_gpu_stroke_pieces_end_dash (GskGpuStrokePieces    *self,
+                                const graphene_vec2_t *direction)
+{
+  if (self->defer_first_dash)
+    {
+      memcpy (self->first_dash, self->dash, sizeof (graphene_point_t) * self->n_dash);
+      self->n_first_dash = self->n_dash;
+      self->defer_first_dash = FALSE;
+      return TRUE;
+    }
+
+  return gsk_gpu_stroke_pieces_add_polyline (self, self->dash, self->n_dash, FALSE, direction);
+}
+
+static void
+gsk_gpu_stroke_pieces_next_dash (GskGpuStrokePieces *self)
+{
+  self->dash_on = !self->dash_on;
+  self->dash_index = (self->dash_index + 1) % self->stroke->n_dash;
+  self->dash_remaining = self->stroke->dash[self->dash_index];
+}
+
+static gboolean
+gsk_gpu_stroke_pieces_dash_contour (GskGpuStrokePieces *self,
+                                    gboolean            closed)
+{
+  const GskStroke *stroke = self->stroke;
+  const graphene_point_t *pts = self->contour;
+  gsize i, n_pts, n_segments;
+  graphene_vec2_t direction;
+  float period, offset, length;
+
+  n_pts = self->n_contour;
+  n_segments = closed ? n_pts : n_pts - 1;
+
+  /* Every period draws at least one dash, so give up early
+   * if there would be too many */
+  period = stroke->dash_length * (stroke->n_dash % 2 ? 2 : 1);
+  length = 0;
+  for (i = 0; i < n_segments; i++)
+    length += graphene_point_distance (&pts[i], &pts[(i + 1) % n_pts], NULL, NULL);
+  if (length / period > GSK_GPU_STROKE_MAX_PIECES)
+    return FALSE;
+
+  /* Like cairo, start every contour at the dash offset */
+  offset = fmodf (stroke->dash_offset, period);
+  if (offset < 0)
+    offset += period;
+  self->dash_index = 0;
+  self->dash_on = TRUE;
+  self->dash_remaining = stroke->dash[0];
+  for (i = 0; i < 2 * stroke->n_dash && offset >= self->dash_remaining; i++)
+    {
+      offset -= self->dash_remaining;
+      gsk_gpu_stroke_pieces_next_dash (self);
+    }
+  self->dash_remaining = MAX (self->dash_remaining - offset, 0);
+
+  self->defer_first_dash = closed && self->dash_on;
+  self->n_dash = 0;
+  self->n_first_dash = 0;
+  if (self->dash_on)
+    gsk_gpu_stroke_pieces_add_dash_point (self, &pts[0]);
+
+  graphene_vec2_init (&direction, 1, 0);
+  for (i = 0; i < n_segments; i++)
+    {
+      const graphene_point_t *a = &pts[i];
+      const graphene_point_t *b = &pts[(i + 1) % n_pts];
+      float t;
+
+      length = graphene_point_distance (a, b, NULL, NULL);
+      get_direction (a, b, &direction);
+
+      for (t = 0; length - t > self->dash_remaining; )
+        {
+          graphene_point_t p;
+
+          t += self->dash_remaining;
+          p = GRAPHENE_POINT_INIT (a->x + graphene_vec2_get_x (&direction) * t,
+                                   a->y + graphene_vec2_get_y (&direction) * t);
+
+          if (self->dash_on)
+            {
+              gsk_gpu_stroke_pieces_add_dash_point (self, &p);
+              if (!gsk_gpu_stroke_pieces_end_dash (self, &direction))
+                return FALSE;
+            }
+          else
+            {
+              self->n_dash = 0;
+              gsk_gpu_stroke_pieces_add_dash_point (self, &p);
+            }
+
+          gsk_gpu_stroke_pieces_next_dash (self);
+        }
+
+      self->dash_remaining -= length - t;
+      if (self->dash_on)
+        gsk_gpu_stroke_pieces_add_dash_point (self, b);
+    }
+
+  if (closed && self->dash_on)
+    {
+      /* The dash never ended, so the whole contour is drawn */
+      if (self->defer_first_dash)
+        return gsk_gpu_stroke_pieces_add_polyline (self, pts, n_pts, TRUE, &direction);
+
+      if (graphene_point_equal (&self->dash[self->n_dash - 1], &pts[0]))
+        {
+          for (i = 0; i < self->n_first_dash; i++)
+            gsk_gpu_stroke_pieces_add_dash_point (self, &self->first_dash[i]);
+          self->n_first_dash = 0;
+        }
+    }
+
+  if (!gsk_gpu_stroke_pieces_add_polyline (self, self->first_dash, self->n_first_dash, FALSE, &direction))
+    return FALSE;
+
+  if (!self->dash_on)
+    return TRUE;
+
+  return gsk_gpu_stroke_pieces_add_polyline (self, self->dash, self->n_dash, FALSE, &direction);
+}
+
+static gboolean
+gsk_gpu_stroke_pieces_finish_contour (GskGpuStrokePieces *self,
+                                      gboolean            closed)
+{
+  gboolean result;
+
+  /* A move without any lines doesn't draw anything */
+  if (!self->has_lines)
+    result = TRUE;
+  else
+    {
+      if (closed && self->n_contour > 1 &&
+          graphene_point_equal (&self->contour[0], &self->contour[self->n_contour - 1]))
+        self->n_contour--;
+
+      if (self->stroke->dash_length > 0 && self->n_contour > 1)
+        result = gsk_gpu_stroke_pieces_dash_contour (self, closed);
+      else
+        result = gsk_gpu_stroke_pieces_add_polyline (self,
+                                                     self->contour,
+                                                     self->n_contour,
+                                                     closed,
+                                                     graphene_vec2_x_axis ());
+    }
+
+  self->n_contour = 0;
+  self->has_lines = FALSE;
+
+  return result;
+}
+
+static gboolean
+gsk_gpu_stroke_pieces_foreach (GskPathOperation        op,
+                               const graphene_point_t *pts,
+                               gsize                   n_pts,
+                               float                   weight,
+                               gpointer                user_data)
+{
+  GskGpuStrokePieces *self = user_data;
+
+  switch (op)
+    {
+    case GSK_PATH_MOVE:
+      if (!gsk_gpu_stroke_pieces_finish_contour (self, FALSE))
+        return FALSE;
+      self->contour[0] = pts[0];
+      self->n_contour = 1;
+      return TRUE;
+
+    case GSK_PATH_CLOSE:
+      return gsk_gpu_stroke_pieces_finish_contour (self, TRUE);
+
+    case GSK_PATH_LINE:
+      self->has_lines = TRUE;
+      if (graphene_point_equal (&self->contour[self->n_contour - 1], &pts[1]))
+        return TRUE;
+      if (self->n_contour >= G_N_ELEMENTS (self->contour))
+        return FALSE;
+      self->contour[self->n_contour++] = pts[1];
+      return TRUE;
+
+    case GSK_PATH_QUAD:
+    case GSK_PATH_CUBIC:
+    case GSK_PATH_CONIC:
+    default:
+      g_assert_not_reached ();
+      return FALSE;
+    }
+}
+
+/*
+ * gsk_gpu_stroke_pieces_init:
+ * @self: the pieces to initialize
+ * @path: the path to stroke
+ * @stroke: the stroke parameters
+ * @scale: the scale the path will be drawn at
+ *
+ * Flattens, dashes and tessellates the stroke, so the shaders can
+ * draw it directly instead of uploading a cairo rendering.
+ *
+ * Returns: %FALSE if the stroke needs too many pieces
+ */
+static gboolean
+gsk_gpu_stroke_pieces_init (GskGpuStrokePieces    *self,
+                            GskPath               *path,
+                            const GskStroke       *stroke,
+                            const graphene_vec2_t *scale)
+{
+  float min_scale, max_scale;
+
+  min_scale = MIN (graphene_vec2_get_x (scale), graphene_vec2_get_y (scale));
+  max_scale = MAX (graphene_vec2_get_x (scale), graphene_vec2_get_y (scale));
+  if (min_scale <= 0 || stroke->line_width <= 0)
+    return FALSE;
+
+  self->stroke = stroke;
+  self->half_width = stroke->line_width / 2;
+  /* Half a pixel on both sides, so the seams are fully covered */
+  self->overlap = 0.5 / min_scale;
+  self->n_contour = 0;
+  self->has_lines = FALSE;
+  self->n_pieces = 0;
+  self->n_points = 0;
+
+  if (!gsk_path_foreach_with_tolerance (path,
+                                        0,
+                                        GSK_PATH_TOLERANCE_DEFAULT / max_scale,
+                                        gsk_gpu_stroke_pieces_foreach,
+                                        self))
+    return FALSE;
+
+  return gsk_gpu_stroke_pieces_finish_contour (self, FALSE);
+}
+
+static void
+gsk_gpu_pattern_writer_append_stroke_pieces (GskGpuPatternWriter      *self,
+                                             const GskGpuStrokePieces *pieces)
+{
+  gsize i, j, p;
+
+  gsk_gpu_pattern_writer_append_float (self, pieces->stroke->line_width);
+  gsk_gpu_pattern_writer_append_uint (self, pieces->n_pieces);
+  p = 0;
+  for (i = 0; i < pieces->n_pieces; i++)
+    {
+      gsk_gpu_pattern_writer_append_uint (self, pieces->piece_points[i]);
+      for (j = 0; j < pieces->piece_points[i]; j++)
+        gsk_gpu_pattern_writer_append_point (self, &pieces->points[p++], &self->offset);
+    }
+}
+
+static gboolean
+gsk_gpu_node_processor_create_fill_pattern (GskGpuPatternWriter *self,
+                                            GskRenderNode       *node)
+{
+  graphene_rect_t path_bounds;
+  GskGpuPathLines lines;
+  GskRenderNode *child;
+
+  if (!gsk_gpu_frame_should_optimize (self->frame, GSK_GPU_OPTIMIZE_PATHS))
+    return FALSE;
+
+  if (!gsk_gpu_path_lines_init (&lines, gsk_fill_node_get_path (node), TRUE, &self->scale))
+    return FALSE;
+
+  child = gsk_fill_node_get_child (node);
+  if (!gsk_gpu_node_processor_create_node_pattern (self, child))
+    return FALSE;
+  if (!gsk_path_get_bounds (gsk_fill_node_get_path (node), &path_bounds) ||
+      !gsk_rect_contains_rect (&child->bounds, &path_bounds))
+    {
+      gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_CLIP);
+      gsk_gpu_pattern_writer_append_rect (self, &child->bounds, &self->offset);
+    }
+
+  gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_FILL);
+  gsk_gpu_pattern_writer_append_uint (self, gsk_fill_node_get_fill_rule (node));
+  gsk_gpu_pattern_writer_append_lines (self, &lines);
+
+  return TRUE;
+}
+
+/* Checks that create_stroke_pattern() will be able to draw the path */
+static gboolean
+gsk_gpu_node_processor_stroke_can_pattern (GskRenderNode         *node,
+                                           const graphene_vec2_t *scale)
+{
+  GskGpuStrokePieces pieces;
+  GskGpuPathLines lines;
+
+  if (gsk_gpu_node_processor_stroke_can_ubershader (gsk_stroke_node_get_stroke (node)))
+    return gsk_gpu_path_lines_init (&lines, gsk_stroke_node_get_path (node), FALSE, scale);
+
+  return gsk_gpu_stroke_pieces_init (&pieces,
+                                     gsk_stroke_node_get_path (node),
+                                     gsk_stroke_node_get_stroke (node),
+                                     scale);
+}
+
+static gboolean
+gsk_gpu_node_processor_create_stroke_pattern (GskGpuPatternWriter *self,
+                                              GskRenderNode       *node)
+{
+  const GskStroke *stroke;
+  graphene_rect_t path_bounds;
+  GskGpuStrokePieces pieces;
+  GskGpuPathLines lines;
+  GskRenderNode *child;
+  gboolean is_round;
+
+  if (!gsk_gpu_frame_should_optimize (self->frame, GSK_GPU_OPTIMIZE_PATHS))
+    return FALSE;
+
+  stroke = gsk_stroke_node_get_stroke (node);
+  is_round = gsk_gpu_node_processor_stroke_can_ubershader (stroke);
+  if (is_round)
+    {
+      if (!gsk_gpu_path_lines_init (&lines, gsk_stroke_node_get_path (node), FALSE, &self->scale))
+        return FALSE;
+    }
+  else
+    {
+      if (!gsk_gpu_stroke_pieces_init (&pieces, gsk_stroke_node_get_path (node), stroke, &self->scale))
+        return FALSE;
+    }
+
+  child = gsk_stroke_node_get_child (node);
+  if (!gsk_gpu_node_processor_create_node_pattern (self, child))
+    return FALSE;
+  if (!gsk_path_get_stroke_bounds (gsk_stroke_node_get_path (node), stroke, &path_bounds) ||
+      !gsk_rect_contains_rect (&child->bounds, &path_bounds))
+    {
+      gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_CLIP);
+      gsk_gpu_pattern_writer_append_rect (self, &child->bounds, &self->offset);
+    }
+
+  if (is_round)
+    {
+      gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_STROKE);
+      gsk_gpu_pattern_writer_append_float (self, stroke->line_width);
+      gsk_gpu_pattern_writer_append_lines (self, &lines);
+    }
+  else
+    {
+      gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_STROKE_PIECES);
+      gsk_gpu_pattern_writer_append_stroke_pieces (self, &pieces);
+    }
+
+  return TRUE;
+}
+
+/*
+ * gsk_gpu_node_processor_lookup_path_mask:
+ * @self: the node processor
+ * @path: the path
+ * @fill_rule: the fill rule if filling
+ * @stroke: (nullable): the stroke or %NULL to fill
+ * @out_rect: (out): the area covered by the mask
+ * @out_tex_rect: (out): the texture rect to draw the mask image with
+ *
+ * Looks up the path in the device's path cache, so unchanged fills
+ * and strokes don't need to be rasterized again every frame.
+ *
+ * Returns: (nullable) (transfer none): the mask image or %NULL if
+ *   the path can't be cached
+ */
+static GskGpuImage *
+gsk_gpu_node_processor_lookup_path_mask (GskGpuNodeProcessor *self,
+                                         GskPath             *path,
+                                         GskFillRule          fill_rule,
+                                         const GskStroke     *stroke,
+                                         graphene_rect_t     *out_rect,
+                                         graphene_rect_t     *out_tex_rect)
+{
+  graphene_rect_t bounds;
+  graphene_point_t origin, subpixel;
+  GskGpuImage *image;
+  float scale_x, scale_y;
+
+  scale_x = graphene_vec2_get_x (&self->scale);
+  scale_y = graphene_vec2_get_y (&self->scale);
+  if (scale_x <= 0 || scale_y <= 0)
+    return NULL;
+
+  subpixel = GRAPHENE_POINT_INIT (self->offset.x * scale_x - floorf (self->offset.x * scale_x),
+                                  self->offset.y * scale_y - floorf (self->offset.y * scale_y));
+
+  image = gsk_gpu_device_lookup_path_image (gsk_gpu_frame_get_device (self->frame),
+                                            self->frame,
+                                            path,
+                                            fill_rule,
+                                            stroke,
+                                            &self->scale,
+                                            &subpixel,
+                                            &bounds,
+                                            &origin);
+  if (image == NULL)
+    return NULL;
+
+  *out_rect = GRAPHENE_RECT_INIT (- origin.x / scale_x,
+                                  - origin.y / scale_y,
+                                  bounds.size.width / scale_x,
+                                  bounds.size.height / scale_y);
+  *out_tex_rect = GRAPHENE_RECT_INIT (out_rect->origin.x - bounds.origin.x / scale_x,
+                                      out_rect->origin.y - bounds.origin.y / scale_y,
+                                      gsk_gpu_image_get_width (image) / scale_x,
+                                      gsk_gpu_image_get_height (image) / scale_y);
+
+  return image;
+}
+
+static void
+gsk_gpu_node_processor_add_child_with_mask (GskGpuNodeProcessor   *self,
+                                            GskRenderNode         *child,
+                                            const graphene_rect_t *rect,
+                                            GskGpuImage           *mask_image,
+                                            const graphene_rect_t *mask_rect)
+{
+  GskGpuImage *source_image;
+  graphene_rect_t source_rect;
+  guint32 descriptors[2];
+
+  if (GSK_RENDER_NODE_TYPE (child) == GSK_COLOR_NODE)
+    {
+      guint32 descriptor = gsk_gpu_node_processor_add_image (self, mask_image, GSK_GPU_SAMPLER_DEFAULT);
+      gsk_gpu_colorize_op (self->frame,
+                           gsk_gpu_clip_get_shader_clip (&self->clip, &self->offset, rect),
+                           self->desc,
+                           descriptor,
+                           rect,
+                           &self->offset,
+                           mask_rect,
+                           &GDK_RGBA_INIT_ALPHA (gsk_color_node_get_color (child), self->opacity));
+      return;
+    }
+
+  source_image = gsk_gpu_node_processor_get_node_as_image (self,
+                                                           0,
+                                                           GSK_GPU_IMAGE_STRAIGHT_ALPHA,
+                                                           rect,
+                                                           child,
+                                                           &source_rect);
+  if (source_image == NULL)
+    return;
+
+  gsk_gpu_node_processor_add_images (self,
+                                     2,
+                                     (GskGpuImage *[2]) { source_image, mask_image },
+                                     (GskGpuSampler[2]) { GSK_GPU_SAMPLER_DEFAULT, GSK_GPU_SAMPLER_DEFAULT },
+                                     descriptors);
+
+  gsk_gpu_mask_op (self->frame,
+                   gsk_gpu_clip_get_shader_clip (&self->clip, &self->offset, rect),
+                   self->desc,
+                   rect,
+                   &self->offset,
+                   self->opacity,
+                   GSK_MASK_MODE_ALPHA,
+                   descriptors[0],
+                   &source_rect,
+                   descriptors[1],
+                   mask_rect);
+
+  g_object_unref (source_image);
+}
+
 typedef struct _FillData FillData;
 struct _FillData
 {
@@ -3572,9 +4965,10 @@ static void
 gsk_gpu_node_processor_add_fill_node (GskGpuNodeProcessor *self,
                                       GskRenderNode       *node)
 {
-  graphene_rect_t clip_bounds, source_rect;
+  graphene_rect_t clip_bounds, source_rect, mask_rect, mask_tex_rect;
   GskGpuImage *mask_image, *source_image;
   guint32 descriptors[2];
+  GskGpuPathLines lines;
   GskRenderNode *child;
 
   if (!gsk_gpu_node_processor_clip_node_bounds (self, node, &clip_bounds))
@@ -3583,9 +4977,30 @@ gsk_gpu_node_processor_add_fill_node (GskGpuNodeProcessor *self,
 
   child = gsk_fill_node_get_child (node);
 
+  /* Check the path first, so the pattern code can't end up
+   * rendering this node as an offscreen, which would recurse */
+  if (gsk_gpu_frame_should_optimize (self->frame, GSK_GPU_OPTIMIZE_PATHS) &&
+      gsk_gpu_path_lines_init (&lines, gsk_fill_node_get_path (node), TRUE, &self->scale) &&
+      gsk_gpu_node_processor_try_node_as_pattern_in_rect (self, node, &clip_bounds))
+    return;
+
+  mask_image = gsk_gpu_node_processor_lookup_path_mask (self,
+                                                        gsk_fill_node_get_path (node),
+                                                        gsk_fill_node_get_fill_rule (node),
+                                                        NULL,
+                                                        &mask_rect,
+                                                        &mask_tex_rect);
+  if (mask_image != NULL)
+    {
+      if (gsk_rect_intersection (&clip_bounds, &mask_rect, &clip_bounds))
+        gsk_gpu_node_processor_add_child_with_mask (self, child, &clip_bounds, mask_image, &mask_tex_rect);
+      return;
+    }
+
   mask_image = gsk_gpu_upload_cairo_op (self->frame,
                                         &self->scale,
                                         &clip_bounds,
+                                        TRUE,
                                         gsk_gpu_node_processor_fill_path,
                                         g_memdup (&(FillData) {
                                             .path = gsk_path_ref (gsk_fill_node_get_path (node)),
@@ -3669,7 +5084,7 @@ static void
 gsk_gpu_node_processor_add_stroke_node (GskGpuNodeProcessor *self,
                                         GskRenderNode       *node)
 {
-  graphene_rect_t clip_bounds, source_rect;
+  graphene_rect_t clip_bounds, source_rect, mask_rect, mask_tex_rect;
   GskGpuImage *mask_image, *source_image;
   guint32 descriptors[2];
   GskRenderNode *child;
@@ -3680,9 +5095,29 @@ gsk_gpu_node_processor_add_stroke_node (GskGpuNodeProcessor *self,
 
   child = gsk_stroke_node_get_child (node);
 
+  /* See the comment in add_fill_node() */
+  if (gsk_gpu_frame_should_optimize (self->frame, GSK_GPU_OPTIMIZE_PATHS) &&
+      gsk_gpu_node_processor_stroke_can_pattern (node, &self->scale) &&
+      gsk_gpu_node_processor_try_node_as_pattern_in_rect (self, node, &clip_bounds))
+    return;
+
+  mask_image = gsk_gpu_node_processor_lookup_path_mask (self,
+                                                        gsk_stroke_node_get_path (node),
+                                                        GSK_FILL_RULE_WINDING,
+                                                        gsk_stroke_node_get_stroke (node),
+                                                        &mask_rect,
+                                                        &mask_tex_rect);
+  if (mask_image != NULL)
+    {
+      if (gsk_rect_intersection (&clip_bounds, &mask_rect, &clip_bounds))
+        gsk_gpu_node_processor_add_child_with_mask (self, child, &clip_bounds, mask_image, &mask_tex_rect);
+      return;
+    }
+
   mask_image = gsk_gpu_upload_cairo_op (self->frame,
                                         &self->scale,
                                         &clip_bounds,
+                                        TRUE,
                                         gsk_gpu_node_processor_stroke_path,
                                         g_memdup (&(StrokeData) {
                                             .path = gsk_path_ref (gsk_stroke_node_get_path (node)),
@@ -3799,18 +5234,31 @@ gsk_gpu_node_processor_create_subsurface_pattern (GskGpuPatternWriter *self,
   return gsk_gpu_node_processor_create_node_pattern (self, gsk_subsurface_node_get_child (node));
 }
 
+static void
+gsk_gpu_node_processor_add_container_child (GskRenderNode *child,
+                                            gpointer       data)
+{
+  gsk_gpu_node_processor_add_node (data, child);
+}
+
 static void
 gsk_gpu_node_processor_add_container_node (GskGpuNodeProcessor *self,
                                            GskRenderNode       *node)
 {
+  graphene_rect_t clip;
+
   if (self->opacity < 1.0 && !gsk_container_node_is_disjoint (node))
     {
       gsk_gpu_node_processor_add_without_opacity (self, node);
       return;
     }
 
-  for (guint i = 0; i < gsk_container_node_get_n_children (node); i++)
-    gsk_gpu_node_processor_add_node (self, gsk_container_node_get_child (node, i));
+  /* Children don't change the clip, so it is the same for all of them */
+  gsk_gpu_node_processor_get_clip_bounds (self, &clip);
+  gsk_container_node_foreach_in_rect (node,
+                                      &clip,
+                                      gsk_gpu_node_processor_add_container_child,
+                                      self);
 }
 
 static gboolean
@@ -3820,6 +5268,57 @@ gsk_gpu_node_processor_create_debug_pattern (GskGpuPatternWriter *self,
   return gsk_gpu_node_processor_create_node_pattern (self, gsk_debug_node_get_child (node));
 }
 
+static void
+gsk_gpu_node_processor_add_gl_shader_node (GskGpuNodeProcessor *self,
+                                           GskRenderNode       *node)
+{
+  GskGpuImage *images[4];
+  GskGpuSampler samplers[4];
+  guint32 descriptors[4];
+  gsize i, n_children;
+
+  n_children = gsk_gl_shader_node_get_n_children (node);
+
+  if (!gsk_gpu_gl_shader_op_is_supported (self->frame) ||
+      n_children > G_N_ELEMENTS (images))
+    {
+      gsk_gpu_node_processor_add_fallback_node (self, node);
+      return;
+    }
+
+  /* Shaders expect their textures to cover exactly the node's bounds */
+  for (i = 0; i < n_children; i++)
+    {
+      images[i] = gsk_gpu_node_processor_create_offscreen (self->frame,
+                                                           &self->scale,
+                                                           &node->bounds,
+                                                           gsk_gl_shader_node_get_child (node, i));
+      if (images[i] == NULL)
+        {
+          while (i-- > 0)
+            g_object_unref (images[i]);
+          return;
+        }
+      samplers[i] = GSK_GPU_SAMPLER_DEFAULT;
+    }
+
+  if (n_children > 0)
+    gsk_gpu_node_processor_add_images (self, n_children, images, samplers, descriptors);
+
+  gsk_gpu_gl_shader_op (self->frame,
+                        gsk_gpu_clip_get_shader_clip (&self->clip, &self->offset, &node->bounds),
+                        self->desc,
+                        gsk_gl_shader_node_get_shader (node),
+                        gsk_gl_shader_node_get_args (node),
+                        &node->bounds,
+                        &self->offset,
+                        descriptors,
+                        n_children);
+
+  for (i = 0; i < n_children; i++)
+    g_object_unref (images[i]);
+}
+
 static void
 gsk_gpu_node_processor_add_debug_node (GskGpuNodeProcessor *self,
                                        GskRenderNode       *node)
@@ -3993,7 +5492,7 @@ static const struct
   [GSK_GL_SHADER_NODE] = {
     0,
     0,
-    NULL,
+    gsk_gpu_node_processor_add_gl_shader_node,
     NULL,
   },
   [GSK_TEXTURE_SCALE_NODE] = {
@@ -4012,13 +5511,13 @@ static const struct
     0,
     GSK_GPU_HANDLE_OPACITY,
     gsk_gpu_node_processor_add_fill_node,
-    NULL,
+    gsk_gpu_node_processor_create_fill_pattern,
   },
   [GSK_STROKE_NODE] = {
     0,
     GSK_GPU_HANDLE_OPACITY,
     gsk_gpu_node_processor_add_stroke_node,
-    NULL,
+    gsk_gpu_node_processor_create_stroke_pattern,
   },
   [GSK_SUBSURFACE_NODE] = {
     GSK_GPU_GLOBAL_MATRIX | GSK_GPU_GLOBAL_SCALE | GSK_GPU_GLOBAL_CLIP | GSK_GPU_GLOBAL_SCISSOR | GSK_GPU_GLOBAL_BLEND,
@@ -4102,9 +5601,13 @@ gsk_gpu_node_processor_create_node_pattern (GskGpuPatternWriter *self,
       gsize size_before = pattern_buffer_get_size (&self->buffer);
       gsize images_before = self->desc ? gsk_gpu_descriptors_get_n_images (self->desc) : 0;
       gsize buffers_before = self->desc ? gsk_gpu_descriptors_get_n_buffers (self->desc) : 0;
+      guint n_types_before = self->n_types;
+      guint32 program_before = self->program;
       if (nodes_vtable[node_type].create_pattern (self, node))
         return TRUE;
       pattern_buffer_set_size (&self->buffer, size_before);
+      self->n_types = n_types_before;
+      self->program = program_before;
       if (self->desc)
         gsk_gpu_descriptors_set_size (self->desc, images_before, buffers_before);
     }
@@ -4125,7 +5628,7 @@ gsk_gpu_node_processor_create_node_pattern (GskGpuPatternWriter *self,
                                      &bounds);
   if (image == NULL)
     {
-      gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_COLOR);
+      gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_COLOR);
       gsk_gpu_pattern_writer_append_rgba (self, &GDK_RGBA_TRANSPARENT);
       return TRUE;
     }
@@ -4137,9 +5640,9 @@ gsk_gpu_node_processor_create_node_pattern (GskGpuPatternWriter *self,
     }
 
   if (gsk_gpu_image_get_flags (image) & GSK_GPU_IMAGE_STRAIGHT_ALPHA)
-    gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_STRAIGHT_ALPHA);
+    gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_STRAIGHT_ALPHA);
   else
-    gsk_gpu_pattern_writer_append_uint (self, GSK_GPU_PATTERN_TEXTURE);
+    gsk_gpu_pattern_writer_append_type (self, GSK_GPU_PATTERN_TEXTURE);
   gsk_gpu_pattern_writer_append_uint (self, tex_id);
   gsk_gpu_pattern_writer_append_rect (self, &bounds, &self->offset);
 
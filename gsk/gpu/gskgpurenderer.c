@@ -15,6 +15,7 @@
 #include "gdk/gdkdmabuftextureprivate.h"
 #include "gdk/gdkdrawcontextprivate.h"
 #include "gdk/gdkprofilerprivate.h"
+#include "gdk/gdksurfaceprivate.h"
 #include "gdk/gdktextureprivate.h"
 #include "gdk/gdktexturedownloaderprivate.h"
 #include "gdk/gdkdrawcontextprivate.h"
@@ -30,6 +31,12 @@ static const GdkDebugKey gsk_gpu_optimization_keys[] = {
   { "blit", GSK_GPU_OPTIMIZE_BLIT, "Use shaders instead of vkCmdBlit()/glBlitFramebuffer()" },
   { "gradients", GSK_GPU_OPTIMIZE_GRADIENTS, "Don't supersample gradients" },
   { "mipmap", GSK_GPU_OPTIMIZE_MIPMAP, "Avoid creating mipmaps" },
+  { "paths", GSK_GPU_OPTIMIZE_PATHS, "Rasterize paths with cairo instead of shaders" },
+  { "threads", GSK_GPU_OPTIMIZE_THREADS, "Don't rasterize cairo fallbacks in parallel" },
+  { "sdf", GSK_GPU_OPTIMIZE_SDF, "Rasterize large glyphs for every size instead of using distance fields" },
+  { "blur", GSK_GPU_OPTIMIZE_BLUR, "Always blur at full resolution" },
+  { "specialize", GSK_GPU_OPTIMIZE_SPECIALIZE, "Always interpret uber shader patterns" },
+  { "linear", GSK_GPU_OPTIMIZE_LINEAR, "Composite high depth content in sRGB instead of linear light" },
 };
 
 typedef struct _GskGpuRendererPrivate GskGpuRendererPrivate;
@@ -244,6 +251,22 @@ gsk_gpu_renderer_unrealize (GskRenderer *renderer)
   g_clear_object (&priv->device);
 }
 
+/* Textures we render are often handed to the compositor, as subsurface
+ * content. If it told us what it can scan out for our surface, prefer
+ * that. This is queried on every allocation, so new feedback is picked
+ * up with the next texture.
+ */
+static GdkDmabufFormats *
+gsk_gpu_renderer_get_scanout_formats (GskGpuRenderer *self)
+{
+  GdkSurface *surface = gsk_renderer_get_surface (GSK_RENDERER (self));
+
+  if (surface == NULL)
+    return NULL;
+
+  return gdk_surface_get_scanout_formats (surface);
+}
+
 static GdkTexture *
 gsk_gpu_renderer_fallback_render_texture (GskGpuRenderer        *self,
                                           GskRenderNode         *root,
@@ -267,6 +290,7 @@ gsk_gpu_renderer_fallback_render_texture (GskGpuRenderer        *self,
     {
       image = gsk_gpu_device_create_download_image (priv->device,
                                                     gsk_render_node_get_preferred_depth (root),
+                                                    gsk_gpu_renderer_get_scanout_formats (self),
                                                     MIN (max_size, rounded_viewport->size.width),
                                                     MIN (max_size, rounded_viewport->size.height));
       max_size /= 2;
@@ -291,6 +315,7 @@ gsk_gpu_renderer_fallback_render_texture (GskGpuRenderer        *self,
           if (image == NULL)
             image = gsk_gpu_device_create_download_image (priv->device,
                                                           depth,
+                                                          gsk_gpu_renderer_get_scanout_formats (self),
                                                           MIN (image_width, width - x),
                                                           MIN (image_height, height - y));
 
@@ -348,6 +373,7 @@ gsk_gpu_renderer_render_texture (GskRenderer           *renderer,
                                          ceil (viewport->size.height));
   image = gsk_gpu_device_create_download_image (priv->device,
                                                 gsk_render_node_get_preferred_depth (root),
+                                                gsk_gpu_renderer_get_scanout_formats (self),
                                                 rounded_viewport.size.width,
                                                 rounded_viewport.size.height);
 
@@ -118,6 +118,8 @@ gsk_gpu_shader_op_vk_command_n (GskGpuOp              *op,
                  6 * instance_scale, MIN (max_ops_per_draw, n_ops - i),
                  0, self->vertex_offset / shader_op_class->vertex_size + i);
     }
+
+  gsk_gpu_frame_add_draw_calls (frame, (n_ops + max_ops_per_draw - 1) / max_ops_per_draw);
  
   return next;
 }
@@ -142,6 +144,7 @@ gsk_gpu_shader_op_gl_command_n (GskGpuOp          *op,
   GskGLDescriptors *desc;
   GskGpuOp *next;
   gsize i, n_ops, n_external, max_ops_per_draw;
+  gboolean base_instance;
 
   desc = GSK_GL_DESCRIPTORS (self->desc);
   if (desc)
@@ -191,10 +194,12 @@ gsk_gpu_shader_op_gl_command_n (GskGpuOp          *op,
       n_ops += next_shader->n_ops;
     }
 
+  base_instance = gdk_gl_context_has_feature (GDK_GL_CONTEXT (gsk_gpu_frame_get_context (frame)),
+                                              GDK_GL_FEATURE_BASE_INSTANCE);
+
   for (i = 0; i < n_ops; i += max_ops_per_draw)
     {
-      if (gdk_gl_context_has_feature (GDK_GL_CONTEXT (gsk_gpu_frame_get_context (frame)),
-                                      GDK_GL_FEATURE_BASE_INSTANCE))
+      if (base_instance)
         {
           glDrawArraysInstancedBaseInstance (GL_TRIANGLES,
                                              0,
@@ -213,6 +218,8 @@ gsk_gpu_shader_op_gl_command_n (GskGpuOp          *op,
         }
     }
 
+  gsk_gpu_frame_add_draw_calls (frame, (n_ops + max_ops_per_draw - 1) / max_ops_per_draw);
+
   return next;
 }
 
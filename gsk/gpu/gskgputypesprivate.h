@@ -6,6 +6,8 @@
 #include "gdk/gdkmemoryformatprivate.h"
 
 #define GSK_GPU_PATTERN_STACK_SIZE 16
+#define GSK_GPU_PATTERN_MAX_SPECIALIZED_TYPES 5
+#define GSK_GPU_PATTERN_SPECIALIZED_TYPE_BITS 6
 
 typedef struct _GskGLDescriptors        GskGLDescriptors;
 typedef struct _GskGpuBuffer            GskGpuBuffer;
@@ -53,6 +55,14 @@ typedef enum {
   GSK_GPU_BLEND_CLEAR
 } GskGpuBlend;
 
+/* The encoding of the colors in the target of a render pass.
+ * Shaders always produce sRGB colors, they are converted when
+ * writing to a linear target. */
+typedef enum {
+  GSK_GPU_COLOR_STATE_SRGB,
+  GSK_GPU_COLOR_STATE_SRGB_LINEAR
+} GskGpuColorState;
+
 typedef enum {
   GSK_GPU_PATTERN_DONE,
   GSK_GPU_PATTERN_COLOR,
@@ -93,6 +103,9 @@ typedef enum {
   GSK_GPU_PATTERN_BLEND_HUE,
   GSK_GPU_PATTERN_BLEND_SATURATION,
   GSK_GPU_PATTERN_BLEND_LUMINOSITY,
+  GSK_GPU_PATTERN_FILL,
+  GSK_GPU_PATTERN_STROKE,
+  GSK_GPU_PATTERN_STROKE_PIECES,
 } GskGpuPatternType;
 
 G_STATIC_ASSERT (GSK_GPU_PATTERN_BLEND_MULTIPLY == GSK_GPU_PATTERN_BLEND_DEFAULT + GSK_BLEND_MODE_MULTIPLY);
@@ -110,6 +123,8 @@ G_STATIC_ASSERT (GSK_GPU_PATTERN_BLEND_COLOR == GSK_GPU_PATTERN_BLEND_DEFAULT +
 G_STATIC_ASSERT (GSK_GPU_PATTERN_BLEND_HUE == GSK_GPU_PATTERN_BLEND_DEFAULT + GSK_BLEND_MODE_HUE);
 G_STATIC_ASSERT (GSK_GPU_PATTERN_BLEND_SATURATION == GSK_GPU_PATTERN_BLEND_DEFAULT + GSK_BLEND_MODE_SATURATION);
 G_STATIC_ASSERT (GSK_GPU_PATTERN_BLEND_LUMINOSITY == GSK_GPU_PATTERN_BLEND_DEFAULT + GSK_BLEND_MODE_LUMINOSITY);
+G_STATIC_ASSERT (GSK_GPU_PATTERN_STROKE_PIECES < (1 << GSK_GPU_PATTERN_SPECIALIZED_TYPE_BITS));
+G_STATIC_ASSERT (GSK_GPU_PATTERN_MAX_SPECIALIZED_TYPES * GSK_GPU_PATTERN_SPECIALIZED_TYPE_BITS <= 32);
 
 typedef enum {
   GSK_GPU_OPTIMIZE_UBER                 = 1 <<  0,
@@ -118,5 +133,11 @@ typedef enum {
   GSK_GPU_OPTIMIZE_BLIT                 = 1 <<  3,
   GSK_GPU_OPTIMIZE_GRADIENTS            = 1 <<  4,
   GSK_GPU_OPTIMIZE_MIPMAP               = 1 <<  5,
+  GSK_GPU_OPTIMIZE_PATHS                = 1 <<  6,
+  GSK_GPU_OPTIMIZE_THREADS              = 1 <<  7,
+  GSK_GPU_OPTIMIZE_SDF                  = 1 <<  8,
+  GSK_GPU_OPTIMIZE_BLUR                 = 1 <<  9,
+  GSK_GPU_OPTIMIZE_SPECIALIZE           = 1 << 10,
+  GSK_GPU_OPTIMIZE_LINEAR               = 1 << 11,
 } GskGpuOptimizations;
 
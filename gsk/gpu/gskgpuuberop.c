@@ -9,6 +9,12 @@
 
 #include "gpu/shaders/gskgpuuberinstance.h"
 
+/* Pattern programs need to be seen this often before they get their own
+ * shader variation. Rarer programs use the interpreting shader. */
+#define MIN_USES_FOR_SPECIALIZATION 16
+#define MAX_SPECIALIZED_PROGRAMS 32
+#define MAX_TRACKED_PROGRAMS 1024
+
 typedef struct _GskGpuUberOp GskGpuUberOp;
 
 struct _GskGpuUberOp
@@ -47,19 +53,66 @@ static const GskGpuShaderOpClass GSK_GPU_UBER_OP_CLASS = {
   gsk_gpu_uber_setup_vao,
 };
 
+G_LOCK_DEFINE_STATIC (program_uses);
+static GHashTable *program_uses;
+static guint n_specialized_programs;
+
+static guint32
+gsk_gpu_uber_op_get_variation (guint32 program)
+{
+  gpointer value;
+  guint uses;
+
+  if (program == 0)
+    return 0;
+
+  G_LOCK (program_uses);
+
+  if (program_uses == NULL)
+    program_uses = g_hash_table_new (NULL, NULL);
+
+  if (g_hash_table_lookup_extended (program_uses, GUINT_TO_POINTER (program), NULL, &value))
+    uses = GPOINTER_TO_UINT (value);
+  else if (g_hash_table_size (program_uses) < MAX_TRACKED_PROGRAMS)
+    uses = 0;
+  else
+    {
+      G_UNLOCK (program_uses);
+      return 0;
+    }
+
+  if (uses < MIN_USES_FOR_SPECIALIZATION)
+    {
+      uses++;
+      if (uses == MIN_USES_FOR_SPECIALIZATION)
+        {
+          if (n_specialized_programs < MAX_SPECIALIZED_PROGRAMS)
+            n_specialized_programs++;
+          else
+            uses = MIN_USES_FOR_SPECIALIZATION - 1;
+        }
+      g_hash_table_insert (program_uses, GUINT_TO_POINTER (program), GUINT_TO_POINTER (uses));
+    }
+
+  G_UNLOCK (program_uses);
+
+  return uses >= MIN_USES_FOR_SPECIALIZATION ? program : 0;
+}
+
 void
 gsk_gpu_uber_op (GskGpuFrame             *frame,
                  GskGpuShaderClip         clip,
                  const graphene_rect_t   *rect,
                  const graphene_point_t  *offset,
                  GskGpuDescriptors       *desc,
+                 guint32                  program,
                  guint32                  pattern_id)
 {
   GskGpuUberInstance *instance;
 
   gsk_gpu_shader_op_alloc (frame,
                            &GSK_GPU_UBER_OP_CLASS,
-                           0,
+                           gsk_gpu_uber_op_get_variation (program),
                            clip,
                            desc,
                            &instance);
@@ -11,6 +11,7 @@ void                    gsk_gpu_uber_op                                 (GskGpuF
                                                                          const graphene_rect_t          *rect,
                                                                          const graphene_point_t         *offset,
                                                                          GskGpuDescriptors              *desc,
+                                                                         guint32                         program,
                                                                          guint32                         pattern_id);
 
 
@@ -9,10 +9,12 @@
 #include "gskglimageprivate.h"
 #ifdef GDK_RENDERING_VULKAN
 #include "gskvulkanbufferprivate.h"
+#include "gskvulkanframeprivate.h"
 #include "gskvulkanimageprivate.h"
 #endif
 
 #include "gdk/gdkglcontextprivate.h"
+#include "gdk/gdkparalleltaskprivate.h"
 #include "gsk/gskdebugprivate.h"
 
 static GskGpuOp *
@@ -101,13 +103,17 @@ gsk_gpu_upload_op_vk_command_with_area (GskGpuOp                    *op,
                                         void           (* draw_func) (GskGpuOp *, guchar *, gsize),
                                         GskGpuBuffer               **buffer)
 {
-  gsize stride;
+  gsize stride, bpp, offset;
   guchar *data;
 
-  stride = area->width * gdk_memory_format_bytes_per_pixel (gsk_gpu_image_get_format (GSK_GPU_IMAGE (image)));
-  *buffer = gsk_vulkan_buffer_new_write (GSK_VULKAN_DEVICE (gsk_gpu_frame_get_device (frame)),
-                                         area->height * stride);
-  data = gsk_gpu_buffer_map (*buffer);
+  bpp = gdk_memory_format_bytes_per_pixel (gsk_gpu_image_get_format (GSK_GPU_IMAGE (image)));
+  stride = area->width * bpp;
+  /* bufferOffset must be a multiple of 4 and of the texel size */
+  *buffer = gsk_vulkan_frame_alloc_staging (GSK_VULKAN_FRAME (frame),
+                                            area->height * stride,
+                                            4 * bpp,
+                                            &offset);
+  data = gsk_gpu_buffer_map (*buffer) + offset;
 
   draw_func (op, data, stride);
 
@@ -125,8 +131,8 @@ gsk_gpu_upload_op_vk_command_with_area (GskGpuOp                    *op,
                             .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
                             .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
                             .buffer = gsk_vulkan_buffer_get_vk_buffer (GSK_VULKAN_BUFFER (*buffer)),
-                            .offset = 0,
-                            .size = VK_WHOLE_SIZE,
+                            .offset = offset,
+                            .size = area->height * stride,
                         },
                         0, NULL);
   gsk_vulkan_image_transition (image, 
@@ -143,7 +149,7 @@ gsk_gpu_upload_op_vk_command_with_area (GskGpuOp                    *op,
                           1,
                           (VkBufferImageCopy[1]) {
                                {
-                                   .bufferOffset = 0,
+                                   .bufferOffset = offset,
                                    .bufferRowLength = area->width,
                                    .bufferImageHeight = area->height,
                                    .imageSubresource = {
@@ -343,10 +349,16 @@ struct _GskGpuUploadCairoOp
   GskGpuOp op;
 
   GskGpuImage *image;
+  cairo_rectangle_int_t area;
   graphene_rect_t viewport;
   GskGpuCairoFunc func;
   gpointer user_data;
   GDestroyNotify user_destroy;
+  gboolean threadsafe;
+
+  /* pixels rendered ahead of time by gsk_gpu_upload_cairo_ops_render_parallel() */
+  guchar *data;
+  gsize stride;
 
   GskGpuBuffer *buffer;
 };
@@ -359,6 +371,7 @@ gsk_gpu_upload_cairo_op_finish (GskGpuOp *op)
   g_object_unref (self->image);
   if (self->user_destroy)
     self->user_destroy (self->user_data);
+  g_free (self->data);
   g_clear_object (&self->buffer);
 }
 
@@ -372,21 +385,23 @@ gsk_gpu_upload_cairo_op_print (GskGpuOp    *op,
 
   gsk_gpu_print_op (string, indent, "upload-cairo");
   gsk_gpu_print_image (string, self->image);
+  if (self->area.width != gsk_gpu_image_get_width (self->image) ||
+      self->area.height != gsk_gpu_image_get_height (self->image))
+    gsk_gpu_print_int_rect (string, &self->area);
   gsk_gpu_print_newline (string);
 }
 
 static void
-gsk_gpu_upload_cairo_op_draw (GskGpuOp *op,
-                              guchar   *data,
-                              gsize     stride)
+gsk_gpu_upload_cairo_op_render (GskGpuUploadCairoOp *self,
+                                guchar              *data,
+                                gsize                stride)
 {
-  GskGpuUploadCairoOp *self = (GskGpuUploadCairoOp *) op;
   cairo_surface_t *surface;
   cairo_t *cr;
   int width, height;
 
-  width = gsk_gpu_image_get_width (self->image);
-  height = gsk_gpu_image_get_height (self->image);
+  width = self->area.width;
+  height = self->area.height;
 
   surface = cairo_image_surface_create_for_data (data,
                                                  CAIRO_FORMAT_ARGB32,
@@ -409,6 +424,26 @@ gsk_gpu_upload_cairo_op_draw (GskGpuOp *op,
   cairo_surface_destroy (surface);
 }
 
+static void
+gsk_gpu_upload_cairo_op_draw (GskGpuOp *op,
+                              guchar   *data,
+                              gsize     stride)
+{
+  GskGpuUploadCairoOp *self = (GskGpuUploadCairoOp *) op;
+  gsize y;
+
+  if (self->data == NULL)
+    {
+      gsk_gpu_upload_cairo_op_render (self, data, stride);
+      return;
+    }
+
+  for (y = 0; y < self->area.height; y++)
+    memcpy (data + y * stride, self->data + y * self->stride, self->area.width * 4);
+
+  g_clear_pointer (&self->data, g_free);
+}
+
 #ifdef GDK_RENDERING_VULKAN
 static GskGpuOp *
 gsk_gpu_upload_cairo_op_vk_command (GskGpuOp              *op,
@@ -417,12 +452,23 @@ gsk_gpu_upload_cairo_op_vk_command (GskGpuOp              *op,
 {
   GskGpuUploadCairoOp *self = (GskGpuUploadCairoOp *) op;
 
-  return gsk_gpu_upload_op_vk_command (op,
-                                       frame,
-                                       state,
-                                       GSK_VULKAN_IMAGE (self->image),
-                                       gsk_gpu_upload_cairo_op_draw,
-                                       &self->buffer);
+  if (self->area.x == 0 && self->area.y == 0 &&
+      self->area.width == gsk_gpu_image_get_width (self->image) &&
+      self->area.height == gsk_gpu_image_get_height (self->image))
+    return gsk_gpu_upload_op_vk_command (op,
+                                         frame,
+                                         state,
+                                         GSK_VULKAN_IMAGE (self->image),
+                                         gsk_gpu_upload_cairo_op_draw,
+                                         &self->buffer);
+
+  return gsk_gpu_upload_op_vk_command_with_area (op,
+                                                 frame,
+                                                 state,
+                                                 GSK_VULKAN_IMAGE (self->image),
+                                                 &self->area,
+                                                 gsk_gpu_upload_cairo_op_draw,
+                                                 &self->buffer);
 }
 #endif
 
@@ -433,10 +479,11 @@ gsk_gpu_upload_cairo_op_gl_command (GskGpuOp          *op,
 {
   GskGpuUploadCairoOp *self = (GskGpuUploadCairoOp *) op;
 
-  return gsk_gpu_upload_op_gl_command (op,
-                                       frame,
-                                       self->image,
-                                       gsk_gpu_upload_cairo_op_draw);
+  return gsk_gpu_upload_op_gl_command_with_area (op,
+                                                 frame,
+                                                 self->image,
+                                                 &self->area,
+                                                 gsk_gpu_upload_cairo_op_draw);
 }
 
 static const GskGpuOpClass GSK_GPU_UPLOAD_CAIRO_OP_CLASS = {
@@ -454,25 +501,146 @@ GskGpuImage *
 gsk_gpu_upload_cairo_op (GskGpuFrame           *frame,
                          const graphene_vec2_t *scale,
                          const graphene_rect_t *viewport,
+                         gboolean               threadsafe,
                          GskGpuCairoFunc        func,
                          gpointer               user_data,
                          GDestroyNotify         user_destroy)
+{
+  GskGpuImage *image;
+
+  image = gsk_gpu_device_create_upload_image (gsk_gpu_frame_get_device (frame),
+                                              FALSE,
+                                              GDK_MEMORY_DEFAULT,
+                                              ceil (graphene_vec2_get_x (scale) * viewport->size.width),
+                                              ceil (graphene_vec2_get_y (scale) * viewport->size.height));
+
+  gsk_gpu_upload_cairo_into_op (frame,
+                                image,
+                                &(cairo_rectangle_int_t) {
+                                    0, 0,
+                                    gsk_gpu_image_get_width (image),
+                                    gsk_gpu_image_get_height (image)
+                                },
+                                viewport,
+                                threadsafe,
+                                func,
+                                user_data,
+                                user_destroy);
+
+  g_object_unref (image);
+
+  return image;
+}
+
+/*
+ * gsk_gpu_upload_cairo_into_op:
+ * @frame: the frame
+ * @image: the image to draw into
+ * @area: the area of the image to draw into
+ * @viewport: the area of the cairo drawing that gets mapped to @area
+ * @threadsafe: %TRUE if @func may be called from a different thread
+ * @func: the function to draw with
+ * @user_data: data for @func
+ * @user_destroy: destroy notify for @user_data
+ *
+ * Like gsk_gpu_upload_cairo_op(), but draws into a part of an
+ * existing image, like an atlas.
+ */
+void
+gsk_gpu_upload_cairo_into_op (GskGpuFrame                 *frame,
+                              GskGpuImage                 *image,
+                              const cairo_rectangle_int_t *area,
+                              const graphene_rect_t       *viewport,
+                              gboolean                     threadsafe,
+                              GskGpuCairoFunc              func,
+                              gpointer                     user_data,
+                              GDestroyNotify               user_destroy)
 {
   GskGpuUploadCairoOp *self;
 
   self = (GskGpuUploadCairoOp *) gsk_gpu_op_alloc (frame, &GSK_GPU_UPLOAD_CAIRO_OP_CLASS);
 
-  self->image = gsk_gpu_device_create_upload_image (gsk_gpu_frame_get_device (frame),
-                                                    FALSE,
-                                                    GDK_MEMORY_DEFAULT,
-                                                    ceil (graphene_vec2_get_x (scale) * viewport->size.width),
-                                                    ceil (graphene_vec2_get_y (scale) * viewport->size.height));
+  self->image = g_object_ref (image);
+  self->area = *area;
   self->viewport = *viewport;
   self->func = func;
   self->user_data = user_data;
   self->user_destroy = user_destroy;
+  self->threadsafe = threadsafe;
+}
 
-  return self->image;
+typedef struct _RenderParallel RenderParallel;
+
+struct _RenderParallel
+{
+  GPtrArray *ops;
+  /* atomic */ int next;
+};
+
+static void
+gsk_gpu_upload_cairo_ops_render_task (gpointer data)
+{
+  RenderParallel *render = data;
+  int i;
+
+  for (i = g_atomic_int_add (&render->next, 1);
+       i < render->ops->len;
+       i = g_atomic_int_add (&render->next, 1))
+    {
+      GskGpuUploadCairoOp *self = g_ptr_array_index (render->ops, i);
+      gsize stride;
+      guchar *data;
+
+      stride = cairo_format_stride_for_width (CAIRO_FORMAT_ARGB32, self->area.width);
+      data = g_malloc (self->area.height * stride);
+
+      gsk_gpu_upload_cairo_op_render (self, data, stride);
+
+      self->stride = stride;
+      self->data = data;
+    }
+}
+
+/*
+ * gsk_gpu_upload_cairo_ops_render_parallel:
+ * @first_op: the first op of the frame
+ *
+ * Rasterizes the cairo drawings of all threadsafe upload ops in the
+ * op list on multiple threads.
+ *
+ * The ops then only need to copy the results when the command buffer
+ * is recorded. Cairo fallbacks are by far the most expensive part of
+ * recording on the CPU and they are fully independent of each other,
+ * so this is where threads pay off.
+ */
+void
+gsk_gpu_upload_cairo_ops_render_parallel (GskGpuOp *first_op)
+{
+  RenderParallel render = { NULL, 0 };
+  GskGpuOp *op;
+
+  for (op = first_op; op; op = op->next)
+    {
+      GskGpuUploadCairoOp *self = (GskGpuUploadCairoOp *) op;
+
+      if (op->op_class != &GSK_GPU_UPLOAD_CAIRO_OP_CLASS || !self->threadsafe)
+        continue;
+
+      if (render.ops == NULL)
+        render.ops = g_ptr_array_new ();
+      g_ptr_array_add (render.ops, self);
+    }
+
+  if (render.ops == NULL)
+    return;
+
+  /* No point in going through threads for a single op */
+  if (render.ops->len > 1)
+    gdk_parallel_task_run (gsk_gpu_upload_cairo_ops_render_task,
+                           &render,
+                           MIN (render.ops->len, g_get_num_processors ()));
+
+  g_ptr_array_unref (render.ops);
 }
 
 typedef struct _GskGpuUploadGlyphOp GskGpuUploadGlyphOp;
@@ -486,6 +654,7 @@ struct _GskGpuUploadGlyphOp
   PangoFont *font;
   PangoGlyph glyph;
   graphene_point_t origin;
+  guint sdf_spread;
 
   GskGpuBuffer *buffer;
 };
@@ -517,12 +686,82 @@ gsk_gpu_upload_glyph_op_print (GskGpuOp    *op,
   gsk_gpu_print_op (string, indent, "upload-glyph");
   gsk_gpu_print_int_rect (string, &self->area);
   g_string_append_printf (string, "glyph %u font %s ", self->glyph, str);
+  if (self->sdf_spread)
+    gsk_gpu_print_string (string, "sdf");
   gsk_gpu_print_newline (string);
 
   g_free (str);
   pango_font_description_free (desc);
 }
 
+/*
+ * Turns the rendered glyph coverage in @data into a signed distance
+ * field, so the glyph can be drawn at any scale from a single
+ * rasterization.
+ *
+ * Distances are measured in pixels to the nearest pixel on the other
+ * side of the outline, searching up to @spread pixels away, and stored
+ * as 0.5 + distance / (2 * spread) in all channels.
+ * Antialiased edge pixels use their coverage for subpixel precision.
+ */
+static void
+gsk_gpu_upload_glyph_op_compute_sdf (guchar *data,
+                                     gsize   stride,
+                                     int     width,
+                                     int     height,
+                                     int     spread)
+{
+  guchar *coverage;
+  int x, y, dx, dy;
+
+  coverage = g_malloc (width * height);
+  for (y = 0; y < height; y++)
+    {
+      const guint32 *row = (const guint32 *) (data + y * stride);
+
+      for (x = 0; x < width; x++)
+        coverage[y * width + x] = row[x] >> 24;
+    }
+
+  for (y = 0; y < height; y++)
+    {
+      guint32 *row = (guint32 *) (data + y * stride);
+
+      for (x = 0; x < width; x++)
+        {
+          guchar c = coverage[y * width + x];
+          gboolean inside = c >= 128;
+          int best = (spread + 1) * (spread + 1);
+          float dist;
+          guint32 v;
+
+          for (dy = MAX (-spread, -y); dy <= MIN (spread, height - 1 - y); dy++)
+            {
+              for (dx = MAX (-spread, -x); dx <= MIN (spread, width - 1 - x); dx++)
+                {
+                  int d2 = dx * dx + dy * dy;
+
+                  if (d2 < best &&
+                      (coverage[(y + dy) * width + x + dx] >= 128) != inside)
+                    best = d2;
+                }
+            }
+
+          if (c > 0 && c < 255 && best <= 2)
+            dist = c / 255.f - 0.5f;
+          else if (inside)
+            dist = sqrtf (best) - 0.5f;
+          else
+            dist = 0.5f - sqrtf (best);
+
+          v = (guint32) (CLAMP (0.5f + dist / (2 * spread), 0.f, 1.f) * 255.f + 0.5f);
+          row[x] = (v << 24) | (v << 16) | (v << 8) | v;
+        }
+    }
+
+  g_free (coverage);
+}
+
 static void
 gsk_gpu_upload_glyph_op_draw (GskGpuOp *op,
                               guchar   *data,
@@ -573,6 +812,9 @@ gsk_gpu_upload_glyph_op_draw (GskGpuOp *op,
 
   cairo_surface_finish (surface);
   cairo_surface_destroy (surface);
+
+  if (self->sdf_spread)
+    gsk_gpu_upload_glyph_op_compute_sdf (data, stride, self->area.width, self->area.height, self->sdf_spread);
 }
 
 #ifdef GDK_RENDERING_VULKAN
@@ -624,7 +866,8 @@ gsk_gpu_upload_glyph_op (GskGpuFrame                 *frame,
                          PangoFont                   *font,
                          const PangoGlyph             glyph,
                          const cairo_rectangle_int_t *area,
-                         const graphene_point_t      *origin)
+                         const graphene_point_t      *origin,
+                         guint                        sdf_spread)
 {
   GskGpuUploadGlyphOp *self;
 
@@ -635,4 +878,5 @@ gsk_gpu_upload_glyph_op (GskGpuFrame                 *frame,
   self->font = g_object_ref (font);
   self->glyph = glyph;
   self->origin = *origin;
+  self->sdf_spread = sdf_spread;
 }
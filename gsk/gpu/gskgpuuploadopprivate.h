@@ -16,16 +16,29 @@ GskGpuImage *           gsk_gpu_upload_texture_op_try                   (GskGpuF
 GskGpuImage *           gsk_gpu_upload_cairo_op                         (GskGpuFrame                    *frame,
                                                                          const graphene_vec2_t          *scale,
                                                                          const graphene_rect_t          *viewport,
+                                                                         gboolean                        threadsafe,
                                                                          GskGpuCairoFunc                 func,
                                                                          gpointer                        user_data,
                                                                          GDestroyNotify                  user_destroy);
 
+void                    gsk_gpu_upload_cairo_into_op                    (GskGpuFrame                    *frame,
+                                                                         GskGpuImage                    *image,
+                                                                         const cairo_rectangle_int_t    *area,
+                                                                         const graphene_rect_t          *viewport,
+                                                                         gboolean                        threadsafe,
+                                                                         GskGpuCairoFunc                 func,
+                                                                         gpointer                        user_data,
+                                                                         GDestroyNotify                  user_destroy);
+
+void                    gsk_gpu_upload_cairo_ops_render_parallel        (GskGpuOp                       *first_op);
+
 void                    gsk_gpu_upload_glyph_op                         (GskGpuFrame                    *frame,
                                                                          GskGpuImage                    *image,
                                                                          PangoFont                      *font,
                                                                          PangoGlyph                      glyph,
                                                                          const cairo_rectangle_int_t    *area,
-                                                                         const graphene_point_t         *origin);
+                                                                         const graphene_point_t         *origin,
+                                                                         guint                           sdf_spread);
 
 G_END_DECLS
 
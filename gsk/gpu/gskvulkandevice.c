@@ -8,14 +8,19 @@
 #include "gskvulkanimageprivate.h"
 
 #include "gdk/gdkdisplayprivate.h"
+#include "gdk/gdkprofilerprivate.h"
 #include "gdk/gdkvulkancontextprivate.h"
 
+/* Above this fraction of a heap's budget, we consider memory tight */
+#define LOW_MEMORY_BUDGET_PERCENT 90
+
 struct _GskVulkanDevice
 {
   GskGpuDevice parent_instance;
 
   GskVulkanAllocator *allocators[VK_MAX_MEMORY_TYPES];
   GskVulkanAllocator *external_allocator;
+  VkDeviceSize heap_usage[VK_MAX_MEMORY_HEAPS]; /* bytes allocated by us */
   GdkVulkanFeatures features;
 
   guint max_immutable_samplers;
@@ -23,6 +28,7 @@ struct _GskVulkanDevice
   guint max_buffers;
 
   GHashTable *conversion_cache;
+  GHashTable *format_cache;
   GHashTable *render_pass_cache;
   GHashTable *pipeline_layouts;
   GskVulkanPipelineLayout *pipeline_layout_cache;
@@ -38,7 +44,11 @@ struct _GskVulkanDeviceClass
 
 G_DEFINE_TYPE (GskVulkanDevice, gsk_vulkan_device, GSK_TYPE_GPU_DEVICE)
 
+static guint memory_used_counter;
+static guint memory_budget_counter;
+
 typedef struct _ConversionCacheEntry ConversionCacheEntry;
+typedef struct _FormatCacheEntry FormatCacheEntry;
 typedef struct _PipelineCacheKey PipelineCacheKey;
 typedef struct _RenderPassCacheKey RenderPassCacheKey;
 typedef struct _GskVulkanPipelineLayoutSetup GskVulkanPipelineLayoutSetup;
@@ -73,6 +83,19 @@ struct _ConversionCacheEntry
   VkSampler vk_sampler;
 };
 
+struct _FormatCacheEntry
+{
+  VkFormat vk_format;
+  uint64_t modifier;
+  guint n_planes;
+  VkImageTiling tiling;
+  VkImageUsageFlags usage;
+
+  /* actual data */
+  VkFormatFeatureFlags features;
+  VkExtent3D max_extent;
+};
+
 struct _PipelineCacheKey
 {
   const GskGpuShaderOpClass *op_class;
@@ -107,6 +130,32 @@ conversion_cache_entry_equal (gconstpointer a,
   return keya->vk_format == keyb->vk_format;
 }
 
+static guint
+format_cache_entry_hash (gconstpointer data)
+{
+  const FormatCacheEntry *key = data;
+
+  return key->vk_format ^
+         (guint) (key->modifier ^ (key->modifier >> 32)) ^
+         (key->n_planes << 24) ^
+         (key->tiling << 28) ^
+         (key->usage << 12);
+}
+
+static gboolean
+format_cache_entry_equal (gconstpointer a,
+                          gconstpointer b)
+{
+  const FormatCacheEntry *keya = a;
+  const FormatCacheEntry *keyb = b;
+
+  return keya->vk_format == keyb->vk_format &&
+         keya->modifier == keyb->modifier &&
+         keya->n_planes == keyb->n_planes &&
+         keya->tiling == keyb->tiling &&
+         keya->usage == keyb->usage;
+}
+
 static guint
 pipeline_cache_key_hash (gconstpointer data)
 {
@@ -399,10 +448,11 @@ gsk_vulkan_device_create_upload_image (GskGpuDevice    *device,
 }
 
 static GskGpuImage *
-gsk_vulkan_device_create_download_image (GskGpuDevice   *device,
-                                         GdkMemoryDepth  depth,
-                                         gsize           width,
-                                         gsize           height)
+gsk_vulkan_device_create_download_image (GskGpuDevice     *device,
+                                         GdkMemoryDepth    depth,
+                                         GdkDmabufFormats *scanout_formats,
+                                         gsize             width,
+                                         gsize             height)
 {
   GskVulkanDevice *self = GSK_VULKAN_DEVICE (device);
   GskGpuImage *image;
@@ -410,6 +460,7 @@ gsk_vulkan_device_create_download_image (GskGpuDevice   *device,
 #ifdef HAVE_DMABUF
   image = gsk_vulkan_image_new_dmabuf (self,
                                        gdk_memory_depth_get_format (depth),
+                                       scanout_formats,
                                        width,
                                        height);
   if (image != NULL)
@@ -459,6 +510,8 @@ gsk_vulkan_device_finalize (GObject *object)
     }
   g_hash_table_unref (self->conversion_cache);
 
+  g_hash_table_unref (self->format_cache);
+
   g_hash_table_iter_init (&iter, self->render_pass_cache);
   while (g_hash_table_iter_next (&iter, &key, &value))
     {
@@ -488,6 +541,80 @@ gsk_vulkan_device_finalize (GObject *object)
   G_OBJECT_CLASS (gsk_vulkan_device_parent_class)->finalize (object);
 }
 
+static gboolean
+gsk_vulkan_device_trim (GskGpuDevice *device)
+{
+  GskVulkanDevice *self = GSK_VULKAN_DEVICE (device);
+  VkPhysicalDeviceMemoryBudgetPropertiesEXT budget = {
+    .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT,
+  };
+  VkPhysicalDeviceMemoryProperties2 properties = {
+    .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+  };
+  gboolean has_budget, low_memory;
+  VkDeviceSize total;
+  guint max_percent;
+  gsize i;
+
+  for (i = 0; i < VK_MAX_MEMORY_TYPES; i++)
+    {
+      if (self->allocators[i])
+        gsk_vulkan_allocator_trim (self->allocators[i]);
+    }
+
+  has_budget = gsk_vulkan_device_has_feature (self, GDK_VULKAN_FEATURE_MEMORY_BUDGET);
+  if (has_budget)
+    properties.pNext = &budget;
+
+  vkGetPhysicalDeviceMemoryProperties2 (gsk_vulkan_device_get_vk_physical_device (self),
+                                        &properties);
+
+  low_memory = FALSE;
+  total = 0;
+  max_percent = 0;
+  for (i = 0; i < properties.memoryProperties.memoryHeapCount; i++)
+    {
+      const VkMemoryHeap *heap = &properties.memoryProperties.memoryHeaps[i];
+
+      total += self->heap_usage[i];
+
+      if (has_budget && budget.heapBudget[i] > 0)
+        {
+          guint percent = budget.heapUsage[i] * 100 / budget.heapBudget[i];
+
+          max_percent = MAX (max_percent, percent);
+          if (percent >= LOW_MEMORY_BUDGET_PERCENT)
+            low_memory = TRUE;
+
+          GSK_DEBUG (VULKAN, "Heap %zu%s: %" G_GUINT64_FORMAT " kB used by us, "
+                             "%" G_GUINT64_FORMAT " of %" G_GUINT64_FORMAT " kB budget used (%u%%)",
+                     i,
+                     heap->flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT ? " (device local)" : "",
+                     (guint64) self->heap_usage[i] / 1024,
+                     (guint64) budget.heapUsage[i] / 1024,
+                     (guint64) budget.heapBudget[i] / 1024,
+                     percent);
+        }
+      else
+        {
+          GSK_DEBUG (VULKAN, "Heap %zu%s: %" G_GUINT64_FORMAT " kB used by us, %" G_GUINT64_FORMAT " kB size",
+                     i,
+                     heap->flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT ? " (device local)" : "",
+                     (guint64) self->heap_usage[i] / 1024,
+                     (guint64) heap->size / 1024);
+        }
+    }
+
+  gdk_profiler_set_int_counter (memory_used_counter, total / 1024);
+  if (has_budget)
+    gdk_profiler_set_int_counter (memory_budget_counter, max_percent);
+
+  if (low_memory)
+    GSK_DEBUG (VULKAN, "Memory budget exceeds %u%%, freeing caches", LOW_MEMORY_BUDGET_PERCENT);
+
+  return low_memory;
+}
+
 static void
 gsk_vulkan_device_class_init (GskVulkanDeviceClass *klass)
 {
@@ -499,14 +626,19 @@ gsk_vulkan_device_class_init (GskVulkanDeviceClass *klass)
   gpu_device_class->create_upload_image = gsk_vulkan_device_create_upload_image;
   gpu_device_class->create_download_image = gsk_vulkan_device_create_download_image;
   gpu_device_class->make_current = gsk_vulkan_device_make_current;
+  gpu_device_class->trim = gsk_vulkan_device_trim;
 
   object_class->finalize = gsk_vulkan_device_finalize;
+
+  memory_used_counter = gdk_profiler_define_int_counter ("vulkan-memory", "Vulkan memory allocated, in kB");
+  memory_budget_counter = gdk_profiler_define_int_counter ("vulkan-budget", "Highest Vulkan heap budget use, in percent");
 }
 
 static void
 gsk_vulkan_device_init (GskVulkanDevice *self)
 {
   self->conversion_cache = g_hash_table_new (conversion_cache_entry_hash, conversion_cache_entry_equal);
+  self->format_cache = g_hash_table_new_full (format_cache_entry_hash, format_cache_entry_equal, g_free, NULL);
   self->render_pass_cache = g_hash_table_new (render_pass_cache_key_hash, render_pass_cache_key_equal);
   self->pipeline_layouts = g_hash_table_new (gsk_vulkan_pipeline_layout_setup_hash, gsk_vulkan_pipeline_layout_setup_equal);
 }
@@ -816,6 +948,146 @@ gsk_vulkan_device_get_vk_conversion (GskVulkanDevice *self,
   return entry->vk_conversion;
 }
 
+/*
+ * gsk_vulkan_device_get_format_features:
+ * @self: a GskVulkanDevice
+ * @vk_format: the format to query
+ * @modifier: the modifier, only used for VK_IMAGE_TILING_DRM_FORMAT_MODIFIER_EXT
+ * @n_planes: the number of memory planes, only used for
+ *   VK_IMAGE_TILING_DRM_FORMAT_MODIFIER_EXT
+ * @tiling: the tiling to query
+ * @usage: the usage the image will be created with
+ * @out_max_extent: (out): the largest supported image size
+ *
+ * Queries the features images with the given properties can be
+ * sampled with.
+ *
+ * The results are cached, because dmabuf textures query them for
+ * every imported buffer and clients usually produce a stream of
+ * buffers with the same properties.
+ *
+ * Returns: the supported features or 0 if such images can't be
+ *   sampled from
+ */
+VkFormatFeatureFlags
+gsk_vulkan_device_get_format_features (GskVulkanDevice   *self,
+                                       VkFormat           vk_format,
+                                       uint64_t           modifier,
+                                       guint              n_planes,
+                                       VkImageTiling      tiling,
+                                       VkImageUsageFlags  usage,
+                                       VkExtent3D        *out_max_extent)
+{
+  VkDrmFormatModifierPropertiesEXT drm_mod_properties[100];
+  VkDrmFormatModifierPropertiesListEXT drm_properties;
+  VkPhysicalDevice vk_phys_device;
+  VkFormatProperties2 properties;
+  VkImageFormatProperties2 image_properties;
+  FormatCacheEntry lookup;
+  FormatCacheEntry *entry;
+  VkFormatFeatureFlags features;
+  VkResult res;
+  gsize i;
+
+  if (tiling != VK_IMAGE_TILING_DRM_FORMAT_MODIFIER_EXT)
+    {
+      modifier = 0;
+      n_planes = 0;
+    }
+
+  lookup = (FormatCacheEntry) {
+    .vk_format = vk_format,
+    .modifier = modifier,
+    .n_planes = n_planes,
+    .tiling = tiling,
+    .usage = usage,
+  };
+  entry = g_hash_table_lookup (self->format_cache, &lookup);
+  if (entry)
+    {
+      *out_max_extent = entry->max_extent;
+      return entry->features;
+    }
+
+  vk_phys_device = gsk_vulkan_device_get_vk_physical_device (self);
+
+  drm_properties = (VkDrmFormatModifierPropertiesListEXT) {
+    .sType = VK_STRUCTURE_TYPE_DRM_FORMAT_MODIFIER_PROPERTIES_LIST_EXT,
+    .drmFormatModifierCount = G_N_ELEMENTS (drm_mod_properties),
+    .pDrmFormatModifierProperties = drm_mod_properties,
+  };
+  properties = (VkFormatProperties2) {
+    .sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2,
+    .pNext = (tiling != VK_IMAGE_TILING_DRM_FORMAT_MODIFIER_EXT) ? NULL : &drm_properties
+  };
+  vkGetPhysicalDeviceFormatProperties2 (vk_phys_device,
+                                        vk_format,
+                                        &properties);
+
+  switch ((int) tiling)
+    {
+      case VK_IMAGE_TILING_OPTIMAL:
+        features = properties.formatProperties.optimalTilingFeatures;
+        break;
+      case VK_IMAGE_TILING_LINEAR:
+        features = properties.formatProperties.linearTilingFeatures;
+        break;
+      case VK_IMAGE_TILING_DRM_FORMAT_MODIFIER_EXT:
+        features = 0;
+        for (i = 0; i < drm_properties.drmFormatModifierCount; i++)
+          {
+            if (drm_mod_properties[i].drmFormatModifier == modifier &&
+                drm_mod_properties[i].drmFormatModifierPlaneCount == n_planes)
+              {
+                features = drm_mod_properties[i].drmFormatModifierTilingFeatures;
+                break;
+              }
+          }
+        break;
+      default:
+        features = 0;
+        break;
+    }
+
+  if (!(features & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT))
+    features = 0;
+
+  image_properties = (VkImageFormatProperties2) {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_FORMAT_PROPERTIES_2,
+  };
+  if (features != 0)
+    {
+      res = vkGetPhysicalDeviceImageFormatProperties2 (vk_phys_device,
+                                                       &(VkPhysicalDeviceImageFormatInfo2) {
+                                                         .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_FORMAT_INFO_2,
+                                                         .format = vk_format,
+                                                         .type = VK_IMAGE_TYPE_2D,
+                                                         .tiling = tiling,
+                                                         .usage = usage,
+                                                         .flags = 0,
+                                                         .pNext = (tiling != VK_IMAGE_TILING_DRM_FORMAT_MODIFIER_EXT) ? NULL : &(VkPhysicalDeviceImageDrmFormatModifierInfoEXT) {
+                                                             .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_DRM_FORMAT_MODIFIER_INFO_EXT,
+                                                             .drmFormatModifier = modifier,
+                                                             .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+                                                             .queueFamilyIndexCount = 1,
+                                                             .pQueueFamilyIndices = (uint32_t[1]) { gsk_vulkan_device_get_vk_queue_family_index (self) },
+                                                          }
+                                                       },
+                                                       &image_properties);
+      if (res != VK_SUCCESS)
+        features = 0;
+    }
+
+  entry = g_memdup (&lookup, sizeof (FormatCacheEntry));
+  entry->features = features;
+  entry->max_extent = features ? image_properties.imageFormatProperties.maxExtent : (VkExtent3D) { 0, 0, 0 };
+  g_hash_table_add (self->format_cache, entry);
+
+  *out_max_extent = entry->max_extent;
+
+  return entry->features;
+}
+
 VkRenderPass
 gsk_vulkan_device_get_vk_render_pass (GskVulkanDevice *self,
                                       VkFormat         format,
@@ -1196,7 +1468,8 @@ gsk_vulkan_device_get_allocator (GskVulkanDevice    *self,
     {
       self->allocators[index] = gsk_vulkan_direct_allocator_new (gsk_vulkan_device_get_vk_device (self),
                                                                  index,
-                                                                 type);
+                                                                 type,
+                                                                 &self->heap_usage[type->heapIndex]);
       self->allocators[index] = gsk_vulkan_buddy_allocator_new (self->allocators[index],
                                                                 1024 * 1024);
       //allocators[index] = gsk_vulkan_stats_allocator_new (allocators[index]);
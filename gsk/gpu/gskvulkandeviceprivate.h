@@ -66,6 +66,13 @@ VkSamplerYcbcrConversion
                         gsk_vulkan_device_get_vk_conversion             (GskVulkanDevice        *self,
                                                                          VkFormat                vk_format,
                                                                          VkSampler              *out_sampler);
+VkFormatFeatureFlags    gsk_vulkan_device_get_format_features           (GskVulkanDevice        *self,
+                                                                         VkFormat                vk_format,
+                                                                         uint64_t                modifier,
+                                                                         guint                   n_planes,
+                                                                         VkImageTiling           tiling,
+                                                                         VkImageUsageFlags       usage,
+                                                                         VkExtent3D             *out_max_extent);
 VkRenderPass            gsk_vulkan_device_get_vk_render_pass            (GskVulkanDevice        *self,
                                                                          VkFormat                format,
                                                                          VkImageLayout           from_layout,
@@ -13,6 +13,11 @@
 #include "gdk/gdkdisplayprivate.h"
 #include "gdk/gdkdmabuftextureprivate.h"
 
+/* The staging buffer grows in powers of 2 up to the max size, larger uploads
+ * get their own buffer */
+#define DEFAULT_STAGING_BUFFER_SIZE (1024 * 1024)
+#define MAX_STAGING_BUFFER_SIZE (32 * 1024 * 1024)
+
 #define GDK_ARRAY_NAME gsk_descriptors
 #define GDK_ARRAY_TYPE_NAME GskDescriptors
 #define GDK_ARRAY_ELEMENT_TYPE GskVulkanRealDescriptors *
@@ -51,9 +56,18 @@ struct _GskVulkanFrame
 
   GskDescriptors descriptors;
 
+  GskGpuBuffer *staging_buffer;
+  gsize staging_size;
+  gsize staging_used;
+
   gsize pool_n_sets;
   gsize pool_n_images;
   gsize pool_n_buffers;
+
+  float timestamp_period; /* in ns, or 0 if timestamps are not supported */
+  VkQueryPool vk_timestamp_pool;
+  guint32 n_timestamp_queries;
+  guint32 n_used_timestamp_queries;
 };
 
 struct _GskVulkanFrameClass
@@ -96,11 +110,16 @@ gsk_vulkan_frame_setup (GskGpuFrame *frame)
   GskVulkanDevice *device;
   VkDevice vk_device;
   VkCommandPool vk_command_pool;
+  VkPhysicalDeviceProperties props;
 
   device = GSK_VULKAN_DEVICE (gsk_gpu_frame_get_device (frame));
   vk_device = gsk_vulkan_device_get_vk_device (device);
   vk_command_pool = gsk_vulkan_device_get_vk_command_pool (device);
 
+  vkGetPhysicalDeviceProperties (gsk_vulkan_device_get_vk_physical_device (device), &props);
+  if (props.limits.timestampComputeAndGraphics)
+    self->timestamp_period = props.limits.timestampPeriod;
+
   GSK_VK_CHECK (vkAllocateCommandBuffers, vk_device,
                                           &(VkCommandBufferAllocateInfo) {
                                               .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
@@ -135,6 +154,34 @@ gsk_vulkan_frame_cleanup (GskGpuFrame *frame)
                                  VK_TRUE,
                                  INT64_MAX);
 
+  if (self->n_used_timestamp_queries > 0)
+    {
+      guint64 *timestamps;
+      guint32 i;
+
+      timestamps = g_new (guint64, self->n_used_timestamp_queries);
+      if (vkGetQueryPoolResults (vk_device,
+                                 self->vk_timestamp_pool,
+                                 0, self->n_used_timestamp_queries,
+                                 self->n_used_timestamp_queries * sizeof (guint64),
+                                 timestamps,
+                                 sizeof (guint64),
+                                 VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT) == VK_SUCCESS)
+        {
+          for (i = 0; i < self->n_used_timestamp_queries; i++)
+            timestamps[i] = (guint64) (timestamps[i] * (double) self->timestamp_period);
+
+          gsk_gpu_frame_report_timings (frame, timestamps);
+        }
+      else
+        {
+          gsk_gpu_frame_report_timings (frame, NULL);
+        }
+
+      g_free (timestamps);
+      self->n_used_timestamp_queries = 0;
+    }
+
   GSK_VK_CHECK (vkResetFences, vk_device,
                                1,
                                &self->vk_fence);
@@ -151,6 +198,9 @@ gsk_vulkan_frame_cleanup (GskGpuFrame *frame)
 
   gsk_descriptors_set_size (&self->descriptors, 0);
 
+  /* The fence has signalled, so the GPU is done reading the staging buffer */
+  self->staging_used = 0;
+
   GSK_GPU_FRAME_CLASS (gsk_vulkan_frame_parent_class)->cleanup (frame);
 }
 
@@ -295,6 +345,42 @@ gsk_vulkan_frame_create_storage_buffer (GskGpuFrame *frame,
   return gsk_vulkan_buffer_new_storage (GSK_VULKAN_DEVICE (gsk_gpu_frame_get_device (frame)), size);
 }
 
+static void
+gsk_vulkan_frame_ensure_timestamp_pool (GskVulkanFrame *self,
+                                        guint32         n_queries)
+{
+  VkDevice vk_device;
+
+  if (n_queries <= self->n_timestamp_queries)
+    return;
+
+  vk_device = gsk_vulkan_device_get_vk_device (GSK_VULKAN_DEVICE (gsk_gpu_frame_get_device (GSK_GPU_FRAME (self))));
+
+  if (self->vk_timestamp_pool != VK_NULL_HANDLE)
+    vkDestroyQueryPool (vk_device, self->vk_timestamp_pool, NULL);
+
+  self->n_timestamp_queries = MAX (64, 1 << g_bit_storage (n_queries - 1));
+
+  GSK_VK_CHECK (vkCreateQueryPool, vk_device,
+                                   &(VkQueryPoolCreateInfo) {
+                                       .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+                                       .queryType = VK_QUERY_TYPE_TIMESTAMP,
+                                       .queryCount = self->n_timestamp_queries,
+                                   },
+                                   NULL,
+                                   &self->vk_timestamp_pool);
+}
+
+static void
+gsk_vulkan_frame_write_timestamp (GskVulkanFrame *self)
+{
+  vkCmdWriteTimestamp (self->vk_command_buffer,
+                       VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                       self->vk_timestamp_pool,
+                       self->n_used_timestamp_queries);
+  self->n_used_timestamp_queries++;
+}
+
 static void
 gsk_vulkan_frame_submit (GskGpuFrame  *frame,
                          GskGpuBuffer *vertex_buffer,
@@ -303,6 +389,21 @@ gsk_vulkan_frame_submit (GskGpuFrame  *frame,
   GskVulkanFrame *self = GSK_VULKAN_FRAME (frame);
   GskVulkanSemaphores semaphores;
   GskVulkanCommandState state;
+  guint32 n_queries = 0;
+  gboolean timed;
+
+  timed = gsk_gpu_frame_should_time_ops (frame) && self->timestamp_period > 0;
+  if (timed)
+    {
+      GskGpuOp *o;
+
+      /* One per op is an upper bound, ops may record more than one op at once */
+      n_queries = 1;
+      for (o = op; o; o = o->next)
+        n_queries++;
+
+      gsk_vulkan_frame_ensure_timestamp_pool (self, n_queries);
+    }
 
   if (gsk_descriptors_get_size (&self->descriptors) == 0)
     gsk_descriptors_append (&self->descriptors, gsk_vulkan_real_descriptors_new (self));
@@ -315,6 +416,9 @@ gsk_vulkan_frame_submit (GskGpuFrame  *frame,
                                           .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
                                       });
 
+  if (timed)
+    vkCmdResetQueryPool (self->vk_command_buffer, self->vk_timestamp_pool, 0, n_queries);
+
   if (vertex_buffer)
     vkCmdBindVertexBuffers (self->vk_command_buffer,
                             0,
@@ -341,9 +445,18 @@ gsk_vulkan_frame_submit (GskGpuFrame  *frame,
 
   while (op)
     {
+      if (timed)
+        {
+          gsk_gpu_frame_add_timed_op (frame, op);
+          gsk_vulkan_frame_write_timestamp (self);
+        }
+
       op = gsk_gpu_op_vk_command (op, frame, &state);
     }
 
+  if (timed)
+    gsk_vulkan_frame_write_timestamp (self);
+
   GSK_VK_CHECK (vkEndCommandBuffer, self->vk_command_buffer);
 
   GSK_VK_CHECK (vkQueueSubmit, gsk_vulkan_device_get_vk_queue (GSK_VULKAN_DEVICE (gsk_gpu_frame_get_device (frame))),
@@ -384,6 +497,7 @@ gsk_vulkan_frame_finalize (GObject *object)
                                NULL);
     }
   gsk_descriptors_clear (&self->descriptors);
+  g_clear_object (&self->staging_buffer);
 
   vkFreeCommandBuffers (vk_device,
                         vk_command_pool,
@@ -391,6 +505,10 @@ gsk_vulkan_frame_finalize (GObject *object)
   vkDestroyFence (vk_device,
                   self->vk_fence,
                   NULL);
+  if (self->vk_timestamp_pool != VK_NULL_HANDLE)
+    vkDestroyQueryPool (vk_device,
+                        self->vk_timestamp_pool,
+                        NULL);
 
   G_OBJECT_CLASS (gsk_vulkan_frame_parent_class)->finalize (object);
 }
@@ -430,6 +548,63 @@ gsk_vulkan_frame_get_vk_fence (GskVulkanFrame *self)
   return self->vk_fence;
 }
 
+/*
+ * gsk_vulkan_frame_alloc_staging:
+ * @self: the frame
+ * @size: number of bytes needed
+ * @alignment: required alignment of the offset
+ * @out_offset: (out): offset of the allocated range in the buffer
+ *
+ * Allocates a range of a host-mapped buffer to copy data to the GPU from.
+ *
+ * Instead of creating a new buffer for every upload, the frame keeps one
+ * persistent staging buffer that it hands out in consecutive ranges. It
+ * is reused from the start once the frame's fence has signalled.
+ *
+ * Returns: (transfer full): the buffer to write to
+ */
+GskGpuBuffer *
+gsk_vulkan_frame_alloc_staging (GskVulkanFrame *self,
+                                gsize           size,
+                                gsize           alignment,
+                                gsize          *out_offset)
+{
+  GskVulkanDevice *device;
+  gsize offset;
+
+  device = GSK_VULKAN_DEVICE (gsk_gpu_frame_get_device (GSK_GPU_FRAME (self)));
+
+  offset = (self->staging_used + alignment - 1) / alignment * alignment;
+
+  if (self->staging_buffer == NULL || offset + size > self->staging_size)
+    {
+      gsize new_size;
+
+      if (size > MAX_STAGING_BUFFER_SIZE)
+        {
+          *out_offset = 0;
+          return gsk_vulkan_buffer_new_write (device, size);
+        }
+
+      new_size = MAX (self->staging_size, DEFAULT_STAGING_BUFFER_SIZE);
+      if (self->staging_used > 0)
+        new_size = MIN (new_size * 2, MAX_STAGING_BUFFER_SIZE);
+      while (new_size < size)
+        new_size *= 2;
+
+      /* Ops that already use the old buffer keep a reference to it */
+      g_clear_object (&self->staging_buffer);
+      self->staging_buffer = gsk_vulkan_buffer_new_write (device, new_size);
+      self->staging_size = new_size;
+      offset = 0;
+    }
+
+  self->staging_used = offset + size;
+  *out_offset = offset;
+
+  return g_object_ref (self->staging_buffer);
+}
+
 void
 gsk_vulkan_semaphores_add_wait (GskVulkanSemaphores  *self,
                                 VkSemaphore           semaphore,
@@ -67,84 +67,21 @@ gsk_vulkan_device_supports_format (GskVulkanDevice   *device,
                                    gsize              height,
                                    GskGpuImageFlags  *out_flags)
 {
-  VkDrmFormatModifierPropertiesEXT drm_mod_properties[100];
-  VkDrmFormatModifierPropertiesListEXT drm_properties;
-  VkPhysicalDevice vk_phys_device;
-  VkFormatProperties2 properties;
-  VkImageFormatProperties2 image_properties;
   VkFormatFeatureFlags features;
-  VkResult res;
-  gsize i;
-
-  vk_phys_device = gsk_vulkan_device_get_vk_physical_device (device);
-
-  drm_properties = (VkDrmFormatModifierPropertiesListEXT) {
-    .sType = VK_STRUCTURE_TYPE_DRM_FORMAT_MODIFIER_PROPERTIES_LIST_EXT,
-    .drmFormatModifierCount = G_N_ELEMENTS (drm_mod_properties),
-    .pDrmFormatModifierProperties = drm_mod_properties,
-  };
-  properties = (VkFormatProperties2) {
-    .sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2,
-    .pNext = (tiling != VK_IMAGE_TILING_DRM_FORMAT_MODIFIER_EXT) ? NULL : &drm_properties
-  };
-  vkGetPhysicalDeviceFormatProperties2 (vk_phys_device,
-                                        format,
-                                        &properties);
-
-  switch ((int) tiling)
-    {
-      case VK_IMAGE_TILING_OPTIMAL:
-        features = properties.formatProperties.optimalTilingFeatures;
-        break;
-      case VK_IMAGE_TILING_LINEAR:
-        features = properties.formatProperties.linearTilingFeatures;
-        break;
-      case VK_IMAGE_TILING_DRM_FORMAT_MODIFIER_EXT:
-        features = 0;
-        for (i = 0; i < drm_properties.drmFormatModifierCount; i++)
-          {
-            if (drm_mod_properties[i].drmFormatModifier == modifier &&
-                drm_mod_properties[i].drmFormatModifierPlaneCount == n_planes)
-              {
-                features = drm_mod_properties[i].drmFormatModifierTilingFeatures;
-                break;
-              }
-          }
-        if (features == 0)
-          return FALSE;
-        break;
-      default:
-        return FALSE;
-    }
-
-  if (!(features & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT))
-    return FALSE;
-
-  image_properties = (VkImageFormatProperties2) {
-    .sType = VK_STRUCTURE_TYPE_IMAGE_FORMAT_PROPERTIES_2,
-  };
-  res = vkGetPhysicalDeviceImageFormatProperties2 (vk_phys_device,
-                                                   &(VkPhysicalDeviceImageFormatInfo2) {
-                                                     .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_FORMAT_INFO_2,
-                                                     .format = format,
-                                                     .type = VK_IMAGE_TYPE_2D,
-                                                     .tiling = tiling,
-                                                     .usage = usage,
-                                                     .flags = 0,
-                                                     .pNext = (tiling != VK_IMAGE_TILING_DRM_FORMAT_MODIFIER_EXT) ? NULL : &(VkPhysicalDeviceImageDrmFormatModifierInfoEXT) {
-                                                         .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_DRM_FORMAT_MODIFIER_INFO_EXT,
-                                                         .drmFormatModifier = modifier,
-                                                         .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-                                                         .queueFamilyIndexCount = 1,
-                                                         .pQueueFamilyIndices = (uint32_t[1]) { gsk_vulkan_device_get_vk_queue_family_index (device) },
-                                                      }
-                                                   },
-                                                   &image_properties);
-  if (res != VK_SUCCESS)
+  VkExtent3D max_extent;
+
+  features = gsk_vulkan_device_get_format_features (device,
+                                                    format,
+                                                    modifier,
+                                                    n_planes,
+                                                    tiling,
+                                                    usage,
+                                                    &max_extent);
+  if (features == 0)
     return FALSE;
 
-  if (image_properties.imageFormatProperties.maxExtent.width < width ||
-      image_properties.imageFormatProperties.maxExtent.height < height)
+  if (max_extent.width < width ||
+      max_extent.height < height)
     return FALSE;
 
   *out_flags = 0;
@@ -297,6 +234,9 @@ gsk_vulkan_image_new (GskVulkanDevice           *device,
         }
     }
 
+  if (scanout_formats)
+    gsk_vulkan_image_prefer_scanout_modifiers (format, scanout_formats, modifiers, &n_modifiers);
+
   if (gdk_memory_format_alpha (format) == GDK_MEMORY_ALPHA_STRAIGHT)
     flags |= GSK_GPU_IMAGE_STRAIGHT_ALPHA;
 
@@ -609,11 +549,45 @@ gsk_vulkan_device_check_dmabuf_format (GskVulkanDevice          *device,
   return TRUE;
 }
 
+/* Restricts the modifiers to the ones that the compositor can scan out,
+ * so that our images can go to the screen without another copy. If
+ * none of them qualify, we keep the list as is.
+ */
+static void
+gsk_vulkan_image_prefer_scanout_modifiers (GdkMemoryFormat   format,
+                                           GdkDmabufFormats *scanout_formats,
+                                           uint64_t         *modifiers,
+                                           gsize            *n_modifiers)
+{
+  guint32 fourcc;
+  gsize i, n;
+
+  fourcc = gdk_memory_format_get_dmabuf_fourcc (format);
+  if (fourcc == 0)
+    return;
+
+  n = 0;
+  for (i = 0; i < *n_modifiers; i++)
+    {
+      if (gdk_dmabuf_formats_contains (scanout_formats, fourcc, modifiers[i]))
+        modifiers[n++] = modifiers[i];
+    }
+
+  if (n == 0)
+    return;
+
+  GDK_DEBUG (DMABUF, "Using %zu of %zu modifiers for %.4s that can be scanned out",
+             n, *n_modifiers, (char *) &fourcc);
+
+  *n_modifiers = n;
+}
+
 GskGpuImage *
-gsk_vulkan_image_new_dmabuf (GskVulkanDevice *device,
-                             GdkMemoryFormat  format,
-                             gsize            width,
-                             gsize            height)
+gsk_vulkan_image_new_dmabuf (GskVulkanDevice  *device,
+                             GdkMemoryFormat   format,
+                             GdkDmabufFormats *scanout_formats,
+                             gsize             width,
+                             gsize             height)
 {
   uint64_t modifiers[100];
   VkDevice vk_device;
@@ -33,6 +33,7 @@ GskGpuImage *           gsk_vulkan_image_new_for_upload                 (GskVulk
 #ifdef HAVE_DMABUF
 GskGpuImage *           gsk_vulkan_image_new_dmabuf                     (GskVulkanDevice        *device,
                                                                          GdkMemoryFormat         format,
+                                                                         GdkDmabufFormats       *scanout_formats,
                                                                          gsize                   width,
                                                                          gsize                   height);
 GskGpuImage *           gsk_vulkan_image_new_for_dmabuf                 (GskVulkanDevice        *device,
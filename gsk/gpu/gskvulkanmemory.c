@@ -16,6 +16,7 @@ struct _GskVulkanDirectAllocator
   VkDevice device; /* no reference held */
   uint32_t vk_memory_type_index;
   VkMemoryType vk_memory_type;
+  VkDeviceSize *heap_usage; /* shared between all types of the heap */
 };
 
 static void
@@ -58,6 +59,8 @@ gsk_vulkan_direct_allocator_alloc (GskVulkanAllocator  *allocator,
   alloc->offset = 0;
   alloc->size = size;
   alloc->memory_flags = self->vk_memory_type.propertyFlags;
+
+  *self->heap_usage += size;
 }
 
 static void
@@ -72,12 +75,16 @@ gsk_vulkan_direct_allocator_free (GskVulkanAllocator  *allocator,
   vkFreeMemory (self->device,
                 alloc->vk_memory,
                 NULL);
+
+  *self->heap_usage -= alloc->size;
 }
 
+/* heap_usage is updated with the bytes allocated from the device */
 GskVulkanAllocator *
 gsk_vulkan_direct_allocator_new (VkDevice            device,
                                  uint32_t            vk_type_index,
-                                 const VkMemoryType *vk_type)
+                                 const VkMemoryType *vk_type,
+                                 VkDeviceSize       *heap_usage)
 {
   GskVulkanDirectAllocator *self;
 
@@ -89,6 +96,7 @@ gsk_vulkan_direct_allocator_new (VkDevice            device,
   self->device = device;
   self->vk_memory_type_index = vk_type_index;
   self->vk_memory_type = *vk_type;
+  self->heap_usage = heap_usage;
 
   return (GskVulkanAllocator *) self;
 }
@@ -148,6 +156,16 @@ find_slot (gsize num)
   return g_bit_storage (num - 1);
 }
 
+static inline gboolean
+allocation_is_lower (const GskVulkanAllocation *a,
+                     const GskVulkanAllocation *b)
+{
+  if (a->vk_memory != b->vk_memory)
+    return (guint64) a->vk_memory < (guint64) b->vk_memory;
+
+  return a->offset < b->offset;
+}
+
 static void
 gsk_vulkan_buddy_allocator_alloc (GskVulkanAllocator  *allocator,
                                   VkDeviceSize         size,
@@ -191,7 +209,23 @@ gsk_vulkan_buddy_allocator_alloc (GskVulkanAllocator  *allocator,
   else
     {
       gsize n = gsk_vulkan_allocation_list_get_size (&self->free_lists[i]);
-      *alloc = *gsk_vulkan_allocation_list_get (&self->free_lists[i], n - 1);
+      gsize j, best;
+
+      /* Address-ordered fit: Always take the lowest free chunk, so
+       * allocations pack into the same blocks and the other blocks
+       * drain and can be returned to the device.
+       */
+      best = n - 1;
+      for (j = 0; j + 1 < n; j++)
+        {
+          if (allocation_is_lower (gsk_vulkan_allocation_list_get (&self->free_lists[i], j),
+                                   gsk_vulkan_allocation_list_get (&self->free_lists[i], best)))
+            best = j;
+        }
+
+      *alloc = *gsk_vulkan_allocation_list_get (&self->free_lists[i], best);
+      if (best < n - 1)
+        *gsk_vulkan_allocation_list_index (&self->free_lists[i], best) = *gsk_vulkan_allocation_list_get (&self->free_lists[i], n - 1);
       gsk_vulkan_allocation_list_set_size (&self->free_lists[i], n - 1);
     }
 
@@ -257,6 +291,20 @@ restart:
   gsk_vulkan_allocation_list_append (&self->free_lists[slot], alloc);
 }
 
+static void
+gsk_vulkan_buddy_allocator_trim (GskVulkanAllocator *allocator)
+{
+  GskVulkanBuddyAllocator *self = (GskVulkanBuddyAllocator *) allocator;
+
+  if (self->cache.vk_memory)
+    {
+      gsk_vulkan_free (self->allocator, &self->cache);
+      self->cache.vk_memory = NULL;
+    }
+
+  gsk_vulkan_allocator_trim (self->allocator);
+}
+
 GskVulkanAllocator *
 gsk_vulkan_buddy_allocator_new (GskVulkanAllocator *allocator,
                                 gsize               block_size)
@@ -269,6 +317,7 @@ gsk_vulkan_buddy_allocator_new (GskVulkanAllocator *allocator,
   self->allocator_class.free_allocator = gsk_vulkan_buddy_allocator_free_allocator;
   self->allocator_class.alloc = gsk_vulkan_buddy_allocator_alloc;
   self->allocator_class.free = gsk_vulkan_buddy_allocator_free;
+  self->allocator_class.trim = gsk_vulkan_buddy_allocator_trim;
   self->allocator = allocator;
   self->block_size_slot = find_slot (block_size);
 
@@ -356,6 +405,14 @@ gsk_vulkan_stats_allocator_free (GskVulkanAllocator  *allocator,
   gsk_vulkan_stats_allocator_dump_stats (self, "free()");
 }
 
+static void
+gsk_vulkan_stats_allocator_trim (GskVulkanAllocator *allocator)
+{
+  GskVulkanStatsAllocator *self = (GskVulkanStatsAllocator *) allocator;
+
+  gsk_vulkan_allocator_trim (self->allocator);
+}
+
 GskVulkanAllocator *
 gsk_vulkan_stats_allocator_new (GskVulkanAllocator *allocator)
 {
@@ -366,6 +423,7 @@ gsk_vulkan_stats_allocator_new (GskVulkanAllocator *allocator)
   self->allocator_class.free_allocator = gsk_vulkan_stats_allocator_free_allocator;
   self->allocator_class.alloc = gsk_vulkan_stats_allocator_alloc;
   self->allocator_class.free = gsk_vulkan_stats_allocator_free;
+  self->allocator_class.trim = gsk_vulkan_stats_allocator_trim;
   self->allocator = allocator;
 
   return (GskVulkanAllocator *) self;
@@ -34,6 +34,8 @@ struct _GskVulkanAllocator
                                                                          GskVulkanAllocation            *out_alloc);
   void                  (* free)                                        (GskVulkanAllocator             *allocator,
                                                                          GskVulkanAllocation            *alloc);
+  /* optional: release memory that is kept around for reuse */
+  void                  (* trim)                                        (GskVulkanAllocator             *allocator);
 };
 
 static inline void      gsk_vulkan_alloc                                (GskVulkanAllocator             *allocator,
@@ -42,6 +44,7 @@ static inline void      gsk_vulkan_alloc                                (GskVulk
                                                                          GskVulkanAllocation            *out_alloc);
 static inline void      gsk_vulkan_free                                 (GskVulkanAllocator             *allocator,
                                                                          GskVulkanAllocation            *alloc);
+static inline void      gsk_vulkan_allocator_trim                       (GskVulkanAllocator             *allocator);
 
 static inline GskVulkanAllocator *
                         gsk_vulkan_allocator_ref                        (GskVulkanAllocator             *allocator);
@@ -49,7 +52,8 @@ static inline void      gsk_vulkan_allocator_unref                      (GskVulk
 
 GskVulkanAllocator *    gsk_vulkan_direct_allocator_new                 (VkDevice                        device,
                                                                          uint32_t                        vk_type_index,
-                                                                         const VkMemoryType             *vk_type);
+                                                                         const VkMemoryType             *vk_type,
+                                                                         VkDeviceSize                   *heap_usage);
 GskVulkanAllocator *    gsk_vulkan_buddy_allocator_new                  (GskVulkanAllocator             *allocator,
                                                                          gsize                           block_size);
 GskVulkanAllocator *    gsk_vulkan_stats_allocator_new                  (GskVulkanAllocator             *allocator);
@@ -71,6 +75,13 @@ gsk_vulkan_free (GskVulkanAllocator  *allocator,
   allocator->free (allocator, alloc);
 }
 
+static inline void
+gsk_vulkan_allocator_trim (GskVulkanAllocator *allocator)
+{
+  if (allocator->trim)
+    allocator->trim (allocator);
+}
+
 static inline GskVulkanAllocator *
 gsk_vulkan_allocator_ref (GskVulkanAllocator *self)
 {
@@ -19,4 +19,53 @@ luminance (vec3 color)
   return dot (vec3 (0.2126, 0.7152, 0.0722), color);
 }
 
+/* The sRGB transfer functions, extended to values outside
+ * of [0, 1] by mirroring them, like scRGB does.
+ */
+float
+srgb_eotf (float v)
+{
+  float a = abs (v);
+
+  if (a >= 0.04045)
+    a = pow ((a + 0.055) / (1.0 + 0.055), 2.4);
+  else
+    a = a / 12.92;
+
+  return sign (v) * a;
+}
+
+float
+srgb_oetf (float v)
+{
+  float a = abs (v);
+
+  if (a > 0.0031308)
+    a = 1.055 * pow (a, 1.0 / 2.4) - 0.055;
+  else
+    a = 12.92 * a;
+
+  return sign (v) * a;
+}
+
+vec4
+color_srgb_to_linear (vec4 color)
+{
+  vec4 c = color_unpremultiply (color);
+
+  c.rgb = vec3 (srgb_eotf (c.r), srgb_eotf (c.g), srgb_eotf (c.b));
+
+  return color_premultiply (c);
+}
+
+vec4
+color_linear_to_srgb (vec4 color)
+{
+  vec4 c = color_unpremultiply (color);
+
+  c.rgb = vec3 (srgb_oetf (c.r), srgb_oetf (c.g), srgb_oetf (c.b));
+
+  return color_premultiply (c);
+}
+
 #endif /* _COLOR_ */
@@ -10,12 +10,14 @@ uniform PushConstants
     mat4 mvp;
     mat3x4 clip;
     vec2 scale;
+    highp uint color_state;
 } push;
 
 #define GSK_GLOBAL_MVP push.mvp
 #define GSK_GLOBAL_CLIP push.clip
 #define GSK_GLOBAL_CLIP_RECT push.clip[0]
 #define GSK_GLOBAL_SCALE push.scale
+#define GSK_GLOBAL_COLOR_STATE push.color_state
 
 #if __VERSION__ < 420 || (defined(GSK_GLES) && __VERSION__ < 310)
 layout(std140)
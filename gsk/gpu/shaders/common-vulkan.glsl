@@ -8,6 +8,7 @@ layout(push_constant) uniform PushConstants {
     mat4 mvp;
     mat3x4 clip;
     vec2 scale;
+    uint color_state;
 } push;
 
 layout(constant_id=0) const uint GSK_SHADER_CLIP = GSK_GPU_SHADER_CLIP_NONE;
@@ -20,6 +21,7 @@ layout(constant_id=4) const uint GSK_VARIATION = 0;
 #define GSK_GLOBAL_CLIP push.clip
 #define GSK_GLOBAL_CLIP_RECT push.clip[0]
 #define GSK_GLOBAL_SCALE push.scale
+#define GSK_GLOBAL_COLOR_STATE push.color_state
 
 #define GSK_VERTEX_INDEX gl_VertexIndex
 
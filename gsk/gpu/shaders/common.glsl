@@ -149,6 +149,16 @@ gsk_texture_straight_alpha (uint tex_id,
 void            run                             (out vec4 color,
                                                  out vec2 pos);
 
+/* Shaders compute sRGB colors, convert them if the target is linear */
+vec4
+output_color_from_srgb (vec4 color)
+{
+  if (GSK_GLOBAL_COLOR_STATE == GSK_GPU_COLOR_STATE_SRGB_LINEAR)
+    return color_srgb_to_linear (color);
+  else
+    return color;
+}
+
 void
 main_clip_none (void)
 {
@@ -157,7 +167,7 @@ main_clip_none (void)
 
   run (color, pos);
 
-  gsk_set_output_color (color);
+  gsk_set_output_color (output_color_from_srgb (color));
 }
 
 void
@@ -173,7 +183,7 @@ main_clip_rect (void)
   float coverage = rect_coverage (clip, pos);
   color *= coverage;
 
-  gsk_set_output_color (color);
+  gsk_set_output_color (output_color_from_srgb (color));
 }
 
 void
@@ -189,7 +199,7 @@ main_clip_rounded (void)
   float coverage = rounded_rect_coverage (clip, pos);
   color *= coverage;
 
-  gsk_set_output_color (color);
+  gsk_set_output_color (output_color_from_srgb (color));
 }
 
 void
@@ -2,11 +2,16 @@
 #define _ENUMS_
 
 #define GSK_GPU_PATTERN_STACK_SIZE 16
+#define GSK_GPU_PATTERN_MAX_SPECIALIZED_TYPES 5u
+#define GSK_GPU_PATTERN_SPECIALIZED_TYPE_BITS 6u
 
 #define GSK_GPU_SHADER_CLIP_NONE 0u
 #define GSK_GPU_SHADER_CLIP_RECT 1u
 #define GSK_GPU_SHADER_CLIP_ROUNDED 2u
 
+#define GSK_GPU_COLOR_STATE_SRGB 0u
+#define GSK_GPU_COLOR_STATE_SRGB_LINEAR 1u
+
 #define GSK_GPU_PATTERN_DONE 0u
 #define GSK_GPU_PATTERN_COLOR 1u
 #define GSK_GPU_PATTERN_OPACITY 2u
@@ -46,12 +51,18 @@
 #define GSK_GPU_PATTERN_BLEND_HUE 36u
 #define GSK_GPU_PATTERN_BLEND_SATURATION 37u
 #define GSK_GPU_PATTERN_BLEND_LUMINOSITY 38u
+#define GSK_GPU_PATTERN_FILL 39u
+#define GSK_GPU_PATTERN_STROKE 40u
+#define GSK_GPU_PATTERN_STROKE_PIECES 41u
 
 #define GSK_MASK_MODE_ALPHA 0u
 #define GSK_MASK_MODE_INVERTED_ALPHA 1u
 #define GSK_MASK_MODE_LUMINANCE 2u
 #define GSK_MASK_MODE_INVERTED_LUMINANCE 3u
 
+#define GSK_FILL_RULE_WINDING 0u
+#define GSK_FILL_RULE_EVEN_ODD 1u
+
 #define TOP 0u
 #define RIGHT 1u
 #define BOTTOM 2u
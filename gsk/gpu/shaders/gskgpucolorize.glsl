@@ -1,5 +1,7 @@
 #include "common.glsl"
 
+#define VARIATION_SDF ((GSK_VARIATION & 1u) == 1u)
+
 PASS(0) vec2 _pos;
 PASS_FLAT(1) Rect _rect;
 PASS_FLAT(2) vec4 _color;
@@ -39,8 +41,17 @@ void
 run (out vec4 color,
      out vec2 position)
 {
-  float alpha = gsk_texture (_tex_id, _tex_coord).a * rect_coverage (_rect, _pos);
-  color = _color * alpha;
+  float alpha = gsk_texture (_tex_id, _tex_coord).a;
+
+  if (VARIATION_SDF)
+    {
+      /* alpha is a distance field with the outline at 0.5,
+       * antialias it over one pixel */
+      float width = max (fwidth (alpha), 0.0001);
+      alpha = clamp ((alpha - 0.5) / width + 0.5, 0.0, 1.0);
+    }
+
+  color = _color * alpha * rect_coverage (_rect, _pos);
   position = _pos;
 }
 
@@ -0,0 +1,84 @@
+#include "common.glsl"
+
+/* The GLSL of a GskGLShader gets appended to the fragment shader
+ * when the program is compiled, see gsk_gl_device_use_gl_shader_program().
+ * It declares its own uniforms and textures and implements mainImage().
+ */
+
+PASS(0) vec2 _pos;
+PASS_FLAT(1) Rect _rect;
+PASS(2) vec2 _coord;
+PASS_FLAT(3) vec2 _size;
+
+
+#ifdef GSK_VERTEX_SHADER
+
+IN(0) vec4 in_rect;
+
+void
+run (out vec2 pos)
+{
+  Rect r = rect_from_gsk (in_rect);
+
+  pos = rect_get_position (r);
+
+  _pos = pos;
+  _rect = r;
+  _coord = rect_get_coord (r, pos);
+  _size = in_rect.zw;
+}
+
+#endif
+
+
+
+#ifdef GSK_FRAGMENT_SHADER
+
+#ifndef GSK_GLES
+#define GSK_GL3 1
+#endif
+
+/* Node textures are stored top-down, while GskGLShader uses
+ * texture coordinates with the origin in the lower left corner */
+#define GskTexture(sampler, texCoords) texture (sampler, vec2 ((texCoords).x, 1.0 - (texCoords).y))
+
+vec4
+gsk_premultiply (vec4 c)
+{
+  return vec4 (c.rgb * c.a, c.a);
+}
+
+void mainImage (out vec4 fragColor,
+                in vec2 fragCoord,
+                in vec2 resolution,
+                in vec2 uv);
+
+#ifdef VULKAN
+/* Vulkan can't compile shaders at runtime, and these ops are only
+ * used with GL. Draw like the fallback does. */
+void
+mainImage (out vec4 fragColor,
+           in vec2 fragCoord,
+           in vec2 resolution,
+           in vec2 uv)
+{
+  fragColor = vec4 (1.0, 105.0 / 255.0, 180.0 / 255.0, 1.0);
+}
+#endif
+
+void
+run (out vec4 color,
+     out vec2 position)
+{
+  vec4 result;
+
+  mainImage (result,
+             _coord * _size,
+             _size,
+             vec2 (_coord.x, 1.0 - _coord.y));
+
+  color = result * rect_coverage (_rect, _pos);
+  position = _pos;
+}
+
+#endif
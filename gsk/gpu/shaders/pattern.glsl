@@ -257,6 +257,135 @@ glyphs_pattern (inout uint reader,
   return color * opacity;
 }
 
+float
+line_distance (vec2 a,
+               vec2 b,
+               vec2 p)
+{
+  vec2 pa = p - a;
+  vec2 ba = b - a;
+  float h = clamp (dot (pa, ba) / max (dot (ba, ba), 0.000001), 0.0, 1.0);
+
+  return length (pa - ba * h);
+}
+
+void
+fill_pattern (inout uint reader,
+              inout vec4 color,
+              Position   pos)
+{
+  uint fill_rule = read_uint (reader);
+  uint n_lines = read_uint (reader);
+  int winding = 0;
+  uint crossings = 0u;
+  uint i;
+
+  vec2 p = position (pos);
+  vec2 dFdp = abs (position_fwidth (pos));
+  float pixel = 0.5 * (dFdp.x + dFdp.y);
+  float dist = pixel;
+
+  for (i = 0u; i < n_lines; i++)
+    {
+      vec2 a = read_vec2 (reader);
+      vec2 b = read_vec2 (reader);
+
+      dist = min (dist, line_distance (a, b, p));
+
+      if ((a.y <= p.y) != (b.y <= p.y))
+        {
+          float x = a.x + (p.y - a.y) * (b.x - a.x) / (b.y - a.y);
+          if (x > p.x)
+            {
+              winding += a.y < b.y ? 1 : -1;
+              crossings++;
+            }
+        }
+    }
+
+  bool inside;
+  if (fill_rule == GSK_FILL_RULE_EVEN_ODD)
+    inside = (crossings & 1u) != 0u;
+  else
+    inside = winding != 0;
+
+  color *= clamp (0.5 + (inside ? dist : -dist) / pixel, 0.0, 1.0);
+}
+
+void
+stroke_pattern (inout uint reader,
+                inout vec4 color,
+                Position   pos)
+{
+  float half_width = 0.5 * read_float (reader);
+  uint n_lines = read_uint (reader);
+  uint i;
+
+  vec2 p = position (pos);
+  vec2 dFdp = abs (position_fwidth (pos));
+  float pixel = 0.5 * (dFdp.x + dFdp.y);
+  float dist = half_width + pixel;
+
+  for (i = 0u; i < n_lines; i++)
+    {
+      vec2 a = read_vec2 (reader);
+      vec2 b = read_vec2 (reader);
+
+      dist = min (dist, line_distance (a, b, p));
+    }
+
+  color *= clamp (0.5 + (half_width - dist) / pixel, 0.0, 1.0);
+}
+
+/* The pieces are convex polygons with their points in clockwise order
+ * and circles with the stroke's width, written as a single point.
+ * The stroke is their union, so its distance is the smallest one.
+ */
+void
+stroke_pieces_pattern (inout uint reader,
+                       inout vec4 color,
+                       Position   pos)
+{
+  float half_width = 0.5 * read_float (reader);
+  uint n_pieces = read_uint (reader);
+  uint i, j;
+
+  vec2 p = position (pos);
+  vec2 dFdp = abs (position_fwidth (pos));
+  float pixel = 0.5 * (dFdp.x + dFdp.y);
+  float dist = pixel;
+
+  for (i = 0u; i < n_pieces; i++)
+    {
+      uint n_points = read_uint (reader);
+      vec2 first = read_vec2 (reader);
+      float d;
+
+      if (n_points == 1u)
+        {
+          d = length (p - first) - half_width;
+        }
+      else
+        {
+          vec2 a = first;
+
+          d = -1.0e20;
+          for (j = 1u; j <= n_points; j++)
+            {
+              vec2 b = j < n_points ? read_vec2 (reader) : first;
+              vec2 e = b - a;
+
+              d = max (d, dot (p - a, vec2 (e.y, -e.x)) / length (e));
+              a = b;
+            }
+        }
+
+      dist = min (dist, d);
+    }
+
+  color *= clamp (0.5 - dist / pixel, 0.0, 1.0);
+}
+
 vec4
 texture_pattern (inout uint reader,
                  Position   pos)
@@ -359,10 +488,27 @@ pattern (uint reader,
 {
   vec4 color = vec4 (1.0, 0.0, 0.8, 1.0); /* pink */
   Position pos = position_new (pos_ / GSK_GLOBAL_SCALE);
+  uint i;
 
-  for(;;)
+  /* A nonzero variation encodes the types of the pattern program, so
+   * the compiler can unroll this loop and drop the switch. */
+  for (i = 0u;; i++)
     {
-      uint type = read_uint (reader);
+      uint type;
+
+      if (GSK_VARIATION != 0u)
+        {
+          if (i >= GSK_GPU_PATTERN_MAX_SPECIALIZED_TYPES)
+            return color;
+          type = (GSK_VARIATION >> (GSK_GPU_PATTERN_SPECIALIZED_TYPE_BITS * i)) &
+                 ((1u << GSK_GPU_PATTERN_SPECIALIZED_TYPE_BITS) - 1u);
+          reader++;
+        }
+      else
+        {
+          type = read_uint (reader);
+        }
+
       switch (type)
       {
         default:
@@ -404,6 +550,15 @@ pattern (uint reader,
         case GSK_GPU_PATTERN_CLIP:
           clip_pattern (reader, color, pos);
           break;
+        case GSK_GPU_PATTERN_FILL:
+          fill_pattern (reader, color, pos);
+          break;
+        case GSK_GPU_PATTERN_STROKE:
+          stroke_pattern (reader, color, pos);
+          break;
+        case GSK_GPU_PATTERN_STROKE_PIECES:
+          stroke_pieces_pattern (reader, color, pos);
+          break;
         case GSK_GPU_PATTERN_REPEAT_PUSH:
           repeat_push_pattern (reader, pos);
           break;
@@ -22,9 +22,30 @@
 
 #include "gskcairoblurprivate.h"
 
+#include "gdk/gdkparalleltaskprivate.h"
+
 #include <math.h>
 #include <string.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HAVE_SSE2_BLUR 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define HAVE_NEON_BLUR 1
+#endif
+
+/* Columns are blurred in stripes of this many bytes, so the sums
+ * and the rows kept for a stripe stay in the cache */
+#define STRIPE_WIDTH 64
+
+/* Surfaces with at least this many pixels are blurred in parallel */
+#define PARALLEL_BLUR_PIXELS (256 * 256)
+#define PARALLEL_BLUR_CHUNK_PIXELS (64 * 1024)
+
+/* The vectorized division is exact for box sizes below this */
+#define MAX_SIMD_BOX_SIZE 16384
+
 /*
  * Gets the size for a single box blur.
  *
@@ -156,33 +177,283 @@ blur_rows (guchar *dst_buffer,
     }
 }
 
-/* Swaps width and height.
+#if defined(HAVE_SSE2_BLUR) || defined(HAVE_NEON_BLUR)
+/* Computes (sum + d / 2) / d for 16 sums. The division is done in
+ * floats, adding 0.5 keeps the result away from integers, so the
+ * truncation rounds exactly like the integer division for the sizes
+ * we use this for.
+ */
+static inline void
+blur_yspan_16 (guint32      *sums,
+               const guchar *in,
+               guchar       *ring,
+               gboolean      leave,
+               guchar       *out,
+               float         bias,
+               float         inv_d)
+{
+#if defined(HAVE_SSE2_BLUR)
+  const __m128i zero = _mm_setzero_si128 ();
+  __m128i s0, s1, s2, s3, v, l, lo, hi;
+
+  s0 = _mm_loadu_si128 ((const __m128i *) (sums + 0));
+  s1 = _mm_loadu_si128 ((const __m128i *) (sums + 4));
+  s2 = _mm_loadu_si128 ((const __m128i *) (sums + 8));
+  s3 = _mm_loadu_si128 ((const __m128i *) (sums + 12));
+
+  v = zero;
+  if (in)
+    {
+      v = _mm_loadu_si128 ((const __m128i *) in);
+      lo = _mm_unpacklo_epi8 (v, zero);
+      hi = _mm_unpackhi_epi8 (v, zero);
+      s0 = _mm_add_epi32 (s0, _mm_unpacklo_epi16 (lo, zero));
+      s1 = _mm_add_epi32 (s1, _mm_unpackhi_epi16 (lo, zero));
+      s2 = _mm_add_epi32 (s2, _mm_unpacklo_epi16 (hi, zero));
+      s3 = _mm_add_epi32 (s3, _mm_unpackhi_epi16 (hi, zero));
+    }
+
+  if (leave)
+    {
+      l = _mm_loadu_si128 ((const __m128i *) ring);
+      lo = _mm_unpacklo_epi8 (l, zero);
+      hi = _mm_unpackhi_epi8 (l, zero);
+      s0 = _mm_sub_epi32 (s0, _mm_unpacklo_epi16 (lo, zero));
+      s1 = _mm_sub_epi32 (s1, _mm_unpackhi_epi16 (lo, zero));
+      s2 = _mm_sub_epi32 (s2, _mm_unpacklo_epi16 (hi, zero));
+      s3 = _mm_sub_epi32 (s3, _mm_unpackhi_epi16 (hi, zero));
+    }
+
+  if (in)
+    _mm_storeu_si128 ((__m128i *) ring, v);
+
+  _mm_storeu_si128 ((__m128i *) (sums + 0), s0);
+  _mm_storeu_si128 ((__m128i *) (sums + 4), s1);
+  _mm_storeu_si128 ((__m128i *) (sums + 8), s2);
+  _mm_storeu_si128 ((__m128i *) (sums + 12), s3);
+
+  if (out)
+    {
+      const __m128 b = _mm_set1_ps (bias);
+      const __m128 m = _mm_set1_ps (inv_d);
+
+      s0 = _mm_cvttps_epi32 (_mm_mul_ps (_mm_add_ps (_mm_cvtepi32_ps (s0), b), m));
+      s1 = _mm_cvttps_epi32 (_mm_mul_ps (_mm_add_ps (_mm_cvtepi32_ps (s1), b), m));
+      s2 = _mm_cvttps_epi32 (_mm_mul_ps (_mm_add_ps (_mm_cvtepi32_ps (s2), b), m));
+      s3 = _mm_cvttps_epi32 (_mm_mul_ps (_mm_add_ps (_mm_cvtepi32_ps (s3), b), m));
+
+      _mm_storeu_si128 ((__m128i *) out,
+                        _mm_packus_epi16 (_mm_packs_epi32 (s0, s1),
+                                          _mm_packs_epi32 (s2, s3)));
+    }
+#elif defined(HAVE_NEON_BLUR)
+  uint32x4_t s0, s1, s2, s3;
+  uint16x8_t lo, hi;
+  uint8x16_t v, l;
+
+  s0 = vld1q_u32 (sums + 0);
+  s1 = vld1q_u32 (sums + 4);
+  s2 = vld1q_u32 (sums + 8);
+  s3 = vld1q_u32 (sums + 12);
+
+  v = vdupq_n_u8 (0);
+  if (in)
+    {
+      v = vld1q_u8 (in);
+      lo = vmovl_u8 (vget_low_u8 (v));
+      hi = vmovl_u8 (vget_high_u8 (v));
+      s0 = vaddw_u16 (s0, vget_low_u16 (lo));
+      s1 = vaddw_u16 (s1, vget_high_u16 (lo));
+      s2 = vaddw_u16 (s2, vget_low_u16 (hi));
+      s3 = vaddw_u16 (s3, vget_high_u16 (hi));
+    }
+
+  if (leave)
+    {
+      l = vld1q_u8 (ring);
+      lo = vmovl_u8 (vget_low_u8 (l));
+      hi = vmovl_u8 (vget_high_u8 (l));
+      s0 = vsubw_u16 (s0, vget_low_u16 (lo));
+      s1 = vsubw_u16 (s1, vget_high_u16 (lo));
+      s2 = vsubw_u16 (s2, vget_low_u16 (hi));
+      s3 = vsubw_u16 (s3, vget_high_u16 (hi));
+    }
+
+  if (in)
+    vst1q_u8 (ring, v);
+
+  vst1q_u32 (sums + 0, s0);
+  vst1q_u32 (sums + 4, s1);
+  vst1q_u32 (sums + 8, s2);
+  vst1q_u32 (sums + 12, s3);
+
+  if (out)
+    {
+      const float32x4_t b = vdupq_n_f32 (bias);
+      const float32x4_t m = vdupq_n_f32 (inv_d);
+
+      s0 = vcvtq_u32_f32 (vmulq_f32 (vaddq_f32 (vcvtq_f32_u32 (s0), b), m));
+      s1 = vcvtq_u32_f32 (vmulq_f32 (vaddq_f32 (vcvtq_f32_u32 (s1), b), m));
+      s2 = vcvtq_u32_f32 (vmulq_f32 (vaddq_f32 (vcvtq_f32_u32 (s2), b), m));
+      s3 = vcvtq_u32_f32 (vmulq_f32 (vaddq_f32 (vcvtq_f32_u32 (s3), b), m));
+
+      vst1q_u8 (out,
+                vcombine_u8 (vmovn_u16 (vcombine_u16 (vmovn_u32 (s0), vmovn_u32 (s1))),
+                             vmovn_u16 (vcombine_u16 (vmovn_u32 (s2), vmovn_u32 (s3)))));
+    }
+#endif
+}
+#endif
+
+/* This is blur_xspan() for columns instead of rows, for up to
+ * STRIPE_WIDTH columns at once. Going down the columns row by row
+ * means we read and write whole rows, and can work on many columns
+ * at the same time.
+ *
+ * A row is overwritten with its result before the window has moved
+ * past it, so the rows in the window are kept in @ring, which needs
+ * room for d rows of STRIPE_WIDTH bytes.
  */
 static void
-flip_buffer (guchar *dst_buffer,
-             guchar *src_buffer,
-             int     width,
-             int     height)
+blur_yspan (guchar *buffer,
+            gsize   stride,
+            int     width,
+            int     height,
+            int     d,
+            int     shift,
+            guchar *ring)
 {
-  /* Working in blocks increases cache efficiency, compared to reading
-   * or writing an entire column at once
-   */
-#define BLOCK_SIZE 16
-
-  int i0, j0;
-
-  for (i0 = 0; i0 < width; i0 += BLOCK_SIZE)
-    for (j0 = 0; j0 < height; j0 += BLOCK_SIZE)
-      {
-        int max_j = MIN(j0 + BLOCK_SIZE, height);
-        int max_i = MIN(i0 + BLOCK_SIZE, width);
-        int i, j;
-
-        for (i = i0; i < max_i; i++)
-          for (j = j0; j < max_j; j++)
-            dst_buffer[i * height + j] = src_buffer[j * width + i];
-      }
-#undef BLOCK_SIZE
+  guint32 sums[STRIPE_WIDTH] = { 0, };
+  int offset;
+  int i, k, x;
+
+  if (d % 2 == 1)
+    offset = d / 2;
+  else
+    offset = (d - shift) / 2;
+
+  for (i = -d + offset, k = 0; i < height + offset; i++, k++)
+    {
+      const guchar *in = i >= 0 && i < height ? buffer + i * stride : NULL;
+      guchar *out = i >= offset ? buffer + (i - offset) * stride : NULL;
+      /* The slot of the row that was added d rows ago */
+      guchar *slot = ring + (k % d) * STRIPE_WIDTH;
+      gboolean leave = i >= d;
+
+      x = 0;
+
+#if defined(HAVE_SSE2_BLUR) || defined(HAVE_NEON_BLUR)
+      if (d < MAX_SIMD_BOX_SIZE)
+        {
+          for (; x + 16 <= width; x += 16)
+            blur_yspan_16 (sums + x,
+                           in ? in + x : NULL,
+                           slot + x,
+                           leave,
+                           out ? out + x : NULL,
+                           d / 2 + 0.5f,
+                           1.0f / d);
+        }
+#endif
+
+      for (; x < width; x++)
+        {
+          if (in)
+            sums[x] += in[x];
+          if (leave)
+            sums[x] -= slot[x];
+          if (in)
+            slot[x] = in[x];
+          if (out)
+            out[x] = (sums[x] + d / 2) / d;
+        }
+    }
+}
+
+static void
+blur_columns (guchar *buffer,
+              gsize   stride,
+              int     width,
+              int     height,
+              int     d,
+              guchar *ring)
+{
+  /* See blur_rows() for the passes */
+  if (d % 2 == 1)
+    {
+      blur_yspan (buffer, stride, width, height, d, 0, ring);
+      blur_yspan (buffer, stride, width, height, d, 0, ring);
+      blur_yspan (buffer, stride, width, height, d, 0, ring);
+    }
+  else
+    {
+      blur_yspan (buffer, stride, width, height, d, 1, ring);
+      blur_yspan (buffer, stride, width, height, d, -1, ring);
+      blur_yspan (buffer, stride, width, height, d + 1, 0, ring);
+    }
+}
+
+typedef struct
+{
+  guchar *buffer;
+  int width;
+  int height;
+  int d;
+
+  int chunk_size;  /* columns for the vertical pass, rows for the horizontal one */
+  int n_chunks;
+  int next_chunk;  /* (atomic) */
+} BoxBlur;
+
+static void
+blur_columns_task (gpointer data)
+{
+  BoxBlur *blur = data;
+  guchar *ring;
+  int chunk;
+
+  ring = g_malloc ((blur->d + 1) * STRIPE_WIDTH);
+
+  for (chunk = g_atomic_int_add (&blur->next_chunk, 1);
+       chunk < blur->n_chunks;
+       chunk = g_atomic_int_add (&blur->next_chunk, 1))
+    {
+      int x = chunk * STRIPE_WIDTH;
+
+      blur_columns (blur->buffer + x,
+                    blur->width,
+                    MIN (STRIPE_WIDTH, blur->width - x),
+                    blur->height,
+                    blur->d,
+                    ring);
+    }
+
+  g_free (ring);
+}
+
+static void
+blur_rows_task (gpointer data)
+{
+  BoxBlur *blur = data;
+  guchar *tmp_buffer;
+  int chunk;
+
+  tmp_buffer = g_malloc (blur->width);
+
+  for (chunk = g_atomic_int_add (&blur->next_chunk, 1);
+       chunk < blur->n_chunks;
+       chunk = g_atomic_int_add (&blur->next_chunk, 1))
+    {
+      int y = chunk * blur->chunk_size;
+
+      blur_rows (blur->buffer + y * blur->width,
+                 tmp_buffer,
+                 blur->width,
+                 MIN (blur->chunk_size, blur->height - y),
+                 blur->d);
+    }
+
+  g_free (tmp_buffer);
 }
 
 static void
@@ -192,30 +463,36 @@ _boxblur (guchar      *buffer,
           int          radius,
           GskBlurFlags flags)
 {
-  guchar *flipped_buffer;
-  int d = get_box_filter_size (radius);
+  BoxBlur blur;
+  guint n_tasks;
 
-  flipped_buffer = g_malloc (width * height);
+  blur.buffer = buffer;
+  blur.width = width;
+  blur.height = height;
+  blur.d = get_box_filter_size (radius);
+
+  if (g_get_num_processors () > 1 && width * height >= PARALLEL_BLUR_PIXELS)
+    n_tasks = g_get_num_processors ();
+  else
+    n_tasks = 1;
 
   if (flags & GSK_BLUR_Y)
     {
-      /* Step 1: swap rows and columns */
-      flip_buffer (flipped_buffer, buffer, width, height);
-
-      /* Step 2: blur rows (really columns) */
-      blur_rows (flipped_buffer, buffer, height, width, d);
+      blur.chunk_size = STRIPE_WIDTH;
+      blur.n_chunks = (width + STRIPE_WIDTH - 1) / STRIPE_WIDTH;
+      blur.next_chunk = 0;
 
-      /* Step 3: swap rows and columns */
-      flip_buffer (buffer, flipped_buffer, height, width);
+      gdk_parallel_task_run (blur_columns_task, &blur, MIN (n_tasks, blur.n_chunks));
     }
 
   if (flags & GSK_BLUR_X)
     {
-      /* Step 4: blur rows */
-      blur_rows (buffer, flipped_buffer, width, height, d);
-    }
+      blur.chunk_size = MAX (1, PARALLEL_BLUR_CHUNK_PIXELS / width);
+      blur.n_chunks = (height + blur.chunk_size - 1) / blur.chunk_size;
+      blur.next_chunk = 0;
 
-  g_free (flipped_buffer);
+      gdk_parallel_task_run (blur_rows_task, &blur, MIN (n_tasks, blur.n_chunks));
+    }
 }
 
 /*
@@ -25,8 +25,17 @@
 #include "gskdebugprivate.h"
 #include "gskrendererprivate.h"
 #include "gskrendernodeprivate.h"
+#include "gdk/gdkmemorytextureprivate.h"
+#include "gdk/gdkparalleltaskprivate.h"
 #include "gdk/gdktextureprivate.h"
 
+#include <pango/pangocairo.h>
+
+/* Size of the tiles that are rendered in parallel */
+#define TILE_SIZE 256
+/* Don't bother with threads for images smaller than this */
+#define MIN_TILED_PIXELS (512 * 512)
+
 typedef struct {
   GQuark cpu_time;
   GQuark gpu_time;
@@ -90,6 +99,256 @@ gsk_cairo_renderer_do_render (GskRenderer   *renderer,
   gsk_profiler_push_samples (profiler);
 }
 
+/*
+ * Checks if @node can be drawn from multiple threads at the same time.
+ *
+ * Most nodes only read immutable data when drawing, but textures that
+ * are not in memory need the main thread to download, and cairo nodes
+ * replay recording surfaces that cairo does not guarantee to be safe
+ * for concurrent replay.
+ *
+ * As a side effect, this makes sure the cairo fonts of all text nodes
+ * exist, so they are not created lazily from multiple threads.
+ */
+static gboolean
+gsk_cairo_renderer_node_is_threadsafe (GskRenderNode *node)
+{
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_CONTAINER_NODE:
+      {
+        GskRenderNode **children;
+        guint i, n_children;
+
+        children = gsk_container_node_get_children (node, &n_children);
+        for (i = 0; i < n_children; i++)
+          {
+            if (!gsk_cairo_renderer_node_is_threadsafe (children[i]))
+              return FALSE;
+          }
+        return TRUE;
+      }
+
+    case GSK_COLOR_NODE:
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+    case GSK_CONIC_GRADIENT_NODE:
+    case GSK_BORDER_NODE:
+    case GSK_INSET_SHADOW_NODE:
+    case GSK_OUTSET_SHADOW_NODE:
+      return TRUE;
+
+    case GSK_TEXT_NODE:
+      pango_cairo_font_get_scaled_font (PANGO_CAIRO_FONT (gsk_text_node_get_font (node)));
+      return TRUE;
+
+    case GSK_TEXTURE_NODE:
+      return GDK_IS_MEMORY_TEXTURE (gsk_texture_node_get_texture (node));
+
+    case GSK_TEXTURE_SCALE_NODE:
+      return GDK_IS_MEMORY_TEXTURE (gsk_texture_scale_node_get_texture (node));
+
+    case GSK_TRANSFORM_NODE:
+      return gsk_cairo_renderer_node_is_threadsafe (gsk_transform_node_get_child (node));
+
+    case GSK_OPACITY_NODE:
+      return gsk_cairo_renderer_node_is_threadsafe (gsk_opacity_node_get_child (node));
+
+    case GSK_COLOR_MATRIX_NODE:
+      return gsk_cairo_renderer_node_is_threadsafe (gsk_color_matrix_node_get_child (node));
+
+    case GSK_REPEAT_NODE:
+      return gsk_cairo_renderer_node_is_threadsafe (gsk_repeat_node_get_child (node));
+
+    case GSK_CLIP_NODE:
+      return gsk_cairo_renderer_node_is_threadsafe (gsk_clip_node_get_child (node));
+
+    case GSK_ROUNDED_CLIP_NODE:
+      return gsk_cairo_renderer_node_is_threadsafe (gsk_rounded_clip_node_get_child (node));
+
+    case GSK_SHADOW_NODE:
+      return gsk_cairo_renderer_node_is_threadsafe (gsk_shadow_node_get_child (node));
+
+    case GSK_BLUR_NODE:
+      return gsk_cairo_renderer_node_is_threadsafe (gsk_blur_node_get_child (node));
+
+    case GSK_DEBUG_NODE:
+      return gsk_cairo_renderer_node_is_threadsafe (gsk_debug_node_get_child (node));
+
+    case GSK_FILL_NODE:
+      return gsk_cairo_renderer_node_is_threadsafe (gsk_fill_node_get_child (node));
+
+    case GSK_STROKE_NODE:
+      return gsk_cairo_renderer_node_is_threadsafe (gsk_stroke_node_get_child (node));
+
+    case GSK_SUBSURFACE_NODE:
+      return gsk_cairo_renderer_node_is_threadsafe (gsk_subsurface_node_get_child (node));
+
+    case GSK_BLEND_NODE:
+      return gsk_cairo_renderer_node_is_threadsafe (gsk_blend_node_get_bottom_child (node)) &&
+             gsk_cairo_renderer_node_is_threadsafe (gsk_blend_node_get_top_child (node));
+
+    case GSK_CROSS_FADE_NODE:
+      return gsk_cairo_renderer_node_is_threadsafe (gsk_cross_fade_node_get_start_child (node)) &&
+             gsk_cairo_renderer_node_is_threadsafe (gsk_cross_fade_node_get_end_child (node));
+
+    case GSK_MASK_NODE:
+      return gsk_cairo_renderer_node_is_threadsafe (gsk_mask_node_get_source (node)) &&
+             gsk_cairo_renderer_node_is_threadsafe (gsk_mask_node_get_mask (node));
+
+    case GSK_CAIRO_NODE:
+    case GSK_GL_SHADER_NODE:
+    case GSK_NOT_A_RENDER_NODE:
+    default:
+      return FALSE;
+    }
+}
+
+/* Draws @node, skipping children of containers that are outside of @clip */
+typedef struct
+{
+  cairo_t *cr;
+  const graphene_rect_t *clip;
+} CulledDraw;
+
+static void
+gsk_cairo_renderer_draw_child_culled (GskRenderNode *node,
+                                      gpointer       data)
+{
+  CulledDraw *draw = data;
+
+  if (gsk_render_node_get_node_type (node) == GSK_CONTAINER_NODE)
+    gsk_container_node_foreach_in_rect (node, draw->clip, gsk_cairo_renderer_draw_child_culled, draw);
+  else
+    gsk_render_node_draw (node, draw->cr);
+}
+
+static void
+gsk_cairo_renderer_draw_node_culled (GskRenderNode         *node,
+                                     cairo_t               *cr,
+                                     const graphene_rect_t *clip)
+{
+  CulledDraw draw = { cr, clip };
+
+  if (!graphene_rect_intersection (&node->bounds, clip, NULL))
+    return;
+
+  gsk_cairo_renderer_draw_child_culled (node, &draw);
+}
+
+typedef struct _RenderTiles RenderTiles;
+
+struct _RenderTiles
+{
+  GskRenderNode *root;
+  graphene_rect_t viewport;
+  guchar *data;
+  gsize stride;
+  int width;
+  int height;
+  int n_columns;
+  guint n_tiles;
+  /* atomic */ int next_tile;
+};
+
+static void
+gsk_cairo_renderer_render_tiles_task (gpointer data)
+{
+  RenderTiles *tiles = data;
+  guint i;
+
+  for (i = g_atomic_int_add (&tiles->next_tile, 1);
+       i < tiles->n_tiles;
+       i = g_atomic_int_add (&tiles->next_tile, 1))
+    {
+      cairo_surface_t *surface;
+      cairo_t *cr;
+      int x, y, width, height;
+
+      x = (i % tiles->n_columns) * TILE_SIZE;
+      y = (i / tiles->n_columns) * TILE_SIZE;
+      width = MIN (TILE_SIZE, tiles->width - x);
+      height = MIN (TILE_SIZE, tiles->height - y);
+
+      /* Every tile gets its own surface for its part of the image data,
+       * cairo surfaces must not be drawn to from multiple threads */
+      surface = cairo_image_surface_create_for_data (tiles->data + y * tiles->stride + x * 4,
+                                                     CAIRO_FORMAT_ARGB32,
+                                                     width, height,
+                                                     tiles->stride);
+      cr = cairo_create (surface);
+      cairo_translate (cr, - tiles->viewport.origin.x - x, - tiles->viewport.origin.y - y);
+
+      gsk_cairo_renderer_draw_node_culled (tiles->root,
+                                           cr,
+                                           &GRAPHENE_RECT_INIT (tiles->viewport.origin.x + x,
+                                                                tiles->viewport.origin.y + y,
+                                                                width, height));
+
+      cairo_destroy (cr);
+      cairo_surface_finish (surface);
+      cairo_surface_destroy (surface);
+    }
+}
+
+/*
+ * Renders @root into the image @surface by splitting it into tiles and
+ * drawing them on multiple threads.
+ *
+ * Returns: %FALSE if the node can't be drawn in parallel and nothing
+ *   was rendered
+ */
+static gboolean
+gsk_cairo_renderer_do_render_tiled (GskRenderer           *renderer,
+                                    cairo_surface_t       *surface,
+                                    GskRenderNode         *root,
+                                    const graphene_rect_t *viewport)
+{
+  GskCairoRenderer *self = GSK_CAIRO_RENDERER (renderer);
+  GskProfiler *profiler;
+  RenderTiles tiles;
+  gint64 cpu_time;
+  int n_rows;
+
+  tiles.width = cairo_image_surface_get_width (surface);
+  tiles.height = cairo_image_surface_get_height (surface);
+
+  if (g_get_num_processors () < 2 ||
+      tiles.width * tiles.height < MIN_TILED_PIXELS ||
+      GSK_RENDERER_DEBUG_CHECK (renderer, GEOMETRY) ||
+      !gsk_cairo_renderer_node_is_threadsafe (root))
+    return FALSE;
+
+  profiler = gsk_renderer_get_profiler (renderer);
+  gsk_profiler_timer_begin (profiler, self->profile_timers.cpu_time);
+
+  cairo_surface_flush (surface);
+
+  tiles.root = root;
+  tiles.viewport = *viewport;
+  tiles.data = cairo_image_surface_get_data (surface);
+  tiles.stride = cairo_image_surface_get_stride (surface);
+  tiles.n_columns = (tiles.width + TILE_SIZE - 1) / TILE_SIZE;
+  n_rows = (tiles.height + TILE_SIZE - 1) / TILE_SIZE;
+  tiles.n_tiles = tiles.n_columns * n_rows;
+  tiles.next_tile = 0;
+
+  gdk_parallel_task_run (gsk_cairo_renderer_render_tiles_task,
+                         &tiles,
+                         MIN (tiles.n_tiles, g_get_num_processors ()));
+
+  cairo_surface_mark_dirty (surface);
+
+  cpu_time = gsk_profiler_timer_end (profiler, self->profile_timers.cpu_time);
+  gsk_profiler_timer_set (profiler, self->profile_timers.cpu_time, cpu_time);
+
+  gsk_profiler_push_samples (profiler);
+
+  return TRUE;
+}
+
 static GdkTexture *
 gsk_cairo_renderer_render_texture (GskRenderer           *renderer,
                                    GskRenderNode         *root,
@@ -136,13 +395,17 @@ gsk_cairo_renderer_render_texture (GskRenderer           *renderer,
     }
 
   surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
-  cr = cairo_create (surface);
 
-  cairo_translate (cr, - viewport->origin.x, - viewport->origin.y);
+  if (!gsk_cairo_renderer_do_render_tiled (renderer, surface, root, viewport))
+    {
+      cr = cairo_create (surface);
+
+      cairo_translate (cr, - viewport->origin.x, - viewport->origin.y);
 
-  gsk_cairo_renderer_do_render (renderer, cr, root);
+      gsk_cairo_renderer_do_render (renderer, cr, root);
 
-  cairo_destroy (cr);
+      cairo_destroy (cr);
+    }
 
   texture = gdk_texture_new_for_surface (surface);
   cairo_surface_destroy (surface);
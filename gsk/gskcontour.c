@@ -97,6 +97,7 @@ struct _GskContourClass
   float                 (* get_distance)        (const GskContour       *contour,
                                                  const GskPathPoint     *point,
                                                  gpointer                measure_data);
+  void                  (* clear)               (GskContour             *contour);
 };
 
 /* {{{ Utilities */
@@ -521,6 +522,7 @@ gsk_contour_print_default (const GskContour *contour,
 /* }}} */
 /* {{{ Standard */
 
+typedef struct _GskCurveTree GskCurveTree;
 typedef struct _GskStandardContour GskStandardContour;
 struct _GskStandardContour
 {
@@ -529,6 +531,7 @@ struct _GskStandardContour
   GskPathFlags flags;
 
   GskBoundingBox bounds;
+  GskCurveTree *tree; /* built on demand, see gsk_standard_contour_get_tree() */
 
   gsize n_ops;
   gsize n_points;
@@ -546,7 +549,9 @@ gsk_standard_contour_compute_size (gsize n_ops,
   gsize s = sizeof (GskStandardContour)
           + sizeof (gskpathop) * n_ops
           + sizeof (graphene_point_t) * n_points;
-  return s + (align - (s % align));
+
+  /* Round up, so the next contour in the path is aligned */
+  return (s + align - 1) / align * align;
 }
 
 static void
@@ -688,17 +693,111 @@ gsk_standard_contour_get_stroke_bounds (const GskContour *contour,
   return TRUE;
 }
 
-static int
-gsk_standard_contour_get_winding (const GskContour       *contour,
-                                  const graphene_point_t *point)
+/* {{{ Curve tree */
+
+/* Contours with many operations get a tree of bounding boxes
+ * over their curves the first time they are queried, so that
+ * hit testing only needs to look at the curves near the point.
+ *
+ * The leaves hold runs of consecutive operations, which tend
+ * to be close to each other. The tree is a complete binary tree
+ * stored in an array, with the children of node i at 2i + 1
+ * and 2i + 2. Visiting children in order keeps the results
+ * identical to walking over all operations.
+ */
+#define CURVE_TREE_MIN_OPS 256
+#define CURVE_TREE_LEAF_OPS 16
+
+struct _GskCurveTree
+{
+  gsize n_leaves; /* a power of two */
+  GskBoundingBox nodes[]; /* 2 * n_leaves - 1 */
+};
+
+static GskCurveTree *
+gsk_curve_tree_new (const GskStandardContour *self)
+{
+  GskCurveTree *tree;
+  gsize n_leaves, first_leaf;
+
+  n_leaves = 1;
+  while (n_leaves * CURVE_TREE_LEAF_OPS < self->n_ops)
+    n_leaves *= 2;
+  first_leaf = n_leaves - 1;
+
+  tree = g_malloc (sizeof (GskCurveTree) + sizeof (GskBoundingBox) * (2 * n_leaves - 1));
+  tree->n_leaves = n_leaves;
+
+  for (gsize i = 0; i < n_leaves; i++)
+    {
+      GskBoundingBox *leaf = &tree->nodes[first_leaf + i];
+      gsize end = MIN ((i + 1) * CURVE_TREE_LEAF_OPS, self->n_ops);
+
+      /* An empty box, which no query will ever enter.
+       * gsk_bounding_box_init() would sort the corners.
+       */
+      leaf->min = GRAPHENE_POINT_INIT (FLT_MAX, FLT_MAX);
+      leaf->max = GRAPHENE_POINT_INIT (-FLT_MAX, -FLT_MAX);
+
+      for (gsize j = i * CURVE_TREE_LEAF_OPS; j < end; j++)
+        {
+          GskCurve c;
+          GskBoundingBox b;
+
+          if (gsk_pathop_op (self->ops[j]) == GSK_PATH_MOVE)
+            continue;
+
+          gsk_curve_init (&c, self->ops[j]);
+          gsk_curve_get_bounds (&c, &b);
+          gsk_bounding_box_union (leaf, &b, leaf);
+        }
+    }
+
+  for (gsize i = first_leaf; i-- > 0; )
+    gsk_bounding_box_union (&tree->nodes[2 * i + 1], &tree->nodes[2 * i + 2], &tree->nodes[i]);
+
+  return tree;
+}
+
+static const GskCurveTree *
+gsk_standard_contour_get_tree (const GskStandardContour *contour)
 {
   GskStandardContour *self = (GskStandardContour *) contour;
-  int winding = 0;
 
-  if (!gsk_bounding_box_contains_point (&self->bounds, point))
+  if (self->n_ops < CURVE_TREE_MIN_OPS)
+    return NULL;
+
+  /* Paths are immutable and may be shared between threads */
+  if (g_once_init_enter (&self->tree))
+    g_once_init_leave (&self->tree, gsk_curve_tree_new (self));
+
+  return self->tree;
+}
+
+static int
+gsk_curve_tree_get_winding (const GskCurveTree       *tree,
+                            const GskStandardContour *self,
+                            gsize                     node,
+                            const graphene_point_t   *point)
+{
+  const GskBoundingBox *b = &tree->nodes[node];
+  gsize first_leaf = tree->n_leaves - 1;
+  gsize start, end;
+  int winding;
+
+  /* Same test as gsk_curve_get_crossing() does for curves */
+  if (b->max.y < point->y || b->min.y > point->y || b->max.x < point->x)
     return 0;
 
-  for (gsize i = 0; i < self->n_ops; i ++)
+  if (node < first_leaf)
+    return gsk_curve_tree_get_winding (tree, self, 2 * node + 1, point) +
+           gsk_curve_tree_get_winding (tree, self, 2 * node + 2, point);
+
+  start = (node - first_leaf) * CURVE_TREE_LEAF_OPS;
+  end = MIN (start + CURVE_TREE_LEAF_OPS, self->n_ops);
+  winding = 0;
+
+  for (gsize i = start; i < end; i++)
     {
       GskCurve c;
 
@@ -709,6 +808,95 @@ gsk_standard_contour_get_winding (const GskContour       *contour,
       winding += gsk_curve_get_crossing (&c, point);
     }
 
+  return winding;
+}
+
+static float
+bounding_box_distance (const GskBoundingBox   *b,
+                       const graphene_point_t *point)
+{
+  float dx = MAX (MAX (b->min.x - point->x, point->x - b->max.x), 0);
+  float dy = MAX (MAX (b->min.y - point->y, point->y - b->max.y), 0);
+
+  return sqrtf (dx * dx + dy * dy);
+}
+
+static void
+gsk_curve_tree_get_closest_point (const GskCurveTree       *tree,
+                                  const GskStandardContour *self,
+                                  gsize                     node,
+                                  const graphene_point_t   *point,
+                                  float                    *threshold,
+                                  unsigned int             *best_idx,
+                                  float                    *best_t)
+{
+  gsize first_leaf = tree->n_leaves - 1;
+  gsize start, end;
+
+  if (bounding_box_distance (&tree->nodes[node], point) > *threshold)
+    return;
+
+  if (node < first_leaf)
+    {
+      gsk_curve_tree_get_closest_point (tree, self, 2 * node + 1, point, threshold, best_idx, best_t);
+      gsk_curve_tree_get_closest_point (tree, self, 2 * node + 2, point, threshold, best_idx, best_t);
+      return;
+    }
+
+  start = (node - first_leaf) * CURVE_TREE_LEAF_OPS;
+  end = MIN (start + CURVE_TREE_LEAF_OPS, self->n_ops);
+
+  for (gsize i = start; i < end; i++)
+    {
+      GskCurve c;
+      float distance, t;
+
+      if (gsk_pathop_op (self->ops[i]) == GSK_PATH_MOVE)
+        continue;
+
+      gsk_curve_init (&c, self->ops[i]);
+      if (gsk_curve_get_closest_point (&c, point, *threshold, &distance, &t) &&
+          distance < *threshold)
+        {
+          *best_idx = i;
+          *best_t = t;
+          *threshold = distance;
+        }
+    }
+}
+
+/* }}} */
+
+static int
+gsk_standard_contour_get_winding (const GskContour       *contour,
+                                  const graphene_point_t *point)
+{
+  GskStandardContour *self = (GskStandardContour *) contour;
+  const GskCurveTree *tree;
+  int winding = 0;
+
+  if (!gsk_bounding_box_contains_point (&self->bounds, point))
+    return 0;
+
+  tree = gsk_standard_contour_get_tree (self);
+  if (tree)
+    {
+      winding = gsk_curve_tree_get_winding (tree, self, 0, point);
+    }
+  else
+    {
+      for (gsize i = 0; i < self->n_ops; i ++)
+        {
+          GskCurve c;
+
+          if (gsk_pathop_op (self->ops[i]) == GSK_PATH_MOVE)
+            continue;
+
+          gsk_curve_init (&c, self->ops[i]);
+          winding += gsk_curve_get_crossing (&c, point);
+        }
+    }
+
   if ((self->flags & GSK_PATH_CLOSED) == 0)
     {
       GskCurve c;
@@ -739,6 +927,7 @@ gsk_standard_contour_get_closest_point (const GskContour       *contour,
                                         float                  *out_dist)
 {
   GskStandardContour *self = (GskStandardContour *) contour;
+  const GskCurveTree *tree;
   unsigned int best_idx = G_MAXUINT;
   float best_t = 0;
 
@@ -760,21 +949,29 @@ gsk_standard_contour_get_closest_point (const GskContour       *contour,
       return FALSE;
     }
 
-  for (gsize i = 0; i < self->n_ops; i ++)
+  tree = gsk_standard_contour_get_tree (self);
+  if (tree)
     {
-      GskCurve c;
-      float distance, t;
-
-      if (gsk_pathop_op (self->ops[i]) == GSK_PATH_MOVE)
-        continue;
-
-      gsk_curve_init (&c, self->ops[i]);
-      if (gsk_curve_get_closest_point (&c, point, threshold, &distance, &t) &&
-          distance < threshold)
+      gsk_curve_tree_get_closest_point (tree, self, 0, point, &threshold, &best_idx, &best_t);
+    }
+  else
+    {
+      for (gsize i = 0; i < self->n_ops; i ++)
         {
-          best_idx = i;
-          best_t = t;
-          threshold = distance;
+          GskCurve c;
+          float distance, t;
+
+          if (gsk_pathop_op (self->ops[i]) == GSK_PATH_MOVE)
+            continue;
+
+          gsk_curve_init (&c, self->ops[i]);
+          if (gsk_curve_get_closest_point (&c, point, threshold, &distance, &t) &&
+              distance < threshold)
+            {
+              best_idx = i;
+              best_t = t;
+              threshold = distance;
+            }
         }
     }
 
@@ -1257,6 +1454,14 @@ gsk_standard_contour_get_distance (const GskContour   *contour,
   return p0->length * (1 - fraction) + p1->length * fraction;
 }
 
+static void
+gsk_standard_contour_clear (GskContour *contour)
+{
+  GskStandardContour *self = (GskStandardContour *) contour;
+
+  g_clear_pointer (&self->tree, g_free);
+}
+
 static const GskContourClass GSK_STANDARD_CONTOUR_CLASS =
 {
   sizeof (GskStandardContour),
@@ -1280,6 +1485,7 @@ static const GskContourClass GSK_STANDARD_CONTOUR_CLASS =
   gsk_standard_contour_free_measure,
   gsk_standard_contour_get_point,
   gsk_standard_contour_get_distance,
+  gsk_standard_contour_clear,
 };
 
 /* You must ensure the contour has enough size allocated,
@@ -1300,6 +1506,7 @@ gsk_standard_contour_init (GskContour             *contour,
   self->contour.klass = &GSK_STANDARD_CONTOUR_CLASS;
 
   self->flags = flags;
+  self->tree = NULL;
   self->n_ops = n_ops;
   self->n_points = n_points;
   self->points = (graphene_point_t *) &self->ops[n_ops];
@@ -2634,6 +2841,16 @@ gsk_contour_get_distance (const GskContour   *self,
   return self->klass->get_distance (self, point, measure_data);
 }
 
+/* Frees data that the contour caches for queries.
+ * The contour may be used again afterwards.
+ */
+void
+gsk_contour_clear (GskContour *self)
+{
+  if (self->klass->clear)
+    self->klass->clear (self);
+}
+
 /* }}} */
 
 /* vim:set foldmethod=marker expandtab: */
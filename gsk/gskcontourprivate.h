@@ -94,5 +94,6 @@ void                    gsk_contour_get_point                   (const GskContou
 float                   gsk_contour_get_distance                (const GskContour       *self,
                                                                  const GskPathPoint     *point,
                                                                  gpointer                measure_data);
+void                    gsk_contour_clear                       (GskContour             *self);
 
 G_END_DECLS
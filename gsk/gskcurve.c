@@ -211,6 +211,34 @@ get_length_by_approximation (const GskCurve *curve,
   return z * sum;
 }
 
+/* The derivatives of quads and cubics are polynomials
+ *
+ *   a * t^2 + b * t + c
+ *
+ * so we can evaluate them for all samples in a single loop,
+ * instead of creating the derivative curve for every sample.
+ */
+static float
+get_length_of_polynomial (const graphene_point_t *a,
+                          const graphene_point_t *b,
+                          const graphene_point_t *c,
+                          float                   t)
+{
+  double z = t / 2;
+  double sum = 0;
+
+  for (unsigned int i = 0; i < G_N_ELEMENTS (T); i++)
+    {
+      double s = z * T[i] + z;
+      double dx = (a->x * s + b->x) * s + c->x;
+      double dy = (a->y * s + b->y) * s + c->y;
+
+      sum += C[i] * sqrt (dx * dx + dy * dy);
+    }
+
+  return z * sum;
+}
+
 /* Compute the inverse of the arclength using bisection,
  * to a given precision
  */
@@ -220,7 +248,6 @@ get_t_by_bisection (const GskCurve *curve,
                     float           epsilon)
 {
   float t1, t2, t, l;
-  GskCurve c1;
 
   g_assert (epsilon >= FLT_EPSILON);
 
@@ -233,9 +260,7 @@ get_t_by_bisection (const GskCurve *curve,
       if (t == t1 || t == t2)
         break;
 
-      gsk_curve_split (curve, t, &c1, NULL);
-
-      l = gsk_curve_get_length (&c1);
+      l = gsk_curve_get_length_to (curve, t);
       if (fabsf (length - l) < epsilon)
         break;
       else if (l < length)
@@ -894,7 +919,14 @@ static float
 gsk_quad_curve_get_length_to (const GskCurve *curve,
                               float           t)
 {
-  return get_length_by_approximation (curve, t);
+  const GskQuadCurve *self = &curve->quad;
+
+  gsk_quad_curve_ensure_coefficients (self);
+
+  return get_length_of_polynomial (&GRAPHENE_POINT_INIT (0, 0),
+                                   &GRAPHENE_POINT_INIT (2 * self->coeffs[0].x, 2 * self->coeffs[0].y),
+                                   &self->coeffs[1],
+                                   t);
 }
 
 static float
@@ -1373,7 +1405,14 @@ static float
 gsk_cubic_curve_get_length_to (const GskCurve *curve,
                                float           t)
 {
-  return get_length_by_approximation (curve, t);
+  const GskCubicCurve *self = &curve->cubic;
+
+  gsk_cubic_curve_ensure_coefficients (self);
+
+  return get_length_of_polynomial (&GRAPHENE_POINT_INIT (3 * self->coeffs[0].x, 3 * self->coeffs[0].y),
+                                   &GRAPHENE_POINT_INIT (2 * self->coeffs[1].x, 2 * self->coeffs[1].y),
+                                   &self->coeffs[2],
+                                   t);
 }
 
 static float
@@ -15,6 +15,8 @@ static const GdkDebugKey gsk_debug_keys[] = {
   { "staging", GSK_DEBUG_STAGING, "Use a staging image for texture upload (Vulkan only)" },
   { "offload-disable", GSK_DEBUG_OFFLOAD_DISABLE, "Disable graphics offload" },
   { "cairo", GSK_DEBUG_CAIRO, "Overlay error pattern over Cairo drawing (finds fallbacks)" },
+  { "gpu-timings", GSK_DEBUG_GPU_TIMINGS, "Measure GPU time spent per operation (ngl and vulkan)" },
+  { "intern-disable", GSK_DEBUG_INTERN_DISABLE, "Disable sharing of identical render nodes" },
 };
 
 static guint gsk_debug_flags;
@@ -29,6 +29,7 @@
 #include "gskdebugprivate.h"
 #include "gskrendernodeprivate.h"
 #include "gdksurfaceprivate.h"
+#include "gdkprofilerprivate.h"
 
 #include <graphene.h>
 
@@ -132,8 +133,15 @@ find_texture_to_attach (GskOffload          *self,
           break;
 
         case GSK_TEXTURE_NODE:
+        case GSK_TEXTURE_SCALE_NODE:
           {
-            GdkTexture *texture = gsk_texture_node_get_texture (node);
+            GdkTexture *texture;
+
+            /* The compositor does the scaling, so the filter is a hint at best */
+            if (GSK_RENDER_NODE_TYPE (node) == GSK_TEXTURE_NODE)
+              texture = gsk_texture_node_get_texture (node);
+            else
+              texture = gsk_texture_scale_node_get_texture (node);
 
             if (has_clip)
               {
@@ -391,6 +399,32 @@ find_subsurface_info (GskOffload    *self,
   return NULL;
 }
 
+/* Crops dest to the clip and adjusts source to match.
+ * Returns FALSE if nothing is left.
+ */
+static gboolean
+crop_to_clip (const graphene_rect_t *clip,
+              graphene_rect_t       *source,
+              graphene_rect_t       *dest)
+{
+  graphene_rect_t cropped;
+  float sx, sy;
+
+  if (!gsk_rect_intersection (dest, clip, &cropped))
+    return FALSE;
+
+  sx = source->size.width / dest->size.width;
+  sy = source->size.height / dest->size.height;
+
+  source->origin.x += (cropped.origin.x - dest->origin.x) * sx;
+  source->origin.y += (cropped.origin.y - dest->origin.y) * sy;
+  source->size.width = cropped.size.width * sx;
+  source->size.height = cropped.size.height * sy;
+  *dest = cropped;
+
+  return TRUE;
+}
+
 static void
 visit_node (GskOffload    *self,
             GskRenderNode *node)
@@ -560,11 +594,15 @@ complex_clip:
                                "Can't offload: unknown subsurface %p",
                                subsurface);
           }
-        else if (!self->current_clip->is_fully_contained)
+        else if (!self->current_clip->is_fully_contained &&
+                 (self->current_clip->is_empty ||
+                  self->current_clip->is_complex ||
+                  !self->current_clip->is_rectilinear))
           {
             GDK_DISPLAY_DEBUG (gdk_surface_get_display (self->surface), OFFLOAD,
                                "Can't offload subsurface %p: clipped",
                                subsurface);
+            info->rejected = GSK_OFFLOAD_REJECTED_CLIP;
           }
         else if (self->transforms &&
                  gsk_transform_get_category ((GskTransform *)self->transforms->data) < GSK_TRANSFORM_CATEGORY_2D_AFFINE)
@@ -572,6 +610,7 @@ complex_clip:
             GDK_DISPLAY_DEBUG (gdk_surface_get_display (self->surface), OFFLOAD,
                                "Can't offload subsurface %p: non-affine transform",
                                subsurface);
+            info->rejected = GSK_OFFLOAD_REJECTED_TRANSFORM;
           }
         else
           {
@@ -580,13 +619,29 @@ complex_clip:
             info->texture = find_texture_to_attach (self, subsurface, gsk_subsurface_node_get_child (node), &clip);
             if (info->texture)
               {
-                info->can_offload = TRUE;
-                info->can_raise = TRUE;
                 info->source = clip;
                 transform_bounds (self, &node->bounds, &info->dest);
-                info->place_above = self->last_info ? self->last_info->subsurface : NULL;
-                self->last_info = info;
+
+                /* Rectangular clips can be done by cropping the viewport */
+                if (!self->current_clip->is_fully_contained &&
+                    !crop_to_clip (&self->current_clip->rect.bounds, &info->source, &info->dest))
+                  {
+                    GDK_DISPLAY_DEBUG (gdk_surface_get_display (self->surface), OFFLOAD,
+                                       "Can't offload subsurface %p: clipped away",
+                                       subsurface);
+                    info->texture = NULL;
+                    info->rejected = GSK_OFFLOAD_REJECTED_CLIP;
+                  }
+                else
+                  {
+                    info->can_offload = TRUE;
+                    info->can_raise = TRUE;
+                    info->place_above = self->last_info ? self->last_info->subsurface : NULL;
+                    self->last_info = info;
+                  }
               }
+            else
+              info->rejected = GSK_OFFLOAD_REJECTED_CONTENT;
           }
       }
       break;
@@ -601,6 +656,33 @@ complex_clip:
     pop_clip (self);
 }
 
+static void
+gsk_offload_report_rejections (GskOffload *self)
+{
+  static const char *names[GSK_OFFLOAD_N_REJECTED][2] = {
+    [GSK_OFFLOAD_REJECTED_CLIP] = { "offload-rejected-clip", "Subsurfaces not offloaded due to clips" },
+    [GSK_OFFLOAD_REJECTED_TRANSFORM] = { "offload-rejected-transform", "Subsurfaces not offloaded due to transforms" },
+    [GSK_OFFLOAD_REJECTED_CONTENT] = { "offload-rejected-content", "Subsurfaces not offloaded due to their content" },
+    [GSK_OFFLOAD_REJECTED_ATTACH] = { "offload-rejected-attach", "Subsurfaces where attaching the texture failed" },
+  };
+  static guint counters[GSK_OFFLOAD_N_REJECTED];
+  static gsize initialized = 0;
+  guint counts[GSK_OFFLOAD_N_REJECTED] = { 0, };
+
+  if (g_once_init_enter (&initialized))
+    {
+      for (gsize i = GSK_OFFLOAD_REJECTED_NONE + 1; i < GSK_OFFLOAD_N_REJECTED; i++)
+        counters[i] = gdk_profiler_define_int_counter (names[i][0], names[i][1]);
+      g_once_init_leave (&initialized, 1);
+    }
+
+  for (gsize i = 0; i < self->n_subsurfaces; i++)
+    counts[self->subsurfaces[i].rejected]++;
+
+  for (gsize i = GSK_OFFLOAD_REJECTED_NONE + 1; i < GSK_OFFLOAD_N_REJECTED; i++)
+    gdk_profiler_set_int_counter (counters[i], counts[i]);
+}
+
 GskOffload *
 gsk_offload_new (GdkSurface     *surface,
                  GskRenderNode  *root,
@@ -661,6 +743,9 @@ gsk_offload_new (GdkSurface     *surface,
                                                         &info->dest,
                                                         info->place_above != NULL,
                                                         info->place_above);
+
+          if (!info->is_offloaded)
+            info->rejected = GSK_OFFLOAD_REJECTED_ATTACH;
         }
       else
         {
@@ -699,6 +784,9 @@ gsk_offload_new (GdkSurface     *surface,
 
     }
 
+  if (self->n_subsurfaces > 0)
+    gsk_offload_report_rejections (self);
+
   return self;
 }
 
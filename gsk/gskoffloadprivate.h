@@ -26,6 +26,16 @@
 
 typedef struct _GskOffload GskOffload;
 
+typedef enum
+{
+  GSK_OFFLOAD_REJECTED_NONE,
+  GSK_OFFLOAD_REJECTED_CLIP,
+  GSK_OFFLOAD_REJECTED_TRANSFORM,
+  GSK_OFFLOAD_REJECTED_CONTENT,
+  GSK_OFFLOAD_REJECTED_ATTACH,
+  GSK_OFFLOAD_N_REJECTED
+} GskOffloadRejected;
+
 typedef struct
 {
   GdkSubsurface *subsurface;
@@ -34,6 +44,8 @@ typedef struct
   graphene_rect_t dest;
   graphene_rect_t source;
 
+  GskOffloadRejected rejected;
+
   guint was_offloaded : 1;
   guint can_offload   : 1;
   guint is_offloaded  : 1;
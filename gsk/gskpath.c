@@ -69,26 +69,20 @@ G_DEFINE_BOXED_TYPE (GskPath, gsk_path, gsk_path_ref, gsk_path_unref)
 /* {{{ Private API */
 
 GskPath *
-gsk_path_new_from_contours (const GSList *contours)
+gsk_path_new_from_contours (const GskContour * const *contours,
+                            gsize                     n_contours)
 {
   GskPath *path;
-  const GSList *l;
-  gsize size;
-  gsize n_contours;
+  gsize i, size;
   guint8 *contour_data;
   GskPathFlags flags;
 
   flags = GSK_PATH_CLOSED | GSK_PATH_FLAT;
-  size = 0;
-  n_contours = 0;
-  for (l = contours; l; l = l->next)
+  size = n_contours * sizeof (GskContour *);
+  for (i = 0; i < n_contours; i++)
     {
-      GskContour *contour = l->data;
-
-      n_contours++;
-      size += sizeof (GskContour *);
-      size += gsk_contour_get_size (contour);
-      flags &= gsk_contour_get_flags (contour);
+      size += gsk_contour_get_size (contours[i]);
+      flags &= gsk_contour_get_flags (contours[i]);
     }
 
   path = g_malloc0 (sizeof (GskPath) + size);
@@ -96,17 +90,12 @@ gsk_path_new_from_contours (const GSList *contours)
   path->flags = flags;
   path->n_contours = n_contours;
   contour_data = (guint8 *) &path->contours[n_contours];
-  n_contours = 0;
 
-  for (l = contours; l; l = l->next)
+  for (i = 0; i < n_contours; i++)
     {
-      GskContour *contour = l->data;
-
-      path->contours[n_contours] = (GskContour *) contour_data;
-      gsk_contour_copy ((GskContour *) contour_data, contour);
-      size = gsk_contour_get_size (contour);
-      contour_data += size;
-      n_contours++;
+      path->contours[i] = (GskContour *) contour_data;
+      gsk_contour_copy ((GskContour *) contour_data, contours[i]);
+      contour_data += gsk_contour_get_size (contours[i]);
     }
 
   return path;
@@ -177,6 +166,9 @@ gsk_path_unref (GskPath *self)
   if (self->ref_count > 0)
     return;
 
+  for (gsize i = 0; i < self->n_contours; i++)
+    gsk_contour_clear (self->contours[i]);
+
   g_free (self);
 }
 
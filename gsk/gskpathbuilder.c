@@ -78,7 +78,7 @@ struct _GskPathBuilder
 {
   int ref_count;
 
-  GSList *contours; /* (reverse) list of already recorded contours */
+  GPtrArray *contours; /* already recorded contours */
 
   GskPathFlags flags; /* flags for the current path */
   graphene_point_t current_point; /* the point all drawing ops start from */
@@ -112,6 +112,7 @@ gsk_path_builder_new (void)
   self = g_slice_new0 (GskPathBuilder);
   self->ref_count = 1;
 
+  self->contours = g_ptr_array_new_with_free_func (g_free);
   self->ops = g_array_new (FALSE, FALSE, sizeof (gskpathop));
   self->points = g_array_new (FALSE, FALSE, sizeof (graphene_point_t));
 
@@ -211,8 +212,7 @@ gsk_path_builder_clear (GskPathBuilder *self)
 {
   gsk_path_builder_end_current (self);
 
-  g_slist_free_full (self->contours, g_free);
-  self->contours = NULL;
+  g_ptr_array_set_size (self->contours, 0);
 }
 
 /**
@@ -235,6 +235,7 @@ gsk_path_builder_unref (GskPathBuilder *self)
     return;
 
   gsk_path_builder_clear (self);
+  g_ptr_array_unref (self->contours);
   g_array_unref (self->ops);
   g_array_unref (self->points);
   g_slice_free (GskPathBuilder, self);
@@ -293,9 +294,8 @@ gsk_path_builder_to_path (GskPathBuilder *self)
 
   gsk_path_builder_end_current (self);
 
-  self->contours = g_slist_reverse (self->contours);
-
-  path = gsk_path_new_from_contours (self->contours);
+  path = gsk_path_new_from_contours ((const GskContour * const *) self->contours->pdata,
+                                     self->contours->len);
 
   gsk_path_builder_clear (self);
 
@@ -308,7 +308,7 @@ gsk_path_builder_add_contour (GskPathBuilder *self,
 {
   gsk_path_builder_end_current (self);
 
-  self->contours = g_slist_prepend (self->contours, contour);
+  g_ptr_array_add (self->contours, contour);
 }
 
 /**
@@ -47,6 +47,7 @@ typedef struct _GskContourMeasure GskContourMeasure;
 
 struct _GskContourMeasure
 {
+  float offset; /* sum of the lengths of all previous contours */
   float length;
   gpointer contour_data;
 };
@@ -59,7 +60,9 @@ struct _GskPathMeasure
   GskPath *path;
   float tolerance;
 
-  float length;
+  /* Contours are measured on demand, in order. This is the
+   * number of contours that have been measured so far. */
+  gsize n_measured;
   gsize n_contours;
   GskContourMeasure measures[];
 };
@@ -101,7 +104,7 @@ gsk_path_measure_new_with_tolerance (GskPath *path,
                                      float    tolerance)
 {
   GskPathMeasure *self;
-  gsize i, n_contours;
+  gsize n_contours;
 
   g_return_val_if_fail (path != NULL, NULL);
   g_return_val_if_fail (tolerance > 0, NULL);
@@ -115,15 +118,36 @@ gsk_path_measure_new_with_tolerance (GskPath *path,
   self->tolerance = tolerance;
   self->n_contours = n_contours;
 
-  for (i = 0; i < n_contours; i++)
+  return self;
+}
+
+/* Measures all contours up to and including the given one */
+static void
+gsk_path_measure_ensure_contour (GskPathMeasure *self,
+                                 gsize           contour)
+{
+  for (; self->n_measured <= contour; self->n_measured++)
     {
-      self->measures[i].contour_data = gsk_contour_init_measure (gsk_path_get_contour (path, i),
-                                                                 self->tolerance,
-                                                                 &self->measures[i].length);
-      self->length += self->measures[i].length;
+      GskContourMeasure *measure = &self->measures[self->n_measured];
+
+      if (self->n_measured > 0)
+        measure->offset = measure[-1].offset + measure[-1].length;
+      measure->contour_data = gsk_contour_init_measure (gsk_path_get_contour (self->path, self->n_measured),
+                                                        self->tolerance,
+                                                        &measure->length);
     }
+}
 
-  return self;
+/* Measures contours until one ends after the given distance,
+ * or all of them are measured */
+static void
+gsk_path_measure_ensure_distance (GskPathMeasure *self,
+                                  float           distance)
+{
+  while (self->n_measured < self->n_contours &&
+         (self->n_measured == 0 ||
+          self->measures[self->n_measured - 1].offset + self->measures[self->n_measured - 1].length <= distance))
+    gsk_path_measure_ensure_contour (self, self->n_measured);
 }
 
 /**
@@ -168,7 +192,7 @@ gsk_path_measure_unref (GskPathMeasure *self)
   if (self->ref_count > 0)
     return;
 
-  for (i = 0; i < self->n_contours; i++)
+  for (i = 0; i < self->n_measured; i++)
     {
       gsk_contour_free_measure (gsk_path_get_contour (self->path, i),
                                 self->measures[i].contour_data);
@@ -227,17 +251,12 @@ gsk_path_measure_get_length (GskPathMeasure *self)
 {
   g_return_val_if_fail (self != NULL, 0);
 
-  return self->length;
-}
-
-static float
-gsk_path_measure_clamp_distance (GskPathMeasure *self,
-                                 float           distance)
-{
-  if (isnan (distance))
+  if (self->n_contours == 0)
     return 0;
 
-  return CLAMP (distance, 0, self->length);
+  gsk_path_measure_ensure_contour (self, self->n_contours - 1);
+
+  return self->measures[self->n_contours - 1].offset + self->measures[self->n_contours - 1].length;
 }
 
 /**
@@ -259,7 +278,7 @@ gsk_path_measure_get_point (GskPathMeasure *self,
                             float           distance,
                             GskPathPoint   *result)
 {
-  gsize i;
+  gsize i, lo, hi;
   const GskContour *contour;
 
   g_return_val_if_fail (self != NULL, FALSE);
@@ -268,19 +287,32 @@ gsk_path_measure_get_point (GskPathMeasure *self,
   if (self->n_contours == 0)
     return FALSE;
 
-  distance = gsk_path_measure_clamp_distance (self, distance);
+  if (isnan (distance) || distance < 0)
+    distance = 0;
+
+  gsk_path_measure_ensure_distance (self, distance);
 
-  for (i = 0; i < self->n_contours - 1; i++)
+  /* Find the last contour that starts at or before the distance.
+   * All contours before it end before the distance, so with empty
+   * contours, this is the same contour a linear search would find.
+   */
+  lo = 0;
+  hi = self->n_measured - 1;
+  while (lo < hi)
     {
-      if (distance < self->measures[i].length)
-        break;
+      gsize mid = (lo + hi + 1) / 2;
 
-      distance -= self->measures[i].length;
+      if (self->measures[mid].offset <= distance)
+        lo = mid;
+      else
+        hi = mid - 1;
     }
 
+  i = lo;
+
   g_assert (0 <= i && i < self->n_contours);
 
-  distance = CLAMP (distance, 0, self->measures[i].length);
+  distance = CLAMP (distance - self->measures[i].offset, 0, self->measures[i].length);
 
   contour = gsk_path_get_contour (self->path, i);
 
@@ -309,20 +341,13 @@ float
 gsk_path_point_get_distance (const GskPathPoint *point,
                              GskPathMeasure     *measure)
 {
-  float contour_offset = 0;
-
   g_return_val_if_fail (measure != NULL, 0);
   g_return_val_if_fail (gsk_path_point_valid (point, measure->path), 0);
 
-  for (gsize i = 0; i < measure->n_contours; i++)
-    {
-      if (i == point->contour)
-        return contour_offset + gsk_contour_get_distance (gsk_path_get_contour (measure->path, i),
-                                                          point,
-                                                          measure->measures[i].contour_data);
-
-      contour_offset += measure->measures[i].length;
-    }
+  gsk_path_measure_ensure_contour (measure, point->contour);
 
-  g_return_val_if_reached (0);
+  return measure->measures[point->contour].offset +
+         gsk_contour_get_distance (gsk_path_get_contour (measure->path, point->contour),
+                                   point,
+                                   measure->measures[point->contour].contour_data);
 }
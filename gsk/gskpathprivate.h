@@ -38,7 +38,8 @@ typedef struct _GskRealPathPoint GskRealPathPoint;
 /* Same as Skia, so looks like a good value. ¯\_(ツ)_/¯ */
 #define GSK_PATH_TOLERANCE_DEFAULT (0.5)
 
-GskPath *               gsk_path_new_from_contours              (const GSList           *contours);
+GskPath *               gsk_path_new_from_contours              (const GskContour * const *contours,
+                                                                 gsize                     n_contours);
 
 gsize                   gsk_path_get_n_contours                 (const GskPath          *self);
 const GskContour *      gsk_path_get_contour                    (const GskPath          *self,
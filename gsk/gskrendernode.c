@@ -40,11 +40,15 @@
 
 #include "gskdebugprivate.h"
 #include "gskrendererprivate.h"
+#include "gskrendernodebinaryprivate.h"
 #include "gskrendernodeparserprivate.h"
 
+#include "gdk/gdkallocationsprivate.h"
+
 #include <graphene-gobject.h>
 
 #include <math.h>
+#include <string.h>
 
 #include <gobject/gvaluecollector.h>
 
@@ -132,10 +136,70 @@ value_render_node_lcopy_value (const GValue *value,
   return NULL;
 }
 
+/* Snapshots create and release thousands of small nodes every frame.
+ * Instead of going through the allocator for every one of them, we
+ * keep a bounded number of freed instances per type around and reuse
+ * them. We can't use per-frame arenas, because nodes are refcounted
+ * and routinely outlive the frame that created them.
+ */
+#define MAX_CACHED_NODES_PER_TYPE 1024
+
+G_LOCK_DEFINE_STATIC (node_cache);
+static GPtrArray *node_cache[GSK_RENDER_NODE_TYPE_N_TYPES];
+static gsize node_instance_size[GSK_RENDER_NODE_TYPE_N_TYPES];
+
+static GskRenderNode *
+gsk_render_node_alloc_cached (GskRenderNodeType node_type)
+{
+  GskRenderNode *node = NULL;
+  gsize instance_size;
+
+  G_LOCK (node_cache);
+
+  if (node_cache[node_type] && node_cache[node_type]->len > 0)
+    node = g_ptr_array_steal_index_fast (node_cache[node_type], node_cache[node_type]->len - 1);
+  instance_size = node_instance_size[node_type];
+
+  G_UNLOCK (node_cache);
+
+  if (node == NULL)
+    return NULL;
+
+  /* re-initialize like g_type_create_instance() would */
+  memset ((guchar *) node + sizeof (GTypeInstance), 0, instance_size - sizeof (GTypeInstance));
+  g_atomic_ref_count_init (&node->ref_count);
+
+  return node;
+}
+
 static void
 gsk_render_node_finalize (GskRenderNode *self)
 {
-  g_type_free_instance ((GTypeInstance *) self);
+  GskRenderNodeType node_type = GSK_RENDER_NODE_TYPE (self);
+
+  gdk_allocation_remove (GDK_ALLOCATION_RENDER_NODE);
+
+  G_LOCK (node_cache);
+
+  if (node_cache[node_type] == NULL)
+    {
+      GTypeQuery query;
+
+      g_type_query (gsk_render_node_types[node_type], &query);
+      node_instance_size[node_type] = query.instance_size;
+      node_cache[node_type] = g_ptr_array_new ();
+    }
+
+  if (node_cache[node_type]->len < MAX_CACHED_NODES_PER_TYPE)
+    {
+      g_ptr_array_add (node_cache[node_type], self);
+      self = NULL;
+    }
+
+  G_UNLOCK (node_cache);
+
+  if (self)
+    g_type_free_instance ((GTypeInstance *) self);
 }
 
 static void
@@ -271,11 +335,26 @@ gsk_render_node_type_register_static (const char     *node_name,
 gpointer
 gsk_render_node_alloc (GskRenderNodeType node_type)
 {
+  GskRenderNode *node;
+
   g_return_val_if_fail (node_type > GSK_NOT_A_RENDER_NODE, NULL);
   g_return_val_if_fail (node_type < GSK_RENDER_NODE_TYPE_N_TYPES, NULL);
 
   g_assert (gsk_render_node_types[node_type] != G_TYPE_INVALID);
-  return g_type_create_instance (gsk_render_node_types[node_type]);
+
+  node = gsk_render_node_alloc_cached (node_type);
+  if (node == NULL)
+    node = (GskRenderNode *) g_type_create_instance (gsk_render_node_types[node_type]);
+
+  if (GDK_ALLOCATION_TRACKING)
+    {
+      GTypeQuery query;
+
+      g_type_query (gsk_render_node_types[node_type], &query);
+      gdk_allocation_record (GDK_ALLOCATION_RENDER_NODE, 1, 0, query.instance_size);
+    }
+
+  return node;
 }
 
 /**
@@ -297,7 +376,9 @@ GskRenderNode *
 void
 _gsk_render_node_unref (GskRenderNode *node)
 {
-  if G_UNLIKELY (g_atomic_ref_count_dec (&node->ref_count))
+  if G_UNLIKELY (node->interned)
+    gsk_render_node_unref_interned (node);
+  else if G_UNLIKELY (g_atomic_ref_count_dec (&node->ref_count))
     GSK_RENDER_NODE_GET_CLASS (node)->finalize (node);
 }
 
@@ -603,9 +684,11 @@ gsk_render_node_write_to_file (GskRenderNode *node,
  * @error_func: (nullable) (scope call): Callback on parsing errors
  * @user_data: (closure error_func): user_data for @error_func
  *
- * Loads data previously created via [method@Gsk.RenderNode.serialize].
+ * Loads data previously created via [method@Gsk.RenderNode.serialize]
+ * or [method@Gsk.RenderNode.serialize_binary].
  *
- * For a discussion of the supported format, see that function.
+ * The format of the data is detected automatically. For a discussion
+ * of the supported formats, see those functions.
  *
  * Returns: (nullable) (transfer full): a new `GskRenderNode`
  */
@@ -616,7 +699,10 @@ gsk_render_node_deserialize (GBytes            *bytes,
 {
   GskRenderNode *node = NULL;
 
-  node = gsk_render_node_deserialize_from_bytes (bytes, error_func, user_data);
+  if (gsk_render_node_is_binary (bytes))
+    node = gsk_render_node_deserialize_binary (bytes, error_func, user_data);
+  else
+    node = gsk_render_node_deserialize_from_bytes (bytes, error_func, user_data);
 
   return node;
 }
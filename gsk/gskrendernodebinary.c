@@ -0,0 +1,1597 @@
+/*
+ * Copyright © 2024 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gskrendernodebinaryprivate.h"
+
+#include "gskprivate.h"
+#include "gskrendernodeparserprivate.h"
+#include "gskrendernodeprivate.h"
+
+#include "gdk/gdkmemoryformatprivate.h"
+#include "gdk/gdkmemorytextureprivate.h"
+#include "gdk/gdktexturedownloaderprivate.h"
+
+#include <pango/pangocairo.h>
+#include <string.h>
+
+/*
+ * The binary format
+ *
+ * The binary format is meant for quickly saving and loading large
+ * recordings, the text format stays the format for interchange.
+ * It uses the byte order of the machine that wrote it, and loading
+ * the file on a machine with a different byte order fails.
+ *
+ * The file starts with a GskBinaryHeader, followed by the data area
+ * and the tables. All offsets are relative to the start of the file.
+ *
+ * - The string table lists the NUL-terminated strings in the data area,
+ *   every string is stored only once.
+ * - The texture table lists the pixel data of textures in the data area,
+ *   in the texture's own memory format. Every texture is stored only once
+ *   and the data is aligned, so it can be used without copying when the
+ *   file is mapped into memory.
+ * - The node table lists the offsets of the node records. A record is
+ *   the node type followed by the node's properties. Child nodes are
+ *   referenced by their index in the node table, and children are always
+ *   stored before their parents, so nodes can be created in table order.
+ *   Nodes that are used multiple times are only stored once, too.
+ *
+ * Nodes that have no binary representation are stored as a record of
+ * type GSK_NOT_A_RENDER_NODE containing their text serialization.
+ */
+
+#define GSK_BINARY_VERSION 1
+#define GSK_BINARY_BYTE_ORDER 0x01020304
+#define GSK_BINARY_TEXT_NODE GSK_NOT_A_RENDER_NODE
+
+static const guchar gsk_binary_magic[8] = { 0x89, 'G', 'S', 'K', 'N', 'O', 'D', 'E' };
+
+typedef struct _GskBinaryHeader GskBinaryHeader;
+typedef struct _GskBinaryString GskBinaryString;
+typedef struct _GskBinaryTexture GskBinaryTexture;
+
+struct _GskBinaryHeader
+{
+  guchar magic[8];
+  guint32 byte_order;
+  guint32 version;
+  guint32 n_strings;
+  guint32 n_textures;
+  guint32 n_nodes;
+  guint32 root;
+  guint64 strings_offset;
+  guint64 textures_offset;
+  guint64 nodes_offset;
+};
+
+struct _GskBinaryString
+{
+  guint64 offset;
+  guint32 length;
+  guint32 padding;
+};
+
+struct _GskBinaryTexture
+{
+  guint64 offset;
+  guint64 size;
+  guint32 width;
+  guint32 height;
+  guint32 format;
+  guint32 stride;
+};
+
+G_STATIC_ASSERT (sizeof (GskBinaryHeader) == 56);
+G_STATIC_ASSERT (sizeof (GskBinaryString) == 16);
+G_STATIC_ASSERT (sizeof (GskBinaryTexture) == 32);
+
+/* {{{ Writing */
+
+typedef struct _Writer Writer;
+
+struct _Writer
+{
+  GByteArray *data;
+  GHashTable *strings;   /* char * => index + 1 */
+  GArray *string_table;
+  GHashTable *textures;  /* GdkTexture * => index + 1 */
+  GArray *texture_table;
+  GHashTable *nodes;     /* GskRenderNode * => index + 1 */
+  GArray *node_table;    /* guint64 offsets */
+};
+
+static void
+writer_align (Writer *self,
+              gsize   alignment)
+{
+  static const guchar zeros[16] = { 0, };
+
+  if (self->data->len % alignment)
+    g_byte_array_append (self->data, zeros, alignment - self->data->len % alignment);
+}
+
+static guint32
+writer_add_string (Writer     *self,
+                   const char *string)
+{
+  GskBinaryString entry = { 0, };
+  gpointer index;
+
+  if (g_hash_table_lookup_extended (self->strings, string, NULL, &index))
+    return GPOINTER_TO_UINT (index) - 1;
+
+  entry.offset = self->data->len;
+  entry.length = strlen (string);
+  g_byte_array_append (self->data, (const guchar *) string, entry.length + 1);
+  g_array_append_val (self->string_table, entry);
+
+  g_hash_table_insert (self->strings, g_strdup (string), GUINT_TO_POINTER (self->string_table->len));
+
+  return self->string_table->len - 1;
+}
+
+static guint32
+writer_add_texture (Writer     *self,
+                    GdkTexture *texture)
+{
+  GskBinaryTexture entry = { 0, };
+  GdkTextureDownloader downloader;
+  GBytes *bytes;
+  gsize stride;
+  gpointer index;
+
+  index = g_hash_table_lookup (self->textures, texture);
+  if (index)
+    return GPOINTER_TO_UINT (index) - 1;
+
+  gdk_texture_downloader_init (&downloader, texture);
+  gdk_texture_downloader_set_format (&downloader, gdk_texture_get_format (texture));
+  bytes = gdk_texture_downloader_download_bytes (&downloader, &stride);
+  gdk_texture_downloader_finish (&downloader);
+
+  writer_align (self, 16);
+  entry.offset = self->data->len;
+  entry.size = g_bytes_get_size (bytes);
+  entry.width = gdk_texture_get_width (texture);
+  entry.height = gdk_texture_get_height (texture);
+  entry.format = gdk_texture_get_format (texture);
+  entry.stride = stride;
+  g_byte_array_append (self->data, g_bytes_get_data (bytes, NULL), entry.size);
+  g_array_append_val (self->texture_table, entry);
+
+  g_bytes_unref (bytes);
+
+  g_hash_table_insert (self->textures, texture, GUINT_TO_POINTER (self->texture_table->len));
+
+  return self->texture_table->len - 1;
+}
+
+static void
+write_u32 (GByteArray *record,
+           guint32     value)
+{
+  g_byte_array_append (record, (const guchar *) &value, sizeof (value));
+}
+
+static void
+write_i32 (GByteArray *record,
+           gint32      value)
+{
+  g_byte_array_append (record, (const guchar *) &value, sizeof (value));
+}
+
+static void
+write_float (GByteArray *record,
+             float       value)
+{
+  g_byte_array_append (record, (const guchar *) &value, sizeof (value));
+}
+
+static void
+write_point (GByteArray             *record,
+             const graphene_point_t *point)
+{
+  write_float (record, point->x);
+  write_float (record, point->y);
+}
+
+static void
+write_rect (GByteArray            *record,
+            const graphene_rect_t *rect)
+{
+  write_float (record, rect->origin.x);
+  write_float (record, rect->origin.y);
+  write_float (record, rect->size.width);
+  write_float (record, rect->size.height);
+}
+
+static void
+write_rounded_rect (GByteArray           *record,
+                    const GskRoundedRect *rect)
+{
+  int i;
+
+  write_rect (record, &rect->bounds);
+  for (i = 0; i < 4; i++)
+    {
+      write_float (record, rect->corner[i].width);
+      write_float (record, rect->corner[i].height);
+    }
+}
+
+static void
+write_rgba (GByteArray    *record,
+            const GdkRGBA *rgba)
+{
+  write_float (record, rgba->red);
+  write_float (record, rgba->green);
+  write_float (record, rgba->blue);
+  write_float (record, rgba->alpha);
+}
+
+static void
+write_color_stops (GByteArray         *record,
+                   const GskColorStop *stops,
+                   gsize               n_stops)
+{
+  gsize i;
+
+  write_u32 (record, n_stops);
+  for (i = 0; i < n_stops; i++)
+    {
+      write_float (record, stops[i].offset);
+      write_rgba (record, &stops[i].color);
+    }
+}
+
+static guint32 writer_add_node (Writer        *self,
+                                GskRenderNode *node);
+
+static void
+write_node (Writer        *self,
+            GByteArray    *record,
+            GskRenderNode *node)
+{
+  write_u32 (record, writer_add_node (self, node));
+}
+
+static void
+write_string (Writer     *self,
+              GByteArray *record,
+              const char *string)
+{
+  write_u32 (record, writer_add_string (self, string));
+}
+
+static gboolean
+text_node_has_custom_font (GskRenderNode *node)
+{
+  PangoFont *font = gsk_text_node_get_font (node);
+
+  /* fonts loaded from data urls only exist in the text format */
+  return g_object_get_data (G_OBJECT (pango_font_get_font_map (font)), "font-files") != NULL;
+}
+
+static void
+write_text_node (Writer        *self,
+                 GByteArray    *record,
+                 GskRenderNode *node)
+{
+  PangoFont *font = gsk_text_node_get_font (node);
+  PangoFontDescription *desc;
+  const PangoGlyphInfo *glyphs;
+  cairo_font_options_t *options;
+  char *s;
+  guint i, n_glyphs;
+
+  desc = pango_font_describe_with_absolute_size (font);
+  s = pango_font_description_to_string (desc);
+  write_string (self, record, s);
+  g_free (s);
+  pango_font_description_free (desc);
+
+  options = cairo_font_options_create ();
+  cairo_scaled_font_get_font_options (pango_cairo_font_get_scaled_font (PANGO_CAIRO_FONT (font)), options);
+  write_u32 (record, cairo_font_options_get_hint_style (options));
+  write_u32 (record, cairo_font_options_get_antialias (options));
+  cairo_font_options_destroy (options);
+
+  write_rgba (record, gsk_text_node_get_color (node));
+  write_point (record, gsk_text_node_get_offset (node));
+
+  glyphs = gsk_text_node_get_glyphs (node, &n_glyphs);
+  write_u32 (record, n_glyphs);
+  for (i = 0; i < n_glyphs; i++)
+    {
+      write_u32 (record, glyphs[i].glyph);
+      write_i32 (record, glyphs[i].geometry.width);
+      write_i32 (record, glyphs[i].geometry.x_offset);
+      write_i32 (record, glyphs[i].geometry.y_offset);
+      write_u32 (record, (glyphs[i].attr.is_cluster_start ? 1 : 0) |
+                         (glyphs[i].attr.is_color ? 2 : 0));
+    }
+}
+
+static void
+write_text_fallback (Writer        *self,
+                     GByteArray    *record,
+                     GskRenderNode *node)
+{
+  GBytes *bytes;
+
+  bytes = gsk_render_node_serialize (node);
+  write_u32 (record, GSK_BINARY_TEXT_NODE);
+  write_string (self, record, g_bytes_get_data (bytes, NULL));
+  g_bytes_unref (bytes);
+}
+
+static guint32
+writer_add_node (Writer        *self,
+                 GskRenderNode *node)
+{
+  GskRenderNodeType node_type;
+  GByteArray *record;
+  gpointer index;
+  guint64 offset;
+
+  index = g_hash_table_lookup (self->nodes, node);
+  if (index)
+    return GPOINTER_TO_UINT (index) - 1;
+
+  node_type = gsk_render_node_get_node_type (node);
+  record = g_byte_array_new ();
+  write_u32 (record, node_type);
+
+  switch (node_type)
+    {
+    case GSK_CONTAINER_NODE:
+      {
+        guint i, n_children;
+
+        n_children = gsk_container_node_get_n_children (node);
+        write_u32 (record, n_children);
+        for (i = 0; i < n_children; i++)
+          write_node (self, record, gsk_container_node_get_child (node, i));
+      }
+      break;
+
+    case GSK_COLOR_NODE:
+      write_rect (record, &node->bounds);
+      write_rgba (record, gsk_color_node_get_color (node));
+      break;
+
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+      {
+        const GskColorStop *stops;
+        gsize n_stops;
+
+        stops = gsk_linear_gradient_node_get_color_stops (node, &n_stops);
+        write_rect (record, &node->bounds);
+        write_point (record, gsk_linear_gradient_node_get_start (node));
+        write_point (record, gsk_linear_gradient_node_get_end (node));
+        write_color_stops (record, stops, n_stops);
+      }
+      break;
+
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+      {
+        const GskColorStop *stops;
+        gsize n_stops;
+
+        stops = gsk_radial_gradient_node_get_color_stops (node, &n_stops);
+        write_rect (record, &node->bounds);
+        write_point (record, gsk_radial_gradient_node_get_center (node));
+        write_float (record, gsk_radial_gradient_node_get_hradius (node));
+        write_float (record, gsk_radial_gradient_node_get_vradius (node));
+        write_float (record, gsk_radial_gradient_node_get_start (node));
+        write_float (record, gsk_radial_gradient_node_get_end (node));
+        write_color_stops (record, stops, n_stops);
+      }
+      break;
+
+    case GSK_CONIC_GRADIENT_NODE:
+      {
+        const GskColorStop *stops;
+        gsize n_stops;
+
+        stops = gsk_conic_gradient_node_get_color_stops (node, &n_stops);
+        write_rect (record, &node->bounds);
+        write_point (record, gsk_conic_gradient_node_get_center (node));
+        write_float (record, gsk_conic_gradient_node_get_rotation (node));
+        write_color_stops (record, stops, n_stops);
+      }
+      break;
+
+    case GSK_BORDER_NODE:
+      {
+        const float *widths = gsk_border_node_get_widths (node);
+        const GdkRGBA *colors = gsk_border_node_get_colors (node);
+        int i;
+
+        write_rounded_rect (record, gsk_border_node_get_outline (node));
+        for (i = 0; i < 4; i++)
+          write_float (record, widths[i]);
+        for (i = 0; i < 4; i++)
+          write_rgba (record, &colors[i]);
+      }
+      break;
+
+    case GSK_TEXTURE_NODE:
+      write_rect (record, &node->bounds);
+      write_u32 (record, writer_add_texture (self, gsk_texture_node_get_texture (node)));
+      break;
+
+    case GSK_TEXTURE_SCALE_NODE:
+      write_rect (record, &node->bounds);
+      write_u32 (record, writer_add_texture (self, gsk_texture_scale_node_get_texture (node)));
+      write_u32 (record, gsk_texture_scale_node_get_filter (node));
+      break;
+
+    case GSK_INSET_SHADOW_NODE:
+      write_rounded_rect (record, gsk_inset_shadow_node_get_outline (node));
+      write_rgba (record, gsk_inset_shadow_node_get_color (node));
+      write_float (record, gsk_inset_shadow_node_get_dx (node));
+      write_float (record, gsk_inset_shadow_node_get_dy (node));
+      write_float (record, gsk_inset_shadow_node_get_spread (node));
+      write_float (record, gsk_inset_shadow_node_get_blur_radius (node));
+      break;
+
+    case GSK_OUTSET_SHADOW_NODE:
+      write_rounded_rect (record, gsk_outset_shadow_node_get_outline (node));
+      write_rgba (record, gsk_outset_shadow_node_get_color (node));
+      write_float (record, gsk_outset_shadow_node_get_dx (node));
+      write_float (record, gsk_outset_shadow_node_get_dy (node));
+      write_float (record, gsk_outset_shadow_node_get_spread (node));
+      write_float (record, gsk_outset_shadow_node_get_blur_radius (node));
+      break;
+
+    case GSK_TRANSFORM_NODE:
+      {
+        char *s;
+
+        write_node (self, record, gsk_transform_node_get_child (node));
+        s = gsk_transform_to_string (gsk_transform_node_get_transform (node));
+        write_string (self, record, s);
+        g_free (s);
+      }
+      break;
+
+    case GSK_OPACITY_NODE:
+      write_node (self, record, gsk_opacity_node_get_child (node));
+      write_float (record, gsk_opacity_node_get_opacity (node));
+      break;
+
+    case GSK_COLOR_MATRIX_NODE:
+      {
+        float values[16];
+        int i;
+
+        write_node (self, record, gsk_color_matrix_node_get_child (node));
+        graphene_matrix_to_float (gsk_color_matrix_node_get_color_matrix (node), values);
+        for (i = 0; i < 16; i++)
+          write_float (record, values[i]);
+        graphene_vec4_to_float (gsk_color_matrix_node_get_color_offset (node), values);
+        for (i = 0; i < 4; i++)
+          write_float (record, values[i]);
+      }
+      break;
+
+    case GSK_REPEAT_NODE:
+      write_rect (record, &node->bounds);
+      write_node (self, record, gsk_repeat_node_get_child (node));
+      write_rect (record, gsk_repeat_node_get_child_bounds (node));
+      break;
+
+    case GSK_CLIP_NODE:
+      write_node (self, record, gsk_clip_node_get_child (node));
+      write_rect (record, gsk_clip_node_get_clip (node));
+      break;
+
+    case GSK_ROUNDED_CLIP_NODE:
+      write_node (self, record, gsk_rounded_clip_node_get_child (node));
+      write_rounded_rect (record, gsk_rounded_clip_node_get_clip (node));
+      break;
+
+    case GSK_SHADOW_NODE:
+      {
+        gsize i, n_shadows;
+
+        write_node (self, record, gsk_shadow_node_get_child (node));
+        n_shadows = gsk_shadow_node_get_n_shadows (node);
+        write_u32 (record, n_shadows);
+        for (i = 0; i < n_shadows; i++)
+          {
+            const GskShadow *shadow = gsk_shadow_node_get_shadow (node, i);
+
+            write_rgba (record, &shadow->color);
+            write_float (record, shadow->dx);
+            write_float (record, shadow->dy);
+            write_float (record, shadow->radius);
+          }
+      }
+      break;
+
+    case GSK_BLEND_NODE:
+      write_node (self, record, gsk_blend_node_get_bottom_child (node));
+      write_node (self, record, gsk_blend_node_get_top_child (node));
+      write_u32 (record, gsk_blend_node_get_blend_mode (node));
+      break;
+
+    case GSK_CROSS_FADE_NODE:
+      write_node (self, record, gsk_cross_fade_node_get_start_child (node));
+      write_node (self, record, gsk_cross_fade_node_get_end_child (node));
+      write_float (record, gsk_cross_fade_node_get_progress (node));
+      break;
+
+    case GSK_TEXT_NODE:
+      if (text_node_has_custom_font (node))
+        {
+          g_byte_array_set_size (record, 0);
+          write_text_fallback (self, record, node);
+        }
+      else
+        write_text_node (self, record, node);
+      break;
+
+    case GSK_BLUR_NODE:
+      write_node (self, record, gsk_blur_node_get_child (node));
+      write_float (record, gsk_blur_node_get_radius (node));
+      break;
+
+    case GSK_DEBUG_NODE:
+      {
+        const char *message = gsk_debug_node_get_message (node);
+
+        write_node (self, record, gsk_debug_node_get_child (node));
+        write_u32 (record, message != NULL);
+        if (message)
+          write_string (self, record, message);
+      }
+      break;
+
+    case GSK_MASK_NODE:
+      write_node (self, record, gsk_mask_node_get_source (node));
+      write_node (self, record, gsk_mask_node_get_mask (node));
+      write_u32 (record, gsk_mask_node_get_mask_mode (node));
+      break;
+
+    case GSK_CAIRO_NODE:
+    case GSK_GL_SHADER_NODE:
+    case GSK_FILL_NODE:
+    case GSK_STROKE_NODE:
+    case GSK_SUBSURFACE_NODE:
+      g_byte_array_set_size (record, 0);
+      write_text_fallback (self, record, node);
+      break;
+
+    case GSK_NOT_A_RENDER_NODE:
+    default:
+      g_assert_not_reached ();
+      break;
+    }
+
+  writer_align (self, 4);
+  offset = self->data->len;
+  g_byte_array_append (self->data, record->data, record->len);
+  g_byte_array_unref (record);
+
+  g_array_append_val (self->node_table, offset);
+  g_hash_table_insert (self->nodes, node, GUINT_TO_POINTER (self->node_table->len));
+
+  return self->node_table->len - 1;
+}
+
+/**
+ * gsk_render_node_serialize_binary:
+ * @node: a `GskRenderNode`
+ *
+ * Serializes the @node in a compact binary format.
+ *
+ * Unlike the text format produced by [method@Gsk.RenderNode.serialize],
+ * this format is not meant to be human-readable or stable across GTK
+ * versions. It stores strings, textures and nodes that are used
+ * multiple times only once, and textures are stored uncompressed.
+ * That makes it a lot faster to save and load large recordings.
+ *
+ * The data can be loaded again with [func@Gsk.RenderNode.deserialize],
+ * which recognizes the format automatically. The data is only valid on
+ * machines with the same byte order.
+ *
+ * Returns: a `GBytes` representing the node.
+ *
+ * Since: 4.16
+ */
+GBytes *
+gsk_render_node_serialize_binary (GskRenderNode *node)
+{
+  GskBinaryHeader header = { { 0, }, };
+  Writer writer;
+
+  g_return_val_if_fail (GSK_IS_RENDER_NODE (node), NULL);
+
+  writer.data = g_byte_array_new ();
+  writer.strings = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  writer.string_table = g_array_new (FALSE, FALSE, sizeof (GskBinaryString));
+  writer.textures = g_hash_table_new (g_direct_hash, g_direct_equal);
+  writer.texture_table = g_array_new (FALSE, FALSE, sizeof (GskBinaryTexture));
+  writer.nodes = g_hash_table_new (g_direct_hash, g_direct_equal);
+  writer.node_table = g_array_new (FALSE, FALSE, sizeof (guint64));
+
+  /* reserve space for the header */
+  g_byte_array_append (writer.data, (const guchar *) &header, sizeof (header));
+
+  header.root = writer_add_node (&writer, node);
+
+  writer_align (&writer, 8);
+  header.strings_offset = writer.data->len;
+  g_byte_array_append (writer.data,
+                       (const guchar *) writer.string_table->data,
+                       writer.string_table->len * sizeof (GskBinaryString));
+  header.textures_offset = writer.data->len;
+  g_byte_array_append (writer.data,
+                       (const guchar *) writer.texture_table->data,
+                       writer.texture_table->len * sizeof (GskBinaryTexture));
+  header.nodes_offset = writer.data->len;
+  g_byte_array_append (writer.data,
+                       (const guchar *) writer.node_table->data,
+                       writer.node_table->len * sizeof (guint64));
+
+  memcpy (header.magic, gsk_binary_magic, sizeof (gsk_binary_magic));
+  header.byte_order = GSK_BINARY_BYTE_ORDER;
+  header.version = GSK_BINARY_VERSION;
+  header.n_strings = writer.string_table->len;
+  header.n_textures = writer.texture_table->len;
+  header.n_nodes = writer.node_table->len;
+  memcpy (writer.data->data, &header, sizeof (header));
+
+  g_hash_table_unref (writer.strings);
+  g_array_unref (writer.string_table);
+  g_hash_table_unref (writer.textures);
+  g_array_unref (writer.texture_table);
+  g_hash_table_unref (writer.nodes);
+  g_array_unref (writer.node_table);
+
+  return g_byte_array_free_to_bytes (writer.data);
+}
+
+/* }}} */
+/* {{{ Reading */
+
+typedef struct _Reader Reader;
+
+struct _Reader
+{
+  GBytes *bytes;
+  const guchar *data;
+  gsize size;
+  GskBinaryHeader header;
+
+  GskRenderNode **nodes;
+  GdkTexture **textures;
+  guint32 current_node;
+  gsize pos;
+
+  GskParseErrorFunc error_func;
+  gpointer user_data;
+  gboolean failed;
+};
+
+static void reader_error (Reader     *self,
+                          const char *format,
+                          ...) G_GNUC_PRINTF (2, 3);
+
+static void
+reader_error (Reader     *self,
+              const char *format,
+              ...)
+{
+  GskParseLocation location = { 0, };
+  GError *error;
+  va_list args;
+
+  if (self->failed)
+    return;
+
+  self->failed = TRUE;
+
+  if (self->error_func == NULL)
+    return;
+
+  location.bytes = self->pos;
+  location.chars = self->pos;
+
+  va_start (args, format);
+  error = g_error_new_valist (GSK_SERIALIZATION_ERROR, GSK_SERIALIZATION_INVALID_DATA, format, args);
+  va_end (args);
+
+  self->error_func (&location, &location, error, self->user_data);
+
+  g_error_free (error);
+}
+
+static gboolean
+reader_check_range (Reader  *self,
+                    guint64  offset,
+                    guint64  size)
+{
+  if (offset > self->size || size > self->size - offset)
+    {
+      reader_error (self, "Data at offset %" G_GUINT64_FORMAT " is out of bounds", offset);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+reader_read (Reader   *self,
+             gpointer  out,
+             gsize     size)
+{
+  if (self->failed || !reader_check_range (self, self->pos, size))
+    {
+      memset (out, 0, size);
+      return;
+    }
+
+  memcpy (out, self->data + self->pos, size);
+  self->pos += size;
+}
+
+static guint32
+read_u32 (Reader *self)
+{
+  guint32 value;
+
+  reader_read (self, &value, sizeof (value));
+
+  return value;
+}
+
+static gint32
+read_i32 (Reader *self)
+{
+  gint32 value;
+
+  reader_read (self, &value, sizeof (value));
+
+  return value;
+}
+
+static float
+read_float (Reader *self)
+{
+  float value;
+
+  reader_read (self, &value, sizeof (value));
+
+  return value;
+}
+
+static guint32
+read_enum (Reader     *self,
+           guint32     max_value,
+           const char *name)
+{
+  guint32 value = read_u32 (self);
+
+  if (value > max_value)
+    {
+      reader_error (self, "Invalid %s %u", name, value);
+      return 0;
+    }
+
+  return value;
+}
+
+static void
+read_point (Reader           *self,
+            graphene_point_t *point)
+{
+  point->x = read_float (self);
+  point->y = read_float (self);
+}
+
+static void
+read_rect (Reader          *self,
+           graphene_rect_t *rect)
+{
+  rect->origin.x = read_float (self);
+  rect->origin.y = read_float (self);
+  rect->size.width = read_float (self);
+  rect->size.height = read_float (self);
+}
+
+static void
+read_rounded_rect (Reader         *self,
+                   GskRoundedRect *rect)
+{
+  int i;
+
+  read_rect (self, &rect->bounds);
+  for (i = 0; i < 4; i++)
+    {
+      rect->corner[i].width = read_float (self);
+      rect->corner[i].height = read_float (self);
+    }
+}
+
+static void
+read_rgba (Reader  *self,
+           GdkRGBA *rgba)
+{
+  rgba->red = read_float (self);
+  rgba->green = read_float (self);
+  rgba->blue = read_float (self);
+  rgba->alpha = read_float (self);
+}
+
+static GskColorStop *
+read_color_stops (Reader *self,
+                  gsize  *n_stops)
+{
+  GskColorStop *stops;
+  guint32 i, n;
+
+  n = read_u32 (self);
+  if (n < 2 || !reader_check_range (self, self->pos, (guint64) n * 5 * sizeof (float)))
+    {
+      reader_error (self, "Invalid number of color stops %u", n);
+      *n_stops = 0;
+      return NULL;
+    }
+
+  stops = g_new (GskColorStop, n);
+  for (i = 0; i < n; i++)
+    {
+      stops[i].offset = read_float (self);
+      read_rgba (self, &stops[i].color);
+
+      if (stops[i].offset < 0 || stops[i].offset > 1 ||
+          (i > 0 && stops[i].offset < stops[i - 1].offset))
+        reader_error (self, "Color stop offsets must be increasing values between 0 and 1");
+    }
+
+  *n_stops = n;
+
+  return stops;
+}
+
+static GskRenderNode *
+read_node (Reader *self)
+{
+  guint32 index = read_u32 (self);
+
+  if (self->failed)
+    return NULL;
+
+  /* children are always stored before their parents */
+  if (index >= self->current_node || self->nodes[index] == NULL)
+    {
+      reader_error (self, "Invalid child node %u", index);
+      return NULL;
+    }
+
+  return self->nodes[index];
+}
+
+static const char *
+read_string (Reader *self)
+{
+  GskBinaryString entry;
+  guint32 index;
+
+  index = read_u32 (self);
+  if (self->failed)
+    return NULL;
+
+  if (index >= self->header.n_strings)
+    {
+      reader_error (self, "Invalid string %u", index);
+      return NULL;
+    }
+
+  memcpy (&entry,
+          self->data + self->header.strings_offset + index * sizeof (GskBinaryString),
+          sizeof (GskBinaryString));
+
+  if (!reader_check_range (self, entry.offset, (guint64) entry.length + 1) ||
+      self->data[entry.offset + entry.length] != '\0')
+    {
+      reader_error (self, "Invalid string %u", index);
+      return NULL;
+    }
+
+  return (const char *) self->data + entry.offset;
+}
+
+static GdkTexture *
+read_texture (Reader *self)
+{
+  GskBinaryTexture entry;
+  GBytes *bytes;
+  guint32 index;
+  gsize bpp;
+
+  index = read_u32 (self);
+  if (self->failed)
+    return NULL;
+
+  if (index >= self->header.n_textures)
+    {
+      reader_error (self, "Invalid texture %u", index);
+      return NULL;
+    }
+
+  if (self->textures[index])
+    return self->textures[index];
+
+  memcpy (&entry,
+          self->data + self->header.textures_offset + index * sizeof (GskBinaryTexture),
+          sizeof (GskBinaryTexture));
+
+  if (entry.format >= GDK_MEMORY_N_FORMATS || entry.width == 0 || entry.height == 0)
+    {
+      reader_error (self, "Invalid texture %u", index);
+      return NULL;
+    }
+
+  bpp = gdk_memory_format_bytes_per_pixel (entry.format);
+  if (entry.stride < (guint64) entry.width * bpp ||
+      entry.size < (guint64) entry.stride * (entry.height - 1) + (guint64) entry.width * bpp ||
+      !reader_check_range (self, entry.offset, entry.size))
+    {
+      reader_error (self, "Invalid texture %u", index);
+      return NULL;
+    }
+
+  /* no copy, the texture references the data directly */
+  bytes = g_bytes_new_from_bytes (self->bytes, entry.offset, entry.size);
+  self->textures[index] = gdk_memory_texture_new (entry.width,
+                                                  entry.height,
+                                                  entry.format,
+                                                  bytes,
+                                                  entry.stride);
+  g_bytes_unref (bytes);
+
+  return self->textures[index];
+}
+
+static GskRenderNode *
+read_text_node (Reader *self)
+{
+  PangoFontMap *fontmap;
+  PangoFontDescription *desc;
+  PangoContext *context;
+  PangoFont *font, *hinted;
+  PangoGlyphString *glyphs;
+  cairo_hint_style_t hint_style;
+  cairo_antialias_t antialias;
+  graphene_point_t offset;
+  GskRenderNode *result;
+  const char *font_name;
+  GdkRGBA color;
+  guint32 i, n_glyphs;
+
+  font_name = read_string (self);
+  hint_style = read_enum (self, CAIRO_HINT_STYLE_FULL, "hint style");
+  antialias = read_enum (self, CAIRO_ANTIALIAS_BEST, "antialias");
+  read_rgba (self, &color);
+  read_point (self, &offset);
+  n_glyphs = read_u32 (self);
+  if (self->failed ||
+      !reader_check_range (self, self->pos, (guint64) n_glyphs * 5 * sizeof (guint32)))
+    return NULL;
+
+  fontmap = pango_cairo_font_map_get_default ();
+  desc = pango_font_description_from_string (font_name);
+  context = pango_font_map_create_context (fontmap);
+  font = pango_font_map_load_font (fontmap, context, desc);
+  g_object_unref (context);
+  pango_font_description_free (desc);
+  if (font == NULL)
+    {
+      reader_error (self, "Failed to load font \"%s\"", font_name);
+      return NULL;
+    }
+
+  hinted = gsk_reload_font (font, 1.0, CAIRO_HINT_METRICS_OFF, hint_style, antialias);
+  g_object_unref (font);
+
+  glyphs = pango_glyph_string_new ();
+  pango_glyph_string_set_size (glyphs, n_glyphs);
+  for (i = 0; i < n_glyphs; i++)
+    {
+      guint32 flags;
+
+      glyphs->glyphs[i].glyph = read_u32 (self);
+      glyphs->glyphs[i].geometry.width = read_i32 (self);
+      glyphs->glyphs[i].geometry.x_offset = read_i32 (self);
+      glyphs->glyphs[i].geometry.y_offset = read_i32 (self);
+      flags = read_u32 (self);
+      glyphs->glyphs[i].attr.is_cluster_start = (flags & 1) ? 1 : 0;
+      glyphs->glyphs[i].attr.is_color = (flags & 2) ? 1 : 0;
+    }
+
+  result = gsk_text_node_new (hinted, glyphs, &color, &offset);
+
+  pango_glyph_string_free (glyphs);
+  g_object_unref (hinted);
+
+  /* empty text nodes don't exist, but we need something */
+  if (result == NULL)
+    result = gsk_container_node_new (NULL, 0);
+
+  return result;
+}
+
+static GskRenderNode *
+read_text_fallback (Reader *self)
+{
+  const char *text;
+  GBytes *bytes;
+  GskRenderNode *result;
+
+  text = read_string (self);
+  if (text == NULL)
+    return NULL;
+
+  bytes = g_bytes_new_static (text, strlen (text));
+  result = gsk_render_node_deserialize_from_bytes (bytes, self->error_func, self->user_data);
+  g_bytes_unref (bytes);
+
+  return result;
+}
+
+static GskRenderNode *
+read_node_record (Reader *self)
+{
+  GskRenderNodeType node_type;
+
+  node_type = read_enum (self, GSK_SUBSURFACE_NODE, "node type");
+  if (self->failed)
+    return NULL;
+
+  switch (node_type)
+    {
+    case GSK_BINARY_TEXT_NODE:
+      return read_text_fallback (self);
+
+    case GSK_CONTAINER_NODE:
+      {
+        GskRenderNode **children;
+        GskRenderNode *result;
+        guint32 i, n_children;
+
+        n_children = read_u32 (self);
+        if (!reader_check_range (self, self->pos, (guint64) n_children * sizeof (guint32)))
+          return NULL;
+
+        children = g_new (GskRenderNode *, n_children);
+        for (i = 0; i < n_children; i++)
+          children[i] = read_node (self);
+
+        result = self->failed ? NULL : gsk_container_node_new (children, n_children);
+        g_free (children);
+
+        return result;
+      }
+
+    case GSK_COLOR_NODE:
+      {
+        graphene_rect_t bounds;
+        GdkRGBA color;
+
+        read_rect (self, &bounds);
+        read_rgba (self, &color);
+        if (self->failed)
+          return NULL;
+
+        return gsk_color_node_new (&color, &bounds);
+      }
+
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+      {
+        graphene_rect_t bounds;
+        graphene_point_t start, end;
+        GskColorStop *stops;
+        GskRenderNode *result;
+        gsize n_stops;
+
+        read_rect (self, &bounds);
+        read_point (self, &start);
+        read_point (self, &end);
+        stops = read_color_stops (self, &n_stops);
+        if (self->failed)
+          {
+            g_free (stops);
+            return NULL;
+          }
+
+        if (node_type == GSK_REPEATING_LINEAR_GRADIENT_NODE)
+          result = gsk_repeating_linear_gradient_node_new (&bounds, &start, &end, stops, n_stops);
+        else
+          result = gsk_linear_gradient_node_new (&bounds, &start, &end, stops, n_stops);
+        g_free (stops);
+
+        return result;
+      }
+
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+      {
+        graphene_rect_t bounds;
+        graphene_point_t center;
+        float hradius, vradius, start, end;
+        GskColorStop *stops;
+        GskRenderNode *result;
+        gsize n_stops;
+
+        read_rect (self, &bounds);
+        read_point (self, &center);
+        hradius = read_float (self);
+        vradius = read_float (self);
+        start = read_float (self);
+        end = read_float (self);
+        stops = read_color_stops (self, &n_stops);
+        if (self->failed)
+          {
+            g_free (stops);
+            return NULL;
+          }
+
+        if (node_type == GSK_REPEATING_RADIAL_GRADIENT_NODE)
+          result = gsk_repeating_radial_gradient_node_new (&bounds, &center, hradius, vradius, start, end, stops, n_stops);
+        else
+          result = gsk_radial_gradient_node_new (&bounds, &center, hradius, vradius, start, end, stops, n_stops);
+        g_free (stops);
+
+        return result;
+      }
+
+    case GSK_CONIC_GRADIENT_NODE:
+      {
+        graphene_rect_t bounds;
+        graphene_point_t center;
+        float rotation;
+        GskColorStop *stops;
+        GskRenderNode *result;
+        gsize n_stops;
+
+        read_rect (self, &bounds);
+        read_point (self, &center);
+        rotation = read_float (self);
+        stops = read_color_stops (self, &n_stops);
+        if (self->failed)
+          {
+            g_free (stops);
+            return NULL;
+          }
+
+        result = gsk_conic_gradient_node_new (&bounds, &center, rotation, stops, n_stops);
+        g_free (stops);
+
+        return result;
+      }
+
+    case GSK_BORDER_NODE:
+      {
+        GskRoundedRect outline;
+        float widths[4];
+        GdkRGBA colors[4];
+        int i;
+
+        read_rounded_rect (self, &outline);
+        for (i = 0; i < 4; i++)
+          widths[i] = read_float (self);
+        for (i = 0; i < 4; i++)
+          read_rgba (self, &colors[i]);
+        if (self->failed)
+          return NULL;
+
+        return gsk_border_node_new (&outline, widths, colors);
+      }
+
+    case GSK_TEXTURE_NODE:
+      {
+        graphene_rect_t bounds;
+        GdkTexture *texture;
+
+        read_rect (self, &bounds);
+        texture = read_texture (self);
+        if (self->failed)
+          return NULL;
+
+        return gsk_texture_node_new (texture, &bounds);
+      }
+
+    case GSK_TEXTURE_SCALE_NODE:
+      {
+        graphene_rect_t bounds;
+        GdkTexture *texture;
+        GskScalingFilter filter;
+
+        read_rect (self, &bounds);
+        texture = read_texture (self);
+        filter = read_enum (self, GSK_SCALING_FILTER_TRILINEAR, "scaling filter");
+        if (self->failed)
+          return NULL;
+
+        return gsk_texture_scale_node_new (texture, &bounds, filter);
+      }
+
+    case GSK_INSET_SHADOW_NODE:
+    case GSK_OUTSET_SHADOW_NODE:
+      {
+        GskRoundedRect outline;
+        GdkRGBA color;
+        float dx, dy, spread, blur_radius;
+
+        read_rounded_rect (self, &outline);
+        read_rgba (self, &color);
+        dx = read_float (self);
+        dy = read_float (self);
+        spread = read_float (self);
+        blur_radius = read_float (self);
+        if (self->failed)
+          return NULL;
+
+        if (node_type == GSK_INSET_SHADOW_NODE)
+          return gsk_inset_shadow_node_new (&outline, &color, dx, dy, spread, blur_radius);
+        else
+          return gsk_outset_shadow_node_new (&outline, &color, dx, dy, spread, blur_radius);
+      }
+
+    case GSK_TRANSFORM_NODE:
+      {
+        GskRenderNode *child, *result;
+        GskTransform *transform;
+        const char *s;
+
+        child = read_node (self);
+        s = read_string (self);
+        if (self->failed)
+          return NULL;
+
+        if (!gsk_transform_parse (s, &transform))
+          {
+            reader_error (self, "Invalid transform \"%s\"", s);
+            return NULL;
+          }
+
+        result = gsk_transform_node_new (child, transform);
+        gsk_transform_unref (transform);
+
+        return result;
+      }
+
+    case GSK_OPACITY_NODE:
+      {
+        GskRenderNode *child;
+        float opacity;
+
+        child = read_node (self);
+        opacity = read_float (self);
+        if (self->failed)
+          return NULL;
+
+        return gsk_opacity_node_new (child, opacity);
+      }
+
+    case GSK_COLOR_MATRIX_NODE:
+      {
+        GskRenderNode *child;
+        graphene_matrix_t matrix;
+        graphene_vec4_t offset;
+        float values[16];
+        int i;
+
+        child = read_node (self);
+        for (i = 0; i < 16; i++)
+          values[i] = read_float (self);
+        graphene_matrix_init_from_float (&matrix, values);
+        for (i = 0; i < 4; i++)
+          values[i] = read_float (self);
+        graphene_vec4_init_from_float (&offset, values);
+        if (self->failed)
+          return NULL;
+
+        return gsk_color_matrix_node_new (child, &matrix, &offset);
+      }
+
+    case GSK_REPEAT_NODE:
+      {
+        GskRenderNode *child;
+        graphene_rect_t bounds, child_bounds;
+
+        read_rect (self, &bounds);
+        child = read_node (self);
+        read_rect (self, &child_bounds);
+        if (self->failed)
+          return NULL;
+
+        return gsk_repeat_node_new (&bounds, child, &child_bounds);
+      }
+
+    case GSK_CLIP_NODE:
+      {
+        GskRenderNode *child;
+        graphene_rect_t clip;
+
+        child = read_node (self);
+        read_rect (self, &clip);
+        if (self->failed)
+          return NULL;
+
+        return gsk_clip_node_new (child, &clip);
+      }
+
+    case GSK_ROUNDED_CLIP_NODE:
+      {
+        GskRenderNode *child;
+        GskRoundedRect clip;
+
+        child = read_node (self);
+        read_rounded_rect (self, &clip);
+        if (self->failed)
+          return NULL;
+
+        return gsk_rounded_clip_node_new (child, &clip);
+      }
+
+    case GSK_SHADOW_NODE:
+      {
+        GskRenderNode *child, *result;
+        GskShadow *shadows;
+        guint32 i, n_shadows;
+
+        child = read_node (self);
+        n_shadows = read_u32 (self);
+        if (n_shadows == 0 ||
+            !reader_check_range (self, self->pos, (guint64) n_shadows * 7 * sizeof (float)))
+          {
+            reader_error (self, "Invalid number of shadows %u", n_shadows);
+            return NULL;
+          }
+
+        shadows = g_new (GskShadow, n_shadows);
+        for (i = 0; i < n_shadows; i++)
+          {
+            read_rgba (self, &shadows[i].color);
+            shadows[i].dx = read_float (self);
+            shadows[i].dy = read_float (self);
+            shadows[i].radius = read_float (self);
+          }
+
+        result = self->failed ? NULL : gsk_shadow_node_new (child, shadows, n_shadows);
+        g_free (shadows);
+
+        return result;
+      }
+
+    case GSK_BLEND_NODE:
+      {
+        GskRenderNode *bottom, *top;
+        GskBlendMode mode;
+
+        bottom = read_node (self);
+        top = read_node (self);
+        mode = read_enum (self, GSK_BLEND_MODE_LUMINOSITY, "blend mode");
+        if (self->failed)
+          return NULL;
+
+        return gsk_blend_node_new (bottom, top, mode);
+      }
+
+    case GSK_CROSS_FADE_NODE:
+      {
+        GskRenderNode *start, *end;
+        float progress;
+
+        start = read_node (self);
+        end = read_node (self);
+        progress = read_float (self);
+        if (self->failed)
+          return NULL;
+
+        return gsk_cross_fade_node_new (start, end, progress);
+      }
+
+    case GSK_TEXT_NODE:
+      return read_text_node (self);
+
+    case GSK_BLUR_NODE:
+      {
+        GskRenderNode *child;
+        float radius;
+
+        child = read_node (self);
+        radius = read_float (self);
+        if (self->failed)
+          return NULL;
+
+        return gsk_blur_node_new (child, radius);
+      }
+
+    case GSK_DEBUG_NODE:
+      {
+        GskRenderNode *child;
+        const char *message = NULL;
+
+        child = read_node (self);
+        if (read_u32 (self))
+          message = read_string (self);
+        if (self->failed)
+          return NULL;
+
+        return gsk_debug_node_new (child, g_strdup (message));
+      }
+
+    case GSK_MASK_NODE:
+      {
+        GskRenderNode *source, *mask;
+        GskMaskMode mode;
+
+        source = read_node (self);
+        mask = read_node (self);
+        mode = read_enum (self, GSK_MASK_MODE_INVERTED_LUMINANCE, "mask mode");
+        if (self->failed)
+          return NULL;
+
+        return gsk_mask_node_new (source, mask, mode);
+      }
+
+    case GSK_CAIRO_NODE:
+    case GSK_GL_SHADER_NODE:
+    case GSK_FILL_NODE:
+    case GSK_STROKE_NODE:
+    case GSK_SUBSURFACE_NODE:
+    default:
+      reader_error (self, "Unsupported node type %u", node_type);
+      return NULL;
+    }
+}
+
+/*
+ * gsk_render_node_is_binary:
+ * @bytes: the data to check
+ *
+ * Checks if @bytes starts with the header of the binary format.
+ *
+ * Returns: %TRUE if @bytes should be loaded with
+ *   gsk_render_node_deserialize_binary()
+ */
+gboolean
+gsk_render_node_is_binary (GBytes *bytes)
+{
+  gsize size;
+  const guchar *data = g_bytes_get_data (bytes, &size);
+
+  return size >= sizeof (gsk_binary_magic) &&
+         memcmp (data, gsk_binary_magic, sizeof (gsk_binary_magic)) == 0;
+}
+
+/*
+ * gsk_render_node_deserialize_binary:
+ * @bytes: the data created by gsk_render_node_serialize_binary()
+ * @error_func: (nullable) (scope call): Callback on parsing errors
+ * @user_data: (closure error_func): user_data for @error_func
+ *
+ * Loads a node from the binary format.
+ *
+ * Textures reference the data in @bytes instead of copying it, so
+ * if @bytes is a mapped file, no pixel data is ever copied.
+ *
+ * Unlike the text format, corrupt data is not recovered from.
+ *
+ * Returns: (nullable) (transfer full): the loaded node or %NULL
+ *   on error
+ */
+GskRenderNode *
+gsk_render_node_deserialize_binary (GBytes            *bytes,
+                                    GskParseErrorFunc  error_func,
+                                    gpointer           user_data)
+{
+  Reader reader = { 0, };
+  GskRenderNode *result;
+  guint32 i;
+
+  reader.bytes = bytes;
+  reader.data = g_bytes_get_data (bytes, &reader.size);
+  reader.error_func = error_func;
+  reader.user_data = user_data;
+
+  reader_read (&reader, &reader.header, sizeof (GskBinaryHeader));
+  if (reader.failed)
+    return NULL;
+
+  if (reader.header.byte_order != GSK_BINARY_BYTE_ORDER || reader.header.version != GSK_BINARY_VERSION)
+    {
+      if (error_func)
+        {
+          GskParseLocation location = { 0, };
+          GError *error;
+
+          if (reader.header.byte_order != GSK_BINARY_BYTE_ORDER)
+            error = g_error_new (GSK_SERIALIZATION_ERROR, GSK_SERIALIZATION_UNSUPPORTED_FORMAT,
+                                 "Data was written on a machine with different byte order");
+          else
+            error = g_error_new (GSK_SERIALIZATION_ERROR, GSK_SERIALIZATION_UNSUPPORTED_VERSION,
+                                 "Unsupported version %u", reader.header.version);
+          error_func (&location, &location, error, user_data);
+          g_error_free (error);
+        }
+      return NULL;
+    }
+
+  if (!reader_check_range (&reader, reader.header.strings_offset, (guint64) reader.header.n_strings * sizeof (GskBinaryString)) ||
+      !reader_check_range (&reader, reader.header.textures_offset, (guint64) reader.header.n_textures * sizeof (GskBinaryTexture)) ||
+      !reader_check_range (&reader, reader.header.nodes_offset, (guint64) reader.header.n_nodes * sizeof (guint64)))
+    return NULL;
+
+  if (reader.header.root >= reader.header.n_nodes)
+    {
+      reader_error (&reader, "Invalid root node %u", reader.header.root);
+      return NULL;
+    }
+
+  reader.nodes = g_new0 (GskRenderNode *, reader.header.n_nodes);
+  reader.textures = g_new0 (GdkTexture *, reader.header.n_textures);
+
+  for (i = 0; i < reader.header.n_nodes; i++)
+    {
+      guint64 offset;
+
+      memcpy (&offset,
+              reader.data + reader.header.nodes_offset + i * sizeof (guint64),
+              sizeof (guint64));
+
+      reader.current_node = i;
+      reader.pos = offset;
+      reader.nodes[i] = read_node_record (&reader);
+
+      if (reader.nodes[i] == NULL)
+        {
+          reader_error (&reader, "Failed to load node %u", i);
+          break;
+        }
+    }
+
+  if (reader.failed)
+    result = NULL;
+  else
+    result = gsk_render_node_ref (reader.nodes[reader.header.root]);
+
+  for (i = 0; i < reader.header.n_nodes; i++)
+    g_clear_pointer (&reader.nodes[i], gsk_render_node_unref);
+  g_free (reader.nodes);
+  for (i = 0; i < reader.header.n_textures; i++)
+    g_clear_object (&reader.textures[i]);
+  g_free (reader.textures);
+
+  return result;
+}
+
+/* }}} */
+
+/* vim:set foldmethod=marker expandtab: */
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "gskrendernode.h"
+
+gboolean        gsk_render_node_is_binary               (GBytes            *bytes);
+
+GskRenderNode * gsk_render_node_deserialize_binary      (GBytes            *bytes,
+                                                         GskParseErrorFunc  error_func,
+                                                         gpointer           user_data);
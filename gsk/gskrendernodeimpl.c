@@ -20,6 +20,7 @@
 
 #include "gskrendernodeprivate.h"
 
+#include "gskboundingboxprivate.h"
 #include "gskcairoblurprivate.h"
 #include "gskcairorenderer.h"
 #include "gskdebugprivate.h"
@@ -40,6 +41,7 @@
 #include "gdk/gdktextureprivate.h"
 #include "gdk/gdktexturedownloaderprivate.h"
 
+#include <float.h>
 #include <cairo.h>
 #ifdef CAIRO_HAS_SVG_SURFACE
 #include <cairo-svg.h>
@@ -57,6 +59,11 @@
  */
 #define MAX_RECTS_IN_DIFF 30
 
+/* maximal number of differing children we run a full diff on. Beyond
+ * that, we use the bounds of the differing children instead.
+ */
+#define MAX_CHILDREN_IN_DIFF 1024
+
 static inline void
 gsk_cairo_rectangle (cairo_t               *cr,
                      const graphene_rect_t *rect)
@@ -3152,6 +3159,8 @@ gsk_cairo_node_get_draw_context (GskRenderNode *node)
  *
  * A render node that can contain other render nodes.
  */
+typedef struct _GskContainerTree GskContainerTree;
+
 struct _GskContainerNode
 {
   GskRenderNode render_node;
@@ -3159,8 +3168,115 @@ struct _GskContainerNode
   gboolean disjoint;
   guint n_children;
   GskRenderNode **children;
+  GskContainerTree *tree; /* built on demand, see gsk_container_node_get_tree() */
 };
 
+/* Containers with many children get a tree of bounding boxes over
+ * their children the first time they are drawn, so that renderers
+ * only need to look at the children that intersect their clip.
+ *
+ * Like the curve tree of paths, the leaves hold runs of consecutive
+ * children and the tree is a complete binary tree stored in an array,
+ * with the children of node i at 2i + 1 and 2i + 2. Visiting it in
+ * order keeps the drawing order.
+ */
+#define CONTAINER_TREE_MIN_CHILDREN 256
+#define CONTAINER_TREE_LEAF_CHILDREN 16
+
+struct _GskContainerTree
+{
+  gsize n_leaves; /* a power of two */
+  GskBoundingBox nodes[]; /* 2 * n_leaves - 1 */
+};
+
+static GskContainerTree *
+gsk_container_tree_new (const GskContainerNode *self)
+{
+  GskContainerTree *tree;
+  gsize n_leaves, first_leaf;
+
+  n_leaves = 1;
+  while (n_leaves * CONTAINER_TREE_LEAF_CHILDREN < self->n_children)
+    n_leaves *= 2;
+  first_leaf = n_leaves - 1;
+
+  tree = g_malloc (sizeof (GskContainerTree) + sizeof (GskBoundingBox) * (2 * n_leaves - 1));
+  tree->n_leaves = n_leaves;
+
+  for (gsize i = 0; i < n_leaves; i++)
+    {
+      GskBoundingBox *leaf = &tree->nodes[first_leaf + i];
+      gsize end = MIN ((i + 1) * CONTAINER_TREE_LEAF_CHILDREN, self->n_children);
+
+      /* An empty box, which no query will ever enter */
+      leaf->min = GRAPHENE_POINT_INIT (FLT_MAX, FLT_MAX);
+      leaf->max = GRAPHENE_POINT_INIT (-FLT_MAX, -FLT_MAX);
+
+      for (gsize j = i * CONTAINER_TREE_LEAF_CHILDREN; j < end; j++)
+        {
+          GskBoundingBox b;
+
+          gsk_bounding_box_init_from_rect (&b, &self->children[j]->bounds);
+          gsk_bounding_box_union (leaf, &b, leaf);
+        }
+    }
+
+  for (gsize i = first_leaf; i-- > 0; )
+    gsk_bounding_box_union (&tree->nodes[2 * i + 1], &tree->nodes[2 * i + 2], &tree->nodes[i]);
+
+  return tree;
+}
+
+static const GskContainerTree *
+gsk_container_node_get_tree (const GskContainerNode *container)
+{
+  GskContainerNode *self = (GskContainerNode *) container;
+
+  if (self->n_children < CONTAINER_TREE_MIN_CHILDREN)
+    return NULL;
+
+  /* Nodes are immutable and may be drawn from multiple threads */
+  if (g_once_init_enter (&self->tree))
+    g_once_init_leave (&self->tree, gsk_container_tree_new (self));
+
+  return self->tree;
+}
+
+static void
+gsk_container_tree_foreach (const GskContainerTree   *tree,
+                            const GskContainerNode   *self,
+                            gsize                     node,
+                            const GskBoundingBox     *box,
+                            const graphene_rect_t    *rect,
+                            GskRenderNodeForeachFunc  func,
+                            gpointer                  user_data)
+{
+  const GskBoundingBox *b = &tree->nodes[node];
+  gsize first_leaf = tree->n_leaves - 1;
+  gsize start, end;
+
+  /* Same test as gsk_rect_intersects() */
+  if (b->min.x >= box->max.x || b->max.x <= box->min.x ||
+      b->min.y >= box->max.y || b->max.y <= box->min.y)
+    return;
+
+  if (node < first_leaf)
+    {
+      gsk_container_tree_foreach (tree, self, 2 * node + 1, box, rect, func, user_data);
+      gsk_container_tree_foreach (tree, self, 2 * node + 2, box, rect, func, user_data);
+      return;
+    }
+
+  start = (node - first_leaf) * CONTAINER_TREE_LEAF_CHILDREN;
+  end = MIN (start + CONTAINER_TREE_LEAF_CHILDREN, self->n_children);
+
+  for (gsize i = start; i < end; i++)
+    {
+      if (gsk_rect_intersects (&self->children[i]->bounds, rect))
+        func (self->children[i], user_data);
+    }
+}
+
 static void
 gsk_container_node_finalize (GskRenderNode *node)
 {
@@ -3171,6 +3287,7 @@ gsk_container_node_finalize (GskRenderNode *node)
     gsk_render_node_unref (container->children[i]);
 
   g_free (container->children);
+  g_free (container->tree);
 
   parent_class->finalize (node);
 }
@@ -3180,12 +3297,26 @@ gsk_container_node_draw (GskRenderNode *node,
                          cairo_t       *cr)
 {
   GskContainerNode *container = (GskContainerNode *) node;
+  graphene_rect_t clip;
+  double x1, y1, x2, y2;
   guint i;
 
-  for (i = 0; i < container->n_children; i++)
+  if (container->n_children < CONTAINER_TREE_MIN_CHILDREN)
     {
-      gsk_render_node_draw (container->children[i], cr);
+      for (i = 0; i < container->n_children; i++)
+        {
+          gsk_render_node_draw (container->children[i], cr);
+        }
+      return;
     }
+
+  cairo_clip_extents (cr, &x1, &y1, &x2, &y2);
+  graphene_rect_init (&clip, x1, y1, x2 - x1, y2 - y1);
+
+  gsk_container_node_foreach_in_rect (node,
+                                      &clip,
+                                      (GskRenderNodeForeachFunc) gsk_render_node_draw,
+                                      cr);
 }
 
 static int
@@ -3244,6 +3375,49 @@ gsk_render_node_diff_multiple (GskRenderNode **nodes1,
                                gsize           n_nodes2,
                                GskDiffData    *data)
 {
+  /* Identical nodes don't contribute to the diff, so skip the
+   * common start and end. With shared nodes, this usually leaves
+   * only the few children that actually changed.
+   */
+  while (n_nodes1 > 0 && n_nodes2 > 0 && nodes1[0] == nodes2[0])
+    {
+      nodes1++;
+      nodes2++;
+      n_nodes1--;
+      n_nodes2--;
+    }
+
+  while (n_nodes1 > 0 && n_nodes2 > 0 && nodes1[n_nodes1 - 1] == nodes2[n_nodes2 - 1])
+    {
+      n_nodes1--;
+      n_nodes2--;
+    }
+
+  if (n_nodes1 == 0 && n_nodes2 == 0)
+    return TRUE;
+
+  if (n_nodes1 + n_nodes2 > MAX_CHILDREN_IN_DIFF)
+    {
+      graphene_rect_t bounds;
+      cairo_rectangle_int_t rect;
+      gsize i;
+
+      if (n_nodes1 > 0)
+        bounds = nodes1[0]->bounds;
+      else
+        bounds = nodes2[0]->bounds;
+
+      for (i = 0; i < n_nodes1; i++)
+        graphene_rect_union (&bounds, &nodes1[i]->bounds, &bounds);
+      for (i = 0; i < n_nodes2; i++)
+        graphene_rect_union (&bounds, &nodes2[i]->bounds, &bounds);
+
+      gsk_rect_to_cairo_grow (&bounds, &rect);
+      cairo_region_union_rectangle (data->region, &rect);
+
+      return TRUE;
+    }
+
   return gsk_diff ((gconstpointer *) nodes1, n_nodes1,
                    (gconstpointer *) nodes2, n_nodes2,
                    gsk_container_node_get_diff_settings (),
@@ -3421,6 +3595,44 @@ gsk_container_node_is_disjoint (const GskRenderNode *node)
   return self->disjoint;
 }
 
+/*< private >
+ * gsk_container_node_foreach_in_rect:
+ * @node: a container `GskRenderNode`
+ * @rect: the area of interest
+ * @func: (scope call): function to call
+ * @user_data: data to pass to @func
+ *
+ * Calls @func for all children of @node whose bounds intersect @rect,
+ * in the order they are drawn.
+ *
+ * For containers with many children, this uses a tree of bounds, so
+ * that children far outside of @rect are not looked at.
+ */
+void
+gsk_container_node_foreach_in_rect (const GskRenderNode      *node,
+                                    const graphene_rect_t    *rect,
+                                    GskRenderNodeForeachFunc  func,
+                                    gpointer                  user_data)
+{
+  const GskContainerNode *self = (const GskContainerNode *) node;
+  const GskContainerTree *tree;
+  GskBoundingBox box;
+
+  tree = gsk_container_node_get_tree (self);
+  if (tree == NULL)
+    {
+      for (guint i = 0; i < self->n_children; i++)
+        {
+          if (gsk_rect_intersects (&self->children[i]->bounds, rect))
+            func (self->children[i], user_data);
+        }
+      return;
+    }
+
+  gsk_bounding_box_init_from_rect (&box, rect);
+  gsk_container_tree_foreach (tree, self, 0, &box, rect, func, user_data);
+}
+
 /* }}} */
 /* {{{ GSK_TRANSFORM_NODE */
 
@@ -4503,6 +4715,7 @@ struct _GskRoundedClipNode
 
   GskRenderNode *child;
   GskRoundedRect clip;
+  GskRoundedRectShape shape;
 };
 
 static void
@@ -4524,7 +4737,10 @@ gsk_rounded_clip_node_draw (GskRenderNode *node,
 
   cairo_save (cr);
 
-  gsk_rounded_rect_path (&self->clip, cr);
+  if (self->shape & GSK_ROUNDED_RECT_SHAPE_RECTILINEAR)
+    gsk_cairo_rectangle (cr, &self->clip.bounds);
+  else
+    gsk_rounded_rect_path (&self->clip, cr);
   cairo_clip (cr);
 
   gsk_render_node_draw (self->child, cr);
@@ -4597,6 +4813,7 @@ gsk_rounded_clip_node_new (GskRenderNode         *child,
 
   self->child = gsk_render_node_ref (child);
   gsk_rounded_rect_init_copy (&self->clip, clip);
+  self->shape = gsk_rounded_rect_get_shape (&self->clip);
 
   gsk_rect_intersection (&self->clip.bounds, &child->bounds, &node->bounds);
 
@@ -4637,6 +4854,14 @@ gsk_rounded_clip_node_get_clip (const GskRenderNode *node)
   return &self->clip;
 }
 
+/* Private */
+GskRoundedRectShape
+gsk_rounded_clip_node_get_shape (const GskRenderNode *self)
+{
+  const GskRoundedClipNode *node = (const GskRoundedClipNode *) self;
+  return node->shape;
+}
+
 /* }}} */
 /* {{{ GSK_FILL_NODE */
 
@@ -5986,8 +6211,15 @@ struct _GskBlurNode
 
   GskRenderNode *child;
   float radius;
+
+  /* The result of the last draw, protected by blur_cache */
+  cairo_surface_t *cached_surface;
+  graphene_rect_t cached_bounds;
 };
 
+/* Nodes are drawn from multiple threads by the GPU renderers */
+G_LOCK_DEFINE_STATIC (blur_cache);
+
 static void
 gsk_blur_node_finalize (GskRenderNode *node)
 {
@@ -5995,6 +6227,7 @@ gsk_blur_node_finalize (GskRenderNode *node)
   GskRenderNodeClass *parent_class = g_type_class_peek (g_type_parent (GSK_TYPE_BLUR_NODE));
 
   gsk_render_node_unref (self->child);
+  g_clear_pointer (&self->cached_surface, cairo_surface_destroy);
 
   parent_class->finalize (node);
 }
@@ -6168,20 +6401,40 @@ gsk_blur_node_draw (GskRenderNode *node,
   if (!gsk_rect_intersection (&blur_bounds, &node->bounds, &blur_bounds))
     return;
 
-  surface = cairo_surface_create_similar_image (cairo_get_target (cr),
-                                                CAIRO_FORMAT_ARGB32,
-                                                ceil (blur_bounds.size.width),
-                                                ceil (blur_bounds.size.height));
-  cairo_surface_set_device_offset (surface,
-                                   - blur_bounds.origin.x,
-                                   - blur_bounds.origin.y);
-
-  cr2 = cairo_create (surface);
-  gsk_render_node_draw (self->child, cr2);
-  cairo_destroy (cr2);
+  /* Blurring is expensive, and the result only depends on the area,
+   * so reuse the last one if it covers everything we need.
+   */
+  G_LOCK (blur_cache);
+  if (self->cached_surface &&
+      gsk_rect_contains_rect (&self->cached_bounds, &blur_bounds))
+    surface = cairo_surface_reference (self->cached_surface);
+  else
+    surface = NULL;
+  G_UNLOCK (blur_cache);
 
-  blur_image_surface (surface, (int) ceil (0.5 * self->radius), 3);
-  cairo_surface_mark_dirty (surface);
+  if (surface == NULL)
+    {
+      surface = cairo_surface_create_similar_image (cairo_get_target (cr),
+                                                    CAIRO_FORMAT_ARGB32,
+                                                    ceil (blur_bounds.size.width),
+                                                    ceil (blur_bounds.size.height));
+      cairo_surface_set_device_offset (surface,
+                                       - blur_bounds.origin.x,
+                                       - blur_bounds.origin.y);
+
+      cr2 = cairo_create (surface);
+      gsk_render_node_draw (self->child, cr2);
+      cairo_destroy (cr2);
+
+      blur_image_surface (surface, (int) ceil (0.5 * self->radius), 3);
+      cairo_surface_mark_dirty (surface);
+
+      G_LOCK (blur_cache);
+      g_clear_pointer (&self->cached_surface, cairo_surface_destroy);
+      self->cached_surface = cairo_surface_reference (surface);
+      self->cached_bounds = blur_bounds;
+      G_UNLOCK (blur_cache);
+    }
 
   cairo_set_source_surface (cr, surface, 0, 0);
   cairo_rectangle (cr,
@@ -7099,6 +7352,279 @@ gsk_subsurface_node_get_subsurface (const GskRenderNode *node)
   return self->subsurface;
 }
 
+/* }}} */
+/* {{{ Interning */
+
+/* Interned nodes are kept in a weak set and deduplicated by their
+ * structure, so that identical subtrees created in different places
+ * (or different frames) end up as the same node. Child nodes are
+ * compared by pointer, nodes that are only identical further down
+ * are not deduplicated.
+ */
+
+typedef struct
+{
+  gconstpointer data;
+  gsize size;
+} GskInternKey;
+
+#define GSK_INTERN_KEY_MAX 3
+
+G_LOCK_DEFINE_STATIC (interned_nodes);
+static GHashTable *interned_nodes;
+
+static guint
+gsk_render_node_get_intern_key (const GskRenderNode *node,
+                                GskInternKey         key[GSK_INTERN_KEY_MAX])
+{
+#define KEY(i, field) \
+  G_STMT_START { \
+    key[i].data = &(field); \
+    key[i].size = sizeof (field); \
+  } G_STMT_END
+
+  switch (GSK_RENDER_NODE_TYPE (node))
+    {
+    case GSK_COLOR_NODE:
+      KEY (0, ((GskColorNode *) node)->color);
+      return 1;
+
+    case GSK_BORDER_NODE:
+      KEY (0, ((GskBorderNode *) node)->outline);
+      KEY (1, ((GskBorderNode *) node)->border_width);
+      KEY (2, ((GskBorderNode *) node)->border_color);
+      return 3;
+
+    case GSK_TEXTURE_NODE:
+      KEY (0, ((GskTextureNode *) node)->texture);
+      return 1;
+
+    case GSK_TEXTURE_SCALE_NODE:
+      KEY (0, ((GskTextureScaleNode *) node)->texture);
+      KEY (1, ((GskTextureScaleNode *) node)->filter);
+      return 2;
+
+    case GSK_INSET_SHADOW_NODE:
+      {
+        GskInsetShadowNode *self = (GskInsetShadowNode *) node;
+
+        KEY (0, self->outline);
+        KEY (1, self->color);
+        key[2].data = &self->dx;
+        key[2].size = 4 * sizeof (float);
+        return 3;
+      }
+
+    case GSK_OUTSET_SHADOW_NODE:
+      {
+        GskOutsetShadowNode *self = (GskOutsetShadowNode *) node;
+
+        KEY (0, self->outline);
+        KEY (1, self->color);
+        key[2].data = &self->dx;
+        key[2].size = 4 * sizeof (float);
+        return 3;
+      }
+
+    case GSK_CONTAINER_NODE:
+      {
+        GskContainerNode *self = (GskContainerNode *) node;
+
+        key[0].data = self->children;
+        key[0].size = self->n_children * sizeof (GskRenderNode *);
+        return 1;
+      }
+
+    case GSK_TRANSFORM_NODE:
+      {
+        GskTransformNode *self = (GskTransformNode *) node;
+
+        /* only translations are fully described by dx/dy */
+        if (gsk_transform_get_category (self->transform) != GSK_TRANSFORM_CATEGORY_2D_TRANSLATE)
+          return 0;
+
+        KEY (0, self->child);
+        KEY (1, self->dx);
+        KEY (2, self->dy);
+        return 3;
+      }
+
+    case GSK_OPACITY_NODE:
+      KEY (0, ((GskOpacityNode *) node)->child);
+      KEY (1, ((GskOpacityNode *) node)->opacity);
+      return 2;
+
+    case GSK_CLIP_NODE:
+      KEY (0, ((GskClipNode *) node)->child);
+      KEY (1, ((GskClipNode *) node)->clip);
+      return 2;
+
+    case GSK_ROUNDED_CLIP_NODE:
+      KEY (0, ((GskRoundedClipNode *) node)->child);
+      KEY (1, ((GskRoundedClipNode *) node)->clip);
+      return 2;
+
+    case GSK_NOT_A_RENDER_NODE:
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+    case GSK_CONIC_GRADIENT_NODE:
+    case GSK_COLOR_MATRIX_NODE:
+    case GSK_REPEAT_NODE:
+    case GSK_SHADOW_NODE:
+    case GSK_BLEND_NODE:
+    case GSK_CROSS_FADE_NODE:
+    case GSK_TEXT_NODE:
+    case GSK_BLUR_NODE:
+    case GSK_DEBUG_NODE:
+    case GSK_MASK_NODE:
+    case GSK_CAIRO_NODE:
+    case GSK_GL_SHADER_NODE:
+    case GSK_FILL_NODE:
+    case GSK_STROKE_NODE:
+    case GSK_SUBSURFACE_NODE:
+    default:
+      return 0;
+    }
+
+#undef KEY
+}
+
+static guint
+gsk_intern_hash_data (guint         hash,
+                      gconstpointer data,
+                      gsize         size)
+{
+  const guchar *bytes = data;
+  gsize i;
+
+  /* FNV-1a */
+  for (i = 0; i < size; i++)
+    hash = (hash ^ bytes[i]) * 16777619u;
+
+  return hash;
+}
+
+static guint
+gsk_render_node_intern_hash (gconstpointer data)
+{
+  const GskRenderNode *node = data;
+  GskInternKey key[GSK_INTERN_KEY_MAX];
+  guint i, n_keys, hash;
+
+  n_keys = gsk_render_node_get_intern_key (node, key);
+
+  hash = gsk_intern_hash_data (2166136261u ^ GSK_RENDER_NODE_TYPE (node), &node->bounds, sizeof (graphene_rect_t));
+  for (i = 0; i < n_keys; i++)
+    hash = gsk_intern_hash_data (hash, key[i].data, key[i].size);
+
+  return hash;
+}
+
+static gboolean
+gsk_render_node_intern_equal (gconstpointer data1,
+                              gconstpointer data2)
+{
+  const GskRenderNode *node1 = data1;
+  const GskRenderNode *node2 = data2;
+  GskInternKey key1[GSK_INTERN_KEY_MAX], key2[GSK_INTERN_KEY_MAX];
+  guint i, n_keys;
+
+  if (GSK_RENDER_NODE_TYPE (node1) != GSK_RENDER_NODE_TYPE (node2) ||
+      memcmp (&node1->bounds, &node2->bounds, sizeof (graphene_rect_t)) != 0)
+    return FALSE;
+
+  n_keys = gsk_render_node_get_intern_key (node1, key1);
+  if (n_keys != gsk_render_node_get_intern_key (node2, key2))
+    return FALSE;
+
+  for (i = 0; i < n_keys; i++)
+    {
+      if (key1[i].size != key2[i].size ||
+          memcmp (key1[i].data, key2[i].data, key1[i].size) != 0)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/*< private >
+ * gsk_render_node_intern:
+ * @node: (transfer full): a `GskRenderNode`
+ *
+ * Looks for an existing node that is structurally identical to @node
+ * and returns it instead of @node. If there is none, @node is added
+ * to the set of known nodes.
+ *
+ * Using this for all nodes of a tree makes identical subtrees share
+ * nodes, which is cheaper to diff and cache in renderers.
+ *
+ * Node types that can't be compared cheaply are returned unchanged.
+ *
+ * Returns: (transfer full): @node or an identical node
+ */
+GskRenderNode *
+gsk_render_node_intern (GskRenderNode *node)
+{
+  GskInternKey key[GSK_INTERN_KEY_MAX];
+  GskRenderNode *result;
+
+  if (node->interned ||
+      GSK_DEBUG_CHECK (INTERN_DISABLE) ||
+      gsk_render_node_get_intern_key (node, key) == 0)
+    return node;
+
+  G_LOCK (interned_nodes);
+
+  if (interned_nodes == NULL)
+    interned_nodes = g_hash_table_new (gsk_render_node_intern_hash, gsk_render_node_intern_equal);
+
+  result = g_hash_table_lookup (interned_nodes, node);
+  if (result)
+    {
+      gsk_render_node_ref (result);
+    }
+  else
+    {
+      node->interned = TRUE;
+      g_hash_table_add (interned_nodes, node);
+    }
+
+  G_UNLOCK (interned_nodes);
+
+  if (result == NULL)
+    return node;
+
+  gsk_render_node_unref (node);
+
+  return result;
+}
+
+/*< private >
+ * gsk_render_node_unref_interned:
+ * @node: (transfer full): an interned `GskRenderNode`
+ *
+ * Drops a reference of an interned node. This takes the lock, so
+ * that the node can't be found while it gets removed.
+ */
+void
+gsk_render_node_unref_interned (GskRenderNode *node)
+{
+  gboolean last_ref;
+
+  G_LOCK (interned_nodes);
+
+  last_ref = g_atomic_ref_count_dec (&node->ref_count);
+  if (last_ref)
+    g_hash_table_remove (interned_nodes, node);
+
+  G_UNLOCK (interned_nodes);
+
+  if (last_ref)
+    GSK_RENDER_NODE_GET_CLASS (node)->finalize (node);
+}
+
 /* }}} */
 
 GType gsk_render_node_types[GSK_RENDER_NODE_TYPE_N_TYPES];
@@ -62,6 +62,7 @@ struct _Context
 {
   GHashTable *named_nodes;
   GHashTable *named_textures;
+  GHashTable *data_textures;
   PangoFontMap *fontmap;
 };
 
@@ -86,9 +87,117 @@ context_finish (Context *context)
 {
   g_clear_pointer (&context->named_nodes, g_hash_table_unref);
   g_clear_pointer (&context->named_textures, g_hash_table_unref);
+  g_clear_pointer (&context->data_textures, g_hash_table_unref);
   g_clear_object (&context->fontmap);
 }
 
+typedef struct
+{
+  char *url;
+  GdkTexture *texture;
+} DecodeJob;
+
+static void
+decode_data_url (gpointer data,
+                 gpointer user_data)
+{
+  DecodeJob *job = data;
+  GBytes *bytes;
+
+  bytes = gtk_css_data_url_parse (job->url, NULL, NULL);
+  if (bytes == NULL)
+    return;
+
+  job->texture = gdk_texture_new_from_bytes (bytes, NULL);
+  g_bytes_unref (bytes);
+}
+
+#define DATA_URL_PREFIX "url(\"data:image/"
+
+/* Decoding embedded images dominates parsing node files that contain
+ * them, so find the data urls up front and decode them in parallel.
+ * The results are put into the data_textures cache that parse_texture()
+ * consults. Anything that fails to decode here, or that is not found
+ * by the simple scan, is decoded again while parsing, which also takes
+ * care of reporting errors.
+ */
+static void
+context_decode_data_urls (Context *context,
+                          GBytes  *bytes)
+{
+  const char *data, *end, *p;
+  GPtrArray *jobs;
+  GHashTable *seen;
+  gsize size;
+  guint i;
+
+  data = g_bytes_get_data (bytes, &size);
+  end = data + size;
+  jobs = g_ptr_array_new ();
+  seen = g_hash_table_new (g_str_hash, g_str_equal);
+
+  for (p = data;
+       (p = g_strstr_len (p, end - p, DATA_URL_PREFIX)) != NULL;)
+    {
+      const char *url, *url_end;
+      DecodeJob *job;
+
+      url = p + strlen ("url(\"");
+      url_end = memchr (url, '"', end - url);
+      if (url_end == NULL)
+        break;
+      p = url_end;
+
+      /* Escapes would make the string differ from the parsed url */
+      if (memchr (url, '\\', url_end - url) ||
+          memchr (url, '\n', url_end - url))
+        continue;
+
+      job = g_new0 (DecodeJob, 1);
+      job->url = g_strndup (url, url_end - url);
+      if (!g_hash_table_add (seen, job->url))
+        {
+          g_free (job->url);
+          g_free (job);
+          continue;
+        }
+
+      g_ptr_array_add (jobs, job);
+    }
+
+  if (jobs->len > 1)
+    {
+      GThreadPool *pool;
+
+      pool = g_thread_pool_new (decode_data_url, NULL,
+                                MIN (jobs->len, g_get_num_processors ()),
+                                FALSE, NULL);
+      for (i = 0; i < jobs->len; i++)
+        g_thread_pool_push (pool, g_ptr_array_index (jobs, i), NULL);
+      g_thread_pool_free (pool, FALSE, TRUE);
+    }
+
+  for (i = 0; i < jobs->len; i++)
+    {
+      DecodeJob *job = g_ptr_array_index (jobs, i);
+
+      if (job->texture)
+        {
+          if (context->data_textures == NULL)
+            context->data_textures = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                            g_free, g_object_unref);
+          g_hash_table_insert (context->data_textures, job->url, job->texture);
+        }
+      else
+        g_free (job->url);
+
+      g_free (job);
+    }
+
+  g_hash_table_unref (seen);
+  g_ptr_array_unref (jobs);
+}
+
 static gboolean
 parse_enum (GtkCssParser *parser,
             GType         type,
@@ -211,15 +320,32 @@ parse_texture (GtkCssParser *parser,
     {
       GBytes *bytes;
 
-      bytes = gtk_css_data_url_parse (url, NULL, &error);
-      if (bytes)
+      if (context->data_textures)
+        texture = g_hash_table_lookup (context->data_textures, url);
+      else
+        texture = NULL;
+
+      if (texture)
         {
-          texture = gdk_texture_new_from_bytes (bytes, &error);
-          g_bytes_unref (bytes);
+          g_object_ref (texture);
         }
       else
         {
-          texture = NULL;
+          bytes = gtk_css_data_url_parse (url, NULL, &error);
+          if (bytes)
+            {
+              texture = gdk_texture_new_from_bytes (bytes, &error);
+              g_bytes_unref (bytes);
+            }
+
+          /* The same image is often embedded many times */
+          if (texture)
+            {
+              if (context->data_textures == NULL)
+                context->data_textures = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                                g_free, g_object_unref);
+              g_hash_table_insert (context->data_textures, g_strdup (url), g_object_ref (texture));
+            }
         }
     }
   else
@@ -2897,6 +3023,7 @@ gsk_render_node_deserialize_from_bytes (GBytes            *bytes,
   parser = gtk_css_parser_new_for_bytes (bytes, NULL, gsk_render_node_parser_error,
                                          &error_func_pair, NULL);
   context_init (&context);
+  context_decode_data_urls (&context, bytes);
 
   root = parse_container_node (parser, &context);
 
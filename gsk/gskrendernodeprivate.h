@@ -4,6 +4,7 @@
 #include <cairo.h>
 
 #include "gdk/gdkmemoryformatprivate.h"
+#include "gskroundedrectprivate.h"
 
 G_BEGIN_DECLS
 
@@ -34,6 +35,7 @@ struct _GskRenderNode
 
   guint preferred_depth : 2;
   guint offscreen_for_opacity : 1;
+  guint interned : 1;
 };
 
 typedef struct
@@ -66,6 +68,9 @@ GType           gsk_render_node_type_register_static    (const char
 
 gpointer        gsk_render_node_alloc                   (GskRenderNodeType            node_type);
 
+GskRenderNode * gsk_render_node_intern                  (GskRenderNode               *node);
+void            gsk_render_node_unref_interned          (GskRenderNode               *node);
+
 void            _gsk_render_node_unref                  (GskRenderNode               *node);
 
 gboolean        gsk_render_node_can_diff                (const GskRenderNode         *node1,
@@ -85,6 +90,8 @@ void            gsk_render_node_draw_fallback           (GskRenderNode
 bool            gsk_border_node_get_uniform             (const GskRenderNode         *self) G_GNUC_PURE;
 bool            gsk_border_node_get_uniform_color       (const GskRenderNode         *self) G_GNUC_PURE;
 
+GskRoundedRectShape gsk_rounded_clip_node_get_shape     (const GskRenderNode         *self) G_GNUC_PURE;
+
 void            gsk_text_node_serialize_glyphs          (GskRenderNode               *self,
                                                          GString                     *str);
 
@@ -97,6 +104,13 @@ void            gsk_transform_node_get_translate        (const GskRenderNode
 GdkMemoryDepth  gsk_render_node_get_preferred_depth     (const GskRenderNode         *node) G_GNUC_PURE;
 
 gboolean        gsk_container_node_is_disjoint          (const GskRenderNode         *node) G_GNUC_PURE;
+typedef void (* GskRenderNodeForeachFunc) (GskRenderNode *node,
+                                           gpointer       user_data);
+
+void            gsk_container_node_foreach_in_rect      (const GskRenderNode         *node,
+                                                         const graphene_rect_t       *rect,
+                                                         GskRenderNodeForeachFunc     func,
+                                                         gpointer                     user_data);
 
 gboolean        gsk_render_node_use_offscreen_for_opacity (const GskRenderNode       *node) G_GNUC_PURE;
 
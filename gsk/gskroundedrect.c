@@ -369,6 +369,42 @@ gsk_rounded_rect_is_rectilinear (const GskRoundedRect *self)
   return TRUE;
 }
 
+/*< private >
+ * gsk_rounded_rect_get_shape:
+ * @self: the `GskRoundedRect` to classify
+ *
+ * Classifies the corners of @self in a single pass, so callers that
+ * need to pick between several ways of drawing a rounded rectangle
+ * only need to look at the corners once.
+ *
+ * A rectilinear rectangle is also circular and uniform.
+ *
+ * Returns: the shape of @self
+ */
+GskRoundedRectShape
+gsk_rounded_rect_get_shape (const GskRoundedRect *self)
+{
+  GskRoundedRectShape shape = GSK_ROUNDED_RECT_SHAPE_RECTILINEAR |
+                              GSK_ROUNDED_RECT_SHAPE_CIRCULAR |
+                              GSK_ROUNDED_RECT_SHAPE_UNIFORM;
+
+  for (guint i = 0; i < 4; i++)
+    {
+      if (self->corner[i].width > 0 ||
+          self->corner[i].height > 0)
+        shape &= ~GSK_ROUNDED_RECT_SHAPE_RECTILINEAR;
+
+      if (self->corner[i].width != self->corner[i].height)
+        shape &= ~GSK_ROUNDED_RECT_SHAPE_CIRCULAR;
+
+      if (self->corner[i].width != self->corner[0].width ||
+          self->corner[i].height != self->corner[0].height)
+        shape &= ~GSK_ROUNDED_RECT_SHAPE_UNIFORM;
+    }
+
+  return shape;
+}
+
 static inline gboolean
 ellipsis_contains_point (const graphene_size_t  *ellipsis,
                          const graphene_point_t *point)
@@ -869,6 +905,13 @@ _cairo_ellipsis (cairo_t *cr,
       return;
     }
 
+  /* No need to change the matrix for circles */
+  if (xradius == yradius)
+    {
+      cairo_arc (cr, xc, yc, xradius, angle1, angle2);
+      return;
+    }
+
   cairo_get_matrix (cr, &save);
   cairo_translate (cr, xc, yc);
   cairo_scale (cr, xradius, yradius);
@@ -880,6 +923,14 @@ void
 gsk_rounded_rect_path (const GskRoundedRect *self,
                        cairo_t              *cr)
 {
+  if (gsk_rounded_rect_is_rectilinear (self))
+    {
+      cairo_rectangle (cr,
+                       self->bounds.origin.x, self->bounds.origin.y,
+                       self->bounds.size.width, self->bounds.size.height);
+      return;
+    }
+
   cairo_new_sub_path (cr);
 
   _cairo_ellipsis (cr,
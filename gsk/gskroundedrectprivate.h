@@ -43,6 +43,14 @@ void                     gsk_rounded_rect_scale_affine          (GskRoundedRect
 
 gboolean                 gsk_rounded_rect_is_circular           (const GskRoundedRect     *self) G_GNUC_PURE;
 
+typedef enum {
+  GSK_ROUNDED_RECT_SHAPE_RECTILINEAR = 1 << 0,
+  GSK_ROUNDED_RECT_SHAPE_CIRCULAR    = 1 << 1,
+  GSK_ROUNDED_RECT_SHAPE_UNIFORM     = 1 << 2,
+} GskRoundedRectShape;
+
+GskRoundedRectShape      gsk_rounded_rect_get_shape             (const GskRoundedRect     *self) G_GNUC_PURE;
+
 void                     gsk_rounded_rect_path                  (const GskRoundedRect     *self,
                                                                  cairo_t                  *cr);
 void                     gsk_rounded_rect_to_float              (const GskRoundedRect     *self,
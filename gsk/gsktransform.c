@@ -126,6 +126,7 @@ gsk_transform_finalize (GskTransform *self)
 {
   self->transform_class->finalize (self);
 
+  g_clear_pointer (&self->matrix, graphene_matrix_free);
   gsk_transform_unref (self->next);
 }
 
@@ -1629,6 +1630,36 @@ gsk_transform_to_string (GskTransform *self)
   return g_string_free (string, FALSE);
 }
 
+static void
+gsk_transform_compute_matrix (GskTransform      *self,
+                              graphene_matrix_t *out_matrix)
+{
+  graphene_matrix_t m;
+
+  /* 2D chains are cheaper to combine with floats than with matrices */
+  if (self->category >= GSK_TRANSFORM_CATEGORY_2D_AFFINE)
+    {
+      float scale_x, scale_y, dx, dy;
+
+      gsk_transform_to_affine (self, &scale_x, &scale_y, &dx, &dy);
+      graphene_matrix_init_scale (out_matrix, scale_x, scale_y, 1);
+      graphene_matrix_translate (out_matrix, &GRAPHENE_POINT3D_INIT (dx, dy, 0));
+    }
+  else if (self->category >= GSK_TRANSFORM_CATEGORY_2D)
+    {
+      float xx, yx, xy, yy, dx, dy;
+
+      gsk_transform_to_2d (self, &xx, &yx, &xy, &yy, &dx, &dy);
+      graphene_matrix_init_from_2d (out_matrix, xx, yx, xy, yy, dx, dy);
+    }
+  else
+    {
+      gsk_transform_to_matrix (self->next, out_matrix);
+      self->transform_class->to_matrix (self, &m);
+      graphene_matrix_multiply (&m, out_matrix, out_matrix);
+    }
+}
+
 /**
  * gsk_transform_to_matrix:
  * @self: (nullable): a `GskTransform`
@@ -1642,17 +1673,26 @@ void
 gsk_transform_to_matrix (GskTransform      *self,
                          graphene_matrix_t *out_matrix)
 {
-  graphene_matrix_t m;
-
   if (self == NULL)
     {
       graphene_matrix_init_identity (out_matrix);
       return;
     }
 
-  gsk_transform_to_matrix (self->next, out_matrix);
-  self->transform_class->to_matrix (self, &m);
-  graphene_matrix_multiply (&m, out_matrix, out_matrix);
+  /* Transforms are immutable, so keep the result around. Converting
+   * a chain again, like the modelview of a renderer, is then free,
+   * and so is converting a longer chain built on top of it.
+   */
+  if (g_once_init_enter (&self->matrix))
+    {
+      graphene_matrix_t *matrix = graphene_matrix_alloc ();
+
+      gsk_transform_compute_matrix (self, matrix);
+
+      g_once_init_leave (&self->matrix, matrix);
+    }
+
+  graphene_matrix_init_from_matrix (out_matrix, self->matrix);
 }
 
 /**
@@ -1692,6 +1732,8 @@ gsk_transform_to_2d (GskTransform *self,
                      float        *out_dx,
                      float        *out_dy)
 {
+  graphene_matrix_t *matrix;
+
   *out_xx = 1.0f;
   *out_yx = 0.0f;
   *out_xy = 0.0f;
@@ -1710,6 +1752,16 @@ gsk_transform_to_2d (GskTransform *self,
       return;
     }
 
+  matrix = g_atomic_pointer_get (&self->matrix);
+  if (matrix != NULL)
+    {
+      graphene_matrix_to_2d (matrix,
+                             out_xx, out_yx,
+                             out_xy, out_yy,
+                             out_dx, out_dy);
+      return;
+    }
+
   gsk_transform_to_2d (self->next,
                        out_xx, out_yx,
                        out_xy, out_yy,
@@ -1845,6 +1897,8 @@ gsk_transform_to_affine (GskTransform *self,
                          float        *out_dx,
                          float        *out_dy)
 {
+  graphene_matrix_t *matrix;
+
   *out_scale_x = 1.0f;
   *out_scale_y = 1.0f;
   *out_dx = 0.0f;
@@ -1861,6 +1915,16 @@ gsk_transform_to_affine (GskTransform *self,
       return;
     }
 
+  matrix = g_atomic_pointer_get (&self->matrix);
+  if (matrix != NULL)
+    {
+      *out_scale_x = graphene_matrix_get_value (matrix, 0, 0);
+      *out_scale_y = graphene_matrix_get_value (matrix, 1, 1);
+      *out_dx = graphene_matrix_get_value (matrix, 3, 0);
+      *out_dy = graphene_matrix_get_value (matrix, 3, 1);
+      return;
+    }
+
   gsk_transform_to_affine (self->next,
                            out_scale_x, out_scale_y,
                            out_dx, out_dy);
@@ -1892,6 +1956,8 @@ gsk_transform_to_translate (GskTransform *self,
                             float        *out_dx,
                             float        *out_dy)
 {
+  graphene_matrix_t *matrix;
+
   *out_dx = 0.0f;
   *out_dy = 0.0f;
 
@@ -1907,6 +1973,14 @@ gsk_transform_to_translate (GskTransform *self,
       return;
     }
 
+  matrix = g_atomic_pointer_get (&self->matrix);
+  if (matrix != NULL)
+    {
+      *out_dx = graphene_matrix_get_value (matrix, 3, 0);
+      *out_dy = graphene_matrix_get_value (matrix, 3, 1);
+      return;
+    }
+
   gsk_transform_to_translate (self->next, out_dx, out_dy);
 
   self->transform_class->apply_translate (self, out_dx, out_dy);
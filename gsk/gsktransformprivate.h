@@ -35,6 +35,9 @@ struct _GskTransform
 
   GskTransformCategory category;
   GskTransform *next;
+
+  /* computed on demand by gsk_transform_to_matrix() */
+  graphene_matrix_t *matrix;
 };
 
 gboolean                gsk_transform_parser_parse              (GtkCssParser           *parser,
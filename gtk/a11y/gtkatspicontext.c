@@ -113,10 +113,41 @@ struct _GtkAtSpiContext
 
   guint registration_ids[20];
   guint n_registered_objects;
+
+  /* The PendingChange flags that still need to be emitted, and
+   * our link in the pending_contexts queue while they are non-zero
+   */
+  guint pending_changes;
+  GList pending_link;
 };
 
 G_DEFINE_TYPE (GtkAtSpiContext, gtk_at_spi_context, GTK_TYPE_AT_CONTEXT)
 
+/* Changes for which ATs only care about the latest value. Instead of
+ * emitting a signal for every intermediate update, e.g. the bounds of
+ * every row while a list is scrolled, they are collected and emitted
+ * once per context when the main loop is idle again.
+ */
+typedef enum {
+  PENDING_BOUNDS      = 1 << 0,
+  PENDING_NAME        = 1 << 1,
+  PENDING_DESCRIPTION = 1 << 2,
+  PENDING_VALUE       = 1 << 3,
+} PendingChange;
+
+static GQueue pending_contexts = G_QUEUE_INIT;
+static guint pending_flush_id;
+
+/* While no AT has registered an event listener, there is nobody to
+ * receive change notifications, so we don't even compute them
+ */
+static gboolean
+has_event_listeners (GtkAtSpiContext *self)
+{
+  return self->connection != NULL &&
+         gtk_at_spi_root_has_event_listeners (self->root);
+}
+
 /* {{{ State handling */
 static void
 set_atspi_state (guint64        *states,
@@ -936,6 +967,94 @@ emit_window_event (GtkAtSpiContext *self,
                                  NULL);
 }
 
+static void
+flush_pending_changes (GtkAtSpiContext *self)
+{
+  GtkATContext *ctx = GTK_AT_CONTEXT (self);
+  guint changes = self->pending_changes;
+
+  self->pending_changes = 0;
+
+  if (changes & PENDING_NAME)
+    {
+      char *label = gtk_at_context_get_name (ctx);
+      GVariant *v = g_variant_new_take_string (label);
+      emit_property_changed (self, "accessible-name", v);
+    }
+
+  if (changes & PENDING_DESCRIPTION)
+    {
+      char *label = gtk_at_context_get_description (ctx);
+      GVariant *v = g_variant_new_take_string (label);
+      emit_property_changed (self, "accessible-description", v);
+    }
+
+  if ((changes & PENDING_VALUE) &&
+      gtk_at_context_has_accessible_property (ctx, GTK_ACCESSIBLE_PROPERTY_VALUE_NOW))
+    {
+      GtkAccessibleValue *value;
+
+      value = gtk_at_context_get_accessible_property (ctx, GTK_ACCESSIBLE_PROPERTY_VALUE_NOW);
+      emit_property_changed (self,
+                             "accessible-value",
+                             g_variant_new_double (gtk_number_accessible_value_get (value)));
+    }
+
+  if (changes & PENDING_BOUNDS)
+    {
+      GtkAccessible *accessible = gtk_at_context_get_accessible (ctx);
+      int x, y, width, height;
+
+      if (gtk_accessible_get_bounds (accessible, &x, &y, &width, &height))
+        emit_bounds_changed (self, x, y, width, height);
+    }
+}
+
+static gboolean
+flush_pending_contexts (gpointer data)
+{
+  GList *link;
+
+  pending_flush_id = 0;
+
+  while ((link = g_queue_pop_head_link (&pending_contexts)) != NULL)
+    flush_pending_changes (link->data);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+queue_pending_change (GtkAtSpiContext *self,
+                      PendingChange    change)
+{
+  if (!has_event_listeners (self))
+    return;
+
+  if (self->pending_changes == 0)
+    {
+      self->pending_link.data = self;
+      g_queue_push_tail_link (&pending_contexts, &self->pending_link);
+    }
+
+  self->pending_changes |= change;
+
+  if (pending_flush_id == 0)
+    {
+      pending_flush_id = g_idle_add (flush_pending_contexts, NULL);
+      gdk_source_set_static_name_by_id (pending_flush_id, "[gtk] AT-SPI pending changes");
+    }
+}
+
+static void
+drop_pending_changes (GtkAtSpiContext *self)
+{
+  if (self->pending_changes == 0)
+    return;
+
+  g_queue_unlink (&pending_contexts, &self->pending_link);
+  self->pending_changes = 0;
+}
+
 static void
 gtk_at_spi_context_state_change (GtkATContext                *ctx,
                                  GtkAccessibleStateChange     changed_states,
@@ -949,6 +1068,9 @@ gtk_at_spi_context_state_change (GtkATContext                *ctx,
   GtkAccessible *accessible = gtk_at_context_get_accessible (ctx);
   GtkAccessibleValue *value;
 
+  if (!has_event_listeners (self))
+    return;
+
   if (GTK_IS_WIDGET (accessible) && !gtk_widget_get_realized (GTK_WIDGET (accessible)))
     return;
 
@@ -1147,26 +1269,13 @@ gtk_at_spi_context_state_change (GtkATContext                *ctx,
     }
 
   if (changed_properties & GTK_ACCESSIBLE_PROPERTY_CHANGE_LABEL)
-    {
-      char *label = gtk_at_context_get_name (GTK_AT_CONTEXT (self));
-      GVariant *v = g_variant_new_take_string (label);
-      emit_property_changed (self, "accessible-name", v);
-    }
+    queue_pending_change (self, PENDING_NAME);
 
   if (changed_properties & GTK_ACCESSIBLE_PROPERTY_CHANGE_DESCRIPTION)
-  {
-      char *label = gtk_at_context_get_description (GTK_AT_CONTEXT (self));
-      GVariant *v = g_variant_new_take_string (label);
-      emit_property_changed (self, "accessible-description", v);
-    }
+    queue_pending_change (self, PENDING_DESCRIPTION);
 
   if (changed_properties & GTK_ACCESSIBLE_PROPERTY_CHANGE_VALUE_NOW)
-    {
-      value = gtk_accessible_attribute_set_get_value (properties, GTK_ACCESSIBLE_PROPERTY_VALUE_NOW);
-      emit_property_changed (self,
-                             "accessible-value",
-                             g_variant_new_double (gtk_number_accessible_value_get (value)));
-    }
+    queue_pending_change (self, PENDING_VALUE);
 }
 
 static void
@@ -1177,6 +1286,9 @@ gtk_at_spi_context_platform_change (GtkATContext                *ctx,
   GtkAccessible *accessible = gtk_at_context_get_accessible (ctx);
   GtkWidget *widget;
 
+  if (!has_event_listeners (self))
+    return;
+
   if (!GTK_IS_WIDGET (accessible))
     return;
 
@@ -1222,10 +1334,8 @@ static void
 gtk_at_spi_context_bounds_change (GtkATContext *ctx)
 {
   GtkAtSpiContext *self = GTK_AT_SPI_CONTEXT (ctx);
-  GtkAccessible *accessible = gtk_at_context_get_accessible (ctx);
-  int x, y, width, height;
-  if (gtk_accessible_get_bounds (accessible, &x, &y, &width, &height))
-    emit_bounds_changed (self, x, y, width, height);
+
+  queue_pending_change (self, PENDING_BOUNDS);
 }
 
 static void
@@ -1235,8 +1345,12 @@ gtk_at_spi_context_child_change (GtkATContext             *ctx,
 {
   GtkAtSpiContext *self = GTK_AT_SPI_CONTEXT (ctx);
   GtkAccessible *accessible = gtk_at_context_get_accessible (ctx);
-  GtkATContext *child_context = gtk_accessible_get_at_context (child);
+  GtkATContext *child_context;
+
+  if (!has_event_listeners (self))
+    return;
 
+  child_context = gtk_accessible_get_at_context (child);
   if (child_context == NULL)
     return;
 
@@ -1422,6 +1536,7 @@ gtk_at_spi_context_finalize (GObject *gobject)
 {
   GtkAtSpiContext *self = GTK_AT_SPI_CONTEXT (gobject);
 
+  drop_pending_changes (self);
   gtk_at_spi_context_unregister_object (self);
 
   g_clear_object (&self->root);
@@ -1521,6 +1636,7 @@ gtk_at_spi_context_unrealize (GtkATContext *context)
                    G_OBJECT_TYPE_NAME (accessible));
 
   /* Notify ATs that the accessible object is going away */
+  drop_pending_changes (self);
   emit_defunct (self);
   gtk_at_spi_root_unregister (self->root, self);
 
@@ -1540,7 +1656,7 @@ gtk_at_spi_context_announce (GtkATContext                      *context,
   GtkAtSpiContext *self = GTK_AT_SPI_CONTEXT (context);
   AtspiLive live;
 
-  if (self->connection == NULL)
+  if (!has_event_listeners (self))
     return;
 
   switch (priority)
@@ -1576,7 +1692,7 @@ gtk_at_spi_context_update_caret_position (GtkATContext *context)
   GtkAccessibleText *accessible_text = GTK_ACCESSIBLE_TEXT (accessible);
   guint offset;
 
-  if (self->connection == NULL)
+  if (!has_event_listeners (self))
     return;
 
   offset = gtk_accessible_text_get_caret_position (accessible_text);
@@ -1600,7 +1716,7 @@ gtk_at_spi_context_update_selection_bound (GtkATContext *context)
 {
   GtkAtSpiContext *self = GTK_AT_SPI_CONTEXT (context);
 
-  if (self->connection == NULL)
+  if (!has_event_listeners (self))
     return;
 
   g_dbus_connection_emit_signal (self->connection,
@@ -1625,7 +1741,7 @@ gtk_at_spi_context_update_text_contents (GtkATContext *context,
 {
   GtkAtSpiContext *self = GTK_AT_SPI_CONTEXT (context);
 
-  if (self->connection == NULL)
+  if (!has_event_listeners (self))
     return;
 
   GtkAccessible *accessible = gtk_at_context_get_accessible (context);
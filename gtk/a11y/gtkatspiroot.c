@@ -45,6 +45,7 @@
 #define ATSPI_PATH_PREFIX       "/org/a11y/atspi"
 #define ATSPI_ROOT_PATH         ATSPI_PATH_PREFIX "/accessible/root"
 #define ATSPI_CACHE_PATH        ATSPI_PATH_PREFIX "/cache"
+#define ATSPI_REGISTRY_PATH     ATSPI_PATH_PREFIX "/registry"
 
 struct _GtkAtSpiRoot
 {
@@ -71,6 +72,13 @@ struct _GtkAtSpiRoot
   GtkAtSpiCache *cache;
 
   GListModel *toplevels;
+
+  /* The number of event listeners registered with the AT-SPI registry,
+   * or -1 if we don't know yet
+   */
+  int n_event_listeners;
+  guint listener_registered_id;
+  guint listener_deregistered_id;
 };
 
 enum
@@ -104,6 +112,16 @@ gtk_at_spi_root_dispose (GObject *gobject)
 {
   GtkAtSpiRoot *self = GTK_AT_SPI_ROOT (gobject);
 
+  if (self->connection != NULL)
+    {
+      if (self->listener_registered_id != 0)
+        g_dbus_connection_signal_unsubscribe (self->connection, self->listener_registered_id);
+      if (self->listener_deregistered_id != 0)
+        g_dbus_connection_signal_unsubscribe (self->connection, self->listener_deregistered_id);
+      self->listener_registered_id = 0;
+      self->listener_deregistered_id = 0;
+    }
+
   g_clear_object (&self->cache);
   g_clear_object (&self->connection);
   g_clear_pointer (&self->queued_contexts, g_list_free);
@@ -541,6 +559,101 @@ on_registration_reply (GObject      *gobject,
   g_free (data);
 }
 
+static void
+on_event_listener_registered (GDBusConnection *connection,
+                              const char      *sender_name,
+                              const char      *object_path,
+                              const char      *interface_name,
+                              const char      *signal_name,
+                              GVariant        *parameters,
+                              gpointer         user_data)
+{
+  GtkAtSpiRoot *self = user_data;
+
+  if (self->n_event_listeners < 0)
+    return;
+
+  if (g_strcmp0 (signal_name, "EventListenerRegistered") == 0)
+    self->n_event_listeners += 1;
+  else if (self->n_event_listeners > 0)
+    self->n_event_listeners -= 1;
+
+  GTK_DEBUG (A11Y, "%s: %d event listeners registered",
+                   signal_name,
+                   self->n_event_listeners);
+}
+
+static void
+on_registered_events_reply (GObject      *gobject,
+                            GAsyncResult *result,
+                            gpointer      user_data)
+{
+  GtkAtSpiRoot *self = user_data;
+  GError *error = NULL;
+  GVariant *reply = g_dbus_connection_call_finish (G_DBUS_CONNECTION (gobject), result, &error);
+
+  if (error != NULL)
+    {
+      /* Older registries don't tell us; keep emitting everything */
+      GTK_DEBUG (A11Y, "Unable to query the registered events: %s", error->message);
+      g_error_free (error);
+      g_object_unref (self);
+      return;
+    }
+
+  GVariant *events = g_variant_get_child_value (reply, 0);
+
+  self->n_event_listeners = g_variant_n_children (events);
+
+  GTK_DEBUG (A11Y, "%d event listeners registered", self->n_event_listeners);
+
+  g_variant_unref (events);
+  g_variant_unref (reply);
+  g_object_unref (self);
+}
+
+/* Track whether any AT listens for events at all, so that contexts can
+ * skip computing and emitting change notifications while nobody does
+ */
+static void
+root_watch_event_listeners (GtkAtSpiRoot *self)
+{
+  self->listener_registered_id =
+    g_dbus_connection_signal_subscribe (self->connection,
+                                        "org.a11y.atspi.Registry",
+                                        "org.a11y.atspi.Registry",
+                                        "EventListenerRegistered",
+                                        ATSPI_REGISTRY_PATH,
+                                        NULL,
+                                        G_DBUS_SIGNAL_FLAGS_NONE,
+                                        on_event_listener_registered,
+                                        self,
+                                        NULL);
+  self->listener_deregistered_id =
+    g_dbus_connection_signal_subscribe (self->connection,
+                                        "org.a11y.atspi.Registry",
+                                        "org.a11y.atspi.Registry",
+                                        "EventListenerDeregistered",
+                                        ATSPI_REGISTRY_PATH,
+                                        NULL,
+                                        G_DBUS_SIGNAL_FLAGS_NONE,
+                                        on_event_listener_registered,
+                                        self,
+                                        NULL);
+
+  g_dbus_connection_call (self->connection,
+                          "org.a11y.atspi.Registry",
+                          ATSPI_REGISTRY_PATH,
+                          "org.a11y.atspi.Registry",
+                          "GetRegisteredEvents",
+                          NULL,
+                          G_VARIANT_TYPE ("(a(ss))"),
+                          G_DBUS_CALL_FLAGS_NONE, -1,
+                          NULL,
+                          on_registered_events_reply,
+                          g_object_ref (self));
+}
+
 static gboolean
 root_register (gpointer user_data)
 {
@@ -591,6 +704,8 @@ root_register (gpointer user_data)
                    unique_name,
                    self->root_path);
 
+  root_watch_event_listeners (self);
+
   g_dbus_connection_call (self->connection,
                           "org.a11y.atspi.Registry",
                           ATSPI_ROOT_PATH,
@@ -765,6 +880,7 @@ gtk_at_spi_root_class_init (GtkAtSpiRootClass *klass)
 static void
 gtk_at_spi_root_init (GtkAtSpiRoot *self)
 {
+  self->n_event_listeners = -1;
 }
 
 GtkAtSpiRoot *
@@ -811,6 +927,25 @@ gtk_at_spi_root_to_ref (GtkAtSpiRoot *self)
                         self->root_path);
 }
 
+/*< private >
+ * gtk_at_spi_root_has_event_listeners:
+ * @self: a `GtkAtSpiRoot`
+ *
+ * Checks whether any assistive technology has registered an event
+ * listener with the AT-SPI registry.
+ *
+ * Returns `TRUE` as long as the registry has not told us otherwise.
+ *
+ * Returns: whether change notifications need to be emitted
+ */
+gboolean
+gtk_at_spi_root_has_event_listeners (GtkAtSpiRoot *self)
+{
+  g_return_val_if_fail (GTK_IS_AT_SPI_ROOT (self), FALSE);
+
+  return self->n_event_listeners != 0;
+}
+
 const char *
 gtk_at_spi_root_get_base_path (GtkAtSpiRoot *self)
 {
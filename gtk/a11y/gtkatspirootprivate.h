@@ -52,6 +52,9 @@ gtk_at_spi_root_get_connection (GtkAtSpiRoot *self);
 GtkAtSpiCache *
 gtk_at_spi_root_get_cache (GtkAtSpiRoot *self);
 
+gboolean
+gtk_at_spi_root_has_event_listeners (GtkAtSpiRoot *self);
+
 const char *
 gtk_at_spi_root_get_base_path (GtkAtSpiRoot *self);
 
@@ -125,13 +125,28 @@ accessible_text_handle_method (GDBusConnection       *connection,
 
       g_variant_get (parameters, "(i)", &offset);
 
-      GBytes *text = gtk_accessible_text_get_contents (accessible_text, offset, offset + 1);
+      if (GTK_IS_TEXT_VIEW (accessible))
+        {
+          GtkTextBuffer *buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (accessible));
+          GtkTextIter iter;
 
-      if (text != NULL)
+          if (offset >= 0)
+            {
+              gtk_text_buffer_get_iter_at_offset (buffer, &iter, offset);
+              ch = gtk_text_iter_get_char (&iter);
+            }
+        }
+      else
         {
-          const char *str = g_bytes_get_data (text, NULL);
-          if (g_utf8_strlen (str, -1) > 0)
-            ch = g_utf8_get_char (str);
+          GBytes *text = gtk_accessible_text_get_contents (accessible_text, offset, offset + 1);
+
+          if (text != NULL)
+            {
+              const char *str = g_bytes_get_data (text, NULL);
+              if (g_utf8_strlen (str, -1) > 0)
+                ch = g_utf8_get_char (str);
+              g_bytes_unref (text);
+            }
         }
 
       g_dbus_method_invocation_return_value (invocation, g_variant_new ("(i)", ch));
@@ -460,6 +475,16 @@ accessible_text_get_property (GDBusConnection  *connection,
       const char *str;
       gsize len;
 
+      /* The buffer knows its length, so don't copy out the whole
+       * contents of a potentially huge text view just to count them
+       */
+      if (GTK_IS_TEXT_VIEW (accessible))
+        {
+          GtkTextBuffer *buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (accessible));
+
+          return g_variant_new_int32 (gtk_text_buffer_get_char_count (buffer));
+        }
+
       contents = gtk_accessible_text_get_contents (accessible_text, 0, G_MAXUINT);
       str = g_bytes_get_data (contents, NULL);
       len = g_utf8_strlen (str, -1);
@@ -0,0 +1,46 @@
+#include "config.h"
+
+#include "gtkbuilderprecompileprivate.h"
+
+#include <stdlib.h>
+
+/* This program converts a GtkBuilder ui file into the precompiled form
+ * that GtkBuilder can replay without parsing the XML again. Run it
+ * like this:
+ *
+ *   builder-precompile INPUT OUTPUT
+ *
+ * The GTK build uses it for the ui files in its resources.
+ */
+int
+main (int argc, char *argv[])
+{
+  GError *error = NULL;
+  GBytes *precompiled;
+  char *contents;
+  gsize length;
+
+  if (argc != 3)
+    {
+      g_print ("Usage: builder-precompile INPUT OUTPUT\n");
+      exit (1);
+    }
+
+  if (!g_file_get_contents (argv[1], &contents, &length, &error))
+    g_error ("%s", error->message);
+
+  precompiled = _gtk_buildable_parser_precompile (contents, length, &error);
+  if (precompiled == NULL)
+    g_error ("Failed to precompile %s: %s", argv[1], error->message);
+
+  if (!g_file_set_contents (argv[2],
+                            g_bytes_get_data (precompiled, NULL),
+                            g_bytes_get_size (precompiled),
+                            &error))
+    g_error ("%s", error->message);
+
+  g_bytes_unref (precompiled);
+  g_free (contents);
+
+  return 0;
+}
@@ -0,0 +1,47 @@
+#include "config.h"
+
+#include "gtkcsstokenizerprivate.h"
+
+#include <stdlib.h>
+
+/* This program converts a CSS file into the precompiled token stream
+ * that GtkCssTokenizer can replay without tokenizing the text again.
+ * Run it like this:
+ *
+ *   css-precompile INPUT OUTPUT
+ *
+ * The GTK build uses it for the builtin theme.
+ */
+int
+main (int argc, char *argv[])
+{
+  GError *error = NULL;
+  GBytes *bytes, *precompiled;
+  char *contents;
+  gsize length;
+
+  if (argc != 3)
+    {
+      g_print ("Usage: css-precompile INPUT OUTPUT\n");
+      exit (1);
+    }
+
+  if (!g_file_get_contents (argv[1], &contents, &length, &error))
+    g_error ("%s", error->message);
+
+  bytes = g_bytes_new_take (contents, length);
+  precompiled = gtk_css_tokenizer_precompile (bytes, &error);
+  if (precompiled == NULL)
+    g_error ("Failed to precompile %s: %s", argv[1], error->message);
+
+  if (!g_file_set_contents (argv[2],
+                            g_bytes_get_data (precompiled, NULL),
+                            g_bytes_get_size (precompiled),
+                            &error))
+    g_error ("%s", error->message);
+
+  g_bytes_unref (precompiled);
+  g_bytes_unref (bytes);
+
+  return 0;
+}
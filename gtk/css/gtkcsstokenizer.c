@@ -36,8 +36,17 @@ struct _GtkCssTokenizer
   const char            *end;
 
   GtkCssLocation         position;
+
+  guint                  precompiled : 1;
 };
 
+/* Precompiled token streams start with this header, followed by one
+ * record per token: the token type, the location after the token and
+ * the token's payload.
+ */
+#define PRECOMPILED_HEADER "GCS"
+#define PRECOMPILED_HEADER_SIZE 4
+
 void
 gtk_css_token_clear (GtkCssToken *token)
 {
@@ -579,6 +588,12 @@ gtk_css_tokenizer_new (GBytes *bytes)
   tokenizer->data = g_bytes_get_data (bytes, NULL);
   tokenizer->end = tokenizer->data + g_bytes_get_size (bytes);
 
+  if (gtk_css_tokenizer_is_precompiled (tokenizer->data, g_bytes_get_size (bytes)))
+    {
+      tokenizer->precompiled = TRUE;
+      tokenizer->data += PRECOMPILED_HEADER_SIZE;
+    }
+
   gtk_css_location_init (&tokenizer->position);
 
   return tokenizer;
@@ -706,6 +721,74 @@ gtk_css_tokenizer_remaining (GtkCssTokenizer *tokenizer)
   return tokenizer->end - tokenizer->data;
 }
 
+/* Helpers to look at 8 bytes at once. swar_has_byte() is nonzero
+ * if any byte of @v equals @c.
+ */
+#define SWAR_ONES  G_GUINT64_CONSTANT (0x0101010101010101)
+#define SWAR_HIGHS G_GUINT64_CONSTANT (0x8080808080808080)
+
+static inline guint64
+swar_load (const char *data)
+{
+  guint64 v;
+
+  memcpy (&v, data, sizeof (guint64));
+
+  return v;
+}
+
+static inline guint64
+swar_has_zero (guint64 v)
+{
+  return (v - SWAR_ONES) & ~v & SWAR_HIGHS;
+}
+
+static inline guint64
+swar_has_byte (guint64 v,
+               guchar  c)
+{
+  return swar_has_zero (v ^ (SWAR_ONES * c));
+}
+
+/* Returns the length of the run of ASCII at the start of the remaining
+ * input that contains no newlines and neither @stop1 nor @stop2.
+ *
+ * Such a run has one character per byte and doesn't change the line,
+ * so it can be consumed in one go.
+ */
+static gsize
+gtk_css_tokenizer_scan_plain (GtkCssTokenizer *tokenizer,
+                              char             stop1,
+                              char             stop2)
+{
+  const char *data = tokenizer->data;
+  const char *end = tokenizer->end;
+
+  while (end - data >= 8)
+    {
+      guint64 v = swar_load (data);
+
+      if ((v & SWAR_HIGHS) ||
+          swar_has_byte (v, '\n') ||
+          swar_has_byte (v, '\r') ||
+          swar_has_byte (v, '\f') ||
+          swar_has_byte (v, stop1) ||
+          swar_has_byte (v, stop2))
+        break;
+
+      data += 8;
+    }
+
+  while (data < end &&
+         !is_multibyte (*data) &&
+         !is_newline (*data) &&
+         *data != stop1 &&
+         *data != stop2)
+    data++;
+
+  return data - tokenizer->data;
+}
+
 static inline gboolean
 gtk_css_tokenizer_has_valid_escape (GtkCssTokenizer *tokenizer)
 {
@@ -833,7 +916,18 @@ gtk_css_tokenizer_read_whitespace (GtkCssTokenizer *tokenizer,
                                    GtkCssToken     *token)
 {
   do {
-    gtk_css_tokenizer_consume_whitespace (tokenizer);
+    const char *data = tokenizer->data;
+
+    /* Indentation is the common case, skip it in bulk */
+    while (tokenizer->end - data >= 8 && swar_load (data) == SWAR_ONES * ' ')
+      data += 8;
+    while (data < tokenizer->end && (*data == ' ' || *data == '\t'))
+      data++;
+
+    if (data > tokenizer->data)
+      gtk_css_tokenizer_consume (tokenizer, data - tokenizer->data, data - tokenizer->data);
+    else
+      gtk_css_tokenizer_consume_whitespace (tokenizer);
   } while (tokenizer->data != tokenizer->end &&
            is_whitespace (*tokenizer->data));
 
@@ -904,10 +998,23 @@ gtk_css_tokenizer_read_name (GtkCssTokenizer *tokenizer)
               gtk_css_tokenizer_consume_char (tokenizer, tokenizer->name_buffer);
             }
         }
-      else if (is_name (*tokenizer->data))
+      else if (is_multibyte (*tokenizer->data))
         {
           gtk_css_tokenizer_consume_char (tokenizer, tokenizer->name_buffer);
         }
+      else if (is_name (*tokenizer->data))
+        {
+          const char *data = tokenizer->data;
+          gsize len;
+
+          do
+            data++;
+          while (data < tokenizer->end && !is_multibyte (*data) && is_name (*data));
+
+          len = data - tokenizer->data;
+          g_string_append_len (tokenizer->name_buffer, tokenizer->data, len);
+          gtk_css_tokenizer_consume (tokenizer, len, len);
+        }
       else
         {
           break;
@@ -1001,10 +1108,30 @@ gtk_css_tokenizer_read_url (GtkCssTokenizer  *tokenizer,
           g_string_free (url, TRUE);
           return FALSE;
         }
-      else
+      else if (is_multibyte (*tokenizer->data))
         {
           gtk_css_tokenizer_consume_char (tokenizer, url);
         }
+      else
+        {
+          /* Data urls can be long, copy plain runs in one go */
+          const char *data = tokenizer->data;
+          gsize len;
+
+          do
+            data++;
+          while (data < tokenizer->end &&
+                 !is_multibyte (*data) &&
+                 !is_whitespace (*data) &&
+                 !is_non_printable (*data) &&
+                 *data != ')' && *data != '(' &&
+                 *data != '"' && *data != '\'' &&
+                 *data != '\\');
+
+          len = data - tokenizer->data;
+          g_string_append_len (url, tokenizer->data, len);
+          gtk_css_tokenizer_consume (tokenizer, len, len);
+        }
     }
 
   gtk_css_token_init_string (token, GTK_CSS_TOKEN_URL, url);
@@ -1205,6 +1332,15 @@ gtk_css_tokenizer_read_string (GtkCssTokenizer  *tokenizer,
 
   while (tokenizer->data < tokenizer->end)
     {
+      gsize len = gtk_css_tokenizer_scan_plain (tokenizer, end, '\\');
+
+      if (len > 0)
+        {
+          g_string_append_len (tokenizer->name_buffer, tokenizer->data, len);
+          gtk_css_tokenizer_consume (tokenizer, len, len);
+          continue;
+        }
+
       if (*tokenizer->data == end)
         {
           gtk_css_tokenizer_consume_ascii (tokenizer);
@@ -1253,6 +1389,14 @@ gtk_css_tokenizer_read_comment (GtkCssTokenizer  *tokenizer,
 
   while (tokenizer->data < tokenizer->end)
     {
+      gsize len = gtk_css_tokenizer_scan_plain (tokenizer, '*', '*');
+
+      if (len > 0)
+        {
+          gtk_css_tokenizer_consume (tokenizer, len, len);
+          continue;
+        }
+
       if (gtk_css_tokenizer_remaining (tokenizer) > 1 &&
           tokenizer->data[0] == '*' && tokenizer->data[1] == '/')
         {
@@ -1284,11 +1428,172 @@ gtk_css_tokenizer_read_match (GtkCssTokenizer *tokenizer,
     }
 }
 
+static gboolean
+gtk_css_tokenizer_replay_uint (GtkCssTokenizer *tokenizer,
+                               gsize           *value)
+{
+  guint shift = 0;
+
+  *value = 0;
+
+  while (tokenizer->data < tokenizer->end && shift < 64)
+    {
+      guchar c = *tokenizer->data++;
+
+      *value |= ((gsize) (c & 0x7f)) << shift;
+      if ((c & 0x80) == 0)
+        return TRUE;
+
+      shift += 7;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+gtk_css_tokenizer_replay_double (GtkCssTokenizer *tokenizer,
+                                 double          *value)
+{
+  guint64 bits;
+
+  if (gtk_css_tokenizer_remaining (tokenizer) < sizeof (bits))
+    return FALSE;
+
+  memcpy (&bits, tokenizer->data, sizeof (bits));
+  bits = GUINT64_FROM_LE (bits);
+  memcpy (value, &bits, sizeof (bits));
+  tokenizer->data += sizeof (bits);
+
+  return TRUE;
+}
+
+static gboolean
+gtk_css_tokenizer_replay_string (GtkCssTokenizer *tokenizer)
+{
+  gsize len;
+
+  if (!gtk_css_tokenizer_replay_uint (tokenizer, &len) ||
+      gtk_css_tokenizer_remaining (tokenizer) < len)
+    return FALSE;
+
+  g_string_set_size (tokenizer->name_buffer, 0);
+  g_string_append_len (tokenizer->name_buffer, tokenizer->data, len);
+  tokenizer->data += len;
+
+  return TRUE;
+}
+
+static gboolean
+gtk_css_tokenizer_replay_token (GtkCssTokenizer  *tokenizer,
+                                GtkCssToken      *token,
+                                GError          **error)
+{
+  GtkCssLocation *position = &tokenizer->position;
+  GtkCssTokenType type;
+  gsize bytes, chars, lines;
+  double value;
+  gsize delim;
+
+  if (tokenizer->data == tokenizer->end)
+    {
+      gtk_css_token_init (token, GTK_CSS_TOKEN_EOF);
+      return TRUE;
+    }
+
+  type = (guchar) *tokenizer->data++;
+
+  if (!gtk_css_tokenizer_replay_uint (tokenizer, &bytes) ||
+      !gtk_css_tokenizer_replay_uint (tokenizer, &chars) ||
+      !gtk_css_tokenizer_replay_uint (tokenizer, &lines) ||
+      !gtk_css_tokenizer_replay_uint (tokenizer, &position->line_bytes) ||
+      !gtk_css_tokenizer_replay_uint (tokenizer, &position->line_chars))
+    goto fail;
+
+  position->bytes += bytes;
+  position->chars += chars;
+  position->lines += lines;
+
+  switch ((guint) type)
+    {
+    case GTK_CSS_TOKEN_WHITESPACE:
+    case GTK_CSS_TOKEN_OPEN_PARENS:
+    case GTK_CSS_TOKEN_CLOSE_PARENS:
+    case GTK_CSS_TOKEN_OPEN_SQUARE:
+    case GTK_CSS_TOKEN_CLOSE_SQUARE:
+    case GTK_CSS_TOKEN_OPEN_CURLY:
+    case GTK_CSS_TOKEN_CLOSE_CURLY:
+    case GTK_CSS_TOKEN_COMMA:
+    case GTK_CSS_TOKEN_COLON:
+    case GTK_CSS_TOKEN_SEMICOLON:
+    case GTK_CSS_TOKEN_CDC:
+    case GTK_CSS_TOKEN_CDO:
+    case GTK_CSS_TOKEN_INCLUDE_MATCH:
+    case GTK_CSS_TOKEN_DASH_MATCH:
+    case GTK_CSS_TOKEN_PREFIX_MATCH:
+    case GTK_CSS_TOKEN_SUFFIX_MATCH:
+    case GTK_CSS_TOKEN_SUBSTRING_MATCH:
+    case GTK_CSS_TOKEN_COLUMN:
+    case GTK_CSS_TOKEN_COMMENT:
+      gtk_css_token_init (token, type);
+      return TRUE;
+
+    case GTK_CSS_TOKEN_DELIM:
+      if (!gtk_css_tokenizer_replay_uint (tokenizer, &delim))
+        goto fail;
+      gtk_css_token_init_delim (token, delim);
+      return TRUE;
+
+    case GTK_CSS_TOKEN_STRING:
+    case GTK_CSS_TOKEN_IDENT:
+    case GTK_CSS_TOKEN_FUNCTION:
+    case GTK_CSS_TOKEN_AT_KEYWORD:
+    case GTK_CSS_TOKEN_HASH_UNRESTRICTED:
+    case GTK_CSS_TOKEN_HASH_ID:
+    case GTK_CSS_TOKEN_URL:
+      if (!gtk_css_tokenizer_replay_string (tokenizer))
+        goto fail;
+      gtk_css_token_init_string (token, type, tokenizer->name_buffer);
+      return TRUE;
+
+    case GTK_CSS_TOKEN_SIGNED_INTEGER:
+    case GTK_CSS_TOKEN_SIGNLESS_INTEGER:
+    case GTK_CSS_TOKEN_SIGNED_NUMBER:
+    case GTK_CSS_TOKEN_SIGNLESS_NUMBER:
+    case GTK_CSS_TOKEN_PERCENTAGE:
+      if (!gtk_css_tokenizer_replay_double (tokenizer, &value))
+        goto fail;
+      gtk_css_token_init_number (token, type, value);
+      return TRUE;
+
+    case GTK_CSS_TOKEN_SIGNED_INTEGER_DIMENSION:
+    case GTK_CSS_TOKEN_SIGNLESS_INTEGER_DIMENSION:
+    case GTK_CSS_TOKEN_SIGNED_DIMENSION:
+    case GTK_CSS_TOKEN_SIGNLESS_DIMENSION:
+      if (!gtk_css_tokenizer_replay_double (tokenizer, &value) ||
+          !gtk_css_tokenizer_replay_string (tokenizer))
+        goto fail;
+      gtk_css_token_init_dimension (token, type, value, tokenizer->name_buffer);
+      return TRUE;
+
+    default:
+      break;
+    }
+
+fail:
+  tokenizer->data = tokenizer->end;
+  gtk_css_token_init (token, GTK_CSS_TOKEN_EOF);
+  gtk_css_tokenizer_parse_error (error, "Invalid precompiled CSS data");
+  return FALSE;
+}
+
 gboolean
 gtk_css_tokenizer_read_token (GtkCssTokenizer  *tokenizer,
                               GtkCssToken      *token,
                               GError          **error)
 {
+  if (tokenizer->precompiled)
+    return gtk_css_tokenizer_replay_token (tokenizer, token, error);
+
   if (tokenizer->data == tokenizer->end)
     {
       gtk_css_token_init (token, GTK_CSS_TOKEN_EOF);
@@ -1484,3 +1789,140 @@ gtk_css_tokenizer_read_token (GtkCssTokenizer  *tokenizer,
     }
 }
 
+
+static void
+precompile_uint (GString *data,
+                 gsize    value)
+{
+  while (value >= 0x80)
+    {
+      g_string_append_c (data, (value & 0x7f) | 0x80);
+      value >>= 7;
+    }
+
+  g_string_append_c (data, value);
+}
+
+static void
+precompile_double (GString *data,
+                   double   value)
+{
+  guint64 bits;
+
+  memcpy (&bits, &value, sizeof (bits));
+  bits = GUINT64_TO_LE (bits);
+  g_string_append_len (data, (const char *) &bits, sizeof (bits));
+}
+
+static void
+precompile_string (GString    *data,
+                   const char *string,
+                   gsize       len)
+{
+  precompile_uint (data, len);
+  g_string_append_len (data, string, len);
+}
+
+gboolean
+gtk_css_tokenizer_is_precompiled (const char *data,
+                                  gsize       data_len)
+{
+  return data_len >= PRECOMPILED_HEADER_SIZE &&
+         memcmp (data, PRECOMPILED_HEADER, PRECOMPILED_HEADER_SIZE) == 0;
+}
+
+/**
+ * gtk_css_tokenizer_precompile:
+ * @bytes: CSS text
+ * @error: return location for an error
+ *
+ * Tokenizes @bytes and stores the resulting tokens in a binary form
+ * that gtk_css_tokenizer_new() can replay without having to tokenize
+ * the text again. Token locations are kept, so errors and sections
+ * refer to the original text.
+ *
+ * Returns: The precompiled data or %NULL if the text could not be
+ *   tokenized without errors
+ */
+GBytes *
+gtk_css_tokenizer_precompile (GBytes  *bytes,
+                              GError **error)
+{
+  GtkCssTokenizer *tokenizer;
+  GtkCssLocation last;
+  GString *data;
+
+  if (gtk_css_tokenizer_is_precompiled (g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes)))
+    return g_bytes_ref (bytes);
+
+  tokenizer = gtk_css_tokenizer_new (bytes);
+  data = g_string_sized_new (g_bytes_get_size (bytes));
+  g_string_append_len (data, PRECOMPILED_HEADER, PRECOMPILED_HEADER_SIZE);
+  gtk_css_location_init (&last);
+
+  while (TRUE)
+    {
+      GtkCssToken token;
+
+      if (!gtk_css_tokenizer_read_token (tokenizer, &token, error))
+        {
+          gtk_css_token_clear (&token);
+          gtk_css_tokenizer_unref (tokenizer);
+          g_string_free (data, TRUE);
+          return NULL;
+        }
+
+      if (gtk_css_token_is (&token, GTK_CSS_TOKEN_EOF))
+        break;
+
+      g_string_append_c (data, token.type);
+      precompile_uint (data, tokenizer->position.bytes - last.bytes);
+      precompile_uint (data, tokenizer->position.chars - last.chars);
+      precompile_uint (data, tokenizer->position.lines - last.lines);
+      precompile_uint (data, tokenizer->position.line_bytes);
+      precompile_uint (data, tokenizer->position.line_chars);
+      last = tokenizer->position;
+
+      switch (token.type)
+        {
+        case GTK_CSS_TOKEN_DELIM:
+          precompile_uint (data, token.delim.delim);
+          break;
+
+        case GTK_CSS_TOKEN_STRING:
+        case GTK_CSS_TOKEN_IDENT:
+        case GTK_CSS_TOKEN_FUNCTION:
+        case GTK_CSS_TOKEN_AT_KEYWORD:
+        case GTK_CSS_TOKEN_HASH_UNRESTRICTED:
+        case GTK_CSS_TOKEN_HASH_ID:
+        case GTK_CSS_TOKEN_URL:
+          precompile_string (data, gtk_css_token_get_string (&token), token.string.len);
+          break;
+
+        case GTK_CSS_TOKEN_SIGNED_INTEGER:
+        case GTK_CSS_TOKEN_SIGNLESS_INTEGER:
+        case GTK_CSS_TOKEN_SIGNED_NUMBER:
+        case GTK_CSS_TOKEN_SIGNLESS_NUMBER:
+        case GTK_CSS_TOKEN_PERCENTAGE:
+          precompile_double (data, token.number.number);
+          break;
+
+        case GTK_CSS_TOKEN_SIGNED_INTEGER_DIMENSION:
+        case GTK_CSS_TOKEN_SIGNLESS_INTEGER_DIMENSION:
+        case GTK_CSS_TOKEN_SIGNED_DIMENSION:
+        case GTK_CSS_TOKEN_SIGNLESS_DIMENSION:
+          precompile_double (data, token.dimension.value);
+          precompile_string (data, token.dimension.dimension, strlen (token.dimension.dimension));
+          break;
+
+        default:
+          break;
+        }
+
+      gtk_css_token_clear (&token);
+    }
+
+  gtk_css_tokenizer_unref (tokenizer);
+
+  return g_string_free_to_bytes (data);
+}
@@ -148,5 +148,10 @@ gboolean                gtk_css_tokenizer_read_token            (GtkCssTokenizer
                                                                  GtkCssToken            *token,
                                                                  GError                **error);
 
+gboolean                gtk_css_tokenizer_is_precompiled        (const char             *data,
+                                                                 gsize                   data_len) G_GNUC_PURE;
+GBytes *                gtk_css_tokenizer_precompile            (GBytes                 *bytes,
+                                                                 GError                **error);
+
 G_END_DECLS
 
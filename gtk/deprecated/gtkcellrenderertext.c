@@ -170,6 +170,8 @@ struct _GtkCellRendererTextPrivate
 {
   GtkWidget *entry;
 
+  PangoLayout          *layout;   /* reused by get_layout() */
+
   PangoAttrList        *extra_attrs;
   GdkRGBA               foreground;
   GdkRGBA               background;
@@ -566,6 +568,7 @@ gtk_cell_renderer_text_finalize (GObject *object)
     g_object_unref (priv->language);
 
   g_clear_object (&priv->entry);
+  g_clear_object (&priv->layout);
 
   G_OBJECT_CLASS (gtk_cell_renderer_text_parent_class)->finalize (object);
 }
@@ -1343,9 +1346,25 @@ get_layout (GtkCellRendererText *celltext,
   PangoUnderline uline;
   int xpad;
   gboolean placeholder_layout = show_placeholder_text (celltext);
+  const char *text = placeholder_layout ? priv->placeholder_text : priv->text;
 
-  layout = gtk_widget_create_pango_layout (widget, placeholder_layout ?
-                                           priv->placeholder_text : priv->text);
+  /* A renderer is usually used for all rows of a column, so reuse
+   * the layout unless it is still in use or made for another widget.
+   * Everything that is set below has to be set unconditionally.
+   */
+  if (priv->layout &&
+      G_OBJECT (priv->layout)->ref_count == 1 &&
+      pango_layout_get_context (priv->layout) == gtk_widget_get_pango_context (widget))
+    {
+      layout = g_object_ref (priv->layout);
+      pango_layout_set_text (layout, text ? text : "", -1);
+      pango_layout_set_width (layout, -1);
+    }
+  else
+    {
+      layout = gtk_widget_create_pango_layout (widget, text);
+      g_set_object (&priv->layout, layout);
+    }
 
   gtk_cell_renderer_get_padding (GTK_CELL_RENDERER (celltext), &xpad, NULL);
 
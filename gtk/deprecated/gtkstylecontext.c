@@ -148,7 +148,12 @@ static void
 gtk_style_context_cascade_changed (GtkStyleCascade *cascade,
                                    GtkStyleContext *context)
 {
-  gtk_css_node_invalidate_style_provider (gtk_style_context_get_root (context));
+  const GtkCssSelectorKeys *keys = gtk_style_provider_get_changed_keys ();
+
+  if (keys)
+    gtk_css_node_invalidate_style_provider_for_keys (gtk_style_context_get_root (context), keys);
+  else
+    gtk_css_node_invalidate_style_provider (gtk_style_context_get_root (context));
 }
 
 static void
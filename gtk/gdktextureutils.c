@@ -515,6 +515,53 @@ gdk_texture_new_from_resource_at_scale (const char    *path,
 /* }}} */
 /* {{{ Symbolic texture API */
 
+/* The rgb planes of symbolic icons hold the amount of the success,
+ * warning and error colors, see gtk_make_symbolic_pixbuf_from_data().
+ * Most icons only use the foreground color and have all of them zero.
+ * For those, only the alpha plane is kept, so renderers can draw them
+ * as a mask filled with the foreground color.
+ */
+static GdkTexture *
+texture_new_for_symbolic_pixbuf (GdkPixbuf *pixbuf)
+{
+  const guchar *pixels, *row;
+  guchar *data;
+  GdkTexture *texture;
+  GBytes *bytes;
+  gsize stride;
+  int width, height;
+  int x, y;
+
+  width = gdk_pixbuf_get_width (pixbuf);
+  height = gdk_pixbuf_get_height (pixbuf);
+  stride = gdk_pixbuf_get_rowstride (pixbuf);
+  pixels = gdk_pixbuf_read_pixels (pixbuf);
+
+  for (y = 0; y < height; y++)
+    {
+      row = pixels + y * stride;
+      for (x = 0; x < width; x++)
+        {
+          if (row[4 * x] | row[4 * x + 1] | row[4 * x + 2])
+            return gdk_texture_new_for_pixbuf (pixbuf);
+        }
+    }
+
+  data = g_malloc ((gsize) width * height);
+  for (y = 0; y < height; y++)
+    {
+      row = pixels + y * stride;
+      for (x = 0; x < width; x++)
+        data[y * width + x] = row[4 * x + 3];
+    }
+
+  bytes = g_bytes_new_take (data, (gsize) width * height);
+  texture = gdk_memory_texture_new (width, height, GDK_MEMORY_A8, bytes, width);
+  g_bytes_unref (bytes);
+
+  return texture;
+}
+
 GdkTexture *
 gdk_texture_new_from_path_symbolic (const char    *path,
                                     int            width,
@@ -528,7 +575,7 @@ gdk_texture_new_from_path_symbolic (const char    *path,
   pixbuf = make_symbolic_pixbuf_from_path (path, width, height, scale, error);
   if (pixbuf)
     {
-      texture = gdk_texture_new_for_pixbuf (pixbuf);
+      texture = texture_new_for_symbolic_pixbuf (pixbuf);
       g_object_unref (pixbuf);
     }
 
@@ -554,7 +601,7 @@ gdk_texture_new_from_resource_symbolic (const char  *path,
   pixbuf = make_symbolic_pixbuf_from_resource (path, width, height, scale, error);
   if (pixbuf)
     {
-      texture = gdk_texture_new_for_pixbuf (pixbuf);
+      texture = texture_new_for_symbolic_pixbuf (pixbuf);
       g_object_unref (pixbuf);
     }
 
@@ -594,7 +641,7 @@ gdk_texture_new_from_file_symbolic (GFile       *file,
   GdkTexture *texture;
 
   pixbuf = make_symbolic_pixbuf_from_file (file, width, height, scale, error);
-  texture = gdk_texture_new_for_pixbuf (pixbuf);
+  texture = texture_new_for_symbolic_pixbuf (pixbuf);
   g_object_unref (pixbuf);
 
   return texture;
@@ -2,7 +2,8 @@
 #
 # Generate gtk.gresources.xml
 #
-# Usage: gen-gtk-gresources-xml SRCDIR_GTK [OUTPUT-FILE]
+# Usage: gen-gtk-gresources-xml SRCDIR_GTK ENDIAN [OUTPUT-FILE] [FLAGS...]
+#        gen-gtk-gresources-xml SRCDIR_GTK ui-files
 
 import os, sys
 import filecmp
@@ -22,6 +23,8 @@ def replace_if_changed(new, old):
 
 srcdir = sys.argv[1]
 endian = sys.argv[2]
+precompiled_theme = 'precompiled-theme' in sys.argv[4:]
+precompiled_ui = 'precompiled-ui' in sys.argv[4:]
 
 xml = '''<?xml version='1.0' encoding='UTF-8'?>
 <gresources>
@@ -31,6 +34,29 @@ xml = '''<?xml version='1.0' encoding='UTF-8'?>
 def get_files(subdir,extension):
   return sorted(filter(lambda x: x.endswith((extension)), os.listdir(os.path.join(srcdir,subdir))))
 
+def get_ui_files():
+  return ['ui/' + f for f in get_files('ui', '.ui')] + \
+         ['print/ui/' + f for f in get_files('print/ui', '.ui')] + \
+         ['inspector/' + f for f in get_files('inspector', '.ui')]
+
+# The name that the precompiled version of a ui file has in the build
+# directory, see gtk/meson.build
+def precompiled_ui_file(path):
+  return path.replace('/', '-')[:-len('.ui')] + '.gui'
+
+def ui_file(path, preprocess=None):
+  if precompiled_ui:
+    return '    <file alias=\'{0}\'>{1}</file>\n'.format(path, precompiled_ui_file(path))
+  elif preprocess:
+    return '    <file preprocess=\'{0}\'>{1}</file>\n'.format(preprocess, path)
+  else:
+    return '    <file>{0}</file>\n'.format(path)
+
+if endian == 'ui-files':
+  for f in get_ui_files():
+    print(f)
+  sys.exit(0)
+
 xml += '''
     <file>theme/Empty/gtk.css</file>
 
@@ -43,10 +69,15 @@ xml += '''
     <file>theme/Default/gtk-dark.css</file>
     <file>theme/Default/gtk-hc.css</file>
     <file>theme/Default/gtk-hc-dark.css</file>
-    <file>theme/Default/Default-light.css</file>
-    <file>theme/Default/Default-dark.css</file>
-    <file>theme/Default/Default-hc.css</file>
-    <file>theme/Default/Default-hc-dark.css</file>
+'''
+
+for variant in ['light', 'dark', 'hc', 'hc-dark']:
+  if precompiled_theme:
+    xml += '    <file alias=\'theme/Default/Default-{0}.css\'>Default-{0}.gcss</file>\n'.format(variant)
+  else:
+    xml += '    <file>theme/Default/Default-{0}.css</file>\n'.format(variant)
+
+xml += '''
 '''
 
 for f in get_files('theme/Default/assets', '.png'):
@@ -66,10 +97,10 @@ for f in get_files('theme/Default/assets-hc', '.svg'):
   xml += '    <file preprocess=\'xml-stripblanks\'>theme/Default/assets-hc/{0}</file>\n'.format(f)
 
 for f in get_files('ui', '.ui'):
-  xml += '    <file>ui/{0}</file>\n'.format(f)
+  xml += ui_file('ui/' + f)
 
 for f in get_files('print/ui', '.ui'):
-  xml += '    <file>print/ui/{0}</file>\n'.format(f)
+  xml += ui_file('print/ui/' + f)
 
 xml += '\n'
 
@@ -87,7 +118,7 @@ for s in ['16x16', '32x32', '64x64', 'scalable']:
         xml += '    <file preprocess=\'xml-stripblanks\'>icons/{0}/{1}/{2}</file>\n'.format(s,c,f)
 
 for f in get_files('inspector', '.ui'):
-  xml += '    <file preprocess=\'xml-stripblanks\'>inspector/{0}</file>\n'.format(f)
+  xml += ui_file('inspector/' + f, 'xml-stripblanks')
 
 xml += '''
     <file>inspector/inspector.css</file>
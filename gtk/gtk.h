@@ -39,6 +39,7 @@
 #include <gtk/gtkactionbar.h>
 #include <gtk/gtkadjustment.h>
 #include <gtk/gtkalertdialog.h>
+#include <gtk/gtkanimatedimage.h>
 #include <gtk/deprecated/gtkappchooser.h>
 #include <gtk/deprecated/gtkappchooserdialog.h>
 #include <gtk/deprecated/gtkappchooserwidget.h>
@@ -180,6 +181,7 @@
 #include <gtk/gtklistheader.h>
 #include <gtk/gtklistitem.h>
 #include <gtk/gtklistitemfactory.h>
+#include <gtk/gtklistmodelbatch.h>
 #include <gtk/deprecated/gtkliststore.h>
 #include <gtk/gtklistview.h>
 #include <gtk/deprecated/gtklockbutton.h>
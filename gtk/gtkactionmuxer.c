@@ -24,6 +24,7 @@
 #include "gtkactionobservableprivate.h"
 #include "gtkactionobserverprivate.h"
 #include "gtkbitmaskprivate.h"
+#include "gtkmain.h"
 #include "gtkmarshalers.h"
 #include "gtkwidgetprivate.h"
 #include "gsettings-mapping.h"
@@ -163,6 +164,17 @@ struct _GtkActionMuxer
   GtkAccels primary_accels;
 
   GtkBitmask *widget_actions_disabled;
+
+  /* Where action names were found in this muxer, without looking at
+   * the parents. Maps names to ResolvedAction.
+   */
+  GHashTable *resolved_actions;
+
+  /* Enabled and state changes waiting to be sent to observers,
+   * maps names to PendingChange.
+   */
+  GHashTable *pending_changes;
+  guint pending_changes_id;
 };
 
 G_DEFINE_TYPE_WITH_CODE (GtkActionMuxer, gtk_action_muxer, G_TYPE_OBJECT,
@@ -194,6 +206,29 @@ typedef struct
   gulong        handler_ids[4];
 } Group;
 
+/* A widget action, a group, or neither if the name
+ * is not known to this muxer itself
+ */
+typedef struct
+{
+  char            *name;
+  GtkWidgetAction *widget_action;
+  guint            position;
+  Group           *group;
+} ResolvedAction;
+
+typedef struct
+{
+  gboolean  enabled_changed;
+  gboolean  enabled;
+  GVariant *state;
+} PendingChange;
+
+/* Muxers are asked for all the names their descendants use, so
+ * don't let the cache of misses grow without bounds
+ */
+#define MAX_RESOLVED_ACTIONS 512
+
 static inline guint
 get_action_position (GtkWidgetAction *action)
 {
@@ -305,18 +340,122 @@ gtk_action_muxer_find_group (GtkActionMuxer  *muxer,
   return NULL;
 }
 
+static void
+resolved_action_free (gpointer data)
+{
+  ResolvedAction *resolved = data;
+
+  g_free (resolved->name);
+  g_free (resolved);
+}
+
+static const char *
+resolved_action_get_unprefixed_name (const ResolvedAction *resolved)
+{
+  return resolved->name + strlen (resolved->group->prefix) + 1;
+}
+
+/* Looks up @action_name among the widget actions and groups of @muxer
+ * itself. The result is cached until the groups change.
+ */
+static const ResolvedAction *
+gtk_action_muxer_resolve (GtkActionMuxer *muxer,
+                          const char     *action_name)
+{
+  ResolvedAction *resolved;
+
+  if (muxer->resolved_actions == NULL)
+    muxer->resolved_actions = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, resolved_action_free);
+
+  resolved = g_hash_table_lookup (muxer->resolved_actions, action_name);
+  if (resolved)
+    {
+      /* Groups may still have a removed action while they
+       * emit ::action-removed, so don't trust the cache blindly
+       */
+      if (resolved->group &&
+          !g_action_group_has_action (resolved->group->group,
+                                      resolved_action_get_unprefixed_name (resolved)))
+        resolved->group = NULL;
+
+      return resolved;
+    }
+
+  if (g_hash_table_size (muxer->resolved_actions) >= MAX_RESOLVED_ACTIONS)
+    g_hash_table_remove_all (muxer->resolved_actions);
+
+  resolved = g_new0 (ResolvedAction, 1);
+  resolved->name = g_strdup (action_name);
+
+  if (muxer->widget)
+    {
+      GtkWidgetClass *klass = GTK_WIDGET_GET_CLASS (muxer->widget);
+      GtkWidgetClassPrivate *priv = klass->priv;
+      GtkWidgetAction *action;
+
+      for (action = priv->actions; action; action = action->next)
+        {
+          if (strcmp (action->name, action_name) == 0)
+            {
+              resolved->widget_action = action;
+              resolved->position = get_action_position (action);
+              break;
+            }
+        }
+    }
+
+  if (resolved->widget_action == NULL)
+    resolved->group = gtk_action_muxer_find_group (muxer, action_name, NULL);
+
+  g_hash_table_insert (muxer->resolved_actions, resolved->name, resolved);
+
+  return resolved;
+}
+
+static void
+gtk_action_muxer_invalidate_action (GtkActionMuxer *muxer,
+                                    const char     *action_name)
+{
+  if (muxer->resolved_actions)
+    g_hash_table_remove (muxer->resolved_actions, action_name);
+}
+
+static void
+gtk_action_muxer_invalidate_prefix (GtkActionMuxer *muxer,
+                                    const char     *prefix)
+{
+  GHashTableIter iter;
+  const char *name;
+  gsize len;
+
+  if (!muxer->resolved_actions)
+    return;
+
+  len = strlen (prefix);
+
+  g_hash_table_iter_init (&iter, muxer->resolved_actions);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &name, NULL))
+    {
+      if (strncmp (name, prefix, len) == 0 && name[len] == '.')
+        g_hash_table_iter_remove (&iter);
+    }
+}
+
 GActionGroup *
 gtk_action_muxer_find (GtkActionMuxer  *muxer,
                        const char      *action_name,
                        const char     **unprefixed_name)
 {
-  Group *group;
+  const ResolvedAction *resolved;
 
-  group = gtk_action_muxer_find_group (muxer, action_name, unprefixed_name);
-  if (group)
-    return group->group;
+  resolved = gtk_action_muxer_resolve (muxer, action_name);
+  if (resolved->group == NULL)
+    return NULL;
 
-  return NULL;
+  if (unprefixed_name)
+    *unprefixed_name = resolved_action_get_unprefixed_name (resolved);
+
+  return resolved->group->group;
 }
 
 GActionGroup *
@@ -345,36 +484,144 @@ find_observers (GtkActionMuxer *muxer,
   return NULL;
 }
 
-void
-gtk_action_muxer_action_enabled_changed (GtkActionMuxer *muxer,
-                                         const char     *action_name,
-                                         gboolean        enabled)
+static void
+gtk_action_muxer_emit_enabled_changed (GtkActionMuxer *muxer,
+                                       const char     *action_name,
+                                       gboolean        enabled)
 {
-  GtkWidgetAction *iter;
   Action *action;
   GSList *node;
 
-  if (muxer->widget)
-    {
-      GtkWidgetClass *klass = GTK_WIDGET_GET_CLASS (muxer->widget);
-      GtkWidgetClassPrivate *priv = klass->priv;
+  action = find_observers (muxer, action_name);
+  for (node = action ? action->watchers : NULL; node; node = node->next)
+    gtk_action_observer_action_enabled_changed (node->data, GTK_ACTION_OBSERVABLE (muxer), action_name, enabled);
+}
 
-      for (iter = priv->actions; iter; iter = iter->next)
-        {
-          if (strcmp (action_name, iter->name) == 0)
-            {
-              guint position = get_action_position (iter);
-              muxer->widget_actions_disabled =
-                _gtk_bitmask_set (muxer->widget_actions_disabled, position, !enabled);
-              break;
-            }
-        }
+static void
+gtk_action_muxer_emit_state_changed (GtkActionMuxer *muxer,
+                                     const char     *action_name,
+                                     GVariant       *state)
+{
+  Action *action;
+  GSList *node;
+
+  action = find_observers (muxer, action_name);
+  for (node = action ? action->watchers : NULL; node; node = node->next)
+    gtk_action_observer_action_state_changed (node->data, GTK_ACTION_OBSERVABLE (muxer), action_name, state);
+}
+
+static void
+pending_change_free (gpointer data)
+{
+  PendingChange *change = data;
+
+  g_clear_pointer (&change->state, g_variant_unref);
+  g_free (change);
+}
+
+/* Sends the queued enabled and state changes. This must happen before
+ * observers see actions being added or removed, so they receive the
+ * notifications in order.
+ */
+static void
+gtk_action_muxer_flush_changes (GtkActionMuxer *muxer)
+{
+  GHashTable *pending;
+  GHashTableIter iter;
+  const char *action_name;
+  PendingChange *change;
+
+  g_clear_handle_id (&muxer->pending_changes_id, g_source_remove);
+
+  if (!muxer->pending_changes)
+    return;
+
+  /* Observers may cause new changes while we emit these */
+  pending = g_steal_pointer (&muxer->pending_changes);
+
+  g_object_ref (muxer);
+
+  g_hash_table_iter_init (&iter, pending);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &action_name, (gpointer *) &change))
+    {
+      if (change->enabled_changed)
+        gtk_action_muxer_emit_enabled_changed (muxer, action_name, change->enabled);
+      if (change->state)
+        gtk_action_muxer_emit_state_changed (muxer, action_name, change->state);
     }
 
+  g_hash_table_unref (pending);
+
+  g_object_unref (muxer);
+}
+
+static gboolean
+gtk_action_muxer_flush_changes_cb (gpointer data)
+{
+  GtkActionMuxer *muxer = data;
+
+  muxer->pending_changes_id = 0;
+  gtk_action_muxer_flush_changes (muxer);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Actions often change several times in a row, for example while
+ * a selection is being changed, and every notification makes many
+ * actionable widgets update themselves. So changes are collected,
+ * and only the latest one is sent, right before the next frame.
+ */
+static PendingChange *
+gtk_action_muxer_queue_change (GtkActionMuxer *muxer,
+                               const char     *action_name)
+{
+  Action *action;
+  PendingChange *change;
+
   action = find_observers (muxer, action_name);
+  if (action == NULL || action->watchers == NULL)
+    return NULL;
 
-  for (node = action ? action->watchers : NULL; node; node = node->next)
-    gtk_action_observer_action_enabled_changed (node->data, GTK_ACTION_OBSERVABLE (muxer), action_name, enabled);
+  if (muxer->pending_changes == NULL)
+    muxer->pending_changes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, pending_change_free);
+
+  change = g_hash_table_lookup (muxer->pending_changes, action_name);
+  if (change == NULL)
+    {
+      change = g_new0 (PendingChange, 1);
+      g_hash_table_insert (muxer->pending_changes, g_strdup (action_name), change);
+    }
+
+  if (!muxer->pending_changes_id)
+    {
+      muxer->pending_changes_id = g_idle_add_full (GTK_PRIORITY_RESIZE - 2,
+                                                   gtk_action_muxer_flush_changes_cb,
+                                                   muxer, NULL);
+      gdk_source_set_static_name_by_id (muxer->pending_changes_id, "[gtk] action muxer changes");
+    }
+
+  return change;
+}
+
+void
+gtk_action_muxer_action_enabled_changed (GtkActionMuxer *muxer,
+                                         const char     *action_name,
+                                         gboolean        enabled)
+{
+  const ResolvedAction *resolved;
+  PendingChange *change;
+
+  resolved = gtk_action_muxer_resolve (muxer, action_name);
+  if (resolved->widget_action)
+    muxer->widget_actions_disabled =
+      _gtk_bitmask_set (muxer->widget_actions_disabled, resolved->position, !enabled);
+
+  change = gtk_action_muxer_queue_change (muxer, action_name);
+  if (change)
+    {
+      change->enabled_changed = TRUE;
+      change->enabled = enabled;
+    }
 }
 
 static void
@@ -396,12 +643,14 @@ gtk_action_muxer_action_state_changed (GtkActionMuxer *muxer,
                                        const char     *action_name,
                                        GVariant       *state)
 {
-  Action *action;
-  GSList *node;
+  PendingChange *change;
 
-  action = find_observers (muxer, action_name);
-  for (node = action ? action->watchers : NULL; node; node = node->next)
-    gtk_action_observer_action_state_changed (node->data, GTK_ACTION_OBSERVABLE (muxer), action_name, state);
+  change = gtk_action_muxer_queue_change (muxer, action_name);
+  if (change)
+    {
+      g_clear_pointer (&change->state, g_variant_unref);
+      change->state = g_variant_ref (state);
+    }
 }
 
 static void
@@ -513,6 +762,8 @@ gtk_action_muxer_action_added (GtkActionMuxer     *muxer,
   Action *action;
   GSList *node;
 
+  gtk_action_muxer_flush_changes (muxer);
+
   action = find_observers (muxer, action_name);
   for (node = action ? action->watchers : NULL; node; node = node->next)
     gtk_action_observer_action_added (node->data,
@@ -535,6 +786,8 @@ gtk_action_muxer_action_added_to_group (GActionGroup *action_group,
 
   fullname = g_strconcat (group->prefix, ".", action_name, NULL);
 
+  gtk_action_muxer_invalidate_action (muxer, fullname);
+
    if (muxer->parent)
      gtk_action_observable_unregister_observer (GTK_ACTION_OBSERVABLE (muxer->parent),
                                                 fullname,
@@ -562,6 +815,8 @@ gtk_action_muxer_action_removed (GtkActionMuxer *muxer,
   Action *action;
   GSList *node;
 
+  gtk_action_muxer_flush_changes (muxer);
+
   action = find_observers (muxer, action_name);
   for (node = action ? action->watchers : NULL; node; node = node->next)
     gtk_action_observer_action_removed (node->data, GTK_ACTION_OBSERVABLE (muxer), action_name);
@@ -578,6 +833,7 @@ gtk_action_muxer_action_removed_from_group (GActionGroup *action_group,
   Action *action;
 
   fullname = g_strconcat (group->prefix, ".", action_name, NULL);
+  gtk_action_muxer_invalidate_action (muxer, fullname);
   gtk_action_muxer_action_removed (muxer, fullname);
   g_free (fullname);
 
@@ -753,53 +1009,41 @@ action_muxer_query_action (GtkActionMuxer      *muxer,
                            GVariant           **state,
                            gboolean             recurse)
 {
-  GtkWidgetAction *action;
-  Group *group;
-  const char *unprefixed_name;
-
-  if (muxer->widget)
-    {
-      GtkWidgetClass *klass = GTK_WIDGET_GET_CLASS (muxer->widget);
-      GtkWidgetClassPrivate *priv = klass->priv;
+  const ResolvedAction *resolved;
 
-      for (action = priv->actions; action; action = action->next)
-        {
-          guint position;
+  resolved = gtk_action_muxer_resolve (muxer, action_name);
 
-          if (strcmp (action->name, action_name) != 0)
-            continue;
+  if (resolved->widget_action)
+    {
+      GtkWidgetAction *action = resolved->widget_action;
 
-          position = get_action_position (action);
+      if (enabled)
+        *enabled = !_gtk_bitmask_get (muxer->widget_actions_disabled, resolved->position);
+      if (parameter_type)
+        *parameter_type = action->parameter_type;
+      if (state_type)
+        *state_type = action->state_type;
 
-          if (enabled)
-            *enabled = !_gtk_bitmask_get (muxer->widget_actions_disabled, position);
-          if (parameter_type)
-            *parameter_type = action->parameter_type;
-          if (state_type)
-            *state_type = action->state_type;
+      if (state_hint)
+        *state_hint = NULL;
+      if (state)
+        *state = NULL;
 
-          if (state_hint)
-            *state_hint = NULL;
+      if (action->pspec)
+        {
           if (state)
-            *state = NULL;
-
-          if (action->pspec)
-            {
-              if (state)
-                *state = prop_action_get_state (muxer->widget, action);
-              if (state_hint)
-                *state_hint = prop_action_get_state_hint (muxer->widget, action);
-            }
-
-          return TRUE;
+            *state = prop_action_get_state (muxer->widget, action);
+          if (state_hint)
+            *state_hint = prop_action_get_state_hint (muxer->widget, action);
         }
-    }
 
-  group = gtk_action_muxer_find_group (muxer, action_name, &unprefixed_name);
+      return TRUE;
+    }
 
-  if (group)
-    return g_action_group_query_action (group->group, unprefixed_name, enabled,
-                                        parameter_type, state_type, state_hint, state);
+  if (resolved->group)
+    return g_action_group_query_action (resolved->group->group,
+                                        resolved_action_get_unprefixed_name (resolved),
+                                        enabled, parameter_type, state_type, state_hint, state);
 
   if (muxer->parent && recurse)
     return gtk_action_muxer_query_action (muxer->parent, action_name,
@@ -838,44 +1082,32 @@ gtk_action_muxer_activate_action (GtkActionMuxer *muxer,
                                   const char     *action_name,
                                   GVariant       *parameter)
 {
-  const char *unprefixed_name;
-  Group *group;
+  const ResolvedAction *resolved;
 
-  if (muxer->widget)
+  resolved = gtk_action_muxer_resolve (muxer, action_name);
+
+  if (resolved->widget_action)
     {
-      GtkWidgetClass *klass = GTK_WIDGET_GET_CLASS (muxer->widget);
-      GtkWidgetClassPrivate *priv = klass->priv;
-      GtkWidgetAction *action;
+      GtkWidgetAction *action = resolved->widget_action;
 
-      for (action = priv->actions; action; action = action->next)
+      if (!_gtk_bitmask_get (muxer->widget_actions_disabled, resolved->position))
         {
-          if (strcmp (action->name, action_name) == 0)
+          if (action->activate)
+            {
+              GTK_DEBUG (ACTIONS, "%s: activate action", action->name);
+              action->activate (muxer->widget, action->name, parameter);
+            }
+          else if (action->pspec)
             {
-              guint position = get_action_position (action);
-
-              if (!_gtk_bitmask_get (muxer->widget_actions_disabled, position))
-                {
-                  if (action->activate)
-                    {
-                      GTK_DEBUG (ACTIONS, "%s: activate action", action->name);
-                      action->activate (muxer->widget, action->name, parameter);
-                    }
-                  else if (action->pspec)
-                    {
-                      GTK_DEBUG (ACTIONS, "%s: activate prop action", action->pspec->name);
-                      prop_action_activate (muxer->widget, action, parameter);
-                    }
-                }
-
-              return;
+              GTK_DEBUG (ACTIONS, "%s: activate prop action", action->pspec->name);
+              prop_action_activate (muxer->widget, action, parameter);
             }
         }
     }
-
-  group = gtk_action_muxer_find_group (muxer, action_name, &unprefixed_name);
-
-  if (group)
-    g_action_group_activate_action (group->group, unprefixed_name, parameter);
+  else if (resolved->group)
+    g_action_group_activate_action (resolved->group->group,
+                                    resolved_action_get_unprefixed_name (resolved),
+                                    parameter);
   else if (muxer->parent)
     gtk_action_muxer_activate_action (muxer->parent, action_name, parameter);
 }
@@ -885,31 +1117,19 @@ gtk_action_muxer_change_action_state (GtkActionMuxer *muxer,
                                       const char     *action_name,
                                       GVariant       *state)
 {
-  GtkWidgetAction *action;
-  const char *unprefixed_name;
-  Group *group;
-
-  if (muxer->widget)
-    {
-      GtkWidgetClass *klass = GTK_WIDGET_GET_CLASS (muxer->widget);
-      GtkWidgetClassPrivate *priv = klass->priv;
+  const ResolvedAction *resolved;
 
-      for (action = priv->actions; action; action = action->next)
-        {
-          if (strcmp (action->name, action_name) == 0)
-            {
-              if (action->pspec)
-                prop_action_set_state (muxer->widget, action, state);
+  resolved = gtk_action_muxer_resolve (muxer, action_name);
 
-              return;
-            }
-        }
+  if (resolved->widget_action)
+    {
+      if (resolved->widget_action->pspec)
+        prop_action_set_state (muxer->widget, resolved->widget_action, state);
     }
-
-  group = gtk_action_muxer_find_group (muxer, action_name, &unprefixed_name);
-
-  if (group)
-    g_action_group_change_action_state (group->group, unprefixed_name, state);
+  else if (resolved->group)
+    g_action_group_change_action_state (resolved->group->group,
+                                        resolved_action_get_unprefixed_name (resolved),
+                                        state);
   else if (muxer->parent)
     gtk_action_muxer_change_action_state (muxer->parent, action_name, state);
 }
@@ -1061,6 +1281,7 @@ gtk_action_muxer_finalize (GObject *object)
     }
   if (muxer->groups)
     g_hash_table_unref (muxer->groups);
+  g_clear_pointer (&muxer->resolved_actions, g_hash_table_unref);
 
   gtk_accels_clear (&muxer->primary_accels);
 
@@ -1080,6 +1301,11 @@ gtk_action_muxer_dispose (GObject *object)
 
   muxer->widget = NULL;
 
+  g_clear_handle_id (&muxer->pending_changes_id, g_source_remove);
+  g_clear_pointer (&muxer->pending_changes, g_hash_table_unref);
+  if (muxer->resolved_actions)
+    g_hash_table_remove_all (muxer->resolved_actions);
+
   G_OBJECT_CLASS (gtk_action_muxer_parent_class)->dispose (object);
 }
 
@@ -1190,7 +1416,7 @@ gtk_action_muxer_observer_action_enabled_changed (GtkActionObserver   *observer,
                                  NULL, NULL, NULL, NULL, NULL, FALSE))
     return;
 
-  gtk_action_muxer_action_enabled_changed (GTK_ACTION_MUXER (observer), action_name, enabled);
+  gtk_action_muxer_emit_enabled_changed (GTK_ACTION_MUXER (observer), action_name, enabled);
 }
 
 static void
@@ -1203,7 +1429,7 @@ gtk_action_muxer_observer_action_state_changed (GtkActionObserver   *observer,
                                  NULL, NULL, NULL, NULL, NULL, FALSE))
     return;
 
-  gtk_action_muxer_action_state_changed (GTK_ACTION_MUXER (observer), action_name, state);
+  gtk_action_muxer_emit_state_changed (GTK_ACTION_MUXER (observer), action_name, state);
 }
 
 static void
@@ -1290,6 +1516,7 @@ gtk_action_muxer_insert (GtkActionMuxer *muxer,
   group->prefix = g_strdup (prefix);
 
   g_hash_table_insert (muxer->groups, group->prefix, group);
+  gtk_action_muxer_invalidate_prefix (muxer, prefix);
 
   actions = g_action_group_list_actions (group->group);
   for (i = 0; actions[i]; i++)
@@ -1333,6 +1560,7 @@ gtk_action_muxer_remove (GtkActionMuxer *muxer,
       int i;
 
       g_hash_table_steal (muxer->groups, prefix);
+      gtk_action_muxer_invalidate_prefix (muxer, prefix);
 
       actions = g_action_group_list_actions (group->group);
       for (i = 0; actions[i]; i++)
@@ -1388,6 +1616,8 @@ gtk_action_muxer_set_parent (GtkActionMuxer *muxer,
   if (muxer->parent == parent)
     return;
 
+  gtk_action_muxer_flush_changes (muxer);
+
   if (muxer->parent != NULL)
     {
       notify_observers_removed (muxer, muxer->parent);
@@ -0,0 +1,696 @@
+/* GTK - The GIMP Toolkit
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkanimatedimage.h"
+
+#include "gtkprivate.h"
+#include "gdk/gdkanimationdecoderprivate.h"
+#include "gdk/gdkdecodeschedulerprivate.h"
+
+/**
+ * GtkAnimatedImage:
+ *
+ * `GtkAnimatedImage` plays animated images, such as GIF files.
+ *
+ * It is a [class@Gtk.MediaStream], so it can be displayed with
+ * [class@Gtk.Picture] or [class@Gtk.Video] and controlled with the
+ * media stream API. Images that are not animated show their only frame.
+ *
+ * Frames are decoded ahead in a thread, into a small cache, so playback
+ * does not block the main loop. Once the stream is realized, frames are
+ * advanced by the frame clock of the surface, so that a new frame shows
+ * up in the next frame that is drawn.
+ *
+ * Which formats can be played depends on the gdk-pixbuf loaders that
+ * are installed.
+ *
+ * Since: 4.16
+ */
+
+/* Frames are decoded ahead until this many are cached, or until the
+ * cached frames take up MAX_CACHE_SIZE, whatever comes first
+ */
+#define MAX_CACHED_FRAMES 16
+#define MAX_CACHE_SIZE (32 * 1024 * 1024)
+
+typedef struct _Frame Frame;
+
+struct _Frame
+{
+  GdkTexture *texture;
+  gint64 duration;
+};
+
+struct _GtkAnimatedImage
+{
+  GtkMediaStream parent_instance;
+
+  GBytes *bytes;
+  GCancellable *cancellable;
+
+  int width;
+  int height;
+
+  /* Owned by the decode task while it runs */
+  GdkAnimationDecoder *decoder;
+  guint decoding : 1;
+  guint decoder_done : 1;
+  guint restart : 1;
+  guint playing : 1;
+  guint max_frames;
+
+  GQueue frames;
+  Frame current;
+  gint64 timestamp;   /* start of the current frame, in stream time */
+  gint64 frame_end;   /* end of the current frame, in monotonic time */
+  gint64 remaining;   /* what is left of the current frame while paused */
+
+  GdkSurface *surface;
+  GdkFrameClock *frame_clock;
+  gulong update_handler;
+  guint timeout_id;
+};
+
+static void
+frame_free (gpointer data)
+{
+  Frame *frame = data;
+
+  g_object_unref (frame->texture);
+  g_free (frame);
+}
+
+static void
+gtk_animated_image_paintable_snapshot (GdkPaintable *paintable,
+                                       GdkSnapshot  *snapshot,
+                                       double        width,
+                                       double        height)
+{
+  GtkAnimatedImage *self = GTK_ANIMATED_IMAGE (paintable);
+
+  if (self->current.texture)
+    gdk_paintable_snapshot (GDK_PAINTABLE (self->current.texture), snapshot, width, height);
+}
+
+static GdkPaintable *
+gtk_animated_image_paintable_get_current_image (GdkPaintable *paintable)
+{
+  GtkAnimatedImage *self = GTK_ANIMATED_IMAGE (paintable);
+
+  if (self->current.texture)
+    return GDK_PAINTABLE (g_object_ref (self->current.texture));
+
+  return gdk_paintable_new_empty (self->width, self->height);
+}
+
+static int
+gtk_animated_image_paintable_get_intrinsic_width (GdkPaintable *paintable)
+{
+  GtkAnimatedImage *self = GTK_ANIMATED_IMAGE (paintable);
+
+  return self->width;
+}
+
+static int
+gtk_animated_image_paintable_get_intrinsic_height (GdkPaintable *paintable)
+{
+  GtkAnimatedImage *self = GTK_ANIMATED_IMAGE (paintable);
+
+  return self->height;
+}
+
+static void
+gtk_animated_image_paintable_init (GdkPaintableInterface *iface)
+{
+  iface->snapshot = gtk_animated_image_paintable_snapshot;
+  iface->get_current_image = gtk_animated_image_paintable_get_current_image;
+  iface->get_intrinsic_width = gtk_animated_image_paintable_get_intrinsic_width;
+  iface->get_intrinsic_height = gtk_animated_image_paintable_get_intrinsic_height;
+}
+
+G_DEFINE_TYPE_WITH_CODE (GtkAnimatedImage, gtk_animated_image, GTK_TYPE_MEDIA_STREAM,
+                         G_IMPLEMENT_INTERFACE (GDK_TYPE_PAINTABLE,
+                                                gtk_animated_image_paintable_init))
+
+static void gtk_animated_image_advance (GtkAnimatedImage *self,
+                                        gint64            now);
+
+static gint64
+gtk_animated_image_get_time (GtkAnimatedImage *self)
+{
+  if (self->frame_clock)
+    return gdk_frame_clock_get_frame_time (self->frame_clock);
+
+  return g_get_monotonic_time ();
+}
+
+/* {{{ Decoding */
+
+typedef struct
+{
+  GBytes *bytes;
+  GdkAnimationDecoder *decoder;
+  guint n_frames;
+  GQueue frames;
+  gboolean done;
+} DecodeData;
+
+static void
+decode_data_free (gpointer data)
+{
+  DecodeData *decode = data;
+
+  g_bytes_unref (decode->bytes);
+  g_clear_pointer (&decode->decoder, gdk_animation_decoder_free);
+  g_queue_clear_full (&decode->frames, frame_free);
+  g_free (decode);
+}
+
+static void
+gtk_animated_image_decode_thread (GTask        *task,
+                                  gpointer      source_object,
+                                  gpointer      task_data,
+                                  GCancellable *cancellable)
+{
+  DecodeData *decode = task_data;
+  GError *error = NULL;
+  guint i;
+
+  if (decode->decoder == NULL)
+    {
+      decode->decoder = gdk_animation_decoder_new (decode->bytes, &error);
+      if (decode->decoder == NULL)
+        {
+          g_task_return_error (task, error);
+          return;
+        }
+    }
+
+  for (i = 0; i < decode->n_frames; i++)
+    {
+      Frame *frame;
+
+      if (g_task_return_error_if_cancelled (task))
+        return;
+
+      frame = g_new (Frame, 1);
+      if (!gdk_animation_decoder_next_frame (decode->decoder, &frame->texture, &frame->duration, &error))
+        {
+          g_free (frame);
+
+          if (error)
+            {
+              g_task_return_error (task, error);
+              return;
+            }
+
+          decode->done = TRUE;
+          break;
+        }
+
+      g_queue_push_tail (&decode->frames, frame);
+
+      if (frame->duration < 0)
+        {
+          decode->done = TRUE;
+          break;
+        }
+    }
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void gtk_animated_image_decode_done (GObject      *source,
+                                            GAsyncResult *result,
+                                            gpointer      data);
+
+static void
+gtk_animated_image_queue_decode (GtkAnimatedImage *self)
+{
+  DecodeData *decode;
+  GTask *task;
+  guint n_cached;
+
+  if (self->bytes == NULL || self->decoding || self->decoder_done)
+    return;
+
+  /* Refill when half of the cache has been used up. Before the size
+   * is known, only decode the first frame, to show it quickly.
+   */
+  n_cached = g_queue_get_length (&self->frames);
+  if (self->max_frames > 0 && n_cached > self->max_frames / 2)
+    return;
+
+  decode = g_new0 (DecodeData, 1);
+  decode->bytes = g_bytes_ref (self->bytes);
+  decode->decoder = g_steal_pointer (&self->decoder);
+  decode->n_frames = self->max_frames > 0 ? self->max_frames - n_cached : 1;
+
+  task = g_task_new (self, self->cancellable, gtk_animated_image_decode_done, NULL);
+  g_task_set_source_tag (task, gtk_animated_image_queue_decode);
+  g_task_set_task_data (task, decode, decode_data_free);
+
+  self->decoding = TRUE;
+  gdk_decode_scheduler_run (task, gtk_animated_image_decode_thread);
+
+  g_object_unref (task);
+}
+
+static gboolean
+gtk_animated_image_next_frame (GtkAnimatedImage *self)
+{
+  Frame *frame;
+
+  frame = g_queue_pop_head (&self->frames);
+  if (frame == NULL)
+    return FALSE;
+
+  if (self->restart)
+    {
+      self->timestamp = 0;
+      self->restart = FALSE;
+    }
+  else if (self->current.texture)
+    {
+      self->timestamp += self->current.duration;
+    }
+
+  g_clear_object (&self->current.texture);
+  self->current = *frame;
+  g_free (frame);
+
+  gtk_animated_image_queue_decode (self);
+
+  return TRUE;
+}
+
+static void
+gtk_animated_image_decode_done (GObject      *source,
+                                GAsyncResult *result,
+                                gpointer      data)
+{
+  GtkAnimatedImage *self = GTK_ANIMATED_IMAGE (source);
+  GtkMediaStream *stream = GTK_MEDIA_STREAM (self);
+  DecodeData *decode = g_task_get_task_data (G_TASK (result));
+  GError *error = NULL;
+
+  if (!g_task_propagate_boolean (G_TASK (result), &error))
+    {
+      if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_error_free (error);
+      else
+        {
+          self->decoding = FALSE;
+          gtk_media_stream_gerror (stream, error);
+        }
+      return;
+    }
+
+  self->decoding = FALSE;
+  self->decoder = g_steal_pointer (&decode->decoder);
+  self->decoder_done = decode->done;
+  while (!g_queue_is_empty (&decode->frames))
+    g_queue_push_tail (&self->frames, g_queue_pop_head (&decode->frames));
+
+  if (!gtk_media_stream_is_prepared (stream))
+    {
+      gsize frame_size;
+
+      self->width = self->decoder->width;
+      self->height = self->decoder->height;
+
+      frame_size = MAX ((gsize) self->width * self->height * 4, 1);
+      self->max_frames = CLAMP (MAX_CACHE_SIZE / frame_size, 2, MAX_CACHED_FRAMES);
+
+      gtk_media_stream_stream_prepared (stream, FALSE, TRUE, FALSE, 0);
+      gdk_paintable_invalidate_size (GDK_PAINTABLE (self));
+    }
+
+  if (self->current.texture == NULL || self->restart)
+    {
+      if (gtk_animated_image_next_frame (self))
+        {
+          self->remaining = MAX (self->current.duration, 0);
+          self->frame_end = gtk_animated_image_get_time (self) + self->remaining;
+
+          gdk_paintable_invalidate_contents (GDK_PAINTABLE (self));
+          gtk_media_stream_update (stream, self->timestamp);
+        }
+    }
+
+  /* Catch up if playback was waiting for frames */
+  if (self->playing)
+    gtk_animated_image_advance (self, gtk_animated_image_get_time (self));
+  else
+    gtk_animated_image_queue_decode (self);
+}
+
+/* }}} */
+/* {{{ Playback */
+
+static void
+gtk_animated_image_update_cb (GdkFrameClock    *clock,
+                              GtkAnimatedImage *self)
+{
+  gtk_animated_image_advance (self, gdk_frame_clock_get_frame_time (clock));
+}
+
+static gboolean
+gtk_animated_image_timeout_cb (gpointer data)
+{
+  GtkAnimatedImage *self = data;
+
+  self->timeout_id = 0;
+  gtk_animated_image_advance (self, g_get_monotonic_time ());
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gtk_animated_image_stop_updates (GtkAnimatedImage *self)
+{
+  g_clear_handle_id (&self->timeout_id, g_source_remove);
+
+  if (self->update_handler)
+    {
+      g_clear_signal_handler (&self->update_handler, self->frame_clock);
+      gdk_frame_clock_end_updating (self->frame_clock);
+    }
+}
+
+static void
+gtk_animated_image_schedule (GtkAnimatedImage *self)
+{
+  gint64 delay;
+
+  if (!self->playing ||
+      self->current.texture == NULL ||
+      self->current.duration < 0)
+    {
+      gtk_animated_image_stop_updates (self);
+      return;
+    }
+
+  if (self->frame_clock)
+    {
+      if (self->update_handler == 0)
+        {
+          self->update_handler = g_signal_connect (self->frame_clock, "update",
+                                                   G_CALLBACK (gtk_animated_image_update_cb), self);
+          gdk_frame_clock_begin_updating (self->frame_clock);
+        }
+      return;
+    }
+
+  /* Not shown in any surface, so there is no frame clock to follow */
+  g_clear_handle_id (&self->timeout_id, g_source_remove);
+  delay = MAX (self->frame_end - g_get_monotonic_time (), 0);
+  self->timeout_id = g_timeout_add ((delay + 999) / 1000, gtk_animated_image_timeout_cb, self);
+  gdk_source_set_static_name_by_id (self->timeout_id, "[gtk] gtk_animated_image_timeout_cb");
+}
+
+static void
+gtk_animated_image_restart (GtkAnimatedImage *self)
+{
+  g_assert (!self->decoding);
+
+  g_clear_pointer (&self->decoder, gdk_animation_decoder_free);
+  g_queue_clear_full (&self->frames, frame_free);
+  self->decoder_done = FALSE;
+  self->restart = TRUE;
+
+  gtk_animated_image_queue_decode (self);
+}
+
+static void
+gtk_animated_image_advance (GtkAnimatedImage *self,
+                            gint64            now)
+{
+  GtkMediaStream *stream = GTK_MEDIA_STREAM (self);
+  gboolean changed = FALSE;
+
+  /* Don't race through the cached frames after a long stall */
+  if (now - self->frame_end > G_USEC_PER_SEC)
+    self->frame_end = now;
+
+  while (self->current.texture &&
+         self->current.duration >= 0 &&
+         now >= self->frame_end)
+    {
+      /* Either decoding fell behind, and this frame stays until the
+       * next one arrives, or everything has been played
+       */
+      if (!gtk_animated_image_next_frame (self))
+        break;
+
+      self->frame_end += MAX (self->current.duration, 0);
+      changed = TRUE;
+    }
+
+  if (changed)
+    {
+      gdk_paintable_invalidate_contents (GDK_PAINTABLE (self));
+      gtk_media_stream_update (stream, self->timestamp);
+    }
+
+  if (self->current.texture &&
+      self->decoder_done &&
+      g_queue_is_empty (&self->frames) &&
+      (self->current.duration < 0 || now >= self->frame_end))
+    {
+      /* An image that isn't animated has nothing to loop */
+      if (gtk_media_stream_get_loop (stream) && self->timestamp > 0)
+        {
+          self->frame_end = now + MAX (self->current.duration, 0);
+          gtk_animated_image_restart (self);
+        }
+      else
+        {
+          gtk_media_stream_stream_ended (stream);
+          return;
+        }
+    }
+
+  gtk_animated_image_schedule (self);
+}
+
+static gboolean
+gtk_animated_image_play (GtkMediaStream *stream)
+{
+  GtkAnimatedImage *self = GTK_ANIMATED_IMAGE (stream);
+
+  self->playing = TRUE;
+
+  if (gtk_media_stream_get_ended (stream))
+    {
+      self->remaining = 0;
+      gtk_animated_image_restart (self);
+    }
+
+  self->frame_end = gtk_animated_image_get_time (self) + self->remaining;
+  gtk_animated_image_schedule (self);
+
+  return TRUE;
+}
+
+static void
+gtk_animated_image_pause (GtkMediaStream *stream)
+{
+  GtkAnimatedImage *self = GTK_ANIMATED_IMAGE (stream);
+
+  self->playing = FALSE;
+  self->remaining = MAX (self->frame_end - gtk_animated_image_get_time (self), 0);
+
+  gtk_animated_image_stop_updates (self);
+}
+
+static void
+gtk_animated_image_realize (GtkMediaStream *stream,
+                            GdkSurface     *surface)
+{
+  GtkAnimatedImage *self = GTK_ANIMATED_IMAGE (stream);
+
+  /* Follow the first surface. When shown in more than one,
+   * the others see the same frames anyway.
+   */
+  if (self->surface)
+    return;
+
+  gtk_animated_image_stop_updates (self);
+
+  self->surface = g_object_ref (surface);
+  self->frame_clock = g_object_ref (gdk_surface_get_frame_clock (surface));
+
+  gtk_animated_image_schedule (self);
+}
+
+static void
+gtk_animated_image_unrealize (GtkMediaStream *stream,
+                              GdkSurface     *surface)
+{
+  GtkAnimatedImage *self = GTK_ANIMATED_IMAGE (stream);
+
+  if (self->surface != surface)
+    return;
+
+  gtk_animated_image_stop_updates (self);
+
+  g_clear_object (&self->frame_clock);
+  g_clear_object (&self->surface);
+
+  gtk_animated_image_schedule (self);
+}
+
+/* }}} */
+
+static void
+gtk_animated_image_dispose (GObject *object)
+{
+  GtkAnimatedImage *self = GTK_ANIMATED_IMAGE (object);
+
+  g_cancellable_cancel (self->cancellable);
+
+  gtk_animated_image_stop_updates (self);
+  g_clear_object (&self->frame_clock);
+  g_clear_object (&self->surface);
+
+  g_clear_pointer (&self->decoder, gdk_animation_decoder_free);
+  g_queue_clear_full (&self->frames, frame_free);
+  g_clear_object (&self->current.texture);
+  g_clear_pointer (&self->bytes, g_bytes_unref);
+
+  G_OBJECT_CLASS (gtk_animated_image_parent_class)->dispose (object);
+}
+
+static void
+gtk_animated_image_finalize (GObject *object)
+{
+  GtkAnimatedImage *self = GTK_ANIMATED_IMAGE (object);
+
+  g_object_unref (self->cancellable);
+
+  G_OBJECT_CLASS (gtk_animated_image_parent_class)->finalize (object);
+}
+
+static void
+gtk_animated_image_class_init (GtkAnimatedImageClass *klass)
+{
+  GtkMediaStreamClass *stream_class = GTK_MEDIA_STREAM_CLASS (klass);
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  stream_class->play = gtk_animated_image_play;
+  stream_class->pause = gtk_animated_image_pause;
+  stream_class->realize = gtk_animated_image_realize;
+  stream_class->unrealize = gtk_animated_image_unrealize;
+
+  gobject_class->dispose = gtk_animated_image_dispose;
+  gobject_class->finalize = gtk_animated_image_finalize;
+}
+
+static void
+gtk_animated_image_init (GtkAnimatedImage *self)
+{
+  self->cancellable = g_cancellable_new ();
+  g_queue_init (&self->frames);
+}
+
+/**
+ * gtk_animated_image_new_for_bytes:
+ * @bytes: the data of the image
+ *
+ * Creates a new media stream that plays the animated image in @bytes.
+ *
+ * Decoding happens in a thread. If the data can't be decoded, the
+ * stream reports the error with [method@Gtk.MediaStream.get_error].
+ *
+ * Returns: (transfer full) (type GtkAnimatedImage): a new `GtkAnimatedImage`
+ *
+ * Since: 4.16
+ */
+GtkMediaStream *
+gtk_animated_image_new_for_bytes (GBytes *bytes)
+{
+  GtkAnimatedImage *self;
+
+  g_return_val_if_fail (bytes != NULL, NULL);
+
+  self = g_object_new (GTK_TYPE_ANIMATED_IMAGE, NULL);
+  self->bytes = g_bytes_ref (bytes);
+
+  gtk_animated_image_queue_decode (self);
+
+  return GTK_MEDIA_STREAM (self);
+}
+
+static void
+gtk_animated_image_file_loaded (GObject      *source,
+                                GAsyncResult *result,
+                                gpointer      data)
+{
+  GtkAnimatedImage *self = data;
+  GError *error = NULL;
+  GBytes *bytes;
+
+  bytes = g_file_load_bytes_finish (G_FILE (source), result, NULL, &error);
+  if (bytes == NULL)
+    {
+      if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_error_free (error);
+      else
+        gtk_media_stream_gerror (GTK_MEDIA_STREAM (self), error);
+    }
+  else
+    {
+      self->bytes = bytes;
+      gtk_animated_image_queue_decode (self);
+    }
+
+  g_object_unref (self);
+}
+
+/**
+ * gtk_animated_image_new_for_file:
+ * @file: the file to play
+ *
+ * Creates a new media stream that plays the animated image in @file.
+ *
+ * The file is loaded and decoded asynchronously. Errors are reported
+ * with [method@Gtk.MediaStream.get_error].
+ *
+ * Returns: (transfer full) (type GtkAnimatedImage): a new `GtkAnimatedImage`
+ *
+ * Since: 4.16
+ */
+GtkMediaStream *
+gtk_animated_image_new_for_file (GFile *file)
+{
+  GtkAnimatedImage *self;
+
+  g_return_val_if_fail (G_IS_FILE (file), NULL);
+
+  self = g_object_new (GTK_TYPE_ANIMATED_IMAGE, NULL);
+
+  g_file_load_bytes_async (file,
+                           self->cancellable,
+                           gtk_animated_image_file_loaded,
+                           g_object_ref (self));
+
+  return GTK_MEDIA_STREAM (self);
+}
+
+/* vim:set foldmethod=marker expandtab: */
@@ -0,0 +1,37 @@
+/* GTK - The GIMP Toolkit
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#if !defined (__GTK_H_INSIDE__) && !defined (GTK_COMPILATION)
+#error "Only <gtk/gtk.h> can be included directly."
+#endif
+
+#include <gtk/gtkmediastream.h>
+
+G_BEGIN_DECLS
+
+#define GTK_TYPE_ANIMATED_IMAGE (gtk_animated_image_get_type ())
+
+GDK_AVAILABLE_IN_4_16
+G_DECLARE_FINAL_TYPE (GtkAnimatedImage, gtk_animated_image, GTK, ANIMATED_IMAGE, GtkMediaStream)
+
+GDK_AVAILABLE_IN_4_16
+GtkMediaStream *        gtk_animated_image_new_for_bytes        (GBytes                 *bytes);
+GDK_AVAILABLE_IN_4_16
+GtkMediaStream *        gtk_animated_image_new_for_file         (GFile                  *file);
+
+G_END_DECLS
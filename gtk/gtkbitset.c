@@ -113,6 +113,32 @@ gtk_bitset_contains (const GtkBitset *self,
   return roaring_bitmap_contains (&self->roaring, value);
 }
 
+/**
+ * gtk_bitset_contains_range:
+ * @self: a `GtkBitset`
+ * @first: the first value to check
+ * @n_items: the number of consecutive values to check
+ *
+ * Checks if all of the @n_items values starting at @first have been
+ * added to @self.
+ *
+ * This is a lot faster than checking every value on its own.
+ *
+ * Returns: %TRUE if @self contains all the values. An empty range is
+ *   always contained.
+ *
+ * Since: 4.16
+ **/
+gboolean
+gtk_bitset_contains_range (const GtkBitset *self,
+                           guint            first,
+                           guint            n_items)
+{
+  g_return_val_if_fail (self != NULL, FALSE);
+
+  return roaring_bitmap_contains_range (&self->roaring, first, (uint64_t) first + n_items);
+}
+
 /**
  * gtk_bitset_is_empty:
  * @self: a `GtkBitset`
@@ -908,6 +934,86 @@ gtk_bitset_iter_next (GtkBitsetIter *iter,
   return TRUE;
 }
 
+/**
+ * gtk_bitset_iter_next_run:
+ * @iter: a pointer to a `GtkBitsetIter`
+ * @first: (out) (optional): Set to the first value of the run
+ * @n_items: (out) (optional): Set to the number of values in the run
+ *
+ * Gets the run of consecutive values that starts at the current value
+ * of @iter and moves @iter to the first value after that run.
+ *
+ * This allows handling the values of a set one range at a time:
+ *
+ * ```c
+ * GtkBitsetIter iter;
+ * guint first, n_items;
+ *
+ * gtk_bitset_iter_init_first (&iter, set, NULL);
+ * while (gtk_bitset_iter_next_run (&iter, &first, &n_items))
+ *   do_something (first, n_items);
+ * ```
+ *
+ * If @iter is not valid, %FALSE is returned and @first and @n_items
+ * are set to 0.
+ *
+ * Returns: %TRUE if @iter was valid and a run was returned
+ *
+ * Since: 4.16
+ **/
+gboolean
+gtk_bitset_iter_next_run (GtkBitsetIter *iter,
+                          guint         *first,
+                          guint         *n_items)
+{
+  roaring_uint32_iterator_t *riter = (roaring_uint32_iterator_t *) iter;
+  const guint64 limit = ((guint64) G_MAXUINT) + 1;
+  guint64 start, end, step;
+
+  g_return_val_if_fail (iter != NULL, FALSE);
+
+  if (!riter->has_value)
+    {
+      if (first)
+        *first = 0;
+      if (n_items)
+        *n_items = 0;
+      return FALSE;
+    }
+
+  /* The run is [start, end). Grow it exponentially, then bisect
+   * the remaining step, so long runs cost O(log n) range checks
+   * that work on whole containers at once. */
+  start = riter->current_value;
+  end = start + 1;
+  step = 1;
+  while (end < limit &&
+         roaring_bitmap_contains_range (riter->parent, end, MIN (end + step, limit)))
+    {
+      end = MIN (end + step, limit);
+      step *= 2;
+    }
+  while (step > 1)
+    {
+      step /= 2;
+      if (end < limit &&
+          roaring_bitmap_contains_range (riter->parent, end, MIN (end + step, limit)))
+        end = MIN (end + step, limit);
+    }
+
+  if (first)
+    *first = start;
+  if (n_items)
+    *n_items = end - start;
+
+  if (end < limit)
+    roaring_move_uint32_iterator_equalorlarger (riter, end);
+  else
+    riter->has_value = FALSE;
+
+  return TRUE;
+}
+
 /**
  * gtk_bitset_iter_previous:
  * @iter: a pointer to a valid `GtkBitsetIter`
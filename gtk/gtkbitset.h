@@ -42,6 +42,10 @@ G_DEFINE_AUTOPTR_CLEANUP_FUNC(GtkBitset, gtk_bitset_unref)
 GDK_AVAILABLE_IN_ALL
 gboolean                gtk_bitset_contains                     (const GtkBitset        *self,
                                                                  guint                   value);
+GDK_AVAILABLE_IN_4_16
+gboolean                gtk_bitset_contains_range               (const GtkBitset        *self,
+                                                                 guint                   first,
+                                                                 guint                   n_items);
 GDK_AVAILABLE_IN_ALL
 gboolean                gtk_bitset_is_empty                     (const GtkBitset        *self);
 GDK_AVAILABLE_IN_ALL
@@ -167,6 +171,10 @@ gboolean                gtk_bitset_iter_init_at                 (GtkBitsetIter
 GDK_AVAILABLE_IN_ALL
 gboolean                gtk_bitset_iter_next                    (GtkBitsetIter          *iter,
                                                                  guint                  *value);
+GDK_AVAILABLE_IN_4_16
+gboolean                gtk_bitset_iter_next_run                (GtkBitsetIter          *iter,
+                                                                 guint                  *first,
+                                                                 guint                  *n_items);
 GDK_AVAILABLE_IN_ALL
 gboolean                gtk_bitset_iter_previous                (GtkBitsetIter          *iter,
                                                                  guint                  *value);
@@ -666,6 +666,137 @@ object_properties_get_value (const ObjectProperties *self,
   return &g_array_index (self->values, GValue, idx);
 }
 
+/* Templates are instantiated once per instance of their class, always
+ * with the same property values. So the values of properties that are
+ * converted from their string form without looking at the builder's
+ * state are kept in a per-template-type cache and copied for later
+ * instances.
+ */
+typedef struct
+{
+  GParamSpec *pspec;
+  char *string;
+  GValue value;
+} CachedValue;
+
+static guint
+cached_value_hash (gconstpointer data)
+{
+  const CachedValue *cached = data;
+
+  return g_direct_hash (cached->pspec) ^ g_str_hash (cached->string);
+}
+
+static gboolean
+cached_value_equal (gconstpointer a,
+                    gconstpointer b)
+{
+  const CachedValue *ca = a;
+  const CachedValue *cb = b;
+
+  return ca->pspec == cb->pspec && strcmp (ca->string, cb->string) == 0;
+}
+
+static void
+cached_value_free (gpointer data)
+{
+  CachedValue *cached = data;
+
+  g_value_unset (&cached->value);
+  g_free (cached->string);
+  g_free (cached);
+}
+
+static gboolean
+value_is_cacheable (GParamSpec *pspec)
+{
+  switch (G_TYPE_FUNDAMENTAL (G_PARAM_SPEC_VALUE_TYPE (pspec)))
+    {
+    case G_TYPE_CHAR:
+    case G_TYPE_UCHAR:
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_INT:
+    case G_TYPE_UINT:
+    case G_TYPE_LONG:
+    case G_TYPE_ULONG:
+    case G_TYPE_INT64:
+    case G_TYPE_UINT64:
+    case G_TYPE_ENUM:
+    case G_TYPE_FLAGS:
+    case G_TYPE_FLOAT:
+    case G_TYPE_DOUBLE:
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
+static GHashTable *
+gtk_builder_get_value_cache (GtkBuilder *builder)
+{
+  GtkBuilderPrivate *priv = gtk_builder_get_instance_private (builder);
+  static GQuark quark = 0;
+  GHashTable *cache;
+
+  if (priv->template_type == 0)
+    return NULL;
+
+  if (G_UNLIKELY (quark == 0))
+    quark = g_quark_from_static_string ("gtk-builder-value-cache");
+
+  cache = g_type_get_qdata (priv->template_type, quark);
+  if (cache == NULL)
+    {
+      cache = g_hash_table_new_full (cached_value_hash, cached_value_equal,
+                                     cached_value_free, NULL);
+      g_type_set_qdata (priv->template_type, quark, cache);
+    }
+
+  return cache;
+}
+
+static gboolean
+gtk_builder_value_from_string_cached (GtkBuilder  *builder,
+                                      GParamSpec  *pspec,
+                                      const char  *string,
+                                      GValue      *value,
+                                      GError     **error)
+{
+  GHashTable *cache;
+  CachedValue lookup, *cached;
+
+  if (!value_is_cacheable (pspec))
+    return gtk_builder_value_from_string (builder, pspec, string, value, error);
+
+  cache = gtk_builder_get_value_cache (builder);
+  if (cache == NULL)
+    return gtk_builder_value_from_string (builder, pspec, string, value, error);
+
+  lookup.pspec = pspec;
+  lookup.string = (char *) string;
+  cached = g_hash_table_lookup (cache, &lookup);
+  if (cached == NULL)
+    {
+      if (!gtk_builder_value_from_string (builder, pspec, string, value, error))
+        return FALSE;
+
+      cached = g_new0 (CachedValue, 1);
+      cached->pspec = pspec;
+      cached->string = g_strdup (string);
+      g_value_init (&cached->value, G_VALUE_TYPE (value));
+      g_value_copy (value, &cached->value);
+      g_hash_table_add (cache, cached);
+
+      return TRUE;
+    }
+
+  g_value_init (value, G_VALUE_TYPE (&cached->value));
+  g_value_copy (&cached->value, value);
+
+  return TRUE;
+}
+
 static void
 gtk_builder_get_parameters (GtkBuilder         *builder,
                             GType               object_type,
@@ -756,10 +887,10 @@ gtk_builder_get_parameters (GtkBuilder         *builder,
               continue;
             }
         }
-      else if (!gtk_builder_value_from_string (builder, prop->pspec,
-                                               prop->text->str,
-                                               &property_value,
-                                               &error))
+      else if (!gtk_builder_value_from_string_cached (builder, prop->pspec,
+                                                      prop->text->str,
+                                                      &property_value,
+                                                      &error))
         {
           g_warning ("Failed to set property %s.%s to %s: %s",
                      g_type_name (object_type), prop->pspec->name, prop->text->str,
@@ -1725,6 +1856,296 @@ gtk_builder_add_objects_from_resource (GtkBuilder   *builder,
   return TRUE;
 }
 
+typedef struct
+{
+  char *filename;
+  char *resource_path;
+  GBytes *data;
+} AsyncLoad;
+
+static void
+async_load_free (gpointer data)
+{
+  AsyncLoad *load = data;
+
+  g_free (load->filename);
+  g_free (load->resource_path);
+  g_clear_pointer (&load->data, g_bytes_unref);
+  g_free (load);
+}
+
+/* Runs in a worker thread, so it must not touch the builder. Reading
+ * the data and tokenizing the markup into the precompiled format is
+ * done here, creating the objects is left to the main thread.
+ */
+static void
+async_load_thread (GTask        *task,
+                   gpointer      source_object,
+                   gpointer      task_data,
+                   GCancellable *cancellable)
+{
+  AsyncLoad *load = task_data;
+  GError *error = NULL;
+  GBytes *data;
+
+  if (load->filename)
+    {
+      char *buffer;
+      gsize length;
+
+      if (!g_file_get_contents (load->filename, &buffer, &length, &error))
+        {
+          g_task_return_error (task, error);
+          return;
+        }
+
+      data = g_bytes_new_take (buffer, length);
+    }
+  else
+    {
+      data = g_resources_lookup_data (load->resource_path, 0, &error);
+      if (data == NULL)
+        {
+          g_task_return_error (task, error);
+          return;
+        }
+    }
+
+  if (!_gtk_buildable_parser_is_precompiled (g_bytes_get_data (data, NULL),
+                                             g_bytes_get_size (data)))
+    {
+      GBytes *precompiled;
+
+      /* Broken markup is passed on as is, so that the error is
+       * reported the same way as by the synchronous functions
+       */
+      precompiled = _gtk_buildable_parser_precompile (g_bytes_get_data (data, NULL),
+                                                      g_bytes_get_size (data),
+                                                      NULL);
+      if (precompiled)
+        {
+          g_bytes_unref (data);
+          data = precompiled;
+        }
+    }
+
+  load->data = data;
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+async_load_done (GObject      *source,
+                 GAsyncResult *result,
+                 gpointer      user_data)
+{
+  GtkBuilder *builder = GTK_BUILDER (source);
+  GtkBuilderPrivate *priv = gtk_builder_get_instance_private (builder);
+  GTask *task = user_data;
+  AsyncLoad *load = g_task_get_task_data (G_TASK (result));
+  GError *error = NULL;
+  char *filename_for_errors;
+
+  if (!g_task_propagate_boolean (G_TASK (result), &error))
+    {
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      return;
+    }
+
+  if (g_task_return_error_if_cancelled (task))
+    {
+      g_object_unref (task);
+      return;
+    }
+
+  g_free (priv->filename);
+  g_free (priv->resource_prefix);
+
+  if (load->filename)
+    {
+      priv->filename = g_strdup (load->filename);
+      priv->resource_prefix = NULL;
+      filename_for_errors = g_strdup (load->filename);
+    }
+  else
+    {
+      const char *slash;
+
+      priv->filename = g_strdup (".");
+
+      slash = strrchr (load->resource_path, '/');
+      if (slash != NULL)
+        priv->resource_prefix = g_strndup (load->resource_path, slash - load->resource_path + 1);
+      else
+        priv->resource_prefix = g_strdup ("/");
+
+      filename_for_errors = g_strconcat ("<resource>", load->resource_path, NULL);
+    }
+
+  _gtk_builder_parser_parse_buffer (builder, filename_for_errors,
+                                    g_bytes_get_data (load->data, NULL),
+                                    g_bytes_get_size (load->data),
+                                    NULL,
+                                    &error);
+  g_free (filename_for_errors);
+
+  if (error)
+    g_task_return_error (task, error);
+  else
+    g_task_return_boolean (task, TRUE);
+
+  g_object_unref (task);
+}
+
+static void
+gtk_builder_add_async (GtkBuilder          *builder,
+                       AsyncLoad           *load,
+                       gpointer             source_tag,
+                       GCancellable        *cancellable,
+                       GAsyncReadyCallback  callback,
+                       gpointer             user_data)
+{
+  GTask *task, *load_task;
+
+  task = g_task_new (builder, cancellable, callback, user_data);
+  g_task_set_source_tag (task, source_tag);
+
+  load_task = g_task_new (builder, cancellable, async_load_done, task);
+  g_task_set_task_data (load_task, load, async_load_free);
+  g_task_run_in_thread (load_task, async_load_thread);
+  g_object_unref (load_task);
+}
+
+/**
+ * gtk_builder_add_from_file_async:
+ * @builder: a `GtkBuilder`
+ * @filename: (type filename): the name of the file to parse
+ * @cancellable: (nullable): a `GCancellable` to cancel the operation
+ * @callback: (scope async) (closure user_data): a callback to call when
+ *   the operation is complete
+ * @user_data: data to pass to @callback
+ *
+ * Asynchronously parses a file containing a UI definition and merges
+ * it with the current contents of @builder.
+ *
+ * Reading and parsing the file happens in a separate thread. The objects
+ * are created and their signals connected in the thread-default main
+ * context of the caller, right before @callback is called.
+ *
+ * Since: 4.16
+ */
+void
+gtk_builder_add_from_file_async (GtkBuilder          *builder,
+                                 const char          *filename,
+                                 GCancellable        *cancellable,
+                                 GAsyncReadyCallback  callback,
+                                 gpointer             user_data)
+{
+  AsyncLoad *load;
+
+  g_return_if_fail (GTK_IS_BUILDER (builder));
+  g_return_if_fail (filename != NULL);
+  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+  load = g_new0 (AsyncLoad, 1);
+  load->filename = g_strdup (filename);
+
+  gtk_builder_add_async (builder, load, gtk_builder_add_from_file_async,
+                         cancellable, callback, user_data);
+}
+
+/**
+ * gtk_builder_add_from_file_finish:
+ * @builder: a `GtkBuilder`
+ * @result: a `GAsyncResult`
+ * @error: (nullable): return location for an error
+ *
+ * Finishes the [method@Gtk.Builder.add_from_file_async] call.
+ *
+ * See [method@Gtk.Builder.add_from_file] for the errors that can
+ * be returned.
+ *
+ * Returns: %TRUE on success, %FALSE if an error occurred
+ *
+ * Since: 4.16
+ */
+gboolean
+gtk_builder_add_from_file_finish (GtkBuilder    *builder,
+                                  GAsyncResult  *result,
+                                  GError       **error)
+{
+  g_return_val_if_fail (GTK_IS_BUILDER (builder), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, builder), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == gtk_builder_add_from_file_async, FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+/**
+ * gtk_builder_add_from_resource_async:
+ * @builder: a `GtkBuilder`
+ * @resource_path: the path of the resource file to parse
+ * @cancellable: (nullable): a `GCancellable` to cancel the operation
+ * @callback: (scope async) (closure user_data): a callback to call when
+ *   the operation is complete
+ * @user_data: data to pass to @callback
+ *
+ * Asynchronously parses a resource file containing a UI definition
+ * and merges it with the current contents of @builder.
+ *
+ * Parsing the resource happens in a separate thread. The objects are
+ * created and their signals connected in the thread-default main
+ * context of the caller, right before @callback is called.
+ *
+ * Since: 4.16
+ */
+void
+gtk_builder_add_from_resource_async (GtkBuilder          *builder,
+                                     const char          *resource_path,
+                                     GCancellable        *cancellable,
+                                     GAsyncReadyCallback  callback,
+                                     gpointer             user_data)
+{
+  AsyncLoad *load;
+
+  g_return_if_fail (GTK_IS_BUILDER (builder));
+  g_return_if_fail (resource_path != NULL);
+  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+  load = g_new0 (AsyncLoad, 1);
+  load->resource_path = g_strdup (resource_path);
+
+  gtk_builder_add_async (builder, load, gtk_builder_add_from_resource_async,
+                         cancellable, callback, user_data);
+}
+
+/**
+ * gtk_builder_add_from_resource_finish:
+ * @builder: a `GtkBuilder`
+ * @result: a `GAsyncResult`
+ * @error: (nullable): return location for an error
+ *
+ * Finishes the [method@Gtk.Builder.add_from_resource_async] call.
+ *
+ * See [method@Gtk.Builder.add_from_resource] for the errors that can
+ * be returned.
+ *
+ * Returns: %TRUE on success, %FALSE if an error occurred
+ *
+ * Since: 4.16
+ */
+gboolean
+gtk_builder_add_from_resource_finish (GtkBuilder    *builder,
+                                      GAsyncResult  *result,
+                                      GError       **error)
+{
+  g_return_val_if_fail (GTK_IS_BUILDER (builder), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, builder), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == gtk_builder_add_from_resource_async, FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
 /**
  * gtk_builder_add_from_string:
  * @builder: a `GtkBuilder`
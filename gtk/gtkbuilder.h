@@ -126,6 +126,26 @@ gboolean     gtk_builder_add_objects_from_string (GtkBuilder    *builder,
                                                   gssize         length,
                                                   const char   **object_ids,
                                                   GError       **error);
+GDK_AVAILABLE_IN_4_16
+void         gtk_builder_add_from_file_async     (GtkBuilder          *builder,
+                                                  const char          *filename,
+                                                  GCancellable        *cancellable,
+                                                  GAsyncReadyCallback  callback,
+                                                  gpointer             user_data);
+GDK_AVAILABLE_IN_4_16
+gboolean     gtk_builder_add_from_file_finish    (GtkBuilder          *builder,
+                                                  GAsyncResult        *result,
+                                                  GError             **error);
+GDK_AVAILABLE_IN_4_16
+void         gtk_builder_add_from_resource_async (GtkBuilder          *builder,
+                                                  const char          *resource_path,
+                                                  GCancellable        *cancellable,
+                                                  GAsyncReadyCallback  callback,
+                                                  gpointer             user_data);
+GDK_AVAILABLE_IN_4_16
+gboolean     gtk_builder_add_from_resource_finish(GtkBuilder          *builder,
+                                                  GAsyncResult        *result,
+                                                  GError             **error);
 GDK_AVAILABLE_IN_ALL
 GObject*     gtk_builder_get_object              (GtkBuilder    *builder,
                                                   const char    *name);
@@ -178,6 +178,207 @@ gtk_buildable_parse_context_free (GtkBuildableParseContext *context)
   g_ptr_array_unref (context->tag_stack);
 }
 
+/*****************************************  Replay GMarkup parser callbacks ***************************/
+
+static guint32
+demarshal_uint32 (const char **tree)
+{
+  const guchar *p = (const guchar *)*tree;
+  guchar c = *p;
+  /* see marshal_uint32 for format */
+
+  if (c < 128) /* 7 bit */
+    {
+      *tree += 1;
+      return c;
+    }
+  else if ((c & 0xc0) == 0x80) /* 14 bit */
+    {
+      *tree += 2;
+      return (c & 0x3f) << 8 | p[1];
+    }
+  else if ((c & 0xe0) == 0xc0) /* 21 bit */
+    {
+      *tree += 3;
+      return (c & 0x1f) << 16 | p[1] << 8 | p[2];
+    }
+  else if ((c & 0xf0) == 0xe0) /* 28 bit */
+    {
+      *tree += 4;
+      return (c & 0xf) << 24 | p[1] << 16 | p[2] << 8 | p[3];
+    }
+  else
+    {
+      *tree += 5;
+      return p[1] << 24 | p[2] << 16 | p[3] << 8 | p[4];
+    }
+}
+
+static const char *
+demarshal_string (const char **tree,
+                  const char  *strings)
+{
+  guint32 offset = demarshal_uint32 (tree);
+
+  return strings + offset;
+}
+
+static const char *
+demarshal_text (const char **tree,
+                const char  *strings,
+                guint32     *len)
+{
+  guint32 offset = demarshal_uint32 (tree);
+  const char *str = strings + offset;
+
+  *len = demarshal_uint32 (&str);
+  return str;
+}
+
+static void
+propagate_error (GtkBuildableParseContext *context,
+                 GError                  **dest,
+                 GError                   *src)
+{
+  (*context->internal_callbacks->error) (NULL, src, context);
+  g_propagate_error (dest, src);
+}
+
+static gboolean
+replay_start_element (GtkBuildableParseContext  *context,
+                      const char               **tree,
+                      const char                *strings,
+                      GError                   **error)
+{
+  const char *element_name;
+  guint32 i, n_attrs;
+  const char **attr_names;
+  const char **attr_values;
+  GError *tmp_error = NULL;
+
+  element_name = demarshal_string (tree, strings);
+  n_attrs = demarshal_uint32 (tree);
+
+  attr_names = g_newa (const char *, n_attrs + 1);
+  attr_values = g_newa (const char *, n_attrs + 1);
+  for (i = 0; i < n_attrs; i++)
+    {
+      attr_names[i] = demarshal_string (tree, strings);
+      attr_values[i] = demarshal_string (tree, strings);
+    }
+  attr_names[i] = NULL;
+  attr_values[i] = NULL;
+
+  (* context->internal_callbacks->start_element) (NULL,
+                                                  element_name,
+                                                  attr_names,
+                                                  attr_values,
+                                                  context,
+                                                  &tmp_error);
+
+  if (tmp_error)
+    {
+      propagate_error (context, error, tmp_error);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+replay_end_element (GtkBuildableParseContext  *context,
+                    const char               **tree,
+                    const char                *strings,
+                    GError                   **error)
+{
+  GError *tmp_error = NULL;
+
+  (* context->internal_callbacks->end_element) (NULL,
+                                                gtk_buildable_parse_context_get_element (context),
+                                                context,
+                                                &tmp_error);
+  if (tmp_error)
+    {
+      propagate_error (context, error, tmp_error);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+replay_text (GtkBuildableParseContext  *context,
+             const char               **tree,
+             const char                *strings,
+             GError                   **error)
+{
+  guint32 len;
+  const char *text;
+  GError *tmp_error = NULL;
+
+  text = demarshal_text (tree, strings, &len);
+
+  (*context->internal_callbacks->text) (NULL,
+                                        text,
+                                        len,
+                                        context,
+                                        &tmp_error);
+
+  if (tmp_error)
+    {
+      propagate_error (context, error, tmp_error);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+gtk_buildable_parse_context_replay (GtkBuildableParseContext  *context,
+                                    const char                *data,
+                                    gssize                     data_len,
+                                    GError                   **error)
+{
+  const char *data_end = data + data_len;
+  guint32 type, len;
+  const char *strings;
+  const char *tree;
+
+  data = data + 4; /* Skip header */
+
+  len = demarshal_uint32 (&data);
+
+  strings = data;
+  data = data + len;
+  tree = data;
+
+  while (tree < data_end)
+    {
+      gboolean res;
+      type = demarshal_uint32 (&tree);
+
+      switch (type)
+        {
+        case RECORD_TYPE_ELEMENT:
+          res = replay_start_element (context, &tree, strings, error);
+          break;
+        case RECORD_TYPE_END_ELEMENT:
+          res = replay_end_element (context, &tree, strings, error);
+          break;
+        case RECORD_TYPE_TEXT:
+          res = replay_text (context, &tree, strings, error);
+          break;
+        default:
+          g_assert_not_reached ();
+        }
+
+      if (!res)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 static gboolean
 gtk_buildable_parse_context_parse (GtkBuildableParseContext *context,
                                    const char           *text,
@@ -188,7 +389,7 @@ gtk_buildable_parse_context_parse (GtkBuildableParseContext *context,
 
   if (_gtk_buildable_parser_is_precompiled (text, text_len))
     {
-      res = _gtk_buildable_parser_replay_precompiled (context, text, text_len, error);
+      res = gtk_buildable_parse_context_replay (context, text, text_len, error);
     }
   else
     {
@@ -474,6 +675,13 @@ builder_construct (ParserData  *data,
       object = _gtk_builder_construct (data->builder, object_info, error);
       if (!object)
         return NULL;
+
+      /* Hold back property notifications until the whole tree has been
+       * built, so that handlers run once per property and not once per
+       * change while the object is being set up
+       */
+      g_object_freeze_notify (object);
+      g_ptr_array_add (data->frozen_objects, g_object_ref (object));
     }
   else
     {
@@ -2151,6 +2359,20 @@ text (GtkBuildableParseContext  *context,
     }
 }
 
+static void
+thaw_objects (ParserData *data)
+{
+  for (guint i = 0; i < data->frozen_objects->len; i++)
+    {
+      GObject *object = g_ptr_array_index (data->frozen_objects, i);
+
+      g_object_thaw_notify (object);
+      g_object_unref (object);
+    }
+
+  g_ptr_array_set_size (data->frozen_objects, 0);
+}
+
 static const GtkBuildableParser parser = {
   start_element,
   end_element,
@@ -2186,6 +2408,7 @@ _gtk_builder_parser_parse_buffer (GtkBuilder   *builder,
                                            (GDestroyNotify)g_free, NULL);
   data.stack = g_ptr_array_new ();
   data.finalizers = g_ptr_array_new ();
+  data.frozen_objects = g_ptr_array_new ();
 
   if (requested_objs)
     {
@@ -2206,6 +2429,11 @@ _gtk_builder_parser_parse_buffer (GtkBuilder   *builder,
   if (_gtk_builder_lookup_failed (builder, error))
     goto out;
 
+  /* Notifications need to be out before signal handlers are connected,
+   * as handlers from the UI file never saw construction-time changes
+   */
+  thaw_objects (&data);
+
   if (!_gtk_builder_finish (builder, error))
     goto out;
 
@@ -2236,11 +2464,14 @@ _gtk_builder_parser_parse_buffer (GtkBuilder   *builder,
 
  out:
 
+  thaw_objects (&data);
+
   g_slist_free_full (data.custom_finalizers, (GDestroyNotify)free_subparser);
   g_free (data.domain);
   g_hash_table_destroy (data.object_ids);
   g_ptr_array_free (data.stack, TRUE);
   g_ptr_array_free (data.finalizers, TRUE);
+  g_ptr_array_free (data.frozen_objects, TRUE);
   gtk_buildable_parse_context_free (&data.ctx);
 
   /* restore the original domain */
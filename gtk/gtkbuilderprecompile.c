@@ -1,4 +1,4 @@
-/* gtkbuilderparser.c
+/* gtkbuilderprecompile.c
  * Copyright (C) 2019 Red Hat,
  *                         Alexander Larsson <alexander.larsson@redhat.com>
  *
@@ -18,19 +18,11 @@
 
 #include "config.h"
 
-#include <gio/gio.h>
-#include "gtkbuilderprivate.h"
-#include "gtkbuilder.h"
-#include "gtkbuildableprivate.h"
+#include "gtkbuilderprecompileprivate.h"
 
-/*****************************************  Record a GMarkup parser call ***************************/
+#include <string.h>
 
-typedef enum
-{
-  RECORD_TYPE_ELEMENT,
-  RECORD_TYPE_END_ELEMENT,
-  RECORD_TYPE_TEXT,
-} RecordDataType;
+/*****************************************  Record a GMarkup parser call ***************************/
 
 /* All strings are owned by the string chunk */
 typedef struct {
@@ -542,161 +534,6 @@ _gtk_buildable_parser_precompile (const char  *text,
   return g_string_free_to_bytes (marshaled);
 }
 
-/*****************************************  Replay GMarkup parser callbacks ***************************/
-
-static guint32
-demarshal_uint32 (const char **tree)
-{
-  const guchar *p = (const guchar *)*tree;
-  guchar c = *p;
-  /* see marshal_uint32 for format */
-
-  if (c < 128) /* 7 bit */
-    {
-      *tree += 1;
-      return c;
-    }
-  else if ((c & 0xc0) == 0x80) /* 14 bit */
-    {
-      *tree += 2;
-      return (c & 0x3f) << 8 | p[1];
-    }
-  else if ((c & 0xe0) == 0xc0) /* 21 bit */
-    {
-      *tree += 3;
-      return (c & 0x1f) << 16 | p[1] << 8 | p[2];
-    }
-  else if ((c & 0xf0) == 0xe0) /* 28 bit */
-    {
-      *tree += 4;
-      return (c & 0xf) << 24 | p[1] << 16 | p[2] << 8 | p[3];
-    }
-  else
-    {
-      *tree += 5;
-      return p[1] << 24 | p[2] << 16 | p[3] << 8 | p[4];
-    }
-}
-
-static const char *
-demarshal_string (const char **tree,
-                  const char  *strings)
-{
-  guint32 offset = demarshal_uint32 (tree);
-
-  return strings + offset;
-}
-
-static const char *
-demarshal_text (const char **tree,
-                const char  *strings,
-                guint32     *len)
-{
-  guint32 offset = demarshal_uint32 (tree);
-  const char *str = strings + offset;
-
-  *len = demarshal_uint32 (&str);
-  return str;
-}
-
-static void
-propagate_error (GtkBuildableParseContext *context,
-                 GError                  **dest,
-                 GError                   *src)
-{
-  (*context->internal_callbacks->error) (NULL, src, context);
-  g_propagate_error (dest, src);
-}
-
-static gboolean
-replay_start_element (GtkBuildableParseContext  *context,
-                      const char               **tree,
-                      const char                *strings,
-                      GError                   **error)
-{
-  const char *element_name;
-  guint32 i, n_attrs;
-  const char **attr_names;
-  const char **attr_values;
-  GError *tmp_error = NULL;
-
-  element_name = demarshal_string (tree, strings);
-  n_attrs = demarshal_uint32 (tree);
-
-  attr_names = g_newa (const char *, n_attrs + 1);
-  attr_values = g_newa (const char *, n_attrs + 1);
-  for (i = 0; i < n_attrs; i++)
-    {
-      attr_names[i] = demarshal_string (tree, strings);
-      attr_values[i] = demarshal_string (tree, strings);
-    }
-  attr_names[i] = NULL;
-  attr_values[i] = NULL;
-
-  (* context->internal_callbacks->start_element) (NULL,
-                                                  element_name,
-                                                  attr_names,
-                                                  attr_values,
-                                                  context,
-                                                  &tmp_error);
-
-  if (tmp_error)
-    {
-      propagate_error (context, error, tmp_error);
-      return FALSE;
-    }
-
-  return TRUE;
-}
-
-static gboolean
-replay_end_element (GtkBuildableParseContext  *context,
-                    const char               **tree,
-                    const char                *strings,
-                    GError                   **error)
-{
-  GError *tmp_error = NULL;
-
-  (* context->internal_callbacks->end_element) (NULL,
-                                                gtk_buildable_parse_context_get_element (context),
-                                                context,
-                                                &tmp_error);
-  if (tmp_error)
-    {
-      propagate_error (context, error, tmp_error);
-      return FALSE;
-    }
-
-  return TRUE;
-}
-
-static gboolean
-replay_text (GtkBuildableParseContext  *context,
-             const char               **tree,
-             const char                *strings,
-             GError                   **error)
-{
-  guint32 len;
-  const char *text;
-  GError *tmp_error = NULL;
-
-  text = demarshal_text (tree, strings, &len);
-
-  (*context->internal_callbacks->text) (NULL,
-                                        text,
-                                        len,
-                                        context,
-                                        &tmp_error);
-
-  if (tmp_error)
-    {
-      propagate_error (context, error, tmp_error);
-      return FALSE;
-    }
-
-  return TRUE;
-}
-
 gboolean
 _gtk_buildable_parser_is_precompiled (const char *data,
                                       gssize      data_len)
@@ -708,49 +545,3 @@ _gtk_buildable_parser_is_precompiled (const char *data,
     data[2] == 'U' &&
     data[3] == 0;
 }
-
-gboolean
-_gtk_buildable_parser_replay_precompiled (GtkBuildableParseContext  *context,
-                                          const char                *data,
-                                          gssize                     data_len,
-                                          GError                   **error)
-{
-  const char *data_end = data + data_len;
-  guint32 type, len;
-  const char *strings;
-  const char *tree;
-
-  data = data + 4; /* Skip header */
-
-  len = demarshal_uint32 (&data);
-
-  strings = data;
-  data = data + len;
-  tree = data;
-
-  while (tree < data_end)
-    {
-      gboolean res;
-      type = demarshal_uint32 (&tree);
-
-      switch (type)
-        {
-        case RECORD_TYPE_ELEMENT:
-          res = replay_start_element (context, &tree, strings, error);
-          break;
-        case RECORD_TYPE_END_ELEMENT:
-          res = replay_end_element (context, &tree, strings, error);
-          break;
-        case RECORD_TYPE_TEXT:
-          res = replay_text (context, &tree, strings, error);
-          break;
-        default:
-          g_assert_not_reached ();
-        }
-
-      if (!res)
-        return FALSE;
-    }
-
-  return TRUE;
-}
@@ -0,0 +1,41 @@
+/* gtkbuilderprecompileprivate.h
+ * Copyright (C) 2019 Red Hat,
+ *                         Alexander Larsson <alexander.larsson@redhat.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/* This header only depends on GLib, so that tools that run during the
+ * build can precompile ui files without linking to GTK.
+ */
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef enum
+{
+  RECORD_TYPE_ELEMENT,
+  RECORD_TYPE_END_ELEMENT,
+  RECORD_TYPE_TEXT,
+} RecordDataType;
+
+GBytes * _gtk_buildable_parser_precompile (const char               *text,
+                                           gssize                    text_len,
+                                           GError                  **error);
+gboolean _gtk_buildable_parser_is_precompiled (const char           *data,
+                                               gssize                data_len);
+
+G_END_DECLS
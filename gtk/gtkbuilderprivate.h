@@ -21,6 +21,7 @@
 #include "gtkbuilder.h"
 #include "gtkbuildable.h"
 #include "gtkexpression.h"
+#include "gtkbuilderprecompileprivate.h"
 
 enum {
   TAG_PROPERTY,
@@ -181,6 +182,7 @@ typedef struct {
   const char *filename;
   GPtrArray *finalizers;
   GSList *custom_finalizers;
+  GPtrArray *frozen_objects;
 
   const char **requested_objects; /* NULL if all the objects are requested */
   gboolean inside_requested_object;
@@ -193,15 +195,6 @@ typedef struct {
 } ParserData;
 
 /* Things only GtkBuilder should use */
-GBytes * _gtk_buildable_parser_precompile (const char               *text,
-                                           gssize                    text_len,
-                                           GError                  **error);
-gboolean _gtk_buildable_parser_is_precompiled (const char           *data,
-                                               gssize                data_len);
-gboolean _gtk_buildable_parser_replay_precompiled (GtkBuildableParseContext *context,
-                                                   const char           *data,
-                                                   gssize                data_len,
-                                                   GError              **error);
 void _gtk_builder_parser_parse_buffer (GtkBuilder *builder,
                                        const char *filename,
                                        const char *buffer,
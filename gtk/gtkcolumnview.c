@@ -110,6 +110,12 @@
  * the %GTK_ACCESSIBLE_ROLE_GRID_CELL role
  */
 
+/* Views with more visible columns than this only create cell contents
+ * for the columns near the visible area, see
+ * gtk_column_view_update_offscreen_columns().
+ */
+#define GTK_COLUMN_VIEW_MIN_OFFSCREEN_COLUMNS 16
+
 /* We create a subclass of GtkListView for the sole purpose of overriding
  * some parameters for item creation.
  */
@@ -144,6 +150,8 @@ struct _GtkColumnView
   double autoscroll_x;
   double autoscroll_delta;
 
+  guint offscreen_tick_id;
+
   GtkGesture *drag_gesture;
 };
 
@@ -477,6 +485,73 @@ gtk_column_view_allocate_columns (GtkColumnView *self,
   return total_width;
 }
 
+/* Columns that are more than half a page away from the visible area
+ * are set offscreen, so none of their cells create or bind widgets.
+ * Returns TRUE if any column changes (or, with !apply, would change).
+ */
+static gboolean
+gtk_column_view_update_offscreen_columns (GtkColumnView *self,
+                                          gboolean       apply)
+{
+  GtkColumnViewColumn *column;
+  gboolean changed, virtualize;
+  guint i, n, n_visible;
+  int start, end, margin, offset, size;
+
+  n = g_list_model_get_n_items (G_LIST_MODEL (self->columns));
+  n_visible = 0;
+  for (i = 0; i < n; i++)
+    {
+      column = g_list_model_get_item (G_LIST_MODEL (self->columns), i);
+      if (gtk_column_view_column_get_visible (column))
+        n_visible++;
+      g_object_unref (column);
+    }
+  virtualize = n_visible > GTK_COLUMN_VIEW_MIN_OFFSCREEN_COLUMNS;
+
+  margin = gtk_widget_get_width (GTK_WIDGET (self)) / 2;
+  start = gtk_adjustment_get_value (self->hadjustment) - margin;
+  end = gtk_adjustment_get_value (self->hadjustment) + gtk_widget_get_width (GTK_WIDGET (self)) + margin;
+
+  changed = FALSE;
+  for (i = 0; i < n; i++)
+    {
+      gboolean offscreen;
+
+      column = g_list_model_get_item (G_LIST_MODEL (self->columns), i);
+      gtk_column_view_column_get_allocation (column, &offset, &size);
+
+      offscreen = virtualize &&
+                  gtk_column_view_column_get_visible (column) &&
+                  column != self->focus_column &&
+                  (offset + size < start || offset > end);
+
+      if (offscreen != gtk_column_view_column_get_offscreen (column))
+        {
+          changed = TRUE;
+          if (apply)
+            gtk_column_view_column_set_offscreen (column, offscreen);
+        }
+
+      g_object_unref (column);
+    }
+
+  return changed;
+}
+
+static gboolean
+gtk_column_view_offscreen_tick_cb (GtkWidget     *widget,
+                                   GdkFrameClock *frame_clock,
+                                   gpointer       unused)
+{
+  GtkColumnView *self = GTK_COLUMN_VIEW (widget);
+
+  self->offscreen_tick_id = 0;
+  gtk_column_view_update_offscreen_columns (self, TRUE);
+
+  return G_SOURCE_REMOVE;
+}
+
 static void
 gtk_column_view_allocate (GtkWidget *widget,
                           int        width,
@@ -502,6 +577,14 @@ gtk_column_view_allocate (GtkWidget *widget,
                        gsk_transform_translate (NULL, &GRAPHENE_POINT_INIT (-x, header_height)));
 
   gtk_adjustment_configure (self->hadjustment,  x, 0, full_width, width * 0.1, width * 0.9, width);
+
+  /* Changing the cells creates and destroys widgets, which must not
+   * happen during allocation, so do it before the next frame. */
+  if (self->offscreen_tick_id == 0 &&
+      gtk_column_view_update_offscreen_columns (self, FALSE))
+    self->offscreen_tick_id = gtk_widget_add_tick_callback (widget,
+                                                            gtk_column_view_offscreen_tick_cb,
+                                                            NULL, NULL);
 }
 
 static void
@@ -580,6 +663,12 @@ gtk_column_view_dispose (GObject *object)
 
   gtk_column_view_sorter_clear (GTK_COLUMN_VIEW_SORTER (self->sorter));
 
+  if (self->offscreen_tick_id)
+    {
+      gtk_widget_remove_tick_callback (GTK_WIDGET (self), self->offscreen_tick_id);
+      self->offscreen_tick_id = 0;
+    }
+
   while (g_list_model_get_n_items (G_LIST_MODEL (self->columns)) > 0)
     {
       GtkColumnViewColumn *column = g_list_model_get_item (G_LIST_MODEL (self->columns), 0);
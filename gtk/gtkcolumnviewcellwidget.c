@@ -26,8 +26,11 @@
 #include "gtkcolumnviewrowwidgetprivate.h"
 #include "gtkcssboxesprivate.h"
 #include "gtkcssnodeprivate.h"
+#include "gtkcssstylechangeprivate.h"
+#include "gtkexpressionprivate.h"
 #include "gtklistfactorywidgetprivate.h"
 #include "gtkprivate.h"
+#include "gtkrenderlayoutprivate.h"
 #include "gtkwidgetprivate.h"
 
 
@@ -37,6 +40,12 @@ struct _GtkColumnViewCellWidget
 
   GtkColumnViewColumn *column;
 
+  /* Text mode: the cell draws the result of the column's text
+   * expression itself instead of creating widgets via a factory */
+  GtkExpression *text_expression;
+  char *text;
+  PangoLayout *layout;
+
   /* This list isn't sorted - next/prev refer to list elements, not rows in the list */
   GtkColumnViewCellWidget *next_cell;
   GtkColumnViewCellWidget *prev_cell;
@@ -190,6 +199,107 @@ gtk_column_view_cell_widget_update_object (GtkListFactoryWidget *fw,
     gtk_column_view_cell_do_notify (cell, notify_item, notify_position, notify_selected);
 }
 
+static void
+gtk_column_view_cell_widget_update_text (GtkColumnViewCellWidget *self)
+{
+  GtkWidget *widget = GTK_WIDGET (self);
+  gpointer item = gtk_list_item_base_get_item (GTK_LIST_ITEM_BASE (self));
+  GValue value = G_VALUE_INIT;
+  const char *text = NULL;
+
+  if (self->text_expression && item)
+    {
+      if (gtk_expression_get_value_type (self->text_expression) == G_TYPE_STRING)
+        {
+          text = gtk_expression_evaluate_string (self->text_expression, item, &value);
+        }
+      else if (gtk_expression_evaluate (self->text_expression, item, &value))
+        {
+          GValue string = G_VALUE_INIT;
+
+          g_value_init (&string, G_TYPE_STRING);
+          g_value_transform (&value, &string);
+          g_value_unset (&value);
+          value = string;
+          text = g_value_get_string (&value);
+        }
+    }
+
+  if (g_strcmp0 (text, self->text) == 0)
+    {
+      g_value_unset (&value);
+      return;
+    }
+
+  g_free (self->text);
+  self->text = g_strdup (text);
+  g_value_unset (&value);
+
+  if (self->text)
+    {
+      if (self->layout == NULL)
+        {
+          PangoAttrList *attrs;
+
+          self->layout = gtk_widget_create_pango_layout (widget, NULL);
+          attrs = gtk_css_style_get_pango_attributes (gtk_css_node_get_style (gtk_widget_get_css_node (widget)));
+          pango_layout_set_attributes (self->layout, attrs);
+          pango_attr_list_unref (attrs);
+        }
+      pango_layout_set_text (self->layout, self->text, -1);
+
+      gtk_accessible_update_property (GTK_ACCESSIBLE (self),
+                                      GTK_ACCESSIBLE_PROPERTY_LABEL, self->text,
+                                      -1);
+    }
+  else
+    {
+      gtk_accessible_reset_property (GTK_ACCESSIBLE (self), GTK_ACCESSIBLE_PROPERTY_LABEL);
+    }
+
+  gtk_widget_queue_resize (widget);
+}
+
+static void
+gtk_column_view_cell_widget_update (GtkListItemBase *base,
+                                    guint            position,
+                                    gpointer         item,
+                                    gboolean         selected)
+{
+  GtkColumnViewCellWidget *self = GTK_COLUMN_VIEW_CELL_WIDGET (base);
+  gboolean item_changed;
+
+  item_changed = gtk_list_item_base_get_item (base) != item;
+
+  GTK_LIST_ITEM_BASE_CLASS (gtk_column_view_cell_widget_parent_class)->update (base, position, item, selected);
+
+  if (self->text_expression && item_changed)
+    gtk_column_view_cell_widget_update_text (self);
+}
+
+static void
+gtk_column_view_cell_widget_measure_text (GtkColumnViewCellWidget *self,
+                                          GtkOrientation           orientation,
+                                          int                     *minimum,
+                                          int                     *natural,
+                                          int                     *minimum_baseline,
+                                          int                     *natural_baseline)
+{
+  PangoRectangle logical;
+
+  pango_layout_get_pixel_extents (self->layout, NULL, &logical);
+
+  if (orientation == GTK_ORIENTATION_HORIZONTAL)
+    {
+      *minimum = *natural = logical.width;
+    }
+  else
+    {
+      *minimum = *natural = logical.height;
+      *minimum_baseline = *natural_baseline = pango_layout_get_baseline (self->layout) / PANGO_SCALE;
+    }
+}
+
 static int
 unadjust_width (GtkWidget *widget,
                 int        width)
@@ -224,7 +334,7 @@ gtk_column_view_cell_widget_measure (GtkWidget      *widget,
 
   if (orientation == GTK_ORIENTATION_VERTICAL)
     {
-      if (fixed_width > -1)
+      if (fixed_width > -1 && child)
         {
           int min;
 
@@ -240,6 +350,8 @@ gtk_column_view_cell_widget_measure (GtkWidget      *widget,
 
   if (child)
     gtk_widget_measure (child, orientation, for_size, minimum, natural, minimum_baseline, natural_baseline);
+  else if (cell->text)
+    gtk_column_view_cell_widget_measure_text (cell, orientation, minimum, natural, minimum_baseline, natural_baseline);
 
   if (orientation == GTK_ORIENTATION_HORIZONTAL)
     {
@@ -269,6 +381,60 @@ gtk_column_view_cell_widget_size_allocate (GtkWidget *widget,
     }
 }
 
+static void
+gtk_column_view_cell_widget_snapshot (GtkWidget   *widget,
+                                      GtkSnapshot *snapshot)
+{
+  GtkColumnViewCellWidget *self = GTK_COLUMN_VIEW_CELL_WIDGET (widget);
+
+  if (self->text)
+    {
+      PangoRectangle logical;
+      GtkCssBoxes boxes;
+      int baseline;
+      float x, y;
+
+      pango_layout_get_pixel_extents (self->layout, NULL, &logical);
+
+      if (_gtk_widget_get_direction (widget) == GTK_TEXT_DIR_RTL)
+        x = gtk_widget_get_width (widget) - logical.width - logical.x;
+      else
+        x = - logical.x;
+
+      baseline = gtk_widget_get_baseline (widget);
+      if (baseline != -1)
+        y = baseline - pango_layout_get_baseline (self->layout) / PANGO_SCALE;
+      else
+        y = MAX (0, floor ((gtk_widget_get_height (widget) - logical.height) / 2));
+
+      gtk_css_boxes_init (&boxes, widget);
+      gtk_css_style_snapshot_layout (&boxes, snapshot, x, y, self->layout);
+    }
+
+  GTK_WIDGET_CLASS (gtk_column_view_cell_widget_parent_class)->snapshot (widget, snapshot);
+}
+
+static void
+gtk_column_view_cell_widget_css_changed (GtkWidget         *widget,
+                                         GtkCssStyleChange *change)
+{
+  GtkColumnViewCellWidget *self = GTK_COLUMN_VIEW_CELL_WIDGET (widget);
+
+  GTK_WIDGET_CLASS (gtk_column_view_cell_widget_parent_class)->css_changed (widget, change);
+
+  if (self->layout &&
+      (change == NULL || gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_TEXT_ATTRS)))
+    {
+      PangoAttrList *attrs;
+
+      attrs = gtk_css_style_get_pango_attributes (gtk_css_node_get_style (gtk_widget_get_css_node (widget)));
+      pango_layout_set_attributes (self->layout, attrs);
+      pango_attr_list_unref (attrs);
+
+      gtk_widget_queue_resize (widget);
+    }
+}
+
 /* This should be to be called when unsetting the parent, but we have no
  * set_parent vfunc().
  */
@@ -299,6 +465,10 @@ gtk_column_view_cell_widget_dispose (GObject *object)
   /* unset_parent() forgot to call this. Be very angry. */
   g_warn_if_fail (self->column == NULL);
 
+  g_clear_pointer (&self->text_expression, gtk_expression_unref);
+  g_clear_pointer (&self->text, g_free);
+  g_clear_object (&self->layout);
+
   G_OBJECT_CLASS (gtk_column_view_cell_widget_parent_class)->dispose (object);
 }
 
@@ -317,6 +487,7 @@ static void
 gtk_column_view_cell_widget_class_init (GtkColumnViewCellWidgetClass *klass)
 {
   GtkListFactoryWidgetClass *factory_class = GTK_LIST_FACTORY_WIDGET_CLASS (klass);
+  GtkListItemBaseClass *base_class = GTK_LIST_ITEM_BASE_CLASS (klass);
   GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
 
@@ -325,11 +496,15 @@ gtk_column_view_cell_widget_class_init (GtkColumnViewCellWidgetClass *klass)
   factory_class->update_object = gtk_column_view_cell_widget_update_object;
   factory_class->teardown_object = gtk_column_view_cell_widget_teardown_object;
 
+  base_class->update = gtk_column_view_cell_widget_update;
+
   widget_class->focus = gtk_column_view_cell_widget_focus;
   widget_class->grab_focus = gtk_column_view_cell_widget_grab_focus;
   widget_class->measure = gtk_column_view_cell_widget_measure;
   widget_class->size_allocate = gtk_column_view_cell_widget_size_allocate;
   widget_class->get_request_mode = gtk_column_view_cell_widget_get_request_mode;
+  widget_class->snapshot = gtk_column_view_cell_widget_snapshot;
+  widget_class->css_changed = gtk_column_view_cell_widget_css_changed;
 
   gobject_class->dispose = gtk_column_view_cell_widget_dispose;
 
@@ -363,12 +538,27 @@ gtk_column_view_cell_widget_new (GtkColumnViewColumn *column,
                                  gboolean             inert)
 {
   GtkColumnViewCellWidget *self;
+  GtkListItemFactory *factory;
+  GtkExpression *text_expression;
+
+  if (inert || gtk_column_view_column_get_offscreen (column))
+    {
+      factory = NULL;
+      text_expression = NULL;
+    }
+  else
+    {
+      factory = gtk_column_view_column_get_factory (column);
+      text_expression = factory ? NULL : gtk_column_view_column_get_text_expression (column);
+    }
 
   self = g_object_new (GTK_TYPE_COLUMN_VIEW_CELL_WIDGET,
-                       "factory", inert ? NULL : gtk_column_view_column_get_factory (column),
+                       "factory", factory,
                        NULL);
 
   self->column = g_object_ref (column);
+  if (text_expression)
+    self->text_expression = gtk_expression_ref (text_expression);
 
   self->next_cell = gtk_column_view_column_get_first_cell (self->column);
   if (self->next_cell)
@@ -419,3 +609,17 @@ gtk_column_view_cell_widget_set_child (GtkColumnViewCellWidget *self,
   if (child)
     gtk_widget_set_parent (child, GTK_WIDGET (self));
 }
+
+void
+gtk_column_view_cell_widget_set_text_expression (GtkColumnViewCellWidget *self,
+                                                 GtkExpression           *expression)
+{
+  if (self->text_expression == expression)
+    return;
+
+  g_clear_pointer (&self->text_expression, gtk_expression_unref);
+  if (expression)
+    self->text_expression = gtk_expression_ref (expression);
+
+  gtk_column_view_cell_widget_update_text (self);
+}
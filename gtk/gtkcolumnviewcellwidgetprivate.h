@@ -41,6 +41,9 @@ GtkWidget *                     gtk_column_view_cell_widget_new                (
 void                            gtk_column_view_cell_widget_set_child          (GtkColumnViewCellWidget         *self,
                                                                                 GtkWidget                       *child);
 
+void                            gtk_column_view_cell_widget_set_text_expression (GtkColumnViewCellWidget        *self,
+                                                                                GtkExpression                   *expression);
+
 void                            gtk_column_view_cell_widget_remove             (GtkColumnViewCellWidget         *self);
 
 GtkColumnViewCellWidget *       gtk_column_view_cell_widget_get_next           (GtkColumnViewCellWidget         *self);
@@ -23,6 +23,7 @@
 #include "gtkcolumnviewsorterprivate.h"
 
 #include "gtkcolumnviewprivate.h"
+#include "gtkcolumnviewcellwidgetprivate.h"
 #include "gtkcolumnviewrowwidgetprivate.h"
 #include "gtkcolumnviewtitleprivate.h"
 #include "gtklistbaseprivate.h"
@@ -42,6 +43,10 @@
  * that tells the columnview how to create cells for this column from items in
  * the model.
  *
+ * Columns that only display text can instead set a
+ * [property@Gtk.ColumnViewColumn:text-expression]. Cells of such columns
+ * draw the text themselves and don't create any widgets.
+ *
  * Columns have a title, and can optionally have a header menu set
  * with [method@Gtk.ColumnViewColumn.set_header_menu].
  *
@@ -55,6 +60,7 @@ struct _GtkColumnViewColumn
   GObject parent_instance;
 
   GtkListItemFactory *factory;
+  GtkExpression *text_expression;
   char *title;
   char *id;
   GtkSorter *sorter;
@@ -74,6 +80,11 @@ struct _GtkColumnViewColumn
   guint visible     : 1;
   guint resizable   : 1;
   guint expand      : 1;
+  guint offscreen   : 1;
+
+  /* size before the column went offscreen */
+  int offscreen_minimum;
+  int offscreen_natural;
 
   GMenuModel *menu;
 
@@ -99,6 +110,7 @@ enum
   PROP_EXPAND,
   PROP_FIXED_WIDTH,
   PROP_ID,
+  PROP_TEXT_EXPRESSION,
 
   N_PROPS
 };
@@ -116,6 +128,7 @@ gtk_column_view_column_dispose (GObject *object)
   g_assert (self->first_cell == NULL); /* no view = no children */
 
   g_clear_object (&self->factory);
+  g_clear_pointer (&self->text_expression, gtk_expression_unref);
   g_clear_object (&self->sorter);
   g_clear_pointer (&self->title, g_free);
   g_clear_object (&self->menu);
@@ -174,6 +187,10 @@ gtk_column_view_column_get_property (GObject    *object,
       g_value_set_string (value, self->id);
       break;
 
+    case PROP_TEXT_EXPRESSION:
+      gtk_value_set_expression (value, self->text_expression);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -226,6 +243,10 @@ gtk_column_view_column_set_property (GObject      *object,
       gtk_column_view_column_set_id (self, g_value_get_string (value));
       break;
 
+    case PROP_TEXT_EXPRESSION:
+      gtk_column_view_column_set_text_expression (self, gtk_value_get_expression (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -350,6 +371,18 @@ gtk_column_view_column_class_init (GtkColumnViewColumnClass *klass)
                           NULL,
                           G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkColumnViewColumn:text-expression: (attributes org.gtk.Property.get=gtk_column_view_column_get_text_expression org.gtk.Property.set=gtk_column_view_column_set_text_expression)
+   *
+   * An expression to display as text in the cells of this column
+   * when no factory is set.
+   *
+   * Since: 4.16
+   */
+  properties[PROP_TEXT_EXPRESSION] =
+    gtk_param_spec_expression ("text-expression", NULL, NULL,
+                               G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, N_PROPS, properties);
 }
 
@@ -486,6 +519,13 @@ gtk_column_view_column_measure (GtkColumnViewColumn *self,
           nat = MAX (nat, cell_nat);
         }
 
+      /* offscreen cells are empty, don't shrink because of that */
+      if (self->offscreen)
+        {
+          min = MAX (min, self->offscreen_minimum);
+          nat = MAX (nat, self->offscreen_natural);
+        }
+
       self->minimum_size_request = min;
       self->natural_size_request = nat;
     }
@@ -619,6 +659,7 @@ gtk_column_view_column_set_column_view (GtkColumnViewColumn *self,
   gtk_column_view_column_remove_header (self);
 
   self->view = view;
+  self->offscreen = FALSE;
 
   gtk_column_view_column_ensure_cells (self);
 
@@ -666,24 +707,61 @@ gtk_column_view_column_update_factory (GtkColumnViewColumn *self,
                                        gboolean             inert)
 {
   GtkListItemFactory *factory;
+  GtkExpression *text_expression;
   GtkColumnViewCellWidget *cell;
 
-  if (self->factory == NULL)
+  if (self->factory == NULL && self->text_expression == NULL)
     return;
 
-  if (inert)
-    factory = NULL;
+  if (inert || self->offscreen)
+    {
+      factory = NULL;
+      text_expression = NULL;
+    }
+  else if (self->factory)
+    {
+      factory = self->factory;
+      text_expression = NULL;
+    }
   else
-    factory = self->factory;
+    {
+      factory = NULL;
+      text_expression = self->text_expression;
+    }
 
   for (cell = self->first_cell;
        cell;
        cell = gtk_column_view_cell_widget_get_next (cell))
     {
       gtk_list_factory_widget_set_factory (GTK_LIST_FACTORY_WIDGET (cell), factory);
+      gtk_column_view_cell_widget_set_text_expression (cell, text_expression);
     }
 }
 
+gboolean
+gtk_column_view_column_get_offscreen (GtkColumnViewColumn *self)
+{
+  return self->offscreen;
+}
+
+/* Offscreen columns keep their cells, but without a factory, so
+ * no widgets are created or bound for them. */
+void
+gtk_column_view_column_set_offscreen (GtkColumnViewColumn *self,
+                                      gboolean             offscreen)
+{
+  if (self->offscreen == offscreen)
+    return;
+
+  if (offscreen)
+    gtk_column_view_column_measure (self, &self->offscreen_minimum, &self->offscreen_natural);
+
+  self->offscreen = offscreen;
+
+  if (self->view && !gtk_column_view_is_inert (self->view))
+    gtk_column_view_column_update_factory (self, FALSE);
+}
+
 /**
  * gtk_column_view_column_set_factory: (attributes org.gtk.Method.set_property=factory)
  * @self: a `GtkColumnViewColumn`
@@ -711,6 +789,67 @@ gtk_column_view_column_set_factory (GtkColumnViewColumn *self,
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_FACTORY]);
 }
 
+/**
+ * gtk_column_view_column_get_text_expression: (attributes org.gtk.Method.get_property=text-expression)
+ * @self: a `GtkColumnViewColumn`
+ *
+ * Gets the expression set with gtk_column_view_column_set_text_expression().
+ *
+ * Returns: (nullable) (transfer none): The text expression
+ *
+ * Since: 4.16
+ */
+GtkExpression *
+gtk_column_view_column_get_text_expression (GtkColumnViewColumn *self)
+{
+  g_return_val_if_fail (GTK_IS_COLUMN_VIEW_COLUMN (self), NULL);
+
+  return self->text_expression;
+}
+
+/**
+ * gtk_column_view_column_set_text_expression: (attributes org.gtk.Method.set_property=text-expression)
+ * @self: a `GtkColumnViewColumn`
+ * @expression: (nullable) (transfer none): the expression to display
+ *
+ * Sets an expression that is displayed as text in the cells of this
+ * column.
+ *
+ * The expression is evaluated with the row's item as `this` and must
+ * evaluate to a string or to a value that can be transformed to one.
+ *
+ * The text expression is only used when no factory is set. Cells
+ * of such a column don't create any widgets, so this is a lot cheaper
+ * than a factory with labels for large, read-only tables. The expression
+ * is evaluated whenever a cell is bound to a new item; changes to the
+ * item are not tracked.
+ *
+ * Since: 4.16
+ */
+void
+gtk_column_view_column_set_text_expression (GtkColumnViewColumn *self,
+                                            GtkExpression       *expression)
+{
+  g_return_if_fail (GTK_IS_COLUMN_VIEW_COLUMN (self));
+  g_return_if_fail (expression == NULL ||
+                    g_value_type_transformable (gtk_expression_get_value_type (expression), G_TYPE_STRING));
+
+  if (self->text_expression == expression)
+    return;
+
+  if (self->text_expression && !expression)
+    gtk_column_view_column_update_factory (self, TRUE);
+
+  g_clear_pointer (&self->text_expression, gtk_expression_unref);
+  if (expression)
+    self->text_expression = gtk_expression_ref (expression);
+
+  if (self->view && !gtk_column_view_is_inert (self->view))
+    gtk_column_view_column_update_factory (self, FALSE);
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_TEXT_EXPRESSION]);
+}
+
 /**
  * gtk_column_view_column_set_title: (attributes org.gtk.Method.set_property=title)
  * @self: a `GtkColumnViewColumn`
@@ -24,6 +24,7 @@
 #endif
 
 #include <gtk/gtkcolumnview.h>
+#include <gtk/gtkexpression.h>
 #include <gtk/gtksorter.h>
 
 G_BEGIN_DECLS
@@ -102,5 +103,11 @@ void                    gtk_column_view_column_set_id                   (GtkColu
 GDK_AVAILABLE_IN_4_10
 const char *            gtk_column_view_column_get_id                   (GtkColumnViewColumn    *self);
 
+GDK_AVAILABLE_IN_4_16
+void                    gtk_column_view_column_set_text_expression      (GtkColumnViewColumn    *self,
+                                                                         GtkExpression          *expression);
+GDK_AVAILABLE_IN_4_16
+GtkExpression *         gtk_column_view_column_get_text_expression      (GtkColumnViewColumn    *self);
+
 G_END_DECLS
 
@@ -39,6 +39,9 @@ GtkWidget *             gtk_column_view_column_get_header               (GtkColu
 
 void                    gtk_column_view_column_update_factory           (GtkColumnViewColumn    *self,
                                                                          gboolean                inert);
+gboolean                gtk_column_view_column_get_offscreen            (GtkColumnViewColumn    *self);
+void                    gtk_column_view_column_set_offscreen            (GtkColumnViewColumn    *self,
+                                                                         gboolean                offscreen);
 void                    gtk_column_view_column_queue_resize             (GtkColumnViewColumn    *self);
 void                    gtk_column_view_column_measure                  (GtkColumnViewColumn    *self,
                                                                          int                    *minimum,
@@ -29,7 +29,30 @@
 
 
 #define GTK_COMPOSE_TABLE_MAGIC "GtkComposeTable"
-#define GTK_COMPOSE_TABLE_VERSION (4)
+#define GTK_COMPOSE_TABLE_VERSION (5)
+
+/* The cache file starts with the magic, followed by the version as a
+ * big-endian guint16, so all versions can be told apart. Since version
+ * 5, this is followed by a byte order mark and a header in native byte
+ * order, and the data is stored in native byte order too, so that the
+ * cache can be mapped and used without copying, and its pages can be
+ * shared between processes.
+ */
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+#define GTK_COMPOSE_TABLE_BYTE_ORDER 'l'
+#else
+#define GTK_COMPOSE_TABLE_BYTE_ORDER 'B'
+#endif
+
+typedef struct {
+  guint16 max_seq_len;
+  guint16 n_index_size;
+  guint16 data_size;
+  guint16 n_chars;
+} GtkComposeTableCacheHeader;
+
+#define GTK_COMPOSE_TABLE_DATA_OFFSET \
+  (strlen (GTK_COMPOSE_TABLE_MAGIC) + sizeof (guint16) + 1 + sizeof (GtkComposeTableCacheHeader))
 
 extern const GtkComposeTable builtin_compose_table;
 
@@ -701,49 +724,38 @@ gtk_compose_table_serialize (GtkComposeTable *compose_table,
 {
   char *p, *contents;
   gsize header_length, total_length;
-  guint16 bytes;
-  const char *header = GTK_COMPOSE_TABLE_MAGIC;
-  const guint16 version = GTK_COMPOSE_TABLE_VERSION;
-  guint16 max_seq_len = compose_table->max_seq_len;
-  guint16 n_index_size = compose_table->n_index_size;
-  guint16 data_size = compose_table->data_size;
-  guint16 n_chars = compose_table->n_chars;
-  guint32 i;
+  guint16 version = GUINT16_TO_BE (GTK_COMPOSE_TABLE_VERSION);
+  GtkComposeTableCacheHeader header;
 
   g_return_val_if_fail (compose_table != NULL, NULL);
-  g_return_val_if_fail (max_seq_len > 0, NULL);
-  g_return_val_if_fail (n_index_size > 0, NULL);
+  g_return_val_if_fail (compose_table->max_seq_len > 0, NULL);
+  g_return_val_if_fail (compose_table->n_index_size > 0, NULL);
 
-  header_length = strlen (header);
-  total_length = header_length + sizeof (guint16) * (5 + data_size) + n_chars;
+  header.max_seq_len = compose_table->max_seq_len;
+  header.n_index_size = compose_table->n_index_size;
+  header.data_size = compose_table->data_size;
+  header.n_chars = compose_table->n_chars;
+
+  header_length = strlen (GTK_COMPOSE_TABLE_MAGIC);
+  total_length = GTK_COMPOSE_TABLE_DATA_OFFSET + sizeof (guint16) * header.data_size + header.n_chars;
   if (count)
     *count = total_length;
 
   p = contents = g_malloc (total_length);
 
-  memcpy (p, header, header_length);
+  memcpy (p, GTK_COMPOSE_TABLE_MAGIC, header_length);
   p += header_length;
-
-#define APPEND_GUINT16(elt) \
-  bytes = GUINT16_TO_BE (elt); \
-  memcpy (p, &bytes, sizeof (guint16)); \
+  memcpy (p, &version, sizeof (guint16));
   p += sizeof (guint16);
+  *p++ = GTK_COMPOSE_TABLE_BYTE_ORDER;
+  memcpy (p, &header, sizeof (header));
+  p += sizeof (header);
 
-  APPEND_GUINT16 (version);
-  APPEND_GUINT16 (max_seq_len);
-  APPEND_GUINT16 (n_index_size);
-  APPEND_GUINT16 (data_size);
-  APPEND_GUINT16 (n_chars);
-
-  for (i = 0; i < data_size; i++)
-    {
-      APPEND_GUINT16 (compose_table->data[i]);
-    }
+  memcpy (p, compose_table->data, sizeof (guint16) * header.data_size);
+  p += sizeof (guint16) * header.data_size;
 
-  if (compose_table->n_chars > 0)
-    memcpy (p, compose_table->char_data, compose_table->n_chars);
-
-#undef APPEND_GUINT16
+  if (header.n_chars > 0)
+    memcpy (p, compose_table->char_data, header.n_chars);
 
   return contents;
 }
@@ -754,21 +766,14 @@ gtk_compose_table_load_cache (const char *compose_file,
 {
   guint32 hash;
   char *path = NULL;
-  char *contents = NULL;
-  char *p;
+  GMappedFile *mapped = NULL;
+  const char *contents;
   GStatBuf original_buf;
   GStatBuf cache_buf;
   gsize total_length;
   GError *error = NULL;
-  guint16 bytes;
   guint16 version;
-  guint16 max_seq_len;
-  guint16 n_index_size;
-  guint16 data_size;
-  guint16 n_chars;
-  guint32 i;
-  guint16 *data = NULL;
-  char *char_data = NULL;
+  GtkComposeTableCacheHeader header;
   GtkComposeTable *retval;
 
   *found_old_cache = FALSE;
@@ -786,86 +791,83 @@ gtk_compose_table_load_cache (const char *compose_file,
   g_stat (compose_file, &original_buf);
   if (original_buf.st_mtime > cache_buf.st_mtime)
     goto out_load_cache;
-  if (!g_file_get_contents (path, &contents, &total_length, &error))
+
+  mapped = g_mapped_file_new (path, FALSE, &error);
+  if (mapped == NULL)
     {
       g_warning ("Failed to get cache content %s: %s", path, error->message);
       g_error_free (error);
       goto out_load_cache;
     }
 
-#define GET_GUINT16(elt) \
-  memcpy (&bytes, p, sizeof (guint16)); \
-  elt = GUINT16_FROM_BE (bytes); \
-  p += sizeof (guint16);
+  contents = g_mapped_file_get_contents (mapped);
+  total_length = g_mapped_file_get_length (mapped);
 
-  p = contents;
-  if (g_ascii_strncasecmp (p, GTK_COMPOSE_TABLE_MAGIC,
+  if (total_length < strlen (GTK_COMPOSE_TABLE_MAGIC) + sizeof (guint16) ||
+      g_ascii_strncasecmp (contents, GTK_COMPOSE_TABLE_MAGIC,
                            strlen (GTK_COMPOSE_TABLE_MAGIC)) != 0)
     {
       g_warning ("The file is not a GtkComposeTable cache file %s", path);
       goto out_load_cache;
     }
 
-  p += strlen (GTK_COMPOSE_TABLE_MAGIC);
-  if (p - contents > total_length)
-    {
-      g_warning ("Broken cache content %s at head", path);
-      goto out_load_cache;
-    }
-
-  GET_GUINT16 (version);
+  memcpy (&version, contents + strlen (GTK_COMPOSE_TABLE_MAGIC), sizeof (guint16));
+  version = GUINT16_FROM_BE (version);
   if (version != GTK_COMPOSE_TABLE_VERSION)
     {
-      if (version < GTK_COMPOSE_TABLE_VERSION)
+      /* Caches written before 4.4 have versions below 4 */
+      if (version < 4)
         *found_old_cache = TRUE;
       goto out_load_cache;
     }
 
-  GET_GUINT16 (max_seq_len);
-  GET_GUINT16 (n_index_size);
-  GET_GUINT16 (data_size);
-  GET_GUINT16 (n_chars);
-
-  if (max_seq_len == 0 || data_size == 0)
+  if (total_length < GTK_COMPOSE_TABLE_DATA_OFFSET)
     {
-      g_warning ("cache size is not correct %d %d", max_seq_len, data_size);
+      g_warning ("Broken cache content %s at head", path);
       goto out_load_cache;
     }
 
-  data = g_new0 (guint16, data_size);
+  /* Written on a machine with a different byte order, just regenerate it */
+  if (contents[strlen (GTK_COMPOSE_TABLE_MAGIC) + sizeof (guint16)] != GTK_COMPOSE_TABLE_BYTE_ORDER)
+    goto out_load_cache;
+
+  memcpy (&header,
+          contents + GTK_COMPOSE_TABLE_DATA_OFFSET - sizeof (header),
+          sizeof (header));
 
-  for (i = 0; i < data_size; i++)
+  if (header.max_seq_len == 0 || header.data_size == 0)
     {
-      GET_GUINT16 (data[i]);
+      g_warning ("cache size is not correct %d %d", header.max_seq_len, header.data_size);
+      goto out_load_cache;
     }
 
-  if (n_chars > 0)
+  if (total_length != GTK_COMPOSE_TABLE_DATA_OFFSET + sizeof (guint16) * header.data_size + header.n_chars ||
+      (header.n_chars > 0 && contents[total_length - 1] != '\0'))
     {
-      char_data = g_new (char, n_chars + 1);
-      memcpy (char_data, p, n_chars);
-      char_data[n_chars] = '\0';
+      g_warning ("Broken cache content %s", path);
+      goto out_load_cache;
     }
 
+  /* The data is used right from the mapping, which is kept
+   * for the lifetime of the table
+   */
   retval = g_new0 (GtkComposeTable, 1);
-  retval->data = data;
-  retval->max_seq_len = max_seq_len;
-  retval->n_index_size = n_index_size;
-  retval->data_size = data_size;
-  retval->char_data = char_data;
-  retval->n_chars = n_chars;
+  retval->data = (guint16 *) (contents + GTK_COMPOSE_TABLE_DATA_OFFSET);
+  retval->max_seq_len = header.max_seq_len;
+  retval->n_index_size = header.n_index_size;
+  retval->data_size = header.data_size;
+  if (header.n_chars > 0)
+    retval->char_data = (char *) (contents + GTK_COMPOSE_TABLE_DATA_OFFSET + sizeof (guint16) * header.data_size);
+  retval->n_chars = header.n_chars;
   retval->id = hash;
+  retval->mapped = mapped;
 
-  g_free (contents);
   g_free (path);
 
   return retval;
 
-#undef GET_GUINT16
-
 out_load_cache:
-  g_free (data);
-  g_free (char_data);
-  g_free (contents);
+  g_clear_pointer (&mapped, g_mapped_file_unref);
   g_free (path);
   return NULL;
 }
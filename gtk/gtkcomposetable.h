@@ -44,6 +44,9 @@ typedef struct _GtkComposeTableCompact GtkComposeTableCompact;
  * then we place it directly. Otherwise, we put the UTF8-encoded
  * value in the char_data array, and use offset | 0x8000 as the
  * encoded value.
+ *
+ * Tables loaded from the cache keep the cache file mapped, and
+ * data and char_data point into the read-only mapping.
  */
 struct _GtkComposeTable
 {
@@ -55,6 +58,7 @@ struct _GtkComposeTable
   int n_chars;
   int n_sequences;
   guint32 id;
+  GMappedFile *mapped;
 };
 
 GtkComposeTable * gtk_compose_table_new_with_file (const char    *compose_file);
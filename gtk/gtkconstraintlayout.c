@@ -263,6 +263,12 @@ struct _GtkConstraintLayout
 
   GListStore *constraints_observer;
   GListStore *guides_observer;
+
+  /* Whether the required stays that pin the layout to its last
+   * allocation are in the solver; we keep them between allocations,
+   * so that a new size only needs to move them
+   */
+  gboolean has_allocation_stays;
 };
 
 G_DEFINE_TYPE (GtkConstraintLayoutChild, gtk_constraint_layout_child, GTK_TYPE_LAYOUT_CHILD)
@@ -544,6 +550,8 @@ gtk_constraint_layout_finalize (GObject *gobject)
 {
   GtkConstraintLayout *self = GTK_CONSTRAINT_LAYOUT (gobject);
 
+  gtk_constraint_layout_release_allocation (self);
+
   if (self->constraints_observer)
     {
       g_list_store_remove_all (self->constraints_observer);
@@ -730,6 +738,46 @@ get_layout_attribute (GtkConstraintLayout    *self,
   return res;
 }
 
+/*< private >
+ * gtk_constraint_layout_release_allocation:
+ * @self: a `GtkConstraintLayout`
+ *
+ * Removes the stays that keep the layout at its last allocation.
+ *
+ * This needs to happen before the layout is measured, or before
+ * constraints are added that may conflict with the allocated size.
+ */
+void
+gtk_constraint_layout_release_allocation (GtkConstraintLayout *self)
+{
+  GtkConstraintAttribute attrs[] = {
+    GTK_CONSTRAINT_ATTRIBUTE_TOP,
+    GTK_CONSTRAINT_ATTRIBUTE_LEFT,
+    GTK_CONSTRAINT_ATTRIBUTE_WIDTH,
+    GTK_CONSTRAINT_ATTRIBUTE_HEIGHT,
+  };
+  GtkWidget *widget;
+  gsize i;
+
+  if (!self->has_allocation_stays)
+    return;
+
+  self->has_allocation_stays = FALSE;
+
+  widget = gtk_layout_manager_get_widget (GTK_LAYOUT_MANAGER (self));
+
+  gtk_constraint_solver_freeze (self->solver);
+
+  for (i = 0; i < G_N_ELEMENTS (attrs); i++)
+    {
+      GtkConstraintVariable *var = get_layout_attribute (self, widget, attrs[i]);
+
+      gtk_constraint_solver_remove_stay_variable (self->solver, var);
+    }
+
+  gtk_constraint_solver_thaw (self->solver);
+}
+
 /*< private >
  * layout_add_constraint:
  * @self: a `GtkConstraintLayout`
@@ -770,6 +818,8 @@ layout_add_constraint (GtkConstraintLayout *self,
   if (solver == NULL)
     return;
 
+  gtk_constraint_layout_release_allocation (self);
+
   attr = gtk_constraint_get_target_attribute (constraint);
   target = gtk_constraint_get_target (constraint);
   if (target == NULL || target == GTK_CONSTRAINT_TARGET (layout_widget))
@@ -928,6 +978,9 @@ gtk_constraint_layout_measure (GtkLayoutManager *manager,
   if (solver == NULL)
     return;
 
+  /* The size of the layout must be free while measuring */
+  gtk_constraint_layout_release_allocation (self);
+
   gtk_constraint_solver_freeze (solver);
 
   /* We measure each child in the layout and impose restrictions on the
@@ -1018,7 +1071,6 @@ gtk_constraint_layout_allocate (GtkLayoutManager *manager,
                                 int               baseline)
 {
   GtkConstraintLayout *self = GTK_CONSTRAINT_LAYOUT (manager);
-  GtkConstraintRef *stay_w, *stay_h, *stay_t, *stay_l;
   GtkConstraintSolver *solver;
   GtkConstraintVariable *layout_top, *layout_height;
   GtkConstraintVariable *layout_left, *layout_width;
@@ -1028,30 +1080,47 @@ gtk_constraint_layout_allocate (GtkLayoutManager *manager,
   if (solver == NULL)
     return;
 
-  /* We add required stay constraints to ensure that the layout remains
-   * within the bounds of the allocation
-   */
   layout_top = get_layout_attribute (self, widget, GTK_CONSTRAINT_ATTRIBUTE_TOP);
   layout_left = get_layout_attribute (self, widget, GTK_CONSTRAINT_ATTRIBUTE_LEFT);
   layout_width = get_layout_attribute (self, widget, GTK_CONSTRAINT_ATTRIBUTE_WIDTH);
   layout_height = get_layout_attribute (self, widget, GTK_CONSTRAINT_ATTRIBUTE_HEIGHT);
 
-  gtk_constraint_variable_set_value (layout_top, 0.0);
-  stay_t = gtk_constraint_solver_add_stay_variable (solver,
-                                                    layout_top,
-                                                    GTK_CONSTRAINT_STRENGTH_REQUIRED);
-  gtk_constraint_variable_set_value (layout_left, 0.0);
-  stay_l = gtk_constraint_solver_add_stay_variable (solver,
-                                                    layout_left,
-                                                    GTK_CONSTRAINT_STRENGTH_REQUIRED);
-  gtk_constraint_variable_set_value (layout_width, width);
-  stay_w = gtk_constraint_solver_add_stay_variable (solver,
-                                                    layout_width,
-                                                    GTK_CONSTRAINT_STRENGTH_REQUIRED);
-  gtk_constraint_variable_set_value (layout_height, height);
-  stay_h = gtk_constraint_solver_add_stay_variable (solver,
-                                                    layout_height,
-                                                    GTK_CONSTRAINT_STRENGTH_REQUIRED);
+  if (self->has_allocation_stays)
+    {
+      /* The layout was not measured or changed since the last allocation,
+       * so we can move the stays to the new size and let the solver start
+       * from the previous solution, instead of rebuilding the tableau
+       */
+      gtk_constraint_solver_freeze (solver);
+      gtk_constraint_solver_update_stay_variable (solver, layout_width, width);
+      gtk_constraint_solver_update_stay_variable (solver, layout_height, height);
+      gtk_constraint_solver_thaw (solver);
+    }
+  else
+    {
+      /* We add required stay constraints to ensure that the layout remains
+       * within the bounds of the allocation
+       */
+      gtk_constraint_variable_set_value (layout_top, 0.0);
+      gtk_constraint_solver_add_stay_variable (solver,
+                                               layout_top,
+                                               GTK_CONSTRAINT_STRENGTH_REQUIRED);
+      gtk_constraint_variable_set_value (layout_left, 0.0);
+      gtk_constraint_solver_add_stay_variable (solver,
+                                               layout_left,
+                                               GTK_CONSTRAINT_STRENGTH_REQUIRED);
+      gtk_constraint_variable_set_value (layout_width, width);
+      gtk_constraint_solver_add_stay_variable (solver,
+                                               layout_width,
+                                               GTK_CONSTRAINT_STRENGTH_REQUIRED);
+      gtk_constraint_variable_set_value (layout_height, height);
+      gtk_constraint_solver_add_stay_variable (solver,
+                                               layout_height,
+                                               GTK_CONSTRAINT_STRENGTH_REQUIRED);
+
+      self->has_allocation_stays = TRUE;
+    }
+
   GTK_DEBUG (LAYOUT, "Layout [%p]: { .x: %g, .y: %g, .w: %g, .h: %g }",
                      self,
                      gtk_constraint_variable_get_value (layout_left),
@@ -1120,12 +1189,6 @@ gtk_constraint_layout_allocate (GtkLayoutManager *manager,
                    gtk_constraint_variable_get_value (var_height));
         }
     }
-
-  /* The allocation stay constraints are not needed any more */
-  gtk_constraint_solver_remove_constraint (solver, stay_w);
-  gtk_constraint_solver_remove_constraint (solver, stay_h);
-  gtk_constraint_solver_remove_constraint (solver, stay_t);
-  gtk_constraint_solver_remove_constraint (solver, stay_l);
 }
 
 static void
@@ -1165,6 +1228,8 @@ gtk_constraint_layout_unroot (GtkLayoutManager *manager)
   GHashTableIter iter;
   gpointer key;
 
+  gtk_constraint_layout_release_allocation (self);
+
   /* Detach all constraints we're holding, as we're removing the layout
    * from the global solver, and they should not contribute to the other
    * layouts
@@ -207,6 +207,12 @@ typedef struct {
 
 typedef struct {
   GtkConstraintRef *constraint;
+
+  /* Only set for required stays */
+  GtkConstraintVariable *eplus;
+  GtkConstraintVariable *eminus;
+
+  double prev_constant;
 } StayInfo;
 
 struct _GtkConstraintSolver
@@ -1316,6 +1322,9 @@ gtk_constraint_solver_add_constraint_internal (GtkConstraintSolver *self,
       StayInfo *si = g_new (StayInfo, 1);
 
       si->constraint = constraint;
+      si->eplus = eplus;
+      si->eminus = eminus;
+      si->prev_constant = prev_constant;
 
       g_hash_table_insert (self->stay_var_map, constraint->variable, si);
     }
@@ -1652,6 +1661,59 @@ gtk_constraint_solver_remove_stay_variable (GtkConstraintSolver *self,
   gtk_constraint_solver_remove_constraint (self, si->constraint);
 }
 
+/*< private >
+ * gtk_constraint_solver_update_stay_variable:
+ * @self: a `GtkConstraintSolver`
+ * @variable: a required stay variable
+ * @value: the new value of @variable
+ *
+ * Moves the required stay constraint associated to @variable
+ * to @value.
+ *
+ * Unlike removing the stay and adding a new one, this only changes
+ * the constants in the tableau, and re-optimizes starting from the
+ * previous solution, in the same way gtk_constraint_solver_suggest_value()
+ * does for edit variables.
+ */
+void
+gtk_constraint_solver_update_stay_variable (GtkConstraintSolver *self,
+                                            GtkConstraintVariable *variable,
+                                            double value)
+{
+  StayInfo *si = g_hash_table_lookup (self->stay_var_map, variable);
+  double delta;
+
+  if (si == NULL)
+    {
+      char *str = gtk_constraint_variable_to_string (variable);
+
+      g_critical ("Unknown stay variable '%s'", str);
+
+      g_free (str);
+
+      return;
+    }
+
+  if (si->eplus == NULL)
+    {
+      g_critical ("Only required stay variables can be updated");
+      return;
+    }
+
+  delta = value - si->prev_constant;
+  if (delta == 0.0)
+    return;
+
+  si->prev_constant = value;
+
+  gtk_constraint_solver_delta_edit_constant (self, delta, si->eplus, si->eminus);
+
+  self->needs_solving = TRUE;
+
+  if (self->auto_solve)
+    gtk_constraint_solver_resolve (self);
+}
+
 /*< private >
  * gtk_constraint_solver_add_edit_variable:
  * @self: a `GtkConstraintSolver`
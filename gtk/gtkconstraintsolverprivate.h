@@ -67,6 +67,11 @@ void
 gtk_constraint_solver_remove_stay_variable (GtkConstraintSolver   *solver,
                                             GtkConstraintVariable *variable);
 
+void
+gtk_constraint_solver_update_stay_variable (GtkConstraintSolver   *solver,
+                                            GtkConstraintVariable *variable,
+                                            double                 value);
+
 gboolean
 gtk_constraint_solver_has_stay_variable (GtkConstraintSolver   *solver,
                                          GtkConstraintVariable *variable);
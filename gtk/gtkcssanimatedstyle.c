@@ -679,9 +679,9 @@ gtk_css_animated_style_create_css_transitions (GPtrArray   *animations,
   gboolean source_is_animated;
   guint i;
 
-  durations = base_style->transition->transition_duration;
-  delays = base_style->transition->transition_delay;
-  timing_functions = base_style->transition->transition_timing_function;
+  durations = gtk_css_style_get_transition_values (base_style)->transition_duration;
+  delays = gtk_css_style_get_transition_values (base_style)->transition_delay;
+  timing_functions = gtk_css_style_get_transition_values (base_style)->transition_timing_function;
 
   if (_gtk_css_array_value_get_n_values (durations) == 1 &&
       _gtk_css_array_value_get_n_values (delays) == 1 &&
@@ -689,7 +689,7 @@ gtk_css_animated_style_create_css_transitions (GPtrArray   *animations,
       _gtk_css_number_value_get (_gtk_css_array_value_get_nth (delays, 0), 100) == 0)
     return animations;
 
-  transition_infos_set (transitions, base_style->transition->transition_property);
+  transition_infos_set (transitions, gtk_css_style_get_transition_values (base_style)->transition_property);
 
   source_is_animated = GTK_IS_CSS_ANIMATED_STYLE (source);
   for (i = 0; i < GTK_CSS_PROPERTY_N_PROPERTIES; i++)
@@ -911,11 +911,11 @@ gtk_css_animated_style_new (GtkCssStyle      *base_style,
   style->background = (GtkCssBackgroundValues *)gtk_css_values_ref ((GtkCssValues *)base_style->background);
   style->border = (GtkCssBorderValues *)gtk_css_values_ref ((GtkCssValues *)base_style->border);
   style->icon = (GtkCssIconValues *)gtk_css_values_ref ((GtkCssValues *)base_style->icon);
-  style->outline = (GtkCssOutlineValues *)gtk_css_values_ref ((GtkCssValues *)base_style->outline);
+  style->outline = (GtkCssOutlineValues *)gtk_css_values_ref ((GtkCssValues *)gtk_css_style_get_outline_values (base_style));
   style->font = (GtkCssFontValues *)gtk_css_values_ref ((GtkCssValues *)base_style->font);
-  style->font_variant = (GtkCssFontVariantValues *)gtk_css_values_ref ((GtkCssValues *)base_style->font_variant);
+  style->font_variant = (GtkCssFontVariantValues *)gtk_css_values_ref ((GtkCssValues *)gtk_css_style_get_font_variant_values (base_style));
   style->animation = (GtkCssAnimationValues *)gtk_css_values_ref ((GtkCssValues *)base_style->animation);
-  style->transition = (GtkCssTransitionValues *)gtk_css_values_ref ((GtkCssValues *)base_style->transition);
+  style->transition = (GtkCssTransitionValues *)gtk_css_values_ref ((GtkCssValues *)gtk_css_style_get_transition_values (base_style));
   style->size = (GtkCssSizeValues *)gtk_css_values_ref ((GtkCssValues *)base_style->size);
   style->other = (GtkCssOtherValues *)gtk_css_values_ref ((GtkCssValues *)base_style->other);
 
@@ -975,11 +975,11 @@ gtk_css_animated_style_new_advance (GtkCssAnimatedStyle *source,
   style->background = (GtkCssBackgroundValues *)gtk_css_values_ref ((GtkCssValues *)base_style->background);
   style->border = (GtkCssBorderValues *)gtk_css_values_ref ((GtkCssValues *)base_style->border);
   style->icon = (GtkCssIconValues *)gtk_css_values_ref ((GtkCssValues *)base_style->icon);
-  style->outline = (GtkCssOutlineValues *)gtk_css_values_ref ((GtkCssValues *)base_style->outline);
+  style->outline = (GtkCssOutlineValues *)gtk_css_values_ref ((GtkCssValues *)gtk_css_style_get_outline_values (base_style));
   style->font = (GtkCssFontValues *)gtk_css_values_ref ((GtkCssValues *)base_style->font);
-  style->font_variant = (GtkCssFontVariantValues *)gtk_css_values_ref ((GtkCssValues *)base_style->font_variant);
+  style->font_variant = (GtkCssFontVariantValues *)gtk_css_values_ref ((GtkCssValues *)gtk_css_style_get_font_variant_values (base_style));
   style->animation = (GtkCssAnimationValues *)gtk_css_values_ref ((GtkCssValues *)base_style->animation);
-  style->transition = (GtkCssTransitionValues *)gtk_css_values_ref ((GtkCssValues *)base_style->transition);
+  style->transition = (GtkCssTransitionValues *)gtk_css_values_ref ((GtkCssValues *)gtk_css_style_get_transition_values (base_style));
   style->size = (GtkCssSizeValues *)gtk_css_values_ref ((GtkCssValues *)base_style->size);
   style->other = (GtkCssOtherValues *)gtk_css_values_ref ((GtkCssValues *)base_style->other);
 
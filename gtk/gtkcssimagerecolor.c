@@ -181,6 +181,19 @@ gtk_css_image_recolor_snapshot (GtkCssImage *image,
   if (recolor->texture == NULL)
     return;
 
+  if (gdk_texture_get_format (recolor->texture) == GDK_MEMORY_A8)
+    {
+      /* Only uses the foreground color, see gdktextureutils.c */
+      gtk_snapshot_push_mask (snapshot, GSK_MASK_MODE_ALPHA);
+      gtk_snapshot_append_texture (snapshot,
+                                   recolor->texture,
+                                   &GRAPHENE_RECT_INIT (0, 0, width, height));
+      gtk_snapshot_pop (snapshot);
+      gtk_snapshot_append_color (snapshot, fg, &GRAPHENE_RECT_INIT (0, 0, width, height));
+      gtk_snapshot_pop (snapshot);
+      return;
+    }
+
   graphene_matrix_init_from_float (&matrix,
           (float[16]) {
                        sc->red - fg->red, sc->green - fg->green, sc->blue - fg->blue, 0,
@@ -21,6 +21,7 @@
 
 #include "gtkcssstaticstyleprivate.h"
 #include "gtkcssanimatedstyleprivate.h"
+#include "gtkcssselectorprivate.h"
 #include "gtkcssstylepropertyprivate.h"
 #include "gtkmarshalers.h"
 #include "gtksettingsprivate.h"
@@ -126,6 +127,11 @@ static int created_styles;
 static guint invalidated_nodes_counter;
 static guint created_styles_counter;
 
+static gboolean validate_statistics_enabled;
+static gboolean collect_validate_statistics;
+static GtkCssValidateStatistics current_statistics;
+static GtkCssValidateStatistics last_statistics;
+
 static void
 gtk_css_node_set_invalid (GtkCssNode *node,
                           gboolean    invalid)
@@ -371,6 +377,7 @@ gtk_css_node_create_style (GtkCssNode                   *cssnode,
     return g_object_ref (style);
 
   created_styles++;
+  current_statistics.n_created++;
 
   if (change & GTK_CSS_CHANGE_NEEDS_RECOMPUTE)
     {
@@ -945,6 +952,15 @@ gtk_css_node_do_ensure_style (GtkCssNode                   *cssnode,
   if (cssnode->style_is_invalid)
     {
       GtkCssStyle *new_style;
+      gint64 before G_GNUC_UNUSED;
+
+      before = GDK_PROFILER_CURRENT_TIME;
+
+      if (collect_validate_statistics)
+        {
+          current_statistics.n_validated++;
+          current_statistics.change |= cssnode->pending_changes;
+        }
 
       g_clear_pointer (&cssnode->cache, gtk_css_node_style_cache_unref);
 
@@ -956,6 +972,19 @@ gtk_css_node_do_ensure_style (GtkCssNode                   *cssnode,
 
       style_changed = gtk_css_node_set_style (cssnode, new_style);
       g_object_unref (new_style);
+
+      if (GDK_PROFILER_IS_RUNNING)
+        {
+          char *node_string = gtk_css_node_declaration_to_string (cssnode->decl);
+          char *change_string = gtk_css_change_to_string (cssnode->pending_changes);
+
+          gdk_profiler_end_markf (before, "Restyle CSS node", "%s (%s)%s",
+                                  node_string, change_string,
+                                  style_changed ? "" : ", unchanged");
+
+          g_free (change_string);
+          g_free (node_string);
+        }
     }
   else
     {
@@ -1242,6 +1271,37 @@ gtk_css_node_get_declaration (GtkCssNode *cssnode)
   return cssnode->decl;
 }
 
+/*
+ * gtk_css_node_invalidate_style_provider_for_keys:
+ * @cssnode: a node
+ * @keys: keys of the selectors that changed
+ *
+ * Like gtk_css_node_invalidate_style_provider(), but only restyles
+ * nodes that may match one of the changed selectors. Their children
+ * are updated by the usual parent style propagation.
+ */
+void
+gtk_css_node_invalidate_style_provider_for_keys (GtkCssNode               *cssnode,
+                                                 const GtkCssSelectorKeys *keys)
+{
+  GtkCssNode *child;
+
+  /* The styles in the cache may have been computed from changed
+   * rules, even if this node is not affected itself. */
+  g_clear_pointer (&cssnode->cache, gtk_css_node_style_cache_unref);
+
+  if (gtk_css_selector_keys_may_match (keys, cssnode))
+    gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_SOURCE);
+
+  for (child = cssnode->first_child;
+       child;
+       child = child->next_sibling)
+    {
+      if (gtk_css_node_get_style_provider_or_null (child) == NULL)
+        gtk_css_node_invalidate_style_provider_for_keys (child, keys);
+    }
+}
+
 void
 gtk_css_node_invalidate_style_provider (GtkCssNode *cssnode)
 {
@@ -1346,6 +1406,14 @@ gtk_css_node_validate_internal (GtkCssNode             *cssnode,
     gtk_css_node_declaration_remove_bloom_hashes (cssnode->decl, filter);
 }
 
+/* Style computation has to run on the main thread. Computed values
+ * share non-atomically refcounted GtkCssValues with the providers and
+ * with other nodes, the style cache and the initial values are global,
+ * and computing some values loads images or looks up icons. The style
+ * of a node also depends on the new style of its parent and on the
+ * change flags propagated from its previous siblings, so subtrees are
+ * only independent once their parents have been validated.
+ */
 void
 gtk_css_node_validate (GtkCssNode *cssnode)
 {
@@ -1359,11 +1427,48 @@ gtk_css_node_validate (GtkCssNode *cssnode)
 
   timestamp = gtk_css_node_get_timestamp (cssnode);
 
+  collect_validate_statistics = validate_statistics_enabled || GDK_PROFILER_IS_RUNNING;
+  if (collect_validate_statistics)
+    {
+      current_statistics = (GtkCssValidateStatistics) { 0, };
+      current_statistics.total_time = g_get_monotonic_time ();
+      gtk_css_static_style_start_timing ();
+    }
+
   gtk_css_node_validate_internal (cssnode, &filter, timestamp);
 
+  if (collect_validate_statistics)
+    {
+      gtk_css_static_style_stop_timing (&current_statistics.match_time,
+                                        &current_statistics.compute_time);
+      current_statistics.total_time = g_get_monotonic_time () - current_statistics.total_time;
+      collect_validate_statistics = FALSE;
+
+      /* Keep the last validation that did something */
+      if (current_statistics.n_validated > 0)
+        last_statistics = current_statistics;
+    }
+
   if (GDK_PROFILER_IS_RUNNING)
     {
-      gdk_profiler_end_mark (before,  "Validate CSS", "");
+      if (current_statistics.n_validated > 0)
+        {
+          char *change_string = gtk_css_change_to_string (current_statistics.change);
+
+          gdk_profiler_end_markf (before, "Validate CSS",
+                                  "%u nodes, %u new styles, matching %" G_GINT64_FORMAT " µs, computing %" G_GINT64_FORMAT " µs (%s)",
+                                  current_statistics.n_validated,
+                                  current_statistics.n_created,
+                                  current_statistics.match_time,
+                                  current_statistics.compute_time,
+                                  change_string);
+
+          g_free (change_string);
+        }
+      else
+        {
+          gdk_profiler_end_mark (before,  "Validate CSS", "");
+        }
       gdk_profiler_set_int_counter (invalidated_nodes_counter, invalidated_nodes);
       gdk_profiler_set_int_counter (created_styles_counter, created_styles);
       invalidated_nodes = 0;
@@ -1371,6 +1476,31 @@ gtk_css_node_validate (GtkCssNode *cssnode)
     }
 }
 
+/*
+ * gtk_css_node_enable_validate_statistics:
+ *
+ * Makes gtk_css_node_validate() collect statistics even when the
+ * profiler is not running. This is used by the inspector.
+ */
+void
+gtk_css_node_enable_validate_statistics (void)
+{
+  validate_statistics_enabled = TRUE;
+}
+
+/*
+ * gtk_css_node_get_validate_statistics:
+ * @stats: (out): return location for the statistics
+ *
+ * Gets the statistics of the last call to gtk_css_node_validate()
+ * that recomputed any styles.
+ */
+void
+gtk_css_node_get_validate_statistics (GtkCssValidateStatistics *stats)
+{
+  *stats = last_statistics;
+}
+
 GtkStyleProvider *
 gtk_css_node_get_style_provider (GtkCssNode *cssnode)
 {
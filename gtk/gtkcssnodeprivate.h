@@ -142,6 +142,9 @@ const GtkCssNodeDeclaration *
 GtkCssStyle *           gtk_css_node_get_style          (GtkCssNode            *cssnode) G_GNUC_PURE;
 
 
+void                    gtk_css_node_invalidate_style_provider_for_keys
+                                                        (GtkCssNode            *cssnode,
+                                                         const GtkCssSelectorKeys *keys);
 void                    gtk_css_node_invalidate_style_provider
                                                         (GtkCssNode            *cssnode);
 void                    gtk_css_node_invalidate_frame_clock
@@ -151,6 +154,21 @@ void                    gtk_css_node_invalidate         (GtkCssNode            *
                                                          GtkCssChange           change);
 void                    gtk_css_node_validate           (GtkCssNode            *cssnode);
 
+typedef struct
+{
+  guint                 n_validated;    /* nodes whose style was recomputed */
+  guint                 n_created;      /* static styles that had to be created */
+  GtkCssChange          change;         /* union of the changes that caused recomputation */
+  gint64                match_time;     /* in µs, spent matching selectors */
+  gint64                compute_time;   /* in µs, spent computing values */
+  gint64                total_time;     /* in µs, spent in gtk_css_node_validate() */
+} GtkCssValidateStatistics;
+
+void                    gtk_css_node_enable_validate_statistics
+                                                        (void);
+void                    gtk_css_node_get_validate_statistics
+                                                        (GtkCssValidateStatistics *stats);
+
 GtkStyleProvider *      gtk_css_node_get_style_provider (GtkCssNode            *cssnode) G_GNUC_PURE;
 
 typedef enum {
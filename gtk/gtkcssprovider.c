@@ -113,6 +113,10 @@ struct GtkCssRuleset
   PropertyValue *styles;
   guint n_styles;
   guint owns_styles : 1;
+  /* Kept after the selector is freed, to compare rulesets on reload */
+  GtkCssSelectorKeyType key_type : 2;
+  GQuark key;
+  guint64 fingerprint;
 };
 
 struct _GtkCssScanner
@@ -995,6 +999,9 @@ gtk_css_provider_postprocess (GtkCssProvider *css_provider)
 
       ruleset = &g_array_index (priv->rulesets, GtkCssRuleset, i);
 
+      ruleset->fingerprint = gtk_css_selector_get_fingerprint (ruleset->selector);
+      ruleset->key_type = gtk_css_selector_get_key (ruleset->selector, &ruleset->key);
+
       _gtk_css_selector_tree_builder_add (builder,
 					  ruleset->selector,
 					  &ruleset->selector_match,
@@ -1086,6 +1093,248 @@ gtk_css_provider_load_internal (GtkCssProvider *self,
     }
 }
 
+static gboolean
+gtk_css_sections_equal (GtkCssSection *a,
+                        GtkCssSection *b)
+{
+  if (a == b)
+    return TRUE;
+
+  if (a == NULL || b == NULL)
+    return FALSE;
+
+  if (gtk_css_section_get_start_location (a)->bytes != gtk_css_section_get_start_location (b)->bytes ||
+      gtk_css_section_get_end_location (a)->bytes != gtk_css_section_get_end_location (b)->bytes)
+    return FALSE;
+
+  if (gtk_css_section_get_file (a) == gtk_css_section_get_file (b))
+    return TRUE;
+
+  if (gtk_css_section_get_file (a) == NULL || gtk_css_section_get_file (b) == NULL)
+    return FALSE;
+
+  return g_file_equal (gtk_css_section_get_file (a), gtk_css_section_get_file (b));
+}
+
+static gboolean
+gtk_css_ruleset_equal (const GtkCssRuleset *a,
+                       const GtkCssRuleset *b)
+{
+  guint i;
+
+  if (a->fingerprint != b->fingerprint ||
+      a->n_styles != b->n_styles)
+    return FALSE;
+
+  for (i = 0; i < a->n_styles; i++)
+    {
+      if (a->styles[i].property != b->styles[i].property ||
+          !_gtk_css_value_equal (a->styles[i].value, b->styles[i].value) ||
+          !gtk_css_sections_equal (a->styles[i].section, b->styles[i].section))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+gtk_css_provider_colors_equal (GHashTable *a,
+                               GHashTable *b)
+{
+  GHashTableIter iter;
+  gpointer key, value;
+
+  if (g_hash_table_size (a) != g_hash_table_size (b))
+    return FALSE;
+
+  g_hash_table_iter_init (&iter, a);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      GtkCssValue *other = g_hash_table_lookup (b, key);
+
+      if (other == NULL || !_gtk_css_value_equal (value, other))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void gtk_css_provider_print_keyframes (GHashTable *keyframes,
+                                              GString    *str);
+
+static gboolean
+gtk_css_provider_keyframes_equal (GHashTable *a,
+                                  GHashTable *b)
+{
+  GString *sa, *sb;
+  gboolean result;
+
+  if (g_hash_table_size (a) != g_hash_table_size (b))
+    return FALSE;
+
+  if (g_hash_table_size (a) == 0)
+    return TRUE;
+
+  sa = g_string_new (NULL);
+  sb = g_string_new (NULL);
+  gtk_css_provider_print_keyframes (a, sa);
+  gtk_css_provider_print_keyframes (b, sb);
+  result = g_string_equal (sa, sb);
+  g_string_free (sa, TRUE);
+  g_string_free (sb, TRUE);
+
+  return result;
+}
+
+/* Compares the rulesets before and after a reload and collects the
+ * keys of all selectors that were added, removed or changed. Only
+ * nodes matching one of those keys can have a different style.
+ *
+ * Unchanged rulesets are paired up in order, so that rulesets whose
+ * relative order changed are treated as changed, too.
+ *
+ * Returns NULL if all nodes need to be restyled.
+ */
+static GtkCssSelectorKeys *
+gtk_css_provider_diff (GtkCssProvider *self,
+                       GArray         *old_rulesets,
+                       GHashTable     *old_colors,
+                       GHashTable     *old_keyframes)
+{
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (self);
+  GtkCssSelectorKeys *keys;
+  GHashTable *old_by_fingerprint;
+  gboolean *old_matched;
+  guint i, next_old;
+
+  /* Named colors and keyframes are looked up while computing styles,
+   * we can't tell which nodes use them */
+  if (!gtk_css_provider_colors_equal (old_colors, priv->symbolic_colors) ||
+      !gtk_css_provider_keyframes_equal (old_keyframes, priv->keyframes))
+    return NULL;
+
+  keys = gtk_css_selector_keys_new ();
+  old_matched = g_new0 (gboolean, old_rulesets->len);
+  old_by_fingerprint = g_hash_table_new_full (g_int64_hash, g_int64_equal, NULL, (GDestroyNotify) g_array_unref);
+
+  for (i = 0; i < old_rulesets->len; i++)
+    {
+      GtkCssRuleset *ruleset = &g_array_index (old_rulesets, GtkCssRuleset, i);
+      GArray *indexes;
+
+      indexes = g_hash_table_lookup (old_by_fingerprint, &ruleset->fingerprint);
+      if (indexes == NULL)
+        {
+          indexes = g_array_new (FALSE, FALSE, sizeof (guint));
+          g_hash_table_insert (old_by_fingerprint, &ruleset->fingerprint, indexes);
+        }
+      g_array_append_val (indexes, i);
+    }
+
+  next_old = 0;
+  for (i = 0; i < priv->rulesets->len; i++)
+    {
+      GtkCssRuleset *ruleset = &g_array_index (priv->rulesets, GtkCssRuleset, i);
+      GArray *indexes;
+      guint j;
+
+      indexes = g_hash_table_lookup (old_by_fingerprint, &ruleset->fingerprint);
+      if (indexes)
+        {
+          for (j = 0; j < indexes->len; j++)
+            {
+              guint old = g_array_index (indexes, guint, j);
+
+              if (old < next_old || old_matched[old])
+                continue;
+
+              if (gtk_css_ruleset_equal (ruleset, &g_array_index (old_rulesets, GtkCssRuleset, old)))
+                {
+                  old_matched[old] = TRUE;
+                  next_old = old + 1;
+                  break;
+                }
+            }
+
+          if (j < indexes->len)
+            continue;
+        }
+
+      gtk_css_selector_keys_add (keys, ruleset->key_type, ruleset->key);
+      if (gtk_css_selector_keys_match_all (keys))
+        break;
+    }
+
+  for (i = 0; i < old_rulesets->len && !gtk_css_selector_keys_match_all (keys); i++)
+    {
+      GtkCssRuleset *ruleset = &g_array_index (old_rulesets, GtkCssRuleset, i);
+
+      if (!old_matched[i])
+        gtk_css_selector_keys_add (keys, ruleset->key_type, ruleset->key);
+    }
+
+  g_hash_table_unref (old_by_fingerprint);
+  g_free (old_matched);
+
+  if (gtk_css_selector_keys_match_all (keys))
+    {
+      gtk_css_selector_keys_free (keys);
+      return NULL;
+    }
+
+  return keys;
+}
+
+/* Replaces the contents of the provider with @file or @bytes and
+ * restyles the nodes that are affected by the difference.
+ */
+static void
+gtk_css_provider_reload (GtkCssProvider *self,
+                         GFile          *file,
+                         GBytes         *bytes)
+{
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (self);
+  GArray *old_rulesets;
+  GHashTable *old_colors, *old_keyframes;
+  GtkCssSelectorKeys *keys;
+  guint i;
+
+  old_rulesets = priv->rulesets;
+  old_colors = priv->symbolic_colors;
+  old_keyframes = priv->keyframes;
+
+  priv->rulesets = g_array_new (FALSE, FALSE, sizeof (GtkCssRuleset));
+  priv->symbolic_colors = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                 (GDestroyNotify) g_free,
+                                                 (GDestroyNotify) _gtk_css_value_unref);
+  priv->keyframes = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                           (GDestroyNotify) g_free,
+                                           (GDestroyNotify) _gtk_css_keyframes_unref);
+
+  gtk_css_provider_reset (self);
+
+  gtk_css_provider_load_internal (self, NULL, file, bytes);
+
+  keys = gtk_css_provider_diff (self, old_rulesets, old_colors, old_keyframes);
+
+  for (i = 0; i < old_rulesets->len; i++)
+    gtk_css_ruleset_clear (&g_array_index (old_rulesets, GtkCssRuleset, i));
+  g_array_free (old_rulesets, TRUE);
+  g_hash_table_unref (old_colors);
+  g_hash_table_unref (old_keyframes);
+
+  if (keys == NULL)
+    {
+      gtk_style_provider_changed (GTK_STYLE_PROVIDER (self));
+    }
+  else
+    {
+      if (!gtk_css_selector_keys_is_empty (keys))
+        gtk_style_provider_changed_for_keys (GTK_STYLE_PROVIDER (self), keys);
+      gtk_css_selector_keys_free (keys);
+    }
+}
+
 /**
  * gtk_css_provider_load_from_data:
  * @css_provider: a `GtkCssProvider`
@@ -1164,11 +1413,7 @@ gtk_css_provider_load_from_bytes (GtkCssProvider *css_provider,
   g_return_if_fail (GTK_IS_CSS_PROVIDER (css_provider));
   g_return_if_fail (data != NULL);
 
-  gtk_css_provider_reset (css_provider);
-
-  gtk_css_provider_load_internal (css_provider, NULL, NULL, g_bytes_ref (data));
-
-  gtk_style_provider_changed (GTK_STYLE_PROVIDER (css_provider));
+  gtk_css_provider_reload (css_provider, NULL, g_bytes_ref (data));
 }
 
 /**
@@ -1187,11 +1432,7 @@ gtk_css_provider_load_from_file (GtkCssProvider  *css_provider,
   g_return_if_fail (GTK_IS_CSS_PROVIDER (css_provider));
   g_return_if_fail (G_IS_FILE (file));
 
-  gtk_css_provider_reset (css_provider);
-
-  gtk_css_provider_load_internal (css_provider, NULL, file, NULL);
-
-  gtk_style_provider_changed (GTK_STYLE_PROVIDER (css_provider));
+  gtk_css_provider_reload (css_provider, file, NULL);
 }
 
 /**
@@ -1391,7 +1632,10 @@ gtk_css_provider_load_named (GtkCssProvider *provider,
   g_return_if_fail (GTK_IS_CSS_PROVIDER (provider));
   g_return_if_fail (name != NULL);
 
-  gtk_css_provider_reset (provider);
+  /* No reset here, the load functions below replace the contents,
+   * and comparing against the previous theme lets us restyle only
+   * what changed.
+   */
 
   /* try loading the resource for the theme. This is mostly meant for built-in
    * themes.
@@ -126,6 +126,36 @@ struct _GtkCssSelectorTree
   gint32 matches_offset; /* pointers that we return as matches if selector matches */
 };
 
+/* The roots of a tree are indexed by the name, id or class a node must
+ * have for them to match, so matching only needs to visit the roots that
+ * can match a given node instead of every root of the tree.
+ */
+typedef enum {
+  GTK_CSS_SELECTOR_TREE_ROOT_NAME,
+  GTK_CSS_SELECTOR_TREE_ROOT_ID,
+  GTK_CSS_SELECTOR_TREE_ROOT_CLASS,
+  GTK_CSS_SELECTOR_TREE_ROOT_OTHER,
+  GTK_CSS_SELECTOR_TREE_N_ROOT_TYPES
+} GtkCssSelectorTreeRootType;
+
+typedef struct
+{
+  GQuark key;
+  gint32 offset; /* of the root, relative to the index */
+} GtkCssSelectorTreeRoot;
+
+/* Stored in front of the first root, the roots array follows the tree
+ * and is sorted by type and key */
+typedef struct
+{
+  guint32 roots_offset;
+  guint32 roots_start[GTK_CSS_SELECTOR_TREE_N_ROOT_TYPES];
+  guint32 n_roots;
+  guint32 padding;
+} GtkCssSelectorTreeIndex;
+
+G_STATIC_ASSERT (sizeof (GtkCssSelectorTreeIndex) % sizeof (gpointer) == 0);
+
 static gboolean
 gtk_css_selector_equal (const GtkCssSelector *a,
 			const GtkCssSelector *b)
@@ -1735,6 +1765,183 @@ gtk_css_selector_is_simple (const GtkCssSelector *selector)
   }
 }
 
+/*
+ * gtk_css_selector_get_fingerprint:
+ * @selector: a selector
+ *
+ * Computes a 64bit hash of the whole @selector. Equal selectors
+ * have equal fingerprints, and different selectors are practically
+ * guaranteed to have different ones, so it can be kept to identify
+ * a selector after it has been freed.
+ *
+ * Returns: the fingerprint
+ */
+guint64
+gtk_css_selector_get_fingerprint (const GtkCssSelector *selector)
+{
+  const guchar *data = (const guchar *) selector;
+  gsize i, size;
+  guint64 hash;
+
+  /* Selectors are zeroed before being filled in, so hashing the
+   * bytes is the same as hashing the values */
+  size = gtk_css_selector_size (selector) * sizeof (GtkCssSelector);
+
+  /* FNV-1a */
+  hash = G_GUINT64_CONSTANT (0xcbf29ce484222325);
+  for (i = 0; i < size; i++)
+    {
+      hash ^= data[i];
+      hash *= G_GUINT64_CONSTANT (0x100000001b3);
+    }
+
+  return hash;
+}
+
+/*
+ * gtk_css_selector_get_key:
+ * @selector: a selector
+ * @out_quark: (out): the quark for the returned key type
+ *
+ * Finds the most specific id, class or name that a node must have
+ * to match @selector. If there is none, %GTK_CSS_SELECTOR_KEY_ANY
+ * is returned.
+ *
+ * Returns: the type of key
+ */
+GtkCssSelectorKeyType
+gtk_css_selector_get_key (const GtkCssSelector *selector,
+                          GQuark               *out_quark)
+{
+  GtkCssSelectorKeyType type = GTK_CSS_SELECTOR_KEY_ANY;
+
+  *out_quark = 0;
+
+  for (; selector && gtk_css_selector_is_simple (selector);
+       selector = gtk_css_selector_previous (selector))
+    {
+      if (selector->class == &GTK_CSS_SELECTOR_ID)
+        {
+          *out_quark = selector->id.name;
+          return GTK_CSS_SELECTOR_KEY_ID;
+        }
+      else if (selector->class == &GTK_CSS_SELECTOR_CLASS)
+        {
+          *out_quark = selector->style_class.style_class;
+          type = GTK_CSS_SELECTOR_KEY_CLASS;
+        }
+      else if (selector->class == &GTK_CSS_SELECTOR_NAME &&
+               type == GTK_CSS_SELECTOR_KEY_ANY)
+        {
+          *out_quark = selector->name.name;
+          type = GTK_CSS_SELECTOR_KEY_NAME;
+        }
+    }
+
+  return type;
+}
+
+/* A set of selector keys, used to find the nodes that may be
+ * affected by a set of changed selectors.
+ */
+struct _GtkCssSelectorKeys
+{
+  gboolean    match_all;
+  GHashTable *names;
+  GHashTable *classes;
+  GHashTable *ids;
+};
+
+GtkCssSelectorKeys *
+gtk_css_selector_keys_new (void)
+{
+  GtkCssSelectorKeys *keys;
+
+  keys = g_new0 (GtkCssSelectorKeys, 1);
+  keys->names = g_hash_table_new (NULL, NULL);
+  keys->classes = g_hash_table_new (NULL, NULL);
+  keys->ids = g_hash_table_new (NULL, NULL);
+
+  return keys;
+}
+
+void
+gtk_css_selector_keys_free (GtkCssSelectorKeys *keys)
+{
+  g_hash_table_unref (keys->names);
+  g_hash_table_unref (keys->classes);
+  g_hash_table_unref (keys->ids);
+  g_free (keys);
+}
+
+void
+gtk_css_selector_keys_add (GtkCssSelectorKeys    *keys,
+                           GtkCssSelectorKeyType  type,
+                           GQuark                 quark)
+{
+  switch (type)
+    {
+    case GTK_CSS_SELECTOR_KEY_ANY:
+      keys->match_all = TRUE;
+      break;
+    case GTK_CSS_SELECTOR_KEY_NAME:
+      g_hash_table_add (keys->names, GUINT_TO_POINTER (quark));
+      break;
+    case GTK_CSS_SELECTOR_KEY_CLASS:
+      g_hash_table_add (keys->classes, GUINT_TO_POINTER (quark));
+      break;
+    case GTK_CSS_SELECTOR_KEY_ID:
+      g_hash_table_add (keys->ids, GUINT_TO_POINTER (quark));
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+gboolean
+gtk_css_selector_keys_is_empty (const GtkCssSelectorKeys *keys)
+{
+  return !keys->match_all &&
+         g_hash_table_size (keys->names) == 0 &&
+         g_hash_table_size (keys->classes) == 0 &&
+         g_hash_table_size (keys->ids) == 0;
+}
+
+gboolean
+gtk_css_selector_keys_match_all (const GtkCssSelectorKeys *keys)
+{
+  return keys->match_all;
+}
+
+gboolean
+gtk_css_selector_keys_may_match (const GtkCssSelectorKeys *keys,
+                                 GtkCssNode               *node)
+{
+  const GQuark *classes;
+  guint i, n_classes;
+
+  if (keys->match_all)
+    return TRUE;
+
+  if (g_hash_table_contains (keys->names, GUINT_TO_POINTER (gtk_css_node_get_name (node))))
+    return TRUE;
+
+  if (g_hash_table_contains (keys->ids, GUINT_TO_POINTER (gtk_css_node_get_id (node))))
+    return TRUE;
+
+  if (g_hash_table_size (keys->classes) > 0)
+    {
+      classes = gtk_css_node_list_classes (node, &n_classes);
+      for (i = 0; i < n_classes; i++)
+        {
+          if (g_hash_table_contains (keys->classes, GUINT_TO_POINTER (classes[i])))
+            return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
 static GHashTable *
 gtk_css_selectors_count_initial_init (void)
 {
@@ -1924,19 +2131,97 @@ gtk_css_selector_tree_match (const GtkCssSelectorTree      *tree,
   return TRUE;
 }
 
+static inline const GtkCssSelectorTreeIndex *
+gtk_css_selector_tree_get_index (const GtkCssSelectorTree *tree)
+{
+  return (const GtkCssSelectorTreeIndex *) ((const guint8 *) tree - sizeof (GtkCssSelectorTreeIndex));
+}
+
+static inline const GtkCssSelectorTreeRoot *
+gtk_css_selector_tree_index_get_roots (const GtkCssSelectorTreeIndex *index,
+                                       GtkCssSelectorTreeRootType     type,
+                                       guint                         *n_roots)
+{
+  const GtkCssSelectorTreeRoot *roots;
+  guint end;
+
+  roots = (const GtkCssSelectorTreeRoot *) ((const guint8 *) index + index->roots_offset);
+
+  if (type + 1 < GTK_CSS_SELECTOR_TREE_N_ROOT_TYPES)
+    end = index->roots_start[type + 1];
+  else
+    end = index->n_roots;
+
+  *n_roots = end - index->roots_start[type];
+
+  return roots + index->roots_start[type];
+}
+
+static const GtkCssSelectorTree *
+gtk_css_selector_tree_index_lookup (const GtkCssSelectorTreeIndex *index,
+                                    GtkCssSelectorTreeRootType     type,
+                                    GQuark                         key)
+{
+  const GtkCssSelectorTreeRoot *roots;
+  guint min, max, mid, n_roots;
+
+  roots = gtk_css_selector_tree_index_get_roots (index, type, &n_roots);
+
+  min = 0;
+  max = n_roots;
+  while (min < max)
+    {
+      mid = (min + max) / 2;
+
+      if (roots[mid].key == key)
+        return (const GtkCssSelectorTree *) ((const guint8 *) index + roots[mid].offset);
+      else if (roots[mid].key < key)
+        min = mid + 1;
+      else
+        max = mid;
+    }
+
+  return NULL;
+}
+
 void
 _gtk_css_selector_tree_match_all (const GtkCssSelectorTree     *tree,
                                   const GtkCountingBloomFilter *filter,
                                   GtkCssNode                   *node,
                                   GtkCssSelectorMatches        *out_tree_rules)
 {
-  const GtkCssSelectorTree *iter;
+  const GtkCssSelectorTreeIndex *index;
+  const GtkCssSelectorTreeRoot *roots;
+  const GtkCssSelectorTree *root;
+  const GQuark *classes;
+  guint i, n_roots, n_classes;
+
+  if (tree == NULL)
+    return;
+
+  index = gtk_css_selector_tree_get_index (tree);
+
+  root = gtk_css_selector_tree_index_lookup (index, GTK_CSS_SELECTOR_TREE_ROOT_NAME, gtk_css_node_get_name (node));
+  if (root)
+    gtk_css_selector_tree_match (root, filter, FALSE, node, out_tree_rules);
+
+  root = gtk_css_selector_tree_index_lookup (index, GTK_CSS_SELECTOR_TREE_ROOT_ID, gtk_css_node_get_id (node));
+  if (root)
+    gtk_css_selector_tree_match (root, filter, FALSE, node, out_tree_rules);
+
+  classes = gtk_css_node_list_classes (node, &n_classes);
+  for (i = 0; i < n_classes; i++)
+    {
+      root = gtk_css_selector_tree_index_lookup (index, GTK_CSS_SELECTOR_TREE_ROOT_CLASS, classes[i]);
+      if (root)
+        gtk_css_selector_tree_match (root, filter, FALSE, node, out_tree_rules);
+    }
 
-  for (iter = tree;
-       iter != NULL;
-       iter = gtk_css_selector_tree_get_sibling (iter))
+  roots = gtk_css_selector_tree_index_get_roots (index, GTK_CSS_SELECTOR_TREE_ROOT_OTHER, &n_roots);
+  for (i = 0; i < n_roots; i++)
     {
-      gtk_css_selector_tree_match (iter, filter, FALSE, node, out_tree_rules);
+      root = (const GtkCssSelectorTree *) ((const guint8 *) index + roots[i].offset);
+      gtk_css_selector_tree_match (root, filter, FALSE, node, out_tree_rules);
     }
 }
 
@@ -2070,7 +2355,7 @@ _gtk_css_selector_tree_free (GtkCssSelectorTree *tree)
   if (tree == NULL)
     return;
 
-  g_free (tree);
+  g_free ((gpointer) gtk_css_selector_tree_get_index (tree));
 }
 
 
@@ -2245,6 +2530,95 @@ _gtk_css_selector_tree_builder_add (GtkCssSelectorTreeBuilder *builder,
   info->selector_match = selector_match;
 }
 
+static GtkCssSelectorTreeRootType
+gtk_css_selector_tree_get_root_type (const GtkCssSelectorTree *tree,
+                                     GQuark                   *key)
+{
+  if (tree->selector.class == &GTK_CSS_SELECTOR_NAME)
+    {
+      *key = tree->selector.name.name;
+      return GTK_CSS_SELECTOR_TREE_ROOT_NAME;
+    }
+  else if (tree->selector.class == &GTK_CSS_SELECTOR_ID)
+    {
+      *key = tree->selector.id.name;
+      return GTK_CSS_SELECTOR_TREE_ROOT_ID;
+    }
+  else if (tree->selector.class == &GTK_CSS_SELECTOR_CLASS)
+    {
+      *key = tree->selector.style_class.style_class;
+      return GTK_CSS_SELECTOR_TREE_ROOT_CLASS;
+    }
+
+  *key = 0;
+  return GTK_CSS_SELECTOR_TREE_ROOT_OTHER;
+}
+
+typedef struct
+{
+  GtkCssSelectorTreeRootType type;
+  GtkCssSelectorTreeRoot root;
+} RootInfo;
+
+static int
+compare_root_info (gconstpointer a,
+                   gconstpointer b)
+{
+  const RootInfo *ra = a;
+  const RootInfo *rb = b;
+
+  if (ra->type != rb->type)
+    return ra->type < rb->type ? -1 : 1;
+
+  if (ra->root.key != rb->root.key)
+    return ra->root.key < rb->root.key ? -1 : 1;
+
+  return ra->root.offset < rb->root.offset ? -1 : (ra->root.offset > rb->root.offset);
+}
+
+static void
+build_index (GByteArray *array,
+             gint32      root_offset)
+{
+  GtkCssSelectorTreeIndex *index;
+  GArray *infos;
+  gint32 offset;
+  guint i, type;
+
+  infos = g_array_new (FALSE, FALSE, sizeof (RootInfo));
+
+  for (offset = root_offset;
+       offset != GTK_CSS_SELECTOR_TREE_EMPTY_OFFSET;
+       offset = get_tree (array, offset)->sibling_offset)
+    {
+      RootInfo info;
+
+      info.type = gtk_css_selector_tree_get_root_type (get_tree (array, offset), &info.root.key);
+      info.root.offset = offset;
+      g_array_append_val (infos, info);
+    }
+
+  g_array_sort (infos, compare_root_info);
+
+  index = (GtkCssSelectorTreeIndex *) array->data;
+  index->roots_offset = array->len;
+  index->n_roots = infos->len;
+
+  for (type = 0, i = 0; type < GTK_CSS_SELECTOR_TREE_N_ROOT_TYPES; type++)
+    {
+      index->roots_start[type] = i;
+      while (i < infos->len && g_array_index (infos, RootInfo, i).type == type)
+        i++;
+    }
+
+  for (i = 0; i < infos->len; i++)
+    g_byte_array_append (array,
+                         (guint8 *) &g_array_index (infos, RootInfo, i).root,
+                         sizeof (GtkCssSelectorTreeRoot));
+
+  g_array_free (infos, TRUE);
+}
+
 /* Convert all offsets to node-relative */
 static void
 fixup_offsets (GtkCssSelectorTree *tree, guint8 *data)
@@ -2277,15 +2651,24 @@ _gtk_css_selector_tree_builder_build (GtkCssSelectorTreeBuilder *builder)
   guint8 *data;
   guint len;
   guint i;
+  gint32 root_offset;
   GtkCssSelectorRuleSetInfo **infos_array;
 
+  if (builder->infos->len == 0)
+    return NULL;
+
   array = g_byte_array_new ();
+  g_byte_array_set_size (array, sizeof (GtkCssSelectorTreeIndex));
+  memset (array->data, 0, sizeof (GtkCssSelectorTreeIndex));
 
   infos_array = g_alloca (sizeof (GtkCssSelectorRuleSetInfo *) * builder->infos->len);
   for (i = 0; i < builder->infos->len; i++)
     infos_array[i] = &g_array_index (builder->infos, GtkCssSelectorRuleSetInfo, i);
 
-  subdivide_infos (array, infos_array, builder->infos->len, GTK_CSS_SELECTOR_TREE_EMPTY_OFFSET);
+  root_offset = subdivide_infos (array, infos_array, builder->infos->len, GTK_CSS_SELECTOR_TREE_EMPTY_OFFSET);
+  g_assert (root_offset == sizeof (GtkCssSelectorTreeIndex));
+
+  build_index (array, root_offset);
 
   len = array->len;
   data = g_byte_array_free (array, FALSE);
@@ -2293,7 +2676,7 @@ _gtk_css_selector_tree_builder_build (GtkCssSelectorTreeBuilder *builder)
   /* shrink to final size */
   data = g_realloc (data, len);
 
-  tree = (GtkCssSelectorTree *)data;
+  tree = (GtkCssSelectorTree *) (data + root_offset);
 
   fixup_offsets (tree, data);
 
@@ -35,6 +35,13 @@ typedef union _GtkCssSelector GtkCssSelector;
 typedef struct _GtkCssSelectorTree GtkCssSelectorTree;
 typedef struct _GtkCssSelectorTreeBuilder GtkCssSelectorTreeBuilder;
 
+typedef enum {
+  GTK_CSS_SELECTOR_KEY_ANY,
+  GTK_CSS_SELECTOR_KEY_NAME,
+  GTK_CSS_SELECTOR_KEY_CLASS,
+  GTK_CSS_SELECTOR_KEY_ID
+} GtkCssSelectorKeyType;
+
 GtkCssSelector *  _gtk_css_selector_parse           (GtkCssParser           *parser);
 void              _gtk_css_selector_free            (GtkCssSelector         *selector);
 
@@ -47,6 +54,21 @@ gboolean          gtk_css_selector_matches          (const GtkCssSelector   *sel
 GtkCssChange      _gtk_css_selector_get_change      (const GtkCssSelector   *selector);
 int               _gtk_css_selector_compare         (const GtkCssSelector   *a,
                                                      const GtkCssSelector   *b);
+guint64           gtk_css_selector_get_fingerprint  (const GtkCssSelector   *selector) G_GNUC_PURE;
+GtkCssSelectorKeyType
+                  gtk_css_selector_get_key          (const GtkCssSelector   *selector,
+                                                     GQuark                 *out_quark);
+
+GtkCssSelectorKeys *
+                  gtk_css_selector_keys_new         (void);
+void              gtk_css_selector_keys_free        (GtkCssSelectorKeys     *keys);
+void              gtk_css_selector_keys_add         (GtkCssSelectorKeys     *keys,
+                                                     GtkCssSelectorKeyType   type,
+                                                     GQuark                  quark);
+gboolean          gtk_css_selector_keys_is_empty    (const GtkCssSelectorKeys *keys);
+gboolean          gtk_css_selector_keys_match_all   (const GtkCssSelectorKeys *keys);
+gboolean          gtk_css_selector_keys_may_match   (const GtkCssSelectorKeys *keys,
+                                                     GtkCssNode               *node);
 
 void         _gtk_css_selector_tree_free             (GtkCssSelectorTree       *tree);
 void         _gtk_css_selector_tree_match_all        (const GtkCssSelectorTree *tree,
@@ -29,6 +29,7 @@
 #include "gtkcssnumbervalueprivate.h"
 #include "gtkcssshorthandpropertyprivate.h"
 #include "gtkcssstringvalueprivate.h"
+#include "gtkcssstylecacheprivate.h"
 #include "gtkcssstylepropertyprivate.h"
 #include "gtkcsstransitionprivate.h"
 #include "gtkprivate.h"
@@ -254,6 +255,128 @@ DEFINE_VALUES (TRANSITION, Transition, transition)
 DEFINE_VALUES (SIZE, Size, size)
 DEFINE_VALUES (OTHER, Other, other)
 
+/* Most nodes never look at their outline, font variants or transitions,
+ * so when the lookup sets any of these, we keep the specified values
+ * around and only compute the group when it is first accessed.
+ */
+struct _GtkCssDeferredValues
+{
+  GtkStyleProvider *provider;
+  GtkCssStyle *parent_style;
+  guint n_pending;
+
+  GtkCssLookupValue outline[G_N_ELEMENTS (outline_props)];
+  GtkCssLookupValue font_variant[G_N_ELEMENTS (font_variant_props)];
+  GtkCssLookupValue transition[G_N_ELEMENTS (transition_props)];
+};
+
+static void
+gtk_css_deferred_values_clear (GtkCssLookupValue *values,
+                               guint              n_values)
+{
+  guint i;
+
+  for (i = 0; i < n_values; i++)
+    {
+      g_clear_pointer (&values[i].value, gtk_css_value_unref);
+      g_clear_pointer (&values[i].section, gtk_css_section_unref);
+    }
+}
+
+static void
+gtk_css_deferred_values_free (GtkCssDeferredValues *deferred)
+{
+  gtk_css_deferred_values_clear (deferred->outline, G_N_ELEMENTS (deferred->outline));
+  gtk_css_deferred_values_clear (deferred->font_variant, G_N_ELEMENTS (deferred->font_variant));
+  gtk_css_deferred_values_clear (deferred->transition, G_N_ELEMENTS (deferred->transition));
+
+  g_object_unref (deferred->provider);
+  g_clear_object (&deferred->parent_style);
+
+  g_free (deferred);
+}
+
+static GtkCssDeferredValues *
+gtk_css_static_style_get_deferred (GtkCssStaticStyle *sstyle,
+                                   GtkStyleProvider  *provider,
+                                   GtkCssStyle       *parent_style)
+{
+  if (sstyle->deferred == NULL)
+    {
+      sstyle->deferred = g_new0 (GtkCssDeferredValues, 1);
+      sstyle->deferred->provider = g_object_ref (provider);
+      sstyle->deferred->parent_style = parent_style ? g_object_ref (parent_style) : NULL;
+    }
+
+  return sstyle->deferred;
+}
+
+static gboolean
+gtk_css_deferred_values_equal (const GtkCssLookupValue *values1,
+                               const GtkCssLookupValue *values2,
+                               guint                    n_values)
+{
+  guint i;
+
+  for (i = 0; i < n_values; i++)
+    {
+      if (values1[i].value != values2[i].value)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+#define DEFINE_DEFERRED_VALUES(ENUM, TYPE, NAME) \
+static inline void \
+gtk_css_ ## NAME ## _values_defer (GtkCssStaticStyle *sstyle, \
+                                   GtkStyleProvider *provider, \
+                                   GtkCssStyle *parent_style, \
+                                   GtkCssLookup *lookup) \
+{ \
+  GtkCssDeferredValues *deferred; \
+  int i; \
+\
+  deferred = gtk_css_static_style_get_deferred (sstyle, provider, parent_style); \
+  deferred->n_pending++; \
+\
+  for (i = 0; i < G_N_ELEMENTS (NAME ## _props); i++) \
+    { \
+      guint id = NAME ## _props[i]; \
+      if (lookup->values[id].value) \
+        deferred->NAME[i].value = gtk_css_value_ref (lookup->values[id].value); \
+      if (lookup->values[id].section) \
+        deferred->NAME[i].section = gtk_css_section_ref (lookup->values[id].section); \
+    } \
+} \
+\
+static void \
+gtk_css_ ## NAME ## _values_compute_deferred (GtkCssStaticStyle *sstyle) \
+{ \
+  GtkCssStyle *style = (GtkCssStyle *)sstyle; \
+  GtkCssDeferredValues *deferred = sstyle->deferred; \
+  int i; \
+\
+  style->NAME = (GtkCss ## TYPE ## Values *)gtk_css_values_new (GTK_CSS_ ## ENUM ## _VALUES); \
+\
+  for (i = 0; i < G_N_ELEMENTS (NAME ## _props); i++) \
+    { \
+      guint id = NAME ## _props[i]; \
+      gtk_css_static_style_compute_value (sstyle, \
+                                          deferred->provider, \
+                                          deferred->parent_style, \
+                                          id, \
+                                          deferred->NAME[i].value, \
+                                          deferred->NAME[i].section); \
+    } \
+\
+  gtk_css_deferred_values_clear (deferred->NAME, G_N_ELEMENTS (deferred->NAME)); \
+}
+
+DEFINE_DEFERRED_VALUES (OUTLINE, Outline, outline)
+DEFINE_DEFERRED_VALUES (FONT_VARIANT, FontVariant, font_variant)
+DEFINE_DEFERRED_VALUES (TRANSITION, Transition, transition)
+
 #define VERIFY_MASK(NAME) \
   { \
     GtkBitmask *copy; \
@@ -304,6 +427,10 @@ gtk_css_static_style_get_section (GtkCssStyle *style,
 {
   GtkCssStaticStyle *sstyle = GTK_CSS_STATIC_STYLE (style);
 
+  /* Sections of deferred values are only known once they are computed */
+  if (sstyle->deferred)
+    gtk_css_style_get_value (style, id);
+
   if (sstyle->sections == NULL ||
       id >= sstyle->sections->len)
     return NULL;
@@ -322,6 +449,8 @@ gtk_css_static_style_dispose (GObject *object)
       style->sections = NULL;
     }
 
+  g_clear_pointer (&style->deferred, gtk_css_deferred_values_free);
+
   G_OBJECT_CLASS (gtk_css_static_style_parent_class)->dispose (object);
 }
 
@@ -331,6 +460,34 @@ gtk_css_static_style_get_static_style (GtkCssStyle *style)
   return (GtkCssStaticStyle *)style;
 }
 
+static void
+gtk_css_static_style_compute_deferred (GtkCssStyle      *style,
+                                       GtkCssValuesType  type)
+{
+  GtkCssStaticStyle *sstyle = GTK_CSS_STATIC_STYLE (style);
+
+  gtk_internal_return_if_fail (sstyle->deferred != NULL);
+
+  switch (type)
+    {
+    case GTK_CSS_OUTLINE_VALUES:
+      gtk_css_outline_values_compute_deferred (sstyle);
+      break;
+    case GTK_CSS_FONT_VARIANT_VALUES:
+      gtk_css_font_variant_values_compute_deferred (sstyle);
+      break;
+    case GTK_CSS_TRANSITION_VALUES:
+      gtk_css_transition_values_compute_deferred (sstyle);
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+
+  sstyle->deferred->n_pending--;
+  if (sstyle->deferred->n_pending == 0)
+    g_clear_pointer (&sstyle->deferred, gtk_css_deferred_values_free);
+}
+
 static void
 gtk_css_static_style_class_init (GtkCssStaticStyleClass *klass)
 {
@@ -341,6 +498,7 @@ gtk_css_static_style_class_init (GtkCssStaticStyleClass *klass)
 
   style_class->get_section = gtk_css_static_style_get_section;
   style_class->get_static_style = gtk_css_static_style_get_static_style;
+  style_class->compute_deferred = gtk_css_static_style_compute_deferred;
 
   gtk_css_core_values_init ();
   gtk_css_background_values_init ();
@@ -962,7 +1120,7 @@ gtk_css_lookup_resolve (GtkCssLookup      *lookup,
   if (gtk_css_outline_values_unset (lookup))
     style->outline = (GtkCssOutlineValues *)gtk_css_values_ref (gtk_css_outline_initial_values);
   else
-    gtk_css_outline_values_new_compute (sstyle, provider, parent_style, lookup);
+    gtk_css_outline_values_defer (sstyle, provider, parent_style, lookup);
 
   if (parent_style && gtk_css_font_values_unset (lookup))
     style->font = (GtkCssFontValues *)gtk_css_values_ref ((GtkCssValues *)parent_style->font);
@@ -972,7 +1130,7 @@ gtk_css_lookup_resolve (GtkCssLookup      *lookup,
   if (gtk_css_font_variant_values_unset (lookup))
     style->font_variant = (GtkCssFontVariantValues *)gtk_css_values_ref (gtk_css_font_variant_initial_values);
   else
-    gtk_css_font_variant_values_new_compute (sstyle, provider, parent_style, lookup);
+    gtk_css_font_variant_values_defer (sstyle, provider, parent_style, lookup);
 
   if (gtk_css_animation_values_unset (lookup))
     style->animation = (GtkCssAnimationValues *)gtk_css_values_ref (gtk_css_animation_initial_values);
@@ -982,7 +1140,7 @@ gtk_css_lookup_resolve (GtkCssLookup      *lookup,
   if (gtk_css_transition_values_unset (lookup))
     style->transition = (GtkCssTransitionValues *)gtk_css_values_ref (gtk_css_transition_initial_values);
   else
-    gtk_css_transition_values_new_compute (sstyle, provider, parent_style, lookup);
+    gtk_css_transition_values_defer (sstyle, provider, parent_style, lookup);
 
   if (gtk_css_size_values_unset (lookup))
     style->size = (GtkCssSizeValues *)gtk_css_values_ref (gtk_css_size_initial_values);
@@ -995,6 +1153,40 @@ gtk_css_lookup_resolve (GtkCssLookup      *lookup,
     gtk_css_other_values_new_compute (sstyle, provider, parent_style, lookup);
 }
 
+static gboolean collect_times;
+static gint64 match_time;
+static gint64 compute_time;
+
+/*
+ * gtk_css_static_style_start_timing:
+ *
+ * Starts measuring the time spent in selector matching and value
+ * computation by gtk_css_static_style_new_compute().
+ */
+void
+gtk_css_static_style_start_timing (void)
+{
+  collect_times = TRUE;
+  match_time = 0;
+  compute_time = 0;
+}
+
+/*
+ * gtk_css_static_style_stop_timing:
+ * @match_time: (out): return location for the time spent matching, in µs
+ * @compute_time: (out): return location for the time spent computing, in µs
+ *
+ * Stops measuring times started with gtk_css_static_style_start_timing().
+ */
+void
+gtk_css_static_style_stop_timing (gint64 *out_match_time,
+                                  gint64 *out_compute_time)
+{
+  collect_times = FALSE;
+  *out_match_time = match_time;
+  *out_compute_time = compute_time;
+}
+
 GtkCssStyle *
 gtk_css_static_style_new_compute (GtkStyleProvider             *provider,
                                   const GtkCountingBloomFilter *filter,
@@ -1002,11 +1194,16 @@ gtk_css_static_style_new_compute (GtkStyleProvider             *provider,
                                   GtkCssChange                  change)
 {
   GtkCssStaticStyle *result;
+  GtkCssStyle *parent_style, *cached;
   GtkCssLookup lookup;
   GtkCssNode *parent;
+  gint64 before = 0;
 
   _gtk_css_lookup_init (&lookup);
 
+  if (collect_times)
+    before = g_get_monotonic_time ();
+
   if (node)
     gtk_style_provider_lookup (provider,
                                filter,
@@ -1014,25 +1211,106 @@ gtk_css_static_style_new_compute (GtkStyleProvider             *provider,
                                &lookup,
                                change == 0 ? &change : NULL);
 
-  result = g_object_new (GTK_TYPE_CSS_STATIC_STYLE, NULL);
+  if (collect_times)
+    {
+      gint64 now = g_get_monotonic_time ();
 
-  result->change = change;
+      match_time += now - before;
+      before = now;
+    }
 
   if (node)
     parent = gtk_css_node_get_parent (node);
   else
     parent = NULL;
 
+  parent_style = parent ? gtk_css_node_get_style (parent) : NULL;
+
+  cached = gtk_css_style_cache_lookup (provider, &lookup, parent_style, change);
+  if (cached)
+    {
+      _gtk_css_lookup_destroy (&lookup);
+      if (collect_times)
+        compute_time += g_get_monotonic_time () - before;
+      return cached;
+    }
+
+  result = g_object_new (GTK_TYPE_CSS_STATIC_STYLE, NULL);
+
+  result->change = change;
+
   gtk_css_lookup_resolve (&lookup,
                           provider,
                           result,
-                          parent ? gtk_css_node_get_style (parent) : NULL);
+                          parent_style);
+
+  gtk_css_style_cache_insert (provider, &lookup, parent_style, change, GTK_CSS_STYLE (result));
 
   _gtk_css_lookup_destroy (&lookup);
 
+  if (collect_times)
+    compute_time += g_get_monotonic_time () - before;
+
   return GTK_CSS_STYLE (result);
 }
 
+/* Computing a value usually creates a new instance, even if an equal
+ * value was just computed for another style. We remember the last few
+ * computed values for every property and share them when they are equal,
+ * so styles use less memory and comparing them mostly compares pointers.
+ */
+#define N_INTERNED_VALUES 4
+
+static GtkCssValue *interned_values[GTK_CSS_PROPERTY_N_PROPERTIES][N_INTERNED_VALUES];
+static guint8 interned_next[GTK_CSS_PROPERTY_N_PROPERTIES];
+
+static GtkCssValue *
+gtk_css_static_style_intern_value (guint        id,
+                                   GtkCssValue *value)
+{
+  GtkCssValue **interned = interned_values[id];
+  guint i;
+
+  /* Only fresh values, everything else is already shared */
+  if (value->ref_count != 1)
+    return value;
+
+  for (i = 0; i < N_INTERNED_VALUES; i++)
+    {
+      if (interned[i] && _gtk_css_value_equal (interned[i], value))
+        {
+          gtk_css_value_unref (value);
+          return gtk_css_value_ref (interned[i]);
+        }
+    }
+
+  i = interned_next[id];
+  interned_next[id] = (i + 1) % N_INTERNED_VALUES;
+
+  g_clear_pointer (&interned[i], gtk_css_value_unref);
+  interned[i] = gtk_css_value_ref (value);
+
+  return value;
+}
+
+/*
+ * gtk_css_static_style_clear_interned_values:
+ *
+ * Drops the values remembered for sharing between styles, so that
+ * they don't keep resources of a previous theme alive.
+ */
+void
+gtk_css_static_style_clear_interned_values (void)
+{
+  guint id, i;
+
+  for (id = 0; id < GTK_CSS_PROPERTY_N_PROPERTIES; id++)
+    {
+      for (i = 0; i < N_INTERNED_VALUES; i++)
+        g_clear_pointer (&interned_values[id][i], gtk_css_value_unref);
+    }
+}
+
 G_STATIC_ASSERT (GTK_CSS_PROPERTY_BORDER_TOP_STYLE == GTK_CSS_PROPERTY_BORDER_TOP_WIDTH - 1);
 G_STATIC_ASSERT (GTK_CSS_PROPERTY_BORDER_RIGHT_STYLE == GTK_CSS_PROPERTY_BORDER_RIGHT_WIDTH - 1);
 G_STATIC_ASSERT (GTK_CSS_PROPERTY_BORDER_BOTTOM_STYLE == GTK_CSS_PROPERTY_BORDER_BOTTOM_WIDTH - 1);
@@ -1097,6 +1375,8 @@ gtk_css_static_style_compute_value (GtkCssStaticStyle *style,
       value = _gtk_css_initial_value_new_compute (id, provider, (GtkCssStyle *)style, parent_style);
     }
 
+  value = gtk_css_static_style_intern_value (id, value);
+
   gtk_css_static_style_set_value (style, id, value, section);
 }
 
@@ -1107,3 +1387,135 @@ gtk_css_static_style_get_change (GtkCssStaticStyle *style)
 
   return style->change;
 }
+
+static const GtkCssLookupValue *
+gtk_css_deferred_values_get (GtkCssDeferredValues *deferred,
+                             GtkCssValuesType      type,
+                             guint                *n_values)
+{
+  switch (type)
+    {
+    case GTK_CSS_OUTLINE_VALUES:
+      *n_values = G_N_ELEMENTS (deferred->outline);
+      return deferred->outline;
+    case GTK_CSS_FONT_VARIANT_VALUES:
+      *n_values = G_N_ELEMENTS (deferred->font_variant);
+      return deferred->font_variant;
+    case GTK_CSS_TRANSITION_VALUES:
+      *n_values = G_N_ELEMENTS (deferred->transition);
+      return deferred->transition;
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+/*
+ * gtk_css_static_style_is_deferred:
+ * @style: a style
+ * @type: the group to check
+ *
+ * Checks if the values of the given group have not been
+ * computed yet.
+ *
+ * Returns: %TRUE if computing the values has been deferred
+ */
+gboolean
+gtk_css_static_style_is_deferred (GtkCssStyle      *style,
+                                  GtkCssValuesType  type)
+{
+  if (!GTK_IS_CSS_STATIC_STYLE (style) ||
+      GTK_CSS_STATIC_STYLE (style)->deferred == NULL)
+    return FALSE;
+
+  switch (type)
+    {
+    case GTK_CSS_OUTLINE_VALUES:
+      return style->outline == NULL;
+    case GTK_CSS_FONT_VARIANT_VALUES:
+      return style->font_variant == NULL;
+    case GTK_CSS_TRANSITION_VALUES:
+      return style->transition == NULL;
+    default:
+      return FALSE;
+    }
+}
+
+/*
+ * gtk_css_static_style_deferred_equal:
+ * @style1: a style
+ * @style2: another style
+ * @type: the group to compare
+ *
+ * Checks if both styles deferred the values of the given group
+ * with identical inputs. If the other values of the styles are
+ * equal, the computed values of the group will be equal, too.
+ *
+ * Returns: %TRUE if the deferred values are known to be equal
+ */
+gboolean
+gtk_css_static_style_deferred_equal (GtkCssStyle      *style1,
+                                     GtkCssStyle      *style2,
+                                     GtkCssValuesType  type)
+{
+  GtkCssDeferredValues *deferred1, *deferred2;
+  const GtkCssLookupValue *values1, *values2;
+  guint n_values;
+
+  if (!gtk_css_static_style_is_deferred (style1, type) ||
+      !gtk_css_static_style_is_deferred (style2, type))
+    return FALSE;
+
+  deferred1 = GTK_CSS_STATIC_STYLE (style1)->deferred;
+  deferred2 = GTK_CSS_STATIC_STYLE (style2)->deferred;
+
+  if (deferred1->provider != deferred2->provider ||
+      deferred1->parent_style != deferred2->parent_style)
+    return FALSE;
+
+  values1 = gtk_css_deferred_values_get (deferred1, type, &n_values);
+  values2 = gtk_css_deferred_values_get (deferred2, type, &n_values);
+
+  return gtk_css_deferred_values_equal (values1, values2, n_values);
+}
+
+/*
+ * gtk_css_static_style_add_deferred_changes:
+ * @type: a group with deferred values
+ * @changes: the changes to add to
+ * @affects: the affects to add to
+ *
+ * Marks all properties of the given group as changed, without
+ * computing them.
+ */
+void
+gtk_css_static_style_add_deferred_changes (GtkCssValuesType   type,
+                                           GtkBitmask       **changes,
+                                           GtkCssAffects     *affects)
+{
+  const int *props;
+  guint i, n_props;
+
+  switch (type)
+    {
+    case GTK_CSS_OUTLINE_VALUES:
+      props = outline_props;
+      n_props = G_N_ELEMENTS (outline_props);
+      break;
+    case GTK_CSS_FONT_VARIANT_VALUES:
+      props = font_variant_props;
+      n_props = G_N_ELEMENTS (font_variant_props);
+      break;
+    case GTK_CSS_TRANSITION_VALUES:
+      props = transition_props;
+      n_props = G_N_ELEMENTS (transition_props);
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+
+  for (i = 0; i < n_props; i++)
+    {
+      *changes = _gtk_bitmask_set (*changes, props[i], TRUE);
+      *affects |= _gtk_css_style_property_get_affects (_gtk_css_style_property_lookup_by_id (props[i]));
+    }
+}
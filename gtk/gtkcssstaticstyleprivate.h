@@ -33,6 +33,7 @@ G_BEGIN_DECLS
 #define GTK_CSS_STATIC_STYLE_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS ((obj), GTK_TYPE_CSS_STATIC_STYLE, GtkCssStaticStyleClass))
 
 typedef struct _GtkCssStaticStyleClass      GtkCssStaticStyleClass;
+typedef struct _GtkCssDeferredValues        GtkCssDeferredValues;
 
 
 struct _GtkCssStaticStyle
@@ -42,6 +43,8 @@ struct _GtkCssStaticStyle
   GPtrArray             *sections;             /* sections the values are defined in */
 
   GtkCssChange           change;               /* change as returned by value lookup */
+
+  GtkCssDeferredValues  *deferred;             /* specified values of groups that are not computed yet */
 };
 
 struct _GtkCssStaticStyleClass
@@ -57,6 +60,19 @@ GtkCssStyle *           gtk_css_static_style_new_compute        (GtkStyleProvide
                                                                  GtkCssNode                     *node,
                                                                  GtkCssChange                    change);
 GtkCssChange            gtk_css_static_style_get_change         (GtkCssStaticStyle              *style);
+void                    gtk_css_static_style_clear_interned_values (void);
+void                    gtk_css_static_style_start_timing       (void);
+void                    gtk_css_static_style_stop_timing        (gint64                         *match_time,
+                                                                 gint64                         *compute_time);
+
+gboolean                gtk_css_static_style_is_deferred        (GtkCssStyle                    *style,
+                                                                 GtkCssValuesType                type);
+gboolean                gtk_css_static_style_deferred_equal     (GtkCssStyle                    *style1,
+                                                                 GtkCssStyle                    *style2,
+                                                                 GtkCssValuesType                type);
+void                    gtk_css_static_style_add_deferred_changes (GtkCssValuesType              type,
+                                                                 GtkBitmask                    **changes,
+                                                                 GtkCssAffects                  *affects);
 
 G_END_DECLS
 
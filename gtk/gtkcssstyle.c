@@ -121,27 +121,27 @@ gtk_css_style_get_value (GtkCssStyle *style,
     case GTK_CSS_PROPERTY_LINE_HEIGHT:
       return style->font->line_height;
     case GTK_CSS_PROPERTY_TEXT_DECORATION_LINE:
-      return style->font_variant->text_decoration_line;
+      return gtk_css_style_get_font_variant_values (style)->text_decoration_line;
     case GTK_CSS_PROPERTY_TEXT_DECORATION_COLOR:
-      return style->font_variant->text_decoration_color ? style->font_variant->text_decoration_color : style->core->color;
+      return gtk_css_style_get_font_variant_values (style)->text_decoration_color ? gtk_css_style_get_font_variant_values (style)->text_decoration_color : style->core->color;
     case GTK_CSS_PROPERTY_TEXT_DECORATION_STYLE:
-      return style->font_variant->text_decoration_style;
+      return gtk_css_style_get_font_variant_values (style)->text_decoration_style;
     case GTK_CSS_PROPERTY_TEXT_TRANSFORM:
-      return style->font_variant->text_transform;
+      return gtk_css_style_get_font_variant_values (style)->text_transform;
     case GTK_CSS_PROPERTY_FONT_KERNING:
-      return style->font_variant->font_kerning;
+      return gtk_css_style_get_font_variant_values (style)->font_kerning;
     case GTK_CSS_PROPERTY_FONT_VARIANT_LIGATURES:
-      return style->font_variant->font_variant_ligatures;
+      return gtk_css_style_get_font_variant_values (style)->font_variant_ligatures;
     case GTK_CSS_PROPERTY_FONT_VARIANT_POSITION:
-      return style->font_variant->font_variant_position;
+      return gtk_css_style_get_font_variant_values (style)->font_variant_position;
     case GTK_CSS_PROPERTY_FONT_VARIANT_CAPS:
-      return style->font_variant->font_variant_caps;
+      return gtk_css_style_get_font_variant_values (style)->font_variant_caps;
     case GTK_CSS_PROPERTY_FONT_VARIANT_NUMERIC:
-      return style->font_variant->font_variant_numeric;
+      return gtk_css_style_get_font_variant_values (style)->font_variant_numeric;
     case GTK_CSS_PROPERTY_FONT_VARIANT_ALTERNATES:
-      return style->font_variant->font_variant_alternates;
+      return gtk_css_style_get_font_variant_values (style)->font_variant_alternates;
     case GTK_CSS_PROPERTY_FONT_VARIANT_EAST_ASIAN:
-      return style->font_variant->font_variant_east_asian;
+      return gtk_css_style_get_font_variant_values (style)->font_variant_east_asian;
     case GTK_CSS_PROPERTY_TEXT_SHADOW:
       return style->font->text_shadow;
     case GTK_CSS_PROPERTY_BOX_SHADOW:
@@ -187,11 +187,11 @@ gtk_css_style_get_value (GtkCssStyle *style,
     case GTK_CSS_PROPERTY_BORDER_BOTTOM_LEFT_RADIUS:
       return style->border->border_bottom_left_radius;
     case GTK_CSS_PROPERTY_OUTLINE_STYLE:
-      return style->outline->outline_style;
+      return gtk_css_style_get_outline_values (style)->outline_style;
     case GTK_CSS_PROPERTY_OUTLINE_WIDTH:
-      return style->outline->outline_width;
+      return gtk_css_style_get_outline_values (style)->outline_width;
     case GTK_CSS_PROPERTY_OUTLINE_OFFSET:
-      return style->outline->outline_offset;
+      return gtk_css_style_get_outline_values (style)->outline_offset;
     case GTK_CSS_PROPERTY_BACKGROUND_CLIP:
       return style->background->background_clip;
     case GTK_CSS_PROPERTY_BACKGROUND_ORIGIN:
@@ -209,7 +209,7 @@ gtk_css_style_get_value (GtkCssStyle *style,
     case GTK_CSS_PROPERTY_BORDER_LEFT_COLOR:
       return style->border->border_left_color ? style->border->border_left_color: style->core->color;
     case GTK_CSS_PROPERTY_OUTLINE_COLOR:
-      return style->outline->outline_color ? style->outline->outline_color : style->core->color;
+      return gtk_css_style_get_outline_values (style)->outline_color ? gtk_css_style_get_outline_values (style)->outline_color : style->core->color;
     case GTK_CSS_PROPERTY_BACKGROUND_REPEAT:
       return style->background->background_repeat;
     case GTK_CSS_PROPERTY_BACKGROUND_IMAGE:
@@ -247,13 +247,13 @@ gtk_css_style_get_value (GtkCssStyle *style,
     case GTK_CSS_PROPERTY_MIN_HEIGHT:
       return style->size->min_height;
     case GTK_CSS_PROPERTY_TRANSITION_PROPERTY:
-      return style->transition->transition_property;
+      return gtk_css_style_get_transition_values (style)->transition_property;
     case GTK_CSS_PROPERTY_TRANSITION_DURATION:
-      return style->transition->transition_duration;
+      return gtk_css_style_get_transition_values (style)->transition_duration;
     case GTK_CSS_PROPERTY_TRANSITION_TIMING_FUNCTION:
-      return style->transition->transition_timing_function;
+      return gtk_css_style_get_transition_values (style)->transition_timing_function;
     case GTK_CSS_PROPERTY_TRANSITION_DELAY:
-      return style->transition->transition_delay;
+      return gtk_css_style_get_transition_values (style)->transition_delay;
     case GTK_CSS_PROPERTY_ANIMATION_NAME:
       return style->animation->animation_name;
     case GTK_CSS_PROPERTY_ANIMATION_DURATION:
@@ -303,6 +303,16 @@ gtk_css_style_is_static (GtkCssStyle *style)
   return GTK_CSS_STYLE_GET_CLASS (style)->is_static (style);
 }
 
+void
+gtk_css_style_compute_deferred (GtkCssStyle      *style,
+                                GtkCssValuesType  type)
+{
+  gtk_internal_return_if_fail (GTK_IS_CSS_STYLE (style));
+  gtk_internal_return_if_fail (GTK_CSS_STYLE_GET_CLASS (style)->compute_deferred != NULL);
+
+  GTK_CSS_STYLE_GET_CLASS (style)->compute_deferred (style, type);
+}
+
 GtkCssStaticStyle *
 gtk_css_style_get_static_style (GtkCssStyle *style)
 {
@@ -405,7 +415,7 @@ get_pango_underline_from_style (GtkTextDecorationStyle style)
 PangoTextTransform
 gtk_css_style_get_pango_text_transform (GtkCssStyle *style)
 {
-  switch (_gtk_css_text_transform_value_get (style->font_variant->text_transform))
+  switch (_gtk_css_text_transform_value_get (gtk_css_style_get_font_variant_values (style)->text_transform))
     {
     case GTK_CSS_TEXT_TRANSFORM_NONE:
       return PANGO_TEXT_TRANSFORM_NONE;
@@ -460,7 +470,7 @@ gtk_css_style_compute_font_features (GtkCssStyle *style)
   char *settings;
   GString *s = NULL;
 
-  switch (_gtk_css_font_kerning_value_get (style->font_variant->font_kerning))
+  switch (_gtk_css_font_kerning_value_get (gtk_css_style_get_font_variant_values (style)->font_kerning))
     {
     case GTK_CSS_FONT_KERNING_NORMAL:
       append_separated (&s, "kern 1");
@@ -473,7 +483,7 @@ gtk_css_style_compute_font_features (GtkCssStyle *style)
       break;
     }
 
-  ligatures = _gtk_css_font_variant_ligature_value_get (style->font_variant->font_variant_ligatures);
+  ligatures = _gtk_css_font_variant_ligature_value_get (gtk_css_style_get_font_variant_values (style)->font_variant_ligatures);
   if (ligatures == GTK_CSS_FONT_VARIANT_LIGATURE_NORMAL)
     {
       /* all defaults */
@@ -500,7 +510,7 @@ gtk_css_style_compute_font_features (GtkCssStyle *style)
         append_separated (&s, "calt 0");
     }
 
-  switch (_gtk_css_font_variant_position_value_get (style->font_variant->font_variant_position))
+  switch (_gtk_css_font_variant_position_value_get (gtk_css_style_get_font_variant_values (style)->font_variant_position))
     {
     case GTK_CSS_FONT_VARIANT_POSITION_SUB:
       append_separated (&s, "subs 1");
@@ -513,7 +523,7 @@ gtk_css_style_compute_font_features (GtkCssStyle *style)
       break;
     }
 
-  numeric = _gtk_css_font_variant_numeric_value_get (style->font_variant->font_variant_numeric);
+  numeric = _gtk_css_font_variant_numeric_value_get (gtk_css_style_get_font_variant_values (style)->font_variant_numeric);
   if (numeric == GTK_CSS_FONT_VARIANT_NUMERIC_NORMAL)
     {
       /* all defaults */
@@ -538,7 +548,7 @@ gtk_css_style_compute_font_features (GtkCssStyle *style)
         append_separated (&s, "zero 1");
     }
 
-  switch (_gtk_css_font_variant_alternate_value_get (style->font_variant->font_variant_alternates))
+  switch (_gtk_css_font_variant_alternate_value_get (gtk_css_style_get_font_variant_values (style)->font_variant_alternates))
     {
     case GTK_CSS_FONT_VARIANT_ALTERNATE_HISTORICAL_FORMS:
       append_separated (&s, "hist 1");
@@ -548,7 +558,7 @@ gtk_css_style_compute_font_features (GtkCssStyle *style)
       break;
     }
 
-  east_asian = _gtk_css_font_variant_east_asian_value_get (style->font_variant->font_variant_east_asian);
+  east_asian = _gtk_css_font_variant_east_asian_value_get (gtk_css_style_get_font_variant_values (style)->font_variant_east_asian);
   if (east_asian == GTK_CSS_FONT_VARIANT_EAST_ASIAN_NORMAL)
     {
       /* all defaults */
@@ -593,17 +603,19 @@ gtk_css_style_get_pango_attributes (GtkCssStyle *style)
 {
   PangoAttrList *attrs = NULL;
   GtkTextDecorationLine decoration_line;
+  GtkCssFontVariantValues *font_variant;
   GtkTextDecorationStyle decoration_style;
   const GdkRGBA *color;
   const GdkRGBA *decoration_color;
   double letter_spacing;
 
   /* text-decoration */
-  decoration_line = _gtk_css_text_decoration_line_value_get (style->font_variant->text_decoration_line);
-  decoration_style = _gtk_css_text_decoration_style_value_get (style->font_variant->text_decoration_style);
+  font_variant = gtk_css_style_get_font_variant_values (style);
+  decoration_line = _gtk_css_text_decoration_line_value_get (font_variant->text_decoration_line);
+  decoration_style = _gtk_css_text_decoration_style_value_get (font_variant->text_decoration_style);
   color = gtk_css_color_value_get_rgba (style->core->color);
-  decoration_color = gtk_css_color_value_get_rgba (style->font_variant->text_decoration_color
-                                                   ? style->font_variant->text_decoration_color
+  decoration_color = gtk_css_color_value_get_rgba (font_variant->text_decoration_color
+                                                   ? font_variant->text_decoration_color
                                                    : style->core->color);
 
   if (decoration_line & GTK_CSS_TEXT_DECORATION_LINE_UNDERLINE)
@@ -651,7 +663,7 @@ gtk_css_style_get_pango_attributes (GtkCssStyle *style)
    }
 
   /* casing variants */
-  switch (_gtk_css_font_variant_caps_value_get (style->font_variant->font_variant_caps))
+  switch (_gtk_css_font_variant_caps_value_get (font_variant->font_variant_caps))
     {
     case GTK_CSS_FONT_VARIANT_CAPS_SMALL_CAPS:
       attrs = add_pango_attr (attrs, pango_attr_variant_new (PANGO_VARIANT_SMALL_CAPS));
@@ -0,0 +1,307 @@
+/* GTK - The GIMP Toolkit
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkcssstylecacheprivate.h"
+
+#include "gtkcssstaticstyleprivate.h"
+#include "gtkdebug.h"
+
+/* The style cache shares computed styles between nodes anywhere in the
+ * widget tree.
+ *
+ * GtkCssNodeStyleCache can only share styles between siblings, because
+ * it is keyed by the node declaration. This cache is keyed by the result
+ * of the style provider lookup instead: the winning value and section of
+ * every property, the parent style and the change flags. Computing a
+ * style only depends on those and the provider, so two nodes with equal
+ * keys get equal styles, no matter where they are.
+ *
+ * The values and sections are owned by the provider, so the whole cache
+ * is dropped whenever a style provider changes.
+ */
+
+#define MAX_CACHED_STYLES 1024
+
+typedef struct _GtkCssStyleCacheValue GtkCssStyleCacheValue;
+typedef struct _GtkCssStyleCacheEntry GtkCssStyleCacheEntry;
+
+struct _GtkCssStyleCacheValue
+{
+  guint          id;
+  GtkCssSection *section;
+  GtkCssValue   *value;
+};
+
+struct _GtkCssStyleCacheEntry
+{
+  GList                  link;
+  GtkCssStyle           *style;
+
+  guint                  hash;
+  GtkStyleProvider      *provider;
+  GtkCssStyle           *parent_style;
+  GtkCssChange           change;
+  guint                  n_values;
+  GtkCssStyleCacheValue *values;
+};
+
+static GHashTable *cached_styles;
+static GQueue lru = G_QUEUE_INIT;
+static guint64 cache_hits;
+static guint64 cache_misses;
+
+static guint
+gtk_css_style_cache_entry_hash (gconstpointer data)
+{
+  const GtkCssStyleCacheEntry *entry = data;
+
+  return entry->hash;
+}
+
+static gboolean
+gtk_css_style_cache_entry_equal (gconstpointer data1,
+                                 gconstpointer data2)
+{
+  const GtkCssStyleCacheEntry *entry1 = data1;
+  const GtkCssStyleCacheEntry *entry2 = data2;
+  guint i;
+
+  if (entry1->hash != entry2->hash ||
+      entry1->provider != entry2->provider ||
+      entry1->parent_style != entry2->parent_style ||
+      entry1->change != entry2->change ||
+      entry1->n_values != entry2->n_values)
+    return FALSE;
+
+  for (i = 0; i < entry1->n_values; i++)
+    {
+      if (entry1->values[i].id != entry2->values[i].id ||
+          entry1->values[i].value != entry2->values[i].value ||
+          entry1->values[i].section != entry2->values[i].section)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+gtk_css_style_cache_entry_free (gpointer data)
+{
+  GtkCssStyleCacheEntry *entry = data;
+  guint i;
+
+  for (i = 0; i < entry->n_values; i++)
+    {
+      gtk_css_value_unref (entry->values[i].value);
+      if (entry->values[i].section)
+        gtk_css_section_unref (entry->values[i].section);
+    }
+
+  g_clear_object (&entry->parent_style);
+  g_object_unref (entry->provider);
+  g_object_unref (entry->style);
+  g_free (entry);
+}
+
+static gboolean
+gtk_css_style_cache_init_key (GtkCssStyleCacheEntry *key,
+                              GtkCssStyleCacheValue *values,
+                              GtkStyleProvider      *provider,
+                              const GtkCssLookup    *lookup,
+                              GtkCssStyle           *parent_style,
+                              GtkCssChange           change)
+{
+  guint i, hash;
+
+  /* GTK_DEBUG=no-css-cache disables all style caches */
+  if (GTK_DEBUG_CHECK (NO_CSS_CACHE))
+    return FALSE;
+
+  /* Animated styles are replaced every frame, caching for them
+   * would only evict useful entries.
+   */
+  if (parent_style != NULL && !GTK_IS_CSS_STATIC_STYLE (parent_style))
+    return FALSE;
+
+  hash = g_direct_hash (provider) ^ g_direct_hash (parent_style);
+  hash = hash * 31 + (guint) (change ^ (change >> 32));
+
+  key->n_values = 0;
+  for (i = 0; i < GTK_CSS_PROPERTY_N_PROPERTIES; i++)
+    {
+      if (lookup->values[i].value == NULL)
+        continue;
+
+      values[key->n_values].id = i;
+      values[key->n_values].section = lookup->values[i].section;
+      values[key->n_values].value = lookup->values[i].value;
+      key->n_values++;
+
+      hash = hash * 31 + i;
+      hash ^= g_direct_hash (lookup->values[i].value);
+      hash ^= g_direct_hash (lookup->values[i].section) << 1;
+    }
+
+  key->style = NULL;
+  key->hash = hash;
+  key->provider = provider;
+  key->parent_style = parent_style;
+  key->change = change;
+  key->values = values;
+
+  return TRUE;
+}
+
+/*
+ * gtk_css_style_cache_lookup:
+ * @provider: the provider the lookup was done with
+ * @lookup: the result of the lookup
+ * @parent_style: (nullable): the style of the parent node
+ * @change: the change flags of the style
+ *
+ * Looks for a previously computed style for the given lookup result.
+ *
+ * Returns: (transfer full) (nullable): a cached style
+ */
+GtkCssStyle *
+gtk_css_style_cache_lookup (GtkStyleProvider   *provider,
+                            const GtkCssLookup *lookup,
+                            GtkCssStyle        *parent_style,
+                            GtkCssChange        change)
+{
+  GtkCssStyleCacheValue values[GTK_CSS_PROPERTY_N_PROPERTIES];
+  GtkCssStyleCacheEntry key, *entry;
+
+  if (cached_styles == NULL)
+    return NULL;
+
+  if (!gtk_css_style_cache_init_key (&key, values, provider, lookup, parent_style, change))
+    return NULL;
+
+  entry = g_hash_table_lookup (cached_styles, &key);
+  if (entry == NULL)
+    {
+      cache_misses++;
+      return NULL;
+    }
+
+  cache_hits++;
+
+  g_queue_unlink (&lru, &entry->link);
+  g_queue_push_head_link (&lru, &entry->link);
+
+  return g_object_ref (entry->style);
+}
+
+/*
+ * gtk_css_style_cache_insert:
+ * @provider: the provider the lookup was done with
+ * @lookup: the result of the lookup
+ * @parent_style: (nullable): the style of the parent node
+ * @change: the change flags of the style
+ * @style: the style computed from @lookup
+ *
+ * Stores @style so that later lookups with the same result can reuse it.
+ */
+void
+gtk_css_style_cache_insert (GtkStyleProvider   *provider,
+                            const GtkCssLookup *lookup,
+                            GtkCssStyle        *parent_style,
+                            GtkCssChange        change,
+                            GtkCssStyle        *style)
+{
+  GtkCssStyleCacheValue values[GTK_CSS_PROPERTY_N_PROPERTIES];
+  GtkCssStyleCacheEntry key, *entry;
+  guint i;
+
+  if (!gtk_css_style_cache_init_key (&key, values, provider, lookup, parent_style, change))
+    return;
+
+  if (cached_styles == NULL)
+    cached_styles = g_hash_table_new_full (gtk_css_style_cache_entry_hash,
+                                           gtk_css_style_cache_entry_equal,
+                                           NULL,
+                                           gtk_css_style_cache_entry_free);
+  else if (g_hash_table_contains (cached_styles, &key))
+    return;
+
+  if (g_queue_get_length (&lru) >= MAX_CACHED_STYLES)
+    {
+      GList *last = g_queue_pop_tail_link (&lru);
+
+      g_hash_table_remove (cached_styles, last->data);
+    }
+
+  entry = g_malloc (sizeof (GtkCssStyleCacheEntry) + key.n_values * sizeof (GtkCssStyleCacheValue));
+  *entry = key;
+  entry->values = (GtkCssStyleCacheValue *) (entry + 1);
+  entry->style = g_object_ref (style);
+  g_object_ref (entry->provider);
+  if (entry->parent_style)
+    g_object_ref (entry->parent_style);
+
+  for (i = 0; i < key.n_values; i++)
+    {
+      entry->values[i] = values[i];
+      gtk_css_value_ref (entry->values[i].value);
+      if (entry->values[i].section)
+        gtk_css_section_ref (entry->values[i].section);
+    }
+
+  entry->link.data = entry;
+  entry->link.prev = NULL;
+  entry->link.next = NULL;
+  g_queue_push_head_link (&lru, &entry->link);
+
+  g_hash_table_add (cached_styles, entry);
+}
+
+/*
+ * gtk_css_style_cache_clear:
+ *
+ * Drops all cached styles. This must be called whenever a style
+ * provider changes, because the values that the cache is keyed by
+ * are owned by the providers.
+ */
+void
+gtk_css_style_cache_clear (void)
+{
+  if (cached_styles == NULL)
+    return;
+
+  g_queue_init (&lru);
+  g_hash_table_remove_all (cached_styles);
+}
+
+/*
+ * gtk_css_style_cache_get_statistics:
+ * @n_styles: (out): return location for the number of cached styles
+ * @n_hits: (out): return location for the number of lookups that found a style
+ * @n_misses: (out): return location for the number of lookups that did not
+ *
+ * Gets statistics about the style cache, for use in the inspector.
+ */
+void
+gtk_css_style_cache_get_statistics (guint   *n_styles,
+                                    guint64 *n_hits,
+                                    guint64 *n_misses)
+{
+  *n_styles = g_queue_get_length (&lru);
+  *n_hits = cache_hits;
+  *n_misses = cache_misses;
+}
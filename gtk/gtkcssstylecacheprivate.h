@@ -0,0 +1,40 @@
+/* GTK - The GIMP Toolkit
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "gtkcsslookupprivate.h"
+#include "gtkcssstyleprivate.h"
+#include "gtkstyleproviderprivate.h"
+
+G_BEGIN_DECLS
+
+GtkCssStyle *           gtk_css_style_cache_lookup              (GtkStyleProvider       *provider,
+                                                                 const GtkCssLookup     *lookup,
+                                                                 GtkCssStyle            *parent_style,
+                                                                 GtkCssChange            change);
+void                    gtk_css_style_cache_insert              (GtkStyleProvider       *provider,
+                                                                 const GtkCssLookup     *lookup,
+                                                                 GtkCssStyle            *parent_style,
+                                                                 GtkCssChange            change,
+                                                                 GtkCssStyle            *style);
+void                    gtk_css_style_cache_clear               (void);
+
+void                    gtk_css_style_cache_get_statistics      (guint                  *n_styles,
+                                                                 guint64                *n_hits,
+                                                                 guint64                *n_misses);
+
+G_END_DECLS
@@ -19,12 +19,37 @@
 
 #include "gtkcssstylechangeprivate.h"
 
+#include "gtkcssstaticstyleprivate.h"
 #include "gtkcssstylepropertyprivate.h"
 
+/* Returns TRUE if the change of a group whose values may not be computed
+ * yet could be determined without computing them.
+ */
+static gboolean
+compute_deferred_change (GtkCssStyleChange *change,
+                         GtkCssValuesType   type,
+                         gboolean           core_changed)
+{
+  if (!gtk_css_static_style_is_deferred (change->new_style, type))
+    return FALSE;
+
+  /* The node is styled for the first time, it will be fully
+   * measured and drawn anyway. */
+  if (change->old_style == gtk_css_static_style_get_default ())
+    {
+      gtk_css_static_style_add_deferred_changes (type, &change->changes, &change->affects);
+      return TRUE;
+    }
+
+  return !core_changed &&
+         gtk_css_static_style_deferred_equal (change->old_style, change->new_style, type);
+}
+
 static void
 compute_change (GtkCssStyleChange *change)
 {
   gboolean color_changed = FALSE;
+  gboolean core_changed = FALSE;
 
   if (change->old_style->core != change->new_style->core)
     {
@@ -33,6 +58,7 @@ compute_change (GtkCssStyleChange *change)
                                                        &change->changes,
                                                        &change->affects);
       color_changed = _gtk_bitmask_get (change->changes, GTK_CSS_PROPERTY_COLOR);
+      core_changed = !_gtk_bitmask_is_empty (change->changes);
     }
 
   if (change->old_style->background != change->new_style->background)
@@ -57,8 +83,9 @@ compute_change (GtkCssStyleChange *change)
                                                      &change->changes,
                                                      &change->affects);
 
-  if (change->old_style->outline != change->new_style->outline ||
-      (color_changed && change->old_style->outline->outline_color == NULL))
+  if (!compute_deferred_change (change, GTK_CSS_OUTLINE_VALUES, core_changed) &&
+      (gtk_css_style_get_outline_values (change->old_style) != gtk_css_style_get_outline_values (change->new_style) ||
+       (color_changed && change->old_style->outline->outline_color == NULL)))
     gtk_css_outline_values_compute_changes_and_affects (change->old_style,
                                                         change->new_style,
                                                         &change->changes,
@@ -72,8 +99,9 @@ compute_change (GtkCssStyleChange *change)
                                                      &change->changes,
                                                      &change->affects);
 
-  if (change->old_style->font_variant != change->new_style->font_variant ||
-      (color_changed && change->old_style->font_variant->text_decoration_color == NULL))
+  if (!compute_deferred_change (change, GTK_CSS_FONT_VARIANT_VALUES, core_changed) &&
+      (gtk_css_style_get_font_variant_values (change->old_style) != gtk_css_style_get_font_variant_values (change->new_style) ||
+       (color_changed && change->old_style->font_variant->text_decoration_color == NULL)))
     gtk_css_font_variant_values_compute_changes_and_affects (change->old_style,
                                                              change->new_style,
                                                              &change->changes,
@@ -85,7 +113,8 @@ compute_change (GtkCssStyleChange *change)
                                                           &change->changes,
                                                           &change->affects);
 
-  if (change->old_style->transition != change->new_style->transition)
+  if (!compute_deferred_change (change, GTK_CSS_TRANSITION_VALUES, core_changed) &&
+      (gtk_css_style_get_transition_values (change->old_style) != gtk_css_style_get_transition_values (change->new_style)))
     gtk_css_transition_values_compute_changes_and_affects (change->old_style,
                                                            change->new_style,
                                                            &change->changes,
@@ -246,6 +246,11 @@ struct _GtkCssStyleClass
   gboolean              (* is_static)                           (GtkCssStyle            *style);
 
   GtkCssStaticStyle *   (* get_static_style)                    (GtkCssStyle            *style);
+
+  /* Compute the values of the given group that were deferred until first use.
+   * Optional: only needed if the style can have deferred values */
+  void                  (* compute_deferred)                    (GtkCssStyle            *style,
+                                                                 GtkCssValuesType        type);
 };
 
 GType                   gtk_css_style_get_type                  (void) G_GNUC_CONST;
@@ -256,6 +261,39 @@ GtkCssSection *         gtk_css_style_get_section               (GtkCssStyle
                                                                  guint                   id) G_GNUC_PURE;
 gboolean                gtk_css_style_is_static                 (GtkCssStyle            *style) G_GNUC_PURE;
 GtkCssStaticStyle *     gtk_css_style_get_static_style          (GtkCssStyle            *style);
+void                    gtk_css_style_compute_deferred          (GtkCssStyle            *style,
+                                                                 GtkCssValuesType        type);
+
+/* The outline, font variant and transition groups of static styles
+ * are only computed when they are first used, so they must be accessed
+ * with these functions.
+ */
+static inline GtkCssOutlineValues *
+gtk_css_style_get_outline_values (GtkCssStyle *style)
+{
+  if (G_UNLIKELY (style->outline == NULL))
+    gtk_css_style_compute_deferred (style, GTK_CSS_OUTLINE_VALUES);
+
+  return style->outline;
+}
+
+static inline GtkCssFontVariantValues *
+gtk_css_style_get_font_variant_values (GtkCssStyle *style)
+{
+  if (G_UNLIKELY (style->font_variant == NULL))
+    gtk_css_style_compute_deferred (style, GTK_CSS_FONT_VARIANT_VALUES);
+
+  return style->font_variant;
+}
+
+static inline GtkCssTransitionValues *
+gtk_css_style_get_transition_values (GtkCssStyle *style)
+{
+  if (G_UNLIKELY (style->transition == NULL))
+    gtk_css_style_compute_deferred (style, GTK_CSS_TRANSITION_VALUES);
+
+  return style->transition;
+}
 
 char *                  gtk_css_style_to_string                 (GtkCssStyle            *style);
 gboolean                gtk_css_style_print                     (GtkCssStyle            *style,
@@ -26,6 +26,7 @@ G_BEGIN_DECLS
 
 typedef struct _GtkCssNode GtkCssNode;
 typedef struct _GtkCssNodeDeclaration GtkCssNodeDeclaration;
+typedef struct _GtkCssSelectorKeys GtkCssSelectorKeys;
 typedef struct _GtkCssStyle GtkCssStyle;
 typedef struct _GtkCssStaticStyle GtkCssStaticStyle;
 
@@ -23,6 +23,8 @@
 #include "gtkcssstyleprivate.h"
 #include "gtkstyleproviderprivate.h"
 
+#include "gdk/gdkallocationsprivate.h"
+
 struct _GtkCssValue {
   GTK_CSS_VALUE_BASE
 };
@@ -147,6 +149,8 @@ _gtk_css_value_alloc (const GtkCssValueClass *klass,
   value->class = klass;
   value->ref_count = 1;
 
+  gdk_allocation_add (GDK_ALLOCATION_CSS_VALUE, size);
+
 #ifdef CSS_VALUE_ACCOUNTING
   {
     ValueAccounting *c;
@@ -189,6 +193,8 @@ gtk_css_value_unref (GtkCssValue *value)
   }
 #endif
 
+  gdk_allocation_remove (GDK_ALLOCATION_CSS_VALUE);
+
   value->class->free (value);
 }
 
@@ -48,14 +48,28 @@
  * This means you do not need access to the `GtkDirectoryList`, but can access
  * the `GFile` directly from the `GFileInfo` when operating with a `GtkListView`
  * or similar.
+ *
+ * If [property@Gtk.DirectoryList:cached] is set, the results of a completed
+ * enumeration are kept in a cache that is shared between all directory lists
+ * and invalidated as soon as the directory changes. Setting the file of a
+ * list to a directory that is in the cache fills the list immediately,
+ * without enumerating it again.
  */
 
 /* random number that everyone else seems to use, too */
 #define FILES_PER_QUERY 100
+/* time that emitting items-changed for a batch of files may take before the
+ * batches get smaller */
+#define BATCH_BUDGET_US 4000
+/* number of directories kept in the enumeration cache */
+#define CACHE_SIZE 16
+/* seconds an unused directory stays in the enumeration cache */
+#define CACHE_TIMEOUT 60
 
 enum {
   PROP_0,
   PROP_ATTRIBUTES,
+  PROP_CACHED,
   PROP_ERROR,
   PROP_FILE,
   PROP_IO_PRIORITY,
@@ -86,6 +100,23 @@ free_queued_event (gpointer data)
   g_free (event);
 }
 
+typedef struct _CacheEntry CacheEntry;
+struct _CacheEntry
+{
+  GFile *file;
+  char *attributes;
+  GFileMonitor *monitor;
+  GPtrArray *infos; /* NULL while the directory is still loading */
+  gboolean valid;
+  guint timeout_id;
+  GList link;
+};
+
+/* GFile => CacheEntry */
+static GHashTable *cache;
+/* CacheEntry, most recently used first */
+static GQueue cache_lru = G_QUEUE_INIT;
+
 struct _GtkDirectoryList
 {
   GObject parent_instance;
@@ -94,9 +125,12 @@ struct _GtkDirectoryList
   GFile *file;
   GFileMonitor *monitor;
   gboolean monitored;
+  gboolean cached;
   int io_priority;
+  guint files_per_query;
 
   GCancellable *cancellable;
+  CacheEntry *cache_entry; /* to be added to the cache when loading finishes */
   GError *error; /* Error while loading */
   GSequence *items; /* Use GPtrArray or GListStore here? */
   GQueue events;
@@ -149,6 +183,134 @@ gtk_directory_list_model_init (GListModelInterface *iface)
 G_DEFINE_TYPE_WITH_CODE (GtkDirectoryList, gtk_directory_list, G_TYPE_OBJECT,
                          G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_directory_list_model_init))
 
+static void
+cache_entry_free (CacheEntry *entry)
+{
+  if (entry->monitor)
+    {
+      g_signal_handlers_disconnect_by_data (entry->monitor, entry);
+      g_file_monitor_cancel (entry->monitor);
+      g_object_unref (entry->monitor);
+    }
+  g_clear_handle_id (&entry->timeout_id, g_source_remove);
+  g_clear_pointer (&entry->infos, g_ptr_array_unref);
+  g_object_unref (entry->file);
+  g_free (entry->attributes);
+  g_free (entry);
+}
+
+static void
+cache_remove (CacheEntry *entry)
+{
+  g_queue_unlink (&cache_lru, &entry->link);
+  g_hash_table_remove (cache, entry->file);
+}
+
+static void
+cache_entry_changed (GFileMonitor      *monitor,
+                     GFile             *file,
+                     GFile             *other_file,
+                     GFileMonitorEvent  event,
+                     gpointer           data)
+{
+  CacheEntry *entry = data;
+
+  if (entry->infos)
+    cache_remove (entry);
+  else
+    entry->valid = FALSE;
+}
+
+static gboolean
+cache_entry_timeout (gpointer data)
+{
+  CacheEntry *entry = data;
+
+  entry->timeout_id = 0;
+  cache_remove (entry);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+cache_entry_start_timeout (CacheEntry *entry)
+{
+  g_clear_handle_id (&entry->timeout_id, g_source_remove);
+  entry->timeout_id = g_timeout_add_seconds (CACHE_TIMEOUT, cache_entry_timeout, entry);
+  gdk_source_set_static_name_by_id (entry->timeout_id, "[gtk] directory list cache timeout");
+}
+
+static CacheEntry *
+cache_entry_new (GFile      *file,
+                 const char *attributes)
+{
+  CacheEntry *entry;
+  GFileMonitor *monitor;
+
+  monitor = g_file_monitor_directory (file, G_FILE_MONITOR_WATCH_MOVES, NULL, NULL);
+  if (monitor == NULL)
+    return NULL;
+
+  entry = g_new0 (CacheEntry, 1);
+  entry->file = g_object_ref (file);
+  entry->attributes = g_strdup (attributes);
+  entry->monitor = monitor;
+  entry->valid = TRUE;
+  entry->link.data = entry;
+  g_signal_connect (monitor, "changed", G_CALLBACK (cache_entry_changed), entry);
+
+  return entry;
+}
+
+static void
+cache_insert (CacheEntry *entry,
+              GSequence  *items)
+{
+  GSequenceIter *iter;
+  CacheEntry *old;
+
+  if (cache == NULL)
+    cache = g_hash_table_new_full (g_file_hash, (GEqualFunc) g_file_equal,
+                                   NULL, (GDestroyNotify) cache_entry_free);
+
+  old = g_hash_table_lookup (cache, entry->file);
+  if (old)
+    cache_remove (old);
+
+  entry->infos = g_ptr_array_new_full (g_sequence_get_length (items), g_object_unref);
+  for (iter = g_sequence_get_begin_iter (items);
+       !g_sequence_iter_is_end (iter);
+       iter = g_sequence_iter_next (iter))
+    g_ptr_array_add (entry->infos, g_object_ref (g_sequence_get (iter)));
+
+  g_hash_table_insert (cache, entry->file, entry);
+  g_queue_push_head_link (&cache_lru, &entry->link);
+  cache_entry_start_timeout (entry);
+
+  while (g_queue_get_length (&cache_lru) > CACHE_SIZE)
+    cache_remove (g_queue_peek_tail (&cache_lru));
+}
+
+static CacheEntry *
+cache_lookup (GFile      *file,
+              const char *attributes)
+{
+  CacheEntry *entry;
+
+  if (cache == NULL)
+    return NULL;
+
+  entry = g_hash_table_lookup (cache, file);
+  if (entry == NULL || g_strcmp0 (entry->attributes, attributes) != 0)
+    return NULL;
+
+  g_queue_unlink (&cache_lru, &entry->link);
+  g_queue_push_head_link (&cache_lru, &entry->link);
+  cache_entry_start_timeout (entry);
+
+  return entry;
+}
+
 static void
 gtk_directory_list_set_property (GObject      *object,
                                  guint         prop_id,
@@ -162,6 +324,11 @@ gtk_directory_list_set_property (GObject      *object,
     case PROP_ATTRIBUTES:
       gtk_directory_list_set_attributes (self, g_value_get_string (value));
       break;
+
+    case PROP_CACHED:
+      gtk_directory_list_set_cached (self, g_value_get_boolean (value));
+      break;
+
     case PROP_FILE:
       gtk_directory_list_set_file (self, g_value_get_object (value));
       break;
@@ -194,6 +361,10 @@ gtk_directory_list_get_property (GObject     *object,
       g_value_set_string (value, self->attributes);
       break;
 
+    case PROP_CACHED:
+      g_value_set_boolean (value, self->cached);
+      break;
+
     case PROP_ERROR:
       g_value_set_boxed (value, self->error);
       break;
@@ -231,6 +402,8 @@ gtk_directory_list_get_property (GObject     *object,
 static gboolean
 gtk_directory_list_stop_loading (GtkDirectoryList *self)
 {
+  g_clear_pointer (&self->cache_entry, cache_entry_free);
+
   if (self->cancellable == NULL)
     return FALSE;
 
@@ -292,6 +465,18 @@ gtk_directory_list_class_init (GtkDirectoryListClass *class)
                            NULL,
                            GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkDirectoryList:cached: (attributes org.gtk.Property.get=gtk_directory_list_get_cached org.gtk.Property.set=gtk_directory_list_set_cached)
+   *
+   * %TRUE if enumeration results are shared via the enumeration cache.
+   *
+   * Since: 4.16
+   */
+  properties[PROP_CACHED] =
+      g_param_spec_boolean ("cached", NULL, NULL,
+                            FALSE,
+                            GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
   /**
    * GtkDirectoryList:error: (attributes org.gtk.Property.get=gtk_directory_list_get_error)
    *
@@ -374,6 +559,7 @@ gtk_directory_list_init (GtkDirectoryList *self)
 {
   self->items = g_sequence_new (g_object_unref);
   self->io_priority = G_PRIORITY_DEFAULT;
+  self->files_per_query = FILES_PER_QUERY;
   self->monitored = TRUE;
   g_queue_init (&self->events);
 }
@@ -432,6 +618,39 @@ gtk_directory_list_enumerator_closed_cb (GObject      *source,
   g_file_enumerator_close_finish (G_FILE_ENUMERATOR (source), res, NULL);
 }
 
+static void gtk_directory_list_got_files_cb (GObject      *source,
+                                             GAsyncResult *res,
+                                             gpointer      user_data);
+
+static void
+gtk_directory_list_next_files (GtkDirectoryList *self,
+                               GFileEnumerator  *enumerator)
+{
+  g_file_enumerator_next_files_async (enumerator,
+                                      self->files_per_query,
+                                      self->io_priority,
+                                      self->cancellable,
+                                      gtk_directory_list_got_files_cb,
+                                      self);
+}
+
+/* Grow batches while handling them is cheap for whoever listens to
+ * items-changed, and shrink them again when it would cost frames.
+ */
+static void
+gtk_directory_list_update_files_per_query (GtkDirectoryList *self,
+                                           gint64            elapsed)
+{
+  guint max_files;
+
+  max_files = g_file_is_native (self->file) ? 50 * FILES_PER_QUERY : FILES_PER_QUERY;
+
+  if (elapsed > BATCH_BUDGET_US)
+    self->files_per_query = MAX (self->files_per_query / 2, FILES_PER_QUERY / 4);
+  else if (elapsed < BATCH_BUDGET_US / 2)
+    self->files_per_query = MIN (self->files_per_query * 2, max_files);
+}
+
 static void
 gtk_directory_list_got_files_cb (GObject      *source,
                                  GAsyncResult *res,
@@ -439,8 +658,10 @@ gtk_directory_list_got_files_cb (GObject      *source,
 {
   GtkDirectoryList *self = user_data; /* invalid if cancelled */
   GFileEnumerator *enumerator = G_FILE_ENUMERATOR (source);
+  GCancellable *cancellable;
   GError *error = NULL;
   GList *l, *files;
+  gint64 start;
   guint n;
 
   files = g_file_enumerator_next_files_finish (enumerator, res, &error);
@@ -466,9 +687,18 @@ gtk_directory_list_got_files_cb (GObject      *source,
 
       if (error)
         {
+          g_clear_pointer (&self->cache_entry, cache_entry_free);
           self->error = error;
           g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_ERROR]);
         }
+      else if (self->cache_entry)
+        {
+          if (self->cache_entry->valid)
+            cache_insert (self->cache_entry, self->items);
+          else
+            cache_entry_free (self->cache_entry);
+          self->cache_entry = NULL;
+        }
 
       g_object_thaw_notify (G_OBJECT (self));
       return;
@@ -489,18 +719,34 @@ gtk_directory_list_got_files_cb (GObject      *source,
     }
   g_list_free (files);
 
-  g_file_enumerator_next_files_async (enumerator,
-                                      g_file_is_native (self->file) ? 50 * FILES_PER_QUERY : FILES_PER_QUERY,
-                                      self->io_priority,
-                                      self->cancellable,
-                                      gtk_directory_list_got_files_cb,
-                                      self);
+  if (n == 0)
+    {
+      gtk_directory_list_next_files (self, enumerator);
+      return;
+    }
+
+  /* Handlers may change or drop the list, which cancels the load */
+  cancellable = g_object_ref (self->cancellable);
+
+  start = g_get_monotonic_time ();
+  g_list_model_items_changed (G_LIST_MODEL (self), g_sequence_get_length (self->items) - n, 0, n);
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
 
-  if (n > 0)
+  if (g_cancellable_is_cancelled (cancellable))
     {
-      g_list_model_items_changed (G_LIST_MODEL (self), g_sequence_get_length (self->items) - n, 0, n);
-      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+      g_file_enumerator_close_async (enumerator,
+                                     G_PRIORITY_DEFAULT,
+                                     NULL,
+                                     gtk_directory_list_enumerator_closed_cb,
+                                     NULL);
+    }
+  else
+    {
+      gtk_directory_list_update_files_per_query (self, g_get_monotonic_time () - start);
+      gtk_directory_list_next_files (self, enumerator);
     }
+
+  g_object_unref (cancellable);
 }
 
 static void
@@ -523,6 +769,7 @@ gtk_directory_list_got_enumerator_cb (GObject      *source,
         }
 
       g_object_freeze_notify (G_OBJECT (self));
+      g_clear_pointer (&self->cache_entry, cache_entry_free);
       self->error = error;
       g_clear_object (&self->cancellable);
       g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LOADING]);
@@ -531,15 +778,32 @@ gtk_directory_list_got_enumerator_cb (GObject      *source,
       return;
     }
 
-  g_file_enumerator_next_files_async (enumerator,
-                                      g_file_is_native (file) ? 50 * FILES_PER_QUERY : FILES_PER_QUERY,
-                                      self->io_priority,
-                                      self->cancellable,
-                                      gtk_directory_list_got_files_cb,
-                                      self);
+  gtk_directory_list_next_files (self, enumerator);
   g_object_unref (enumerator);
 }
 
+static gboolean
+gtk_directory_list_load_from_cache (GtkDirectoryList *self)
+{
+  CacheEntry *entry;
+  guint i;
+
+  entry = cache_lookup (self->file, self->attributes);
+  if (entry == NULL)
+    return FALSE;
+
+  for (i = 0; i < entry->infos->len; i++)
+    g_sequence_append (self->items, g_object_ref (g_ptr_array_index (entry->infos, i)));
+
+  if (entry->infos->len > 0)
+    {
+      g_list_model_items_changed (G_LIST_MODEL (self), 0, 0, entry->infos->len);
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+    }
+
+  return TRUE;
+}
+
 static void
 gtk_directory_list_start_loading (GtkDirectoryList *self)
 {
@@ -549,13 +813,18 @@ gtk_directory_list_start_loading (GtkDirectoryList *self)
   was_loading = gtk_directory_list_stop_loading (self);
   gtk_directory_list_clear_items (self);
 
-  if (self->file == NULL)
+  if (self->file == NULL ||
+      (self->cached && gtk_directory_list_load_from_cache (self)))
     {
       if (was_loading)
         g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LOADING]);
       return;
     }
 
+  if (self->cached)
+    self->cache_entry = cache_entry_new (self->file, self->attributes);
+
+  self->files_per_query = FILES_PER_QUERY;
   glib_apis_suck = g_strconcat ("standard::name,", self->attributes, NULL);
   self->cancellable = g_cancellable_new ();
   g_file_enumerate_children_async (self->file,
@@ -1045,3 +1314,56 @@ gtk_directory_list_get_monitored (GtkDirectoryList *self)
 
   return self->monitored;
 }
+
+/**
+ * gtk_directory_list_set_cached: (attributes org.gtk.Method.set_property=cached)
+ * @self: a `GtkDirectoryList`
+ * @cached: %TRUE to use the enumeration cache
+ *
+ * Sets whether the directory list uses the shared enumeration cache.
+ *
+ * When the cache is used, the results of every completed enumeration
+ * are kept for a while, and directories that are in the cache are not
+ * enumerated again when they are loaded. The cache monitors the
+ * directories it contains and drops them as soon as they change.
+ *
+ * The `GFileInfo`s in the cache are shared between all directory
+ * lists that load the same directory, so they should not be modified.
+ *
+ * Since: 4.16
+ */
+void
+gtk_directory_list_set_cached (GtkDirectoryList *self,
+                               gboolean          cached)
+{
+  g_return_if_fail (GTK_IS_DIRECTORY_LIST (self));
+
+  if (self->cached == cached)
+    return;
+
+  self->cached = cached;
+
+  if (!cached)
+    g_clear_pointer (&self->cache_entry, cache_entry_free);
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_CACHED]);
+}
+
+/**
+ * gtk_directory_list_get_cached: (attributes org.gtk.Method.get_property=cached)
+ * @self: a `GtkDirectoryList`
+ *
+ * Returns whether the directory list uses the shared
+ * enumeration cache.
+ *
+ * Returns: %TRUE if the enumeration cache is used
+ *
+ * Since: 4.16
+ */
+gboolean
+gtk_directory_list_get_cached (GtkDirectoryList *self)
+{
+  g_return_val_if_fail (GTK_IS_DIRECTORY_LIST (self), FALSE);
+
+  return self->cached;
+}
@@ -67,5 +67,11 @@ void                    gtk_directory_list_set_monitored        (GtkDirectoryLis
 GDK_AVAILABLE_IN_ALL
 gboolean                gtk_directory_list_get_monitored        (GtkDirectoryList       *self);
 
+GDK_AVAILABLE_IN_4_16
+void                    gtk_directory_list_set_cached           (GtkDirectoryList       *self,
+                                                                 gboolean                cached);
+GDK_AVAILABLE_IN_4_16
+gboolean                gtk_directory_list_get_cached           (GtkDirectoryList       *self);
+
 G_END_DECLS
 
@@ -205,6 +205,7 @@ gtk_drop_controller_motion_class_init (GtkDropControllerMotionClass *klass)
 
   controller_class->handle_event = gtk_drop_controller_motion_handle_event;
   controller_class->handle_crossing = gtk_drop_controller_motion_handle_crossing;
+  controller_class->event_types = GTK_EVENT_TYPES_DND;
 
   /**
    * GtkDropControllerMotion:contains-pointer: (attributes org.gtk.Property.get=gtk_drop_controller_motion_contains_pointer)
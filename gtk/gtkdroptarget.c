@@ -635,6 +635,7 @@ gtk_drop_target_class_init (GtkDropTargetClass *class)
   controller_class->handle_event = gtk_drop_target_handle_event;
   controller_class->filter_event = gtk_drop_target_filter_event;
   controller_class->handle_crossing = gtk_drop_target_handle_crossing;
+  controller_class->event_types = GTK_EVENT_TYPES_DND;
 
   class->accept = gtk_drop_target_accept;
   class->enter = gtk_drop_target_enter;
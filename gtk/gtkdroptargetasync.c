@@ -374,6 +374,7 @@ gtk_drop_target_async_class_init (GtkDropTargetAsyncClass *class)
   controller_class->handle_event = gtk_drop_target_async_handle_event;
   controller_class->filter_event = gtk_drop_target_async_filter_event;
   controller_class->handle_crossing = gtk_drop_target_async_handle_crossing;
+  controller_class->event_types = GTK_EVENT_TYPES_DND;
 
   class->accept = gtk_drop_target_async_accept;
   class->drag_enter = gtk_drop_target_async_drag_enter;
@@ -23,9 +23,9 @@
 #include "gtkbox.h"
 #include "gtkbutton.h"
 #include "gtkentry.h"
+#include "gtkcssstylechangeprivate.h"
 #include "gtkflowboxprivate.h"
 #include "gtkstack.h"
-#include "gtklabel.h"
 #include "gtkgesturelongpress.h"
 #include "gtkpopover.h"
 #include "gtkscrolledwindow.h"
@@ -72,6 +72,131 @@
 
 #define BOX_SPACE 6
 
+/* Emoji are drawn from layouts that are shared between all choosers,
+ * instead of giving every emoji a label with its own layout. There is
+ * one set of layouts for each font the emoji are shown in. The glyphs
+ * themselves end up in the glyph cache of the renderer, which is shared
+ * as well.
+ */
+typedef struct
+{
+  PangoLayout *layout;
+  PangoRectangle extents;
+  gboolean usable;
+} EmojiGlyph;
+
+typedef struct
+{
+  PangoContext *context;
+  int max_width;
+  GHashTable *glyphs;
+} EmojiFont;
+
+static GHashTable *emoji_fonts;
+
+static void
+emoji_glyph_free (gpointer data)
+{
+  EmojiGlyph *glyph = data;
+
+  g_object_unref (glyph->layout);
+  g_free (glyph);
+}
+
+static EmojiGlyph *
+emoji_font_get_glyph (EmojiFont  *font,
+                      const char *text)
+{
+  EmojiGlyph *glyph;
+  PangoAttrList *attrs;
+  PangoRectangle ink;
+
+  glyph = g_hash_table_lookup (font->glyphs, text);
+  if (glyph)
+    return glyph;
+
+  glyph = g_new (EmojiGlyph, 1);
+  glyph->layout = pango_layout_new (font->context);
+  pango_layout_set_text (glyph->layout, text, -1);
+  attrs = pango_attr_list_new ();
+  pango_attr_list_insert (attrs, pango_attr_scale_new (PANGO_SCALE_X_LARGE));
+  pango_layout_set_attributes (glyph->layout, attrs);
+  pango_attr_list_unref (attrs);
+
+  pango_layout_get_extents (glyph->layout, &ink, &glyph->extents);
+
+  /* Check for fallback rendering that generates too wide items */
+  glyph->usable = pango_layout_get_unknown_glyphs_count (glyph->layout) == 0 &&
+                  ink.width < 1.5 * font->max_width;
+
+  pango_extents_to_pixels (&glyph->extents, NULL);
+
+  g_hash_table_insert (font->glyphs, g_strdup (text), glyph);
+
+  return glyph;
+}
+
+static EmojiFont *
+get_emoji_font (GtkWidget *widget)
+{
+  PangoContext *context;
+  const cairo_font_options_t *options;
+  char *font_name;
+  char *key;
+  EmojiFont *font;
+
+  context = gtk_widget_get_pango_context (widget);
+  options = pango_cairo_context_get_font_options (context);
+  font_name = pango_font_description_to_string (pango_context_get_font_description (context));
+  key = g_strdup_printf ("%p %s %lu %g",
+                         pango_context_get_font_map (context),
+                         font_name,
+                         options ? cairo_font_options_hash (options) : 0,
+                         pango_cairo_context_get_resolution (context));
+  g_free (font_name);
+
+  if (emoji_fonts == NULL)
+    emoji_fonts = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  font = g_hash_table_lookup (emoji_fonts, key);
+  if (font)
+    {
+      g_free (key);
+      return font;
+    }
+
+  font = g_new0 (EmojiFont, 1);
+  /* A copy, so that the layouts don't change with the widget */
+  font->context = gtk_widget_create_pango_context (widget);
+  font->glyphs = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, emoji_glyph_free);
+
+  /* Get a reasonable maximum width for an emoji. We do this to
+   * skip overly wide fallback rendering for certain emojis the
+   * font does not contain and therefore end up being rendered
+   * as multiply glyphs.
+   */
+  {
+    PangoLayout *layout = pango_layout_new (font->context);
+    PangoAttrList *attrs;
+    PangoRectangle rect;
+
+    pango_layout_set_text (layout, "🙂", -1);
+    attrs = pango_attr_list_new ();
+    pango_attr_list_insert (attrs, pango_attr_scale_new (PANGO_SCALE_X_LARGE));
+    pango_layout_set_attributes (layout, attrs);
+    pango_attr_list_unref (attrs);
+
+    pango_layout_get_extents (layout, &rect, NULL);
+    font->max_width = rect.width;
+
+    g_object_unref (layout);
+  }
+
+  g_hash_table_insert (emoji_fonts, key, font);
+
+  return font;
+}
+
 GType gtk_emoji_chooser_child_get_type (void);
 
 #define GTK_TYPE_EMOJI_CHOOSER_CHILD (gtk_emoji_chooser_child_get_type ())
@@ -80,6 +205,8 @@ typedef struct
 {
   GtkFlowBoxChild parent;
   GtkWidget *variations;
+  char *text;
+  EmojiGlyph *glyph;
 } GtkEmojiChooserChild;
 
 typedef struct
@@ -104,6 +231,89 @@ gtk_emoji_chooser_child_dispose (GObject *object)
   G_OBJECT_CLASS (gtk_emoji_chooser_child_parent_class)->dispose (object);
 }
 
+static void
+gtk_emoji_chooser_child_finalize (GObject *object)
+{
+  GtkEmojiChooserChild *child = (GtkEmojiChooserChild *)object;
+
+  g_free (child->text);
+
+  G_OBJECT_CLASS (gtk_emoji_chooser_child_parent_class)->finalize (object);
+}
+
+static EmojiGlyph *
+gtk_emoji_chooser_child_get_glyph (GtkEmojiChooserChild *child)
+{
+  if (child->glyph == NULL)
+    child->glyph = emoji_font_get_glyph (get_emoji_font (GTK_WIDGET (child)), child->text);
+
+  return child->glyph;
+}
+
+static void
+gtk_emoji_chooser_child_measure (GtkWidget      *widget,
+                                 GtkOrientation  orientation,
+                                 int             for_size,
+                                 int            *minimum,
+                                 int            *natural,
+                                 int            *minimum_baseline,
+                                 int            *natural_baseline)
+{
+  EmojiGlyph *glyph = gtk_emoji_chooser_child_get_glyph ((GtkEmojiChooserChild *)widget);
+
+  if (orientation == GTK_ORIENTATION_HORIZONTAL)
+    *minimum = *natural = glyph->extents.width;
+  else
+    *minimum = *natural = glyph->extents.height;
+}
+
+static void
+gtk_emoji_chooser_child_snapshot (GtkWidget   *widget,
+                                  GtkSnapshot *snapshot)
+{
+  EmojiGlyph *glyph = gtk_emoji_chooser_child_get_glyph ((GtkEmojiChooserChild *)widget);
+  GdkRGBA color;
+
+  gtk_widget_get_color (widget, &color);
+
+  gtk_snapshot_save (snapshot);
+  gtk_snapshot_translate (snapshot,
+                          &GRAPHENE_POINT_INIT ((gtk_widget_get_width (widget) - glyph->extents.width) / 2 - glyph->extents.x,
+                                                (gtk_widget_get_height (widget) - glyph->extents.height) / 2 - glyph->extents.y));
+  gtk_snapshot_append_layout (snapshot, glyph->layout, &color);
+  gtk_snapshot_restore (snapshot);
+
+  GTK_WIDGET_CLASS (gtk_emoji_chooser_child_parent_class)->snapshot (widget, snapshot);
+}
+
+static void
+gtk_emoji_chooser_child_css_changed (GtkWidget         *widget,
+                                     GtkCssStyleChange *change)
+{
+  GtkEmojiChooserChild *child = (GtkEmojiChooserChild *)widget;
+
+  GTK_WIDGET_CLASS (gtk_emoji_chooser_child_parent_class)->css_changed (widget, change);
+
+  if (change == NULL ||
+      gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_TEXT_ATTRS | GTK_CSS_AFFECTS_TEXT_SIZE))
+    {
+      child->glyph = NULL;
+      gtk_widget_queue_resize (widget);
+    }
+}
+
+static void
+gtk_emoji_chooser_child_system_setting_changed (GtkWidget        *widget,
+                                                GtkSystemSetting  setting)
+{
+  GtkEmojiChooserChild *child = (GtkEmojiChooserChild *)widget;
+
+  GTK_WIDGET_CLASS (gtk_emoji_chooser_child_parent_class)->system_setting_changed (widget, setting);
+
+  child->glyph = NULL;
+  gtk_widget_queue_resize (widget);
+}
+
 static void
 gtk_emoji_chooser_child_size_allocate (GtkWidget *widget,
                                        int        width,
@@ -164,6 +374,11 @@ gtk_emoji_chooser_child_class_init (GtkEmojiChooserChildClass *class)
   GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (class);
 
   object_class->dispose = gtk_emoji_chooser_child_dispose;
+  object_class->finalize = gtk_emoji_chooser_child_finalize;
+  widget_class->measure = gtk_emoji_chooser_child_measure;
+  widget_class->snapshot = gtk_emoji_chooser_child_snapshot;
+  widget_class->css_changed = gtk_emoji_chooser_child_css_changed;
+  widget_class->system_setting_changed = gtk_emoji_chooser_child_system_setting_changed;
   widget_class->size_allocate = gtk_emoji_chooser_child_size_allocate;
   widget_class->focus = gtk_emoji_chooser_child_focus;
   widget_class->grab_focus = gtk_emoji_chooser_child_grab_focus;
@@ -199,8 +414,6 @@ struct _GtkEmojiChooser
   GtkWidget *stack;
   GtkWidget *scrolled_window;
 
-  int emoji_max_width;
-
   EmojiSection recent;
   EmojiSection people;
   EmojiSection body;
@@ -419,7 +632,6 @@ emoji_activated (GtkFlowBox      *box,
 {
   GtkEmojiChooser *chooser = data;
   char *text;
-  GtkWidget *label;
   GVariant *item;
   gunichar modifier;
 
@@ -434,8 +646,7 @@ emoji_activated (GtkFlowBox      *box,
         gtk_popover_popdown (GTK_POPOVER (popover));
     }
 
-  label = gtk_flow_box_child_get_child (child);
-  text = g_strdup (gtk_label_get_label (GTK_LABEL (label)));
+  text = g_strdup (((GtkEmojiChooserChild *)child)->text);
 
   item = (GVariant*) g_object_get_data (G_OBJECT (child), "emoji-data");
   modifier = (gunichar) GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (child), "modifier"));
@@ -555,15 +766,12 @@ add_emoji (GtkWidget    *box,
            gunichar      modifier,
            GtkEmojiChooser *chooser)
 {
-  GtkWidget *child;
-  GtkWidget *label;
-  PangoAttrList *attrs;
+  GtkEmojiChooserChild *child;
+  EmojiGlyph *glyph;
   GVariant *codes;
   char text[64];
   char *p = text;
   int i;
-  PangoLayout *layout;
-  PangoRectangle rect;
   gunichar code = 0;
 
   codes = g_variant_get_child_value (item, 0);
@@ -581,33 +789,22 @@ add_emoji (GtkWidget    *box,
 
   p[0] = 0;
 
-  label = gtk_label_new (text);
-  attrs = pango_attr_list_new ();
-  pango_attr_list_insert (attrs, pango_attr_scale_new (PANGO_SCALE_X_LARGE));
-  gtk_label_set_attributes (GTK_LABEL (label), attrs);
-  pango_attr_list_unref (attrs);
-
-  layout = gtk_label_get_layout (GTK_LABEL (label));
-  pango_layout_get_extents (layout, &rect, NULL);
-
-  /* Check for fallback rendering that generates too wide items */
-  if (pango_layout_get_unknown_glyphs_count (layout) > 0 ||
-      rect.width >= 1.5 * chooser->emoji_max_width)
-    {
-      g_object_ref_sink (label);
-      g_object_unref (label);
-      return;
-    }
+  glyph = emoji_font_get_glyph (get_emoji_font (GTK_WIDGET (chooser)), text);
+  if (!glyph->usable)
+    return;
 
   child = g_object_new (GTK_TYPE_EMOJI_CHOOSER_CHILD, NULL);
+  child->text = g_strdup (text);
+  gtk_accessible_update_property (GTK_ACCESSIBLE (child),
+                                  GTK_ACCESSIBLE_PROPERTY_LABEL, text,
+                                  -1);
   g_object_set_data_full (G_OBJECT (child), "emoji-data",
                           g_variant_ref (item),
                           (GDestroyNotify)g_variant_unref);
   if (modifier != 0)
     g_object_set_data (G_OBJECT (child), "modifier", GUINT_TO_POINTER (modifier));
 
-  gtk_flow_box_child_set_child (GTK_FLOW_BOX_CHILD (child), label);
-  gtk_flow_box_insert (GTK_FLOW_BOX (box), child, prepend ? 0 : -1);
+  gtk_flow_box_insert (GTK_FLOW_BOX (box), GTK_WIDGET (child), prepend ? 0 : -1);
 }
 
 static GBytes *
@@ -716,12 +913,20 @@ populate_emoji_chooser (gpointer data)
 
   if (!chooser->data)
     {
-      GBytes *bytes;
+      static GVariant *emoji_data;
+
+      /* The data does not change, so share it between all choosers */
+      if (!emoji_data)
+        {
+          GBytes *bytes;
+
+          bytes = get_emoji_data ();
 
-      bytes = get_emoji_data ();
+          emoji_data = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE ("a(aussasasu)"), bytes, TRUE));
+          g_bytes_unref (bytes);
+        }
 
-      chooser->data = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE ("a(aussasasu)"), bytes, TRUE));
-      g_bytes_unref (bytes);
+      chooser->data = g_variant_ref (emoji_data);
     }
 
   if (!chooser->iter)
@@ -1005,27 +1210,6 @@ gtk_emoji_chooser_init (GtkEmojiChooser *chooser)
   text = gtk_search_entry_get_text_widget (GTK_SEARCH_ENTRY (chooser->search_entry));
   gtk_text_set_input_hints (text, GTK_INPUT_HINT_NO_EMOJI);
 
-  /* Get a reasonable maximum width for an emoji. We do this to
-   * skip overly wide fallback rendering for certain emojis the
-   * font does not contain and therefore end up being rendered
-   * as multiply glyphs.
-   */
-  {
-    PangoLayout *layout = gtk_widget_create_pango_layout (GTK_WIDGET (chooser), "🙂");
-    PangoAttrList *attrs;
-    PangoRectangle rect;
-
-    attrs = pango_attr_list_new ();
-    pango_attr_list_insert (attrs, pango_attr_scale_new (PANGO_SCALE_X_LARGE));
-    pango_layout_set_attributes (layout, attrs);
-    pango_attr_list_unref (attrs);
-
-    pango_layout_get_extents (layout, &rect, NULL);
-    chooser->emoji_max_width = rect.width;
-
-    g_object_unref (layout);
-  }
-
   adj = gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (chooser->scrolled_window));
   g_signal_connect (adj, "value-changed", G_CALLBACK (adj_value_changed), chooser);
 
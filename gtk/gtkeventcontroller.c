@@ -70,6 +70,8 @@ struct _GtkEventControllerPrivate
 
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE (GtkEventController, gtk_event_controller, G_TYPE_OBJECT)
 
+G_STATIC_ASSERT (GDK_EVENT_LAST <= 32);
+
 static void
 gtk_event_controller_set_widget (GtkEventController *self,
                                  GtkWidget          *widget)
@@ -190,6 +192,7 @@ gtk_event_controller_class_init (GtkEventControllerClass *klass)
   klass->filter_event = gtk_event_controller_filter_event_default;
   klass->handle_event = gtk_event_controller_handle_event_default;
   klass->handle_crossing = gtk_event_controller_handle_crossing_default;
+  klass->event_types = GTK_EVENT_TYPES_ALL;
 
   object_class->finalize = gtk_event_controller_finalize;
   object_class->set_property = gtk_event_controller_set_property;
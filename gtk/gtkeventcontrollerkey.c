@@ -187,6 +187,7 @@ gtk_event_controller_key_class_init (GtkEventControllerKeyClass *klass)
   object_class->finalize = gtk_event_controller_key_finalize;
   controller_class->handle_event = gtk_event_controller_key_handle_event;
   controller_class->handle_crossing = gtk_event_controller_key_handle_crossing;
+  controller_class->event_types = GTK_EVENT_TYPES_KEY;
 
   /**
    * GtkEventControllerKey::key-pressed:
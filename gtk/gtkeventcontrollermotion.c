@@ -192,6 +192,7 @@ gtk_event_controller_motion_class_init (GtkEventControllerMotionClass *klass)
 
   controller_class->handle_event = gtk_event_controller_motion_handle_event;
   controller_class->handle_crossing = gtk_event_controller_motion_handle_crossing;
+  controller_class->event_types = GTK_EVENT_TYPE_MASK (GDK_MOTION_NOTIFY);
 
   /**
    * GtkEventControllerMotion:is-pointer: (attributes org.gtk.Property.get=gtk_event_controller_motion_is_pointer)
@@ -113,9 +113,31 @@ struct _GtkEventControllerClass
   gboolean (* filter_event) (GtkEventController *controller,
                              GdkEvent           *event);
 
+  /* The event types handle_event can do anything with, as a mask of
+   * GTK_EVENT_TYPE_MASK() bits. Widgets use it to skip controllers,
+   * and the coordinate translation for themselves, on other events.
+   */
+  guint event_types;
+
   gpointer padding[10];
 };
 
+#define GTK_EVENT_TYPE_MASK(type) (1u << (type))
+
+#define GTK_EVENT_TYPES_ALL G_MAXUINT
+#define GTK_EVENT_TYPES_KEY (GTK_EVENT_TYPE_MASK (GDK_KEY_PRESS) | \
+                             GTK_EVENT_TYPE_MASK (GDK_KEY_RELEASE))
+#define GTK_EVENT_TYPES_DND (GTK_EVENT_TYPE_MASK (GDK_DRAG_ENTER) | \
+                             GTK_EVENT_TYPE_MASK (GDK_DRAG_LEAVE) | \
+                             GTK_EVENT_TYPE_MASK (GDK_DRAG_MOTION) | \
+                             GTK_EVENT_TYPE_MASK (GDK_DROP_START))
+
+static inline guint
+gtk_event_controller_get_event_types (GtkEventController *controller)
+{
+  return GTK_EVENT_CONTROLLER_GET_CLASS (controller)->event_types;
+}
+
 GtkWidget * gtk_event_controller_get_target (GtkEventController *controller);
 
 
@@ -519,6 +519,8 @@ gtk_event_controller_scroll_class_init (GtkEventControllerScrollClass *klass)
   object_class->get_property = gtk_event_controller_scroll_get_property;
 
   controller_class->handle_event = gtk_event_controller_scroll_handle_event;
+  controller_class->event_types = GTK_EVENT_TYPE_MASK (GDK_SCROLL) |
+                                   GTK_EVENT_TYPE_MASK (GDK_TOUCHPAD_HOLD);
 
   /**
    * GtkEventControllerScroll:flags: (attributes org.gtk.Property.get=gtk_event_controller_scroll_get_flags org.gtk.Property.set=gtk_event_controller_scroll_set_flags)
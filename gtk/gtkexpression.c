@@ -19,9 +19,11 @@
 
 #include "config.h"
 
-#include "gtkexpression.h"
+#include "gtkexpressionprivate.h"
 
 #include "gtkprivate.h"
+#include "gtkstringlist.h"
+#include "gtktreelistmodel.h"
 
 #include <gobject/gvaluecollector.h>
 
@@ -1163,6 +1165,18 @@ gtk_object_expression_get_object (GtkExpression *expression)
  *
  * A `GObject` property value in a `GtkExpression`.
  */
+typedef enum {
+  GTK_PROPERTY_STEP_GENERIC,
+  GTK_PROPERTY_STEP_STRING_OBJECT_STRING,
+  GTK_PROPERTY_STEP_TREE_LIST_ROW_ITEM,
+} GtkPropertyStepKind;
+
+typedef struct
+{
+  GParamSpec *pspec;
+  GtkPropertyStepKind kind;
+} GtkPropertyStep;
+
 struct _GtkPropertyExpression
 {
   GtkExpression parent;
@@ -1170,6 +1184,14 @@ struct _GtkPropertyExpression
   GtkExpression *expr;
 
   GParamSpec *pspec;
+
+  /* The chain of property expressions ending in this one, flattened
+   * when the expression is created, so evaluating it does not need
+   * to recurse through the nested expressions.
+   */
+  GtkExpression *root; /* first expression that isn't a property expression */
+  guint n_steps;
+  GtkPropertyStep *steps;
 };
 
 static void
@@ -1178,6 +1200,7 @@ gtk_property_expression_finalize (GtkExpression *expr)
   GtkPropertyExpression *self = (GtkPropertyExpression *) expr;
 
   g_clear_pointer (&self->expr, gtk_expression_unref);
+  g_free (self->steps);
 
   GTK_EXPRESSION_SUPER (expr)->finalize (expr);
 }
@@ -1188,39 +1211,127 @@ gtk_property_expression_is_static (GtkExpression *expr)
   return FALSE;
 }
 
+static GtkPropertyStepKind
+gtk_property_step_get_kind (GParamSpec *pspec)
+{
+  /* Properties with a C getter that can be called directly. This
+   * is only safe on final types, which can't override the property.
+   */
+  if (pspec->owner_type == GTK_TYPE_STRING_OBJECT &&
+      g_str_equal (pspec->name, "string"))
+    return GTK_PROPERTY_STEP_STRING_OBJECT_STRING;
+  else if (pspec->owner_type == GTK_TYPE_TREE_LIST_ROW &&
+           g_str_equal (pspec->name, "item"))
+    return GTK_PROPERTY_STEP_TREE_LIST_ROW_ITEM;
+  else
+    return GTK_PROPERTY_STEP_GENERIC;
+}
+
+static void
+gtk_property_expression_compile (GtkPropertyExpression *self)
+{
+  GtkExpression *expr;
+  guint i;
+
+  self->n_steps = 1;
+  for (expr = self->expr;
+       expr != NULL && G_TYPE_CHECK_INSTANCE_TYPE (expr, GTK_TYPE_PROPERTY_EXPRESSION);
+       expr = ((GtkPropertyExpression *) expr)->expr)
+    self->n_steps++;
+
+  self->root = expr;
+  self->steps = g_new (GtkPropertyStep, self->n_steps);
+
+  expr = (GtkExpression *) self;
+  for (i = self->n_steps; i-- > 0; expr = ((GtkPropertyExpression *) expr)->expr)
+    {
+      GParamSpec *pspec = ((GtkPropertyExpression *) expr)->pspec;
+
+      self->steps[i].pspec = pspec;
+      self->steps[i].kind = gtk_property_step_get_kind (pspec);
+    }
+}
+
+static GObject *
+gtk_property_step_get_object (const GtkPropertyStep *step,
+                              GObject               *object)
+{
+  GValue value = G_VALUE_INIT;
+  GObject *result;
+
+  if (step->kind == GTK_PROPERTY_STEP_TREE_LIST_ROW_ITEM &&
+      GTK_IS_TREE_LIST_ROW (object))
+    return gtk_tree_list_row_get_item (GTK_TREE_LIST_ROW (object));
+
+  g_object_get_property (object, step->pspec->name, &value);
+
+  if (!G_VALUE_HOLDS_OBJECT (&value))
+    {
+      g_value_unset (&value);
+      return NULL;
+    }
+
+  result = g_value_dup_object (&value);
+  g_value_unset (&value);
+
+  return result;
+}
+
+/* Returns the object to read the property of the last step from */
 static GObject *
 gtk_property_expression_get_object (GtkPropertyExpression *self,
                                     gpointer               this)
 {
-  GValue expr_value = G_VALUE_INIT;
   GObject *object;
+  guint i;
 
-  if (self->expr == NULL)
+  if (self->root == NULL)
     {
-      if (this)
-        return g_object_ref (this);
-      else
+      if (this == NULL)
         return NULL;
+
+      object = g_object_ref (this);
     }
+  else
+    {
+      GValue expr_value = G_VALUE_INIT;
 
-  if (!gtk_expression_evaluate (self->expr, this, &expr_value))
-    return NULL;
+      if (!gtk_expression_evaluate (self->root, this, &expr_value))
+        return NULL;
 
-  if (!G_VALUE_HOLDS_OBJECT (&expr_value))
-    {
+      if (!G_VALUE_HOLDS_OBJECT (&expr_value))
+        {
+          g_value_unset (&expr_value);
+          return NULL;
+        }
+
+      object = g_value_dup_object (&expr_value);
       g_value_unset (&expr_value);
-      return NULL;
-    }
+      if (object == NULL)
+        return NULL;
 
-  object = g_value_dup_object (&expr_value);
-  g_value_unset (&expr_value);
-  if (object == NULL)
-    return NULL;
+      if (!G_TYPE_CHECK_INSTANCE_TYPE (object, self->steps[0].pspec->owner_type))
+        {
+          g_object_unref (object);
+          return NULL;
+        }
+    }
 
-  if (!G_TYPE_CHECK_INSTANCE_TYPE (object, self->pspec->owner_type))
+  for (i = 1; i < self->n_steps; i++)
     {
+      GObject *next;
+
+      next = gtk_property_step_get_object (&self->steps[i - 1], object);
       g_object_unref (object);
-      return NULL;
+      object = next;
+      if (object == NULL)
+        return NULL;
+
+      if (!G_TYPE_CHECK_INSTANCE_TYPE (object, self->steps[i].pspec->owner_type))
+        {
+          g_object_unref (object);
+          return NULL;
+        }
     }
 
   return object;
@@ -1238,7 +1349,17 @@ gtk_property_expression_evaluate (GtkExpression *expr,
   if (object == NULL)
     return FALSE;
 
-  g_object_get_property (object, self->pspec->name, value);
+  if (self->steps[self->n_steps - 1].kind == GTK_PROPERTY_STEP_STRING_OBJECT_STRING &&
+      GTK_IS_STRING_OBJECT (object) &&
+      (!G_IS_VALUE (value) || G_VALUE_HOLDS_STRING (value)))
+    {
+      if (!G_IS_VALUE (value))
+        g_value_init (value, G_TYPE_STRING);
+      g_value_set_string (value, gtk_string_object_get_string (GTK_STRING_OBJECT (object)));
+    }
+  else
+    g_object_get_property (object, self->pspec->name, value);
+
   g_object_unref (object);
   return TRUE;
 }
@@ -1460,6 +1581,7 @@ gtk_property_expression_new_for_pspec (GtkExpression *expression,
 
   self->pspec = pspec;
   self->expr = expression;
+  gtk_property_expression_compile (self);
 
   return result;
 }
@@ -1915,6 +2037,74 @@ gtk_expression_evaluate (GtkExpression *self,
   return GTK_EXPRESSION_GET_CLASS (self)->evaluate (self, this_, value);
 }
 
+/*<private>
+ * gtk_expression_evaluate_string:
+ * @self: a `GtkExpression` of type %G_TYPE_STRING
+ * @this_: (transfer none) (type GObject) (nullable): the this argument for the evaluation
+ * @value: an empty `GValue`
+ *
+ * Evaluates @self and returns the resulting string.
+ *
+ * The string is owned by @value, which must be unset when the
+ * string is no longer needed. Depending on the expression, @value
+ * may hold the object the string belongs to instead of a copy
+ * of it.
+ *
+ * If the expression cannot be evaluated or evaluates to %NULL,
+ * %NULL is returned and @value is left empty.
+ *
+ * Returns: (nullable) (transfer none): the string
+ */
+const char *
+gtk_expression_evaluate_string (GtkExpression *self,
+                                gpointer       this_,
+                                GValue        *value)
+{
+  const char *result;
+
+  g_return_val_if_fail (GTK_IS_EXPRESSION (self), NULL);
+  g_return_val_if_fail (this_ == NULL || G_IS_OBJECT (this_), NULL);
+  g_return_val_if_fail (value != NULL, NULL);
+
+  if (G_TYPE_CHECK_INSTANCE_TYPE (self, GTK_TYPE_PROPERTY_EXPRESSION))
+    {
+      GtkPropertyExpression *pself = (GtkPropertyExpression *) self;
+
+      if (pself->steps[pself->n_steps - 1].kind == GTK_PROPERTY_STEP_STRING_OBJECT_STRING)
+        {
+          GObject *object = gtk_property_expression_get_object (pself, this_);
+
+          if (object == NULL)
+            return NULL;
+
+          if (GTK_IS_STRING_OBJECT (object))
+            {
+              result = gtk_string_object_get_string (GTK_STRING_OBJECT (object));
+              if (result == NULL)
+                {
+                  g_object_unref (object);
+                  return NULL;
+                }
+
+              g_value_init (value, G_TYPE_OBJECT);
+              g_value_take_object (value, object);
+              return result;
+            }
+
+          g_object_unref (object);
+        }
+    }
+
+  if (!gtk_expression_evaluate (self, this_, value))
+    return NULL;
+
+  result = g_value_get_string (value);
+  if (result == NULL)
+    g_value_unset (value);
+
+  return result;
+}
+
 /**
  * gtk_expression_is_static:
  * @self: a `GtkExpression`
@@ -37,6 +37,11 @@
 /* random number that everyone else seems to use, too */
 #define FILES_PER_QUERY 100
 
+/* number of g_file_query_info_async() calls running at the same time
+ * to fill in the attributes that are not queried while enumerating
+ */
+#define MAX_INFO_QUERIES 8
+
 typedef struct _FileModelNode           FileModelNode;
 
 struct _FileModelNode
@@ -51,6 +56,7 @@ struct _FileModelNode
   guint                 visible :1;     /* if the file is currently visible */
   guint                 filtered_out :1;/* if the file is currently filtered out (i.e. it didn't pass the filters) */
   guint                 frozen_add :1;  /* true if the model was frozen and the entry has not been added yet */
+  guint                 needs_info :1;  /* true if info only contains model->fast_attributes */
 };
 
 struct _GtkFileSystemModel
@@ -60,6 +66,7 @@ struct _GtkFileSystemModel
   GFile *               dir;            /* directory that's displayed */
   guint                 dir_thaw_source;/* GSource id for unfreezing the model */
   char *                attributes;     /* attributes the file info must contain, or NULL for all attributes */
+  char *                fast_attributes;/* attributes to enumerate the directory with, or NULL to use attributes */
   GFileMonitor *        dir_monitor;    /* directory that is monitored, or NULL if monitoring was not supported */
 
   GCancellable *        cancellable;    /* cancellable in use for all operations - cancelled on dispose */
@@ -75,6 +82,10 @@ struct _GtkFileSystemModel
 
   guint                 frozen;         /* number of times we're frozen */
 
+  GQueue                visible_info_queue; /* GFiles of visible nodes that need info */
+  GQueue                hidden_info_queue;  /* GFiles of invisible nodes that need info */
+  guint                 n_info_queries; /* number of running queries for nodes that need info */
+
   unsigned int          filter_on_thaw   : 1; /* set when filtering needs to happen upon thawing */
   unsigned int          show_hidden      : 1; /* whether to show hidden files */
   unsigned int          show_folders     : 1; /* whether to show folders */
@@ -307,6 +318,183 @@ node_get_for_file (GtkFileSystemModel *model,
   return GTK_INVALID_LIST_POSITION;
 }
 
+/*** Info queries ***/
+
+/* Enumerating a directory only queries model->fast_attributes, so that
+ * the names show up quickly even where sniffing the content type is
+ * slow, like on network shares. The full attributes are then queried
+ * per file, for visible files first. Until then, the content type is
+ * guessed from the file name.
+ */
+
+static void gtk_file_system_model_query_infos (GtkFileSystemModel *model);
+
+static void
+gtk_file_system_model_info_done (GObject      *object,
+                                 GAsyncResult *res,
+                                 gpointer      data)
+{
+  GtkFileSystemModel *model = data;
+  GFile *file = G_FILE (object);
+  GFileInfo *info;
+  GError *error = NULL;
+  FileModelNode *node;
+  guint id;
+
+  info = g_file_query_info_finish (file, res, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+      g_error_free (error);
+      return;
+    }
+  g_clear_error (&error);
+
+  model->n_info_queries--;
+
+  id = node_get_for_file (model, file);
+  if (id != GTK_INVALID_LIST_POSITION)
+    {
+      node = get_node (model, id);
+      if (node->needs_info)
+        {
+          node->needs_info = FALSE;
+
+          if (info)
+            {
+              /* Keep the GFileInfo, it is the item in the list model */
+              g_file_info_copy_into (info, node->info);
+              g_file_info_set_attribute_object (node->info, "standard::file", G_OBJECT (file));
+
+              if (!node->frozen_add)
+                {
+                  node_compute_visibility_and_filters (model, id);
+                  g_list_model_items_changed (G_LIST_MODEL (model), id, 1, 1);
+                }
+            }
+        }
+    }
+
+  g_clear_object (&info);
+
+  gtk_file_system_model_query_infos (model);
+}
+
+static void
+gtk_file_system_model_query_infos (GtkFileSystemModel *model)
+{
+  while (model->n_info_queries < MAX_INFO_QUERIES)
+    {
+      GFile *file;
+
+      file = g_queue_pop_head (&model->visible_info_queue);
+      if (file == NULL)
+        file = g_queue_pop_head (&model->hidden_info_queue);
+      if (file == NULL)
+        break;
+
+      g_file_query_info_async (file,
+                               model->attributes,
+                               G_FILE_QUERY_INFO_NONE,
+                               G_PRIORITY_LOW,
+                               model->cancellable,
+                               gtk_file_system_model_info_done,
+                               model);
+      model->n_info_queries++;
+
+      g_object_unref (file);
+    }
+}
+
+/* Must be called once the visibility of a new node is known */
+static void
+node_queue_info (GtkFileSystemModel *model,
+                 guint               id)
+{
+  FileModelNode *node = get_node (model, id);
+
+  if (!node->needs_info)
+    return;
+
+  g_queue_push_tail (node->visible ? &model->visible_info_queue : &model->hidden_info_queue,
+                     g_object_ref (node->file));
+
+  gtk_file_system_model_query_infos (model);
+}
+
+/* Returns the attributes to enumerate a directory with, or %NULL
+ * if all @attributes are fast to query
+ */
+static char *
+get_fast_attributes (const char *attributes)
+{
+  GString *fast;
+  char **split;
+  gboolean has_slow, has_fast_content_type;
+  guint i;
+
+  if (attributes == NULL)
+    return NULL;
+
+  split = g_strsplit (attributes, ",", -1);
+  fast = g_string_new (NULL);
+  has_slow = FALSE;
+  has_fast_content_type = FALSE;
+
+  for (i = 0; split[i]; i++)
+    {
+      if (g_str_equal (split[i], G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE))
+        {
+          has_slow = TRUE;
+          continue;
+        }
+
+      if (g_str_equal (split[i], G_FILE_ATTRIBUTE_STANDARD_FAST_CONTENT_TYPE))
+        has_fast_content_type = TRUE;
+
+      if (fast->len > 0)
+        g_string_append_c (fast, ',');
+      g_string_append (fast, split[i]);
+    }
+
+  g_strfreev (split);
+
+  if (!has_slow)
+    {
+      g_string_free (fast, TRUE);
+      return NULL;
+    }
+
+  if (!has_fast_content_type)
+    {
+      if (fast->len > 0)
+        g_string_append_c (fast, ',');
+      g_string_append (fast, G_FILE_ATTRIBUTE_STANDARD_FAST_CONTENT_TYPE);
+    }
+
+  return g_string_free (fast, FALSE);
+}
+
+/* Sets a content type that is good enough for filtering, sorting
+ * and icons until the real one has been queried
+ */
+static void
+set_fast_content_type (GFileInfo *info)
+{
+  const char *content_type;
+  char *guessed;
+
+  content_type = g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_STANDARD_FAST_CONTENT_TYPE);
+  if (content_type)
+    {
+      g_file_info_set_content_type (info, content_type);
+      return;
+    }
+
+  guessed = g_content_type_guess (g_file_info_get_name (info), NULL, 0, NULL);
+  g_file_info_set_content_type (info, guessed);
+  g_free (guessed);
+}
+
 /*** GListModel ***/
 
 static GType
@@ -419,6 +607,7 @@ thaw_updates (GtkFileSystemModel *model)
 
           node->frozen_add = FALSE;
           node_compute_visibility_and_filters (model, i);
+          node_queue_info (model, i);
           if (changed_idx == G_MAXUINT)
             changed_idx = i;
         }
@@ -433,7 +622,8 @@ thaw_updates (GtkFileSystemModel *model)
 static void
 add_file (GtkFileSystemModel *model,
           GFile              *file,
-          GFileInfo          *info)
+          GFileInfo          *info,
+          gboolean            needs_info)
 {
   FileModelNode *node;
   guint position;
@@ -450,6 +640,7 @@ add_file (GtkFileSystemModel *model,
       node->info = g_object_ref (info);
     }
   node->frozen_add = model->frozen ? TRUE : FALSE;
+  node->needs_info = needs_info;
 
   g_array_append_vals (model->files, node, 1);
   g_free (node);
@@ -460,6 +651,7 @@ add_file (GtkFileSystemModel *model,
     {
       node_compute_visibility_and_filters (model, position);
       g_list_model_items_changed (G_LIST_MODEL (model), position, 0, 1);
+      node_queue_info (model, position);
     }
 }
 
@@ -521,6 +713,8 @@ gtk_file_system_model_dispose (GObject *object)
   g_clear_handle_id (&model->dir_thaw_source, g_source_remove);
 
   g_cancellable_cancel (model->cancellable);
+  g_queue_clear_full (&model->visible_info_queue, g_object_unref);
+  g_queue_clear_full (&model->hidden_info_queue, g_object_unref);
   if (model->dir_monitor)
     g_file_monitor_cancel (model->dir_monitor);
 
@@ -544,6 +738,7 @@ gtk_file_system_model_finalize (GObject *object)
 
   g_clear_object (&model->cancellable);
   g_clear_pointer (&model->attributes, g_free);
+  g_clear_pointer (&model->fast_attributes, g_free);
   g_clear_object (&model->dir);
   g_clear_object (&model->dir_monitor);
   g_clear_pointer (&model->file_lookup, g_hash_table_destroy);
@@ -641,8 +836,10 @@ gtk_file_system_model_got_files (GObject      *object,
               g_object_unref (info);
               continue;
             }
+          if (model->fast_attributes)
+            set_fast_content_type (info);
           file = g_file_get_child (model->dir, name);
-          add_file (model, file, info);
+          add_file (model, file, info, model->fast_attributes != NULL);
           g_object_unref (file);
           g_object_unref (info);
         }
@@ -693,13 +890,14 @@ gtk_file_system_model_update_file (GtkFileSystemModel *model,
   id = node_get_for_file (model, file);
   if (id == GTK_INVALID_LIST_POSITION)
     {
-      add_file (model, file, info);
+      add_file (model, file, info, FALSE);
       id = node_get_for_file (model, file);
     }
 
   node = get_node (model, id);
 
   g_set_object (&node->info, info);
+  node->needs_info = FALSE;
 
   g_file_info_set_attribute_object (info, "standard::file", G_OBJECT (file));
 }
@@ -821,9 +1019,10 @@ gtk_file_system_model_set_directory (GtkFileSystemModel *model,
 
   model->dir = g_object_ref (dir);
   model->attributes = g_strdup (attributes);
+  model->fast_attributes = get_fast_attributes (attributes);
 
   g_file_enumerate_children_async (model->dir,
-                                   attributes,
+                                   model->fast_attributes ? model->fast_attributes : attributes,
                                    G_FILE_QUERY_INFO_NONE,
                                    IO_PRIORITY,
                                    model->cancellable,
@@ -866,6 +1065,10 @@ _gtk_file_system_model_new (void)
  * If supported, it will also monitor the drectory and update the model's
  * contents to reflect changes, if the @directory supports monitoring.
  *
+ * Files are added before their content type is known, because sniffing
+ * it can be slow. It is queried in the background, and files are updated
+ * with it as the results arrive.
+ *
  * Returns: the newly created `GtkFileSystemModel`
  **/
 GtkFileSystemModel *
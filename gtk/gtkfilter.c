@@ -19,7 +19,7 @@
 
 #include "config.h"
 
-#include "gtkfilter.h"
+#include "gtkfilterprivate.h"
 
 #include "gtktypebuiltins.h"
 #include "gtkprivate.h"
@@ -52,7 +52,13 @@ enum {
   LAST_SIGNAL
 };
 
-G_DEFINE_TYPE (GtkFilter, gtk_filter, G_TYPE_OBJECT)
+typedef struct _GtkFilterPrivate GtkFilterPrivate;
+struct _GtkFilterPrivate
+{
+  gboolean thread_safe;
+};
+
+G_DEFINE_TYPE_WITH_PRIVATE (GtkFilter, gtk_filter, G_TYPE_OBJECT)
 
 static guint signals[LAST_SIGNAL] = { 0 };
 
@@ -185,3 +191,43 @@ gtk_filter_changed (GtkFilter       *self,
   g_signal_emit (self, signals[CHANGED], 0, change);
 }
 
+/*<private>
+ * gtk_filter_is_thread_safe:
+ * @self: a `GtkFilter`
+ *
+ * Checks if [method@Gtk.Filter.match] may be called for @self
+ * from other threads than the main thread.
+ *
+ * Filters are not thread safe unless the implementation says
+ * so with gtk_filter_set_thread_safe().
+ *
+ * Returns: %TRUE if @self can match items in any thread
+ */
+gboolean
+gtk_filter_is_thread_safe (GtkFilter *self)
+{
+  GtkFilterPrivate *priv = gtk_filter_get_instance_private (self);
+
+  return priv->thread_safe;
+}
+
+/*<private>
+ * gtk_filter_set_thread_safe:
+ * @self: a `GtkFilter`
+ * @thread_safe: if the match function is thread safe
+ *
+ * Filter implementations call this when the way they match
+ * items doesn't touch any state that is owned by the main thread.
+ *
+ * Matching from threads still only happens while the main thread
+ * waits for it, so the filter may not change while that happens.
+ */
+void
+gtk_filter_set_thread_safe (GtkFilter *self,
+                            gboolean   thread_safe)
+{
+  GtkFilterPrivate *priv = gtk_filter_get_instance_private (self);
+
+  priv->thread_safe = thread_safe;
+}
+
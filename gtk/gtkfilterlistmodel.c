@@ -22,6 +22,8 @@
 #include "gtkfilterlistmodel.h"
 
 #include "gtkbitset.h"
+#include "gtkfilterprivate.h"
+#include "gtklistmodelbatchprivate.h"
 #include "gtkprivate.h"
 #include "gtksectionmodelprivate.h"
 
@@ -41,6 +43,17 @@
  * `GtkFilterListModel` passes through sections from the underlying model.
  */
 
+/* The minimum amount of items each thread gets when filtering in parallel
+ *
+ * When filtering all pending items in one go and the filter is thread safe,
+ * the items are split into chunks that are matched in worker threads.
+ * Starting threads has a cost, so don't do this for few items.
+ */
+#define GTK_FILTER_PARALLEL_CHUNK_SIZE (16 * 1024)
+
+/* The maximum number of chunks when filtering in parallel */
+#define GTK_FILTER_PARALLEL_MAX_CHUNKS (8)
+
 enum {
   PROP_0,
   PROP_FILTER,
@@ -64,6 +77,8 @@ struct _GtkFilterListModel
   GtkBitset *matches; /* NULL if strictness != GTK_FILTER_MATCH_SOME */
   GtkBitset *pending; /* not yet filtered items or NULL if all filtered */
   guint pending_cb; /* idle callback handle */
+
+  GtkListModelBatch batch;
 };
 
 struct _GtkFilterListModelClass
@@ -250,6 +265,100 @@ gtk_filter_list_model_run_filter_on_item (GtkFilterListModel *self,
   return visible;
 }
 
+typedef struct
+{
+  GtkFilter *filter;
+  gpointer *items;
+  guint8 *visible;
+  guint n_items;
+} GtkFilterChunk;
+
+static gpointer
+gtk_filter_list_model_filter_chunk (gpointer data)
+{
+  GtkFilterChunk *chunk = data;
+  guint i;
+
+  for (i = 0; i < chunk->n_items; i++)
+    chunk->visible[i] = gtk_filter_match (chunk->filter, chunk->items[i]);
+
+  return NULL;
+}
+
+/* Matches all pending items in worker threads.
+ *
+ * Getting the items from the model needs the main thread, so that
+ * happens before and after the threads run.
+ */
+static gboolean
+gtk_filter_list_model_run_filter_parallel (GtkFilterListModel *self)
+{
+  GtkFilterChunk chunks[GTK_FILTER_PARALLEL_MAX_CHUNKS];
+  GThread *threads[GTK_FILTER_PARALLEL_MAX_CHUNKS];
+  GtkBitsetIter iter;
+  gpointer *items;
+  guint *positions;
+  guint8 *visible;
+  guint i, pos, n_items, n_chunks, chunk_size;
+  gboolean more;
+
+  if (!gtk_filter_is_thread_safe (self->filter))
+    return FALSE;
+
+  n_items = gtk_bitset_get_size (self->pending);
+  n_chunks = MIN (n_items / GTK_FILTER_PARALLEL_CHUNK_SIZE, g_get_num_processors ());
+  n_chunks = MIN (n_chunks, GTK_FILTER_PARALLEL_MAX_CHUNKS);
+  if (n_chunks < 2)
+    return FALSE;
+
+  items = g_new (gpointer, n_items);
+  positions = g_new (guint, n_items);
+  visible = g_new (guint8, n_items);
+
+  for (i = 0, more = gtk_bitset_iter_init_first (&iter, self->pending, &pos);
+       more;
+       i++, more = gtk_bitset_iter_next (&iter, &pos))
+    {
+      positions[i] = pos;
+      items[i] = g_list_model_get_item (self->model, pos);
+    }
+
+  chunk_size = n_items / n_chunks;
+  for (i = 0; i < n_chunks; i++)
+    {
+      chunks[i].filter = self->filter;
+      chunks[i].items = items + i * chunk_size;
+      chunks[i].visible = visible + i * chunk_size;
+      chunks[i].n_items = i + 1 < n_chunks ? chunk_size : n_items - i * chunk_size;
+    }
+
+  /* The main thread matches the first chunk itself */
+  for (i = 1; i < n_chunks; i++)
+    threads[i] = g_thread_new ("[gtk] filter", gtk_filter_list_model_filter_chunk, &chunks[i]);
+
+  gtk_filter_list_model_filter_chunk (&chunks[0]);
+
+  for (i = 1; i < n_chunks; i++)
+    g_thread_join (threads[i]);
+
+  for (i = 0; i < n_items; i++)
+    {
+      if (visible[i])
+        gtk_bitset_add (self->matches, positions[i]);
+      else
+        gtk_bitset_remove (self->matches, positions[i]);
+      g_object_unref (items[i]);
+    }
+
+  g_free (visible);
+  g_free (positions);
+  g_free (items);
+
+  g_clear_pointer (&self->pending, gtk_bitset_unref);
+
+  return TRUE;
+}
+
 static void
 gtk_filter_list_model_run_filter (GtkFilterListModel *self,
                                   guint               n_steps)
@@ -263,12 +372,18 @@ gtk_filter_list_model_run_filter (GtkFilterListModel *self,
   if (self->pending == NULL)
     return;
 
+  if (n_steps == G_MAXUINT &&
+      gtk_filter_list_model_run_filter_parallel (self))
+    return;
+
   for (i = 0, more = gtk_bitset_iter_init_first (&iter, self->pending, &pos);
        i < n_steps && more;
        i++, more = gtk_bitset_iter_next (&iter, &pos))
     {
       if (gtk_filter_list_model_run_filter_on_item (self, pos))
         gtk_bitset_add (self->matches, pos);
+      else
+        gtk_bitset_remove (self->matches, pos);
     }
 
   if (more)
@@ -305,12 +420,10 @@ gtk_filter_list_model_emit_items_changed_for_changes (GtkFilterListModel *self,
       max = gtk_bitset_get_maximum (changes);
       removed = gtk_bitset_get_size_in_range (old, min, max);
       added = gtk_bitset_get_size_in_range (self->matches, min, max);
-      g_list_model_items_changed (G_LIST_MODEL (self),
-                                  min > 0 ? gtk_bitset_get_size_in_range (self->matches, 0, min - 1) : 0,
-                                  removed,
-                                  added);
-      if (removed != added)
-        g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+      gtk_list_model_batch_items_changed (&self->batch, G_LIST_MODEL (self), properties[PROP_N_ITEMS],
+                                          min > 0 ? gtk_bitset_get_size_in_range (self->matches, 0, min - 1) : 0,
+                                          removed,
+                                          added);
     }
   gtk_bitset_unref (changes);
   gtk_bitset_unref (old);
@@ -383,9 +496,8 @@ gtk_filter_list_model_items_changed_cb (GListModel         *model,
       return;
 
     case GTK_FILTER_MATCH_ALL:
-      g_list_model_items_changed (G_LIST_MODEL (self), position, removed, added);
-      if (removed != added)
-        g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+      gtk_list_model_batch_items_changed (&self->batch, G_LIST_MODEL (self), properties[PROP_N_ITEMS],
+                                          position, removed, added);
       return;
 
     case GTK_FILTER_MATCH_SOME:
@@ -413,11 +525,9 @@ gtk_filter_list_model_items_changed_cb (GListModel         *model,
     filter_added = 0;
 
   if (filter_removed > 0 || filter_added > 0)
-    g_list_model_items_changed (G_LIST_MODEL (self),
-                                position > 0 ? gtk_bitset_get_size_in_range (self->matches, 0, position - 1) : 0,
-                                filter_removed, filter_added);
-  if (filter_removed != filter_added)
-    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+    gtk_list_model_batch_items_changed (&self->batch, G_LIST_MODEL (self), properties[PROP_N_ITEMS],
+                                        position > 0 ? gtk_bitset_get_size_in_range (self->matches, 0, position - 1) : 0,
+                                        filter_removed, filter_added);
 }
 
 static void
@@ -491,12 +601,16 @@ gtk_filter_list_model_get_property (GObject     *object,
 static void
 gtk_filter_list_model_clear_model (GtkFilterListModel *self)
 {
+  guint i;
+
   if (self->model == NULL)
     return;
 
   gtk_filter_list_model_stop_filtering (self);
   g_signal_handlers_disconnect_by_func (self->model, gtk_filter_list_model_items_changed_cb, self);
   g_signal_handlers_disconnect_by_func (self->model, gtk_filter_list_model_sections_changed_cb, self);
+  for (i = 0; i < self->batch.depth; i++)
+    gtk_list_model_end_batch (self->model);
   g_clear_object (&self->model);
   if (self->matches)
     gtk_bitset_remove_all (self->matches);
@@ -527,8 +641,8 @@ gtk_filter_list_model_refilter (GtkFilterListModel *self,
         gtk_filter_list_model_stop_filtering (self);
         if (n_before > 0)
           {
-            g_list_model_items_changed (G_LIST_MODEL (self), 0, n_before, 0);
-            g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+            gtk_list_model_batch_items_changed (&self->batch, G_LIST_MODEL (self), properties[PROP_N_ITEMS],
+                                                0, n_before, 0);
           }
       }
       break;
@@ -544,8 +658,8 @@ gtk_filter_list_model_refilter (GtkFilterListModel *self,
             n_items = g_list_model_get_n_items (self->model);
             if (n_items > 0)
               {
-                g_list_model_items_changed (G_LIST_MODEL (self), 0, 0, n_items);
-                g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+                gtk_list_model_batch_items_changed (&self->batch, G_LIST_MODEL (self), properties[PROP_N_ITEMS],
+                                                    0, 0, n_items);
               }
           }
           break;
@@ -582,8 +696,8 @@ gtk_filter_list_model_refilter (GtkFilterListModel *self,
                 gtk_bitset_unref (inverse);
 
                 g_clear_pointer (&self->matches, gtk_bitset_unref);
-                g_list_model_items_changed (G_LIST_MODEL (self), start, n_before - end - start, n_after - end - start);
-                g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+                gtk_list_model_batch_items_changed (&self->batch, G_LIST_MODEL (self), properties[PROP_N_ITEMS],
+                                                    start, n_before - end - start, n_after - end - start);
               }
           }
           break;
@@ -625,7 +739,10 @@ gtk_filter_list_model_refilter (GtkFilterListModel *self,
             gtk_bitset_subtract (pending, self->matches);
             break;
           case GTK_FILTER_CHANGE_MORE_STRICT:
-            self->matches = gtk_bitset_new_empty ();
+            /* Only current matches can still match. Keep showing them
+             * until they are checked, so incremental filtering only ever
+             * removes items. */
+            self->matches = gtk_bitset_copy (old);
             pending = gtk_bitset_copy (old);
             break;
           }
@@ -844,7 +961,7 @@ void
 gtk_filter_list_model_set_model (GtkFilterListModel *self,
                                  GListModel         *model)
 {
-  guint removed, added;
+  guint removed, added, i;
 
   g_return_if_fail (GTK_IS_FILTER_LIST_MODEL (self));
   g_return_if_fail (model == NULL || G_IS_LIST_MODEL (model));
@@ -863,6 +980,8 @@ gtk_filter_list_model_set_model (GtkFilterListModel *self,
       g_signal_connect (model, "items-changed", G_CALLBACK (gtk_filter_list_model_items_changed_cb), self);
       if (GTK_IS_SECTION_MODEL (model))
         g_signal_connect (model, "sections-changed", G_CALLBACK (gtk_filter_list_model_sections_changed_cb), self);
+      for (i = 0; i < self->batch.depth; i++)
+        gtk_list_model_begin_batch (model);
       if (removed == 0)
         {
           self->strictness = GTK_FILTER_MATCH_NONE;
@@ -886,9 +1005,8 @@ gtk_filter_list_model_set_model (GtkFilterListModel *self,
     }
 
   if (removed > 0 || added > 0)
-    g_list_model_items_changed (G_LIST_MODEL (self), 0, removed, added);
-  if (removed != added)
-    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+    gtk_list_model_batch_items_changed (&self->batch, G_LIST_MODEL (self), properties[PROP_N_ITEMS],
+                                        0, removed, added);
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_MODEL]);
 }
@@ -1010,3 +1128,19 @@ gtk_filter_list_model_get_pending (GtkFilterListModel *self)
 
   return gtk_bitset_get_size (self->pending);
 }
+
+void
+gtk_filter_list_model_set_batch (GtkFilterListModel *self,
+                                 gboolean            begin)
+{
+  if (begin)
+    {
+      gtk_list_model_batch_begin (&self->batch);
+      gtk_list_model_begin_batch (self->model);
+    }
+  else
+    {
+      gtk_list_model_end_batch (self->model);
+      gtk_list_model_batch_end (&self->batch, G_LIST_MODEL (self), properties[PROP_N_ITEMS]);
+    }
+}
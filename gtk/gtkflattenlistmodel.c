@@ -21,6 +21,7 @@
 
 #include "gtkflattenlistmodel.h"
 
+#include "gtklistmodelbatchprivate.h"
 #include "gtksectionmodel.h"
 #include "gtkrbtreeprivate.h"
 
@@ -63,6 +64,8 @@ struct _GtkFlattenListModel
 
   GListModel *model;
   GtkRbTree *items; /* NULL if model == NULL */
+
+  GtkListModelBatch batch;
 };
 
 struct _GtkFlattenListModelClass
@@ -271,9 +274,8 @@ gtk_flatten_list_model_items_changed_cb (GListModel *model,
         }
     }
 
-  g_list_model_items_changed (G_LIST_MODEL (self), real_position, removed, added);
-  if (removed != added)
-    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+  gtk_list_model_batch_items_changed (&self->batch, G_LIST_MODEL (self), properties[PROP_N_ITEMS],
+                                      real_position, removed, added);
 }
 
 static void
@@ -409,9 +411,8 @@ gtk_flatten_list_model_model_items_changed_cb (GListModel          *model,
   real_added = gtk_flatten_list_model_add_items (self, node, position, added);
 
   if (real_removed > 0 || real_added > 0)
-    g_list_model_items_changed (G_LIST_MODEL (self), real_position, real_removed, real_added);
-  if (real_removed != real_added)
-    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+    gtk_list_model_batch_items_changed (&self->batch, G_LIST_MODEL (self), properties[PROP_N_ITEMS],
+                                        real_position, real_removed, real_added);
 }
 
 static void
@@ -419,7 +420,11 @@ gtk_flatten_list_clear_model (GtkFlattenListModel *self)
 {
   if (self->model)
     {
+      guint i;
+
       g_signal_handlers_disconnect_by_func (self->model, gtk_flatten_list_model_model_items_changed_cb, self);
+      for (i = 0; i < self->batch.depth; i++)
+        gtk_list_model_end_batch (self->model);
       g_clear_object (&self->model);
       g_clear_pointer (&self->items, gtk_rb_tree_unref);
     }
@@ -522,7 +527,7 @@ void
 gtk_flatten_list_model_set_model (GtkFlattenListModel *self,
                                   GListModel          *model)
 {
-  guint removed, added = 0;
+  guint removed, added = 0, i;
 
   g_return_if_fail (GTK_IS_FLATTEN_LIST_MODEL (self));
   g_return_if_fail (model == NULL || G_IS_LIST_MODEL (model));
@@ -539,6 +544,8 @@ gtk_flatten_list_model_set_model (GtkFlattenListModel *self,
     {
       g_object_ref (model);
       g_signal_connect (model, "items-changed", G_CALLBACK (gtk_flatten_list_model_model_items_changed_cb), self);
+      for (i = 0; i < self->batch.depth; i++)
+        gtk_list_model_begin_batch (model);
       self->items = gtk_rb_tree_new (FlattenNode,
                                      FlattenAugment,
                                      gtk_flatten_list_model_augment,
@@ -549,9 +556,8 @@ gtk_flatten_list_model_set_model (GtkFlattenListModel *self,
     }
 
   if (removed > 0 || added > 0)
-    g_list_model_items_changed (G_LIST_MODEL (self), 0, removed, added);
-  if (removed != added)
-    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+    gtk_list_model_batch_items_changed (&self->batch, G_LIST_MODEL (self), properties[PROP_N_ITEMS],
+                                        0, removed, added);
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_MODEL]);
 }
@@ -596,3 +602,21 @@ gtk_flatten_list_model_get_model_for_item (GtkFlattenListModel *self,
 
   return node->model;
 }
+
+void
+gtk_flatten_list_model_set_batch (GtkFlattenListModel *self,
+                                  gboolean             begin)
+{
+  /* Only the model of models is batched, the models inside it come
+   * and go during a batch and other code may be batching them. */
+  if (begin)
+    {
+      gtk_list_model_batch_begin (&self->batch);
+      gtk_list_model_begin_batch (self->model);
+    }
+  else
+    {
+      gtk_list_model_end_batch (self->model);
+      gtk_list_model_batch_end (&self->batch, G_LIST_MODEL (self), properties[PROP_N_ITEMS]);
+    }
+}
@@ -762,6 +762,17 @@ gtk_gesture_class_init (GtkGestureClass *klass)
 
   controller_class->filter_event = gtk_gesture_filter_event;
   controller_class->handle_event = gtk_gesture_handle_event;
+  controller_class->event_types = GTK_EVENT_TYPE_MASK (GDK_MOTION_NOTIFY) |
+                                   GTK_EVENT_TYPE_MASK (GDK_BUTTON_PRESS) |
+                                   GTK_EVENT_TYPE_MASK (GDK_BUTTON_RELEASE) |
+                                   GTK_EVENT_TYPE_MASK (GDK_GRAB_BROKEN) |
+                                   GTK_EVENT_TYPE_MASK (GDK_TOUCH_BEGIN) |
+                                   GTK_EVENT_TYPE_MASK (GDK_TOUCH_UPDATE) |
+                                   GTK_EVENT_TYPE_MASK (GDK_TOUCH_END) |
+                                   GTK_EVENT_TYPE_MASK (GDK_TOUCH_CANCEL) |
+                                   GTK_EVENT_TYPE_MASK (GDK_TOUCHPAD_SWIPE) |
+                                   GTK_EVENT_TYPE_MASK (GDK_TOUCHPAD_PINCH) |
+                                   GTK_EVENT_TYPE_MASK (GDK_TOUCHPAD_HOLD);
   controller_class->reset = gtk_gesture_reset;
 
   klass->check = gtk_gesture_check_impl;
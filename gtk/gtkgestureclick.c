@@ -34,6 +34,7 @@
 #include "gtkgestureclick.h"
 #include "gtkgestureclickprivate.h"
 #include "gtkprivate.h"
+#include "gtksettingsprivate.h"
 #include "gtkmarshalers.h"
 
 typedef struct _GtkGestureClickPrivate GtkGestureClickPrivate;
@@ -142,7 +143,7 @@ _gtk_gesture_click_update_timeout (GtkGestureClick *gesture)
 
   widget = gtk_event_controller_get_widget (GTK_EVENT_CONTROLLER (gesture));
   settings = gtk_widget_get_settings (widget);
-  g_object_get (settings, "gtk-double-click-time", &double_click_time, NULL);
+  double_click_time = gtk_settings_get_double_click_time (settings);
 
   priv->double_click_timeout_id = g_timeout_add (double_click_time, _double_click_timeout_cb, gesture);
   gdk_source_set_static_name_by_id (priv->double_click_timeout_id, "[gtk] _double_click_timeout_cb");
@@ -34,8 +34,15 @@
 #include "gtkmain.h"
 #include "gtknative.h"
 
+#include "gdk/gdkdeviceprivate.h"
+#include "gdk/gdkeventsprivate.h"
+
 typedef struct {
   gboolean stylus_only;
+
+  /* The last motion we emitted, in the history of its device */
+  GdkDevice *history_device;
+  guint32 history_serial;
 } GtkGestureStylusPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (GtkGestureStylus, gtk_gesture_stylus, GTK_TYPE_GESTURE_SINGLE)
@@ -128,6 +135,18 @@ gtk_gesture_stylus_handle_event (GtkEventController *controller,
 
   g_signal_emit (controller, signals[n_signal], 0, x, y);
 
+  /* The backlog of a motion goes back to the one before it */
+  if (n_signal == MOTION)
+    {
+      priv->history_device = gdk_event_get_device (event);
+      priv->history_serial = gdk_motion_event_get_history_serial (event);
+    }
+  else
+    {
+      priv->history_device = NULL;
+      priv->history_serial = 0;
+    }
+
   return TRUE;
 }
 
@@ -417,7 +436,10 @@ gtk_gesture_stylus_get_axes (GtkGestureStylus  *gesture,
  * [method@Gtk.GestureStylus.get_axis] express the latest (most up-to-date)
  * state in motion history.
  *
- * The @backlog is provided in chronological order.
+ * The @backlog contains the samples that the device reported since the
+ * previous [signal@Gtk.GestureStylus::motion] signal, including those that
+ * were not delivered as separate events. It is provided in chronological
+ * order.
  *
  * Returns: %TRUE if there is a backlog to unfold in the current state.
  */
@@ -426,10 +448,12 @@ gtk_gesture_stylus_get_backlog (GtkGestureStylus  *gesture,
                                 GdkTimeCoord     **backlog,
                                 guint             *n_elems)
 {
+  GtkGestureStylusPrivate *priv = gtk_gesture_stylus_get_instance_private (gesture);
   GdkEvent *event;
-  GArray *backlog_array;
+  GArray *backlog_array, *history_array = NULL;
   GdkTimeCoord *history = NULL;
   guint n_coords = 0, i;
+  guint32 serial;
   double surf_x, surf_y;
   GtkNative *native;
   GtkWidget *event_widget;
@@ -440,8 +464,35 @@ gtk_gesture_stylus_get_backlog (GtkGestureStylus  *gesture,
 
   event = gtk_event_controller_get_current_event (GTK_EVENT_CONTROLLER (gesture));
 
-  if (event && GDK_IS_EVENT_TYPE (event, GDK_MOTION_NOTIFY))
-    history = gdk_event_get_history (event, &n_coords);
+  if (!event || !GDK_IS_EVENT_TYPE (event, GDK_MOTION_NOTIFY))
+    return FALSE;
+
+  /* Prefer the device history, as it has every sample since the last
+   * motion we saw, no matter how events were compressed or delivered
+   */
+  serial = gdk_motion_event_get_history_serial (event);
+  if (serial != 0 && priv->history_serial != 0 &&
+      priv->history_device == gdk_event_get_device (event) &&
+      serial - priv->history_serial > 1)
+    {
+      history_array = g_array_new (FALSE, FALSE, sizeof (GdkTimeCoord));
+      if (gdk_device_get_history (gdk_event_get_device (event),
+                                  gdk_event_get_surface (event),
+                                  priv->history_serial + 1,
+                                  serial - 1,
+                                  history_array) &&
+          history_array->len > 0)
+        {
+          history = (GdkTimeCoord *) history_array->data;
+          n_coords = history_array->len;
+        }
+    }
+
+  if (!history)
+    {
+      g_clear_pointer (&history_array, g_array_unref);
+      history = gdk_event_get_history (event, &n_coords);
+    }
 
   if (!history)
     return FALSE;
@@ -473,7 +524,10 @@ gtk_gesture_stylus_get_backlog (GtkGestureStylus  *gesture,
 
   *n_elems = backlog_array->len;
   *backlog = (GdkTimeCoord *) g_array_free (backlog_array, FALSE);
-  g_free (history);
+  if (history_array)
+    g_array_unref (history_array);
+  else
+    g_free (history);
 
   return TRUE;
 }
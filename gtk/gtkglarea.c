@@ -34,6 +34,7 @@
 #include "gtkcssnodeprivate.h"
 #include "gdk/gdkgltextureprivate.h"
 #include "gdk/gdkglcontextprivate.h"
+#include "gdk/gdkdebugprivate.h"
 
 #include <epoxy/gl.h>
 
@@ -148,11 +149,53 @@
  * you should use the [signal@Gtk.GLArea::create-context] signal.
  */
 
+typedef struct _GtkGLAreaThread GtkGLAreaThread;
+
 typedef struct {
   GdkGLTextureBuilder *builder;
   GdkTexture *holder;
+  GtkGLAreaThread *thread;
 } Texture;
 
+/* The state shared with the render thread in threaded mode.
+ *
+ * The thread renders into textures from its own pool. It hands the
+ * last completed frame to the main thread, which only draws it.
+ * Textures that are still in use keep a reference on this struct,
+ * so they can be released after the thread is gone.
+ */
+struct _GtkGLAreaThread
+{
+  GtkGLArea *area;
+  GdkGLContext *context;
+  GThread *thread;
+
+  GMutex mutex;
+  GCond cond;
+
+  /* Protected by the mutex */
+  int width;
+  int height;
+  gboolean has_depth_buffer;
+  gboolean has_stencil_buffer;
+  gboolean needs_render;
+  gboolean quit;
+  gboolean stopped;
+  gboolean frame_ready_pending;
+  GdkTexture *frame;
+  GList *textures;
+
+  /* Only used by the render thread */
+  gboolean use_depth_buffer;
+  gboolean use_stencil_buffer;
+  Texture *texture;
+  guint frame_buffer;
+  guint depth_stencil_buffer;
+  gboolean depth_stencil_has_stencil;
+  int buffer_width;
+  int buffer_height;
+};
+
 typedef struct {
   GdkGLContext *context;
   GError *error;
@@ -173,7 +216,10 @@ typedef struct {
   gboolean needs_render;
   gboolean auto_render;
   gboolean use_es;
+  gboolean threaded;
   GdkGLAPI allowed_apis;
+
+  GtkGLAreaThread *thread;
 } GtkGLAreaPrivate;
 
 enum {
@@ -187,6 +233,7 @@ enum {
   PROP_API,
 
   PROP_AUTO_RENDER,
+  PROP_THREADED,
 
   LAST_PROP
 };
@@ -203,6 +250,8 @@ enum {
 
 static void gtk_gl_area_allocate_buffers (GtkGLArea *area);
 static void gtk_gl_area_allocate_texture (GtkGLArea *area);
+static void gtk_gl_area_start_thread     (GtkGLArea *area);
+static void gtk_gl_area_stop_thread      (GtkGLArea *area);
 
 static guint area_signals[LAST_SIGNAL] = { 0, };
 
@@ -240,6 +289,10 @@ G_GNUC_END_IGNORE_DEPRECATIONS
       gtk_gl_area_set_allowed_apis (self, g_value_get_flags (value));
       break;
 
+    case PROP_THREADED:
+      gtk_gl_area_set_threaded (self, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
     }
@@ -285,6 +338,10 @@ G_GNUC_END_IGNORE_DEPRECATIONS
       g_value_set_flags (value, gtk_gl_area_get_api (GTK_GL_AREA (gobject)));
       break;
 
+    case PROP_THREADED:
+      g_value_set_boolean (value, priv->threaded);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
     }
@@ -309,6 +366,9 @@ gtk_gl_area_realize (GtkWidget *widget)
                          _("OpenGL context creation failed"));
 
   priv->needs_resize = TRUE;
+
+  if (priv->threaded && priv->context != NULL)
+    gtk_gl_area_start_thread (area);
 }
 
 static void
@@ -456,24 +516,70 @@ gtk_gl_area_ensure_texture (GtkGLArea *area)
     }
 
   if (priv->texture == NULL)
-    {
-      GLuint id;
+    priv->texture = create_texture (priv->context);
 
-      priv->texture = g_new (Texture, 1);
-      priv->texture->holder = NULL;
+  gtk_gl_area_allocate_texture (area);
+}
 
-      priv->texture->builder = gdk_gl_texture_builder_new ();
-      gdk_gl_texture_builder_set_context (priv->texture->builder, priv->context);
-      if (gdk_gl_context_get_api (priv->context) == GDK_GL_API_GLES)
-        gdk_gl_texture_builder_set_format (priv->texture->builder, GDK_MEMORY_R8G8B8A8_PREMULTIPLIED);
-      else
-        gdk_gl_texture_builder_set_format (priv->texture->builder, GDK_MEMORY_B8G8R8A8_PREMULTIPLIED);
+static void
+allocate_depth_stencil_buffer (guint    buffer,
+                               gboolean has_stencil_buffer,
+                               int      width,
+                               int      height)
+{
+  glBindRenderbuffer (GL_RENDERBUFFER, buffer);
+  if (has_stencil_buffer)
+    glRenderbufferStorage (GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+  else
+    glRenderbufferStorage (GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+}
 
-      glGenTextures (1, &id);
-      gdk_gl_texture_builder_set_id (priv->texture->builder, id);
-    }
+static Texture *
+create_texture (GdkGLContext *context)
+{
+  Texture *texture;
+  GLuint id;
 
-  gtk_gl_area_allocate_texture (area);
+  texture = g_new (Texture, 1);
+  texture->holder = NULL;
+  texture->thread = NULL;
+
+  texture->builder = gdk_gl_texture_builder_new ();
+  gdk_gl_texture_builder_set_context (texture->builder, context);
+  if (gdk_gl_context_get_api (context) == GDK_GL_API_GLES)
+    gdk_gl_texture_builder_set_format (texture->builder, GDK_MEMORY_R8G8B8A8_PREMULTIPLIED);
+  else
+    gdk_gl_texture_builder_set_format (texture->builder, GDK_MEMORY_B8G8R8A8_PREMULTIPLIED);
+
+  glGenTextures (1, &id);
+  gdk_gl_texture_builder_set_id (texture->builder, id);
+
+  return texture;
+}
+
+static void
+allocate_texture_storage (Texture      *texture,
+                          GdkGLContext *context,
+                          int           width,
+                          int           height)
+{
+  if (gdk_gl_texture_builder_get_width (texture->builder) == width &&
+      gdk_gl_texture_builder_get_height (texture->builder) == height)
+    return;
+
+  glBindTexture (GL_TEXTURE_2D, gdk_gl_texture_builder_get_id (texture->builder));
+  glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+  if (gdk_gl_context_get_api (context) == GDK_GL_API_GLES)
+    glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+  else
+    glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_BGRA, GL_UNSIGNED_BYTE, NULL);
+
+  gdk_gl_texture_builder_set_width (texture->builder, width);
+  gdk_gl_texture_builder_set_height (texture->builder, height);
 }
 
 /*
@@ -494,13 +600,9 @@ gtk_gl_area_allocate_buffers (GtkGLArea *area)
   height = gtk_widget_get_height (widget) * scale;
 
   if (priv->has_depth_buffer || priv->has_stencil_buffer)
-    {
-      glBindRenderbuffer (GL_RENDERBUFFER, priv->depth_stencil_buffer);
-      if (priv->has_stencil_buffer)
-        glRenderbufferStorage (GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
-      else
-        glRenderbufferStorage (GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
-    }
+    allocate_depth_stencil_buffer (priv->depth_stencil_buffer,
+                                   priv->has_stencil_buffer,
+                                   width, height);
 
   priv->needs_render = TRUE;
 }
@@ -524,23 +626,7 @@ gtk_gl_area_allocate_texture (GtkGLArea *area)
   width = gtk_widget_get_width (widget) * scale;
   height = gtk_widget_get_height (widget) * scale;
 
-  if (gdk_gl_texture_builder_get_width (priv->texture->builder) != width ||
-      gdk_gl_texture_builder_get_height (priv->texture->builder) != height)
-    {
-      glBindTexture (GL_TEXTURE_2D, gdk_gl_texture_builder_get_id (priv->texture->builder));
-      glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-      glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-      glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-      glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-      if (gdk_gl_context_get_api (priv->context) == GDK_GL_API_GLES)
-        glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-      else
-        glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_BGRA, GL_UNSIGNED_BYTE, NULL);
-
-      gdk_gl_texture_builder_set_width (priv->texture->builder, width);
-      gdk_gl_texture_builder_set_height (priv->texture->builder, height);
-    }
+  allocate_texture_storage (priv->texture, priv->context, width, height);
 }
 
 /**
@@ -564,6 +650,12 @@ gtk_gl_area_attach_buffers (GtkGLArea *area)
 
   g_return_if_fail (GTK_IS_GL_AREA (area));
 
+  if (gtk_gl_area_is_render_thread (area))
+    {
+      gtk_gl_area_thread_attach_buffers (priv->thread);
+      return;
+    }
+
   if (priv->context == NULL)
     return;
 
@@ -648,6 +740,7 @@ gtk_gl_area_unrealize (GtkWidget *widget)
   if (priv->context != NULL)
     {
       gtk_gl_area_make_current (area);
+      gtk_gl_area_stop_thread (area);
       gtk_gl_area_delete_buffers (area);
       gtk_gl_area_delete_textures (area);
 
@@ -715,6 +808,438 @@ release_texture (gpointer data)
   texture->holder = NULL;
 }
 
+/* Threaded rendering {{{ */
+
+static gboolean
+gtk_gl_area_is_render_thread (GtkGLArea *area)
+{
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+
+  return priv->thread != NULL && priv->thread->thread == g_thread_self ();
+}
+
+static void
+gtk_gl_area_thread_free (gpointer data)
+{
+  GtkGLAreaThread *thread = data;
+
+  g_assert (thread->textures == NULL);
+
+  g_object_unref (thread->context);
+  g_mutex_clear (&thread->mutex);
+  g_cond_clear (&thread->cond);
+}
+
+/* Called wherever the last reference to a frame is dropped.
+ * Textures are put back into the pool, unless the thread has
+ * exited already, in which case nobody will use them again.
+ */
+static void
+gtk_gl_area_thread_release_texture (gpointer data)
+{
+  Texture *texture = data;
+  GtkGLAreaThread *thread = texture->thread;
+  gboolean stopped;
+  gpointer sync;
+
+  sync = gdk_gl_texture_builder_get_sync (texture->builder);
+  if (sync)
+    {
+      glDeleteSync (sync);
+      gdk_gl_texture_builder_set_sync (texture->builder, NULL);
+    }
+
+  g_mutex_lock (&thread->mutex);
+  texture->holder = NULL;
+  stopped = thread->stopped;
+  if (stopped)
+    thread->textures = g_list_remove (thread->textures, texture);
+  g_mutex_unlock (&thread->mutex);
+
+  if (stopped)
+    delete_one_texture (texture);
+
+  g_atomic_rc_box_release_full (thread, gtk_gl_area_thread_free);
+}
+
+static gboolean
+gtk_gl_area_thread_frame_ready (gpointer data)
+{
+  GtkGLAreaThread *thread = data;
+  GtkGLArea *area;
+
+  g_mutex_lock (&thread->mutex);
+  thread->frame_ready_pending = FALSE;
+  area = thread->area;
+  g_mutex_unlock (&thread->mutex);
+
+  if (area)
+    gtk_widget_queue_draw (GTK_WIDGET (area));
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gtk_gl_area_thread_attach_buffers (GtkGLAreaThread *thread)
+{
+  glBindFramebuffer (GL_FRAMEBUFFER, thread->frame_buffer);
+
+  if (thread->texture != NULL)
+    glFramebufferTexture2D (GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                            GL_TEXTURE_2D, gdk_gl_texture_builder_get_id (thread->texture->builder), 0);
+
+  if (thread->depth_stencil_buffer)
+    {
+      if (thread->use_depth_buffer)
+        glFramebufferRenderbuffer (GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                                   GL_RENDERBUFFER, thread->depth_stencil_buffer);
+      if (thread->use_stencil_buffer)
+        glFramebufferRenderbuffer (GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT,
+                                   GL_RENDERBUFFER, thread->depth_stencil_buffer);
+    }
+}
+
+/* Runs on the render thread, with the mutex unlocked */
+static GdkTexture *
+gtk_gl_area_thread_render (GtkGLAreaThread *thread,
+                           GtkGLArea       *area,
+                           int              width,
+                           int              height)
+{
+  GdkTexture *frame;
+  gpointer sync = NULL;
+  gboolean unused;
+  gboolean resized;
+  GLenum status;
+
+  /* The storage format depends on the stencil buffer */
+  if (thread->depth_stencil_buffer != 0 &&
+      thread->use_stencil_buffer != thread->depth_stencil_has_stencil)
+    {
+      glDeleteRenderbuffers (1, &thread->depth_stencil_buffer);
+      thread->depth_stencil_buffer = 0;
+    }
+
+  if (thread->texture == NULL)
+    thread->texture = create_texture (thread->context);
+  allocate_texture_storage (thread->texture, thread->context, width, height);
+
+  if (thread->frame_buffer == 0)
+    glGenFramebuffers (1, &thread->frame_buffer);
+
+  resized = thread->buffer_width != width || thread->buffer_height != height;
+
+  if (thread->use_depth_buffer || thread->use_stencil_buffer)
+    {
+      gboolean allocate = resized;
+
+      if (thread->depth_stencil_buffer == 0)
+        {
+          glGenRenderbuffers (1, &thread->depth_stencil_buffer);
+          allocate = TRUE;
+        }
+
+      if (allocate)
+        {
+          allocate_depth_stencil_buffer (thread->depth_stencil_buffer,
+                                         thread->use_stencil_buffer,
+                                         width, height);
+          thread->depth_stencil_has_stencil = thread->use_stencil_buffer;
+        }
+    }
+  else if (thread->depth_stencil_buffer != 0)
+    {
+      glDeleteRenderbuffers (1, &thread->depth_stencil_buffer);
+      thread->depth_stencil_buffer = 0;
+    }
+
+  thread->buffer_width = width;
+  thread->buffer_height = height;
+
+  gtk_gl_area_thread_attach_buffers (thread);
+
+  if (thread->use_depth_buffer)
+    glEnable (GL_DEPTH_TEST);
+  else
+    glDisable (GL_DEPTH_TEST);
+
+  status = glCheckFramebufferStatus (GL_FRAMEBUFFER);
+  if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+      g_warning ("fb setup not supported (%x)", status);
+      return NULL;
+    }
+
+  if (resized)
+    g_signal_emit (area, area_signals[RESIZE], 0, width, height, NULL);
+
+  g_signal_emit (area, area_signals[RENDER], 0, thread->context, &unused);
+
+  if (gdk_gl_context_has_feature (thread->context, GDK_GL_FEATURE_SYNC))
+    sync = glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+  /* The frame is used from another context */
+  glFlush ();
+
+  gdk_gl_texture_builder_set_sync (thread->texture->builder, sync);
+
+  thread->texture->thread = g_atomic_rc_box_acquire (thread);
+  frame = gdk_gl_texture_builder_build (thread->texture->builder,
+                                        gtk_gl_area_thread_release_texture,
+                                        thread->texture);
+  thread->texture->holder = frame;
+
+  return frame;
+}
+
+static gpointer
+gtk_gl_area_thread_run (gpointer data)
+{
+  GtkGLAreaThread *thread = data;
+  GList *l;
+
+  gdk_gl_context_make_current (thread->context);
+
+  g_mutex_lock (&thread->mutex);
+
+  while (TRUE)
+    {
+      GdkTexture *frame, *old_frame;
+      GtkGLArea *area;
+      gboolean frame_ready;
+      int width, height;
+
+      while (!thread->quit &&
+             (!thread->needs_render || thread->width == 0 || thread->height == 0))
+        g_cond_wait (&thread->cond, &thread->mutex);
+
+      if (thread->quit)
+        break;
+
+      /* The area stays alive until the thread is joined */
+      area = thread->area;
+      width = thread->width;
+      height = thread->height;
+      thread->needs_render = FALSE;
+
+      thread->use_depth_buffer = thread->has_depth_buffer;
+      thread->use_stencil_buffer = thread->has_stencil_buffer;
+
+      for (l = thread->textures; l; l = l->next)
+        {
+          Texture *texture = l->data;
+
+          if (texture->holder == NULL)
+            {
+              thread->textures = g_list_delete_link (thread->textures, l);
+              thread->texture = texture;
+              break;
+            }
+        }
+
+      g_mutex_unlock (&thread->mutex);
+
+      frame = gtk_gl_area_thread_render (thread, area, width, height);
+
+      g_mutex_lock (&thread->mutex);
+
+      if (thread->texture)
+        {
+          thread->textures = g_list_prepend (thread->textures, thread->texture);
+          thread->texture = NULL;
+        }
+
+      if (frame == NULL)
+        continue;
+
+      old_frame = thread->frame;
+      thread->frame = frame;
+      frame_ready = !thread->frame_ready_pending;
+      thread->frame_ready_pending = TRUE;
+
+      g_mutex_unlock (&thread->mutex);
+
+      /* This may release a texture, which takes the lock */
+      g_clear_object (&old_frame);
+
+      if (frame_ready)
+        g_main_context_invoke_full (NULL,
+                                    G_PRIORITY_DEFAULT,
+                                    gtk_gl_area_thread_frame_ready,
+                                    g_atomic_rc_box_acquire (thread),
+                                    (GDestroyNotify) g_atomic_rc_box_release);
+
+      g_mutex_lock (&thread->mutex);
+    }
+
+  /* Textures that are still in use are deleted on release */
+  l = thread->textures;
+  while (l)
+    {
+      Texture *texture = l->data;
+      GList *next = l->next;
+
+      if (texture->holder == NULL)
+        {
+          thread->textures = g_list_delete_link (thread->textures, l);
+          delete_one_texture (texture);
+        }
+
+      l = next;
+    }
+  thread->stopped = TRUE;
+
+  g_mutex_unlock (&thread->mutex);
+
+  if (thread->depth_stencil_buffer != 0)
+    glDeleteRenderbuffers (1, &thread->depth_stencil_buffer);
+  if (thread->frame_buffer != 0)
+    {
+      glBindFramebuffer (GL_FRAMEBUFFER, 0);
+      glDeleteFramebuffers (1, &thread->frame_buffer);
+    }
+
+  gdk_gl_context_clear_current ();
+
+  return NULL;
+}
+
+static GdkGLContext *
+gtk_gl_area_create_thread_context (GtkGLArea *area)
+{
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+  GtkWidget *widget = GTK_WIDGET (area);
+  GdkGLContext *context;
+  int major, minor;
+
+  context = gdk_surface_create_gl_context (gtk_native_get_surface (gtk_widget_get_native (widget)), NULL);
+  if (context == NULL)
+    return NULL;
+
+  /* Make sure the render thread gets the same kind of context
+   * as the one the area was realized with */
+  gdk_gl_context_set_allowed_apis (context, gdk_gl_context_get_api (priv->context));
+  gdk_gl_context_get_required_version (priv->context, &major, &minor);
+  gdk_gl_context_set_required_version (context, major, minor);
+
+  if (!gdk_gl_context_realize (context, NULL))
+    {
+      g_object_unref (context);
+      return NULL;
+    }
+
+  return context;
+}
+
+static void
+gtk_gl_area_start_thread (GtkGLArea *area)
+{
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+  GtkGLAreaThread *thread;
+  GdkGLContext *context;
+
+  context = gtk_gl_area_create_thread_context (area);
+  if (context == NULL)
+    {
+      GDK_DISPLAY_DEBUG (gtk_widget_get_display (GTK_WIDGET (area)), OPENGL,
+                         "Failed to create a context for the render thread, rendering on the main thread");
+      return;
+    }
+
+  /* Don't keep the new context current on the main thread */
+  if (gdk_gl_context_get_current () == context)
+    gdk_gl_context_clear_current ();
+
+  thread = g_atomic_rc_box_new0 (GtkGLAreaThread);
+  thread->area = area;
+  thread->context = context;
+  g_mutex_init (&thread->mutex);
+  g_cond_init (&thread->cond);
+
+  priv->thread = thread;
+  priv->needs_render = TRUE;
+
+  thread->thread = g_thread_new ("GtkGLArea render", gtk_gl_area_thread_run, thread);
+}
+
+static void
+gtk_gl_area_stop_thread (GtkGLArea *area)
+{
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+  GtkGLAreaThread *thread = priv->thread;
+  GdkTexture *frame;
+
+  if (thread == NULL)
+    return;
+
+  g_mutex_lock (&thread->mutex);
+  thread->quit = TRUE;
+  thread->area = NULL;
+  frame = g_steal_pointer (&thread->frame);
+  g_cond_signal (&thread->cond);
+  g_mutex_unlock (&thread->mutex);
+
+  g_thread_join (thread->thread);
+  priv->thread = NULL;
+
+  g_clear_object (&frame);
+
+  g_atomic_rc_box_release_full (thread, gtk_gl_area_thread_free);
+}
+
+static void
+gtk_gl_area_thread_snapshot (GtkGLArea   *area,
+                             GtkSnapshot *snapshot,
+                             int          width,
+                             int          height)
+{
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+  GtkGLAreaThread *thread = priv->thread;
+  GtkWidget *widget = GTK_WIDGET (area);
+  GdkTexture *frame;
+
+  g_mutex_lock (&thread->mutex);
+
+  if (thread->width != width || thread->height != height)
+    {
+      thread->width = width;
+      thread->height = height;
+      priv->needs_render = TRUE;
+    }
+
+  thread->has_depth_buffer = priv->has_depth_buffer;
+  thread->has_stencil_buffer = priv->has_stencil_buffer;
+
+  if (priv->needs_render)
+    {
+      thread->needs_render = TRUE;
+      priv->needs_render = FALSE;
+      g_cond_signal (&thread->cond);
+    }
+
+  frame = thread->frame ? g_object_ref (thread->frame) : NULL;
+
+  g_mutex_unlock (&thread->mutex);
+
+  if (frame == NULL)
+    return;
+
+  /* See gtk_gl_area_snapshot() */
+  gtk_snapshot_save (snapshot);
+  gtk_snapshot_translate (snapshot, &GRAPHENE_POINT_INIT (0, gtk_widget_get_height (widget)));
+  gtk_snapshot_scale (snapshot, 1, -1);
+  gtk_snapshot_append_texture (snapshot,
+                               frame,
+                               &GRAPHENE_RECT_INIT (0, 0,
+                                                    gtk_widget_get_width (widget),
+                                                    gtk_widget_get_height (widget)));
+  gtk_snapshot_restore (snapshot);
+
+  g_object_unref (frame);
+}
+
+/* }}} */
+
 static void
 gtk_gl_area_snapshot (GtkWidget   *widget,
                       GtkSnapshot *snapshot)
@@ -744,6 +1269,12 @@ gtk_gl_area_snapshot (GtkWidget   *widget,
   if (priv->context == NULL)
     return;
 
+  if (priv->thread)
+    {
+      gtk_gl_area_thread_snapshot (area, snapshot, w, h);
+      return;
+    }
+
   gtk_gl_area_make_current (area);
 
   gtk_gl_area_attach_buffers (area);
@@ -943,6 +1474,23 @@ gtk_gl_area_class_init (GtkGLAreaClass *klass)
                         G_PARAM_STATIC_STRINGS |
                         G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkGLArea:threaded: (attributes org.gtk.Property.get=gtk_gl_area_get_threaded org.gtk.Property.set=gtk_gl_area_set_threaded)
+   *
+   * If set to %TRUE the [signal@Gtk.GLArea::render] signal is emitted
+   * on a separate thread.
+   *
+   * See [method@Gtk.GLArea.set_threaded] for details.
+   *
+   * Since: 4.16
+   */
+  obj_props[PROP_THREADED] =
+    g_param_spec_boolean ("threaded", NULL, NULL,
+                          FALSE,
+                          GTK_PARAM_READWRITE |
+                          G_PARAM_STATIC_STRINGS |
+                          G_PARAM_EXPLICIT_NOTIFY);
+
   gobject_class->set_property = gtk_gl_area_set_property;
   gobject_class->get_property = gtk_gl_area_get_property;
   gobject_class->notify = gtk_gl_area_notify;
@@ -959,6 +1507,10 @@ gtk_gl_area_class_init (GtkGLAreaClass *klass)
    * The @context is bound to the @area prior to emitting this function,
    * and the buffers are painted to the window once the emission terminates.
    *
+   * If the area is [property@Gtk.GLArea:threaded], this signal is
+   * emitted on the render thread, and @context is the context of
+   * that thread.
+   *
    * Returns: %TRUE to stop other handlers from being invoked for the event.
    *   %FALSE to propagate the event further.
    */
@@ -1471,6 +2023,74 @@ gtk_gl_area_set_auto_render (GtkGLArea *area,
     }
 }
 
+/**
+ * gtk_gl_area_get_threaded: (attributes org.gtk.Method.get_property=threaded)
+ * @area: a `GtkGLArea`
+ *
+ * Returns whether the area renders on a separate thread.
+ *
+ * Returns: %TRUE if the @area is threaded
+ *
+ * Since: 4.16
+ */
+gboolean
+gtk_gl_area_get_threaded (GtkGLArea *area)
+{
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+
+  g_return_val_if_fail (GTK_IS_GL_AREA (area), FALSE);
+
+  return priv->threaded;
+}
+
+/**
+ * gtk_gl_area_set_threaded: (attributes org.gtk.Method.set_property=threaded)
+ * @area: a `GtkGLArea`
+ * @threaded: whether to render on a separate thread
+ *
+ * Sets whether the `GtkGLArea` renders on a separate thread.
+ *
+ * In threaded mode, the [signal@Gtk.GLArea::resize] and
+ * [signal@Gtk.GLArea::render] signals are emitted on a render thread
+ * with its own `GdkGLContext`, which shares its resources with the
+ * context of the area. The area draws the last frame that the thread
+ * completed, so slow rendering does not block the main thread.
+ *
+ * Handlers of these signals must not call GTK functions other than
+ * [method@Gtk.GLArea.make_current] and [method@Gtk.GLArea.attach_buffers],
+ * and must use the context that is passed to the render signal.
+ *
+ * The render thread renders a new frame when the area changes its
+ * size and after [method@Gtk.GLArea.queue_render] has been called.
+ * Drawing the area does not cause a new frame to be rendered, so
+ * [property@Gtk.GLArea:auto-render] has no effect in threaded mode.
+ *
+ * If no context can be created for the render thread, the area
+ * renders on the main thread.
+ *
+ * Changing this property only takes effect the next time the area
+ * is realized.
+ *
+ * Since: 4.16
+ */
+void
+gtk_gl_area_set_threaded (GtkGLArea *area,
+                          gboolean   threaded)
+{
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+
+  g_return_if_fail (GTK_IS_GL_AREA (area));
+
+  threaded = !!threaded;
+
+  if (priv->threaded != threaded)
+    {
+      priv->threaded = threaded;
+
+      g_object_notify_by_pspec (G_OBJECT (area), obj_props[PROP_THREADED]);
+    }
+}
+
 /**
  * gtk_gl_area_get_context:
  * @area: a `GtkGLArea`
@@ -1508,6 +2128,8 @@ gtk_gl_area_make_current (GtkGLArea *area)
   g_return_if_fail (GTK_IS_GL_AREA (area));
   g_return_if_fail (gtk_widget_get_realized (GTK_WIDGET (area)));
 
-  if (priv->context != NULL)
+  if (gtk_gl_area_is_render_thread (area))
+    gdk_gl_context_make_current (priv->thread->context);
+  else if (priv->context != NULL)
     gdk_gl_context_make_current (priv->context);
 }
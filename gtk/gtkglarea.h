@@ -114,6 +114,11 @@ void            gtk_gl_area_set_auto_render             (GtkGLArea    *area,
                                                          gboolean      auto_render);
 GDK_AVAILABLE_IN_ALL
 void           gtk_gl_area_queue_render                 (GtkGLArea    *area);
+GDK_AVAILABLE_IN_4_16
+gboolean        gtk_gl_area_get_threaded                (GtkGLArea    *area);
+GDK_AVAILABLE_IN_4_16
+void            gtk_gl_area_set_threaded                (GtkGLArea    *area,
+                                                         gboolean      threaded);
 
 
 GDK_AVAILABLE_IN_ALL
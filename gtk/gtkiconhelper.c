@@ -80,11 +80,28 @@ get_icon_lookup_flags (GtkIconHelper *self,
   return flags;
 }
 
+static double
+gtk_icon_helper_get_fractional_scale (GtkIconHelper *self)
+{
+  GtkNative *native;
+  GdkSurface *surface;
+
+  native = gtk_widget_get_native (self->owner);
+  if (native == NULL)
+    return gtk_widget_get_scale_factor (self->owner);
+
+  surface = gtk_native_get_surface (native);
+  if (surface == NULL)
+    return gtk_widget_get_scale_factor (self->owner);
+
+  return gdk_surface_get_scale (surface);
+}
+
 static GdkPaintable *
 ensure_paintable_for_gicon (GtkIconHelper    *self,
                             GtkCssStyle      *style,
-                            GtkTextDirection  dir,
                             int               scale,
+                            GtkTextDirection  dir,
                             gboolean          preload,
                             GIcon            *gicon,
                             gboolean         *symbolic)
@@ -93,6 +110,7 @@ ensure_paintable_for_gicon (GtkIconHelper    *self,
   int width, height;
   GtkIconPaintable *icon;
   GtkIconLookupFlags flags;
+  double fractional_scale;
 
   icon_theme = gtk_icon_theme_get_for_display (gtk_widget_get_display (self->owner));
   flags = get_icon_lookup_flags (self, style);
@@ -101,11 +119,35 @@ ensure_paintable_for_gicon (GtkIconHelper    *self,
 
   width = height = gtk_icon_helper_get_size (self);
 
+  /* At fractional scales, the integer scale makes us rasterize svgs
+   * bigger than they are shown. Look them up at their pixel size
+   * instead, but keep using the integer scale for bitmaps, which
+   * look better downscaled than upscaled.
+   */
+  fractional_scale = gtk_icon_helper_get_fractional_scale (self);
+  if (fractional_scale != ceil (fractional_scale))
+    {
+      icon = gtk_icon_theme_lookup_by_gicon (icon_theme,
+                                             gicon,
+                                             ceil (MIN (width, height) * fractional_scale),
+                                             1,
+                                             dir,
+                                             flags);
+      if (gtk_icon_paintable_is_scalable (icon))
+        {
+          *symbolic = gtk_icon_paintable_is_symbolic (icon);
+          return GDK_PAINTABLE (icon);
+        }
+
+      g_object_unref (icon);
+    }
+
   icon = gtk_icon_theme_lookup_by_gicon (icon_theme,
                                          gicon,
                                          MIN (width, height),
+                                         scale,
                                          dir,
-                                         scale, flags);
+                                         flags);
 
   *symbolic = gtk_icon_paintable_is_symbolic (icon);
   return GDK_PAINTABLE (icon);
@@ -0,0 +1,200 @@
+/*
+ * Copyright © 2024 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkiconrastercacheprivate.h"
+
+#include "gtkdebug.h"
+#include "gdk/gdkmemoryformatprivate.h"
+
+#include <glib/gstdio.h>
+#include <string.h>
+
+/* Rendering SVG icons is expensive, and the same icons get rendered at
+ * the same sizes every time an application starts. So the rendered
+ * pixels are kept in files in the user cache directory, one file per
+ * icon, size, scale and symbolic flag.
+ *
+ * The file name is a checksum of all of these, plus the mtime and size
+ * of the icon file. So when an icon file changes, its old entries are
+ * simply not found anymore.
+ *
+ * The files contain a header followed by the pixels in the texture's
+ * memory format. They are mmapped and handed to a GdkMemoryTexture
+ * without copying.
+ */
+
+#define RASTER_CACHE_MAGIC "GTKICON1"
+
+typedef struct
+{
+  char magic[8];
+  guint32 width;
+  guint32 height;
+  guint32 format;
+  guint32 stride;
+  guint64 reserved;
+} RasterCacheHeader;
+
+G_STATIC_ASSERT (sizeof (RasterCacheHeader) == 32);
+
+static const char *
+get_cache_dir (void)
+{
+  static gsize initialized = 0;
+  static char *cache_dir = NULL;
+
+  if (g_once_init_enter (&initialized))
+    {
+      cache_dir = g_build_filename (g_get_user_cache_dir (), "gtk-4.0", "icons", NULL);
+      g_once_init_leave (&initialized, 1);
+    }
+
+  return cache_dir;
+}
+
+static char *
+get_cache_filename (const char *filename,
+                    int         size,
+                    int         scale,
+                    gboolean    symbolic)
+{
+  GStatBuf stat_buf;
+  char *key, *checksum, *result;
+
+  if (g_stat (filename, &stat_buf) != 0)
+    return NULL;
+
+  key = g_strdup_printf ("%s\n%" G_GINT64_FORMAT "\n%" G_GINT64_FORMAT "\n%d\n%d\n%d\n%d",
+                         filename,
+                         (gint64) stat_buf.st_mtime,
+                         (gint64) stat_buf.st_size,
+                         size, scale, symbolic,
+                         G_BYTE_ORDER);
+  checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, key, -1);
+  result = g_build_filename (get_cache_dir (), checksum, NULL);
+
+  g_free (checksum);
+  g_free (key);
+
+  return result;
+}
+
+GdkTexture *
+gtk_icon_raster_cache_lookup (const char *filename,
+                              int         size,
+                              int         scale,
+                              gboolean    symbolic)
+{
+  RasterCacheHeader header;
+  GdkTexture *texture;
+  GMappedFile *mapped;
+  GBytes *bytes, *pixels;
+  char *cache_filename;
+  gsize length;
+
+  cache_filename = get_cache_filename (filename, size, scale, symbolic);
+  if (cache_filename == NULL)
+    return NULL;
+
+  mapped = g_mapped_file_new (cache_filename, FALSE, NULL);
+  g_free (cache_filename);
+  if (mapped == NULL)
+    return NULL;
+
+  bytes = g_mapped_file_get_bytes (mapped);
+  g_mapped_file_unref (mapped);
+
+  length = g_bytes_get_size (bytes);
+  if (length < sizeof (RasterCacheHeader))
+    goto invalid;
+
+  memcpy (&header, g_bytes_get_data (bytes, NULL), sizeof (RasterCacheHeader));
+  if (memcmp (header.magic, RASTER_CACHE_MAGIC, sizeof (header.magic)) != 0 ||
+      header.width == 0 || header.height == 0 ||
+      header.format >= GDK_MEMORY_N_FORMATS ||
+      header.stride < header.width * gdk_memory_format_bytes_per_pixel (header.format) ||
+      (length - sizeof (RasterCacheHeader)) / header.stride < header.height)
+    goto invalid;
+
+  pixels = g_bytes_new_from_bytes (bytes,
+                                   sizeof (RasterCacheHeader),
+                                   (gsize) header.stride * header.height);
+  texture = gdk_memory_texture_new (header.width, header.height,
+                                    header.format,
+                                    pixels,
+                                    header.stride);
+  g_bytes_unref (pixels);
+  g_bytes_unref (bytes);
+
+  return texture;
+
+invalid:
+  g_bytes_unref (bytes);
+  return NULL;
+}
+
+void
+gtk_icon_raster_cache_store (const char *filename,
+                             int         size,
+                             int         scale,
+                             gboolean    symbolic,
+                             GdkTexture *texture)
+{
+  RasterCacheHeader header = { RASTER_CACHE_MAGIC, };
+  GdkTextureDownloader *downloader;
+  GBytes *pixels;
+  GString *contents;
+  char *cache_filename;
+  gsize stride;
+  GError *error = NULL;
+
+  cache_filename = get_cache_filename (filename, size, scale, symbolic);
+  if (cache_filename == NULL)
+    return;
+
+  if (g_mkdir_with_parents (get_cache_dir (), 0700) != 0)
+    {
+      g_free (cache_filename);
+      return;
+    }
+
+  downloader = gdk_texture_downloader_new (texture);
+  gdk_texture_downloader_set_format (downloader, gdk_texture_get_format (texture));
+  pixels = gdk_texture_downloader_download_bytes (downloader, &stride);
+  gdk_texture_downloader_free (downloader);
+
+  header.width = gdk_texture_get_width (texture);
+  header.height = gdk_texture_get_height (texture);
+  header.format = gdk_texture_get_format (texture);
+  header.stride = stride;
+
+  contents = g_string_sized_new (sizeof (RasterCacheHeader) + g_bytes_get_size (pixels));
+  g_string_append_len (contents, (const char *) &header, sizeof (RasterCacheHeader));
+  g_string_append_len (contents, g_bytes_get_data (pixels, NULL), g_bytes_get_size (pixels));
+
+  if (!g_file_set_contents (cache_filename, contents->str, contents->len, &error))
+    {
+      GTK_DEBUG (ICONTHEME, "Failed to write icon cache %s: %s", cache_filename, error->message);
+      g_error_free (error);
+    }
+
+  g_string_free (contents, TRUE);
+  g_bytes_unref (pixels);
+  g_free (cache_filename);
+}
@@ -44,6 +44,7 @@
 #include "gtkcsscolorvalueprivate.h"
 #include "gtkdebug.h"
 #include "gtkiconcacheprivate.h"
+#include "gtkiconrastercacheprivate.h"
 #include "gtkmain.h"
 #include "gtkprivate.h"
 #include "gtksettingsprivate.h"
@@ -53,6 +54,7 @@
 #include "gtkwidgetprivate.h"
 #include "gdktextureutilsprivate.h"
 #include "gdk/gdktextureprivate.h"
+#include "gdk/gdkdecodeschedulerprivate.h"
 #include "gdk/gdkprofilerprivate.h"
 
 #define GDK_ARRAY_ELEMENT_TYPE char *
@@ -434,6 +436,10 @@ typedef struct
 
   GArray *dir_sizes;     /* IconThemeDirSize */
   GArray *dirs;          /* IconThemeDir */
+
+  /* For every icon, the dir sizes that contain it, see theme_build_index() */
+  GHashTable *icon_index; /* name (interned) -> offset in index_entries */
+  GArray *index_entries;  /* guint32 */
 } IconTheme;
 
 typedef struct
@@ -489,6 +495,7 @@ static GtkIconPaintable *theme_lookup_icon                (IconTheme        *the
                                                            int               size,
                                                            int               scale,
                                                            gboolean          allow_svg);
+static void              theme_build_index                (IconTheme        *theme);
 static void              theme_subdir_load                (GtkIconTheme     *self,
                                                            IconTheme        *theme,
                                                            GKeyFile         *theme_file,
@@ -1395,6 +1402,21 @@ gtk_icon_theme_get_serial (GtkIconTheme *self)
   return self->serial;
 }
 
+/*<private>
+ * gtk_icon_paintable_is_scalable:
+ * @self: a `GtkIconPaintable`
+ *
+ * Returns whether the icon is rasterized from a vector image,
+ * so that it looks good at any size it is loaded at.
+ *
+ * Returns: %TRUE if the icon is an SVG
+ */
+gboolean
+gtk_icon_paintable_is_scalable (GtkIconPaintable *self)
+{
+  return self->is_svg;
+}
+
 static void
 gtk_icon_theme_dispose (GObject *object)
 {
@@ -1952,6 +1974,7 @@ load_themes (GtkIconTheme *self)
   char *dir;
   const char *file;
   GStatBuf stat_buf;
+  GList *l;
   int j;
 
   gtk_string_set_init (&self->icons);
@@ -1962,6 +1985,9 @@ load_themes (GtkIconTheme *self)
   insert_theme (self, FALLBACK_ICON_THEME);
   self->themes = g_list_reverse (self->themes);
 
+  for (l = self->themes; l; l = l->next)
+    theme_build_index (l->data);
+
   self->unthemed_icons = g_hash_table_new_full (g_str_hash, g_str_equal,
                                                 g_free, (GDestroyNotify)free_unthemed_icon);
 
@@ -2516,7 +2542,9 @@ gtk_icon_theme_lookup_icon (GtkIconTheme       *self,
           if (!has_texture)
             {
               GTask *task = g_task_new (icon, NULL, NULL, NULL);
-              g_task_run_in_thread (task, load_icon_thread);
+              /* Preloads are speculative, let explicit loads go first */
+              g_task_set_priority (task, G_PRIORITY_LOW);
+              gdk_decode_scheduler_run (task, load_icon_thread);
               g_object_unref (task);
             }
         }
@@ -2845,9 +2873,71 @@ theme_destroy (IconTheme *theme)
     theme_dir_destroy (&g_array_index (theme->dirs, IconThemeDir, i));
   g_array_free (theme->dirs, TRUE);
 
+  g_clear_pointer (&theme->icon_index, g_hash_table_destroy);
+  g_clear_pointer (&theme->index_entries, g_array_unref);
+
   g_free (theme);
 }
 
+/* Builds an index of the dir sizes that contain each icon, so that
+ * lookups only look at the sizes an icon is actually available in,
+ * instead of probing the hash table of every dir size in the theme.
+ *
+ * For every icon, index_entries contains the number of dir sizes,
+ * followed by pairs of dir size index and file index, in the order of
+ * the dir sizes.
+ */
+static void
+theme_build_index (IconTheme *theme)
+{
+  GHashTableIter iter;
+  gpointer key, value;
+  guint i, n_entries;
+
+  theme->icon_index = g_hash_table_new (g_direct_hash, g_direct_equal);
+  theme->index_entries = g_array_new (FALSE, TRUE, sizeof (guint32));
+
+  /* Count the dir sizes of every icon */
+  for (i = 0; i < theme->dir_sizes->len; i++)
+    {
+      IconThemeDirSize *dir_size = &g_array_index (theme->dir_sizes, IconThemeDirSize, i);
+
+      g_hash_table_iter_init (&iter, dir_size->icon_hash);
+      while (g_hash_table_iter_next (&iter, &key, NULL))
+        {
+          guint count = GPOINTER_TO_UINT (g_hash_table_lookup (theme->icon_index, key));
+          g_hash_table_insert (theme->icon_index, key, GUINT_TO_POINTER (count + 1));
+        }
+    }
+
+  /* Turn the counts into offsets */
+  n_entries = 0;
+  g_hash_table_iter_init (&iter, theme->icon_index);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      g_hash_table_iter_replace (&iter, GUINT_TO_POINTER (n_entries));
+      n_entries += 1 + 2 * GPOINTER_TO_UINT (value);
+    }
+
+  /* Fill in the dir sizes, the count is rebuilt as we go */
+  g_array_set_size (theme->index_entries, n_entries);
+  for (i = 0; i < theme->dir_sizes->len; i++)
+    {
+      IconThemeDirSize *dir_size = &g_array_index (theme->dir_sizes, IconThemeDirSize, i);
+
+      g_hash_table_iter_init (&iter, dir_size->icon_hash);
+      while (g_hash_table_iter_next (&iter, &key, &value))
+        {
+          guint offset = GPOINTER_TO_UINT (g_hash_table_lookup (theme->icon_index, key));
+          guint32 *entry = &g_array_index (theme->index_entries, guint32, offset);
+
+          entry[1 + 2 * entry[0]] = i;
+          entry[2 + 2 * entry[0]] = GPOINTER_TO_INT (value);
+          entry[0]++;
+        }
+    }
+}
+
 static void
 theme_dir_size_destroy (IconThemeDirSize *dir)
 {
@@ -3041,25 +3131,27 @@ theme_lookup_icon (IconTheme   *theme,
   IconThemeFile *min_file;
   int min_difference;
   IconCacheFlag min_suffix = ICON_CACHE_FLAG_PNG_SUFFIX;
+  gpointer offset;
+  const guint32 *entry;
   int i;
 
   min_difference = G_MAXINT;
   min_dir_size = NULL;
   min_file = NULL;
 
-  for (i = 0; i < theme->dir_sizes->len; i++)
+  if (!g_hash_table_lookup_extended (theme->icon_index, icon_name, NULL, &offset))
+    return NULL;
+
+  entry = &g_array_index (theme->index_entries, guint32, GPOINTER_TO_UINT (offset));
+
+  for (i = 0; i < entry[0]; i++)
     {
-      IconThemeDirSize *dir_size = &g_array_index (theme->dir_sizes, IconThemeDirSize, i);
+      IconThemeDirSize *dir_size = &g_array_index (theme->dir_sizes, IconThemeDirSize, entry[1 + 2 * i]);
       IconThemeFile *file;
       guint best_suffix;
       int difference;
-      gpointer file_index;
-
-      if (!g_hash_table_lookup_extended (dir_size->icon_hash, icon_name, NULL, &file_index))
-        continue;
-
-      file = &g_array_index (dir_size->icon_files, IconThemeFile, GPOINTER_TO_INT(file_index));
 
+      file = &g_array_index (dir_size->icon_files, IconThemeFile, entry[2 + 2 * i]);
 
       if (allow_svg)
         best_suffix = file->best_suffix;
@@ -3756,26 +3848,42 @@ icon_ensure_texture__locked (GtkIconPaintable *icon,
     {
       if (icon->is_svg)
         {
-          if (gtk_icon_paintable_is_symbolic (icon))
-            icon->texture = gdk_texture_new_from_path_symbolic (icon->filename,
-                                                                pixel_size, pixel_size,
-                                                                icon->desired_scale,
-                                                                &load_error);
-          else
-            {
-              GFile *file = g_file_new_for_path (icon->filename);
-              GInputStream *stream = G_INPUT_STREAM (g_file_read (file, NULL, &load_error));
+          gboolean symbolic = gtk_icon_paintable_is_symbolic (icon);
 
-              if (stream)
+          icon->texture = gtk_icon_raster_cache_lookup (icon->filename,
+                                                        pixel_size,
+                                                        icon->desired_scale,
+                                                        symbolic);
+          if (icon->texture == NULL)
+            {
+              if (symbolic)
+                icon->texture = gdk_texture_new_from_path_symbolic (icon->filename,
+                                                                    pixel_size, pixel_size,
+                                                                    icon->desired_scale,
+                                                                    &load_error);
+              else
                 {
-                  icon->texture = gdk_texture_new_from_stream_at_scale (stream,
-                                                                        pixel_size, pixel_size,
-                                                                        TRUE, NULL,
-                                                                        &load_error);
-                  g_object_unref (stream);
+                  GFile *file = g_file_new_for_path (icon->filename);
+                  GInputStream *stream = G_INPUT_STREAM (g_file_read (file, NULL, &load_error));
+
+                  if (stream)
+                    {
+                      icon->texture = gdk_texture_new_from_stream_at_scale (stream,
+                                                                            pixel_size, pixel_size,
+                                                                            TRUE, NULL,
+                                                                            &load_error);
+                      g_object_unref (stream);
+                    }
+
+                  g_object_unref (file);
                 }
 
-              g_object_unref (file);
+              if (icon->texture)
+                gtk_icon_raster_cache_store (icon->filename,
+                                             pixel_size,
+                                             icon->desired_scale,
+                                             symbolic,
+                                             icon->texture);
             }
         }
       else
@@ -3896,23 +4004,12 @@ gtk_icon_paintable_snapshot_symbolic (GtkSymbolicPaintable *paintable,
   int texture_width, texture_height;
   double render_width;
   double render_height;
+  graphene_rect_t bounds;
   gboolean symbolic;
 
   texture = gtk_icon_paintable_ensure_texture (icon);
   symbolic = gtk_icon_paintable_is_symbolic (icon);
 
-  if (symbolic)
-    {
-      graphene_matrix_t matrix;
-      graphene_vec4_t offset;
-
-      init_color_matrix (&matrix, &offset,
-                         &colors[0], &colors[3],
-                         &colors[2], &colors[1]);
-
-      gtk_snapshot_push_color_matrix (snapshot, &matrix, &offset);
-    }
-
   texture_width = gdk_texture_get_width (texture);
   texture_height = gdk_texture_get_height (texture);
 
@@ -3928,14 +4025,37 @@ gtk_icon_paintable_snapshot_symbolic (GtkSymbolicPaintable *paintable,
       render_height = height;
     }
 
-  gtk_snapshot_append_texture (snapshot, texture,
-                               &GRAPHENE_RECT_INIT ((width - render_width) / 2,
-                                                    (height - render_height) / 2,
-                                                    render_width,
-                                                    render_height));
+  bounds = GRAPHENE_RECT_INIT ((width - render_width) / 2,
+                               (height - render_height) / 2,
+                               render_width,
+                               render_height);
+
+  if (!symbolic)
+    {
+      gtk_snapshot_append_texture (snapshot, texture, &bounds);
+    }
+  else if (gdk_texture_get_format (texture) == GDK_MEMORY_A8)
+    {
+      /* Only uses the foreground color, see gdktextureutils.c */
+      gtk_snapshot_push_mask (snapshot, GSK_MASK_MODE_ALPHA);
+      gtk_snapshot_append_texture (snapshot, texture, &bounds);
+      gtk_snapshot_pop (snapshot);
+      gtk_snapshot_append_color (snapshot, &colors[0], &bounds);
+      gtk_snapshot_pop (snapshot);
+    }
+  else
+    {
+      graphene_matrix_t matrix;
+      graphene_vec4_t offset;
+
+      init_color_matrix (&matrix, &offset,
+                         &colors[0], &colors[3],
+                         &colors[2], &colors[1]);
 
-  if (symbolic)
-    gtk_snapshot_pop (snapshot);
+      gtk_snapshot_push_color_matrix (snapshot, &matrix, &offset);
+      gtk_snapshot_append_texture (snapshot, texture, &bounds);
+      gtk_snapshot_pop (snapshot);
+    }
 }
 
 static GdkPaintableFlags
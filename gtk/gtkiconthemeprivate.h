@@ -31,3 +31,5 @@ void gtk_icon_theme_lookup_symbolic_colors   (GtkCssStyle      *style,
 
 int gtk_icon_theme_get_serial (GtkIconTheme *self);
 
+gboolean gtk_icon_paintable_is_scalable (GtkIconPaintable *self);
+
@@ -3,6 +3,10 @@
 #include <glib.h>
 #include <string.h>
 
+/* Strings that don't fit inline are kept in a refcounted GRcBox, so
+ * that identical large texts can be shared with istring_set_shared()
+ * instead of being copied.
+ */
 typedef struct
 {
   guint n_bytes;
@@ -34,7 +38,7 @@ istring_clear (IString *str)
   if (istring_is_inline (str))
     str->u.buf[0] = 0;
   else
-    g_clear_pointer (&str->u.str, g_free);
+    g_clear_pointer (&str->u.str, g_rc_box_release);
 
   str->n_bytes = 0;
   str->n_chars = 0;
@@ -53,13 +57,35 @@ istring_set (IString    *str,
     }
   else
     {
-      str->u.str = g_strndup (text, n_bytes);
+      str->u.str = g_rc_box_alloc (n_bytes + 1);
+      memcpy (str->u.str, text, n_bytes);
+      str->u.str[n_bytes] = 0;
     }
 
   str->n_bytes = n_bytes;
   str->n_chars = n_chars;
 }
 
+static inline void
+istring_set_shared (IString *str,
+                    IString *other)
+{
+  if (istring_is_inline (other))
+    memcpy (str->u.buf, other->u.buf, other->n_bytes + 1);
+  else
+    str->u.str = g_rc_box_acquire (other->u.str);
+
+  str->n_bytes = other->n_bytes;
+  str->n_chars = other->n_chars;
+}
+
+/* Heap memory held by @str, 0 if it is inline */
+static inline gsize
+istring_heap_size (const IString *str)
+{
+  return istring_is_inline (str) ? 0 : str->n_bytes + 1;
+}
+
 static inline gboolean
 istring_empty (IString *str)
 {
@@ -117,7 +143,7 @@ static inline void
 istring_prepend (IString *str,
                  IString *other)
 {
-  if G_LIKELY (str->n_bytes + other->n_bytes < sizeof str->u.buf - 1)
+  if G_LIKELY (str->n_bytes + other->n_bytes <= sizeof str->u.buf - 1)
     {
       memmove (str->u.buf + other->n_bytes, str->u.buf, str->n_bytes);
       memcpy (str->u.buf, other->u.buf, other->n_bytes);
@@ -128,15 +154,22 @@ istring_prepend (IString *str,
   else
     {
       char *old = NULL;
+      char *buf;
 
       if (!istring_is_inline (str))
         old = str->u.str;
 
-      str->u.str = g_strconcat (istring_str (other), istring_str (str), NULL);
+      buf = g_rc_box_alloc (str->n_bytes + other->n_bytes + 1);
+      memcpy (buf, istring_str (other), other->n_bytes);
+      memcpy (buf + other->n_bytes, istring_str (str), str->n_bytes);
+      buf[str->n_bytes + other->n_bytes] = 0;
+
+      str->u.str = buf;
       str->n_bytes += other->n_bytes;
       str->n_chars += other->n_chars;
 
-      g_free (old);
+      if (old != NULL)
+        g_rc_box_release (old);
     }
 }
 
@@ -148,17 +181,24 @@ istring_append (IString *str,
   guint n_bytes = other->n_bytes;
   guint n_chars = other->n_chars;
 
-  if G_LIKELY (istring_is_inline (str))
+  if G_LIKELY (istring_is_inline (str) &&
+               str->n_bytes + n_bytes <= (sizeof str->u.buf - 1))
     {
-      if G_LIKELY (str->n_bytes + n_bytes <= (sizeof str->u.buf - 1))
-        memcpy (str->u.buf + str->n_bytes, text, n_bytes);
-      else
-        str->u.str = g_strconcat (str->u.buf, text, NULL);
+      memcpy (str->u.buf + str->n_bytes, text, n_bytes);
     }
   else
     {
-      str->u.str = g_realloc (str->u.str, str->n_bytes + n_bytes + 1);
-      memcpy (str->u.str + str->n_bytes, text, n_bytes);
+      char *buf;
+
+      /* The heap string may be shared, so never modify it in place */
+      buf = g_rc_box_alloc (str->n_bytes + n_bytes + 1);
+      memcpy (buf, istring_str (str), str->n_bytes);
+      memcpy (buf + str->n_bytes, text, n_bytes);
+
+      if (!istring_is_inline (str))
+        g_rc_box_release (str->u.str);
+
+      str->u.str = buf;
     }
 
   str->n_bytes += n_bytes;
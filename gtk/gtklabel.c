@@ -47,6 +47,7 @@
 #include "gtkrenderbackgroundprivate.h"
 #include "gtkrenderborderprivate.h"
 #include "gtkrenderlayoutprivate.h"
+#include "gtksettingsprivate.h"
 #include "gtkshortcut.h"
 #include "gtkshortcutcontroller.h"
 #include "gtkshortcuttrigger.h"
@@ -1099,6 +1100,166 @@ get_default_widths (GtkLabel    *self,
     }
 }
 
+/* Sizes of non-wrapping labels only depend on what gets shaped, so they
+ * are shared between all labels showing the same text in the same font.
+ * Lists often contain thousands of identical labels, and this saves
+ * shaping each of them just to measure it.
+ */
+#define STATIC_SIZE_CACHE_MAX_ENTRIES 1024
+#define STATIC_SIZE_CACHE_MAX_TEXT    256
+
+typedef struct
+{
+  char *text;
+  PangoFontDescription *font_desc;
+  PangoFontMap *font_map;
+  guint font_map_serial;
+  cairo_font_options_t *font_options;
+  double resolution;
+  PangoLanguage *language;
+  PangoDirection base_dir;
+  int width;
+  int lines;
+  guint ellipsize : 3;
+  guint single_line_mode : 1;
+  guint round_glyph_positions : 1;
+
+  /* The cached sizes, in pango units */
+  int natural_width;
+  int minimum_width;
+  int height;
+  int baseline;
+} StaticSize;
+
+static GHashTable *static_size_cache;
+
+static guint
+static_size_hash (gconstpointer data)
+{
+  const StaticSize *size = data;
+
+  return g_str_hash (size->text) ^
+         pango_font_description_hash (size->font_desc) ^
+         (guint) size->width ^
+         (guint) size->ellipsize << 24;
+}
+
+static gboolean
+static_size_equal (gconstpointer a,
+                   gconstpointer b)
+{
+  const StaticSize *size_a = a;
+  const StaticSize *size_b = b;
+
+  return size_a->width == size_b->width &&
+         size_a->lines == size_b->lines &&
+         size_a->ellipsize == size_b->ellipsize &&
+         size_a->single_line_mode == size_b->single_line_mode &&
+         size_a->round_glyph_positions == size_b->round_glyph_positions &&
+         size_a->base_dir == size_b->base_dir &&
+         size_a->language == size_b->language &&
+         size_a->resolution == size_b->resolution &&
+         size_a->font_map == size_b->font_map &&
+         size_a->font_map_serial == size_b->font_map_serial &&
+         strcmp (size_a->text, size_b->text) == 0 &&
+         pango_font_description_equal (size_a->font_desc, size_b->font_desc) &&
+         (size_a->font_options == size_b->font_options ||
+          (size_a->font_options != NULL && size_b->font_options != NULL &&
+           cairo_font_options_equal (size_a->font_options, size_b->font_options)));
+}
+
+static void
+static_size_free (gpointer data)
+{
+  StaticSize *size = data;
+
+  g_free (size->text);
+  pango_font_description_free (size->font_desc);
+  g_object_unref (size->font_map);
+  g_clear_pointer (&size->font_options, cairo_font_options_destroy);
+  g_free (size);
+}
+
+/* Fills in the key part of @size, borrowing from the label's layout.
+ * Returns FALSE if the label's size can't be shared.
+ */
+static gboolean
+static_size_init_key (GtkLabel   *self,
+                      int         width,
+                      StaticSize *size)
+{
+  PangoContext *context;
+
+  if (self->tabs != NULL ||
+      strlen (self->text) > STATIC_SIZE_CACHE_MAX_TEXT ||
+      pango_layout_get_attributes (self->layout) != NULL)
+    return FALSE;
+
+  context = pango_layout_get_context (self->layout);
+
+  size->text = self->text;
+  size->font_desc = (PangoFontDescription *) pango_context_get_font_description (context);
+  size->font_map = pango_context_get_font_map (context);
+  size->font_map_serial = pango_font_map_get_serial (size->font_map);
+  size->font_options = (cairo_font_options_t *) pango_cairo_context_get_font_options (context);
+  size->resolution = pango_cairo_context_get_resolution (context);
+  size->language = pango_context_get_language (context);
+  size->base_dir = pango_context_get_base_dir (context);
+  size->width = width;
+  size->lines = self->single_line_mode ? 0 : self->lines;
+  size->ellipsize = self->ellipsize;
+  size->single_line_mode = self->single_line_mode;
+  size->round_glyph_positions = pango_context_get_round_glyph_positions (context);
+
+  return size->font_desc != NULL;
+}
+
+static void
+static_size_cache_add (const StaticSize *size)
+{
+  StaticSize *entry;
+
+  if (static_size_cache == NULL)
+    static_size_cache = g_hash_table_new_full (static_size_hash, static_size_equal,
+                                               static_size_free, NULL);
+  else if (g_hash_table_size (static_size_cache) >= STATIC_SIZE_CACHE_MAX_ENTRIES)
+    g_hash_table_remove_all (static_size_cache);
+
+  entry = g_memdup2 (size, sizeof (StaticSize));
+  entry->text = g_strdup (size->text);
+  entry->font_desc = pango_font_description_copy (size->font_desc);
+  g_object_ref (entry->font_map);
+  if (size->font_options)
+    entry->font_options = cairo_font_options_copy (size->font_options);
+
+  g_hash_table_add (static_size_cache, entry);
+}
+
+static void
+compute_static_size (GtkLabel   *self,
+                     int         width,
+                     StaticSize *size)
+{
+  PangoLayout *layout;
+
+  layout = gtk_label_get_measuring_layout (self, NULL, width);
+
+  pango_layout_get_size (layout, &size->natural_width, &size->height);
+  size->baseline = pango_layout_get_baseline (layout);
+
+  if (self->ellipsize)
+    {
+      layout = gtk_label_get_measuring_layout (self, layout, 0);
+      pango_layout_get_size (layout, &size->minimum_width, NULL);
+      /* yes, Pango ellipsizes even when that needs more space */
+      size->minimum_width = MIN (size->minimum_width, size->natural_width);
+    }
+  else
+    size->minimum_width = size->natural_width;
+
+  g_object_unref (layout);
+}
+
 static void
 get_static_size (GtkLabel       *self,
                  GtkOrientation  orientation,
@@ -1108,39 +1269,43 @@ get_static_size (GtkLabel       *self,
                  int            *natural_baseline)
 {
   int minimum_default, natural_default;
-  PangoLayout *layout;
+  StaticSize size, *cached = NULL;
+  gboolean cacheable;
+  int width;
 
   get_default_widths (self, &minimum_default, &natural_default);
+  width = self->ellipsize ? natural_default : -1;
+
+  gtk_label_ensure_layout (self);
 
-  layout = gtk_label_get_measuring_layout (self, NULL, self->ellipsize ? natural_default : -1);
+  cacheable = static_size_init_key (self, width, &size);
+  if (cacheable && static_size_cache != NULL)
+    cached = g_hash_table_lookup (static_size_cache, &size);
 
-  if (orientation == GTK_ORIENTATION_HORIZONTAL)
+  if (cached != NULL)
+    size = *cached;
+  else
     {
-      pango_layout_get_size (layout, natural, NULL);
-      if (self->ellipsize)
-        {
-          layout = gtk_label_get_measuring_layout (self, layout, 0);
-          pango_layout_get_size (layout, minimum, NULL);
-          /* yes, Pango ellipsizes even when that needs more space */
-          *minimum = MIN (*minimum, *natural);
-        }
-      else
-        *minimum = *natural;
+      compute_static_size (self, width, &size);
+      if (cacheable)
+        static_size_cache_add (&size);
+    }
 
+  if (orientation == GTK_ORIENTATION_HORIZONTAL)
+    {
+      *minimum = size.minimum_width;
       if (minimum_default > *minimum)
         *minimum = minimum_default;
-      *natural = MAX (*minimum, *natural);
+      *natural = MAX (*minimum, size.natural_width);
     }
   else
     {
-      pango_layout_get_size (layout, NULL, minimum);
-      *minimum_baseline = pango_layout_get_baseline (layout);
+      *minimum = size.height;
+      *minimum_baseline = size.baseline;
 
       *natural = *minimum;
       *natural_baseline = *minimum_baseline;
     }
-
-  g_object_unref (layout);
 }
 
 static void
@@ -5443,9 +5608,7 @@ get_better_cursor (GtkLabel *self,
 
   cursor_direction = get_cursor_direction (self);
 
-  g_object_get (gtk_widget_get_settings (GTK_WIDGET (self)),
-                "gtk-split-cursor", &split_cursor,
-                NULL);
+  split_cursor = gtk_settings_get_split_cursor (gtk_widget_get_settings (GTK_WIDGET (self)));
 
   gtk_label_ensure_layout (self);
 
@@ -5530,9 +5693,7 @@ gtk_label_move_visually (GtkLabel *self,
 
       gtk_label_ensure_layout (self);
 
-      g_object_get (gtk_widget_get_settings (GTK_WIDGET (self)),
-                    "gtk-split-cursor", &split_cursor,
-                    NULL);
+      split_cursor = gtk_settings_get_split_cursor (gtk_widget_get_settings (GTK_WIDGET (self)));
 
       if (split_cursor)
         strong = TRUE;
@@ -47,6 +47,14 @@
  */
 #define GTK_LIST_BASE_CHILD_MAX_OVERDRAW 10
 
+/* When the anchor jumps far away, creating and binding all the widgets
+ * around it in one frame makes the jump stutter. So only this many
+ * center widgets are created right away and the rest are added in the
+ * following frames, growing faster while that stays within the budget.
+ */
+#define GTK_LIST_BASE_ANCHOR_RAMP_START 32
+#define GTK_LIST_BASE_ANCHOR_RAMP_BUDGET_US 4000
+
 typedef struct _RubberbandData RubberbandData;
 
 struct _RubberbandData
@@ -78,6 +86,8 @@ struct _GtkListBasePrivate
   GtkPackType anchor_side_across;
   guint center_widgets;
   guint above_below_widgets;
+  guint center_widgets_limit; /* while growing after a jump */
+  guint anchor_ramp_id;
   /* the last item that was selected - basically the location to extend selections from */
   GtkListItemTracker *selected;
   /* the item that has input focus */
@@ -666,6 +676,11 @@ gtk_list_base_dispose (GObject *object)
   gtk_list_base_clear_adjustment (self, GTK_ORIENTATION_HORIZONTAL);
   gtk_list_base_clear_adjustment (self, GTK_ORIENTATION_VERTICAL);
 
+  if (priv->anchor_ramp_id)
+    {
+      gtk_widget_remove_tick_callback (GTK_WIDGET (self), priv->anchor_ramp_id);
+      priv->anchor_ramp_id = 0;
+    }
   if (priv->anchor)
     {
       gtk_list_item_tracker_free (priv->item_manager, priv->anchor);
@@ -2002,6 +2017,7 @@ gtk_list_base_init_real (GtkListBase      *self,
                                                   gtk_list_base_prepare_section_func,
                                                   gtk_list_base_create_header_widget_func);
   priv->anchor = gtk_list_item_tracker_new (priv->item_manager);
+  priv->center_widgets_limit = G_MAXUINT;
   priv->anchor_side_along = GTK_PACK_START;
   priv->anchor_side_across = GTK_PACK_START;
   priv->selected = gtk_list_item_tracker_new (priv->item_manager);
@@ -2215,6 +2231,58 @@ gtk_list_base_get_anchor (GtkListBase *self)
  * The anchor will also ensure that enough widgets are created according
  * to gtk_list_base_set_anchor_max_widgets().
  **/
+static gboolean
+gtk_list_base_anchor_ramp_cb (GtkWidget     *widget,
+                              GdkFrameClock *frame_clock,
+                              gpointer       unused)
+{
+  GtkListBase *self = GTK_LIST_BASE (widget);
+  GtkListBasePrivate *priv = gtk_list_base_get_instance_private (self);
+  gint64 start;
+
+  if (priv->center_widgets_limit >= priv->center_widgets)
+    {
+      priv->center_widgets_limit = G_MAXUINT;
+      priv->anchor_ramp_id = 0;
+      return G_SOURCE_REMOVE;
+    }
+
+  start = g_get_monotonic_time ();
+
+  priv->center_widgets_limit *= 2;
+  gtk_list_base_set_anchor (self,
+                            gtk_list_item_tracker_get_position (priv->item_manager, priv->anchor),
+                            priv->anchor_align_across,
+                            priv->anchor_side_across,
+                            priv->anchor_align_along,
+                            priv->anchor_side_along);
+
+  /* cheap items, grow faster next time */
+  if (g_get_monotonic_time () - start < GTK_LIST_BASE_ANCHOR_RAMP_BUDGET_US / 2)
+    priv->center_widgets_limit *= 2;
+
+  return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+gtk_list_base_is_anchor_jump (GtkListBase *self,
+                              guint        anchor_pos)
+{
+  GtkListBasePrivate *priv = gtk_list_base_get_instance_private (self);
+  guint old_pos;
+
+  if (!gtk_widget_get_mapped (GTK_WIDGET (self)) ||
+      priv->center_widgets <= GTK_LIST_BASE_ANCHOR_RAMP_START)
+    return FALSE;
+
+  old_pos = gtk_list_item_tracker_get_position (priv->item_manager, priv->anchor);
+  if (old_pos == GTK_INVALID_LIST_POSITION || anchor_pos == GTK_INVALID_LIST_POSITION)
+    return FALSE;
+
+  return anchor_pos > old_pos + priv->center_widgets ||
+         old_pos > anchor_pos + priv->center_widgets;
+}
+
 void
 gtk_list_base_set_anchor (GtkListBase *self,
                           guint        anchor_pos,
@@ -2224,14 +2292,24 @@ gtk_list_base_set_anchor (GtkListBase *self,
                           GtkPackType  anchor_side_along)
 {
   GtkListBasePrivate *priv = gtk_list_base_get_instance_private (self);
-  guint items_before;
+  guint items_before, n_center;
+
+  if (gtk_list_base_is_anchor_jump (self, anchor_pos))
+    {
+      priv->center_widgets_limit = GTK_LIST_BASE_ANCHOR_RAMP_START;
+      if (priv->anchor_ramp_id == 0)
+        priv->anchor_ramp_id = gtk_widget_add_tick_callback (GTK_WIDGET (self),
+                                                             gtk_list_base_anchor_ramp_cb,
+                                                             NULL, NULL);
+    }
 
-  items_before = round (priv->center_widgets * CLAMP (anchor_align_along, 0, 1));
+  n_center = MIN (priv->center_widgets, priv->center_widgets_limit);
+  items_before = round (n_center * CLAMP (anchor_align_along, 0, 1));
   gtk_list_item_tracker_set_position (priv->item_manager,
                                       priv->anchor,
                                       anchor_pos,
                                       items_before + priv->above_below_widgets,
-                                      priv->center_widgets - items_before + priv->above_below_widgets);
+                                      n_center - items_before + priv->above_below_widgets);
 
   priv->anchor_align_across = anchor_align_across;
   priv->anchor_side_across = anchor_side_across;
@@ -133,6 +133,11 @@ struct _GtkListBox
   gulong adjustment_changed_id;
   GtkWidget *scrollable_parent;
   GtkAdjustment *adjustment;
+  GtkAdjustment *scroll_adjustment;
+  double drawn_offset;
+  int drawn_start;
+  int drawn_end;
+  gboolean drawn_culled;
   gboolean activate_single_click;
   gboolean accept_unpaired_release;
   gboolean show_separators;
@@ -269,6 +274,12 @@ static void                 gtk_list_box_size_allocate                (GtkWidget
                                                                        int                  width,
                                                                        int                  height,
                                                                        int                  baseline);
+static void                 gtk_list_box_snapshot                     (GtkWidget           *widget,
+                                                                       GtkSnapshot         *snapshot);
+static void                 gtk_list_box_set_scroll_adjustment        (GtkListBox          *box,
+                                                                       GtkAdjustment       *adjustment);
+static void                 gtk_list_box_scroll_adjustment_changed    (GtkAdjustment       *adjustment,
+                                                                       GtkListBox          *box);
 static void                 gtk_list_box_activate_cursor_row          (GtkListBox          *box);
 static void                 gtk_list_box_toggle_cursor_row            (GtkListBox          *box);
 static void                 gtk_list_box_move_cursor                  (GtkListBox          *box,
@@ -446,6 +457,8 @@ gtk_list_box_dispose (GObject *object)
 
   gtk_list_box_remove_all (self);
 
+  gtk_list_box_set_scroll_adjustment (self, NULL);
+
   G_OBJECT_CLASS (gtk_list_box_parent_class)->dispose (object);
 }
 
@@ -488,6 +501,7 @@ gtk_list_box_class_init (GtkListBoxClass *klass)
   widget_class->get_request_mode = gtk_list_box_get_request_mode;
   widget_class->measure = gtk_list_box_measure;
   widget_class->size_allocate = gtk_list_box_size_allocate;
+  widget_class->snapshot = gtk_list_box_snapshot;
   klass->activate_cursor_row = gtk_list_box_activate_cursor_row;
   klass->toggle_cursor_row = gtk_list_box_toggle_cursor_row;
   klass->move_cursor = gtk_list_box_move_cursor;
@@ -1081,6 +1095,50 @@ gtk_list_box_get_adjustment (GtkListBox *box)
   return box->adjustment;
 }
 
+/* Rows outside the drawn range are not drawn, see gtk_list_box_snapshot().
+ * Scrolling only moves our render node, so we need to redraw when the
+ * scrollable parent scrolls close to the edge of what we drew.
+ */
+static void
+gtk_list_box_scroll_adjustment_changed (GtkAdjustment *adjustment,
+                                        GtkListBox    *box)
+{
+  double top, page_size;
+
+  if (!box->drawn_culled)
+    return;
+
+  page_size = gtk_adjustment_get_page_size (adjustment);
+  top = gtk_adjustment_get_value (adjustment) + box->drawn_offset;
+
+  if (top - page_size / 2 < box->drawn_start ||
+      top + page_size * 1.5 > box->drawn_end)
+    gtk_widget_queue_draw (GTK_WIDGET (box));
+}
+
+static void
+gtk_list_box_set_scroll_adjustment (GtkListBox    *box,
+                                    GtkAdjustment *adjustment)
+{
+  if (box->scroll_adjustment == adjustment)
+    return;
+
+  if (box->scroll_adjustment)
+    {
+      g_signal_handlers_disconnect_by_func (box->scroll_adjustment, gtk_list_box_scroll_adjustment_changed, box);
+      g_object_unref (box->scroll_adjustment);
+    }
+
+  box->scroll_adjustment = adjustment;
+
+  if (adjustment)
+    {
+      g_object_ref (adjustment);
+      g_signal_connect (adjustment, "value-changed", G_CALLBACK (gtk_list_box_scroll_adjustment_changed), box);
+      g_signal_connect (adjustment, "changed", G_CALLBACK (gtk_list_box_scroll_adjustment_changed), box);
+    }
+}
+
 static void
 adjustment_changed (GObject    *object,
                     GParamSpec *pspec,
@@ -1090,6 +1148,7 @@ adjustment_changed (GObject    *object,
 
   adjustment = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (object));
   gtk_list_box_set_adjustment (GTK_LIST_BOX (data), adjustment);
+  gtk_list_box_set_scroll_adjustment (GTK_LIST_BOX (data), adjustment);
 }
 
 static void
@@ -1119,6 +1178,7 @@ gtk_list_box_parent_cb (GObject    *object,
   else
     {
       gtk_list_box_set_adjustment (GTK_LIST_BOX (object), NULL);
+      gtk_list_box_set_scroll_adjustment (box, NULL);
       box->adjustment_changed_id = 0;
       box->scrollable_parent = NULL;
     }
@@ -2653,6 +2713,95 @@ gtk_list_box_size_allocate (GtkWidget *widget,
     }
 }
 
+/* Rows that are scrolled out of view don't need to be drawn, which
+ * keeps long lists, like the ones created for a bound model, cheap to
+ * draw. This only works if the scrollable parent clips us.
+ *
+ * We draw a page more on both ends, so our render node can be reused
+ * while scrolling and only needs to be redrawn once the view gets close
+ * to its edges. That slack also covers shadows and outlines.
+ */
+static gboolean
+gtk_list_box_update_drawn_range (GtkListBox *box)
+{
+  graphene_rect_t bounds;
+
+  box->drawn_culled = FALSE;
+
+  if (box->scroll_adjustment == NULL ||
+      box->scrollable_parent == NULL ||
+      gtk_widget_get_overflow (box->scrollable_parent) != GTK_OVERFLOW_HIDDEN ||
+      !gtk_widget_compute_bounds (box->scrollable_parent, GTK_WIDGET (box), &bounds))
+    return FALSE;
+
+  box->drawn_offset = bounds.origin.y - gtk_adjustment_get_value (box->scroll_adjustment);
+  box->drawn_start = floorf (bounds.origin.y - bounds.size.height);
+  box->drawn_end = ceilf (bounds.origin.y + 2 * bounds.size.height);
+  box->drawn_culled = TRUE;
+
+  return TRUE;
+}
+
+/* Rows are allocated top to bottom, so their positions are sorted */
+static GSequenceIter *
+gtk_list_box_get_first_row_after (GtkListBox *box,
+                                  int         y)
+{
+  GSequenceIter *begin, *end;
+
+  begin = g_sequence_get_begin_iter (box->children);
+  end = g_sequence_get_end_iter (box->children);
+
+  while (begin != end)
+    {
+      GSequenceIter *mid = g_sequence_range_get_midpoint (begin, end);
+      GtkListBoxRow *row = g_sequence_get (mid);
+
+      if (ROW_PRIV (row)->y + ROW_PRIV (row)->height <= y)
+        begin = g_sequence_iter_next (mid);
+      else
+        end = mid;
+    }
+
+  return begin;
+}
+
+static void
+gtk_list_box_snapshot (GtkWidget   *widget,
+                       GtkSnapshot *snapshot)
+{
+  GtkListBox *box = GTK_LIST_BOX (widget);
+  GSequenceIter *iter;
+
+  if (!gtk_list_box_update_drawn_range (box))
+    {
+      GTK_WIDGET_CLASS (gtk_list_box_parent_class)->snapshot (widget, snapshot);
+      return;
+    }
+
+  if (box->placeholder)
+    gtk_widget_snapshot_child (widget, box->placeholder, snapshot);
+
+  for (iter = gtk_list_box_get_first_row_after (box, box->drawn_start);
+       !g_sequence_iter_is_end (iter);
+       iter = g_sequence_iter_next (iter))
+    {
+      GtkListBoxRow *row = g_sequence_get (iter);
+      GtkWidget *header = ROW_PRIV (row)->header;
+      int y = ROW_PRIV (row)->y;
+
+      if (header)
+        y -= gtk_widget_get_height (header);
+
+      if (y >= box->drawn_end)
+        break;
+
+      if (header)
+        gtk_widget_snapshot_child (widget, header, snapshot);
+      gtk_widget_snapshot_child (widget, GTK_WIDGET (row), snapshot);
+    }
+}
+
 /**
  * gtk_list_box_prepend:
  * @box: a `GtkListBox`
@@ -26,7 +26,17 @@
 #include "gtksectionmodel.h"
 #include "gtkwidgetprivate.h"
 
+/* Maximum number of sections remembered by the section cache */
+#define GTK_LIST_ITEM_MANAGER_MAX_CACHED_SECTIONS 1024
+
 typedef struct _GtkListItemChange GtkListItemChange;
+typedef struct _GtkListSection GtkListSection;
+
+struct _GtkListSection
+{
+  guint start;
+  guint end;
+};
 
 struct _GtkListItemManager
 {
@@ -38,6 +48,10 @@ struct _GtkListItemManager
 
   GtkRbTree *items;
   GSList *trackers;
+  /* Sections queried from the model, sorted by position. Tiles only
+   * know the sections around tracked items, so this avoids querying
+   * the model again when scrolling back to a section. */
+  GArray *sections;
 
   GtkListTile * (* split_func) (GtkWidget *, GtkListTile *, guint);
   GtkListItemBase * (* create_widget) (GtkWidget *);
@@ -63,6 +77,8 @@ struct _GtkListItemChange
   GHashTable *deleted_items;
   GQueue recycled_items;
   GQueue recycled_headers;
+  /* deleted items may be reused for different items */
+  gboolean reuse_deleted_items;
 };
 
 G_DEFINE_TYPE (GtkListItemManager, gtk_list_item_manager, G_TYPE_OBJECT)
@@ -73,6 +89,7 @@ gtk_list_item_change_init (GtkListItemChange *change)
   change->deleted_items = NULL;
   g_queue_init (&change->recycled_items);
   g_queue_init (&change->recycled_headers);
+  change->reuse_deleted_items = FALSE;
 }
 
 static void
@@ -146,6 +163,22 @@ gtk_list_item_change_get (GtkListItemChange *change,
   if (result)
     return result;
 
+  /* Normally deleted items are kept for their item, so that items
+   * that are moved keep their widget. When the whole model changes,
+   * rebinding any of them is still cheaper than creating a new one.
+   */
+  if (change->reuse_deleted_items && change->deleted_items)
+    {
+      GHashTableIter iter;
+
+      g_hash_table_iter_init (&iter, change->deleted_items);
+      if (g_hash_table_iter_next (&iter, NULL, (gpointer *) &result))
+        {
+          g_hash_table_iter_steal (&iter);
+          return result;
+        }
+    }
+
   return NULL;
 }
 
@@ -171,6 +204,111 @@ potentially_empty_rectangle_union (cairo_rectangle_int_t       *self,
   gdk_rectangle_union (self, area, self);
 }
 
+/* Returns the index of the first cached section ending after position */
+static guint
+gtk_list_item_manager_find_section (GtkListItemManager *self,
+                                    guint               position)
+{
+  guint min, max, mid;
+
+  min = 0;
+  max = self->sections->len;
+  while (min < max)
+    {
+      mid = (min + max) / 2;
+      if (g_array_index (self->sections, GtkListSection, mid).end <= position)
+        min = mid + 1;
+      else
+        max = mid;
+    }
+
+  return min;
+}
+
+static void
+gtk_list_item_manager_get_section (GtkListItemManager *self,
+                                   guint               position,
+                                   guint              *out_start,
+                                   guint              *out_end)
+{
+  GtkListSection section, *cached;
+  guint i;
+
+  i = gtk_list_item_manager_find_section (self, position);
+  if (i < self->sections->len)
+    {
+      cached = &g_array_index (self->sections, GtkListSection, i);
+      if (cached->start <= position)
+        {
+          *out_start = cached->start;
+          *out_end = cached->end;
+          return;
+        }
+    }
+
+  gtk_section_model_get_section (GTK_SECTION_MODEL (self->model), position, &section.start, &section.end);
+  *out_start = section.start;
+  *out_end = section.end;
+
+  if (self->sections->len >= GTK_LIST_ITEM_MANAGER_MAX_CACHED_SECTIONS)
+    {
+      g_array_set_size (self->sections, 0);
+      i = 0;
+    }
+  else
+    {
+      /* Sections don't overlap, unless the model is broken */
+      if (i < self->sections->len &&
+          g_array_index (self->sections, GtkListSection, i).start < section.end)
+        return;
+      if (i > 0 &&
+          g_array_index (self->sections, GtkListSection, i - 1).end > section.start)
+        return;
+    }
+
+  g_array_insert_val (self->sections, i, section);
+}
+
+/*
+ * gtk_list_item_manager_invalidate_sections:
+ * @self: the listitemmanager
+ * @position: first changed position
+ * @n_items: number of changed items before the change
+ * @diff: number of items added minus number of items removed
+ *
+ * Drops all cached sections that could have changed and shifts
+ * the cached sections behind the change by @diff.
+ *
+ * Sections that touch the changed range are dropped, too, because
+ * their boundaries may have moved.
+ */
+static void
+gtk_list_item_manager_invalidate_sections (GtkListItemManager *self,
+                                           guint               position,
+                                           guint               n_items,
+                                           int                 diff)
+{
+  guint first, last, i;
+
+  first = gtk_list_item_manager_find_section (self, position > 0 ? position - 1 : 0);
+
+  last = first;
+  while (last < self->sections->len &&
+         g_array_index (self->sections, GtkListSection, last).start <= position + n_items)
+    last++;
+
+  for (i = last; i < self->sections->len; i++)
+    {
+      GtkListSection *section = &g_array_index (self->sections, GtkListSection, i);
+
+      section->start += diff;
+      section->end += diff;
+    }
+
+  if (last > first)
+    g_array_remove_range (self->sections, first, last - first);
+}
+
 static void
 gtk_list_item_manager_augment_node (GtkRbTree *tree,
                                     gpointer   node_augment,
@@ -971,7 +1109,7 @@ gtk_list_item_manager_add_items (GtkListItemManager *self,
           GtkListTile *footer = gtk_list_tile_get_footer (self, section);
           GtkListTile *previous_footer = gtk_list_tile_get_previous_skip (section);
 
-          gtk_section_model_get_section (GTK_SECTION_MODEL (self->model), position, &start, &end);
+          gtk_list_item_manager_get_section (self, position, &start, &end);
 
           if (previous_footer != NULL && previous_footer->type == GTK_LIST_TILE_FOOTER &&
               position > start && position < end)
@@ -1320,7 +1458,7 @@ gtk_list_item_manager_ensure_items (GtkListItemManager *self,
               guint start, end;
               gpointer item;
 
-              gtk_section_model_get_section (GTK_SECTION_MODEL (self->model), position, &start, &end);
+              gtk_list_item_manager_get_section (self, position, &start, &end);
               header = gtk_list_item_manager_insert_section (self,
                                                              start,
                                                              GTK_LIST_TILE_UNMATCHED_FOOTER,
@@ -1399,7 +1537,7 @@ gtk_list_item_manager_ensure_items (GtkListItemManager *self,
                   guint start, end;
                   gpointer item;
 
-                  gtk_section_model_get_section (GTK_SECTION_MODEL (self->model), position + i, &start, &end);
+                  gtk_list_item_manager_get_section (self, position + i, &start, &end);
 
                   gtk_list_tile_set_type (tile, GTK_LIST_TILE_HEADER);
                   g_assert (tile->widget == NULL);
@@ -1452,6 +1590,8 @@ gtk_list_item_manager_model_items_changed_cb (GListModel         *model,
   gtk_list_item_change_init (&change);
   n_items = g_list_model_get_n_items (G_LIST_MODEL (self->model));
 
+  gtk_list_item_manager_invalidate_sections (self, position, removed, added - removed);
+
   gtk_list_item_manager_remove_items (self, &change, position, removed);
   gtk_list_item_manager_add_items (self, &change, position, added);
 
@@ -1615,6 +1755,8 @@ gtk_list_item_manager_model_sections_changed_cb (GListModel         *model,
   GtkListTile *tile, *header;
   guint offset;
 
+  gtk_list_item_manager_invalidate_sections (self, position, n_items, 0);
+
   if (!gtk_list_item_manager_has_sections (self))
     return;
 
@@ -1703,17 +1845,15 @@ gtk_list_item_manager_model_selection_changed_cb (GListModel         *model,
 }
 
 static void
-gtk_list_item_manager_clear_model (GtkListItemManager *self)
+gtk_list_item_manager_clear_model (GtkListItemManager *self,
+                                   GtkListItemChange  *change)
 {
-  GtkListItemChange change;
   GSList *l;
 
   if (self->model == NULL)
     return;
 
-  gtk_list_item_change_init (&change);
-  gtk_list_item_manager_remove_items (self, &change, 0, g_list_model_get_n_items (G_LIST_MODEL (self->model)));
-  gtk_list_item_change_finish (&change);
+  gtk_list_item_manager_remove_items (self, change, 0, g_list_model_get_n_items (G_LIST_MODEL (self->model)));
   for (l = self->trackers; l; l = l->next)
     {
       gtk_list_item_tracker_unset_position (self, l->data);
@@ -1729,6 +1869,7 @@ gtk_list_item_manager_clear_model (GtkListItemManager *self)
                                         gtk_list_item_manager_model_sections_changed_cb,
                                         self);
   g_clear_object (&self->model);
+  g_array_set_size (self->sections, 0);
 
   gtk_list_item_manager_gc_tiles (self);
 
@@ -1739,10 +1880,14 @@ static void
 gtk_list_item_manager_dispose (GObject *object)
 {
   GtkListItemManager *self = GTK_LIST_ITEM_MANAGER (object);
+  GtkListItemChange change;
 
-  gtk_list_item_manager_clear_model (self);
+  gtk_list_item_change_init (&change);
+  gtk_list_item_manager_clear_model (self, &change);
+  gtk_list_item_change_finish (&change);
 
   g_clear_pointer (&self->items, gtk_rb_tree_unref);
+  g_clear_pointer (&self->sections, g_array_unref);
 
   G_OBJECT_CLASS (gtk_list_item_manager_parent_class)->dispose (object);
 }
@@ -1758,24 +1903,29 @@ gtk_list_item_manager_class_init (GtkListItemManagerClass *klass)
 static void
 gtk_list_item_manager_init (GtkListItemManager *self)
 {
+  self->sections = g_array_new (FALSE, FALSE, sizeof (GtkListSection));
 }
 
 void
 gtk_list_item_manager_set_model (GtkListItemManager *self,
                                  GtkSelectionModel  *model)
 {
+  GtkListItemChange change;
+
   g_return_if_fail (GTK_IS_LIST_ITEM_MANAGER (self));
   g_return_if_fail (model == NULL || GTK_IS_SELECTION_MODEL (model));
 
   if (self->model == model)
     return;
 
-  gtk_list_item_manager_clear_model (self);
+  /* Keep the widgets of the old model around for the new one */
+  gtk_list_item_change_init (&change);
+  change.reuse_deleted_items = TRUE;
+
+  gtk_list_item_manager_clear_model (self, &change);
 
   if (model)
     {
-      GtkListItemChange change;
-
       self->model = g_object_ref (model);
 
       g_signal_connect (model,
@@ -1792,11 +1942,11 @@ gtk_list_item_manager_set_model (GtkListItemManager *self,
                           G_CALLBACK (gtk_list_item_manager_model_sections_changed_cb),
                           self);
 
-      gtk_list_item_change_init (&change);
       gtk_list_item_manager_add_items (self, &change, 0, g_list_model_get_n_items (G_LIST_MODEL (model)));
       gtk_list_item_manager_ensure_items (self, &change, G_MAXUINT, 0);
-      gtk_list_item_change_finish (&change);
     }
+
+  gtk_list_item_change_finish (&change);
 }
 
 GtkSelectionModel *
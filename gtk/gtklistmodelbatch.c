@@ -0,0 +1,155 @@
+/*
+ * Copyright © 2024 The GTK Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtklistmodelbatchprivate.h"
+
+/* While a batch is active, changes are not emitted but merged into
+ * a single range: everything between the first changed item and the
+ * last unchanged item at the end. Changes are always reported in
+ * order, so tracking these two numbers is enough to describe the
+ * whole batch with one ::items-changed emission.
+ */
+
+void
+gtk_list_model_batch_items_changed (GtkListModelBatch *batch,
+                                    GListModel        *model,
+                                    GParamSpec        *n_items_pspec,
+                                    guint              position,
+                                    guint              removed,
+                                    guint              added)
+{
+  if (batch->depth == 0)
+    {
+      g_list_model_items_changed (model, position, removed, added);
+      if (removed != added && n_items_pspec)
+        g_object_notify_by_pspec (G_OBJECT (model), n_items_pspec);
+      return;
+    }
+
+  if (removed == 0 && added == 0)
+    return;
+
+  if (!batch->pending)
+    {
+      batch->pending = TRUE;
+      batch->n_items = g_list_model_get_n_items (model);
+      batch->n_items_before = batch->n_items - added + removed;
+      batch->position = position;
+      batch->tail = batch->n_items_before - position - removed;
+      return;
+    }
+
+  g_assert (position + removed <= batch->n_items);
+
+  batch->position = MIN (batch->position, position);
+  batch->tail = MIN (batch->tail, batch->n_items - position - removed);
+  batch->n_items = batch->n_items - removed + added;
+}
+
+void
+gtk_list_model_batch_begin (GtkListModelBatch *batch)
+{
+  batch->depth++;
+}
+
+void
+gtk_list_model_batch_end (GtkListModelBatch *batch,
+                          GListModel        *model,
+                          GParamSpec        *n_items_pspec)
+{
+  g_return_if_fail (batch->depth > 0);
+
+  batch->depth--;
+  if (batch->depth > 0 || !batch->pending)
+    return;
+
+  batch->pending = FALSE;
+  gtk_list_model_batch_items_changed (batch,
+                                      model,
+                                      n_items_pspec,
+                                      batch->position,
+                                      batch->n_items_before - batch->position - batch->tail,
+                                      batch->n_items - batch->position - batch->tail);
+}
+
+/**
+ * gtk_list_model_begin_batch:
+ * @model: a `GListModel`
+ *
+ * Starts a batch of changes to @model.
+ *
+ * Until the matching call to [func@Gtk.list_model_end_batch], GTK's
+ * list models do not emit [signal@Gio.ListModel::items-changed] but
+ * merge all changes into one range that gets emitted when the batch
+ * ends. That way a burst of small changes, like many appends, only
+ * needs to be handled once by everything that watches @model.
+ *
+ * Batches are forwarded to the models wrapped by [class@Gtk.MapListModel],
+ * [class@Gtk.FilterListModel], [class@Gtk.SortListModel] and to the
+ * model of models of [class@Gtk.FlattenListModel], so starting a batch
+ * on the outermost model of a chain batches the whole chain.
+ * Models that do not support batches are ignored.
+ *
+ * Note that while a batch is active, the items of @model can already
+ * be queried and reflect the changes that have not been emitted yet.
+ *
+ * Batches can be nested.
+ *
+ * Since: 4.16
+ */
+void
+gtk_list_model_begin_batch (GListModel *model)
+{
+  g_return_if_fail (model == NULL || G_IS_LIST_MODEL (model));
+
+  if (GTK_IS_MAP_LIST_MODEL (model))
+    gtk_map_list_model_set_batch (GTK_MAP_LIST_MODEL (model), TRUE);
+  else if (GTK_IS_FILTER_LIST_MODEL (model))
+    gtk_filter_list_model_set_batch (GTK_FILTER_LIST_MODEL (model), TRUE);
+  else if (GTK_IS_SORT_LIST_MODEL (model))
+    gtk_sort_list_model_set_batch (GTK_SORT_LIST_MODEL (model), TRUE);
+  else if (GTK_IS_FLATTEN_LIST_MODEL (model))
+    gtk_flatten_list_model_set_batch (GTK_FLATTEN_LIST_MODEL (model), TRUE);
+}
+
+/**
+ * gtk_list_model_end_batch:
+ * @model: a `GListModel`
+ *
+ * Ends a batch started with [func@Gtk.list_model_begin_batch].
+ *
+ * When the outermost batch ends, the changes made during it are
+ * emitted as a single [signal@Gio.ListModel::items-changed].
+ *
+ * Since: 4.16
+ */
+void
+gtk_list_model_end_batch (GListModel *model)
+{
+  g_return_if_fail (model == NULL || G_IS_LIST_MODEL (model));
+
+  if (GTK_IS_MAP_LIST_MODEL (model))
+    gtk_map_list_model_set_batch (GTK_MAP_LIST_MODEL (model), FALSE);
+  else if (GTK_IS_FILTER_LIST_MODEL (model))
+    gtk_filter_list_model_set_batch (GTK_FILTER_LIST_MODEL (model), FALSE);
+  else if (GTK_IS_SORT_LIST_MODEL (model))
+    gtk_sort_list_model_set_batch (GTK_SORT_LIST_MODEL (model), FALSE);
+  else if (GTK_IS_FLATTEN_LIST_MODEL (model))
+    gtk_flatten_list_model_set_batch (GTK_FLATTEN_LIST_MODEL (model), FALSE);
+}
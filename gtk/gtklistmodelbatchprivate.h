@@ -0,0 +1,61 @@
+/*
+ * Copyright © 2024 The GTK Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "gtklistmodelbatch.h"
+
+#include "gtkfilterlistmodel.h"
+#include "gtkflattenlistmodel.h"
+#include "gtkmaplistmodel.h"
+#include "gtksortlistmodel.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GtkListModelBatch GtkListModelBatch;
+
+struct _GtkListModelBatch
+{
+  guint depth;
+  gboolean pending;     /* if the fields below are valid */
+  guint position;       /* first changed item */
+  guint tail;           /* unchanged items at the end */
+  guint n_items_before; /* number of items before the first change */
+  guint n_items;        /* number of items after the last change */
+};
+
+void                    gtk_list_model_batch_items_changed      (GtkListModelBatch      *batch,
+                                                                 GListModel             *model,
+                                                                 GParamSpec             *n_items_pspec,
+                                                                 guint                   position,
+                                                                 guint                   removed,
+                                                                 guint                   added);
+void                    gtk_list_model_batch_begin              (GtkListModelBatch      *batch);
+void                    gtk_list_model_batch_end                (GtkListModelBatch      *batch,
+                                                                 GListModel             *model,
+                                                                 GParamSpec             *n_items_pspec);
+
+void                    gtk_filter_list_model_set_batch         (GtkFilterListModel     *self,
+                                                                 gboolean                begin);
+void                    gtk_flatten_list_model_set_batch        (GtkFlattenListModel    *self,
+                                                                 gboolean                begin);
+void                    gtk_map_list_model_set_batch            (GtkMapListModel        *self,
+                                                                 gboolean                begin);
+void                    gtk_sort_list_model_set_batch           (GtkSortListModel       *self,
+                                                                 gboolean                begin);
+
+G_END_DECLS
@@ -30,6 +30,8 @@
 #include "gtktypebuiltins.h"
 #include "gtkwidgetprivate.h"
 
+#include <stdlib.h>
+
 /* Maximum number of list items created by the listview.
  * For debugging, you can set this to G_MAXUINT to ensure
  * there's always a list item for every row.
@@ -465,6 +467,17 @@ compare_ints (gconstpointer first,
   return *(int *) first - *(int *) second;
 }
 
+static guint
+gtk_list_view_get_median_height (int   *heights,
+                                 guint  n_heights)
+{
+  g_return_val_if_fail (n_heights > 0, 0);
+
+  qsort (heights, n_heights, sizeof (int), compare_ints);
+
+  return heights[n_heights / 2];
+}
+
 static guint
 gtk_list_view_get_unknown_row_height (GtkListView *self,
                                       GArray      *heights)
@@ -472,9 +485,14 @@ gtk_list_view_get_unknown_row_height (GtkListView *self,
   g_return_val_if_fail (heights->len > 0, 0);
 
   /* return the median and hope rows are generally uniform with few outliers */
-  g_array_sort (heights, compare_ints);
+  return gtk_list_view_get_median_height ((int *) heights->data, heights->len);
+}
 
-  return g_array_index (heights, int, heights->len / 2);
+static gboolean
+gtk_list_tile_starts_section (GtkListTile *tile)
+{
+  return tile->type == GTK_LIST_TILE_HEADER ||
+         tile->type == GTK_LIST_TILE_UNMATCHED_HEADER;
 }
 
 static void
@@ -597,7 +615,8 @@ gtk_list_view_size_allocate (GtkWidget *widget,
 {
   GtkListView *self = GTK_LIST_VIEW (widget);
   GtkListTile *tile;
-  GArray *heights;
+  GArray *heights, *sections;
+  guint i, section;
   int min, nat, row_height, y, list_width, spacing;
   GtkOrientation orientation, opposite_orientation;
   GtkScrollablePolicy scroll_policy, opposite_scroll_policy;
@@ -628,13 +647,20 @@ gtk_list_view_size_allocate (GtkWidget *widget,
   else
     list_width = MAX (nat, list_width);
 
-  /* step 2: determine height of known list items and gc the list */
+  /* step 2: determine height of known list items and gc the list.
+   * Remember where each section's heights start, so unknown rows can
+   * be estimated from the rows of their own section. */
   heights = g_array_new (FALSE, FALSE, sizeof (int));
+  sections = g_array_new (FALSE, FALSE, sizeof (guint));
+  g_array_append_val (sections, heights->len);
 
   for (;
        tile != NULL;
        tile = gtk_rb_tree_node_get_next (tile))
     {
+      if (gtk_list_tile_starts_section (tile))
+        g_array_append_val (sections, heights->len);
+
       if (tile->widget == NULL)
         continue;
 
@@ -650,27 +676,47 @@ gtk_list_view_size_allocate (GtkWidget *widget,
         g_array_append_val (heights, row_height);
     }
 
-  /* step 3: determine height of unknown items and set the positions */
+  /* step 3: determine height of unknown items and set the positions.
+   * Sections without any known rows use the median of the whole list.
+   * The section heights are sorted in place first, the whole array
+   * last, because that reorders them across sections. */
+  for (i = 0; i < sections->len; i++)
+    {
+      guint start = g_array_index (sections, guint, i);
+      guint end = i + 1 < sections->len ? g_array_index (sections, guint, i + 1) : heights->len;
+
+      if (start < end)
+        g_array_index (sections, guint, i) = gtk_list_view_get_median_height (&g_array_index (heights, int, start), end - start);
+      else
+        g_array_index (sections, guint, i) = 0;
+    }
   row_height = gtk_list_view_get_unknown_row_height (self, heights);
   g_array_free (heights, TRUE);
 
   y = 0;
+  section = 0;
   for (tile = gtk_list_item_manager_get_first (self->item_manager);
        tile != NULL;
        tile = gtk_rb_tree_node_get_next (tile))
     {
+      if (gtk_list_tile_starts_section (tile))
+        section++;
+
       gtk_list_tile_set_area_position (self->item_manager, tile, 0, y);
       if (tile->widget == NULL)
         {
+          int section_height = g_array_index (sections, guint, section);
+
           gtk_list_tile_set_area_size (self->item_manager,
                                        tile,
                                        list_width,
-                                       row_height * tile->n_items
+                                       (section_height ? section_height : row_height) * tile->n_items
                                        + spacing * (tile->n_items - 1));
         }
 
       y += tile->area.height + spacing;
     }
+  g_array_free (sections, TRUE);
 
   /* step 4: allocate the rest */
   gtk_list_base_allocate (GTK_LIST_BASE (self));
@@ -63,8 +63,6 @@
 #include "gtkwidgetprivate.h"
 #include "gtkwindowprivate.h"
 #include "gtkwindowgroup.h"
-#include "print/gtkprintbackendprivate.h"
-#include "gtkimmoduleprivate.h"
 #include "gtkroot.h"
 #include "gtknative.h"
 #include "gtkpopcountprivate.h"
@@ -553,13 +551,11 @@ do_post_parse_initialization (void)
 
   gtk_initialized = TRUE;
 
-  before = GDK_PROFILER_CURRENT_TIME;
-#ifdef G_OS_UNIX
-  gtk_print_backends_init ();
-#endif
-  gtk_im_modules_init ();
-  gtk_media_file_extension_init ();
-  gdk_profiler_end_mark (before, "Init modules", NULL);
+  /* Print backends, IM modules and media modules are loaded when
+   * they are first used
+   */
+  if (g_getenv ("GTK_MEDIA"))
+    gtk_media_file_extension_init ();
 
   before = GDK_PROFILER_CURRENT_TIME;
   display_manager = gdk_display_manager_get ();
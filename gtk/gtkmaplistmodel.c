@@ -21,6 +21,7 @@
 
 #include "gtkmaplistmodel.h"
 
+#include "gtklistmodelbatchprivate.h"
 #include "gtkrbtreeprivate.h"
 #include "gtksectionmodel.h"
 #include "gtkprivate.h"
@@ -93,6 +94,8 @@ struct _GtkMapListModel
   GDestroyNotify user_destroy;
 
   GtkRbTree *items; /* NULL if map_func == NULL */
+
+  GtkListModelBatch batch;
 };
 
 struct _GtkMapListModelClass
@@ -261,9 +264,8 @@ gtk_map_list_model_items_changed_cb (GListModel      *model,
 
   if (self->items == NULL)
     {
-      g_list_model_items_changed (G_LIST_MODEL (self), position, removed, added);
-      if (removed != added)
-        g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+      gtk_list_model_batch_items_changed (&self->batch, G_LIST_MODEL (self), properties[PROP_N_ITEMS],
+                                          position, removed, added);
       return;
     }
 
@@ -312,9 +314,8 @@ gtk_map_list_model_items_changed_cb (GListModel      *model,
       gtk_rb_tree_node_mark_dirty (node);
     }
 
-  g_list_model_items_changed (G_LIST_MODEL (self), position, removed, added);
-  if (removed != added)
-    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+  gtk_list_model_batch_items_changed (&self->batch, G_LIST_MODEL (self), properties[PROP_N_ITEMS],
+                                      position, removed, added);
 }
 
 static void
@@ -372,11 +373,15 @@ gtk_map_list_model_get_property (GObject     *object,
 static void
 gtk_map_list_model_clear_model (GtkMapListModel *self)
 {
+  guint i;
+
   if (self->model == NULL)
     return;
 
   g_signal_handlers_disconnect_by_func (self->model, gtk_map_list_model_sections_changed_cb, self);
   g_signal_handlers_disconnect_by_func (self->model, gtk_map_list_model_items_changed_cb, self);
+  for (i = 0; i < self->batch.depth; i++)
+    gtk_list_model_end_batch (self->model);
   g_clear_object (&self->model);
 }
 
@@ -610,7 +615,7 @@ gtk_map_list_model_set_map_func (GtkMapListModel        *self,
   else
     n_items = 0;
   if (n_items)
-    g_list_model_items_changed (G_LIST_MODEL (self), 0, n_items, n_items);
+    gtk_list_model_batch_items_changed (&self->batch, G_LIST_MODEL (self), NULL, 0, n_items, n_items);
 
   if (was_maped != will_be_maped)
     g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_HAS_MAP]);
@@ -631,7 +636,7 @@ void
 gtk_map_list_model_set_model (GtkMapListModel *self,
                               GListModel      *model)
 {
-  guint removed, added;
+  guint removed, added, i;
 
   g_return_if_fail (GTK_IS_MAP_LIST_MODEL (self));
   g_return_if_fail (model == NULL || G_IS_LIST_MODEL (model));
@@ -646,6 +651,8 @@ gtk_map_list_model_set_model (GtkMapListModel *self,
     {
       self->model = g_object_ref (model);
       g_signal_connect (model, "items-changed", G_CALLBACK (gtk_map_list_model_items_changed_cb), self);
+      for (i = 0; i < self->batch.depth; i++)
+        gtk_list_model_begin_batch (model);
       added = g_list_model_get_n_items (model);
 
       if (GTK_IS_SECTION_MODEL (model))
@@ -659,9 +666,8 @@ gtk_map_list_model_set_model (GtkMapListModel *self,
   gtk_map_list_model_init_items (self);
   
   if (removed > 0 || added > 0)
-    g_list_model_items_changed (G_LIST_MODEL (self), 0, removed, added);
-  if (removed != added)
-    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+    gtk_list_model_batch_items_changed (&self->batch, G_LIST_MODEL (self), properties[PROP_N_ITEMS],
+                                        0, removed, added);
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_MODEL]);
 }
@@ -697,3 +703,19 @@ gtk_map_list_model_has_map (GtkMapListModel *self)
 
   return self->map_func != NULL;
 }
+
+void
+gtk_map_list_model_set_batch (GtkMapListModel *self,
+                              gboolean         begin)
+{
+  if (begin)
+    {
+      gtk_list_model_batch_begin (&self->batch);
+      gtk_list_model_begin_batch (self->model);
+    }
+  else
+    {
+      gtk_list_model_end_batch (self->model);
+      gtk_list_model_batch_end (&self->batch, G_LIST_MODEL (self), properties[PROP_N_ITEMS]);
+    }
+}
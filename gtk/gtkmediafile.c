@@ -23,6 +23,7 @@
 
 #include "gtkdebug.h"
 #include "gtkprivate.h"
+#include "gdkprofilerprivate.h"
 #include <glib/gi18n-lib.h>
 #include "gtkmodulesprivate.h"
 #include "gtknomediafileprivate.h"
@@ -187,6 +188,8 @@ gtk_media_file_get_extension (void)
   GIOExtension *e;
   GIOExtensionPoint *ep;
 
+  gtk_media_file_extension_init ();
+
   GTK_DEBUG (MODULES, "Looking up MediaFile extension");
 
   ep = g_io_extension_point_lookup (GTK_MEDIA_FILE_EXTENSION_POINT_NAME);
@@ -606,10 +609,18 @@ gtk_media_file_get_input_stream (GtkMediaFile *self)
 void
 gtk_media_file_extension_init (void)
 {
+  static gboolean initialized = FALSE;
   GIOExtensionPoint *ep;
   GIOModuleScope *scope;
   char **paths;
   int i;
+  gint64 before G_GNUC_UNUSED;
+
+  if (initialized)
+    return;
+
+  initialized = TRUE;
+  before = GDK_PROFILER_CURRENT_TIME;
 
   GTK_DEBUG (MODULES, "Registering extension point %s", GTK_MEDIA_FILE_EXTENSION_POINT_NAME);
 
@@ -644,7 +655,9 @@ gtk_media_file_extension_init (void)
         }
     }
 
-  /* If the env var is given, check at startup that things actually work */
+  gdk_profiler_end_mark (before, "Load media modules", NULL);
+
+  /* If the env var is given, check that things actually work */
   if (g_getenv ("GTK_MEDIA"))
     gtk_media_file_get_extension ();
 }
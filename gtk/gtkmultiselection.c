@@ -143,6 +143,14 @@ gtk_multi_selection_toggle_selection (GtkMultiSelection *self,
 
   gtk_bitset_difference (self->selected, changes);
 
+  /* Everything got unselected, so there is no need to look up
+   * the items to forget them one by one */
+  if (gtk_bitset_is_empty (self->selected))
+    {
+      g_hash_table_remove_all (self->items);
+      return;
+    }
+
   selected = gtk_bitset_copy (changes);
   gtk_bitset_intersect (selected, self->selected);
 
@@ -155,6 +155,18 @@ gtk_multi_sort_keys_clear_key (GtkSortKeys *keys,
     gtk_sort_keys_clear_key (self->keys[i].keys, key + self->keys[i].offset);
 }
 
+/* Only the first key decides the prefix, the later keys only
+ * matter when it is equal */
+static guint64
+gtk_multi_sort_keys_get_prefix (GtkSortKeys   *keys,
+                                gconstpointer  key_memory)
+{
+  GtkMultiSortKeys *self = (GtkMultiSortKeys *) keys;
+
+  return gtk_sort_keys_get_prefix (self->keys[0].keys,
+                                   ((const char *) key_memory) + self->keys[0].offset);
+}
+
 static const GtkSortKeysClass GTK_MULTI_SORT_KEYS_CLASS =
 {
   gtk_multi_sort_keys_free,
@@ -162,13 +174,24 @@ static const GtkSortKeysClass GTK_MULTI_SORT_KEYS_CLASS =
   gtk_multi_sort_keys_is_compatible,
   gtk_multi_sort_keys_init_key,
   gtk_multi_sort_keys_clear_key,
+  gtk_multi_sort_keys_get_prefix,
+};
+
+static const GtkSortKeysClass GTK_MULTI_SORT_KEYS_NO_PREFIX_CLASS =
+{
+  gtk_multi_sort_keys_free,
+  gtk_multi_sort_keys_compare,
+  gtk_multi_sort_keys_is_compatible,
+  gtk_multi_sort_keys_init_key,
+  gtk_multi_sort_keys_clear_key,
+  NULL,
 };
 
 static GtkSortKeys *
 gtk_multi_sort_keys_new (GtkMultiSorter *self)
 {
   GtkMultiSortKeys *result;
-  GtkSortKeys *keys;
+  GtkSortKeys *keys, *first;
   gsize i;
 
   if (gtk_sorters_get_size (&self->sorters) == 0)
@@ -176,19 +199,26 @@ gtk_multi_sort_keys_new (GtkMultiSorter *self)
   else if (gtk_sorters_get_size (&self->sorters) == 1)
     return gtk_sorter_get_keys (gtk_sorters_get (&self->sorters, 0));
 
-  keys = gtk_sort_keys_alloc (&GTK_MULTI_SORT_KEYS_CLASS,
+  first = gtk_sorter_get_keys (gtk_sorters_get (&self->sorters, 0));
+  keys = gtk_sort_keys_alloc (gtk_sort_keys_has_prefix (first) ? &GTK_MULTI_SORT_KEYS_CLASS
+                                                               : &GTK_MULTI_SORT_KEYS_NO_PREFIX_CLASS,
                               sizeof (GtkMultiSortKeys) + gtk_sorters_get_size (&self->sorters) * sizeof (GtkMultiSortKey),
                               0, 1);
   result = (GtkMultiSortKeys *) keys;
 
   result->n_keys = gtk_sorters_get_size (&self->sorters);
+  keys->thread_safe = TRUE;
   for (i = 0; i < result->n_keys; i++)
     {
-      result->keys[i].keys = gtk_sorter_get_keys (gtk_sorters_get (&self->sorters, i));
+      if (i == 0)
+        result->keys[i].keys = first;
+      else
+        result->keys[i].keys = gtk_sorter_get_keys (gtk_sorters_get (&self->sorters, i));
       result->keys[i].offset = GTK_SORT_KEYS_ALIGN (keys->key_size, gtk_sort_keys_get_key_align (result->keys[i].keys));
       keys->key_size = result->keys[i].offset + GTK_SORT_KEYS_ALIGN (gtk_sort_keys_get_key_size (result->keys[i].keys),
                                                                      gtk_sort_keys_get_key_align (result->keys[i].keys));
       keys->key_align = MAX (keys->key_align, gtk_sort_keys_get_key_align (result->keys[i].keys));
+      keys->thread_safe &= gtk_sort_keys_is_thread_safe (result->keys[i].keys);
     }
 
   return keys;
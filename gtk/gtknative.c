@@ -37,6 +37,8 @@ typedef struct _GtkNativePrivate
   gulong update_handler_id;
   gulong layout_handler_id;
   gulong scale_changed_handler_id;
+  gulong fractional_scale_changed_handler_id;
+  double scale;
 } GtkNativePrivate;
 
 static GQuark quark_gtk_native_private;
@@ -128,6 +130,17 @@ scale_changed_cb (GdkSurface *surface,
                   GParamSpec *pspec,
                   GtkNative  *native)
 {
+  GtkNativePrivate *priv = g_object_get_qdata (G_OBJECT (native), quark_gtk_native_private);
+
+  /* Fractional scale changes matter too, for rendering icons at the
+   * exact size. Both properties usually change together, so only
+   * react once.
+   */
+  if (priv->scale == gdk_surface_get_scale (surface))
+    return;
+
+  priv->scale = gdk_surface_get_scale (surface);
+
   _gtk_widget_scale_changed (GTK_WIDGET (native));
 }
 
@@ -139,6 +152,7 @@ verify_priv_unrealized (gpointer user_data)
   g_warn_if_fail (priv->update_handler_id == 0);
   g_warn_if_fail (priv->layout_handler_id == 0);
   g_warn_if_fail (priv->scale_changed_handler_id == 0);
+  g_warn_if_fail (priv->fractional_scale_changed_handler_id == 0);
 
   g_free (priv);
 }
@@ -173,9 +187,13 @@ gtk_native_realize (GtkNative *self)
                                               G_CALLBACK (surface_layout_cb),
                                               self);
 
+  priv->scale = gdk_surface_get_scale (surface);
   priv->scale_changed_handler_id = g_signal_connect (surface, "notify::scale-factor",
                                                      G_CALLBACK (scale_changed_cb),
                                                      self);
+  priv->fractional_scale_changed_handler_id = g_signal_connect (surface, "notify::scale",
+                                                                G_CALLBACK (scale_changed_cb),
+                                                                self);
 
   g_object_set_qdata_full (G_OBJECT (self),
                            quark_gtk_native_private,
@@ -208,6 +226,7 @@ gtk_native_unrealize (GtkNative *self)
   g_clear_signal_handler (&priv->update_handler_id, clock);
   g_clear_signal_handler (&priv->layout_handler_id, surface);
   g_clear_signal_handler (&priv->scale_changed_handler_id, surface);
+  g_clear_signal_handler (&priv->fractional_scale_changed_handler_id, surface);
 
   g_object_set_qdata (G_OBJECT (self), quark_gtk_native_private, NULL);
 }
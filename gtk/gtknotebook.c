@@ -47,6 +47,7 @@
 #include "gtksizerequest.h"
 #include "gtkprivate.h"
 #include "gtkselectionmodel.h"
+#include "gtksettingsprivate.h"
 #include "gtkstack.h"
 #include "gtktypebuiltins.h"
 #include "gtkwidgetprivate.h"
@@ -2908,7 +2909,7 @@ check_threshold (GtkNotebook *notebook,
   GtkSettings *settings;
 
   settings = gtk_widget_get_settings (GTK_WIDGET (notebook));
-  g_object_get (G_OBJECT (settings), "gtk-dnd-drag-threshold", &dnd_threshold, NULL);
+  dnd_threshold = gtk_settings_get_dnd_drag_threshold (settings);
 
   /* we want a large threshold */
   dnd_threshold *= DND_THRESHOLD_MULTIPLIER;
@@ -141,6 +141,65 @@ COMPARE_FUNCS(gulong)
 COMPARE_FUNCS(gint64)
 COMPARE_FUNCS(guint64)
 
+/* Radix sort prefixes: integers that sort like the numbers */
+static inline guint64
+signed_prefix (gint64 num)
+{
+  return ((guint64) num) ^ (G_GUINT64_CONSTANT (1) << 63);
+}
+
+static inline guint64
+unsigned_prefix (guint64 num)
+{
+  return num;
+}
+
+static inline guint64
+float_prefix (double num)
+{
+  union { double d; guint64 u; } bits;
+
+  /* NaN sorts last */
+  if (isnan (num))
+    return G_MAXUINT64;
+
+  /* -0.0 compares equal to 0.0 */
+  if (num == 0)
+    num = 0;
+
+  bits.d = num;
+  if (bits.u >> 63)
+    return ~bits.u;
+  else
+    return bits.u | (G_GUINT64_CONSTANT (1) << 63);
+}
+
+#define PREFIX_FUNCS(type, _convert) \
+static guint64 \
+gtk_ ## type ## _sort_keys_prefix_ascending (GtkSortKeys   *keys, \
+                                            gconstpointer  key_memory) \
+{ \
+  return _convert (*(type *) key_memory); \
+} \
+\
+static guint64 \
+gtk_ ## type ## _sort_keys_prefix_descending (GtkSortKeys   *keys, \
+                                             gconstpointer  key_memory) \
+{ \
+  return ~_convert (*(type *) key_memory); \
+}
+
+PREFIX_FUNCS(char, signed_prefix)
+PREFIX_FUNCS(guchar, unsigned_prefix)
+PREFIX_FUNCS(int, signed_prefix)
+PREFIX_FUNCS(guint, unsigned_prefix)
+PREFIX_FUNCS(float, float_prefix)
+PREFIX_FUNCS(double, float_prefix)
+PREFIX_FUNCS(long, signed_prefix)
+PREFIX_FUNCS(gulong, unsigned_prefix)
+PREFIX_FUNCS(gint64, signed_prefix)
+PREFIX_FUNCS(guint64, unsigned_prefix)
+
 G_GNUC_BEGIN_IGNORE_DEPRECATIONS
 
 #define NUMERIC_SORT_KEYS(TYPE, key_type, type, default_value) \
@@ -171,7 +230,8 @@ static const GtkSortKeysClass GTK_ASCENDING_ ## TYPE ## _SORT_KEYS_CLASS = \
   gtk_ ## key_type ## _sort_keys_compare_ascending, \
   gtk_ ## type ## _sort_keys_is_compatible, \
   gtk_ ## type ## _sort_keys_init_key, \
-  NULL \
+  NULL, \
+  gtk_ ## key_type ## _sort_keys_prefix_ascending, \
 }; \
 \
 static const GtkSortKeysClass GTK_DESCENDING_ ## TYPE ## _SORT_KEYS_CLASS = \
@@ -180,7 +240,8 @@ static const GtkSortKeysClass GTK_DESCENDING_ ## TYPE ## _SORT_KEYS_CLASS = \
   gtk_ ## key_type ## _sort_keys_compare_descending, \
   gtk_ ## type ## _sort_keys_is_compatible, \
   gtk_ ## type ## _sort_keys_init_key, \
-  NULL \
+  NULL, \
+  gtk_ ## key_type ## _sort_keys_prefix_descending, \
 }; \
 \
 static gboolean \
@@ -326,6 +387,8 @@ gtk_numeric_sort_keys_new (GtkNumericSorter *self)
     }
 
   result->expression = gtk_expression_ref (self->expression);
+  ((GtkSortKeys *) result)->thread_safe = TRUE;
+  ((GtkSortKeys *) result)->exact_prefix = TRUE;
 
   return (GtkSortKeys *) result;
 }
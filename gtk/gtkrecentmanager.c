@@ -166,6 +166,12 @@ struct _GtkRecentManagerPrivate
 
   guint changed_timeout;
   guint changed_age;
+
+  /* the file as we last wrote it, to tell our own writes
+   * from changes by other instances
+   */
+  GStatBuf written_stat;
+  guint has_written_stat : 1;
 };
 
 enum
@@ -494,6 +500,8 @@ gtk_recent_manager_real_changed (GtkRecentManager *manager)
                          g_strerror (errno));
               g_free (utf8);
             }
+
+          priv->has_written_stat = g_stat (priv->filename, &priv->written_stat) == 0;
         }
 
       /* mark us as clean */
@@ -511,6 +519,30 @@ gtk_recent_manager_real_changed (GtkRecentManager *manager)
   g_object_thaw_notify (G_OBJECT (manager));
 }
 
+/* Whether the file on disk is still the one we last wrote. With a
+ * long history, reparsing it is expensive, and every write of ours
+ * triggers the file monitor.
+ *
+ * The file gets replaced on every write, so this also catches writes
+ * by other instances that happen within the same second.
+ */
+static gboolean
+gtk_recent_manager_file_is_ours (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  GStatBuf stat_buf;
+
+  if (!priv->has_written_stat || priv->filename == NULL)
+    return FALSE;
+
+  if (g_stat (priv->filename, &stat_buf) != 0)
+    return FALSE;
+
+  return stat_buf.st_ino == priv->written_stat.st_ino &&
+         stat_buf.st_size == priv->written_stat.st_size &&
+         stat_buf.st_mtime == priv->written_stat.st_mtime;
+}
+
 static void
 gtk_recent_manager_monitor_changed (GFileMonitor      *monitor,
                                     GFile             *file,
@@ -525,7 +557,8 @@ gtk_recent_manager_monitor_changed (GFileMonitor      *monitor,
     case G_FILE_MONITOR_EVENT_CHANGED:
     case G_FILE_MONITOR_EVENT_CREATED:
     case G_FILE_MONITOR_EVENT_DELETED:
-      gtk_recent_manager_changed (manager);
+      if (!gtk_recent_manager_file_is_ours (manager))
+        gtk_recent_manager_changed (manager);
       break;
 
     case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
@@ -730,7 +730,7 @@ void
 gtk_css_style_snapshot_outline (GtkCssBoxes *boxes,
                                 GtkSnapshot *snapshot)
 {
-  GtkCssOutlineValues *outline = boxes->style->outline;
+  GtkCssOutlineValues *outline = gtk_css_style_get_outline_values (boxes->style);
   GtkBorderStyle border_style[4];
   float border_width[4];
   GdkRGBA colors[4];
@@ -24,7 +24,7 @@
 #include "gtkpangoprivate.h"
 #include "gtksnapshot.h"
 #include "gtktypebuiltins.h"
-#include "gtksettings.h"
+#include "gtksettingsprivate.h"
 
 
 void
@@ -242,11 +242,11 @@ gtk_css_style_snapshot_caret (GtkCssBoxes    *boxes,
   GdkSeat *seat;
   PangoDirection keyboard_direction;
   PangoDirection direction2;
+  const GtkSettingsValues *values;
 
-  g_object_get (gtk_settings_get_for_display (display),
-                "gtk-split-cursor", &split_cursor,
-                "gtk-cursor-aspect-ratio", &aspect_ratio,
-                NULL);
+  values = gtk_settings_get_values (gtk_settings_get_for_display (display));
+  split_cursor = values->split_cursor;
+  aspect_ratio = values->cursor_aspect_ratio;
 
   keyboard_direction = PANGO_DIRECTION_LTR;
   seat = gdk_display_get_default_seat (display);
@@ -1733,6 +1733,26 @@ gtk_scrolled_window_size_allocate (GtkWidget *widget,
   gtk_scrolled_window_check_attach_pan_gesture (scrolled_window);
 }
 
+/* Unless we pass on the child's size, we can stop its resizes from
+ * renegotiating the size of all our ancestors.
+ */
+static void
+gtk_scrolled_window_update_resize_boundary (GtkScrolledWindow *scrolled_window)
+{
+  GtkScrolledWindowPrivate *priv = gtk_scrolled_window_get_instance_private (scrolled_window);
+  GtkBorder border;
+
+  if (priv->child == NULL)
+    return;
+
+  gtk_widget_set_resize_boundary (priv->child,
+                                  priv->hscrollbar_policy != GTK_POLICY_NEVER &&
+                                  priv->vscrollbar_policy != GTK_POLICY_NEVER &&
+                                  !priv->propagate_natural_width &&
+                                  !priv->propagate_natural_height &&
+                                  !gtk_scrollable_get_border (GTK_SCROLLABLE (priv->child), &border));
+}
+
 static void
 gtk_scrolled_window_measure (GtkWidget      *widget,
                              GtkOrientation  orientation,
@@ -2407,6 +2427,7 @@ gtk_scrolled_window_set_policy (GtkScrolledWindow *scrolled_window,
       priv->hscrollbar_policy = hscrollbar_policy;
       priv->vscrollbar_policy = vscrollbar_policy;
 
+      gtk_scrolled_window_update_resize_boundary (scrolled_window);
       gtk_widget_queue_resize (GTK_WIDGET (scrolled_window));
 
       g_object_notify_by_pspec (object, properties[PROP_HSCROLLBAR_POLICY]);
@@ -3249,6 +3270,27 @@ _gtk_scrolled_window_set_adjustment_value (GtkScrolledWindow *scrolled_window,
   g_signal_emit (scrolled_window, signals[EDGE_OVERSHOT], 0, edge_pos);
 }
 
+/* Compute kinetic scrolling positions for the time the frame is
+ * predicted to be presented, not for the time it started. Frames
+ * are presented at a steady rate even when they start late, so
+ * this keeps the steps between frames even.
+ */
+static gint64
+get_deceleration_time (GdkFrameClock *frame_clock)
+{
+  GdkFrameTimings *timings;
+  gint64 presentation_time = 0;
+
+  timings = gdk_frame_clock_get_current_timings (frame_clock);
+  if (timings)
+    presentation_time = gdk_frame_timings_get_predicted_presentation_time (timings);
+
+  if (presentation_time != 0)
+    return presentation_time;
+
+  return gdk_frame_clock_get_frame_time (frame_clock);
+}
+
 static gboolean
 scrolled_window_deceleration_cb (GtkWidget         *widget,
                                  GdkFrameClock     *frame_clock,
@@ -3261,9 +3303,9 @@ scrolled_window_deceleration_cb (GtkWidget         *widget,
   double position, elapsed;
   gboolean retval = G_SOURCE_REMOVE;
 
-  current_time = gdk_frame_clock_get_frame_time (frame_clock);
-  elapsed = (current_time - priv->last_deceleration_time) / (double)G_TIME_SPAN_SECOND;
-  priv->last_deceleration_time = current_time;
+  current_time = get_deceleration_time (frame_clock);
+  elapsed = MAX (current_time - priv->last_deceleration_time, 0) / (double)G_TIME_SPAN_SECOND;
+  priv->last_deceleration_time = MAX (current_time, priv->last_deceleration_time);
 
   hadjustment = gtk_scrollbar_get_adjustment (GTK_SCROLLBAR (priv->hscrollbar));
   vadjustment = gtk_scrollbar_get_adjustment (GTK_SCROLLBAR (priv->vscrollbar));
@@ -3346,9 +3388,9 @@ gtk_scrolled_window_start_deceleration (GtkScrolledWindow *scrolled_window)
 
   frame_clock = gtk_widget_get_frame_clock (GTK_WIDGET (scrolled_window));
 
-  current_time = gdk_frame_clock_get_frame_time (frame_clock);
-  elapsed = (current_time - priv->last_deceleration_time) / (double)G_TIME_SPAN_SECOND;
-  priv->last_deceleration_time = current_time;
+  current_time = get_deceleration_time (frame_clock);
+  elapsed = MAX (current_time - priv->last_deceleration_time, 0) / (double)G_TIME_SPAN_SECOND;
+  priv->last_deceleration_time = MAX (current_time, priv->last_deceleration_time);
 
   _gtk_scrolled_window_get_overshoot (scrolled_window, &overshoot_x, &overshoot_y);
 
@@ -3833,7 +3875,7 @@ gtk_scrolled_window_update_use_indicators (GtkScrolledWindow *scrolled_window)
   GtkSettings *settings = gtk_widget_get_settings (GTK_WIDGET (scrolled_window));
   gboolean overlay_scrolling;
 
-  g_object_get (settings, "gtk-overlay-scrolling", &overlay_scrolling, NULL);
+  overlay_scrolling = gtk_settings_get_values (settings)->overlay_scrolling;
 
   use_indicators = overlay_scrolling && priv->overlay_scrolling;
 
@@ -4144,6 +4186,7 @@ gtk_scrolled_window_set_propagate_natural_width (GtkScrolledWindow *scrolled_win
     {
       priv->propagate_natural_width = propagate;
       g_object_notify_by_pspec (G_OBJECT (scrolled_window), properties [PROP_PROPAGATE_NATURAL_WIDTH]);
+      gtk_scrolled_window_update_resize_boundary (scrolled_window);
       gtk_widget_queue_resize (GTK_WIDGET (scrolled_window));
     }
 }
@@ -4189,6 +4232,7 @@ gtk_scrolled_window_set_propagate_natural_height (GtkScrolledWindow *scrolled_wi
     {
       priv->propagate_natural_height = propagate;
       g_object_notify_by_pspec (G_OBJECT (scrolled_window), properties [PROP_PROPAGATE_NATURAL_HEIGHT]);
+      gtk_scrolled_window_update_resize_boundary (scrolled_window);
       gtk_widget_queue_resize (GTK_WIDGET (scrolled_window));
     }
 }
@@ -4289,6 +4333,8 @@ gtk_scrolled_window_set_child (GtkScrolledWindow *scrolled_window,
                     "hadjustment", hadj,
                     "vadjustment", vadj,
                     NULL);
+
+      gtk_scrolled_window_update_resize_boundary (scrolled_window);
     }
 
   if (priv->child)
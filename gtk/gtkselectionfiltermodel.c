@@ -149,7 +149,47 @@ gtk_selection_filter_model_selection_changed_cb (GListModel              *model,
                                                  guint                    n_items,
                                                  GtkSelectionFilterModel *self)
 {
-  selection_filter_model_items_changed (self, position, n_items, n_items);
+  GtkBitset *selection, *changes;
+  guint first, last, sel_position, sel_removed, sel_added;
+
+  if (n_items == 0)
+    return;
+
+  selection = gtk_selection_model_get_selection_in_range (self->model, position, n_items);
+
+  /* Only report the range that actually changed, not the whole
+   * range the selection model reported */
+  changes = gtk_bitset_copy (selection);
+  gtk_bitset_difference (changes, self->selection);
+  gtk_bitset_remove_range (changes, 0, position);
+  gtk_bitset_remove_range (changes, position + n_items, G_MAXUINT - position - n_items);
+
+  if (gtk_bitset_is_empty (changes))
+    {
+      gtk_bitset_unref (changes);
+      gtk_bitset_unref (selection);
+      return;
+    }
+
+  first = gtk_bitset_get_minimum (changes);
+  last = gtk_bitset_get_maximum (changes);
+  gtk_bitset_unref (changes);
+
+  sel_position = first > 0 ? gtk_bitset_get_size_in_range (self->selection, 0, first - 1) : 0;
+  sel_removed = gtk_bitset_get_size_in_range (self->selection, first, last);
+  sel_added = gtk_bitset_get_size_in_range (selection, first, last);
+
+  /* Update just the changed range instead of copying the selection */
+  gtk_bitset_remove_range_closed (self->selection, first, last);
+  changes = gtk_bitset_new_range (first, last - first + 1);
+  gtk_bitset_intersect (changes, selection);
+  gtk_bitset_union (self->selection, changes);
+  gtk_bitset_unref (changes);
+  gtk_bitset_unref (selection);
+
+  g_list_model_items_changed (G_LIST_MODEL (self), sel_position, sel_removed, sel_added);
+  if (sel_removed != sel_added)
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
 }
 
 static void
@@ -136,6 +136,9 @@ struct _GtkSettings
   gboolean font_size_absolute;
   char *font_family;
   cairo_font_options_t *font_options;
+  GPtrArray *warm_fontsets;
+  GtkSettingsValues values;
+  gboolean values_valid;
 };
 
 struct _GtkSettingsClass
@@ -228,6 +231,7 @@ static void    settings_update_cursor_theme      (GtkSettings           *setting
 static void    settings_update_font_options      (GtkSettings           *settings);
 static void    settings_update_font_values       (GtkSettings           *settings);
 static gboolean settings_update_fontconfig       (GtkSettings           *settings);
+static void    settings_warm_up_fonts            (GtkSettings           *settings);
 static void    settings_update_theme             (GtkSettings           *settings);
 static gboolean settings_update_xsetting         (GtkSettings           *settings,
                                                   GParamSpec            *pspec,
@@ -989,6 +993,7 @@ gtk_settings_finalize (GObject *object)
     cairo_font_options_destroy (settings->font_options);
 
   g_free (settings->font_family);
+  g_clear_pointer (&settings->warm_fontsets, g_ptr_array_unref);
 
   g_object_unref (settings->theme_provider);
 
@@ -1108,6 +1113,7 @@ gtk_settings_create_for_display (GdkDisplay *display)
   settings_update_cursor_theme (settings);
   settings_update_font_options (settings);
   settings_update_font_values (settings);
+  settings_warm_up_fonts (settings);
 
   return settings;
 }
@@ -1164,6 +1170,13 @@ gtk_settings_get_default (void)
   return NULL;
 }
 
+static void
+settings_invalidate_values (GtkSettings *settings)
+{
+  settings->values_valid = FALSE;
+  settings->values.version++;
+}
+
 static void
 gtk_settings_set_property (GObject      *object,
                            guint         property_id,
@@ -1174,6 +1187,7 @@ gtk_settings_set_property (GObject      *object,
 
   g_value_copy (value, &settings->property_values[property_id - 1].value);
   settings->property_values[property_id - 1].source = GTK_SETTINGS_SOURCE_APPLICATION;
+  settings_invalidate_values (settings);
 }
 
 static void
@@ -1226,6 +1240,8 @@ gtk_settings_notify (GObject    *object,
   GtkSettings *settings = GTK_SETTINGS (object);
   guint property_id = pspec->param_id;
 
+  settings_invalidate_values (settings);
+
   if (settings->display == NULL) /* initialization */
     return;
 
@@ -1237,6 +1253,7 @@ gtk_settings_notify (GObject    *object,
       break;
     case PROP_FONT_NAME:
       settings_update_font_values (settings);
+      settings_warm_up_fonts (settings);
       settings_invalidate_style (settings);
       gtk_system_setting_changed (settings->display, GTK_SYSTEM_SETTING_FONT_NAME);
       break;
@@ -1245,6 +1262,7 @@ gtk_settings_notify (GObject    *object,
       settings_update_theme (settings);
       break;
     case PROP_XFT_DPI:
+      settings_warm_up_fonts (settings);
       settings_invalidate_style (settings);
       gtk_system_setting_changed (settings->display, GTK_SYSTEM_SETTING_DPI);
       break;
@@ -1254,11 +1272,15 @@ gtk_settings_notify (GObject    *object,
     case PROP_XFT_RGBA:
     case PROP_HINT_FONT_METRICS:
       settings_update_font_options (settings);
+      settings_warm_up_fonts (settings);
       gtk_system_setting_changed (settings->display, GTK_SYSTEM_SETTING_FONT_CONFIG);
       break;
     case PROP_FONTCONFIG_TIMESTAMP:
       if (settings_update_fontconfig (settings))
-        gtk_system_setting_changed (settings->display, GTK_SYSTEM_SETTING_FONT_CONFIG);
+        {
+          settings_warm_up_fonts (settings);
+          gtk_system_setting_changed (settings->display, GTK_SYSTEM_SETTING_FONT_CONFIG);
+        }
       break;
     case PROP_ENABLE_ANIMATIONS:
       settings_invalidate_style (settings);
@@ -1312,6 +1334,7 @@ apply_queued_setting (GtkSettings      *settings,
         {
           g_value_copy (&tmp_value, &settings->property_values[pspec->param_id - 1].value);
           settings->property_values[pspec->param_id - 1].source = qvalue->source;
+          settings_invalidate_values (settings);
           g_object_notify_by_pspec (G_OBJECT (settings), pspec);
         }
 
@@ -1476,6 +1499,76 @@ settings_update_font_options (GtkSettings *settings)
   cairo_font_options_set_antialias (settings->font_options, antialias_mode);
 }
 
+static void
+warm_up_font (GtkSettings                *settings,
+              PangoContext               *context,
+              const PangoFontDescription *desc)
+{
+  PangoFontset *fontset;
+
+  fontset = pango_font_map_load_fontset (pango_context_get_font_map (context),
+                                         context,
+                                         desc,
+                                         pango_context_get_language (context));
+  if (fontset)
+    g_ptr_array_add (settings->warm_fontsets, fontset);
+}
+
+/* Loads the fontsets for the default fonts, so that the fontconfig
+ * matching for them is already underway when the first widgets are
+ * laid out. Pango does that matching in a thread, so this does not
+ * block.
+ *
+ * The fontsets are kept around until the font settings change. That
+ * keeps them from being pushed out of the font map's cache, so all
+ * widgets that use these fonts share them.
+ */
+static void
+settings_warm_up_fonts (GtkSettings *settings)
+{
+  PangoContext *context;
+  PangoFontDescription *desc;
+  cairo_font_options_t *options;
+  int dpi;
+
+  g_clear_pointer (&settings->warm_fontsets, g_ptr_array_unref);
+
+  if (g_strcmp0 (g_getenv ("GTK_FONT_WARMUP"), "0") == 0)
+    return;
+
+  g_object_get (settings, "gtk-xft-dpi", &dpi, NULL);
+
+  /* Set up the context like gtk_widget_update_pango_context() does for
+   * widgets at scale 1, as the context is part of the fontset key
+   */
+  context = pango_font_map_create_context (pango_cairo_font_map_get_default ());
+  options = cairo_font_options_copy (settings->font_options);
+  cairo_font_options_set_hint_metrics (options, CAIRO_HINT_METRICS_ON);
+  pango_cairo_context_set_font_options (context, options);
+  cairo_font_options_destroy (options);
+  pango_cairo_context_set_resolution (context, dpi > 0 ? dpi / 1024. : 96.);
+
+  desc = pango_font_description_new ();
+  pango_font_description_set_family (desc, settings->font_family);
+  if (settings->font_size_absolute)
+    pango_font_description_set_absolute_size (desc, settings->font_size);
+  else
+    pango_font_description_set_size (desc, settings->font_size);
+
+  settings->warm_fontsets = g_ptr_array_new_with_free_func (g_object_unref);
+
+  /* Regular and bold text, and monospace for entries and text views */
+  warm_up_font (settings, context, desc);
+  pango_font_description_set_weight (desc, PANGO_WEIGHT_BOLD);
+  warm_up_font (settings, context, desc);
+  pango_font_description_set_weight (desc, PANGO_WEIGHT_NORMAL);
+  pango_font_description_set_family (desc, "Monospace");
+  warm_up_font (settings, context, desc);
+
+  pango_font_description_free (desc);
+  g_object_unref (context);
+}
+
 static gboolean
 settings_update_fontconfig (GtkSettings *settings)
 {
@@ -1800,6 +1893,7 @@ settings_update_xsetting (GtkSettings *settings,
       g_param_value_validate (pspec, &val);
       g_value_copy (&val, &settings->property_values[pspec->param_id - 1].value);
       settings->property_values[pspec->param_id - 1].source = GTK_SETTINGS_SOURCE_XSETTING;
+      settings_invalidate_values (settings);
 
       g_value_unset (&val);
 
@@ -1880,43 +1974,83 @@ gtk_settings_reset_property (GtkSettings *settings,
     g_param_value_set_default (pspec, &settings->property_values[pspec->param_id - 1].value);
 
   settings->property_values[pspec->param_id - 1].source = GTK_SETTINGS_SOURCE_DEFAULT;
+  settings_invalidate_values (settings);
   g_object_notify_by_pspec (G_OBJECT (settings), pspec);
 }
 
-gboolean
-gtk_settings_get_enable_animations (GtkSettings *settings)
-{
-  GtkSettingsPropertyValue *svalue = &settings->property_values[PROP_ENABLE_ANIMATIONS - 1];
-
-  if (svalue->source < GTK_SETTINGS_SOURCE_XSETTING)
-    {
-      GParamSpec *pspec;
-
-      pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (settings), "gtk-enable-animations");
-      if (settings_update_xsetting (settings, pspec, FALSE))
-        g_object_notify_by_pspec (G_OBJECT (settings), pspec);
-    }
+static const guint cached_properties[] = {
+  PROP_DOUBLE_CLICK_TIME,
+  PROP_DOUBLE_CLICK_DISTANCE,
+  PROP_DND_DRAG_THRESHOLD,
+  PROP_CURSOR_BLINK,
+  PROP_CURSOR_BLINK_TIME,
+  PROP_CURSOR_BLINK_TIMEOUT,
+  PROP_SPLIT_CURSOR,
+  PROP_CURSOR_ASPECT_RATIO,
+  PROP_XFT_DPI,
+  PROP_ENABLE_ANIMATIONS,
+  PROP_ENABLE_PRIMARY_PASTE,
+  PROP_KEYNAV_USE_CARET,
+  PROP_OVERLAY_SCROLLING,
+  PROP_HINT_FONT_METRICS,
+};
 
-  return g_value_get_boolean (&svalue->value);
-}
+#define CACHED_INT(prop) g_value_get_int (&settings->property_values[prop - 1].value)
+#define CACHED_BOOLEAN(prop) g_value_get_boolean (&settings->property_values[prop - 1].value)
 
-int
-gtk_settings_get_dnd_drag_threshold (GtkSettings *settings)
+/*
+ * gtk_settings_get_values:
+ * @settings: a `GtkSettings`
+ *
+ * Returns the cached values of frequently used settings.
+ *
+ * The values are refreshed lazily after a setting changed, so
+ * reading them is cheap. The returned struct stays valid as long
+ * as @settings, but its contents change with the settings.
+ *
+ * Returns: (transfer none): the settings values
+ */
+const GtkSettingsValues *
+gtk_settings_get_values (GtkSettings *settings)
 {
-  GtkSettingsPropertyValue *svalue = &settings->property_values[PROP_DND_DRAG_THRESHOLD - 1];
+  GtkSettingsValues *values = &settings->values;
+  gsize i;
 
-  if (svalue->source < GTK_SETTINGS_SOURCE_XSETTING)
+  if (G_LIKELY (settings->values_valid))
+    return values;
+
+  for (i = 0; i < G_N_ELEMENTS (cached_properties); i++)
     {
-      GParamSpec *pspec;
+      GParamSpec *pspec = pspecs[cached_properties[i]];
 
-      pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (settings), "gtk-dnd-drag-threshold");
-      if (settings_update_xsetting (settings, pspec, FALSE))
+      if (settings->property_values[pspec->param_id - 1].source < GTK_SETTINGS_SOURCE_XSETTING &&
+          settings_update_xsetting (settings, pspec, FALSE))
         g_object_notify_by_pspec (G_OBJECT (settings), pspec);
     }
 
-  return g_value_get_int (&svalue->value);
+  values->double_click_time = CACHED_INT (PROP_DOUBLE_CLICK_TIME);
+  values->double_click_distance = CACHED_INT (PROP_DOUBLE_CLICK_DISTANCE);
+  values->dnd_drag_threshold = CACHED_INT (PROP_DND_DRAG_THRESHOLD);
+  values->cursor_blink_time = CACHED_INT (PROP_CURSOR_BLINK_TIME);
+  values->cursor_blink_timeout = CACHED_INT (PROP_CURSOR_BLINK_TIMEOUT);
+  values->xft_dpi = CACHED_INT (PROP_XFT_DPI);
+  values->cursor_aspect_ratio = g_value_get_double (&settings->property_values[PROP_CURSOR_ASPECT_RATIO - 1].value);
+  values->cursor_blink = CACHED_BOOLEAN (PROP_CURSOR_BLINK);
+  values->split_cursor = CACHED_BOOLEAN (PROP_SPLIT_CURSOR);
+  values->enable_animations = CACHED_BOOLEAN (PROP_ENABLE_ANIMATIONS);
+  values->enable_primary_paste = CACHED_BOOLEAN (PROP_ENABLE_PRIMARY_PASTE);
+  values->keynav_use_caret = CACHED_BOOLEAN (PROP_KEYNAV_USE_CARET);
+  values->overlay_scrolling = CACHED_BOOLEAN (PROP_OVERLAY_SCROLLING);
+  values->hint_font_metrics = CACHED_BOOLEAN (PROP_HINT_FONT_METRICS);
+
+  settings->values_valid = TRUE;
+
+  return values;
 }
 
+#undef CACHED_INT
+#undef CACHED_BOOLEAN
+
 static void
 settings_update_font_name (GtkSettings *settings)
 {
@@ -42,8 +42,58 @@ typedef enum
 GtkSettingsSource  _gtk_settings_get_setting_source (GtkSettings *settings,
                                                      const char *name);
 
-gboolean gtk_settings_get_enable_animations  (GtkSettings *settings);
-int      gtk_settings_get_dnd_drag_threshold (GtkSettings *settings);
+/* The settings that are looked at in hot paths, cached so that reading
+ * them does not go through GValues. The version changes whenever any
+ * setting changes, so it can be used to invalidate derived data.
+ */
+typedef struct
+{
+  guint version;
+
+  int double_click_time;
+  int double_click_distance;
+  int dnd_drag_threshold;
+  int cursor_blink_time;
+  int cursor_blink_timeout;
+  int xft_dpi;
+  double cursor_aspect_ratio;
+
+  guint cursor_blink : 1;
+  guint split_cursor : 1;
+  guint enable_animations : 1;
+  guint enable_primary_paste : 1;
+  guint keynav_use_caret : 1;
+  guint overlay_scrolling : 1;
+  guint hint_font_metrics : 1;
+} GtkSettingsValues;
+
+const GtkSettingsValues *
+         gtk_settings_get_values             (GtkSettings *settings);
+
+static inline gboolean
+gtk_settings_get_enable_animations (GtkSettings *settings)
+{
+  return gtk_settings_get_values (settings)->enable_animations;
+}
+
+static inline int
+gtk_settings_get_dnd_drag_threshold (GtkSettings *settings)
+{
+  return gtk_settings_get_values (settings)->dnd_drag_threshold;
+}
+
+static inline int
+gtk_settings_get_double_click_time (GtkSettings *settings)
+{
+  return gtk_settings_get_values (settings)->double_click_time;
+}
+
+static inline gboolean
+gtk_settings_get_split_cursor (GtkSettings *settings)
+{
+  return gtk_settings_get_values (settings)->split_cursor;
+}
+
 const char *gtk_settings_get_font_family    (GtkSettings *settings);
 int          gtk_settings_get_font_size      (GtkSettings *settings);
 gboolean     gtk_settings_get_font_size_is_absolute (GtkSettings *settings);
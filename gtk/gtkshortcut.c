@@ -19,7 +19,7 @@
 
 #include "config.h"
 
-#include "gtkshortcut.h"
+#include "gtkshortcutprivate.h"
 
 #include "gtkshortcutaction.h"
 #include "gtkshortcuttrigger.h"
@@ -68,6 +68,11 @@ G_DEFINE_TYPE (GtkShortcut, gtk_shortcut, G_TYPE_OBJECT)
 
 static GParamSpec *properties[N_PROPS] = { NULL, };
 
+/* Bumped whenever any shortcut changes its trigger, so that
+ * shortcut controllers know when to rebuild their index
+ */
+static guint trigger_generation;
+
 static void
 gtk_shortcut_dispose (GObject *object)
 {
@@ -344,6 +349,7 @@ gtk_shortcut_set_trigger (GtkShortcut *self,
 
   if (g_set_object (&self->trigger, trigger))
     {
+      trigger_generation++;
       g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_TRIGGER]);
       g_object_unref (trigger);
     }
@@ -387,3 +393,9 @@ gtk_shortcut_set_arguments (GtkShortcut *self,
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_ARGUMENTS]);
 }
+
+guint
+gtk_shortcut_get_trigger_generation (void)
+{
+  return trigger_generation;
+}
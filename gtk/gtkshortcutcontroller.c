@@ -70,7 +70,7 @@
 #include "gtkflattenlistmodel.h"
 #include "gtkbuildable.h"
 #include "gtkeventcontrollerprivate.h"
-#include "gtkshortcut.h"
+#include "gtkshortcutprivate.h"
 #include "gtkshortcutmanager.h"
 #include "gtkshortcuttrigger.h"
 #include "gtktypebuiltins.h"
@@ -79,8 +79,13 @@
 #include "gtkdebug.h"
 #include "gtkmodelbuttonprivate.h"
 
+#include "gdk/gdkeventsprivate.h"
+
 #include <gdk/gdk.h>
 
+/* Controllers with fewer shortcuts than this just check all of them */
+#define INDEX_MIN_SHORTCUTS 32
+
 struct _GtkShortcutController
 {
   GtkEventController parent_instance;
@@ -91,8 +96,15 @@ struct _GtkShortcutController
 
   gulong shortcuts_changed_id;
   guint custom_shortcuts : 1;
+  guint index_valid : 1;
 
   guint last_activated;
+
+  /* keyval => GArray of positions of shortcuts that may trigger for it */
+  GHashTable *index;
+  /* positions of shortcuts that need to be checked for every event */
+  GArray *unindexed;
+  guint index_generation;
 };
 
 struct _GtkShortcutControllerClass
@@ -194,6 +206,8 @@ gtk_shortcut_controller_items_changed_cb (GListModel            *model,
                                           guint                  added,
                                           GtkShortcutController *self)
 {
+  self->index_valid = FALSE;
+
   g_list_model_items_changed (G_LIST_MODEL (self), position, removed, added);
   if (removed != added)
     g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
@@ -292,6 +306,8 @@ gtk_shortcut_controller_finalize (GObject *object)
 
   g_clear_signal_handler (&self->shortcuts_changed_id, self->shortcuts);
   g_clear_object (&self->shortcuts);
+  g_clear_pointer (&self->index, g_hash_table_unref);
+  g_clear_pointer (&self->unindexed, g_array_unref);
 
   G_OBJECT_CLASS (gtk_shortcut_controller_parent_class)->finalize (object);
 }
@@ -310,101 +326,332 @@ shortcut_data_free (gpointer data)
   g_object_unref (sdata->shortcut);
 }
 
+static void
+gtk_shortcut_controller_index_add (GtkShortcutController *self,
+                                   guint                  keyval,
+                                   guint                  position)
+{
+  GArray *positions;
+
+  positions = g_hash_table_lookup (self->index, GUINT_TO_POINTER (keyval));
+  if (positions == NULL)
+    {
+      positions = g_array_new (FALSE, FALSE, sizeof (guint));
+      g_hash_table_insert (self->index, GUINT_TO_POINTER (keyval), positions);
+    }
+
+  g_array_append_val (positions, position);
+}
+
+/* Returns FALSE if the trigger can't be indexed by keyval */
 static gboolean
-gtk_shortcut_controller_run_controllers (GtkEventController *controller,
-                                         GdkEvent           *event,
-                                         double              x,
-                                         double              y,
-                                         gboolean            enable_mnemonics)
+gtk_shortcut_controller_index_trigger (GtkShortcutController *self,
+                                       GtkShortcutTrigger    *trigger,
+                                       guint                  position)
 {
-  GtkShortcutController *self = GTK_SHORTCUT_CONTROLLER (controller);
-  int i, p;
-  GArray *shortcuts = NULL;
-  gboolean has_exact = FALSE;
-  gboolean retval = FALSE;
+  if (GTK_IS_KEYVAL_TRIGGER (trigger))
+    {
+      gtk_shortcut_controller_index_add (self,
+                                         gtk_keyval_trigger_get_keyval (GTK_KEYVAL_TRIGGER (trigger)),
+                                         position);
+      return TRUE;
+    }
+  else if (GTK_IS_MNEMONIC_TRIGGER (trigger))
+    {
+      gtk_shortcut_controller_index_add (self,
+                                         gtk_mnemonic_trigger_get_keyval (GTK_MNEMONIC_TRIGGER (trigger)),
+                                         position);
+      return TRUE;
+    }
+  else if (GTK_IS_NEVER_TRIGGER (trigger))
+    {
+      return TRUE;
+    }
+  else if (GTK_IS_ALTERNATIVE_TRIGGER (trigger))
+    {
+      GtkAlternativeTrigger *alternative = GTK_ALTERNATIVE_TRIGGER (trigger);
+      gboolean first, second;
+
+      first = gtk_shortcut_controller_index_trigger (self, gtk_alternative_trigger_get_first (alternative), position);
+      second = gtk_shortcut_controller_index_trigger (self, gtk_alternative_trigger_get_second (alternative), position);
+
+      return first && second;
+    }
+
+  return FALSE;
+}
+
+/* Keyval and mnemonic triggers store their keyval in lowercase. We
+ * index them by that keyval, and look up every keyval they could
+ * match for an event. Actual matching is still done by the triggers.
+ */
+static void
+gtk_shortcut_controller_ensure_index (GtkShortcutController *self)
+{
+  guint i, n;
 
-  for (i = 0, p = g_list_model_get_n_items (self->shortcuts); i < p; i++)
+  if (self->index_valid &&
+      self->index_generation == gtk_shortcut_get_trigger_generation ())
+    return;
+
+  if (self->index)
+    g_hash_table_remove_all (self->index);
+  else
+    self->index = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) g_array_unref);
+
+  if (self->unindexed)
+    g_array_set_size (self->unindexed, 0);
+  else
+    self->unindexed = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  for (i = 0, n = g_list_model_get_n_items (self->shortcuts); i < n; i++)
     {
-      GtkShortcut *shortcut;
-      ShortcutData *data;
-      guint index;
-      GtkWidget *widget;
-      GtkNative *native;
+      GtkShortcut *shortcut = g_list_model_get_item (self->shortcuts, i);
 
-      /* This is not entirely right, but we only want to do round-robin cycling
-       * for mnemonics.
-       */
-      if (enable_mnemonics)
-        index = (self->last_activated + 1 + i) % g_list_model_get_n_items (self->shortcuts);
-      else
-        index = i;
+      if (!GTK_IS_SHORTCUT (shortcut) ||
+          !gtk_shortcut_controller_index_trigger (self, gtk_shortcut_get_trigger (shortcut), i))
+        g_array_append_val (self->unindexed, i);
 
-      shortcut = g_list_model_get_item (self->shortcuts, index);
-      if (!GTK_IS_SHORTCUT (shortcut))
-        {
-          g_object_unref (shortcut);
-          continue;
-        }
+      g_object_unref (shortcut);
+    }
 
-      switch (gtk_shortcut_trigger_trigger (gtk_shortcut_get_trigger (shortcut), event, enable_mnemonics))
-        {
-        case GDK_KEY_MATCH_PARTIAL:
-          if (!has_exact)
-            break;
-          G_GNUC_FALLTHROUGH;
+  self->index_valid = TRUE;
+  self->index_generation = gtk_shortcut_get_trigger_generation ();
+}
+
+static void
+gtk_shortcut_controller_index_lookup (GtkShortcutController *self,
+                                      guint                  keyval,
+                                      GArray                *result)
+{
+  GArray *positions;
+
+  positions = g_hash_table_lookup (self->index, GUINT_TO_POINTER (keyval));
+  if (positions)
+    g_array_append_vals (result, positions->data, positions->len);
+}
+
+static guint
+normalize_keyval (guint keyval)
+{
+  if (keyval == GDK_KEY_ISO_Left_Tab)
+    return GDK_KEY_Tab;
+
+  return gdk_keyval_to_lower (keyval);
+}
+
+static int
+compare_positions (gconstpointer a,
+                   gconstpointer b)
+{
+  guint pa = *(const guint *) a;
+  guint pb = *(const guint *) b;
+
+  return (pa > pb) - (pa < pb);
+}
 
-        case GDK_KEY_MATCH_NONE:
-          g_object_unref (shortcut);
-          continue;
+/* Collects the positions of all shortcuts that may trigger for @event,
+ * sorted and without duplicates
+ */
+static GArray *
+gtk_shortcut_controller_get_candidates (GtkShortcutController *self,
+                                        GdkEvent              *event)
+{
+  GArray *result;
+  guint i, j;
 
-        case GDK_KEY_MATCH_EXACT:
-          if (!has_exact)
+  gtk_shortcut_controller_ensure_index (self);
+
+  result = g_array_new (FALSE, FALSE, sizeof (guint));
+  g_array_append_vals (result, self->unindexed->data, self->unindexed->len);
+
+  /* Keyval and mnemonic triggers only ever match key presses */
+  if (gdk_event_get_event_type (event) == GDK_KEY_PRESS)
+    {
+      GdkTranslatedKey *no_lock = gdk_key_event_get_translated_key (event, TRUE);
+      guint keyval = gdk_key_event_get_keyval (event);
+      GdkKeymapKey *keys;
+      guint *keyvals;
+      int k, n_keys;
+
+      /* Exact matches, and mnemonics */
+      gtk_shortcut_controller_index_lookup (self, no_lock->keyval, result);
+      if (normalize_keyval (no_lock->keyval) != no_lock->keyval)
+        gtk_shortcut_controller_index_lookup (self, normalize_keyval (no_lock->keyval), result);
+      if (normalize_keyval (keyval) != normalize_keyval (no_lock->keyval))
+        gtk_shortcut_controller_index_lookup (self, normalize_keyval (keyval), result);
+
+      /* Partial matches, for keyvals on the same key in other layouts */
+      if (gdk_display_map_keycode (gdk_event_get_display (event),
+                                   gdk_key_event_get_keycode (event),
+                                   &keys, &keyvals, &n_keys))
+        {
+          for (k = 0; k < n_keys; k++)
             {
-              if (shortcuts)
-                g_array_set_size (shortcuts, 0);
+              if (keys[k].level != no_lock->level ||
+                  keyvals[k] == no_lock->keyval)
+                continue;
+
+              gtk_shortcut_controller_index_lookup (self, keyvals[k], result);
             }
-          has_exact = TRUE;
-          break;
 
-        default:
-          g_assert_not_reached ();
+          g_free (keys);
+          g_free (keyvals);
         }
+    }
 
-      widget = gtk_event_controller_get_widget (GTK_EVENT_CONTROLLER (self));
-      if (!self->custom_shortcuts &&
-          GTK_IS_FLATTEN_LIST_MODEL (self->shortcuts))
-        {
-          GListModel *model = gtk_flatten_list_model_get_model_for_item (GTK_FLATTEN_LIST_MODEL (self->shortcuts), index);
-          if (GTK_IS_SHORTCUT_CONTROLLER (model))
-            widget = gtk_event_controller_get_widget (GTK_EVENT_CONTROLLER (model));
-        }
+  g_array_sort (result, compare_positions);
+
+  for (i = 0, j = 0; i < result->len; i++)
+    {
+      if (j > 0 && g_array_index (result, guint, i) == g_array_index (result, guint, j - 1))
+        continue;
+
+      g_array_index (result, guint, j++) = g_array_index (result, guint, i);
+    }
+  g_array_set_size (result, j);
+
+  return result;
+}
+
+static void
+gtk_shortcut_controller_check_shortcut (GtkShortcutController  *self,
+                                        GdkEvent               *event,
+                                        gboolean                enable_mnemonics,
+                                        guint                   index,
+                                        GArray                **shortcuts,
+                                        gboolean               *has_exact)
+{
+  GtkShortcut *shortcut;
+  ShortcutData *data;
+  GtkWidget *widget;
+  GtkNative *native;
+
+  shortcut = g_list_model_get_item (self->shortcuts, index);
+  if (!GTK_IS_SHORTCUT (shortcut))
+    {
+      g_object_unref (shortcut);
+      return;
+    }
+
+  switch (gtk_shortcut_trigger_trigger (gtk_shortcut_get_trigger (shortcut), event, enable_mnemonics))
+    {
+    case GDK_KEY_MATCH_PARTIAL:
+      if (!*has_exact)
+        break;
+      G_GNUC_FALLTHROUGH;
 
-      if (!_gtk_widget_is_sensitive (widget) ||
-          !_gtk_widget_get_mapped (widget))
+    case GDK_KEY_MATCH_NONE:
+      g_object_unref (shortcut);
+      return;
+
+    case GDK_KEY_MATCH_EXACT:
+      if (!*has_exact)
         {
-          g_object_unref (shortcut);
-          continue;
+          if (*shortcuts)
+            g_array_set_size (*shortcuts, 0);
         }
+      *has_exact = TRUE;
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+
+  widget = gtk_event_controller_get_widget (GTK_EVENT_CONTROLLER (self));
+  if (!self->custom_shortcuts &&
+      GTK_IS_FLATTEN_LIST_MODEL (self->shortcuts))
+    {
+      GListModel *model = gtk_flatten_list_model_get_model_for_item (GTK_FLATTEN_LIST_MODEL (self->shortcuts), index);
+      if (GTK_IS_SHORTCUT_CONTROLLER (model))
+        widget = gtk_event_controller_get_widget (GTK_EVENT_CONTROLLER (model));
+    }
+
+  if (!_gtk_widget_is_sensitive (widget) ||
+      !_gtk_widget_get_mapped (widget))
+    {
+      g_object_unref (shortcut);
+      return;
+    }
+
+  native = gtk_widget_get_native (widget);
+  if (!native ||
+      !gdk_surface_get_mapped (gtk_native_get_surface (native)))
+    {
+      g_object_unref (shortcut);
+      return;
+    }
+
+  if (G_UNLIKELY (!*shortcuts))
+    {
+      *shortcuts = g_array_sized_new (FALSE, TRUE, sizeof (ShortcutData), 8);
+      g_array_set_clear_func (*shortcuts, shortcut_data_free);
+    }
+
+  g_array_set_size (*shortcuts, (*shortcuts)->len + 1);
+  data = &g_array_index (*shortcuts, ShortcutData, (*shortcuts)->len - 1);
+  data->shortcut = shortcut;
+  data->index = index;
+  data->widget = widget;
+}
+
+static gboolean
+gtk_shortcut_controller_run_controllers (GtkEventController *controller,
+                                         GdkEvent           *event,
+                                         double              x,
+                                         double              y,
+                                         gboolean            enable_mnemonics)
+{
+  GtkShortcutController *self = GTK_SHORTCUT_CONTROLLER (controller);
+  int i, p;
+  GArray *shortcuts = NULL;
+  gboolean has_exact = FALSE;
+  gboolean retval = FALSE;
 
-      native = gtk_widget_get_native (widget);
-      if (!native ||
-          !gdk_surface_get_mapped (gtk_native_get_surface (native)))
+  p = g_list_model_get_n_items (self->shortcuts);
+
+  if (p < INDEX_MIN_SHORTCUTS)
+    {
+      for (i = 0; i < p; i++)
         {
-          g_object_unref (shortcut);
-          continue;
+          guint index;
+
+          /* This is not entirely right, but we only want to do round-robin cycling
+           * for mnemonics.
+           */
+          if (enable_mnemonics)
+            index = (self->last_activated + 1 + i) % p;
+          else
+            index = i;
+
+          gtk_shortcut_controller_check_shortcut (self, event, enable_mnemonics, index,
+                                                  &shortcuts, &has_exact);
         }
+    }
+  else
+    {
+      GArray *candidates;
+      guint start, n, j;
 
-      if (G_UNLIKELY (!shortcuts))
+      candidates = gtk_shortcut_controller_get_candidates (self, event);
+      n = candidates->len;
+
+      /* Keep the same order as above, starting after the last
+       * activated shortcut for mnemonics
+       */
+      start = 0;
+      if (enable_mnemonics)
         {
-          shortcuts = g_array_sized_new (FALSE, TRUE, sizeof (ShortcutData), 8);
-          g_array_set_clear_func (shortcuts, shortcut_data_free);
+          while (start < n && g_array_index (candidates, guint, start) <= self->last_activated)
+            start++;
         }
 
-      g_array_set_size (shortcuts, shortcuts->len + 1);
-      data = &g_array_index (shortcuts, ShortcutData, shortcuts->len - 1);
-      data->shortcut = shortcut;
-      data->index = index;
-      data->widget = widget;
+      for (j = 0; j < n; j++)
+        gtk_shortcut_controller_check_shortcut (self, event, enable_mnemonics,
+                                                g_array_index (candidates, guint, (start + j) % n),
+                                                &shortcuts, &has_exact);
+
+      g_array_unref (candidates);
     }
 
   if (GTK_DEBUG_CHECK (KEYBINDINGS))
@@ -578,6 +825,7 @@ gtk_shortcut_controller_class_init (GtkShortcutControllerClass *klass)
   object_class->get_property = gtk_shortcut_controller_get_property;
 
   controller_class->handle_event = gtk_shortcut_controller_handle_event;
+  controller_class->event_types = GTK_EVENT_TYPES_KEY;
   controller_class->set_widget = gtk_shortcut_controller_set_widget;
   controller_class->unset_widget = gtk_shortcut_controller_unset_widget;
 
@@ -442,8 +442,19 @@ gtk_widget_query_size_for_orientation (GtkWidget        *widget,
           g_string_append_printf (s, ", baseline %d/%d",
                                   min_baseline, nat_baseline);
         }
-      g_string_append_printf (s, " (hit cache: %s)\n",
-                              found_in_cache ? "yes" : "no");
+      if (for_size >= 0)
+        {
+          guint64 hits, misses, evictions;
+
+          _gtk_size_request_cache_get_statistics (&hits, &misses, &evictions);
+          g_string_append_printf (s, " (hit cache: %s, total %" G_GUINT64_FORMAT " hits, %"
+                                  G_GUINT64_FORMAT " misses, %" G_GUINT64_FORMAT " evictions)\n",
+                                  found_in_cache ? "yes" : "no",
+                                  hits, misses, evictions);
+        }
+      else
+        g_string_append_printf (s, " (hit cache: %s)\n",
+                                found_in_cache ? "yes" : "no");
       g_printerr ("%s", s->str);
       g_string_free (s, TRUE);
     }
@@ -25,48 +25,78 @@
 
 #include <string.h>
 
+/* Process-wide statistics about for_size lookups,
+ * for GTK_DEBUG=size-request
+ */
+static guint64 n_hits;
+static guint64 n_misses;
+static guint64 n_evictions;
+
 void
 _gtk_size_request_cache_init (SizeRequestCache *cache)
 {
   memset (cache, 0, sizeof (SizeRequestCache));
 }
 
-static void
-free_sizes_x (SizeRequestX **sizes)
+void
+_gtk_size_request_cache_free (SizeRequestCache *cache)
 {
-  int i;
-
-  for (i = 0; i < GTK_SIZE_REQUEST_CACHED_SIZES && sizes[i] != NULL; i++)
-    g_free (sizes[i]);
+  g_free (cache->requests_x);
+  g_free (cache->requests_y);
+}
 
-  g_free (sizes);
+void
+_gtk_size_request_cache_clear (SizeRequestCache *cache)
+{
+  _gtk_size_request_cache_free (cache);
+  _gtk_size_request_cache_init (cache);
 }
 
-static void
-free_sizes_y (SizeRequestY **sizes)
+/* The number of entries allocated for n_sizes cached requests */
+static guint
+get_capacity (guint n_sizes)
 {
-  int i;
+  guint capacity;
 
-  for (i = 0; i < GTK_SIZE_REQUEST_CACHED_SIZES && sizes[i] != NULL; i++)
-    g_free (sizes[i]);
+  if (n_sizes == 0)
+    return 0;
 
-  g_free (sizes);
-}
+  capacity = GTK_SIZE_REQUEST_MIN_CACHED_SIZES;
+  while (capacity < n_sizes)
+    capacity *= 2;
 
-void
-_gtk_size_request_cache_free (SizeRequestCache *cache)
-{
-  if (cache->requests_x)
-    free_sizes_x (cache->requests_x);
-  if (cache->requests_y)
-    free_sizes_y (cache->requests_y);
+  return capacity;
 }
 
-void
-_gtk_size_request_cache_clear (SizeRequestCache *cache)
+/* Returns the index of the entry to store a new request in,
+ * growing the storage if there is still room to grow.
+ */
+static guint
+pull_new_request (SizeRequestCache *cache,
+                  GtkOrientation    orientation,
+                  gsize             element_size,
+                  gpointer         *requests)
 {
-  _gtk_size_request_cache_free (cache);
-  _gtk_size_request_cache_init (cache);
+  guint n_sizes = cache->flags[orientation].n_cached_requests;
+
+  if (n_sizes < GTK_SIZE_REQUEST_CACHED_SIZES)
+    {
+      if (n_sizes == get_capacity (n_sizes))
+        *requests = g_realloc_n (*requests,
+                                 MAX (GTK_SIZE_REQUEST_MIN_CACHED_SIZES, n_sizes * 2),
+                                 element_size);
+
+      cache->flags[orientation].n_cached_requests++;
+      cache->flags[orientation].last_cached_request = n_sizes;
+    }
+  else
+    {
+      if (++cache->flags[orientation].last_cached_request == GTK_SIZE_REQUEST_CACHED_SIZES)
+        cache->flags[orientation].last_cached_request = 0;
+      n_evictions++;
+    }
+
+  return cache->flags[orientation].last_cached_request;
 }
 
 void
@@ -115,41 +145,25 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
 
   if (orientation == GTK_ORIENTATION_HORIZONTAL)
     {
-      SizeRequestX **cached_sizes = cache->requests_x;
-      SizeRequestX  *cached_size;
+      SizeRequestX *cached_sizes = cache->requests_x;
+      SizeRequestX *cached_size;
 
       for (i = 0; i < n_sizes; i++)
 	{
-	  if (cached_sizes[i]->cached_size.minimum_size == minimum_size &&
-	      cached_sizes[i]->cached_size.natural_size == natural_size)
+	  if (cached_sizes[i].cached_size.minimum_size == minimum_size &&
+	      cached_sizes[i].cached_size.natural_size == natural_size)
 	    {
-	      cached_sizes[i]->lower_for_size = MIN (cached_sizes[i]->lower_for_size, for_size);
-	      cached_sizes[i]->upper_for_size = MAX (cached_sizes[i]->upper_for_size, for_size);
+	      cached_sizes[i].lower_for_size = MIN (cached_sizes[i].lower_for_size, for_size);
+	      cached_sizes[i].upper_for_size = MAX (cached_sizes[i].upper_for_size, for_size);
 	      return;
 	    }
 	}
 
       /* If not found, pull a new size from the cache, the returned size cache
-       * will immediately be used to cache the new computed size so we go ahead
-       * and increment the last_cached_request right away */
-      if (n_sizes < GTK_SIZE_REQUEST_CACHED_SIZES)
-	{
-	  cache->flags[orientation].n_cached_requests++;
-	  cache->flags[orientation].last_cached_request = cache->flags[orientation].n_cached_requests - 1;
-	}
-      else
-	{
-	  if (++cache->flags[orientation].last_cached_request == GTK_SIZE_REQUEST_CACHED_SIZES)
-	    cache->flags[orientation].last_cached_request = 0;
-	}
-
-      if (cache->requests_x == NULL)
-	cache->requests_x = g_new0 (SizeRequestX *, GTK_SIZE_REQUEST_CACHED_SIZES);
+       * will immediately be used to cache the new computed size */
+      i = pull_new_request (cache, orientation, sizeof (SizeRequestX), (gpointer *) &cache->requests_x);
 
-      if (cache->requests_x[cache->flags[orientation].last_cached_request] == NULL)
-	cache->requests_x[cache->flags[orientation].last_cached_request] = g_new (SizeRequestX, 1);
-
-      cached_size = cache->requests_x[cache->flags[orientation].last_cached_request];
+      cached_size = &cache->requests_x[i];
       cached_size->lower_for_size = for_size;
       cached_size->upper_for_size = for_size;
       cached_size->cached_size.minimum_size = minimum_size;
@@ -157,43 +171,27 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
     }
   else
     {
-      SizeRequestY **cached_sizes = cache->requests_y;
-      SizeRequestY  *cached_size;
+      SizeRequestY *cached_sizes = cache->requests_y;
+      SizeRequestY *cached_size;
 
       for (i = 0; i < n_sizes; i++)
 	{
-	  if (cached_sizes[i]->cached_size.minimum_size == minimum_size &&
-	      cached_sizes[i]->cached_size.natural_size == natural_size &&
-	      cached_sizes[i]->cached_size.minimum_baseline == minimum_baseline &&
-	      cached_sizes[i]->cached_size.natural_baseline == natural_baseline)
+	  if (cached_sizes[i].cached_size.minimum_size == minimum_size &&
+	      cached_sizes[i].cached_size.natural_size == natural_size &&
+	      cached_sizes[i].cached_size.minimum_baseline == minimum_baseline &&
+	      cached_sizes[i].cached_size.natural_baseline == natural_baseline)
 	    {
-	      cached_sizes[i]->lower_for_size = MIN (cached_sizes[i]->lower_for_size, for_size);
-	      cached_sizes[i]->upper_for_size = MAX (cached_sizes[i]->upper_for_size, for_size);
+	      cached_sizes[i].lower_for_size = MIN (cached_sizes[i].lower_for_size, for_size);
+	      cached_sizes[i].upper_for_size = MAX (cached_sizes[i].upper_for_size, for_size);
 	      return;
 	    }
 	}
 
       /* If not found, pull a new size from the cache, the returned size cache
-       * will immediately be used to cache the new computed size so we go ahead
-       * and increment the last_cached_request right away */
-      if (n_sizes < GTK_SIZE_REQUEST_CACHED_SIZES)
-	{
-	  cache->flags[orientation].n_cached_requests++;
-	  cache->flags[orientation].last_cached_request = cache->flags[orientation].n_cached_requests - 1;
-	}
-      else
-	{
-	  if (++cache->flags[orientation].last_cached_request == GTK_SIZE_REQUEST_CACHED_SIZES)
-	    cache->flags[orientation].last_cached_request = 0;
-	}
+       * will immediately be used to cache the new computed size */
+      i = pull_new_request (cache, orientation, sizeof (SizeRequestY), (gpointer *) &cache->requests_y);
 
-      if (cache->requests_y == NULL)
-	cache->requests_y = g_new0 (SizeRequestY *, GTK_SIZE_REQUEST_CACHED_SIZES);
-
-      if (cache->requests_y[cache->flags[orientation].last_cached_request] == NULL)
-	cache->requests_y[cache->flags[orientation].last_cached_request] = g_new (SizeRequestY, 1);
-
-      cached_size = cache->requests_y[cache->flags[orientation].last_cached_request];
+      cached_size = &cache->requests_y[i];
       cached_size->lower_for_size = for_size;
       cached_size->upper_for_size = for_size;
       cached_size->cached_size.minimum_size = minimum_size;
@@ -239,7 +237,7 @@ _gtk_size_request_cache_lookup (const SizeRequestCache *cache,
 	  /* Search for an already cached size */
           for (i = 0, p = cache->flags[GTK_ORIENTATION_HORIZONTAL].n_cached_requests; i < p; i++)
             {
-              const SizeRequestX *cur = cache->requests_x[i];
+              const SizeRequestX *cur = &cache->requests_x[i];
 
 	      if (cur->lower_for_size <= for_size &&
 		  cur->upper_for_size >= for_size)
@@ -249,10 +247,12 @@ _gtk_size_request_cache_lookup (const SizeRequestCache *cache,
                   *minimum = result->minimum_size;
                   *natural = result->natural_size;
 
+                  n_hits++;
                   return TRUE;
                 }
             }
 
+          n_misses++;
           return FALSE;
 	}
     }
@@ -278,7 +278,7 @@ _gtk_size_request_cache_lookup (const SizeRequestCache *cache,
 	  /* Search for an already cached size */
           for (i = 0, p = cache->flags[GTK_ORIENTATION_VERTICAL].n_cached_requests; i < p; i++)
             {
-              const SizeRequestY *cur = cache->requests_y[i];
+              const SizeRequestY *cur = &cache->requests_y[i];
 
 	      if (cur->lower_for_size <= for_size &&
 		  cur->upper_for_size >= for_size)
@@ -289,12 +289,23 @@ _gtk_size_request_cache_lookup (const SizeRequestCache *cache,
                   *natural = result->natural_size;
                   *minimum_baseline = result->minimum_baseline;
                   *natural_baseline = result->natural_baseline;
+                  n_hits++;
                   return TRUE;
                 }
             }
 
+          n_misses++;
           return FALSE;
         }
     }
 }
 
+void
+_gtk_size_request_cache_get_statistics (guint64 *hits,
+                                        guint64 *misses,
+                                        guint64 *evictions)
+{
+  *hits = n_hits;
+  *misses = n_misses;
+  *evictions = n_evictions;
+}
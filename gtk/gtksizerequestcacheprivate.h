@@ -34,8 +34,12 @@ G_BEGIN_DECLS
  * for a said widget to have, if a label can
  * only wrap to 3 lines, only 3 caches will
  * ever be allocated for it.
+ *
+ * The storage grows in powers of two as a
+ * widget needs more entries, up to this limit.
  */
-#define GTK_SIZE_REQUEST_CACHED_SIZES   (64)
+#define GTK_SIZE_REQUEST_CACHED_SIZES   (256)
+#define GTK_SIZE_REQUEST_MIN_CACHED_SIZES (4)
 
 typedef struct {
   int minimum_size;
@@ -64,8 +68,8 @@ typedef struct
 } SizeRequestY;
 
 typedef struct {
-  SizeRequestX **requests_x;
-  SizeRequestY **requests_y;
+  SizeRequestX *requests_x;
+  SizeRequestY *requests_y;
 
   CachedSizeX  cached_size_x;
   CachedSizeY  cached_size_y;
@@ -98,5 +102,9 @@ gboolean        _gtk_size_request_cache_lookup                  (const SizeReque
                                                                  int                    *minimum_baseline,
                                                                  int                    *natural_baseline);
 
+void            _gtk_size_request_cache_get_statistics          (guint64                *hits,
+                                                                 guint64                *misses,
+                                                                 guint64                *evictions);
+
 G_END_DECLS
 
@@ -38,6 +38,7 @@
 #define GDK_ARRAY_TYPE_NAME GtkSnapshotNodes
 #define GDK_ARRAY_ELEMENT_TYPE GskRenderNode *
 #define GDK_ARRAY_FREE_FUNC gsk_render_node_unref
+#define GDK_ARRAY_PREALLOC 32
 #include "gdk/gdkarrayimpl.c"
 
 /**
@@ -130,6 +131,11 @@ struct _GtkSnapshotState {
     struct {
       char *message;
     } debug;
+    struct {
+      GskRenderNode **node;
+      guint64 *node_version;
+      guint64 version;
+    } cached;
     struct {
       GskMaskMode mask_mode;
       GskRenderNode *mask_node;
@@ -218,6 +224,16 @@ gtk_snapshot_collect_default (GtkSnapshot       *snapshot,
   return node;
 }
 
+static GskRenderNode *
+gtk_snapshot_collect_discard (GtkSnapshot      *snapshot,
+                              GtkSnapshotState *state,
+                              GskRenderNode   **nodes,
+                              guint             n_nodes)
+{
+  /* Drop the node and return nothing.  */
+  return NULL;
+}
+
 static GtkSnapshotState *
 gtk_snapshot_push_state (GtkSnapshot            *snapshot,
                          GskTransform           *transform,
@@ -507,11 +523,21 @@ gtk_snapshot_push_opacity (GtkSnapshot *snapshot,
   GtkSnapshotState *current_state = gtk_snapshot_get_current_state (snapshot);
   GtkSnapshotState *state;
 
+  /* Fully opaque content doesn't need an opacity node */
+  if (opacity >= 1.0)
+    {
+      gtk_snapshot_push_state (snapshot,
+                               current_state->transform,
+                               gtk_snapshot_collect_default,
+                               NULL);
+      return;
+    }
+
   state = gtk_snapshot_push_state (snapshot,
                                    current_state->transform,
                                    gtk_snapshot_collect_opacity,
                                    NULL);
-  state->data.opacity.opacity = CLAMP (opacity, 0.0, 1.0);
+  state->data.opacity.opacity = MAX (opacity, 0.0);
 }
 
 static GskRenderNode *
@@ -560,7 +586,8 @@ gtk_snapshot_push_blur (GtkSnapshot *snapshot,
 
   state = gtk_snapshot_push_state (snapshot,
                                    current_state->transform,
-                                   gtk_snapshot_collect_blur,
+                                   radius > 0 ? gtk_snapshot_collect_blur
+                                              : gtk_snapshot_collect_default,
                                    NULL);
   state->data.blur.radius = radius;
 }
@@ -720,16 +747,6 @@ gtk_snapshot_collect_repeat (GtkSnapshot      *snapshot,
   return repeat_node;
 }
 
-static GskRenderNode *
-gtk_snapshot_collect_discard_repeat (GtkSnapshot      *snapshot,
-                                     GtkSnapshotState *state,
-                                     GskRenderNode   **nodes,
-                                     guint             n_nodes)
-{
-  /* Drop the node and return nothing.  */
-  return NULL;
-}
-
 static void
 gtk_graphene_rect_scale_affine (const graphene_rect_t *rect,
                                 float                  scale_x,
@@ -823,6 +840,97 @@ gtk_snapshot_ensure_identity (GtkSnapshot *snapshot)
     gtk_snapshot_autopush_transform (snapshot);
 }
 
+static GskRenderNode *
+gtk_snapshot_collect_cached (GtkSnapshot      *snapshot,
+                             GtkSnapshotState *state,
+                             GskRenderNode   **nodes,
+                             guint             n_nodes)
+{
+  GskRenderNode *node;
+
+  node = gtk_snapshot_collect_default (snapshot, state, nodes, n_nodes);
+
+  g_clear_pointer (state->data.cached.node, gsk_render_node_unref);
+  if (node)
+    *state->data.cached.node = gsk_render_node_ref (node);
+  *state->data.cached.node_version = state->data.cached.version;
+
+  return node;
+}
+
+/**
+ * gtk_snapshot_push_cached: (skip)
+ * @snapshot: a `GtkSnapshot`
+ * @cached_node: (inout) (nullable) (transfer full): location of the
+ *   node that was recorded the last time
+ * @cached_version: (inout): location of the version of @cached_node
+ * @version: the version of the current content
+ *
+ * Reuses previously recorded content, or starts recording it again.
+ *
+ * If @cached_node holds a node that was recorded for @version, it is
+ * appended to @snapshot at the current offset and transform, and
+ * %FALSE is returned. Nothing else must be done in that case.
+ *
+ * Otherwise, %TRUE is returned, and all content until the matching
+ * call to [method@Gtk.Snapshot.pop] is recorded. The content is
+ * recorded independently of the current transform. When popping,
+ * the result is stored in @cached_node and @cached_version, so later
+ * frames can reuse it even if the offset or transform changed.
+ *
+ * Widgets can use this to avoid regenerating large subtrees,
+ * for example when they only scroll:
+ *
+ * ```c
+ * gtk_snapshot_translate (snapshot, &GRAPHENE_POINT_INIT (-self->offset, 0));
+ * if (gtk_snapshot_push_cached (snapshot, &self->node, &self->node_version, self->version))
+ *   {
+ *     draw_plot (self, snapshot);
+ *     gtk_snapshot_pop (snapshot);
+ *   }
+ * ```
+ *
+ * The widget is responsible for changing the version when its content
+ * changes, and for freeing @cached_node when it is done with it.
+ *
+ * Returns: %TRUE if the content needs to be recorded
+ *
+ * Since: 4.16
+ */
+gboolean
+gtk_snapshot_push_cached (GtkSnapshot    *snapshot,
+                          GskRenderNode **cached_node,
+                          guint64        *cached_version,
+                          guint64         version)
+{
+  GtkSnapshotState *state;
+
+  g_return_val_if_fail (snapshot != NULL, FALSE);
+  g_return_val_if_fail (cached_node != NULL, FALSE);
+  g_return_val_if_fail (cached_version != NULL, FALSE);
+
+  if (*cached_node != NULL && *cached_version == version)
+    {
+      gtk_snapshot_append_node (snapshot, *cached_node);
+      return FALSE;
+    }
+
+  /* Record in the node's own coordinates, and let the transform
+   * be applied on top of it, like it is for appended nodes.
+   */
+  gtk_snapshot_ensure_identity (snapshot);
+
+  state = gtk_snapshot_push_state (snapshot,
+                                   NULL,
+                                   gtk_snapshot_collect_cached,
+                                   NULL);
+  state->data.cached.node = cached_node;
+  state->data.cached.node_version = cached_version;
+  state->data.cached.version = version;
+
+  return TRUE;
+}
+
 /**
  * gtk_snapshot_push_repeat:
  * @snapshot: a `GtkSnapshot`
@@ -856,7 +964,7 @@ gtk_snapshot_push_repeat (GtkSnapshot           *snapshot,
   state = gtk_snapshot_push_state (snapshot,
                                    gtk_snapshot_get_current_state (snapshot)->transform,
                                    empty_child_bounds
-                                   ? gtk_snapshot_collect_discard_repeat
+                                   ? gtk_snapshot_collect_discard
                                    : gtk_snapshot_collect_repeat,
                                    NULL);
 
@@ -909,6 +1017,16 @@ gtk_snapshot_push_clip (GtkSnapshot           *snapshot,
 
   gtk_snapshot_ensure_affine (snapshot, &scale_x, &scale_y, &dx, &dy);
 
+  /* Nothing drawn inside an empty clip will ever be visible */
+  if (bounds->size.width == 0 || bounds->size.height == 0)
+    {
+      gtk_snapshot_push_state (snapshot,
+                               gtk_snapshot_get_current_state (snapshot)->transform,
+                               gtk_snapshot_collect_discard,
+                               NULL);
+      return;
+    }
+
   state = gtk_snapshot_push_state (snapshot,
                                    gtk_snapshot_get_current_state (snapshot)->transform,
                                    gtk_snapshot_collect_clip,
@@ -1144,6 +1262,15 @@ gtk_snapshot_push_rounded_clip (GtkSnapshot          *snapshot,
 
   gtk_snapshot_ensure_affine (snapshot, &scale_x, &scale_y, &dx, &dy);
 
+  if (bounds->bounds.size.width == 0 || bounds->bounds.size.height == 0)
+    {
+      gtk_snapshot_push_state (snapshot,
+                               gtk_snapshot_get_current_state (snapshot)->transform,
+                               gtk_snapshot_collect_discard,
+                               NULL);
+      return;
+    }
+
   state = gtk_snapshot_push_state (snapshot,
                                    gtk_snapshot_get_current_state (snapshot)->transform,
                                    gtk_snapshot_collect_rounded_clip,
@@ -1765,6 +1892,7 @@ gtk_snapshot_append_node_internal (GtkSnapshot   *snapshot,
 
   if (current_state)
     {
+      node = gsk_render_node_intern (node);
       gtk_snapshot_nodes_append (&snapshot->nodes, node);
       current_state->n_nodes ++;
     }
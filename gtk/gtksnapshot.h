@@ -67,6 +67,11 @@ GDK_AVAILABLE_IN_ALL
 void            gtk_snapshot_push_debug                 (GtkSnapshot            *snapshot,
                                                          const char             *message,
                                                          ...) G_GNUC_PRINTF (2, 3);
+GDK_AVAILABLE_IN_4_16
+gboolean        gtk_snapshot_push_cached                (GtkSnapshot            *snapshot,
+                                                         GskRenderNode         **cached_node,
+                                                         guint64                *cached_version,
+                                                         guint64                 version);
 GDK_AVAILABLE_IN_ALL
 void            gtk_snapshot_push_opacity               (GtkSnapshot            *snapshot,
                                                          double                  opacity);
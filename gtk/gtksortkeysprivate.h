@@ -31,6 +31,8 @@ struct _GtkSortKeys
 
   gsize key_size;
   gsize key_align; /* must be power of 2 */
+  gboolean thread_safe; /* key_compare only looks at keys and may run in any thread */
+  gboolean exact_prefix; /* get_prefix orders keys exactly like key_compare */
 };
 
 struct _GtkSortKeysClass
@@ -47,6 +49,11 @@ struct _GtkSortKeysClass
                                                                  gpointer                key_memory);
   void                  (* clear_key)                           (GtkSortKeys            *self,
                                                                  gpointer                key_memory);
+
+  /* optional: an integer that sorts like the key, for radix sorting.
+   * Keys with different prefixes must compare in the same order. */
+  guint64               (* get_prefix)                          (GtkSortKeys            *self,
+                                                                 gconstpointer           key_memory);
 };
 
 GtkSortKeys *           gtk_sort_keys_alloc                     (const GtkSortKeysClass *klass,
@@ -66,6 +73,7 @@ GCompareDataFunc        gtk_sort_keys_get_key_compare_func      (GtkSortKeys
 gboolean                gtk_sort_keys_is_compatible             (GtkSortKeys            *self,
                                                                  GtkSortKeys            *other);
 gboolean                gtk_sort_keys_needs_clear_key           (GtkSortKeys            *self);
+gboolean                gtk_sort_keys_is_thread_safe            (GtkSortKeys            *self);
 
 #define GTK_SORT_KEYS_ALIGN(_size,_align) (((_size) + (_align) - 1) & ~((_align) - 1))
 static inline int
@@ -92,4 +100,17 @@ gtk_sort_keys_clear_key (GtkSortKeys *self,
     self->klass->clear_key (self, key_memory);
 }
 
+static inline gboolean
+gtk_sort_keys_has_prefix (GtkSortKeys *self)
+{
+  return self->klass->get_prefix != NULL;
+}
+
+static inline guint64
+gtk_sort_keys_get_prefix (GtkSortKeys   *self,
+                          gconstpointer  key_memory)
+{
+  return self->klass->get_prefix (self, key_memory);
+}
+
 
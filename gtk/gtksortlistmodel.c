@@ -22,6 +22,7 @@
 #include "gtksortlistmodel.h"
 
 #include "gtkbitset.h"
+#include "gtklistmodelbatchprivate.h"
 #include "gtkmultisorter.h"
 #include "gtkprivate.h"
 #include "gtksectionmodel.h"
@@ -53,6 +54,27 @@
  */
 #define GTK_SORT_STEP_TIME_US (1000) /* 1 millisecond */
 
+/* The minimum amount of items each thread gets when sorting in parallel
+ *
+ * When sorting in one go and the sort keys can be compared in any thread,
+ * large lists are split into chunks that are sorted in worker threads.
+ * The main thread then merges the sorted chunks.
+ * Starting threads has a cost, so don't do this for small lists.
+ */
+#define GTK_SORT_PARALLEL_CHUNK_SIZE (32 * 1024)
+
+/* The maximum number of chunks when sorting in parallel */
+#define GTK_SORT_PARALLEL_MAX_CHUNKS (8)
+
+/* The minimum amount of items to radix sort
+ *
+ * When the sort keys provide integer prefixes, sorting in one go first
+ * radix sorts the items by prefix, which leaves little work for the
+ * tim sort. The passes over all items have a fixed cost, so small lists
+ * are better off with just the tim sort.
+ */
+#define GTK_SORT_RADIX_MIN_ITEMS (4 * 1024)
+
 /**
  * GtkSortListModel:
  *
@@ -107,6 +129,7 @@ struct _GtkSortListModel
   gboolean incremental;
 
   GtkTimSort sort; /* ongoing sort operation */
+  gboolean presorted; /* parallel presort changed the order */
   guint sort_cb; /* 0 or current ongoing sort callback */
 
   guint n_items;
@@ -117,6 +140,8 @@ struct _GtkSortListModel
   GtkBitset *missing_keys;
 
   gpointer *positions;
+
+  GtkListModelBatch batch;
 };
 
 struct _GtkSortListModelClass
@@ -446,7 +471,7 @@ gtk_sort_list_model_sort_cb (gpointer data)
   if (gtk_sort_list_model_sort_step (self, FALSE, &pos, &n_items))
     {
       if (n_items)
-        g_list_model_items_changed (G_LIST_MODEL (self), pos, n_items, n_items);
+        gtk_list_model_batch_items_changed (&self->batch, G_LIST_MODEL (self), NULL, pos, n_items, n_items);
       g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
       return G_SOURCE_CONTINUE;
     }
@@ -455,6 +480,26 @@ gtk_sort_list_model_sort_cb (gpointer data)
   return G_SOURCE_REMOVE;
 }
 
+static void
+gtk_sort_list_model_ensure_all_keys (GtkSortListModel *self)
+{
+  GtkBitsetIter iter;
+  guint pos;
+
+  if (gtk_bitset_is_empty (self->missing_keys))
+    return;
+
+  for (gtk_bitset_iter_init_first (&iter, self->missing_keys, &pos);
+       gtk_bitset_iter_is_valid (&iter);
+       gtk_bitset_iter_next (&iter, &pos))
+    {
+      gpointer item = g_list_model_get_item (self->model, pos);
+      gtk_sort_keys_init_key (self->sort_keys, item, key_from_pos (self, pos));
+      g_object_unref (item);
+    }
+  gtk_bitset_remove_all (self->missing_keys);
+}
+
 static int
 sort_func (gconstpointer a,
            gconstpointer b,
@@ -471,10 +516,172 @@ sort_func (gconstpointer a,
   return *sa < *sb ? -1 : 1;
 }
 
+typedef struct
+{
+  gpointer *positions;
+  gsize n_items;
+  GtkSortKeys *sort_keys;
+} GtkSortChunk;
+
+static gpointer
+gtk_sort_list_model_sort_chunk (gpointer data)
+{
+  GtkSortChunk *chunk = data;
+
+  gtk_tim_sort (chunk->positions,
+                chunk->n_items,
+                sizeof (gpointer),
+                sort_func,
+                chunk->sort_keys);
+
+  return NULL;
+}
+
+/* Sorts chunks of the positions in worker threads and stores them
+ * in @runs, so that the tim sort only needs to merge them.
+ *
+ * Only the comparisons happen in the threads, creating the keys needs
+ * the items and is done here in the main thread.
+ */
+static gboolean
+gtk_sort_list_model_presort_parallel (GtkSortListModel *self,
+                                      gsize            *runs)
+{
+  GtkSortChunk chunks[GTK_SORT_PARALLEL_MAX_CHUNKS];
+  GThread *threads[GTK_SORT_PARALLEL_MAX_CHUNKS];
+  guint i, n_chunks, chunk_size;
+
+  if (!gtk_sort_keys_is_thread_safe (self->sort_keys))
+    return FALSE;
+
+  n_chunks = MIN (self->n_items / GTK_SORT_PARALLEL_CHUNK_SIZE, g_get_num_processors ());
+  n_chunks = MIN (n_chunks, GTK_SORT_PARALLEL_MAX_CHUNKS);
+  if (n_chunks < 2)
+    return FALSE;
+
+  gtk_sort_list_model_ensure_all_keys (self);
+
+  chunk_size = self->n_items / n_chunks;
+  for (i = 0; i < n_chunks; i++)
+    {
+      chunks[i].positions = self->positions + i * chunk_size;
+      chunks[i].n_items = i + 1 < n_chunks ? chunk_size : self->n_items - i * chunk_size;
+      chunks[i].sort_keys = self->sort_keys;
+      runs[i] = chunks[i].n_items;
+    }
+  runs[n_chunks] = 0;
+
+  /* The main thread sorts the first chunk itself */
+  for (i = 1; i < n_chunks; i++)
+    threads[i] = g_thread_new ("[gtk] sort", gtk_sort_list_model_sort_chunk, &chunks[i]);
+
+  gtk_sort_list_model_sort_chunk (&chunks[0]);
+
+  for (i = 1; i < n_chunks; i++)
+    g_thread_join (threads[i]);
+
+  return TRUE;
+}
+
+/* Sorts the positions by the prefixes of their keys with a LSD radix
+ * sort, 8 bits per pass.
+ *
+ * The sort is stable and starts from the order of the keys in memory,
+ * which is the order sort_func() uses for equal keys. So if the prefixes
+ * are exact, the result is completely sorted and @runs is set to a single
+ * run. Otherwise the tim sort still has to sort items with equal prefixes,
+ * but it will find long runs.
+ */
+static gboolean
+gtk_sort_list_model_presort_radix (GtkSortListModel *self,
+                                   gsize            *runs)
+{
+  guint64 *prefixes, *tmp_prefixes;
+  gpointer *positions, *tmp_positions;
+  gsize counts[256];
+  guint i, shift;
+
+  if (self->n_items < GTK_SORT_RADIX_MIN_ITEMS ||
+      !gtk_sort_keys_has_prefix (self->sort_keys))
+    return FALSE;
+
+  gtk_sort_list_model_ensure_all_keys (self);
+
+  prefixes = g_new (guint64, self->n_items);
+  tmp_prefixes = g_new (guint64, self->n_items);
+  tmp_positions = g_new (gpointer, self->n_items);
+  positions = self->positions;
+
+  for (i = 0; i < self->n_items; i++)
+    {
+      positions[i] = key_from_pos (self, i);
+      prefixes[i] = gtk_sort_keys_get_prefix (self->sort_keys, positions[i]);
+    }
+
+  for (shift = 0; shift < 64; shift += 8)
+    {
+      gsize offset;
+      gpointer swap;
+
+      memset (counts, 0, sizeof (counts));
+      for (i = 0; i < self->n_items; i++)
+        counts[(prefixes[i] >> shift) & 0xff]++;
+
+      /* all items have the same byte here, nothing to do */
+      if (counts[(prefixes[0] >> shift) & 0xff] == self->n_items)
+        continue;
+
+      offset = 0;
+      for (i = 0; i < 256; i++)
+        {
+          gsize count = counts[i];
+          counts[i] = offset;
+          offset += count;
+        }
+
+      for (i = 0; i < self->n_items; i++)
+        {
+          gsize dest = counts[(prefixes[i] >> shift) & 0xff]++;
+
+          tmp_prefixes[dest] = prefixes[i];
+          tmp_positions[dest] = positions[i];
+        }
+
+      swap = prefixes;
+      prefixes = tmp_prefixes;
+      tmp_prefixes = swap;
+      swap = positions;
+      positions = tmp_positions;
+      tmp_positions = swap;
+    }
+
+  if (positions != self->positions)
+    {
+      memcpy (self->positions, positions, sizeof (gpointer) * self->n_items);
+      tmp_positions = positions;
+    }
+
+  g_free (prefixes);
+  g_free (tmp_prefixes);
+  g_free (tmp_positions);
+
+  if (self->sort_keys->exact_prefix)
+    {
+      runs[0] = self->n_items;
+      runs[1] = 0;
+    }
+  else
+    runs[0] = 0;
+
+  return TRUE;
+}
+
 static gboolean
 gtk_sort_list_model_start_sorting (GtkSortListModel *self,
                                    gsize            *runs)
 {
+  gsize parallel_runs[GTK_SORT_PARALLEL_MAX_CHUNKS + 1];
+
   g_assert (self->sort_cb == 0);
 
   gtk_tim_sort_init (&self->sort,
@@ -485,6 +692,16 @@ gtk_sort_list_model_start_sorting (GtkSortListModel *self,
                      self->sort_keys);
   if (runs)
     gtk_tim_sort_set_runs (&self->sort, runs);
+  else if (!self->incremental && gtk_sort_list_model_presort_radix (self, parallel_runs))
+    {
+      gtk_tim_sort_set_runs (&self->sort, parallel_runs);
+      self->presorted = TRUE;
+    }
+  else if (!self->incremental && gtk_sort_list_model_presort_parallel (self, parallel_runs))
+    {
+      gtk_tim_sort_set_runs (&self->sort, parallel_runs);
+      self->presorted = TRUE;
+    }
   if (self->incremental)
     gtk_tim_sort_set_max_merge_size (&self->sort, GTK_SORT_MAX_MERGE_SIZE);
 
@@ -507,6 +724,14 @@ gtk_sort_list_model_finish_sorting (GtkSortListModel *self,
   gtk_sort_list_model_sort_step (self, TRUE, pos, n_items);
   gtk_tim_sort_finish (&self->sort);
 
+  /* The merges don't know what changed inside the chunks */
+  if (self->presorted)
+    {
+      *pos = 0;
+      *n_items = self->n_items;
+      self->presorted = FALSE;
+    }
+
   gtk_sort_list_model_stop_sorting (self, NULL);
 }
 
@@ -750,9 +975,8 @@ gtk_sort_list_model_items_changed_cb (GListModel       *model,
   if (!gtk_sort_list_model_should_sort (self))
     {
       self->n_items = self->n_items - removed + added;
-      g_list_model_items_changed (G_LIST_MODEL (self), position, removed, added);
-      if (removed != added)
-        g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+      gtk_list_model_batch_items_changed (&self->batch, G_LIST_MODEL (self), properties[PROP_N_ITEMS],
+                                          position, removed, added);
       return;
     }
 
@@ -792,9 +1016,8 @@ gtk_sort_list_model_items_changed_cb (GListModel       *model,
     }
 
   n_items = self->n_items - start - end;
-  g_list_model_items_changed (G_LIST_MODEL (self), start, n_items - added + removed, n_items);
-  if (removed != added)
-    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+  gtk_list_model_batch_items_changed (&self->batch, G_LIST_MODEL (self), properties[PROP_N_ITEMS],
+                                      start, n_items - added + removed, n_items);
 }
 
 static void
@@ -933,13 +1156,13 @@ gtk_sort_list_model_sorter_changed (GtkSorter        *sorter,
   if (sections_changed && self->n_items > 0)
     {
       if (n_items > 0)
-        g_list_model_items_changed (G_LIST_MODEL (self), 0, self->n_items, self->n_items);
+        gtk_list_model_batch_items_changed (&self->batch, G_LIST_MODEL (self), NULL, 0, self->n_items, self->n_items);
       else
         gtk_section_model_sections_changed (GTK_SECTION_MODEL (self), 0, self->n_items);
     }
   else if (n_items > 0)
     {
-      g_list_model_items_changed (G_LIST_MODEL (self), pos, n_items, n_items);
+      gtk_list_model_batch_items_changed (&self->batch, G_LIST_MODEL (self), NULL, pos, n_items, n_items);
     }
 }
 
@@ -954,10 +1177,14 @@ gtk_sort_list_model_sorter_changed_cb (GtkSorter        *sorter,
 static void
 gtk_sort_list_model_clear_model (GtkSortListModel *self)
 {
+  guint i;
+
   if (self->model == NULL)
     return;
 
   g_signal_handlers_disconnect_by_func (self->model, gtk_sort_list_model_items_changed_cb, self);
+  for (i = 0; i < self->batch.depth; i++)
+    gtk_list_model_end_batch (self->model);
   g_clear_object (&self->model);
   gtk_sort_list_model_clear_items (self, NULL, NULL);
   self->n_items = 0;
@@ -1152,7 +1379,7 @@ void
 gtk_sort_list_model_set_model (GtkSortListModel *self,
                                GListModel       *model)
 {
-  guint removed;
+  guint removed, i;
 
   g_return_if_fail (GTK_IS_SORT_LIST_MODEL (self));
   g_return_if_fail (model == NULL || G_IS_LIST_MODEL (model));
@@ -1170,6 +1397,8 @@ gtk_sort_list_model_set_model (GtkSortListModel *self,
       self->model = g_object_ref (model);
       self->n_items = g_list_model_get_n_items (model);
       g_signal_connect (model, "items-changed", G_CALLBACK (gtk_sort_list_model_items_changed_cb), self);
+      for (i = 0; i < self->batch.depth; i++)
+        gtk_list_model_begin_batch (model);
 
       if (gtk_sort_list_model_should_sort (self))
         {
@@ -1180,9 +1409,8 @@ gtk_sort_list_model_set_model (GtkSortListModel *self,
     }
   
   if (removed > 0 || self->n_items > 0)
-    g_list_model_items_changed (G_LIST_MODEL (self), 0, removed, self->n_items);
-  if (removed != self->n_items)
-    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+    gtk_list_model_batch_items_changed (&self->batch, G_LIST_MODEL (self), properties[PROP_N_ITEMS],
+                                        0, removed, self->n_items);
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_MODEL]);
 }
@@ -1327,7 +1555,7 @@ gtk_sort_list_model_set_incremental (GtkSortListModel *self,
 
       gtk_sort_list_model_finish_sorting (self, &pos, &n_items);
       if (n_items)
-        g_list_model_items_changed (G_LIST_MODEL (self), pos, n_items, n_items);
+        gtk_list_model_batch_items_changed (&self->batch, G_LIST_MODEL (self), NULL, pos, n_items, n_items);
     }
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_INCREMENTAL]);
@@ -1400,3 +1628,124 @@ gtk_sort_list_model_get_pending (GtkSortListModel *self)
     }
 }
 
+/* Moves the item at @pos in the model to its new place in the sorted
+ * positions and returns the range of sorted positions that changed. */
+static void
+gtk_sort_list_model_resort_item (GtkSortListModel *self,
+                                 guint             pos,
+                                 guint            *out_start,
+                                 guint            *out_end)
+{
+  gpointer key, item;
+  guint from, to, min, max, mid;
+
+  key = key_from_pos (self, pos);
+  for (from = 0; self->positions[from] != key; from++)
+    g_assert (from + 1 < self->n_items);
+
+  if (gtk_sort_keys_needs_clear_key (self->sort_keys))
+    gtk_sort_keys_clear_key (self->sort_keys, key);
+  item = g_list_model_get_item (self->model, pos);
+  gtk_sort_keys_init_key (self->sort_keys, item, key);
+  g_object_unref (item);
+
+  memmove (&self->positions[from],
+           &self->positions[from + 1],
+           sizeof (gpointer) * (self->n_items - from - 1));
+
+  /* find the first position that sorts after the key, so the
+   * item stays behind equal items, like a stable sort would */
+  min = 0;
+  max = self->n_items - 1;
+  while (min < max)
+    {
+      mid = (min + max) / 2;
+      if (gtk_sort_keys_compare (self->sort_keys, key, self->positions[mid]) == GTK_ORDERING_SMALLER)
+        max = mid;
+      else
+        min = mid + 1;
+    }
+  to = min;
+
+  memmove (&self->positions[to + 1],
+           &self->positions[to],
+           sizeof (gpointer) * (self->n_items - to - 1));
+  self->positions[to] = key;
+
+  *out_start = MIN (from, to);
+  *out_end = MAX (from, to) + 1;
+}
+
+/**
+ * gtk_sort_list_model_resort_items:
+ * @self: a `GtkSortListModel`
+ * @position: the first changed position in the model being sorted
+ * @n_items: the number of changed items
+ *
+ * Tells @self that the sort keys of @n_items items starting at
+ * @position in the underlying model have changed.
+ *
+ * This is much cheaper than making the sorter emit
+ * [signal@Gtk.Sorter::changed] when only few items change, as only
+ * those items are moved to their new place. The
+ * [signal@Gio.ListModel::items-changed] signal is emitted for the
+ * range of items that moved.
+ *
+ * Since: 4.16
+ */
+void
+gtk_sort_list_model_resort_items (GtkSortListModel *self,
+                                  guint             position,
+                                  guint             n_items)
+{
+  guint i, start, end, item_start, item_end;
+
+  g_return_if_fail (GTK_IS_SORT_LIST_MODEL (self));
+  g_return_if_fail (position + n_items <= self->n_items);
+
+  if (n_items == 0 || !gtk_sort_list_model_should_sort (self))
+    return;
+
+  /* Every item costs a linear move of the positions, so for many items
+   * or while keys are still being created, handle them like a change
+   * of the model. */
+  if (gtk_sort_list_model_is_sorting (self) ||
+      !gtk_bitset_is_empty (self->missing_keys) ||
+      n_items > MAX (self->n_items / 64, 1))
+    {
+      gtk_sort_list_model_items_changed_cb (self->model, position, n_items, n_items, self);
+      return;
+    }
+
+  start = self->n_items;
+  end = 0;
+  for (i = position; i < position + n_items; i++)
+    {
+      gtk_sort_list_model_resort_item (self, i, &item_start, &item_end);
+      if (item_end - item_start > 1)
+        {
+          start = MIN (start, item_start);
+          end = MAX (end, item_end);
+        }
+    }
+
+  if (start < end)
+    gtk_list_model_batch_items_changed (&self->batch, G_LIST_MODEL (self), NULL,
+                                        start, end - start, end - start);
+}
+
+void
+gtk_sort_list_model_set_batch (GtkSortListModel *self,
+                               gboolean          begin)
+{
+  if (begin)
+    {
+      gtk_list_model_batch_begin (&self->batch);
+      gtk_list_model_begin_batch (self->model);
+    }
+  else
+    {
+      gtk_list_model_end_batch (self->model);
+      gtk_list_model_batch_end (&self->batch, G_LIST_MODEL (self), properties[PROP_N_ITEMS]);
+    }
+}
@@ -66,5 +66,10 @@ gboolean                gtk_sort_list_model_get_incremental     (GtkSortListMode
 GDK_AVAILABLE_IN_ALL
 guint                   gtk_sort_list_model_get_pending         (GtkSortListModel       *self);
 
+GDK_AVAILABLE_IN_4_16
+void                    gtk_sort_list_model_resort_items        (GtkSortListModel       *self,
+                                                                 guint                   position,
+                                                                 guint                   n_items);
+
 G_END_DECLS
 
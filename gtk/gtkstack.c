@@ -149,6 +149,8 @@ typedef struct {
   guint transition_duration;
 
   GtkStackPage *last_visible_child;
+  GskRenderNode *last_visible_node;
+  GtkStackPage *last_visible_node_page;
   guint tick_id;
   GtkProgressTracker tracker;
   gboolean first_frame_skipped;
@@ -829,6 +831,15 @@ static void stack_remove (GtkStack  *stack,
                           GtkWidget *child,
                           gboolean   in_dispose);
 
+static void
+gtk_stack_clear_last_visible_node (GtkStack *stack)
+{
+  GtkStackPrivate *priv = gtk_stack_get_instance_private (stack);
+
+  g_clear_pointer (&priv->last_visible_node, gsk_render_node_unref);
+  g_clear_object (&priv->last_visible_node_page);
+}
+
 static void
 gtk_stack_dispose (GObject *obj)
 {
@@ -840,6 +851,8 @@ gtk_stack_dispose (GObject *obj)
   while ((child = gtk_widget_get_first_child (GTK_WIDGET (stack))))
     stack_remove (stack, child, TRUE);
 
+  gtk_stack_clear_last_visible_node (stack);
+
   if (priv->pages && n_pages > 0)
     {
       g_list_model_items_changed (G_LIST_MODEL (priv->pages), 0, n_pages, 0);
@@ -1246,6 +1259,7 @@ gtk_stack_progress_updated (GtkStack *stack)
     {
       gtk_widget_set_child_visible (priv->last_visible_child->widget, FALSE);
       priv->last_visible_child = NULL;
+      gtk_stack_clear_last_visible_node (stack);
     }
 }
 
@@ -1460,6 +1474,7 @@ set_visible_child (GtkStack               *stack,
   if (priv->last_visible_child)
     gtk_widget_set_child_visible (priv->last_visible_child->widget, FALSE);
   priv->last_visible_child = NULL;
+  gtk_stack_clear_last_visible_node (stack);
 
   if (priv->visible_child && priv->visible_child->widget)
     {
@@ -2359,6 +2374,37 @@ gtk_stack_get_request_mode (GtkWidget *widget)
         GTK_SIZE_REQUEST_HEIGHT_FOR_WIDTH;
 }
 
+/* The child that is transitioned away from is only snapshot once,
+ * and its render node is reused for the rest of the transition.
+ * It isn't allocated anymore either, so pages with a lot of
+ * content don't slow down the transition.
+ */
+static void
+gtk_stack_snapshot_last_visible_child (GtkWidget   *widget,
+                                       GtkSnapshot *snapshot)
+{
+  GtkStack *stack = GTK_STACK (widget);
+  GtkStackPrivate *priv = gtk_stack_get_instance_private (stack);
+
+  if (priv->last_visible_node_page != priv->last_visible_child)
+    gtk_stack_clear_last_visible_node (stack);
+
+  if (priv->last_visible_node == NULL)
+    {
+      GtkSnapshot *child_snapshot;
+
+      child_snapshot = gtk_snapshot_new ();
+      gtk_widget_snapshot_child (widget, priv->last_visible_child->widget, child_snapshot);
+      priv->last_visible_node = gtk_snapshot_free_to_node (child_snapshot);
+      if (priv->last_visible_node == NULL)
+        return;
+
+      priv->last_visible_node_page = g_object_ref (priv->last_visible_child);
+    }
+
+  gtk_snapshot_append_node (snapshot, priv->last_visible_node);
+}
+
 static void
 gtk_stack_snapshot_crossfade (GtkWidget   *widget,
                               GtkSnapshot *snapshot)
@@ -2371,9 +2417,7 @@ gtk_stack_snapshot_crossfade (GtkWidget   *widget,
 
   if (priv->last_visible_child)
     {
-      gtk_widget_snapshot_child (widget,
-                                 priv->last_visible_child->widget,
-                                 snapshot);
+      gtk_stack_snapshot_last_visible_child (widget, snapshot);
     }
   gtk_snapshot_pop (snapshot);
 
@@ -2437,7 +2481,7 @@ gtk_stack_snapshot_under (GtkWidget   *widget,
     {
       gtk_snapshot_save (snapshot);
       gtk_snapshot_translate (snapshot, &GRAPHENE_POINT_INIT (pos_x, pos_y));
-      gtk_widget_snapshot_child (widget, priv->last_visible_child->widget, snapshot);
+      gtk_stack_snapshot_last_visible_child (widget, snapshot);
       gtk_snapshot_restore (snapshot);
     }
 }
@@ -2473,7 +2517,7 @@ gtk_stack_snapshot_cube (GtkWidget   *widget,
                                  - gtk_widget_get_height (widget) / 2.f,
                                  gtk_widget_get_width (widget) / 2.f));
       if (priv->active_transition_type == GTK_STACK_TRANSITION_TYPE_ROTATE_LEFT)
-        gtk_widget_snapshot_child (widget, priv->last_visible_child->widget, snapshot);
+        gtk_stack_snapshot_last_visible_child (widget, snapshot);
       else
         gtk_widget_snapshot_child (widget, priv->visible_child->widget, snapshot);
       gtk_snapshot_restore (snapshot);
@@ -2497,7 +2541,7 @@ gtk_stack_snapshot_cube (GtkWidget   *widget,
   if (priv->active_transition_type == GTK_STACK_TRANSITION_TYPE_ROTATE_LEFT)
     gtk_widget_snapshot_child (widget, priv->visible_child->widget, snapshot);
   else if (priv->last_visible_child)
-    gtk_widget_snapshot_child (widget, priv->last_visible_child->widget, snapshot);
+    gtk_stack_snapshot_last_visible_child (widget, snapshot);
   gtk_snapshot_restore (snapshot);
 
   if (priv->last_visible_child && progress <= 0.5)
@@ -2517,7 +2561,7 @@ gtk_stack_snapshot_cube (GtkWidget   *widget,
                                  - gtk_widget_get_height (widget) / 2.f,
                                  gtk_widget_get_width (widget) / 2.f));
       if (priv->active_transition_type == GTK_STACK_TRANSITION_TYPE_ROTATE_LEFT)
-        gtk_widget_snapshot_child (widget, priv->last_visible_child->widget, snapshot);
+        gtk_stack_snapshot_last_visible_child (widget, snapshot);
       else
         gtk_widget_snapshot_child (widget, priv->visible_child->widget, snapshot);
       gtk_snapshot_restore (snapshot);
@@ -2580,7 +2624,7 @@ gtk_stack_snapshot_slide (GtkWidget   *widget,
 
       gtk_snapshot_save (snapshot);
       gtk_snapshot_translate (snapshot, &GRAPHENE_POINT_INIT (x, y));
-      gtk_widget_snapshot_child (widget, priv->last_visible_child->widget, snapshot);
+      gtk_stack_snapshot_last_visible_child (widget, snapshot);
       gtk_snapshot_restore (snapshot);
      }
 
@@ -2663,7 +2707,7 @@ gtk_stack_size_allocate (GtkWidget *widget,
   GtkStackPrivate *priv = gtk_stack_get_instance_private (stack);
   GtkAllocation child_allocation;
 
-  if (priv->last_visible_child)
+  if (priv->last_visible_child && priv->last_visible_node == NULL)
     {
       int child_width, child_height;
       int min, nat;
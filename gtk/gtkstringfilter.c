@@ -21,6 +21,9 @@
 
 #include "gtkstringfilter.h"
 
+#include "gtkexpressionprivate.h"
+#include "gtkfilterprivate.h"
+#include "gtkstringlist.h"
 #include "gtktypebuiltins.h"
 
 /**
@@ -52,6 +55,7 @@ struct _GtkStringFilter
   GtkStringFilterMatchMode match_mode;
 
   GtkExpression *expression;
+  gboolean string_object_expression; /* expression reads GtkStringObject:string */
 };
 
 enum {
@@ -88,6 +92,108 @@ gtk_string_filter_prepare (GtkStringFilter *self,
   return result;
 }
 
+/* The strings of GtkStringObjects never change, so their prepared
+ * form can be kept on the object. There's one per case mode.
+ */
+static GQuark cache_quarks[2];
+
+static GQuark
+gtk_string_filter_get_cache_quark (GtkStringFilter *self)
+{
+  return cache_quarks[self->ignore_case ? 1 : 0];
+}
+
+/* Reading the string of a GtkStringObject is fine in any thread and
+ * doesn't need the expression machinery. Arbitrary properties and
+ * closures are neither.
+ */
+static gboolean
+gtk_string_filter_expression_is_string_object (GtkExpression *expression)
+{
+  GParamSpec *pspec;
+
+  if (expression == NULL ||
+      !G_TYPE_CHECK_INSTANCE_TYPE (expression, GTK_TYPE_PROPERTY_EXPRESSION) ||
+      gtk_property_expression_get_expression (expression) != NULL)
+    return FALSE;
+
+  pspec = gtk_property_expression_get_pspec (expression);
+
+  return pspec->owner_type == GTK_TYPE_STRING_OBJECT;
+}
+
+static gboolean
+gtk_string_filter_match_prepared (GtkStringFilter *self,
+                                  const char      *prepared)
+{
+  gboolean result;
+
+  /* strstr() and friends are vectorized in the C library already */
+  switch (self->match_mode)
+    {
+    case GTK_STRING_FILTER_MATCH_MODE_EXACT:
+      result = strcmp (prepared, self->search_prepared) == 0;
+      break;
+    case GTK_STRING_FILTER_MATCH_MODE_SUBSTRING:
+      result = strstr (prepared, self->search_prepared) != NULL;
+      break;
+    case GTK_STRING_FILTER_MATCH_MODE_PREFIX:
+      result = g_str_has_prefix (prepared, self->search_prepared);
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+
+#if 0
+  g_print ("%s %s %s\n", prepared, result ? "==" : "!=", self->search_prepared);
+#endif
+
+  return result;
+}
+
+/* Normalizing and casefolding ASCII doesn't do anything but lowercasing,
+ * so skip the expensive Unicode functions for it.
+ *
+ * Returns %FALSE if @s isn't ASCII.
+ */
+static gboolean
+gtk_string_filter_match_ascii (GtkStringFilter *self,
+                               const char      *s,
+                               gboolean        *result)
+{
+  char buffer[256];
+  char *folded;
+  gsize i, len;
+
+  for (len = 0; s[len]; len++)
+    {
+      if (s[len] & 0x80)
+        return FALSE;
+    }
+
+  if (!self->ignore_case)
+    {
+      *result = gtk_string_filter_match_prepared (self, s);
+      return TRUE;
+    }
+
+  if (len < sizeof (buffer))
+    folded = buffer;
+  else
+    folded = g_malloc (len + 1);
+
+  for (i = 0; i < len; i++)
+    folded[i] = g_ascii_tolower (s[i]);
+  folded[len] = '\0';
+
+  *result = gtk_string_filter_match_prepared (self, folded);
+
+  if (folded != buffer)
+    g_free (folded);
+
+  return TRUE;
+}
+
 /* This is necessary because code just looks at self->search otherwise
  * and that can be the empty string...
  */
@@ -97,6 +203,34 @@ gtk_string_filter_has_search (GtkStringFilter *self)
   return self->search_prepared != NULL;
 }
 
+static gboolean
+gtk_string_filter_match_string_object (GtkStringFilter *self,
+                                       GtkStringObject *item)
+{
+  const char *s, *prepared;
+  gboolean result;
+  GQuark quark;
+
+  s = gtk_string_object_get_string (item);
+  if (s == NULL || s[0] == '\0')
+    return FALSE;
+
+  if (gtk_string_filter_match_ascii (self, s, &result))
+    return result;
+
+  quark = gtk_string_filter_get_cache_quark (self);
+  prepared = g_object_get_qdata (G_OBJECT (item), quark);
+  if (prepared == NULL)
+    {
+      char *tmp = gtk_string_filter_prepare (self, s);
+
+      g_object_set_qdata_full (G_OBJECT (item), quark, tmp, g_free);
+      prepared = tmp;
+    }
+
+  return gtk_string_filter_match_prepared (self, prepared);
+}
+
 static gboolean
 gtk_string_filter_match (GtkFilter *filter,
                          gpointer   item)
@@ -110,34 +244,32 @@ gtk_string_filter_match (GtkFilter *filter,
   if (!gtk_string_filter_has_search (self))
     return TRUE;
 
-  if (self->expression == NULL ||
-      !gtk_expression_evaluate (self->expression, item, &value))
+  if (self->string_object_expression)
+    {
+      if (!GTK_IS_STRING_OBJECT (item))
+        return FALSE;
+
+      return gtk_string_filter_match_string_object (self, item);
+    }
+
+  if (self->expression == NULL)
     return FALSE;
-  s = g_value_get_string (&value);
-  prepared = gtk_string_filter_prepare (self, s);
-  if (prepared == NULL)
+  s = gtk_expression_evaluate_string (self->expression, item, &value);
+  if (s == NULL)
     return FALSE;
-
-  switch (self->match_mode)
+  if (s[0] == '\0')
     {
-    case GTK_STRING_FILTER_MATCH_MODE_EXACT:
-      result = strcmp (prepared, self->search_prepared) == 0;
-      break;
-    case GTK_STRING_FILTER_MATCH_MODE_SUBSTRING:
-      result = strstr (prepared, self->search_prepared) != NULL;
-      break;
-    case GTK_STRING_FILTER_MATCH_MODE_PREFIX:
-      result = g_str_has_prefix (prepared, self->search_prepared);
-      break;
-    default:
-      g_assert_not_reached ();
+      g_value_unset (&value);
+      return FALSE;
     }
 
-#if 0
-  g_print ("%s (%s) %s %s (%s)\n", s, prepared, result ? "==" : "!=", self->search, self->search_prepared);
-#endif
+  if (!gtk_string_filter_match_ascii (self, s, &result))
+    {
+      prepared = gtk_string_filter_prepare (self, s);
+      result = gtk_string_filter_match_prepared (self, prepared);
+      g_free (prepared);
+    }
 
-  g_free (prepared);
   g_value_unset (&value);
 
   return result;
@@ -242,6 +374,9 @@ gtk_string_filter_class_init (GtkStringFilterClass *class)
   filter_class->match = gtk_string_filter_match;
   filter_class->get_strictness = gtk_string_filter_get_strictness;
 
+  cache_quarks[0] = g_quark_from_static_string ("gtk-string-filter-normalized");
+  cache_quarks[1] = g_quark_from_static_string ("gtk-string-filter-casefolded");
+
   object_class->get_property = gtk_string_filter_get_property;
   object_class->set_property = gtk_string_filter_set_property;
   object_class->dispose = gtk_string_filter_dispose;
@@ -295,6 +430,8 @@ gtk_string_filter_init (GtkStringFilter *self)
 {
   self->ignore_case = TRUE;
   self->match_mode = GTK_STRING_FILTER_MATCH_MODE_SUBSTRING;
+
+  gtk_filter_set_thread_safe (GTK_FILTER (self), TRUE);
 }
 
 /**
@@ -361,6 +498,14 @@ gtk_string_filter_set_search (GtkStringFilter *self,
     change = GTK_FILTER_CHANGE_LESS_STRICT;
   else if (!gtk_string_filter_has_search (self))
     change = GTK_FILTER_CHANGE_MORE_STRICT;
+  else if (self->match_mode == GTK_STRING_FILTER_MATCH_MODE_EXACT)
+    change = GTK_FILTER_CHANGE_DIFFERENT;
+  else if (self->match_mode == GTK_STRING_FILTER_MATCH_MODE_SUBSTRING &&
+           strstr (search, self->search))
+    change = GTK_FILTER_CHANGE_MORE_STRICT;
+  else if (self->match_mode == GTK_STRING_FILTER_MATCH_MODE_SUBSTRING &&
+           strstr (self->search, search))
+    change = GTK_FILTER_CHANGE_LESS_STRICT;
   else if (g_str_has_prefix (search, self->search))
     change = GTK_FILTER_CHANGE_MORE_STRICT;
   else if (g_str_has_prefix (self->search, search))
@@ -418,6 +563,9 @@ gtk_string_filter_set_expression (GtkStringFilter *self,
 
   g_clear_pointer (&self->expression, gtk_expression_unref);
   self->expression = gtk_expression_ref (expression);
+  self->string_object_expression = gtk_string_filter_expression_is_string_object (expression);
+  gtk_filter_set_thread_safe (GTK_FILTER (self),
+                              expression == NULL || self->string_object_expression);
 
   if (gtk_string_filter_has_search (self))
     gtk_filter_changed (GTK_FILTER (self), GTK_FILTER_CHANGE_DIFFERENT);
@@ -69,18 +69,39 @@
  * for property bindings and expressions.
  */
 
-#define GDK_ARRAY_ELEMENT_TYPE GtkStringObject *
-#define GDK_ARRAY_NAME objects
-#define GDK_ARRAY_TYPE_NAME Objects
-#define GDK_ARRAY_FREE_FUNC g_object_unref
-#include "gdk/gdkarrayimpl.c"
-
 struct _GtkStringObject
 {
   GObject parent_instance;
   char *string;
 };
 
+/* Creating a GObject per string is expensive for large lists, so
+ * the list stores plain strings and only creates the objects the
+ * first time somebody asks for the item. The objects are kept after
+ * that, so every call returns the same object.
+ *
+ * Strings are tagged by setting the lowest bit of the pointer, which
+ * is always unset for malloc()ed memory.
+ */
+#define IS_STRING(item) (GPOINTER_TO_SIZE (item) & 1)
+#define TO_STRING(item) ((char *) (GPOINTER_TO_SIZE (item) & ~(gsize) 1))
+#define FROM_STRING(str) ((gpointer) (GPOINTER_TO_SIZE (str) | 1))
+
+static void
+free_item (gpointer item)
+{
+  if (IS_STRING (item))
+    g_free (TO_STRING (item));
+  else
+    g_object_unref (item);
+}
+
+#define GDK_ARRAY_ELEMENT_TYPE gpointer
+#define GDK_ARRAY_NAME objects
+#define GDK_ARRAY_TYPE_NAME Objects
+#define GDK_ARRAY_FREE_FUNC free_item
+#include "gdk/gdkarrayimpl.c"
+
 enum {
   PROP_STRING = 1,
   PROP_NUM_PROPERTIES
@@ -221,11 +242,16 @@ gtk_string_list_get_item (GListModel *list,
                           guint       position)
 {
   GtkStringList *self = GTK_STRING_LIST (list);
+  gpointer *item;
 
   if (position >= objects_get_size (&self->items))
     return NULL;
 
-  return g_object_ref (objects_get (&self->items, position));
+  item = objects_index (&self->items, position);
+  if (IS_STRING (*item))
+    *item = gtk_string_object_new_take (TO_STRING (*item));
+
+  return g_object_ref (*item);
 }
 
 static void
@@ -590,7 +616,7 @@ gtk_string_list_splice (GtkStringList      *self,
 
   for (i = 0; i < n_additions; i++)
     {
-      *objects_index (&self->items, position + i) = gtk_string_object_new (additions[i]);
+      *objects_index (&self->items, position + i) = FROM_STRING (g_strdup (additions[i]));
     }
 
   if (n_removals || n_additions)
@@ -616,7 +642,7 @@ gtk_string_list_append (GtkStringList *self,
 {
   g_return_if_fail (GTK_IS_STRING_LIST (self));
 
-  objects_append (&self->items, gtk_string_object_new (string));
+  objects_append (&self->items, FROM_STRING (g_strdup (string)));
 
   g_list_model_items_changed (G_LIST_MODEL (self), objects_get_size (&self->items) - 1, 0, 1);
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
@@ -643,7 +669,7 @@ gtk_string_list_take (GtkStringList *self,
 {
   g_return_if_fail (GTK_IS_STRING_LIST (self));
 
-  objects_append (&self->items, gtk_string_object_new_take (string));
+  objects_append (&self->items, FROM_STRING (string));
 
   g_list_model_items_changed (G_LIST_MODEL (self), objects_get_size (&self->items) - 1, 0, 1);
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
@@ -686,12 +712,18 @@ const char *
 gtk_string_list_get_string (GtkStringList *self,
                             guint          position)
 {
+  gpointer item;
+
   g_return_val_if_fail (GTK_IS_STRING_LIST (self), NULL);
 
   if (position >= objects_get_size (&self->items))
     return NULL;
 
-  return objects_get (&self->items, position)->string;
+  item = objects_get (&self->items, position);
+  if (IS_STRING (item))
+    return TO_STRING (item);
+
+  return ((GtkStringObject *) item)->string;
 }
 
 /* }}} */
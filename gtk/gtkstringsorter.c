@@ -21,6 +21,7 @@
 
 #include "gtkstringsorter.h"
 
+#include "gtkexpressionprivate.h"
 #include "gtksorterprivate.h"
 #include "gtktypebuiltins.h"
 
@@ -73,15 +74,9 @@ gtk_string_sorter_get_key (GtkExpression *expression,
   if (expression == NULL)
     return NULL;
 
-  if (!gtk_expression_evaluate (expression, item1, &value))
-    return NULL;
-
-  string = g_value_get_string (&value);
+  string = gtk_expression_evaluate_string (expression, item1, &value);
   if (string == NULL)
-    {
-      g_value_unset (&value);
-      return NULL;
-    }
+    return NULL;
 
   if (ignore_case)
     s = g_utf8_casefold (string, -1);
@@ -214,6 +209,29 @@ gtk_string_sort_keys_clear_key (GtkSortKeys *keys,
   g_free (*key);
 }
 
+/* The first 8 bytes of the key, in strcmp() order */
+static guint64
+gtk_string_sort_keys_get_prefix (GtkSortKeys   *keys,
+                                 gconstpointer  key_memory)
+{
+  const guchar *s = *(const guchar **) key_memory;
+  guint64 prefix;
+  guint i;
+
+  if (s == NULL)
+    return G_MAXUINT64;
+
+  prefix = 0;
+  for (i = 0; i < 8; i++)
+    {
+      prefix = (prefix << 8) | *s;
+      if (*s)
+        s++;
+    }
+
+  return prefix;
+}
+
 static const GtkSortKeysClass GTK_STRING_SORT_KEYS_CLASS =
 {
   gtk_string_sort_keys_free,
@@ -221,6 +239,7 @@ static const GtkSortKeysClass GTK_STRING_SORT_KEYS_CLASS =
   gtk_string_sort_keys_is_compatible,
   gtk_string_sort_keys_init_key,
   gtk_string_sort_keys_clear_key,
+  gtk_string_sort_keys_get_prefix,
 };
 
 static GtkSortKeys *
@@ -239,6 +258,7 @@ gtk_string_sort_keys_new (GtkStringSorter *self)
   result->expression = gtk_expression_ref (self->expression);
   result->ignore_case = self->ignore_case;
   result->collation = self->collation;
+  ((GtkSortKeys *) result)->thread_safe = TRUE;
 
   return (GtkSortKeys *) result;
 }
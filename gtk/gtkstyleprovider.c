@@ -20,6 +20,8 @@
 #include "gtksettingsprivate.h"
 #include "gtkstyleproviderprivate.h"
 
+#include "gtkcssstaticstyleprivate.h"
+#include "gtkcssstylecacheprivate.h"
 #include "gtkprivate.h"
 
 /**
@@ -124,9 +126,50 @@ gtk_style_provider_changed (GtkStyleProvider *provider)
 {
   gtk_internal_return_if_fail (GTK_IS_STYLE_PROVIDER (provider));
 
+  /* Cached styles may refer to values of this provider */
+  gtk_css_style_cache_clear ();
+  gtk_css_static_style_clear_interned_values ();
+
   g_signal_emit (provider, signals[CHANGED], 0);
 }
 
+static const GtkCssSelectorKeys *changed_keys;
+
+/*
+ * gtk_style_provider_changed_for_keys:
+ * @provider: the provider that changed
+ * @keys: keys of the selectors that changed
+ *
+ * Like gtk_style_provider_changed(), but only nodes that match one
+ * of @keys need to be restyled. Handlers of the changed signal can
+ * get @keys with gtk_style_provider_get_changed_keys().
+ */
+void
+gtk_style_provider_changed_for_keys (GtkStyleProvider         *provider,
+                                     const GtkCssSelectorKeys *keys)
+{
+  const GtkCssSelectorKeys *previous_keys = changed_keys;
+
+  changed_keys = keys;
+  gtk_style_provider_changed (provider);
+  changed_keys = previous_keys;
+}
+
+/*
+ * gtk_style_provider_get_changed_keys:
+ *
+ * Gets the keys of the changed selectors while a changed signal
+ * emitted by gtk_style_provider_changed_for_keys() is running.
+ *
+ * Returns: (nullable): the keys or %NULL if all nodes need to
+ *   be restyled
+ */
+const GtkCssSelectorKeys *
+gtk_style_provider_get_changed_keys (void)
+{
+  return changed_keys;
+}
+
 GtkSettings *
 gtk_style_provider_get_settings (GtkStyleProvider *provider)
 {
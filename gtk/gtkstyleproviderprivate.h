@@ -67,6 +67,10 @@ void                    gtk_style_provider_lookup                (GtkStyleProvid
                                                                   GtkCssChange            *out_change);
 
 void                    gtk_style_provider_changed               (GtkStyleProvider        *provider);
+void                    gtk_style_provider_changed_for_keys      (GtkStyleProvider        *provider,
+                                                                  const GtkCssSelectorKeys *keys);
+const GtkCssSelectorKeys *
+                        gtk_style_provider_get_changed_keys      (void);
 
 void                    gtk_style_provider_emit_error            (GtkStyleProvider        *provider,
                                                                   GtkCssSection           *section,
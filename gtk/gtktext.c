@@ -58,7 +58,7 @@
 #include "gtkrenderbackgroundprivate.h"
 #include "gtkrenderborderprivate.h"
 #include "gtkrenderlayoutprivate.h"
-#include "gtksettings.h"
+#include "gtksettingsprivate.h"
 #include "gtksnapshot.h"
 #include "gtktexthandleprivate.h"
 #include "gtktexthistoryprivate.h"
@@ -171,6 +171,12 @@ struct _GtkTextPrivate
   PangoAttrList  *attrs;
   PangoTabArray  *tabs;
 
+  /* The text as drawn by the last snapshot, so that redraws for
+   * the cursor blinking don't need to snapshot the layout again
+   */
+  GskRenderNode  *text_node;
+  graphene_rect_t text_node_bounds;
+
   GdkContentProvider *selection_content;
 
   char         *im_module;
@@ -219,6 +225,7 @@ struct _GtkTextPrivate
 
   guint64       blink_start_time;
   guint         blink_tick;
+  guint         blink_timeout_id;
   float         cursor_alpha;
 
   guint16       preedit_length;              /* length of preedit string, in bytes */
@@ -519,6 +526,7 @@ static PangoLayout *gtk_text_ensure_layout            (GtkText       *self,
                                                        gboolean       include_preedit);
 static void         gtk_text_reset_layout             (GtkText       *self);
 static void         gtk_text_recompute                (GtkText       *self);
+static void         gtk_text_recompute_positions      (GtkText       *self);
 static int          gtk_text_find_position            (GtkText       *self,
                                                        int            x);
 static void         gtk_text_get_cursor_locations     (GtkText       *self,
@@ -1993,6 +2001,7 @@ gtk_text_dispose (GObject *object)
       gtk_widget_remove_tick_callback (GTK_WIDGET (object), priv->blink_tick);
       priv->blink_tick = 0;
     }
+  g_clear_handle_id (&priv->blink_timeout_id, g_source_remove);
 
   if (priv->magnifier)
     _gtk_magnifier_set_inspected (GTK_MAGNIFIER (priv->magnifier), NULL);
@@ -2037,6 +2046,7 @@ gtk_text_finalize (GObject *object)
 
   g_clear_object (&priv->history);
   g_clear_object (&priv->cached_layout);
+  g_clear_pointer (&priv->text_node, gsk_render_node_unref);
   g_clear_object (&priv->im_context);
   g_free (priv->im_module);
 
@@ -3311,8 +3321,7 @@ gtk_text_focus_changed (GtkEventControllerFocus *controller,
           gtk_im_context_focus_out (priv->im_context);
         }
 
-      if (priv->blink_tick)
-        remove_blink_timeout (self);
+      remove_blink_timeout (self);
     }
 }
 
@@ -3609,9 +3618,12 @@ gtk_text_css_changed (GtkWidget         *widget,
                       GtkCssStyleChange *change)
 {
   GtkText *self = GTK_TEXT (widget);
+  GtkTextPrivate *priv = gtk_text_get_instance_private (self);
 
   GTK_WIDGET_CLASS (gtk_text_parent_class)->css_changed (widget, change);
 
+  g_clear_pointer (&priv->text_node, gsk_render_node_unref);
+
   gtk_text_update_cached_style_values (self);
 
   if (gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_TEXT |
@@ -3846,9 +3858,7 @@ get_better_cursor_x (GtkText *self,
   if (keyboard)
     direction = gdk_device_get_direction (keyboard);
 
-  g_object_get (gtk_widget_get_settings (GTK_WIDGET (self)),
-                "gtk-split-cursor", &split_cursor,
-                NULL);
+  split_cursor = gtk_settings_get_split_cursor (gtk_widget_get_settings (GTK_WIDGET (self)));
 
   pango_layout_get_cursor_pos (layout, index, &strong_pos, &weak_pos);
 
@@ -4525,7 +4535,12 @@ gtk_text_set_positions (GtkText *self,
   if (changed)
     {
       gtk_text_update_clipboard_actions (self);
-      gtk_text_recompute (self);
+
+      /* The preedit string is shown at the cursor position */
+      if (priv->preedit_length > 0)
+        gtk_text_recompute (self);
+      else
+        gtk_text_recompute_positions (self);
     }
 }
 
@@ -4539,12 +4554,24 @@ gtk_text_reset_layout (GtkText *self)
       g_object_unref (priv->cached_layout);
       priv->cached_layout = NULL;
     }
+
+  g_clear_pointer (&priv->text_node, gsk_render_node_unref);
 }
 
 static void
 gtk_text_recompute (GtkText *self)
 {
   gtk_text_reset_layout (self);
+  gtk_text_recompute_positions (self);
+}
+
+/* Like gtk_text_recompute(), but keeps the layout. This is enough
+ * when only the cursor or selection moved, and avoids reshaping
+ * long texts on every cursor movement.
+ */
+static void
+gtk_text_recompute_positions (GtkText *self)
+{
   gtk_widget_queue_draw (GTK_WIDGET (self));
 
   if (!gtk_widget_get_mapped (GTK_WIDGET (self)))
@@ -4567,7 +4594,8 @@ gtk_text_create_layout (GtkText  *self,
   char *preedit_string = NULL;
   int preedit_length = 0;
   PangoAttrList *preedit_attrs = NULL;
-  char *display_text;
+  const char *display_text;
+  char *display_text_copy = NULL;
   guint n_bytes;
 
   layout = gtk_widget_create_pango_layout (widget, NULL);
@@ -4578,9 +4606,17 @@ gtk_text_create_layout (GtkText  *self,
     tmp_attrs = pango_attr_list_new ();
   tmp_attrs = _gtk_pango_attr_list_merge (tmp_attrs, priv->attrs);
 
-  display_text = gtk_text_get_display_text (self, 0, -1);
-
-  n_bytes = strlen (display_text);
+  /* Avoid copying and walking potentially long texts twice */
+  if (priv->visible)
+    {
+      display_text = gtk_entry_buffer_get_text (get_buffer (self));
+      n_bytes = gtk_entry_buffer_get_bytes (get_buffer (self));
+    }
+  else
+    {
+      display_text = display_text_copy = gtk_text_get_display_text (self, 0, -1);
+      n_bytes = strlen (display_text);
+    }
 
   if (include_preedit)
     {
@@ -4652,7 +4688,7 @@ gtk_text_create_layout (GtkText  *self,
     pango_layout_set_tabs (layout, priv->tabs);
 
   g_free (preedit_string);
-  g_free (display_text);
+  g_free (display_text_copy);
 
   pango_attr_list_unref (preedit_attrs);
   pango_attr_list_unref (tmp_attrs);
@@ -4744,9 +4780,32 @@ gtk_text_draw_text (GtkText     *self,
   gtk_text_get_layout_offsets (self, &x, &y);
 
   gtk_css_boxes_init (&boxes, widget);
-  gtk_css_style_snapshot_layout (&boxes, snapshot, x, y, layout);
 
-  if (priv->selection_bound != priv->current_pos)
+  if (priv->selection_bound == priv->current_pos)
+    {
+      graphene_rect_t bounds;
+
+      /* Without a selection, the text only changes with the layout,
+       * the style or the scroll position, so reuse the last node
+       */
+      graphene_rect_init (&bounds, x, y, gtk_widget_get_width (widget), gtk_widget_get_height (widget));
+
+      if (priv->text_node == NULL ||
+          !graphene_rect_equal (&bounds, &priv->text_node_bounds))
+        {
+          GtkSnapshot *text_snapshot;
+
+          text_snapshot = gtk_snapshot_new ();
+          gtk_css_style_snapshot_layout (&boxes, text_snapshot, x, y, layout);
+          g_clear_pointer (&priv->text_node, gsk_render_node_unref);
+          priv->text_node = gtk_snapshot_free_to_node (text_snapshot);
+          priv->text_node_bounds = bounds;
+        }
+
+      if (priv->text_node)
+        gtk_snapshot_append_node (snapshot, priv->text_node);
+    }
+  else
     {
       const char *text = pango_layout_get_text (layout);
       int start_index = g_utf8_offset_to_pointer (text, priv->selection_bound) - text;
@@ -4756,6 +4815,8 @@ gtk_text_draw_text (GtkText     *self,
       int range[2];
       int width, height;
 
+      gtk_css_style_snapshot_layout (&boxes, snapshot, x, y, layout);
+
       width = gtk_widget_get_width (widget);
       height = gtk_widget_get_height (widget);
 
@@ -4922,7 +4983,7 @@ gtk_text_handle_drag_finished (GtkTextHandle *handle,
       guint double_click_time;
 
       settings = gtk_widget_get_settings (GTK_WIDGET (self));
-      g_object_get (settings, "gtk-double-click-time", &double_click_time, NULL);
+      double_click_time = gtk_settings_get_double_click_time (settings);
       if (g_get_monotonic_time() - priv->handle_place_time < double_click_time * 1000)
         {
           gtk_text_select_word (self);
@@ -5176,9 +5237,7 @@ gtk_text_move_visually (GtkText *self,
   index = g_utf8_offset_to_pointer (text, start) - text;
 
 
-  g_object_get (gtk_widget_get_settings (GTK_WIDGET (self)),
-                "gtk-split-cursor", &split_cursor,
-                NULL);
+  split_cursor = gtk_settings_get_split_cursor (gtk_widget_get_settings (GTK_WIDGET (self)));
 
   if (split_cursor)
     strong = TRUE;
@@ -6566,7 +6625,7 @@ cursor_blinks (GtkText *self)
       gboolean blink;
 
       settings = gtk_widget_get_settings (GTK_WIDGET (self));
-      g_object_get (settings, "gtk-cursor-blink", &blink, NULL);
+      blink = gtk_settings_get_values (settings)->cursor_blink;
 
       return blink;
     }
@@ -6581,7 +6640,7 @@ get_middle_click_paste (GtkText *self)
   gboolean paste;
 
   settings = gtk_widget_get_settings (GTK_WIDGET (self));
-  g_object_get (settings, "gtk-enable-primary-paste", &paste, NULL);
+  paste = gtk_settings_get_values (settings)->enable_primary_paste;
 
   return paste;
 }
@@ -6592,7 +6651,7 @@ get_cursor_time (GtkText *self)
   GtkSettings *settings = gtk_widget_get_settings (GTK_WIDGET (self));
   int time;
 
-  g_object_get (settings, "gtk-cursor-blink-time", &time, NULL);
+  time = gtk_settings_get_values (settings)->cursor_blink_time;
 
   return time;
 }
@@ -6603,19 +6662,24 @@ get_cursor_blink_timeout (GtkText *self)
   GtkSettings *settings = gtk_widget_get_settings (GTK_WIDGET (self));
   int timeout;
 
-  g_object_get (settings, "gtk-cursor-blink-timeout", &timeout, NULL);
+  timeout = gtk_settings_get_values (settings)->cursor_blink_timeout;
 
   return timeout;
 }
 
 typedef struct {
+  GtkText *text;
   guint64 start;
   guint64 end;
 } BlinkData;
 
-static gboolean blink_cb (GtkWidget     *widget,
-                          GdkFrameClock *clock,
-                          gpointer       user_data);
+/* Roughly one frame, in microseconds */
+#define BLINK_MIN_WAIT 16667
+
+static gboolean blink_cb         (GtkWidget     *widget,
+                                  GdkFrameClock *clock,
+                                  gpointer       user_data);
+static gboolean blink_timeout_cb (gpointer       user_data);
 
 static void
 add_blink_timeout (GtkText  *self,
@@ -6631,6 +6695,7 @@ add_blink_timeout (GtkText  *self,
   blink_time = get_cursor_time (self);
 
   data = g_new (BlinkData, 1);
+  data->text = self;
   data->start = priv->blink_start_time;
   if (delay)
     data->start += blink_time * 1000 / 2;
@@ -6652,6 +6717,7 @@ remove_blink_timeout (GtkText *self)
       gtk_widget_remove_tick_callback (GTK_WIDGET (self), priv->blink_tick);
       priv->blink_tick = 0;
     }
+  g_clear_handle_id (&priv->blink_timeout_id, g_source_remove);
 }
 
 /*
@@ -6738,9 +6804,50 @@ blink_cb (GtkWidget     *widget,
       gtk_widget_queue_draw (widget);
     }
 
+  /* While the cursor is fully visible or invisible, nothing needs
+   * to be drawn, so don't keep the frame clock running until the
+   * next fade starts
+   */
+  if (phase < 0.25 || (phase >= 0.5 && phase < 0.75))
+    {
+      double fade_start = phase < 0.25 ? 0.25 : 0.75;
+      guint64 fade_time = data->start + (guint64) (fade_start * (data->end - data->start));
+
+      if (fade_time > now + 2 * BLINK_MIN_WAIT)
+        {
+          guint64 wait = fade_time - now - BLINK_MIN_WAIT;
+
+          priv->blink_tick = 0;
+          priv->blink_timeout_id = g_timeout_add_full (G_PRIORITY_DEFAULT,
+                                                       wait / 1000,
+                                                       blink_timeout_cb,
+                                                       g_memdup2 (data, sizeof (BlinkData)),
+                                                       g_free);
+          gdk_source_set_static_name_by_id (priv->blink_timeout_id, "[gtk] blink_timeout_cb");
+
+          return G_SOURCE_REMOVE;
+        }
+    }
+
   return G_SOURCE_CONTINUE;
 }
 
+static gboolean
+blink_timeout_cb (gpointer user_data)
+{
+  BlinkData *data = user_data;
+  GtkText *self = data->text;
+  GtkTextPrivate *priv = gtk_text_get_instance_private (self);
+
+  priv->blink_timeout_id = 0;
+  priv->blink_tick = gtk_widget_add_tick_callback (GTK_WIDGET (self),
+                                                   blink_cb,
+                                                   g_memdup2 (data, sizeof (BlinkData)),
+                                                   g_free);
+
+  return G_SOURCE_REMOVE;
+}
+
 static void
 gtk_text_check_cursor_blink (GtkText *self)
 {
@@ -6748,14 +6855,11 @@ gtk_text_check_cursor_blink (GtkText *self)
 
   if (cursor_blinks (self))
     {
-      if (!priv->blink_tick)
+      if (!priv->blink_tick && !priv->blink_timeout_id)
         add_blink_timeout (self, FALSE);
     }
   else
-    {
-      if (priv->blink_tick)
-        remove_blink_timeout (self);
-    }
+    remove_blink_timeout (self);
 }
 
 static void
@@ -163,6 +163,13 @@ struct _BTreeView {
   GtkTextLayout *layout;
   BTreeView *next;
   BTreeView *prev;
+
+  /* The line found by the last _gtk_text_btree_find_line_by_y(),
+   * valid as long as y_cache_stamp == tree->heights_stamp */
+  GtkTextLine *y_cache_line;
+  int y_cache_top;
+  int y_cache_height;
+  guint y_cache_stamp;
 };
 
 /*
@@ -193,6 +200,11 @@ struct _GtkTextBTree {
    * pointed-to segment and segment offset.
    */
   guint segments_changed_stamp;
+  /* Incremented when the height of any line or node may
+   * have changed for any view, or when lines are added or
+   * removed. This invalidates the views' y caches.
+   */
+  guint heights_stamp;
 
   /* Cache the last line in the buffer */
   GtkTextLine *last_line;
@@ -209,6 +221,18 @@ struct _GtkTextBTree {
   guint end_iter_segment_stamp;
 
   GHashTable *child_anchor_table;
+
+  /* Contents of the buffer as of chars_changed_stamp */
+  GBytes *text_bytes;
+  guint text_bytes_stamp;
+
+  /* While tag redisplay is frozen, the character range that needs
+   * to be redisplayed once it is thawed, or -1 if there is none.
+   */
+  guint tag_redisplay_freeze_count;
+  int pending_redisplay_start;
+  int pending_redisplay_end;
+  guint pending_redisplay_size : 1;
 };
 
 
@@ -344,6 +368,13 @@ static inline void
 chars_changed (GtkTextBTree *tree)
 {
   tree->chars_changed_stamp += 1;
+  tree->heights_stamp += 1;
+}
+
+static inline void
+heights_changed (GtkTextBTree *tree)
+{
+  tree->heights_stamp += 1;
 }
 
 /*
@@ -406,6 +437,10 @@ _gtk_text_btree_new (GtkTextTagTable *table,
    */
   tree->chars_changed_stamp = g_random_int ();
   tree->segments_changed_stamp = g_random_int ();
+  tree->heights_stamp = 0;
+
+  tree->pending_redisplay_start = -1;
+  tree->pending_redisplay_end = -1;
 
   tree->last_line_stamp = tree->chars_changed_stamp - 1;
   tree->last_line = NULL;
@@ -512,6 +547,7 @@ _gtk_text_btree_unref (GtkTextBTree *tree)
       tree->insert_mark = NULL;
       g_object_unref (tree->selection_bound_mark);
       tree->selection_bound_mark = NULL;
+      g_clear_pointer (&tree->text_bytes, g_bytes_unref);
       tree->chars_changed_stamp = 0;
 
       g_free (tree);
@@ -1102,6 +1138,7 @@ _gtk_text_btree_insert (GtkTextIter *iter,
   int char_count_delta;                /* change to number of chars */
   GtkTextBTree *tree;
   int start_byte_index;
+  int end_byte_index;
   GtkTextLine *start_line;
 
   g_return_if_fail (text != NULL);
@@ -1139,6 +1176,7 @@ _gtk_text_btree_insert (GtkTextIter *iter,
   sol = 0;
   line_count_delta = 0;
   char_count_delta = 0;
+  end_byte_index = start_byte_index;
   while (eol < len)
     {
       sol = eol;
@@ -1160,10 +1198,13 @@ _gtk_text_btree_insert (GtkTextIter *iter,
 
       chunk_len = eol - sol;
 
-      g_assert (g_utf8_validate (&text[sol], chunk_len, NULL));
+      /* The buffer validates the whole text before inserting it */
+      if (GTK_DEBUG_CHECK (TEXT))
+        g_assert (g_utf8_validate (&text[sol], chunk_len, NULL));
       seg = _gtk_char_segment_new (&text[sol], chunk_len);
 
       char_count_delta += seg->char_count;
+      end_byte_index += chunk_len;
 
       if (cur_seg == NULL)
         {
@@ -1197,6 +1238,7 @@ _gtk_text_btree_insert (GtkTextIter *iter,
       line = newline;
       cur_seg = NULL;
       line_count_delta++;
+      end_byte_index = 0;
     }
 
   /*
@@ -1223,12 +1265,10 @@ _gtk_text_btree_insert (GtkTextIter *iter,
                                       &start,
                                       start_line,
                                       start_byte_index);
-    end = start;
-
-    /* We could almost certainly be more efficient here
-       by saving the information from the insertion loop
-       above. FIXME */
-    gtk_text_iter_forward_chars (&end, char_count_delta);
+    _gtk_text_btree_get_iter_at_line (tree,
+                                      &end,
+                                      line,
+                                      end_byte_index);
 
     DV (g_print ("invalidating due to inserting some text (%s)\n", G_STRLOC));
     _gtk_text_btree_invalidate_region (tree, &start, &end, FALSE);
@@ -1419,9 +1459,62 @@ _gtk_text_btree_find_line_by_y (GtkTextBTree *tree,
 
   last_line = get_last_line (tree);
 
+  /* Scrolling looks up the same or following lines over and over,
+   * so try the last result and its siblings before walking down
+   * the tree.
+   */
+  if (view->y_cache_line != NULL &&
+      view->y_cache_stamp == tree->heights_stamp &&
+      ypixel >= view->y_cache_top)
+    {
+      line = view->y_cache_line;
+      line_top = view->y_cache_top;
+
+      while (line != NULL && line != last_line)
+        {
+          GtkTextLineData *ld;
+          int height;
+
+          if (line == view->y_cache_line)
+            height = view->y_cache_height;
+          else
+            {
+              ld = _gtk_text_line_get_data (line, view_id);
+              height = ld ? ld->height : 0;
+            }
+
+          if (ypixel < line_top + height)
+            {
+              view->y_cache_line = line;
+              view->y_cache_top = line_top;
+              view->y_cache_height = height;
+
+              if (line_top_out)
+                *line_top_out = line_top;
+
+              return line;
+            }
+
+          line_top += height;
+          line = line->next;
+        }
+
+      line_top = 0;
+    }
+
   line = find_line_by_y (tree, view, tree->root_node, ypixel, &line_top,
                          last_line);
 
+  if (line != NULL)
+    {
+      GtkTextLineData *ld = _gtk_text_line_get_data (line, view_id);
+
+      view->y_cache_line = line;
+      view->y_cache_top = line_top;
+      view->y_cache_height = ld->height;
+      view->y_cache_stamp = tree->heights_stamp;
+    }
+
   if (line_top_out)
     *line_top_out = line_top;
 
@@ -1538,6 +1631,7 @@ _gtk_text_btree_add_view (GtkTextBTree *tree,
 
   view->view_id = layout;
   view->layout = layout;
+  view->y_cache_line = NULL;
 
   view->next = tree->views;
   view->prev = NULL;
@@ -1729,6 +1823,34 @@ queue_tag_redisplay (GtkTextBTree      *tree,
                      const GtkTextIter *start,
                      const GtkTextIter *end)
 {
+  if (tree->tag_redisplay_freeze_count > 0)
+    {
+      int start_offset, end_offset;
+
+      if (!_gtk_text_tag_affects_size (tag) &&
+          !_gtk_text_tag_affects_nonsize_appearance (tag))
+        return;
+
+      start_offset = gtk_text_iter_get_offset (start);
+      end_offset = gtk_text_iter_get_offset (end);
+
+      if (tree->pending_redisplay_start < 0)
+        {
+          tree->pending_redisplay_start = start_offset;
+          tree->pending_redisplay_end = end_offset;
+        }
+      else
+        {
+          tree->pending_redisplay_start = MIN (tree->pending_redisplay_start, start_offset);
+          tree->pending_redisplay_end = MAX (tree->pending_redisplay_end, end_offset);
+        }
+
+      if (_gtk_text_tag_affects_size (tag))
+        tree->pending_redisplay_size = TRUE;
+
+      return;
+    }
+
   if (_gtk_text_tag_affects_size (tag))
     {
       DV (g_print ("invalidating due to size-affecting tag (%s)\n", G_STRLOC));
@@ -1743,6 +1865,52 @@ queue_tag_redisplay (GtkTextBTree      *tree,
   /* We don't need to do anything if the tag doesn't affect display */
 }
 
+/*
+ * _gtk_text_btree_freeze_tag_redisplay:
+ * @tree: a `GtkTextBTree`
+ *
+ * Collects the redisplay caused by tagging into a single region until
+ * the matching _gtk_text_btree_thaw_tag_redisplay(), so that applying
+ * many tag runs only invalidates the views once.
+ */
+void
+_gtk_text_btree_freeze_tag_redisplay (GtkTextBTree *tree)
+{
+  tree->tag_redisplay_freeze_count++;
+}
+
+void
+_gtk_text_btree_thaw_tag_redisplay (GtkTextBTree *tree)
+{
+  GtkTextIter start, end;
+  int char_count;
+
+  g_return_if_fail (tree->tag_redisplay_freeze_count > 0);
+
+  tree->tag_redisplay_freeze_count--;
+
+  if (tree->tag_redisplay_freeze_count > 0 ||
+      tree->pending_redisplay_start < 0)
+    return;
+
+  /* Offsets may be out of date if a signal handler changed the text */
+  char_count = _gtk_text_btree_char_count (tree);
+
+  _gtk_text_btree_get_iter_at_char (tree, &start,
+                                    MIN (tree->pending_redisplay_start, char_count));
+  _gtk_text_btree_get_iter_at_char (tree, &end,
+                                    MIN (tree->pending_redisplay_end, char_count));
+
+  if (tree->pending_redisplay_size)
+    _gtk_text_btree_invalidate_region (tree, &start, &end, FALSE);
+  else
+    redisplay_region (tree, &start, &end, FALSE);
+
+  tree->pending_redisplay_start = -1;
+  tree->pending_redisplay_end = -1;
+  tree->pending_redisplay_size = FALSE;
+}
+
 void
 _gtk_text_btree_tag (const GtkTextIter *start_orig,
                      const GtkTextIter *end_orig,
@@ -2399,6 +2567,66 @@ copy_segment (GString *string,
     }
 }
 
+/*
+ * _gtk_text_btree_get_text_bytes:
+ * @tree: a `GtkTextBTree`
+ *
+ * Returns the whole text of @tree, including hidden text and
+ * the replacements for paintables and child anchors, like
+ * _gtk_text_btree_get_text() on the whole buffer.
+ *
+ * This walks the segments directly instead of using iters and
+ * keeps the result until the text changes. The result is immutable,
+ * so it can be passed to other threads.
+ *
+ * Returns: (transfer full): the text, not including a nul terminator
+ */
+GBytes *
+_gtk_text_btree_get_text_bytes (GtkTextBTree *tree)
+{
+  GtkTextLine *line;
+  GString *string;
+  gsize len;
+
+  if (tree->text_bytes != NULL &&
+      tree->text_bytes_stamp == tree->chars_changed_stamp)
+    return g_bytes_ref (tree->text_bytes);
+
+  g_clear_pointer (&tree->text_bytes, g_bytes_unref);
+
+  string = g_string_new (NULL);
+
+  for (line = _gtk_text_btree_get_line (tree, 0, NULL);
+       line != NULL;
+       line = _gtk_text_line_next_excluding_last (line))
+    {
+      GtkTextLineSegment *seg;
+
+      for (seg = line->segments; seg != NULL; seg = seg->next)
+        {
+          if (seg->type == &gtk_text_char_type)
+            g_string_append_len (string, seg->body.chars, seg->byte_count);
+          else if (seg->type == &gtk_text_paintable_type)
+            g_string_append_len (string, _gtk_text_unknown_char_utf8, GTK_TEXT_UNKNOWN_CHAR_UTF8_LEN);
+          else if (seg->type == &gtk_text_child_type)
+            g_string_append_len (string,
+                                 gtk_text_child_anchor_get_replacement (seg->body.child.obj),
+                                 seg->byte_count);
+        }
+    }
+
+  /* The line containing the end iter ends with a newline that
+   * is not part of the buffer */
+  g_assert (string->len > 0 && string->str[string->len - 1] == '\n');
+  g_string_truncate (string, string->len - 1);
+
+  len = string->len;
+  tree->text_bytes = g_bytes_new_take (g_string_free (string, FALSE), len);
+  tree->text_bytes_stamp = tree->chars_changed_stamp;
+
+  return g_bytes_ref (tree->text_bytes);
+}
+
 char *
 _gtk_text_btree_get_text (const GtkTextIter *start_orig,
                          const GtkTextIter *end_orig,
@@ -5262,6 +5490,7 @@ _gtk_text_btree_validate (GtkTextBTree *tree,
       gtk_text_btree_node_validate (view,
                                     tree->root_node,
                                     view_id, &state);
+      heights_changed (tree);
 
       if (y)
         *y = state.y;
@@ -5432,6 +5661,7 @@ _gtk_text_btree_validate_line (GtkTextBTree     *tree,
     {
       gtk_text_layout_wrap (view->layout, line, ld);
       gtk_text_btree_node_check_valid_upward (line->parent, view_id);
+      heights_changed (tree);
     }
 }
 
@@ -6193,6 +6423,7 @@ recompute_node_counts (GtkTextBTree *tree, GtkTextBTreeNode *node)
       gtk_text_btree_node_check_valid (node, view->view_id);
       view = view->next;
     }
+  heights_changed (tree);
 
   /*
    * Scan through the GtkTextBTreeNode’s tag records again and delete any Summary
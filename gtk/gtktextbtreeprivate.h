@@ -113,6 +113,8 @@ void _gtk_text_btree_tag (const GtkTextIter *start,
                           const GtkTextIter *end,
                           GtkTextTag        *tag,
                           gboolean           apply);
+void _gtk_text_btree_freeze_tag_redisplay (GtkTextBTree *tree);
+void _gtk_text_btree_thaw_tag_redisplay   (GtkTextBTree *tree);
 
 /* "Getters" */
 
@@ -132,6 +134,7 @@ char         *_gtk_text_btree_get_text          (const GtkTextIter *start,
                                                  const GtkTextIter *end,
                                                  gboolean           include_hidden,
                                                  gboolean           include_nonchars);
+GBytes       *_gtk_text_btree_get_text_bytes    (GtkTextBTree      *tree);
 int           _gtk_text_btree_line_count        (GtkTextBTree      *tree);
 int           _gtk_text_btree_char_count        (GtkTextBTree      *tree);
 gboolean      _gtk_text_btree_char_is_invisible (const GtkTextIter *iter);
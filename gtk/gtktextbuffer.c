@@ -300,52 +300,123 @@ gtk_text_buffer_content_new (GtkTextBuffer *buffer)
   return GDK_CONTENT_PROVIDER (content);
 }
 
+/* Text is transferred in chunks of this size, so that copying or
+ * pasting huge amounts of text does not need a second copy of all
+ * of it in memory.
+ */
+#define TEXT_PLAIN_CHUNK_SIZE (64 * 1024)
+
+typedef struct
+{
+  GInputStream *stream;
+  GtkTextBuffer *buffer;
+  char *data;
+  gsize n_pending;
+} TextPlainReader;
+
+static void
+text_plain_reader_free (gpointer data)
+{
+  TextPlainReader *reader = data;
+
+  g_object_unref (reader->stream);
+  g_free (reader->data);
+  g_free (reader);
+}
+
+static void
+text_plain_reader_read (GdkContentDeserializer *deserializer);
+
+static void
+gtk_text_buffer_deserialize_text_plain_done (GdkContentDeserializer *deserializer)
+{
+  TextPlainReader *reader = gdk_content_deserializer_get_task_data (deserializer);
+  GtkTextIter start, end;
+
+  gtk_text_buffer_get_bounds (reader->buffer, &start, &end);
+  gtk_text_buffer_select_range (reader->buffer, &start, &end);
+
+  gdk_content_deserializer_return_success (deserializer);
+}
+
 static void
 gtk_text_buffer_deserialize_text_plain_finish (GObject      *source,
                                                GAsyncResult *result,
                                                gpointer      deserializer)
 {
-  GOutputStream *stream = G_OUTPUT_STREAM (source);
-  GtkTextBuffer *buffer;
-  GtkTextIter start, end;
+  TextPlainReader *reader = gdk_content_deserializer_get_task_data (deserializer);
   GError *error = NULL;
-  gssize written;
+  GtkTextIter end;
+  const char *valid_end, *insert_end, *nul;
+  gboolean done;
+  gssize n_read;
   gsize size;
-  char *data;
 
-  written = g_output_stream_splice_finish (stream, result, &error);
-  if (written < 0)
+  n_read = g_input_stream_read_finish (G_INPUT_STREAM (source), result, &error);
+  if (n_read < 0)
     {
       gdk_content_deserializer_return_error (deserializer, error);
       return;
     }
 
-  size = g_memory_output_stream_get_size (G_MEMORY_OUTPUT_STREAM (
-                               g_filter_output_stream_get_base_stream (G_FILTER_OUTPUT_STREAM (stream))));
-  data = g_memory_output_stream_steal_data (G_MEMORY_OUTPUT_STREAM (
-                               g_filter_output_stream_get_base_stream (G_FILTER_OUTPUT_STREAM (stream))));
+  size = reader->n_pending + n_read;
+  done = n_read == 0;
 
-  if (data)
+  /* Text ends at the first nul byte */
+  nul = memchr (reader->data, '\0', size);
+  if (nul)
     {
-      if (memchr (data, '\0', size))
-        size = -1;
-      buffer = g_value_get_object (gdk_content_deserializer_get_value (deserializer));
-      gtk_text_buffer_get_end_iter (buffer, &end);
-      gtk_text_buffer_insert (buffer, &end, data, size);
-      gtk_text_buffer_get_bounds (buffer, &start, &end);
-      gtk_text_buffer_select_range (buffer, &start, &end);
-
-      g_free (data);
+      size = nul - reader->data;
+      done = TRUE;
     }
 
-  gdk_content_deserializer_return_success (deserializer);
+  /* The converter validates the text, but a character may be split
+   * across reads. Keep its start around for the next chunk. Anything
+   * else that does not validate ends the text.
+   */
+  g_utf8_validate (reader->data, size, &valid_end);
+  if (reader->data + size - valid_end > 3)
+    done = TRUE;
+
+  /* Also keep a trailing \r, so a \r\n does not become two line breaks */
+  insert_end = valid_end;
+  if (!done && insert_end > reader->data && insert_end[-1] == '\r')
+    insert_end--;
+
+  gtk_text_buffer_get_end_iter (reader->buffer, &end);
+  gtk_text_buffer_insert (reader->buffer, &end, reader->data, insert_end - reader->data);
+
+  if (done)
+    {
+      gtk_text_buffer_deserialize_text_plain_done (deserializer);
+      return;
+    }
+
+  reader->n_pending = reader->data + size - insert_end;
+  memmove (reader->data, insert_end, reader->n_pending);
+
+  text_plain_reader_read (deserializer);
+}
+
+static void
+text_plain_reader_read (GdkContentDeserializer *deserializer)
+{
+  TextPlainReader *reader = gdk_content_deserializer_get_task_data (deserializer);
+
+  g_input_stream_read_async (reader->stream,
+                             reader->data + reader->n_pending,
+                             TEXT_PLAIN_CHUNK_SIZE,
+                             gdk_content_deserializer_get_priority (deserializer),
+                             gdk_content_deserializer_get_cancellable (deserializer),
+                             gtk_text_buffer_deserialize_text_plain_finish,
+                             deserializer);
 }
 
 static void
 gtk_text_buffer_deserialize_text_plain (GdkContentDeserializer *deserializer)
 {
-  GOutputStream *output, *filter;
   GCharsetConverter *converter;
+  TextPlainReader *reader;
   GtkTextBuffer *buffer;
   GError *error = NULL;
 
@@ -362,21 +433,42 @@ gtk_text_buffer_deserialize_text_plain (GdkContentDeserializer *deserializer)
     }
   g_charset_converter_set_use_fallback (converter, TRUE);
 
-  output = g_memory_output_stream_new_resizable ();
-  filter = g_converter_output_stream_new (output, G_CONVERTER (converter));
-  g_object_unref (output);
+  reader = g_new0 (TextPlainReader, 1);
+  reader->stream = g_converter_input_stream_new (gdk_content_deserializer_get_input_stream (deserializer),
+                                                 G_CONVERTER (converter));
+  reader->buffer = buffer;
+  /* room for a \r and the start of a split character */
+  reader->data = g_malloc (TEXT_PLAIN_CHUNK_SIZE + 4);
   g_object_unref (converter);
 
-  g_output_stream_splice_async (filter,
-                                gdk_content_deserializer_get_input_stream (deserializer),
-                                G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE | G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
-                                gdk_content_deserializer_get_priority (deserializer),
-                                gdk_content_deserializer_get_cancellable (deserializer),
-                                gtk_text_buffer_deserialize_text_plain_finish,
-                                deserializer);
-  g_object_unref (filter);
+  gdk_content_deserializer_set_task_data (deserializer, reader, text_plain_reader_free);
+
+  text_plain_reader_read (deserializer);
 }
 
+typedef struct
+{
+  GtkTextBuffer *buffer;
+  GtkTextMark *position;
+  GtkTextMark *end;
+  char *chunk;
+} TextPlainWriter;
+
+static void
+text_plain_writer_free (gpointer data)
+{
+  TextPlainWriter *writer = data;
+
+  gtk_text_buffer_delete_mark (writer->buffer, writer->position);
+  gtk_text_buffer_delete_mark (writer->buffer, writer->end);
+  g_object_unref (writer->buffer);
+  g_free (writer->chunk);
+  g_free (writer);
+}
+
+static void
+text_plain_writer_write (GdkContentSerializer *serializer);
+
 static void
 gtk_text_buffer_serialize_text_plain_finish (GObject      *source,
                                              GAsyncResult *result,
@@ -388,37 +480,69 @@ gtk_text_buffer_serialize_text_plain_finish (GObject      *source,
   if (!g_output_stream_write_all_finish (stream, result, NULL, &error))
     gdk_content_serializer_return_error (serializer, error);
   else
-    gdk_content_serializer_return_success (serializer);
+    text_plain_writer_write (serializer);
 }
 
+/* Writes the text one chunk at a time. The range is kept in marks,
+ * as the buffer might change while we wait for the stream.
+ */
 static void
-gtk_text_buffer_serialize_text_plain (GdkContentSerializer *serializer)
+text_plain_writer_write (GdkContentSerializer *serializer)
 {
-  GtkTextBuffer *buffer;
-  GtkTextIter start, end;
-  char *str;
+  TextPlainWriter *writer = gdk_content_serializer_get_task_data (serializer);
+  GtkTextIter position, chunk_end, end;
 
-  buffer = g_value_get_object (gdk_content_serializer_get_value (serializer));
+  gtk_text_buffer_get_iter_at_mark (writer->buffer, &position, writer->position);
+  gtk_text_buffer_get_iter_at_mark (writer->buffer, &end, writer->end);
 
-  if (gtk_text_buffer_get_selection_bounds (buffer, &start, &end))
-    {
-      str = gtk_text_iter_get_visible_text (&start, &end);
-    }
-  else
+  if (gtk_text_iter_compare (&position, &end) >= 0)
     {
-      str = g_strdup ("");
+      gdk_content_serializer_return_success (serializer);
+      return;
     }
-  gdk_content_serializer_set_task_data (serializer, str, g_free);
+
+  chunk_end = position;
+  gtk_text_iter_forward_chars (&chunk_end, TEXT_PLAIN_CHUNK_SIZE);
+  if (gtk_text_iter_compare (&chunk_end, &end) > 0)
+    chunk_end = end;
+
+  g_free (writer->chunk);
+  writer->chunk = gtk_text_iter_get_visible_text (&position, &chunk_end);
+  gtk_text_buffer_move_mark (writer->buffer, writer->position, &chunk_end);
 
   g_output_stream_write_all_async (gdk_content_serializer_get_output_stream (serializer),
-                                   str,
-                                   strlen (str),
+                                   writer->chunk,
+                                   strlen (writer->chunk),
                                    gdk_content_serializer_get_priority (serializer),
                                    gdk_content_serializer_get_cancellable (serializer),
                                    gtk_text_buffer_serialize_text_plain_finish,
                                    serializer);
 }
 
+static void
+gtk_text_buffer_serialize_text_plain (GdkContentSerializer *serializer)
+{
+  TextPlainWriter *writer;
+  GtkTextBuffer *buffer;
+  GtkTextIter start, end;
+
+  buffer = g_value_get_object (gdk_content_serializer_get_value (serializer));
+
+  if (!gtk_text_buffer_get_selection_bounds (buffer, &start, &end))
+    {
+      gdk_content_serializer_return_success (serializer);
+      return;
+    }
+
+  writer = g_new0 (TextPlainWriter, 1);
+  writer->buffer = g_object_ref (buffer);
+  writer->position = gtk_text_buffer_create_mark (buffer, NULL, &start, TRUE);
+  writer->end = gtk_text_buffer_create_mark (buffer, NULL, &end, FALSE);
+  gdk_content_serializer_set_task_data (serializer, writer, text_plain_writer_free);
+
+  text_plain_writer_write (serializer);
+}
+
 static void
 gtk_text_buffer_register_serializers (void)
 {
@@ -1180,6 +1304,69 @@ gtk_text_buffer_set_text (GtkTextBuffer *buffer,
   gtk_text_history_end_irreversible_action (buffer->priv->history);
 }
 
+/**
+ * gtk_text_buffer_set_bytes:
+ * @buffer: a `GtkTextBuffer`
+ * @bytes: UTF-8 text to insert
+ *
+ * Deletes current contents of @buffer, and inserts the contents of
+ * @bytes instead.
+ *
+ * This is meant for loading large documents. Unlike
+ * [method@Gtk.TextBuffer.set_text], the text does not need to be
+ * nul-terminated and may be larger than %G_MAXINT bytes, so @bytes
+ * can wrap a memory-mapped file, for example from
+ * g_mapped_file_get_bytes(). The text is validated only once and
+ * the change cannot be undone.
+ *
+ * Since: 4.16
+ */
+void
+gtk_text_buffer_set_bytes (GtkTextBuffer *buffer,
+                           GBytes        *bytes)
+{
+  GtkTextIter start, end;
+  const char *data;
+  gsize size;
+
+  g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
+  g_return_if_fail (bytes != NULL);
+
+  data = g_bytes_get_data (bytes, &size);
+
+  g_return_if_fail (g_utf8_validate_len (data, size, NULL));
+
+  gtk_text_history_begin_irreversible_action (buffer->priv->history);
+
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+
+  gtk_text_buffer_delete (buffer, &start, &end);
+
+  gtk_text_buffer_get_start_iter (buffer, &start);
+  while (size > 0)
+    {
+      gsize len = MIN (size, G_MAXINT);
+
+      if (len < size)
+        {
+          /* Split at a character boundary, and not inside "\r\n" */
+          while (len > 0 && (data[len] & 0xc0) == 0x80)
+            len--;
+          if (len > 0 && data[len - 1] == '\r' && data[len] == '\n')
+            len--;
+        }
+
+      /* Skip gtk_text_buffer_insert(), we validated already.
+       * The default handler moves @start to the end of the text. */
+      g_signal_emit (buffer, signals[INSERT_TEXT], 0, &start, data, (int) len);
+
+      data += len;
+      size -= len;
+    }
+
+  gtk_text_history_end_irreversible_action (buffer->priv->history);
+}
+
 /*
  * Insertion
  */
@@ -1557,6 +1744,20 @@ insert_range_untagged (GtkTextBuffer     *buffer,
         }
       else
         {
+          GtkTextIter chunk_end = range_start;
+
+          /* Copy long runs of text in chunks, so we never hold all
+           * of it as one string. Don't split a \r\n.
+           */
+          if (gtk_text_iter_forward_chars (&chunk_end, TEXT_PLAIN_CHUNK_SIZE) &&
+              gtk_text_iter_compare (&chunk_end, &range_end) < 0)
+            {
+              if (gtk_text_iter_get_char (&chunk_end) == '\n')
+                gtk_text_iter_forward_char (&chunk_end);
+              if (gtk_text_iter_compare (&chunk_end, &range_end) < 0)
+                range_end = chunk_end;
+            }
+
           r = save_range (&range_start,
                           &range_end,
                           &end);
@@ -2241,6 +2442,34 @@ gtk_text_buffer_get_slice (GtkTextBuffer     *buffer,
     return gtk_text_iter_get_visible_slice (start, end);
 }
 
+/**
+ * gtk_text_buffer_get_bytes:
+ * @buffer: a `GtkTextBuffer`
+ *
+ * Returns a snapshot of the whole text of the buffer.
+ *
+ * The contents are the same as the result of [method@Gtk.TextBuffer.get_slice]
+ * for the whole buffer with @include_hidden_chars set to %TRUE, but
+ * without a nul terminator.
+ *
+ * The returned bytes are immutable, so unlike the buffer itself they
+ * can be read from other threads, for example to search or index the
+ * text in the background. The snapshot is kept until the text of the
+ * buffer changes, so repeated calls without changes in between don't
+ * copy the text again.
+ *
+ * Returns: (transfer full): the text of the buffer
+ *
+ * Since: 4.16
+ */
+GBytes *
+gtk_text_buffer_get_bytes (GtkTextBuffer *buffer)
+{
+  g_return_val_if_fail (GTK_IS_TEXT_BUFFER (buffer), NULL);
+
+  return _gtk_text_btree_get_text_bytes (get_btree (buffer));
+}
+
 /*
  * Pixbufs
  */
@@ -3032,6 +3261,94 @@ gtk_text_buffer_remove_tag (GtkTextBuffer     *buffer,
   gtk_text_buffer_emit_tag (buffer, tag, FALSE, start, end);
 }
 
+static void
+gtk_text_buffer_emit_tag_runs (GtkTextBuffer *buffer,
+                               GtkTextTag    *tag,
+                               gboolean       apply,
+                               const int     *offsets,
+                               gsize          n_offsets)
+{
+  GtkTextBTree *btree = get_btree (buffer);
+
+  g_object_ref (tag);
+  _gtk_text_btree_freeze_tag_redisplay (btree);
+
+  for (gsize i = 0; i + 1 < n_offsets; i += 2)
+    {
+      GtkTextIter start, end;
+
+      gtk_text_buffer_get_iter_at_offset (buffer, &start, offsets[i]);
+      gtk_text_buffer_get_iter_at_offset (buffer, &end, offsets[i + 1]);
+
+      gtk_text_buffer_emit_tag (buffer, tag, apply, &start, &end);
+    }
+
+  _gtk_text_btree_thaw_tag_redisplay (btree);
+  g_object_unref (tag);
+}
+
+/**
+ * gtk_text_buffer_apply_tag_runs:
+ * @buffer: a `GtkTextBuffer`
+ * @tag: a `GtkTextTag`
+ * @offsets: (array length=n_offsets): pairs of start and end character offsets
+ * @n_offsets: the number of elements in @offsets, which must be even
+ *
+ * Applies @tag to many ranges at once.
+ *
+ * This is equivalent to calling [method@Gtk.TextBuffer.apply_tag]
+ * for each range, and emits the “apply-tag” signal for each of them,
+ * but the views are only invalidated once, for all ranges together.
+ * This makes it a lot cheaper to apply the result of e.g. syntax
+ * highlighting.
+ *
+ * Offsets that are out of range are clamped to the end of the buffer.
+ *
+ * Since: 4.16
+ */
+void
+gtk_text_buffer_apply_tag_runs (GtkTextBuffer *buffer,
+                                GtkTextTag    *tag,
+                                const int     *offsets,
+                                gsize          n_offsets)
+{
+  g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
+  g_return_if_fail (GTK_IS_TEXT_TAG (tag));
+  g_return_if_fail (offsets != NULL || n_offsets == 0);
+  g_return_if_fail (n_offsets % 2 == 0);
+  g_return_if_fail (tag->priv->table == buffer->priv->tag_table);
+
+  gtk_text_buffer_emit_tag_runs (buffer, tag, TRUE, offsets, n_offsets);
+}
+
+/**
+ * gtk_text_buffer_remove_tag_runs:
+ * @buffer: a `GtkTextBuffer`
+ * @tag: a `GtkTextTag`
+ * @offsets: (array length=n_offsets): pairs of start and end character offsets
+ * @n_offsets: the number of elements in @offsets, which must be even
+ *
+ * Removes @tag from many ranges at once.
+ *
+ * See [method@Gtk.TextBuffer.apply_tag_runs].
+ *
+ * Since: 4.16
+ */
+void
+gtk_text_buffer_remove_tag_runs (GtkTextBuffer *buffer,
+                                 GtkTextTag    *tag,
+                                 const int     *offsets,
+                                 gsize          n_offsets)
+{
+  g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
+  g_return_if_fail (GTK_IS_TEXT_TAG (tag));
+  g_return_if_fail (offsets != NULL || n_offsets == 0);
+  g_return_if_fail (n_offsets % 2 == 0);
+  g_return_if_fail (tag->priv->table == buffer->priv->tag_table);
+
+  gtk_text_buffer_emit_tag_runs (buffer, tag, FALSE, offsets, n_offsets);
+}
+
 /**
  * gtk_text_buffer_apply_tag_by_name:
  * @buffer: a `GtkTextBuffer`
@@ -3222,6 +3539,8 @@ gtk_text_buffer_remove_all_tags (GtkTextBuffer     *buffer,
 
   g_slist_foreach (tags, (GFunc) g_object_ref, NULL);
 
+  _gtk_text_btree_freeze_tag_redisplay (get_btree (buffer));
+
   tmp_list = tags;
   while (tmp_list != NULL)
     {
@@ -3232,6 +3551,8 @@ gtk_text_buffer_remove_all_tags (GtkTextBuffer     *buffer,
       tmp_list = tmp_list->next;
     }
 
+  _gtk_text_btree_thaw_tag_redisplay (get_btree (buffer));
+
   g_slist_free_full (tags, g_object_unref);
 }
 
@@ -5133,6 +5454,50 @@ gtk_text_buffer_set_max_undo_levels (GtkTextBuffer *buffer,
   gtk_text_history_set_max_undo_levels (buffer->priv->history, max_undo_levels);
 }
 
+/**
+ * gtk_text_buffer_get_max_undo_size:
+ * @buffer: a `GtkTextBuffer`
+ *
+ * Gets the maximum amount of memory, in bytes, that the undo
+ * history may use.
+ *
+ * Returns: the maximum size of the undo history (0 indicates unlimited)
+ *
+ * Since: 4.16
+ */
+gsize
+gtk_text_buffer_get_max_undo_size (GtkTextBuffer *buffer)
+{
+  g_return_val_if_fail (GTK_IS_TEXT_BUFFER (buffer), 0);
+
+  return gtk_text_history_get_max_undo_bytes (buffer->priv->history);
+}
+
+/**
+ * gtk_text_buffer_set_max_undo_size:
+ * @buffer: a `GtkTextBuffer`
+ * @max_undo_size: the maximum size of the undo history, in bytes
+ *
+ * Sets the maximum amount of memory, in bytes, that the undo
+ * history may use.
+ *
+ * When the history grows larger than this, the oldest undo actions
+ * are discarded. The most recent action is always kept. This applies
+ * in addition to [method@Gtk.TextBuffer.set_max_undo_levels].
+ *
+ * If 0, the size of the undo history is not limited.
+ *
+ * Since: 4.16
+ */
+void
+gtk_text_buffer_set_max_undo_size (GtkTextBuffer *buffer,
+                                   gsize          max_undo_size)
+{
+  g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
+
+  gtk_text_history_set_max_undo_bytes (buffer->priv->history, max_undo_size);
+}
+
 const char *
 gtk_justification_to_string (GtkJustification just)
 {
@@ -156,6 +156,9 @@ GDK_AVAILABLE_IN_ALL
 void gtk_text_buffer_set_text          (GtkTextBuffer *buffer,
                                         const char    *text,
                                         int            len);
+GDK_AVAILABLE_IN_4_16
+void gtk_text_buffer_set_bytes         (GtkTextBuffer *buffer,
+                                        GBytes        *bytes);
 
 /* Insert into the buffer */
 GDK_AVAILABLE_IN_ALL
@@ -242,6 +245,8 @@ char           *gtk_text_buffer_get_slice           (GtkTextBuffer     *buffer,
                                                      const GtkTextIter *start,
                                                      const GtkTextIter *end,
                                                      gboolean           include_hidden_chars);
+GDK_AVAILABLE_IN_4_16
+GBytes         *gtk_text_buffer_get_bytes           (GtkTextBuffer     *buffer);
 
 /* Insert a paintable */
 GDK_AVAILABLE_IN_ALL
@@ -316,6 +321,16 @@ void gtk_text_buffer_remove_tag            (GtkTextBuffer     *buffer,
                                             GtkTextTag        *tag,
                                             const GtkTextIter *start,
                                             const GtkTextIter *end);
+GDK_AVAILABLE_IN_4_16
+void gtk_text_buffer_apply_tag_runs        (GtkTextBuffer     *buffer,
+                                            GtkTextTag        *tag,
+                                            const int         *offsets,
+                                            gsize              n_offsets);
+GDK_AVAILABLE_IN_4_16
+void gtk_text_buffer_remove_tag_runs       (GtkTextBuffer     *buffer,
+                                            GtkTextTag        *tag,
+                                            const int         *offsets,
+                                            gsize              n_offsets);
 GDK_AVAILABLE_IN_ALL
 void gtk_text_buffer_apply_tag_by_name     (GtkTextBuffer     *buffer,
                                             const char        *name,
@@ -447,6 +462,11 @@ guint           gtk_text_buffer_get_max_undo_levels       (GtkTextBuffer *buffer
 GDK_AVAILABLE_IN_ALL
 void            gtk_text_buffer_set_max_undo_levels       (GtkTextBuffer *buffer,
                                                            guint          max_undo_levels);
+GDK_AVAILABLE_IN_4_16
+gsize           gtk_text_buffer_get_max_undo_size         (GtkTextBuffer *buffer);
+GDK_AVAILABLE_IN_4_16
+void            gtk_text_buffer_set_max_undo_size         (GtkTextBuffer *buffer,
+                                                           gsize          max_undo_size);
 GDK_AVAILABLE_IN_ALL
 void            gtk_text_buffer_undo                      (GtkTextBuffer *buffer);
 GDK_AVAILABLE_IN_ALL
@@ -36,8 +36,18 @@
  * gtk_text_history_end_irreversible_action() can be used to denote a
  * section of operations that cannot be undone. This will cause all previous
  * changes tracked by the GtkTextHistory to be discarded.
+ *
+ * The history can be bounded both by the number of actions and by the
+ * memory they hold. Large texts that are identical to the text of a
+ * recent action (such as the same clipboard contents being pasted and
+ * replaced over and over) share a single copy.
  */
 
+/* Texts at least this large are looked up in recent actions for sharing */
+#define SHARE_MIN_BYTES    1024
+/* How many recent actions to look at when trying to share a text */
+#define SHARE_MAX_LOOKUPS  16
+
 typedef struct _Action     Action;
 typedef enum   _ActionKind ActionKind;
 
@@ -56,6 +66,8 @@ struct _Action
 {
   ActionKind kind;
   GList link;
+  /* Memory held by this action, including any children */
+  gsize n_bytes;
   guint is_modified : 1;
   guint is_modified_set : 1;
   union {
@@ -99,6 +111,10 @@ struct _GtkTextHistory
   guint               in_user;
   guint               max_undo_levels;
 
+  /* Sum of n_bytes of the actions in both queues */
+  gsize               n_bytes;
+  gsize               max_undo_bytes;
+
   guint               can_undo : 1;
   guint               can_redo : 1;
   guint               is_modified : 1;
@@ -288,10 +304,41 @@ action_new (ActionKind kind)
   action = g_new0 (Action, 1);
   action->kind = kind;
   action->link.data = action;
+  action->n_bytes = sizeof (Action);
 
   return action;
 }
 
+static inline IString *
+action_get_istring (Action *action)
+{
+  switch (action->kind)
+    {
+    case ACTION_KIND_INSERT:
+      return &action->u.insert.istr;
+
+    case ACTION_KIND_DELETE_BACKSPACE:
+    case ACTION_KIND_DELETE_KEY:
+    case ACTION_KIND_DELETE_PROGRAMMATIC:
+    case ACTION_KIND_DELETE_SELECTION:
+      return &action->u.delete.istr;
+
+    case ACTION_KIND_BARRIER:
+    case ACTION_KIND_GROUP:
+    default:
+      return NULL;
+    }
+}
+
+/* Updates the size of an action that holds a text, not a group */
+static inline void
+action_update_size (Action *action)
+{
+  g_assert (action_get_istring (action) != NULL);
+
+  action->n_bytes = sizeof (Action) + istring_heap_size (action_get_istring (action));
+}
+
 static void
 action_free (Action *action)
 {
@@ -369,11 +416,17 @@ action_chain (Action   *action,
        */
       if (tail != NULL && tail->kind == other->kind)
         {
+          gsize tail_bytes = tail->n_bytes;
+
           if (action_chain (tail, other, in_user_action))
-            return TRUE;
+            {
+              action->n_bytes += tail->n_bytes - tail_bytes;
+              return TRUE;
+            }
         }
 
       g_queue_push_tail_link (&action->u.group.actions, &other->link);
+      action->n_bytes += other->n_bytes;
 
       return TRUE;
     }
@@ -427,6 +480,7 @@ action_chain (Action   *action,
 
       istring_append (&action->u.insert.istr, &other->u.insert.istr);
       action->u.insert.end += other->u.insert.end - other->u.insert.begin;
+      action_update_size (action);
       action_free (other);
 
       return TRUE;
@@ -452,6 +506,7 @@ action_chain (Action   *action,
           istring_prepend (&action->u.delete.istr,
                            &other->u.delete.istr);
           action->u.delete.begin = other->u.delete.begin;
+          action_update_size (action);
           action_free (other);
           return TRUE;
         }
@@ -466,6 +521,7 @@ action_chain (Action   *action,
             {
               istring_append (&action->u.delete.istr, &other->u.delete.istr);
               action->u.delete.end += other->u.delete.istr.n_chars;
+              action_update_size (action);
               action_free (other);
               return TRUE;
             }
@@ -534,25 +590,36 @@ gtk_text_history_do_select (GtkTextHistory *self,
   self->funcs.select (self->funcs_data, selection_insert, selection_bound);
 }
 
+/* Unlinks and frees @action, which must be a toplevel action in @queue */
+static void
+gtk_text_history_drop (GtkTextHistory *self,
+                       GQueue         *queue,
+                       Action         *action)
+{
+  g_assert (self->n_bytes >= action->n_bytes);
+
+  self->n_bytes -= action->n_bytes;
+  g_queue_unlink (queue, &action->link);
+  action_free (action);
+}
+
+static void
+gtk_text_history_clear_queue (GtkTextHistory *self,
+                              GQueue         *queue)
+{
+  while (queue->length > 0)
+    gtk_text_history_drop (self, queue, g_queue_peek_head (queue));
+}
+
 static void
 gtk_text_history_truncate_one (GtkTextHistory *self)
 {
   if (self->undo_queue.length > 0)
-    {
-      Action *action = g_queue_peek_head (&self->undo_queue);
-      g_queue_unlink (&self->undo_queue, &action->link);
-      action_free (action);
-    }
+    gtk_text_history_drop (self, &self->undo_queue, g_queue_peek_head (&self->undo_queue));
   else if (self->redo_queue.length > 0)
-    {
-      Action *action = g_queue_peek_tail (&self->redo_queue);
-      g_queue_unlink (&self->redo_queue, &action->link);
-      action_free (action);
-    }
+    gtk_text_history_drop (self, &self->redo_queue, g_queue_peek_tail (&self->redo_queue));
   else
-    {
-      g_assert_not_reached ();
-    }
+    g_assert_not_reached ();
 }
 
 static void
@@ -560,11 +627,21 @@ gtk_text_history_truncate (GtkTextHistory *self)
 {
   g_assert (GTK_IS_TEXT_HISTORY (self));
 
-  if (self->max_undo_levels == 0)
-    return;
+  if (self->max_undo_levels != 0)
+    {
+      while (self->undo_queue.length + self->redo_queue.length > self->max_undo_levels)
+        gtk_text_history_truncate_one (self);
+    }
 
-  while (self->undo_queue.length + self->redo_queue.length > self->max_undo_levels)
-    gtk_text_history_truncate_one (self);
+  /* Always keep the most recent action, it may be a group that is
+   * still being filled by a user action.
+   */
+  if (self->max_undo_bytes != 0)
+    {
+      while (self->n_bytes > self->max_undo_bytes &&
+             self->undo_queue.length + self->redo_queue.length > 1)
+        gtk_text_history_truncate_one (self);
+    }
 }
 
 static void
@@ -572,8 +649,8 @@ gtk_text_history_finalize (GObject *object)
 {
   GtkTextHistory *self = (GtkTextHistory *)object;
 
-  clear_action_queue (&self->undo_queue);
-  clear_action_queue (&self->redo_queue);
+  gtk_text_history_clear_queue (self, &self->undo_queue);
+  gtk_text_history_clear_queue (self, &self->redo_queue);
 
   G_OBJECT_CLASS (gtk_text_history_parent_class)->finalize (object);
 }
@@ -650,18 +727,26 @@ gtk_text_history_push (GtkTextHistory *self,
   g_assert (self->enabled);
   g_assert (action != NULL);
 
-  while (self->redo_queue.length > 0)
-    {
-      peek = g_queue_peek_head (&self->redo_queue);
-      g_queue_unlink (&self->redo_queue, &peek->link);
-      action_free (peek);
-    }
+  gtk_text_history_clear_queue (self, &self->redo_queue);
 
   peek = g_queue_peek_tail (&self->undo_queue);
   in_user_action = self->in_user > 0;
 
-  if (peek == NULL || !action_chain (peek, action, in_user_action))
-    g_queue_push_tail_link (&self->undo_queue, &action->link);
+  if (peek != NULL)
+    {
+      gsize peek_bytes = peek->n_bytes;
+
+      if (action_chain (peek, action, in_user_action))
+        {
+          self->n_bytes += peek->n_bytes - peek_bytes;
+          goto chained;
+        }
+    }
+
+  g_queue_push_tail_link (&self->undo_queue, &action->link);
+  self->n_bytes += action->n_bytes;
+
+chained:
 
   gtk_text_history_truncate (self);
   gtk_text_history_update_state (self);
@@ -951,7 +1036,7 @@ gtk_text_history_end_user_action (GtkTextHistory *self)
   return_if_applying (self);
   return_if_irreversible (self);
 
-  clear_action_queue (&self->redo_queue);
+  gtk_text_history_clear_queue (self, &self->redo_queue);
 
   peek = g_queue_peek_tail (&self->undo_queue);
 
@@ -973,8 +1058,7 @@ gtk_text_history_end_user_action (GtkTextHistory *self)
   /* Unlikely, but if the group is empty, just remove it */
   if (action_group_is_empty (peek))
     {
-      g_queue_unlink (&self->undo_queue, &peek->link);
-      action_free (peek);
+      gtk_text_history_drop (self, &self->undo_queue, peek);
       goto update_state;
     }
 
@@ -990,8 +1074,7 @@ gtk_text_history_end_user_action (GtkTextHistory *self)
       replaced->is_modified_set = peek->is_modified_set;
 
       g_queue_unlink (&peek->u.group.actions, link_);
-      g_queue_unlink (&self->undo_queue, &peek->link);
-      action_free (peek);
+      gtk_text_history_drop (self, &self->undo_queue, peek);
 
       gtk_text_history_push (self, replaced);
 
@@ -1023,8 +1106,8 @@ gtk_text_history_begin_irreversible_action (GtkTextHistory *self)
 
   self->irreversible++;
 
-  clear_action_queue (&self->undo_queue);
-  clear_action_queue (&self->redo_queue);
+  gtk_text_history_clear_queue (self, &self->undo_queue);
+  gtk_text_history_clear_queue (self, &self->redo_queue);
 
   gtk_text_history_update_state (self);
 }
@@ -1045,8 +1128,8 @@ gtk_text_history_end_irreversible_action (GtkTextHistory *self)
 
   self->irreversible--;
 
-  clear_action_queue (&self->undo_queue);
-  clear_action_queue (&self->redo_queue);
+  gtk_text_history_clear_queue (self, &self->undo_queue);
+  gtk_text_history_clear_queue (self, &self->redo_queue);
 
   gtk_text_history_update_state (self);
 }
@@ -1134,6 +1217,69 @@ gtk_text_history_selection_changed (GtkTextHistory *self,
   self->selection.bound = CLAMP (selection_bound, -1, G_MAXINT);
 }
 
+static IString *
+find_shared_in_queue (const GQueue *queue,
+                      const char   *text,
+                      guint         len,
+                      guint        *n_lookups)
+{
+  for (const GList *iter = queue->tail; iter && *n_lookups < SHARE_MAX_LOOKUPS; iter = iter->prev)
+    {
+      Action *action = iter->data;
+      IString *istr;
+
+      if (action->kind == ACTION_KIND_GROUP)
+        {
+          istr = find_shared_in_queue (&action->u.group.actions, text, len, n_lookups);
+          if (istr != NULL)
+            return istr;
+          continue;
+        }
+
+      if (!(istr = action_get_istring (action)))
+        continue;
+
+      (*n_lookups)++;
+
+      if (istr->n_bytes == len && memcmp (istring_str (istr), text, len) == 0)
+        return istr;
+    }
+
+  return NULL;
+}
+
+/*
+ * Sets @istr to @text, sharing the string of a recent action if it
+ * holds the same large text. This happens a lot when the same text
+ * gets pasted repeatedly, or when text that was just inserted gets
+ * replaced again.
+ */
+static void
+gtk_text_history_set_istring (GtkTextHistory *self,
+                              IString        *istr,
+                              const char     *text,
+                              guint           len,
+                              guint           n_chars)
+{
+  if (len >= SHARE_MIN_BYTES)
+    {
+      IString *shared;
+      guint n_lookups = 0;
+
+      shared = find_shared_in_queue (&self->undo_queue, text, len, &n_lookups);
+      if (shared == NULL)
+        shared = find_shared_in_queue (&self->redo_queue, text, len, &n_lookups);
+
+      if (shared != NULL)
+        {
+          istring_set_shared (istr, shared);
+          return;
+        }
+    }
+
+  istring_set (istr, text, len, n_chars);
+}
+
 void
 gtk_text_history_text_inserted (GtkTextHistory *self,
                                 guint           position,
@@ -1156,7 +1302,8 @@ gtk_text_history_text_inserted (GtkTextHistory *self,
   action = action_new (ACTION_KIND_INSERT);
   action->u.insert.begin = position;
   action->u.insert.end = position + n_chars;
-  istring_set (&action->u.insert.istr, text, len, n_chars);
+  gtk_text_history_set_istring (self, &action->u.insert.istr, text, len, n_chars);
+  action_update_size (action);
 
   gtk_text_history_push (self, action);
 }
@@ -1194,7 +1341,8 @@ gtk_text_history_text_deleted (GtkTextHistory *self,
   action->u.delete.end = end;
   action->u.delete.selection.insert = self->selection.insert;
   action->u.delete.selection.bound = self->selection.bound;
-  istring_set (&action->u.delete.istr, text, len, ABS (end - begin));
+  gtk_text_history_set_istring (self, &action->u.delete.istr, text, len, ABS (end - begin));
+  action_update_size (action);
 
   gtk_text_history_push (self, action);
 }
@@ -1223,8 +1371,8 @@ gtk_text_history_set_enabled (GtkTextHistory *self,
         {
           self->irreversible = 0;
           self->in_user = 0;
-          clear_action_queue (&self->undo_queue);
-          clear_action_queue (&self->redo_queue);
+          gtk_text_history_clear_queue (self, &self->undo_queue);
+          gtk_text_history_clear_queue (self, &self->redo_queue);
         }
 
       gtk_text_history_update_state (self);
@@ -1251,3 +1399,33 @@ gtk_text_history_set_max_undo_levels (GtkTextHistory *self,
       gtk_text_history_truncate (self);
     }
 }
+
+gsize
+gtk_text_history_get_max_undo_bytes (GtkTextHistory *self)
+{
+  g_return_val_if_fail (GTK_IS_TEXT_HISTORY (self), 0);
+
+  return self->max_undo_bytes;
+}
+
+void
+gtk_text_history_set_max_undo_bytes (GtkTextHistory *self,
+                                     gsize           max_undo_bytes)
+{
+  g_return_if_fail (GTK_IS_TEXT_HISTORY (self));
+
+  if (self->max_undo_bytes != max_undo_bytes)
+    {
+      self->max_undo_bytes = max_undo_bytes;
+      gtk_text_history_truncate (self);
+      gtk_text_history_update_state (self);
+    }
+}
+
+gsize
+gtk_text_history_get_n_bytes (GtkTextHistory *self)
+{
+  g_return_val_if_fail (GTK_IS_TEXT_HISTORY (self), 0);
+
+  return self->n_bytes;
+}
@@ -1053,6 +1053,73 @@ gtk_text_layout_validate (GtkTextLayout *layout,
     }
 }
 
+/* Number of pixels validated between checks of the clock */
+#define VALIDATE_CHUNK_PIXELS 2000
+
+/**
+ * gtk_text_layout_validate_until:
+ * @layout: a `GtkTextLayout`
+ * @end_time: monotonic time at which to stop validating
+ *
+ * Validates regions of a `GtkTextLayout` until the layout is valid
+ * or @end_time has passed.
+ *
+ * Unlike gtk_text_layout_validate(), ::changed is emitted only
+ * once, for the range spanning all validated regions. The btree
+ * validates regions in buffer order, so the range is contiguous
+ * and its total height change is the sum of the individual changes.
+ *
+ * Returns: %TRUE if the layout is valid
+ **/
+gboolean
+gtk_text_layout_validate_until (GtkTextLayout *layout,
+                                gint64         end_time)
+{
+  GtkTextBTree *btree;
+  int y, old_height, new_height;
+  int first_y = -1, last_end = 0, delta = 0;
+  int max_pixels = VALIDATE_CHUNK_PIXELS;
+  gboolean valid = FALSE;
+
+  g_return_val_if_fail (GTK_IS_TEXT_LAYOUT (layout), TRUE);
+
+  btree = _gtk_text_buffer_get_btree (layout->buffer);
+  while (TRUE)
+    {
+      if (!_gtk_text_btree_validate (btree,
+                                     layout, max_pixels,
+                                     &y, &old_height, &new_height))
+        {
+          valid = TRUE;
+          break;
+        }
+
+      if (first_y < 0)
+        first_y = y;
+      last_end = y + new_height;
+      delta += new_height - old_height;
+
+      max_pixels -= new_height;
+      if (max_pixels <= 0)
+        {
+          if (g_get_monotonic_time () >= end_time)
+            break;
+          max_pixels = VALIDATE_CHUNK_PIXELS;
+        }
+    }
+
+  if (first_y >= 0)
+    {
+      update_layout_size (layout);
+      gtk_text_layout_emit_changed (layout,
+                                    first_y,
+                                    last_end - delta - first_y,
+                                    last_end - first_y);
+    }
+
+  return valid;
+}
+
 GtkTextLineData *
 gtk_text_layout_wrap (GtkTextLayout   *layout,
                       GtkTextLine     *line,
@@ -2246,12 +2313,14 @@ gtk_text_layout_update_display_cursors (GtkTextLayout      *layout,
 }
 
 /* Add the tag to the array if it's not there already, and remove
- * it otherwise. It keeps the array sorted by tags priority. */
+ * it otherwise. It keeps the array sorted by tags priority, and
+ * priorities are unique within a tag table, so the position can be
+ * found with a binary search. */
 static GPtrArray *
 tags_array_toggle_tag (GPtrArray  *array,
 		       GtkTextTag *tag)
 {
-  int pos;
+  int pos, end;
   GtkTextTag **tags;
 
   if (array == NULL)
@@ -2259,7 +2328,17 @@ tags_array_toggle_tag (GPtrArray  *array,
 
   tags = (GtkTextTag**) array->pdata;
 
-  for (pos = 0; pos < array->len && tags[pos]->priv->priority < tag->priv->priority; pos++) ;
+  pos = 0;
+  end = array->len;
+  while (pos < end)
+    {
+      int mid = pos + (end - pos) / 2;
+
+      if (tags[mid]->priv->priority < tag->priv->priority)
+        pos = mid + 1;
+      else
+        end = mid;
+    }
 
   if (pos < array->len && tags[pos] == tag)
     g_ptr_array_remove_index (array, pos);
@@ -2275,6 +2354,29 @@ tags_array_toggle_tag (GPtrArray  *array,
   return array;
 }
 
+/* A rough estimate of what a display keeps alive: the text, the
+ * attributes for each run, and the glyphs and log attrs that pango
+ * computes per character once the layout has been measured.
+ */
+static gsize
+estimate_display_size (GtkTextLineDisplay *display,
+                       int                 n_bytes,
+                       int                 n_runs)
+{
+  gsize size;
+  int n_chars;
+
+  n_chars = pango_layout_get_character_count (display->layout);
+
+  size = sizeof (GtkTextLineDisplay);
+  size += n_bytes;
+  size += (gsize) n_runs * 8 * sizeof (PangoAttrInt);
+  size += (gsize) n_chars * (sizeof (PangoGlyphInfo) + sizeof (int) + sizeof (PangoLogAttr));
+  size += (gsize) pango_layout_get_line_count (display->layout) * sizeof (PangoLayoutLine);
+
+  return size;
+}
+
 GtkTextLineDisplay *
 gtk_text_layout_create_display (GtkTextLayout *layout,
                                 GtkTextLine   *line,
@@ -2304,6 +2406,7 @@ gtk_text_layout_create_display (GtkTextLayout *layout,
   PangoAttribute *last_scale_attr = NULL;
   PangoAttribute *last_fallback_attr = NULL;
   GtkTextBTree *btree;
+  int n_runs = 0;
 
   g_return_val_if_fail (line != NULL, NULL);
 
@@ -2425,6 +2528,7 @@ gtk_text_layout_create_display (GtkTextLayout *layout,
                     }
 
                   seg = prev_seg; /* Back up one */
+                  n_runs++;
                   add_generic_attrs (layout, &style->appearance,
                                      bytes,
                                      attrs, layout_byte_offset - bytes,
@@ -2437,6 +2541,7 @@ gtk_text_layout_create_display (GtkTextLayout *layout,
                 }
               else if (seg->type == &gtk_text_paintable_type)
                 {
+                  n_runs++;
                   add_generic_attrs (layout,
                                      &style->appearance,
                                      seg->byte_count,
@@ -2451,6 +2556,7 @@ gtk_text_layout_create_display (GtkTextLayout *layout,
               else if (seg->type == &gtk_text_child_type)
                 {
                   saw_widget = TRUE;
+                  n_runs++;
 
                   add_generic_attrs (layout, &style->appearance,
                                      seg->byte_count,
@@ -2621,6 +2727,7 @@ gtk_text_layout_create_display (GtkTextLayout *layout,
     g_ptr_array_free (tags, TRUE);
 
   display->has_children = saw_widget;
+  display->mem_size = estimate_display_size (display, layout_byte_offset, n_runs);
 
   if (saw_widget)
     allocate_child_widgets (layout, display);
@@ -4171,6 +4278,8 @@ gtk_text_layout_snapshot (GtkTextLayout      *layout,
       draw_selection_text = FALSE;
     }
 
+  gtk_text_line_display_cache_begin_frame (priv->cache);
+
   gtk_text_layout_wrap_loop_start (layout);
 
   for (GtkTextLine *line = first_line;
@@ -4223,9 +4332,15 @@ gtk_text_layout_snapshot (GtkTextLayout      *layout,
                 selection_end_index = -1;
             }
 
+          /* The node only needs to be recreated if the selection on this
+           * line changed, or if it contains a (blinking) block cursor.
+           */
           if (line_display->node != NULL)
             {
-              if (line_display->has_block_cursor && gtk_widget_has_focus (widget))
+              if (line_display->node_has_block_cursor ||
+                  (line_display->has_block_cursor && gtk_widget_has_focus (widget)) ||
+                  line_display->node_selection_start != selection_start_index ||
+                  line_display->node_selection_end != selection_end_index)
                 g_clear_pointer (&line_display->node, gsk_render_node_unref);
             }
 
@@ -4241,6 +4356,10 @@ gtk_text_layout_snapshot (GtkTextLayout      *layout,
                            draw_selection_text,
                            cursor_alpha);
               line_display->node = gtk_snapshot_pop_collect (snapshot);
+              line_display->node_selection_start = selection_start_index;
+              line_display->node_selection_end = selection_end_index;
+              line_display->node_has_block_cursor = line_display->has_block_cursor &&
+                                                    gtk_widget_has_focus (widget);
             }
 
           if (line_display->node != NULL)
@@ -4342,3 +4461,12 @@ gtk_text_layout_set_mru_size (GtkTextLayout *layout,
 
   gtk_text_line_display_cache_set_mru_size (priv->cache, mru_size);
 }
+
+void
+gtk_text_layout_get_cache_stats (GtkTextLayout                *layout,
+                                 GtkTextLineDisplayCacheStats *stats)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  gtk_text_line_display_cache_get_stats (priv->cache, stats);
+}
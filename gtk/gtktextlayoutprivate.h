@@ -98,6 +98,7 @@ typedef struct _GtkTextLineData GtkTextLineData;
 typedef struct _GtkTextLayout         GtkTextLayout;
 typedef struct _GtkTextLayoutClass    GtkTextLayoutClass;
 typedef struct _GtkTextLineDisplay    GtkTextLineDisplay;
+typedef struct _GtkTextLineDisplayCacheStats GtkTextLineDisplayCacheStats;
 typedef struct _GtkTextAttrAppearance GtkTextAttrAppearance;
 
 struct _GtkTextLayout
@@ -204,18 +205,38 @@ struct _GtkTextLineDisplay
 
   GtkTextLine *line;
 
+  /* Estimated memory held by @layout, used for the cache budget */
+  gsize mem_size;
+  /* Last snapshot generation of the cache in which this was used */
+  guint cache_generation;
+
   GdkRectangle block_cursor;
 
+  /* Selection byte range that @node was rendered with */
+  int node_selection_start;
+  int node_selection_end;
+
   guint cursors_invalid : 1;
   guint has_block_cursor : 1;
   guint cursor_at_line_end : 1;
   guint size_only : 1;
   guint pg_bg_rgba_set : 1;
   guint has_children : 1;
+  guint node_has_block_cursor : 1;
 
   GdkRGBA pg_bg_rgba;
 };
 
+struct _GtkTextLineDisplayCacheStats
+{
+  guint64 hits;
+  guint64 misses;
+  guint64 evictions;
+  guint n_lines;
+  gsize mem_used;
+  gsize mem_budget;
+};
+
 #ifdef GTK_COMPILATION
 extern G_GNUC_INTERNAL PangoAttrType gtk_text_attr_appearance_type;
 #endif
@@ -298,6 +319,8 @@ void     gtk_text_layout_validate_yrange (GtkTextLayout *layout,
                                           int            y1_);
 void     gtk_text_layout_validate        (GtkTextLayout *layout,
                                           int            max_pixels);
+gboolean gtk_text_layout_validate_until  (GtkTextLayout *layout,
+                                          gint64         end_time);
 
 GtkTextLineData* gtk_text_layout_wrap  (GtkTextLayout   *layout,
                                         GtkTextLine     *line,
@@ -380,6 +403,8 @@ void gtk_text_layout_snapshot (GtkTextLayout        *layout,
 
 void gtk_text_layout_set_mru_size (GtkTextLayout *layout,
                                    guint          mru_size);
+void gtk_text_layout_get_cache_stats (GtkTextLayout                *layout,
+                                      GtkTextLineDisplayCacheStats *stats);
 
 G_END_DECLS
 
@@ -26,6 +26,7 @@
 #include "gtkprivate.h"
 
 #define DEFAULT_MRU_SIZE         250
+#define DEFAULT_MEMORY_BUDGET    (8 * 1024 * 1024)
 #define BLOW_CACHE_TIMEOUT_SEC   20
 #define DEBUG_LINE_DISPLAY_CACHE 0
 
@@ -38,10 +39,21 @@ struct _GtkTextLineDisplayCache
   GSource     *evict_source;
   guint        mru_size;
 
+  /* Sum of the mem_size of all cached displays */
+  gsize        mem_used;
+  gsize        mem_budget;
+
+  /* Displays used since the last snapshot started are "hot": they
+   * are on screen and are never culled for the memory budget.
+   */
+  guint        generation;
+
+  guint64      hits;
+  guint64      misses;
+  guint64      evictions;
+
 #if DEBUG_LINE_DISPLAY_CACHE
   guint       log_source;
-  int         hits;
-  int         misses;
   int         inval;
   int         inval_cursors;
   int         inval_by_line;
@@ -60,7 +72,7 @@ static gboolean
 dump_stats (gpointer data)
 {
   GtkTextLineDisplayCache *cache = data;
-  g_printerr ("%p: size=%u hits=%d misses=%d inval_total=%d "
+  g_printerr ("%p: size=%u hits=%"G_GUINT64_FORMAT" misses=%"G_GUINT64_FORMAT" inval_total=%d "
               "inval_cursors=%d inval_by_line=%d "
               "inval_by_range=%d inval_by_y_range=%d\n",
               cache, g_hash_table_size (cache->line_to_display),
@@ -84,6 +96,7 @@ gtk_text_line_display_cache_new (void)
   ret->sorted_by_line = g_sequence_new (NULL);
   ret->line_to_display = g_hash_table_new (NULL, NULL);
   ret->mru_size = DEFAULT_MRU_SIZE;
+  ret->mem_budget = DEFAULT_MEMORY_BUDGET;
 
 #if DEBUG_LINE_DISPLAY_CACHE
   ret->log_source = g_timeout_add_seconds (1, dump_stats, ret);
@@ -122,6 +135,7 @@ gtk_text_line_display_cache_blow_cb (gpointer data)
 
   cache->evict_source = NULL;
 
+  cache->evictions += g_hash_table_size (cache->line_to_display);
   gtk_text_line_display_cache_invalidate (cache);
 
   return G_SOURCE_REMOVE;
@@ -206,13 +220,23 @@ gtk_text_line_display_cache_take_display (GtkTextLineDisplayCache *cache,
                               layout);
   g_hash_table_insert (cache->line_to_display, display->line, display);
   g_queue_push_head_link (&cache->mru, &display->mru_link);
+  display->cache_generation = cache->generation;
+  cache->mem_used += display->mem_size;
 
-  /* Cull the cache if we're at capacity */
-  while (cache->mru.length > cache->mru_size)
+  /* Cull the cache if we're at capacity. Since the MRU is ordered by
+   * use, once the tail is hot everything in front of it is hot too.
+   */
+  while (cache->mru.length > cache->mru_size ||
+         cache->mem_used > cache->mem_budget)
     {
       display = g_queue_peek_tail (&cache->mru);
 
+      if (cache->mru.length <= cache->mru_size &&
+          display->cache_generation == cache->generation)
+        break;
+
       gtk_text_line_display_cache_invalidate_display (cache, display, FALSE);
+      cache->evictions++;
     }
 }
 
@@ -264,8 +288,10 @@ gtk_text_line_display_cache_invalidate_display (GtkTextLineDisplayCache *cache,
 
   if (cursors_only)
     {
+      /* Cursors are drawn on top of the cached node, and a selection
+       * change is detected when snapshotting, so the node can stay.
+       */
       g_clear_pointer (&display->cursors, g_array_unref);
-      g_clear_pointer (&display->node, gsk_render_node_unref);
       display->cursors_invalid = TRUE;
       display->has_block_cursor = FALSE;
     }
@@ -281,6 +307,9 @@ gtk_text_line_display_cache_invalidate_display (GtkTextLineDisplayCache *cache,
 
       if (iter != NULL)
         {
+          g_assert (cache->mem_used >= display->mem_size);
+          cache->mem_used -= display->mem_size;
+
           g_sequence_remove (iter);
 
           g_queue_push_head_link (&purge_in_idle, &display->mru_link);
@@ -341,7 +370,8 @@ gtk_text_line_display_cache_get (GtkTextLineDisplayCache *cache,
     {
       if (size_only || !display->size_only)
         {
-          STAT_INC (cache->hits);
+          cache->hits++;
+          display->cache_generation = cache->generation;
 
           if (!size_only && display->line == cache->cursor_line)
             gtk_text_layout_update_display_cursors (layout, display->line, display);
@@ -363,7 +393,7 @@ gtk_text_line_display_cache_get (GtkTextLineDisplayCache *cache,
       gtk_text_line_display_cache_invalidate_display (cache, display, FALSE);
     }
 
-  STAT_INC (cache->misses);
+  cache->misses++;
 
   g_assert (!g_hash_table_lookup (cache->line_to_display, line));
 
@@ -810,6 +840,38 @@ gtk_text_line_display_cache_set_mru_size (GtkTextLineDisplayCache *cache,
           display = g_queue_peek_tail (&cache->mru);
 
           gtk_text_line_display_cache_invalidate_display (cache, display, FALSE);
+          cache->evictions++;
         }
     }
 }
+
+/*
+ * gtk_text_line_display_cache_begin_frame:
+ * @cache: a GtkTextLineDisplayCache
+ *
+ * Starts a new snapshot generation. Displays that are requested after
+ * this call are considered visible and are kept even when the cache
+ * is over its memory budget; everything else is culled in MRU order.
+ */
+void
+gtk_text_line_display_cache_begin_frame (GtkTextLineDisplayCache *cache)
+{
+  g_assert (cache != NULL);
+
+  cache->generation++;
+}
+
+void
+gtk_text_line_display_cache_get_stats (GtkTextLineDisplayCache      *cache,
+                                       GtkTextLineDisplayCacheStats *stats)
+{
+  g_assert (cache != NULL);
+  g_assert (stats != NULL);
+
+  stats->hits = cache->hits;
+  stats->misses = cache->misses;
+  stats->evictions = cache->evictions;
+  stats->n_lines = g_hash_table_size (cache->line_to_display);
+  stats->mem_used = cache->mem_used;
+  stats->mem_budget = cache->mem_budget;
+}
@@ -55,6 +55,9 @@ void                     gtk_text_line_display_cache_invalidate_y_range (GtkText
                                                                          gboolean                 cursors_only);
 void                     gtk_text_line_display_cache_set_mru_size       (GtkTextLineDisplayCache *cache,
                                                                          guint                    mru_size);
+void                     gtk_text_line_display_cache_begin_frame        (GtkTextLineDisplayCache *cache);
+void                     gtk_text_line_display_cache_get_stats          (GtkTextLineDisplayCache *cache,
+                                                                         GtkTextLineDisplayCacheStats *stats);
 
 G_END_DECLS
 
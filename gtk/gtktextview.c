@@ -50,7 +50,7 @@
 #include "gtkrenderbackgroundprivate.h"
 #include "gtkrenderborderprivate.h"
 #include "gtkscrollable.h"
-#include "gtksettings.h"
+#include "gtksettingsprivate.h"
 #include "gtksnapshot.h"
 #include "gtktextiterprivate.h"
 #include "gtktexthandleprivate.h"
@@ -226,6 +226,7 @@ struct _GtkTextViewPrivate
 
   guint64 blink_start_time;
   guint blink_tick;
+  guint blink_timeout_id;
   float cursor_alpha;
 
   guint scroll_timeout;
@@ -2064,6 +2065,12 @@ gtk_text_view_get_selection_node (GtkTextView *text_view)
   return text_view->priv->selection_node;
 }
 
+GtkTextLayout *
+gtk_text_view_get_layout (GtkTextView *text_view)
+{
+  return text_view->priv->layout;
+}
+
 static void
 _gtk_text_view_ensure_magnifier (GtkTextView *text_view)
 {
@@ -3928,6 +3935,7 @@ gtk_text_view_dispose (GObject *object)
   gtk_text_view_remove_validate_idles (text_view);
   gtk_text_view_set_buffer (text_view, NULL);
   gtk_text_view_destroy_layout (text_view);
+  gtk_text_view_stop_cursor_blink (text_view);
 
   if (text_view->priv->scroll_timeout)
     {
@@ -4863,6 +4871,11 @@ first_validate_callback (gpointer data)
   return FALSE;
 }
 
+/* Time spent validating offscreen lines per idle, in microseconds.
+ * Large buffers need many iterations, so do as much as possible per
+ * iteration while still leaving most of a frame for drawing. */
+#define INCREMENTAL_VALIDATE_BUDGET 5000
+
 static gboolean
 incremental_validate_callback (gpointer data)
 {
@@ -4871,7 +4884,8 @@ incremental_validate_callback (gpointer data)
 
   DV(g_print(G_STRLOC"\n"));
 
-  gtk_text_layout_validate (text_view->priv->layout, 2000);
+  gtk_text_layout_validate_until (text_view->priv->layout,
+                                  g_get_monotonic_time () + INCREMENTAL_VALIDATE_BUDGET);
 
   gtk_text_view_update_adjustments (text_view);
 
@@ -5422,7 +5436,7 @@ gtk_text_view_handle_drag_finished (GtkTextHandle *handle,
       guint double_click_time;
 
       settings = gtk_widget_get_settings (GTK_WIDGET (text_view));
-      g_object_get (settings, "gtk-double-click-time", &double_click_time, NULL);
+      double_click_time = gtk_settings_get_double_click_time (settings);
       if (g_get_monotonic_time() - priv->handle_place_time < double_click_time * 1000)
         {
           buffer = get_buffer (text_view);
@@ -6095,7 +6109,7 @@ cursor_blinks (GtkTextView *text_view)
       GtkSettings *settings = gtk_widget_get_settings (GTK_WIDGET (text_view));
       gboolean blink;
 
-      g_object_get (settings, "gtk-cursor-blink", &blink, NULL);
+      blink = gtk_settings_get_values (settings)->cursor_blink;
 
       if (!blink)
         return FALSE;
@@ -6122,7 +6136,7 @@ cursor_visible (GtkTextView *text_view)
   GtkSettings *settings = gtk_widget_get_settings (GTK_WIDGET (text_view));
   gboolean use_caret;
 
-  g_object_get (settings, "gtk-keynav-use-caret", &use_caret, NULL);
+  use_caret = gtk_settings_get_values (settings)->keynav_use_caret;
 
    return use_caret || text_view->priv->cursor_visible;
 }
@@ -6134,7 +6148,7 @@ get_middle_click_paste (GtkTextView *text_view)
   gboolean paste;
 
   settings = gtk_widget_get_settings (GTK_WIDGET (text_view));
-  g_object_get (settings, "gtk-enable-primary-paste", &paste, NULL);
+  paste = gtk_settings_get_values (settings)->enable_primary_paste;
 
   return paste;
 }
@@ -6145,7 +6159,7 @@ get_cursor_time (GtkTextView *text_view)
   GtkSettings *settings = gtk_widget_get_settings (GTK_WIDGET (text_view));
   int time;
 
-  g_object_get (settings, "gtk-cursor-blink-time", &time, NULL);
+  time = gtk_settings_get_values (settings)->cursor_blink_time;
 
   return time;
 }
@@ -6156,7 +6170,7 @@ get_cursor_blink_timeout (GtkTextView *text_view)
   GtkSettings *settings = gtk_widget_get_settings (GTK_WIDGET (text_view));
   int time;
 
-  g_object_get (settings, "gtk-cursor-blink-timeout", &time, NULL);
+  time = gtk_settings_get_values (settings)->cursor_blink_timeout;
 
   return time;
 }
@@ -6167,13 +6181,18 @@ get_cursor_blink_timeout (GtkTextView *text_view)
  */
 
 typedef struct {
+  GtkTextView *text_view;
   guint64 start;
   guint64 end;
 } BlinkData;
 
-static gboolean blink_cb (GtkWidget     *widget,
-                          GdkFrameClock *clock,
-                          gpointer       user_data);
+/* Roughly one frame, in microseconds */
+#define BLINK_MIN_WAIT 16667
+
+static gboolean blink_cb         (GtkWidget     *widget,
+                                  GdkFrameClock *clock,
+                                  gpointer       user_data);
+static gboolean blink_timeout_cb (gpointer       user_data);
 
 
 static void
@@ -6190,6 +6209,7 @@ add_blink_timeout (GtkTextView *self,
   blink_time = get_cursor_time (self);
 
   data = g_new (BlinkData, 1);
+  data->text_view = self;
   data->start = priv->blink_start_time;
   if (delay)
     data->start += blink_time * 1000 / 2;
@@ -6211,6 +6231,7 @@ remove_blink_timeout (GtkTextView *self)
       gtk_widget_remove_tick_callback (GTK_WIDGET (self), priv->blink_tick);
       priv->blink_tick = 0;
     }
+  g_clear_handle_id (&priv->blink_timeout_id, g_source_remove);
 }
 
 static float
@@ -6277,9 +6298,49 @@ blink_cb (GtkWidget     *widget,
       gtk_widget_queue_draw (widget);
     }
 
+  /* While the cursor is fully visible or invisible, nothing needs
+   * to be drawn, so don't keep the frame clock running until the
+   * next fade starts
+   */
+  if (phase < 0.25 || (phase >= 0.5 && phase < 0.75))
+    {
+      double fade_start = phase < 0.25 ? 0.25 : 0.75;
+      guint64 fade_time = data->start + (guint64) (fade_start * (data->end - data->start));
+
+      if (fade_time > now + 2 * BLINK_MIN_WAIT)
+        {
+          guint64 wait = fade_time - now - BLINK_MIN_WAIT;
+
+          priv->blink_tick = 0;
+          priv->blink_timeout_id = g_timeout_add_full (G_PRIORITY_DEFAULT,
+                                                       wait / 1000,
+                                                       blink_timeout_cb,
+                                                       g_memdup2 (data, sizeof (BlinkData)),
+                                                       g_free);
+          gdk_source_set_static_name_by_id (priv->blink_timeout_id, "[gtk] blink_timeout_cb");
+
+          return G_SOURCE_REMOVE;
+        }
+    }
+
   return G_SOURCE_CONTINUE;
 }
 
+static gboolean
+blink_timeout_cb (gpointer user_data)
+{
+  BlinkData *data = user_data;
+  GtkTextViewPrivate *priv = data->text_view->priv;
+
+  priv->blink_timeout_id = 0;
+  priv->blink_tick = gtk_widget_add_tick_callback (GTK_WIDGET (data->text_view),
+                                                   blink_cb,
+                                                   g_memdup2 (data, sizeof (BlinkData)),
+                                                   g_free);
+
+  return G_SOURCE_REMOVE;
+}
+
 
 static void
 gtk_text_view_stop_cursor_blink (GtkTextView *text_view)
@@ -6294,14 +6355,11 @@ gtk_text_view_check_cursor_blink (GtkTextView *text_view)
 
   if (cursor_blinks (text_view) && cursor_visible (text_view))
     {
-      if (!priv->blink_tick)
+      if (!priv->blink_tick && !priv->blink_timeout_id)
         add_blink_timeout (text_view, FALSE);
     }
   else
-    {
-      if (priv->blink_tick)
-        remove_blink_timeout (text_view);
-    }
+    remove_blink_timeout (text_view);
 }
 
 static void
@@ -7836,6 +7894,7 @@ gtk_text_view_set_attributes_from_style (GtkTextView        *text_view,
 {
   GtkCssStyle *style;
   const GdkRGBA black = { 0, };
+  GtkCssFontVariantValues *font_variant;
   const GdkRGBA *color;
   const GdkRGBA *decoration_color;
   GtkTextDecorationLine decoration_line;
@@ -7860,10 +7919,11 @@ gtk_text_view_set_attributes_from_style (GtkTextView        *text_view,
 
   /* text-decoration */
 
-  decoration_line = _gtk_css_text_decoration_line_value_get (style->font_variant->text_decoration_line);
-  decoration_style = _gtk_css_text_decoration_style_value_get (style->font_variant->text_decoration_style);
-  decoration_color = gtk_css_color_value_get_rgba (style->font_variant->text_decoration_color
-                                                   ? style->font_variant->text_decoration_color
+  font_variant = gtk_css_style_get_font_variant_values (style);
+  decoration_line = _gtk_css_text_decoration_line_value_get (font_variant->text_decoration_line);
+  decoration_style = _gtk_css_text_decoration_style_value_get (font_variant->text_decoration_style);
+  decoration_color = gtk_css_color_value_get_rgba (font_variant->text_decoration_color
+                                                   ? font_variant->text_decoration_color
                                                    : style->core->color);
 
   if (decoration_line & GTK_CSS_TEXT_DECORATION_LINE_UNDERLINE)
@@ -7968,9 +8028,7 @@ gtk_text_view_check_keymap_direction (GtkTextView *text_view)
   else
     direction = PANGO_DIRECTION_LTR;
 
-  g_object_get (settings,
-                "gtk-split-cursor", &split_cursor,
-                NULL);
+  split_cursor = gtk_settings_get_split_cursor (settings);
 
   if (direction == PANGO_DIRECTION_RTL)
     new_keyboard_dir = GTK_TEXT_DIR_RTL;
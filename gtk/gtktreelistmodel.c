@@ -33,10 +33,12 @@
 enum {
   PROP_0,
   PROP_AUTOEXPAND,
+  PROP_INCREMENTAL,
   PROP_ITEM_TYPE,
   PROP_MODEL,
   PROP_N_ITEMS,
   PROP_PASSTHROUGH,
+  PROP_PENDING,
   NUM_PROPERTIES
 };
 
@@ -56,12 +58,14 @@ struct _TreeNode
 
   guint empty : 1;
   guint is_root : 1;
+  guint pending_expand : 1; /* queued for incremental autoexpand */
 };
 
 struct _TreeAugment
 {
   guint n_items;
   guint n_local;
+  guint n_pending; /* pending nodes, including descendants */
 };
 
 struct _GtkTreeListModel
@@ -76,6 +80,9 @@ struct _GtkTreeListModel
 
   guint autoexpand : 1;
   guint passthrough : 1;
+  guint incremental : 1;
+
+  guint pending_cb; /* idle callback handle */
 };
 
 struct _GtkTreeListModelClass
@@ -168,6 +175,59 @@ tree_node_get_n_children (TreeNode *node)
   return child_aug->n_items;
 }
 
+static guint
+tree_node_get_n_pending (TreeNode *node)
+{
+  TreeNode *child_node;
+
+  if (node->children == NULL)
+    return 0;
+
+  child_node = gtk_rb_tree_get_root (node->children);
+  if (child_node == NULL)
+    return 0;
+
+  return ((TreeAugment *) gtk_rb_tree_get_augment (node->children, child_node))->n_pending;
+}
+
+/* Finds the first node below @parent that waits to be autoexpanded */
+static TreeNode *
+tree_node_find_pending (TreeNode *parent)
+{
+  GtkRbTree *tree;
+  TreeNode *node, *tmp;
+
+  if (tree_node_get_n_pending (parent) == 0)
+    return NULL;
+
+  tree = parent->children;
+  node = gtk_rb_tree_get_root (tree);
+
+  while (node)
+    {
+      tmp = gtk_rb_tree_node_get_left (node);
+      if (tmp && ((TreeAugment *) gtk_rb_tree_get_augment (tree, tmp))->n_pending > 0)
+        {
+          node = tmp;
+          continue;
+        }
+
+      if (node->pending_expand)
+        return node;
+
+      if (tree_node_get_n_pending (node) > 0)
+        {
+          tree = node->children;
+          node = gtk_rb_tree_get_root (tree);
+          continue;
+        }
+
+      node = gtk_rb_tree_node_get_right (node);
+    }
+
+  g_return_val_if_reached (NULL);
+}
+
 static guint
 tree_node_get_position (TreeNode *node)
 {
@@ -310,6 +370,9 @@ tree_node_get_row (TreeNode *node)
 static guint
 gtk_tree_list_model_expand_node (GtkTreeListModel *self,
                                  TreeNode         *node);
+static guint
+gtk_tree_list_model_autoexpand_node (GtkTreeListModel *self,
+                                     TreeNode         *node);
 
 static void
 gtk_tree_list_model_items_changed_cb (GListModel *model,
@@ -378,7 +441,7 @@ gtk_tree_list_model_items_changed_cb (GListModel *model,
     {
       for (i = 0; i < added; i++)
         {
-          tree_added += gtk_tree_list_model_expand_node (self, child);
+          tree_added += gtk_tree_list_model_autoexpand_node (self, child);
           child = gtk_rb_tree_node_get_next (child);
         }
     }
@@ -437,21 +500,27 @@ gtk_tree_list_model_augment (GtkRbTree *tree,
 {
   TreeAugment *aug = _aug;
 
+  TreeNode *node = _node;
+
   aug->n_items = 1;
-  aug->n_items += tree_node_get_n_children (_node);
+  aug->n_items += tree_node_get_n_children (node);
   aug->n_local = 1;
+  aug->n_pending = node->pending_expand;
+  aug->n_pending += tree_node_get_n_pending (node);
 
   if (left)
     {
       TreeAugment *left_aug = gtk_rb_tree_get_augment (tree, left);
       aug->n_items += left_aug->n_items;
       aug->n_local += left_aug->n_local;
+      aug->n_pending += left_aug->n_pending;
     }
   if (right)
     {
       TreeAugment *right_aug = gtk_rb_tree_get_augment (tree, right);
       aug->n_items += right_aug->n_items;
       aug->n_local += right_aug->n_local;
+      aug->n_pending += right_aug->n_pending;
     }
 }
 
@@ -483,7 +552,7 @@ gtk_tree_list_model_init_node (GtkTreeListModel *list,
       node->item = g_list_model_get_item (model, i);
       g_assert (node ->item);
       if (list->autoexpand)
-        gtk_tree_list_model_expand_node (list, node);
+        gtk_tree_list_model_autoexpand_node (list, node);
     }
 }
 
@@ -493,6 +562,12 @@ gtk_tree_list_model_expand_node (GtkTreeListModel *self,
 {
   GListModel *model;
 
+  if (node->pending_expand)
+    {
+      node->pending_expand = FALSE;
+      tree_node_mark_dirty (node);
+    }
+
   if (node->empty)
     return 0;
   
@@ -511,6 +586,83 @@ gtk_tree_list_model_expand_node (GtkTreeListModel *self,
   return tree_node_get_n_children (node);
 }
 
+#define GTK_TREE_LIST_MODEL_EXPAND_STEPS 64
+
+static gboolean
+gtk_tree_list_model_run_pending (GtkTreeListModel *self,
+                                 guint             n_steps)
+{
+  TreeNode *node;
+  guint i, n_added;
+
+  for (i = 0; i < n_steps; i++)
+    {
+      node = tree_node_find_pending (&self->root_node);
+      if (node == NULL)
+        break;
+
+      n_added = gtk_tree_list_model_expand_node (self, node);
+      if (n_added)
+        {
+          g_list_model_items_changed (G_LIST_MODEL (self),
+                                      tree_node_get_position (node) + 1,
+                                      0,
+                                      n_added);
+          g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
+        }
+
+      if (node->row && node->children)
+        {
+          g_object_notify (G_OBJECT (node->row), "expanded");
+          g_object_notify (G_OBJECT (node->row), "children");
+        }
+    }
+
+  return tree_node_get_n_pending (&self->root_node) > 0;
+}
+
+static gboolean
+gtk_tree_list_model_pending_cb (gpointer data)
+{
+  GtkTreeListModel *self = data;
+
+  if (!gtk_tree_list_model_run_pending (self, GTK_TREE_LIST_MODEL_EXPAND_STEPS))
+    {
+      self->pending_cb = 0;
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
+      return G_SOURCE_REMOVE;
+    }
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
+  return G_SOURCE_CONTINUE;
+}
+
+/* Expands a node because of autoexpand. In incremental mode, the node
+ * is only queued and the children get added from an idle handler, so
+ * expanding many nodes with slow child models doesn't block.
+ */
+static guint
+gtk_tree_list_model_autoexpand_node (GtkTreeListModel *self,
+                                     TreeNode         *node)
+{
+  if (!self->incremental)
+    return gtk_tree_list_model_expand_node (self, node);
+
+  if (node->empty || node->model != NULL || node->pending_expand)
+    return 0;
+
+  node->pending_expand = TRUE;
+  tree_node_mark_dirty (node);
+
+  if (self->pending_cb == 0)
+    {
+      self->pending_cb = g_idle_add (gtk_tree_list_model_pending_cb, self);
+      gdk_source_set_static_name_by_id (self->pending_cb, "[gtk] gtk_tree_list_model_pending_cb");
+    }
+
+  return 0;
+}
+
 static guint
 gtk_tree_list_model_collapse_node (GtkTreeListModel *self,
                                    TreeNode         *node)
@@ -595,6 +747,10 @@ gtk_tree_list_model_set_property (GObject      *object,
       gtk_tree_list_model_set_autoexpand (self, g_value_get_boolean (value));
       break;
 
+    case PROP_INCREMENTAL:
+      gtk_tree_list_model_set_incremental (self, g_value_get_boolean (value));
+      break;
+
     case PROP_PASSTHROUGH:
       self->passthrough = g_value_get_boolean (value);
       break;
@@ -619,6 +775,10 @@ gtk_tree_list_model_get_property (GObject     *object,
       g_value_set_boolean (value, self->autoexpand);
       break;
 
+    case PROP_INCREMENTAL:
+      g_value_set_boolean (value, self->incremental);
+      break;
+
     case PROP_ITEM_TYPE:
       g_value_set_gtype (value, gtk_tree_list_model_get_item_type (G_LIST_MODEL (self)));
       break;
@@ -635,6 +795,10 @@ gtk_tree_list_model_get_property (GObject     *object,
       g_value_set_boolean (value, self->passthrough);
       break;
 
+    case PROP_PENDING:
+      g_value_set_uint (value, gtk_tree_list_model_get_pending (self));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -646,6 +810,7 @@ gtk_tree_list_model_finalize (GObject *object)
 {
   GtkTreeListModel *self = GTK_TREE_LIST_MODEL (object);
 
+  g_clear_handle_id (&self->pending_cb, g_source_remove);
   gtk_tree_list_model_clear_node (&self->root_node);
   if (self->user_destroy)
     self->user_destroy (self->user_data);
@@ -672,6 +837,18 @@ gtk_tree_list_model_class_init (GtkTreeListModelClass *class)
                             FALSE,
                             GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkTreeListModel:incremental: (attributes org.gtk.Property.get=gtk_tree_list_model_get_incremental org.gtk.Property.set=gtk_tree_list_model_set_incremental)
+   *
+   * If autoexpanding rows should happen incrementally.
+   *
+   * Since: 4.16
+   */
+  properties[PROP_INCREMENTAL] =
+      g_param_spec_boolean ("incremental", NULL, NULL,
+                            FALSE,
+                            GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
   /**
    * GtkTreeListModel:item-type:
    *
@@ -720,6 +897,18 @@ gtk_tree_list_model_class_init (GtkTreeListModelClass *class)
                             FALSE,
                             GTK_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkTreeListModel:pending: (attributes org.gtk.Property.get=gtk_tree_list_model_get_pending)
+   *
+   * Number of rows that are still waiting to be autoexpanded.
+   *
+   * Since: 4.16
+   */
+  properties[PROP_PENDING] =
+      g_param_spec_uint ("pending", NULL, NULL,
+                         0, G_MAXUINT, 0,
+                         GTK_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (gobject_class, NUM_PROPERTIES, properties);
 }
 
@@ -858,6 +1047,89 @@ gtk_tree_list_model_get_autoexpand (GtkTreeListModel *self)
   return self->autoexpand;
 }
 
+/**
+ * gtk_tree_list_model_set_incremental: (attributes org.gtk.Method.set_property=incremental)
+ * @self: a `GtkTreeListModel`
+ * @incremental: %TRUE to autoexpand rows incrementally
+ *
+ * Sets whether rows should be autoexpanded incrementally.
+ *
+ * By default, when [property@Gtk.TreeListModel:autoexpand] is set, the
+ * child models of all added rows are created right away, which can take
+ * a long time when many rows get added or the child models are slow
+ * to create.
+ *
+ * In incremental mode, those rows are added unexpanded and get
+ * expanded a few at a time while the main loop is idle, starting
+ * with the first row. Rows expanded via [method@Gtk.TreeListRow.set_expanded]
+ * still have their children added right away.
+ *
+ * When incremental mode is turned off, all pending rows are
+ * expanded immediately.
+ *
+ * See [method@Gtk.FilterListModel.set_incremental] for a discussion
+ * of the tradeoffs of incremental models.
+ *
+ * Since: 4.16
+ */
+void
+gtk_tree_list_model_set_incremental (GtkTreeListModel *self,
+                                     gboolean          incremental)
+{
+  g_return_if_fail (GTK_IS_TREE_LIST_MODEL (self));
+
+  if (self->incremental == incremental)
+    return;
+
+  self->incremental = incremental;
+
+  if (!incremental && self->pending_cb)
+    {
+      g_clear_handle_id (&self->pending_cb, g_source_remove);
+      gtk_tree_list_model_run_pending (self, G_MAXUINT);
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
+    }
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_INCREMENTAL]);
+}
+
+/**
+ * gtk_tree_list_model_get_incremental: (attributes org.gtk.Method.get_property=incremental)
+ * @self: a `GtkTreeListModel`
+ *
+ * Returns whether rows are autoexpanded incrementally.
+ *
+ * Returns: %TRUE if rows are autoexpanded incrementally
+ *
+ * Since: 4.16
+ */
+gboolean
+gtk_tree_list_model_get_incremental (GtkTreeListModel *self)
+{
+  g_return_val_if_fail (GTK_IS_TREE_LIST_MODEL (self), FALSE);
+
+  return self->incremental;
+}
+
+/**
+ * gtk_tree_list_model_get_pending: (attributes org.gtk.Method.get_property=pending)
+ * @self: a `GtkTreeListModel`
+ *
+ * Returns the number of rows that are still waiting to be
+ * autoexpanded because the model is in incremental mode.
+ *
+ * Returns: the number of pending rows
+ *
+ * Since: 4.16
+ */
+guint
+gtk_tree_list_model_get_pending (GtkTreeListModel *self)
+{
+  g_return_val_if_fail (GTK_IS_TREE_LIST_MODEL (self), 0);
+
+  return tree_node_get_n_pending (&self->root_node);
+}
+
 /**
  * gtk_tree_list_model_get_row:
  * @self: a `GtkTreeListModel`
@@ -73,6 +73,13 @@ void                    gtk_tree_list_model_set_autoexpand      (GtkTreeListMode
                                                                  gboolean                autoexpand);
 GDK_AVAILABLE_IN_ALL
 gboolean                gtk_tree_list_model_get_autoexpand      (GtkTreeListModel       *self);
+GDK_AVAILABLE_IN_4_16
+void                    gtk_tree_list_model_set_incremental     (GtkTreeListModel       *self,
+                                                                 gboolean                incremental);
+GDK_AVAILABLE_IN_4_16
+gboolean                gtk_tree_list_model_get_incremental     (GtkTreeListModel       *self);
+GDK_AVAILABLE_IN_4_16
+guint                   gtk_tree_list_model_get_pending         (GtkTreeListModel       *self);
 
 GDK_AVAILABLE_IN_ALL
 GtkTreeListRow *        gtk_tree_list_model_get_child_row       (GtkTreeListModel       *self,
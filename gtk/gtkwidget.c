@@ -72,7 +72,9 @@
 
 #include "inspector/window.h"
 
+#include "gdk/gdkallocationsprivate.h"
 #include "gdk/gdkeventsprivate.h"
+#include "gdk/gdkframeclockprivate.h"
 #include "gdk/gdkprofilerprivate.h"
 #include "gsk/gskdebugprivate.h"
 #include "gsk/gskrendererprivate.h"
@@ -655,6 +657,12 @@ static GQuark           quark_font_options = 0;
 static GQuark           quark_font_map = 0;
 static GQuark           quark_builder_set_id = 0;
 
+/* Per-frame statistics about render node reuse */
+static int              snapshotted_widgets;
+static int              reused_widgets;
+static guint            snapshotted_widgets_counter;
+static guint            reused_widgets_counter;
+
 GType
 gtk_widget_get_type (void)
 {
@@ -721,6 +729,91 @@ gtk_widget_get_instance_private (GtkWidget *self)
   return (G_STRUCT_MEMBER_P (self, GtkWidget_private_offset));
 }
 
+static GtkWidgetRareData *
+gtk_widget_ensure_rare_data (GtkWidget *self)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (self);
+
+  if (G_UNLIKELY (priv->rare_data == NULL))
+    priv->rare_data = g_new0 (GtkWidgetRareData, 1);
+
+  return priv->rare_data;
+}
+
+/* Containers with at least this many children keep a
+ * spatial index of them for gtk_widget_pick()
+ */
+#define PICK_INDEX_MIN_CHILDREN 64
+
+/* A uniform grid over the pick bounds of the children. Every cell
+ * lists the children whose bounds overlap it, in sibling order.
+ * Children without pick bounds are checked for every point.
+ */
+struct _GtkWidgetPickIndex
+{
+  GtkWidget **children;
+  guint n_children;
+
+  GArray *unbounded;
+
+  graphene_rect_t bounds;
+  guint n_columns;
+  guint n_rows;
+  guint *cell_start;
+  guint *cell_children;
+};
+
+static void
+gtk_widget_pick_index_free (GtkWidgetPickIndex *index)
+{
+  g_free (index->children);
+  g_array_unref (index->unbounded);
+  g_free (index->cell_start);
+  g_free (index->cell_children);
+  g_free (index);
+}
+
+static void
+gtk_widget_clear_pick_index (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+
+  if (priv->rare_data)
+    g_clear_pointer (&priv->rare_data->pick_index, gtk_widget_pick_index_free);
+}
+
+/* The pick bounds of a widget depend on the ones of its children,
+ * so they are only valid if the children's ones are. Which means
+ * we can stop walking up once we find invalid bounds.
+ */
+static void
+gtk_widget_invalidate_pick_bounds (GtkWidget *widget)
+{
+  while (widget)
+    {
+      GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+      gboolean was_valid = priv->pick_bounds_valid;
+
+      priv->pick_bounds_valid = FALSE;
+
+      widget = priv->parent;
+      if (widget == NULL)
+        break;
+
+      gtk_widget_clear_pick_index (widget);
+
+      if (!was_valid)
+        break;
+    }
+}
+
+static void
+gtk_widget_invalidate_pick_children (GtkWidget *widget)
+{
+  gtk_widget_clear_pick_index (widget);
+  gtk_widget_invalidate_pick_bounds (widget);
+}
+
 static void
 gtk_widget_base_class_init (gpointer g_class)
 {
@@ -1183,6 +1276,9 @@ gtk_widget_class_init (GtkWidgetClass *klass)
   gtk_widget_parent_class = g_type_class_peek_parent (klass);
 
   quark_pango_context = g_quark_from_static_string ("gtk-pango-context");
+
+  snapshotted_widgets_counter = gdk_profiler_define_int_counter ("snapshotted-widgets", "Widgets snapshotted per frame");
+  reused_widgets_counter = gdk_profiler_define_int_counter ("reused-widgets", "Widgets reusing their render node per frame");
   quark_mnemonic_labels = g_quark_from_static_string ("gtk-mnemonic-labels");
   quark_size_groups = g_quark_from_static_string ("gtk-widget-size-groups");
   quark_auto_children = g_quark_from_static_string ("gtk-widget-auto-children");
@@ -2579,6 +2675,9 @@ gtk_widget_unparent (GtkWidget *widget)
   priv->width = 0;
   priv->height = 0;
 
+  /* The new parent may well depend on our size */
+  priv->resize_boundary = FALSE;
+
   if (_gtk_widget_get_realized (widget))
     gtk_widget_unrealize (widget);
 
@@ -2630,8 +2729,11 @@ gtk_widget_unparent (GtkWidget *widget)
 
   _gtk_widget_update_parent_muxer (widget);
 
-  if (old_parent->priv->children_observer)
-    gtk_list_list_model_item_removed (old_parent->priv->children_observer, old_prev_sibling);
+  priv->pick_bounds_valid = FALSE;
+  gtk_widget_invalidate_pick_children (old_parent);
+
+  if (old_parent->priv->rare_data && old_parent->priv->rare_data->children_observer)
+    gtk_list_list_model_item_removed (old_parent->priv->rare_data->children_observer, old_prev_sibling);
 
   if (old_parent->priv->layout_manager)
     gtk_layout_manager_remove_layout_child (old_parent->priv->layout_manager, widget);
@@ -2817,6 +2919,7 @@ gtk_widget_real_hide (GtkWidget *widget)
   priv->width = 0;
   priv->height = 0;
   priv->baseline = 0;
+  gtk_widget_invalidate_pick_bounds (widget);
   gtk_widget_update_paintables (widget);
 }
 
@@ -3523,6 +3626,8 @@ gtk_widget_queue_draw (GtkWidget *widget)
 
 static void
 gtk_widget_set_alloc_needed (GtkWidget *widget);
+static void
+gtk_widget_queue_transform (GtkWidget *widget);
 
 /**
  * gtk_widget_queue_allocate:
@@ -3594,7 +3699,7 @@ gtk_widget_queue_resize_internal (GtkWidget *widget)
       GtkWidget *parent = _gtk_widget_get_parent (widget);
       if (parent)
         {
-          if (GTK_IS_NATIVE (widget))
+          if (GTK_IS_NATIVE (widget) || priv->resize_boundary)
             gtk_widget_queue_allocate (parent);
           else
             gtk_widget_queue_resize_internal (parent);
@@ -3995,6 +4100,7 @@ gtk_widget_allocate (GtkWidget    *widget,
   alloc_needed = priv->alloc_needed;
   /* Preserve request/allocate ordering */
   priv->alloc_needed = FALSE;
+  priv->transform_needed = FALSE;
 
   baseline_changed = priv->allocated_baseline != baseline;
   transform_changed = !gsk_transform_equal (priv->allocated_transform, transform);
@@ -4065,6 +4171,9 @@ gtk_widget_allocate (GtkWidget    *widget,
   if (adjusted.x || adjusted.y)
     transform = gsk_transform_translate (transform, &GRAPHENE_POINT_INIT (adjusted.x, adjusted.y));
 
+  if (!gsk_transform_equal (priv->transform, transform))
+    gtk_widget_invalidate_pick_bounds (widget);
+
   gsk_transform_unref (priv->transform);
   priv->transform = transform;
 
@@ -4085,6 +4194,9 @@ gtk_widget_allocate (GtkWidget    *widget,
     }
   else
     {
+      if (size_changed)
+        gtk_widget_invalidate_pick_bounds (widget);
+
       priv->width = adjusted.width;
       priv->height = adjusted.height;
       priv->baseline = baseline;
@@ -4538,6 +4650,21 @@ gtk_widget_real_mnemonic_activate (GtkWidget *widget,
   return TRUE;
 }
 
+/* Most widgets only have controllers for some kinds of events, such
+ * as key controllers or shortcuts. Checking for that up front saves
+ * translating the event coordinates for every widget along the event
+ * path, and walking their controller lists.
+ */
+static inline gboolean
+gtk_widget_handles_event_type (GtkWidget *widget,
+                               GdkEvent  *event)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+
+  return (priv->controller_event_types &
+          GTK_EVENT_TYPE_MASK (gdk_event_get_event_type (event))) != 0;
+}
+
 #define WIDGET_REALIZED_FOR_EVENT(widget, event) \
      (gdk_event_get_event_type (event) == GDK_FOCUS_CHANGE || _gtk_widget_get_realized (widget))
 
@@ -4551,9 +4678,14 @@ gtk_widget_run_controllers (GtkWidget           *widget,
 {
   GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
   GtkEventController *controller;
+  guint event_type_mask;
   gboolean handled = FALSE;
   GList *l;
 
+  event_type_mask = GTK_EVENT_TYPE_MASK (gdk_event_get_event_type (event));
+  if ((priv->controller_event_types & event_type_mask) == 0)
+    return FALSE;
+
   g_object_ref (widget);
 
   l = priv->event_controllers;
@@ -4576,7 +4708,8 @@ gtk_widget_run_controllers (GtkWidget           *widget,
 
           controller_phase = gtk_event_controller_get_propagation_phase (controller);
 
-          if (controller_phase == phase)
+          if (controller_phase == phase &&
+              (gtk_event_controller_get_event_types (controller) & event_type_mask) != 0)
             {
               gboolean this_handled;
               gboolean is_gesture;
@@ -4741,6 +4874,9 @@ _gtk_widget_captured_event (GtkWidget *widget,
   if (!event_surface_is_still_viewable (event))
     return TRUE;
 
+  if (!gtk_widget_handles_event_type (widget, event))
+    return FALSE;
+
   translate_event_coordinates (event, &x, &y, widget);
 
   return_val = gtk_widget_run_controllers (widget, event, target, x, y, GTK_PHASE_CAPTURE);
@@ -4768,6 +4904,9 @@ gtk_widget_event (GtkWidget *widget,
   if (!_gtk_widget_get_mapped (widget))
     return FALSE;
 
+  if (!gtk_widget_handles_event_type (widget, event))
+    return FALSE;
+
   translate_event_coordinates (event, &x, &y, widget);
 
   if (widget == target)
@@ -4994,7 +5133,8 @@ gtk_widget_real_css_changed (GtkWidget         *widget,
           else if (gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_TRANSFORM) &&
                    priv->parent)
             {
-              gtk_widget_queue_allocate (priv->parent);
+              gtk_widget_queue_transform (widget);
+              gtk_widget_queue_draw (priv->parent);
             }
 
           if (gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_REDRAW) ||
@@ -5747,6 +5887,7 @@ _gtk_widget_set_visible_flag (GtkWidget *widget,
       g_clear_pointer (&priv->transform, gsk_transform_unref);
       priv->width = 0;
       priv->height = 0;
+      gtk_widget_invalidate_pick_bounds (widget);
       gtk_widget_update_paintables (widget);
     }
 }
@@ -6082,12 +6223,14 @@ gtk_widget_reposition_after (GtkWidget *widget,
   if (parent->priv->root && priv->root == NULL)
     gtk_widget_root (widget);
 
-  if (parent->priv->children_observer)
+  gtk_widget_invalidate_pick_children (parent);
+
+  if (parent->priv->rare_data && parent->priv->rare_data->children_observer)
     {
       if (prev_previous)
-        gtk_list_list_model_item_moved (parent->priv->children_observer, widget, prev_previous);
+        gtk_list_list_model_item_moved (parent->priv->rare_data->children_observer, widget, prev_previous);
       else
-        gtk_list_list_model_item_added (parent->priv->children_observer, widget);
+        gtk_list_list_model_item_added (parent->priv->rare_data->children_observer, widget);
     }
 
   if (prev_parent == NULL)
@@ -6479,7 +6622,7 @@ gtk_widget_update_pango_context (GtkWidget        *widget,
 
   if (settings)
     {
-      g_object_get (settings, "gtk-hint-font-metrics", &hint_font_metrics, NULL);
+      hint_font_metrics = gtk_settings_get_values (settings)->hint_font_metrics;
 
       /* Override the user setting on non-HiDPI */
       if (scale == 1)
@@ -6683,6 +6826,13 @@ gtk_widget_create_pango_context (GtkWidget *widget)
   return context;
 }
 
+static void
+pango_layout_freed (gpointer  data,
+                    GObject  *layout)
+{
+  gdk_allocation_remove (GDK_ALLOCATION_PANGO_LAYOUT);
+}
+
 /**
  * gtk_widget_create_pango_layout:
  * @widget: a `GtkWidget`
@@ -6714,6 +6864,12 @@ gtk_widget_create_pango_layout (GtkWidget  *widget,
   if (text)
     pango_layout_set_text (layout, text, -1);
 
+  if (GDK_ALLOCATION_TRACKING)
+    {
+      gdk_allocation_record (GDK_ALLOCATION_PANGO_LAYOUT, 1, 0, 0);
+      g_object_weak_ref (G_OBJECT (layout), pango_layout_freed, NULL);
+    }
+
   return layout;
 }
 
@@ -7172,6 +7328,42 @@ gtk_widget_has_size_request (GtkWidget *widget)
   return !(priv->width_request == -1 && priv->height_request == -1);
 }
 
+/*< private >
+ * gtk_widget_get_memory_stats:
+ * @widget: a `GtkWidget`
+ * @stats: (out): return location for the statistics
+ *
+ * Estimates the memory that @widget itself uses, not
+ * counting its children, controllers or render nodes.
+ * This is used by the inspector.
+ */
+void
+gtk_widget_get_memory_stats (GtkWidget            *widget,
+                             GtkWidgetMemoryStats *stats)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+  GTypeQuery query;
+
+  g_type_query (G_OBJECT_TYPE (widget), &query);
+
+  stats->instance_size = query.instance_size;
+  stats->private_size = sizeof (GtkWidgetPrivate);
+  stats->rare_data_size = 0;
+  stats->n_controllers = g_list_length (priv->event_controllers);
+
+  if (priv->name)
+    stats->private_size += strlen (priv->name) + 1;
+
+  if (priv->rare_data)
+    {
+      stats->rare_data_size = sizeof (GtkWidgetRareData);
+      if (priv->rare_data->tooltip_markup)
+        stats->rare_data_size += strlen (priv->rare_data->tooltip_markup) + 1;
+      if (priv->rare_data->tooltip_text)
+        stats->rare_data_size += strlen (priv->rare_data->tooltip_text) + 1;
+    }
+}
+
 /**
  * gtk_widget_get_ancestor:
  * @widget: a `GtkWidget`
@@ -7432,10 +7624,13 @@ gtk_widget_dispose (GObject *object)
   if (priv->muxer != NULL)
     g_object_run_dispose (G_OBJECT (priv->muxer));
 
-  if (priv->children_observer)
-    gtk_list_list_model_clear (priv->children_observer);
-  if (priv->controller_observer)
-    gtk_list_list_model_clear (priv->controller_observer);
+  if (priv->rare_data)
+    {
+      if (priv->rare_data->children_observer)
+        gtk_list_list_model_clear (priv->rare_data->children_observer);
+      if (priv->rare_data->controller_observer)
+        gtk_list_list_model_clear (priv->rare_data->controller_observer);
+    }
 
   if (priv->parent)
     {
@@ -7457,7 +7652,8 @@ gtk_widget_dispose (GObject *object)
   if (_gtk_widget_get_realized (widget))
     gtk_widget_unrealize (widget);
 
-  g_clear_object (&priv->cursor);
+  if (priv->rare_data)
+    g_clear_object (&priv->rare_data->cursor);
 
   if (!priv->in_destruction)
     {
@@ -7647,8 +7843,14 @@ gtk_widget_finalize (GObject *object)
   gtk_grab_remove (widget);
 
   g_free (priv->name);
-  g_free (priv->tooltip_markup);
-  g_free (priv->tooltip_text);
+
+  if (priv->rare_data)
+    {
+      g_clear_pointer (&priv->rare_data->pick_index, gtk_widget_pick_index_free);
+      g_free (priv->rare_data->tooltip_markup);
+      g_free (priv->rare_data->tooltip_text);
+      g_free (priv->rare_data);
+    }
 
   g_clear_pointer (&priv->transform, gsk_transform_unref);
   g_clear_pointer (&priv->allocated_transform, gsk_transform_unref);
@@ -9920,12 +10122,14 @@ void
 gtk_widget_set_tooltip_text (GtkWidget  *widget,
                              const char *text)
 {
-  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
   GObject *object = G_OBJECT (widget);
+  GtkWidgetRareData *rare_data;
   char *tooltip_text, *tooltip_markup;
 
   g_return_if_fail (GTK_IS_WIDGET (widget));
 
+  rare_data = gtk_widget_ensure_rare_data (widget);
+
   g_object_freeze_notify (object);
 
   /* Treat an empty string as a NULL string,
@@ -9942,13 +10146,13 @@ gtk_widget_set_tooltip_text (GtkWidget  *widget,
       tooltip_markup = text != NULL ? g_markup_escape_text (text, -1) : NULL;
     }
 
-  g_clear_pointer (&priv->tooltip_markup, g_free);
-  g_clear_pointer (&priv->tooltip_text, g_free);
+  g_clear_pointer (&rare_data->tooltip_markup, g_free);
+  g_clear_pointer (&rare_data->tooltip_text, g_free);
 
-  priv->tooltip_text = tooltip_text;
-  priv->tooltip_markup = tooltip_markup;
+  rare_data->tooltip_text = tooltip_text;
+  rare_data->tooltip_markup = tooltip_markup;
 
-  gtk_widget_set_has_tooltip (widget, priv->tooltip_text != NULL);
+  gtk_widget_set_has_tooltip (widget, rare_data->tooltip_text != NULL);
   if (_gtk_widget_get_visible (widget))
     gtk_widget_trigger_tooltip_query (widget);
 
@@ -9978,7 +10182,7 @@ gtk_widget_get_tooltip_text (GtkWidget *widget)
 
   g_return_val_if_fail (GTK_IS_WIDGET (widget), NULL);
 
-  return priv->tooltip_text;
+  return priv->rare_data ? priv->rare_data->tooltip_text : NULL;
 }
 
 /**
@@ -9999,12 +10203,14 @@ void
 gtk_widget_set_tooltip_markup (GtkWidget  *widget,
                                const char *markup)
 {
-  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
   GObject *object = G_OBJECT (widget);
+  GtkWidgetRareData *rare_data;
   char *tooltip_markup;
 
   g_return_if_fail (GTK_IS_WIDGET (widget));
 
+  rare_data = gtk_widget_ensure_rare_data (widget);
+
   g_object_freeze_notify (object);
 
   /* Treat an empty string as a NULL string,
@@ -10015,24 +10221,24 @@ gtk_widget_set_tooltip_markup (GtkWidget  *widget,
   else
     tooltip_markup = g_strdup (markup);
 
-  g_clear_pointer (&priv->tooltip_text, g_free);
-  g_clear_pointer (&priv->tooltip_markup, g_free);
+  g_clear_pointer (&rare_data->tooltip_text, g_free);
+  g_clear_pointer (&rare_data->tooltip_markup, g_free);
 
-  priv->tooltip_markup = tooltip_markup;
+  rare_data->tooltip_markup = tooltip_markup;
 
   /* Store the tooltip without markup, as we might end up using
    * it for widget descriptions in the accessibility layer
    */
-  if (priv->tooltip_markup != NULL)
+  if (rare_data->tooltip_markup != NULL)
     {
-      pango_parse_markup (priv->tooltip_markup, -1, 0, NULL,
-                          &priv->tooltip_text,
+      pango_parse_markup (rare_data->tooltip_markup, -1, 0, NULL,
+                          &rare_data->tooltip_text,
                           NULL,
                           NULL);
     }
 
   gtk_accessible_update_property (GTK_ACCESSIBLE (widget),
-                                  GTK_ACCESSIBLE_PROPERTY_DESCRIPTION, priv->tooltip_text,
+                                  GTK_ACCESSIBLE_PROPERTY_DESCRIPTION, rare_data->tooltip_text,
                                   -1);
 
   gtk_widget_set_has_tooltip (widget, tooltip_markup != NULL);
@@ -10065,7 +10271,7 @@ gtk_widget_get_tooltip_markup (GtkWidget *widget)
 
   g_return_val_if_fail (GTK_IS_WIDGET (widget), NULL);
 
-  return priv->tooltip_markup;
+  return priv->rare_data ? priv->rare_data->tooltip_markup : NULL;
 }
 
 /**
@@ -10206,6 +10412,284 @@ gtk_widget_can_be_picked (GtkWidget    *widget,
   return TRUE;
 }
 
+static void
+gtk_widget_ensure_pick_bounds (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+  GtkWidget *child;
+  GtkCssBoxes boxes;
+  graphene_rect_t bounds;
+  gboolean bounded;
+
+  if (priv->pick_bounds_valid)
+    return;
+
+  /* Widgets can make contains() return TRUE outside of their
+   * border box, so we can't say anything about those
+   */
+  bounded = GTK_WIDGET_GET_CLASS (widget)->contains == gtk_widget_real_contains;
+
+  gtk_css_boxes_init (&boxes, widget);
+  bounds = *gtk_css_boxes_get_border_rect (&boxes);
+
+  for (child = _gtk_widget_get_first_child (widget);
+       child;
+       child = _gtk_widget_get_next_sibling (child))
+    {
+      GtkWidgetPrivate *child_priv = gtk_widget_get_instance_private (child);
+
+      if (GTK_IS_NATIVE (child))
+        continue;
+
+      /* Always do this, our bounds are only valid if the children's are */
+      gtk_widget_ensure_pick_bounds (child);
+
+      /* Picking doesn't look at children outside of the padding box */
+      if (priv->overflow == GTK_OVERFLOW_HIDDEN)
+        continue;
+
+      if (child_priv->pick_bounded)
+        graphene_rect_union (&bounds, &child_priv->pick_bounds, &bounds);
+      else
+        bounded = FALSE;
+    }
+
+  if (priv->transform)
+    {
+      if (gsk_transform_get_category (priv->transform) >= GSK_TRANSFORM_CATEGORY_2D)
+        {
+          graphene_rect_t transformed;
+
+          gsk_transform_transform_bounds (priv->transform, &bounds, &transformed);
+          bounds = transformed;
+        }
+      else
+        {
+          bounded = FALSE;
+        }
+    }
+
+  priv->pick_bounds = bounds;
+  priv->pick_bounded = bounded;
+  priv->pick_bounds_valid = TRUE;
+}
+
+static void
+gtk_widget_pick_index_get_cell (GtkWidgetPickIndex *index,
+                                double              x,
+                                double              y,
+                                guint              *column,
+                                guint              *row)
+{
+  double fx, fy;
+
+  fx = (x - index->bounds.origin.x) / index->bounds.size.width * index->n_columns;
+  fy = (y - index->bounds.origin.y) / index->bounds.size.height * index->n_rows;
+
+  *column = CLAMP (fx, 0, index->n_columns - 1);
+  *row = CLAMP (fy, 0, index->n_rows - 1);
+}
+
+static GtkWidgetPickIndex *
+gtk_widget_pick_index_new (GtkWidget *widget,
+                           guint      n_children)
+{
+  GtkWidgetPickIndex *index;
+  GtkWidget *child;
+  guint i, n_bounded, n_cells, n_entries;
+  guint *fill;
+
+  index = g_new0 (GtkWidgetPickIndex, 1);
+  index->children = g_new (GtkWidget *, n_children);
+  index->unbounded = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  n_bounded = 0;
+  for (child = _gtk_widget_get_first_child (widget);
+       child;
+       child = _gtk_widget_get_next_sibling (child))
+    {
+      GtkWidgetPrivate *child_priv = gtk_widget_get_instance_private (child);
+
+      if (GTK_IS_NATIVE (child))
+        continue;
+
+      gtk_widget_ensure_pick_bounds (child);
+
+      i = index->n_children++;
+      index->children[i] = child;
+
+      if (!child_priv->pick_bounded)
+        {
+          g_array_append_val (index->unbounded, i);
+          continue;
+        }
+
+      if (n_bounded++ == 0)
+        index->bounds = child_priv->pick_bounds;
+      else
+        graphene_rect_union (&index->bounds, &child_priv->pick_bounds, &index->bounds);
+    }
+
+  if (n_bounded == 0 ||
+      index->bounds.size.width <= 0 ||
+      index->bounds.size.height <= 0)
+    {
+      /* Nothing to look up, everything bounded is empty */
+      return index;
+    }
+
+  index->n_columns = index->n_rows = CLAMP (ceil (sqrt (n_bounded)), 1, 256);
+  n_cells = index->n_columns * index->n_rows;
+  index->cell_start = g_new0 (guint, n_cells + 1);
+
+  /* Count the children in every cell first, then fill them in */
+  for (i = 0; i < index->n_children; i++)
+    {
+      GtkWidgetPrivate *child_priv = gtk_widget_get_instance_private (index->children[i]);
+      guint c0, r0, c1, r1, c, r;
+
+      if (!child_priv->pick_bounded)
+        continue;
+
+      gtk_widget_pick_index_get_cell (index,
+                                      child_priv->pick_bounds.origin.x,
+                                      child_priv->pick_bounds.origin.y,
+                                      &c0, &r0);
+      gtk_widget_pick_index_get_cell (index,
+                                      child_priv->pick_bounds.origin.x + child_priv->pick_bounds.size.width,
+                                      child_priv->pick_bounds.origin.y + child_priv->pick_bounds.size.height,
+                                      &c1, &r1);
+
+      for (r = r0; r <= r1; r++)
+        for (c = c0; c <= c1; c++)
+          index->cell_start[r * index->n_columns + c + 1]++;
+    }
+
+  for (i = 0; i < n_cells; i++)
+    index->cell_start[i + 1] += index->cell_start[i];
+
+  n_entries = index->cell_start[n_cells];
+  index->cell_children = g_new (guint, n_entries);
+  fill = g_memdup2 (index->cell_start, sizeof (guint) * n_cells);
+
+  for (i = 0; i < index->n_children; i++)
+    {
+      GtkWidgetPrivate *child_priv = gtk_widget_get_instance_private (index->children[i]);
+      guint c0, r0, c1, r1, c, r;
+
+      if (!child_priv->pick_bounded)
+        continue;
+
+      gtk_widget_pick_index_get_cell (index,
+                                      child_priv->pick_bounds.origin.x,
+                                      child_priv->pick_bounds.origin.y,
+                                      &c0, &r0);
+      gtk_widget_pick_index_get_cell (index,
+                                      child_priv->pick_bounds.origin.x + child_priv->pick_bounds.size.width,
+                                      child_priv->pick_bounds.origin.y + child_priv->pick_bounds.size.height,
+                                      &c1, &r1);
+
+      for (r = r0; r <= r1; r++)
+        for (c = c0; c <= c1; c++)
+          index->cell_children[fill[r * index->n_columns + c]++] = i;
+    }
+
+  g_free (fill);
+
+  return index;
+}
+
+static GtkWidgetPickIndex *
+gtk_widget_get_pick_index (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+  GtkWidget *child;
+  guint n_children;
+
+  if (priv->rare_data && priv->rare_data->pick_index)
+    return priv->rare_data->pick_index;
+
+  n_children = 0;
+  for (child = _gtk_widget_get_first_child (widget);
+       child;
+       child = _gtk_widget_get_next_sibling (child))
+    n_children++;
+
+  if (n_children < PICK_INDEX_MIN_CHILDREN)
+    return NULL;
+
+  gtk_widget_ensure_rare_data (widget)->pick_index = gtk_widget_pick_index_new (widget, n_children);
+
+  return priv->rare_data->pick_index;
+}
+
+static GtkWidget *gtk_widget_do_pick (GtkWidget    *widget,
+                                      double        x,
+                                      double        y,
+                                      GtkPickFlags  flags);
+
+static GtkWidget *
+gtk_widget_pick_child (GtkWidget    *child,
+                       double        x,
+                       double        y,
+                       GtkPickFlags  flags)
+{
+  GtkWidgetPrivate *child_priv = gtk_widget_get_instance_private (child);
+  graphene_point3d_t res;
+
+  if (!gtk_widget_can_be_picked (child, flags))
+    return NULL;
+
+  if (GTK_IS_NATIVE (child))
+    return NULL;
+
+  if (child_priv->pick_bounds_valid &&
+      child_priv->pick_bounded &&
+      !graphene_rect_contains_point (&child_priv->pick_bounds, &GRAPHENE_POINT_INIT (x, y)))
+    return NULL;
+
+  if (child_priv->transform)
+    {
+      if (gsk_transform_get_category (child_priv->transform) >= GSK_TRANSFORM_CATEGORY_2D_TRANSLATE)
+        {
+          graphene_point_t transformed_p;
+
+          gsk_transform_transform_point (child_priv->transform,
+                                         &(graphene_point_t) { 0, 0 },
+                                         &transformed_p);
+
+          graphene_point3d_init (&res, x - transformed_p.x, y - transformed_p.y, 0.);
+        }
+      else
+        {
+          GskTransform *transform;
+          graphene_matrix_t inv;
+          graphene_point3d_t p0, p1;
+
+          transform = gsk_transform_invert (gsk_transform_ref (child_priv->transform));
+          if (transform == NULL)
+            return NULL;
+
+          gsk_transform_to_matrix (transform, &inv);
+          gsk_transform_unref (transform);
+          graphene_point3d_init (&p0, x, y, 0);
+          graphene_point3d_init (&p1, x, y, 1);
+          graphene_matrix_transform_point3d (&inv, &p0, &p0);
+          graphene_matrix_transform_point3d (&inv, &p1, &p1);
+          if (fabs (p0.z - p1.z) < 1.f / 4096)
+            return NULL;
+
+          graphene_point3d_interpolate (&p0, &p1, p0.z / (p0.z - p1.z), &res);
+        }
+    }
+  else
+    {
+      graphene_point3d_init (&res, x, y, 0);
+    }
+
+  return gtk_widget_do_pick (child, res.x, res.y, flags);
+}
+
 static GtkWidget *
 gtk_widget_do_pick (GtkWidget    *widget,
                     double        x,
@@ -10213,6 +10697,7 @@ gtk_widget_do_pick (GtkWidget    *widget,
                     GtkPickFlags  flags)
 {
   GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+  GtkWidgetPickIndex *index;
   GtkWidget *child;
 
   if (priv->overflow == GTK_OVERFLOW_HIDDEN)
@@ -10226,62 +10711,52 @@ gtk_widget_do_pick (GtkWidget    *widget,
         return NULL;
     }
 
-  for (child = _gtk_widget_get_last_child (widget);
-       child;
-       child = _gtk_widget_get_prev_sibling (child))
+  index = gtk_widget_get_pick_index (widget);
+  if (index)
     {
-      GtkWidgetPrivate *child_priv = gtk_widget_get_instance_private (child);
-      GtkWidget *picked;
-      graphene_point3d_t res;
+      guint cell_first, i, j;
 
-      if (!gtk_widget_can_be_picked (child, flags))
-        continue;
+      cell_first = i = 0;
+      if (index->n_columns > 0 &&
+          graphene_rect_contains_point (&index->bounds, &GRAPHENE_POINT_INIT (x, y)))
+        {
+          guint column, row;
 
-      if (GTK_IS_NATIVE (child))
-        continue;
+          gtk_widget_pick_index_get_cell (index, x, y, &column, &row);
+          cell_first = index->cell_start[row * index->n_columns + column];
+          i = index->cell_start[row * index->n_columns + column + 1];
+        }
+      j = index->unbounded->len;
 
-      if (child_priv->transform)
+      /* Merge the cell's children and the unbounded ones, topmost first */
+      while (i > cell_first || j > 0)
         {
-          if (gsk_transform_get_category (child_priv->transform) >= GSK_TRANSFORM_CATEGORY_2D_TRANSLATE)
-            {
-              graphene_point_t transformed_p;
-
-              gsk_transform_transform_point (child_priv->transform,
-                                             &(graphene_point_t) { 0, 0 },
-                                             &transformed_p);
+          guint next;
+          GtkWidget *picked;
 
-              graphene_point3d_init (&res, x - transformed_p.x, y - transformed_p.y, 0.);
-            }
+          if (j == 0 ||
+              (i > cell_first && index->cell_children[i - 1] > g_array_index (index->unbounded, guint, j - 1)))
+            next = index->cell_children[--i];
           else
-            {
-              GskTransform *transform;
-              graphene_matrix_t inv;
-              graphene_point3d_t p0, p1;
-
-              transform = gsk_transform_invert (gsk_transform_ref (child_priv->transform));
-              if (transform == NULL)
-                continue;
-
-              gsk_transform_to_matrix (transform, &inv);
-              gsk_transform_unref (transform);
-              graphene_point3d_init (&p0, x, y, 0);
-              graphene_point3d_init (&p1, x, y, 1);
-              graphene_matrix_transform_point3d (&inv, &p0, &p0);
-              graphene_matrix_transform_point3d (&inv, &p1, &p1);
-              if (fabs (p0.z - p1.z) < 1.f / 4096)
-                continue;
+            next = g_array_index (index->unbounded, guint, --j);
 
-              graphene_point3d_interpolate (&p0, &p1, p0.z / (p0.z - p1.z), &res);
-            }
+          picked = gtk_widget_pick_child (index->children[next], x, y, flags);
+          if (picked)
+            return picked;
         }
-      else
+    }
+  else
+    {
+      for (child = _gtk_widget_get_last_child (widget);
+           child;
+           child = _gtk_widget_get_prev_sibling (child))
         {
-          graphene_point3d_init (&res, x, y, 0);
-        }
+          GtkWidget *picked;
 
-      picked = gtk_widget_do_pick (child, res.x, res.y, flags);
-      if (picked)
-        return picked;
+          picked = gtk_widget_pick_child (child, x, y, flags);
+          if (picked)
+            return picked;
+        }
     }
 
   if (!GTK_WIDGET_GET_CLASS (widget)->contains (widget, x, y))
@@ -10662,6 +11137,7 @@ gtk_widget_set_overflow (GtkWidget   *widget,
 
   priv->overflow = overflow;
 
+  gtk_widget_invalidate_pick_bounds (widget);
   gtk_widget_queue_draw (widget);
 
   g_object_notify_by_pspec (G_OBJECT (widget), widget_props[PROP_OVERFLOW]);
@@ -10733,12 +11209,10 @@ _gtk_widget_get_alloc_needed (GtkWidget *widget)
 }
 
 static void
-gtk_widget_set_alloc_needed (GtkWidget *widget)
+gtk_widget_set_alloc_needed_on_child (GtkWidget *widget)
 {
   GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
 
-  priv->alloc_needed = TRUE;
-
   do
     {
       if (priv->alloc_needed_on_child)
@@ -10764,6 +11238,30 @@ gtk_widget_set_alloc_needed (GtkWidget *widget)
   while (TRUE);
 }
 
+static void
+gtk_widget_set_alloc_needed (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+
+  priv->alloc_needed = TRUE;
+
+  gtk_widget_set_alloc_needed_on_child (widget);
+}
+
+/* Recomputes the transform of @widget on the next layout, reusing
+ * its current allocation. This is what CSS transforms need, neither
+ * the widget nor its parent have to be allocated again for them.
+ */
+static void
+gtk_widget_queue_transform (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+
+  priv->transform_needed = TRUE;
+
+  gtk_widget_set_alloc_needed_on_child (widget);
+}
+
 gboolean
 gtk_widget_needs_allocate (GtkWidget *widget)
 {
@@ -10793,7 +11291,7 @@ gtk_widget_ensure_allocate (GtkWidget *widget)
    *  If that wasn't true, the parent would have taken care of
    *  things.
    */
-  if (priv->alloc_needed)
+  if (priv->alloc_needed || priv->transform_needed)
     {
       gtk_widget_allocate (widget,
                            priv->allocated_width,
@@ -10807,6 +11305,40 @@ gtk_widget_ensure_allocate (GtkWidget *widget)
     }
 }
 
+/*
+ * gtk_widget_set_resize_boundary:
+ * @widget: a `GtkWidget`
+ * @resize_boundary: whether the parent's size request is independent
+ *   of the size request of @widget
+ *
+ * Used by containers whose size request doesn't depend on a child's,
+ * such as scrolled windows that don't propagate their child's size.
+ *
+ * Resizes queued on @widget or its descendants then only cause the
+ * parent to allocate @widget again, instead of renegotiating the size
+ * of all ancestors up to the toplevel.
+ *
+ * The parent is responsible for unsetting this when its size request
+ * starts depending on @widget, or when @widget is removed.
+ */
+void
+gtk_widget_set_resize_boundary (GtkWidget *widget,
+                                gboolean   resize_boundary)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+
+  resize_boundary = !!resize_boundary;
+
+  if (priv->resize_boundary == resize_boundary)
+    return;
+
+  priv->resize_boundary = resize_boundary;
+
+  /* The parent may have missed resizes while the boundary was set */
+  if (!resize_boundary && priv->parent)
+    gtk_widget_queue_resize (priv->parent);
+}
+
 void
 gtk_widget_ensure_resize (GtkWidget *widget)
 {
@@ -11735,9 +12267,10 @@ gtk_widget_add_controller (GtkWidget          *widget,
   GTK_EVENT_CONTROLLER_GET_CLASS (controller)->set_widget (controller, widget);
 
   priv->event_controllers = g_list_prepend (priv->event_controllers, controller);
+  priv->controller_event_types |= gtk_event_controller_get_event_types (controller);
 
-  if (priv->controller_observer)
-    gtk_list_list_model_item_added_at (priv->controller_observer, 0);
+  if (priv->rare_data && priv->rare_data->controller_observer)
+    gtk_list_list_model_item_added_at (priv->rare_data->controller_observer, 0);
 }
 
 /**
@@ -11771,8 +12304,15 @@ gtk_widget_remove_controller (GtkWidget          *widget,
   priv->event_controllers = g_list_delete_link (priv->event_controllers, list);
   g_object_unref (controller);
 
-  if (priv->controller_observer)
-    gtk_list_list_model_item_removed (priv->controller_observer, before);
+  priv->controller_event_types = 0;
+  for (list = priv->event_controllers; list; list = list->next)
+    {
+      if (list->data)
+        priv->controller_event_types |= gtk_event_controller_get_event_types (list->data);
+    }
+
+  if (priv->rare_data && priv->rare_data->controller_observer)
+    gtk_list_list_model_item_removed (priv->rare_data->controller_observer, before);
 }
 
 void
@@ -11882,8 +12422,14 @@ gtk_widget_do_snapshot (GtkWidget *widget,
   GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
   GskRenderNode *render_node;
 
+  /* The widget's previous render node is still valid, and it
+   * covers the whole subtree, so there is no need to descend.
+   */
   if (!priv->draw_needed)
-    return;
+    {
+      reused_widgets++;
+      return;
+    }
 
   g_assert (priv->mapped);
 
@@ -11903,6 +12449,7 @@ gtk_widget_do_snapshot (GtkWidget *widget,
   priv->render_node = render_node;
 
   priv->draw_needed = FALSE;
+  snapshotted_widgets++;
 
   gtk_widget_pop_paintables (widget);
   gtk_widget_update_paintables (widget);
@@ -11955,11 +12502,20 @@ gtk_widget_render (GtkWidget            *widget,
   if (GDK_PROFILER_IS_RUNNING)
     {
       before_render = GDK_PROFILER_CURRENT_TIME;
-      gdk_profiler_add_mark (before_snapshot, (before_render - before_snapshot), "Widget snapshot", "");
+      gdk_profiler_add_markf (before_snapshot, (before_render - before_snapshot), "Widget snapshot",
+                              "%d snapshotted, %d reused", snapshotted_widgets, reused_widgets);
+      gdk_profiler_set_int_counter (snapshotted_widgets_counter, snapshotted_widgets);
+      gdk_profiler_set_int_counter (reused_widgets_counter, reused_widgets);
     }
 
+  snapshotted_widgets = 0;
+  reused_widgets = 0;
+
   if (root != NULL)
     {
+      GdkFrameClock *frame_clock;
+      gint64 render_start;
+
       root = gtk_inspector_prepare_render (widget,
                                            renderer,
                                            surface,
@@ -11967,8 +12523,18 @@ gtk_widget_render (GtkWidget            *widget,
                                            root,
                                            priv->render_node);
 
+      render_start = g_get_monotonic_time ();
       gsk_renderer_render (renderer, root, region);
 
+      frame_clock = gtk_widget_get_frame_clock (widget);
+      if (frame_clock)
+        {
+          GdkFrameTimings *timings = gdk_frame_clock_get_current_timings (frame_clock);
+
+          if (timings)
+            timings->render_duration += g_get_monotonic_time () - render_start;
+        }
+
       gsk_render_node_unref (root);
 
       gdk_profiler_end_mark (before_render, "Widget render", "");
@@ -11980,7 +12546,7 @@ gtk_widget_child_observer_destroyed (gpointer widget)
 {
   GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
 
-  priv->children_observer = NULL;
+  priv->rare_data->children_observer = NULL;
 }
 
 /**
@@ -12002,14 +12568,16 @@ gtk_widget_child_observer_destroyed (gpointer widget)
 GListModel *
 gtk_widget_observe_children (GtkWidget *widget)
 {
-  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+  GtkWidgetRareData *rare_data;
 
   g_return_val_if_fail (GTK_IS_WIDGET (widget), NULL);
 
-  if (priv->children_observer)
-    return g_object_ref (G_LIST_MODEL (priv->children_observer));
+  rare_data = gtk_widget_ensure_rare_data (widget);
+
+  if (rare_data->children_observer)
+    return g_object_ref (G_LIST_MODEL (rare_data->children_observer));
 
-  priv->children_observer = gtk_list_list_model_new ((gpointer) gtk_widget_get_first_child,
+  rare_data->children_observer = gtk_list_list_model_new ((gpointer) gtk_widget_get_first_child,
                                                      (gpointer) gtk_widget_get_next_sibling,
                                                      (gpointer) gtk_widget_get_prev_sibling,
                                                      (gpointer) gtk_widget_get_last_child,
@@ -12017,7 +12585,7 @@ gtk_widget_observe_children (GtkWidget *widget)
                                                      widget,
                                                      gtk_widget_child_observer_destroyed);
 
-  return G_LIST_MODEL (priv->children_observer);
+  return G_LIST_MODEL (rare_data->children_observer);
 }
 
 static void
@@ -12025,7 +12593,7 @@ gtk_widget_controller_observer_destroyed (gpointer widget)
 {
   GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
 
-  priv->controller_observer = NULL;
+  priv->rare_data->controller_observer = NULL;
 }
 
 static gpointer
@@ -12075,14 +12643,16 @@ gtk_widget_controller_list_get_item (gpointer item,
 GListModel *
 gtk_widget_observe_controllers (GtkWidget *widget)
 {
-  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+  GtkWidgetRareData *rare_data;
 
   g_return_val_if_fail (GTK_IS_WIDGET (widget), NULL);
 
-  if (priv->controller_observer)
-    return g_object_ref (G_LIST_MODEL (priv->controller_observer));
+  rare_data = gtk_widget_ensure_rare_data (widget);
+
+  if (rare_data->controller_observer)
+    return g_object_ref (G_LIST_MODEL (rare_data->controller_observer));
 
-  priv->controller_observer = gtk_list_list_model_new (gtk_widget_controller_list_get_first,
+  rare_data->controller_observer = gtk_list_list_model_new (gtk_widget_controller_list_get_first,
                                                        gtk_widget_controller_list_get_next,
                                                        gtk_widget_controller_list_get_prev,
                                                        NULL,
@@ -12090,7 +12660,7 @@ gtk_widget_observe_controllers (GtkWidget *widget)
                                                        widget,
                                                        gtk_widget_controller_observer_destroyed);
 
-  return G_LIST_MODEL (priv->controller_observer);
+  return G_LIST_MODEL (rare_data->controller_observer);
 }
 
 /**
@@ -12406,12 +12976,17 @@ gtk_widget_set_cursor (GtkWidget *widget,
                        GdkCursor *cursor)
 {
   GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+  GtkWidgetRareData *rare_data;
   GtkRoot *root;
 
   g_return_if_fail (GTK_IS_WIDGET (widget));
   g_return_if_fail (cursor == NULL || GDK_IS_CURSOR (cursor));
 
-  if (!g_set_object (&priv->cursor, cursor))
+  if (cursor == NULL && priv->rare_data == NULL)
+    return;
+
+  rare_data = gtk_widget_ensure_rare_data (widget);
+  if (!g_set_object (&rare_data->cursor, cursor))
     return;
 
   root = _gtk_widget_get_root (widget);
@@ -12476,7 +13051,7 @@ gtk_widget_get_cursor (GtkWidget *widget)
 
   g_return_val_if_fail (GTK_IS_WIDGET (widget), NULL);
 
-  return priv->cursor;
+  return priv->rare_data ? priv->rare_data->cursor : NULL;
 }
 
 /**
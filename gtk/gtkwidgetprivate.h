@@ -58,6 +58,35 @@ typedef struct _GtkWidgetSurfaceTransformData
   GList *callbacks;
 } GtkWidgetSurfaceTransformData;
 
+typedef struct _GtkWidgetPickIndex GtkWidgetPickIndex;
+
+/* Fields that most widgets never set. They are allocated
+ * the first time one of them is needed.
+ */
+typedef struct _GtkWidgetRareData
+{
+  GtkListListModel *children_observer;
+  GtkListListModel *controller_observer;
+
+  /* Spatial index of the children, for widgets with many of them */
+  GtkWidgetPickIndex *pick_index;
+
+  /* Pointer cursor */
+  GdkCursor *cursor;
+
+  /* Tooltip */
+  char *tooltip_markup;
+  char *tooltip_text;
+} GtkWidgetRareData;
+
+typedef struct
+{
+  gsize instance_size;
+  gsize private_size;
+  gsize rare_data_size;
+  guint n_controllers;
+} GtkWidgetMemoryStats;
+
 struct _GtkWidgetPrivate
 {
   /* The state of the widget. Needs to be able to hold all GtkStateFlags bits
@@ -86,6 +115,8 @@ struct _GtkWidgetPrivate
   guint resize_needed         : 1; /* queue_resize() has been called but no get_preferred_size() yet */
   guint alloc_needed          : 1; /* this widget needs a size_allocate() call */
   guint alloc_needed_on_child : 1; /* 0 or more children - or this widget - need a size_allocate() call */
+  guint transform_needed      : 1; /* only the CSS transform changed, the allocation is still valid */
+  guint resize_boundary       : 1; /* the parent's size request doesn't depend on this widget's */
 
   /* Queue-draw related flags */
   guint draw_needed           : 1;
@@ -102,6 +133,10 @@ struct _GtkWidgetPrivate
   /* SizeGroup related flags */
   guint have_size_groups      : 1;
 
+  /* Picking related flags */
+  guint pick_bounds_valid     : 1; /* pick_bounds is up to date */
+  guint pick_bounded          : 1; /* gtk_widget_pick() can only return widgets in pick_bounds */
+
   /* Alignment */
   guint   halign              : 4;
   guint   valign              : 4;
@@ -126,9 +161,17 @@ struct _GtkWidgetPrivate
   void (* resize_func) (GtkWidget *);
   GtkBorder margin;
 
+  /* Bounds of everything that picking this widget can return,
+   * in the coordinates of the parent. See pick_bounded.
+   */
+  graphene_rect_t pick_bounds;
+
   /* Surface relative transform updates callbacks */
   GtkWidgetSurfaceTransformData *surface_transform_data;
 
+  /* only created on-demand */
+  GtkWidgetRareData *rare_data;
+
   /* The widget's name. If the widget does not have a name
    * (the name is NULL), then its name (as returned by
    * "gtk_widget_get_name") is its class's name.
@@ -173,6 +216,8 @@ struct _GtkWidgetPrivate
   GSList *paintables;
 
   GList *event_controllers;
+  /* The union of the event types of event_controllers */
+  guint controller_event_types;
 
   /* Widget tree */
   GtkWidget *parent;
@@ -182,19 +227,10 @@ struct _GtkWidgetPrivate
   GtkWidget *last_child;
 
   /* only created on-demand */
-  GtkListListModel *children_observer;
-  GtkListListModel *controller_observer;
   GtkActionMuxer *muxer;
 
   GtkWidget *focus_child;
 
-  /* Pointer cursor */
-  GdkCursor *cursor;
-
-  /* Tooltip */
-  char *tooltip_markup;
-  char *tooltip_text;
-
   /* Accessibility */
   GtkATContext *at_context;
   GtkAccessibleRole accessible_role;
@@ -227,6 +263,8 @@ gboolean     _gtk_widget_get_alloc_needed   (GtkWidget *widget);
 gboolean     gtk_widget_needs_allocate      (GtkWidget *widget);
 void         gtk_widget_ensure_resize       (GtkWidget *widget);
 void         gtk_widget_ensure_allocate     (GtkWidget *widget);
+void         gtk_widget_set_resize_boundary (GtkWidget *widget,
+                                             gboolean   resize_boundary);
 void          _gtk_widget_scale_changed     (GtkWidget *widget);
 
 GdkSurface * gtk_widget_get_surface         (GtkWidget *widget);
@@ -280,6 +318,9 @@ gboolean          gtk_widget_has_tick_callback             (GtkWidget *widget);
 
 gboolean          gtk_widget_has_size_request              (GtkWidget *widget);
 
+void              gtk_widget_get_memory_stats              (GtkWidget            *widget,
+                                                            GtkWidgetMemoryStats *stats);
+
 void              gtk_widget_reset_controllers             (GtkWidget *widget);
 
 GtkEventController **gtk_widget_list_controllers           (GtkWidget           *widget,
@@ -29,6 +29,7 @@
 #include "gtklabel.h"
 #include "gtk/gtkwidgetprivate.h"
 #include "gtkcssproviderprivate.h"
+#include "gtkcssstylecacheprivate.h"
 #include "gtkcssstylepropertyprivate.h"
 #include "gtkcssstyleprivate.h"
 #include "gtkcssvalueprivate.h"
@@ -178,6 +179,8 @@ struct _GtkInspectorCssNodeTreePrivate
   GtkWidget *node_tree;
   GListStore *prop_model;
   GtkWidget *prop_tree;
+  GtkWidget *style_cache_stats;
+  GtkWidget *validate_stats;
   GtkCssNode *node;
 };
 
@@ -290,6 +293,8 @@ gtk_inspector_css_node_tree_class_init (GtkInspectorCssNodeTreeClass *klass)
   gtk_widget_class_set_template_from_resource (widget_class, "/org/gtk/libgtk/inspector/css-node-tree.ui");
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorCssNodeTree, node_tree);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorCssNodeTree, prop_tree);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorCssNodeTree, style_cache_stats);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorCssNodeTree, validate_stats);
 }
 
 static int
@@ -615,6 +620,8 @@ gtk_inspector_css_node_tree_init (GtkInspectorCssNodeTree *cnt)
   gtk_widget_init_template (GTK_WIDGET (cnt));
   priv = cnt->priv;
 
+  gtk_css_node_enable_validate_statistics ();
+
   priv->root_model = g_list_store_new (gtk_css_node_get_type ());
   priv->node_model = gtk_tree_list_model_new (G_LIST_MODEL (priv->root_model),
                                               FALSE, FALSE,
@@ -768,6 +775,42 @@ gtk_inspector_css_node_tree_set_object (GtkInspectorCssNodeTree *cnt,
  g_list_free (nodes);
 }
 
+static void
+gtk_inspector_css_node_tree_update_style_cache_stats (GtkInspectorCssNodeTree *cnt)
+{
+  GtkInspectorCssNodeTreePrivate *priv = cnt->priv;
+  guint n_styles;
+  guint64 n_hits, n_misses;
+  char *text;
+
+  gtk_css_style_cache_get_statistics (&n_styles, &n_hits, &n_misses);
+
+  text = g_strdup_printf (_("Style cache: %u styles, %" G_GUINT64_FORMAT " hits, %" G_GUINT64_FORMAT " misses (%.1f%% hit rate)"),
+                          n_styles, n_hits, n_misses,
+                          n_hits + n_misses > 0 ? 100.0 * n_hits / (n_hits + n_misses) : 0.0);
+  gtk_label_set_text (GTK_LABEL (priv->style_cache_stats), text);
+  g_free (text);
+}
+
+static void
+gtk_inspector_css_node_tree_update_validate_stats (GtkInspectorCssNodeTree *cnt)
+{
+  GtkInspectorCssNodeTreePrivate *priv = cnt->priv;
+  GtkCssValidateStatistics stats;
+  char *change, *text;
+
+  gtk_css_node_get_validate_statistics (&stats);
+
+  change = gtk_css_change_to_string (stats.change);
+  text = g_strdup_printf (_("Last restyle: %u nodes, %u new styles, %" G_GINT64_FORMAT " µs total, "
+                            "%" G_GINT64_FORMAT " µs matching, %" G_GINT64_FORMAT " µs computing. Changes: %s"),
+                          stats.n_validated, stats.n_created, stats.total_time,
+                          stats.match_time, stats.compute_time, change);
+  gtk_label_set_text (GTK_LABEL (priv->validate_stats), text);
+  g_free (text);
+  g_free (change);
+}
+
 static void
 gtk_inspector_css_node_tree_update_style (GtkInspectorCssNodeTree *cnt,
                                           GtkCssStyle             *new_style)
@@ -775,6 +818,9 @@ gtk_inspector_css_node_tree_update_style (GtkInspectorCssNodeTree *cnt,
   GtkInspectorCssNodeTreePrivate *priv = cnt->priv;
   int i;
 
+  gtk_inspector_css_node_tree_update_style_cache_stats (cnt);
+  gtk_inspector_css_node_tree_update_validate_stats (cnt);
+
   for (i = 0; i < _gtk_css_style_property_get_n_properties (); i++)
     {
       GtkCssStyleProperty *prop;
@@ -46,6 +46,7 @@
 #include "shortcuts.h"
 #include "size-groups.h"
 #include "statistics.h"
+#include "timeline.h"
 #include "tree-data.h"
 #include "visual.h"
 #include "window.h"
@@ -89,6 +90,7 @@ gtk_inspector_init (void)
   g_type_ensure (GTK_TYPE_INSPECTOR_SHORTCUTS);
   g_type_ensure (GTK_TYPE_INSPECTOR_SIZE_GROUPS);
   g_type_ensure (GTK_TYPE_INSPECTOR_STATISTICS);
+  g_type_ensure (GTK_TYPE_INSPECTOR_TIMELINE);
   g_type_ensure (GTK_TYPE_INSPECTOR_TREE_DATA);
   g_type_ensure (GTK_TYPE_INSPECTOR_VISUAL);
   g_type_ensure (GTK_TYPE_INSPECTOR_WINDOW);
@@ -32,6 +32,7 @@
 #include "gtkmenubutton.h"
 #include "gtkwidgetprivate.h"
 #include "gtkbinlayout.h"
+#include "gtktextviewprivate.h"
 #include "gtkwidgetprivate.h"
 
 struct _GtkInspectorMiscInfo
@@ -90,6 +91,10 @@ struct _GtkInspectorMiscInfo
   GtkWidget *is_toplevel;
   GtkWidget *child_visible_row;
   GtkWidget *child_visible;
+  GtkWidget *memory_row;
+  GtkWidget *memory;
+  GtkWidget *line_cache_row;
+  GtkWidget *line_cache;
 
   guint update_source_id;
   gint64 last_frame;
@@ -324,6 +329,28 @@ update_frame_clock (GtkInspectorMiscInfo *sl)
     }
 }
 
+static void
+update_memory (GtkInspectorMiscInfo *sl)
+{
+  GtkWidgetMemoryStats stats;
+  char *instance, *private, *rare_data, *tmp;
+
+  gtk_widget_get_memory_stats (GTK_WIDGET (sl->object), &stats);
+
+  instance = g_format_size (stats.instance_size);
+  private = g_format_size (stats.private_size);
+  rare_data = g_format_size (stats.rare_data_size);
+  tmp = g_strdup_printf ("%s instance, %s private, %s on demand\n"
+                         "%u controllers",
+                         instance, private, rare_data,
+                         stats.n_controllers);
+  gtk_label_set_label (GTK_LABEL (sl->memory), tmp);
+  g_free (tmp);
+  g_free (instance);
+  g_free (private);
+  g_free (rare_data);
+}
+
 static void
 update_direction (GtkInspectorMiscInfo *sl)
 {
@@ -401,6 +428,8 @@ update_info (gpointer data)
       gtk_widget_set_visible (sl->mapped, gtk_widget_get_mapped (GTK_WIDGET (sl->object)));
       gtk_widget_set_visible (sl->is_toplevel, GTK_IS_NATIVE (sl->object));
       gtk_widget_set_visible (sl->child_visible, _gtk_widget_get_child_visible (GTK_WIDGET (sl->object)));
+
+      update_memory (sl);
     }
 
   update_surface (sl);
@@ -450,6 +479,25 @@ update_info (gpointer data)
       sl->last_frame = frame;
     }
 
+  if (GTK_IS_TEXT_VIEW (sl->object))
+    {
+      GtkTextLineDisplayCacheStats stats;
+      char *used, *budget;
+
+      gtk_text_layout_get_cache_stats (gtk_text_view_get_layout (GTK_TEXT_VIEW (sl->object)), &stats);
+
+      used = g_format_size (stats.mem_used);
+      budget = g_format_size (stats.mem_budget);
+      tmp = g_strdup_printf ("%u lines, %s of %s\n"
+                             "%"G_GUINT64_FORMAT" hits, %"G_GUINT64_FORMAT" misses, %"G_GUINT64_FORMAT" evictions",
+                             stats.n_lines, used, budget,
+                             stats.hits, stats.misses, stats.evictions);
+      gtk_label_set_label (GTK_LABEL (sl->line_cache), tmp);
+      g_free (tmp);
+      g_free (used);
+      g_free (budget);
+    }
+
   if (GDK_IS_SURFACE (sl->object))
     {
       char buf[64];
@@ -523,6 +571,8 @@ gtk_inspector_misc_info_set_object (GtkInspectorMiscInfo *sl,
   gtk_widget_set_visible (sl->framecount_row, GDK_IS_FRAME_CLOCK (object));
   gtk_widget_set_visible (sl->framerate_row, GDK_IS_FRAME_CLOCK (object));
   gtk_widget_set_visible (sl->scale_row, GDK_IS_SURFACE (object));
+  gtk_widget_set_visible (sl->memory_row, GTK_IS_WIDGET (object));
+  gtk_widget_set_visible (sl->line_cache_row, GTK_IS_TEXT_VIEW (object));
 
   if (GTK_IS_WIDGET (object))
     {
@@ -644,6 +694,10 @@ gtk_inspector_misc_info_class_init (GtkInspectorMiscInfoClass *klass)
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, is_toplevel);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, child_visible_row);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, child_visible);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, memory_row);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, memory);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, line_cache_row);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, line_cache);
 
   gtk_widget_class_bind_template_callback (widget_class, update_measure_picture);
   gtk_widget_class_bind_template_callback (widget_class, measure_picture_drag_prepare);
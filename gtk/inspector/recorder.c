@@ -204,6 +204,9 @@ struct _GtkInspectorRecorder
   GtkInspectorRecording *recording; /* start recording if recording or NULL if not */
   gint64 start_time;
 
+  guint max_frames; /* 0 for no limit */
+  guint n_frames;
+
   gboolean debug_nodes;
   gboolean highlight_sequences;
 
@@ -223,6 +226,7 @@ enum
   PROP_DEBUG_NODES,
   PROP_HIGHLIGHT_SEQUENCES,
   PROP_SELECTED_SEQUENCE,
+  PROP_MAX_FRAMES,
   LAST_PROP
 };
 
@@ -385,6 +389,7 @@ recordings_clear_all (GtkButton            *button,
                       GtkInspectorRecorder *recorder)
 {
   g_list_store_remove_all (G_LIST_STORE (recorder->recordings));
+  recorder->n_frames = 0;
 }
 
 static const char *
@@ -2202,6 +2207,10 @@ gtk_inspector_recorder_get_property (GObject    *object,
       g_value_set_pointer (value, recorder->selected_sequence);
       break;
 
+    case PROP_MAX_FRAMES:
+      g_value_set_uint (value, recorder->max_frames);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
       break;
@@ -2234,6 +2243,10 @@ gtk_inspector_recorder_set_property (GObject      *object,
       recorder->selected_sequence = g_value_get_pointer (value);
       break;
 
+    case PROP_MAX_FRAMES:
+      gtk_inspector_recorder_set_max_frames (recorder, g_value_get_uint (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
       break;
@@ -2275,6 +2288,10 @@ gtk_inspector_recorder_class_init (GtkInspectorRecorderClass *klass)
 
   props[PROP_HIGHLIGHT_SEQUENCES] = g_param_spec_boolean ("highlight-sequences", NULL, NULL, FALSE, G_PARAM_READWRITE);
   props[PROP_SELECTED_SEQUENCE] = g_param_spec_pointer ("selected-sequence", NULL, NULL, G_PARAM_READWRITE);
+  props[PROP_MAX_FRAMES] =
+    g_param_spec_uint ("max-frames", NULL, NULL,
+                       0, G_MAXUINT, 0,
+                       G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
 
   g_object_class_install_properties (object_class, LAST_PROP, props);
 
@@ -2386,11 +2403,49 @@ gtk_inspector_recorder_init (GtkInspectorRecorder *recorder)
   g_object_unref (column);
 }
 
+/* Unchanged parts of the widget tree reuse their render nodes
+ * from the previous frame, so recorded frames already share those
+ * subtrees. The limit still bounds the memory of long recordings.
+ */
+static void
+gtk_inspector_recorder_trim_recordings (GtkInspectorRecorder *recorder)
+{
+  if (recorder->max_frames == 0)
+    return;
+
+  while (recorder->n_frames > recorder->max_frames)
+    {
+      GtkInspectorRecording *recording;
+      gboolean is_frame;
+      guint i;
+
+      /* Drop the oldest frame along with the events before it */
+      for (i = 0; ; i++)
+        {
+          recording = g_list_model_get_item (recorder->recordings, i);
+          is_frame = GTK_INSPECTOR_IS_RENDER_RECORDING (recording);
+          g_object_unref (recording);
+
+          if (is_frame)
+            break;
+        }
+
+      g_list_store_splice (G_LIST_STORE (recorder->recordings), 0, i + 1, NULL, 0);
+      recorder->n_frames--;
+    }
+}
+
 static void
 gtk_inspector_recorder_add_recording (GtkInspectorRecorder  *recorder,
                                       GtkInspectorRecording *recording)
 {
   g_list_store_append (G_LIST_STORE (recorder->recordings), recording);
+
+  if (GTK_INSPECTOR_IS_RENDER_RECORDING (recording))
+    {
+      recorder->n_frames++;
+      gtk_inspector_recorder_trim_recordings (recorder);
+    }
 }
 
 void
@@ -2489,6 +2544,20 @@ gtk_inspector_recorder_record_event (GtkInspectorRecorder *recorder,
   g_object_unref (recording);
 }
 
+void
+gtk_inspector_recorder_set_max_frames (GtkInspectorRecorder *recorder,
+                                       guint                 max_frames)
+{
+  if (recorder->max_frames == max_frames)
+    return;
+
+  recorder->max_frames = max_frames;
+
+  gtk_inspector_recorder_trim_recordings (recorder);
+
+  g_object_notify_by_pspec (G_OBJECT (recorder), props[PROP_MAX_FRAMES]);
+}
+
 void
 gtk_inspector_recorder_set_debug_nodes (GtkInspectorRecorder *recorder,
                                         gboolean              debug_nodes)
@@ -33,6 +33,9 @@ void            gtk_inspector_recorder_set_recording            (GtkInspectorRec
                                                                  gboolean                record);
 gboolean        gtk_inspector_recorder_is_recording             (GtkInspectorRecorder   *recorder);
 
+void            gtk_inspector_recorder_set_max_frames           (GtkInspectorRecorder   *recorder,
+                                                                 guint                   max_frames);
+
 void            gtk_inspector_recorder_set_debug_nodes          (GtkInspectorRecorder   *recorder,
                                                                  gboolean                debug_nodes);
 
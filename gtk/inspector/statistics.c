@@ -37,6 +37,8 @@
 #include "gtksortlistmodel.h"
 #include "gtksearchentry.h"
 
+#include "gdk/gdkallocationsprivate.h"
+
 #include <glib/gi18n-lib.h>
 
 /* {{{ TypeData object */
@@ -247,6 +249,9 @@ struct _GtkInspectorStatisticsPrivate
   guint update_source_id;
   GtkWidget *search_entry;
   GtkWidget *search_bar;
+  GtkWidget *allocations;
+  GdkAllocationCounts last_counts[GDK_N_ALLOCATION_KINDS];
+  gint64 last_time;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (GtkInspectorStatistics, gtk_inspector_statistics, GTK_TYPE_BOX)
@@ -290,20 +295,82 @@ add_type_count (GtkInspectorStatistics *sl, GType type)
   return cumulative;
 }
 
+static gboolean
+has_instance_counts (void)
+{
+  return g_type_get_instance_count (GTK_TYPE_LABEL) > 0;
+}
+
+static void
+update_allocations (GtkInspectorStatistics *sl)
+{
+  GtkInspectorStatisticsPrivate *priv = sl->priv;
+  GdkAllocationKind kind;
+  GString *s;
+  gint64 now;
+  double seconds;
+
+  now = g_get_monotonic_time ();
+  seconds = priv->last_time ? (now - priv->last_time) / (double) G_USEC_PER_SEC : 0;
+
+  s = g_string_new (NULL);
+
+  for (kind = 0; kind < GDK_N_ALLOCATION_KINDS; kind++)
+    {
+      GdkAllocationCounts counts;
+      GdkAllocationCounts *last = &priv->last_counts[kind];
+      char *live;
+
+      gdk_allocation_get_counts (kind, &counts);
+
+      if (s->len > 0)
+        g_string_append_c (s, '\n');
+
+      live = g_strdup_printf ("%" G_GSSIZE_FORMAT, (gssize) (counts.n_allocated - counts.n_freed));
+      g_string_append_printf (s, _("%s: %s live"), gdk_allocation_kind_get_name (kind), live);
+      g_free (live);
+
+      if (seconds > 0)
+        {
+          char *bytes;
+
+          bytes = g_format_size ((guint64) ((counts.bytes_allocated - last->bytes_allocated) / seconds));
+          g_string_append_printf (s, _(", %.0f allocated/s, %.0f freed/s, %s/s"),
+                                  (counts.n_allocated - last->n_allocated) / seconds,
+                                  (counts.n_freed - last->n_freed) / seconds,
+                                  bytes);
+          g_free (bytes);
+        }
+
+      *last = counts;
+    }
+
+  priv->last_time = now;
+
+  gtk_label_set_text (GTK_LABEL (priv->allocations), s->str);
+  g_string_free (s, TRUE);
+}
+
 static gboolean
 update_type_counts (gpointer data)
 {
   GtkInspectorStatistics *sl = data;
   GType type;
 
-  for (type = G_TYPE_INTERFACE; type <= G_TYPE_FUNDAMENTAL_MAX; type += (1 << G_TYPE_FUNDAMENTAL_SHIFT))
+  if (has_instance_counts ())
     {
-      if (!G_TYPE_IS_INSTANTIATABLE (type))
-        continue;
+      for (type = G_TYPE_INTERFACE; type <= G_TYPE_FUNDAMENTAL_MAX; type += (1 << G_TYPE_FUNDAMENTAL_SHIFT))
+        {
+          if (!G_TYPE_IS_INSTANTIATABLE (type))
+            continue;
 
-      add_type_count (sl, type);
+          add_type_count (sl, type);
+        }
     }
 
+  if (sl->priv->update_source_id != 0)
+    update_allocations (sl);
+
   return TRUE;
 }
 
@@ -316,6 +383,8 @@ toggle_record (GtkToggleButton        *button,
 
   if (gtk_toggle_button_get_active (button))
     {
+      gdk_allocation_tracking_enable ();
+      sl->priv->last_time = 0;
       sl->priv->update_source_id = g_timeout_add_seconds (1, update_type_counts, sl);
       update_type_counts (sl);
     }
@@ -323,15 +392,10 @@ toggle_record (GtkToggleButton        *button,
     {
       g_source_remove (sl->priv->update_source_id);
       sl->priv->update_source_id = 0;
+      gdk_allocation_tracking_disable ();
     }
 }
 
-static gboolean
-has_instance_counts (void)
-{
-  return g_type_get_instance_count (GTK_TYPE_LABEL) > 0;
-}
-
 static gboolean
 instance_counts_enabled (void)
 {
@@ -813,7 +877,6 @@ constructed (GObject *object)
       if (instance_counts_enabled ())
         gtk_label_set_text (GTK_LABEL (sl->priv->excuse), _("GLib must be configured with -Dbuildtype=debug"));
       gtk_stack_set_visible_child_name (GTK_STACK (sl->priv->stack), "excuse");
-      gtk_widget_set_sensitive (sl->priv->button, FALSE);
     }
 }
 
@@ -823,7 +886,10 @@ finalize (GObject *object)
   GtkInspectorStatistics *sl = GTK_INSPECTOR_STATISTICS (object);
 
   if (sl->priv->update_source_id)
-    g_source_remove (sl->priv->update_source_id);
+    {
+      g_source_remove (sl->priv->update_source_id);
+      gdk_allocation_tracking_disable ();
+    }
 
   g_hash_table_unref (sl->priv->types);
 
@@ -894,6 +960,7 @@ gtk_inspector_statistics_class_init (GtkInspectorStatisticsClass *klass)
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorStatistics, search_entry);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorStatistics, search_bar);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorStatistics, excuse);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorStatistics, allocations);
   gtk_widget_class_bind_template_callback (widget_class, search_changed);
 }
 
@@ -0,0 +1,546 @@
+/*
+ * Copyright © 2024 The GTK Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <glib/gi18n-lib.h>
+
+#include "timeline.h"
+
+#include "gtkbinlayout.h"
+#include "gtkdrawingarea.h"
+#include "gtklabel.h"
+#include "gtkprivate.h"
+#include "gtktogglebutton.h"
+#include "gtkwindow.h"
+
+#include <math.h>
+
+/* The number of frames kept in the ring buffer, about
+ * four seconds of continuous animation at 60Hz
+ */
+#define N_FRAMES 256
+
+/* Used when the frame clock has no refresh interval yet */
+#define DEFAULT_REFRESH_INTERVAL 16667
+
+typedef enum {
+  PHASE_EVENTS,
+  PHASE_UPDATE,
+  PHASE_LAYOUT,
+  PHASE_SNAPSHOT,
+  PHASE_RENDER,
+  N_PHASES
+} Phase;
+
+static const struct {
+  const char *name;
+  GdkRGBA color;
+} phases[N_PHASES] = {
+  { N_("Events"),   { 0.60, 0.60, 0.60, 1.0 } },
+  { N_("Update"),   { 0.56, 0.35, 0.67, 1.0 } },
+  { N_("Layout"),   { 0.21, 0.52, 0.89, 1.0 } },
+  { N_("Snapshot"), { 0.20, 0.82, 0.48, 1.0 } },
+  { N_("Render"),   { 0.96, 0.76, 0.07, 1.0 } },
+};
+
+typedef struct
+{
+  gint64 frame_counter;
+  gint64 refresh_interval;
+  gint64 durations[N_PHASES];
+} FrameRecord;
+
+struct _GtkInspectorTimeline
+{
+  GtkWidget parent;
+
+  GdkDisplay *display;
+
+  GtkWidget *button;
+  GtkWidget *graph;
+  GtkWidget *summary;
+
+  /* GdkFrameClock => GdkFrameClock, holding a reference */
+  GHashTable *clocks;
+  guint scan_source_id;
+
+  FrameRecord frames[N_FRAMES];
+  guint first_frame;
+  guint n_frames;
+};
+
+typedef struct _GtkInspectorTimelineClass
+{
+  GtkWidgetClass parent_class;
+} GtkInspectorTimelineClass;
+
+enum
+{
+  PROP_0,
+  PROP_BUTTON
+};
+
+G_DEFINE_TYPE (GtkInspectorTimeline, gtk_inspector_timeline, GTK_TYPE_WIDGET)
+
+static FrameRecord *
+get_frame (GtkInspectorTimeline *self,
+           guint                 i)
+{
+  return &self->frames[(self->first_frame + i) % N_FRAMES];
+}
+
+static gint64
+get_total_duration (const FrameRecord *frame)
+{
+  gint64 total = 0;
+  guint i;
+
+  for (i = 0; i < N_PHASES; i++)
+    total += frame->durations[i];
+
+  return total;
+}
+
+static void
+after_paint (GdkFrameClock        *clock,
+             GtkInspectorTimeline *self)
+{
+  GdkFrameTimings *timings;
+  FrameRecord *frame;
+  gint64 paint, render;
+
+  timings = gdk_frame_clock_get_current_timings (clock);
+  if (timings == NULL)
+    return;
+
+  if (self->n_frames < N_FRAMES)
+    {
+      frame = get_frame (self, self->n_frames);
+      self->n_frames++;
+    }
+  else
+    {
+      frame = get_frame (self, 0);
+      self->first_frame = (self->first_frame + 1) % N_FRAMES;
+    }
+
+  /* Rendering happens inside the paint phase, everything
+   * else in there is snapshotting the widgets
+   */
+  paint = gdk_frame_timings_get_paint_duration (timings);
+  render = gdk_frame_timings_get_render_duration (timings);
+
+  frame->frame_counter = gdk_frame_timings_get_frame_counter (timings);
+  gdk_frame_clock_get_refresh_info (clock,
+                                    gdk_frame_timings_get_frame_time (timings),
+                                    &frame->refresh_interval,
+                                    NULL);
+  if (frame->refresh_interval == 0)
+    frame->refresh_interval = DEFAULT_REFRESH_INTERVAL;
+
+  frame->durations[PHASE_EVENTS] = gdk_frame_timings_get_events_duration (timings);
+  frame->durations[PHASE_UPDATE] = gdk_frame_timings_get_update_duration (timings);
+  frame->durations[PHASE_LAYOUT] = gdk_frame_timings_get_layout_duration (timings);
+  frame->durations[PHASE_SNAPSHOT] = MAX (paint - render, 0);
+  frame->durations[PHASE_RENDER] = render;
+
+  gtk_widget_queue_draw (self->graph);
+}
+
+static guint
+find_slowest_frame (GtkInspectorTimeline *self)
+{
+  gint64 slowest = -1;
+  guint i, result = 0;
+
+  for (i = 0; i < self->n_frames; i++)
+    {
+      gint64 total = get_total_duration (get_frame (self, i));
+
+      if (total > slowest)
+        {
+          slowest = total;
+          result = i;
+        }
+    }
+
+  return result;
+}
+
+static void
+draw_legend (GtkInspectorTimeline *self,
+             cairo_t              *cr)
+{
+  GdkRGBA color;
+  double x = 6;
+  guint i;
+
+  gtk_widget_get_color (self->graph, &color);
+
+  for (i = 0; i < N_PHASES; i++)
+    {
+      PangoLayout *layout;
+      int text_width, text_height;
+
+      layout = gtk_widget_create_pango_layout (self->graph, _(phases[i].name));
+      pango_layout_get_pixel_size (layout, &text_width, &text_height);
+
+      gdk_cairo_set_source_rgba (cr, &phases[i].color);
+      cairo_rectangle (cr, x, 6 + (text_height - 10) / 2.0, 10, 10);
+      cairo_fill (cr);
+
+      gdk_cairo_set_source_rgba (cr, &color);
+      cairo_move_to (cr, x + 14, 6);
+      pango_cairo_show_layout (cr, layout);
+
+      x += 14 + text_width + 12;
+
+      g_object_unref (layout);
+    }
+}
+
+static void
+draw_graph (GtkDrawingArea *area,
+            cairo_t        *cr,
+            int             width,
+            int             height,
+            gpointer        data)
+{
+  GtkInspectorTimeline *self = data;
+  GdkRGBA color;
+  gint64 budget, max_duration;
+  double bar_width, scale, y;
+  guint i, j, slowest;
+
+  draw_legend (self, cr);
+
+  if (self->n_frames == 0)
+    return;
+
+  /* Scale the graph so that twice the frame budget always fits,
+   * and overly slow frames push the budget line down
+   */
+  slowest = find_slowest_frame (self);
+  budget = get_frame (self, self->n_frames - 1)->refresh_interval;
+  max_duration = MAX (2 * budget, get_total_duration (get_frame (self, slowest)));
+  scale = (height - 30) / (double) max_duration;
+  bar_width = (double) width / N_FRAMES;
+
+  for (i = 0; i < self->n_frames; i++)
+    {
+      const FrameRecord *frame = get_frame (self, i);
+      double x = width - (self->n_frames - i) * bar_width;
+
+      y = height;
+      for (j = 0; j < N_PHASES; j++)
+        {
+          double h = frame->durations[j] * scale;
+
+          gdk_cairo_set_source_rgba (cr, &phases[j].color);
+          cairo_rectangle (cr, x, y - h, MAX (bar_width - 1, 1), h);
+          cairo_fill (cr);
+
+          y -= h;
+        }
+
+      if (i == slowest)
+        {
+          cairo_set_source_rgb (cr, 0.88, 0.11, 0.14);
+          cairo_set_line_width (cr, 2);
+          cairo_rectangle (cr, x - 1, y - 1, MAX (bar_width - 1, 1) + 2, height - y + 2);
+          cairo_stroke (cr);
+        }
+    }
+
+  gtk_widget_get_color (self->graph, &color);
+  color.alpha = 0.5;
+  gdk_cairo_set_source_rgba (cr, &color);
+  cairo_set_line_width (cr, 1);
+  y = round (height - budget * scale) + 0.5;
+  cairo_move_to (cr, 0, y);
+  cairo_line_to (cr, width, y);
+  cairo_stroke (cr);
+}
+
+static void
+update_summary (GtkInspectorTimeline *self)
+{
+  const FrameRecord *frame;
+  GString *s;
+  gint64 total = 0;
+  guint i, j, n_late = 0;
+
+  if (self->n_frames == 0)
+    {
+      gtk_label_set_text (GTK_LABEL (self->summary), _("No frames recorded"));
+      return;
+    }
+
+  for (i = 0; i < self->n_frames; i++)
+    {
+      gint64 duration;
+
+      frame = get_frame (self, i);
+      duration = get_total_duration (frame);
+      total += duration;
+      if (duration > frame->refresh_interval)
+        n_late++;
+    }
+
+  s = g_string_new (NULL);
+  g_string_append_printf (s,
+                          _("%u frames, average %.2f ms, %u over the frame budget"),
+                          self->n_frames,
+                          total / 1000. / self->n_frames,
+                          n_late);
+  g_string_append_c (s, '\n');
+
+  frame = get_frame (self, find_slowest_frame (self));
+  g_string_append_printf (s, _("Slowest frame %" G_GINT64_FORMAT ": %.2f ms"),
+                          frame->frame_counter,
+                          get_total_duration (frame) / 1000.);
+  for (j = 0; j < N_PHASES; j++)
+    g_string_append_printf (s, "%s %s %.2f ms", j == 0 ? "," : " ·",
+                            _(phases[j].name), frame->durations[j] / 1000.);
+
+  gtk_label_set_text (GTK_LABEL (self->summary), s->str);
+  g_string_free (s, TRUE);
+}
+
+static void
+scan_toplevels (GtkInspectorTimeline *self)
+{
+  GListModel *toplevels;
+  GHashTable *seen;
+  GHashTableIter iter;
+  gpointer clock;
+  guint i;
+
+  seen = g_hash_table_new (NULL, NULL);
+
+  toplevels = gtk_window_get_toplevels ();
+  for (i = 0; i < g_list_model_get_n_items (toplevels); i++)
+    {
+      GtkWidget *window = g_list_model_get_item (toplevels, i);
+
+      if (gtk_widget_get_display (window) == self->display &&
+          window != GTK_WIDGET (gtk_widget_get_root (GTK_WIDGET (self))))
+        {
+          clock = gtk_widget_get_frame_clock (window);
+          if (clock != NULL)
+            {
+              g_hash_table_add (seen, clock);
+
+              if (!g_hash_table_contains (self->clocks, clock))
+                {
+                  g_signal_connect_after (clock, "after-paint", G_CALLBACK (after_paint), self);
+                  g_hash_table_add (self->clocks, g_object_ref (clock));
+                }
+            }
+        }
+
+      g_object_unref (window);
+    }
+
+  g_hash_table_iter_init (&iter, self->clocks);
+  while (g_hash_table_iter_next (&iter, &clock, NULL))
+    {
+      if (!g_hash_table_contains (seen, clock))
+        {
+          g_signal_handlers_disconnect_by_func (clock, after_paint, self);
+          g_hash_table_iter_remove (&iter);
+        }
+    }
+
+  g_hash_table_unref (seen);
+}
+
+static gboolean
+update_timeline (gpointer data)
+{
+  GtkInspectorTimeline *self = data;
+
+  /* Windows come and go, and only get a frame clock once
+   * they are realized, so look for them periodically
+   */
+  scan_toplevels (self);
+  update_summary (self);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+start_recording (GtkInspectorTimeline *self)
+{
+  if (self->scan_source_id != 0 || self->display == NULL)
+    return;
+
+  self->first_frame = 0;
+  self->n_frames = 0;
+
+  self->scan_source_id = g_timeout_add_seconds (1, update_timeline, self);
+  gdk_source_set_static_name_by_id (self->scan_source_id, "[gtk] inspector timeline");
+  update_timeline (self);
+}
+
+static void
+stop_recording (GtkInspectorTimeline *self)
+{
+  GHashTableIter iter;
+  gpointer clock;
+
+  if (self->scan_source_id == 0)
+    return;
+
+  g_clear_handle_id (&self->scan_source_id, g_source_remove);
+
+  g_hash_table_iter_init (&iter, self->clocks);
+  while (g_hash_table_iter_next (&iter, &clock, NULL))
+    g_signal_handlers_disconnect_by_func (clock, after_paint, self);
+  g_hash_table_remove_all (self->clocks);
+
+  update_summary (self);
+}
+
+static void
+toggle_record (GtkToggleButton      *button,
+               GtkInspectorTimeline *self)
+{
+  if (gtk_toggle_button_get_active (button))
+    start_recording (self);
+  else
+    stop_recording (self);
+}
+
+static void
+gtk_inspector_timeline_init (GtkInspectorTimeline *self)
+{
+  self->clocks = g_hash_table_new_full (NULL, NULL, g_object_unref, NULL);
+
+  gtk_widget_init_template (GTK_WIDGET (self));
+
+  gtk_drawing_area_set_draw_func (GTK_DRAWING_AREA (self->graph), draw_graph, self, NULL);
+}
+
+static void
+gtk_inspector_timeline_constructed (GObject *object)
+{
+  GtkInspectorTimeline *self = GTK_INSPECTOR_TIMELINE (object);
+
+  G_OBJECT_CLASS (gtk_inspector_timeline_parent_class)->constructed (object);
+
+  g_signal_connect (self->button, "toggled", G_CALLBACK (toggle_record), self);
+}
+
+static void
+gtk_inspector_timeline_dispose (GObject *object)
+{
+  GtkInspectorTimeline *self = GTK_INSPECTOR_TIMELINE (object);
+
+  stop_recording (self);
+
+  gtk_widget_dispose_template (GTK_WIDGET (self), GTK_TYPE_INSPECTOR_TIMELINE);
+
+  G_OBJECT_CLASS (gtk_inspector_timeline_parent_class)->dispose (object);
+}
+
+static void
+gtk_inspector_timeline_finalize (GObject *object)
+{
+  GtkInspectorTimeline *self = GTK_INSPECTOR_TIMELINE (object);
+
+  g_hash_table_unref (self->clocks);
+
+  G_OBJECT_CLASS (gtk_inspector_timeline_parent_class)->finalize (object);
+}
+
+static void
+gtk_inspector_timeline_get_property (GObject    *object,
+                                     guint       param_id,
+                                     GValue     *value,
+                                     GParamSpec *pspec)
+{
+  GtkInspectorTimeline *self = GTK_INSPECTOR_TIMELINE (object);
+
+  switch (param_id)
+    {
+    case PROP_BUTTON:
+      g_value_set_object (value, self->button);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
+      break;
+    }
+}
+
+static void
+gtk_inspector_timeline_set_property (GObject      *object,
+                                     guint         param_id,
+                                     const GValue *value,
+                                     GParamSpec   *pspec)
+{
+  GtkInspectorTimeline *self = GTK_INSPECTOR_TIMELINE (object);
+
+  switch (param_id)
+    {
+    case PROP_BUTTON:
+      self->button = g_value_get_object (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
+      break;
+    }
+}
+
+static void
+gtk_inspector_timeline_class_init (GtkInspectorTimelineClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+  object_class->constructed = gtk_inspector_timeline_constructed;
+  object_class->dispose = gtk_inspector_timeline_dispose;
+  object_class->finalize = gtk_inspector_timeline_finalize;
+  object_class->get_property = gtk_inspector_timeline_get_property;
+  object_class->set_property = gtk_inspector_timeline_set_property;
+
+  g_object_class_install_property (object_class, PROP_BUTTON,
+      g_param_spec_object ("button", NULL, NULL,
+                           GTK_TYPE_WIDGET, G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
+
+  gtk_widget_class_set_template_from_resource (widget_class, "/org/gtk/libgtk/inspector/timeline.ui");
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorTimeline, graph);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorTimeline, summary);
+
+  gtk_widget_class_set_layout_manager_type (widget_class, GTK_TYPE_BIN_LAYOUT);
+}
+
+void
+gtk_inspector_timeline_set_display (GtkInspectorTimeline *self,
+                                    GdkDisplay           *display)
+{
+  gboolean recording = self->scan_source_id != 0;
+
+  stop_recording (self);
+
+  self->display = display;
+
+  if (recording)
+    start_recording (self);
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright © 2024 The GTK Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <gtk/gtkwidget.h>
+
+#define GTK_TYPE_INSPECTOR_TIMELINE            (gtk_inspector_timeline_get_type())
+#define GTK_INSPECTOR_TIMELINE(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj), GTK_TYPE_INSPECTOR_TIMELINE, GtkInspectorTimeline))
+#define GTK_INSPECTOR_IS_TIMELINE(obj)         (G_TYPE_CHECK_INSTANCE_TYPE((obj), GTK_TYPE_INSPECTOR_TIMELINE))
+
+typedef struct _GtkInspectorTimeline GtkInspectorTimeline;
+
+G_BEGIN_DECLS
+
+GType           gtk_inspector_timeline_get_type                 (void);
+
+void            gtk_inspector_timeline_set_display              (GtkInspectorTimeline   *self,
+                                                                 GdkDisplay             *display);
+
+G_END_DECLS
+
@@ -48,6 +48,7 @@
 #include "visual.h"
 #include "general.h"
 #include "logs.h"
+#include "timeline.h"
 
 #include "gdkdebugprivate.h"
 #include "gdkmarshalers.h"
@@ -297,6 +298,7 @@ gtk_inspector_window_constructed (GObject *object)
   gtk_inspector_general_set_display (GTK_INSPECTOR_GENERAL (iw->general), iw->inspected_display);
   gtk_inspector_clipboard_set_display (GTK_INSPECTOR_CLIPBOARD (iw->clipboard), iw->inspected_display);
   gtk_inspector_logs_set_display (GTK_INSPECTOR_LOGS (iw->logs), iw->inspected_display);
+  gtk_inspector_timeline_set_display (GTK_INSPECTOR_TIMELINE (iw->timeline), iw->inspected_display);
   gtk_inspector_css_node_tree_set_display (GTK_INSPECTOR_CSS_NODE_TREE (iw->widget_css_node_tree), iw->inspected_display);
 }
 
@@ -678,6 +680,7 @@ gtk_inspector_window_class_init (GtkInspectorWindowClass *klass)
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorWindow, general);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorWindow, clipboard);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorWindow, logs);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorWindow, timeline);
 
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorWindow, go_up_button);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorWindow, go_down_button);
@@ -78,6 +78,7 @@ typedef struct
   GtkWidget *clipboard;
   GtkWidget *general;
   GtkWidget *logs;
+  GtkWidget *timeline;
 
   GtkWidget *go_up_button;
   GtkWidget *go_down_button;
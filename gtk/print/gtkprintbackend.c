@@ -25,6 +25,7 @@
 #include <gtk/gtk.h>
 #include "gtkmodulesprivate.h"
 #include "gtkprivate.h"
+#include "gdkprofilerprivate.h"
 
 #include "gtkprintbackendprivate.h"
 
@@ -83,10 +84,18 @@ gtk_print_backend_error_quark (void)
 void
 gtk_print_backends_init (void)
 {
+  static gboolean initialized = FALSE;
   GIOExtensionPoint *ep;
   GIOModuleScope *scope;
   char **paths;
   int i;
+  gint64 before G_GNUC_UNUSED;
+
+  if (initialized)
+    return;
+
+  initialized = TRUE;
+  before = GDK_PROFILER_CURRENT_TIME;
 
   GTK_DEBUG (MODULES, "Registering extension point %s", GTK_PRINT_BACKEND_EXTENSION_POINT_NAME);
 
@@ -118,6 +127,8 @@ gtk_print_backends_init (void)
                    g_type_name (g_io_extension_get_type (ext)));
         }
     }
+
+  gdk_profiler_end_mark (before, "Load print backends", NULL);
 }
 
 /**
@@ -138,6 +149,8 @@ gtk_print_backend_load_modules (void)
 
   result = NULL;
 
+  gtk_print_backends_init ();
+
   ep = g_io_extension_point_lookup (GTK_PRINT_BACKEND_EXTENSION_POINT_NAME);
 
   settings = gtk_settings_get_default ();
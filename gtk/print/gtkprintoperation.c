@@ -1953,32 +1953,168 @@ create_page_setup (GtkPrintOperation *op)
   return page_setup;
 }
 
-static void 
+/* When exporting, the pages are recorded on the main thread, and
+ * written to the file by a worker thread. That way, the application
+ * can draw the next page while cairo is generating the previous one.
+ */
+
+/* How many sheets may be waiting for the worker before drawing blocks */
+#define MAX_QUEUED_SHEETS 4
+
+typedef struct
+{
+  cairo_surface_t *recording;
+  double width;
+  double height;
+} PdfSheet;
+
+typedef struct
+{
+  cairo_surface_t *target;
+  GThread *thread;
+  GAsyncQueue *sheets;     /* PdfSheet, an empty one ends the thread */
+  GAsyncQueue *written;    /* one item for every sheet that was written */
+  guint n_queued;
+
+  /* The sheet that is currently being drawn */
+  cairo_surface_t *recording;
+  double width;
+  double height;
+
+  /* The last complete sheet. It is only handed to the worker once
+   * the print context no longer draws to it.
+   */
+  PdfSheet *pending;
+} PdfStream;
+
+static gpointer
+pdf_stream_thread (gpointer data)
+{
+  PdfStream *stream = data;
+
+  while (TRUE)
+    {
+      PdfSheet *sheet = g_async_queue_pop (stream->sheets);
+      cairo_t *cr;
+
+      if (sheet->recording == NULL)
+        {
+          g_free (sheet);
+          break;
+        }
+
+      cairo_pdf_surface_set_size (stream->target, sheet->width, sheet->height);
+
+      cr = cairo_create (stream->target);
+      cairo_set_source_surface (cr, sheet->recording, 0, 0);
+      cairo_paint (cr);
+      cairo_show_page (cr);
+      cairo_destroy (cr);
+
+      cairo_surface_destroy (sheet->recording);
+      g_free (sheet);
+
+      g_async_queue_push (stream->written, GINT_TO_POINTER (1));
+    }
+
+  cairo_surface_finish (stream->target);
+
+  return NULL;
+}
+
+static PdfStream *
+pdf_stream_new (cairo_surface_t *target)
+{
+  PdfStream *stream;
+
+  stream = g_new0 (PdfStream, 1);
+  stream->target = cairo_surface_reference (target);
+  stream->sheets = g_async_queue_new ();
+  stream->written = g_async_queue_new ();
+  stream->thread = g_thread_new ("[gtk] pdf export", pdf_stream_thread, stream);
+
+  return stream;
+}
+
+static void
+pdf_stream_end_sheet (PdfStream *stream)
+{
+  g_assert (stream->pending == NULL);
+
+  stream->pending = g_new (PdfSheet, 1);
+  stream->pending->recording = g_steal_pointer (&stream->recording);
+  stream->pending->width = stream->width;
+  stream->pending->height = stream->height;
+}
+
+static void
+pdf_stream_push_pending (PdfStream *stream)
+{
+  if (stream->pending == NULL)
+    return;
+
+  /* Don't get too far ahead of the worker, recordings can be big */
+  if (stream->n_queued >= MAX_QUEUED_SHEETS)
+    {
+      g_async_queue_pop (stream->written);
+      stream->n_queued--;
+    }
+
+  g_async_queue_push (stream->sheets, g_steal_pointer (&stream->pending));
+  stream->n_queued++;
+}
+
+static void
+pdf_stream_free (PdfStream *stream)
+{
+  pdf_stream_push_pending (stream);
+  g_async_queue_push (stream->sheets, g_new0 (PdfSheet, 1));
+  g_thread_join (stream->thread);
+
+  g_clear_pointer (&stream->recording, cairo_surface_destroy);
+  g_async_queue_unref (stream->sheets);
+  g_async_queue_unref (stream->written);
+  cairo_surface_destroy (stream->target);
+
+  g_free (stream);
+}
+
+static void
 pdf_start_page (GtkPrintOperation *op,
 		GtkPrintContext   *print_context,
 		GtkPageSetup      *page_setup)
 {
-  cairo_surface_t *surface = op->priv->platform_data;
-  double w, h;
+  PdfStream *stream = op->priv->platform_data;
 
-  w = gtk_page_setup_get_paper_width (page_setup, GTK_UNIT_POINTS);
-  h = gtk_page_setup_get_paper_height (page_setup, GTK_UNIT_POINTS);
-  
-  cairo_pdf_surface_set_size (surface, w, h);
+  stream->width = gtk_page_setup_get_paper_width (page_setup, GTK_UNIT_POINTS);
+  stream->height = gtk_page_setup_get_paper_height (page_setup, GTK_UNIT_POINTS);
+
+  /* With multiple pages per sheet, only the first one starts a recording */
+  if (stream->recording == NULL)
+    {
+      cairo_rectangle_t extents = { 0, 0, stream->width, stream->height };
+      cairo_t *cr;
+
+      stream->recording = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA, &extents);
+
+      cr = cairo_create (stream->recording);
+      gtk_print_context_set_cairo_context (print_context, cr, 72, 72);
+      cairo_destroy (cr);
+
+      pdf_stream_push_pending (stream);
+    }
 }
 
 static void
 pdf_end_page (GtkPrintOperation *op,
 	      GtkPrintContext   *print_context)
 {
-  cairo_t *cr;
-
-  cr = gtk_print_context_get_cairo_context (print_context);
+  PdfStream *stream = op->priv->platform_data;
 
   if ((op->priv->manual_number_up < 2) ||
       ((op->priv->page_position + 1) % op->priv->manual_number_up == 0) ||
       (op->priv->page_position == op->priv->nr_of_pages_to_print - 1))
-    cairo_show_page (cr);
+    pdf_stream_end_sheet (stream);
 }
 
 static void
@@ -1987,10 +2123,8 @@ pdf_end_run (GtkPrintOperation *op,
 	     gboolean           cancelled)
 {
   GtkPrintOperationPrivate *priv = gtk_print_operation_get_instance_private (op);
-  cairo_surface_t *surface = priv->platform_data;
 
-  cairo_surface_finish (surface);
-  cairo_surface_destroy (surface);
+  pdf_stream_free (priv->platform_data);
 
   priv->platform_data = NULL;
   priv->free_platform_data = NULL;
@@ -2033,13 +2167,19 @@ run_pdf (GtkPrintOperation  *op,
   /* this would crash on a nil surface */
   cairo_surface_set_fallback_resolution (surface, 300, 300);
 
-  priv->platform_data = surface;
-  priv->free_platform_data = (GDestroyNotify) cairo_surface_destroy;
+  priv->platform_data = pdf_stream_new (surface);
+  priv->free_platform_data = (GDestroyNotify) pdf_stream_free;
+  cairo_surface_destroy (surface);
 
+  /* The surface belongs to the worker now, so until the first page
+   * gets recorded, measure against a recording surface instead.
+   */
+  surface = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA, NULL);
   cr = cairo_create (surface);
   gtk_print_context_set_cairo_context (op->priv->print_context,
 				       cr, 72, 72);
   cairo_destroy (cr);
+  cairo_surface_destroy (surface);
 
   
   priv->print_pages = GTK_PRINT_PAGES_ALL;
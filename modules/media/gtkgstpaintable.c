@@ -35,8 +35,22 @@ struct _GtkGstPaintable
   GdkPaintable *image;
   double pixel_aspect_ratio;
   graphene_rect_t viewport;
+  gboolean image_drawn;
 
   GdkGLContext *context;
+
+  /* The latest frame from the streaming thread, waiting to be picked
+   * up by the main thread. Frames arriving faster than the main thread
+   * can pick them up replace each other here.
+   */
+  GMutex pending_lock;
+  GdkTexture *pending_texture;
+  double pending_pixel_aspect_ratio;
+  graphene_rect_t pending_viewport;
+  guint n_skipped_frames;
+
+  /* Frames that reached the main thread but never got drawn */
+  guint n_undrawn_frames;
 };
 
 struct _GtkGstPaintableClass
@@ -56,6 +70,8 @@ gtk_gst_paintable_paintable_snapshot (GdkPaintable *paintable,
     {
       float sx, sy;
 
+      self->image_drawn = TRUE;
+
       gtk_snapshot_save (snapshot);
 
       sx = gdk_paintable_get_intrinsic_width (self->image) / self->viewport.size.width;
@@ -187,23 +203,43 @@ static void
 gtk_gst_paintable_dispose (GObject *object)
 {
   GtkGstPaintable *self = GTK_GST_PAINTABLE (object);
-  
+
   g_clear_object (&self->image);
 
+  g_mutex_lock (&self->pending_lock);
+  g_clear_object (&self->pending_texture);
+  g_mutex_unlock (&self->pending_lock);
+
   G_OBJECT_CLASS (gtk_gst_paintable_parent_class)->dispose (object);
 }
 
+static void
+gtk_gst_paintable_finalize (GObject *object)
+{
+  GtkGstPaintable *self = GTK_GST_PAINTABLE (object);
+
+  GST_INFO ("Dropped %u frames before and %u frames after they reached the main thread",
+            self->n_skipped_frames, self->n_undrawn_frames);
+
+  g_clear_object (&self->pending_texture);
+  g_mutex_clear (&self->pending_lock);
+
+  G_OBJECT_CLASS (gtk_gst_paintable_parent_class)->finalize (object);
+}
+
 static void
 gtk_gst_paintable_class_init (GtkGstPaintableClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
   object_class->dispose = gtk_gst_paintable_dispose;
+  object_class->finalize = gtk_gst_paintable_finalize;
 }
 
 static void
 gtk_gst_paintable_init (GtkGstPaintable *self)
 {
+  g_mutex_init (&self->pending_lock);
 }
 
 GdkPaintable *
@@ -277,7 +313,11 @@ gtk_gst_paintable_set_paintable (GtkGstPaintable       *self,
   else
     size_changed = FALSE;
 
+  if (self->image != NULL && !self->image_drawn)
+    self->n_undrawn_frames++;
+
   g_set_object (&self->image, paintable);
+  self->image_drawn = FALSE;
   self->pixel_aspect_ratio = pixel_aspect_ratio;
   self->viewport = *viewport;
 
@@ -287,33 +327,28 @@ gtk_gst_paintable_set_paintable (GtkGstPaintable       *self,
   gdk_paintable_invalidate_contents (GDK_PAINTABLE (self));
 }
 
-typedef struct _SetTextureInvocation SetTextureInvocation;
-
-struct _SetTextureInvocation {
-  GtkGstPaintable *paintable;
-  GdkTexture      *texture;
-  double           pixel_aspect_ratio;
-  graphene_rect_t  viewport;
-};
-
-static void
-set_texture_invocation_free (SetTextureInvocation *invoke)
-{
-  g_object_unref (invoke->paintable);
-  g_object_unref (invoke->texture);
-
-  g_free (invoke);
-}
-
 static gboolean
 gtk_gst_paintable_set_texture_invoke (gpointer data)
 {
-  SetTextureInvocation *invoke = data;
+  GtkGstPaintable *self = data;
+  GdkTexture *texture;
+  double pixel_aspect_ratio;
+  graphene_rect_t viewport;
 
-  gtk_gst_paintable_set_paintable (invoke->paintable,
-                                   GDK_PAINTABLE (invoke->texture),
-                                   invoke->pixel_aspect_ratio,
-                                   &invoke->viewport);
+  g_mutex_lock (&self->pending_lock);
+  texture = g_steal_pointer (&self->pending_texture);
+  pixel_aspect_ratio = self->pending_pixel_aspect_ratio;
+  viewport = self->pending_viewport;
+  g_mutex_unlock (&self->pending_lock);
+
+  if (texture)
+    {
+      gtk_gst_paintable_set_paintable (self,
+                                       GDK_PAINTABLE (texture),
+                                       pixel_aspect_ratio,
+                                       &viewport);
+      g_object_unref (texture);
+    }
 
   return G_SOURCE_REMOVE;
 }
@@ -324,18 +359,28 @@ gtk_gst_paintable_queue_set_texture (GtkGstPaintable       *self,
                                      double                 pixel_aspect_ratio,
                                      const graphene_rect_t *viewport)
 {
-  SetTextureInvocation *invoke;
-
-  invoke = g_new0 (SetTextureInvocation, 1);
-  invoke->paintable = g_object_ref (self);
-  invoke->texture = g_object_ref (texture);
-  invoke->pixel_aspect_ratio = pixel_aspect_ratio;
-  invoke->viewport = *viewport;
-
-  g_main_context_invoke_full (NULL,
-                              G_PRIORITY_DEFAULT,
-                              gtk_gst_paintable_set_texture_invoke,
-                              invoke,
-                              (GDestroyNotify) set_texture_invocation_free);
-}
+  gboolean needs_invoke;
 
+  g_mutex_lock (&self->pending_lock);
+
+  /* If the main thread hasn't picked up the previous frame yet, there
+   * is no point in showing it anymore, so only keep the newest one and
+   * don't queue another invocation
+   */
+  needs_invoke = self->pending_texture == NULL;
+  if (!needs_invoke)
+    self->n_skipped_frames++;
+
+  g_set_object (&self->pending_texture, texture);
+  self->pending_pixel_aspect_ratio = pixel_aspect_ratio;
+  self->pending_viewport = *viewport;
+
+  g_mutex_unlock (&self->pending_lock);
+
+  if (needs_invoke)
+    g_main_context_invoke_full (NULL,
+                                G_PRIORITY_DEFAULT,
+                                gtk_gst_paintable_set_texture_invoke,
+                                g_object_ref (self),
+                                g_object_unref);
+}
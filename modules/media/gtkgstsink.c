@@ -261,9 +261,6 @@ gtk_gst_sink_propose_allocation (GstBaseSink *bsink,
   gboolean need_pool;
   GstVideoInfo info;
 
-  if (!self->gst_context)
-    return FALSE;
-
   gst_query_parse_allocation (query, &caps, &need_pool);
 
   if (caps == NULL)
@@ -272,6 +269,19 @@ gtk_gst_sink_propose_allocation (GstBaseSink *bsink,
       return FALSE;
     }
 
+  /* We wrap mapped system memory frames in memory textures as they are,
+   * so let upstream hand us buffers with its own strides and offsets
+   * instead of making it copy into tightly packed ones.
+   */
+  if (gst_caps_features_is_equal (gst_caps_get_features (caps, 0), GST_CAPS_FEATURES_MEMORY_SYSTEM_MEMORY))
+    {
+      gst_query_add_allocation_meta (query, GST_VIDEO_META_API_TYPE, 0);
+      return TRUE;
+    }
+
+  if (!self->gst_context)
+    return FALSE;
+
 #ifdef HAVE_GSTREAMER_DRM
   if (gst_caps_features_contains (gst_caps_get_features (caps, 0), GST_CAPS_FEATURE_MEMORY_DMABUF))
     {
@@ -422,7 +432,9 @@ gtk_gst_sink_texture_from_buffer (GtkGstSink      *self,
                                                   (GDestroyNotify) gst_buffer_unref,
                                                   gst_buffer_ref (buffer),
                                                   &error);
-      if (!texture)
+      if (texture)
+        self->n_dmabuf_frames++;
+      else
         GST_ERROR_OBJECT (self, "Failed to create dmabuf texture: %s", error->message);
 
       *pixel_aspect_ratio = ((double) GST_VIDEO_INFO_PAR_N (&self->v_info) /
@@ -460,6 +472,8 @@ gtk_gst_sink_texture_from_buffer (GtkGstSink      *self,
 
       g_object_unref (builder);
 
+      self->n_gl_frames++;
+
       *pixel_aspect_ratio = ((double) frame->info.par_n) / ((double) frame->info.par_d);
     }
   else if (gst_video_frame_map (frame, &self->v_info, buffer, GST_MAP_READ))
@@ -477,6 +491,9 @@ gtk_gst_sink_texture_from_buffer (GtkGstSink      *self,
                                         frame->info.stride[0]);
       g_bytes_unref (bytes);
 
+      /* These have to be uploaded by the renderer, every frame */
+      self->n_memory_frames++;
+
       *pixel_aspect_ratio = ((double) frame->info.par_n) / ((double) frame->info.par_d);
     }
   else
@@ -516,6 +533,25 @@ gtk_gst_sink_show_frame (GstVideoSink *vsink,
   return GST_FLOW_OK;
 }
 
+static gboolean
+gtk_gst_sink_stop (GstBaseSink *bsink)
+{
+  GtkGstSink *self = GTK_GST_SINK (bsink);
+
+  GST_OBJECT_LOCK (self);
+
+  GST_INFO_OBJECT (self, "Showed %u dmabuf, %u GL and %u system memory frames",
+                   self->n_dmabuf_frames, self->n_gl_frames, self->n_memory_frames);
+
+  self->n_dmabuf_frames = 0;
+  self->n_gl_frames = 0;
+  self->n_memory_frames = 0;
+
+  GST_OBJECT_UNLOCK (self);
+
+  return TRUE;
+}
+
 static gboolean
 gtk_gst_sink_initialize_gl (GtkGstSink *self)
 {
@@ -796,6 +832,7 @@ gtk_gst_sink_class_init (GtkGstSinkClass * klass)
   gstbasesink_class->query = gtk_gst_sink_query;
   gstbasesink_class->propose_allocation = gtk_gst_sink_propose_allocation;
   gstbasesink_class->get_caps = gtk_gst_sink_get_caps;
+  gstbasesink_class->stop = gtk_gst_sink_stop;
 
   gstvideosink_class->show_frame = gtk_gst_sink_show_frame;
 
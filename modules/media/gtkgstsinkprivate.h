@@ -57,6 +57,11 @@ struct _GtkGstSink
   GstGLContext *       gst_gdk_context;
   GstGLContext *       gst_context;
   GdkDmabufFormats *   dmabuf_formats;
+
+  /* Frames shown since starting, by how they were imported */
+  guint                n_dmabuf_frames;
+  guint                n_gl_frames;
+  guint                n_memory_frames;
 };
 
 struct _GtkGstSinkClass
@@ -16,16 +16,52 @@ init_surface (cairo_t *cr)
   cairo_fill (cr);
 }
 
+/* Blurs at 1/downsample resolution and scales the result back up,
+ * like the GPU renderer does for large radii */
+static void
+blur_surface_downsampled (cairo_surface_t *surface,
+                          int              radius,
+                          int              downsample)
+{
+  int w = cairo_image_surface_get_width (surface);
+  int h = cairo_image_surface_get_height (surface);
+  cairo_surface_t *small;
+  cairo_t *cr;
+
+  small = cairo_image_surface_create (CAIRO_FORMAT_A8, w / downsample, h / downsample);
+
+  cr = cairo_create (small);
+  cairo_scale (cr, 1.0 / downsample, 1.0 / downsample);
+  cairo_set_source_surface (cr, surface, 0, 0);
+  cairo_paint (cr);
+  cairo_destroy (cr);
+
+  gsk_cairo_blur_surface (small, (double) radius / downsample, GSK_BLUR_X | GSK_BLUR_Y);
+
+  cr = cairo_create (surface);
+  cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
+  cairo_scale (cr, downsample, downsample);
+  cairo_set_source_surface (cr, small, 0, 0);
+  cairo_pattern_set_filter (cairo_get_source (cr), CAIRO_FILTER_BILINEAR);
+  cairo_paint (cr);
+  cairo_destroy (cr);
+
+  cairo_surface_destroy (small);
+}
+
 int
 main (int argc, char **argv)
 {
   cairo_surface_t *surface;
   cairo_t *cr;
   GTimer *timer;
-  double msec;
+  double msec, downsampled_msec;
+  gboolean compare;
   int i, j;
   int size;
 
+  compare = argc > 1 && g_str_equal (argv[1], "--compare");
+
   timer = g_timer_new ();
 
   size = 2000;
@@ -48,6 +84,34 @@ main (int argc, char **argv)
 	}
     }
 
+  /* Compare full resolution with downsampling for large radii */
+  if (compare)
+    {
+      for (j = 0; j < 2; j++)
+        {
+          for (i = 32; i <= 256; i *= 2)
+            {
+              int downsample = MIN (i / 16, 8);
+
+              init_surface (cr);
+              g_timer_start (timer);
+              gsk_cairo_blur_surface (surface, i, GSK_BLUR_X | GSK_BLUR_Y);
+              msec = g_timer_elapsed (timer, NULL) * 1000;
+
+              init_surface (cr);
+              g_timer_start (timer);
+              blur_surface_downsampled (surface, i, downsample);
+              downsampled_msec = g_timer_elapsed (timer, NULL) * 1000;
+
+              if (j == 1)
+                g_print ("Radius %3d: full %.2f msec, downsampled %dx %.2f msec\n",
+                         i, msec, downsample, downsampled_msec);
+            }
+        }
+    }
+
+  cairo_destroy (cr);
+  cairo_surface_destroy (surface);
   g_timer_destroy (timer);
 
   return 0;
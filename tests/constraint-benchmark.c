@@ -0,0 +1,332 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+/* Repeatable benchmarks for GtkConstraintLayout.
+ *
+ * Every benchmark builds a form with one label and one entry per row,
+ * laid out with a GtkConstraintLayout, for every size between --min-rows
+ * and --max-rows (doubling each time). Each row adds 8 to 10 variables
+ * to the solver, so the default sizes cover systems of roughly 1000 to
+ * 10000 variables.
+ *
+ * The form is put into a window that is never shown, and measured and
+ * allocated directly, so no frame clock or rendering is involved.
+ */
+
+#include "config.h"
+
+#include <gtk/gtk.h>
+#include <string.h>
+
+#include "variable.h"
+
+static int min_rows = 100;
+static int max_rows = 1000;
+static int repeats = 3;
+static int n_resizes = 100;
+static char *only = NULL;
+static gboolean machine_readable = FALSE;
+
+static GOptionEntry options[] = {
+  { "min-rows", 0, 0, G_OPTION_ARG_INT, &min_rows, "Smallest number of form rows", "N" },
+  { "max-rows", 0, 0, G_OPTION_ARG_INT, &max_rows, "Largest number of form rows", "N" },
+  { "repeats", 'r', 0, G_OPTION_ARG_INT, &repeats, "Runs to average over", "N" },
+  { "resizes", 0, 0, G_OPTION_ARG_INT, &n_resizes, "Allocations per resize benchmark", "N" },
+  { "benchmark", 'b', 0, G_OPTION_ARG_STRING, &only, "Only run benchmarks containing NAME", "NAME" },
+  { "machine-readable", 0, 0, G_OPTION_ARG_NONE, &machine_readable, "Print results in tab-separated columns", NULL },
+  { NULL }
+};
+
+typedef GtkWidget FormWidget;
+typedef GtkWidgetClass FormWidgetClass;
+
+GType form_widget_get_type (void);
+
+G_DEFINE_TYPE (FormWidget, form_widget, GTK_TYPE_WIDGET)
+
+static void
+form_widget_dispose (GObject *object)
+{
+  GtkWidget *child;
+
+  while ((child = gtk_widget_get_first_child (GTK_WIDGET (object))))
+    gtk_widget_unparent (child);
+
+  G_OBJECT_CLASS (form_widget_parent_class)->dispose (object);
+}
+
+static void
+form_widget_class_init (FormWidgetClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = form_widget_dispose;
+
+  gtk_widget_class_set_layout_manager_type (klass, GTK_TYPE_CONSTRAINT_LAYOUT);
+}
+
+static void
+form_widget_init (FormWidget *self)
+{
+}
+
+static void
+add_constraint (GtkConstraintLayout    *layout,
+                gpointer                target,
+                GtkConstraintAttribute  target_attr,
+                GtkConstraintRelation   relation,
+                gpointer                source,
+                GtkConstraintAttribute  source_attr,
+                double                  constant,
+                int                     strength)
+{
+  gtk_constraint_layout_add_constraint (layout,
+                                        gtk_constraint_new (target, target_attr,
+                                                            relation,
+                                                            source, source_attr,
+                                                            1.0, constant,
+                                                            strength));
+}
+
+static GtkWidget *
+create_form (int n_rows)
+{
+  GtkConstraintLayout *layout;
+  GtkWidget *form, *previous;
+  int i;
+
+  form = g_object_new (form_widget_get_type (), NULL);
+  layout = GTK_CONSTRAINT_LAYOUT (gtk_widget_get_layout_manager (form));
+
+  previous = NULL;
+  for (i = 0; i < n_rows; i++)
+    {
+      GtkWidget *label, *entry;
+      char *text;
+
+      text = g_strdup_printf ("Field %d", i);
+      label = gtk_label_new (text);
+      g_free (text);
+      entry = gtk_entry_new ();
+
+      gtk_widget_set_parent (label, form);
+      gtk_widget_set_parent (entry, form);
+
+      add_constraint (layout, label, GTK_CONSTRAINT_ATTRIBUTE_START,
+                      GTK_CONSTRAINT_RELATION_EQ,
+                      NULL, GTK_CONSTRAINT_ATTRIBUTE_START,
+                      8, GTK_CONSTRAINT_STRENGTH_REQUIRED);
+      add_constraint (layout, entry, GTK_CONSTRAINT_ATTRIBUTE_START,
+                      GTK_CONSTRAINT_RELATION_EQ,
+                      label, GTK_CONSTRAINT_ATTRIBUTE_END,
+                      12, GTK_CONSTRAINT_STRENGTH_REQUIRED);
+      add_constraint (layout, entry, GTK_CONSTRAINT_ATTRIBUTE_END,
+                      GTK_CONSTRAINT_RELATION_EQ,
+                      NULL, GTK_CONSTRAINT_ATTRIBUTE_END,
+                      -8, GTK_CONSTRAINT_STRENGTH_REQUIRED);
+      add_constraint (layout, entry, GTK_CONSTRAINT_ATTRIBUTE_TOP,
+                      GTK_CONSTRAINT_RELATION_EQ,
+                      previous, previous ? GTK_CONSTRAINT_ATTRIBUTE_BOTTOM : GTK_CONSTRAINT_ATTRIBUTE_TOP,
+                      6, GTK_CONSTRAINT_STRENGTH_REQUIRED);
+      add_constraint (layout, label, GTK_CONSTRAINT_ATTRIBUTE_BASELINE,
+                      GTK_CONSTRAINT_RELATION_EQ,
+                      entry, GTK_CONSTRAINT_ATTRIBUTE_BASELINE,
+                      0, GTK_CONSTRAINT_STRENGTH_STRONG);
+
+      /* Give all labels the same width, so the entries line up */
+      if (previous != NULL)
+        add_constraint (layout, label, GTK_CONSTRAINT_ATTRIBUTE_WIDTH,
+                        GTK_CONSTRAINT_RELATION_EQ,
+                        gtk_widget_get_prev_sibling (previous),
+                        GTK_CONSTRAINT_ATTRIBUTE_WIDTH,
+                        0, GTK_CONSTRAINT_STRENGTH_MEDIUM);
+
+      previous = entry;
+    }
+
+  add_constraint (layout, NULL, GTK_CONSTRAINT_ATTRIBUTE_BOTTOM,
+                  GTK_CONSTRAINT_RELATION_GE,
+                  previous, GTK_CONSTRAINT_ATTRIBUTE_BOTTOM,
+                  6, GTK_CONSTRAINT_STRENGTH_REQUIRED);
+
+  return form;
+}
+
+typedef struct
+{
+  GtkWidget *window;
+  GtkWidget *form;
+  int width;
+  int height;
+} Form;
+
+static void
+form_init (Form *form,
+           int   n_rows)
+{
+  form->window = gtk_window_new ();
+  form->form = create_form (n_rows);
+  gtk_window_set_child (GTK_WINDOW (form->window), form->form);
+
+  gtk_widget_measure (form->form, GTK_ORIENTATION_HORIZONTAL, -1,
+                      NULL, &form->width, NULL, NULL);
+  gtk_widget_measure (form->form, GTK_ORIENTATION_VERTICAL, form->width,
+                      NULL, &form->height, NULL, NULL);
+}
+
+static void
+form_clear (Form *form)
+{
+  gtk_window_destroy (GTK_WINDOW (form->window));
+}
+
+static void
+form_allocate (Form *form,
+               int   width,
+               int   height)
+{
+  gtk_widget_allocate (form->form, width, height, -1, NULL);
+}
+
+static double
+bench_build (int n_rows)
+{
+  Form form;
+  gint64 start;
+  double result;
+
+  start = g_get_monotonic_time ();
+  form_init (&form, n_rows);
+  form_allocate (&form, form.width, form.height);
+  result = (g_get_monotonic_time () - start) / 1000.0;
+
+  form_clear (&form);
+
+  return result;
+}
+
+/* The parent hands out new sizes without measuring the form again,
+ * like a paned or a box would do
+ */
+static double
+bench_resize (int n_rows)
+{
+  Form form;
+  gint64 start;
+  double result;
+  int i;
+
+  form_init (&form, n_rows);
+  form_allocate (&form, form.width, form.height);
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < n_resizes; i++)
+    form_allocate (&form, form.width + i % 50, form.height + i % 20);
+  result = (g_get_monotonic_time () - start) / 1000.0 / n_resizes;
+
+  form_clear (&form);
+
+  return result;
+}
+
+/* Every new size is measured before it is allocated, like
+ * interactively resizing a window does
+ */
+static double
+bench_measure_resize (int n_rows)
+{
+  Form form;
+  gint64 start;
+  double result;
+  int i;
+
+  form_init (&form, n_rows);
+  form_allocate (&form, form.width, form.height);
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < n_resizes; i++)
+    {
+      int width = form.width + i % 50;
+      int height;
+
+      gtk_widget_measure (form.form, GTK_ORIENTATION_VERTICAL, width,
+                          NULL, &height, NULL, NULL);
+      form_allocate (&form, width, height);
+    }
+  result = (g_get_monotonic_time () - start) / 1000.0 / n_resizes;
+
+  form_clear (&form);
+
+  return result;
+}
+
+static struct {
+  const char *name;
+  double (* run) (int n_rows);
+} benchmarks[] = {
+  { "build", bench_build },
+  { "resize", bench_resize },
+  { "measure-resize", bench_measure_resize },
+};
+
+static void
+print_header (void)
+{
+  if (machine_readable)
+    g_print ("# benchmark\trows\tms\tstddev\n");
+}
+
+static void
+run_benchmark (const char *name,
+               double (* run) (int n_rows),
+               int         n_rows)
+{
+  Variable time = VARIABLE_INIT;
+  int i;
+
+  for (i = 0; i < repeats; i++)
+    variable_add (&time, run (n_rows));
+
+  if (machine_readable)
+    g_print ("%s\t%d\t%g\t%g\n",
+             name, n_rows,
+             variable_mean (&time), variable_standard_deviation (&time));
+  else
+    g_print ("%-16s %6d rows: %10.3f +/- %.3f ms\n",
+             name, n_rows,
+             variable_mean (&time), variable_standard_deviation (&time));
+}
+
+int
+main (int argc, char *argv[])
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  int n_rows;
+  gsize i;
+
+  context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  gtk_init ();
+
+  print_header ();
+
+  for (n_rows = min_rows; n_rows <= max_rows; n_rows *= 2)
+    {
+      for (i = 0; i < G_N_ELEMENTS (benchmarks); i++)
+        {
+          if (only && !strstr (benchmarks[i].name, only))
+            continue;
+
+          run_benchmark (benchmarks[i].name, benchmarks[i].run, n_rows);
+        }
+    }
+
+  return 0;
+}
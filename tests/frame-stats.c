@@ -18,6 +18,11 @@ struct FrameStats
   gint64 last_handled_frame;
 
   Variable latency;
+  Variable update_time;
+  Variable layout_time;
+  Variable paint_time;
+  Variable render_time;
+  Variable queue_latency;
 };
 
 static int max_stats = -1;
@@ -85,7 +90,7 @@ on_frame_clock_after_paint (GdkFrameClock *frame_clock,
         {
           if (frame_stats->num_stats == 0 && machine_readable)
             {
-              g_print ("# load_factor frame_rate latency\n");
+              g_print ("# load_factor frame_rate latency update layout paint render queue_latency\n");
             }
 
           frame_stats->num_stats++;
@@ -94,6 +99,11 @@ on_frame_clock_after_paint (GdkFrameClock *frame_clock,
                         ((current_time - frame_stats->last_print_time) / 1000000.));
 
           print_variable ("Latency", &frame_stats->latency);
+          print_variable ("Update time", &frame_stats->update_time);
+          print_variable ("Layout time", &frame_stats->layout_time);
+          print_variable ("Paint time", &frame_stats->paint_time);
+          print_variable ("Render time", &frame_stats->render_time);
+          print_variable ("Queue latency", &frame_stats->queue_latency);
 
           g_print ("\n");
         }
@@ -101,6 +111,11 @@ on_frame_clock_after_paint (GdkFrameClock *frame_clock,
       frame_stats->last_print_time = current_time;
       frame_stats->frames_since_last_print = 0;
       variable_init (&frame_stats->latency);
+      variable_init (&frame_stats->update_time);
+      variable_init (&frame_stats->layout_time);
+      variable_init (&frame_stats->paint_time);
+      variable_init (&frame_stats->render_time);
+      variable_init (&frame_stats->queue_latency);
 
       if (frame_stats->num_stats == max_stats)
         exit (0);
@@ -127,6 +142,16 @@ on_frame_clock_after_paint (GdkFrameClock *frame_clock,
 
           variable_add_weighted (&frame_stats->latency, frame_latency, display_time);
         }
+
+      if (timings && gdk_frame_timings_get_complete (timings))
+        {
+          variable_add (&frame_stats->update_time, gdk_frame_timings_get_update_duration (timings) / 1000.);
+          variable_add (&frame_stats->layout_time, gdk_frame_timings_get_layout_duration (timings) / 1000.);
+          variable_add (&frame_stats->paint_time, gdk_frame_timings_get_paint_duration (timings) / 1000.);
+          variable_add (&frame_stats->render_time, gdk_frame_timings_get_render_duration (timings) / 1000.);
+          if (gdk_frame_timings_get_presentation_latency (timings) != 0)
+            variable_add (&frame_stats->queue_latency, gdk_frame_timings_get_presentation_latency (timings) / 1000.);
+        }
     }
 }
 
@@ -169,6 +194,11 @@ frame_stats_ensure (GtkWindow *window)
   g_object_set_data (G_OBJECT (window), "frame-stats", frame_stats);
 
   variable_init (&frame_stats->latency);
+  variable_init (&frame_stats->update_time);
+  variable_init (&frame_stats->layout_time);
+  variable_init (&frame_stats->paint_time);
+  variable_init (&frame_stats->render_time);
+  variable_init (&frame_stats->queue_latency);
   frame_stats->last_handled_frame = -1;
 
   g_signal_connect (window, "realize",
@@ -0,0 +1,524 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+/* Repeatable benchmarks for list model pipelines and list widgets.
+ *
+ * The model benchmarks build a fresh pipeline on top of a GtkStringList
+ * for every size between --min-items and --max-items (in steps of 10)
+ * and report the time per item and the memory that the pipeline keeps
+ * allocated.
+ *
+ * The scroll benchmarks sweep a GtkListView and a GtkColumnView from
+ * top to bottom. The scroll position is computed from the frame number,
+ * not the frame time, so every run renders the same sequence of frames.
+ * Run with GDK_DEBUG=no-vsync to not be limited by the refresh rate.
+ */
+
+#include "config.h"
+
+#include <gtk/gtk.h>
+#include <string.h>
+
+#ifdef HAVE_MALLINFO2
+#include <malloc.h>
+#endif
+
+#include "variable.h"
+
+static int min_items = 10000;
+static int max_items = 1000000;
+static int repeats = 3;
+static int n_frames = 300;
+static char *only = NULL;
+static gboolean scroll = FALSE;
+static gboolean machine_readable = FALSE;
+
+static GOptionEntry options[] = {
+  { "min-items", 0, 0, G_OPTION_ARG_INT, &min_items, "Smallest number of items", "N" },
+  { "max-items", 0, 0, G_OPTION_ARG_INT, &max_items, "Largest number of items", "N" },
+  { "repeats", 'r', 0, G_OPTION_ARG_INT, &repeats, "Runs to average over", "N" },
+  { "frames", 'f', 0, G_OPTION_ARG_INT, &n_frames, "Frames per scroll benchmark", "N" },
+  { "benchmark", 'b', 0, G_OPTION_ARG_STRING, &only, "Only run benchmarks containing NAME", "NAME" },
+  { "scroll", 0, 0, G_OPTION_ARG_NONE, &scroll, "Run the widget scroll benchmarks", NULL },
+  { "machine-readable", 0, 0, G_OPTION_ARG_NONE, &machine_readable, "Print results in tab-separated columns", NULL },
+  { NULL }
+};
+
+static gssize
+get_allocated_bytes (void)
+{
+#ifdef HAVE_MALLINFO2
+  return (gssize) mallinfo2 ().uordblks;
+#else
+  return 0;
+#endif
+}
+
+static GListModel *
+create_source (guint n_items)
+{
+  GtkStringList *list;
+  GRand *rand;
+  guint i;
+
+  list = gtk_string_list_new (NULL);
+  rand = g_rand_new_with_seed (42);
+
+  for (i = 0; i < n_items; i++)
+    gtk_string_list_take (list, g_strdup_printf ("%08x", g_rand_int (rand)));
+
+  g_rand_free (rand);
+
+  return G_LIST_MODEL (list);
+}
+
+/* Touch every item, so that lazy models do their work */
+static void
+iterate_model (GListModel *model)
+{
+  guint i, n_items;
+
+  n_items = g_list_model_get_n_items (model);
+  for (i = 0; i < n_items; i++)
+    g_object_unref (g_list_model_get_item (model, i));
+}
+
+static guint
+get_number (GtkStringObject *object)
+{
+  return g_ascii_strtoull (gtk_string_object_get_string (object), NULL, 16);
+}
+
+static gboolean
+filter_odd (gpointer item,
+            gpointer data)
+{
+  return get_number (item) & 1;
+}
+
+static gpointer
+map_to_self (gpointer item,
+             gpointer data)
+{
+  return item;
+}
+
+static GListModel *
+bench_sort_string (GListModel *source)
+{
+  GtkSorter *sorter;
+
+  sorter = GTK_SORTER (gtk_string_sorter_new (gtk_property_expression_new (GTK_TYPE_STRING_OBJECT, NULL, "string")));
+
+  return G_LIST_MODEL (gtk_sort_list_model_new (g_object_ref (source), sorter));
+}
+
+static GListModel *
+bench_sort_numeric (GListModel *source)
+{
+  GtkSorter *sorter;
+
+  sorter = GTK_SORTER (gtk_numeric_sorter_new (gtk_cclosure_expression_new (G_TYPE_UINT,
+                                                                            NULL,
+                                                                            0, NULL,
+                                                                            G_CALLBACK (get_number),
+                                                                            NULL, NULL)));
+
+  return G_LIST_MODEL (gtk_sort_list_model_new (g_object_ref (source), sorter));
+}
+
+static GListModel *
+bench_filter (GListModel *source)
+{
+  GtkFilter *filter;
+
+  filter = GTK_FILTER (gtk_custom_filter_new (filter_odd, NULL, NULL));
+
+  return G_LIST_MODEL (gtk_filter_list_model_new (g_object_ref (source), filter));
+}
+
+static GListModel *
+bench_filter_string (GListModel *source)
+{
+  GtkStringFilter *filter;
+
+  filter = gtk_string_filter_new (gtk_property_expression_new (GTK_TYPE_STRING_OBJECT, NULL, "string"));
+  gtk_string_filter_set_search (filter, "a");
+
+  return G_LIST_MODEL (gtk_filter_list_model_new (g_object_ref (source), GTK_FILTER (filter)));
+}
+
+static GListModel *
+bench_map (GListModel *source)
+{
+  GListModel *model;
+
+  model = G_LIST_MODEL (gtk_map_list_model_new (g_object_ref (source), map_to_self, NULL, NULL));
+  iterate_model (model);
+
+  return model;
+}
+
+static GListModel *
+bench_flatten (GListModel *source)
+{
+  GListStore *store;
+  GListModel *model;
+  guint i, n_items;
+
+  /* Split the source into chunks of 1000 items */
+  store = g_list_store_new (G_TYPE_LIST_MODEL);
+  n_items = g_list_model_get_n_items (source);
+  for (i = 0; i < n_items; i += 1000)
+    {
+      GtkSliceListModel *slice = gtk_slice_list_model_new (g_object_ref (source), i, 1000);
+      g_list_store_append (store, slice);
+      g_object_unref (slice);
+    }
+
+  model = G_LIST_MODEL (gtk_flatten_list_model_new (G_LIST_MODEL (store)));
+  iterate_model (model);
+
+  return model;
+}
+
+static GListModel *
+bench_pipeline (GListModel *source)
+{
+  GListModel *model;
+
+  model = bench_filter (source);
+  model = G_LIST_MODEL (gtk_sort_list_model_new (model,
+                                                 GTK_SORTER (gtk_string_sorter_new (gtk_property_expression_new (GTK_TYPE_STRING_OBJECT, NULL, "string")))));
+  model = G_LIST_MODEL (gtk_map_list_model_new (model, map_to_self, NULL, NULL));
+  iterate_model (model);
+
+  return model;
+}
+
+static struct {
+  const char *name;
+  GListModel * (* create) (GListModel *source);
+} model_benchmarks[] = {
+  { "sort-string", bench_sort_string },
+  { "sort-numeric", bench_sort_numeric },
+  { "filter", bench_filter },
+  { "filter-string", bench_filter_string },
+  { "map", bench_map },
+  { "flatten", bench_flatten },
+  { "pipeline", bench_pipeline },
+};
+
+static void
+print_header (void)
+{
+  if (machine_readable)
+    g_print ("# benchmark\titems\tns/item\tstddev\tbytes\n");
+}
+
+static void
+run_model_benchmark (const char *name,
+                     GListModel * (* create) (GListModel *source),
+                     GListModel *source)
+{
+  Variable time = VARIABLE_INIT;
+  gssize allocated = 0;
+  guint n_items;
+  int i;
+
+  n_items = g_list_model_get_n_items (source);
+
+  for (i = 0; i < repeats; i++)
+    {
+      GListModel *model;
+      gssize bytes_before;
+      gint64 start;
+
+      bytes_before = get_allocated_bytes ();
+      start = g_get_monotonic_time ();
+
+      model = create (source);
+
+      variable_add (&time, (g_get_monotonic_time () - start) * 1000.0 / n_items);
+      allocated = MAX (allocated, get_allocated_bytes () - bytes_before);
+
+      g_object_unref (model);
+    }
+
+  if (machine_readable)
+    g_print ("%s\t%u\t%g\t%g\t%" G_GSSIZE_FORMAT "\n",
+             name, n_items,
+             variable_mean (&time), variable_standard_deviation (&time),
+             allocated);
+  else
+    g_print ("%-16s %10u items: %10.1f +/- %.1f ns/item, %" G_GSSIZE_FORMAT "k allocated\n",
+             name, n_items,
+             variable_mean (&time), variable_standard_deviation (&time),
+             allocated / 1024);
+}
+
+static void
+run_model_benchmarks (void)
+{
+  guint64 n_items;
+  gsize i;
+
+  for (n_items = min_items; n_items <= max_items; n_items *= 10)
+    {
+      GListModel *source = create_source (n_items);
+
+      for (i = 0; i < G_N_ELEMENTS (model_benchmarks); i++)
+        {
+          if (only && !strstr (model_benchmarks[i].name, only))
+            continue;
+
+          run_model_benchmark (model_benchmarks[i].name, model_benchmarks[i].create, source);
+        }
+
+      g_object_unref (source);
+    }
+}
+
+typedef struct
+{
+  const char *name;
+  guint n_items;
+  GtkWidget *window;
+  GtkAdjustment *adjustment;
+  int frame;
+  gint64 frame_start;
+  gint64 last_frame_end;
+  Variable frame_time;
+  Variable frame_interval;
+  gboolean done;
+} ScrollBenchmark;
+
+static void
+setup_cb (GtkSignalListItemFactory *factory,
+          GtkListItem              *item,
+          gpointer                  data)
+{
+  gtk_list_item_set_child (item, gtk_label_new (NULL));
+}
+
+static void
+bind_cb (GtkSignalListItemFactory *factory,
+         GtkListItem              *item,
+         gpointer                  data)
+{
+  GtkStringObject *object = gtk_list_item_get_item (item);
+
+  gtk_label_set_label (GTK_LABEL (gtk_list_item_get_child (item)),
+                       gtk_string_object_get_string (object));
+}
+
+static GtkListItemFactory *
+create_factory (void)
+{
+  GtkListItemFactory *factory;
+
+  factory = gtk_signal_list_item_factory_new ();
+  g_signal_connect (factory, "setup", G_CALLBACK (setup_cb), NULL);
+  g_signal_connect (factory, "bind", G_CALLBACK (bind_cb), NULL);
+
+  return factory;
+}
+
+static GtkWidget *
+create_list_view (GListModel     *source,
+                  GtkAdjustment **adjustment)
+{
+  GtkWidget *view;
+
+  view = gtk_list_view_new (GTK_SELECTION_MODEL (gtk_no_selection_new (g_object_ref (source))),
+                            create_factory ());
+  *adjustment = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (view));
+
+  return view;
+}
+
+static GtkWidget *
+create_column_view (GListModel     *source,
+                    GtkAdjustment **adjustment)
+{
+  GtkWidget *view;
+  int i;
+
+  view = gtk_column_view_new (GTK_SELECTION_MODEL (gtk_no_selection_new (g_object_ref (source))));
+  for (i = 0; i < 4; i++)
+    {
+      GtkColumnViewColumn *column;
+      char *title;
+
+      title = g_strdup_printf ("Column %d", i);
+      column = gtk_column_view_column_new (title, create_factory ());
+      gtk_column_view_append_column (GTK_COLUMN_VIEW (view), column);
+      g_object_unref (column);
+      g_free (title);
+    }
+  *adjustment = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (view));
+
+  return view;
+}
+
+static void
+update_cb (GdkFrameClock   *frame_clock,
+           ScrollBenchmark *bench)
+{
+  double upper, lower, page_size;
+
+  if (bench->done)
+    return;
+
+  bench->frame_start = g_get_monotonic_time ();
+
+  /* The scroll position only depends on the frame number */
+  upper = gtk_adjustment_get_upper (bench->adjustment);
+  lower = gtk_adjustment_get_lower (bench->adjustment);
+  page_size = gtk_adjustment_get_page_size (bench->adjustment);
+  gtk_adjustment_set_value (bench->adjustment,
+                            lower + (upper - lower - page_size) * bench->frame / n_frames);
+}
+
+static void
+after_paint_cb (GdkFrameClock   *frame_clock,
+                ScrollBenchmark *bench)
+{
+  gint64 now;
+
+  if (bench->done || bench->frame_start == 0)
+    return;
+
+  now = g_get_monotonic_time ();
+  variable_add (&bench->frame_time, (now - bench->frame_start) / 1000.0);
+  if (bench->last_frame_end != 0)
+    variable_add (&bench->frame_interval, (now - bench->last_frame_end) / 1000.0);
+  bench->last_frame_end = now;
+
+  bench->frame++;
+  if (bench->frame > n_frames)
+    {
+      bench->done = TRUE;
+      g_main_context_wakeup (NULL);
+    }
+}
+
+static gboolean
+tick_cb (GtkWidget     *widget,
+         GdkFrameClock *frame_clock,
+         gpointer       data)
+{
+  ScrollBenchmark *bench = data;
+
+  /* Keep the frame clock running while we scroll */
+  return !bench->done;
+}
+
+static void
+realize_cb (GtkWidget       *window,
+            ScrollBenchmark *bench)
+{
+  GdkFrameClock *frame_clock = gtk_widget_get_frame_clock (window);
+
+  g_signal_connect (frame_clock, "update", G_CALLBACK (update_cb), bench);
+  g_signal_connect (frame_clock, "after-paint", G_CALLBACK (after_paint_cb), bench);
+}
+
+static void
+run_scroll_benchmark (const char *name,
+                      GtkWidget * (* create) (GListModel *, GtkAdjustment **),
+                      GListModel *source)
+{
+  ScrollBenchmark bench = { name, g_list_model_get_n_items (source), };
+  GtkWidget *view, *sw;
+  gssize bytes_before;
+
+  bytes_before = get_allocated_bytes ();
+
+  bench.window = gtk_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (bench.window), 800, 600);
+  g_signal_connect (bench.window, "realize", G_CALLBACK (realize_cb), &bench);
+
+  sw = gtk_scrolled_window_new ();
+  gtk_window_set_child (GTK_WINDOW (bench.window), sw);
+  view = create (source, &bench.adjustment);
+  gtk_scrolled_window_set_child (GTK_SCROLLED_WINDOW (sw), view);
+  gtk_widget_add_tick_callback (view, tick_cb, &bench, NULL);
+
+  gtk_window_present (GTK_WINDOW (bench.window));
+
+  while (!bench.done)
+    g_main_context_iteration (NULL, TRUE);
+
+  if (machine_readable)
+    g_print ("%s\t%u\t%g\t%g\t%" G_GSSIZE_FORMAT "\t%g\t%g\n",
+             name, bench.n_items,
+             variable_mean (&bench.frame_time), variable_standard_deviation (&bench.frame_time),
+             get_allocated_bytes () - bytes_before,
+             variable_mean (&bench.frame_interval), variable_standard_deviation (&bench.frame_interval));
+  else
+    g_print ("%-16s %10u items: frame time %.2f +/- %.2f ms, frame interval %.2f +/- %.2f ms, %" G_GSSIZE_FORMAT "k allocated\n",
+             name, bench.n_items,
+             variable_mean (&bench.frame_time), variable_standard_deviation (&bench.frame_time),
+             variable_mean (&bench.frame_interval), variable_standard_deviation (&bench.frame_interval),
+             (get_allocated_bytes () - bytes_before) / 1024);
+
+  g_signal_handlers_disconnect_by_data (gtk_widget_get_frame_clock (bench.window), &bench);
+  gtk_window_destroy (GTK_WINDOW (bench.window));
+}
+
+static void
+run_scroll_benchmarks (void)
+{
+  guint64 n_items;
+
+  if (machine_readable)
+    g_print ("# benchmark\titems\tframe-ms\tstddev\tbytes\tinterval-ms\tstddev\n");
+
+  for (n_items = min_items; n_items <= max_items; n_items *= 10)
+    {
+      GListModel *source = create_source (n_items);
+
+      if (!only || strstr ("listview", only))
+        run_scroll_benchmark ("listview", create_list_view, source);
+      if (!only || strstr ("columnview", only))
+        run_scroll_benchmark ("columnview", create_column_view, source);
+
+      g_object_unref (source);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  GOptionContext *context;
+  GError *error = NULL;
+
+  context = g_option_context_new ("- benchmark list models and list widgets");
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  if (min_items < 1 || max_items < min_items || repeats < 1 || n_frames < 1)
+    {
+      g_printerr ("Invalid arguments\n");
+      return 1;
+    }
+
+  gtk_init ();
+
+  if (scroll)
+    {
+      run_scroll_benchmarks ();
+    }
+  else
+    {
+      print_header ();
+      run_model_benchmarks ();
+    }
+
+  return 0;
+}
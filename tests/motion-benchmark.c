@@ -0,0 +1,180 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+/* Repeatable benchmark for dispatching motion events.
+ *
+ * The window contains a chain of nested boxes for every depth between
+ * --min-depth and --max-depth (doubling each time). Every box has a key
+ * controller and a focus controller, like the containers of a typical
+ * application do, and the innermost widget has a motion controller.
+ *
+ * Synthesized motion events over the innermost widget are fed through
+ * gtk_main_do_event(), so the numbers include picking, crossing tracking
+ * and the capture and bubble phases along the whole path. Events are
+ * created directly, which needs private API, so this links the static
+ * library.
+ */
+
+#include "config.h"
+
+#include <gtk/gtk.h>
+
+#include "gdk/gdkeventsprivate.h"
+#include "gtk/gtkprivate.h"
+
+#include "variable.h"
+
+static int min_depth = 16;
+static int max_depth = 256;
+static int repeats = 3;
+static int n_events = 10000;
+static gboolean machine_readable = FALSE;
+
+static GOptionEntry options[] = {
+  { "min-depth", 0, 0, G_OPTION_ARG_INT, &min_depth, "Smallest nesting depth", "N" },
+  { "max-depth", 0, 0, G_OPTION_ARG_INT, &max_depth, "Largest nesting depth", "N" },
+  { "repeats", 'r', 0, G_OPTION_ARG_INT, &repeats, "Runs to average over", "N" },
+  { "events", 'e', 0, G_OPTION_ARG_INT, &n_events, "Motion events per run", "N" },
+  { "machine-readable", 0, 0, G_OPTION_ARG_NONE, &machine_readable, "Print results in tab-separated columns", NULL },
+  { NULL }
+};
+
+static guint n_motions;
+
+static void
+motion_cb (GtkEventControllerMotion *controller,
+           double                    x,
+           double                    y)
+{
+  n_motions++;
+}
+
+static GtkWidget *
+create_window (int         depth,
+               GtkWidget **leaf)
+{
+  GtkWidget *window, *parent, *child;
+  GtkEventController *controller;
+  int i;
+
+  window = gtk_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), 400, 400);
+
+  parent = window;
+  for (i = 0; i < depth; i++)
+    {
+      child = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+      gtk_widget_set_hexpand (child, TRUE);
+      gtk_widget_set_vexpand (child, TRUE);
+      gtk_widget_add_controller (child, gtk_event_controller_key_new ());
+      gtk_widget_add_controller (child, gtk_event_controller_focus_new ());
+
+      if (parent == window)
+        gtk_window_set_child (GTK_WINDOW (window), child);
+      else
+        gtk_box_append (GTK_BOX (parent), child);
+
+      parent = child;
+    }
+
+  child = gtk_label_new ("Motion");
+  gtk_widget_set_hexpand (child, TRUE);
+  gtk_widget_set_vexpand (child, TRUE);
+  controller = gtk_event_controller_motion_new ();
+  g_signal_connect (controller, "motion", G_CALLBACK (motion_cb), NULL);
+  gtk_widget_add_controller (child, controller);
+  gtk_box_append (GTK_BOX (parent), child);
+
+  *leaf = child;
+
+  return window;
+}
+
+static double
+bench_motion (int depth)
+{
+  GtkWidget *window, *leaf;
+  GdkSurface *surface;
+  GdkDevice *pointer;
+  graphene_point_t p;
+  double nx, ny;
+  gint64 start;
+  double result;
+  int i;
+
+  window = create_window (depth, &leaf);
+  gtk_window_present (GTK_WINDOW (window));
+
+  while (!gtk_widget_get_mapped (leaf) || gtk_widget_get_width (leaf) == 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  surface = gtk_native_get_surface (GTK_NATIVE (window));
+  pointer = gdk_seat_get_pointer (gdk_display_get_default_seat (gtk_widget_get_display (window)));
+  gtk_native_get_surface_transform (GTK_NATIVE (window), &nx, &ny);
+
+  if (!gtk_widget_compute_point (leaf, window,
+                                 &GRAPHENE_POINT_INIT (gtk_widget_get_width (leaf) / 2,
+                                                       gtk_widget_get_height (leaf) / 2),
+                                 &p))
+    g_error ("Failed to find the motion target");
+
+  n_motions = 0;
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < n_events; i++)
+    {
+      GdkEvent *event;
+
+      event = gdk_motion_event_new (surface, pointer, NULL, GDK_CURRENT_TIME, 0,
+                                    p.x + nx + i % 2, p.y + ny, NULL);
+      gtk_main_do_event (event);
+      gdk_event_unref (event);
+    }
+  result = (g_get_monotonic_time () - start) / (double) n_events;
+
+  if (n_motions != n_events)
+    g_printerr ("Only %u of %d motion events reached the target\n", n_motions, n_events);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+
+  return result;
+}
+
+int
+main (int argc, char *argv[])
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  int depth;
+
+  context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  gtk_init ();
+
+  if (machine_readable)
+    g_print ("# depth\tus\tstddev\n");
+
+  for (depth = min_depth; depth <= max_depth; depth *= 2)
+    {
+      Variable time = VARIABLE_INIT;
+      int i;
+
+      for (i = 0; i < repeats; i++)
+        variable_add (&time, bench_motion (depth));
+
+      if (machine_readable)
+        g_print ("%d\t%g\t%g\n",
+                 depth, variable_mean (&time), variable_standard_deviation (&time));
+      else
+        g_print ("motion %6d deep: %10.3f +/- %.3f us per event\n",
+                 depth, variable_mean (&time), variable_standard_deviation (&time));
+    }
+
+  return 0;
+}
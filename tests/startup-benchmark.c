@@ -0,0 +1,379 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+/* Repeatable startup benchmark.
+ *
+ * The benchmark starts itself --runs times as a new process. Every
+ * child builds a window with a large generated ui file, presents it and
+ * exits once the first frame has been presented. The child reports when,
+ * counted from the start of main(), it got through
+ *
+ *   init:      gtk_init()
+ *   builder:   loading the ui file
+ *   layout:    the first layout phase, which includes computing styles
+ *   paint:     the first paint phase
+ *   presented: the compositor showing the first frame, if the backend
+ *              reports presentation times
+ *
+ * The parent also measures the time from spawning the child to its exit.
+ * The first run is reported separately, as it is the one most likely to
+ * hit cold caches. Use GDK_BACKEND to pick the backend to measure.
+ */
+
+#include "config.h"
+
+#include <gtk/gtk.h>
+
+static int n_runs = 10;
+static int n_rows = 200;
+static gboolean machine_readable = FALSE;
+static gboolean child = FALSE;
+
+static GOptionEntry options[] = {
+  { "runs", 'r', 0, G_OPTION_ARG_INT, &n_runs, "Number of startups to measure", "N" },
+  { "rows", 0, 0, G_OPTION_ARG_INT, &n_rows, "Number of rows in the ui file", "N" },
+  { "machine-readable", 0, 0, G_OPTION_ARG_NONE, &machine_readable, "Print results in tab-separated columns", NULL },
+  { "child", 0, G_OPTION_FLAG_HIDDEN, G_OPTION_ARG_NONE, &child, "Run a single startup", NULL },
+  { NULL }
+};
+
+static const char *metrics[] = {
+  "init",
+  "builder",
+  "layout",
+  "paint",
+  "presented",
+  "process",
+};
+
+enum {
+  METRIC_INIT,
+  METRIC_BUILDER,
+  METRIC_LAYOUT,
+  METRIC_PAINT,
+  METRIC_PRESENTED,
+  METRIC_PROCESS,
+  N_METRICS
+};
+
+static gint64 start_time;
+static double results[N_METRICS];
+static gint64 paint_frame = -1;
+static gboolean done = FALSE;
+
+static double
+elapsed (gint64 time)
+{
+  return (time - start_time) / 1000.0;
+}
+
+static char *
+create_ui (int rows)
+{
+  GString *ui;
+  int i;
+
+  ui = g_string_new ("<interface>\n"
+                     "  <object class='GtkWindow' id='window'>\n"
+                     "    <property name='title'>Startup benchmark</property>\n"
+                     "    <property name='default-width'>800</property>\n"
+                     "    <property name='default-height'>600</property>\n"
+                     "    <child>\n"
+                     "      <object class='GtkScrolledWindow'>\n"
+                     "        <child>\n"
+                     "          <object class='GtkBox'>\n"
+                     "            <property name='orientation'>vertical</property>\n"
+                     "            <property name='spacing'>6</property>\n");
+
+  for (i = 0; i < rows; i++)
+    g_string_append_printf (ui,
+                            "            <child>\n"
+                            "              <object class='GtkBox'>\n"
+                            "                <property name='spacing'>12</property>\n"
+                            "                <child>\n"
+                            "                  <object class='GtkImage'>\n"
+                            "                    <property name='icon-name'>%s</property>\n"
+                            "                  </object>\n"
+                            "                </child>\n"
+                            "                <child>\n"
+                            "                  <object class='GtkLabel'>\n"
+                            "                    <property name='label'>Row %d</property>\n"
+                            "                    <property name='xalign'>0</property>\n"
+                            "                    <property name='hexpand'>1</property>\n"
+                            "                  </object>\n"
+                            "                </child>\n"
+                            "                <child>\n"
+                            "                  <object class='GtkEntry'>\n"
+                            "                    <property name='placeholder-text'>Value</property>\n"
+                            "                  </object>\n"
+                            "                </child>\n"
+                            "                <child>\n"
+                            "                  <object class='GtkCheckButton'/>\n"
+                            "                </child>\n"
+                            "                <child>\n"
+                            "                  <object class='GtkButton'>\n"
+                            "                    <property name='icon-name'>edit-delete-symbolic</property>\n"
+                            "                  </object>\n"
+                            "                </child>\n"
+                            "              </object>\n"
+                            "            </child>\n",
+                            i % 2 ? "folder-symbolic" : "document-open-symbolic",
+                            i);
+
+  g_string_append (ui,
+                   "          </object>\n"
+                   "        </child>\n"
+                   "      </object>\n"
+                   "    </child>\n"
+                   "  </object>\n"
+                   "</interface>\n");
+
+  return g_string_free (ui, FALSE);
+}
+
+static gboolean
+check_presented (gpointer data)
+{
+  GdkFrameClock *clock = data;
+  GdkFrameTimings *timings;
+
+  timings = gdk_frame_clock_get_timings (clock, paint_frame);
+  if (timings == NULL)
+    {
+      /* The timings are gone already, so they will never be complete */
+      done = TRUE;
+      return G_SOURCE_REMOVE;
+    }
+
+  if (!gdk_frame_timings_get_complete (timings))
+    return G_SOURCE_CONTINUE;
+
+  if (gdk_frame_timings_get_presentation_time (timings) != 0)
+    results[METRIC_PRESENTED] = elapsed (gdk_frame_timings_get_presentation_time (timings));
+
+  done = TRUE;
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+give_up (gpointer data)
+{
+  done = TRUE;
+  return G_SOURCE_REMOVE;
+}
+
+static void
+layout_cb (GdkFrameClock *clock)
+{
+  if (results[METRIC_LAYOUT] == 0)
+    results[METRIC_LAYOUT] = elapsed (g_get_monotonic_time ());
+}
+
+static void
+after_paint_cb (GdkFrameClock *clock)
+{
+  if (paint_frame >= 0)
+    return;
+
+  results[METRIC_PAINT] = elapsed (g_get_monotonic_time ());
+  paint_frame = gdk_frame_clock_get_frame_counter (clock);
+
+  g_timeout_add (1, check_presented, clock);
+  g_timeout_add_seconds (1, give_up, NULL);
+}
+
+static void
+realize_cb (GtkWidget *window)
+{
+  GdkFrameClock *clock = gtk_widget_get_frame_clock (window);
+
+  g_signal_connect_after (clock, "layout", G_CALLBACK (layout_cb), NULL);
+  g_signal_connect_after (clock, "after-paint", G_CALLBACK (after_paint_cb), NULL);
+}
+
+static int
+run_child (void)
+{
+  GtkBuilder *builder;
+  GtkWidget *window;
+  char *ui;
+
+  gtk_init ();
+  results[METRIC_INIT] = elapsed (g_get_monotonic_time ());
+
+  ui = create_ui (n_rows);
+  builder = gtk_builder_new_from_string (ui, -1);
+  g_free (ui);
+  results[METRIC_BUILDER] = elapsed (g_get_monotonic_time ());
+
+  window = GTK_WIDGET (gtk_builder_get_object (builder, "window"));
+  g_signal_connect (window, "realize", G_CALLBACK (realize_cb), NULL);
+  gtk_window_present (GTK_WINDOW (window));
+
+  while (!done)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_print ("%g\t%g\t%g\t%g\t%g\n",
+           results[METRIC_INIT],
+           results[METRIC_BUILDER],
+           results[METRIC_LAYOUT],
+           results[METRIC_PAINT],
+           results[METRIC_PRESENTED]);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_object_unref (builder);
+
+  return 0;
+}
+
+static int
+compare_double (gconstpointer a,
+                gconstpointer b)
+{
+  double da = *(const double *) a;
+  double db = *(const double *) b;
+
+  return (da > db) - (da < db);
+}
+
+static double
+percentile (GArray *values,
+            double  p)
+{
+  guint i = CLAMP ((guint) (p * values->len), 1, values->len) - 1;
+
+  return g_array_index (values, double, i);
+}
+
+static gboolean
+run_once (const char *self,
+          double      run[N_METRICS])
+{
+  char *argv[4];
+  char *rows_arg, *output;
+  char **fields;
+  gint64 before;
+  int status, i;
+  GError *error = NULL;
+
+  rows_arg = g_strdup_printf ("--rows=%d", n_rows);
+  argv[0] = (char *) self;
+  argv[1] = (char *) "--child";
+  argv[2] = rows_arg;
+  argv[3] = NULL;
+
+  before = g_get_monotonic_time ();
+  if (!g_spawn_sync (NULL, argv, NULL, G_SPAWN_SEARCH_PATH, NULL, NULL,
+                     &output, NULL, &status, &error) ||
+      !g_spawn_check_wait_status (status, &error))
+    {
+      g_printerr ("Failed to run %s: %s\n", self, error->message);
+      g_error_free (error);
+      g_free (rows_arg);
+      return FALSE;
+    }
+  run[METRIC_PROCESS] = (g_get_monotonic_time () - before) / 1000.0;
+
+  fields = g_strsplit (g_strstrip (output), "\t", -1);
+  if (g_strv_length (fields) != METRIC_PROCESS)
+    {
+      g_printerr ("Unexpected output from child: %s\n", output);
+      g_strfreev (fields);
+      g_free (output);
+      g_free (rows_arg);
+      return FALSE;
+    }
+
+  for (i = 0; i < METRIC_PROCESS; i++)
+    run[i] = g_ascii_strtod (fields[i], NULL);
+
+  g_strfreev (fields);
+  g_free (output);
+  g_free (rows_arg);
+
+  return TRUE;
+}
+
+static int
+run_parent (const char *self)
+{
+  GArray *values[N_METRICS];
+  double cold[N_METRICS];
+  int i, j;
+
+  for (j = 0; j < N_METRICS; j++)
+    values[j] = g_array_new (FALSE, FALSE, sizeof (double));
+
+  for (i = 0; i < n_runs; i++)
+    {
+      double run[N_METRICS];
+
+      if (!run_once (self, run))
+        return 1;
+
+      for (j = 0; j < N_METRICS; j++)
+        {
+          if (i == 0)
+            cold[j] = run[j];
+
+          /* A presentation time of 0 means the backend did not report one */
+          if (j != METRIC_PRESENTED || run[j] > 0)
+            g_array_append_val (values[j], run[j]);
+        }
+    }
+
+  if (machine_readable)
+    g_print ("# metric\tcold\tp50\tp90\tmax\n");
+
+  for (j = 0; j < N_METRICS; j++)
+    {
+      if (values[j]->len == 0)
+        {
+          if (!machine_readable)
+            g_print ("%-10s not reported by this backend\n", metrics[j]);
+          g_array_unref (values[j]);
+          continue;
+        }
+
+      g_array_sort (values[j], compare_double);
+
+      if (machine_readable)
+        g_print ("%s\t%g\t%g\t%g\t%g\n",
+                 metrics[j], cold[j],
+                 percentile (values[j], 0.5),
+                 percentile (values[j], 0.9),
+                 percentile (values[j], 1.0));
+      else
+        g_print ("%-10s cold %8.2f   p50 %8.2f   p90 %8.2f   max %8.2f ms\n",
+                 metrics[j], cold[j],
+                 percentile (values[j], 0.5),
+                 percentile (values[j], 0.9),
+                 percentile (values[j], 1.0));
+
+      g_array_unref (values[j]);
+    }
+
+  return 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+  GOptionContext *context;
+  GError *error = NULL;
+
+  start_time = g_get_monotonic_time ();
+
+  context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  if (child)
+    return run_child ();
+  else
+    return run_parent (argv[0]);
+}
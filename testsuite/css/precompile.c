@@ -0,0 +1,159 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../gtk/css/gtkcsstokenizerprivate.h"
+#include "../../gtk/css/gtkcsserror.h"
+
+#include <locale.h>
+#include <string.h>
+
+static const char *tests[] = {
+  "",
+  "window { color: red; }",
+  "/* comment */\nbutton:hover > label.title,\r\n.foo#bar { margin: -1px 2.5em 50% +3; }",
+  "@import url(\"resource:///org/gtk/libgtk/theme/Default/Default-light.css\");",
+  "@define-color accent_color #3584e4;\nentry { background-image: linear-gradient(to top, alpha(@accent_color, 0.5), transparent); }",
+  "a[href^='http'], a[x|=\"y\"], a[z~=w], a[b$=c], a[d*=e] { font-family: \"A very long font family name\"; }",
+  "label { font-feature-settings: \"tnum\"; transition: opacity 200ms cubic-bezier(0.25, 0.46, 0.45, 0.94); }",
+  "<!-- .x { content: \"\\2014 \\\"quoted\\\"\"; } -->",
+};
+
+static void
+assert_location_equal (const GtkCssLocation *a,
+                       const GtkCssLocation *b)
+{
+  g_assert_cmpuint (a->bytes, ==, b->bytes);
+  g_assert_cmpuint (a->chars, ==, b->chars);
+  g_assert_cmpuint (a->lines, ==, b->lines);
+  g_assert_cmpuint (a->line_bytes, ==, b->line_bytes);
+  g_assert_cmpuint (a->line_chars, ==, b->line_chars);
+}
+
+static void
+test_replay (gconstpointer data)
+{
+  const char *css = data;
+  GBytes *bytes, *precompiled;
+  GtkCssTokenizer *text, *replay;
+  GError *error = NULL;
+
+  bytes = g_bytes_new_static (css, strlen (css));
+  precompiled = gtk_css_tokenizer_precompile (bytes, &error);
+  g_assert_no_error (error);
+  g_assert_true (gtk_css_tokenizer_is_precompiled (g_bytes_get_data (precompiled, NULL),
+                                                   g_bytes_get_size (precompiled)));
+
+  text = gtk_css_tokenizer_new (bytes);
+  replay = gtk_css_tokenizer_new (precompiled);
+
+  while (TRUE)
+    {
+      GtkCssToken expected, token;
+      char *expected_string, *string;
+
+      g_assert_true (gtk_css_tokenizer_read_token (text, &expected, NULL));
+      g_assert_true (gtk_css_tokenizer_read_token (replay, &token, &error));
+      g_assert_no_error (error);
+
+      g_assert_cmpint (token.type, ==, expected.type);
+      expected_string = gtk_css_token_to_string (&expected);
+      string = gtk_css_token_to_string (&token);
+      g_assert_cmpstr (string, ==, expected_string);
+      g_free (expected_string);
+      g_free (string);
+
+      assert_location_equal (gtk_css_tokenizer_get_location (replay),
+                             gtk_css_tokenizer_get_location (text));
+
+      if (gtk_css_token_is (&expected, GTK_CSS_TOKEN_EOF))
+        break;
+
+      gtk_css_token_clear (&expected);
+      gtk_css_token_clear (&token);
+    }
+
+  gtk_css_tokenizer_unref (replay);
+  gtk_css_tokenizer_unref (text);
+  g_bytes_unref (precompiled);
+  g_bytes_unref (bytes);
+}
+
+static void
+test_truncated (void)
+{
+  const char *css = "box { min-width: 24px; }";
+  GBytes *bytes, *precompiled, *truncated;
+  GtkCssTokenizer *tokenizer;
+  GtkCssToken token;
+  GError *error = NULL;
+
+  bytes = g_bytes_new_static (css, strlen (css));
+  precompiled = gtk_css_tokenizer_precompile (bytes, &error);
+  g_assert_no_error (error);
+
+  truncated = g_bytes_new_from_bytes (precompiled, 0, g_bytes_get_size (precompiled) - 3);
+  tokenizer = gtk_css_tokenizer_new (truncated);
+
+  while (gtk_css_tokenizer_read_token (tokenizer, &token, &error))
+    {
+      g_assert_false (gtk_css_token_is (&token, GTK_CSS_TOKEN_EOF));
+      gtk_css_token_clear (&token);
+    }
+
+  g_assert_error (error, GTK_CSS_PARSER_ERROR, GTK_CSS_PARSER_ERROR_SYNTAX);
+  g_assert_true (gtk_css_token_is (&token, GTK_CSS_TOKEN_EOF));
+  g_error_free (error);
+
+  gtk_css_tokenizer_unref (tokenizer);
+  g_bytes_unref (truncated);
+  g_bytes_unref (precompiled);
+  g_bytes_unref (bytes);
+}
+
+static void
+test_invalid (void)
+{
+  const char *css = "label { content: \"unterminated\n }";
+  GBytes *bytes, *precompiled;
+  GError *error = NULL;
+
+  bytes = g_bytes_new_static (css, strlen (css));
+  precompiled = gtk_css_tokenizer_precompile (bytes, &error);
+  g_assert_null (precompiled);
+  g_assert_error (error, GTK_CSS_PARSER_ERROR, GTK_CSS_PARSER_ERROR_SYNTAX);
+  g_error_free (error);
+  g_bytes_unref (bytes);
+}
+
+int
+main (int argc, char *argv[])
+{
+  guint i;
+
+  (g_test_init) (&argc, &argv, NULL);
+  setlocale (LC_ALL, "C");
+
+  for (i = 0; i < G_N_ELEMENTS (tests); i++)
+    {
+      char *name = g_strdup_printf ("/css/precompile/replay/%u", i);
+      g_test_add_data_func (name, tests[i], test_replay);
+      g_free (name);
+    }
+
+  g_test_add_func ("/css/precompile/truncated", test_truncated);
+  g_test_add_func ("/css/precompile/invalid", test_invalid);
+
+  return g_test_run ();
+}
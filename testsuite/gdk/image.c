@@ -68,6 +68,93 @@ test_load_image (gconstpointer data)
   g_free (path);
 }
 
+static void
+count_partial (GdkTexture *partial,
+               gpointer    data)
+{
+  guint *n_partial = data;
+
+  g_assert_true (GDK_IS_TEXTURE (partial));
+
+  (*n_partial)++;
+}
+
+static void
+test_load_image_stream (gconstpointer data)
+{
+  const char *filename = data;
+  GdkTexture *texture, *texture2;
+  GInputStream *stream;
+  char *path;
+  GFile *file;
+  GBytes *bytes;
+  GError *error = NULL;
+  guint n_partial = 0;
+
+  path = g_test_build_filename (G_TEST_DIST, "image-data", filename, NULL);
+  file = g_file_new_for_path (path);
+  bytes = g_file_load_bytes (file, NULL, NULL, &error);
+  g_assert_no_error (error);
+  stream = g_memory_input_stream_new_from_bytes (bytes);
+
+  if (g_str_has_suffix (filename, ".png"))
+    {
+      texture = gdk_load_png (bytes, &error);
+      g_assert_no_error (error);
+      texture2 = gdk_load_png_from_stream (stream, 0, 0, count_partial, &n_partial, NULL, &error);
+    }
+  else if (g_str_has_suffix (filename, ".jpeg"))
+    {
+      texture = gdk_load_jpeg (bytes, &error);
+      g_assert_no_error (error);
+      texture2 = gdk_load_jpeg_from_stream (stream, 0, 0, count_partial, &n_partial, NULL, &error);
+    }
+  else
+    g_assert_not_reached ();
+
+  g_assert_no_error (error);
+  g_assert_true (GDK_IS_TEXTURE (texture2));
+  assert_texture_equal (texture, texture2);
+
+  g_object_unref (texture2);
+  g_object_unref (texture);
+  g_object_unref (stream);
+  g_bytes_unref (bytes);
+  g_object_unref (file);
+  g_free (path);
+}
+
+static void
+test_load_image_at_size (gconstpointer data)
+{
+  const char *filename = data;
+  GdkTexture *texture;
+  char *path;
+  GFile *file;
+  GError *error = NULL;
+
+  path = g_test_build_filename (G_TEST_DIST, "image-data", filename, NULL);
+  file = g_file_new_for_path (path);
+
+  /* 32x32 images scale down by a factor of 4 to stay at least 8x7 */
+  texture = gdk_texture_new_from_file_at_size (file, 8, 7, &error);
+  g_assert_no_error (error);
+  g_assert_true (GDK_IS_TEXTURE (texture));
+  g_assert_cmpint (gdk_texture_get_width (texture), ==, 8);
+  g_assert_cmpint (gdk_texture_get_height (texture), ==, 8);
+  g_object_unref (texture);
+
+  /* never scale up */
+  texture = gdk_texture_new_from_file_at_size (file, 64, 64, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (gdk_texture_get_width (texture), ==, 32);
+  g_assert_cmpint (gdk_texture_get_height (texture), ==, 32);
+  g_object_unref (texture);
+
+  g_object_unref (file);
+  g_free (path);
+}
+
 static void
 test_save_image (gconstpointer test_data)
 {
@@ -117,6 +204,38 @@ test_save_image (gconstpointer test_data)
   g_free (path);
 }
 
+static void
+test_save_png_compression (void)
+{
+  char *path;
+  GdkTexture *texture, *texture2;
+  GError *error = NULL;
+  GBytes *fast, *small;
+
+  path = g_test_build_filename (G_TEST_DIST, "image-data", "image.png", NULL);
+  texture = gdk_texture_new_from_filename (path, &error);
+  g_assert_no_error (error);
+
+  fast = gdk_save_png_with_compression (texture, 0);
+  small = gdk_save_png_with_compression (texture, 9);
+  g_assert_cmpuint (g_bytes_get_size (small), <=, g_bytes_get_size (fast));
+
+  texture2 = gdk_load_png (fast, &error);
+  g_assert_no_error (error);
+  assert_texture_equal (texture, texture2);
+  g_object_unref (texture2);
+
+  texture2 = gdk_load_png (small, &error);
+  g_assert_no_error (error);
+  assert_texture_equal (texture, texture2);
+  g_object_unref (texture2);
+
+  g_bytes_unref (fast);
+  g_bytes_unref (small);
+  g_object_unref (texture);
+  g_free (path);
+}
+
 static void
 test_load_image_fail (gconstpointer data)
 {
@@ -155,6 +274,13 @@ main (int argc, char *argv[])
      char *test = g_strconcat ("/image/load/", name, NULL);
      g_test_add_data_func (test, name, test_load_image);
      g_free (test);
+
+     if (g_str_has_suffix (name, ".png") || g_str_has_suffix (name, ".jpeg"))
+       {
+         test = g_strconcat ("/image/stream/", name, NULL);
+         g_test_add_data_func (test, name, test_load_image_stream);
+         g_free (test);
+       }
    }
 
   path = g_test_build_filename (G_TEST_DIST, "bad-image-data", NULL);
@@ -169,9 +295,13 @@ main (int argc, char *argv[])
      g_free (test);
    }
 
+  g_test_add_data_func ("/image/at-size/image.png", "image.png", test_load_image_at_size);
+  g_test_add_data_func ("/image/at-size/image.jpeg", "image.jpeg", test_load_image_at_size);
+
   g_test_add_data_func ("/image/save/image.png", "image.png", test_save_image);
   g_test_add_data_func ("/image/save/image.tiff", "image.tiff", test_save_image);
   g_test_add_data_func ("/image/save/image.jpeg", "image.jpeg", test_save_image);
+  g_test_add_func ("/image/save/png-compression", test_save_png_compression);
 
   return g_test_run ();
 }
@@ -257,6 +257,47 @@ test_texture_subtexture (void)
   g_object_unref (texture);
 }
 
+static void
+test_texture_atlas_entry (void)
+{
+  GdkTexture *texture, *entry, *atlas;
+  guchar *data, *entry_data;
+  GBytes *bytes;
+  int x, y;
+
+  data = g_malloc (64 * 64 * 4);
+  for (x = 0; x < 64 * 64 * 4; x++)
+    data[x] = x % 251;
+
+  bytes = g_bytes_new_take (data, 64 * 64 * 4);
+  texture = gdk_memory_texture_new (64, 64, GDK_MEMORY_R8G8B8A8, bytes, 64 * 4);
+  g_bytes_unref (bytes);
+
+  atlas = gdk_memory_texture_get_atlas (GDK_MEMORY_TEXTURE (texture), &x, &y);
+  g_assert_null (atlas);
+
+  entry = gdk_memory_texture_new_atlas_entry (GDK_MEMORY_TEXTURE (texture), 16, 8, 32, 24);
+  g_assert_cmpint (gdk_texture_get_width (entry), ==, 32);
+  g_assert_cmpint (gdk_texture_get_height (entry), ==, 24);
+
+  atlas = gdk_memory_texture_get_atlas (GDK_MEMORY_TEXTURE (entry), &x, &y);
+  g_assert_true (atlas == texture);
+  g_assert_cmpint (x, ==, 16);
+  g_assert_cmpint (y, ==, 8);
+
+  entry_data = g_new0 (guchar, 32 * 24 * 4);
+  gdk_texture_download (entry, entry_data, 32 * 4);
+
+  compare_pixels (32, 24,
+                  data + 8 * 64 * 4 + 16 * 4, 64 * 4,
+                  entry_data, 32 * 4);
+
+  g_free (entry_data);
+
+  g_object_unref (texture);
+  g_object_unref (entry);
+}
+
 static void
 test_texture_icon (void)
 {
@@ -441,6 +482,104 @@ test_texture_downloader (void)
   g_object_unref (texture);
 }
 
+static void
+test_texture_downloader_area (void)
+{
+  GdkTexture *texture;
+  GdkTextureDownloader *downloader;
+  GdkRectangle area = { 3, 5, 7, 9 };
+  gsize stride, area_stride, bpp;
+  GBytes *bytes;
+  const guchar *full;
+  guchar *data;
+  int y;
+
+  texture = gdk_texture_new_from_resource ("/org/gtk/libgtk/icons/16x16/places/user-trash.png");
+
+  downloader = gdk_texture_downloader_new (texture);
+  gdk_texture_downloader_set_format (downloader, GDK_MEMORY_R16G16B16A16);
+  bpp = 4 * 2;
+
+  bytes = gdk_texture_downloader_download_bytes (downloader, &stride);
+  full = g_bytes_get_data (bytes, NULL);
+
+  /* Leave some padding, to check the stride is respected */
+  area_stride = area.width * bpp + 4;
+  data = g_malloc (area_stride * area.height);
+  gdk_texture_downloader_download_area_into (downloader, &area, data, area_stride);
+
+  for (y = 0; y < area.height; y++)
+    g_assert_true (memcmp (data + y * area_stride,
+                           full + (area.y + y) * stride + area.x * bpp,
+                           area.width * bpp) == 0);
+
+  /* The full area must match a regular download */
+  data = g_realloc (data, stride * 16);
+  gdk_texture_downloader_download_area_into (downloader,
+                                             &(GdkRectangle) { 0, 0, 16, 16 },
+                                             data, stride);
+  g_assert_true (memcmp (data, full, stride * 16) == 0);
+
+  g_free (data);
+  g_bytes_unref (bytes);
+  gdk_texture_downloader_free (downloader);
+  g_object_unref (texture);
+}
+
+static void
+test_texture_dds (void)
+{
+  guchar dds[128 + 8] = { 'D', 'D', 'S', ' ', };
+  guchar pixels[4 * 4 * 4];
+  GError *error = NULL;
+  GdkTexture *texture;
+  GBytes *bytes;
+  int i;
+
+  /* A 4x4 DXT1 image, in a single block */
+  dds[4] = 124;             /* dwSize */
+  dds[4 + 8] = 4;           /* dwHeight */
+  dds[4 + 12] = 4;          /* dwWidth */
+  dds[4 + 72] = 32;         /* ddspf.dwSize */
+  dds[4 + 76] = 0x4;        /* ddspf.dwFlags = DDPF_FOURCC */
+  memcpy (dds + 4 + 80, "DXT1", 4);
+
+  /* Red and blue, with only the second pixel using blue */
+  dds[128 + 0] = 0x00;
+  dds[128 + 1] = 0xf8;
+  dds[128 + 2] = 0x1f;
+  dds[128 + 3] = 0x00;
+  dds[128 + 4] = 0x04;
+
+  bytes = g_bytes_new_static (dds, sizeof (dds));
+  texture = gdk_texture_new_from_bytes (bytes, &error);
+  g_assert_no_error (error);
+  g_bytes_unref (bytes);
+
+  g_assert_cmpint (gdk_texture_get_width (texture), ==, 4);
+  g_assert_cmpint (gdk_texture_get_height (texture), ==, 4);
+
+  gdk_texture_download (texture, pixels, 4 * 4);
+
+  for (i = 0; i < 16; i++)
+    {
+      guint32 expected = i == 1 ? 0xff0000ff : 0xffff0000;
+      guint32 pixel;
+
+      memcpy (&pixel, pixels + 4 * i, 4);
+      g_assert_cmphex (pixel, ==, expected);
+    }
+
+  /* Truncated data */
+  bytes = g_bytes_new_static (dds, sizeof (dds) - 1);
+  g_assert_null (gdk_texture_new_from_bytes (bytes, &error));
+  g_assert_error (error, GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_CORRUPT_IMAGE);
+  g_clear_error (&error);
+  g_bytes_unref (bytes);
+
+  g_object_unref (texture);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -452,11 +591,14 @@ main (int argc, char *argv[])
   g_test_add_func ("/texture/save-to-png", test_texture_save_to_png);
   g_test_add_func ("/texture/save-to-tiff", test_texture_save_to_tiff);
   g_test_add_func ("/texture/subtexture", test_texture_subtexture);
+  g_test_add_func ("/texture/atlas-entry", test_texture_atlas_entry);
   g_test_add_func ("/texture/icon/load", test_texture_icon);
   g_test_add_func ("/texture/icon/load-async", test_texture_icon_async);
   g_test_add_func ("/texture/icon/serialize", test_texture_icon_serialize);
   g_test_add_func ("/texture/diff", test_texture_diff);
   g_test_add_func ("/texture/downloader", test_texture_downloader);
+  g_test_add_func ("/texture/downloader-area", test_texture_downloader_area);
+  g_test_add_func ("/texture/dds", test_texture_dds);
 
   return g_test_run ();
 }
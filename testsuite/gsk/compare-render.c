@@ -15,6 +15,14 @@ static gboolean mask = FALSE;
 static gboolean replay = FALSE;
 static gboolean clip = FALSE;
 static gboolean colorflip = FALSE;
+static gboolean timings = FALSE;
+static char *arg_baseline_dir = NULL;
+static int max_regression = 20;
+
+static gboolean timing_regressed = FALSE;
+
+/* Renders done after the first one, to get stable timings */
+#define TIMING_ITERATIONS 5
 
 extern void
 replay_node (GskRenderNode *node, GtkSnapshot *snapshot);
@@ -172,9 +180,154 @@ static const GOptionEntry options[] = {
   { "replay", 0, 0, G_OPTION_ARG_NONE, &replay, "Do replay test", NULL },
   { "clip", 0, 0, G_OPTION_ARG_NONE, &clip, "Do clip test", NULL },
   { "colorflip", 0, 0, G_OPTION_ARG_NONE, &colorflip, "Swap colors", NULL },
+  { "timings", 0, 0, G_OPTION_ARG_NONE, &timings, "Save the time it takes to render", NULL },
+  { "baseline", 0, 0, G_OPTION_ARG_FILENAME, &arg_baseline_dir, "Compare timings to the ones saved in DIR", "DIR" },
+  { "max-regression", 0, 0, G_OPTION_ARG_INT, &max_regression, "Fail if rendering got slower by more than PERCENT", "PERCENT" },
   { NULL }
 };
 
+static int
+compare_times (gconstpointer a,
+               gconstpointer b)
+{
+  gint64 ta = *(const gint64 *) a;
+  gint64 tb = *(const gint64 *) b;
+
+  return ta < tb ? -1 : (ta > tb ? 1 : 0);
+}
+
+static void
+check_baseline (const char *timing_file,
+                const char *renderer_name,
+                gint64      median)
+{
+  GKeyFile *baseline;
+  char *basename, *filename, *baseline_renderer;
+  GError *error = NULL;
+  gint64 baseline_median;
+
+  basename = g_path_get_basename (timing_file);
+  filename = g_build_filename (arg_baseline_dir, basename, NULL);
+  baseline = g_key_file_new ();
+
+  if (!g_key_file_load_from_file (baseline, filename, G_KEY_FILE_NONE, &error))
+    {
+      g_print ("No baseline timing: %s\n", error->message);
+      g_clear_error (&error);
+      goto out;
+    }
+
+  baseline_renderer = g_key_file_get_string (baseline, "timing", "renderer", NULL);
+  baseline_median = g_key_file_get_int64 (baseline, "timing", "median", &error);
+  if (error)
+    {
+      g_print ("Invalid baseline timing in %s: %s\n", filename, error->message);
+      g_clear_error (&error);
+    }
+  else if (g_strcmp0 (baseline_renderer, renderer_name) != 0)
+    {
+      g_print ("Baseline timing in %s is for %s, not %s\n",
+               filename, baseline_renderer, renderer_name);
+    }
+  else
+    {
+      g_print ("Baseline render time: %" G_GINT64_FORMAT " us\n", baseline_median);
+
+      if (median * 100 > baseline_median * (100 + max_regression))
+        {
+          g_print ("Rendering got slower by %" G_GINT64_FORMAT "%%, more than %d%%\n",
+                   (median - baseline_median) * 100 / MAX (baseline_median, 1),
+                   max_regression);
+          timing_regressed = TRUE;
+        }
+    }
+
+  g_free (baseline_renderer);
+
+out:
+  g_key_file_free (baseline);
+  g_free (filename);
+  g_free (basename);
+}
+
+/* Renders the node once more for every iteration and saves the
+ * times as a key file next to the images, so a later run can use
+ * the output directory as its baseline.
+ */
+static void
+time_render (GskRenderer           *renderer,
+             GskRenderNode         *node,
+             const graphene_rect_t *viewport,
+             const char            *test_name,
+             const char            *extension)
+{
+  gint64 times[TIMING_ITERATIONS];
+  const char *renderer_name;
+  GKeyFile *keyfile;
+  char *filename;
+  GError *error = NULL;
+  int i;
+
+  for (i = 0; i < TIMING_ITERATIONS; i++)
+    {
+      GdkTexture *texture;
+      gint64 start;
+
+      start = g_get_monotonic_time ();
+      texture = gsk_renderer_render_texture (renderer, node, viewport);
+      times[i] = g_get_monotonic_time () - start;
+
+      g_object_unref (texture);
+    }
+
+  qsort (times, TIMING_ITERATIONS, sizeof (gint64), compare_times);
+
+  renderer_name = G_OBJECT_TYPE_NAME (renderer);
+  filename = get_output_file (test_name, ".node", extension);
+
+  g_print ("Render time: %" G_GINT64_FORMAT " us (min %" G_GINT64_FORMAT " us)\n",
+           times[TIMING_ITERATIONS / 2], times[0]);
+
+  keyfile = g_key_file_new ();
+  g_key_file_set_string (keyfile, "timing", "renderer", renderer_name);
+  g_key_file_set_integer (keyfile, "timing", "iterations", TIMING_ITERATIONS);
+  g_key_file_set_int64 (keyfile, "timing", "min", times[0]);
+  g_key_file_set_int64 (keyfile, "timing", "median", times[TIMING_ITERATIONS / 2]);
+  g_key_file_set_int64 (keyfile, "timing", "max", times[TIMING_ITERATIONS - 1]);
+
+  g_print ("Storing render timings at %s\n", filename);
+  if (!g_key_file_save_to_file (keyfile, filename, &error))
+    {
+      g_print ("Failed to save timings: %s\n", error->message);
+      g_clear_error (&error);
+    }
+
+  if (arg_baseline_dir)
+    check_baseline (filename, renderer_name, times[TIMING_ITERATIONS / 2]);
+
+  g_key_file_free (keyfile);
+  g_free (filename);
+}
+
+static GdkTexture *
+render_texture (GskRenderer           *renderer,
+                GskRenderNode         *node,
+                const graphene_rect_t *viewport,
+                const char            *test_name,
+                const char            *extension)
+{
+  GdkTexture *texture;
+
+  /* The first render also does the shader compiles and uploads,
+   * so it is not timed */
+  texture = gsk_renderer_render_texture (renderer, node, viewport);
+
+  if (timings)
+    time_render (renderer, node, viewport, test_name, extension);
+
+  return texture;
+}
+
 static GskRenderNode *
 load_node_file (const char *node_file)
 {
@@ -361,7 +514,7 @@ main (int argc, char **argv)
   if (plain)
     {
       /* Render the .node file and download to cairo surface */
-      rendered_texture = gsk_renderer_render_texture (renderer, node, NULL);
+      rendered_texture = render_texture (renderer, node, NULL, node_file, ".timing");
       g_assert_nonnull (rendered_texture);
 
       save_image (rendered_texture, node_file, ".out.png");
@@ -401,7 +554,7 @@ main (int argc, char **argv)
 
       save_node (node2, node_file, "-flipped.node");
 
-      rendered_texture = gsk_renderer_render_texture (renderer, node2, NULL);
+      rendered_texture = render_texture (renderer, node2, NULL, node_file, "-flipped.timing");
       save_image (rendered_texture, node_file, "-flipped.out.png");
 
       pixbuf = gdk_pixbuf_new_from_file (png_file, &error);
@@ -447,7 +600,7 @@ main (int argc, char **argv)
       node2 = gsk_repeat_node_new (&bounds, node, &node_bounds);
       save_node (node2, node_file, "-repeated.node");
 
-      rendered_texture = gsk_renderer_render_texture (renderer, node2, NULL);
+      rendered_texture = render_texture (renderer, node2, NULL, node_file, "-repeated.timing");
       save_image (rendered_texture, node_file, "-repeated.out.png");
 
       pixbuf = gdk_pixbuf_new_from_file (png_file, &error);
@@ -504,7 +657,7 @@ main (int argc, char **argv)
 
       save_node (node2, node_file, "-rotated.node");
 
-      rendered_texture = gsk_renderer_render_texture (renderer, node2, NULL);
+      rendered_texture = render_texture (renderer, node2, NULL, node_file, "-rotated.timing");
       save_image (rendered_texture, node_file, "-rotated.out.png");
 
       pixbuf = gdk_pixbuf_new_from_file (png_file, &error);
@@ -561,7 +714,7 @@ main (int argc, char **argv)
       gsk_render_node_unref (mask_node);
       save_node (node2, node_file, "-masked.node");
 
-      rendered_texture = gsk_renderer_render_texture (renderer, node2, NULL);
+      rendered_texture = render_texture (renderer, node2, NULL, node_file, "-masked.timing");
       save_image (rendered_texture, node_file, "-masked.out.png");
 
       pixbuf = gdk_pixbuf_new_from_file (png_file, &error);
@@ -608,7 +761,7 @@ main (int argc, char **argv)
 
       rendered_texture = gsk_renderer_render_texture (renderer, node, &node_bounds);
       save_image (rendered_texture, node_file, "-replayed.ref.png");
-      rendered_texture2 = gsk_renderer_render_texture (renderer, node2, &node_bounds);
+      rendered_texture2 = render_texture (renderer, node2, &node_bounds, node_file, "-replayed.timing");
       save_image (rendered_texture2, node_file, "-replayed.out.png");
       g_assert_nonnull (rendered_texture);
       g_assert_nonnull (rendered_texture2);
@@ -653,7 +806,7 @@ main (int argc, char **argv)
       node2 = gsk_clip_node_new (node, &clip_rect);
       save_node (node2, node_file, "-clipped.node");
 
-      rendered_texture = gsk_renderer_render_texture (renderer, node2, NULL);
+      rendered_texture = render_texture (renderer, node2, NULL, node_file, "-clipped.timing");
       save_image (rendered_texture, node_file, "-clipped.out.png");
 
       pixbuf = gdk_pixbuf_new_from_file (png_file, &error);
@@ -700,7 +853,7 @@ skip_clip:
 
       save_node (node2, node_file, "-colorflipped.node");
 
-      rendered_texture = gsk_renderer_render_texture (renderer, node2, NULL);
+      rendered_texture = render_texture (renderer, node2, NULL, node_file, "-colorflipped.timing");
       save_image (rendered_texture, node_file, "-colorflipped.out.png");
 
       pixbuf = gdk_pixbuf_new_from_file (png_file, &error);
@@ -730,5 +883,5 @@ skip_clip:
   g_object_unref (renderer);
   gdk_surface_destroy (window);
 
-  return success ? 0 : 1;
+  return success && !timing_regressed ? 0 : 1;
 }
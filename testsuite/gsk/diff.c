@@ -95,6 +95,64 @@ test_can_diff_transform (void)
   gsk_transform_unref (t2);
 }
 
+static void
+test_diff_large_container (void)
+{
+  GskRenderNode **children1, **children2;
+  GskRenderNode *container1, *container2;
+  GskDiffData data = { NULL, NULL };
+  cairo_rectangle_int_t extents;
+  guint i, n = 10000;
+
+  children1 = g_new (GskRenderNode *, n);
+  children2 = g_new (GskRenderNode *, n);
+  for (i = 0; i < n; i++)
+    {
+      children1[i] = gsk_color_node_new (&(GdkRGBA){0, 1, 0, 1 }, &GRAPHENE_RECT_INIT (0, i * 10, 10, 10));
+      children2[i] = gsk_render_node_ref (children1[i]);
+    }
+
+  /* change a single child in the middle */
+  gsk_render_node_unref (children2[n / 2]);
+  children2[n / 2] = gsk_color_node_new (&(GdkRGBA){1, 1, 0, 1 }, &GRAPHENE_RECT_INIT (0, n / 2 * 10, 10, 10));
+
+  container1 = gsk_container_node_new (children1, n);
+  container2 = gsk_container_node_new (children2, n);
+
+  data.region = cairo_region_create ();
+  gsk_render_node_diff (container1, container2, &data);
+  cairo_region_get_extents (data.region, &extents);
+  g_assert_cmpint (extents.y, ==, n / 2 * 10);
+  g_assert_cmpint (extents.height, ==, 10);
+  cairo_region_destroy (data.region);
+
+  /* change everything, the diff should cover all children */
+  gsk_render_node_unref (container2);
+  for (i = 0; i < n; i++)
+    {
+      gsk_render_node_unref (children2[i]);
+      children2[i] = gsk_color_node_new (&(GdkRGBA){1, 1, 0, 1 }, &GRAPHENE_RECT_INIT (0, i * 10, 10, 10));
+    }
+  container2 = gsk_container_node_new (children2, n);
+
+  data.region = cairo_region_create ();
+  gsk_render_node_diff (container1, container2, &data);
+  cairo_region_get_extents (data.region, &extents);
+  g_assert_cmpint (extents.y, ==, 0);
+  g_assert_cmpint (extents.height, ==, n * 10);
+  cairo_region_destroy (data.region);
+
+  for (i = 0; i < n; i++)
+    {
+      gsk_render_node_unref (children1[i]);
+      gsk_render_node_unref (children2[i]);
+    }
+  g_free (children1);
+  g_free (children2);
+  gsk_render_node_unref (container1);
+  gsk_render_node_unref (container2);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -103,6 +161,7 @@ main (int   argc,
 
   g_test_add_func ("/node/can-diff/basic", test_can_diff_basic);
   g_test_add_func ("/node/can-diff/transform", test_can_diff_transform);
+  g_test_add_func ("/node/diff/large-container", test_diff_large_container);
 
   return g_test_run ();
 }
@@ -149,6 +149,160 @@ test_container_disjoint (void)
   gsk_render_node_unref (nodes[1]);
 }
 
+static void
+collect_child (GskRenderNode *node,
+               gpointer       data)
+{
+  g_ptr_array_add (data, node);
+}
+
+static void
+test_container_foreach_in_rect (void)
+{
+  GskRenderNode *node, *nodes[2000];
+  const graphene_rect_t rects[] = {
+    GRAPHENE_RECT_INIT (0, 0, 1000, 1000),
+    GRAPHENE_RECT_INIT (95, 95, 10, 10),
+    GRAPHENE_RECT_INIT (-50, -50, 40, 40),
+    GRAPHENE_RECT_INIT (300, 100, 1, 700),
+    GRAPHENE_RECT_INIT (10, 10, 0, 0),
+  };
+  GPtrArray *found;
+  guint i, j, n;
+
+  /* Mostly ordered tiles, with a few that are far away from their neighbours */
+  for (i = 0; i < G_N_ELEMENTS (nodes); i++)
+    {
+      graphene_rect_t bounds;
+
+      if (i % 97 == 0)
+        bounds = GRAPHENE_RECT_INIT (g_test_rand_int_range (0, 900), g_test_rand_int_range (0, 900), 20, 20);
+      else
+        bounds = GRAPHENE_RECT_INIT ((i % 50) * 10, (i / 50) * 10, 10, 10);
+
+      nodes[i] = gsk_color_node_new (&(GdkRGBA){0,1,1,1}, &bounds);
+    }
+  node = gsk_container_node_new (nodes, G_N_ELEMENTS (nodes));
+
+  for (j = 0; j < G_N_ELEMENTS (rects); j++)
+    {
+      found = g_ptr_array_new ();
+      gsk_container_node_foreach_in_rect (node, &rects[j], collect_child, found);
+
+      n = 0;
+      for (i = 0; i < G_N_ELEMENTS (nodes); i++)
+        {
+          if (!graphene_rect_intersection (&nodes[i]->bounds, &rects[j], NULL))
+            continue;
+
+          g_assert_cmpuint (n, <, found->len);
+          g_assert_true (g_ptr_array_index (found, n) == nodes[i]);
+          n++;
+        }
+      g_assert_cmpuint (n, ==, found->len);
+
+      g_ptr_array_unref (found);
+    }
+
+  gsk_render_node_unref (node);
+  for (i = 0; i < G_N_ELEMENTS (nodes); i++)
+    gsk_render_node_unref (nodes[i]);
+}
+
+static void
+test_rendernode_intern (void)
+{
+  GskRenderNode *node1, *node2, *container1, *container2, *other;
+
+  node1 = gsk_render_node_intern (gsk_color_node_new (&(GdkRGBA){0,1,1,1}, &GRAPHENE_RECT_INIT (0, 0, 50, 50)));
+  node2 = gsk_render_node_intern (gsk_color_node_new (&(GdkRGBA){0,1,1,1}, &GRAPHENE_RECT_INIT (0, 0, 50, 50)));
+  g_assert_true (node1 == node2);
+
+  other = gsk_render_node_intern (gsk_color_node_new (&(GdkRGBA){0,1,1,1}, &GRAPHENE_RECT_INIT (50, 0, 50, 50)));
+  g_assert_true (node1 != other);
+
+  container1 = gsk_render_node_intern (gsk_container_node_new ((GskRenderNode *[]) { node1, other }, 2));
+  container2 = gsk_render_node_intern (gsk_container_node_new ((GskRenderNode *[]) { node2, other }, 2));
+  g_assert_true (container1 == container2);
+
+  gsk_render_node_unref (container1);
+  gsk_render_node_unref (container2);
+  gsk_render_node_unref (node1);
+  gsk_render_node_unref (node2);
+  gsk_render_node_unref (other);
+
+  /* after the last reference is gone, a new node is used */
+  node1 = gsk_render_node_intern (gsk_color_node_new (&(GdkRGBA){1,0,0,1}, &GRAPHENE_RECT_INIT (0, 0, 10, 10)));
+  gsk_render_node_unref (node1);
+  node2 = gsk_render_node_intern (gsk_color_node_new (&(GdkRGBA){1,0,0,1}, &GRAPHENE_RECT_INIT (0, 0, 10, 10)));
+  g_assert_true (GSK_IS_RENDER_NODE (node2));
+  gsk_render_node_unref (node2);
+}
+
+static char *
+texture_data_url (const guchar *pixel)
+{
+  GdkTexture *texture;
+  GBytes *bytes, *png;
+  char *base64, *url;
+
+  bytes = g_bytes_new (pixel, 4);
+  texture = gdk_memory_texture_new (1, 1, GDK_MEMORY_R8G8B8A8, bytes, 4);
+  png = gdk_texture_save_to_png_bytes (texture);
+  base64 = g_base64_encode (g_bytes_get_data (png, NULL), g_bytes_get_size (png));
+  url = g_strconcat ("data:image/png;base64,", base64, NULL);
+
+  g_free (base64);
+  g_bytes_unref (png);
+  g_object_unref (texture);
+  g_bytes_unref (bytes);
+
+  return url;
+}
+
+static void
+test_rendernode_parse_data_urls (void)
+{
+  char *red, *blue, *text;
+  GBytes *bytes;
+  GskRenderNode *node;
+  GdkTexture *textures[4];
+  guint i;
+
+  red = texture_data_url ((guchar[]) { 255, 0, 0, 255 });
+  blue = texture_data_url ((guchar[]) { 0, 0, 255, 255 });
+  text = g_strdup_printf ("texture { bounds: 0 0 1 1; texture: url(\"%s\"); }\n"
+                          "texture { bounds: 1 0 1 1; texture: url(\"%s\"); }\n"
+                          "texture { bounds: 2 0 1 1; texture: url(\"%s\"); }\n"
+                          "texture { bounds: 3 0 1 1; texture: url(\"%s\"); }\n",
+                          red, blue, red, blue);
+  bytes = g_bytes_new_take (text, strlen (text));
+
+  node = gsk_render_node_deserialize (bytes, NULL, NULL);
+  g_assert_nonnull (node);
+  g_assert_cmpint (gsk_render_node_get_node_type (node), ==, GSK_CONTAINER_NODE);
+  g_assert_cmpuint (gsk_container_node_get_n_children (node), ==, 4);
+
+  for (i = 0; i < 4; i++)
+    {
+      GskRenderNode *child = gsk_container_node_get_child (node, i);
+
+      g_assert_cmpint (gsk_render_node_get_node_type (child), ==, GSK_TEXTURE_NODE);
+      textures[i] = gsk_texture_node_get_texture (child);
+      g_assert_cmpint (gdk_texture_get_width (textures[i]), ==, 1);
+    }
+
+  /* Repeated urls are decoded once */
+  g_assert_true (textures[0] == textures[2]);
+  g_assert_true (textures[1] == textures[3]);
+  g_assert_true (textures[0] != textures[1]);
+
+  gsk_render_node_unref (node);
+  g_bytes_unref (bytes);
+  g_free (blue);
+  g_free (red);
+}
+
 const char shader1[] =
 "uniform float progress;\n"
 "uniform sampler2D u_texture1;\n"
@@ -278,6 +432,9 @@ main (int argc, char *argv[])
   g_test_add_func ("/rendernode/border/uniform", test_bordernode_uniform);
   g_test_add_func ("/rendernode/conic-gradient/angle", test_conic_gradient_angle);
   g_test_add_func ("/rendernode/container/disjoint", test_container_disjoint);
+  g_test_add_func ("/rendernode/container/foreach-in-rect", test_container_foreach_in_rect);
+  g_test_add_func ("/rendernode/intern", test_rendernode_intern);
+  g_test_add_func ("/rendernode/parse/data-urls", test_rendernode_parse_data_urls);
   g_test_add_func ("/renderer/cairo", test_cairo_renderer);
   g_test_add_func ("/renderer/gl", test_gl_renderer);
 
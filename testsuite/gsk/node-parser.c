@@ -180,6 +180,28 @@ parse_node_file (GFile *file, gboolean generate)
   node = gsk_render_node_deserialize (bytes, deserialize_error_func, errors);
   g_bytes_unref (bytes);
   bytes = gsk_render_node_serialize (node);
+
+  if (!generate)
+    {
+      GskRenderNode *binary_node;
+      GBytes *binary, *binary_text;
+
+      binary = gsk_render_node_serialize_binary (node);
+      binary_node = gsk_render_node_deserialize (binary, NULL, NULL);
+      binary_text = gsk_render_node_serialize (binary_node);
+
+      if (!g_bytes_equal (bytes, binary_text))
+        {
+          g_print ("Binary roundtrip doesn't match text roundtrip:\n%s\n",
+                   (const char *) g_bytes_get_data (binary_text, NULL));
+          result = FALSE;
+        }
+
+      g_bytes_unref (binary_text);
+      gsk_render_node_unref (binary_node);
+      g_bytes_unref (binary);
+    }
+
   gsk_render_node_unref (node);
 
   if (generate)
@@ -18,6 +18,7 @@
  */
 
 #include <gtk/gtk.h>
+#include <math.h>
 
 #include "path-utils.h"
 
@@ -569,6 +570,51 @@ test_in_fill_rotated (void)
 #undef N_FILL_RULES
 }
 
+/* Contours with many operations use a bounding box tree for hit
+ * testing, so check the results against a circle polygon
+ */
+static void
+test_large_contour (void)
+{
+  GskPathBuilder *builder;
+  GskPath *path;
+  const guint n_segments = 2000;
+  const float radius = 100;
+  guint i, j;
+
+  builder = gsk_path_builder_new ();
+  gsk_path_builder_move_to (builder, radius, 0);
+  for (i = 1; i < n_segments; i++)
+    gsk_path_builder_line_to (builder,
+                              radius * cos (2 * G_PI * i / n_segments),
+                              radius * sin (2 * G_PI * i / n_segments));
+  gsk_path_builder_close (builder);
+  path = gsk_path_builder_free_to_path (builder);
+
+  for (j = 0; j < 1000; j++)
+    {
+      double angle = g_test_rand_double_range (0, 2 * G_PI);
+      double r = g_test_rand_double_range (0, 2 * radius);
+      graphene_point_t test = GRAPHENE_POINT_INIT (r * cos (angle), r * sin (angle));
+      GskPathPoint point;
+      float distance;
+
+      /* Stay away from the edge, where the polygon and the circle differ */
+      if (fabs (r - radius) < 1)
+        continue;
+
+      g_assert_cmpint (gsk_path_in_fill (path, &test, GSK_FILL_RULE_WINDING), ==, r < radius);
+      g_assert_cmpint (gsk_path_in_fill (path, &test, GSK_FILL_RULE_EVEN_ODD), ==, r < radius);
+
+      g_assert_true (gsk_path_get_closest_point (path, &test, INFINITY, &point, &distance));
+      g_assert_cmpfloat_with_epsilon (distance, fabs (r - radius), 0.1);
+
+      g_assert_false (gsk_path_get_closest_point (path, &test, fabs (r - radius) - 0.5, &point, &distance));
+    }
+
+  gsk_path_unref (path);
+}
+
 static void
 test_split (void)
 {
@@ -762,6 +808,68 @@ test_segment (void)
     }
 }
 
+/* The measure only measures the contours it needs, so look up
+ * distances in random order and check they end up in the right
+ * contour, including empty ones.
+ */
+static void
+test_measure_contours (void)
+{
+  GskPathBuilder *builder;
+  GskPathMeasure *measure;
+  GskPath *path;
+  GskPathPoint point;
+  guint i;
+
+  builder = gsk_path_builder_new ();
+  for (i = 0; i < 100; i++)
+    {
+      if (i % 10 == 5)
+        {
+          /* an empty contour */
+          gsk_path_builder_move_to (builder, 10 * i, 0);
+          gsk_path_builder_close (builder);
+        }
+      else
+        gsk_path_builder_add_rect (builder, &GRAPHENE_RECT_INIT (10 * i, 0, 5, 5));
+    }
+  path = gsk_path_builder_free_to_path (builder);
+
+  for (i = 0; i < 1000; i++)
+    {
+      graphene_point_t pos;
+      float distance, fraction;
+      guint rank, contour;
+
+      measure = gsk_path_measure_new (path);
+
+      distance = g_test_rand_double_range (0, 90 * 20);
+      fraction = distance / 20 - floorf (distance / 20);
+      if (fraction < 0.001 || fraction > 0.999)
+        continue;
+
+      /* skip the empty contours when counting */
+      rank = (guint) (distance / 20);
+      for (contour = 0; contour % 10 == 5 || rank > 0; contour++)
+        {
+          if (contour % 10 != 5)
+            rank--;
+        }
+
+      g_assert_true (gsk_path_measure_get_point (measure, distance, &point));
+      gsk_path_point_get_position (&point, path, &pos);
+      g_assert_cmpfloat (pos.x, >=, 10 * contour - 0.01);
+      g_assert_cmpfloat (pos.x, <=, 10 * contour + 5.01);
+      g_assert_cmpfloat_with_epsilon (gsk_path_point_get_distance (&point, measure), distance, 0.01);
+
+      g_assert_cmpfloat_with_epsilon (gsk_path_measure_get_length (measure), 90 * 20, 0.01);
+
+      gsk_path_measure_unref (measure);
+    }
+
+  gsk_path_unref (path);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -772,9 +880,11 @@ main (int   argc,
   g_test_add_func ("/path/parse", test_parse);
   g_test_add_func ("/path/in-fill-union", test_in_fill_union);
   g_test_add_func ("/path/in-fill-rotated", test_in_fill_rotated);
+  g_test_add_func ("/path/large-contour", test_large_contour);
   g_test_add_func ("/path/measure/split", test_split);
   g_test_add_func ("/path/measure/roundtrip", test_roundtrip);
   g_test_add_func ("/path/measure/segment", test_segment);
+  g_test_add_func ("/path/measure/contours", test_measure_contours);
 
   return g_test_run ();
 }
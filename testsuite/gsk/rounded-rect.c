@@ -139,6 +139,37 @@ test_is_circular (void)
   g_assert_true (gsk_rounded_rect_is_circular (&rect));
 }
 
+static void
+test_get_shape (void)
+{
+  GskRoundedRect rect;
+
+  gsk_rounded_rect_init_from_rect (&rect, &GRAPHENE_RECT_INIT (0, 0, 100, 100), 0);
+  g_assert_cmpint (gsk_rounded_rect_get_shape (&rect), ==, GSK_ROUNDED_RECT_SHAPE_RECTILINEAR |
+                                                           GSK_ROUNDED_RECT_SHAPE_CIRCULAR |
+                                                           GSK_ROUNDED_RECT_SHAPE_UNIFORM);
+
+  gsk_rounded_rect_init_from_rect (&rect, &GRAPHENE_RECT_INIT (0, 0, 100, 100), 10);
+  g_assert_cmpint (gsk_rounded_rect_get_shape (&rect), ==, GSK_ROUNDED_RECT_SHAPE_CIRCULAR |
+                                                           GSK_ROUNDED_RECT_SHAPE_UNIFORM);
+
+  gsk_rounded_rect_init (&rect,
+                         &GRAPHENE_RECT_INIT (0, 0, 100, 100),
+                         &GRAPHENE_SIZE_INIT (0, 0),
+                         &GRAPHENE_SIZE_INIT (10, 10),
+                         &GRAPHENE_SIZE_INIT (20, 20),
+                         &GRAPHENE_SIZE_INIT (30, 30));
+  g_assert_cmpint (gsk_rounded_rect_get_shape (&rect), ==, GSK_ROUNDED_RECT_SHAPE_CIRCULAR);
+
+  gsk_rounded_rect_init (&rect,
+                         &GRAPHENE_RECT_INIT (0, 0, 100, 100),
+                         &GRAPHENE_SIZE_INIT (10, 20),
+                         &GRAPHENE_SIZE_INIT (10, 20),
+                         &GRAPHENE_SIZE_INIT (10, 20),
+                         &GRAPHENE_SIZE_INIT (10, 20));
+  g_assert_cmpint (gsk_rounded_rect_get_shape (&rect), ==, GSK_ROUNDED_RECT_SHAPE_UNIFORM);
+}
+
 static void
 test_to_float (void)
 {
@@ -412,6 +443,7 @@ main (int   argc,
   g_test_add_func ("/rounded-rect/intersects-rect", test_intersects_rect);
   g_test_add_func ("/rounded-rect/contains-point", test_contains_point);
   g_test_add_func ("/rounded-rect/is-circular", test_is_circular);
+  g_test_add_func ("/rounded-rect/get-shape", test_get_shape);
   g_test_add_func ("/rounded-rect/to-float", test_to_float);
   g_test_add_func ("/rounded-rect/intersect-with-rect", test_intersect_with_rect);
   g_test_add_func ("/rounded-rect/intersect", test_intersect);
@@ -994,6 +994,78 @@ test_matrix_roundtrip (void)
   g_free (str);
 }
 
+static void
+test_cached_matrix (void)
+{
+  GskTransform *prefix, *transform, *uncached;
+  graphene_matrix_t m1, m2, m3;
+  float xx, yx, xy, yy, dx, dy;
+  float xx2, yx2, xy2, yy2, dx2, dy2;
+  int i;
+
+  prefix = NULL;
+  for (i = 0; i < 20; i++)
+    {
+      prefix = gsk_transform_translate (prefix, &GRAPHENE_POINT_INIT (i, -i));
+      prefix = gsk_transform_scale (prefix, 1.1f, 0.9f);
+    }
+
+  /* Converting to a matrix must not change what the 2D getters return */
+  gsk_transform_to_affine (prefix, &xx, &yy, &dx, &dy);
+  gsk_transform_to_matrix (prefix, &m1);
+  gsk_transform_to_affine (prefix, &xx2, &yy2, &dx2, &dy2);
+  g_assert_cmpfloat_with_epsilon (xx, xx2, EPSILON);
+  g_assert_cmpfloat_with_epsilon (yy, yy2, EPSILON);
+  g_assert_cmpfloat_with_epsilon (dx, dx2, EPSILON);
+  g_assert_cmpfloat_with_epsilon (dy, dy2, EPSILON);
+
+  gsk_transform_to_matrix (prefix, &m2);
+  graphene_assert_fuzzy_matrix_equal (&m1, &m2, EPSILON);
+
+  transform = gsk_transform_rotate (gsk_transform_ref (prefix), 30);
+  gsk_transform_to_2d (transform, &xx, &yx, &xy, &yy, &dx, &dy);
+  gsk_transform_to_matrix (transform, &m1);
+  gsk_transform_to_2d (transform, &xx2, &yx2, &xy2, &yy2, &dx2, &dy2);
+  g_assert_cmpfloat_with_epsilon (xx, xx2, EPSILON);
+  g_assert_cmpfloat_with_epsilon (yx, yx2, EPSILON);
+  g_assert_cmpfloat_with_epsilon (xy, xy2, EPSILON);
+  g_assert_cmpfloat_with_epsilon (yy, yy2, EPSILON);
+  g_assert_cmpfloat_with_epsilon (dx, dx2, EPSILON);
+  g_assert_cmpfloat_with_epsilon (dy, dy2, EPSILON);
+  gsk_transform_unref (transform);
+
+  /* A chain built on a cached prefix must match one built from scratch */
+  transform = gsk_transform_ref (prefix);
+  uncached = NULL;
+  for (i = 0; i < 20; i++)
+    uncached = gsk_transform_scale (gsk_transform_translate (uncached, &GRAPHENE_POINT_INIT (i, -i)), 1.1f, 0.9f);
+  for (i = 0; i < 5; i++)
+    {
+      transform = gsk_transform_rotate_3d (transform, 10 * i, graphene_vec3_x_axis ());
+      transform = gsk_transform_perspective (transform, 500);
+      uncached = gsk_transform_rotate_3d (uncached, 10 * i, graphene_vec3_x_axis ());
+      uncached = gsk_transform_perspective (uncached, 500);
+
+      /* cache every other intermediate step */
+      if (i % 2)
+        gsk_transform_to_matrix (transform, &m1);
+    }
+
+  gsk_transform_to_matrix (transform, &m1);
+  gsk_transform_to_matrix (uncached, &m3);
+  graphene_assert_fuzzy_matrix_equal (&m1, &m3, EPSILON);
+
+  transform = gsk_transform_translate (transform, &GRAPHENE_POINT_INIT (5, 5));
+  uncached = gsk_transform_translate (uncached, &GRAPHENE_POINT_INIT (5, 5));
+  gsk_transform_to_matrix (transform, &m1);
+  gsk_transform_to_matrix (uncached, &m3);
+  graphene_assert_fuzzy_matrix_equal (&m1, &m3, EPSILON);
+
+  gsk_transform_unref (transform);
+  gsk_transform_unref (uncached);
+  gsk_transform_unref (prefix);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -1019,6 +1091,7 @@ main (int   argc,
   g_test_add_func ("/transform/rotate3d", test_rotate3d_transform);
   g_test_add_func ("/transform/matrix", test_matrix_transform);
   g_test_add_func ("/transform/matrix/roundtrip", test_matrix_roundtrip);
+  g_test_add_func ("/transform/matrix/cached", test_cached_matrix);
 
   return g_test_run ();
 }
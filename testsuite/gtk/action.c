@@ -771,6 +771,125 @@ test_reparenting (void)
   g_object_unref (window);
 }
 
+static void
+count_notify (GObject    *object,
+              GParamSpec *pspec,
+              gpointer    data)
+{
+  int *count = data;
+
+  (*count)++;
+}
+
+/* Test that changes to the enabled state are sent to
+ * actionables once, before the next frame
+ */
+static void
+test_batched_changes (void)
+{
+  GtkWidget *window;
+  GtkWidget *button;
+  GSimpleActionGroup *actions;
+  GAction *action;
+  int activated = 0;
+  int notified = 0;
+  GActionEntry entries[] = {
+    { "action", activate, NULL, NULL, NULL },
+  };
+
+  window = gtk_window_new ();
+  button = gtk_button_new ();
+  gtk_window_set_child (GTK_WINDOW (window), button);
+
+  actions = g_simple_action_group_new ();
+  g_action_map_add_action_entries (G_ACTION_MAP (actions),
+                                   entries, G_N_ELEMENTS (entries),
+                                   &activated);
+  gtk_widget_insert_action_group (window, "win", G_ACTION_GROUP (actions));
+
+  gtk_actionable_set_action_name (GTK_ACTIONABLE (button), "win.action");
+  g_assert_true (gtk_widget_get_sensitive (button));
+
+  g_signal_connect (button, "notify::sensitive", G_CALLBACK (count_notify), &notified);
+
+  action = g_action_map_lookup_action (G_ACTION_MAP (actions), "action");
+  g_simple_action_set_enabled (G_SIMPLE_ACTION (action), FALSE);
+  g_simple_action_set_enabled (G_SIMPLE_ACTION (action), TRUE);
+  g_simple_action_set_enabled (G_SIMPLE_ACTION (action), FALSE);
+
+  while (g_main_context_pending (NULL))
+    g_main_context_iteration (NULL, FALSE);
+
+  g_assert_false (gtk_widget_get_sensitive (button));
+  g_assert_cmpint (notified, ==, 1);
+
+  /* Disabled actions don't get activated, without waiting */
+  gtk_widget_activate_action (button, "win.action", NULL);
+  g_assert_cmpint (activated, ==, 0);
+
+  g_simple_action_set_enabled (G_SIMPLE_ACTION (action), TRUE);
+  gtk_widget_activate_action (button, "win.action", NULL);
+  g_assert_cmpint (activated, ==, 1);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_object_unref (actions);
+}
+
+/* Test that looking up actions notices actions
+ * being removed from and added to groups
+ */
+static void
+test_lookup_after_removal (void)
+{
+  GtkWidget *window;
+  GtkWidget *box;
+  GSimpleActionGroup *win_actions;
+  GSimpleActionGroup *box_actions;
+  int win_activated = 0;
+  int box_activated = 0;
+  GActionEntry entries[] = {
+    { "action", activate, NULL, NULL, NULL },
+  };
+
+  window = gtk_window_new ();
+  box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
+  gtk_window_set_child (GTK_WINDOW (window), box);
+
+  win_actions = g_simple_action_group_new ();
+  g_action_map_add_action_entries (G_ACTION_MAP (win_actions),
+                                   entries, G_N_ELEMENTS (entries),
+                                   &win_activated);
+  box_actions = g_simple_action_group_new ();
+  g_action_map_add_action_entries (G_ACTION_MAP (box_actions),
+                                   entries, G_N_ELEMENTS (entries),
+                                   &box_activated);
+
+  gtk_widget_insert_action_group (window, "group", G_ACTION_GROUP (win_actions));
+  gtk_widget_insert_action_group (box, "group", G_ACTION_GROUP (box_actions));
+
+  gtk_widget_activate_action (box, "group.action", NULL);
+  g_assert_cmpint (box_activated, ==, 1);
+  g_assert_cmpint (win_activated, ==, 0);
+
+  g_action_map_remove_action (G_ACTION_MAP (box_actions), "action");
+
+  gtk_widget_activate_action (box, "group.action", NULL);
+  g_assert_cmpint (box_activated, ==, 1);
+  g_assert_cmpint (win_activated, ==, 1);
+
+  g_action_map_add_action_entries (G_ACTION_MAP (box_actions),
+                                   entries, G_N_ELEMENTS (entries),
+                                   &box_activated);
+
+  gtk_widget_activate_action (box, "group.action", NULL);
+  g_assert_cmpint (box_activated, ==, 2);
+  g_assert_cmpint (win_activated, ==, 1);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_object_unref (win_actions);
+  g_object_unref (box_actions);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -787,6 +906,8 @@ main (int   argc,
   g_test_add_func ("/action/introspection", test_introspection);
   g_test_add_func ("/action/enabled", test_enabled);
   g_test_add_func ("/action/reparenting", test_reparenting);
+  g_test_add_func ("/action/batched-changes", test_batched_changes);
+  g_test_add_func ("/action/lookup-after-removal", test_lookup_after_removal);
 
   return g_test_run();
 }
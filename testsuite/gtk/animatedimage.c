@@ -0,0 +1,129 @@
+/* GTK - The GIMP Toolkit
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+#include <string.h>
+
+/* A looping 1x1 GIF with a red and a blue frame, 20ms each */
+static const guchar two_frames_gif[] = {
+  'G', 'I', 'F', '8', '9', 'a',
+  0x01, 0x00, 0x01, 0x00, 0x80, 0x00, 0x00,
+  0xff, 0x00, 0x00,
+  0x00, 0x00, 0xff,
+  0x21, 0xff, 0x0b, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0',
+  0x03, 0x01, 0x00, 0x00, 0x00,
+  0x21, 0xf9, 0x04, 0x00, 0x02, 0x00, 0x00, 0x00,
+  0x2c, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00,
+  0x02, 0x02, 0x44, 0x01, 0x00,
+  0x21, 0xf9, 0x04, 0x00, 0x02, 0x00, 0x00, 0x00,
+  0x2c, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00,
+  0x02, 0x02, 0x4c, 0x01, 0x00,
+  0x3b
+};
+
+static gboolean
+wait_for_prepared (GtkMediaStream *stream)
+{
+  while (!gtk_media_stream_is_prepared (stream))
+    g_main_context_iteration (NULL, TRUE);
+
+  return gtk_media_stream_get_error (stream) == NULL;
+}
+
+static guint32
+get_current_pixel (GtkMediaStream *stream)
+{
+  GdkPaintable *image;
+  guint32 pixel;
+
+  image = gdk_paintable_get_current_image (GDK_PAINTABLE (stream));
+  g_assert_true (GDK_IS_TEXTURE (image));
+  gdk_texture_download (GDK_TEXTURE (image), (guchar *) &pixel, 4);
+  g_object_unref (image);
+
+  return pixel;
+}
+
+static void
+test_frames (void)
+{
+  GtkMediaStream *stream;
+  GBytes *bytes;
+
+  bytes = g_bytes_new_static (two_frames_gif, sizeof (two_frames_gif));
+  stream = gtk_animated_image_new_for_bytes (bytes);
+  g_bytes_unref (bytes);
+
+  if (!wait_for_prepared (stream))
+    {
+      g_test_skip (gtk_media_stream_get_error (stream)->message);
+      g_object_unref (stream);
+      return;
+    }
+
+  g_assert_cmpint (gdk_paintable_get_intrinsic_width (GDK_PAINTABLE (stream)), ==, 1);
+  g_assert_cmpint (gdk_paintable_get_intrinsic_height (GDK_PAINTABLE (stream)), ==, 1);
+  g_assert_true (gtk_media_stream_has_video (stream));
+  g_assert_false (gtk_media_stream_has_audio (stream));
+  g_assert_cmphex (get_current_pixel (stream), ==, 0xffff0000);
+
+  gtk_media_stream_play (stream);
+
+  while (gtk_media_stream_get_timestamp (stream) == 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmphex (get_current_pixel (stream), ==, 0xff0000ff);
+  g_assert_true (gtk_media_stream_get_playing (stream));
+
+  /* The GIF loops by itself */
+  while (get_current_pixel (stream) != 0xffff0000)
+    g_main_context_iteration (NULL, TRUE);
+
+  gtk_media_stream_pause (stream);
+  g_assert_false (gtk_media_stream_get_playing (stream));
+
+  g_object_unref (stream);
+}
+
+static void
+test_invalid (void)
+{
+  GtkMediaStream *stream;
+  GBytes *bytes;
+
+  bytes = g_bytes_new_static ("not an image", strlen ("not an image"));
+  stream = gtk_animated_image_new_for_bytes (bytes);
+  g_bytes_unref (bytes);
+
+  g_assert_false (wait_for_prepared (stream));
+  g_assert_nonnull (gtk_media_stream_get_error (stream));
+
+  gtk_media_stream_play (stream);
+  g_assert_false (gtk_media_stream_get_playing (stream));
+
+  g_object_unref (stream);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/animatedimage/frames", test_frames);
+  g_test_add_func ("/animatedimage/invalid", test_invalid);
+
+  return g_test_run ();
+}
@@ -544,6 +544,58 @@ test_iter (void)
   gtk_bitset_unref (set);
 }
 
+static void
+test_iter_runs (void)
+{
+  GtkBitset *set;
+  GtkBitsetIter iter;
+  guint first, n_items;
+
+  set = gtk_bitset_new_empty ();
+
+  gtk_bitset_iter_init_first (&iter, set, NULL);
+  g_assert_false (gtk_bitset_iter_next_run (&iter, &first, &n_items));
+  g_assert_cmpuint (first, ==, 0);
+  g_assert_cmpuint (n_items, ==, 0);
+
+  gtk_bitset_add_range_closed (set, 10, 20);
+  gtk_bitset_add_range (set, 100, 100000);
+  gtk_bitset_add (set, 200000);
+  gtk_bitset_add (set, G_MAXUINT);
+
+  gtk_bitset_iter_init_first (&iter, set, NULL);
+  g_assert_true (gtk_bitset_iter_next_run (&iter, &first, &n_items));
+  g_assert_cmpuint (first, ==, 10);
+  g_assert_cmpuint (n_items, ==, 11);
+  g_assert_true (gtk_bitset_iter_next_run (&iter, &first, &n_items));
+  g_assert_cmpuint (first, ==, 100);
+  g_assert_cmpuint (n_items, ==, 100000);
+  g_assert_true (gtk_bitset_iter_next_run (&iter, &first, &n_items));
+  g_assert_cmpuint (first, ==, 200000);
+  g_assert_cmpuint (n_items, ==, 1);
+  g_assert_true (gtk_bitset_iter_next_run (&iter, &first, &n_items));
+  g_assert_cmpuint (first, ==, G_MAXUINT);
+  g_assert_cmpuint (n_items, ==, 1);
+  g_assert_false (gtk_bitset_iter_next_run (&iter, &first, &n_items));
+  g_assert_false (gtk_bitset_iter_is_valid (&iter));
+
+  /* runs start at the current value */
+  gtk_bitset_iter_init_at (&iter, set, 15, NULL);
+  g_assert_true (gtk_bitset_iter_next_run (&iter, &first, &n_items));
+  g_assert_cmpuint (first, ==, 15);
+  g_assert_cmpuint (n_items, ==, 6);
+  g_assert_cmpuint (gtk_bitset_iter_get_value (&iter), ==, 100);
+
+  g_assert_true (gtk_bitset_contains_range (set, 10, 11));
+  g_assert_false (gtk_bitset_contains_range (set, 10, 12));
+  g_assert_true (gtk_bitset_contains_range (set, 100, 100000));
+  g_assert_false (gtk_bitset_contains_range (set, 99, 2));
+  g_assert_true (gtk_bitset_contains_range (set, 5, 0));
+  g_assert_true (gtk_bitset_contains_range (set, G_MAXUINT, 1));
+
+  gtk_bitset_unref (set);
+}
+
 static void
 test_splice_overflow (void)
 {
@@ -578,6 +630,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/bitset/slice", test_slice);
   g_test_add_func ("/bitset/rectangle", test_rectangle);
   g_test_add_func ("/bitset/iter", test_iter);
+  g_test_add_func ("/bitset/iter-runs", test_iter_runs);
   g_test_add_func ("/bitset/splice-overflow", test_splice_overflow);
 
   return g_test_run ();
@@ -24,6 +24,7 @@
 
 #include <gtk/gtk.h>
 #include <gdk/gdkkeysyms.h>
+#include <glib/gstdio.h>
 
 G_GNUC_BEGIN_IGNORE_DEPRECATIONS
 
@@ -252,6 +253,13 @@ test_connect_signals (void)
     "    <signal name=\"notify::title\" handler=\"signal_normal\"/>"
     "  </object>"
     "</interface>";
+  const char buffer_with_property[] =
+    "<interface>"
+    "  <object class=\"GtkWindow\" id=\"window1\">"
+    "    <property name=\"title\">title</property>"
+    "    <signal name=\"notify::title\" handler=\"signal_normal\"/>"
+    "  </object>"
+    "</interface>";
 
   builder = builder_new_from_string (buffer, -1, NULL);
 
@@ -301,6 +309,19 @@ test_connect_signals (void)
   g_assert_true (normal == 1);
   gtk_window_destroy (GTK_WINDOW (window));
   g_object_unref (builder);
+
+  /* Notifications held back during construction must not reach
+   * handlers from the UI file
+   */
+  normal = 0;
+
+  builder = builder_new_from_string (buffer_with_property, -1, NULL);
+  window = gtk_builder_get_object (builder, "window1");
+  g_assert_cmpint (normal, ==, 0);
+  gtk_window_set_title (GTK_WINDOW (window), "test");
+  g_assert_cmpint (normal, ==, 1);
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_object_unref (builder);
 }
 
 static void
@@ -2490,6 +2511,92 @@ test_template (void)
   g_object_unref (my_gtk_grid);
 }
 
+#define MY_GTK_BOX_TEMPLATE "\
+<interface>\n\
+ <template class=\"MyGtkBox\" parent=\"GtkBox\">\n\
+   <property name=\"spacing\">6</property>\n\
+   <property name=\"orientation\">vertical</property>\n\
+    <child>\n\
+     <object class=\"GtkLabel\" id=\"label\">\n\
+       <property name=\"xalign\">0.25</property>\n\
+       <property name=\"justify\">right</property>\n\
+       <property name=\"selectable\">true</property>\n\
+     </object>\n\
+  </child>\n\
+ </template>\n\
+</interface>\n"
+
+typedef struct
+{
+  GtkBoxClass parent_class;
+} MyGtkBoxClass;
+
+typedef struct
+{
+  GtkBox parent_instance;
+  GtkLabel *label;
+} MyGtkBox;
+
+GType my_gtk_box_get_type (void);
+
+G_DEFINE_TYPE (MyGtkBox, my_gtk_box, GTK_TYPE_BOX);
+
+static void
+my_gtk_box_init (MyGtkBox *box)
+{
+  gtk_widget_init_template (GTK_WIDGET (box));
+}
+
+static void
+my_gtk_box_dispose (GObject *object)
+{
+  gtk_widget_dispose_template (GTK_WIDGET (object), my_gtk_box_get_type ());
+
+  G_OBJECT_CLASS (my_gtk_box_parent_class)->dispose (object);
+}
+
+static void
+my_gtk_box_class_init (MyGtkBoxClass *klass)
+{
+  GBytes *template = g_bytes_new_static (MY_GTK_BOX_TEMPLATE, strlen (MY_GTK_BOX_TEMPLATE));
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+  G_OBJECT_CLASS (klass)->dispose = my_gtk_box_dispose;
+
+  gtk_widget_class_set_template (widget_class, template);
+  gtk_widget_class_bind_template_child (widget_class, MyGtkBox, label);
+
+  g_bytes_unref (template);
+}
+
+/* Property values of templates are cached after the first instance,
+ * check that later instances still get them
+ */
+static void
+test_template_values (void)
+{
+  int i;
+
+  for (i = 0; i < 3; i++)
+    {
+      MyGtkBox *box = g_object_new (my_gtk_box_get_type (), NULL);
+
+      g_object_ref_sink (box);
+
+      g_assert_cmpint (gtk_box_get_spacing (GTK_BOX (box)), ==, 6);
+      g_assert_cmpint (gtk_orientable_get_orientation (GTK_ORIENTABLE (box)), ==, GTK_ORIENTATION_VERTICAL);
+      g_assert_cmpfloat (gtk_label_get_xalign (box->label), ==, 0.25);
+      g_assert_cmpint (gtk_label_get_justify (box->label), ==, GTK_JUSTIFY_RIGHT);
+      g_assert_true (gtk_label_get_selectable (box->label));
+
+      /* Changing an instance must not leak into the next one */
+      gtk_box_set_spacing (GTK_BOX (box), 12);
+      gtk_label_set_justify (box->label, GTK_JUSTIFY_LEFT);
+
+      g_object_unref (box);
+    }
+}
+
 _BUILDER_TEST_EXPORT void
 on_cellrenderertoggle1_toggled (GtkCellRendererToggle *cell)
 {
@@ -2917,6 +3024,76 @@ test_buildable (void)
   g_object_unref (my_gtk_buildable);
 }
 
+static void
+async_done (GObject      *source,
+            GAsyncResult *result,
+            gpointer      data)
+{
+  GAsyncResult **res = data;
+
+  *res = g_object_ref (result);
+}
+
+static void
+test_add_from_file_async (void)
+{
+  const char buffer[] =
+    "<interface>"
+    "  <object class=\"GtkBox\" id=\"box\">"
+    "    <child>"
+    "      <object class=\"GtkLabel\" id=\"label\">"
+    "        <property name=\"label\">Hello</property>"
+    "      </object>"
+    "    </child>"
+    "  </object>"
+    "</interface>";
+  GtkBuilder *builder;
+  GAsyncResult *result = NULL;
+  GError *error = NULL;
+  GObject *label;
+  char *filename;
+  gboolean ret;
+  int fd;
+
+  fd = g_file_open_tmp ("builder-XXXXXX.ui", &filename, &error);
+  g_assert_no_error (error);
+  g_close (fd, NULL);
+  g_file_set_contents (filename, buffer, -1, &error);
+  g_assert_no_error (error);
+
+  builder = gtk_builder_new ();
+  gtk_builder_add_from_file_async (builder, filename, NULL, async_done, &result);
+  g_assert_null (gtk_builder_get_object (builder, "box"));
+
+  while (result == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  ret = gtk_builder_add_from_file_finish (builder, result, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+  g_clear_object (&result);
+
+  g_assert_true (GTK_IS_BOX (gtk_builder_get_object (builder, "box")));
+  label = gtk_builder_get_object (builder, "label");
+  g_assert_true (GTK_IS_LABEL (label));
+  g_assert_cmpstr (gtk_label_get_label (GTK_LABEL (label)), ==, "Hello");
+
+  g_remove (filename);
+  g_free (filename);
+
+  gtk_builder_add_from_file_async (builder, "does-not-exist.ui", NULL, async_done, &result);
+  while (result == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  ret = gtk_builder_add_from_file_finish (builder, result, &error);
+  g_assert_error (error, G_FILE_ERROR, G_FILE_ERROR_NOENT);
+  g_assert_false (ret);
+  g_clear_error (&error);
+  g_clear_object (&result);
+
+  g_object_unref (builder);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -2957,6 +3134,7 @@ main (int argc, char **argv)
   g_test_add_func ("/Builder/LevelBar", test_level_bar);
   g_test_add_func ("/Builder/Expose Object", test_expose_object);
   g_test_add_func ("/Builder/Template", test_template);
+  g_test_add_func ("/Builder/Template Values", test_template_values);
   g_test_add_func ("/Builder/No IDs", test_no_ids);
   g_test_add_func ("/Builder/Property Bindings", test_property_bindings);
   g_test_add_func ("/Builder/anaconda-signal", test_anaconda_signal);
@@ -2966,6 +3144,7 @@ main (int argc, char **argv)
   g_test_add_func ("/Builder/Expressions", test_expressions);
   g_test_add_func ("/Builder/Child Dispose Order", test_child_dispose_order);
   g_test_add_func ("/Builder/Buildable", test_buildable);
+  g_test_add_func ("/Builder/Add From File Async", test_add_from_file_async);
 
   return g_test_run();
 }
@@ -282,6 +282,47 @@ constraint_solver_edit_var_suggest (void)
   g_object_unref (solver);
 }
 
+static void
+constraint_solver_stay_update (void)
+{
+  GtkConstraintSolver *solver = gtk_constraint_solver_new ();
+
+  GtkConstraintVariable *a = gtk_constraint_solver_create_variable (solver, NULL, "a", 5.0);
+  GtkConstraintVariable *b = gtk_constraint_solver_create_variable (solver, NULL, "b", 0.0);
+
+  gtk_constraint_solver_add_stay_variable (solver, a, GTK_CONSTRAINT_STRENGTH_REQUIRED);
+
+  GtkConstraintExpressionBuilder builder;
+  gtk_constraint_expression_builder_init (&builder, solver);
+  gtk_constraint_expression_builder_term (&builder, a);
+  gtk_constraint_expression_builder_plus (&builder);
+  gtk_constraint_expression_builder_constant (&builder, 10.0);
+  gtk_constraint_solver_add_constraint (solver,
+                                        b, GTK_CONSTRAINT_RELATION_EQ,
+                                        gtk_constraint_expression_builder_finish (&builder),
+                                        GTK_CONSTRAINT_STRENGTH_REQUIRED);
+
+  g_assert_cmpfloat_with_epsilon (gtk_constraint_variable_get_value (a), 5.0, 0.001);
+  g_assert_cmpfloat_with_epsilon (gtk_constraint_variable_get_value (b), 15.0, 0.001);
+
+  gtk_constraint_solver_update_stay_variable (solver, a, 20.0);
+
+  g_assert_cmpfloat_with_epsilon (gtk_constraint_variable_get_value (a), 20.0, 0.001);
+  g_assert_cmpfloat_with_epsilon (gtk_constraint_variable_get_value (b), 30.0, 0.001);
+
+  gtk_constraint_solver_freeze (solver);
+  gtk_constraint_solver_update_stay_variable (solver, a, 1.0);
+  gtk_constraint_solver_thaw (solver);
+
+  g_assert_cmpfloat_with_epsilon (gtk_constraint_variable_get_value (a), 1.0, 0.001);
+  g_assert_cmpfloat_with_epsilon (gtk_constraint_variable_get_value (b), 11.0, 0.001);
+
+  gtk_constraint_variable_unref (a);
+  gtk_constraint_variable_unref (b);
+
+  g_object_unref (solver);
+}
+
 static void
 constraint_solver_paper (void)
 {
@@ -373,6 +414,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/constraint-solver/constant/le", constraint_solver_variable_leq_constant);
   g_test_add_func ("/constraint-solver/stay/simple", constraint_solver_stay);
   g_test_add_func ("/constraint-solver/stay/eq", constraint_solver_eq_with_stay);
+  g_test_add_func ("/constraint-solver/stay/update", constraint_solver_stay_update);
   g_test_add_func ("/constraint-solver/cassowary", constraint_solver_cassowary);
   g_test_add_func ("/constraint-solver/edit/required", constraint_solver_edit_var_required);
   g_test_add_func ("/constraint-solver/edit/suggest", constraint_solver_edit_var_suggest);
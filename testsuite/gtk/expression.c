@@ -323,6 +323,51 @@ test_nested (void)
  * the watch should invalidate itself because its this object
  * is gone.
  */
+static GListModel *
+create_no_children (gpointer item,
+                    gpointer user_data)
+{
+  return NULL;
+}
+
+/* Test property chains that use the direct getters */
+static void
+test_tree_list_row_chain (void)
+{
+  GtkStringList *list;
+  GtkTreeListModel *tree;
+  GtkTreeListRow *row, *row2;
+  GtkExpression *expr;
+  GtkSorter *sorter;
+  GValue value = G_VALUE_INIT;
+  gboolean res;
+
+  list = gtk_string_list_new ((const char *[]) { "b", "a", NULL });
+  tree = gtk_tree_list_model_new (G_LIST_MODEL (list), FALSE, FALSE, create_no_children, NULL, NULL);
+
+  expr = gtk_property_expression_new (GTK_TYPE_TREE_LIST_ROW, NULL, "item");
+  expr = gtk_property_expression_new (GTK_TYPE_STRING_OBJECT, expr, "string");
+
+  row = gtk_tree_list_model_get_row (tree, 0);
+  res = gtk_expression_evaluate (expr, row, &value);
+  g_assert_true (res);
+  g_assert_cmpstr (g_value_get_string (&value), ==, "b");
+  g_value_unset (&value);
+  g_object_unref (row);
+
+  sorter = GTK_SORTER (gtk_string_sorter_new (gtk_expression_ref (expr)));
+  row = gtk_tree_list_model_get_row (tree, 0);
+  row2 = gtk_tree_list_model_get_row (tree, 1);
+  g_assert_cmpint (gtk_sorter_compare (sorter, row, row2), ==, GTK_ORDERING_LARGER);
+  g_assert_cmpint (gtk_sorter_compare (sorter, row2, row2), ==, GTK_ORDERING_EQUAL);
+  g_object_unref (row2);
+  g_object_unref (row);
+  g_object_unref (sorter);
+
+  gtk_expression_unref (expr);
+  g_object_unref (tree);
+}
+
 static void
 test_nested_this_destroyed (void)
 {
@@ -794,6 +839,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/expression/object", test_object);
   g_test_add_func ("/expression/nested", test_nested);
   g_test_add_func ("/expression/nested-this-destroyed", test_nested_this_destroyed);
+  g_test_add_func ("/expression/tree-list-row-chain", test_tree_list_row_chain);
   g_test_add_func ("/expression/type-mismatch", test_type_mismatch);
   g_test_add_func ("/expression/this", test_this);
   g_test_add_func ("/expression/bind", test_bind);
@@ -293,6 +293,9 @@ test_string_properties (void)
   g_assert_true (expr == gtk_string_filter_get_expression (GTK_STRING_FILTER (filter)));
 
   model = new_model (1000, filter);
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "irte");
+  assert_model (model, "13 113 213 313 413 513 613 713 813 913");
+
   gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "thirte");
   assert_model (model, "13 113 213 313 413 513 613 713 813 913");
 
@@ -561,6 +561,102 @@ test_sections (void)
   g_object_unref (sorted);
 }
 
+static guint
+count_containing (GtkStringList *list,
+                  const char    *search)
+{
+  guint i, n_items, result = 0;
+
+  n_items = g_list_model_get_n_items (G_LIST_MODEL (list));
+  for (i = 0; i < n_items; i++)
+    {
+      if (strstr (gtk_string_list_get_string (list, i), search))
+        result++;
+    }
+
+  return result;
+}
+
+/* Test that a stricter filter only rechecks current matches and
+ * keeps them visible until they were checked.
+ */
+static void
+test_more_strict (void)
+{
+  GtkStringList *list;
+  GtkFilterListModel *filtered;
+  GtkStringFilter *filter;
+  guint i, n_before;
+
+  list = gtk_string_list_new (NULL);
+  for (i = 0; i < 5000; i++)
+    {
+      char *s = g_strdup_printf ("%u", i);
+      gtk_string_list_append (list, s);
+      g_free (s);
+    }
+
+  filter = gtk_string_filter_new (gtk_property_expression_new (GTK_TYPE_STRING_OBJECT, NULL, "string"));
+  gtk_string_filter_set_search (filter, "1");
+  filtered = gtk_filter_list_model_new (G_LIST_MODEL (g_object_ref (list)), g_object_ref (GTK_FILTER (filter)));
+  gtk_filter_list_model_set_incremental (filtered, TRUE);
+
+  while (g_main_context_pending (NULL))
+    g_main_context_iteration (NULL, TRUE);
+  n_before = g_list_model_get_n_items (G_LIST_MODEL (filtered));
+  g_assert_cmpuint (n_before, ==, count_containing (list, "1"));
+
+  gtk_string_filter_set_search (filter, "12");
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (filtered)), ==, n_before);
+  g_assert_cmpuint (gtk_filter_list_model_get_pending (filtered), ==, n_before);
+
+  while (g_main_context_pending (NULL))
+    g_main_context_iteration (NULL, TRUE);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (filtered)), ==, count_containing (list, "12"));
+
+  g_object_unref (filtered);
+  g_object_unref (filter);
+  g_object_unref (list);
+}
+
+/* Test that filtering enough items to use threads gives
+ * the same result as filtering them one by one.
+ */
+static void
+test_parallel (void)
+{
+  GtkStringList *list;
+  GtkFilterListModel *filtered;
+  GtkStringFilter *filter;
+  const guint n_items = 100000;
+  guint i, n_expected;
+
+  list = gtk_string_list_new (NULL);
+  n_expected = 0;
+  for (i = 0; i < n_items; i++)
+    {
+      char *s = g_strdup_printf ("%u", i);
+      gtk_string_list_append (list, s);
+      if (strstr (s, "42"))
+        n_expected++;
+      g_free (s);
+    }
+
+  filter = gtk_string_filter_new (gtk_property_expression_new (GTK_TYPE_STRING_OBJECT, NULL, "string"));
+  gtk_string_filter_set_search (filter, "42");
+  filtered = gtk_filter_list_model_new (G_LIST_MODEL (list), GTK_FILTER (filter));
+
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (filtered)), ==, n_expected);
+  for (i = 0; i < n_expected; i++)
+    {
+      GtkStringObject *item = g_list_model_get_item (G_LIST_MODEL (filtered), i);
+      g_assert_nonnull (strstr (gtk_string_object_get_string (item), "42"));
+      g_object_unref (item);
+    }
+
+  g_object_unref (filtered);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -577,6 +673,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/filterlistmodel/empty", test_empty);
   g_test_add_func ("/filterlistmodel/add_remove_item", test_add_remove_item);
   g_test_add_func ("/filterlistmodel/sections", test_sections);
+  g_test_add_func ("/filterlistmodel/more_strict", test_more_strict);
+  g_test_add_func ("/filterlistmodel/parallel", test_parallel);
 
   return g_test_run ();
 }
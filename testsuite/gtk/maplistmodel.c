@@ -459,6 +459,37 @@ test_sections (void)
   g_object_unref (map);
 }
 
+static void
+test_batch (void)
+{
+  GtkMapListModel *map;
+  GListStore *store;
+
+  store = new_store (1, 5, 1);
+  map = new_model (G_LIST_MODEL (store));
+  assert_changes (map, "");
+
+  gtk_list_model_begin_batch (G_LIST_MODEL (map));
+  gtk_list_model_begin_batch (G_LIST_MODEL (map));
+  add (store, 6);
+  add (store, 7);
+  g_list_store_remove (store, 0);
+  assert_model (map, "4 6 8 10 12 14");
+  assert_changes (map, "");
+
+  gtk_list_model_end_batch (G_LIST_MODEL (map));
+  assert_changes (map, "");
+
+  gtk_list_model_end_batch (G_LIST_MODEL (map));
+  assert_changes (map, "0-5+6*");
+
+  g_list_store_remove (store, 0);
+  assert_changes (map, "-0*");
+
+  g_object_unref (store);
+  g_object_unref (map);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -476,6 +507,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/maplistmodel/remove_items", test_remove_items);
   g_test_add_func ("/maplistmodel/splice", test_splice);
   g_test_add_func ("/maplistmodel/sections", test_sections);
+  g_test_add_func ("/maplistmodel/batch", test_batch);
 
   return g_test_run ();
 }
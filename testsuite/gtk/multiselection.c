@@ -701,6 +701,20 @@ test_selection_filter (void)
   assert_model (filter, "2 3 4");
   assert_changes (filter, "");
 
+  ret = gtk_selection_model_select_item (selection, 4, FALSE);
+  g_assert_true (ret);
+  assert_selection (selection, "2 3 4 5");
+  assert_selection_changes (selection, "4:1");
+  assert_model (filter, "2 3 4 5");
+  assert_changes (filter, "+3*");
+
+  ret = gtk_selection_model_select_all (selection);
+  g_assert_true (ret);
+  assert_selection (selection, "1 2 3 4 5");
+  assert_selection_changes (selection, "0:1");
+  assert_model (filter, "1 2 3 4 5");
+  assert_changes (filter, "+0*");
+
   g_assert_true (g_list_model_get_item_type (G_LIST_MODEL (filter)) == G_TYPE_OBJECT);
   g_assert_true (gtk_selection_filter_model_get_model (filter) == selection);
 
@@ -0,0 +1,109 @@
+#include <gtk/gtk.h>
+
+#define N_COLUMNS 20
+#define N_ROWS 10
+#define SIZE 10
+#define SPACING 20
+
+static gboolean
+main_loop_quit_cb (gpointer data)
+{
+  gboolean *done = data;
+
+  *done = TRUE;
+
+  g_main_context_wakeup (NULL);
+
+  return FALSE;
+}
+
+static void
+wait (void)
+{
+  gboolean done = FALSE;
+
+  g_timeout_add (500, main_loop_quit_cb, &done);
+  while (!done)
+    g_main_context_iteration (NULL, FALSE);
+}
+
+static GtkWidget *
+add_child (GtkWidget *fixed,
+           double     x,
+           double     y,
+           int        width,
+           int        height)
+{
+  GtkWidget *child;
+
+  child = gtk_label_new (NULL);
+  gtk_widget_set_size_request (child, width, height);
+  gtk_fixed_put (GTK_FIXED (fixed), child, x, y);
+
+  return child;
+}
+
+/* Enough children for the container to use a pick index */
+static void
+test_pick_many_children (void)
+{
+  GtkWidget *window, *fixed, *top, *moved;
+  GtkWidget *children[N_ROWS][N_COLUMNS];
+  int row, column;
+
+  window = gtk_window_new ();
+  fixed = gtk_fixed_new ();
+  gtk_window_set_child (GTK_WINDOW (window), fixed);
+
+  for (row = 0; row < N_ROWS; row++)
+    for (column = 0; column < N_COLUMNS; column++)
+      children[row][column] = add_child (fixed, column * SPACING, row * SPACING, SIZE, SIZE);
+
+  /* Covers the first two children, and is stacked above them */
+  top = add_child (fixed, 0, 0, SPACING + SIZE, SIZE);
+
+  gtk_widget_set_visible (window, TRUE);
+  wait ();
+
+  for (row = 0; row < N_ROWS; row++)
+    for (column = 0; column < N_COLUMNS; column++)
+      {
+        double x = column * SPACING + SIZE / 2;
+        double y = row * SPACING + SIZE / 2;
+
+        if (row == 0 && column < 2)
+          g_assert_true (gtk_widget_pick (fixed, x, y, GTK_PICK_DEFAULT) == top);
+        else
+          g_assert_true (gtk_widget_pick (fixed, x, y, GTK_PICK_DEFAULT) == children[row][column]);
+
+        /* Between the children */
+        g_assert_true (gtk_widget_pick (fixed, x + SIZE, y + SIZE, GTK_PICK_DEFAULT) == fixed);
+      }
+
+  /* Moving a child must update the index */
+  moved = children[N_ROWS - 1][N_COLUMNS - 1];
+  gtk_fixed_move (GTK_FIXED (fixed), moved, 5 * SPACING + SIZE, 5 * SPACING + SIZE);
+  wait ();
+
+  g_assert_true (gtk_widget_pick (fixed, 5 * SPACING + SIZE + SIZE / 2, 5 * SPACING + SIZE + SIZE / 2, GTK_PICK_DEFAULT) == moved);
+  g_assert_true (gtk_widget_pick (fixed,
+                                  (N_COLUMNS - 1) * SPACING + SIZE / 2,
+                                  (N_ROWS - 1) * SPACING + SIZE / 2,
+                                  GTK_PICK_DEFAULT) == fixed);
+
+  /* As must removing one */
+  gtk_fixed_remove (GTK_FIXED (fixed), top);
+  g_assert_true (gtk_widget_pick (fixed, SIZE / 2, SIZE / 2, GTK_PICK_DEFAULT) == children[0][0]);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/pick/many-children", test_pick_many_children);
+
+  return g_test_run ();
+}
@@ -0,0 +1,107 @@
+#include <gtk/gtk.h>
+
+typedef struct {
+  GskRenderNode *node;
+  guint64 node_version;
+  guint n_recorded;
+} Cache;
+
+static GskRenderNode *
+snapshot_cached (Cache   *cache,
+                 guint64  version,
+                 float    offset)
+{
+  GtkSnapshot *snapshot;
+
+  snapshot = gtk_snapshot_new ();
+  gtk_snapshot_translate (snapshot, &GRAPHENE_POINT_INIT (offset, 0));
+
+  if (gtk_snapshot_push_cached (snapshot, &cache->node, &cache->node_version, version))
+    {
+      cache->n_recorded++;
+      gtk_snapshot_append_color (snapshot,
+                                 &(GdkRGBA) { 1, 0, 0, 1 },
+                                 &GRAPHENE_RECT_INIT (0, 0, 10, 10));
+      gtk_snapshot_append_color (snapshot,
+                                 &(GdkRGBA) { 0, 0, 1, 1 },
+                                 &GRAPHENE_RECT_INIT (10, 0, 10, 10));
+      gtk_snapshot_pop (snapshot);
+    }
+
+  return gtk_snapshot_free_to_node (snapshot);
+}
+
+static void
+test_cached (void)
+{
+  Cache cache = { NULL, };
+  GskRenderNode *node;
+  graphene_rect_t bounds;
+
+  node = snapshot_cached (&cache, 1, 0);
+  g_assert_cmpuint (cache.n_recorded, ==, 1);
+  g_assert_nonnull (cache.node);
+  g_assert_cmpuint (cache.node_version, ==, 1);
+  g_assert_cmpint (gsk_render_node_get_node_type (cache.node), ==, GSK_CONTAINER_NODE);
+  gsk_render_node_get_bounds (node, &bounds);
+  g_assert_cmpfloat (bounds.origin.x, ==, 0);
+  gsk_render_node_unref (node);
+
+  /* Only the offset changed, so the content is reused */
+  node = snapshot_cached (&cache, 1, 25);
+  g_assert_cmpuint (cache.n_recorded, ==, 1);
+  g_assert_cmpint (gsk_render_node_get_node_type (node), ==, GSK_TRANSFORM_NODE);
+  gsk_render_node_get_bounds (node, &bounds);
+  g_assert_cmpfloat (bounds.origin.x, ==, 25);
+  g_assert_cmpfloat (bounds.size.width, ==, 20);
+  gsk_render_node_unref (node);
+
+  /* A new version records the content again */
+  node = snapshot_cached (&cache, 2, 25);
+  g_assert_cmpuint (cache.n_recorded, ==, 2);
+  g_assert_cmpuint (cache.node_version, ==, 2);
+  gsk_render_node_get_bounds (cache.node, &bounds);
+  g_assert_cmpfloat (bounds.origin.x, ==, 0);
+  gsk_render_node_unref (node);
+
+  g_clear_pointer (&cache.node, gsk_render_node_unref);
+}
+
+static void
+test_trivial_pushes (void)
+{
+  GtkSnapshot *snapshot;
+  GskRenderNode *node;
+
+  snapshot = gtk_snapshot_new ();
+  gtk_snapshot_push_opacity (snapshot, 1.0);
+  gtk_snapshot_push_blur (snapshot, 0.0);
+  gtk_snapshot_append_color (snapshot,
+                             &(GdkRGBA) { 1, 0, 0, 1 },
+                             &GRAPHENE_RECT_INIT (0, 0, 10, 10));
+  gtk_snapshot_pop (snapshot);
+  gtk_snapshot_pop (snapshot);
+  node = gtk_snapshot_free_to_node (snapshot);
+  g_assert_cmpint (gsk_render_node_get_node_type (node), ==, GSK_COLOR_NODE);
+  gsk_render_node_unref (node);
+
+  snapshot = gtk_snapshot_new ();
+  gtk_snapshot_push_clip (snapshot, &GRAPHENE_RECT_INIT (0, 0, 0, 10));
+  gtk_snapshot_append_color (snapshot,
+                             &(GdkRGBA) { 1, 0, 0, 1 },
+                             &GRAPHENE_RECT_INIT (0, 0, 10, 10));
+  gtk_snapshot_pop (snapshot);
+  node = gtk_snapshot_free_to_node (snapshot);
+  g_assert_null (node);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/snapshot/cached", test_cached);
+  g_test_add_func ("/snapshot/trivial-pushes", test_trivial_pushes);
+
+  return g_test_run ();
+}
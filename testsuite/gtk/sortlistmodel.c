@@ -590,6 +590,139 @@ test_incremental_remove (void)
   g_object_unref (removed);
 }
 
+static guint
+get_number (GObject *object)
+{
+  return GPOINTER_TO_UINT (g_object_get_qdata (object, number_quark));
+}
+
+/* Test that sorting a large list with sort keys that can be
+ * compared in threads gives the right result.
+ */
+static void
+test_parallel (void)
+{
+  GListStore *store;
+  GtkSortListModel *model;
+  GtkSorter *sorter;
+  guint i;
+  const guint n_items = 200000;
+
+  store = new_shuffled_store (n_items);
+  model = new_model (store);
+
+  sorter = GTK_SORTER (gtk_numeric_sorter_new (gtk_cclosure_expression_new (G_TYPE_UINT,
+                                                                            NULL,
+                                                                            0, NULL,
+                                                                            G_CALLBACK (get_number),
+                                                                            NULL, NULL)));
+  gtk_sort_list_model_set_sorter (model, sorter);
+  g_object_unref (sorter);
+
+  g_assert_cmpuint (gtk_sort_list_model_get_pending (model), ==, 0);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (model)), ==, n_items);
+
+  for (i = 0; i < n_items; i++)
+    g_assert_cmpuint (i + 1, ==, get (G_LIST_MODEL (model), i));
+
+  ignore_changes (model);
+
+  g_object_unref (store);
+  g_object_unref (model);
+}
+
+static guint
+get_last_digit (GObject *object)
+{
+  return GPOINTER_TO_UINT (g_object_get_qdata (object, number_quark)) % 10;
+}
+
+/* Test radix sorting large lists, with sort keys whose prefix
+ * decides the order completely and with ones where it doesn't.
+ */
+static void
+test_radix (void)
+{
+  GListStore *store;
+  GtkSortListModel *model;
+  GtkMultiSorter *sorter;
+  GtkNumericSorter *numeric;
+  guint i, last, number;
+  const guint n_items = 20000;
+
+  store = new_shuffled_store (n_items);
+  model = new_model (store);
+
+  numeric = gtk_numeric_sorter_new (gtk_cclosure_expression_new (G_TYPE_UINT,
+                                                                 NULL,
+                                                                 0, NULL,
+                                                                 G_CALLBACK (get_number),
+                                                                 NULL, NULL));
+  gtk_numeric_sorter_set_sort_order (numeric, GTK_SORT_DESCENDING);
+  gtk_sort_list_model_set_sorter (model, GTK_SORTER (numeric));
+
+  for (i = 0; i < n_items; i++)
+    g_assert_cmpuint (n_items - i, ==, get (G_LIST_MODEL (model), i));
+
+  sorter = gtk_multi_sorter_new ();
+  gtk_multi_sorter_append (sorter, GTK_SORTER (gtk_numeric_sorter_new (gtk_cclosure_expression_new (G_TYPE_UINT,
+                                                                                                      NULL,
+                                                                                                      0, NULL,
+                                                                                                      G_CALLBACK (get_last_digit),
+                                                                                                      NULL, NULL))));
+  gtk_multi_sorter_append (sorter, GTK_SORTER (numeric));
+  gtk_sort_list_model_set_sorter (model, GTK_SORTER (sorter));
+  g_object_unref (sorter);
+
+  last = G_MAXUINT;
+  for (i = 0; i < n_items; i++)
+    {
+      number = get (G_LIST_MODEL (model), i);
+      if (i % (n_items / 10) == 0)
+        g_assert_cmpuint (number % 10, ==, i / (n_items / 10));
+      else
+        g_assert_cmpuint (number, ==, last - 10);
+      last = number;
+    }
+
+  ignore_changes (model);
+
+  g_object_unref (store);
+  g_object_unref (model);
+}
+
+static void
+test_resort_items (void)
+{
+  GtkSortListModel *sort;
+  GListStore *store;
+  GObject *item;
+
+  store = new_store ((guint[]) { 4, 8, 2, 6, 10, 0 });
+  sort = new_model (store);
+  assert_model (sort, "2 4 6 8 10");
+  assert_changes (sort, "");
+
+  item = g_list_model_get_item (G_LIST_MODEL (store), 0);
+  g_object_set_qdata (item, number_quark, GUINT_TO_POINTER (9));
+  gtk_sort_list_model_resort_items (sort, 0, 1);
+  assert_model (sort, "2 6 8 9 10");
+  assert_changes (sort, "1-3+3");
+
+  /* the item is already in place */
+  gtk_sort_list_model_resort_items (sort, 0, 1);
+  assert_changes (sort, "");
+
+  g_object_set_qdata (item, number_quark, GUINT_TO_POINTER (1));
+  gtk_sort_list_model_resort_items (sort, 0, 1);
+  assert_model (sort, "1 2 6 8 10");
+  assert_changes (sort, "0-4+4");
+
+  g_object_unref (item);
+  g_object_unref (store);
+  g_object_unref (sort);
+}
+
 static void
 test_out_of_bounds_access (void)
 {
@@ -726,6 +859,9 @@ main (int argc, char *argv[])
   g_test_add_func ("/sortlistmodel/remove_items", test_remove_items);
   g_test_add_func ("/sortlistmodel/stability", test_stability);
   g_test_add_func ("/sortlistmodel/incremental/remove", test_incremental_remove);
+  g_test_add_func ("/sortlistmodel/parallel", test_parallel);
+  g_test_add_func ("/sortlistmodel/radix", test_radix);
+  g_test_add_func ("/sortlistmodel/resort-items", test_resort_items);
   g_test_add_func ("/sortlistmodel/oob-access", test_out_of_bounds_access);
   g_test_add_func ("/sortlistmodel/add-remove-item", test_add_remove_item);
   g_test_add_func ("/sortlistmodel/sections", test_sections);
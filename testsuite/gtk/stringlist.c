@@ -261,6 +261,28 @@ test_take (void)
   g_object_unref (list);
 }
 
+static void
+test_item_identity (void)
+{
+  GtkStringList *list;
+  GObject *item1, *item2;
+
+  list = new_model ((const char *[]){ "a", "b", "c", NULL });
+
+  g_assert_cmpstr (gtk_string_list_get_string (list, 1), ==, "b");
+
+  item1 = g_list_model_get_item (G_LIST_MODEL (list), 1);
+  item2 = g_list_model_get_item (G_LIST_MODEL (list), 1);
+  g_assert_true (item1 == item2);
+  g_assert_cmpstr (gtk_string_object_get_string (GTK_STRING_OBJECT (item1)), ==, "b");
+  g_assert_cmpstr (gtk_string_list_get_string (list, 1), ==, "b");
+
+  g_object_unref (item1);
+  g_object_unref (item2);
+
+  g_object_unref (list);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -277,6 +299,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/stringlist/splice", test_splice);
   g_test_add_func ("/stringlist/add_remove", test_add_remove);
   g_test_add_func ("/stringlist/take", test_take);
+  g_test_add_func ("/stringlist/item_identity", test_item_identity);
 
   return g_test_run ();
 }
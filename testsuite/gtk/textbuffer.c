@@ -1950,6 +1950,211 @@ test_serialize_wrap_mode (void)
   g_assert_finalize_object (buffer);
 }
 
+static void
+test_get_bytes (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextIter start, end;
+  GBytes *bytes, *bytes2;
+  char *slice;
+
+  buffer = gtk_text_buffer_new (NULL);
+
+  bytes = gtk_text_buffer_get_bytes (buffer);
+  g_assert_cmpuint (g_bytes_get_size (bytes), ==, 0);
+  g_bytes_unref (bytes);
+
+  gtk_text_buffer_set_text (buffer, "Hello\nWorld\n\nfoo", -1);
+  gtk_text_buffer_get_iter_at_offset (buffer, &start, 3);
+  gtk_text_buffer_create_child_anchor (buffer, &start);
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  slice = gtk_text_buffer_get_slice (buffer, &start, &end, TRUE);
+
+  bytes = gtk_text_buffer_get_bytes (buffer);
+  g_assert_cmpmem (g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes), slice, strlen (slice));
+
+  /* Unchanged buffers return the same snapshot */
+  bytes2 = gtk_text_buffer_get_bytes (buffer);
+  g_assert_true (bytes == bytes2);
+  g_bytes_unref (bytes2);
+
+  gtk_text_buffer_insert (buffer, &end, "bar", -1);
+  bytes2 = gtk_text_buffer_get_bytes (buffer);
+  g_assert_false (bytes == bytes2);
+  g_assert_cmpuint (g_bytes_get_size (bytes2), ==, g_bytes_get_size (bytes) + 3);
+  /* The old snapshot is untouched */
+  g_assert_cmpmem (g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes), slice, strlen (slice));
+
+  g_bytes_unref (bytes2);
+  g_bytes_unref (bytes);
+  g_free (slice);
+  g_assert_finalize_object (buffer);
+}
+
+static void
+test_set_bytes (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextIter start, end;
+  GBytes *bytes;
+  char *text;
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_text (buffer, "old contents", -1);
+
+  /* Not nul-terminated */
+  bytes = g_bytes_new_static ("Hello\r\nWörld\nand more", 13);
+  gtk_text_buffer_set_bytes (buffer, bytes);
+  g_bytes_unref (bytes);
+
+  g_assert_cmpint (gtk_text_buffer_get_line_count (buffer), ==, 2);
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  text = gtk_text_buffer_get_text (buffer, &start, &end, TRUE);
+  g_assert_cmpstr (text, ==, "Hello\r\nWörld");
+  g_free (text);
+
+  g_assert_false (gtk_text_buffer_get_can_undo (buffer));
+
+  /* End iters of inserts are computed without walking the text */
+  gtk_text_buffer_get_iter_at_line_offset (buffer, &start, 1, 1);
+  gtk_text_buffer_insert (buffer, &start, "x\ny\nz", -1);
+  g_assert_cmpint (gtk_text_iter_get_line (&start), ==, 3);
+  g_assert_cmpint (gtk_text_iter_get_line_offset (&start), ==, 1);
+  g_assert_cmpint (gtk_text_iter_get_offset (&start), ==, 13);
+  gtk_text_buffer_insert (buffer, &start, "a\n", -1);
+  g_assert_cmpint (gtk_text_iter_get_line (&start), ==, 4);
+  g_assert_cmpint (gtk_text_iter_get_line_offset (&start), ==, 0);
+  g_assert_cmpint (gtk_text_iter_get_char (&start), ==, 0xf6);
+
+  g_assert_finalize_object (buffer);
+}
+
+static void
+test_tag_runs (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextTag *tag;
+  GtkTextIter iter;
+  const int runs[] = { 0, 2, 4, 6, 8, 100 };
+  const int removed[] = { 1, 5 };
+  const gboolean expected[] = { TRUE, FALSE, FALSE, FALSE, FALSE, TRUE, FALSE, FALSE, TRUE, TRUE };
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_text (buffer, "0123456789", -1);
+  tag = gtk_text_buffer_create_tag (buffer, NULL, "weight", PANGO_WEIGHT_BOLD, NULL);
+
+  gtk_text_buffer_apply_tag_runs (buffer, tag, runs, G_N_ELEMENTS (runs));
+  gtk_text_buffer_remove_tag_runs (buffer, tag, removed, G_N_ELEMENTS (removed));
+
+  for (int i = 0; i < G_N_ELEMENTS (expected); i++)
+    {
+      gtk_text_buffer_get_iter_at_offset (buffer, &iter, i);
+      g_assert_true (gtk_text_iter_has_tag (&iter, tag) == expected[i]);
+    }
+
+  g_assert_finalize_object (buffer);
+}
+
+/* Large enough to be transferred in several chunks, with a \r\n and
+ * a multibyte character across chunk boundaries.
+ */
+static char *
+make_large_text (void)
+{
+  GString *text = g_string_new (NULL);
+
+  while (text->len < 65535)
+    g_string_append_c (text, 'a' + text->len % 26);
+  g_string_append (text, "\r\n");
+  while (text->len < 131071)
+    g_string_append_c (text, 'a' + text->len % 26);
+  g_string_append (text, "\xe2\x82\xac\n");
+  while (text->len < 200000)
+    g_string_append (text, "line\n");
+
+  return g_string_free (text, FALSE);
+}
+
+static void
+large_text_done (GObject      *source,
+                 GAsyncResult *result,
+                 gpointer      data)
+{
+  GAsyncResult **out = data;
+
+  *out = g_object_ref (result);
+  g_main_context_wakeup (NULL);
+}
+
+static void
+test_large_text_plain (void)
+{
+  GtkTextBuffer *buffer, *copy;
+  GtkTextIter start, end, iter;
+  GOutputStream *ostream;
+  GInputStream *istream;
+  GAsyncResult *result;
+  GError *error = NULL;
+  GValue value = G_VALUE_INIT;
+  char *text;
+
+  text = make_large_text ();
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_text (buffer, text, -1);
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  gtk_text_buffer_select_range (buffer, &start, &end);
+
+  /* Copying between buffers */
+  copy = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_get_start_iter (copy, &iter);
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  gtk_text_buffer_insert_range (copy, &iter, &start, &end);
+  check_buffer_contents (copy, text);
+  g_assert_cmpint (gtk_text_buffer_get_line_count (copy), ==, gtk_text_buffer_get_line_count (buffer));
+  g_object_unref (copy);
+
+  /* Serializing */
+  g_value_init (&value, GTK_TYPE_TEXT_BUFFER);
+  g_value_set_object (&value, buffer);
+  ostream = g_memory_output_stream_new_resizable ();
+  result = NULL;
+  gdk_content_serialize_async (ostream, "text/plain;charset=utf-8", &value,
+                               G_PRIORITY_DEFAULT, NULL,
+                               large_text_done, &result);
+  while (result == NULL)
+    g_main_context_iteration (NULL, TRUE);
+  g_assert_true (gdk_content_serialize_finish (result, &error));
+  g_assert_no_error (error);
+  g_clear_object (&result);
+  g_value_unset (&value);
+
+  g_assert_cmpuint (g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (ostream)), ==, strlen (text));
+  g_assert_true (memcmp (g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (ostream)), text, strlen (text)) == 0);
+
+  /* Deserializing */
+  istream = g_memory_input_stream_new_from_data (g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (ostream)),
+                                                 g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (ostream)),
+                                                 NULL);
+  gdk_content_deserialize_async (istream, "text/plain;charset=utf-8", GTK_TYPE_TEXT_BUFFER,
+                                 G_PRIORITY_DEFAULT, NULL,
+                                 large_text_done, &result);
+  while (result == NULL)
+    g_main_context_iteration (NULL, TRUE);
+  g_assert_true (gdk_content_deserialize_finish (result, &value, &error));
+  g_assert_no_error (error);
+  g_clear_object (&result);
+
+  copy = g_value_get_object (&value);
+  check_buffer_contents (copy, text);
+  g_assert_cmpint (gtk_text_buffer_get_line_count (copy), ==, gtk_text_buffer_get_line_count (buffer));
+
+  g_value_unset (&value);
+  g_object_unref (istream);
+  g_object_unref (ostream);
+  g_object_unref (buffer);
+  g_free (text);
+}
+
 int
 main (int argc, char** argv)
 {
@@ -1978,6 +2183,10 @@ main (int argc, char** argv)
   g_test_add_func ("/TextBuffer/Undo 4", test_undo4);
   g_test_add_func ("/TextBuffer/Undo 5", test_undo5);
   g_test_add_func ("/TextBuffer/Serialize wrap-mode", test_serialize_wrap_mode);
+  g_test_add_func ("/TextBuffer/Get bytes", test_get_bytes);
+  g_test_add_func ("/TextBuffer/Set bytes", test_set_bytes);
+  g_test_add_func ("/TextBuffer/Tag runs", test_tag_runs);
+  g_test_add_func ("/TextBuffer/Large text", test_large_text_plain);
 
   return g_test_run();
 }
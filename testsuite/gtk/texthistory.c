@@ -664,6 +664,35 @@ test_issue_5777 (void)
   run_test (commands, G_N_ELEMENTS (commands), 4);
 }
 
+static void
+test_max_undo_bytes (void)
+{
+  Text *text = text_new ();
+  char *chunk = g_strnfill (4096, 'x');
+
+  gtk_text_history_set_max_undo_bytes (text->history, 4096 * 7 / 2);
+
+  for (guint i = 0; i < 10; i++)
+    {
+      Command cmd = { INSERT, i * 4096, -1, chunk, NULL };
+      command_insert (&cmd, text);
+    }
+
+  g_assert_cmpuint (gtk_text_history_get_n_bytes (text->history), <=, 4096 * 7 / 2);
+
+  for (guint i = 0; i < 3; i++)
+    {
+      g_assert_true (text->can_undo);
+      gtk_text_history_undo (text->history);
+    }
+
+  g_assert_false (text->can_undo);
+  g_assert_cmpuint (text->buf->len, ==, 7 * 4096);
+
+  g_free (chunk);
+  text_free (text);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -687,6 +716,7 @@ main (int   argc,
   g_test_add_func ("/Gtk/TextHistory/issue_4276", test_issue_4276);
   g_test_add_func ("/Gtk/TextHistory/issue_4575", test_issue_4575);
   g_test_add_func ("/Gtk/TextHistory/issue_5777", test_issue_5777);
+  g_test_add_func ("/Gtk/TextHistory/max_undo_bytes", test_max_undo_bytes);
 
   return g_test_run ();
 }
@@ -339,6 +339,35 @@ test_expand (void)
   g_object_unref (tree);
 }
 
+static void
+test_incremental (void)
+{
+  GtkTreeListModel *tree = new_model (100, FALSE);
+  GtkTreeListRow *row;
+  GString *changes;
+
+  gtk_tree_list_model_set_incremental (tree, TRUE);
+  gtk_tree_list_model_set_autoexpand (tree, TRUE);
+  assert_model (tree, "100");
+
+  /* the expanded row gets its children right away, they get expanded later */
+  row = gtk_tree_list_model_get_row (tree, 0);
+  gtk_tree_list_row_set_expanded (row, TRUE);
+  g_object_unref (row);
+  assert_model (tree, "100 100 90 80 70 60 50 40 30 20 10");
+  assert_changes (tree, "1+10*");
+  g_assert_cmpuint (gtk_tree_list_model_get_pending (tree), ==, 10);
+
+  while (gtk_tree_list_model_get_pending (tree) > 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  assert_model (tree, "100 100 100 99 98 97 96 95 94 93 92 91 90 90 89 88 87 86 85 84 83 82 81 80 80 79 78 77 76 75 74 73 72 71 70 70 69 68 67 66 65 64 63 62 61 60 60 59 58 57 56 55 54 53 52 51 50 50 49 48 47 46 45 44 43 42 41 40 40 39 38 37 36 35 34 33 32 31 30 30 29 28 27 26 25 24 23 22 21 20 20 19 18 17 16 15 14 13 12 11 10 10 9 8 7 6 5 4 3 2 1");
+  changes = g_object_get_qdata (G_OBJECT (tree), changes_quark);
+  g_string_set_size (changes, 0);
+
+  g_object_unref (tree);
+}
+
 static void
 test_remove_some (void)
 {
@@ -623,6 +652,7 @@ main (int argc, char *argv[])
   changes_quark = g_quark_from_static_string ("What did I see? Can I believe what I saw?");
 
   g_test_add_func ("/treelistmodel/expand", test_expand);
+  g_test_add_func ("/treelistmodel/incremental", test_incremental);
   g_test_add_func ("/treelistmodel/remove_some", test_remove_some);
   g_test_add_func ("/treelistmodel/remove_splice", test_splice);
   g_test_add_func ("/treelistmodel/collapse-change", test_collapse_change);
@@ -39,6 +39,7 @@ quit_when_idle (gpointer loop)
 }
 
 static GMainLoop *loop;
+static double scale = 1.0;
 
 static void
 draw_paintable (GdkPaintable *paintable,
@@ -85,7 +86,18 @@ draw_paintable (GdkPaintable *paintable,
                        ),
                        &bounds);
 
-  texture = gsk_renderer_render_texture (renderer, node, &bounds);
+  if (scale != 1.0)
+    {
+      GskRenderNode *scaled;
+
+      scaled = gsk_transform_node_new (node, gsk_transform_scale (NULL, scale, scale));
+      graphene_rect_scale (&bounds, scale, scale, &bounds);
+      texture = gsk_renderer_render_texture (renderer, scaled, &bounds);
+      gsk_render_node_unref (scaled);
+    }
+  else
+    texture = gsk_renderer_render_texture (renderer, node, &bounds);
+
   g_object_set_data_full (G_OBJECT (texture),
                           "source-render-node",
                           node,
@@ -164,10 +176,22 @@ get_save_filename (const char *filename,
   return result;
 }
 
+static void
+load_css (const char *cssfile)
+{
+  GtkCssProvider *provider;
+
+  provider = gtk_css_provider_new ();
+  gtk_css_provider_load_from_path (provider, cssfile);
+
+  gtk_style_context_add_provider_for_display (gdk_display_get_default (),
+                                              GTK_STYLE_PROVIDER (provider),
+                                              GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+}
+
 static void
 screenshot_file (const char *filename,
                  const char *id,
-                 const char *cssfile,
                  const char *save_file,
                  gboolean    as_node,
                  gboolean    force)
@@ -182,18 +206,6 @@ screenshot_file (const char *filename,
   char *save_to;
   GBytes *bytes;
 
-  if (cssfile)
-    {
-      GtkCssProvider *provider;
-
-      provider = gtk_css_provider_new ();
-      gtk_css_provider_load_from_path (provider, cssfile);
-
-      gtk_style_context_add_provider_for_display (gdk_display_get_default (),
-                                                  GTK_STYLE_PROVIDER (provider),
-                                                  GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
-    }
-
   builder = gtk_builder_new ();
   if (!gtk_builder_add_from_file (builder, filename, &error))
     {
@@ -343,6 +355,8 @@ screenshot_file (const char *filename,
     g_free (save_to);
 
   g_object_unref (texture);
+
+  gtk_window_destroy (GTK_WINDOW (window));
 }
 
 void
@@ -353,6 +367,7 @@ do_screenshot (int          *argc,
   char *id = NULL;
   char *css = NULL;
   char **filenames = NULL;
+  char *output_dir = NULL;
   gboolean as_node = FALSE;
   gboolean force = FALSE;
   const GOptionEntry entries[] = {
@@ -360,6 +375,8 @@ do_screenshot (int          *argc,
     { "css", 0, 0, G_OPTION_ARG_FILENAME, &css, N_("Use style from CSS file"), N_("FILE") },
     { "node", 0, 0, G_OPTION_ARG_NONE, &as_node, N_("Save as node file instead of png"), NULL },
     { "force", 0, 0, G_OPTION_ARG_NONE, &force, N_("Overwrite existing file"), NULL },
+    { "scale", 0, 0, G_OPTION_ARG_DOUBLE, &scale, N_("Scale the image by this factor"), N_("FACTOR") },
+    { "output-dir", 0, 0, G_OPTION_ARG_FILENAME, &output_dir, N_("Render every FILE into this directory"), N_("DIR") },
     { G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &filenames, NULL, N_("FILE…") },
     { NULL, }
   };
@@ -392,15 +409,46 @@ do_screenshot (int          *argc,
       exit (1);
     }
 
-  if (g_strv_length (filenames) > 2)
+  if (scale <= 0)
+    {
+      g_printerr (_("Scale must be positive\n"));
+      exit (1);
+    }
+
+  if (output_dir == NULL && g_strv_length (filenames) > 2)
     {
       g_printerr (_("Can only render a single .ui file to a single output file\n"));
       exit (1);
     }
 
-  screenshot_file (filenames[0], id, css, filenames[1], as_node, force);
+  if (css)
+    load_css (css);
+
+  if (output_dir)
+    {
+      /* Render all files with the same display connection,
+       * avoiding the startup cost for every file
+       */
+      for (guint i = 0; filenames[i]; i++)
+        {
+          char *basename, *save_name, *save_to;
+
+          basename = g_path_get_basename (filenames[i]);
+          save_name = get_save_filename (basename, as_node);
+          save_to = g_build_filename (output_dir, save_name, NULL);
+
+          screenshot_file (filenames[i], id, save_to, as_node, force);
+
+          g_free (save_to);
+          g_free (save_name);
+          g_free (basename);
+        }
+    }
+  else
+    screenshot_file (filenames[0], id, filenames[1], as_node, force);
 
   g_strfreev (filenames);
+  g_free (output_dir);
   g_free (id);
   g_free (css);
 }
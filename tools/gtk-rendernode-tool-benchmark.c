@@ -29,14 +29,100 @@
 #include <gtk/gtk.h>
 #include "gtk-rendernode-tool.h"
 
+typedef enum {
+  TIMING_RENDER,
+  TIMING_DOWNLOAD,
+  TIMING_TOTAL,
+  N_TIMINGS
+} Timing;
+
+static const char *timing_names[N_TIMINGS] = { "render", "download", "total" };
+
+typedef struct {
+  double min;
+  double mean;
+  double p50;
+  double p95;
+  double p99;
+  double max;
+} Statistics;
+
+static int
+compare_double (gconstpointer a,
+                gconstpointer b)
+{
+  double da = *(const double *) a;
+  double db = *(const double *) b;
+
+  return da < db ? -1 : (da > db ? 1 : 0);
+}
+
+/* nearest-rank percentile of a sorted array */
+static double
+percentile (const double *values,
+            guint         n_values,
+            guint         percent)
+{
+  guint rank = (percent * n_values + 99) / 100;
+
+  return values[CLAMP (rank, 1, n_values) - 1];
+}
+
 static void
+compute_statistics (double     *values,
+                    guint       n_values,
+                    Statistics *stats)
+{
+  guint i;
+
+  qsort (values, n_values, sizeof (double), compare_double);
+
+  stats->mean = 0;
+  for (i = 0; i < n_values; i++)
+    stats->mean += values[i];
+  stats->mean /= n_values;
+
+  stats->min = values[0];
+  stats->p50 = percentile (values, n_values, 50);
+  stats->p95 = percentile (values, n_values, 95);
+  stats->p99 = percentile (values, n_values, 99);
+  stats->max = values[n_values - 1];
+}
+
+static void
+add_statistics (GVariantBuilder  *builder,
+                const char       *prefix,
+                const Statistics *stats)
+{
+  char *key;
+
+#define ADD(name) \
+  key = g_strconcat (prefix, "-" #name, NULL); \
+  g_variant_builder_add (builder, "{sd}", key, stats->name); \
+  g_free (key);
+
+  ADD (min);
+  ADD (mean);
+  ADD (p50);
+  ADD (p95);
+  ADD (p99);
+  ADD (max);
+
+#undef ADD
+}
+
+/* Returns the results as a{sd}, with all times in milliseconds */
+static GVariant *
 benchmark_node (GskRenderNode *node,
                 const char    *renderer_name,
+                guint          warmup,
                 guint          runs,
                 gboolean       download)
 {
   GError *error = NULL;
   GskRenderer *renderer;
+  GVariantBuilder builder;
+  double *timings[N_TIMINGS];
   guint i;
 
   renderer = create_renderer (renderer_name, &error);
@@ -44,17 +130,24 @@ benchmark_node (GskRenderNode *node,
     {
       g_printerr ("Could not benchmark renderer \"%s\": %s\n", renderer_name, error->message);
       g_clear_error (&error);
-      return;
+      return NULL;
     }
 
-  for (i = 0; i < runs; i++)
+  for (i = 0; i < N_TIMINGS; i++)
+    timings[i] = g_new (double, runs);
+
+  for (i = 0; i < warmup + runs; i++)
     {
       GdkTexture *texture;
-      gint64 start_time, end_time, duration;
+      gint64 start_time, render_time, end_time;
 
       start_time = g_get_monotonic_time ();
 
       texture = gsk_renderer_render_texture (renderer, node, NULL);
+
+      render_time = g_get_monotonic_time ();
+
+      /* Downloading waits for the GPU to finish executing the commands */
       if (download)
         {
           GdkTextureDownloader *downloader;
@@ -69,16 +162,178 @@ benchmark_node (GskRenderNode *node,
 
       end_time = g_get_monotonic_time ();
 
-      duration = end_time - start_time;
-      g_print ("%s\t%lld.%03ds\n",
-               renderer_name,
-               (long long) duration / G_USEC_PER_SEC,
-               (int) ((duration * 1000 / G_USEC_PER_SEC) % 1000)); 
       g_object_unref (texture);
+
+      if (i < warmup)
+        continue;
+
+      timings[TIMING_RENDER][i - warmup] = (double) (render_time - start_time) / 1000.0;
+      timings[TIMING_DOWNLOAD][i - warmup] = (double) (end_time - render_time) / 1000.0;
+      timings[TIMING_TOTAL][i - warmup] = (double) (end_time - start_time) / 1000.0;
     }
 
   gsk_renderer_unrealize (renderer);
   g_object_unref (renderer);
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sd}"));
+  g_variant_builder_add (&builder, "{sd}", "runs", (double) runs);
+
+  for (i = 0; i < N_TIMINGS; i++)
+    {
+      Statistics stats;
+
+      compute_statistics (timings[i], runs, &stats);
+      add_statistics (&builder, timing_names[i], &stats);
+      g_free (timings[i]);
+    }
+
+  return g_variant_builder_end (&builder);
+}
+
+static double
+lookup_result (GVariant   *results,
+               const char *timing,
+               const char *statistic)
+{
+  char *key;
+  double value;
+
+  key = g_strconcat (timing, "-", statistic, NULL);
+  if (!g_variant_lookup (results, key, "d", &value))
+    value = 0;
+  g_free (key);
+
+  return value;
+}
+
+static void
+print_results (const char *renderer_name,
+               GVariant   *results)
+{
+  guint i;
+
+  g_print ("%s\n", renderer_name);
+  for (i = 0; i < N_TIMINGS; i++)
+    {
+      g_print ("  %-8s  min %8.3fms  p50 %8.3fms  p95 %8.3fms  p99 %8.3fms  max %8.3fms\n",
+               timing_names[i],
+               lookup_result (results, timing_names[i], "min"),
+               lookup_result (results, timing_names[i], "p50"),
+               lookup_result (results, timing_names[i], "p95"),
+               lookup_result (results, timing_names[i], "p99"),
+               lookup_result (results, timing_names[i], "max"));
+    }
+}
+
+/* The JSON we write only uses objects, strings and numbers,
+ * which means it can be parsed as GVariant text format, too.
+ */
+static void
+print_json (GVariant *all_results)
+{
+  GVariantIter renderer_iter;
+  GVariant *results;
+  const char *renderer_name;
+  gboolean first_renderer = TRUE;
+
+  g_print ("{\n");
+  g_variant_iter_init (&renderer_iter, all_results);
+  while (g_variant_iter_loop (&renderer_iter, "{&s@a{sd}}", &renderer_name, &results))
+    {
+      GVariantIter iter;
+      const char *key;
+      double value;
+      gboolean first = TRUE;
+
+      g_print ("%s  \"%s\": {\n", first_renderer ? "" : ",\n", renderer_name);
+      first_renderer = FALSE;
+
+      g_variant_iter_init (&iter, results);
+      while (g_variant_iter_next (&iter, "{&sd}", &key, &value))
+        {
+          char buffer[G_ASCII_DTOSTR_BUF_SIZE];
+
+          g_print ("%s    \"%s\": %s", first ? "" : ",\n", key,
+                   g_ascii_formatd (buffer, sizeof (buffer), "%.3f", value));
+          first = FALSE;
+        }
+      g_print ("\n  }");
+    }
+  g_print ("\n}\n");
+}
+
+static GVariant *
+load_baseline (const char *filename)
+{
+  GError *error = NULL;
+  GVariant *baseline;
+  char *contents;
+
+  if (!g_file_get_contents (filename, &contents, NULL, &error))
+    {
+      g_printerr (_("Could not load baseline: %s\n"), error->message);
+      g_error_free (error);
+      exit (1);
+    }
+
+  baseline = g_variant_parse (G_VARIANT_TYPE ("a{sa{sd}}"), contents, NULL, NULL, &error);
+  g_free (contents);
+  if (baseline == NULL)
+    {
+      g_printerr (_("Could not parse baseline: %s\n"), error->message);
+      g_error_free (error);
+      exit (1);
+    }
+
+  return baseline;
+}
+
+/* Returns TRUE if any renderer regressed by more than threshold percent */
+static gboolean
+compare_with_baseline (GVariant *all_results,
+                       GVariant *baseline,
+                       double    threshold)
+{
+  GVariantIter renderer_iter;
+  GVariant *results;
+  const char *renderer_name;
+  gboolean regressed = FALSE;
+
+  g_variant_iter_init (&renderer_iter, all_results);
+  while (g_variant_iter_loop (&renderer_iter, "{&s@a{sd}}", &renderer_name, &results))
+    {
+      GVariant *reference;
+      guint i;
+
+      if (!g_variant_lookup (baseline, renderer_name, "@a{sd}", &reference))
+        {
+          g_print ("%s: not in baseline\n", renderer_name);
+          continue;
+        }
+
+      for (i = 0; i < N_TIMINGS; i++)
+        {
+          double before, after, change;
+
+          before = lookup_result (reference, timing_names[i], "p50");
+          after = lookup_result (results, timing_names[i], "p50");
+          if (before <= 0)
+            continue;
+
+          change = (after - before) * 100.0 / before;
+          g_print ("%s %-8s p50 %8.3fms -> %8.3fms  %+6.1f%%%s\n",
+                   renderer_name, timing_names[i], before, after, change,
+                   change > threshold ? "  REGRESSION" : "");
+
+          /* only the total time decides, the split depends on the driver */
+          if (i == TIMING_TOTAL && change > threshold)
+            regressed = TRUE;
+        }
+
+      g_variant_unref (reference);
+    }
+
+  return regressed;
 }
 
 void
@@ -89,15 +344,26 @@ do_benchmark (int          *argc,
   char **filenames = NULL;
   char **renderers = NULL;
   gboolean nodownload = FALSE;
+  gboolean json = FALSE;
+  char *baseline_file = NULL;
+  double threshold = 10.0;
   int runs = 3;
+  int warmup = 1;
   const GOptionEntry entries[] = {
     { "renderer", 0, 0, G_OPTION_ARG_STRING_ARRAY, &renderers, N_("Add renderer to benchmark"), N_("RENDERER") },
     { "runs", 0, 0, G_OPTION_ARG_INT, &runs, N_("Number of runs with each renderer"), N_("RUNS") },
+    { "warmup", 0, 0, G_OPTION_ARG_INT, &warmup, N_("Number of runs to discard before measuring"), N_("RUNS") },
     { "no-download", 0, 0, G_OPTION_ARG_NONE, &nodownload, N_("Don’t download result/wait for GPU to finish"), NULL },
+    { "json", 0, 0, G_OPTION_ARG_NONE, &json, N_("Print results as JSON"), NULL },
+    { "compare", 0, 0, G_OPTION_ARG_FILENAME, &baseline_file, N_("Compare with results saved with --json"), N_("FILE") },
+    { "threshold", 0, 0, G_OPTION_ARG_DOUBLE, &threshold, N_("Allowed slowdown in percent when comparing"), N_("PERCENT") },
     { G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &filenames, NULL, N_("FILE…") },
     { NULL, }
   };
   GskRenderNode *node;
+  GVariantBuilder builder;
+  GVariant *all_results;
+  gboolean regressed = FALSE;
   GError *error = NULL;
   gsize i;
 
@@ -134,18 +400,51 @@ do_benchmark (int          *argc,
       exit (1);
     }
 
+  if (runs < 1 || warmup < 0)
+    {
+      g_printerr (_("Invalid number of runs\n"));
+      exit (1);
+    }
+
   if (renderers == NULL || renderers[0] == NULL)
     renderers = g_strdupv ((char **) (const char *[]) { "gl", "ngl", "vulkan", "cairo", NULL });
   
   node = load_node_file (filenames[0]);
 
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sa{sd}}"));
   for (i = 0; renderers[i] != NULL; i++)
     {
-      benchmark_node (node, renderers[i], runs, !nodownload);
+      GVariant *results;
+
+      results = benchmark_node (node, renderers[i], warmup, runs, !nodownload);
+      if (results == NULL)
+        continue;
+
+      if (!json && baseline_file == NULL)
+        print_results (renderers[i], results);
+
+      g_variant_builder_add (&builder, "{s@a{sd}}", renderers[i], results);
     }
+  all_results = g_variant_ref_sink (g_variant_builder_end (&builder));
 
+  if (json)
+    print_json (all_results);
+
+  if (baseline_file)
+    {
+      GVariant *baseline = load_baseline (baseline_file);
+
+      regressed = compare_with_baseline (all_results, baseline, threshold);
+      g_variant_unref (baseline);
+    }
+
+  g_variant_unref (all_results);
   gsk_render_node_unref (node);
 
   g_strfreev (filenames);
   g_strfreev (renderers);
+  g_free (baseline_file);
+
+  if (regressed)
+    exit (1);
 }
@@ -60,11 +60,29 @@ GskRenderNode *
 load_node_file (const char *filename)
 {
   GFile *file;
-  GBytes *bytes;
+  GBytes *bytes = NULL;
+  GskRenderNode *node;
   GError *error = NULL;
+  char *path;
 
   file = g_file_new_for_commandline_arg (filename);
-  bytes = g_file_load_bytes (file, NULL, NULL, &error);
+
+  /* Map local files, so textures in binary files don't need to be copied */
+  path = g_file_get_path (file);
+  if (path)
+    {
+      GMappedFile *mapped = g_mapped_file_new (path, FALSE, NULL);
+
+      if (mapped)
+        {
+          bytes = g_mapped_file_get_bytes (mapped);
+          g_mapped_file_unref (mapped);
+        }
+      g_free (path);
+    }
+
+  if (bytes == NULL)
+    bytes = g_file_load_bytes (file, NULL, NULL, &error);
   g_object_unref (file);
 
   if (bytes == NULL)
@@ -74,7 +92,10 @@ load_node_file (const char *filename)
       exit (1);
     }
 
-  return gsk_render_node_deserialize (bytes, deserialize_error_func, NULL);
+  node = gsk_render_node_deserialize (bytes, deserialize_error_func, NULL);
+  g_bytes_unref (bytes);
+
+  return node;
 }
 
 /* keep in sync with gsk/gskrenderer.c */
@@ -0,0 +1,360 @@
+/* packatlas.c
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <gdk/gdk.h>
+#include <glib/gi18n.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <locale.h>
+
+#include "gdkresourceatlasprivate.h"
+
+/* Packs images into pages for gdk_resource_atlas_lookup().
+ *
+ * Every image gets a 1 pixel border that repeats its edge pixels, so
+ * that sampling with linear filtering never picks up its neighbours.
+ */
+
+#define PADDING 1
+
+typedef struct
+{
+  char *name;
+  GdkTexture *texture;
+  int width;
+  int height;
+  guint page;
+  int x;
+  int y;
+} Image;
+
+typedef struct
+{
+  int width;
+  int height;
+} Page;
+
+static char *output_dir = NULL;
+static int page_size = 1024;
+
+static GOptionEntry args[] = {
+  { "output", 'o', 0, G_OPTION_ARG_FILENAME, &output_dir, N_("Output to this directory instead of cwd"), NULL },
+  { "size", 's', 0, G_OPTION_ARG_INT, &page_size, N_("Maximum width and height of a page"), N_("SIZE") },
+  { NULL }
+};
+
+static int
+compare_images (gconstpointer a,
+                gconstpointer b)
+{
+  const Image *ia = a;
+  const Image *ib = b;
+
+  if (ia->height != ib->height)
+    return ib->height - ia->height;
+
+  return ib->width - ia->width;
+}
+
+/* Simple shelf packing. With the images sorted by height, every shelf
+ * wastes little more than the height difference of its images.
+ */
+static guint
+pack_images (GArray *images,
+             GArray *pages)
+{
+  Page *page;
+  int x, y, shelf_height;
+  guint i;
+
+  g_array_sort (images, compare_images);
+
+  page = NULL;
+  x = y = shelf_height = 0;
+
+  for (i = 0; i < images->len; i++)
+    {
+      Image *image = &g_array_index (images, Image, i);
+      int width = image->width + 2 * PADDING;
+      int height = image->height + 2 * PADDING;
+
+      if (page && x + width > page_size)
+        {
+          x = 0;
+          y += shelf_height;
+          shelf_height = 0;
+        }
+
+      if (page == NULL || y + height > page_size)
+        {
+          g_array_set_size (pages, pages->len + 1);
+          page = &g_array_index (pages, Page, pages->len - 1);
+          x = y = shelf_height = 0;
+        }
+
+      image->page = pages->len - 1;
+      image->x = x + PADDING;
+      image->y = y + PADDING;
+
+      x += width;
+      shelf_height = MAX (shelf_height, height);
+      page->width = MAX (page->width, x);
+      page->height = MAX (page->height, y + height);
+    }
+
+  return pages->len;
+}
+
+static void
+copy_image (guchar *data,
+            gsize   stride,
+            Image  *image)
+{
+  GdkTextureDownloader *downloader;
+  guchar *pixels;
+  int x, y;
+
+  pixels = data + image->y * stride + image->x * 4;
+
+  downloader = gdk_texture_downloader_new (image->texture);
+  gdk_texture_downloader_set_format (downloader, GDK_MEMORY_R8G8B8A8);
+  gdk_texture_downloader_download_into (downloader, pixels, stride);
+  gdk_texture_downloader_free (downloader);
+
+  /* Repeat the edges into the padding */
+  for (y = 0; y < image->height; y++)
+    {
+      guchar *row = pixels + y * stride;
+
+      memcpy (row - 4, row, 4);
+      memcpy (row + image->width * 4, row + (image->width - 1) * 4, 4);
+    }
+
+  for (x = -1; x <= image->width; x++)
+    {
+      memcpy (pixels - stride + x * 4, pixels + x * 4, 4);
+      memcpy (pixels + image->height * stride + x * 4, pixels + (image->height - 1) * stride + x * 4, 4);
+    }
+}
+
+static gboolean
+write_page (GArray  *images,
+            Page    *page,
+            guint    n,
+            GError **error)
+{
+  GdkTexture *texture;
+  GBytes *bytes;
+  guchar *data;
+  gsize stride;
+  char *name, *path;
+  gboolean result;
+  guint i;
+
+  stride = page->width * 4;
+  data = g_malloc0 (stride * page->height);
+
+  for (i = 0; i < images->len; i++)
+    {
+      Image *image = &g_array_index (images, Image, i);
+
+      if (image->page == n)
+        copy_image (data, stride, image);
+    }
+
+  bytes = g_bytes_new_take (data, stride * page->height);
+  texture = gdk_memory_texture_new (page->width, page->height, GDK_MEMORY_R8G8B8A8, bytes, stride);
+  g_bytes_unref (bytes);
+
+  name = g_strdup_printf (GDK_RESOURCE_ATLAS_PAGE, n);
+  path = g_build_filename (output_dir, name, NULL);
+  bytes = gdk_texture_save_to_png_bytes (texture);
+  result = g_file_set_contents (path, g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes), error);
+
+  g_bytes_unref (bytes);
+  g_free (path);
+  g_free (name);
+  g_object_unref (texture);
+
+  return result;
+}
+
+static gboolean
+write_index (GArray  *images,
+             GError **error)
+{
+  GVariantBuilder builder;
+  GVariant *index;
+  GBytes *bytes;
+  char *path;
+  gboolean result;
+  guint i;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{s(uqqqq)}"));
+  for (i = 0; i < images->len; i++)
+    {
+      Image *image = &g_array_index (images, Image, i);
+
+      g_variant_builder_add (&builder, "{s(uqqqq)}",
+                             image->name,
+                             image->page,
+                             (guint16) image->x, (guint16) image->y,
+                             (guint16) image->width, (guint16) image->height);
+    }
+
+  index = g_variant_ref_sink (g_variant_new ("(ua{s(uqqqq)})",
+                                             GDK_RESOURCE_ATLAS_VERSION,
+                                             &builder));
+  bytes = g_variant_get_data_as_bytes (index);
+
+  path = g_build_filename (output_dir, GDK_RESOURCE_ATLAS_INDEX, NULL);
+  result = g_file_set_contents (path, g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes), error);
+
+  g_free (path);
+  g_bytes_unref (bytes);
+  g_variant_unref (index);
+
+  return result;
+}
+
+static void
+clear_image (gpointer data)
+{
+  Image *image = data;
+
+  g_free (image->name);
+  g_clear_object (&image->texture);
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GHashTable *names;
+  GArray *images, *pages;
+  GError *error = NULL;
+  guint i, n_pages;
+  int arg, status = 0;
+
+  setlocale (LC_ALL, "");
+
+  bindtextdomain (GETTEXT_PACKAGE, GTK_LOCALEDIR);
+#ifdef HAVE_BIND_TEXTDOMAIN_CODESET
+  bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
+#endif
+
+  g_set_prgname ("gtk4-pack-atlas");
+
+  context = g_option_context_new ("[OPTION…] IMAGE…");
+  g_option_context_set_summary (context,
+                                _("Pack images into an atlas for gdk_texture_new_from_resource().\n"
+                                  "Add the generated files to the resource directory of the images."));
+  g_option_context_add_main_entries (context, args, GETTEXT_PACKAGE);
+
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      return 1;
+    }
+
+  if (argc < 2)
+    {
+      g_printerr ("%s\n", g_option_context_get_help (context, FALSE, NULL));
+      return 1;
+    }
+
+  if (page_size < 16 || page_size > G_MAXUINT16)
+    {
+      g_printerr (_("Invalid page size %d\n"), page_size);
+      return 1;
+    }
+
+  if (output_dir == NULL)
+    output_dir = g_get_current_dir ();
+
+  images = g_array_new (FALSE, TRUE, sizeof (Image));
+  g_array_set_clear_func (images, clear_image);
+  pages = g_array_new (FALSE, TRUE, sizeof (Page));
+  names = g_hash_table_new (g_str_hash, g_str_equal);
+
+  for (arg = 1; arg < argc; arg++)
+    {
+      Image image = { 0, };
+
+      image.texture = gdk_texture_new_from_filename (argv[arg], &error);
+      if (image.texture == NULL)
+        {
+          g_printerr (_("Can’t load file: %s\n"), error->message);
+          g_clear_error (&error);
+          status = 1;
+          goto out;
+        }
+
+      image.name = g_path_get_basename (argv[arg]);
+      image.width = gdk_texture_get_width (image.texture);
+      image.height = gdk_texture_get_height (image.texture);
+      g_array_append_val (images, image);
+
+      if (image.width + 2 * PADDING > page_size ||
+          image.height + 2 * PADDING > page_size)
+        {
+          g_printerr (_("%s is too large for a page of size %d\n"), argv[arg], page_size);
+          status = 1;
+          goto out;
+        }
+
+      /* Images are looked up by their name in the resource directory */
+      if (!g_hash_table_add (names, image.name))
+        {
+          g_printerr (_("Duplicate image name %s\n"), image.name);
+          status = 1;
+          goto out;
+        }
+    }
+
+  n_pages = pack_images (images, pages);
+
+  for (i = 0; i < n_pages; i++)
+    {
+      if (!write_page (images, &g_array_index (pages, Page, i), i, &error))
+        {
+          g_printerr (_("Can’t save file: %s\n"), error->message);
+          g_clear_error (&error);
+          status = 1;
+          goto out;
+        }
+    }
+
+  if (!write_index (images, &error))
+    {
+      g_printerr (_("Can’t save file: %s\n"), error->message);
+      g_clear_error (&error);
+      status = 1;
+      goto out;
+    }
+
+out:
+  g_hash_table_unref (names);
+  g_array_unref (pages);
+  g_array_unref (images);
+  g_option_context_free (context);
+
+  return status;
+}